@@ -86,11 +86,17 @@ if_up(struct interface *ifp)
             CHECK_FLAG(babel_get_if_nfo(ifp)->flags, BABEL_IF_IS_UP));
 }
 
+struct babel_route;
+struct xroute;
+
 struct buffered_update {
     unsigned char id[8];
     unsigned char prefix[16];
     unsigned char plen;
     unsigned char pad[3];
+    /* looked up once by flushupdates(), only valid while it runs */
+    struct babel_route *route;
+    struct xroute *xroute;
 };
 
 /* init function */
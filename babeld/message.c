@@ -1250,9 +1250,10 @@ flushupdates(struct interface *ifp)
            with the same router-id together, with IPv6 going out before IPv4. */
 
         for(i = 0; i < n; i++) {
-            route = find_installed_route(b[i].prefix, b[i].plen);
-            if(route)
-                memcpy(b[i].id, route->src->id, 8);
+            b[i].xroute = find_xroute(b[i].prefix, b[i].plen);
+            b[i].route = find_installed_route(b[i].prefix, b[i].plen);
+            if(b[i].route)
+                memcpy(b[i].id, b[i].route->src->id, 8);
             else
                 memcpy(b[i].id, myid, 8);
         }
@@ -1270,8 +1271,8 @@ flushupdates(struct interface *ifp)
                     continue;
             }
 
-            xroute = find_xroute(b[i].prefix, b[i].plen);
-            route = find_installed_route(b[i].prefix, b[i].plen);
+            xroute = b[i].xroute;
+            route = b[i].route;
 
             if(xroute && (!route || xroute->metric <= kernel_metric)) {
                 really_send_update(ifp, myid,
@@ -6,6 +6,7 @@ Copyright 2011 by Matthieu Boutier and Juliusz Chroboczek
 
 #include <zebra.h>
 #include "if.h"
+#include "typesafe.h"
 
 #include "babeld.h"
 #include "util.h"
@@ -21,8 +22,18 @@ Copyright 2011 by Matthieu Boutier and Juliusz Chroboczek
 
 static void consider_route(struct babel_route *route);
 
-struct babel_route **routes = NULL;
-static int route_slots = 0, max_route_slots = 0;
+PREDECL_RBTREE_UNIQ(route_slots);
+
+/* All the routes to a prefix, with the installed route, if any, at the
+   head of the list. */
+struct route_slot {
+    struct route_slots_item item;
+    unsigned char prefix[16];
+    unsigned char plen;
+    struct babel_route *routes;
+};
+
+static struct route_slots_head route_table = INIT_RBTREE_UNIQ(route_table);
 int kernel_metric = 0;
 enum babel_diversity diversity_kind = DIVERSITY_NONE;
 int diversity_factor = BABEL_DEFAULT_DIVERSITY_FACTOR;
@@ -31,58 +42,34 @@ int keep_unfeasible = 0;
 int smoothing_half_life = 0;
 static int two_to_the_one_over_hl = 0; /* 2^(1/hl) * 0x10000 */
 
-/* We maintain a list of "slots", ordered by prefix.  Every slot
-   contains a linked list of the routes to this prefix, with the
-   installed route, if any, at the head of the list. */
+/* We maintain a tree of "slots", ordered by prefix, so that inserting or
+   removing a prefix doesn't have to move the others around. */
 
 static int
-route_compare(const unsigned char *prefix, unsigned char plen,
-               struct babel_route *route)
+route_slot_compare(const struct route_slot *a, const struct route_slot *b)
 {
-    int i = memcmp(prefix, route->src->prefix, 16);
+    int i = memcmp(a->prefix, b->prefix, 16);
     if(i != 0)
         return i;
 
-    if(plen < route->src->plen)
+    if(a->plen < b->plen)
         return -1;
-    else if(plen > route->src->plen)
+    else if(a->plen > b->plen)
         return 1;
     else
         return 0;
 }
 
-/* Performs binary search, returns -1 in case of failure.  In the latter
-   case, new_return is the place where to insert the new element. */
+DECLARE_RBTREE_UNIQ(route_slots, struct route_slot, item, route_slot_compare);
 
-static int
-find_route_slot(const unsigned char *prefix, unsigned char plen,
-                int *new_return)
+static struct route_slot *
+find_route_slot(const unsigned char *prefix, unsigned char plen)
 {
-    int p, m, g, c;
+    struct route_slot key;
 
-    if(route_slots < 1) {
-        if(new_return)
-            *new_return = 0;
-        return -1;
-    }
-
-    p = 0; g = route_slots - 1;
-
-    do {
-        m = (p + g) / 2;
-        c = route_compare(prefix, plen, routes[m]);
-        if(c == 0)
-            return m;
-        else if(c < 0)
-            g = m - 1;
-        else
-            p = m + 1;
-    } while(p <= g);
-
-    if(new_return)
-        *new_return = p;
-
-    return -1;
+    memcpy(key.prefix, prefix, 16);
+    key.plen = plen;
+    return route_slots_find(&route_table, &key);
 }
 
 struct babel_route *
@@ -90,12 +77,12 @@ find_route(const unsigned char *prefix, unsigned char plen,
            struct neighbour *neigh, const unsigned char *nexthop)
 {
     struct babel_route *route;
-    int i = find_route_slot(prefix, plen, NULL);
+    struct route_slot *slot = find_route_slot(prefix, plen);
 
-    if(i < 0)
+    if(slot == NULL)
         return NULL;
 
-    route = routes[i];
+    route = slot->routes;
 
     while(route) {
         if(route->neigh == neigh && memcmp(route->nexthop, nexthop, 16) == 0)
@@ -109,10 +96,10 @@ find_route(const unsigned char *prefix, unsigned char plen,
 struct babel_route *
 find_installed_route(const unsigned char *prefix, unsigned char plen)
 {
-    int i = find_route_slot(prefix, plen, NULL);
+    struct route_slot *slot = find_route_slot(prefix, plen);
 
-    if(i >= 0 && routes[i]->installed)
-        return routes[i];
+    if(slot && slot->routes->installed)
+        return slot->routes;
 
     return NULL;
 }
@@ -121,27 +108,7 @@ find_installed_route(const unsigned char *prefix, unsigned char plen)
 int
 installed_routes_estimate(void)
 {
-    return route_slots;
-}
-
-static int
-resize_route_table(int new_slots)
-{
-    struct babel_route **new_routes;
-    assert(new_slots >= route_slots);
-
-    if(new_slots == 0) {
-        new_routes = NULL;
-        free(routes);
-    } else {
-        new_routes = realloc(routes, new_slots * sizeof(struct babel_route*));
-        if(new_routes == NULL)
-            return -1;
-    }
-
-    max_route_slots = new_slots;
-    routes = new_routes;
-    return 1;
+    return route_slots_count(&route_table);
 }
 
 /* Insert a route into the table.  If successful, retains the route.
@@ -149,27 +116,24 @@ resize_route_table(int new_slots)
 static struct babel_route *
 insert_route(struct babel_route *route)
 {
-    int i, n = 0;
+    struct route_slot *slot;
 
     assert(!route->installed);
 
-    i = find_route_slot(route->src->prefix, route->src->plen, &n);
+    slot = find_route_slot(route->src->prefix, route->src->plen);
 
-    if(i < 0) {
-        if(route_slots >= max_route_slots)
-            resize_route_table(max_route_slots < 1 ? 8 : 2 * max_route_slots);
-        if(route_slots >= max_route_slots)
+    if(slot == NULL) {
+        slot = malloc(sizeof(struct route_slot));
+        if(slot == NULL)
             return NULL;
-        assert(routes);
+        memcpy(slot->prefix, route->src->prefix, 16);
+        slot->plen = route->src->plen;
         route->next = NULL;
-        if(n < route_slots)
-            memmove(routes + n + 1, routes + n,
-                    (route_slots - n) * sizeof(struct babel_route*));
-        route_slots++;
-        routes[n] = route;
+        slot->routes = route;
+        route_slots_add(&route_table, slot);
     } else {
         struct babel_route *r;
-        r = routes[i];
+        r = slot->routes;
         while(r->next)
             r = r->next;
         r->next = route;
@@ -182,7 +146,7 @@ insert_route(struct babel_route *route)
 void
 flush_route(struct babel_route *route)
 {
-    int i;
+    struct route_slot *slot;
     struct source *src;
     unsigned oldmetric;
     int lost = 0;
@@ -195,28 +159,20 @@ flush_route(struct babel_route *route)
         lost = 1;
     }
 
-    i = find_route_slot(route->src->prefix, route->src->plen, NULL);
-    assert(i >= 0 && i < route_slots);
+    slot = find_route_slot(route->src->prefix, route->src->plen);
+    assert(slot);
 
-    if(route == routes[i]) {
-        routes[i] = route->next;
+    if(route == slot->routes) {
+        slot->routes = route->next;
         route->next = NULL;
         free(route);
 
-        if(routes[i] == NULL) {
-            if(i < route_slots - 1)
-                memmove(routes + i, routes + i + 1,
-                        (route_slots - i - 1) * sizeof(struct babel_route*));
-            routes[route_slots - 1] = NULL;
-            route_slots--;
+        if(slot->routes == NULL) {
+            route_slots_del(&route_table, slot);
+            free(slot);
         }
-
-        if(route_slots == 0)
-            resize_route_table(0);
-        else if(max_route_slots > 8 && route_slots < max_route_slots / 4)
-            resize_route_table(max_route_slots / 2);
     } else {
-        struct babel_route *r = routes[i];
+        struct babel_route *r = slot->routes;
         while(r->next != route)
             r = r->next;
         r->next = route->next;
@@ -230,21 +186,28 @@ flush_route(struct babel_route *route)
     release_source(src);
 }
 
+/* Flushes a route of slot, returns 0 if that was the last one and the slot
+   is gone. */
+static int
+flush_slot_route(struct route_slot *slot, struct babel_route *route)
+{
+    int last = slot->routes == route && route->next == NULL;
+
+    flush_route(route);
+    return !last;
+}
+
 void
 flush_all_routes(void)
 {
-    int i;
-
-    /* Start from the end, to avoid shifting the table. */
-    i = route_slots - 1;
-    while(i >= 0) {
-        while(i < route_slots) {
-        /* Uninstall first, to avoid calling route_lost. */
-            if(routes[i]->installed)
-                uninstall_route(routes[i]);
-            flush_route(routes[i]);
-        }
-        i--;
+    struct route_slot *slot;
+
+    frr_each_safe(route_slots, &route_table, slot) {
+        do {
+            /* Uninstall first, to avoid calling route_lost. */
+            if(slot->routes->installed)
+                uninstall_route(slot->routes);
+        } while(flush_slot_route(slot, slot->routes));
     }
 
     check_sources_released();
@@ -253,51 +216,48 @@ flush_all_routes(void)
 void
 flush_neighbour_routes(struct neighbour *neigh)
 {
-    int i;
+    struct route_slot *slot;
 
-    i = 0;
-    while(i < route_slots) {
+    frr_each_safe(route_slots, &route_table, slot) {
         struct babel_route *r;
-        r = routes[i];
+    again:
+        r = slot->routes;
         while(r) {
             if(r->neigh == neigh) {
-                flush_route(r);
-                goto again;
+                if(flush_slot_route(slot, r))
+                    goto again;
+                break;
             }
             r = r->next;
         }
-        i++;
-    again:
-        ;
     }
 }
 
 void
 flush_interface_routes(struct interface *ifp, int v4only)
 {
-    int i;
+    struct route_slot *slot;
 
-    i = 0;
-    while(i < route_slots) {
+    frr_each_safe(route_slots, &route_table, slot) {
         struct babel_route *r;
-        r = routes[i];
+    again:
+        r = slot->routes;
         while(r) {
             if(r->neigh->ifp == ifp &&
                (!v4only || v4mapped(r->nexthop))) {
-                flush_route(r);
-                goto again;
+                if(flush_slot_route(slot, r))
+                    goto again;
+                break;
             }
             r = r->next;
         }
-        i++;
-    again:
-        ;
     }
 }
 
 struct route_stream {
     int installed;
-    int index;
+    int done;
+    struct route_slot *slot;
     struct babel_route *next;
 };
 
@@ -312,30 +272,47 @@ route_stream(int installed)
        return NULL;
 
     stream->installed = installed;
-    stream->index = installed ? 0 : -1;
+    stream->done = 0;
+    stream->slot = NULL;
     stream->next = NULL;
 
     return stream;
 }
 
+static struct route_slot *
+route_stream_next_slot(struct route_stream *stream)
+{
+    if(stream->done)
+        return NULL;
+
+    if(stream->slot)
+        stream->slot = route_slots_next(&route_table, stream->slot);
+    else
+        stream->slot = route_slots_first(&route_table);
+
+    if(stream->slot == NULL)
+        stream->done = 1;
+    return stream->slot;
+}
+
 struct babel_route *
 route_stream_next(struct route_stream *stream)
 {
     if(stream->installed) {
-        while(stream->index < route_slots && !routes[stream->index]->installed)
-            stream->index++;
+        struct route_slot *slot;
 
-        if(stream->index < route_slots)
-            return routes[stream->index++];
-        else
-            return NULL;
+        do {
+            slot = route_stream_next_slot(stream);
+        } while(slot && !slot->routes->installed);
+
+        return slot ? slot->routes : NULL;
     } else {
         struct babel_route *next;
         if(!stream->next) {
-            stream->index++;
-            if(stream->index >= route_slots)
+            struct route_slot *slot = route_stream_next_slot(stream);
+            if(slot == NULL)
                 return NULL;
-            stream->next = routes[stream->index];
+            stream->next = slot->routes;
         }
         next = stream->next;
         stream->next = next->next;
@@ -358,25 +335,26 @@ metric_to_kernel(int metric)
 /* This is used to maintain the invariant that the installed route is at
    the head of the list. */
 static void
-move_installed_route(struct babel_route *route, int i)
+move_installed_route(struct babel_route *route, struct route_slot *slot)
 {
-    assert(i >= 0 && i < route_slots);
+    assert(slot);
     assert(route->installed);
 
-    if(route != routes[i]) {
-        struct babel_route *r = routes[i];
+    if(route != slot->routes) {
+        struct babel_route *r = slot->routes;
         while(r->next != route)
             r = r->next;
         r->next = route->next;
-        route->next = routes[i];
-        routes[i] = route;
+        route->next = slot->routes;
+        slot->routes = route;
     }
 }
 
 void
 install_route(struct babel_route *route)
 {
-    int i, rc;
+    struct route_slot *slot;
+    int rc;
 
     if(route->installed)
         return;
@@ -385,10 +363,10 @@ install_route(struct babel_route *route)
 	    flog_err(EC_BABEL_ROUTE,
 		     "Installing unfeasible route (this shouldn't happen).");
 
-    i = find_route_slot(route->src->prefix, route->src->plen, NULL);
-    assert(i >= 0 && i < route_slots);
+    slot = find_route_slot(route->src->prefix, route->src->plen);
+    assert(slot);
 
-    if(routes[i] != route && routes[i]->installed) {
+    if(slot->routes != route && slot->routes->installed) {
 	    flog_err(
 		    EC_BABEL_ROUTE,
 		    "Attempting to install duplicate route (this shouldn't happen).");
@@ -407,7 +385,7 @@ install_route(struct babel_route *route)
             return;
     }
     route->installed = 1;
-    move_installed_route(route, i);
+    move_installed_route(route, slot);
 
 }
 
@@ -464,8 +442,8 @@ switch_routes(struct babel_route *old, struct babel_route *new)
 
     old->installed = 0;
     new->installed = 1;
-    move_installed_route(new, find_route_slot(new->src->prefix, new->src->plen,
-                                              NULL));
+    move_installed_route(new, find_route_slot(new->src->prefix,
+                                              new->src->plen));
 }
 
 static void
@@ -677,12 +655,12 @@ find_best_route(const unsigned char *prefix, unsigned char plen, int feasible,
                 struct neighbour *exclude)
 {
     struct babel_route *route = NULL, *r = NULL;
-    int i = find_route_slot(prefix, plen, NULL);
+    struct route_slot *slot = find_route_slot(prefix, plen);
 
-    if(i < 0)
+    if(slot == NULL)
         return NULL;
 
-    route = routes[i];
+    route = slot->routes;
     while(route && !route_acceptable(route, feasible, exclude))
         route = route->next;
 
@@ -734,10 +712,10 @@ update_neighbour_metric(struct neighbour *neigh, int changed)
 {
 
     if(changed) {
-        int i;
+        struct route_slot *slot;
 
-        for(i = 0; i < route_slots; i++) {
-            struct babel_route *r = routes[i];
+        frr_each(route_slots, &route_table, slot) {
+            struct babel_route *r = slot->routes;
             while(r) {
                 if(r->neigh == neigh)
                     update_route_metric(r);
@@ -750,10 +728,10 @@ update_neighbour_metric(struct neighbour *neigh, int changed)
 void
 update_interface_metric(struct interface *ifp)
 {
-    int i;
+    struct route_slot *slot;
 
-    for(i = 0; i < route_slots; i++) {
-        struct babel_route *r = routes[i];
+    frr_each(route_slots, &route_table, slot) {
+        struct babel_route *r = slot->routes;
         while(r) {
             if(r->neigh->ifp == ifp)
                 update_route_metric(r);
@@ -970,10 +948,10 @@ consider_route(struct babel_route *route)
 void
 retract_neighbour_routes(struct neighbour *neigh)
 {
-    int i;
+    struct route_slot *slot;
 
-    for(i = 0; i < route_slots; i++) {
-        struct babel_route *r = routes[i];
+    frr_each(route_slots, &route_table, slot) {
+        struct babel_route *r = slot->routes;
         while(r) {
             if(r->neigh == neigh) {
                 if(r->refmetric != INFINITY) {
@@ -1097,19 +1075,20 @@ route_lost(struct source *src, unsigned oldmetric)
 void
 expire_routes(void)
 {
+    struct route_slot *slot;
     struct babel_route *r;
-    int i;
 
     debugf(BABEL_DEBUG_COMMON,"Expiring old routes.");
 
-    i = 0;
-    while(i < route_slots) {
-        r = routes[i];
+    frr_each_safe(route_slots, &route_table, slot) {
+    again:
+        r = slot->routes;
         while(r) {
             /* Protect against clock being stepped. */
             if(r->time > babel_now.tv_sec || route_old(r)) {
-                flush_route(r);
-                goto again;
+                if(flush_slot_route(slot, r))
+                    goto again;
+                break;
             }
 
             update_route_metric(r);
@@ -1122,8 +1101,5 @@ expire_routes(void)
             }
             r = r->next;
         }
-        i++;
-    again:
-        ;
     }
 }
@@ -14,32 +14,47 @@ Copyright (c) 2007, 2008 by Juliusz Chroboczek
 
 #include "babel_main.h"
 #include "babeld.h"
+#include "jhash.h"
 #include "util.h"
 #include "source.h"
 #include "babel_interface.h"
 #include "route.h"
 #include "babel_errors.h"
 
-struct source *srcs = NULL;
+static int
+source_compare(const struct source *a, const struct source *b)
+{
+    int i = memcmp(a->id, b->id, 8);
+    if(i != 0)
+        return i;
+    i = memcmp(a->prefix, b->prefix, 16);
+    if(i != 0)
+        return i;
+    return numcmp(a->plen, b->plen);
+}
+
+static uint32_t
+source_hash(const struct source *src)
+{
+    return jhash(src->id, 8, jhash(src->prefix, 16, src->plen));
+}
+
+DECLARE_HASH(sources, struct source, item, source_compare, source_hash);
+
+static struct sources_head srcs = INIT_HASH(srcs);
 
 struct source*
 find_source(const unsigned char *id, const unsigned char *p, unsigned char plen,
             int create, unsigned short seqno)
 {
-    struct source *src;
+    struct source *src, key;
 
-    for(src = srcs; src; src = src->next) {
-        /* This should really be a hash table.  For now, check the
-           last byte first. */
-        if(src->id[7] != id[7])
-            continue;
-        if(memcmp(src->id, id, 8) != 0)
-            continue;
-        if(src->plen != plen)
-            continue;
-        if(memcmp(src->prefix, p, 16) == 0)
-            return src;
-    }
+    memcpy(key.id, id, 8);
+    memcpy(key.prefix, p, 16);
+    key.plen = plen;
+    src = sources_find(&srcs, &key);
+    if(src)
+        return src;
 
     if(!create)
         return NULL;
@@ -57,8 +72,7 @@ find_source(const unsigned char *id, const unsigned char *p, unsigned char plen,
     src->metric = INFINITY;
     src->time = babel_now.tv_sec;
     src->route_count = 0;
-    src->next = srcs;
-    srcs = src;
+    sources_add(&srcs, src);
     return src;
 }
 
@@ -84,15 +98,7 @@ flush_source(struct source *src)
         /* The source is in use by a route. */
         return 0;
 
-    if(srcs == src) {
-        srcs = src->next;
-    } else {
-        struct source *previous = srcs;
-        while(previous->next != src)
-            previous = previous->next;
-        previous->next = src->next;
-    }
-
+    sources_del(&srcs, src);
     free(src);
     return 1;
 }
@@ -122,18 +128,12 @@ expire_sources(void)
 {
     struct source *src;
 
-    src = srcs;
-    while(src) {
+    frr_each_safe(sources, &srcs, src) {
         if(src->time > babel_now.tv_sec)
             /* clock stepped */
             src->time = babel_now.tv_sec;
-        if(src->time < babel_now.tv_sec - SOURCE_GC_TIME) {
-            struct source *old = src;
-            src = src->next;
-            flush_source(old);
-            continue;
-        }
-        src = src->next;
+        if(src->time < babel_now.tv_sec - SOURCE_GC_TIME)
+            flush_source(src);
     }
 }
 
@@ -142,7 +142,7 @@ check_sources_released(void)
 {
     struct source *src;
 
-    for(src = srcs; src; src = src->next) {
+    frr_each(sources, &srcs, src) {
         if(src->route_count != 0)
             fprintf(stderr, "Warning: source %s %s has refcount %d.\n",
                     format_eui64(src->id),
@@ -6,10 +6,14 @@ Copyright (c) 2007, 2008 by Juliusz Chroboczek
 #ifndef BABEL_SOURCE_H
 #define BABEL_SOURCE_H
 
+#include "typesafe.h"
+
 #define SOURCE_GC_TIME 200
 
+PREDECL_HASH(sources);
+
 struct source {
-    struct source *next;
+    struct sources_item item;
     unsigned char id[8];
     unsigned char prefix[16];
     unsigned char plen;
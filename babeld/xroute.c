@@ -6,6 +6,7 @@ Copyright 2011 by Matthieu Boutier and Juliusz Chroboczek
 
 #include <zebra.h>
 #include "if.h"
+#include "jhash.h"
 #include "log.h"
 
 #include "babeld.h"
@@ -21,8 +22,24 @@ static int xroute_add_new_route(unsigned char prefix[16], unsigned char plen,
                                 unsigned short metric, unsigned int ifindex,
                                 int proto, int send_updates);
 
-static struct xroute *xroutes;
-static int numxroutes = 0, maxxroutes = 0;
+static int
+xroute_compare(const struct xroute *a, const struct xroute *b)
+{
+    int i = memcmp(a->prefix, b->prefix, 16);
+    if(i != 0)
+        return i;
+    return numcmp(a->plen, b->plen);
+}
+
+static uint32_t
+xroute_hash(const struct xroute *xroute)
+{
+    return jhash(xroute->prefix, 16, xroute->plen);
+}
+
+DECLARE_HASH(xroutes, struct xroute, item, xroute_compare, xroute_hash);
+
+static struct xroutes_head xroutes = INIT_HASH(xroutes);
 
 /* Add redistributed route to Babel table. */
 int
@@ -80,41 +97,18 @@ babel_route_delete (struct zapi_route *api)
 struct xroute *
 find_xroute(const unsigned char *prefix, unsigned char plen)
 {
-    int i;
-    for(i = 0; i < numxroutes; i++) {
-        if(xroutes[i].plen == plen &&
-           memcmp(xroutes[i].prefix, prefix, 16) == 0)
-            return &xroutes[i];
-    }
-    return NULL;
+    struct xroute key;
+
+    memcpy(key.prefix, prefix, 16);
+    key.plen = plen;
+    return xroutes_find(&xroutes, &key);
 }
 
 void
 flush_xroute(struct xroute *xroute)
 {
-    int i;
-
-    i = xroute - xroutes;
-    assert(i >= 0 && i < numxroutes);
-
-    if(i != numxroutes - 1)
-        memcpy(xroutes + i, xroutes + numxroutes - 1, sizeof(struct xroute));
-    numxroutes--;
-    VALGRIND_MAKE_MEM_UNDEFINED(xroutes + numxroutes, sizeof(struct xroute));
-
-    if(numxroutes == 0) {
-        free(xroutes);
-        xroutes = NULL;
-        maxxroutes = 0;
-    } else if(maxxroutes > 8 && numxroutes < maxxroutes / 4) {
-        struct xroute *new_xroutes;
-        int n = maxxroutes / 2;
-        new_xroutes = realloc(xroutes, n * sizeof(struct xroute));
-        if(new_xroutes == NULL)
-            return;
-        xroutes = new_xroutes;
-        maxxroutes = n;
-    }
+    xroutes_del(&xroutes, xroute);
+    free(xroute);
 }
 
 static int
@@ -129,24 +123,16 @@ add_xroute(unsigned char prefix[16], unsigned char plen,
         return 1;
     }
 
-    if(numxroutes >= maxxroutes) {
-        struct xroute *new_xroutes;
-        int n = maxxroutes < 1 ? 8 : 2 * maxxroutes;
-        new_xroutes = xroutes == NULL ?
-            malloc(n * sizeof(struct xroute)) :
-            realloc(xroutes, n * sizeof(struct xroute));
-        if(new_xroutes == NULL)
-            return -1;
-        maxxroutes = n;
-        xroutes = new_xroutes;
-    }
+    xroute = malloc(sizeof(struct xroute));
+    if(xroute == NULL)
+        return -1;
 
-    memcpy(xroutes[numxroutes].prefix, prefix, 16);
-    xroutes[numxroutes].plen = plen;
-    xroutes[numxroutes].metric = metric;
-    xroutes[numxroutes].ifindex = ifindex;
-    xroutes[numxroutes].proto = proto;
-    numxroutes++;
+    memcpy(xroute->prefix, prefix, 16);
+    xroute->plen = plen;
+    xroute->metric = metric;
+    xroute->ifindex = ifindex;
+    xroute->proto = proto;
+    xroutes_add(&xroutes, xroute);
     return 1;
 }
 
@@ -154,11 +140,12 @@ add_xroute(unsigned char prefix[16], unsigned char plen,
 int
 xroutes_estimate(void)
 {
-    return numxroutes;
+    return xroutes_count(&xroutes);
 }
 
 struct xroute_stream {
-    int index;
+    int done;
+    struct xroute *next;
 };
 
 struct
@@ -169,17 +156,25 @@ xroute_stream(void)
     if(stream == NULL)
        return NULL;
 
-    stream->index = 0;
+    stream->done = 0;
+    stream->next = NULL;
     return stream;
 }
 
 struct xroute *
 xroute_stream_next(struct xroute_stream *stream)
 {
-    if(stream->index < numxroutes)
-        return &xroutes[stream->index++];
-    else
+    if(stream->done)
         return NULL;
+
+    if(stream->next)
+        stream->next = xroutes_next(&xroutes, stream->next);
+    else
+        stream->next = xroutes_first(&xroutes);
+
+    if(stream->next == NULL)
+        stream->done = 1;
+    return stream->next;
 }
 
 void
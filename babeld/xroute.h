@@ -7,7 +7,12 @@ Copyright 2011 by Matthieu Boutier and Juliusz Chroboczek
 #ifndef BABEL_XROUTE_H
 #define BABEL_XROUTE_H
 
+#include "typesafe.h"
+
+PREDECL_HASH(xroutes);
+
 struct xroute {
+    struct xroutes_item item;
     unsigned char prefix[16];
     unsigned char plen;
     unsigned short metric;
@@ -371,6 +371,8 @@ int bfd_session_enable(struct bfd_session *bs)
 	/* initialize RTT */
 	bfd_rtt_init(bs);
 
+	bfd_xdp_session_enable(bs);
+
 	return 0;
 }
 
@@ -386,6 +388,8 @@ void bfd_session_disable(struct bfd_session *bs)
 	if (bs->bdc)
 		return;
 
+	bfd_xdp_session_disable(bs);
+
 	/* Free up socket resources. */
 	if (bs->sock != -1) {
 		close(bs->sock);
@@ -517,6 +521,8 @@ void ptm_bfd_sess_dn(struct bfd_session *bfd, uint8_t diag)
 {
 	int old_state = bfd->ses_state;
 
+	bfd_xdp_session_down(bfd);
+
 	bfd->local_diag = diag;
 	bfd->discrs.remote_discr = 0;
 	bfd->ses_state = PTM_BFD_DOWN;
@@ -638,6 +644,10 @@ void bfd_recvtimer_cb(struct event *t)
 {
 	struct bfd_session *bs = EVENT_ARG(t);
 
+	/* the kernel may have been receiving the packets for us */
+	if (bfd_xdp_session_alive(bs))
+		return;
+
 	switch (bs->ses_state) {
 	case PTM_BFD_INIT:
 	case PTM_BFD_UP:
@@ -1270,6 +1280,7 @@ void bfd_set_shutdown(struct bfd_session *bs, bool shutdown)
 		bfd_echo_recvtimer_delete(bs);
 		bfd_xmttimer_delete(bs);
 		bfd_echo_xmttimer_delete(bs);
+		bfd_xdp_session_down(bs);
 
 		/* Change and notify state change. */
 		bs->ses_state = PTM_BFD_ADM_DOWN;
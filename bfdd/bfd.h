@@ -281,6 +281,13 @@ struct bfd_session {
 	struct peer_label *pl;
 
 	struct bfd_dplane_ctx *bdc;
+
+	/* XDP fast path, see bfd_xdp.c */
+	ifindex_t xdp_ifindex;
+	bool xdp_offloaded;
+	struct bfd_pkt xdp_pkt;
+	uint64_t xdp_rx_packets;
+
 	struct sockaddr_any local_address;
 	uint8_t peer_hw_addr[ETH_ALEN];
 	struct interface *ifp;
@@ -564,6 +571,7 @@ void bfd_recv_cb(struct event *t);
 typedef void (*bfd_ev_cb)(struct event *t);
 
 void bfd_recvtimer_update(struct bfd_session *bs);
+void bfd_recvtimer_update_in(struct bfd_session *bs, uint64_t timeout);
 void bfd_echo_recvtimer_update(struct bfd_session *bs);
 void bfd_xmttimer_update(struct bfd_session *bs, uint64_t jitter);
 void bfd_echo_xmttimer_update(struct bfd_session *bs, uint64_t jitter);
@@ -825,6 +833,62 @@ int bfd_dplane_delete_session(struct bfd_session *bs);
  */
 int bfd_dplane_update_session_counters(struct bfd_session *bs);
 
+/**
+ * Asks the data planes for updated counters of all their sessions, with a
+ * single request to each data plane supporting bulk messages.
+ */
+void bfd_dplane_update_counters(void);
+
 void bfd_dplane_show_counters(struct vty *vty);
 
+/*
+ * bfd_xdp.c
+ */
+#ifdef HAVE_BFD_XDP
+/**
+ * Load the XDP program from path.  Single hop sessions bound to an
+ * interface get their echo packets reflected and the steady state of
+ * their control packets handled in the kernel from then on.
+ */
+void bfd_xdp_init(const char *path);
+void bfd_xdp_fini(void);
+
+void bfd_xdp_session_enable(struct bfd_session *bs);
+void bfd_xdp_session_disable(struct bfd_session *bs);
+
+/* bfdd processed a control packet of bs */
+void bfd_xdp_session_rx(struct bfd_session *bs, const struct bfd_pkt *cp);
+
+/* bs left the Up state, its control packets have to come to bfdd again */
+void bfd_xdp_session_down(struct bfd_session *bs);
+
+/**
+ * The detection timer of bs expired: did the kernel see control packets
+ * in the meantime?  If so, the timer is restarted for the remaining time.
+ */
+bool bfd_xdp_session_alive(struct bfd_session *bs);
+#else
+static inline void bfd_xdp_session_enable(struct bfd_session *bs)
+{
+}
+
+static inline void bfd_xdp_session_disable(struct bfd_session *bs)
+{
+}
+
+static inline void bfd_xdp_session_rx(struct bfd_session *bs,
+				      const struct bfd_pkt *cp)
+{
+}
+
+static inline void bfd_xdp_session_down(struct bfd_session *bs)
+{
+}
+
+static inline bool bfd_xdp_session_alive(struct bfd_session *bs)
+{
+	return false;
+}
+#endif /* HAVE_BFD_XDP */
+
 #endif /* _BFD_H_ */
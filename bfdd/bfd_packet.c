@@ -34,6 +34,14 @@ int _ptm_bfd_send(struct bfd_session *bs, uint16_t *port, const void *data,
 		  size_t datalen);
 
 static void bfd_sd_reschedule(struct bfd_vrf_global *bvrf, int sd);
+static ssize_t bfd_recv_ipv4_parse(struct msghdr *msghdr, ssize_t mlen,
+				   uint8_t *ttl, ifindex_t *ifindex,
+				   struct sockaddr_any *local,
+				   struct sockaddr_any *peer);
+static ssize_t bfd_recv_ipv6_parse(struct msghdr *msghdr6, ssize_t mlen,
+				   uint8_t *ttl, ifindex_t *ifindex,
+				   struct sockaddr_any *local,
+				   struct sockaddr_any *peer);
 ssize_t bfd_recv_ipv4(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
 		      ifindex_t *ifindex, struct sockaddr_any *local,
 		      struct sockaddr_any *peer);
@@ -515,7 +523,6 @@ ssize_t bfd_recv_ipv4(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
 		      ifindex_t *ifindex, struct sockaddr_any *local,
 		      struct sockaddr_any *peer)
 {
-	struct cmsghdr *cm;
 	ssize_t mlen;
 	struct sockaddr_in msgaddr;
 	struct msghdr msghdr;
@@ -542,12 +549,23 @@ ssize_t bfd_recv_ipv4(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
 		return -1;
 	}
 
+	return bfd_recv_ipv4_parse(&msghdr, mlen, ttl, ifindex, local, peer);
+}
+
+/* Get the addresses, TTL and interface of a received IPv4 packet. */
+static ssize_t bfd_recv_ipv4_parse(struct msghdr *msghdr, ssize_t mlen,
+				   uint8_t *ttl, ifindex_t *ifindex,
+				   struct sockaddr_any *local,
+				   struct sockaddr_any *peer)
+{
+	struct cmsghdr *cm;
+
 	/* Get source address */
-	peer->sa_sin = *((struct sockaddr_in *)(msghdr.msg_name));
+	peer->sa_sin = *((struct sockaddr_in *)(msghdr->msg_name));
 
 	/* Get and check TTL */
-	for (cm = CMSG_FIRSTHDR(&msghdr); cm != NULL;
-	     cm = CMSG_NXTHDR(&msghdr, cm)) {
+	for (cm = CMSG_FIRSTHDR(msghdr); cm != NULL;
+	     cm = CMSG_NXTHDR(msghdr, cm)) {
 		if (cm->cmsg_level != IPPROTO_IP)
 			continue;
 
@@ -616,7 +634,7 @@ ssize_t bfd_recv_ipv4(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
 
 	/* OS agnostic way of getting interface name. */
 	if (*ifindex == IFINDEX_INTERNAL)
-		*ifindex = getsockopt_ifindex(AF_INET, &msghdr);
+		*ifindex = getsockopt_ifindex(AF_INET, msghdr);
 
 	return mlen;
 }
@@ -625,10 +643,7 @@ ssize_t bfd_recv_ipv6(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
 		      ifindex_t *ifindex, struct sockaddr_any *local,
 		      struct sockaddr_any *peer)
 {
-	struct cmsghdr *cm;
-	struct in6_pktinfo *pi6 = NULL;
 	ssize_t mlen;
-	uint32_t ttlval;
 	struct sockaddr_in6 msgaddr6;
 	struct msghdr msghdr6;
 	struct iovec iov[1];
@@ -654,12 +669,25 @@ ssize_t bfd_recv_ipv6(int sd, uint8_t *msgbuf, size_t msgbuflen, uint8_t *ttl,
 		return -1;
 	}
 
+	return bfd_recv_ipv6_parse(&msghdr6, mlen, ttl, ifindex, local, peer);
+}
+
+/* Get the addresses, hop limit and interface of a received IPv6 packet. */
+static ssize_t bfd_recv_ipv6_parse(struct msghdr *msghdr6, ssize_t mlen,
+				   uint8_t *ttl, ifindex_t *ifindex,
+				   struct sockaddr_any *local,
+				   struct sockaddr_any *peer)
+{
+	struct cmsghdr *cm;
+	struct in6_pktinfo *pi6 = NULL;
+	uint32_t ttlval;
+
 	/* Get source address */
-	peer->sa_sin6 = *((struct sockaddr_in6 *)(msghdr6.msg_name));
+	peer->sa_sin6 = *((struct sockaddr_in6 *)(msghdr6->msg_name));
 
 	/* Get and check TTL */
-	for (cm = CMSG_FIRSTHDR(&msghdr6); cm != NULL;
-	     cm = CMSG_NXTHDR(&msghdr6, cm)) {
+	for (cm = CMSG_FIRSTHDR(msghdr6); cm != NULL;
+	     cm = CMSG_NXTHDR(msghdr6, cm)) {
 		if (cm->cmsg_level != IPPROTO_IPV6)
 			continue;
 
@@ -768,45 +796,79 @@ static void cp_debug(bool mhop, struct sockaddr_any *peer,
 		   mhop ? "yes" : "no", peerstr, localstr, portstr, vrfstr);
 }
 
-void bfd_recv_cb(struct event *t)
+/*
+ * Control packets are read in batches of up to BFD_RECV_BATCH with
+ * recvmmsg(), so a busy socket doesn't need a trip through the event loop
+ * for every single packet.
+ */
+#define BFD_RECV_BATCH 32
+
+struct bfd_recv_buf {
+	uint8_t msgbuf[1516];
+	uint8_t cmsgbuf[255];
+	struct sockaddr_any name;
+	struct iovec iov;
+};
+
+static struct bfd_recv_buf bfd_recv_bufs[BFD_RECV_BATCH];
+static struct mmsghdr bfd_recv_mmsg[BFD_RECV_BATCH];
+
+static int bfd_recv_batch(int sd)
+{
+	struct bfd_recv_buf *rb;
+	struct msghdr *mh;
+	int i, n;
+
+	for (i = 0; i < BFD_RECV_BATCH; i++) {
+		rb = &bfd_recv_bufs[i];
+		mh = &bfd_recv_mmsg[i].msg_hdr;
+
+		rb->iov.iov_base = rb->msgbuf;
+		rb->iov.iov_len = sizeof(rb->msgbuf);
+
+		memset(mh, 0, sizeof(*mh));
+		mh->msg_name = &rb->name;
+		mh->msg_namelen = sizeof(rb->name);
+		mh->msg_iov = &rb->iov;
+		mh->msg_iovlen = 1;
+		mh->msg_control = rb->cmsgbuf;
+		mh->msg_controllen = sizeof(rb->cmsgbuf);
+	}
+
+	n = recvmmsg(sd, bfd_recv_mmsg, BFD_RECV_BATCH, MSG_DONTWAIT, NULL);
+	if (n < 0) {
+		if (errno != EAGAIN)
+			zlog_err("control-recv: recv failed: %s",
+				 strerror(errno));
+		return 0;
+	}
+
+	return n;
+}
+
+static void bfd_recv_ctrl(struct bfd_vrf_global *bvrf, int sd, bool is_mhop,
+			  bool is_ipv6, struct mmsghdr *mmsg)
 {
-	int sd = EVENT_FD(t);
 	struct bfd_session *bfd;
 	struct bfd_pkt *cp;
-	bool is_mhop;
-	ssize_t mlen = 0;
+	ssize_t mlen;
 	uint8_t ttl = 0;
 	vrf_id_t vrfid;
 	ifindex_t ifindex = IFINDEX_INTERNAL;
 	struct sockaddr_any local, peer;
-	uint8_t msgbuf[1516];
+	uint8_t *msgbuf = mmsg->msg_hdr.msg_iov->iov_base;
 	struct interface *ifp = NULL;
-	struct bfd_vrf_global *bvrf = EVENT_ARG(t);
-
-	/* Schedule next read. */
-	bfd_sd_reschedule(bvrf, sd);
-
-	/* Handle echo packets. */
-	if (sd == bvrf->bg_echo || sd == bvrf->bg_echov6) {
-		ptm_bfd_process_echo_pkt(bvrf, sd);
-		return;
-	}
 
 	/* Sanitize input/output. */
 	memset(&local, 0, sizeof(local));
 	memset(&peer, 0, sizeof(peer));
 
-	/* Handle control packets. */
-	is_mhop = false;
-	if (sd == bvrf->bg_shop || sd == bvrf->bg_mhop) {
-		is_mhop = sd == bvrf->bg_mhop;
-		mlen = bfd_recv_ipv4(sd, msgbuf, sizeof(msgbuf), &ttl, &ifindex,
-				     &local, &peer);
-	} else if (sd == bvrf->bg_shop6 || sd == bvrf->bg_mhop6) {
-		is_mhop = sd == bvrf->bg_mhop6;
-		mlen = bfd_recv_ipv6(sd, msgbuf, sizeof(msgbuf), &ttl, &ifindex,
-				     &local, &peer);
-	}
+	if (is_ipv6)
+		mlen = bfd_recv_ipv6_parse(&mmsg->msg_hdr, mmsg->msg_len, &ttl,
+					   &ifindex, &local, &peer);
+	else
+		mlen = bfd_recv_ipv4_parse(&mmsg->msg_hdr, mmsg->msg_len, &ttl,
+					   &ifindex, &local, &peer);
 
 	/*
 	 * With netns backend, we have a separate socket in each VRF. It means
@@ -993,6 +1055,40 @@ void bfd_recv_cb(struct event *t)
 		/* Send the control packet with the final bit immediately. */
 		ptm_bfd_snd(bfd, 1);
 	}
+
+	/* Let the kernel handle the packets to come, if they stay the same. */
+	bfd_xdp_session_rx(bfd, cp);
+}
+
+void bfd_recv_cb(struct event *t)
+{
+	int sd = EVENT_FD(t);
+	struct bfd_vrf_global *bvrf = EVENT_ARG(t);
+	bool is_mhop, is_ipv6;
+	int i, n;
+
+	/* Schedule next read. */
+	bfd_sd_reschedule(bvrf, sd);
+
+	/* Handle echo packets. */
+	if (sd == bvrf->bg_echo || sd == bvrf->bg_echov6) {
+		ptm_bfd_process_echo_pkt(bvrf, sd);
+		return;
+	}
+
+	/* Handle control packets. */
+	if (sd == bvrf->bg_shop || sd == bvrf->bg_mhop) {
+		is_mhop = sd == bvrf->bg_mhop;
+		is_ipv6 = false;
+	} else if (sd == bvrf->bg_shop6 || sd == bvrf->bg_mhop6) {
+		is_mhop = sd == bvrf->bg_mhop6;
+		is_ipv6 = true;
+	} else
+		return;
+
+	n = bfd_recv_batch(sd);
+	for (i = 0; i < n; i++)
+		bfd_recv_ctrl(bvrf, sd, is_mhop, is_ipv6, &bfd_recv_mmsg[i]);
 }
 
 /*
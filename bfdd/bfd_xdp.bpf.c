@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * BFD XDP fast path.
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * Loaded and attached by bfdd (--xdp) to the interfaces of its single hop
+ * sessions:
+ *
+ * - Echo packets from known peers are sent back right away, the way the
+ *   forwarding plane (IPv4) or bfdd (IPv6) would have looped them.
+ * - A control packet equal to the one bfdd last saw from the peer of an Up
+ *   session only updates the session's receive time and is dropped.  Any
+ *   other packet (state change, poll sequence, new timers, unknown session)
+ *   goes up to bfdd as before.
+ */
+
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/in.h>
+#include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/udp.h>
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_endian.h>
+
+#include "bfd_xdp.h"
+
+#define BFD_CTRL_PORT 3784
+#define BFD_ECHO_PORT 3785
+#define BFD_TTL 255
+
+struct {
+	__uint(type, BPF_MAP_TYPE_HASH);
+	__uint(max_entries, BFD_XDP_SESSIONS_MAX);
+	__type(key, __u32);
+	__type(value, struct bfd_xdp_session);
+} bfd_sessions SEC(".maps");
+
+struct {
+	__uint(type, BPF_MAP_TYPE_HASH);
+	__uint(max_entries, BFD_XDP_ECHO_PEERS_MAX);
+	__type(key, struct bfd_xdp_echo_key);
+	__type(value, __u8);
+} bfd_echo_peers SEC(".maps");
+
+static __always_inline void swap_mac(struct ethhdr *eth)
+{
+	__u8 tmp[ETH_ALEN];
+
+	__builtin_memcpy(tmp, eth->h_source, ETH_ALEN);
+	__builtin_memcpy(eth->h_source, eth->h_dest, ETH_ALEN);
+	__builtin_memcpy(eth->h_dest, tmp, ETH_ALEN);
+}
+
+static __always_inline int echo_peer_known(__u32 ifindex, __u8 ipv6,
+					   const void *addr)
+{
+	struct bfd_xdp_echo_key key = {
+		.ifindex = ifindex,
+		.ipv6 = ipv6,
+	};
+
+	if (ipv6)
+		__builtin_memcpy(key.addr, addr, 16);
+	else
+		__builtin_memcpy(key.addr, addr, 4);
+
+	return bpf_map_lookup_elem(&bfd_echo_peers, &key) != NULL;
+}
+
+static __always_inline int ctrl_in(const __u8 *bfd, void *end, __u32 ifindex,
+				   __u8 ipv6, const __u32 *src)
+{
+	struct bfd_xdp_session *bs;
+	const __u32 *peer;
+	__u32 discr;
+
+	if ((void *)(bfd + BFD_XDP_CTRL_LEN) > end)
+		return XDP_PASS;
+
+	/* Your Discriminator */
+	__builtin_memcpy(&discr, bfd + 8, sizeof(discr));
+	bs = bpf_map_lookup_elem(&bfd_sessions, &discr);
+	if (!bs || bs->ifindex != ifindex || bs->ipv6 != ipv6)
+		return XDP_PASS;
+
+	peer = (const __u32 *)bs->peer;
+	if (peer[0] != src[0])
+		return XDP_PASS;
+	if (ipv6 && (peer[1] != src[1] || peer[2] != src[2] ||
+		     peer[3] != src[3]))
+		return XDP_PASS;
+
+#pragma unroll
+	for (int i = 0; i < BFD_XDP_CTRL_LEN; i++)
+		if (bfd[i] != bs->pkt[i])
+			return XDP_PASS;
+
+	bs->last_rx = bpf_ktime_get_ns();
+	__sync_fetch_and_add(&bs->rx_packets, 1);
+
+	return XDP_DROP;
+}
+
+static __always_inline int bfd_ipv4(struct xdp_md *ctx, struct ethhdr *eth,
+				    void *end)
+{
+	struct iphdr *ip = (struct iphdr *)(eth + 1);
+	struct udphdr *udp;
+	__u32 check;
+
+	if ((void *)(ip + 1) > end)
+		return XDP_PASS;
+	if (ip->ihl != 5 || ip->protocol != IPPROTO_UDP ||
+	    (ip->frag_off & bpf_htons(0x3fff)) || ip->ttl != BFD_TTL)
+		return XDP_PASS;
+
+	udp = (struct udphdr *)(ip + 1);
+	if ((void *)(udp + 1) > end)
+		return XDP_PASS;
+
+	if (udp->dest == bpf_htons(BFD_CTRL_PORT))
+		return ctrl_in((const __u8 *)(udp + 1), end,
+			       ctx->ingress_ifindex, 0, &ip->saddr);
+
+	/* the peer's echo, addressed to itself: loop it back */
+	if (udp->dest != bpf_htons(BFD_ECHO_PORT) || ip->saddr != ip->daddr ||
+	    !echo_peer_known(ctx->ingress_ifindex, 0, &ip->saddr))
+		return XDP_PASS;
+
+	swap_mac(eth);
+	check = ip->check;
+	check += bpf_htons(0x0100);
+	ip->check = (__u16)(check + (check >= 0xffff));
+	ip->ttl--;
+
+	return XDP_TX;
+}
+
+static __always_inline int bfd_ipv6(struct xdp_md *ctx, struct ethhdr *eth,
+				    void *end)
+{
+	struct ipv6hdr *ip6 = (struct ipv6hdr *)(eth + 1);
+	struct in6_addr addr;
+	struct udphdr *udp;
+	__u16 port;
+
+	if ((void *)(ip6 + 1) > end)
+		return XDP_PASS;
+	if (ip6->nexthdr != IPPROTO_UDP || ip6->hop_limit != BFD_TTL)
+		return XDP_PASS;
+
+	udp = (struct udphdr *)(ip6 + 1);
+	if ((void *)(udp + 1) > end)
+		return XDP_PASS;
+
+	if (udp->dest == bpf_htons(BFD_CTRL_PORT))
+		return ctrl_in((const __u8 *)(udp + 1), end,
+			       ctx->ingress_ifindex, 1,
+			       (const __u32 *)&ip6->saddr);
+
+	if (udp->dest != bpf_htons(BFD_ECHO_PORT) ||
+	    !echo_peer_known(ctx->ingress_ifindex, 1, &ip6->saddr))
+		return XDP_PASS;
+
+	/* Reply from us to the peer; the UDP checksum stays the same. */
+	swap_mac(eth);
+	addr = ip6->saddr;
+	ip6->saddr = ip6->daddr;
+	ip6->daddr = addr;
+	port = udp->source;
+	udp->source = udp->dest;
+	udp->dest = port;
+	ip6->hop_limit--;
+
+	return XDP_TX;
+}
+
+SEC("xdp")
+int bfd_xdp(struct xdp_md *ctx)
+{
+	void *data = (void *)(long)ctx->data;
+	void *end = (void *)(long)ctx->data_end;
+	struct ethhdr *eth = data;
+
+	if ((void *)(eth + 1) > end)
+		return XDP_PASS;
+
+	if (eth->h_proto == bpf_htons(ETH_P_IP))
+		return bfd_ipv4(ctx, eth, end);
+	if (eth->h_proto == bpf_htons(ETH_P_IPV6))
+		return bfd_ipv6(ctx, eth, end);
+
+	return XDP_PASS;
+}
+
+char _license[] SEC("license") = "GPL";
@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * BFD XDP fast path.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include <linux/if_link.h>
+#include <bpf/bpf.h>
+#include <bpf/libbpf.h>
+
+#include "lib/linklist.h"
+#include "lib/memory.h"
+#include "lib/monotime.h"
+#include "lib/privs.h"
+
+#include "bfd.h"
+#include "bfd_xdp.h"
+
+DEFINE_MTYPE_STATIC(BFDD, BFDD_XDP, "BFD XDP interface");
+
+/*
+ * The XDP program (bfd_xdp.bpf.c) is attached to the interfaces that have
+ * single hop sessions bound to them.  Echo packets of the peers are
+ * reflected in the kernel, and while a session is Up, control packets that
+ * are the same as the last one bfdd processed never reach bfdd: the kernel
+ * only records when they arrived.  The detection timer keeps running here;
+ * when it expires, the receive time in the map decides whether the session
+ * really went down or the timer just restarts for the remaining time.
+ *
+ * Transmission stays with bfdd, an XDP program can't originate packets.
+ */
+struct bfd_xdp_if {
+	ifindex_t ifindex;
+	unsigned int refcnt;
+};
+
+static struct bfd_xdp {
+	struct bpf_object *obj;
+	int prog_fd;
+	int sessions_fd;
+	int echo_fd;
+	struct list *ifs;
+} bxdp = {
+	.prog_fd = -1,
+	.sessions_fd = -1,
+	.echo_fd = -1,
+};
+
+void bfd_xdp_init(const char *path)
+{
+	struct bpf_program *prog;
+
+	libbpf_set_strict_mode(LIBBPF_STRICT_ALL);
+
+	bxdp.obj = bpf_object__open_file(path, NULL);
+	if (!bxdp.obj) {
+		zlog_err("xdp: failed to open %s: %s", path,
+			 safe_strerror(errno));
+		return;
+	}
+
+	frr_with_privs (&bglobal.bfdd_privs) {
+		if (bpf_object__load(bxdp.obj)) {
+			zlog_err("xdp: failed to load %s: %s", path,
+				 safe_strerror(errno));
+			goto fail;
+		}
+	}
+
+	prog = bpf_object__find_program_by_name(bxdp.obj, "bfd_xdp");
+	bxdp.sessions_fd = bpf_object__find_map_fd_by_name(bxdp.obj,
+							   "bfd_sessions");
+	bxdp.echo_fd = bpf_object__find_map_fd_by_name(bxdp.obj,
+						       "bfd_echo_peers");
+	if (!prog || bxdp.sessions_fd < 0 || bxdp.echo_fd < 0) {
+		zlog_err("xdp: %s is not a BFD XDP program", path);
+		goto fail;
+	}
+	bxdp.prog_fd = bpf_program__fd(prog);
+	bxdp.ifs = list_new();
+
+	zlog_info("xdp: loaded %s", path);
+	return;
+
+fail:
+	bpf_object__close(bxdp.obj);
+	bxdp.obj = NULL;
+	bxdp.sessions_fd = bxdp.echo_fd = -1;
+}
+
+void bfd_xdp_fini(void)
+{
+	struct bfd_xdp_if *bxi;
+	struct listnode *node, *nnode;
+
+	if (!bxdp.obj)
+		return;
+
+	for (ALL_LIST_ELEMENTS(bxdp.ifs, node, nnode, bxi)) {
+		frr_with_privs (&bglobal.bfdd_privs) {
+			bpf_xdp_detach(bxi->ifindex, 0, NULL);
+		}
+		XFREE(MTYPE_BFDD_XDP, bxi);
+	}
+	list_delete(&bxdp.ifs);
+
+	bpf_object__close(bxdp.obj);
+	bxdp.obj = NULL;
+	bxdp.prog_fd = bxdp.sessions_fd = bxdp.echo_fd = -1;
+}
+
+static struct bfd_xdp_if *bfd_xdp_if_lookup(ifindex_t ifindex)
+{
+	struct bfd_xdp_if *bxi;
+	struct listnode *node;
+
+	for (ALL_LIST_ELEMENTS_RO(bxdp.ifs, node, bxi))
+		if (bxi->ifindex == ifindex)
+			return bxi;
+
+	return NULL;
+}
+
+static bool bfd_xdp_if_ref(struct interface *ifp)
+{
+	struct bfd_xdp_if *bxi = bfd_xdp_if_lookup(ifp->ifindex);
+	int ret;
+
+	if (bxi) {
+		bxi->refcnt++;
+		return true;
+	}
+
+	/* don't replace a program somebody else attached */
+	frr_with_privs (&bglobal.bfdd_privs) {
+		ret = bpf_xdp_attach(ifp->ifindex, bxdp.prog_fd,
+				     XDP_FLAGS_UPDATE_IF_NOEXIST, NULL);
+	}
+	if (ret) {
+		zlog_warn("xdp: failed to attach to %s: %s", ifp->name,
+			  safe_strerror(-ret));
+		return false;
+	}
+
+	if (bglobal.debug_network)
+		zlog_debug("xdp: attached to %s", ifp->name);
+
+	bxi = XCALLOC(MTYPE_BFDD_XDP, sizeof(*bxi));
+	bxi->ifindex = ifp->ifindex;
+	bxi->refcnt = 1;
+	listnode_add(bxdp.ifs, bxi);
+	return true;
+}
+
+static void bfd_xdp_if_unref(ifindex_t ifindex)
+{
+	struct bfd_xdp_if *bxi = bfd_xdp_if_lookup(ifindex);
+
+	if (!bxi || --bxi->refcnt)
+		return;
+
+	frr_with_privs (&bglobal.bfdd_privs) {
+		bpf_xdp_detach(ifindex, 0, NULL);
+	}
+	listnode_delete(bxdp.ifs, bxi);
+	XFREE(MTYPE_BFDD_XDP, bxi);
+}
+
+static void bfd_xdp_echo_key(const struct bfd_session *bs,
+			     struct bfd_xdp_echo_key *key)
+{
+	bool ipv6 = CHECK_FLAG(bs->flags, BFD_SESS_FLAG_IPV6);
+
+	memset(key, 0, sizeof(*key));
+	key->ifindex = bs->xdp_ifindex;
+	key->ipv6 = ipv6;
+	memcpy(key->addr, &bs->key.peer, ipv6 ? 16 : 4);
+}
+
+void bfd_xdp_session_enable(struct bfd_session *bs)
+{
+	struct bfd_xdp_echo_key key;
+	uint8_t one = 1;
+
+	if (!bxdp.obj || bs->xdp_ifindex || !bs->ifp ||
+	    CHECK_FLAG(bs->flags, BFD_SESS_FLAG_MH) || vrf_is_backend_netns())
+		return;
+
+	if (!bfd_xdp_if_ref(bs->ifp))
+		return;
+
+	bs->xdp_ifindex = bs->ifp->ifindex;
+	bfd_xdp_echo_key(bs, &key);
+	if (bpf_map_update_elem(bxdp.echo_fd, &key, &one, BPF_ANY))
+		zlog_warn("xdp: failed to add echo peer of %s: %s",
+			  bs_to_string(bs), safe_strerror(errno));
+}
+
+void bfd_xdp_session_disable(struct bfd_session *bs)
+{
+	struct bfd_xdp_echo_key key;
+
+	if (!bs->xdp_ifindex)
+		return;
+
+	bfd_xdp_session_down(bs);
+
+	bfd_xdp_echo_key(bs, &key);
+	bpf_map_delete_elem(bxdp.echo_fd, &key);
+
+	bfd_xdp_if_unref(bs->xdp_ifindex);
+	bs->xdp_ifindex = 0;
+}
+
+static uint64_t bfd_xdp_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Account the packets the kernel took care of, false if bs isn't there. */
+static bool bfd_xdp_session_fetch(struct bfd_session *bs,
+				  struct bfd_xdp_session *val)
+{
+	uint32_t discr = htonl(bs->discrs.my_discr);
+
+	if (bpf_map_lookup_elem(bxdp.sessions_fd, &discr, val))
+		return false;
+
+	bs->stats.rx_ctrl_pkt += val->rx_packets - bs->xdp_rx_packets;
+	bs->xdp_rx_packets = val->rx_packets;
+	return true;
+}
+
+void bfd_xdp_session_rx(struct bfd_session *bs, const struct bfd_pkt *cp)
+{
+	struct bfd_xdp_session val = {};
+	uint32_t discr = htonl(bs->discrs.my_discr);
+
+	if (!bs->xdp_ifindex)
+		return;
+
+	/* Nothing changes while a session is in steady state. */
+	if (bs->ses_state != PTM_BFD_UP || cp->len != BFD_PKT_LEN ||
+	    BFD_GETPBIT(cp->flags) || BFD_GETFBIT(cp->flags)) {
+		bfd_xdp_session_down(bs);
+		return;
+	}
+
+	if (bs->xdp_offloaded && !memcmp(&bs->xdp_pkt, cp, BFD_PKT_LEN))
+		return;
+
+	memcpy(val.peer, &bs->key.peer, sizeof(val.peer));
+	val.ifindex = bs->xdp_ifindex;
+	val.ipv6 = CHECK_FLAG(bs->flags, BFD_SESS_FLAG_IPV6);
+	memcpy(val.pkt, cp, BFD_PKT_LEN);
+	val.last_rx = bfd_xdp_now();
+	val.rx_packets = bs->xdp_rx_packets;
+
+	if (bpf_map_update_elem(bxdp.sessions_fd, &discr, &val, BPF_ANY)) {
+		zlog_warn("xdp: failed to offload %s: %s", bs_to_string(bs),
+			  safe_strerror(errno));
+		return;
+	}
+
+	memcpy(&bs->xdp_pkt, cp, BFD_PKT_LEN);
+	bs->xdp_offloaded = true;
+}
+
+void bfd_xdp_session_down(struct bfd_session *bs)
+{
+	uint32_t discr = htonl(bs->discrs.my_discr);
+	struct bfd_xdp_session val;
+
+	if (!bs->xdp_offloaded)
+		return;
+
+	bfd_xdp_session_fetch(bs, &val);
+	bpf_map_delete_elem(bxdp.sessions_fd, &discr);
+	bs->xdp_offloaded = false;
+}
+
+bool bfd_xdp_session_alive(struct bfd_session *bs)
+{
+	struct bfd_xdp_session val;
+	uint64_t now, since;
+
+	if (!bs->xdp_offloaded || bs->ses_state != PTM_BFD_UP ||
+	    !bfd_xdp_session_fetch(bs, &val))
+		return false;
+
+	now = bfd_xdp_now();
+	since = now > val.last_rx ? (now - val.last_rx) / 1000 : 0;
+	if (since >= bs->detect_TO)
+		return false;
+
+	bfd_recvtimer_update_in(bs, bs->detect_TO - since);
+	return true;
+}
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * BFD XDP fast path: maps shared by bfdd and the XDP program.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#ifndef _BFD_XDP_H_
+#define _BFD_XDP_H_
+
+#include <linux/types.h>
+
+#define BFD_XDP_SESSIONS_MAX 8192
+#define BFD_XDP_ECHO_PEERS_MAX 8192
+
+/* Length of a control packet without authentication. */
+#define BFD_XDP_CTRL_LEN 24
+
+/*
+ * "bfd_sessions" map: a single hop session in the Up state, keyed by our
+ * discriminator as it appears in the Your Discriminator field (network
+ * byte order).  bfdd fills in everything but the counters.
+ */
+struct bfd_xdp_session {
+	__u8 peer[16]; /* an IPv4 address takes the first 4 bytes */
+	__u32 ifindex;
+	__u8 ipv6;
+	__u8 pad[3];
+
+	/* the control packet the peer keeps sending while nothing changes */
+	__u8 pkt[BFD_XDP_CTRL_LEN];
+
+	/* updated by the program */
+	__u64 last_rx; /* CLOCK_MONOTONIC, nanoseconds */
+	__u64 rx_packets;
+};
+
+/* "bfd_echo_peers" map: peers whose echo packets are reflected. */
+struct bfd_xdp_echo_key {
+	__u32 ifindex;
+	__u8 ipv6;
+	__u8 pad[3];
+	__u8 addr[16];
+};
+
+#endif /* _BFD_XDP_H_ */
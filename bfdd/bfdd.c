@@ -35,7 +35,12 @@ DEFINE_MTYPE(BFDD, BFDD_NOTIFICATION, "short-lived control notification data");
 struct event_loop *master;
 
 /* BFDd privileges */
-static zebra_capabilities_t _caps_p[] = {ZCAP_BIND, ZCAP_SYS_ADMIN, ZCAP_NET_RAW};
+static zebra_capabilities_t _caps_p[] = {
+	ZCAP_BIND, ZCAP_SYS_ADMIN, ZCAP_NET_RAW,
+#ifdef HAVE_BFD_XDP
+	ZCAP_NET_ADMIN, /* attaching XDP programs */
+#endif
+};
 
 /* BFD daemon information. */
 static struct frr_daemon_info bfdd_di;
@@ -73,6 +78,10 @@ static void sigterm_handler(void)
 	/* Shutdown and free all protocol related memory. */
 	bfd_shutdown();
 
+#ifdef HAVE_BFD_XDP
+	bfd_xdp_fini();
+#endif
+
 	bfd_vrf_terminate();
 
 	/* Terminate and free() FRR related memory. */
@@ -125,12 +134,24 @@ FRR_DAEMON_INFO(bfdd, BFD, .vty_port = 2617,
 
 #define OPTION_CTLSOCK 1001
 #define OPTION_DPLANEADDR 2000
+#define OPTION_XDP 2001
 static const struct option longopts[] = {
 	{"bfdctl", required_argument, NULL, OPTION_CTLSOCK},
 	{"dplaneaddr", required_argument, NULL, OPTION_DPLANEADDR},
+#ifdef HAVE_BFD_XDP
+	{"xdp", optional_argument, NULL, OPTION_XDP},
+#endif
 	{0}
 };
 
+#ifdef HAVE_BFD_XDP
+#define BFD_XDP_OBJECT MODULE_PATH "/bfd_xdp.bpf.o"
+#define BFD_XDP_HELP                                                           \
+	"      --xdp[=FILE]   Handle echo and steady state control packets in XDP\n"
+#else
+#define BFD_XDP_HELP ""
+#endif
+
 
 /*
  * BFD daemon related code.
@@ -320,6 +341,9 @@ static void bg_init(void)
 int main(int argc, char *argv[])
 {
 	char ctl_path[512], dplane_addr[512];
+#ifdef HAVE_BFD_XDP
+	char xdp_path[512] = "";
+#endif
 	bool ctlsockused = false;
 	int opt;
 
@@ -331,7 +355,8 @@ int main(int argc, char *argv[])
 	frr_preinit(&bfdd_di, argc, argv);
 	frr_opt_add("", longopts,
 		    "      --bfdctl       Specify bfdd control socket\n"
-		    "      --dplaneaddr   Specify BFD data plane address\n");
+		    "      --dplaneaddr   Specify BFD data plane address\n"
+		    BFD_XDP_HELP);
 
 	snprintf(ctl_path, sizeof(ctl_path), BFDD_CONTROL_SOCKET,
 		 "", "");
@@ -349,6 +374,12 @@ int main(int argc, char *argv[])
 			strlcpy(dplane_addr, optarg, sizeof(dplane_addr));
 			bglobal.bg_use_dplane = true;
 			break;
+#ifdef HAVE_BFD_XDP
+		case OPTION_XDP:
+			strlcpy(xdp_path, optarg ? optarg : BFD_XDP_OBJECT,
+				sizeof(xdp_path));
+			break;
+#endif
 
 		default:
 			frr_help_exit(1);
@@ -362,6 +393,9 @@ int main(int argc, char *argv[])
 	/* Initialize FRR infrastructure. */
 	master = frr_init();
 
+	/* detection timers get restarted on every received packet */
+	event_master_set_timer_wheel(master, true);
+
 	/* Initialize control socket. */
 	control_init(ctl_path);
 
@@ -370,6 +404,11 @@ int main(int argc, char *argv[])
 
 	bfd_vrf_init();
 
+#ifdef HAVE_BFD_XDP
+	if (xdp_path[0])
+		bfd_xdp_init(xdp_path);
+#endif
+
 	access_list_init();
 
 	/* Initialize zebra connection. */
@@ -359,11 +359,6 @@ static void _display_peer_counter(struct vty *vty, struct bfd_session *bs)
 {
 	_display_peer_header(vty, bs);
 
-	/* Ask data plane for updated counters. */
-	if (bfd_dplane_update_session_counters(bs) == -1)
-		zlog_debug("%s: failed to update BFD session counters (%s)",
-			   __func__, bs_to_string(bs));
-
 	vty_out(vty, "\t\tControl packet input: %" PRIu64 " packets\n",
 		bs->stats.rx_ctrl_pkt);
 	vty_out(vty, "\t\tControl packet output: %" PRIu64 " packets\n",
@@ -385,11 +380,6 @@ static struct json_object *__display_peer_counters_json(struct bfd_session *bs)
 {
 	struct json_object *jo = _peer_json_header(bs);
 
-	/* Ask data plane for updated counters. */
-	if (bfd_dplane_update_session_counters(bs) == -1)
-		zlog_debug("%s: failed to update BFD session counters (%s)",
-			   __func__, bs_to_string(bs));
-
 	json_object_int_add(jo, "control-packet-input", bs->stats.rx_ctrl_pkt);
 	json_object_int_add(jo, "control-packet-output", bs->stats.tx_ctrl_pkt);
 	json_object_int_add(jo, "echo-packet-input", bs->stats.rx_echo_pkt);
@@ -457,6 +447,9 @@ static void _display_peers_counter(struct vty *vty, char *vrfname, bool use_json
 	struct json_object *jo;
 	struct bfd_vrf_tuple bvt = {0};
 
+	/* Ask data planes for updated counters. */
+	bfd_dplane_update_counters();
+
 	bvt.vrfname = vrfname;
 	if (!use_json) {
 		bvt.vty = vty;
@@ -707,6 +700,11 @@ DEFPY(bfd_show_peer_counters, bfd_show_peer_counters_cmd,
 	if (bs == NULL)
 		return CMD_WARNING_CONFIG_FAILED;
 
+	/* Ask data plane for updated counters. */
+	if (bfd_dplane_update_session_counters(bs) == -1)
+		zlog_debug("%s: failed to update BFD session counters (%s)",
+			   __func__, bs_to_string(bs));
+
 	if (use_json(argc, argv))
 		_display_peer_counters_json(vty, bs);
 	else
@@ -71,8 +71,33 @@ enum bfddp_message_type {
 	DP_REQUEST_SESSION_COUNTERS = 5,
 	/** Tell BFD daemon about counters values. */
 	BFD_SESSION_COUNTERS = 6,
+
+	/** Tell BFD daemon which optional messages the data plane supports. */
+	BFD_CAPABILITIES = 7,
+
+	/*
+	 * Bulk messages: only used after the data plane announced
+	 * `CAPABILITY_BULK`.
+	 */
+
+	/** Add or update multiple BFD peer sessions. */
+	DP_ADD_SESSIONS = 8,
+	/** Delete multiple BFD peer sessions. */
+	DP_DELETE_SESSIONS = 9,
+	/** Ask for the counters of multiple (or all) BFD sessions. */
+	DP_REQUEST_COUNTERS_BULK = 10,
+	/** Tell BFD daemon about multiple sessions counters values. */
+	BFD_SESSION_COUNTERS_BULK = 11,
 };
 
+/**
+ * Maximum length of a bulk message.
+ *
+ * Bulk messages carry as many entries as fit in this length, longer lists
+ * are split in multiple messages.
+ */
+#define BFD_DP_BULK_MAX_LENGTH 8192
+
 /**
  * `ECHO_REQUEST`/`ECHO_REPLY` data payload.
  *
@@ -348,8 +373,84 @@ struct bfddp_session_counters {
 	uint64_t echo_output_packets;
 };
 
+/** Data plane capability flags. */
+enum bfddp_capability_flag {
+	/** Data plane understands the bulk messages. */
+	CAPABILITY_BULK = (1 << 0),
+};
+
+/**
+ * Data plane capabilities announcement.
+ *
+ * Message type: `BFD_CAPABILITIES`.
+ *
+ * Sent by the data plane (with ID `0`) right after the connection is
+ * established. Data planes that don't send it only get the single session
+ * messages.
+ */
+struct bfddp_capabilities {
+	/** Supported optional features. \see bfddp_capability_flag. */
+	uint32_t flags;
+};
+
+/**
+ * Multiple sessions add/update.
+ *
+ * Message type: `DP_ADD_SESSIONS`.
+ *
+ * Every entry is handled like a `DP_ADD_SESSION` message.
+ */
+struct bfddp_sessions {
+	/** Amount of entries in `sessions`. */
+	uint32_t count;
+	/** Sessions settings. */
+	struct bfddp_session sessions[];
+};
+
+/**
+ * List of sessions local discriminators.
+ *
+ * Message types: `DP_DELETE_SESSIONS`, `DP_REQUEST_COUNTERS_BULK`.
+ *
+ * A `DP_REQUEST_COUNTERS_BULK` with `count` `0` asks for all sessions.
+ */
+struct bfddp_lids {
+	/** Amount of entries in `lids`. */
+	uint32_t count;
+	/** Sessions local discriminators. */
+	uint32_t lids[];
+};
+
+/** Bulk counters reply flags. */
+enum bfddp_counters_bulk_flag {
+	/** Last message of the reply. */
+	COUNTERS_BULK_LAST = (1 << 0),
+};
+
+/**
+ * Multiple sessions counters reply.
+ *
+ * Message type: `BFD_SESSION_COUNTERS_BULK`.
+ *
+ * The reply to a `DP_REQUEST_COUNTERS_BULK` may be split in multiple
+ * messages, all of them use the request ID and the last one is marked
+ * with `COUNTERS_BULK_LAST`. Unknown sessions are left out.
+ */
+struct bfddp_session_counters_bulk {
+	/** Amount of entries in `counters`. */
+	uint32_t count;
+	/** Reply flags. \see bfddp_counters_bulk_flag. */
+	uint32_t flags;
+	/** Sessions counters. */
+	struct bfddp_session_counters counters[];
+};
+
 /**
  * The protocol wire messages structure.
+ *
+ * Bulk messages payloads (`struct bfddp_sessions`, `struct bfddp_lids` and
+ * `struct bfddp_session_counters_bulk`) start at `data` too, they don't
+ * fit in the union because of their variable length.
  */
 struct bfddp_message {
 	/** Message header. \see bfddp_message_header. */
@@ -363,6 +464,7 @@ struct bfddp_message {
 		struct bfddp_control_packet control;
 		struct bfddp_request_counters counters_req;
 		struct bfddp_session_counters session_counters;
+		struct bfddp_capabilities capabilities;
 	} data;
 };
 
@@ -39,6 +39,21 @@ DEFINE_MTYPE_STATIC(BFDD, BFDD_DPLANE_CTX,
 /** Data plane client socket buffer size. */
 #define BFD_DPLANE_CLIENT_BUF_SIZE 8192
 
+/** Seconds to wait for the data plane capabilities before adding sessions. */
+#define BFD_DPLANE_CAPABILITIES_WAIT 1
+
+/** Bulk message payload space. */
+#define BFD_DPLANE_BULK_PAYLOAD                                                \
+	(BFD_DP_BULK_MAX_LENGTH - offsetof(struct bfddp_message, data))
+/** Maximum amount of sessions in one `DP_ADD_SESSIONS` message. */
+#define BFD_DPLANE_BULK_SESSIONS                                               \
+	((BFD_DPLANE_BULK_PAYLOAD - sizeof(struct bfddp_sessions)) /            \
+	 sizeof(struct bfddp_session))
+/** Maximum amount of local discriminators in one bulk message. */
+#define BFD_DPLANE_BULK_LIDS                                                   \
+	((BFD_DPLANE_BULK_PAYLOAD - sizeof(struct bfddp_lids)) /                \
+	 sizeof(uint32_t))
+
 struct bfd_dplane_ctx {
 	/** Client file descriptor. */
 	int sock;
@@ -68,6 +83,17 @@ struct bfd_dplane_ctx {
 	struct event *outbufev;
 	/** Connection event. */
 	struct event *connectev;
+	/** Session registration event (waiting for capabilities). */
+	struct event *registerev;
+	/** Pending sessions deletion event. */
+	struct event *deleteev;
+
+	/** Data plane supports the bulk messages. */
+	bool bulk;
+	/** Deleted sessions not yet sent to the data plane. */
+	uint32_t del_lids[BFD_DPLANE_BULK_LIDS];
+	/** Amount of entries in `del_lids`. */
+	uint32_t del_count;
 
 	/** Amount of bytes read. */
 	uint64_t in_bytes;
@@ -85,6 +111,8 @@ struct bfd_dplane_ctx {
 	uint64_t in_msgs;
 	/** Amount of messages enqueued (maybe written). */
 	uint64_t out_msgs;
+	/** Amount of bulk messages enqueued. */
+	uint64_t out_bulk_msgs;
 
 	TAILQ_ENTRY(bfd_dplane_ctx) entry;
 };
@@ -95,10 +123,13 @@ struct bfd_dplane_ctx {
 typedef void (*bfd_dplane_expect_cb)(struct bfddp_message *msg, void *arg);
 
 static void bfd_dplane_client_connect(struct event *t);
+static void bfd_dplane_register_sessions(struct bfd_dplane_ctx *bdc);
 static bool bfd_dplane_client_connecting(struct bfd_dplane_ctx *bdc);
 static void bfd_dplane_ctx_free(struct bfd_dplane_ctx *bdc);
 static int _bfd_dplane_add_session(struct bfd_dplane_ctx *bdc,
 				   struct bfd_session *bs);
+static void _bfd_dplane_session_fill(const struct bfd_session *bs,
+				     struct bfddp_message *msg);
 
 /*
  * BFD data plane helper functions.
@@ -120,6 +151,16 @@ static const char *bfd_dplane_messagetype2str(enum bfddp_message_type bmt)
 		return "DP_REQUEST_SESSION_COUNTERS";
 	case BFD_SESSION_COUNTERS:
 		return "BFD_SESSION_COUNTERS";
+	case BFD_CAPABILITIES:
+		return "BFD_CAPABILITIES";
+	case DP_ADD_SESSIONS:
+		return "DP_ADD_SESSIONS";
+	case DP_DELETE_SESSIONS:
+		return "DP_DELETE_SESSIONS";
+	case DP_REQUEST_COUNTERS_BULK:
+		return "DP_REQUEST_COUNTERS_BULK";
+	case BFD_SESSION_COUNTERS_BULK:
+		return "BFD_SESSION_COUNTERS_BULK";
 	default:
 		return "UNKNOWN";
 	}
@@ -127,6 +168,9 @@ static const char *bfd_dplane_messagetype2str(enum bfddp_message_type bmt)
 
 static void bfd_dplane_debug_message(const struct bfddp_message *msg)
 {
+	const struct bfddp_session_counters_bulk *counters_bulk;
+	const struct bfddp_sessions *sessions;
+	const struct bfddp_lids *lids;
 	enum bfddp_message_type bmt;
 	char buf[256], addrs[256];
 	uint32_t flags;
@@ -245,6 +289,31 @@ static void bfd_dplane_debug_message(const struct bfddp_message *msg)
 			be64toh(msg->data.session_counters
 				.echo_output_packets));
 		break;
+
+	case BFD_CAPABILITIES:
+		flags = ntohl(msg->data.capabilities.flags);
+		zlog_debug("  [flags=0x%08x{%s}]", flags,
+			   (flags & CAPABILITY_BULK) ? "bulk" : "");
+		break;
+
+	case DP_ADD_SESSIONS:
+		sessions = (const void *)&msg->data;
+		zlog_debug("  [count=%u]", ntohl(sessions->count));
+		break;
+
+	case DP_DELETE_SESSIONS:
+	case DP_REQUEST_COUNTERS_BULK:
+		lids = (const void *)&msg->data;
+		zlog_debug("  [count=%u]", ntohl(lids->count));
+		break;
+
+	case BFD_SESSION_COUNTERS_BULK:
+		counters_bulk = (const void *)&msg->data;
+		flags = ntohl(counters_bulk->flags);
+		zlog_debug("  [count=%u flags=0x%08x{%s}]",
+			   ntohl(counters_bulk->count), flags,
+			   (flags & COUNTERS_BULK_LAST) ? "last" : "");
+		break;
 	}
 }
 
@@ -283,14 +352,14 @@ static ssize_t bfd_dplane_flush(struct bfd_dplane_ctx *bdc)
 			zlog_warn("%s: socket failed: %s", __func__,
 				  strerror(errno));
 			bfd_dplane_ctx_free(bdc);
-			return 0;
+			return -1;
 		}
 		if (rv == 0) {
 			if (bglobal.debug_dplane)
 				zlog_info("%s: connection closed", __func__);
 
 			bfd_dplane_ctx_free(bdc);
-			return 0;
+			return -1;
 		}
 
 		/* Account total written. */
@@ -390,17 +459,8 @@ bfd_dplane_session_state_change(struct bfd_dplane_ctx *bdc,
 			   state_list[bs->ses_state].str);
 }
 
-/**
- * Enqueue message in output buffer.
- *
- * \param[in,out] bdc data plane client context.
- * \param[in] buf the message to buffer.
- * \param[in] buflen the amount of bytes to buffer.
- *
- * \returns `-1` on failure (buffer full) or `0` on success.
- */
-static int bfd_dplane_enqueue(struct bfd_dplane_ctx *bdc, const void *buf,
-			      size_t buflen)
+static int _bfd_dplane_enqueue(struct bfd_dplane_ctx *bdc, const void *buf,
+			       size_t buflen)
 {
 	size_t rlen;
 
@@ -435,6 +495,103 @@ static int bfd_dplane_enqueue(struct bfd_dplane_ctx *bdc, const void *buf,
 	return 0;
 }
 
+/**
+ * Enqueue message in output buffer, writing the buffered data to the socket
+ * first if there is not enough space.
+ *
+ * \param[in,out] bdc data plane client context.
+ * \param[in] buf the message to buffer.
+ * \param[in] buflen the amount of bytes to buffer.
+ *
+ * \returns `-1` on failure (`bdc` might be gone) or `0` on success.
+ */
+static int bfd_dplane_send_deletes(struct bfd_dplane_ctx *bdc);
+
+static int bfd_dplane_enqueue_flush(struct bfd_dplane_ctx *bdc,
+				    const void *buf, size_t buflen)
+{
+	if (bdc->del_count && bfd_dplane_send_deletes(bdc) == -1)
+		return -1;
+
+	if (_bfd_dplane_enqueue(bdc, buf, buflen) == 0)
+		return 0;
+
+	/* Not connected or message too big: flushing won't help. */
+	if (bdc->sock == -1 || STREAM_READABLE(bdc->outbuf) == 0)
+		return -1;
+
+	if (bfd_dplane_flush(bdc) == -1)
+		return -1;
+
+	return _bfd_dplane_enqueue(bdc, buf, buflen);
+}
+
+/**
+ * Send all pending sessions deletions in one `DP_DELETE_SESSIONS` message.
+ *
+ * \param bdc data plane client context.
+ *
+ * \returns `-1` on failure (`bdc` might be gone) or `0` on success.
+ */
+static int bfd_dplane_send_deletes(struct bfd_dplane_ctx *bdc)
+{
+	static union {
+		struct bfddp_message msg;
+		uint8_t buf[BFD_DP_BULK_MAX_LENGTH];
+	} bulk;
+	struct bfddp_lids *lids = (struct bfddp_lids *)&bulk.msg.data;
+	uint16_t msglen;
+	uint32_t i;
+
+	EVENT_OFF(bdc->deleteev);
+
+	msglen = offsetof(struct bfddp_message, data) + sizeof(*lids) +
+		 bdc->del_count * sizeof(lids->lids[0]);
+
+	bulk.msg.header.version = BFD_DP_VERSION;
+	bulk.msg.header.zero = 0;
+	bulk.msg.header.type = htons(DP_DELETE_SESSIONS);
+	bulk.msg.header.id = 0;
+	bulk.msg.header.length = htons(msglen);
+
+	lids->count = htonl(bdc->del_count);
+	for (i = 0; i < bdc->del_count; i++)
+		lids->lids[i] = htonl(bdc->del_lids[i]);
+	bdc->del_count = 0;
+
+	if (bfd_dplane_enqueue_flush(bdc, &bulk, msglen) == -1)
+		return -1;
+
+	bdc->out_bulk_msgs++;
+	return 0;
+}
+
+static void bfd_dplane_send_deletes_ev(struct event *t)
+{
+	bfd_dplane_send_deletes(EVENT_ARG(t));
+}
+
+/**
+ * Enqueue message in output buffer.
+ *
+ * Sessions deletions waiting to be sent in bulk go out first so the data
+ * plane sees all the changes in order.
+ *
+ * \param[in,out] bdc data plane client context.
+ * \param[in] buf the message to buffer.
+ * \param[in] buflen the amount of bytes to buffer.
+ *
+ * \returns `-1` on failure (buffer full) or `0` on success.
+ */
+static int bfd_dplane_enqueue(struct bfd_dplane_ctx *bdc, const void *buf,
+			      size_t buflen)
+{
+	if (bdc->del_count && bfd_dplane_send_deletes(bdc) == -1)
+		return -1;
+
+	return _bfd_dplane_enqueue(bdc, buf, buflen);
+}
+
 static void bfd_dplane_echo_request_handle(struct bfd_dplane_ctx *bdc,
 					   const struct bfddp_message *bm)
 {
@@ -458,6 +615,17 @@ static void bfd_dplane_echo_request_handle(struct bfd_dplane_ctx *bdc,
 	bfd_dplane_enqueue(bdc, &msg, msglen);
 }
 
+static void
+bfd_dplane_capabilities_handle(struct bfd_dplane_ctx *bdc,
+			       const struct bfddp_capabilities *caps)
+{
+	bdc->bulk = !!(ntohl(caps->flags) & CAPABILITY_BULK);
+
+	/* Send the sessions now instead of waiting any longer. */
+	EVENT_OFF(bdc->registerev);
+	bfd_dplane_register_sessions(bdc);
+}
+
 static void bfd_dplane_handle_message(struct bfddp_message *msg, void *arg)
 {
 	enum bfddp_message_type bmt;
@@ -472,18 +640,26 @@ static void bfd_dplane_handle_message(struct bfddp_message *msg, void *arg)
 	case BFD_STATE_CHANGE:
 		bfd_dplane_session_state_change(bdc, &msg->data.state);
 		break;
+	case BFD_CAPABILITIES:
+		bfd_dplane_capabilities_handle(bdc, &msg->data.capabilities);
+		break;
 	case ECHO_REPLY:
 		/* NOTHING: we don't do anything with this information. */
 		break;
 	case DP_ADD_SESSION:
 	case DP_DELETE_SESSION:
 	case DP_REQUEST_SESSION_COUNTERS:
+	case DP_ADD_SESSIONS:
+	case DP_DELETE_SESSIONS:
+	case DP_REQUEST_COUNTERS_BULK:
 		/* NOTHING: we are not supposed to receive this. */
 		break;
 	case BFD_SESSION_COUNTERS:
+	case BFD_SESSION_COUNTERS_BULK:
 		/*
-		 * NOTHING: caller of DP_REQUEST_SESSION_COUNTERS should
-		 * handle this with `bfd_dplane_expect`.
+		 * NOTHING: caller of DP_REQUEST_SESSION_COUNTERS or
+		 * DP_REQUEST_COUNTERS_BULK should handle this with
+		 * `bfd_dplane_expect`.
 		 */
 		break;
 
@@ -512,10 +688,12 @@ static int bfd_dplane_expect(struct bfd_dplane_ctx *bdc, uint16_t id,
 	ssize_t rv;
 
 	/*
-	 * Don't attempt to read if buffer is full, otherwise we'll get a
+	 * Handle what is already buffered first: the socket might have
+	 * nothing more for us (e.g. rest of a multiple message reply). This
+	 * also avoids reading with a full buffer, otherwise we'll get a
 	 * bogus 'connection closed' signal (rv == 0).
 	 */
-	if (bdc->inbuf->endp == bdc->inbuf->size)
+	if (STREAM_READABLE(bdc->inbuf))
 		goto skip_read;
 
 read_again:
@@ -541,17 +719,21 @@ read_again:
 
 	/* Account read bytes. */
 	bdc->in_bytes += (uint64_t)rv;
+
+skip_read:
 	/* Register peak buffered bytes. */
 	rlen = STREAM_READABLE(bdc->inbuf);
 	if (bdc->in_bytes_peak < rlen)
 		bdc->in_bytes_peak = rlen;
 
-skip_read:
 	while (rlen > 0) {
 		bh = (struct bfddp_message_header *)stream_pnt(bdc->inbuf);
 		/* Not enough data read. */
-		if (ntohs(bh->length) > rlen)
+		if (ntohs(bh->length) > rlen) {
+			/* Make room for the rest of (bulk) messages. */
+			stream_pulldown(bdc->inbuf);
 			goto read_again;
+		}
 
 		/* Account full message read. */
 		bdc->in_msgs++;
@@ -627,6 +809,125 @@ static void _bfd_session_register_dplane(struct hash_bucket *hb, void *arg)
 	_bfd_dplane_add_session(bdc, bs);
 }
 
+/** Sessions registration in bulk: `DP_ADD_SESSIONS` being filled. */
+struct bfd_dplane_bulk_add {
+	struct bfd_dplane_ctx *bdc;
+	/** Connection failed: `bdc` might be gone. */
+	bool failed;
+
+	struct bfd_session *bs[BFD_DPLANE_BULK_SESSIONS];
+	union {
+		struct bfddp_message msg;
+		uint8_t buf[BFD_DP_BULK_MAX_LENGTH];
+	} bulk;
+};
+
+static void bfd_dplane_bulk_add_send(struct bfd_dplane_bulk_add *bba)
+{
+	struct bfddp_sessions *sessions =
+		(struct bfddp_sessions *)&bba->bulk.msg.data;
+	uint32_t count = ntohl(sessions->count), i;
+	uint16_t msglen;
+
+	if (count == 0)
+		return;
+
+	msglen = offsetof(struct bfddp_message, data) + sizeof(*sessions) +
+		 count * sizeof(sessions->sessions[0]);
+
+	bba->bulk.msg.header.version = BFD_DP_VERSION;
+	bba->bulk.msg.header.type = htons(DP_ADD_SESSIONS);
+	bba->bulk.msg.header.length = htons(msglen);
+
+	if (!bba->failed &&
+	    bfd_dplane_enqueue_flush(bba->bdc, &bba->bulk, msglen) == 0) {
+		bba->bdc->out_bulk_msgs++;
+	} else {
+		/* Keep these sessions in software. */
+		bba->failed = true;
+		for (i = 0; i < count; i++) {
+			if (bba->bs[i]->bdc == NULL)
+				continue;
+
+			bba->bs[i]->bdc = NULL;
+			bfd_session_enable(bba->bs[i]);
+		}
+	}
+
+	sessions->count = 0;
+}
+
+static void _bfd_session_register_dplane_bulk(struct hash_bucket *hb,
+					      void *arg)
+{
+	struct bfd_session *bs = hb->data;
+	struct bfd_dplane_bulk_add *bba = arg;
+	struct bfddp_sessions *sessions =
+		(struct bfddp_sessions *)&bba->bulk.msg.data;
+	struct bfddp_message msg = {};
+	uint32_t count;
+
+	if (bs->bdc != NULL || bba->failed)
+		return;
+
+	/* Disable software session. */
+	bfd_session_disable(bs);
+
+	/* Associate session and reset previous state. */
+	bs->bdc = bba->bdc;
+	bs->remote_diag = 0;
+	bs->local_diag = 0;
+	bs->ses_state = PTM_BFD_DOWN;
+
+	_bfd_dplane_session_fill(bs, &msg);
+
+	count = ntohl(sessions->count);
+	sessions->sessions[count] = msg.data.session;
+	bba->bs[count] = bs;
+	sessions->count = htonl(++count);
+
+	if (count == BFD_DPLANE_BULK_SESSIONS)
+		bfd_dplane_bulk_add_send(bba);
+}
+
+/**
+ * Move all unattached sessions to the data plane, in bulk if the data plane
+ * supports it.
+ *
+ * \param bdc the data plane context.
+ */
+static void bfd_dplane_register_sessions(struct bfd_dplane_ctx *bdc)
+{
+	struct bfd_dplane_bulk_add *bba;
+
+	if (!bdc->bulk) {
+		bfd_key_iterate(_bfd_session_register_dplane, bdc);
+		return;
+	}
+
+	bba = XCALLOC(MTYPE_BFDD_DPLANE_CTX, sizeof(*bba));
+	bba->bdc = bdc;
+	bfd_key_iterate(_bfd_session_register_dplane_bulk, bba);
+	bfd_dplane_bulk_add_send(bba);
+	XFREE(MTYPE_BFDD_DPLANE_CTX, bba);
+}
+
+static void bfd_dplane_register_sessions_ev(struct event *t)
+{
+	bfd_dplane_register_sessions(EVENT_ARG(t));
+}
+
+/**
+ * Register the sessions once the data plane told us its capabilities, or
+ * after a while for data planes that don't.
+ */
+static void bfd_dplane_register_schedule(struct bfd_dplane_ctx *bdc)
+{
+	bdc->bulk = false;
+	event_add_timer(master, bfd_dplane_register_sessions_ev, bdc,
+			BFD_DPLANE_CAPABILITIES_WAIT, &bdc->registerev);
+}
+
 static struct bfd_dplane_ctx *bfd_dplane_ctx_new(int sock)
 {
 	struct bfd_dplane_ctx *bdc;
@@ -644,7 +945,7 @@ static struct bfd_dplane_ctx *bfd_dplane_ctx_new(int sock)
 	event_add_read(master, bfd_dplane_read, bdc, sock, &bdc->inbufev);
 
 	/* Register all unattached sessions. */
-	bfd_key_iterate(_bfd_session_register_dplane, bdc);
+	bfd_dplane_register_schedule(bdc);
 
 	return bdc;
 }
@@ -682,6 +983,9 @@ static void bfd_dplane_ctx_free(struct bfd_dplane_ctx *bdc)
 		socket_close(&bdc->sock);
 		EVENT_OFF(bdc->inbufev);
 		EVENT_OFF(bdc->outbufev);
+		EVENT_OFF(bdc->registerev);
+		EVENT_OFF(bdc->deleteev);
+		bdc->del_count = 0;
 		event_add_timer(master, bfd_dplane_client_connect, bdc, 3,
 				&bdc->connectev);
 		return;
@@ -701,6 +1005,8 @@ free_resources:
 	stream_free(bdc->outbuf);
 	EVENT_OFF(bdc->inbufev);
 	EVENT_OFF(bdc->outbufev);
+	EVENT_OFF(bdc->registerev);
+	EVENT_OFF(bdc->deleteev);
 	XFREE(MTYPE_BFDD_DPLANE_CTX, bdc);
 }
 
@@ -770,19 +1076,105 @@ static int _bfd_dplane_add_session(struct bfd_dplane_ctx *bdc,
 	return rv;
 }
 
+static void
+bfd_dplane_session_counters_set(struct bfd_session *bs,
+				const struct bfddp_session_counters *counters)
+{
+	bs->stats.rx_ctrl_pkt = be64toh(counters->control_input_packets);
+	bs->stats.tx_ctrl_pkt = be64toh(counters->control_output_packets);
+	bs->stats.rx_echo_pkt = be64toh(counters->echo_input_packets);
+	bs->stats.tx_echo_pkt = be64toh(counters->echo_output_packets);
+}
+
 static void _bfd_dplane_update_session_counters(struct bfddp_message *msg,
 						void *arg)
 {
 	struct bfd_session *bs = arg;
 
-	bs->stats.rx_ctrl_pkt =
-		be64toh(msg->data.session_counters.control_input_packets);
-	bs->stats.tx_ctrl_pkt =
-		be64toh(msg->data.session_counters.control_output_packets);
-	bs->stats.rx_echo_pkt =
-		be64toh(msg->data.session_counters.echo_input_packets);
-	bs->stats.tx_echo_pkt =
-		be64toh(msg->data.session_counters.echo_output_bytes);
+	bfd_dplane_session_counters_set(bs, &msg->data.session_counters);
+}
+
+/** Bulk counters reply being received. */
+struct bfd_dplane_counters_bulk {
+	struct bfd_dplane_ctx *bdc;
+	/** Got the last message of the reply. */
+	bool done;
+};
+
+static void _bfd_dplane_update_counters_bulk(struct bfddp_message *msg,
+					     void *arg)
+{
+	const struct bfddp_session_counters_bulk *bulk =
+		(const void *)&msg->data;
+	struct bfd_dplane_counters_bulk *bdcb = arg;
+	struct bfd_session *bs;
+	size_t count, max;
+	size_t i;
+
+	/* Not a reply we understand: don't wait for more. */
+	if (ntohs(msg->header.type) != BFD_SESSION_COUNTERS_BULK ||
+	    ntohs(msg->header.length) <
+		    offsetof(struct bfddp_message, data) + sizeof(*bulk)) {
+		bdcb->done = true;
+		return;
+	}
+
+	max = (ntohs(msg->header.length) - offsetof(struct bfddp_message, data) -
+	       sizeof(*bulk)) /
+	      sizeof(bulk->counters[0]);
+	count = MIN(ntohl(bulk->count), max);
+
+	for (i = 0; i < count; i++) {
+		bs = bfd_id_lookup(ntohl(bulk->counters[i].lid));
+		if (bs == NULL || bs->bdc != bdcb->bdc)
+			continue;
+
+		bfd_dplane_session_counters_set(bs, &bulk->counters[i]);
+	}
+
+	if (ntohl(bulk->flags) & COUNTERS_BULK_LAST)
+		bdcb->done = true;
+}
+
+/**
+ * Ask data plane for all its sessions counters and wait for the reply.
+ *
+ * \param bdc the data plane context.
+ *
+ * \returns `0` on success otherwise `-1` (`bdc` might be gone).
+ */
+static int bfd_dplane_update_counters_bulk(struct bfd_dplane_ctx *bdc)
+{
+	struct bfd_dplane_counters_bulk bdcb = { .bdc = bdc };
+	struct bfddp_message msg = {};
+	struct bfddp_lids *lids = (struct bfddp_lids *)&msg.data;
+	uint16_t msglen = offsetof(struct bfddp_message, data) + sizeof(*lids);
+	uint16_t id;
+	int rv;
+
+	id = bfd_dplane_next_id(bdc);
+	msg.header.version = BFD_DP_VERSION;
+	msg.header.type = htons(DP_REQUEST_COUNTERS_BULK);
+	msg.header.id = htons(id);
+	msg.header.length = htons(msglen);
+
+	/* Empty list: all sessions. */
+	lids->count = 0;
+
+	if (bfd_dplane_enqueue_flush(bdc, &msg, msglen) == -1)
+		return -1;
+
+	bdc->out_bulk_msgs++;
+	if (bfd_dplane_flush(bdc) == -1)
+		return -1;
+
+	/* The reply might come in multiple messages. */
+	do {
+		rv = bfd_dplane_expect(bdc, id,
+				       _bfd_dplane_update_counters_bulk, &bdcb);
+	} while (rv == -2 || (rv == 0 && !bdcb.done));
+
+	return rv;
 }
 
 /**
@@ -860,7 +1252,7 @@ static void _bfd_dplane_client_bootstrap(struct bfd_dplane_ctx *bdc)
 
 	/* Remove all sessions then register again to send them all. */
 	bfd_key_iterate(_bfd_session_unregister_dplane, bdc);
-	bfd_key_iterate(_bfd_session_register_dplane, bdc);
+	bfd_dplane_register_schedule(bdc);
 }
 
 static bool bfd_dplane_client_connecting(struct bfd_dplane_ctx *bdc)
@@ -1106,6 +1498,20 @@ int bfd_dplane_delete_session(struct bfd_session *bs)
 	if (bs->bdc == NULL)
 		return 0;
 
+	/* Batch deletions, they are sent together after this event. */
+	if (bs->bdc->bulk) {
+		struct bfd_dplane_ctx *bdc = bs->bdc;
+
+		bs->bdc = NULL;
+		bdc->del_lids[bdc->del_count++] = bs->discrs.my_discr;
+		if (bdc->del_count == BFD_DPLANE_BULK_LIDS)
+			return bfd_dplane_send_deletes(bdc);
+
+		event_add_event(master, bfd_dplane_send_deletes_ev, bdc, 0,
+				&bdc->deleteev);
+		return 0;
+	}
+
 	/* Fill most of the common fields. */
 	_bfd_dplane_session_fill(bs, &msg);
 
@@ -1143,6 +1549,9 @@ void bfd_dplane_show_counters(struct vty *vty)
 		SHOW_COUNTER("Output bytes peak", bdc->out_bytes_peak, PRIu64);
 		SHOW_COUNTER("Output messages", bdc->out_msgs, PRIu64);
 		SHOW_COUNTER("Output full events", bdc->out_fullev, PRIu64);
+		SHOW_COUNTER("Output bulk messages", bdc->out_bulk_msgs,
+			     PRIu64);
+		SHOW_COUNTER("Bulk support", bdc->bulk ? "yes" : "no", "s");
 		SHOW_COUNTER("Output current usage",
 			     STREAM_READABLE(bdc->inbuf), "zu");
 		vty_out(vty, "\n");
@@ -1150,6 +1559,38 @@ void bfd_dplane_show_counters(struct vty *vty)
 #undef SHOW_COUNTER
 }
 
+static void _bfd_dplane_update_counters(struct hash_bucket *hb, void *arg)
+{
+	struct bfd_session *bs = hb->data;
+
+	if (bs->bdc != arg)
+		return;
+
+	if (bfd_dplane_update_session_counters(bs) == -1)
+		zlog_debug("%s: failed to update BFD session counters (%s)",
+			   __func__, bs_to_string(bs));
+}
+
+void bfd_dplane_update_counters(void)
+{
+	struct bfd_dplane_ctx *bdc, *bdcn;
+
+	TAILQ_FOREACH_SAFE (bdc, &bglobal.bg_dplaneq, entry, bdcn) {
+		if (bdc->sock == -1)
+			continue;
+
+		/* Older data planes: one request per session. */
+		if (!bdc->bulk) {
+			bfd_id_iterate(_bfd_dplane_update_counters, bdc);
+			continue;
+		}
+
+		if (bfd_dplane_update_counters_bulk(bdc) == -1)
+			zlog_debug("%s: bulk counters request failed",
+				   __func__);
+	}
+}
+
 int bfd_dplane_update_session_counters(struct bfd_session *bs)
 {
 	uint16_t id;
@@ -24,7 +24,12 @@ void tv_normalize(struct timeval *tv)
 
 void bfd_recvtimer_update(struct bfd_session *bs)
 {
-	struct timeval tv = {.tv_sec = 0, .tv_usec = bs->detect_TO};
+	bfd_recvtimer_update_in(bs, bs->detect_TO);
+}
+
+void bfd_recvtimer_update_in(struct bfd_session *bs, uint64_t timeout)
+{
+	struct timeval tv = {.tv_sec = 0, .tv_usec = timeout};
 
 	/* Remove previous schedule if any. */
 	bfd_recvtimer_delete(bs);
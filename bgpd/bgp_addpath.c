@@ -168,6 +168,87 @@ bool bgp_addpath_tx_path(enum bgp_addpath_strat strat, struct bgp_path_info *pi)
 	assert(!"Reached end of function we should never hit");
 }
 
+/*
+ * Collect the paths of a dest that can be sent with addpath and note which
+ * of them each strategy sends, using the same rules as
+ * bgp_addpath_tx_path().  Returns false if the dest has more paths than
+ * the set holds; the caller then has to look at each path on its own.
+ */
+bool bgp_addpath_tx_set_build(struct bgp_addpath_tx_set *set,
+			      struct bgp_dest *dest)
+{
+	struct bgp_path_info *pi;
+	uint64_t bit;
+	int i;
+
+	memset(set, 0, offsetof(struct bgp_addpath_tx_set, paths));
+
+	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next) {
+		if (!CHECK_FLAG(pi->flags, BGP_PATH_VALID)
+		    || CHECK_FLAG(pi->flags, BGP_PATH_HISTORY)
+		    || CHECK_FLAG(pi->flags, BGP_PATH_REMOVED))
+			continue;
+
+		if (set->count == BGP_ADDPATH_TX_SET_MAX)
+			return false;
+
+		bit = 1ULL << set->count;
+		if (CHECK_FLAG(pi->flags, BGP_PATH_SELECTED))
+			set->selected |= bit;
+		for (i = 0; i < BGP_ADDPATH_MAX; i++)
+			if (bgp_addpath_tx_path(i, pi))
+				set->mask[i] |= bit;
+
+		set->paths[set->count++] = pi;
+	}
+
+	return true;
+}
+
+/*
+ * The paths of the set a peer gets: the bestpath and what its addpath
+ * strategy adds.  Labeled unicast shares the unicast table, so the unicast
+ * strategy applies as well (see bgp_addpath_capable()).
+ */
+uint64_t bgp_addpath_tx_set_mask(const struct bgp_addpath_tx_set *set,
+				 struct peer *peer, afi_t afi, safi_t safi)
+{
+	uint64_t mask = set->selected;
+	enum bgp_addpath_strat strat;
+
+	strat = peer->addpath_type[afi][safi];
+	if (strat < BGP_ADDPATH_MAX)
+		mask |= set->mask[strat];
+
+	if (safi == SAFI_LABELED_UNICAST) {
+		strat = peer->addpath_type[afi][SAFI_UNICAST];
+		if (strat < BGP_ADDPATH_MAX)
+			mask |= set->mask[strat];
+	}
+
+	return mask;
+}
+
+/*
+ * Is the path with this TX ID (as the peer sees it) one of the paths in
+ * mask?
+ */
+bool bgp_addpath_tx_set_has_id(const struct bgp_addpath_tx_set *set,
+			       uint64_t mask, struct peer *peer, afi_t afi,
+			       safi_t safi, uint32_t addpath_tx_id)
+{
+	unsigned int i;
+
+	for (i = 0; i < set->count; i++)
+		if ((mask & (1ULL << i))
+		    && bgp_addpath_id_for_peer(peer, afi, safi,
+					       &set->paths[i]->tx_addpath)
+			       == addpath_tx_id)
+			return true;
+
+	return false;
+}
+
 static void bgp_addpath_flush_type_rn(struct bgp *bgp, afi_t afi, safi_t safi,
 				      enum bgp_addpath_strat addpath_type,
 				      struct bgp_dest *dest)
@@ -46,6 +46,15 @@ bool bgp_addpath_dmed_required(int strategy);
  */
 bool bgp_addpath_tx_path(enum bgp_addpath_strat strat,
 			 struct bgp_path_info *pi);
+
+bool bgp_addpath_tx_set_build(struct bgp_addpath_tx_set *set,
+			      struct bgp_dest *dest);
+uint64_t bgp_addpath_tx_set_mask(const struct bgp_addpath_tx_set *set,
+				 struct peer *peer, afi_t afi, safi_t safi);
+bool bgp_addpath_tx_set_has_id(const struct bgp_addpath_tx_set *set,
+			       uint64_t mask, struct peer *peer, afi_t afi,
+			       safi_t safi, uint32_t addpath_tx_id);
+
 /*
  * Change the type of addpath used for a peer.
  */
@@ -31,6 +31,21 @@ struct bgp_addpath_info_data {
 	uint32_t addpath_tx_id[BGP_ADDPATH_MAX];
 };
 
+/*
+ * The paths of one dest addpath TX may send, worked out once per dest for
+ * all update groups by bgp_addpath_tx_set_build().  Bit i of mask[strat]
+ * is set if paths[i] is sent with that strategy, bit i of selected if it
+ * is the bestpath (which every strategy sends).
+ */
+#define BGP_ADDPATH_TX_SET_MAX 64
+
+struct bgp_addpath_tx_set {
+	unsigned int count;
+	uint64_t selected;
+	uint64_t mask[BGP_ADDPATH_MAX];
+	struct bgp_path_info *paths[BGP_ADDPATH_TX_SET_MAX];
+};
+
 struct bgp_addpath_strategy_names {
 	const char *config_name;
 	const char *human_name;	       /* path detail non-json */
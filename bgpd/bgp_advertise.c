@@ -25,6 +25,8 @@
 #include "bgpd/bgp_mplsvpn.h"
 #include "bgpd/bgp_updgrp.h"
 
+DEFINE_MSLAB_STATIC(BGP_ADJ_IN, sizeof(struct bgp_adj_in));
+
 /* BGP advertise attribute is used for pack same attribute update into
    one packet.  To do that we maintain attribute hash in struct
    peer.  */
@@ -36,6 +38,7 @@ struct bgp_advertise_attr *bgp_advertise_attr_new(void)
 
 void bgp_advertise_attr_free(struct bgp_advertise_attr *baa)
 {
+	bgp_adv_attr_enc_free(&baa->enc);
 	XFREE(MTYPE_BGP_ADVERTISE_ATTR, baa);
 }
 
@@ -165,36 +168,68 @@ bool bgp_adj_out_lookup(struct peer *peer, struct bgp_dest *dest,
 }
 
 
-void bgp_adj_in_set(struct bgp_dest *dest, struct peer *peer, struct attr *attr,
-		    uint32_t addpath_id)
+struct bgp_adj_in *bgp_adj_in_lookup(struct bgp_dest *dest,
+				     struct peer *peer, uint32_t addpath_id)
 {
 	struct bgp_adj_in *adj;
 
-	for (adj = dest->adj_in; adj; adj = adj->next) {
-		if (adj->peer == peer && adj->addpath_rx_id == addpath_id) {
-			if (adj->attr != attr) {
-				bgp_attr_unintern(&adj->attr);
-				adj->attr = bgp_attr_intern(attr);
-			}
-			return;
+	for (adj = dest->adj_in; adj; adj = adj->next)
+		if (adj->peer == peer && adj->addpath_rx_id == addpath_id)
+			return adj;
+	return NULL;
+}
+
+struct bgp_adj_in *bgp_adj_in_set(struct bgp_dest *dest, struct peer *peer,
+				  struct attr *attr, uint32_t addpath_id)
+{
+	struct bgp_table *table = bgp_dest_table(dest);
+	struct bgp_adj_in *adj;
+
+	adj = bgp_adj_in_lookup(dest, peer, addpath_id);
+	if (adj) {
+		if (adj->attr != attr) {
+			bgp_attr_unintern(&adj->attr);
+			adj->attr = bgp_attr_intern(attr);
 		}
+		return adj;
 	}
-	adj = XCALLOC(MTYPE_BGP_ADJ_IN, sizeof(struct bgp_adj_in));
+	adj = XSLAB_CALLOC(MSLAB_BGP_ADJ_IN);
 	adj->peer = peer_lock(peer); /* adj_in peer reference */
 	adj->attr = bgp_attr_intern(attr);
 	adj->uptime = monotime(NULL);
 	adj->addpath_rx_id = addpath_id;
+	adj->dest = dest;
 	BGP_ADJ_IN_ADD(dest, adj);
+	bgp_peer_adj_in_add_tail(&peer->adj_in[table->afi][table->safi], adj);
 	bgp_dest_lock_node(dest);
+	return adj;
+}
+
+void bgp_adj_in_set_filtered(struct bgp_adj_in *bai, bool filtered)
+{
+	struct bgp_table *table = bgp_dest_table(bai->dest);
+
+	if (bai->filtered == filtered)
+		return;
+
+	bai->filtered = filtered;
+	if (filtered)
+		bai->peer->filtered_pcount[table->afi][table->safi]++;
+	else
+		bai->peer->filtered_pcount[table->afi][table->safi]--;
 }
 
 void bgp_adj_in_remove(struct bgp_dest *dest, struct bgp_adj_in *bai)
 {
+	struct bgp_table *table = bgp_dest_table(dest);
+
+	bgp_adj_in_set_filtered(bai, false);
 	bgp_attr_unintern(&bai->attr);
 	BGP_ADJ_IN_DEL(dest, bai);
+	bgp_peer_adj_in_del(&bai->peer->adj_in[table->afi][table->safi], bai);
 	bgp_dest_unlock_node(dest);
 	peer_unlock(bai->peer); /* adj_in peer reference */
-	XFREE(MTYPE_BGP_ADJ_IN, bai);
+	XSLAB_FREE(MSLAB_BGP_ADJ_IN, bai);
 }
 
 bool bgp_adj_in_unset(struct bgp_dest *dest, struct peer *peer,
@@ -220,6 +255,48 @@ bool bgp_adj_in_unset(struct bgp_dest *dest, struct peer *peer,
 	return true;
 }
 
+/* Next entry for peer, or for any peer if NULL.  Not safe against
+ * bgp_update() for the entry, see bgp_soft_reconfig_dest() for that.
+ */
+bool bgp_adj_in_iter_next(struct bgp_dest *dest, const struct peer *peer,
+			  struct bgp_adj_in_iter *iter)
+{
+	if (!iter->paths) {
+		iter->ain = iter->ain ? iter->ain->next : dest->adj_in;
+		for (; iter->ain; iter->ain = iter->ain->next) {
+			if (peer && iter->ain->peer != peer)
+				continue;
+
+			iter->peer = iter->ain->peer;
+			iter->attr = iter->ain->attr;
+			iter->uptime = iter->ain->uptime;
+			iter->addpath_rx_id = iter->ain->addpath_rx_id;
+			iter->filtered = iter->ain->filtered;
+			return true;
+		}
+		iter->paths = true;
+	}
+
+	iter->pi = iter->pi ? iter->pi->next : bgp_dest_get_bgp_path_info(dest);
+	for (; iter->pi; iter->pi = iter->pi->next) {
+		if (peer && iter->pi->peer != peer)
+			continue;
+		if (!bgp_path_adj_in_shared(iter->pi))
+			continue;
+
+		iter->peer = iter->pi->peer;
+		iter->attr = iter->pi->attr;
+		iter->uptime = iter->pi->uptime;
+		iter->addpath_rx_id = iter->pi->addpath_rx_id;
+		iter->filtered = false;
+		return true;
+	}
+
+	iter->peer = NULL;
+	iter->attr = NULL;
+	return false;
+}
+
 void bgp_sync_init(struct peer *peer)
 {
 	afi_t afi;
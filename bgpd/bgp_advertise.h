@@ -9,8 +9,10 @@
 #include "lib/typesafe.h"
 
 PREDECL_DLIST(bgp_adv_fifo);
+PREDECL_DLIST(bgp_peer_adj_in);
 
 struct update_subgroup;
+struct bgp_adv_attr_enc;
 
 /* BGP advertise attribute.  */
 struct bgp_advertise_attr {
@@ -22,6 +24,12 @@ struct bgp_advertise_attr {
 
 	/* Attribute pointer to be announced.  */
 	struct attr *attr;
+
+	/* Cached wire encoding of attr for the owning subgroup, built by
+	 * subgroup_update_packet() and reused for every further UPDATE
+	 * carrying this attribute.
+	 */
+	struct bgp_adv_attr_enc *enc;
 };
 
 struct bgp_advertise {
@@ -61,14 +69,17 @@ struct bgp_adj_out {
 	/* Prefix information.  */
 	struct bgp_dest *dest;
 
-	uint32_t addpath_tx_id;
-
 	/* Advertised attribute.  */
 	struct attr *attr;
 
 	/* Advertisement information.  */
 	struct bgp_advertise *adv;
 
+	/* Kept next to each other to avoid padding, there is one of these
+	 * per (dest, subgroup, addpath id) so every byte counts.
+	 */
+	uint32_t addpath_tx_id;
+
 	/* Attribute hash */
 	uint32_t attr_hash;
 };
@@ -86,6 +97,10 @@ struct bgp_adj_in {
 	/* Received peer.  */
 	struct peer *peer;
 
+	/* For peer->adj_in */
+	struct bgp_peer_adj_in_item peer_item;
+	struct bgp_dest *dest;
+
 	/* Received attribute.  */
 	struct attr *attr;
 
@@ -94,6 +109,30 @@ struct bgp_adj_in {
 
 	/* Addpath identifier */
 	uint32_t addpath_rx_id;
+
+	/* Denied when last run through bgp_update(), counted in
+	 * peer->filtered_pcount
+	 */
+	bool filtered;
+};
+
+DECLARE_DLIST(bgp_peer_adj_in, struct bgp_adj_in, peer_item);
+
+/* What a peer sent, as kept for soft reconfiguration inbound: either an
+ * Adj-RIB-In entry or a path standing in for it (BGP_PATH_ADJ_IN_SHARED).
+ * Zero-initialise and pass to bgp_adj_in_iter_next() to walk a dest.
+ */
+struct bgp_adj_in_iter {
+	struct peer *peer;
+	struct attr *attr;
+	time_t uptime;
+	uint32_t addpath_rx_id;
+	bool filtered;
+
+	/* position */
+	struct bgp_adj_in *ain;
+	struct bgp_path_info *pi;
+	bool paths;
 };
 
 /* BGP advertisement list.  */
@@ -129,11 +168,19 @@ struct bgp_synchronize {
 /* Prototypes.  */
 extern bool bgp_adj_out_lookup(struct peer *peer, struct bgp_dest *dest,
 			       uint32_t addpath_tx_id);
-extern void bgp_adj_in_set(struct bgp_dest *dest, struct peer *peer,
-			   struct attr *attr, uint32_t addpath_id);
+extern struct bgp_adj_in *bgp_adj_in_set(struct bgp_dest *dest,
+					 struct peer *peer, struct attr *attr,
+					 uint32_t addpath_id);
+extern struct bgp_adj_in *bgp_adj_in_lookup(struct bgp_dest *dest,
+					    struct peer *peer,
+					    uint32_t addpath_id);
 extern bool bgp_adj_in_unset(struct bgp_dest *dest, struct peer *peer,
 			     uint32_t addpath_id);
 extern void bgp_adj_in_remove(struct bgp_dest *dest, struct bgp_adj_in *bai);
+extern void bgp_adj_in_set_filtered(struct bgp_adj_in *bai, bool filtered);
+extern bool bgp_adj_in_iter_next(struct bgp_dest *dest,
+				 const struct peer *peer,
+				 struct bgp_adj_in_iter *iter);
 
 extern void bgp_sync_init(struct peer *peer);
 extern void bgp_sync_delete(struct peer *peer);
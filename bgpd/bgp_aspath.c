@@ -21,6 +21,7 @@
 #include "bgpd/bgp_debug.h"
 #include "bgpd/bgp_attr.h"
 #include "bgpd/bgp_errors.h"
+#include "bgpd/bgp_intern.h"
 
 /* Attr. Flags and Attr. Type Code. */
 #define AS_HEADER_SIZE 2
@@ -70,8 +71,19 @@ struct assegment_header {
 	uint8_t length;
 };
 
-/* Hash for aspath.  This is the top level structure of AS path. */
-static struct hash *ashash;
+/* Hash for aspath.  This is the top level structure of AS path.
+ * Sharded, see bgp_intern.h.
+ */
+static struct bgp_intern_table ashash;
+
+/* last aspath memo_id handed out */
+static atomic_uint_fast64_t aspath_memo_id;
+
+static inline uint64_t aspath_memo_id_next(void)
+{
+	return atomic_fetch_add_explicit(&aspath_memo_id, 1,
+					 memory_order_relaxed) + 1;
+}
 
 /* Stream for SNMP. See aspath_snmp_pathseg */
 static struct stream *snmp_stream;
@@ -316,6 +328,7 @@ void aspath_free(struct aspath *aspath)
 /* Unintern aspath from AS path bucket. */
 void aspath_unintern(struct aspath **aspath)
 {
+	struct bgp_intern_shard *shard;
 	struct aspath *ret;
 	struct aspath *asp;
 
@@ -324,15 +337,18 @@ void aspath_unintern(struct aspath **aspath)
 
 	asp = *aspath;
 
-	if (asp->refcnt)
-		asp->refcnt--;
-
-	if (asp->refcnt == 0) {
-		/* This aspath must exist in aspath hash table. */
-		ret = hash_release(ashash, asp);
-		assert(ret != NULL);
-		aspath_free(asp);
-		*aspath = NULL;
+	shard = bgp_intern_shard(&ashash, asp);
+	frr_with_mutex (&shard->mtx) {
+		if (asp->refcnt)
+			asp->refcnt--;
+
+		if (asp->refcnt == 0) {
+			/* This aspath must exist in aspath hash table. */
+			ret = hash_release(shard->hash, asp);
+			assert(ret != NULL);
+			aspath_free(asp);
+			*aspath = NULL;
+		}
 	}
 }
 
@@ -658,23 +674,35 @@ void aspath_str_update(struct aspath *as, bool make_json)
 	aspath_make_str_count(as, make_json);
 }
 
-/* Intern allocated AS path. */
+/* Intern allocated AS path.  If aspath already is interned, this just
+   takes another reference. */
 struct aspath *aspath_intern(struct aspath *aspath)
 {
+	struct bgp_intern_shard *shard;
 	struct aspath *find;
 
-	/* Assert this AS path structure is not interned and has the string
-	   representation built. */
-	assert(aspath->refcnt == 0);
+	/* Assert this AS path structure has the string representation
+	   built. */
 	assert(aspath->str);
 
-	/* Check AS path hash. */
-	find = hash_get(ashash, aspath, hash_alloc_intern);
+	shard = bgp_intern_shard(&ashash, aspath);
+	frr_with_mutex (&shard->mtx) {
+		if (aspath->refcnt)
+			find = aspath;
+		else {
+			/* Check AS path hash. */
+			find = bgp_intern_shard_get(shard, aspath,
+						    hash_alloc_intern);
+			if (find == aspath)
+				find->memo_id = aspath_memo_id_next();
+		}
+
+		find->refcnt++;
+	}
+
 	if (find != aspath)
 		aspath_free(aspath);
 
-	find->refcnt++;
-
 	return find;
 }
 
@@ -725,6 +753,7 @@ static void *aspath_hash_alloc(void *arg)
 	new->str_len = aspath->str_len;
 	new->json = aspath->json;
 	new->asnotation = aspath->asnotation;
+	new->memo_id = aspath_memo_id_next();
 
 	return new;
 }
@@ -835,8 +864,10 @@ static int assegments_parse(struct stream *s, size_t length,
 struct aspath *aspath_parse(struct stream *s, size_t length, int use32bit,
 			    enum asnotation_mode asnotation)
 {
+	struct bgp_intern_shard *shard;
 	struct aspath as;
 	struct aspath *find;
+	bool hit;
 
 	/* If length is odd it's malformed AS path. */
 	/* Nit-picking: if (use32bit == 0) it is malformed if odd,
@@ -853,10 +884,15 @@ struct aspath *aspath_parse(struct stream *s, size_t length, int use32bit,
 		return NULL;
 
 	/* If already same aspath exist then return it. */
-	find = hash_get(ashash, &as, aspath_hash_alloc);
+	shard = bgp_intern_shard(&ashash, &as);
+	frr_with_mutex (&shard->mtx) {
+		find = bgp_intern_shard_get(shard, &as, aspath_hash_alloc);
+		hit = find->refcnt != 0;
+		find->refcnt++;
+	}
 
 	/* if the aspath was already hashed free temporary memory. */
-	if (find->refcnt) {
+	if (hit) {
 		assegment_free_all(as.segments);
 		/* aspath_key_make() always updates the string */
 		XFREE(MTYPE_AS_STR, as.str);
@@ -866,8 +902,6 @@ struct aspath *aspath_parse(struct stream *s, size_t length, int use32bit,
 		}
 	}
 
-	find->refcnt++;
-
 	return find;
 }
 
@@ -1905,7 +1939,7 @@ struct aspath *aspath_empty_get(void)
 
 unsigned long aspath_count(void)
 {
-	return ashash->count;
+	return bgp_intern_table_count(&ashash);
 }
 
 /*
@@ -2089,13 +2123,13 @@ bool aspath_cmp(const void *arg1, const void *arg2)
 /* AS path hash initialize. */
 void aspath_init(void)
 {
-	ashash = hash_create_size(32768, aspath_key_make, aspath_cmp,
-				  "BGP AS Path");
+	bgp_intern_table_init(&ashash, 32768 / BGP_INTERN_SHARDS,
+			      aspath_key_make, aspath_cmp, "BGP AS Path", 0);
 }
 
 void aspath_finish(void)
 {
-	hash_clean_and_free(&ashash, (void (*)(void *))aspath_free);
+	bgp_intern_table_finish(&ashash, (void (*)(void *))aspath_free);
 
 	if (snmp_stream)
 		stream_free(snmp_stream);
@@ -2131,9 +2165,10 @@ static void aspath_show_all_iterator(struct hash_bucket *bucket,
    `show [ip] bgp paths' command. */
 void aspath_print_all_vty(struct vty *vty)
 {
-	hash_iterate(ashash, (void (*)(struct hash_bucket *,
-				       void *))aspath_show_all_iterator,
-		     vty);
+	bgp_intern_table_iterate(&ashash,
+				 (void (*)(struct hash_bucket *,
+					   void *))aspath_show_all_iterator,
+				 vty);
 }
 
 static struct aspath *bgp_aggr_aspath_lookup(struct bgp_aggregate *aggregate,
@@ -2173,22 +2208,22 @@ void bgp_aggr_aspath_remove(void *arg)
 	aspath_free(aspath);
 }
 
-void bgp_compute_aggregate_aspath(struct bgp_aggregate *aggregate,
-				  struct aspath *aspath)
+static bool bgp_aggr_aspath_same(const struct aspath *as1,
+				  const struct aspath *as2)
 {
-	bgp_compute_aggregate_aspath_hash(aggregate, aspath);
-
-	bgp_compute_aggregate_aspath_val(aggregate);
-
+	if (!as1 || !as2)
+		return as1 == as2;
+	return aspath_cmp(as1, as2);
 }
 
-void bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
-				       struct aspath *aspath)
+/* Returns true if the as-path was not in the hash before. */
+static bool bgp_aggr_aspath_get(struct bgp_aggregate *aggregate,
+				struct aspath *aspath)
 {
 	struct aspath *aggr_aspath = NULL;
 
 	if ((aggregate == NULL) || (aspath == NULL))
-		return;
+		return false;
 
 	/* Create hash if not already created.
 	 */
@@ -2207,7 +2242,40 @@ void bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
 
 	/* Increment reference counter.
 	 */
-	aggr_aspath->refcnt++;
+	return aggr_aspath->refcnt++ == 0;
+}
+
+/*
+ * Add a route's as-path to the aggregate.  Routes whose as-path is already
+ * in the hash leave the aggregate's as-path alone; a new one is folded into
+ * it the same way bgp_compute_aggregate_aspath_val() folds all of them.
+ * Returns true if the aggregate's as-path changed.
+ */
+bool bgp_compute_aggregate_aspath(struct bgp_aggregate *aggregate,
+				  struct aspath *aspath)
+{
+	struct aspath *aggr_aspath;
+	bool changed;
+
+	if (!bgp_aggr_aspath_get(aggregate, aspath))
+		return false;
+
+	if (!aggregate->aspath) {
+		aggregate->aspath = aspath_dup(aspath);
+		return true;
+	}
+
+	aggr_aspath = aspath_aggregate(aggregate->aspath, aspath);
+	changed = !aspath_cmp(aggr_aspath, aggregate->aspath);
+	aspath_free(aggregate->aspath);
+	aggregate->aspath = aggr_aspath;
+	return changed;
+}
+
+void bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
+				       struct aspath *aspath)
+{
+	bgp_aggr_aspath_get(aggregate, aspath);
 }
 
 void bgp_compute_aggregate_aspath_val(struct bgp_aggregate *aggregate)
@@ -2228,16 +2296,24 @@ void bgp_compute_aggregate_aspath_val(struct bgp_aggregate *aggregate)
 	}
 }
 
-void bgp_remove_aspath_from_aggregate(struct bgp_aggregate *aggregate,
+/*
+ * Remove a route's as-path from the aggregate.  AS_PATH aggregation cannot
+ * be undone value by value (the leading AS_SEQUENCE may grow back), so when
+ * the last route with a given as-path goes away the aggregate's as-path is
+ * rebuilt from the distinct ones left in the hash.  Returns true if it
+ * changed.
+ */
+bool bgp_remove_aspath_from_aggregate(struct bgp_aggregate *aggregate,
 				      struct aspath *aspath)
 {
 	struct aspath *aggr_aspath = NULL;
 	struct aspath *ret_aspath = NULL;
+	bool changed = false;
 
 	if ((!aggregate)
 	    || (!aggregate->aspath_hash)
 	    || (!aspath))
-		return;
+		return false;
 
 	/* Look-up the aspath in the hash.
 	 */
@@ -2251,14 +2327,20 @@ void bgp_remove_aspath_from_aggregate(struct bgp_aggregate *aggregate,
 			aspath_free(ret_aspath);
 			ret_aspath = NULL;
 
-			/* Remove aggregate's old as-path.
+			/* Keep aggregate's old as-path for comparison.
 			 */
-			aspath_free(aggregate->aspath);
+			ret_aspath = aggregate->aspath;
 			aggregate->aspath = NULL;
 
 			bgp_compute_aggregate_aspath_val(aggregate);
+
+			changed = !bgp_aggr_aspath_same(ret_aspath,
+							aggregate->aspath);
+			aspath_free(ret_aspath);
 		}
 	}
+
+	return changed;
 }
 
 void bgp_remove_aspath_from_aggregate_hash(struct bgp_aggregate *aggregate,
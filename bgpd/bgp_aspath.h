@@ -60,6 +60,12 @@ struct aspath {
 
 	/* AS notation used by string expression of AS path */
 	enum asnotation_mode asnotation;
+
+	/* Unique id handed out when the aspath is interned, 0 otherwise.
+	 * Used to key as-path access-list result caches, which cannot use
+	 * the pointer as it may be reused after the aspath is freed.
+	 */
+	uint64_t memo_id;
 };
 
 #define ASPATH_STR_DEFAULT_LEN 32
@@ -132,13 +138,13 @@ extern bool aspath_has_as4(struct aspath *aspath);
 /* For SNMP BGP4PATHATTRASPATHSEGMENT, might be useful for debug */
 extern uint8_t *aspath_snmp_pathseg(struct aspath *aspath, size_t *varlen);
 
-extern void bgp_compute_aggregate_aspath(struct bgp_aggregate *aggregate,
+extern bool bgp_compute_aggregate_aspath(struct bgp_aggregate *aggregate,
 					 struct aspath *aspath);
 
 extern void bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
 					      struct aspath *aspath);
 extern void bgp_compute_aggregate_aspath_val(struct bgp_aggregate *aggregate);
-extern void bgp_remove_aspath_from_aggregate(struct bgp_aggregate *aggregate,
+extern bool bgp_remove_aspath_from_aggregate(struct bgp_aggregate *aggregate,
 					     struct aspath *aspath);
 extern void bgp_remove_aspath_from_aggregate_hash(
 						struct bgp_aggregate *aggregate,
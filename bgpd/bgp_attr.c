@@ -19,9 +19,11 @@
 #include "command.h"
 #include "srv6.h"
 #include "frrstr.h"
+#include "frr_pthread.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_intern.h"
 #include "bgpd/bgp_route.h"
 #include "bgpd/bgp_aspath.h"
 #include "bgpd/bgp_community.h"
@@ -80,7 +82,7 @@ static const struct message attr_flag_str[] = {
 	{BGP_ATTR_FLAG_EXTLEN, "Extended Length"},
 	{0}};
 
-static struct hash *cluster_hash;
+static struct bgp_intern_table cluster_hash;
 
 static void *cluster_hash_alloc(void *p)
 {
@@ -106,12 +108,17 @@ static struct cluster_list *cluster_parse(struct in_addr *pnt, int length)
 {
 	struct cluster_list tmp = {};
 	struct cluster_list *cluster;
+	struct bgp_intern_shard *shard;
 
 	tmp.length = length;
 	tmp.list = length == 0 ? NULL : pnt;
 
-	cluster = hash_get(cluster_hash, &tmp, cluster_hash_alloc);
-	cluster->refcnt++;
+	shard = bgp_intern_shard(&cluster_hash, &tmp);
+	frr_with_mutex (&shard->mtx) {
+		cluster = bgp_intern_shard_get(shard, &tmp,
+					       cluster_hash_alloc);
+		cluster->refcnt++;
+	}
 	return cluster;
 }
 
@@ -155,46 +162,62 @@ static void cluster_free(struct cluster_list *cluster)
 	XFREE(MTYPE_CLUSTER, cluster);
 }
 
+/* Get a new reference, cluster may already be interned. */
 static struct cluster_list *cluster_intern(struct cluster_list *cluster)
 {
+	struct bgp_intern_shard *shard;
 	struct cluster_list *find;
 
-	find = hash_get(cluster_hash, cluster, cluster_hash_alloc);
-	find->refcnt++;
+	shard = bgp_intern_shard(&cluster_hash, cluster);
+	frr_with_mutex (&shard->mtx) {
+		if (cluster->refcnt)
+			find = cluster;
+		else
+			find = bgp_intern_shard_get(shard, cluster,
+						    cluster_hash_alloc);
+		find->refcnt++;
+	}
 
 	return find;
 }
 
 static void cluster_unintern(struct cluster_list **cluster)
 {
-	if ((*cluster)->refcnt)
-		(*cluster)->refcnt--;
-
-	if ((*cluster)->refcnt == 0) {
-		void *p = hash_release(cluster_hash, *cluster);
-		assert(p == *cluster);
-		cluster_free(*cluster);
-		*cluster = NULL;
+	struct bgp_intern_shard *shard;
+
+	shard = bgp_intern_shard(&cluster_hash, *cluster);
+	frr_with_mutex (&shard->mtx) {
+		if ((*cluster)->refcnt)
+			(*cluster)->refcnt--;
+
+		if ((*cluster)->refcnt == 0) {
+			void *p = hash_release(shard->hash, *cluster);
+			assert(p == *cluster);
+			cluster_free(*cluster);
+			*cluster = NULL;
+		}
 	}
 }
 
 static void cluster_init(void)
 {
-	cluster_hash = hash_create(cluster_hash_key_make, cluster_hash_cmp,
-				   "BGP Cluster");
+	bgp_intern_table_init(&cluster_hash, HASH_INITIAL_SIZE,
+			      cluster_hash_key_make, cluster_hash_cmp,
+			      "BGP Cluster", 0);
 }
 
 static void cluster_finish(void)
 {
-	hash_clean_and_free(&cluster_hash, (void (*)(void *))cluster_free);
+	bgp_intern_table_finish(&cluster_hash,
+				(void (*)(void *))cluster_free);
 }
 
-static struct hash *encap_hash = NULL;
+static struct bgp_intern_table encap_hash;
 #ifdef ENABLE_BGP_VNC
-static struct hash *vnc_hash = NULL;
+static struct bgp_intern_table vnc_hash;
 #endif
-static struct hash *srv6_l3vpn_hash;
-static struct hash *srv6_vpn_hash;
+static struct bgp_intern_table srv6_l3vpn_hash;
+static struct bgp_intern_table srv6_vpn_hash;
 
 struct bgp_attr_encap_subtlv *encap_tlv_dup(struct bgp_attr_encap_subtlv *orig)
 {
@@ -308,20 +331,33 @@ typedef enum {
 #endif
 } encap_subtlv_type;
 
-static struct bgp_attr_encap_subtlv *
-encap_intern(struct bgp_attr_encap_subtlv *encap, encap_subtlv_type type)
+static struct bgp_intern_table *encap_table(encap_subtlv_type type)
 {
-	struct bgp_attr_encap_subtlv *find;
-	struct hash *hash = encap_hash;
 #ifdef ENABLE_BGP_VNC
 	if (type == VNC_SUBTLV_TYPE)
-		hash = vnc_hash;
+		return &vnc_hash;
 #endif
+	return &encap_hash;
+}
 
-	find = hash_get(hash, encap, encap_hash_alloc);
+/* Get a new reference, encap may already be interned. */
+static struct bgp_attr_encap_subtlv *
+encap_intern(struct bgp_attr_encap_subtlv *encap, encap_subtlv_type type)
+{
+	struct bgp_intern_shard *shard;
+	struct bgp_attr_encap_subtlv *find;
+
+	shard = bgp_intern_shard(encap_table(type), encap);
+	frr_with_mutex (&shard->mtx) {
+		if (encap->refcnt)
+			find = encap;
+		else
+			find = bgp_intern_shard_get(shard, encap,
+						    encap_hash_alloc);
+		find->refcnt++;
+	}
 	if (find != encap)
 		encap_free(encap);
-	find->refcnt++;
 
 	return find;
 }
@@ -330,18 +366,18 @@ static void encap_unintern(struct bgp_attr_encap_subtlv **encapp,
 			   encap_subtlv_type type)
 {
 	struct bgp_attr_encap_subtlv *encap = *encapp;
-	if (encap->refcnt)
-		encap->refcnt--;
+	struct bgp_intern_shard *shard;
 
-	if (encap->refcnt == 0) {
-		struct hash *hash = encap_hash;
-#ifdef ENABLE_BGP_VNC
-		if (type == VNC_SUBTLV_TYPE)
-			hash = vnc_hash;
-#endif
-		hash_release(hash, encap);
-		encap_free(encap);
-		*encapp = NULL;
+	shard = bgp_intern_shard(encap_table(type), encap);
+	frr_with_mutex (&shard->mtx) {
+		if (encap->refcnt)
+			encap->refcnt--;
+
+		if (encap->refcnt == 0) {
+			hash_release(shard->hash, encap);
+			encap_free(encap);
+			*encapp = NULL;
+		}
 	}
 }
 
@@ -360,19 +396,21 @@ static bool encap_hash_cmp(const void *p1, const void *p2)
 
 static void encap_init(void)
 {
-	encap_hash = hash_create(encap_hash_key_make, encap_hash_cmp,
-				 "BGP Encap Hash");
+	bgp_intern_table_init(&encap_hash, HASH_INITIAL_SIZE,
+			      encap_hash_key_make, encap_hash_cmp,
+			      "BGP Encap Hash", 0);
 #ifdef ENABLE_BGP_VNC
-	vnc_hash = hash_create(encap_hash_key_make, encap_hash_cmp,
-			       "BGP VNC Hash");
+	bgp_intern_table_init(&vnc_hash, HASH_INITIAL_SIZE,
+			      encap_hash_key_make, encap_hash_cmp,
+			      "BGP VNC Hash", 0);
 #endif
 }
 
 static void encap_finish(void)
 {
-	hash_clean_and_free(&encap_hash, (void (*)(void *))encap_free);
+	bgp_intern_table_finish(&encap_hash, (void (*)(void *))encap_free);
 #ifdef ENABLE_BGP_VNC
-	hash_clean_and_free(&vnc_hash, (void (*)(void *))encap_free);
+	bgp_intern_table_finish(&vnc_hash, (void (*)(void *))encap_free);
 #endif
 }
 
@@ -390,7 +428,7 @@ static bool overlay_index_same(const struct attr *a1, const struct attr *a2)
 }
 
 /* Unknown transit attribute. */
-static struct hash *transit_hash;
+static struct bgp_intern_table transit_hash;
 
 static void transit_free(struct transit *transit)
 {
@@ -404,27 +442,41 @@ static void *transit_hash_alloc(void *p)
 	return p;
 }
 
+/* Get a new reference, transit may already be interned. */
 static struct transit *transit_intern(struct transit *transit)
 {
+	struct bgp_intern_shard *shard;
 	struct transit *find;
 
-	find = hash_get(transit_hash, transit, transit_hash_alloc);
+	shard = bgp_intern_shard(&transit_hash, transit);
+	frr_with_mutex (&shard->mtx) {
+		if (transit->refcnt)
+			find = transit;
+		else
+			find = bgp_intern_shard_get(shard, transit,
+						    transit_hash_alloc);
+		find->refcnt++;
+	}
 	if (find != transit)
 		transit_free(transit);
-	find->refcnt++;
 
 	return find;
 }
 
 static void transit_unintern(struct transit **transit)
 {
-	if ((*transit)->refcnt)
-		(*transit)->refcnt--;
+	struct bgp_intern_shard *shard;
+
+	shard = bgp_intern_shard(&transit_hash, *transit);
+	frr_with_mutex (&shard->mtx) {
+		if ((*transit)->refcnt)
+			(*transit)->refcnt--;
 
-	if ((*transit)->refcnt == 0) {
-		hash_release(transit_hash, *transit);
-		transit_free(*transit);
-		*transit = NULL;
+		if ((*transit)->refcnt == 0) {
+			hash_release(shard->hash, *transit);
+			transit_free(*transit);
+			*transit = NULL;
+		}
 	}
 }
 
@@ -542,29 +594,42 @@ static void srv6_l3vpn_free(struct bgp_attr_srv6_l3vpn *l3vpn)
 	XFREE(MTYPE_BGP_SRV6_L3VPN, l3vpn);
 }
 
+/* Get a new reference, l3vpn may already be interned. */
 static struct bgp_attr_srv6_l3vpn *
 srv6_l3vpn_intern(struct bgp_attr_srv6_l3vpn *l3vpn)
 {
+	struct bgp_intern_shard *shard;
 	struct bgp_attr_srv6_l3vpn *find;
 
-	find = hash_get(srv6_l3vpn_hash, l3vpn, srv6_l3vpn_hash_alloc);
+	shard = bgp_intern_shard(&srv6_l3vpn_hash, l3vpn);
+	frr_with_mutex (&shard->mtx) {
+		if (l3vpn->refcnt)
+			find = l3vpn;
+		else
+			find = bgp_intern_shard_get(shard, l3vpn,
+						    srv6_l3vpn_hash_alloc);
+		find->refcnt++;
+	}
 	if (find != l3vpn)
 		srv6_l3vpn_free(l3vpn);
-	find->refcnt++;
 	return find;
 }
 
 static void srv6_l3vpn_unintern(struct bgp_attr_srv6_l3vpn **l3vpnp)
 {
 	struct bgp_attr_srv6_l3vpn *l3vpn = *l3vpnp;
+	struct bgp_intern_shard *shard;
 
-	if (l3vpn->refcnt)
-		l3vpn->refcnt--;
+	shard = bgp_intern_shard(&srv6_l3vpn_hash, l3vpn);
+	frr_with_mutex (&shard->mtx) {
+		if (l3vpn->refcnt)
+			l3vpn->refcnt--;
 
-	if (l3vpn->refcnt == 0) {
-		hash_release(srv6_l3vpn_hash, l3vpn);
-		srv6_l3vpn_free(l3vpn);
-		*l3vpnp = NULL;
+		if (l3vpn->refcnt == 0) {
+			hash_release(shard->hash, l3vpn);
+			srv6_l3vpn_free(l3vpn);
+			*l3vpnp = NULL;
+		}
 	}
 }
 
@@ -578,28 +643,41 @@ static void srv6_vpn_free(struct bgp_attr_srv6_vpn *vpn)
 	XFREE(MTYPE_BGP_SRV6_VPN, vpn);
 }
 
+/* Get a new reference, vpn may already be interned. */
 static struct bgp_attr_srv6_vpn *srv6_vpn_intern(struct bgp_attr_srv6_vpn *vpn)
 {
+	struct bgp_intern_shard *shard;
 	struct bgp_attr_srv6_vpn *find;
 
-	find = hash_get(srv6_vpn_hash, vpn, srv6_vpn_hash_alloc);
+	shard = bgp_intern_shard(&srv6_vpn_hash, vpn);
+	frr_with_mutex (&shard->mtx) {
+		if (vpn->refcnt)
+			find = vpn;
+		else
+			find = bgp_intern_shard_get(shard, vpn,
+						    srv6_vpn_hash_alloc);
+		find->refcnt++;
+	}
 	if (find != vpn)
 		srv6_vpn_free(vpn);
-	find->refcnt++;
 	return find;
 }
 
 static void srv6_vpn_unintern(struct bgp_attr_srv6_vpn **vpnp)
 {
 	struct bgp_attr_srv6_vpn *vpn = *vpnp;
+	struct bgp_intern_shard *shard;
 
-	if (vpn->refcnt)
-		vpn->refcnt--;
+	shard = bgp_intern_shard(&srv6_vpn_hash, vpn);
+	frr_with_mutex (&shard->mtx) {
+		if (vpn->refcnt)
+			vpn->refcnt--;
 
-	if (vpn->refcnt == 0) {
-		hash_release(srv6_vpn_hash, vpn);
-		srv6_vpn_free(vpn);
-		*vpnp = NULL;
+		if (vpn->refcnt == 0) {
+			hash_release(shard->hash, vpn);
+			srv6_vpn_free(vpn);
+			*vpnp = NULL;
+		}
 	}
 }
 
@@ -647,6 +725,42 @@ static bool srv6_l3vpn_same(const struct bgp_attr_srv6_l3vpn *h1,
 		return srv6_l3vpn_hash_cmp((const void *)h1, (const void *)h2);
 }
 
+bool bgp_attr_srv6_l3vpn_same(const struct bgp_attr_srv6_l3vpn *h1,
+			      const struct bgp_attr_srv6_l3vpn *h2)
+{
+	return srv6_l3vpn_same(h1, h2);
+}
+
+struct bgp_attr_srv6_l3vpn *
+bgp_attr_srv6_l3vpn_get(const struct bgp_attr_srv6_l3vpn *l3vpn)
+{
+	struct bgp_intern_shard *shard;
+	struct bgp_attr_srv6_l3vpn *find;
+
+	shard = bgp_intern_shard(&srv6_l3vpn_hash, l3vpn);
+	frr_with_mutex (&shard->mtx) {
+		find = hash_lookup(shard->hash, (void *)l3vpn);
+		if (!find) {
+			find = XMALLOC(MTYPE_BGP_SRV6_L3VPN, sizeof(*find));
+			*find = *l3vpn;
+			find->refcnt = 0;
+			(void)hash_get(shard->hash, find,
+				       srv6_l3vpn_hash_alloc);
+		}
+		find->refcnt++;
+	}
+	return find;
+}
+
+void bgp_attr_srv6_l3vpn_put(struct bgp_attr_srv6_l3vpn **l3vpnp)
+{
+	if (!*l3vpnp)
+		return;
+
+	srv6_l3vpn_unintern(l3vpnp);
+	*l3vpnp = NULL;
+}
+
 static unsigned int srv6_vpn_hash_key_make(const void *p)
 {
 	const struct bgp_attr_srv6_vpn *vpn = p;
@@ -679,18 +793,20 @@ static bool srv6_vpn_same(const struct bgp_attr_srv6_vpn *h1,
 
 static void srv6_init(void)
 {
-	srv6_l3vpn_hash =
-		hash_create(srv6_l3vpn_hash_key_make, srv6_l3vpn_hash_cmp,
-			    "BGP Prefix-SID SRv6-L3VPN-Service-TLV");
-	srv6_vpn_hash = hash_create(srv6_vpn_hash_key_make, srv6_vpn_hash_cmp,
-				    "BGP Prefix-SID SRv6-VPN-Service-TLV");
+	bgp_intern_table_init(&srv6_l3vpn_hash, HASH_INITIAL_SIZE,
+			      srv6_l3vpn_hash_key_make, srv6_l3vpn_hash_cmp,
+			      "BGP Prefix-SID SRv6-L3VPN-Service-TLV", 0);
+	bgp_intern_table_init(&srv6_vpn_hash, HASH_INITIAL_SIZE,
+			      srv6_vpn_hash_key_make, srv6_vpn_hash_cmp,
+			      "BGP Prefix-SID SRv6-VPN-Service-TLV", 0);
 }
 
 static void srv6_finish(void)
 {
-	hash_clean_and_free(&srv6_l3vpn_hash,
-			    (void (*)(void *))srv6_l3vpn_free);
-	hash_clean_and_free(&srv6_vpn_hash, (void (*)(void *))srv6_vpn_free);
+	bgp_intern_table_finish(&srv6_l3vpn_hash,
+				(void (*)(void *))srv6_l3vpn_free);
+	bgp_intern_table_finish(&srv6_vpn_hash,
+				(void (*)(void *))srv6_vpn_free);
 }
 
 static unsigned int transit_hash_key_make(const void *p)
@@ -711,26 +827,36 @@ static bool transit_hash_cmp(const void *p1, const void *p2)
 
 static void transit_init(void)
 {
-	transit_hash = hash_create(transit_hash_key_make, transit_hash_cmp,
-				   "BGP Transit Hash");
+	bgp_intern_table_init(&transit_hash, HASH_INITIAL_SIZE,
+			      transit_hash_key_make, transit_hash_cmp,
+			      "BGP Transit Hash", 0);
 }
 
 static void transit_finish(void)
 {
-	hash_clean_and_free(&transit_hash, (void (*)(void *))transit_free);
+	bgp_intern_table_finish(&transit_hash,
+				(void (*)(void *))transit_free);
 }
 
-/* Attribute hash routines. */
-static struct hash *attrhash;
+/* Attribute hash routines.  Sharded, see bgp_intern.h. */
+static struct bgp_intern_table attrhash;
+
+/* last struct attr memo_id handed out */
+static atomic_uint_fast64_t attr_memo_id;
 
 unsigned long int attr_count(void)
 {
-	return attrhash->count;
+	return bgp_intern_table_count(&attrhash);
+}
+
+void attr_intern_stats_get(struct bgp_intern_stats *stats)
+{
+	bgp_intern_table_stats(&attrhash, stats);
 }
 
 unsigned long int attr_unknown_count(void)
 {
-	return transit_hash->count;
+	return bgp_intern_table_count(&transit_hash);
 }
 
 unsigned int attrhash_key_make(const void *p)
@@ -856,8 +982,9 @@ bool attrhash_cmp(const void *p1, const void *p2)
 
 static void attrhash_init(void)
 {
-	attrhash =
-		hash_create(attrhash_key_make, attrhash_cmp, "BGP Attributes");
+	bgp_intern_table_init(&attrhash, HASH_INITIAL_SIZE, attrhash_key_make,
+			      attrhash_cmp, "BGP Attributes",
+			      HASH_OPEN_ADDRESSING);
 }
 
 /*
@@ -870,7 +997,7 @@ static void attr_vfree(void *attr)
 
 static void attrhash_finish(void)
 {
-	hash_clean_and_free(&attrhash, attr_vfree);
+	bgp_intern_table_finish(&attrhash, attr_vfree);
 }
 
 static void attr_show_all_iterator(struct hash_bucket *bucket, struct vty *vty)
@@ -894,9 +1021,10 @@ static void attr_show_all_iterator(struct hash_bucket *bucket, struct vty *vty)
 
 void attr_show_all(struct vty *vty)
 {
-	hash_iterate(attrhash, (void (*)(struct hash_bucket *,
-					 void *))attr_show_all_iterator,
-		     vty);
+	bgp_intern_table_iterate(&attrhash,
+				 (void (*)(struct hash_bucket *,
+					   void *))attr_show_all_iterator,
+				 vty);
 }
 
 static void *bgp_attr_hash_alloc(void *p)
@@ -906,6 +1034,9 @@ static void *bgp_attr_hash_alloc(void *p)
 
 	attr = XMALLOC(MTYPE_ATTR, sizeof(struct attr));
 	*attr = *val;
+	attr->memo_id = atomic_fetch_add_explicit(&attr_memo_id, 1,
+						  memory_order_relaxed) +
+			1;
 	if (val->encap_subtlvs) {
 		val->encap_subtlvs = NULL;
 	}
@@ -924,101 +1055,59 @@ static void *bgp_attr_hash_alloc(void *p)
 /* Internet argument attribute. */
 struct attr *bgp_attr_intern(struct attr *attr)
 {
+	struct bgp_intern_shard *shard;
 	struct attr *find;
 	struct ecommunity *ecomm = NULL;
 	struct ecommunity *ipv6_ecomm = NULL;
 	struct lcommunity *lcomm = NULL;
 	struct community *comm = NULL;
 
-	/* Intern referenced structure. */
-	if (attr->aspath) {
-		if (!attr->aspath->refcnt)
-			attr->aspath = aspath_intern(attr->aspath);
-		else
-			attr->aspath->refcnt++;
-	}
+	/* Intern referenced structure.  The interns only take another
+	 * reference on structures that already are.
+	 */
+	if (attr->aspath)
+		attr->aspath = aspath_intern(attr->aspath);
 
 	comm = bgp_attr_get_community(attr);
-	if (comm) {
-		if (!comm->refcnt)
-			bgp_attr_set_community(attr, community_intern(comm));
-		else
-			comm->refcnt++;
-	}
+	if (comm)
+		bgp_attr_set_community(attr, community_intern(comm));
 
 	ecomm = bgp_attr_get_ecommunity(attr);
-	if (ecomm) {
-		if (!ecomm->refcnt)
-			bgp_attr_set_ecommunity(attr, ecommunity_intern(ecomm));
-		else
-			ecomm->refcnt++;
-	}
+	if (ecomm)
+		bgp_attr_set_ecommunity(attr, ecommunity_intern(ecomm));
 
 	ipv6_ecomm = bgp_attr_get_ipv6_ecommunity(attr);
-	if (ipv6_ecomm) {
-		if (!ipv6_ecomm->refcnt)
-			bgp_attr_set_ipv6_ecommunity(
-				attr, ecommunity_intern(ipv6_ecomm));
-		else
-			ipv6_ecomm->refcnt++;
-	}
+	if (ipv6_ecomm)
+		bgp_attr_set_ipv6_ecommunity(attr,
+					     ecommunity_intern(ipv6_ecomm));
 
 	lcomm = bgp_attr_get_lcommunity(attr);
-	if (lcomm) {
-		if (!lcomm->refcnt)
-			bgp_attr_set_lcommunity(attr, lcommunity_intern(lcomm));
-		else
-			lcomm->refcnt++;
-	}
+	if (lcomm)
+		bgp_attr_set_lcommunity(attr, lcommunity_intern(lcomm));
 
 	struct cluster_list *cluster = bgp_attr_get_cluster(attr);
 
-	if (cluster) {
-		if (!cluster->refcnt)
-			bgp_attr_set_cluster(attr, cluster_intern(cluster));
-		else
-			cluster->refcnt++;
-	}
+	if (cluster)
+		bgp_attr_set_cluster(attr, cluster_intern(cluster));
 
 	struct transit *transit = bgp_attr_get_transit(attr);
 
-	if (transit) {
-		if (!transit->refcnt)
-			bgp_attr_set_transit(attr, transit_intern(transit));
-		else
-			transit->refcnt++;
-	}
-	if (attr->encap_subtlvs) {
-		if (!attr->encap_subtlvs->refcnt)
-			attr->encap_subtlvs = encap_intern(attr->encap_subtlvs,
-							   ENCAP_SUBTLV_TYPE);
-		else
-			attr->encap_subtlvs->refcnt++;
-	}
-	if (attr->srv6_l3vpn) {
-		if (!attr->srv6_l3vpn->refcnt)
-			attr->srv6_l3vpn = srv6_l3vpn_intern(attr->srv6_l3vpn);
-		else
-			attr->srv6_l3vpn->refcnt++;
-	}
-	if (attr->srv6_vpn) {
-		if (!attr->srv6_vpn->refcnt)
-			attr->srv6_vpn = srv6_vpn_intern(attr->srv6_vpn);
-		else
-			attr->srv6_vpn->refcnt++;
-	}
+	if (transit)
+		bgp_attr_set_transit(attr, transit_intern(transit));
+	if (attr->encap_subtlvs)
+		attr->encap_subtlvs = encap_intern(attr->encap_subtlvs,
+						   ENCAP_SUBTLV_TYPE);
+	if (attr->srv6_l3vpn)
+		attr->srv6_l3vpn = srv6_l3vpn_intern(attr->srv6_l3vpn);
+	if (attr->srv6_vpn)
+		attr->srv6_vpn = srv6_vpn_intern(attr->srv6_vpn);
 #ifdef ENABLE_BGP_VNC
 	struct bgp_attr_encap_subtlv *vnc_subtlvs =
 		bgp_attr_get_vnc_subtlvs(attr);
 
-	if (vnc_subtlvs) {
-		if (!vnc_subtlvs->refcnt)
-			bgp_attr_set_vnc_subtlvs(
-				attr,
-				encap_intern(vnc_subtlvs, VNC_SUBTLV_TYPE));
-		else
-			vnc_subtlvs->refcnt++;
-	}
+	if (vnc_subtlvs)
+		bgp_attr_set_vnc_subtlvs(attr, encap_intern(vnc_subtlvs,
+							    VNC_SUBTLV_TYPE));
 #endif
 
 	/* At this point, attr only contains intern'd pointers.  that means
@@ -1027,8 +1116,11 @@ struct attr *bgp_attr_intern(struct attr *attr)
 	 * If we don't find it, we need to allocate a one because in all
 	 * cases this returns a new reference to a hashed attr, but the input
 	 * wasn't on hash. */
-	find = (struct attr *)hash_get(attrhash, attr, bgp_attr_hash_alloc);
-	find->refcnt++;
+	shard = bgp_intern_shard(&attrhash, attr);
+	frr_with_mutex (&shard->mtx) {
+		find = bgp_intern_shard_get(shard, attr, bgp_attr_hash_alloc);
+		find->refcnt++;
+	}
 
 	return find;
 }
@@ -1230,20 +1322,23 @@ void bgp_attr_unintern_sub(struct attr *attr)
 void bgp_attr_unintern(struct attr **pattr)
 {
 	struct attr *attr = *pattr;
+	struct bgp_intern_shard *shard = bgp_intern_shard(&attrhash, attr);
 	struct attr *ret;
 	struct attr tmp;
 
-	/* Decrement attribute reference. */
-	attr->refcnt--;
+	frr_with_mutex (&shard->mtx) {
+		/* Decrement attribute reference. */
+		attr->refcnt--;
 
-	tmp = *attr;
+		tmp = *attr;
 
-	/* If reference becomes zero then free attribute object. */
-	if (attr->refcnt == 0) {
-		ret = hash_release(attrhash, attr);
-		assert(ret != NULL);
-		XFREE(MTYPE_ATTR, attr);
-		*pattr = NULL;
+		/* If reference becomes zero then free attribute object. */
+		if (attr->refcnt == 0) {
+			ret = hash_release(shard->hash, attr);
+			assert(ret != NULL);
+			XFREE(MTYPE_ATTR, attr);
+			*pattr = NULL;
+		}
 	}
 
 	bgp_attr_unintern_sub(&tmp);
@@ -1316,6 +1411,31 @@ void bgp_attr_flush(struct attr *attr)
 #endif
 }
 
+/* Send the NOTIFICATION for an UPDATE error, or only record it in notify
+ * when parsing off the main pthread (see bgp_parse.c).
+ */
+static void bgp_attr_notify(struct peer *peer, struct bgp_notify *notify,
+			    uint8_t code, uint8_t subcode, uint8_t *data,
+			    size_t datalen)
+{
+	if (!notify) {
+		bgp_notify_send_with_data(peer, code, subcode, data, datalen);
+		return;
+	}
+
+	/* parsing stops at the first error, keep that one */
+	if (notify->code)
+		return;
+
+	notify->code = code;
+	notify->subcode = subcode;
+	notify->length = datalen;
+	if (datalen) {
+		notify->raw_data = XMALLOC(MTYPE_BGP_NOTIFICATION, datalen);
+		memcpy(notify->raw_data, data, datalen);
+	}
+}
+
 /* Implement draft-scudder-idr-optional-transitive behaviour and
  * avoid resetting sessions for malformed attributes which are
  * are partial/optional and hence where the error likely was not
@@ -1334,7 +1454,10 @@ bgp_attr_malformed(struct bgp_attr_parser_args *args, uint8_t subcode,
 	 */
 	uint8_t *notify_datap = (length > 0 ? args->startp : NULL);
 
-	if (bgp_debug_update(peer, NULL, NULL, 1)) {
+	/* bgp_dump_attr() builds community strings on demand, which is only
+	 * done on the main pthread
+	 */
+	if (!args->notify && bgp_debug_update(peer, NULL, NULL, 1)) {
 		char attr_str[BUFSIZ] = {0};
 
 		bgp_dump_attr(attr, attr_str, sizeof(attr_str));
@@ -1344,16 +1467,16 @@ bgp_attr_malformed(struct bgp_attr_parser_args *args, uint8_t subcode,
 
 	/* Only relax error handling for eBGP peers */
 	if (peer->sort != BGP_PEER_EBGP) {
-		bgp_notify_send_with_data(peer, BGP_NOTIFY_UPDATE_ERR, subcode,
-					  notify_datap, length);
+		bgp_attr_notify(peer, args->notify, BGP_NOTIFY_UPDATE_ERR,
+				subcode, notify_datap, length);
 		return BGP_ATTR_PARSE_ERROR;
 	}
 
 	/* Adjust the stream getp to the end of the attribute, in case we can
 	 * still proceed but the caller hasn't read all the attribute.
 	 */
-	stream_set_getp(BGP_INPUT(peer),
-			(args->startp - STREAM_DATA(BGP_INPUT(peer)))
+	stream_set_getp(args->s,
+			(args->startp - STREAM_DATA(args->s))
 				+ args->total);
 
 	switch (args->type) {
@@ -1385,8 +1508,8 @@ bgp_attr_malformed(struct bgp_attr_parser_args *args, uint8_t subcode,
 		return BGP_ATTR_PARSE_WITHDRAW;
 	case BGP_ATTR_MP_REACH_NLRI:
 	case BGP_ATTR_MP_UNREACH_NLRI:
-		bgp_notify_send_with_data(peer, BGP_NOTIFY_UPDATE_ERR, subcode,
-					  notify_datap, length);
+		bgp_attr_notify(peer, args->notify, BGP_NOTIFY_UPDATE_ERR,
+				subcode, notify_datap, length);
 		return BGP_ATTR_PARSE_ERROR;
 	}
 
@@ -1534,7 +1657,6 @@ static bool bgp_attr_flag_invalid(struct bgp_attr_parser_args *args)
 static enum bgp_attr_parse_ret
 bgp_attr_origin(struct bgp_attr_parser_args *args)
 {
-	struct peer *const peer = args->peer;
 	struct attr *const attr = args->attr;
 	const bgp_size_t length = args->length;
 
@@ -1551,7 +1673,7 @@ bgp_attr_origin(struct bgp_attr_parser_args *args)
 	}
 
 	/* Fetch origin attribute. */
-	attr->origin = stream_getc(BGP_INPUT(peer));
+	attr->origin = stream_getc(args->s);
 
 	/* If the ORIGIN attribute has an undefined value, then the Error
 	   Subcode is set to Invalid Origin Attribute.  The Data field
@@ -1586,7 +1708,7 @@ static int bgp_attr_aspath(struct bgp_attr_parser_args *args)
 	 * otherwise, will get 16 Bit
 	 */
 	attr->aspath =
-		aspath_parse(peer->curr, length,
+		aspath_parse(args->s, length,
 			     CHECK_FLAG(peer->cap, PEER_CAP_AS4_RCV) &&
 				     CHECK_FLAG(peer->cap, PEER_CAP_AS4_ADV),
 			     asnotation);
@@ -1694,7 +1816,7 @@ static int bgp_attr_as4_path(struct bgp_attr_parser_args *args,
 
 	asnotation = bgp_get_asnotation(peer->bgp);
 
-	*as4_path = aspath_parse(peer->curr, length, 1, asnotation);
+	*as4_path = aspath_parse(args->s, length, 1, asnotation);
 
 	/* In case of IBGP, length will be zero. */
 	if (!*as4_path) {
@@ -1727,8 +1849,9 @@ static int bgp_attr_as4_path(struct bgp_attr_parser_args *args,
 /*
  * Check that the nexthop attribute is valid.
  */
-enum bgp_attr_parse_ret bgp_attr_nexthop_valid(struct peer *peer,
-					       struct attr *attr)
+static enum bgp_attr_parse_ret
+bgp_attr_nexthop_check(struct peer *peer, struct attr *attr,
+		       struct bgp_notify *notify)
 {
 	struct bgp *bgp = peer->bgp;
 
@@ -1741,20 +1864,24 @@ enum bgp_attr_parse_ret bgp_attr_nexthop_valid(struct peer *peer,
 		data[1] = BGP_ATTR_NEXT_HOP;
 		data[2] = BGP_ATTR_NHLEN_IPV4;
 		memcpy(&data[3], &attr->nexthop.s_addr, BGP_ATTR_NHLEN_IPV4);
-		bgp_notify_send_with_data(peer, BGP_NOTIFY_UPDATE_ERR,
-					  BGP_NOTIFY_UPDATE_INVAL_NEXT_HOP,
-					  data, 7);
+		bgp_attr_notify(peer, notify, BGP_NOTIFY_UPDATE_ERR,
+				BGP_NOTIFY_UPDATE_INVAL_NEXT_HOP, data, 7);
 		return BGP_ATTR_PARSE_ERROR;
 	}
 
 	return BGP_ATTR_PARSE_PROCEED;
 }
 
+enum bgp_attr_parse_ret bgp_attr_nexthop_valid(struct peer *peer,
+					       struct attr *attr)
+{
+	return bgp_attr_nexthop_check(peer, attr, NULL);
+}
+
 /* Nexthop attribute. */
 static enum bgp_attr_parse_ret
 bgp_attr_nexthop(struct bgp_attr_parser_args *args)
 {
-	struct peer *const peer = args->peer;
 	struct attr *const attr = args->attr;
 	const bgp_size_t length = args->length;
 
@@ -1767,7 +1894,7 @@ bgp_attr_nexthop(struct bgp_attr_parser_args *args)
 					  args->total);
 	}
 
-	attr->nexthop.s_addr = stream_get_ipv4(peer->curr);
+	attr->nexthop.s_addr = stream_get_ipv4(args->s);
 	attr->flag |= ATTR_FLAG_BIT(BGP_ATTR_NEXT_HOP);
 
 	return BGP_ATTR_PARSE_PROCEED;
@@ -1776,7 +1903,6 @@ bgp_attr_nexthop(struct bgp_attr_parser_args *args)
 /* MED atrribute. */
 static enum bgp_attr_parse_ret bgp_attr_med(struct bgp_attr_parser_args *args)
 {
-	struct peer *const peer = args->peer;
 	struct attr *const attr = args->attr;
 	const bgp_size_t length = args->length;
 
@@ -1789,7 +1915,7 @@ static enum bgp_attr_parse_ret bgp_attr_med(struct bgp_attr_parser_args *args)
 					  args->total);
 	}
 
-	attr->med = stream_getl(peer->curr);
+	attr->med = stream_getl(args->s);
 
 	attr->flag |= ATTR_FLAG_BIT(BGP_ATTR_MULTI_EXIT_DISC);
 
@@ -1820,11 +1946,11 @@ bgp_attr_local_pref(struct bgp_attr_parser_args *args)
 	   external peer, then this attribute MUST be ignored by the
 	   receiving speaker. */
 	if (peer->sort == BGP_PEER_EBGP) {
-		STREAM_FORWARD_GETP(peer->curr, length);
+		STREAM_FORWARD_GETP(args->s, length);
 		return BGP_ATTR_PARSE_PROCEED;
 	}
 
-	STREAM_GETL(peer->curr, attr->local_pref);
+	STREAM_GETL(args->s, attr->local_pref);
 
 	/* Set the local-pref flag. */
 	attr->flag |= ATTR_FLAG_BIT(BGP_ATTR_LOCAL_PREF);
@@ -1861,7 +1987,7 @@ static int bgp_attr_atomic(struct bgp_attr_parser_args *args)
 	return BGP_ATTR_PARSE_PROCEED;
 
 atomic_ignore:
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	return bgp_attr_ignore(peer, args->type);
 }
@@ -1893,12 +2019,12 @@ static int bgp_attr_aggregator(struct bgp_attr_parser_args *args)
 		goto aggregator_ignore;
 
 	if (CHECK_FLAG(peer->cap, PEER_CAP_AS4_RCV))
-		aggregator_as = stream_getl(peer->curr);
+		aggregator_as = stream_getl(args->s);
 	else
-		aggregator_as = stream_getw(peer->curr);
+		aggregator_as = stream_getw(args->s);
 
 	attr->aggregator_as = aggregator_as;
-	attr->aggregator_addr.s_addr = stream_get_ipv4(peer->curr);
+	attr->aggregator_addr.s_addr = stream_get_ipv4(args->s);
 
 	/* Codification of AS 0 Processing */
 	if (aggregator_as == BGP_AS_ZERO) {
@@ -1920,7 +2046,7 @@ static int bgp_attr_aggregator(struct bgp_attr_parser_args *args)
 	return BGP_ATTR_PARSE_PROCEED;
 
 aggregator_ignore:
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	return bgp_attr_ignore(peer, args->type);
 }
@@ -1946,10 +2072,10 @@ bgp_attr_as4_aggregator(struct bgp_attr_parser_args *args,
 	if (peer->discard_attrs[args->type] || peer->withdraw_attrs[args->type])
 		goto as4_aggregator_ignore;
 
-	aggregator_as = stream_getl(peer->curr);
+	aggregator_as = stream_getl(args->s);
 
 	*as4_aggregator_as = aggregator_as;
-	as4_aggregator_addr->s_addr = stream_get_ipv4(peer->curr);
+	as4_aggregator_addr->s_addr = stream_get_ipv4(args->s);
 
 	/* Codification of AS 0 Processing */
 	if (aggregator_as == BGP_AS_ZERO) {
@@ -1971,7 +2097,7 @@ bgp_attr_as4_aggregator(struct bgp_attr_parser_args *args,
 	return BGP_ATTR_PARSE_PROCEED;
 
 as4_aggregator_ignore:
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	return bgp_attr_ignore(peer, args->type);
 }
@@ -2098,10 +2224,10 @@ bgp_attr_community(struct bgp_attr_parser_args *args)
 
 	bgp_attr_set_community(
 		attr,
-		community_parse((uint32_t *)stream_pnt(peer->curr), length));
+		community_parse((uint32_t *)stream_pnt(args->s), length));
 
 	/* XXX: fix community_parse to use stream API and remove this */
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	/* The Community attribute SHALL be considered malformed if its
 	 * length is not a non-zero multiple of 4.
@@ -2113,7 +2239,7 @@ bgp_attr_community(struct bgp_attr_parser_args *args)
 	return BGP_ATTR_PARSE_PROCEED;
 
 community_ignore:
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	return bgp_attr_ignore(peer, args->type);
 }
@@ -2142,14 +2268,14 @@ bgp_attr_originator_id(struct bgp_attr_parser_args *args)
 	if (peer->discard_attrs[args->type] || peer->withdraw_attrs[args->type])
 		goto originator_id_ignore;
 
-	attr->originator_id.s_addr = stream_get_ipv4(peer->curr);
+	attr->originator_id.s_addr = stream_get_ipv4(args->s);
 
 	attr->flag |= ATTR_FLAG_BIT(BGP_ATTR_ORIGINATOR_ID);
 
 	return BGP_ATTR_PARSE_PROCEED;
 
 originator_id_ignore:
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	return bgp_attr_ignore(peer, args->type);
 }
@@ -2178,18 +2304,18 @@ bgp_attr_cluster_list(struct bgp_attr_parser_args *args)
 		goto cluster_list_ignore;
 
 	bgp_attr_set_cluster(
-		attr, cluster_parse((struct in_addr *)stream_pnt(peer->curr),
+		attr, cluster_parse((struct in_addr *)stream_pnt(args->s),
 				    length));
 
 	/* XXX: Fix cluster_parse to use stream API and then remove this */
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	attr->flag |= ATTR_FLAG_BIT(BGP_ATTR_CLUSTER_LIST);
 
 	return BGP_ATTR_PARSE_PROCEED;
 
 cluster_list_ignore:
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	return bgp_attr_ignore(peer, args->type);
 }
@@ -2210,7 +2336,7 @@ int bgp_mp_reach_parse(struct bgp_attr_parser_args *args,
 	const bgp_size_t length = args->length;
 
 	/* Set end of packet. */
-	s = BGP_INPUT(peer);
+	s = args->s;
 	start = stream_get_getp(s);
 
 /* safe to read statically sized header? */
@@ -2396,7 +2522,7 @@ int bgp_mp_unreach_parse(struct bgp_attr_parser_args *args,
 	struct attr *const attr = args->attr;
 	const bgp_size_t length = args->length;
 
-	s = peer->curr;
+	s = args->s;
 
 #define BGP_MP_UNREACH_MIN_SIZE 3
 	if ((length > STREAM_READABLE(s)) || (length < BGP_MP_UNREACH_MIN_SIZE))
@@ -2455,9 +2581,9 @@ bgp_attr_large_community(struct bgp_attr_parser_args *args)
 		goto large_community_ignore;
 
 	bgp_attr_set_lcommunity(
-		attr, lcommunity_parse(stream_pnt(peer->curr), length));
+		attr, lcommunity_parse(stream_pnt(args->s), length));
 	/* XXX: fix ecommunity_parse to use stream API */
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	if (!bgp_attr_get_lcommunity(attr))
 		return bgp_attr_malformed(args, BGP_NOTIFY_UPDATE_OPT_ATTR_ERR,
@@ -2466,7 +2592,7 @@ bgp_attr_large_community(struct bgp_attr_parser_args *args)
 	return BGP_ATTR_PARSE_PROCEED;
 
 large_community_ignore:
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	return bgp_attr_ignore(peer, args->type);
 }
@@ -2490,12 +2616,12 @@ bgp_attr_ext_communities(struct bgp_attr_parser_args *args)
 	}
 
 	ecomm = ecommunity_parse(
-		stream_pnt(peer->curr), length,
+		stream_pnt(args->s), length,
 		CHECK_FLAG(peer->flags,
 			   PEER_FLAG_DISABLE_LINK_BW_ENCODING_IEEE));
 	bgp_attr_set_ecommunity(attr, ecomm);
 	/* XXX: fix ecommunity_parse to use stream API */
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	/* The Extended Community attribute SHALL be considered malformed if
 	 * its length is not a non-zero multiple of 8.
@@ -2564,13 +2690,13 @@ bgp_attr_ipv6_ext_communities(struct bgp_attr_parser_args *args)
 		goto ipv6_ext_community_ignore;
 
 	ipv6_ecomm = ecommunity_parse_ipv6(
-		stream_pnt(peer->curr), length,
+		stream_pnt(args->s), length,
 		CHECK_FLAG(peer->flags,
 			   PEER_FLAG_DISABLE_LINK_BW_ENCODING_IEEE));
 	bgp_attr_set_ipv6_ecommunity(attr, ipv6_ecomm);
 
 	/* XXX: fix ecommunity_parse to use stream API */
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	if (!ipv6_ecomm)
 		return bgp_attr_malformed(args, BGP_NOTIFY_UPDATE_OPT_ATTR_ERR,
@@ -2579,18 +2705,20 @@ bgp_attr_ipv6_ext_communities(struct bgp_attr_parser_args *args)
 	return BGP_ATTR_PARSE_PROCEED;
 
 ipv6_ext_community_ignore:
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	return bgp_attr_ignore(peer, args->type);
 }
 
 /* Parse Tunnel Encap attribute in an UPDATE */
-static int bgp_attr_encap(uint8_t type, struct peer *peer, /* IN */
-			  bgp_size_t length, /* IN: attr's length field */
-			  struct attr *attr, /* IN: caller already allocated */
-			  uint8_t flag,      /* IN: attr's flags field */
-			  uint8_t *startp)
+static int bgp_attr_encap(struct bgp_attr_parser_args *args)
 {
+	struct peer *const peer = args->peer;
+	struct attr *const attr = args->attr;
+	const uint8_t type = args->type;
+	const uint8_t flag = args->flags;
+	uint8_t *const startp = args->startp;
+	bgp_size_t length = args->length;
 	bgp_size_t total;
 	uint16_t tunneltype = 0;
 
@@ -2601,9 +2729,9 @@ static int bgp_attr_encap(uint8_t type, struct peer *peer, /* IN */
 		zlog_info(
 			"Tunnel Encap attribute flag isn't optional and transitive %d",
 			flag);
-		bgp_notify_send_with_data(peer, BGP_NOTIFY_UPDATE_ERR,
-					  BGP_NOTIFY_UPDATE_ATTR_FLAG_ERR,
-					  startp, total);
+		bgp_attr_notify(peer, args->notify, BGP_NOTIFY_UPDATE_ERR,
+				BGP_NOTIFY_UPDATE_ATTR_FLAG_ERR, startp,
+				total);
 		return -1;
 	}
 
@@ -2614,13 +2742,14 @@ static int bgp_attr_encap(uint8_t type, struct peer *peer, /* IN */
 		if (length < 4) {
 			zlog_info(
 				"Tunnel Encap attribute not long enough to contain outer T,L");
-			bgp_notify_send_with_data(
-				peer, BGP_NOTIFY_UPDATE_ERR,
-				BGP_NOTIFY_UPDATE_OPT_ATTR_ERR, startp, total);
+			bgp_attr_notify(peer, args->notify,
+					BGP_NOTIFY_UPDATE_ERR,
+					BGP_NOTIFY_UPDATE_OPT_ATTR_ERR, startp,
+					total);
 			return -1;
 		}
-		tunneltype = stream_getw(BGP_INPUT(peer));
-		tlv_length = stream_getw(BGP_INPUT(peer));
+		tunneltype = stream_getw(args->s);
+		tlv_length = stream_getw(args->s);
 		length -= 4;
 
 		if (tlv_length != length) {
@@ -2635,13 +2764,13 @@ static int bgp_attr_encap(uint8_t type, struct peer *peer, /* IN */
 		struct bgp_attr_encap_subtlv *tlv;
 
 		if (BGP_ATTR_ENCAP == type) {
-			subtype = stream_getc(BGP_INPUT(peer));
-			sublength = stream_getc(BGP_INPUT(peer));
+			subtype = stream_getc(args->s);
+			sublength = stream_getc(args->s);
 			length -= 2;
 #ifdef ENABLE_BGP_VNC
 		} else {
-			subtype = stream_getw(BGP_INPUT(peer));
-			sublength = stream_getw(BGP_INPUT(peer));
+			subtype = stream_getw(args->s);
+			sublength = stream_getw(args->s);
 			length -= 4;
 #endif
 		}
@@ -2650,9 +2779,10 @@ static int bgp_attr_encap(uint8_t type, struct peer *peer, /* IN */
 			zlog_info(
 				"Tunnel Encap attribute sub-tlv length %d exceeds remaining length %d",
 				sublength, length);
-			bgp_notify_send_with_data(
-				peer, BGP_NOTIFY_UPDATE_ERR,
-				BGP_NOTIFY_UPDATE_OPT_ATTR_ERR, startp, total);
+			bgp_attr_notify(peer, args->notify,
+					BGP_NOTIFY_UPDATE_ERR,
+					BGP_NOTIFY_UPDATE_OPT_ATTR_ERR, startp,
+					total);
 			return -1;
 		}
 
@@ -2662,7 +2792,7 @@ static int bgp_attr_encap(uint8_t type, struct peer *peer, /* IN */
 			      sizeof(struct bgp_attr_encap_subtlv) + sublength);
 		tlv->type = subtype;
 		tlv->length = sublength;
-		stream_get(tlv->value, peer->curr, sublength);
+		stream_get(tlv->value, args->s, sublength);
 		length -= sublength;
 
 		/* attach tlv to encap chain */
@@ -2704,9 +2834,9 @@ static int bgp_attr_encap(uint8_t type, struct peer *peer, /* IN */
 		zlog_info(
 			"Tunnel Encap attribute length is bad: %d leftover octets",
 			length);
-		bgp_notify_send_with_data(peer, BGP_NOTIFY_UPDATE_ERR,
-					  BGP_NOTIFY_UPDATE_OPT_ATTR_ERR,
-					  startp, total);
+		bgp_attr_notify(peer, args->notify, BGP_NOTIFY_UPDATE_ERR,
+				BGP_NOTIFY_UPDATE_OPT_ATTR_ERR, startp,
+				total);
 		return -1;
 	}
 
@@ -2727,23 +2857,23 @@ bgp_attr_srv6_service_data(struct bgp_attr_parser_args *args)
 	uint16_t length;
 	size_t headersz = sizeof(type) + sizeof(length);
 
-	if (STREAM_READABLE(peer->curr) < headersz) {
+	if (STREAM_READABLE(args->s) < headersz) {
 		flog_err(
 			EC_BGP_ATTR_LEN,
 			"Malformed SRv6 Service Data Sub-Sub-TLV attribute - insufficent data (need %zu for attribute header, have %zu remaining in UPDATE)",
-			headersz, STREAM_READABLE(peer->curr));
+			headersz, STREAM_READABLE(args->s));
 		return bgp_attr_malformed(args, BGP_NOTIFY_UPDATE_ATTR_LENG_ERR,
 					  args->total);
 	}
 
-	type = stream_getc(peer->curr);
-	length = stream_getw(peer->curr);
+	type = stream_getc(args->s);
+	length = stream_getw(args->s);
 
-	if (STREAM_READABLE(peer->curr) < length) {
+	if (STREAM_READABLE(args->s) < length) {
 		flog_err(
 			EC_BGP_ATTR_LEN,
 			"Malformed SRv6 Service Data Sub-Sub-TLV attribute - insufficent data (need %hu for attribute data, have %zu remaining in UPDATE)",
-			length, STREAM_READABLE(peer->curr));
+			length, STREAM_READABLE(args->s));
 		return bgp_attr_malformed(args, BGP_NOTIFY_UPDATE_ATTR_LENG_ERR,
 					  args->total);
 	}
@@ -2759,24 +2889,24 @@ bgp_attr_srv6_service_data(struct bgp_attr_parser_args *args)
 	}
 
 	if (type == BGP_PREFIX_SID_SRV6_L3_SERVICE_SID_STRUCTURE) {
-		if (STREAM_READABLE(peer->curr) <
+		if (STREAM_READABLE(args->s) <
 		    BGP_PREFIX_SID_SRV6_L3_SERVICE_SID_STRUCTURE_LENGTH) {
 			flog_err(
 				EC_BGP_ATTR_LEN,
 				"Malformed SRv6 Service Data Sub-Sub-TLV attribute - insufficient data (need %u, have %zu remaining in UPDATE)",
 				BGP_PREFIX_SID_SRV6_L3_SERVICE_SID_STRUCTURE_LENGTH,
-				STREAM_READABLE(peer->curr));
+				STREAM_READABLE(args->s));
 			return bgp_attr_malformed(
 				args, BGP_NOTIFY_UPDATE_ATTR_LENG_ERR,
 				args->total);
 		}
 
-		loc_block_len = stream_getc(peer->curr);
-		loc_node_len = stream_getc(peer->curr);
-		func_len = stream_getc(peer->curr);
-		arg_len = stream_getc(peer->curr);
-		transposition_len = stream_getc(peer->curr);
-		transposition_offset = stream_getc(peer->curr);
+		loc_block_len = stream_getc(args->s);
+		loc_node_len = stream_getc(args->s);
+		func_len = stream_getc(args->s);
+		arg_len = stream_getc(args->s);
+		transposition_len = stream_getc(args->s);
+		transposition_offset = stream_getc(args->s);
 
 		/* Log SRv6 Service Data Sub-Sub-TLV */
 		if (BGP_DEBUG(vpn, VPN_LEAK_LABEL)) {
@@ -2801,7 +2931,7 @@ bgp_attr_srv6_service_data(struct bgp_attr_parser_args *args)
 				"%s attr SRv6 Service Data Sub-Sub-TLV sub-sub-type=%u is not supported, skipped",
 				peer->host, type);
 
-		stream_forward_getp(peer->curr, length);
+		stream_forward_getp(args->s, length);
 	}
 
 	return BGP_ATTR_PARSE_PROCEED;
@@ -2821,44 +2951,44 @@ bgp_attr_srv6_service(struct bgp_attr_parser_args *args)
 	size_t headersz = sizeof(type) + sizeof(length);
 	enum bgp_attr_parse_ret err;
 
-	if (STREAM_READABLE(peer->curr) < headersz) {
+	if (STREAM_READABLE(args->s) < headersz) {
 		flog_err(
 			EC_BGP_ATTR_LEN,
 			"Malformed SRv6 Service Sub-TLV attribute - insufficent data (need %zu for attribute header, have %zu remaining in UPDATE)",
-			headersz, STREAM_READABLE(peer->curr));
+			headersz, STREAM_READABLE(args->s));
 		return bgp_attr_malformed(args, BGP_NOTIFY_UPDATE_ATTR_LENG_ERR,
 					  args->total);
 	}
 
-	type = stream_getc(peer->curr);
-	length = stream_getw(peer->curr);
+	type = stream_getc(args->s);
+	length = stream_getw(args->s);
 
-	if (STREAM_READABLE(peer->curr) < length) {
+	if (STREAM_READABLE(args->s) < length) {
 		flog_err(
 			EC_BGP_ATTR_LEN,
 			"Malformed SRv6 Service Sub-TLV attribute - insufficent data (need %hu for attribute data, have %zu remaining in UPDATE)",
-			length, STREAM_READABLE(peer->curr));
+			length, STREAM_READABLE(args->s));
 		return bgp_attr_malformed(args, BGP_NOTIFY_UPDATE_ATTR_LENG_ERR,
 					  args->total);
 	}
 
 	if (type == BGP_PREFIX_SID_SRV6_L3_SERVICE_SID_INFO) {
-		if (STREAM_READABLE(peer->curr) <
+		if (STREAM_READABLE(args->s) <
 		    BGP_PREFIX_SID_SRV6_L3_SERVICE_SID_INFO_LENGTH) {
 			flog_err(
 				EC_BGP_ATTR_LEN,
 				"Malformed SRv6 Service Sub-TLV attribute - insufficent data (need %d for attribute data, have %zu remaining in UPDATE)",
 				BGP_PREFIX_SID_SRV6_L3_SERVICE_SID_INFO_LENGTH,
-				STREAM_READABLE(peer->curr));
+				STREAM_READABLE(args->s));
 			return bgp_attr_malformed(
 				args, BGP_NOTIFY_UPDATE_ATTR_LENG_ERR,
 				args->total);
 		}
-		stream_getc(peer->curr);
-		stream_get(&ipv6_sid, peer->curr, sizeof(ipv6_sid));
-		sid_flags = stream_getc(peer->curr);
-		endpoint_behavior = stream_getw(peer->curr);
-		stream_getc(peer->curr);
+		stream_getc(args->s);
+		stream_get(&ipv6_sid, args->s, sizeof(ipv6_sid));
+		sid_flags = stream_getc(args->s);
+		endpoint_behavior = stream_getw(args->s);
+		stream_getc(args->s);
 
 		/* Log SRv6 Service Sub-TLV */
 		if (BGP_DEBUG(vpn, VPN_LEAK_LABEL))
@@ -2904,7 +3034,7 @@ bgp_attr_srv6_service(struct bgp_attr_parser_args *args)
 				"%s attr SRv6 Service Sub-TLV sub-type=%u is not supported, skipped",
 				peer->host, type);
 
-		stream_forward_getp(peer->curr, length);
+		stream_forward_getp(args->s, length);
 	}
 
 	return BGP_ATTR_PARSE_PROCEED;
@@ -2931,11 +3061,11 @@ bgp_attr_psid_sub(uint8_t type, uint16_t length,
 	 * Check that we actually have at least as much data as
 	 * specified by the length field
 	 */
-	if (STREAM_READABLE(peer->curr) < length) {
+	if (STREAM_READABLE(args->s) < length) {
 		flog_err(
 			EC_BGP_ATTR_LEN,
 			"Prefix SID specifies length %hu, but only %zu bytes remain",
-			length, STREAM_READABLE(peer->curr));
+			length, STREAM_READABLE(args->s));
 		return bgp_attr_malformed(args, BGP_NOTIFY_UPDATE_ATTR_LENG_ERR,
 					  args->total);
 	}
@@ -2951,11 +3081,11 @@ bgp_attr_psid_sub(uint8_t type, uint16_t length,
 		}
 
 		/* Ignore flags and reserved */
-		stream_getc(peer->curr);
-		stream_getw(peer->curr);
+		stream_getc(args->s);
+		stream_getw(args->s);
 
 		/* Fetch the label index and see if it is valid. */
-		label_index = stream_getl(peer->curr);
+		label_index = stream_getl(args->s);
 		if (label_index == BGP_INVALID_LABEL_INDEX)
 			return bgp_attr_malformed(args, BGP_NOTIFY_UPDATE_OPT_ATTR_ERR,
 						  args->total);
@@ -2974,17 +3104,17 @@ bgp_attr_psid_sub(uint8_t type, uint16_t length,
 		}
 
 		/* Ignore reserved */
-		stream_getc(peer->curr);
-		stream_getw(peer->curr);
+		stream_getc(args->s);
+		stream_getw(args->s);
 
-		stream_get(&ipv6_sid, peer->curr, 16);
+		stream_get(&ipv6_sid, args->s, 16);
 	} else if (type == BGP_PREFIX_SID_ORIGINATOR_SRGB) {
 		/*
 		 * ietf-idr-bgp-prefix-sid-05:
 		 *     Length is the total length of the value portion of the
 		 *     TLV: 2 + multiple of 6.
 		 *
-		 * peer->curr stream readp should be at the beginning of the 16
+		 * args->s stream readp should be at the beginning of the 16
 		 * bit flag field at this point in the code.
 		 */
 
@@ -3008,7 +3138,7 @@ bgp_attr_psid_sub(uint8_t type, uint16_t length,
 		 * SRGBs corresponds to a multiple of the SRGB size; to get
 		 * that length, we skip the 16 bit flags field
 		 */
-		stream_getw(peer->curr);
+		stream_getw(args->s);
 		length -= 2;
 		if (length % BGP_PREFIX_SID_ORIGINATOR_SRGB_LENGTH) {
 			flog_err(
@@ -3023,8 +3153,8 @@ bgp_attr_psid_sub(uint8_t type, uint16_t length,
 		srgb_count = length / BGP_PREFIX_SID_ORIGINATOR_SRGB_LENGTH;
 
 		for (int i = 0; i < srgb_count; i++) {
-			stream_get(&srgb_base, peer->curr, 3);
-			stream_get(&srgb_range, peer->curr, 3);
+			stream_get(&srgb_base, args->s, 3);
+			stream_get(&srgb_range, args->s, 3);
 		}
 	} else if (type == BGP_PREFIX_SID_VPN_SID) {
 		if (length != BGP_PREFIX_SID_VPN_SID_LENGTH) {
@@ -3037,10 +3167,10 @@ bgp_attr_psid_sub(uint8_t type, uint16_t length,
 		}
 
 		/* Parse VPN-SID Sub-TLV */
-		stream_getc(peer->curr);               /* reserved  */
-		sid_type = stream_getc(peer->curr);    /* sid_type  */
-		sid_flags = stream_getc(peer->curr);   /* sid_flags */
-		stream_get(&ipv6_sid, peer->curr,
+		stream_getc(args->s);               /* reserved  */
+		sid_type = stream_getc(args->s);    /* sid_type  */
+		sid_flags = stream_getc(args->s);   /* sid_flags */
+		stream_get(&ipv6_sid, args->s,
 			   sizeof(ipv6_sid)); /* sid_value */
 
 		/* Log VPN-SID Sub-TLV */
@@ -3062,7 +3192,7 @@ bgp_attr_psid_sub(uint8_t type, uint16_t length,
 		sid_copy(&attr->srv6_vpn->sid, &ipv6_sid);
 		attr->srv6_vpn = srv6_vpn_intern(attr->srv6_vpn);
 	} else if (type == BGP_PREFIX_SID_SRV6_L3_SERVICE) {
-		if (STREAM_READABLE(peer->curr) < 1) {
+		if (STREAM_READABLE(args->s) < 1) {
 			flog_err(
 				EC_BGP_ATTR_LEN,
 				"Prefix SID SRV6 L3 Service not enough data left, it must be at least 1 byte");
@@ -3071,7 +3201,7 @@ bgp_attr_psid_sub(uint8_t type, uint16_t length,
 				args->total);
 		}
 		/* ignore reserved */
-		stream_getc(peer->curr);
+		stream_getc(args->s);
 
 		return bgp_attr_srv6_service(args);
 	}
@@ -3082,7 +3212,7 @@ bgp_attr_psid_sub(uint8_t type, uint16_t length,
 				"%s attr Prefix-SID sub-type=%u is not supported, skipped",
 				peer->host, type);
 
-		stream_forward_getp(peer->curr, length);
+		stream_forward_getp(args->s, length);
 	}
 
 	return BGP_ATTR_PARSE_PROCEED;
@@ -3093,7 +3223,6 @@ bgp_attr_psid_sub(uint8_t type, uint16_t length,
  */
 enum bgp_attr_parse_ret bgp_attr_prefix_sid(struct bgp_attr_parser_args *args)
 {
-	struct peer *const peer = args->peer;
 	struct attr *const attr = args->attr;
 	enum bgp_attr_parse_ret ret;
 
@@ -3104,27 +3233,27 @@ enum bgp_attr_parse_ret bgp_attr_prefix_sid(struct bgp_attr_parser_args *args)
 	size_t headersz = sizeof(type) + sizeof(length);
 	size_t psid_parsed_length = 0;
 
-	while (STREAM_READABLE(peer->curr) > 0
+	while (STREAM_READABLE(args->s) > 0
 	       && psid_parsed_length < args->length) {
 
-		if (STREAM_READABLE(peer->curr) < headersz) {
+		if (STREAM_READABLE(args->s) < headersz) {
 			flog_err(
 				EC_BGP_ATTR_LEN,
 				"Malformed Prefix SID attribute - insufficent data (need %zu for attribute header, have %zu remaining in UPDATE)",
-				headersz, STREAM_READABLE(peer->curr));
+				headersz, STREAM_READABLE(args->s));
 			return bgp_attr_malformed(
 				args, BGP_NOTIFY_UPDATE_ATTR_LENG_ERR,
 				args->total);
 		}
 
-		type = stream_getc(peer->curr);
-		length = stream_getw(peer->curr);
+		type = stream_getc(args->s);
+		length = stream_getw(args->s);
 
-		if (STREAM_READABLE(peer->curr) < length) {
+		if (STREAM_READABLE(args->s) < length) {
 			flog_err(
 				EC_BGP_ATTR_LEN,
 				"Malformed Prefix SID attribute - insufficient data (need %hu for attribute body, have %zu remaining in UPDATE)",
-				length, STREAM_READABLE(peer->curr));
+				length, STREAM_READABLE(args->s));
 			return bgp_attr_malformed(args,
 						  BGP_NOTIFY_UPDATE_ATTR_LENG_ERR,
 						  args->total);
@@ -3157,7 +3286,6 @@ enum bgp_attr_parse_ret bgp_attr_prefix_sid(struct bgp_attr_parser_args *args)
 static enum bgp_attr_parse_ret
 bgp_attr_pmsi_tunnel(struct bgp_attr_parser_args *args)
 {
-	struct peer *const peer = args->peer;
 	struct attr *const attr = args->attr;
 	const bgp_size_t length = args->length;
 	uint8_t tnl_type;
@@ -3172,8 +3300,8 @@ bgp_attr_pmsi_tunnel(struct bgp_attr_parser_args *args)
 		return bgp_attr_malformed(args, BGP_NOTIFY_UPDATE_ATTR_LENG_ERR,
 					  args->total);
 	}
-	stream_getc(peer->curr); /* Flags */
-	tnl_type = stream_getc(peer->curr);
+	stream_getc(args->s); /* Flags */
+	tnl_type = stream_getc(args->s);
 	if (tnl_type > PMSI_TNLTYPE_MAX) {
 		flog_err(EC_BGP_ATTR_PMSI_TYPE,
 			 "Invalid PMSI tunnel attribute type %d", tnl_type);
@@ -3193,10 +3321,10 @@ bgp_attr_pmsi_tunnel(struct bgp_attr_parser_args *args)
 
 	attr->flag |= ATTR_FLAG_BIT(BGP_ATTR_PMSI_TUNNEL);
 	bgp_attr_set_pmsi_tnl_type(attr, tnl_type);
-	stream_get(&attr->label, peer->curr, BGP_LABEL_BYTES);
+	stream_get(&attr->label, args->s, BGP_LABEL_BYTES);
 
 	/* Forward read pointer of input stream. */
-	stream_forward_getp(peer->curr, length - attr_parse_len);
+	stream_forward_getp(args->s, length - attr_parse_len);
 
 	return BGP_ATTR_PARSE_PROCEED;
 }
@@ -3207,7 +3335,7 @@ static enum bgp_attr_parse_ret bgp_attr_aigp(struct bgp_attr_parser_args *args)
 	struct peer *const peer = args->peer;
 	struct attr *const attr = args->attr;
 	const bgp_size_t length = args->length;
-	uint8_t *s = stream_pnt(peer->curr);
+	uint8_t *s = stream_pnt(args->s);
 	uint64_t aigp = 0;
 
 	/* If an AIGP attribute is received on a BGP session for which
@@ -3238,7 +3366,7 @@ static enum bgp_attr_parse_ret bgp_attr_aigp(struct bgp_attr_parser_args *args)
 		bgp_attr_set_aigp_metric(attr, aigp);
 
 aigp_ignore:
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	return bgp_attr_ignore(peer, args->type);
 }
@@ -3261,7 +3389,7 @@ static enum bgp_attr_parse_ret bgp_attr_otc(struct bgp_attr_parser_args *args)
 	if (peer->discard_attrs[args->type] || peer->withdraw_attrs[args->type])
 		goto otc_ignore;
 
-	attr->otc = stream_getl(peer->curr);
+	attr->otc = stream_getl(args->s);
 	if (!attr->otc) {
 		flog_err(EC_BGP_ATTR_MAL_AS_PATH, "OTC attribute value is 0");
 		return bgp_attr_malformed(args, BGP_NOTIFY_UPDATE_MAL_AS_PATH,
@@ -3273,7 +3401,7 @@ static enum bgp_attr_parse_ret bgp_attr_otc(struct bgp_attr_parser_args *args)
 	return BGP_ATTR_PARSE_PROCEED;
 
 otc_ignore:
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	return bgp_attr_ignore(peer, args->type);
 }
@@ -3297,7 +3425,7 @@ bgp_attr_unknown(struct bgp_attr_parser_args *args)
 			peer->host, type, length);
 
 	/* Forward read pointer of input stream. */
-	stream_forward_getp(peer->curr, length);
+	stream_forward_getp(args->s, length);
 
 	if (peer->discard_attrs[type] || peer->withdraw_attrs[type])
 		return bgp_attr_ignore(peer, type);
@@ -3392,6 +3520,22 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 				       bgp_size_t size,
 				       struct bgp_nlri *mp_update,
 				       struct bgp_nlri *mp_withdraw)
+{
+	return bgp_attr_parse_stream(peer, BGP_INPUT(peer), NULL, attr, size,
+				     mp_update, mp_withdraw);
+}
+
+/*
+ * Read the path attributes of an UPDATE from s, positioned at the first
+ * attribute.  With notify set, nothing is sent to the peer: the
+ * NOTIFICATION an error calls for is stored there instead, and the peer is
+ * only read from, as the parse workers run this off the main pthread.
+ */
+enum bgp_attr_parse_ret
+bgp_attr_parse_stream(struct peer *peer, struct stream *s,
+		      struct bgp_notify *notify, struct attr *attr,
+		      bgp_size_t size, struct bgp_nlri *mp_update,
+		      struct bgp_nlri *mp_withdraw)
 {
 	enum bgp_attr_parse_ret ret;
 	uint8_t flag = 0;
@@ -3412,33 +3556,34 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 	memset(seen, 0, BGP_ATTR_BITMAP_SIZE);
 
 	/* End pointer of BGP attribute. */
-	endp = BGP_INPUT_PNT(peer) + size;
+	endp = stream_pnt(s) + size;
 
 	/* Get attributes to the end of attribute length. */
-	while (BGP_INPUT_PNT(peer) < endp) {
+	while (stream_pnt(s) < endp) {
 		/* Check remaining length check.*/
-		if (endp - BGP_INPUT_PNT(peer) < BGP_ATTR_MIN_LEN) {
+		if (endp - stream_pnt(s) < BGP_ATTR_MIN_LEN) {
 			/* XXX warning: long int format, int arg (arg 5) */
 			flog_warn(
 				EC_BGP_ATTRIBUTE_TOO_SMALL,
 				"%s: error BGP attribute length %lu is smaller than min len",
 				peer->host,
 				(unsigned long)(endp
-						- stream_pnt(BGP_INPUT(peer))));
+						- stream_pnt(s)));
 
-			bgp_notify_send(peer, BGP_NOTIFY_UPDATE_ERR,
-					BGP_NOTIFY_UPDATE_ATTR_LENG_ERR);
+			bgp_attr_notify(peer, notify, BGP_NOTIFY_UPDATE_ERR,
+					BGP_NOTIFY_UPDATE_ATTR_LENG_ERR, NULL,
+					0);
 			ret = BGP_ATTR_PARSE_ERROR;
 			goto done;
 		}
 
 		/* Fetch attribute flag and type. */
-		startp = BGP_INPUT_PNT(peer);
+		startp = stream_pnt(s);
 		/* "The lower-order four bits of the Attribute Flags octet are
 		   unused.  They MUST be zero when sent and MUST be ignored when
 		   received." */
-		flag = 0xF0 & stream_getc(BGP_INPUT(peer));
-		type = stream_getc(BGP_INPUT(peer));
+		flag = 0xF0 & stream_getc(s);
+		type = stream_getc(s);
 
 		/* Check whether Extended-Length applies and is in bounds */
 		if (CHECK_FLAG(flag, BGP_ATTR_FLAG_EXTLEN)
@@ -3448,19 +3593,20 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 				"%s: Extended length set, but just %lu bytes of attr header",
 				peer->host,
 				(unsigned long)(endp
-						- stream_pnt(BGP_INPUT(peer))));
+						- stream_pnt(s)));
 
-			bgp_notify_send(peer, BGP_NOTIFY_UPDATE_ERR,
-					BGP_NOTIFY_UPDATE_ATTR_LENG_ERR);
+			bgp_attr_notify(peer, notify, BGP_NOTIFY_UPDATE_ERR,
+					BGP_NOTIFY_UPDATE_ATTR_LENG_ERR, NULL,
+					0);
 			ret = BGP_ATTR_PARSE_ERROR;
 			goto done;
 		}
 
 		/* Check extended attribue length bit. */
 		if (CHECK_FLAG(flag, BGP_ATTR_FLAG_EXTLEN))
-			length = stream_getw(BGP_INPUT(peer));
+			length = stream_getw(s);
 		else
-			length = stream_getc(BGP_INPUT(peer));
+			length = stream_getc(s);
 
 		/* If any attribute appears more than once in the UPDATE
 		   message, then the Error Subcode is set to Malformed Attribute
@@ -3472,8 +3618,8 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 				"%s: error BGP attribute type %d appears twice in a message",
 				peer->host, type);
 
-			bgp_notify_send(peer, BGP_NOTIFY_UPDATE_ERR,
-					BGP_NOTIFY_UPDATE_MAL_ATTR);
+			bgp_attr_notify(peer, notify, BGP_NOTIFY_UPDATE_ERR,
+					BGP_NOTIFY_UPDATE_MAL_ATTR, NULL, 0);
 			ret = BGP_ATTR_PARSE_ERROR;
 			goto done;
 		}
@@ -3484,7 +3630,7 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 		SET_BITMAP(seen, type);
 
 		/* Overflow check. */
-		attr_endp = BGP_INPUT_PNT(peer) + length;
+		attr_endp = stream_pnt(s) + length;
 
 		if (attr_endp > endp) {
 			flog_warn(
@@ -3517,20 +3663,19 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 			size_t lfl =
 				CHECK_FLAG(flag, BGP_ATTR_FLAG_EXTLEN) ? 2 : 1;
 			/* Rewind to end of flag field */
-			stream_rewind_getp(BGP_INPUT(peer), (1 + lfl));
+			stream_rewind_getp(s, (1 + lfl));
 			/* Type */
-			stream_get(&ndata[0], BGP_INPUT(peer), 1);
+			stream_get(&ndata[0], s, 1);
 			/* Length */
-			stream_get(&ndata[1], BGP_INPUT(peer), lfl);
+			stream_get(&ndata[1], s, lfl);
 			/* Value */
 			size_t atl = attr_endp - startp;
-			size_t ndl = MIN(atl, STREAM_READABLE(BGP_INPUT(peer)));
-			stream_get(&ndata[lfl + 1], BGP_INPUT(peer), ndl);
+			size_t ndl = MIN(atl, STREAM_READABLE(s));
+			stream_get(&ndata[lfl + 1], s, ndl);
 
-			bgp_notify_send_with_data(
-				peer, BGP_NOTIFY_UPDATE_ERR,
-				BGP_NOTIFY_UPDATE_ATTR_LENG_ERR, ndata,
-				ndl + lfl + 1);
+			bgp_attr_notify(peer, notify, BGP_NOTIFY_UPDATE_ERR,
+					BGP_NOTIFY_UPDATE_ATTR_LENG_ERR, ndata,
+					ndl + lfl + 1);
 
 			ret = BGP_ATTR_PARSE_ERROR;
 			goto done;
@@ -3538,6 +3683,8 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 
 		struct bgp_attr_parser_args attr_args = {
 			.peer = peer,
+			.s = s,
+			.notify = notify,
 			.length = length,
 			.attr = attr,
 			.type = type,
@@ -3617,8 +3764,7 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 		case BGP_ATTR_VNC:
 #endif
 		case BGP_ATTR_ENCAP:
-			ret = bgp_attr_encap(type, peer, length, attr, flag,
-					     startp);
+			ret = bgp_attr_encap(&attr_args);
 			break;
 		case BGP_ATTR_PREFIX_SID:
 			ret = bgp_attr_prefix_sid(&attr_args);
@@ -3641,8 +3787,8 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 		}
 
 		if (ret == BGP_ATTR_PARSE_ERROR_NOTIFYPLS) {
-			bgp_notify_send(peer, BGP_NOTIFY_UPDATE_ERR,
-					BGP_NOTIFY_UPDATE_MAL_ATTR);
+			bgp_attr_notify(peer, notify, BGP_NOTIFY_UPDATE_ERR,
+					BGP_NOTIFY_UPDATE_MAL_ATTR, NULL, 0);
 			ret = BGP_ATTR_PARSE_ERROR;
 			goto done;
 		}
@@ -3666,12 +3812,13 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 		}
 
 		/* Check the fetched length. */
-		if (BGP_INPUT_PNT(peer) != attr_endp) {
+		if (stream_pnt(s) != attr_endp) {
 			flog_warn(EC_BGP_ATTRIBUTE_FETCH_ERROR,
 				  "%s: BGP attribute %s, fetch error",
 				  peer->host, lookup_msg(attr_str, type, NULL));
-			bgp_notify_send(peer, BGP_NOTIFY_UPDATE_ERR,
-					BGP_NOTIFY_UPDATE_ATTR_LENG_ERR);
+			bgp_attr_notify(peer, notify, BGP_NOTIFY_UPDATE_ERR,
+					BGP_NOTIFY_UPDATE_ATTR_LENG_ERR, NULL,
+					0);
 			ret = BGP_ATTR_PARSE_ERROR;
 			goto done;
 		}
@@ -3689,12 +3836,12 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 		attr->label_index = BGP_INVALID_LABEL_INDEX;
 
 	/* Check final read pointer is same as end pointer. */
-	if (BGP_INPUT_PNT(peer) != endp) {
+	if (stream_pnt(s) != endp) {
 		flog_warn(EC_BGP_ATTRIBUTES_MISMATCH,
 			  "%s: BGP attribute %s, length mismatch", peer->host,
 			  lookup_msg(attr_str, type, NULL));
-		bgp_notify_send(peer, BGP_NOTIFY_UPDATE_ERR,
-				BGP_NOTIFY_UPDATE_ATTR_LENG_ERR);
+		bgp_attr_notify(peer, notify, BGP_NOTIFY_UPDATE_ERR,
+				BGP_NOTIFY_UPDATE_ATTR_LENG_ERR, NULL, 0);
 
 		ret = BGP_ATTR_PARSE_ERROR;
 		goto done;
@@ -3715,7 +3862,7 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 	 */
 	if (CHECK_FLAG(attr->flag, ATTR_FLAG_BIT(BGP_ATTR_NEXT_HOP))
 	    && !CHECK_FLAG(attr->flag, ATTR_FLAG_BIT(BGP_ATTR_MP_REACH_NLRI))) {
-		if (bgp_attr_nexthop_valid(peer, attr) < 0) {
+		if (bgp_attr_nexthop_check(peer, attr, notify) < 0) {
 			ret = BGP_ATTR_PARSE_ERROR;
 			goto done;
 		}
@@ -3745,8 +3892,8 @@ enum bgp_attr_parse_ret bgp_attr_parse(struct peer *peer, struct attr *attr,
 	if (CHECK_FLAG(attr->flag, ATTR_FLAG_BIT(BGP_ATTR_AS_PATH))
 	    && bgp_attr_munge_as4_attrs(peer, attr, as4_path, as4_aggregator,
 					&as4_aggregator_addr)) {
-		bgp_notify_send(peer, BGP_NOTIFY_UPDATE_ERR,
-				BGP_NOTIFY_UPDATE_MAL_ATTR);
+		bgp_attr_notify(peer, notify, BGP_NOTIFY_UPDATE_ERR,
+				BGP_NOTIFY_UPDATE_MAL_ATTR, NULL, 0);
 		ret = BGP_ATTR_PARSE_ERROR;
 		goto done;
 	}
@@ -5021,6 +5168,236 @@ void bgp_dump_routes_attr(struct stream *s, struct bgp_path_info *bpi,
 	stream_putw_at(s, cp, len);
 }
 
+/*
+ * Encoding of an attribute for RIB snapshots (bgp_snapshot.c).  Unlike the
+ * UPDATE encoding this keeps the values that are not sent on the wire, such
+ * as weight or the local-preference of eBGP paths, so it is only meant to
+ * be read back by bgpd itself.  Fixed fields come first, then a list of
+ * (type, length, value) for the referenced structures.
+ */
+#define BGP_ATTR_SNAPSHOT_TRANSIT 255
+
+static bool bgp_attr_snapshot_tlv(struct stream *s, uint8_t type,
+				  const void *val, size_t len)
+{
+	if (len > UINT16_MAX || STREAM_WRITEABLE(s) < len + 3)
+		return false;
+
+	stream_putc(s, type);
+	stream_putw(s, len);
+	stream_put(s, val, len);
+	return true;
+}
+
+static bool bgp_attr_snapshot_ecomm(struct stream *s, uint8_t type,
+				    const struct ecommunity *ecomm,
+				    size_t unit_size)
+{
+	size_t len = ecomm->size * unit_size;
+
+	if (len > UINT16_MAX || STREAM_WRITEABLE(s) < len + 4)
+		return false;
+
+	stream_putc(s, type);
+	stream_putw(s, len);
+	stream_putc(s, ecomm->disable_ieee_floating);
+	stream_put(s, ecomm->val, len);
+	return true;
+}
+
+bool bgp_attr_snapshot_put(struct stream *s, struct attr *attr)
+{
+	struct community *comm = bgp_attr_get_community(attr);
+	struct ecommunity *ecomm = bgp_attr_get_ecommunity(attr);
+	struct ecommunity *ipv6_ecomm = bgp_attr_get_ipv6_ecommunity(attr);
+	struct lcommunity *lcomm = bgp_attr_get_lcommunity(attr);
+	struct cluster_list *cluster = bgp_attr_get_cluster(attr);
+	struct transit *transit = bgp_attr_get_transit(attr);
+	size_t start;
+
+	/* only what unicast and multicast paths carry */
+	if (!attr->aspath || attr->srv6_l3vpn || attr->srv6_vpn ||
+	    attr->encap_subtlvs || bgp_attr_get_vnc_subtlvs(attr))
+		return false;
+
+	stream_putq(s, attr->flag);
+	stream_putc(s, attr->origin);
+	stream_put_in_addr(s, &attr->nexthop);
+	stream_putl(s, attr->med);
+	stream_putl(s, attr->local_pref);
+	stream_putl(s, attr->weight);
+	stream_putl(s, attr->tag);
+	stream_putl(s, attr->aggregator_as);
+	stream_put_in_addr(s, &attr->aggregator_addr);
+	stream_put_in_addr(s, &attr->originator_id);
+	stream_putc(s, attr->mp_nexthop_len);
+	stream_putc(s, attr->mp_nexthop_prefer_global);
+	stream_put(s, &attr->mp_nexthop_global, IPV6_MAX_BYTELEN);
+	stream_put(s, &attr->mp_nexthop_local, IPV6_MAX_BYTELEN);
+	stream_put_in_addr(s, &attr->mp_nexthop_global_in);
+	stream_putl(s, attr->nh_ifindex);
+	stream_putl(s, attr->nh_lla_ifindex);
+	stream_putc(s, attr->nh_type);
+	stream_putc(s, attr->bh_type);
+	stream_putc(s, attr->distance);
+	stream_putl(s, attr->rmap_table_id);
+	stream_putl(s, attr->label_index);
+	stream_putl(s, attr->label);
+	stream_putl(s, attr->link_bw);
+	stream_putl(s, attr->srte_color);
+	stream_putl(s, attr->otc);
+	stream_putq(s, attr->aigp_metric);
+
+	/* aspath_put() may pack segments, never grows beyond aspath_size() */
+	if (aspath_size(attr->aspath) > UINT16_MAX ||
+	    STREAM_WRITEABLE(s) < aspath_size(attr->aspath) + 3)
+		return false;
+	stream_putc(s, BGP_ATTR_AS_PATH);
+	start = stream_get_endp(s);
+	stream_putw(s, 0);
+	aspath_put(s, attr->aspath, 1);
+	stream_putw_at(s, start, stream_get_endp(s) - start - 2);
+
+	if (comm && !bgp_attr_snapshot_tlv(s, BGP_ATTR_COMMUNITIES, comm->val,
+					   comm->size * COMMUNITY_SIZE))
+		return false;
+	if (ecomm && !bgp_attr_snapshot_ecomm(s, BGP_ATTR_EXT_COMMUNITIES,
+					      ecomm, ECOMMUNITY_SIZE))
+		return false;
+	if (ipv6_ecomm &&
+	    !bgp_attr_snapshot_ecomm(s, BGP_ATTR_IPV6_EXT_COMMUNITIES,
+				     ipv6_ecomm, IPV6_ECOMMUNITY_SIZE))
+		return false;
+	if (lcomm && !bgp_attr_snapshot_tlv(s, BGP_ATTR_LARGE_COMMUNITIES,
+					    lcomm->val, lcom_length(lcomm)))
+		return false;
+	if (cluster && !bgp_attr_snapshot_tlv(s, BGP_ATTR_CLUSTER_LIST,
+					      cluster->list, cluster->length))
+		return false;
+	if (transit && !bgp_attr_snapshot_tlv(s, BGP_ATTR_SNAPSHOT_TRANSIT,
+					      transit->val, transit->length))
+		return false;
+
+	return true;
+}
+
+struct attr *bgp_attr_snapshot_get(struct bgp *bgp, struct stream *s)
+{
+	struct attr attr = {};
+	struct attr *interned = NULL;
+	struct transit *transit;
+	uint8_t type, floating = 0;
+	uint64_t seen = 0;
+	uint8_t *pnt;
+	uint16_t len;
+	bool ok;
+
+	STREAM_GETQ(s, attr.flag);
+	STREAM_GETC(s, attr.origin);
+	STREAM_GET(&attr.nexthop, s, IPV4_MAX_BYTELEN);
+	STREAM_GETL(s, attr.med);
+	STREAM_GETL(s, attr.local_pref);
+	STREAM_GETL(s, attr.weight);
+	STREAM_GETL(s, attr.tag);
+	STREAM_GETL(s, attr.aggregator_as);
+	STREAM_GET(&attr.aggregator_addr, s, IPV4_MAX_BYTELEN);
+	STREAM_GET(&attr.originator_id, s, IPV4_MAX_BYTELEN);
+	STREAM_GETC(s, attr.mp_nexthop_len);
+	STREAM_GETC(s, attr.mp_nexthop_prefer_global);
+	STREAM_GET(&attr.mp_nexthop_global, s, IPV6_MAX_BYTELEN);
+	STREAM_GET(&attr.mp_nexthop_local, s, IPV6_MAX_BYTELEN);
+	STREAM_GET(&attr.mp_nexthop_global_in, s, IPV4_MAX_BYTELEN);
+	STREAM_GETL(s, attr.nh_ifindex);
+	STREAM_GETL(s, attr.nh_lla_ifindex);
+	STREAM_GETC(s, attr.nh_type);
+	STREAM_GETC(s, attr.bh_type);
+	STREAM_GETC(s, attr.distance);
+	STREAM_GETL(s, attr.rmap_table_id);
+	STREAM_GETL(s, attr.label_index);
+	STREAM_GETL(s, attr.label);
+	STREAM_GETL(s, attr.link_bw);
+	STREAM_GETL(s, attr.srte_color);
+	STREAM_GETL(s, attr.otc);
+	STREAM_GETQ(s, attr.aigp_metric);
+
+	while (STREAM_READABLE(s)) {
+		STREAM_GETC(s, type);
+		STREAM_GETW(s, len);
+		if (type == BGP_ATTR_EXT_COMMUNITIES ||
+		    type == BGP_ATTR_IPV6_EXT_COMMUNITIES)
+			STREAM_GETC(s, floating);
+		if (STREAM_READABLE(s) < len)
+			goto stream_failure;
+
+		/* each of them is written once at most */
+		if (seen & (1ULL << (type & 63)))
+			goto stream_failure;
+		seen |= 1ULL << (type & 63);
+		pnt = stream_pnt(s);
+
+		switch (type) {
+		case BGP_ATTR_AS_PATH:
+			attr.aspath = aspath_parse(s, len, 1, bgp->asnotation);
+			if (!attr.aspath)
+				goto stream_failure;
+			continue;
+		case BGP_ATTR_COMMUNITIES:
+			bgp_attr_set_community(&attr,
+					       community_parse((uint32_t *)pnt,
+							       len));
+			ok = !!bgp_attr_get_community(&attr);
+			break;
+		case BGP_ATTR_EXT_COMMUNITIES:
+			bgp_attr_set_ecommunity(&attr,
+						ecommunity_parse(pnt, len,
+								 floating));
+			ok = !!bgp_attr_get_ecommunity(&attr);
+			break;
+		case BGP_ATTR_IPV6_EXT_COMMUNITIES:
+			bgp_attr_set_ipv6_ecommunity(
+				&attr,
+				ecommunity_parse_ipv6(pnt, len, floating));
+			ok = !!bgp_attr_get_ipv6_ecommunity(&attr);
+			break;
+		case BGP_ATTR_LARGE_COMMUNITIES:
+			bgp_attr_set_lcommunity(&attr,
+						lcommunity_parse(pnt, len));
+			ok = !!bgp_attr_get_lcommunity(&attr);
+			break;
+		case BGP_ATTR_CLUSTER_LIST:
+			ok = len % 4 == 0;
+			if (ok)
+				bgp_attr_set_cluster(
+					&attr,
+					cluster_parse((struct in_addr *)pnt,
+						      len));
+			break;
+		case BGP_ATTR_SNAPSHOT_TRANSIT:
+			ok = len > 0;
+			if (!ok)
+				break;
+			transit = XCALLOC(MTYPE_TRANSIT, sizeof(struct transit));
+			transit->val = XMALLOC(MTYPE_TRANSIT_VAL, len);
+			memcpy(transit->val, pnt, len);
+			transit->length = len;
+			bgp_attr_set_transit(&attr, transit_intern(transit));
+			break;
+		default:
+			ok = false;
+		}
+		if (!ok)
+			goto stream_failure;
+		stream_forward_getp(s, len);
+	}
+
+	if (attr.aspath)
+		interned = bgp_attr_intern(&attr);
+
+stream_failure:
+	bgp_attr_unintern_sub(&attr);
+	return interned;
+}
+
 void bgp_path_attribute_discard_vty(struct vty *vty, struct peer *peer,
 				    const char *discard_attrs, bool set)
 {
@@ -147,6 +147,11 @@ struct attr {
 	/* Reference count of this attribute. */
 	unsigned long refcnt;
 
+	/* Never reused id handed out when interned, lets route-maps remember
+	 * their outcome per attribute (route_map_apply_memo())
+	 */
+	uint64_t memo_id;
+
 	/* Flag of attribute is set or not. */
 	uint64_t flag;
 
@@ -375,9 +380,25 @@ extern void bgp_attr_finish(void);
 extern enum bgp_attr_parse_ret
 bgp_attr_parse(struct peer *peer, struct attr *attr, bgp_size_t size,
 	       struct bgp_nlri *mp_update, struct bgp_nlri *mp_withdraw);
+extern enum bgp_attr_parse_ret
+bgp_attr_parse_stream(struct peer *peer, struct stream *s,
+		      struct bgp_notify *notify, struct attr *attr,
+		      bgp_size_t size, struct bgp_nlri *mp_update,
+		      struct bgp_nlri *mp_withdraw);
 extern struct attr *bgp_attr_intern(struct attr *attr);
 extern void bgp_attr_unintern_sub(struct attr *attr);
 extern void bgp_attr_unintern(struct attr **pattr);
+
+/*
+ * Reference to the interned copy of an SRv6 L3 service TLV, leaving l3vpn
+ * alone.  For callers attaching the same TLV to many routes: the result can
+ * be set in attr->srv6_l3vpn directly and is shared by bgp_attr_intern().
+ */
+extern struct bgp_attr_srv6_l3vpn *
+bgp_attr_srv6_l3vpn_get(const struct bgp_attr_srv6_l3vpn *l3vpn);
+extern void bgp_attr_srv6_l3vpn_put(struct bgp_attr_srv6_l3vpn **l3vpnp);
+extern bool bgp_attr_srv6_l3vpn_same(const struct bgp_attr_srv6_l3vpn *h1,
+				     const struct bgp_attr_srv6_l3vpn *h2);
 extern void bgp_attr_flush(struct attr *attr);
 extern struct attr *bgp_attr_default_set(struct attr *attr, struct bgp *bgp,
 					 uint8_t origin);
@@ -394,11 +415,18 @@ extern bgp_size_t bgp_packet_attribute(
 	uint32_t addpath_tx_id, struct bgp_path_info *bpi);
 extern void bgp_dump_routes_attr(struct stream *s, struct bgp_path_info *bpi,
 				 const struct prefix *p);
+/* Encoding for RIB snapshots, false if the attribute can't be stored */
+extern bool bgp_attr_snapshot_put(struct stream *s, struct attr *attr);
+/* Decode what bgp_attr_snapshot_put() wrote, returns an interned attr */
+extern struct attr *bgp_attr_snapshot_get(struct bgp *bgp, struct stream *s);
 extern bool attrhash_cmp(const void *arg1, const void *arg2);
 extern unsigned int attrhash_key_make(const void *p);
 extern void attr_show_all(struct vty *vty);
 extern unsigned long int attr_count(void);
 extern unsigned long int attr_unknown_count(void);
+
+struct bgp_intern_stats;
+extern void attr_intern_stats_get(struct bgp_intern_stats *stats);
 extern void bgp_path_attribute_discard_vty(struct vty *vty, struct peer *peer,
 					   const char *discard_attrs, bool set);
 extern void bgp_path_attribute_withdraw_vty(struct vty *vty, struct peer *peer,
@@ -413,6 +441,11 @@ extern bool cluster_loop_check(struct cluster_list *cluster,
 /* Below exported for unit-test purposes only */
 struct bgp_attr_parser_args {
 	struct peer *peer;
+	struct stream *s;  /* positioned at the attribute data */
+	/* if set, errors needing a NOTIFICATION are recorded here instead
+	 * of being sent, see bgp_attr_parse_stream()
+	 */
+	struct bgp_notify *notify;
 	bgp_size_t length; /* attribute data length; */
 	bgp_size_t total;  /* total length, inc header */
 	struct attr *attr;
@@ -21,6 +21,7 @@
 #include "lib_errors.h"
 #include "stream.h"
 #include "libfrr.h"
+#include "mempressure.h"
 #include "lib/version.h"
 #include "jhash.h"
 #include "termtable.h"
@@ -521,9 +522,30 @@ static struct bmp_mirrorq *bmp_pull_mirror(struct bmp *bmp)
 	return bmq;
 }
 
+/* mirroring is lossy anyway, so it is the first thing to go under memory
+ * pressure
+ */
+#define BMP_MIRROR_PRESSURE_LIMIT (1024 * 1024)
+
+static size_t bmp_mirror_limit(struct bmp_bgp *bmpbgp)
+{
+	switch (mempressure_level()) {
+	case MEMPRESSURE_NONE:
+		break;
+	case MEMPRESSURE_SOFT:
+		return MIN(bmpbgp->mirror_qsizelimit,
+			   BMP_MIRROR_PRESSURE_LIMIT);
+	case MEMPRESSURE_HARD:
+		return 0;
+	}
+	return bmpbgp->mirror_qsizelimit;
+}
+
 static void bmp_mirror_cull(struct bmp_bgp *bmpbgp)
 {
-	while (bmpbgp->mirror_qsize > bmpbgp->mirror_qsizelimit) {
+	size_t limit = bmp_mirror_limit(bmpbgp);
+
+	while (bmpbgp->mirror_qsize > limit) {
 		struct bmp_mirrorq *bmq, *inner;
 		struct bmp_targets *bt;
 		struct bmp *bmp;
@@ -578,6 +600,18 @@ static int bmp_mirror_packet(struct peer *peer, uint8_t type, bgp_size_t size,
 	if (!bmpbgp)
 		return 0;
 
+	if (mempressure_level() == MEMPRESSURE_HARD) {
+		frr_each(bmp_targets, &bmpbgp->targets, bt) {
+			if (!bt->mirror)
+				continue;
+			frr_each(bmp_session, &bt->sessions, bmp) {
+				bmp->mirror_lost = true;
+				pullwr_bump(bmp->pullwr);
+			}
+		}
+		return 0;
+	}
+
 	qitem = XCALLOC(MTYPE_BMP_MIRRORQ, sizeof(*qitem) + size);
 	qitem->peerid = peer->qobj_node.nid;
 	qitem->tv = tv;
@@ -909,12 +943,14 @@ static struct stream *bmp_withdraw(const struct prefix *p,
 	return s;
 }
 
-static void bmp_monitor(struct bmp *bmp, struct peer *peer, uint8_t flags,
-			const struct prefix *p, struct prefix_rd *prd,
-			struct attr *attr, afi_t afi, safi_t safi,
-			time_t uptime)
+/* encode a full Route Monitoring message, header included */
+static struct stream *bmp_monitor_encode(struct peer *peer, uint8_t flags,
+					 const struct prefix *p,
+					 struct prefix_rd *prd,
+					 struct attr *attr, afi_t afi,
+					 safi_t safi, time_t uptime)
 {
-	struct stream *hdr, *msg;
+	struct stream *hdr, *msg, *s;
 	struct timeval tv = { .tv_sec = uptime, .tv_usec = 0 };
 	struct timeval uptime_real;
 
@@ -931,11 +967,24 @@ static void bmp_monitor(struct bmp *bmp, struct peer *peer, uint8_t flags,
 	stream_putl_at(hdr, BMP_LENGTH_POS,
 			stream_get_endp(hdr) + stream_get_endp(msg));
 
-	bmp->cnt_update++;
-	pullwr_write_stream(bmp->pullwr, hdr);
-	pullwr_write_stream(bmp->pullwr, msg);
+	s = stream_dupcat(hdr, msg, stream_get_endp(hdr));
 	stream_free(hdr);
 	stream_free(msg);
+	return s;
+}
+
+static void bmp_monitor(struct bmp *bmp, struct peer *peer, uint8_t flags,
+			const struct prefix *p, struct prefix_rd *prd,
+			struct attr *attr, afi_t afi, safi_t safi,
+			time_t uptime)
+{
+	struct stream *s;
+
+	s = bmp_monitor_encode(peer, flags, p, prd, attr, afi, safi, uptime);
+
+	bmp->cnt_update++;
+	pullwr_write_stream(bmp->pullwr, s);
+	stream_free(s);
 }
 
 static bool bmp_wrsync(struct bmp *bmp, struct pullwr *pullwr)
@@ -982,7 +1031,7 @@ afibreak:
 	struct bgp_table *table = bmp->targets->bgp->rib[afi][safi];
 	struct bgp_dest *bn = NULL;
 	struct bgp_path_info *bpi = NULL, *bpiter;
-	struct bgp_adj_in *adjin = NULL, *adjiter;
+	struct bgp_adj_in_iter adjin = {}, adjiter;
 
 	if ((afi == AFI_L2VPN && safi == SAFI_EVPN) ||
 	    (safi == SAFI_MPLS_VPN)) {
@@ -1064,35 +1113,35 @@ afibreak:
 			}
 		}
 		if (bmp->targets->afimon[afi][safi] & BMP_MON_PREPOLICY) {
-			for (adjiter = bn->adj_in; adjiter;
-			     adjiter = adjiter->next) {
-				if (adjiter->peer->qobj_node.nid
+			memset(&adjiter, 0, sizeof(adjiter));
+			while (bgp_adj_in_iter_next(bn, NULL, &adjiter)) {
+				if (adjiter.peer->qobj_node.nid
 				    <= bmp->syncpeerid)
 					continue;
-				if (adjin && adjiter->peer->qobj_node.nid
-						> adjin->peer->qobj_node.nid)
+				if (adjin.peer && adjiter.peer->qobj_node.nid
+						> adjin.peer->qobj_node.nid)
 					continue;
 				adjin = adjiter;
 			}
 		}
-		if (bpi || adjin)
+		if (bpi || adjin.peer)
 			break;
 
 		bn = NULL;
 	} while (1);
 
-	if (adjin && bpi
-	    && adjin->peer->qobj_node.nid < bpi->peer->qobj_node.nid) {
+	if (adjin.peer && bpi
+	    && adjin.peer->qobj_node.nid < bpi->peer->qobj_node.nid) {
 		bpi = NULL;
-		bmp->syncpeerid = adjin->peer->qobj_node.nid;
-	} else if (adjin && bpi
-		   && adjin->peer->qobj_node.nid > bpi->peer->qobj_node.nid) {
-		adjin = NULL;
+		bmp->syncpeerid = adjin.peer->qobj_node.nid;
+	} else if (adjin.peer && bpi
+		   && adjin.peer->qobj_node.nid > bpi->peer->qobj_node.nid) {
+		adjin.peer = NULL;
 		bmp->syncpeerid = bpi->peer->qobj_node.nid;
 	} else if (bpi) {
 		bmp->syncpeerid = bpi->peer->qobj_node.nid;
-	} else if (adjin) {
-		bmp->syncpeerid = adjin->peer->qobj_node.nid;
+	} else if (adjin.peer) {
+		bmp->syncpeerid = adjin.peer->qobj_node.nid;
 	}
 
 	const struct prefix *bn_p = bgp_dest_get_prefix(bn);
@@ -1104,9 +1153,9 @@ afibreak:
 	if (bpi)
 		bmp_monitor(bmp, bpi->peer, BMP_PEER_FLAG_L, bn_p, prd,
 			    bpi->attr, afi, safi, bpi->uptime);
-	if (adjin)
-		bmp_monitor(bmp, adjin->peer, 0, bn_p, prd, adjin->attr, afi,
-			    safi, adjin->uptime);
+	if (adjin.peer)
+		bmp_monitor(bmp, adjin.peer, 0, bn_p, prd, adjin.attr, afi,
+			    safi, adjin.uptime);
 
 	if (bn)
 		bgp_dest_unlock_node(bn);
@@ -1114,6 +1163,13 @@ afibreak:
 	return true;
 }
 
+static void bmp_qentry_free(struct bmp_queue_entry *bqe)
+{
+	stream_free(bqe->enc_prepolicy);
+	stream_free(bqe->enc_postpolicy);
+	XFREE(MTYPE_BMP_QUEUE, bqe);
+}
+
 static struct bmp_queue_entry *bmp_pull(struct bmp *bmp)
 {
 	struct bmp_queue_entry *bqe;
@@ -1166,53 +1222,77 @@ static bool bmp_wrqueue(struct bmp *bmp, struct pullwr *pullwr)
 	peer = QOBJ_GET_TYPESAFE(bqe->peerid, peer);
 	if (!peer) {
 		zlog_info("bmp: skipping queued item for deleted peer");
+		bmp->cnt_update_dropped++;
 		goto out;
 	}
-	if (!peer_established(peer))
+	if (!peer_established(peer)) {
+		bmp->cnt_update_dropped++;
 		goto out;
+	}
 
 	bool is_vpn = (bqe->afi == AFI_L2VPN && bqe->safi == SAFI_EVPN) ||
 		      (bqe->safi == SAFI_MPLS_VPN);
 
 	struct prefix_rd *prd = is_vpn ? &bqe->rd : NULL;
-	bn = bgp_safi_node_lookup(bmp->targets->bgp->rib[afi][safi], safi,
-				  &bqe->p, prd);
 
+	/* The messages only depend on the queue entry and the RIB; any RIB
+	 * change requeues the entry and drops the cached encoding, so all
+	 * sessions of the target can share what the first one built.
+	 */
+	if (((bmp->targets->afimon[afi][safi] & BMP_MON_POSTPOLICY) &&
+	     !bqe->enc_postpolicy) ||
+	    ((bmp->targets->afimon[afi][safi] & BMP_MON_PREPOLICY) &&
+	     !bqe->enc_prepolicy))
+		bn = bgp_safi_node_lookup(bmp->targets->bgp->rib[afi][safi],
+					  safi, &bqe->p, prd);
 
 	if (bmp->targets->afimon[afi][safi] & BMP_MON_POSTPOLICY) {
 		struct bgp_path_info *bpi;
 
-		for (bpi = bn ? bgp_dest_get_bgp_path_info(bn) : NULL; bpi;
-		     bpi = bpi->next) {
-			if (!CHECK_FLAG(bpi->flags, BGP_PATH_VALID))
-				continue;
-			if (bpi->peer == peer)
-				break;
-		}
+		if (!bqe->enc_postpolicy) {
+			for (bpi = bn ? bgp_dest_get_bgp_path_info(bn) : NULL;
+			     bpi; bpi = bpi->next) {
+				if (!CHECK_FLAG(bpi->flags, BGP_PATH_VALID))
+					continue;
+				if (bpi->peer == peer)
+					break;
+			}
+
+			bqe->enc_postpolicy = bmp_monitor_encode(
+				peer, BMP_PEER_FLAG_L, &bqe->p, prd,
+				bpi ? bpi->attr : NULL, afi, safi,
+				bpi ? bpi->uptime : monotime(NULL));
+			bmp->targets->cnt_mon_encoded++;
+		} else
+			bmp->targets->cnt_mon_reused++;
 
-		bmp_monitor(bmp, peer, BMP_PEER_FLAG_L, &bqe->p, prd,
-			    bpi ? bpi->attr : NULL, afi, safi,
-			    bpi ? bpi->uptime : monotime(NULL));
+		bmp->cnt_update++;
+		pullwr_write_stream(bmp->pullwr, bqe->enc_postpolicy);
 		written = true;
 	}
 
 	if (bmp->targets->afimon[afi][safi] & BMP_MON_PREPOLICY) {
-		struct bgp_adj_in *adjin;
+		struct bgp_adj_in_iter adjin = {};
 
-		for (adjin = bn ? bn->adj_in : NULL; adjin;
-		     adjin = adjin->next) {
-			if (adjin->peer == peer)
-				break;
-		}
-		bmp_monitor(bmp, peer, 0, &bqe->p, prd,
-			    adjin ? adjin->attr : NULL, afi, safi,
-			    adjin ? adjin->uptime : monotime(NULL));
+		if (!bqe->enc_prepolicy) {
+			if (bn)
+				bgp_adj_in_iter_next(bn, peer, &adjin);
+
+			bqe->enc_prepolicy = bmp_monitor_encode(
+				peer, 0, &bqe->p, prd, adjin.attr, afi, safi,
+				adjin.peer ? adjin.uptime : monotime(NULL));
+			bmp->targets->cnt_mon_encoded++;
+		} else
+			bmp->targets->cnt_mon_reused++;
+
+		bmp->cnt_update++;
+		pullwr_write_stream(bmp->pullwr, bqe->enc_prepolicy);
 		written = true;
 	}
 
 out:
 	if (!bqe->refcount)
-		XFREE(MTYPE_BMP_QUEUE, bqe);
+		bmp_qentry_free(bqe);
 
 	if (bn)
 		bgp_dest_unlock_node(bn);
@@ -1280,6 +1360,12 @@ static void bmp_process_one(struct bmp_targets *bt, struct bgp *bgp, afi_t afi,
 			return;
 
 		bmp_qlist_del(&bt->updlist, bqe);
+
+		/* the route changed again, cached messages are stale */
+		stream_free(bqe->enc_prepolicy);
+		bqe->enc_prepolicy = NULL;
+		stream_free(bqe->enc_postpolicy);
+		bqe->enc_postpolicy = NULL;
 	} else {
 		bqe = XMALLOC(MTYPE_BMP_QUEUE, sizeof(*bqe));
 		memcpy(bqe, &bqeref, sizeof(*bqe));
@@ -1288,6 +1374,7 @@ static void bmp_process_one(struct bmp_targets *bt, struct bgp *bgp, afi_t afi,
 	}
 
 	bqe->refcount = refcount;
+	monotime(&bqe->t_queued);
 	bmp_qlist_add_tail(&bt->updlist, bqe);
 
 	frr_each (bmp_session, &bt->sessions, bmp)
@@ -1527,7 +1614,7 @@ static void bmp_close(struct bmp *bmp)
 			XFREE(MTYPE_BMP_MIRRORQ, bmq);
 	while ((bqe = bmp_pull(bmp)))
 		if (!bqe->refcount)
-			XFREE(MTYPE_BMP_QUEUE, bqe);
+			bmp_qentry_free(bqe);
 
 	EVENT_OFF(bmp->t_read);
 	pullwr_del(bmp->pullwr);
@@ -2433,24 +2520,39 @@ DEFPY(show_bmp,
 			XFREE(MTYPE_TMP, out);
 			ttable_del(tt);
 
+			vty_out(vty,
+				"\n    Route Monitoring queue: %zu entries, %" PRIu64
+				" messages encoded, %" PRIu64 " reused\n",
+				bmp_qlist_count(&bt->updlist),
+				bt->cnt_mon_encoded, bt->cnt_mon_reused);
+
 			vty_out(vty, "\n    %zu connected clients:\n",
 					bmp_session_count(&bt->sessions));
 			tt = ttable_new(&ttable_styles[TTSTYLE_BLANK]);
-			ttable_add_row(tt, "remote|uptime|MonSent|MirrSent|MirrLost|ByteSent|ByteQ|ByteQKernel");
+			ttable_add_row(tt, "remote|uptime|MonSent|MonDrop|MonLag|MirrSent|MirrLost|ByteSent|ByteQ|ByteQKernel");
 			ttable_rowseps(tt, 0, BOTTOM, true, '-');
 
 			frr_each (bmp_session, &bt->sessions, bmp) {
 				uint64_t total;
 				size_t q, kq;
+				int64_t lag = 0;
 
 				pullwr_stats(bmp->pullwr, &total, &q, &kq);
 
 				peer_uptime(bmp->t_up.tv_sec, uptime,
 					    sizeof(uptime), false, NULL);
 
-				ttable_add_row(tt, "%s|%s|%Lu|%Lu|%Lu|%Lu|%zu|%zu",
+				/* age of the oldest item still to be sent */
+				if (bmp->queuepos)
+					lag = monotime_since(
+						      &bmp->queuepos->t_queued,
+						      NULL) /
+					      1000;
+
+				ttable_add_row(tt, "%s|%s|%Lu|%Lu|%" PRId64 "ms|%Lu|%Lu|%Lu|%zu|%zu",
 					       bmp->remote, uptime,
 					       bmp->cnt_update,
+					       bmp->cnt_update_dropped, lag,
 					       bmp->cnt_mirror,
 					       bmp->cnt_mirror_overruns,
 					       total, q, kq);
@@ -2553,6 +2655,16 @@ static int bgp_bmp_init(struct event_loop *tm)
 	return 0;
 }
 
+static int bmp_memory_pressure(enum mempressure_level level,
+			       enum mempressure_level prev)
+{
+	struct bmp_bgp *bmpbgp;
+
+	frr_each(bmp_bgph, &bmp_bgph, bmpbgp)
+		bmp_mirror_cull(bmpbgp);
+	return 0;
+}
+
 static int bgp_bmp_module_init(void)
 {
 	hook_register(bgp_packet_dump, bmp_mirror_packet);
@@ -2562,6 +2674,7 @@ static int bgp_bmp_module_init(void)
 	hook_register(bgp_process, bmp_process);
 	hook_register(bgp_inst_config_write, bmp_config_write);
 	hook_register(bgp_inst_delete, bmp_bgp_del);
+	hook_register(memory_pressure, bmp_memory_pressure);
 	hook_register(frr_late_init, bgp_bmp_init);
 	return 0;
 }
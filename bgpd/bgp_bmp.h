@@ -69,6 +69,16 @@ struct bmp_queue_entry {
 
 	/* initialized only for L2VPN/EVPN (S)AFIs */
 	struct prefix_rd rd;
+
+	/* when this entry was (re)queued, for the lag shown in "show bmp" */
+	struct timeval t_queued;
+
+	/* Route Monitoring messages for this entry, encoded by the first
+	 * session that pulls it and reused by all others.  Dropped whenever
+	 * the entry is requeued because the route changed again.
+	 */
+	struct stream *enc_prepolicy;
+	struct stream *enc_postpolicy;
 };
 
 /* This is for BMP Route Mirroring, which feeds fully raw BGP PDUs out to BMP
@@ -133,6 +143,8 @@ struct bmp {
 
 	/* counters for the various BMP packet types */
 	uint64_t cnt_update, cnt_mirror;
+	/* queued route monitoring items not sent because the peer went away */
+	uint64_t cnt_update_dropped;
 	/* number of times this peer wasn't fast enough in consuming the
 	 * mirror queue
 	 */
@@ -234,6 +246,9 @@ struct bmp_targets {
 
 	uint64_t cnt_accept, cnt_aclrefused;
 
+	/* Route Monitoring messages encoded vs. reused from the queue entry */
+	uint64_t cnt_mon_encoded, cnt_mon_reused;
+
 	QOBJ_FIELDS;
 };
 DECLARE_QOBJ_TYPE(bmp_targets);
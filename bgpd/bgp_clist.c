@@ -913,6 +913,8 @@ int community_list_set(struct community_list_handler *ch, const char *name,
 	entry->direct = direct;
 	entry->style = style;
 	entry->any = (str ? false : true);
+	if (com)
+		community_set_sorted(com);
 	entry->u.com = com;
 	entry->reg = regex;
 	entry->seq = seqnum;
@@ -1128,6 +1130,8 @@ int lcommunity_list_set(struct community_list_handler *ch, const char *name,
 	entry->direct = direct;
 	entry->style = style;
 	entry->any = (str ? false : true);
+	if (lcom)
+		lcommunity_set_sorted(lcom);
 	entry->u.lcom = lcom;
 	entry->reg = regex;
 	entry->seq = seqnum;
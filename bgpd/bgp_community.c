@@ -14,9 +14,10 @@
 #include "bgpd/bgp_memory.h"
 #include "bgpd/bgp_community.h"
 #include "bgpd/bgp_community_alias.h"
+#include "bgpd/bgp_intern.h"
 
-/* Hash of community attribute. */
-static struct hash *comhash;
+/* Hash of community attribute.  Sharded, see bgp_intern.h. */
+static struct bgp_intern_table comhash;
 
 /* Allocate a new communities value.  */
 static struct community *community_new(void)
@@ -461,50 +462,62 @@ CPP_NOTICE("Deprecate COMMUNITY_INTERNET BGP community")
 	com->str = str;
 }
 
-/* Intern communities attribute.  */
+/* Intern communities attribute.  If com already is interned, this just
+   takes another reference.  */
 struct community *community_intern(struct community *com)
 {
+	struct bgp_intern_shard *shard;
 	struct community *find;
 
-	/* Assert this community structure is not interned. */
-	assert(com->refcnt == 0);
+	shard = bgp_intern_shard(&comhash, com);
+	frr_with_mutex (&shard->mtx) {
+		if (com->refcnt)
+			find = com;
+		else {
+			/* Lookup community hash. */
+			find = bgp_intern_shard_get(shard, com,
+						    hash_alloc_intern);
+			if (find == com)
+				community_set_sorted(find);
+		}
 
-	/* Lookup community hash. */
-	find = (struct community *)hash_get(comhash, com, hash_alloc_intern);
+		/* Increment refrence counter.  */
+		find->refcnt++;
+	}
 
 	/* Arguemnt com is allocated temporary.  So when it is not used in
 	   hash, it should be freed.  */
 	if (find != com)
 		community_free(&com);
 
-	/* Increment refrence counter.  */
-	find->refcnt++;
-
-	/* Make string.  */
-	if (!find->str)
-		set_community_string(find, false, true);
-
+	/* The string is only made when something asks for it, most
+	   communities are never displayed or matched by a regex.  */
 	return find;
 }
 
 /* Free community attribute. */
 void community_unintern(struct community **com)
 {
+	struct bgp_intern_shard *shard;
 	struct community *ret;
 
 	if (!*com)
 		return;
 
-	if ((*com)->refcnt)
-		(*com)->refcnt--;
+	shard = bgp_intern_shard(&comhash, *com);
+	frr_with_mutex (&shard->mtx) {
+		if ((*com)->refcnt)
+			(*com)->refcnt--;
 
-	/* Pull off from hash.  */
-	if ((*com)->refcnt == 0) {
-		/* Community value com must exist in hash. */
-		ret = (struct community *)hash_release(comhash, *com);
-		assert(ret != NULL);
+		/* Pull off from hash.  */
+		if ((*com)->refcnt == 0) {
+			/* Community value com must exist in hash. */
+			ret = (struct community *)hash_release(shard->hash,
+							       *com);
+			assert(ret != NULL);
 
-		community_free(com);
+			community_free(com);
+		}
 	}
 }
 
@@ -565,6 +578,45 @@ unsigned int community_hash_make(const struct community *com)
 	return jhash2(pnt, com->size, 0x43ea96c1);
 }
 
+void community_set_sorted(struct community *com)
+{
+	int i;
+
+	com->sorted = true;
+	for (i = 1; i < com->size; i++)
+		if (ntohl(com->val[i - 1]) >= ntohl(com->val[i])) {
+			com->sorted = false;
+			return;
+		}
+}
+
+/* com1 and com2 are both sorted: binary search each of com2's values in
+ * whatever is left of com1, which is much cheaper than the merge below when
+ * a path with many communities is matched against a short list entry.
+ */
+static bool community_match_sorted(const struct community *com1,
+				   const struct community *com2)
+{
+	int lo = 0, hi, mid, j;
+	uint32_t want;
+
+	for (j = 0; j < com2->size; j++) {
+		want = ntohl(com2->val[j]);
+		hi = com1->size;
+		while (lo < hi) {
+			mid = lo + (hi - lo) / 2;
+			if (ntohl(com1->val[mid]) < want)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo == com1->size || com1->val[lo] != com2->val[j])
+			return false;
+		lo++;
+	}
+	return true;
+}
+
 bool community_match(const struct community *com1, const struct community *com2)
 {
 	int i = 0;
@@ -579,6 +631,9 @@ bool community_match(const struct community *com1, const struct community *com2)
 	if (com1->size < com2->size)
 		return false;
 
+	if (com1->sorted && com2->sorted)
+		return community_match_sorted(com1, com2);
+
 	/* Every community on com2 needs to be on com1 for this to match */
 	while (i < com1->size && j < com2->size) {
 		if (memcmp(com1->val + i, com2->val + j, sizeof(uint32_t)) == 0)
@@ -892,22 +947,22 @@ struct community *community_str2com(const char *str)
 /* Return communities hash entry count.  */
 unsigned long community_count(void)
 {
-	return comhash->count;
+	return bgp_intern_table_count(&comhash);
 }
 
-/* Return communities hash.  */
-struct hash *community_hash(void)
+/* Walk the communities hash, see bgp_intern_table_iterate().  */
+void community_iterate(void (*func)(struct hash_bucket *, void *), void *arg)
 {
-	return comhash;
+	bgp_intern_table_iterate(&comhash, func, arg);
 }
 
 /* Initialize comminity related hash. */
 void community_init(void)
 {
-	comhash =
-		hash_create((unsigned int (*)(const void *))community_hash_make,
-			    (bool (*)(const void *, const void *))community_cmp,
-			    "BGP Community Hash");
+	bgp_intern_table_init(&comhash, HASH_INITIAL_SIZE,
+			      (unsigned int (*)(const void *))community_hash_make,
+			      (bool (*)(const void *, const void *))community_cmp,
+			      "BGP Community Hash", 0);
 }
 
 static void community_hash_free(void *data)
@@ -919,7 +974,7 @@ static void community_hash_free(void *data)
 
 void community_finish(void)
 {
-	hash_clean_and_free(&comhash, community_hash_free);
+	bgp_intern_table_finish(&comhash, community_hash_free);
 }
 
 static struct community *bgp_aggr_community_lookup(
@@ -957,21 +1012,67 @@ void bgp_aggr_community_remove(void *arg)
 	community_free(&community);
 }
 
-void bgp_compute_aggregate_community(struct bgp_aggregate *aggregate,
-				     struct community *community)
+/* Count the values of a community entering the aggregate's hash.  If aggr
+ * is given, the values not seen before are merged into it.
+ */
+static bool bgp_aggr_community_vals_add(struct bgp_aggregate *aggregate,
+					struct community *community,
+					struct community **aggr)
 {
-	bgp_compute_aggregate_community_hash(aggregate, community);
-	bgp_compute_aggregate_community_val(aggregate);
+	bool changed = false;
+	int i;
+
+	for (i = 0; i < community->size; i++) {
+		if (!bgp_aggr_val_add(&aggregate->community_vals,
+				      com_nthval(community, i), COMMUNITY_SIZE)
+		    || !aggr)
+			continue;
+
+		if (!*aggr)
+			*aggr = community_new();
+		community_add_val(*aggr, community_val_get(community, i));
+		changed = true;
+	}
+
+	if (changed)
+		qsort((*aggr)->val, (*aggr)->size, sizeof(uint32_t),
+		      community_compare);
+	return changed;
 }
 
+/* Uncount the values of a community leaving the aggregate's hash.  If aggr
+ * is given, the values nobody else carries are removed from it.
+ */
+static bool bgp_aggr_community_vals_del(struct bgp_aggregate *aggregate,
+					struct community *community,
+					struct community **aggr)
+{
+	bool changed = false;
+	int i;
 
-void bgp_compute_aggregate_community_hash(struct bgp_aggregate *aggregate,
-					  struct community *community)
+	for (i = 0; i < community->size; i++) {
+		if (!bgp_aggr_val_del(aggregate->community_vals,
+				      com_nthval(community, i), COMMUNITY_SIZE)
+		    || !aggr || !*aggr)
+			continue;
+
+		community_del_val(*aggr, com_nthval(community, i));
+		changed = true;
+	}
+
+	if (changed && !(*aggr)->size)
+		community_free(aggr);
+	return changed;
+}
+
+static bool bgp_aggr_community_get(struct bgp_aggregate *aggregate,
+				   struct community *community,
+				   struct community **aggr)
 {
 	struct community *aggr_community = NULL;
 
 	if ((aggregate == NULL) || (community == NULL))
-		return;
+		return false;
 
 	/* Create hash if not already created.
 	 */
@@ -991,7 +1092,53 @@ void bgp_compute_aggregate_community_hash(struct bgp_aggregate *aggregate,
 
 	/* Increment reference counter.
 	 */
-	aggr_community->refcnt++;
+	if (aggr_community->refcnt++)
+		return false;
+
+	return bgp_aggr_community_vals_add(aggregate, aggr_community, aggr);
+}
+
+static bool bgp_aggr_community_put(struct bgp_aggregate *aggregate,
+				   struct community *community,
+				   struct community **aggr)
+{
+	struct community *aggr_community = NULL;
+	bool changed;
+
+	if ((!aggregate)
+	    || (!aggregate->community_hash)
+	    || (!community))
+		return false;
+
+	/* Look-up the community in the hash.
+	 */
+	aggr_community = bgp_aggr_community_lookup(aggregate, community);
+	if (!aggr_community || --aggr_community->refcnt)
+		return false;
+
+	hash_release(aggregate->community_hash, aggr_community);
+	changed = bgp_aggr_community_vals_del(aggregate, aggr_community, aggr);
+	community_free(&aggr_community);
+	return changed;
+}
+
+/* Add a route's community to the aggregate, updating the aggregate's
+ * community in place.  Returns true if the latter changed.
+ */
+bool bgp_compute_aggregate_community(struct bgp_aggregate *aggregate,
+				     struct community *community)
+{
+	if (aggregate == NULL)
+		return false;
+
+	return bgp_aggr_community_get(aggregate, community,
+				      &aggregate->community);
+}
+
+void bgp_compute_aggregate_community_hash(struct bgp_aggregate *aggregate,
+					  struct community *community)
+{
+	bgp_aggr_community_get(aggregate, community, NULL);
 }
 
 void bgp_compute_aggregate_community_val(struct bgp_aggregate *aggregate)
@@ -1019,55 +1166,18 @@ void bgp_compute_aggregate_community_val(struct bgp_aggregate *aggregate)
 
 
 
-void bgp_remove_community_from_aggregate(struct bgp_aggregate *aggregate,
+bool bgp_remove_community_from_aggregate(struct bgp_aggregate *aggregate,
 					 struct community *community)
 {
-	struct community *aggr_community = NULL;
-	struct community *ret_comm = NULL;
-
-	if ((!aggregate)
-	    || (!aggregate->community_hash)
-	    || (!community))
-		return;
-
-	/* Look-up the community in the hash.
-	 */
-	aggr_community = bgp_aggr_community_lookup(aggregate, community);
-	if (aggr_community) {
-		aggr_community->refcnt--;
-
-		if (aggr_community->refcnt == 0) {
-			ret_comm = hash_release(aggregate->community_hash,
-						aggr_community);
-			community_free(&ret_comm);
+	if (aggregate == NULL)
+		return false;
 
-			bgp_compute_aggregate_community_val(aggregate);
-		}
-	}
+	return bgp_aggr_community_put(aggregate, community,
+				      &aggregate->community);
 }
 
 void bgp_remove_comm_from_aggregate_hash(struct bgp_aggregate *aggregate,
 		struct community *community)
 {
-
-	struct community *aggr_community = NULL;
-	struct community *ret_comm = NULL;
-
-	if ((!aggregate)
-	    || (!aggregate->community_hash)
-	    || (!community))
-		return;
-
-	/* Look-up the community in the hash.
-	 */
-	aggr_community = bgp_aggr_community_lookup(aggregate, community);
-	if (aggr_community) {
-		aggr_community->refcnt--;
-
-		if (aggr_community->refcnt == 0) {
-			ret_comm = hash_release(aggregate->community_hash,
-						aggr_community);
-			community_free(&ret_comm);
-		}
-	}
+	bgp_aggr_community_put(aggregate, community, NULL);
 }
@@ -25,8 +25,16 @@ struct community {
 	json_object *json;
 
 	/* String of community attribute.  This sring is used by vty output
-	   and expanded community-list for regular expression match.  */
+	   and expanded community-list for regular expression match.  It is
+	   only built when first needed, see community_str().  */
 	char *str;
+
+	/* Values are in strictly ascending order, which lets
+	 * community_match() binary search them.  Only set on communities
+	 * that do not change any more: interned ones and community-list
+	 * entries.
+	 */
+	bool sorted;
 };
 
 /* Well-known communities value.  */
@@ -71,6 +79,7 @@ extern unsigned int community_hash_make(const struct community *com);
 extern struct community *community_str2com(const char *str);
 extern bool community_match(const struct community *com1,
 			    const struct community *com2);
+extern void community_set_sorted(struct community *com);
 extern bool community_cmp(const struct community *c1,
 			  const struct community *c2);
 extern struct community *community_merge(struct community *com1,
@@ -82,9 +91,10 @@ extern bool community_include(struct community *com, uint32_t val);
 extern void community_add_val(struct community *com, uint32_t val);
 extern void community_del_val(struct community *com, uint32_t *val);
 extern unsigned long community_count(void);
-extern struct hash *community_hash(void);
+extern void community_iterate(void (*func)(struct hash_bucket *, void *),
+			      void *arg);
 extern uint32_t community_val_get(struct community *com, int i);
-extern void bgp_compute_aggregate_community(struct bgp_aggregate *aggregate,
+extern bool bgp_compute_aggregate_community(struct bgp_aggregate *aggregate,
 					    struct community *community);
 
 extern void bgp_compute_aggregate_community_val(
@@ -92,7 +102,7 @@ extern void bgp_compute_aggregate_community_val(
 extern void bgp_compute_aggregate_community_hash(
 						struct bgp_aggregate *aggregate,
 						struct community *community);
-extern void bgp_remove_community_from_aggregate(struct bgp_aggregate *aggregate,
+extern bool bgp_remove_community_from_aggregate(struct bgp_aggregate *aggregate,
 						struct community *community);
 extern void bgp_remove_comm_from_aggregate_hash(struct bgp_aggregate *aggregate,
 						struct community *community);
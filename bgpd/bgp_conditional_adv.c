@@ -7,52 +7,218 @@
 
 #include <zebra.h>
 
+#include "jhash.h"
+
 #include "bgpd/bgp_conditional_adv.h"
 #include "bgpd/bgp_vty.h"
 
-static route_map_result_t
-bgp_check_rmap_prefixes_in_bgp_table(struct bgp_table *table,
-				     struct route_map *rmap)
+DEFINE_MTYPE_STATIC(BGPD, BGP_CONDADV, "BGP conditional advertisement");
+
+/*
+ * A condition map as used by one or more peers on one table.  Rather than
+ * scanning the table for matches periodically, every dest bgp_process()
+ * handles is run through the condition maps of its table, and the dests
+ * having a matching path are kept in a set.  Only the set becoming empty or
+ * non-empty changes the outcome for the peers using the condition map.
+ */
+static void bgp_conditional_adv_timer(struct event *t);
+
+struct bgp_condadv_cond {
+	afi_t afi;
+	safi_t safi;
+	char *name;
+
+	/* dests with a path permitted by the map, locked */
+	struct hash *dests;
+
+	/* generation of the evaluation run that last scanned the table */
+	uint32_t scan_gen;
+	bool used;
+};
+
+static unsigned int bgp_condadv_dest_key(const void *arg)
+{
+	return jhash(&arg, sizeof(arg), 0);
+}
+
+static bool bgp_condadv_dest_cmp(const void *a, const void *b)
+{
+	return a == b;
+}
+
+static void bgp_condadv_dest_free(void *arg)
+{
+	bgp_dest_unlock_node(arg);
+}
+
+static void bgp_condadv_cond_flush(struct bgp_condadv_cond *cond)
+{
+	hash_clean(cond->dests, bgp_condadv_dest_free);
+}
+
+static void bgp_condadv_cond_free(struct bgp_condadv_cond *cond)
+{
+	hash_clean_and_free(&cond->dests, bgp_condadv_dest_free);
+	XFREE(MTYPE_BGP_FILTER_NAME, cond->name);
+	XFREE(MTYPE_BGP_CONDADV, cond);
+}
+
+static struct bgp_condadv_cond *bgp_condadv_cond_find(struct bgp *bgp,
+						      afi_t afi, safi_t safi,
+						      const char *name)
+{
+	struct bgp_condadv_cond *cond;
+	struct listnode *node;
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->condadv_conds, node, cond))
+		if (cond->afi == afi && cond->safi == safi &&
+		    strcmp(cond->name, name) == 0)
+			return cond;
+
+	return NULL;
+}
+
+static struct bgp_condadv_cond *bgp_condadv_cond_get(struct bgp *bgp,
+						     afi_t afi, safi_t safi,
+						     const char *name)
+{
+	struct bgp_condadv_cond *cond;
+
+	cond = bgp_condadv_cond_find(bgp, afi, safi, name);
+	if (cond)
+		return cond;
+
+	cond = XCALLOC(MTYPE_BGP_CONDADV, sizeof(*cond));
+	cond->afi = afi;
+	cond->safi = safi;
+	cond->name = XSTRDUP(MTYPE_BGP_FILTER_NAME, name);
+	cond->dests = hash_create(bgp_condadv_dest_key, bgp_condadv_dest_cmp,
+				  "BGP conditional advertisement dests");
+	/* never scanned, generation 0 is not used */
+	cond->scan_gen = 0;
+
+	listnode_add(bgp->condadv_conds, cond);
+	return cond;
+}
+
+static bool bgp_condadv_dest_match(struct bgp_dest *dest,
+				   struct route_map *rmap)
 {
 	struct attr dummy_attr = {0};
-	struct bgp_dest *dest;
 	struct bgp_path_info *pi;
 	struct bgp_path_info path = {0};
 	struct bgp_path_info_extra path_extra = {0};
 	const struct prefix *dest_p;
-	route_map_result_t ret = RMAP_DENYMATCH;
+	route_map_result_t ret;
 
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		dest_p = bgp_dest_get_prefix(dest);
-		assert(dest_p);
+	dest_p = bgp_dest_get_prefix(dest);
+	assert(dest_p);
 
-		for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next) {
-			dummy_attr = *pi->attr;
+	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next) {
+		if (CHECK_FLAG(pi->flags, BGP_PATH_REMOVED))
+			continue;
 
-			/* Fill temp path_info */
-			prep_for_rmap_apply(&path, &path_extra, dest, pi,
-					    pi->peer, &dummy_attr);
+		dummy_attr = *pi->attr;
 
-			RESET_FLAG(dummy_attr.rmap_change_flags);
+		/* Fill temp path_info */
+		prep_for_rmap_apply(&path, &path_extra, dest, pi, pi->peer,
+				    &dummy_attr);
 
-			ret = route_map_apply(rmap, dest_p, &path);
-			bgp_attr_flush(&dummy_attr);
+		RESET_FLAG(dummy_attr.rmap_change_flags);
 
-			if (ret == RMAP_PERMITMATCH) {
-				bgp_dest_unlock_node(dest);
-				bgp_cond_adv_debug(
-					"%s: Condition map routes present in BGP table",
-					__func__);
+		ret = route_map_apply(rmap, dest_p, &path);
+		bgp_attr_flush(&dummy_attr);
 
-				return ret;
-			}
+		if (ret == RMAP_PERMITMATCH)
+			return true;
+	}
+
+	return false;
+}
+
+/* Full table scan, only after the condition map (or its use) changed. */
+static void bgp_condadv_cond_scan(struct bgp_condadv_cond *cond,
+				  struct bgp_table *table,
+				  struct route_map *rmap)
+{
+	struct bgp_dest *dest;
+
+	bgp_condadv_cond_flush(cond);
+
+	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest))
+		if (bgp_condadv_dest_match(dest, rmap))
+			(void)hash_get(cond->dests, bgp_dest_lock_node(dest),
+				       hash_alloc_intern);
+
+	bgp_cond_adv_debug("%s: %s condition map %s routes %spresent in BGP table",
+			   __func__, get_afi_safi_str(cond->afi, cond->safi,
+						      false),
+			   cond->name, cond->dests->count ? "" : "not ");
+}
+
+void bgp_conditional_adv_schedule(struct bgp *bgp)
+{
+	if (!bgp->condition_filter_count)
+		return;
+
+	if (!event_is_scheduled(bgp->t_condition_check))
+		event_add_timer(bm->master, bgp_conditional_adv_timer, bgp, 0,
+				&bgp->t_condition_check);
+}
+
+/*
+ * Called for every dest bgp_process() handled: update the matching dest
+ * sets of the condition maps on this table, and have the peers evaluated
+ * again if one of them goes from empty to non-empty or back.
+ */
+void bgp_conditional_adv_dest_update(struct bgp *bgp, afi_t afi, safi_t safi,
+				     struct bgp_dest *dest)
+{
+	struct bgp_condadv_cond *cond;
+	struct route_map *rmap;
+	struct listnode *node;
+	struct bgp_dest *found;
+	bool match;
+
+	if (!bgp->condadv_conds || !listcount(bgp->condadv_conds))
+		return;
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->condadv_conds, node, cond)) {
+		if (cond->afi != afi || cond->safi != safi || !cond->scan_gen)
+			continue;
+
+		rmap = route_map_lookup_by_name(cond->name);
+		match = rmap && bgp_condadv_dest_match(dest, rmap);
+		found = hash_lookup(cond->dests, dest);
+
+		if (match && !found) {
+			(void)hash_get(cond->dests, bgp_dest_lock_node(dest),
+				       hash_alloc_intern);
+			if (cond->dests->count == 1)
+				bgp_conditional_adv_schedule(bgp);
+		} else if (!match && found) {
+			hash_release(cond->dests, found);
+			bgp_dest_unlock_node(found);
+			if (cond->dests->count == 0)
+				bgp_conditional_adv_schedule(bgp);
 		}
 	}
+}
+
+void bgp_conditional_adv_fini(struct bgp *bgp)
+{
+	struct bgp_condadv_cond *cond;
 
-	bgp_cond_adv_debug("%s: Condition map routes not present in BGP table",
-			   __func__);
+	EVENT_OFF(bgp->t_condition_check);
+
+	if (!bgp->condadv_conds)
+		return;
 
-	return ret;
+	while ((cond = listnode_head(bgp->condadv_conds))) {
+		listnode_delete(bgp->condadv_conds, cond);
+		bgp_condadv_cond_free(cond);
+	}
+	list_delete(&bgp->condadv_conds);
 }
 
 static void bgp_conditional_adv_routes(struct peer *peer, afi_t afi,
@@ -147,8 +313,48 @@ static void bgp_conditional_adv_routes(struct peer *peer, afi_t afi,
 	UNSET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
 }
 
-/* Handler of conditional advertisement timer event.
- * Each route in the condition-map is evaluated.
+/* Drop the condition maps no configured peer uses any more. */
+static void bgp_condadv_cond_gc(struct bgp *bgp)
+{
+	struct bgp_condadv_cond *cond;
+	struct listnode *node, *nnode;
+	struct bgp_filter *filter;
+	struct peer *peer;
+	afi_t afi;
+	safi_t safi;
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->condadv_conds, node, cond))
+		cond->used = false;
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
+		FOREACH_AFI_SAFI (afi, safi) {
+			filter = &peer->filter[afi][safi];
+			if (!filter->advmap.cname)
+				continue;
+
+			cond = bgp_condadv_cond_find(
+				bgp, afi,
+				safi == SAFI_LABELED_UNICAST ? SAFI_UNICAST
+							     : safi,
+				filter->advmap.cname);
+			if (cond)
+				cond->used = true;
+		}
+	}
+
+	for (ALL_LIST_ELEMENTS(bgp->condadv_conds, node, nnode, cond)) {
+		if (cond->used)
+			continue;
+
+		list_delete_node(bgp->condadv_conds, node);
+		bgp_condadv_cond_free(cond);
+	}
+}
+
+/* Handler of conditional advertisement event, scheduled when the outcome
+ * of a condition map can have changed: it went from matching no dest to
+ * matching some or back (bgp_conditional_adv_dest_update()), or the
+ * advertise/condition map configuration or peers changed.
  */
 static void bgp_conditional_adv_timer(struct event *t)
 {
@@ -162,28 +368,19 @@ static void bgp_conditional_adv_timer(struct event *t)
 	struct bgp_filter *filter = NULL;
 	struct listnode *node, *nnode = NULL;
 	struct update_subgroup *subgrp = NULL;
+	struct bgp_condadv_cond *cond;
+	enum update_type update_type;
 	route_map_result_t ret;
-	bool advmap_table_changed = false;
+	static uint32_t scan_gen;
 
 	bgp = EVENT_ARG(t);
 	assert(bgp);
 
-	event_add_timer(bm->master, bgp_conditional_adv_timer, bgp,
-			bgp->condition_check_period, &bgp->t_condition_check);
-
-	/* loop through each peer and check if we have peers with
-	 * advmap_table_change attribute set, to make sure we send
-	 * conditional advertisements properly below.
-	 * peer->advmap_table_change is added on incoming BGP UPDATES,
-	 * but here it's used for outgoing UPDATES, hence we need to
-	 * check if at least one peer got advmap_table_change.
+	/* condition maps the configuration changed for are scanned once
+	 * per run, no matter how many peers use them
 	 */
-	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
-		if (peer->advmap_table_change) {
-			advmap_table_changed = true;
-			break;
-		}
-	}
+	if (++scan_gen == 0)
+		scan_gen = 1;
 
 	/* loop through each peer and advertise or withdraw routes if
 	 * advertise-map is configured and prefix(es) in condition-map
@@ -219,43 +416,62 @@ static void bgp_conditional_adv_timer(struct event *t)
 			    || !filter->advmap.amap || !filter->advmap.cmap)
 				continue;
 
-			if (!peer->advmap_config_change[afi][safi] &&
-			    !advmap_table_changed)
-				continue;
+			cond = bgp_condadv_cond_get(bgp, afi, pfx_rcd_safi,
+						    filter->advmap.cname);
+
+			if (peer->advmap_config_change[afi][safi]) {
+				bgp_cond_adv_debug(
+					"%s: %s for %s - advertise/condition map configuration is changed.",
+					__func__, peer->host,
+					get_afi_safi_str(afi, safi, false));
 
-			if (BGP_DEBUG(cond_adv, COND_ADV)) {
-				if (peer->advmap_table_change)
-					zlog_debug(
-						"%s: %s - routes changed in BGP table.",
-						__func__, peer->host);
-				if (peer->advmap_config_change[afi][safi])
-					zlog_debug(
-						"%s: %s for %s - advertise/condition map configuration is changed.",
-						__func__, peer->host,
-						get_afi_safi_str(afi, safi,
-								 false));
+				if (cond->scan_gen != scan_gen) {
+					bgp_condadv_cond_scan(
+						cond, table,
+						filter->advmap.cmap);
+					cond->scan_gen = scan_gen;
+				}
+			} else if (!cond->scan_gen) {
+				bgp_condadv_cond_scan(cond, table,
+						      filter->advmap.cmap);
+				cond->scan_gen = scan_gen;
 			}
 
 			/* cmap (route-map attached to exist-map or
 			 * non-exist-map) map validation
 			 */
-			ret = bgp_check_rmap_prefixes_in_bgp_table(
-				table, filter->advmap.cmap);
+			ret = cond->dests->count ? RMAP_PERMITMATCH
+						 : RMAP_DENYMATCH;
 
 			/* Derive conditional advertisement status from
 			 * condition and return value of condition-map
 			 * validation.
 			 */
 			if (filter->advmap.condition == CONDITION_EXIST)
-				filter->advmap.update_type =
-					(ret == RMAP_PERMITMATCH)
-						? UPDATE_TYPE_ADVERTISE
-						: UPDATE_TYPE_WITHDRAW;
+				update_type = (ret == RMAP_PERMITMATCH)
+						      ? UPDATE_TYPE_ADVERTISE
+						      : UPDATE_TYPE_WITHDRAW;
 			else
-				filter->advmap.update_type =
-					(ret == RMAP_PERMITMATCH)
-						? UPDATE_TYPE_WITHDRAW
-						: UPDATE_TYPE_ADVERTISE;
+				update_type = (ret == RMAP_PERMITMATCH)
+						      ? UPDATE_TYPE_WITHDRAW
+						      : UPDATE_TYPE_ADVERTISE;
+
+			/* Nothing to do if neither the configuration nor
+			 * the outcome of the condition changed; routes
+			 * matching the advertise-map are then handled by the
+			 * regular updates.
+			 */
+			if (!peer->advmap_config_change[afi][safi] &&
+			    filter->advmap.update_type == update_type)
+				continue;
+
+			bgp_cond_adv_debug(
+				"%s: %s for %s - condition map routes %spresent in BGP table",
+				__func__, peer->host,
+				get_afi_safi_str(afi, safi, false),
+				ret == RMAP_PERMITMATCH ? "" : "not ");
+
+			filter->advmap.update_type = update_type;
 
 			/*
 			 * Update condadv update type so
@@ -301,8 +517,9 @@ static void bgp_conditional_adv_timer(struct event *t)
 						   filter->advmap.amap,
 						   filter->advmap.update_type);
 		}
-		peer->advmap_table_change = false;
 	}
+
+	bgp_condadv_cond_gc(bgp);
 }
 
 void bgp_conditional_adv_enable(struct peer *peer, afi_t afi, safi_t safi)
@@ -320,17 +537,13 @@ void bgp_conditional_adv_enable(struct peer *peer, afi_t afi, safi_t safi)
 	/* advertise-map is already configured on at least one of its
 	 * neighbors (AFI/SAFI). So just increment the counter.
 	 */
-	if (++bgp->condition_filter_count > 1) {
+	if (++bgp->condition_filter_count > 1)
 		bgp_cond_adv_debug("%s: condition_filter_count %d", __func__,
 				   bgp->condition_filter_count);
+	else if (!bgp->condadv_conds)
+		bgp->condadv_conds = list_new();
 
-		return;
-	}
-
-	/* Register for conditional routes polling timer */
-	if (!event_is_scheduled(bgp->t_condition_check))
-		event_add_timer(bm->master, bgp_conditional_adv_timer, bgp, 0,
-				&bgp->t_condition_check);
+	bgp_conditional_adv_schedule(bgp);
 }
 
 void bgp_conditional_adv_disable(struct peer *peer, afi_t afi, safi_t safi)
@@ -350,8 +563,8 @@ void bgp_conditional_adv_disable(struct peer *peer, afi_t afi, safi_t safi)
 		return;
 	}
 
-	/* Last filter removed. So cancel conditional routes polling thread. */
-	EVENT_OFF(bgp->t_condition_check);
+	/* Last filter removed, drop the condition maps' state. */
+	bgp_conditional_adv_fini(bgp);
 }
 
 static void peer_advertise_map_filter_update(struct peer *peer, afi_t afi,
@@ -404,7 +617,8 @@ static void peer_advertise_map_filter_update(struct peer *peer, afi_t afi,
 	if (!filter_exists) {
 		filter->advmap.update_type = UPDATE_TYPE_ADVERTISE;
 		bgp_conditional_adv_enable(peer, afi, safi);
-	}
+	} else
+		bgp_conditional_adv_schedule(peer->bgp);
 
 	/* Process peer route updates. */
 	peer_on_policy_change(peer, afi, safi, 1);
@@ -27,9 +27,17 @@ extern "C" {
 			zlog_debug("" __VA_ARGS__);                            \
 	} while (0)
 
-/* Polling time for monitoring condition-map routes in route table */
+/* Former polling time for monitoring condition-map routes in route table,
+ * condition maps are evaluated on table changes now.
+ */
 #define DEFAULT_CONDITIONAL_ROUTES_POLL_TIME 60
 
+extern void bgp_conditional_adv_schedule(struct bgp *bgp);
+extern void bgp_conditional_adv_dest_update(struct bgp *bgp, afi_t afi,
+					    safi_t safi,
+					    struct bgp_dest *dest);
+extern void bgp_conditional_adv_fini(struct bgp *bgp);
+
 extern void bgp_conditional_adv_enable(struct peer *peer, afi_t afi,
 				       safi_t safi);
 extern void bgp_conditional_adv_disable(struct peer *peer, afi_t afi,
@@ -22,50 +22,73 @@
 #include "bgpd/bgp_advertise.h"
 #include "bgpd/bgp_vty.h"
 
+DEFINE_MSLAB_STATIC(BGP_DAMP_INFO, sizeof(struct bgp_damp_info));
+
 /* Global variable to access damping configuration */
 static struct bgp_damp_config damp[AFI_MAX][SAFI_MAX];
 
 /* Utility macro to add and delete BGP dampening information to no
    used list.  */
-#define BGP_DAMP_LIST_ADD(N, A) BGP_PATH_INFO_ADD(N, A, no_reuse_list)
-#define BGP_DAMP_LIST_DEL(N, A) BGP_PATH_INFO_DEL(N, A, no_reuse_list)
-
-/* Calculate reuse list index by penalty value.  */
-static int bgp_reuse_index(int penalty, struct bgp_damp_config *bdc)
+#define BGP_DAMP_LIST_ADD(N, A)                                                \
+	do {                                                                   \
+		BGP_PATH_INFO_ADD(N, A, no_reuse_list);                        \
+		(N)->no_reuse_count++;                                         \
+	} while (0)
+#define BGP_DAMP_LIST_DEL(N, A)                                                \
+	do {                                                                   \
+		BGP_PATH_INFO_DEL(N, A, no_reuse_list);                        \
+		(N)->no_reuse_count--;                                         \
+	} while (0)
+
+static void bgp_reuse_timer(struct event *t);
+
+/* Seconds until the penalty has decayed below the reuse limit.  DELTA_T is
+ * added as bgp_damp_decay() only decays in steps of that.
+ */
+static time_t bgp_reuse_delay(unsigned int penalty,
+			      struct bgp_damp_config *bdc)
 {
-	unsigned int i;
-	int index;
-
-	/*
-	 * reuse_limit can't be zero, this is for Coverity
-	 * to bypass division by zero test.
-	 */
-	assert(bdc->reuse_limit);
+	double delay;
 
-	i = (int)(((double)penalty / bdc->reuse_limit - 1.0)
-		  * bdc->scale_factor);
-
-	if (i >= bdc->reuse_index_size)
-		i = bdc->reuse_index_size - 1;
-
-	index = bdc->reuse_index[i] - bdc->reuse_index[0];
+	if (penalty < bdc->reuse_limit)
+		return 0;
 
-	return (bdc->reuse_offset + index) % bdc->reuse_list_size;
+	delay = ceil(bdc->half_life * log2((double)penalty / bdc->reuse_limit));
+	if (delay > bdc->max_suppress_time)
+		return bdc->max_suppress_time + DELTA_T;
+	return (time_t)delay + DELTA_T;
 }
 
-/* Add BGP dampening information to reuse list.  */
+/*
+ * Add BGP dampening information to reuse list.  The reuse lists are a timer
+ * wheel with a slot every DELTA_REUSE seconds, and enough slots to cover
+ * max_suppress_time.  So the route goes directly into the slot for the time
+ * its penalty will have decayed below the reuse limit, and normally only
+ * needs to be looked at once more.  (RFC2439 uses an approximation here,
+ * which wraps around and needs reinsertion for long suppression times.)
+ */
 static void bgp_reuse_list_add(struct bgp_damp_info *bdi,
 			       struct bgp_damp_config *bdc)
 {
+	unsigned int slots;
 	int index;
 
-	index = bdi->index = bgp_reuse_index(bdi->penalty, bdc);
+	slots = bgp_reuse_delay(bdi->penalty, bdc) / DELTA_REUSE;
+	if (slots >= bdc->reuse_list_size)
+		slots = bdc->reuse_list_size - 1;
+
+	index = bdi->index = (bdc->reuse_offset + slots) % bdc->reuse_list_size;
 
 	bdi->prev = NULL;
 	bdi->next = bdc->reuse_list[index];
 	if (bdc->reuse_list[index])
 		bdc->reuse_list[index]->prev = bdi;
 	bdc->reuse_list[index] = bdi;
+
+	/* the timer only runs while there is something on the wheel */
+	if (!bdc->reuse_count++)
+		event_add_timer(bm->master, bgp_reuse_timer, bdc, DELTA_REUSE,
+				&bdc->t_reuse);
 }
 
 /* Delete BGP dampening information from reuse list.  */
@@ -78,6 +101,8 @@ static void bgp_reuse_list_delete(struct bgp_damp_info *bdi,
 		bdi->prev->next = bdi->next;
 	else
 		bdc->reuse_list[bdi->index] = bdi->next;
+
+	bdc->reuse_count--;
 }
 
 /* Return decayed penalty value.  */
@@ -85,7 +110,7 @@ int bgp_damp_decay(time_t tdiff, int penalty, struct bgp_damp_config *bdc)
 {
 	unsigned int i;
 
-	i = (int)((double)tdiff / DELTA_T);
+	i = tdiff / DELTA_T;
 
 	if (i == 0)
 		return penalty;
@@ -103,14 +128,14 @@ static void bgp_reuse_timer(struct event *t)
 	struct bgp_damp_info *bdi;
 	struct bgp_damp_info *next;
 	time_t t_now, t_diff;
+	struct timeval start;
+	unsigned int count = 0;
+	int64_t usec;
 
 	struct bgp_damp_config *bdc = EVENT_ARG(t);
 
-	bdc->t_reuse = NULL;
-	event_add_timer(bm->master, bgp_reuse_timer, bdc, DELTA_REUSE,
-			&bdc->t_reuse);
-
-	t_now = monotime(NULL);
+	monotime(&start);
+	t_now = start.tv_sec;
 
 	/* 1.  save a pointer to the current zeroth queue head and zero the
 	   list head entry.  */
@@ -126,6 +151,8 @@ static void bgp_reuse_timer(struct event *t)
 		struct bgp *bgp = bdi->path->peer->bgp;
 
 		next = bdi->next;
+		bdc->reuse_count--;
+		count++;
 
 		/* Set t-diff = t-now - t-updated.  */
 		t_diff = t_now - bdi->t_updated;
@@ -143,6 +170,7 @@ static void bgp_reuse_timer(struct event *t)
 			bgp_path_info_unset_flag(bdi->dest, bdi->path,
 						 BGP_PATH_DAMPED);
 			bdi->suppress_time = 0;
+			bdc->stat_reused++;
 
 			if (bdi->lastrecord == BGP_RECORD_UPDATE) {
 				bgp_path_info_unset_flag(bdi->dest, bdi->path,
@@ -154,15 +182,27 @@ static void bgp_reuse_timer(struct event *t)
 					    bdi->safi);
 			}
 
+			/* bdi is on no list right now, bgp_damp_info_free()
+			 * expects it on the no-reuse list when not damped
+			 */
+			BGP_DAMP_LIST_ADD(bdc, bdi);
 			if (bdi->penalty <= bdc->reuse_limit / 2.0)
 				bgp_damp_info_free(bdi, 1, bdc->afi, bdc->safi);
-			else
-				BGP_DAMP_LIST_ADD(bdc, bdi);
 		} else
 			/* Re-insert into another list (See RFC2439 Section
 			 * 4.8.6).  */
 			bgp_reuse_list_add(bdi, bdc);
 	}
+
+	usec = monotime_since(&start, NULL);
+	bdc->stat_runs++;
+	bdc->stat_evaluated += count;
+	bdc->stat_usec += usec;
+	bdc->stat_usec_max = MAX(bdc->stat_usec_max, usec);
+
+	if (bdc->reuse_count)
+		event_add_timer(bm->master, bgp_reuse_timer, bdc, DELTA_REUSE,
+				&bdc->t_reuse);
 }
 
 /* A route becomes unreachable (RFC2439 Section 4.8.2).  */
@@ -188,8 +228,7 @@ int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 		   2. set figure-of-merit = 1.
 		   3. withdraw the route.  */
 
-		bdi = XCALLOC(MTYPE_BGP_DAMP_INFO,
-			      sizeof(struct bgp_damp_info));
+		bdi = XSLAB_CALLOC(MSLAB_BGP_DAMP_INFO);
 		bdi->path = path;
 		bdi->dest = dest;
 		bdi->penalty =
@@ -309,25 +348,20 @@ void bgp_damp_info_free(struct bgp_damp_info *bdi, int withdraw, afi_t afi,
 	if (bdi->lastrecord == BGP_RECORD_WITHDRAW && withdraw)
 		bgp_path_info_delete(bdi->dest, path);
 
-	XFREE(MTYPE_BGP_DAMP_INFO, bdi);
+	XSLAB_FREE(MSLAB_BGP_DAMP_INFO, bdi);
 }
 
 static void bgp_damp_parameter_set(time_t hlife, unsigned int reuse,
 				   unsigned int sup, time_t maxsup,
 				   struct bgp_damp_config *bdc)
 {
-	double reuse_max_ratio;
 	unsigned int i;
-	double j;
 
 	bdc->suppress_value = sup;
 	bdc->half_life = hlife;
 	bdc->reuse_limit = reuse;
 	bdc->max_suppress_time = maxsup;
 
-	/* Initialize params per bgp_damp_config. */
-	bdc->reuse_index_size = REUSE_ARRAY_SIZE;
-
 	bdc->ceiling = (int)(bdc->reuse_limit
 			     * (pow(2, (double)bdc->max_suppress_time
 					       / bdc->half_life)));
@@ -345,37 +379,19 @@ static void bgp_damp_parameter_set(time_t hlife, unsigned int reuse,
 		bdc->decay_array[i] =
 			bdc->decay_array[i - 1] * bdc->decay_array[1];
 
-	/* Reuse-list computations */
-	i = ceil((double)bdc->max_suppress_time / DELTA_REUSE) + 1;
-	if (i > REUSE_LIST_SIZE || i == 0)
-		i = REUSE_LIST_SIZE;
-	bdc->reuse_list_size = i;
+	/* Reuse-list computations, one slot per DELTA_REUSE up to the
+	 * longest possible reuse delay (see bgp_reuse_delay())
+	 */
+	bdc->reuse_list_size =
+		(bdc->max_suppress_time + DELTA_T) / DELTA_REUSE + 1;
 
 	bdc->reuse_list =
 		XCALLOC(MTYPE_BGP_DAMP_ARRAY,
-			bdc->reuse_list_size * sizeof(struct bgp_reuse_node *));
-
-	/* Reuse-array computations */
-	bdc->reuse_index = XCALLOC(MTYPE_BGP_DAMP_ARRAY,
-				   sizeof(int) * bdc->reuse_index_size);
-
-	reuse_max_ratio = (double)bdc->ceiling / bdc->reuse_limit;
-	j = (exp((double)bdc->max_suppress_time / bdc->half_life) * log10(2.0));
-	if (reuse_max_ratio > j && j != 0)
-		reuse_max_ratio = j;
-
-	bdc->scale_factor =
-		(double)bdc->reuse_index_size / (reuse_max_ratio - 1);
-
-	for (i = 0; i < bdc->reuse_index_size; i++) {
-		bdc->reuse_index[i] =
-			(int)(((double)bdc->half_life / DELTA_REUSE)
-			      * log10(1.0
-				      / (bdc->reuse_limit
-					 * (1.0
-					    + ((double)i / bdc->scale_factor))))
-			      / log10(0.5));
-	}
+			bdc->reuse_list_size * sizeof(struct bgp_damp_info *));
+	bdc->reuse_offset = 0;
+
+	bdc->stat_runs = bdc->stat_evaluated = bdc->stat_reused = 0;
+	bdc->stat_usec = bdc->stat_usec_max = 0;
 }
 
 int bgp_damp_enable(struct bgp *bgp, afi_t afi, safi_t safi, time_t half,
@@ -394,10 +410,7 @@ int bgp_damp_enable(struct bgp *bgp, afi_t afi, safi_t safi, time_t half,
 	SET_FLAG(bgp->af_flags[afi][safi], BGP_CONFIG_DAMPENING);
 	bgp_damp_parameter_set(half, reuse, suppress, max, bdc);
 
-	/* Register reuse timer.  */
-	event_add_timer(bm->master, bgp_reuse_timer, bdc, DELTA_REUSE,
-			&bdc->t_reuse);
-
+	/* The reuse timer is started with the first suppressed route. */
 	return 0;
 }
 
@@ -407,10 +420,6 @@ static void bgp_damp_config_clean(struct bgp_damp_config *bdc)
 	XFREE(MTYPE_BGP_DAMP_ARRAY, bdc->decay_array);
 	bdc->decay_array_size = 0;
 
-	/* Free reuse index array */
-	XFREE(MTYPE_BGP_DAMP_ARRAY, bdc->reuse_index);
-	bdc->reuse_index_size = 0;
-
 	/* Free reuse list array. */
 	XFREE(MTYPE_BGP_DAMP_ARRAY, bdc->reuse_list);
 	bdc->reuse_list_size = 0;
@@ -435,12 +444,14 @@ void bgp_damp_info_clean(afi_t afi, safi_t safi)
 		}
 		bdc->reuse_list[i] = NULL;
 	}
+	bdc->reuse_count = 0;
 
 	for (bdi = bdc->no_reuse_list; bdi; bdi = next) {
 		next = bdi->next;
 		bgp_damp_info_free(bdi, 1, afi, safi);
 	}
 	bdc->no_reuse_list = NULL;
+	bdc->no_reuse_count = 0;
 }
 
 int bgp_damp_disable(struct bgp *bgp, afi_t afi, safi_t safi)
@@ -655,6 +666,19 @@ static int bgp_print_dampening_parameters(struct bgp *bgp, struct vty *vty,
 					    bdc->max_suppress_time);
 			json_object_int_add(json, "maxSuppressPenalty",
 					    bdc->ceiling);
+			json_object_int_add(json, "suppressedRoutes",
+					    bdc->reuse_count);
+			json_object_int_add(json, "historyRoutes",
+					    bdc->no_reuse_count);
+			json_object_int_add(json, "reuseRuns", bdc->stat_runs);
+			json_object_int_add(json, "reuseEvaluated",
+					    bdc->stat_evaluated);
+			json_object_int_add(json, "reuseReused",
+					    bdc->stat_reused);
+			json_object_int_add(json, "reuseTotalUsecs",
+					    bdc->stat_usec);
+			json_object_int_add(json, "reuseMaxUsecs",
+					    bdc->stat_usec_max);
 
 			vty_json(vty, json);
 		} else {
@@ -667,6 +691,20 @@ static int bgp_print_dampening_parameters(struct bgp *bgp, struct vty *vty,
 				(long long)bdc->max_suppress_time / 60);
 			vty_out(vty, "Max suppress penalty: %u\n",
 				bdc->ceiling);
+			vty_out(vty, "Suppressed routes: %u\n",
+				bdc->reuse_count);
+			vty_out(vty,
+				"Other routes with dampening history: %u\n",
+				bdc->no_reuse_count);
+			vty_out(vty,
+				"Reuse timer: %" PRIu64 " runs, %" PRIu64
+				" routes evaluated, %" PRIu64 " reused\n",
+				bdc->stat_runs, bdc->stat_evaluated,
+				bdc->stat_reused);
+			vty_out(vty,
+				"Reuse processing time: %" PRIu64
+				" usec total, %" PRIu64 " usec max\n",
+				bdc->stat_usec, bdc->stat_usec_max);
 			vty_out(vty, "\n");
 		}
 	} else if (!use_json)
@@ -36,7 +36,7 @@ struct bgp_damp_info {
 	/* Back reference to bgp_node. */
 	struct bgp_dest *dest;
 
-	/* Current index in the reuse_list. */
+	/* Current index in the reuse_list (the slot on the timer wheel). */
 	int index;
 
 	/* Last time message type. */
@@ -67,7 +67,6 @@ struct bgp_damp_config {
 	 */
 	time_t tmax; /* Max time previous instability retained */
 	unsigned int reuse_list_size;  /* Number of reuse lists */
-	unsigned int reuse_index_size; /* Size of reuse index array */
 
 	/* Non-configurable parameters.  Most of these are calculated from
 	 * the configurable parameters above.
@@ -75,25 +74,32 @@ struct bgp_damp_config {
 	unsigned int ceiling;		  /* Max value a penalty can attain */
 	unsigned int decay_rate_per_tick; /* Calculated from half-life */
 	unsigned int decay_array_size; /* Calculated using config parameters */
-	double scale_factor;
-	unsigned int reuse_scale_factor;
 
 	/* Decay array per-set based. */
 	double *decay_array;
 
-	/* Reuse index array per-set based. */
-	int *reuse_index;
-
-	/* Reuse list array per-set based. */
+	/* Reuse list array per-set based, a timer wheel with one slot per
+	 * DELTA_REUSE seconds.  reuse_offset is the next slot to expire.
+	 */
 	struct bgp_damp_info **reuse_list;
 	int reuse_offset;
+	/* Suppressed routes, i.e. entries on the reuse lists. */
+	unsigned int reuse_count;
 
 	/* All dampening information which is not on reuse list.  */
 	struct bgp_damp_info *no_reuse_list;
+	unsigned int no_reuse_count;
 
-	/* Reuse timer thread per-set base. */
+	/* Reuse timer thread per-set base, only runs while reuse_count. */
 	struct event *t_reuse;
 
+	/* Reuse timer statistics */
+	uint64_t stat_runs;
+	uint64_t stat_evaluated;
+	uint64_t stat_reused;
+	uint64_t stat_usec;
+	uint64_t stat_usec_max;
+
 	afi_t afi;
 	safi_t safi;
 };
@@ -114,9 +120,6 @@ struct bgp_damp_config {
 #define DEFAULT_REUSE 	       	 750
 #define DEFAULT_SUPPRESS 	2000
 
-#define REUSE_LIST_SIZE          256
-#define REUSE_ARRAY_SIZE        1024
-
 extern int bgp_damp_enable(struct bgp *bgp, afi_t afi, safi_t safi, time_t half,
 			   unsigned int reuse, unsigned int suppress,
 			   time_t max);
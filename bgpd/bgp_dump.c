@@ -70,6 +70,14 @@ struct bgp_dump {
 	char *interval_str;
 
 	struct event *t_interval;
+
+	/* State of an in progress TABLE_DUMP_V2 RIB walk ('routes-mrt') */
+	struct event *t_walk;
+	struct bgp *walk_bgp;
+	struct bgp_table *walk_table;
+	struct bgp_dest *walk_dest;
+	afi_t walk_afi;
+	unsigned int walk_seq;
 };
 
 static int bgp_dump_unset(struct bgp_dump *bgp_dump);
@@ -389,43 +397,110 @@ bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
 }
 
 
-/* Runs under child process. */
-static unsigned int bgp_dump_routes_func(int afi, int first_run,
-					 unsigned int seq)
+/*
+ * The RIB walk for a 'routes-mrt' dump is done in slices, giving the event
+ * loop back whenever the current task has run long enough, so that dumping
+ * several full tables does not hold up keepalives and update processing.
+ * The bgp instance, the table being walked and the current dest are locked
+ * while the walk is suspended.
+ */
+static void bgp_dump_routes_walk_set_table(struct bgp_dump *bgp_dump,
+					   afi_t afi)
+{
+	if (bgp_dump->walk_table)
+		bgp_table_unlock(bgp_dump->walk_table);
+
+	bgp_dump->walk_afi = afi;
+	bgp_dump->walk_table = bgp_dump->walk_bgp->rib[afi][SAFI_UNICAST];
+	bgp_table_lock(bgp_dump->walk_table);
+	bgp_dump->walk_dest = bgp_table_top(bgp_dump->walk_table);
+}
+
+static void bgp_dump_routes_walk_stop(struct bgp_dump *bgp_dump)
 {
+	EVENT_OFF(bgp_dump->t_walk);
+
+	if (bgp_dump->walk_dest)
+		bgp_dest_unlock_node(bgp_dump->walk_dest);
+	bgp_dump->walk_dest = NULL;
+
+	if (bgp_dump->walk_table)
+		bgp_table_unlock(bgp_dump->walk_table);
+	bgp_dump->walk_table = NULL;
+
+	if (bgp_dump->walk_bgp)
+		bgp_unlock(bgp_dump->walk_bgp);
+	bgp_dump->walk_bgp = NULL;
+
+	if (bgp_dump->fp) {
+		fclose(bgp_dump->fp);
+		bgp_dump->fp = NULL;
+	}
+}
+
+static void bgp_dump_routes_walk(struct event *t)
+{
+	struct bgp_dump *bgp_dump = EVENT_ARG(t);
 	struct bgp_path_info *path;
 	struct bgp_dest *dest;
+
+	while (true) {
+		dest = bgp_dump->walk_dest;
+
+		while (dest) {
+			path = bgp_dest_get_bgp_path_info(dest);
+			while (path) {
+				path = bgp_dump_route_node_record(
+					bgp_dump->walk_afi, dest, path,
+					bgp_dump->walk_seq);
+				bgp_dump->walk_seq++;
+			}
+
+			/* bgp_route_next() moves the lock to the next dest */
+			dest = bgp_route_next(dest);
+			bgp_dump->walk_dest = dest;
+
+			if (dest && event_should_yield(t)) {
+				event_add_event(bm->master,
+						bgp_dump_routes_walk, bgp_dump,
+						0, &bgp_dump->t_walk);
+				return;
+			}
+		}
+
+		if (bgp_dump->walk_afi != AFI_IP)
+			break;
+
+		bgp_dump_routes_walk_set_table(bgp_dump, AFI_IP6);
+	}
+
+	/* For a RIB dump there's no point in leaving the file open until the
+	 * next scheduled dump starts.
+	 */
+	fflush(bgp_dump->fp);
+	bgp_dump_routes_walk_stop(bgp_dump);
+}
+
+static void bgp_dump_routes_start(struct bgp_dump *bgp_dump)
+{
 	struct bgp *bgp;
-	struct bgp_table *table;
 
 	bgp = bgp_get_default();
-	if (!bgp)
-		return seq;
-
-	if (bgp_dump_routes.fp == NULL)
-		return seq;
-
-	/* Note that bgp_dump_routes_index_table will do ipv4 and ipv6 peers,
-	   so this should only be done on the first call to
-	   bgp_dump_routes_func.
-	   ( this function will be called once for ipv4 and once for ipv6 ) */
-	if (first_run)
-		bgp_dump_routes_index_table(bgp);
-
-	/* Walk down each BGP route. */
-	table = bgp->rib[afi][SAFI_UNICAST];
-
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		path = bgp_dest_get_bgp_path_info(dest);
-		while (path) {
-			path = bgp_dump_route_node_record(afi, dest, path, seq);
-			seq++;
-		}
+	if (!bgp) {
+		fclose(bgp_dump->fp);
+		bgp_dump->fp = NULL;
+		return;
 	}
 
-	fflush(bgp_dump_routes.fp);
+	/* bgp_dump_routes_index_table() covers both ipv4 and ipv6 peers */
+	bgp_dump_routes_index_table(bgp);
+
+	bgp_dump->walk_bgp = bgp_lock(bgp);
+	bgp_dump->walk_seq = 0;
+	bgp_dump_routes_walk_set_table(bgp_dump, AFI_IP);
 
-	return seq;
+	event_add_event(bm->master, bgp_dump_routes_walk, bgp_dump, 0,
+			&bgp_dump->t_walk);
 }
 
 static void bgp_dump_interval_func(struct event *t)
@@ -433,19 +508,19 @@ static void bgp_dump_interval_func(struct event *t)
 	struct bgp_dump *bgp_dump;
 	bgp_dump = EVENT_ARG(t);
 
-	/* Reschedule dump even if file couldn't be opened this time... */
-	if (bgp_dump_open_file(bgp_dump) != NULL) {
-		/* In case of bgp_dump_routes, we need special route dump
+	if (bgp_dump->type == BGP_DUMP_ROUTES && bgp_dump->walk_bgp) {
+		/* Previous RIB dump is still being written, skip this one
+		 * rather than truncating the file under it.
+		 */
+		flog_warn(EC_BGP_DUMP,
+			  "%s: previous routes-mrt dump still in progress, skipping",
+			  __func__);
+	} else if (bgp_dump_open_file(bgp_dump) != NULL) {
+		/* Reschedule dump even if file couldn't be opened this time...
+		 * In case of bgp_dump_routes, we need special route dump
 		 * function. */
-		if (bgp_dump->type == BGP_DUMP_ROUTES) {
-			unsigned int seq = bgp_dump_routes_func(AFI_IP, 1, 0);
-			bgp_dump_routes_func(AFI_IP6, 0, seq);
-			/* Close the file now. For a RIB dump there's no point
-			 * in leaving
-			 * it open until the next scheduled dump starts. */
-			fclose(bgp_dump->fp);
-			bgp_dump->fp = NULL;
-		}
+		if (bgp_dump->type == BGP_DUMP_ROUTES)
+			bgp_dump_routes_start(bgp_dump);
 	}
 
 	/* if interval is set reschedule */
@@ -681,6 +756,9 @@ static int bgp_dump_set(struct vty *vty, struct bgp_dump *bgp_dump,
 
 static int bgp_dump_unset(struct bgp_dump *bgp_dump)
 {
+	/* Abort a RIB walk in progress, this also closes the file. */
+	bgp_dump_routes_walk_stop(bgp_dump);
+
 	/* Removing file name. */
 	XFREE(MTYPE_BGP_DUMP_STR, bgp_dump->filename);
 
@@ -22,6 +22,7 @@
 #include "bgpd/bgp_aspath.h"
 #include "bgpd/bgp_flowspec_private.h"
 #include "bgpd/bgp_pbr.h"
+#include "bgpd/bgp_intern.h"
 
 /* struct used to dump the rate contained in FS set traffic-rate EC */
 union traffic_rate {
@@ -30,7 +31,7 @@ union traffic_rate {
 };
 
 /* Hash of community attribute. */
-static struct hash *ecomhash;
+static struct bgp_intern_table ecomhash;
 
 /* Allocate a new ecommunities.  */
 struct ecommunity *ecommunity_new(void)
@@ -286,21 +287,31 @@ struct ecommunity *ecommunity_merge(struct ecommunity *ecom1,
 	return ecom1;
 }
 
-/* Intern Extended Communities Attribute.  */
+/* Intern Extended Communities Attribute.  If ecom already is interned,
+ * this just takes another reference.
+ */
 struct ecommunity *ecommunity_intern(struct ecommunity *ecom)
 {
+	struct bgp_intern_shard *shard;
 	struct ecommunity *find;
 
-	assert(ecom->refcnt == 0);
-	find = (struct ecommunity *)hash_get(ecomhash, ecom, hash_alloc_intern);
-	if (find != ecom)
-		ecommunity_free(&ecom);
+	shard = bgp_intern_shard(&ecomhash, ecom);
+	frr_with_mutex (&shard->mtx) {
+		if (ecom->refcnt)
+			find = ecom;
+		else
+			find = bgp_intern_shard_get(shard, ecom,
+						    hash_alloc_intern);
 
-	find->refcnt++;
+		find->refcnt++;
 
-	if (!find->str)
-		find->str =
-			ecommunity_ecom2str(find, ECOMMUNITY_FORMAT_DISPLAY, 0);
+		if (!find->str)
+			find->str = ecommunity_ecom2str(
+				find, ECOMMUNITY_FORMAT_DISPLAY, 0);
+	}
+
+	if (find != ecom)
+		ecommunity_free(&ecom);
 
 	return find;
 }
@@ -308,21 +319,26 @@ struct ecommunity *ecommunity_intern(struct ecommunity *ecom)
 /* Unintern Extended Communities Attribute.  */
 void ecommunity_unintern(struct ecommunity **ecom)
 {
+	struct bgp_intern_shard *shard;
 	struct ecommunity *ret;
 
 	if (!*ecom)
 		return;
 
-	if ((*ecom)->refcnt)
-		(*ecom)->refcnt--;
+	shard = bgp_intern_shard(&ecomhash, *ecom);
+	frr_with_mutex (&shard->mtx) {
+		if ((*ecom)->refcnt)
+			(*ecom)->refcnt--;
 
-	/* Pull off from hash.  */
-	if ((*ecom)->refcnt == 0) {
-		/* Extended community must be in the hash.  */
-		ret = (struct ecommunity *)hash_release(ecomhash, *ecom);
-		assert(ret != NULL);
+		/* Pull off from hash.  */
+		if ((*ecom)->refcnt == 0) {
+			/* Extended community must be in the hash.  */
+			ret = (struct ecommunity *)hash_release(shard->hash,
+								*ecom);
+			assert(ret != NULL);
 
-		ecommunity_free(ecom);
+			ecommunity_free(ecom);
+		}
 	}
 }
 
@@ -358,13 +374,14 @@ bool ecommunity_cmp(const void *arg1, const void *arg2)
 /* Initialize Extended Comminities related hash. */
 void ecommunity_init(void)
 {
-	ecomhash = hash_create(ecommunity_hash_make, ecommunity_cmp,
-			       "BGP ecommunity hash");
+	bgp_intern_table_init(&ecomhash, HASH_INITIAL_SIZE, ecommunity_hash_make,
+			      ecommunity_cmp, "BGP ecommunity hash", 0);
 }
 
 void ecommunity_finish(void)
 {
-	hash_clean_and_free(&ecomhash, (void (*)(void *))ecommunity_hash_free);
+	bgp_intern_table_finish(&ecomhash,
+				(void (*)(void *))ecommunity_hash_free);
 }
 
 /* Extended Communities token enum. */
@@ -1452,21 +1469,70 @@ void bgp_aggr_ecommunity_remove(void *arg)
 	ecommunity_free(&ecommunity);
 }
 
-void bgp_compute_aggregate_ecommunity(struct bgp_aggregate *aggregate,
-				      struct ecommunity *ecommunity)
+/* Count the values of an ecommunity entering the aggregate's hash.  If
+ * aggr is given, the values not seen before are merged into it.
+ */
+static bool bgp_aggr_ecommunity_vals_add(struct bgp_aggregate *aggregate,
+					 struct ecommunity *ecommunity,
+					 struct ecommunity **aggr)
 {
-	bgp_compute_aggregate_ecommunity_hash(aggregate, ecommunity);
-	bgp_compute_aggregate_ecommunity_val(aggregate);
+	bool changed = false;
+	uint8_t *eval;
+	uint32_t i;
+
+	for (i = 0; i < ecommunity->size; i++) {
+		eval = ecommunity->val + i * ecommunity->unit_size;
+		if (!bgp_aggr_val_add(&aggregate->ecommunity_vals, eval,
+				      ecommunity->unit_size)
+		    || !aggr)
+			continue;
+
+		if (!*aggr) {
+			*aggr = ecommunity_new();
+			(*aggr)->unit_size = ecommunity->unit_size;
+		}
+		ecommunity_add_val_internal(*aggr, eval, false, false,
+					    ecommunity->unit_size);
+		changed = true;
+	}
+	return changed;
 }
 
+/* Uncount the values of an ecommunity leaving the aggregate's hash.  If
+ * aggr is given, the values nobody else carries are removed from it.
+ */
+static bool bgp_aggr_ecommunity_vals_del(struct bgp_aggregate *aggregate,
+					 struct ecommunity *ecommunity,
+					 struct ecommunity **aggr)
+{
+	bool changed = false;
+	uint8_t *eval;
+	uint32_t i;
 
-void bgp_compute_aggregate_ecommunity_hash(struct bgp_aggregate *aggregate,
-					   struct ecommunity *ecommunity)
+	for (i = 0; i < ecommunity->size; i++) {
+		eval = ecommunity->val + i * ecommunity->unit_size;
+		if (!bgp_aggr_val_del(aggregate->ecommunity_vals, eval,
+				      ecommunity->unit_size)
+		    || !aggr || !*aggr)
+			continue;
+
+		ecommunity_del_val(*aggr, (struct ecommunity_val *)eval);
+		changed = true;
+	}
+
+	if (changed && !(*aggr)->size)
+		ecommunity_free(aggr);
+	return changed;
+}
+
+static bool bgp_aggr_ecommunity_get(struct bgp_aggregate *aggregate,
+				    struct ecommunity *ecommunity,
+				    struct ecommunity **aggr)
 {
 	struct ecommunity *aggr_ecommunity = NULL;
 
 	if ((aggregate == NULL) || (ecommunity == NULL))
-		return;
+		return false;
 
 	/* Create hash if not already created.
 	 */
@@ -1486,7 +1552,54 @@ void bgp_compute_aggregate_ecommunity_hash(struct bgp_aggregate *aggregate,
 
 	/* Increment reference counter.
 	 */
-	aggr_ecommunity->refcnt++;
+	if (aggr_ecommunity->refcnt++)
+		return false;
+
+	return bgp_aggr_ecommunity_vals_add(aggregate, aggr_ecommunity, aggr);
+}
+
+static bool bgp_aggr_ecommunity_put(struct bgp_aggregate *aggregate,
+				    struct ecommunity *ecommunity,
+				    struct ecommunity **aggr)
+{
+	struct ecommunity *aggr_ecommunity = NULL;
+	bool changed;
+
+	if ((!aggregate)
+	    || (!aggregate->ecommunity_hash)
+	    || (!ecommunity))
+		return false;
+
+	/* Look-up the ecommunity in the hash.
+	 */
+	aggr_ecommunity = bgp_aggr_ecommunity_lookup(aggregate, ecommunity);
+	if (!aggr_ecommunity || --aggr_ecommunity->refcnt)
+		return false;
+
+	hash_release(aggregate->ecommunity_hash, aggr_ecommunity);
+	changed = bgp_aggr_ecommunity_vals_del(aggregate, aggr_ecommunity,
+					       aggr);
+	ecommunity_free(&aggr_ecommunity);
+	return changed;
+}
+
+/* Add a route's ecommunity to the aggregate, updating the aggregate's
+ * ecommunity in place.  Returns true if the latter changed.
+ */
+bool bgp_compute_aggregate_ecommunity(struct bgp_aggregate *aggregate,
+				      struct ecommunity *ecommunity)
+{
+	if (aggregate == NULL)
+		return false;
+
+	return bgp_aggr_ecommunity_get(aggregate, ecommunity,
+				       &aggregate->ecommunity);
+}
+
+void bgp_compute_aggregate_ecommunity_hash(struct bgp_aggregate *aggregate,
+					   struct ecommunity *ecommunity)
+{
+	bgp_aggr_ecommunity_get(aggregate, ecommunity, NULL);
 }
 
 void bgp_compute_aggregate_ecommunity_val(struct bgp_aggregate *aggregate)
@@ -1512,56 +1625,20 @@ void bgp_compute_aggregate_ecommunity_val(struct bgp_aggregate *aggregate)
 	}
 }
 
-void bgp_remove_ecommunity_from_aggregate(struct bgp_aggregate *aggregate,
+bool bgp_remove_ecommunity_from_aggregate(struct bgp_aggregate *aggregate,
 					  struct ecommunity *ecommunity)
 {
-	struct ecommunity *aggr_ecommunity = NULL;
-	struct ecommunity *ret_ecomm = NULL;
-
-	if ((!aggregate)
-	    || (!aggregate->ecommunity_hash)
-	    || (!ecommunity))
-		return;
+	if (aggregate == NULL)
+		return false;
 
-	/* Look-up the ecommunity in the hash.
-	 */
-	aggr_ecommunity = bgp_aggr_ecommunity_lookup(aggregate, ecommunity);
-	if (aggr_ecommunity) {
-		aggr_ecommunity->refcnt--;
-
-		if (aggr_ecommunity->refcnt == 0) {
-			ret_ecomm = hash_release(aggregate->ecommunity_hash,
-						 aggr_ecommunity);
-			ecommunity_free(&ret_ecomm);
-			bgp_compute_aggregate_ecommunity_val(aggregate);
-		}
-	}
+	return bgp_aggr_ecommunity_put(aggregate, ecommunity,
+				       &aggregate->ecommunity);
 }
 
 void bgp_remove_ecomm_from_aggregate_hash(struct bgp_aggregate *aggregate,
 					  struct ecommunity *ecommunity)
 {
-
-	struct ecommunity *aggr_ecommunity = NULL;
-	struct ecommunity *ret_ecomm = NULL;
-
-	if ((!aggregate)
-	    || (!aggregate->ecommunity_hash)
-	    || (!ecommunity))
-		return;
-
-	/* Look-up the ecommunity in the hash.
-	 */
-	aggr_ecommunity = bgp_aggr_ecommunity_lookup(aggregate, ecommunity);
-	if (aggr_ecommunity) {
-		aggr_ecommunity->refcnt--;
-
-		if (aggr_ecommunity->refcnt == 0) {
-			ret_ecomm = hash_release(aggregate->ecommunity_hash,
-						 aggr_ecommunity);
-			ecommunity_free(&ret_ecomm);
-		}
-	}
+	bgp_aggr_ecommunity_put(aggregate, ecommunity, NULL);
 }
 
 struct ecommunity *
@@ -304,7 +304,7 @@ extern int ecommunity_fill_pbr_action(struct ecommunity_val *ecom_eval,
 				      struct bgp_pbr_entry_action *api,
 				      afi_t afi);
 
-extern void bgp_compute_aggregate_ecommunity(
+extern bool bgp_compute_aggregate_ecommunity(
 					struct bgp_aggregate *aggregate,
 					struct ecommunity *ecommunity);
 
@@ -313,7 +313,7 @@ extern void bgp_compute_aggregate_ecommunity_hash(
 					struct ecommunity *ecommunity);
 extern void bgp_compute_aggregate_ecommunity_val(
 					struct bgp_aggregate *aggregate);
-extern void bgp_remove_ecommunity_from_aggregate(
+extern bool bgp_remove_ecommunity_from_aggregate(
 					struct bgp_aggregate *aggregate,
 					struct ecommunity *ecommunity);
 extern void bgp_remove_ecomm_from_aggregate_hash(
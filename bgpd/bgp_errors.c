@@ -485,6 +485,12 @@ static struct log_ref ferr_bgp_err[] = {
 		.description = "No BGP updates were successfully sent to the peer for more than twice the holdtime.",
 		.suggestion = "Check connectivity to the peer and that it is not overloaded",
 	},
+	{
+		.code = EC_BGP_SNAPSHOT,
+		.title = "BGP RIB snapshot could not be written or read",
+		.description = "BGP failed to write its RIB snapshot, or found the snapshot file unusable when restoring it at startup",
+		.suggestion = "Ensure BGP has permissions to write the configured file; an unusable snapshot is ignored and the RIB is learned from the peers again",
+	},
 	{
 		.code = END_FERR,
 	}
@@ -844,6 +844,86 @@ struct bgp_dest *bgp_evpn_vni_node_lookup(const struct bgpevpn *vpn,
 	return bgp_evpn_vni_ip_node_lookup(vpn->ip_table, p, parent_pi);
 }
 
+/*
+ * Remote MACIP adds and deletes are batched: consecutive updates of the
+ * same kind for the same VRF go into a single ZEBRA_REMOTE_MACIP_ADD/DEL
+ * message, zebra walks all the entries it carries. The batch is sent when
+ * the kind or VRF changes, when it is full, before any other EVPN update
+ * to zebra (to keep the ordering) and at the latest once the current event
+ * is done.
+ */
+#define BGP_EVPN_MACIP_ENTRY_MAX                                               \
+	(4 + ETH_ALEN + 2 + IPV6_MAX_BYTELEN + IPV4_MAX_BYTELEN + 1 + 4 +      \
+	 sizeof(esi_t))
+
+static struct {
+	struct stream *s;
+	uint16_t cmd;
+	vrf_id_t vrf_id;
+	uint32_t count;
+	struct event *t_flush;
+} macip_batch;
+
+void bgp_evpn_macip_batch_flush(void)
+{
+	struct stream *s = macip_batch.s;
+
+	EVENT_OFF(macip_batch.t_flush);
+
+	if (!macip_batch.count)
+		return;
+
+	if (bgp_debug_zebra(NULL))
+		zlog_debug("Tx %s MACIP batch, %u entries",
+			   macip_batch.cmd == ZEBRA_REMOTE_MACIP_ADD ? "ADD"
+								     : "DEL",
+			   macip_batch.count);
+
+	macip_batch.count = 0;
+
+	if (!zclient || zclient->sock < 0)
+		return;
+
+	stream_putw_at(s, 0, stream_get_endp(s));
+	stream_reset(zclient->obuf);
+	stream_put(zclient->obuf, STREAM_DATA(s), stream_get_endp(s));
+	zclient_send_message(zclient);
+}
+
+static void bgp_evpn_macip_batch_flush_cb(struct event *t)
+{
+	bgp_evpn_macip_batch_flush();
+}
+
+/* Get the batch stream to append a MACIP entry of this kind to. */
+static struct stream *bgp_evpn_macip_batch_get(uint16_t cmd, vrf_id_t vrf_id)
+{
+	if (!macip_batch.s)
+		macip_batch.s = stream_new(ZEBRA_MAX_PACKET_SIZ);
+
+	if (macip_batch.count &&
+	    (macip_batch.cmd != cmd || macip_batch.vrf_id != vrf_id ||
+	     STREAM_WRITEABLE(macip_batch.s) < BGP_EVPN_MACIP_ENTRY_MAX))
+		bgp_evpn_macip_batch_flush();
+
+	if (!macip_batch.count) {
+		stream_reset(macip_batch.s);
+		zclient_create_header(macip_batch.s, cmd, vrf_id);
+		macip_batch.cmd = cmd;
+		macip_batch.vrf_id = vrf_id;
+	}
+
+	return macip_batch.s;
+}
+
+void bgp_evpn_macip_batch_finish(void)
+{
+	EVENT_OFF(macip_batch.t_flush);
+	macip_batch.count = 0;
+	stream_free(macip_batch.s);
+	macip_batch.s = NULL;
+}
+
 /*
  * Add (update) or delete MACIP from zebra.
  */
@@ -873,12 +953,9 @@ static int bgp_zebra_send_remote_macip(struct bgp *bgp, struct bgpevpn *vpn,
 
 	if (!esi)
 		esi = zero_esi;
-	s = zclient->obuf;
-	stream_reset(s);
-
-	zclient_create_header(
-		s, add ? ZEBRA_REMOTE_MACIP_ADD : ZEBRA_REMOTE_MACIP_DEL,
-		bgp->vrf_id);
+	s = bgp_evpn_macip_batch_get(add ? ZEBRA_REMOTE_MACIP_ADD
+					 : ZEBRA_REMOTE_MACIP_DEL,
+				     bgp->vrf_id);
 	stream_putl(s, vpn->vni);
 
 	if (mac) /* Mac Addr */
@@ -914,8 +991,6 @@ static int bgp_zebra_send_remote_macip(struct bgp *bgp, struct bgpevpn *vpn,
 		stream_put(s, esi, sizeof(esi_t));
 	}
 
-	stream_putw_at(s, 0, stream_get_endp(s));
-
 	if (bgp_debug_zebra(NULL)) {
 		char esi_buf[ESI_STR_LEN];
 
@@ -934,7 +1009,11 @@ static int bgp_zebra_send_remote_macip(struct bgp *bgp, struct bgpevpn *vpn,
 	frrtrace(5, frr_bgp, evpn_mac_ip_zsend, add, vpn, p, remote_vtep_ip,
 		 esi);
 
-	return zclient_send_message(zclient);
+	macip_batch.count++;
+	event_add_event(bm->master, bgp_evpn_macip_batch_flush_cb, NULL, 0,
+			&macip_batch.t_flush);
+
+	return ZCLIENT_SEND_SUCCESS;
 }
 
 /*
@@ -959,6 +1038,9 @@ static int bgp_zebra_send_remote_vtep(struct bgp *bgp, struct bgpevpn *vpn,
 		return 0;
 	}
 
+	/* MACs learnt before the VTEP change must get there first. */
+	bgp_evpn_macip_batch_flush();
+
 	s = zclient->obuf;
 	stream_reset(s);
 
@@ -1883,7 +1965,10 @@ static int update_evpn_route_entry(struct bgp *bgp, struct bgpevpn *vpn,
 		tmp_pi = info_make(ZEBRA_ROUTE_BGP, BGP_ROUTE_STATIC, 0,
 				   bgp->peer_self, attr_new, dest);
 		SET_FLAG(tmp_pi->flags, BGP_PATH_VALID);
-		bgp_path_info_extra_get(tmp_pi);
+		/* local type-2 paths always carry the evpn part, see
+		 * evpn_type2_path_info_get_mac()
+		 */
+		bgp_path_info_evpn_get(tmp_pi);
 
 		/* The VNI goes into the 'label' field of the route */
 		vni2label(vpn->vni, &label[0]);
@@ -1915,7 +2000,8 @@ static int update_evpn_route_entry(struct bgp *bgp, struct bgpevpn *vpn,
 
 		/* Mark route as self type-2 route */
 		if (flags && CHECK_FLAG(flags, ZEBRA_MACIP_TYPE_SVI_IP))
-			tmp_pi->extra->af_flags = BGP_EVPN_MACIP_TYPE_SVI_IP;
+			tmp_pi->extra->evpn->af_flags =
+				BGP_EVPN_MACIP_TYPE_SVI_IP;
 		bgp_path_info_add(dest, tmp_pi);
 	} else {
 		tmp_pi = local_pi;
@@ -2376,7 +2462,10 @@ void bgp_evpn_update_type2_route_entry(struct bgp *bgp, struct bgpevpn *vpn,
 			attr.router_flag = 1;
 	}
 	memcpy(&attr.esi, &local_pi->attr->esi, sizeof(esi_t));
-	bgp_evpn_get_rmac_nexthop(vpn, &evp, &attr, local_pi->extra->af_flags);
+	bgp_evpn_get_rmac_nexthop(vpn, &evp, &attr,
+				  local_pi->extra && local_pi->extra->evpn
+					  ? local_pi->extra->evpn->af_flags
+					  : 0);
 	vni2label(vpn->vni, &(attr.label));
 	/* Add L3 VNI RTs and RMAC for non IPv6 link-local if
 	 * using L3 VNI for type-2 routes also.
@@ -2779,8 +2868,7 @@ bgp_create_evpn_bgp_path_info(struct bgp_path_info *parent_pi,
 	pi = info_make(parent_pi->type, BGP_ROUTE_IMPORTED, 0, parent_pi->peer,
 		       attr_new, dest);
 	SET_FLAG(pi->flags, BGP_PATH_VALID);
-	bgp_path_info_extra_get(pi);
-	pi->extra->parent = bgp_path_info_lock(parent_pi);
+	bgp_path_info_vrfleak_get(pi)->parent = bgp_path_info_lock(parent_pi);
 	bgp_dest_lock_node((struct bgp_dest *)parent_pi->net);
 	if (parent_pi->extra) {
 		memcpy(&pi->extra->label, &parent_pi->extra->label,
@@ -2886,8 +2974,9 @@ static int install_evpn_route_entry_in_vrf(struct bgp *bgp_vrf,
 
 	/* Check if route entry is already present. */
 	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next)
-		if (pi->extra
-		    && (struct bgp_path_info *)pi->extra->parent == parent_pi)
+		if (pi->extra && pi->extra->vrfleak &&
+		    (struct bgp_path_info *)pi->extra->vrfleak->parent ==
+			    parent_pi)
 			break;
 
 	if (!pi) {
@@ -2982,8 +3071,9 @@ static int install_evpn_route_entry_in_vni_common(
 
 	/* Check if route entry is already present. */
 	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next)
-		if (pi->extra
-		    && (struct bgp_path_info *)pi->extra->parent == parent_pi)
+		if (pi->extra && pi->extra->vrfleak &&
+		    (struct bgp_path_info *)pi->extra->vrfleak->parent ==
+			    parent_pi)
 			break;
 
 	if (!pi) {
@@ -3078,8 +3168,9 @@ static int uninstall_evpn_route_entry_in_vni_common(
 
 	/* Find matching route entry. */
 	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next)
-		if (pi->extra &&
-		    (struct bgp_path_info *)pi->extra->parent == parent_pi)
+		if (pi->extra && pi->extra->vrfleak &&
+		    (struct bgp_path_info *)pi->extra->vrfleak->parent ==
+			    parent_pi)
 			break;
 
 	if (!pi)
@@ -3256,8 +3347,9 @@ static int uninstall_evpn_route_entry_in_vrf(struct bgp *bgp_vrf,
 
 	/* Find matching route entry. */
 	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next)
-		if (pi->extra
-		    && (struct bgp_path_info *)pi->extra->parent == parent_pi)
+		if (pi->extra && pi->extra->vrfleak &&
+		    (struct bgp_path_info *)pi->extra->vrfleak->parent ==
+			    parent_pi)
 			break;
 
 	if (!pi) {
@@ -3750,12 +3842,161 @@ static int install_uninstall_routes_for_vni(struct bgp *bgp,
 	return 0;
 }
 
+/*
+ * Installs of the existing remote routes into VRFs are batched: the VRFs
+ * are queued and a single walk of the global EVPN table then imports every
+ * route into the queued VRFs found through the RT to VRF index, instead of
+ * a walk of the whole table for each VRF. This matters when many VRFs come
+ * up (or change their import RTs) at the same time.
+ */
+static struct {
+	struct list *vrfs;
+	uint32_t gen;
+	struct event *t_import;
+} vrf_import_batch;
+
+static void bgp_evpn_vrf_import_batch_vrfs(struct bgp_path_info *pi,
+					   struct vrf_irt_node *vrf_irt)
+{
+	struct listnode *node;
+	struct bgp *bgp_vrf;
+
+	if (!vrf_irt)
+		return;
+
+	for (ALL_LIST_ELEMENTS_RO(vrf_irt->vrfs, node, bgp_vrf)) {
+		if (!CHECK_FLAG(bgp_vrf->vrf_flags,
+				BGP_VRF_EVPN_IMPORT_PENDING) ||
+		    bgp_vrf->evpn_import_gen == vrf_import_batch.gen)
+			continue;
+
+		bgp_vrf->evpn_import_gen = vrf_import_batch.gen;
+		bgp_evpn_route_entry_install_if_vrf_match(bgp_vrf, pi, 1);
+	}
+}
+
+/* Import one global route into the queued VRFs importing any of its RTs */
+static void bgp_evpn_vrf_import_batch_path(struct bgp_path_info *pi)
+{
+	struct ecommunity *ecom;
+	struct ecommunity_val *eval;
+	struct ecommunity_val eval_tmp;
+	uint8_t type, sub_type;
+	uint32_t i;
+
+	if (!(pi->attr->flag & ATTR_FLAG_BIT(BGP_ATTR_EXT_COMMUNITIES)))
+		return;
+
+	ecom = bgp_attr_get_ecommunity(pi->attr);
+	if (!ecom || !ecom->size)
+		return;
+
+	/* new pass, every VRF is visited at most once for this path */
+	vrf_import_batch.gen++;
+
+	for (i = 0; i < ecom->size; i++) {
+		eval = (struct ecommunity_val *)(ecom->val +
+						 (i * ecom->unit_size));
+		type = eval->val[0];
+		sub_type = eval->val[1];
+		if (sub_type != ECOMMUNITY_ROUTE_TARGET)
+			continue;
+
+		bgp_evpn_vrf_import_batch_vrfs(pi, lookup_vrf_import_rt(eval));
+
+		/* non-exact match on the local-admin sub-field */
+		if (type == ECOMMUNITY_ENCODE_AS ||
+		    type == ECOMMUNITY_ENCODE_AS4 ||
+		    type == ECOMMUNITY_ENCODE_IP) {
+			memcpy(&eval_tmp, eval, ecom->unit_size);
+			mask_ecom_global_admin(&eval_tmp, eval);
+			bgp_evpn_vrf_import_batch_vrfs(
+				pi, lookup_vrf_import_rt(&eval_tmp));
+		}
+	}
+}
+
+static void bgp_evpn_vrf_import_batch_run(struct event *t)
+{
+	struct bgp *bgp_evpn;
+	struct bgp_dest *rd_dest, *dest;
+	struct bgp_table *table;
+	struct bgp_path_info *pi;
+	struct bgp *bgp_vrf;
+	struct listnode *node;
+
+	bgp_evpn = bgp_get_evpn();
+
+	if (bgp_evpn && listcount(vrf_import_batch.vrfs)) {
+		if (bgp_debug_zebra(NULL))
+			zlog_debug("Importing EVPN routes into %u VRFs",
+				   listcount(vrf_import_batch.vrfs));
+
+		for (rd_dest = bgp_table_top(bgp_evpn->rib[AFI_L2VPN][SAFI_EVPN]);
+		     rd_dest; rd_dest = bgp_route_next(rd_dest)) {
+			table = bgp_dest_get_bgp_table_info(rd_dest);
+			if (!table)
+				continue;
+
+			for (dest = bgp_table_top(table); dest;
+			     dest = bgp_route_next(dest)) {
+				const struct prefix_evpn *evp =
+					(const struct prefix_evpn *)
+						bgp_dest_get_prefix(dest);
+
+				if (!(evp->prefix.route_type ==
+					      BGP_EVPN_MAC_IP_ROUTE ||
+				      evp->prefix.route_type ==
+					      BGP_EVPN_IP_PREFIX_ROUTE))
+					continue;
+
+				if (!(is_evpn_prefix_ipaddr_v4(evp) ||
+				      is_evpn_prefix_ipaddr_v6(evp)))
+					continue;
+
+				for (pi = bgp_dest_get_bgp_path_info(dest); pi;
+				     pi = pi->next)
+					bgp_evpn_vrf_import_batch_path(pi);
+			}
+		}
+	}
+
+	for (ALL_LIST_ELEMENTS_RO(vrf_import_batch.vrfs, node, bgp_vrf))
+		UNSET_FLAG(bgp_vrf->vrf_flags, BGP_VRF_EVPN_IMPORT_PENDING);
+	list_delete_all_node(vrf_import_batch.vrfs);
+}
+
+/* Drop the VRF from the pending import batch, if queued */
+static void bgp_evpn_vrf_import_batch_cancel(struct bgp *bgp_vrf)
+{
+	if (!CHECK_FLAG(bgp_vrf->vrf_flags, BGP_VRF_EVPN_IMPORT_PENDING))
+		return;
+
+	UNSET_FLAG(bgp_vrf->vrf_flags, BGP_VRF_EVPN_IMPORT_PENDING);
+	listnode_delete(vrf_import_batch.vrfs, bgp_vrf);
+}
+
+void bgp_evpn_vrf_import_batch_finish(void)
+{
+	EVENT_OFF(vrf_import_batch.t_import);
+	list_delete(&vrf_import_batch.vrfs);
+}
+
 /* Install any existing remote routes applicable for this VRF into VRF RIB. This
  * is invoked upon l3vni-add or l3vni import rt change
  */
 static int install_routes_for_vrf(struct bgp *bgp_vrf)
 {
-	install_uninstall_routes_for_vrf(bgp_vrf, 1);
+	if (CHECK_FLAG(bgp_vrf->vrf_flags, BGP_VRF_EVPN_IMPORT_PENDING))
+		return 0;
+
+	if (!vrf_import_batch.vrfs)
+		vrf_import_batch.vrfs = list_new();
+
+	SET_FLAG(bgp_vrf->vrf_flags, BGP_VRF_EVPN_IMPORT_PENDING);
+	listnode_add(vrf_import_batch.vrfs, bgp_vrf);
+	event_add_event(bm->master, bgp_evpn_vrf_import_batch_run, NULL, 0,
+			&vrf_import_batch.t_import);
 	return 0;
 }
 
@@ -3788,6 +4029,7 @@ static int install_routes_for_vni(struct bgp *bgp, struct bgpevpn *vpn)
 /* uninstall routes from l3vni vrf. */
 static int uninstall_routes_for_vrf(struct bgp *bgp_vrf)
 {
+	bgp_evpn_vrf_import_batch_cancel(bgp_vrf);
 	install_uninstall_routes_for_vrf(bgp_vrf, 0);
 	return 0;
 }
@@ -6735,6 +6977,7 @@ void bgp_evpn_init(struct bgp *bgp)
 
 void bgp_evpn_vrf_delete(struct bgp *bgp_vrf)
 {
+	bgp_evpn_vrf_import_batch_cancel(bgp_vrf);
 	bgp_evpn_unmap_vrf_from_its_rts(bgp_vrf);
 	bgp_evpn_nh_finish(bgp_vrf);
 }
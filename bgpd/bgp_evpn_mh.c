@@ -185,8 +185,9 @@ static int bgp_evpn_es_route_install(struct bgp *bgp,
 
 	/* Check if route entry is already present. */
 	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next)
-		if (pi->extra &&
-		    (struct bgp_path_info *)pi->extra->parent == parent_pi)
+		if (pi->extra && pi->extra->vrfleak &&
+		    (struct bgp_path_info *)pi->extra->vrfleak->parent ==
+			    parent_pi)
 			break;
 
 	if (!pi) {
@@ -197,8 +198,8 @@ static int bgp_evpn_es_route_install(struct bgp *bgp,
 		pi = info_make(parent_pi->type, BGP_ROUTE_IMPORTED, 0,
 			       parent_pi->peer, attr_new, dest);
 		SET_FLAG(pi->flags, BGP_PATH_VALID);
-		bgp_path_info_extra_get(pi);
-		pi->extra->parent = bgp_path_info_lock(parent_pi);
+		bgp_path_info_vrfleak_get(pi)->parent =
+			bgp_path_info_lock(parent_pi);
 		bgp_dest_lock_node((struct bgp_dest *)parent_pi->net);
 		bgp_path_info_add(dest, pi);
 	} else {
@@ -253,9 +254,9 @@ static int bgp_evpn_es_route_uninstall(struct bgp *bgp, struct bgp_evpn_es *es,
 
 	/* Find matching route entry. */
 	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next)
-		if (pi->extra
-				&& (struct bgp_path_info *)pi->extra->parent ==
-				parent_pi)
+		if (pi->extra && pi->extra->vrfleak &&
+		    (struct bgp_path_info *)pi->extra->vrfleak->parent ==
+			    parent_pi)
 			break;
 
 	if (!pi) {
@@ -1106,12 +1107,113 @@ static int bgp_evpn_ead_evi_route_delete(struct bgp *bgp,
 	return bgp_evpn_mh_route_delete(bgp, es, vpn, NULL, p);
 }
 
+/*
+ * EAD-EVI routes for all the VNIs of an ES are generated or withdrawn in
+ * the background, BGP_EVPN_EAD_EVI_BATCH at a time, instead of all of them
+ * in the event that changed the ES state.  Each queued ES-EVI is brought in
+ * line with the ES's BGP_EVPNES_ADV_EVI flag at the time it is processed,
+ * so the ES can flip back and forth while the queue is being worked on.
+ */
+static void bgp_evpn_ead_evi_pend_run(struct event *t);
+
+static void bgp_evpn_es_ead_pend_del(struct bgp_evpn_es *es)
+{
+	if (!CHECK_FLAG(es->flags, BGP_EVPNES_EAD_EVI_PEND))
+		return;
+
+	UNSET_FLAG(es->flags, BGP_EVPNES_EAD_EVI_PEND);
+	list_delete_node(bgp_mh_info->ead_evi_pend_es_list,
+			 &es->ead_pend_es_listnode);
+}
+
+static void bgp_evpn_es_evi_ead_pend_add(struct bgp_evpn_es_evi *es_evi)
+{
+	struct bgp_evpn_es *es = es_evi->es;
+
+	if (CHECK_FLAG(es_evi->flags, BGP_EVPNES_EVI_EAD_PEND))
+		return;
+
+	SET_FLAG(es_evi->flags, BGP_EVPNES_EVI_EAD_PEND);
+	listnode_init(&es_evi->ead_pend_listnode, es_evi);
+	listnode_add(es->ead_evi_pend_list, &es_evi->ead_pend_listnode);
+
+	if (!CHECK_FLAG(es->flags, BGP_EVPNES_EAD_EVI_PEND)) {
+		SET_FLAG(es->flags, BGP_EVPNES_EAD_EVI_PEND);
+		listnode_init(&es->ead_pend_es_listnode, es);
+		listnode_add(bgp_mh_info->ead_evi_pend_es_list,
+			     &es->ead_pend_es_listnode);
+	}
+
+	event_add_event(bm->master, bgp_evpn_ead_evi_pend_run, NULL, 0,
+			&bgp_mh_info->t_ead_evi);
+}
+
+static void bgp_evpn_es_evi_ead_pend_del(struct bgp_evpn_es_evi *es_evi)
+{
+	struct bgp_evpn_es *es = es_evi->es;
+
+	if (!CHECK_FLAG(es_evi->flags, BGP_EVPNES_EVI_EAD_PEND))
+		return;
+
+	UNSET_FLAG(es_evi->flags, BGP_EVPNES_EVI_EAD_PEND);
+	list_delete_node(es->ead_evi_pend_list, &es_evi->ead_pend_listnode);
+	if (!listcount(es->ead_evi_pend_list))
+		bgp_evpn_es_ead_pend_del(es);
+}
+
+static void bgp_evpn_es_ead_pend_flush(struct bgp_evpn_es *es)
+{
+	struct bgp_evpn_es_evi *es_evi;
+
+	while ((es_evi = listnode_head(es->ead_evi_pend_list)))
+		bgp_evpn_es_evi_ead_pend_del(es_evi);
+	bgp_evpn_es_ead_pend_del(es);
+}
+
+static void bgp_evpn_ead_evi_pend_run(struct event *t)
+{
+	struct bgp *bgp = bgp_get_evpn();
+	struct bgp_evpn_es *es;
+	struct bgp_evpn_es_evi *es_evi;
+	struct prefix_evpn p;
+	uint32_t count = 0;
+
+	while (count < BGP_EVPN_EAD_EVI_BATCH
+	       && (es = listnode_head(bgp_mh_info->ead_evi_pend_es_list))) {
+		build_evpn_type1_prefix(&p, BGP_EVPN_AD_EVI_ETH_TAG, &es->esi,
+					es->originator_ip);
+
+		while (count < BGP_EVPN_EAD_EVI_BATCH
+		       && (es_evi = listnode_head(es->ead_evi_pend_list))) {
+			/* may take the ES off the pending list */
+			bgp_evpn_es_evi_ead_pend_del(es_evi);
+			if (!bgp
+			    || !CHECK_FLAG(es_evi->flags, BGP_EVPNES_EVI_LOCAL))
+				continue;
+
+			count++;
+			if (CHECK_FLAG(es->flags, BGP_EVPNES_ADV_EVI))
+				bgp_evpn_ead_evi_route_update(bgp, es,
+							      es_evi->vpn, &p);
+			else if (bgp_evpn_mh_route_delete(bgp, es, es_evi->vpn,
+							  NULL, &p))
+				flog_err(EC_BGP_EVPN_ROUTE_DELETE,
+					 "%u: EAD-EVI route deletion failure for ESI %s VNI %u",
+					 bgp->vrf_id, es->esi_str,
+					 es_evi->vpn->vni);
+		}
+	}
+
+	if (listcount(bgp_mh_info->ead_evi_pend_es_list))
+		event_add_event(bm->master, bgp_evpn_ead_evi_pend_run, NULL, 0,
+				&bgp_mh_info->t_ead_evi);
+}
+
 /* Generate EAD-EVI for all VNIs */
 static void bgp_evpn_local_type1_evi_route_add(struct bgp *bgp,
 		struct bgp_evpn_es *es)
 {
 	struct listnode *evi_node;
-	struct prefix_evpn p;
 	struct bgp_evpn_es_evi *es_evi;
 
 	/* EAD-per-EVI routes have been suppressed */
@@ -1123,13 +1225,11 @@ static void bgp_evpn_local_type1_evi_route_add(struct bgp *bgp,
 		return;
 
 	SET_FLAG(es->flags, BGP_EVPNES_ADV_EVI);
-	build_evpn_type1_prefix(&p, BGP_EVPN_AD_EVI_ETH_TAG,
-			&es->esi, es->originator_ip);
 
 	for (ALL_LIST_ELEMENTS_RO(es->es_evi_list, evi_node, es_evi)) {
 		if (!CHECK_FLAG(es_evi->flags, BGP_EVPNES_EVI_LOCAL))
 			continue;
-		bgp_evpn_ead_evi_route_update(bgp, es, es_evi->vpn, &p);
+		bgp_evpn_es_evi_ead_pend_add(es_evi);
 	}
 }
 
@@ -1140,7 +1240,6 @@ static void bgp_evpn_local_type1_evi_route_del(struct bgp *bgp,
 		struct bgp_evpn_es *es)
 {
 	struct listnode *evi_node;
-	struct prefix_evpn p;
 	struct bgp_evpn_es_evi *es_evi;
 
 	/* Delete and withdraw locally learnt EAD-EVI route */
@@ -1149,15 +1248,10 @@ static void bgp_evpn_local_type1_evi_route_del(struct bgp *bgp,
 		return;
 
 	UNSET_FLAG(es->flags, BGP_EVPNES_ADV_EVI);
-	build_evpn_type1_prefix(&p, BGP_EVPN_AD_EVI_ETH_TAG,
-			&es->esi, es->originator_ip);
 	for (ALL_LIST_ELEMENTS_RO(es->es_evi_list, evi_node, es_evi)) {
 		if (!CHECK_FLAG(es_evi->flags, BGP_EVPNES_EVI_LOCAL))
 			continue;
-		if (bgp_evpn_mh_route_delete(bgp, es, es_evi->vpn, NULL, &p))
-			flog_err(EC_BGP_EVPN_ROUTE_CREATE,
-					"%u: Type4 route creation failure for ESI %s",
-					bgp->vrf_id, es->esi_str);
+		bgp_evpn_es_evi_ead_pend_add(es_evi);
 	}
 }
 
@@ -1376,6 +1470,9 @@ static int bgp_zebra_send_remote_es_vtep(struct bgp *bgp,
 	if (es_vtep->flags & BGP_EVPNES_VTEP_ESR)
 		flags |= ZAPI_ES_VTEP_FLAG_ESR_RXED;
 
+	/* Keep the ordering with the MACs pointing to the ES. */
+	bgp_evpn_macip_batch_flush();
+
 	s = zclient->obuf;
 	stream_reset(s);
 
@@ -1910,6 +2007,8 @@ static struct bgp_evpn_es *bgp_evpn_es_new(struct bgp *bgp, const esi_t *esi)
 	listset_app_node_mem(es->macip_global_path_list);
 	es->es_frag_list = list_new();
 	listset_app_node_mem(es->es_frag_list);
+	es->ead_evi_pend_list = list_new();
+	listset_app_node_mem(es->ead_evi_pend_list);
 
 	QOBJ_REG(es, bgp_evpn_es);
 
@@ -1931,6 +2030,8 @@ static void bgp_evpn_es_free(struct bgp_evpn_es *es, const char *caller)
 		zlog_debug("%s: es %s free", caller, es->esi_str);
 
 	/* cleanup resources maintained against the ES */
+	bgp_evpn_es_ead_pend_flush(es);
+	list_delete(&es->ead_evi_pend_list);
 	list_delete(&es->es_evi_list);
 	list_delete(&es->es_vrf_list);
 	list_delete(&es->es_vtep_list);
@@ -2608,6 +2709,8 @@ static void bgp_evpn_es_show_entry_detail(struct vty *vty,
 				    listcount(es->macip_global_path_list));
 		json_object_int_add(json, "inconsistentVniVtepCount",
 				es->incons_evi_vtep_cnt);
+		json_object_int_add(json, "eadEviPendingCount",
+				    listcount(es->ead_evi_pend_list));
 		if (listcount(es->es_vtep_list)) {
 			json_vteps = json_object_new_array();
 			for (ALL_LIST_ELEMENTS_RO(es->es_vtep_list, node,
@@ -2659,6 +2762,9 @@ static void bgp_evpn_es_show_entry_detail(struct vty *vty,
 			listcount(es->macip_global_path_list));
 		vty_out(vty, " Inconsistent VNI VTEP Count: %d\n",
 				es->incons_evi_vtep_cnt);
+		if (listcount(es->ead_evi_pend_list))
+			vty_out(vty, " EAD-EVI Pending Count: %u\n",
+				listcount(es->ead_evi_pend_list));
 		if (es->inconsistencies) {
 			incons_str[0] = '\0';
 			if (es->inconsistencies & BGP_EVPNES_INCONS_VTEP_LIST)
@@ -3156,7 +3262,7 @@ bool bgp_evpn_path_es_use_nhg(struct bgp *bgp_vrf, struct bgp_path_info *pi,
 	*nhg_p = 0;
 
 	/* we don't support NHG for routes leaked from another VRF yet */
-	if (pi->extra && pi->extra->bgp_orig)
+	if (pi->extra && pi->extra->vrfleak && pi->extra->vrfleak->bgp_orig)
 		return false;
 
 	parent_pi = get_route_parent_evpn(pi);
@@ -3538,6 +3644,7 @@ bgp_evpn_es_evi_free(struct bgp_evpn_es_evi *es_evi)
 	 */
 	if (es_evi->flags & (BGP_EVPNES_EVI_LOCAL | BGP_EVPNES_EVI_REMOTE))
 		return es_evi;
+	bgp_evpn_es_evi_ead_pend_del(es_evi);
 	bgp_evpn_es_frag_evi_del(es_evi, false);
 	bgp_evpn_es_vrf_deref(es_evi);
 
@@ -3646,6 +3753,7 @@ bgp_evpn_local_es_evi_do_del(struct bgp_evpn_es_evi *es_evi)
 		}
 	}
 
+	bgp_evpn_es_evi_ead_pend_del(es_evi);
 	return bgp_evpn_es_evi_local_info_clear(es_evi);
 }
 
@@ -3732,6 +3840,7 @@ int bgp_evpn_local_es_evi_add(struct bgp *bgp, esi_t *esi, vni_t vni)
 	bgp_evpn_es_evi_local_info_set(es_evi);
 
 	/* generate an EAD-EVI for this new VNI */
+	bgp_evpn_es_evi_ead_pend_del(es_evi);
 	if (CHECK_FLAG(es->flags, BGP_EVPNES_ADV_EVI)) {
 		build_evpn_type1_prefix(&p, BGP_EVPN_AD_EVI_ETH_TAG, &es->esi,
 					es->originator_ip);
@@ -4904,6 +5013,8 @@ void bgp_evpn_mh_init(void)
 	/* list of ESs with pending processing */
 	bgp_mh_info->pend_es_list = list_new();
 	listset_app_node_mem(bgp_mh_info->pend_es_list);
+	bgp_mh_info->ead_evi_pend_es_list = list_new();
+	listset_app_node_mem(bgp_mh_info->ead_evi_pend_es_list);
 
 	bgp_mh_info->ead_evi_rx = BGP_EVPN_MH_EAD_EVI_RX_DEF;
 	bgp_mh_info->ead_evi_tx = BGP_EVPN_MH_EAD_EVI_TX_DEF;
@@ -4937,8 +5048,10 @@ void bgp_evpn_mh_finish(void)
 	}
 	if (bgp_mh_info->t_cons_check)
 		EVENT_OFF(bgp_mh_info->t_cons_check);
+	EVENT_OFF(bgp_mh_info->t_ead_evi);
 	list_delete(&bgp_mh_info->local_es_list);
 	list_delete(&bgp_mh_info->pend_es_list);
+	list_delete(&bgp_mh_info->ead_evi_pend_es_list);
 	list_delete(&bgp_mh_info->ead_es_export_rtl);
 
 	XFREE(MTYPE_BGP_EVPN_MH_INFO, bgp_mh_info);
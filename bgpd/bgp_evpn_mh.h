@@ -27,6 +27,9 @@
 /* XXX - tune this */
 #define BGP_EVPN_MAX_EVI_PER_ES_FRAG 128
 
+/* EAD-EVI routes (re)generated or withdrawn per event */
+#define BGP_EVPN_EAD_EVI_BATCH 256
+
 /* An ES can result in multiple EAD-per-ES route. Each EAD fragment is
  * associated with an unique RD
  */
@@ -76,6 +79,8 @@ struct bgp_evpn_es {
 #define BGP_EVPNES_CONS_CHECK_PEND (1 << 4)
 	/* ES is in LACP bypass mode - don't advertise EAD-ES or ESR */
 #define BGP_EVPNES_BYPASS (1 << 5)
+	/* EAD-EVI updates queued on ead_evi_pend_list */
+#define BGP_EVPNES_EAD_EVI_PEND (1 << 6)
 	/* bits needed for printing the flags + null */
 #define BGP_EVPN_FLAG_STR_SZ 7
 
@@ -92,6 +97,15 @@ struct bgp_evpn_es {
 	 */
 	struct listnode pend_es_listnode;
 
+	/* memory used for linking the es to bgp_mh_info->ead_evi_pend_es_list
+	 */
+	struct listnode ead_pend_es_listnode;
+
+	/* [EVPNES_LOCAL] ES-EVIs whose EAD-EVI route has to be brought in
+	 * line with BGP_EVPNES_ADV_EVI
+	 */
+	struct list *ead_evi_pend_list;
+
 	/* [EVPNES_LOCAL] List of RDs for this ES (bgp_evpn_es_frag) */
 	struct list *es_frag_list;
 	struct bgp_evpn_es_frag *es_base_frag;
@@ -225,6 +239,8 @@ struct bgp_evpn_es_evi {
 /* created via a remote VTEP imported by BGP */
 #define BGP_EVPNES_EVI_REMOTE           (1 << 1)
 #define BGP_EVPNES_EVI_INCONS_VTEP_LIST (1 << 2)
+/* queued on es->ead_evi_pend_list */
+#define BGP_EVPNES_EVI_EAD_PEND         (1 << 3)
 
 	/* memory used for adding the es_evi to es_evi->vpn->es_evi_rb_tree */
 	RB_ENTRY(bgp_evpn_es_evi) rb_node;
@@ -241,6 +257,8 @@ struct bgp_evpn_es_evi {
 	 * es_evi->es_frag->es_evi_frag_list
 	 */
 	struct listnode es_frag_listnode;
+	/* memory used for linking the es_evi to es->ead_evi_pend_list */
+	struct listnode ead_pend_listnode;
 	/* list of PEs (bgp_evpn_es_evi_vtep) attached to the ES for this VNI */
 	struct list *es_evi_vtep_list;
 
@@ -300,6 +318,9 @@ struct bgp_evpn_mh_info {
 	struct list *pend_es_list;
 	/* periodic timer for running background consistency checks */
 	struct event *t_cons_check;
+	/* ESs with queued EAD-EVI updates, and the job processing them */
+	struct list *ead_evi_pend_es_list;
+	struct event *t_ead_evi;
 
 	/* config knobs for optimizing or interop */
 	/* Generate EAD-EVI routes even if the ES is oper-down. This can be
@@ -45,6 +45,9 @@ struct as_filter {
 	regex_t *reg;
 	char *reg_str;
 
+	/* reg_str can be matched without regexec() */
+	bool literal;
+
 	/* Sequence number. */
 	int64_t seq;
 };
@@ -58,8 +61,30 @@ struct as_list {
 
 	struct as_filter *head;
 	struct as_filter *tail;
+
+	/* Results by aspath memo_id, flushed whenever the list changes.
+	 * Interned aspaths are shared by many paths, so each list only has
+	 * to run its expressions once per distinct AS path.
+	 */
+	struct as_list_cache_entry *cache;
+	uint64_t cache_hits;
+	uint64_t cache_misses;
+};
+
+#define AS_LIST_CACHE_SIZE 1024
+
+struct as_list_cache_entry {
+	uint64_t memo_id;
+	enum as_filter_type type;
 };
 
+static void as_list_cache_flush(struct as_list *aslist)
+{
+	if (aslist->cache)
+		memset(aslist->cache, 0,
+		       sizeof(*aslist->cache) * AS_LIST_CACHE_SIZE);
+}
+
 
 /* Calculate new sequential number. */
 static int64_t bgp_alist_new_seq_get(struct as_list *list)
@@ -123,6 +148,7 @@ static struct as_filter *as_filter_make(regex_t *reg, const char *reg_str,
 	asfilter->reg = reg;
 	asfilter->type = type;
 	asfilter->reg_str = XSTRDUP(MTYPE_AS_FILTER_STR, reg_str);
+	asfilter->literal = bgp_regex_is_literal(reg_str);
 
 	return asfilter;
 }
@@ -168,6 +194,8 @@ static void as_list_filter_add(struct as_list *aslist,
 	struct as_filter *point;
 	struct as_filter *replace;
 
+	as_list_cache_flush(aslist);
+
 	if (aslist->tail && asfilter->seq > aslist->tail->seq)
 		point = NULL;
 	else {
@@ -231,6 +259,7 @@ static struct as_list *as_list_new(void)
 
 static void as_list_free(struct as_list *aslist)
 {
+	XFREE(MTYPE_AS_LIST_CACHE, aslist->cache);
 	XFREE(MTYPE_AS_STR, aslist->name);
 	XFREE(MTYPE_AS_LIST, aslist);
 }
@@ -347,6 +376,8 @@ static void as_list_filter_delete(struct as_list *aslist,
 {
 	char *name = XSTRDUP(MTYPE_AS_STR, aslist->name);
 
+	as_list_cache_flush(aslist);
+
 	if (asfilter->next)
 		asfilter->next->prev = asfilter->prev;
 	else
@@ -371,13 +402,27 @@ static void as_list_filter_delete(struct as_list *aslist,
 
 static bool as_filter_match(struct as_filter *asfilter, struct aspath *aspath)
 {
+	if (asfilter->literal)
+		return bgp_regex_literal_match(asfilter->reg_str, aspath->str);
 	return bgp_regexec(asfilter->reg, aspath) != REG_NOMATCH;
 }
 
+static enum as_filter_type as_list_apply_filters(struct as_list *aslist,
+						 struct aspath *aspath)
+{
+	struct as_filter *asfilter;
+
+	for (asfilter = aslist->head; asfilter; asfilter = asfilter->next) {
+		if (as_filter_match(asfilter, aspath))
+			return asfilter->type;
+	}
+	return AS_FILTER_DENY;
+}
+
 /* Apply AS path filter to AS. */
 enum as_filter_type as_list_apply(struct as_list *aslist, void *object)
 {
-	struct as_filter *asfilter;
+	struct as_list_cache_entry *entry;
 	struct aspath *aspath;
 
 	aspath = (struct aspath *)object;
@@ -385,11 +430,25 @@ enum as_filter_type as_list_apply(struct as_list *aslist, void *object)
 	if (aslist == NULL)
 		return AS_FILTER_DENY;
 
-	for (asfilter = aslist->head; asfilter; asfilter = asfilter->next) {
-		if (as_filter_match(asfilter, aspath))
-			return asfilter->type;
+	/* not interned, nothing to key the cache with */
+	if (!aspath->memo_id)
+		return as_list_apply_filters(aslist, aspath);
+
+	if (!aslist->cache)
+		aslist->cache = XCALLOC(MTYPE_AS_LIST_CACHE,
+					sizeof(*aslist->cache)
+						* AS_LIST_CACHE_SIZE);
+
+	entry = &aslist->cache[aspath->memo_id % AS_LIST_CACHE_SIZE];
+	if (entry->memo_id == aspath->memo_id) {
+		aslist->cache_hits++;
+		return entry->type;
 	}
-	return AS_FILTER_DENY;
+
+	aslist->cache_misses++;
+	entry->memo_id = aspath->memo_id;
+	entry->type = as_list_apply_filters(aslist, aspath);
+	return entry->type;
 }
 
 /* Add hook function. */
@@ -621,13 +680,21 @@ static void as_list_show(struct vty *vty, struct as_list *aslist,
 					       filter_type_str(asfilter->type));
 			json_object_string_add(json_asfilter, "regExp",
 					       asfilter->reg_str);
+			json_object_boolean_add(json_asfilter, "literal",
+						asfilter->literal);
 
 			json_object_array_add(json_aslist, json_asfilter);
 		} else
-			vty_out(vty, "    %s %s\n",
+			vty_out(vty, "    %s %s%s\n",
 				filter_type_str(asfilter->type),
-				asfilter->reg_str);
+				asfilter->reg_str,
+				asfilter->literal ? " (literal)" : "");
 	}
+
+	if (!json)
+		vty_out(vty, "    Result cache: %" PRIu64 " hits, %" PRIu64
+			" misses\n",
+			aslist->cache_hits, aslist->cache_misses);
 }
 
 static void as_list_show_all(struct vty *vty, json_object *json)
@@ -351,11 +351,11 @@ void route_vty_out_flowspec(struct vty *vty, const struct prefix *p,
 			json_object_array_add(json_paths, json_time_path);
 	}
 	if (display == NLRI_STRING_FORMAT_LARGE) {
-		struct bgp_path_info_extra *extra =
-			bgp_path_info_extra_get(path);
+		struct bgp_path_info_extra_fs *extra =
+			path->extra ? path->extra->flowspec : NULL;
 		bool list_began = false;
 
-		if (extra->bgp_fs_pbr && listcount(extra->bgp_fs_pbr)) {
+		if (extra && extra->bgp_fs_pbr && listcount(extra->bgp_fs_pbr)) {
 			struct listnode *node;
 			struct bgp_pbr_match_entry *bpme;
 			struct bgp_pbr_match *bpm;
@@ -378,7 +378,8 @@ void route_vty_out_flowspec(struct vty *vty, const struct prefix *p,
 			}
 			list_delete(&list_bpm);
 		}
-		if (extra->bgp_fs_iprule && listcount(extra->bgp_fs_iprule)) {
+		if (extra && extra->bgp_fs_iprule &&
+		    listcount(extra->bgp_fs_iprule)) {
 			struct listnode *node;
 			struct bgp_pbr_rule *bpr;
 
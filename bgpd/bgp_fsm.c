@@ -22,6 +22,7 @@
 #include "lib_errors.h"
 #include "zclient.h"
 #include "lib/json.h"
+#include "mempressure.h"
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_attr.h"
 #include "bgpd/bgp_debug.h"
@@ -40,6 +41,7 @@
 #include "bgpd/bgp_memory.h"
 #include "bgpd/bgp_keepalives.h"
 #include "bgpd/bgp_io.h"
+#include "bgpd/bgp_parse.h"
 #include "bgpd/bgp_zebra.h"
 #include "bgpd/bgp_vty.h"
 
@@ -129,6 +131,8 @@ static struct peer *peer_xfer_conn(struct peer *from_peer)
 	int fd;
 	enum bgp_fsm_status status, pstatus;
 	enum bgp_fsm_events last_evt, last_maj_evt;
+	struct bgp_preparse *pp;
+	struct stream *pkt;
 
 	assert(from_peer != NULL);
 
@@ -193,6 +197,7 @@ static struct peer *peer_xfer_conn(struct peer *from_peer)
 
 		stream_fifo_clean(peer->ibuf);
 		stream_fifo_clean(peer->obuf);
+		bgp_parse_clean(peer);
 
 		/*
 		 * this should never happen, since bgp_process_packet() is the
@@ -222,6 +227,10 @@ static struct peer *peer_xfer_conn(struct peer *from_peer)
 		while (from_peer->ibuf->head)
 			stream_fifo_push(peer->ibuf,
 					 stream_fifo_pop(from_peer->ibuf));
+		while ((pp = bgp_preparse_pop(&from_peer->preparsed)))
+			bgp_preparse_add_tail(&peer->preparsed, pp);
+		while ((pkt = stream_fifo_pop(from_peer->ibuf_parse)))
+			stream_fifo_push(peer->ibuf, pkt);
 
 		ringbuf_wipe(peer->ibuf_work);
 		ringbuf_copy(peer->ibuf_work, from_peer->ibuf_work,
@@ -1392,9 +1401,6 @@ enum bgp_fsm_state_progress bgp_stop(struct peer *peer)
 	if (peer_established(peer)) {
 		peer->dropped++;
 
-		/* Notify BGP conditional advertisement process */
-		peer->advmap_table_change = true;
-
 		/* bgp log-neighbor-changes of neighbor Down */
 		if (CHECK_FLAG(peer->bgp->flags,
 			       BGP_FLAG_LOG_NEIGHBOR_CHANGES)) {
@@ -1521,6 +1527,7 @@ enum bgp_fsm_state_progress bgp_stop(struct peer *peer)
 			stream_fifo_clean(peer->ibuf);
 		if (peer->obuf)
 			stream_fifo_clean(peer->obuf);
+		bgp_parse_clean(peer);
 
 		if (peer->ibuf_work)
 			ringbuf_wipe(peer->ibuf_work);
@@ -2286,6 +2293,11 @@ static enum bgp_fsm_state_progress bgp_establish(struct peer *peer)
 					 PEER_STATUS_ORF_WAIT_REFRESH);
 	}
 
+	/* Don't build up a full Adj-RIB-In while memory is still short */
+	if (mempressure_level() == MEMPRESSURE_HARD)
+		FOREACH_AFI_SAFI (afi, safi)
+			bgp_adj_in_shed(peer, afi, safi);
+
 	bgp_announce_peer(peer);
 
 	/* Start the route advertisement timer to send updates to the peer - if
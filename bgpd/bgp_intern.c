@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP sharded intern tables.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "frr_pthread.h"
+#include "hash.h"
+
+#include "bgpd/bgp_intern.h"
+
+void bgp_intern_table_init(struct bgp_intern_table *table, unsigned int size,
+			   unsigned int (*hash_key)(const void *),
+			   bool (*hash_cmp)(const void *, const void *),
+			   const char *name, unsigned int flags)
+{
+	unsigned int i;
+
+	for (i = 0; i < BGP_INTERN_SHARDS; i++) {
+		pthread_mutex_init(&table->shards[i].mtx, NULL);
+		table->shards[i].hash = hash_create_flags(size, hash_key,
+							  hash_cmp, name,
+							  flags);
+	}
+}
+
+void bgp_intern_table_finish(struct bgp_intern_table *table,
+			     void (*free_func)(void *))
+{
+	unsigned int i;
+
+	for (i = 0; i < BGP_INTERN_SHARDS; i++) {
+		hash_clean_and_free(&table->shards[i].hash, free_func);
+		pthread_mutex_destroy(&table->shards[i].mtx);
+	}
+}
+
+void *bgp_intern_shard_get(struct bgp_intern_shard *shard, void *data,
+			   void *(*alloc_func)(void *))
+{
+	unsigned long count = shard->hash->count;
+	void *find;
+
+	find = hash_get(shard->hash, data, alloc_func);
+	if (shard->hash->count == count)
+		atomic_fetch_add_explicit(&shard->hits, 1,
+					  memory_order_relaxed);
+	atomic_fetch_add_explicit(&shard->lookups, 1, memory_order_relaxed);
+
+	return find;
+}
+
+unsigned long bgp_intern_table_count(struct bgp_intern_table *table)
+{
+	unsigned long count = 0;
+	unsigned int i;
+
+	for (i = 0; i < BGP_INTERN_SHARDS; i++)
+		count += table->shards[i].hash->count;
+
+	return count;
+}
+
+void bgp_intern_table_stats(struct bgp_intern_table *table,
+			    struct bgp_intern_stats *stats)
+{
+	struct bgp_intern_shard *shard;
+	unsigned int i;
+
+	memset(stats, 0, sizeof(*stats));
+	stats->shards = BGP_INTERN_SHARDS;
+
+	for (i = 0; i < BGP_INTERN_SHARDS; i++) {
+		unsigned long used;
+
+		shard = &table->shards[i];
+
+		frr_with_mutex (&shard->mtx) {
+			stats->entries += shard->hash->count;
+			stats->buckets += shard->hash->size;
+			used = shard->hash->size - shard->hash->stats.empty;
+			stats->used_buckets += used;
+			if (used && shard->hash->count / used > stats->max_chain)
+				stats->max_chain = shard->hash->count / used;
+		}
+
+		stats->lookups += atomic_load_explicit(&shard->lookups,
+						      memory_order_relaxed);
+		stats->hits += atomic_load_explicit(&shard->hits,
+						   memory_order_relaxed);
+	}
+}
+
+void bgp_intern_table_iterate(struct bgp_intern_table *table,
+			      void (*func)(struct hash_bucket *, void *),
+			      void *arg)
+{
+	unsigned int i;
+
+	for (i = 0; i < BGP_INTERN_SHARDS; i++)
+		frr_with_mutex (&table->shards[i].mtx)
+			hash_iterate(table->shards[i].hash, func, arg);
+}
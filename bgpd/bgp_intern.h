@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP sharded intern tables.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#ifndef _FRR_BGP_INTERN_H
+#define _FRR_BGP_INTERN_H
+
+#include <pthread.h>
+
+#include "frratomic.h"
+#include "hash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * An intern table (attributes, AS paths, communities, ...) split into
+ * BGP_INTERN_SHARDS independent hashes, each protected by its own mutex,
+ * so that it can be used from more than one pthread.  The shard is chosen
+ * from the top bits of the hash key so it is independent from the bucket
+ * index (lib/hash.c uses the low bits).  This keeps the chains short at
+ * high entry counts and lets a lookup/insert/release only serialize
+ * against other operations on the same shard.
+ *
+ * The reference count of an interned object is only changed with the lock
+ * of its shard held.  Holding a reference keeps it from dropping to zero,
+ * so checking whether an object one holds is interned (refcnt != 0) is
+ * fine without the lock.
+ */
+#define BGP_INTERN_SHARD_BITS 4
+#define BGP_INTERN_SHARDS     (1U << BGP_INTERN_SHARD_BITS)
+
+struct bgp_intern_shard {
+	pthread_mutex_t mtx;
+	struct hash *hash;
+
+	/* hit-rate accounting for bgp_intern_shard_get() */
+	atomic_uint_fast64_t lookups;
+	atomic_uint_fast64_t hits;
+};
+
+struct bgp_intern_table {
+	struct bgp_intern_shard shards[BGP_INTERN_SHARDS];
+};
+
+/* statistics of an intern table, summed over all shards */
+struct bgp_intern_stats {
+	unsigned int shards;
+	unsigned long entries;
+	unsigned long buckets;
+	unsigned long used_buckets;
+	/* longest average chain length of any single shard */
+	unsigned long max_chain;
+	uint64_t lookups;
+	uint64_t hits;
+};
+
+/* size and flags are per shard, as for hash_create_flags() */
+extern void bgp_intern_table_init(struct bgp_intern_table *table,
+				  unsigned int size,
+				  unsigned int (*hash_key)(const void *),
+				  bool (*hash_cmp)(const void *, const void *),
+				  const char *name, unsigned int flags);
+extern void bgp_intern_table_finish(struct bgp_intern_table *table,
+				    void (*free_func)(void *));
+
+static inline struct bgp_intern_shard *
+bgp_intern_shard(struct bgp_intern_table *table, const void *data)
+{
+	struct hash *hash = table->shards[0].hash;
+
+	return &table->shards[hash->hash_key(data) >>
+			      (32 - BGP_INTERN_SHARD_BITS)];
+}
+
+/*
+ * hash_get() on the shard, with its lock held by the caller, counting
+ * whether data was already present.
+ */
+extern void *bgp_intern_shard_get(struct bgp_intern_shard *shard, void *data,
+				  void *(*alloc_func)(void *));
+
+extern unsigned long bgp_intern_table_count(struct bgp_intern_table *table);
+extern void bgp_intern_table_stats(struct bgp_intern_table *table,
+				   struct bgp_intern_stats *stats);
+
+/*
+ * hash_iterate() over all shards, each one locked while it is walked.
+ * func must not intern into or release from the same table.
+ */
+extern void bgp_intern_table_iterate(struct bgp_intern_table *table,
+				     void (*func)(struct hash_bucket *,
+						  void *),
+				     void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_BGP_INTERN_H */
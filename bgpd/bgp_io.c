@@ -8,7 +8,7 @@
 /* clang-format off */
 #include <zebra.h>
 #include <pthread.h>		// for pthread_mutex_unlock, pthread_mutex_lock
-#include <sys/uio.h>		// for writev
+#include <sys/uio.h>		// for writev, readv
 
 #include "frr_pthread.h"
 #include "linklist.h"		// for list_delete, list_delete_all_node, lis...
@@ -24,6 +24,7 @@
 #include "bgpd/bgp_errors.h"	// for expanded error reference information
 #include "bgpd/bgp_fsm.h"	// for BGP_EVENT_ADD, bgp_event
 #include "bgpd/bgp_packet.h"	// for bgp_notify_io_invalid...
+#include "bgpd/bgp_parse.h"	// for bgp_parse_schedule
 #include "bgpd/bgp_trace.h"	// for frrtraces
 #include "bgpd/bgpd.h"		// for peer, BGP_MARKER_SIZE, bgp_master, bm
 /* clang-format on */
@@ -39,6 +40,21 @@ static bool validate_header(struct peer *);
 #define BGP_IO_TRANS_ERR (1 << 0) /* EAGAIN or similar occurred */
 #define BGP_IO_FATAL_ERR (1 << 1) /* some kind of fatal TCP error */
 #define BGP_IO_WORK_FULL_ERR (1 << 2) /* No room in work buffer */
+#define BGP_IO_BUF_FILLED (1 << 3) /* read filled the work buffer */
+
+/*
+ * Peers with new packets for the main pthread.  The first peer added to an
+ * empty list schedules bgp_io_deliver(), the others just get added; so when
+ * a lot of peers become readable in the same poll cycle, the main pthread
+ * only gets woken up once for all of them.
+ */
+DECLARE_DLIST(bgp_io_wakeup, struct peer, io_wakeup_itm);
+
+static pthread_mutex_t wakeup_mtx = PTHREAD_MUTEX_INITIALIZER;
+static struct bgp_io_wakeup_head wakeup_peers = INIT_DLIST(wakeup_peers);
+static struct event *t_deliver;
+
+static void bgp_io_deliver(struct event *event);
 
 /* Thread external API ----------------------------------------------------- */
 
@@ -97,6 +113,11 @@ void bgp_reads_off(struct peer *peer)
 	assert(fpt->running);
 
 	event_cancel_async(fpt->master, &peer->t_read, NULL);
+	bgp_parse_cancel(peer);
+	frr_with_mutex (&wakeup_mtx) {
+		if (bgp_io_wakeup_anywhere(peer))
+			bgp_io_wakeup_del(&wakeup_peers, peer);
+	}
 	EVENT_OFF(peer->t_process_packet);
 	EVENT_OFF(peer->t_process_packet_error);
 
@@ -105,6 +126,51 @@ void bgp_reads_off(struct peer *peer)
 
 /* Thread internal functions ----------------------------------------------- */
 
+/*
+ * Called from I/O pthread: hand packets on peer->ibuf to the main pthread.
+ */
+static void bgp_io_wakeup(struct peer *peer)
+{
+	bool schedule;
+
+	frr_with_mutex (&wakeup_mtx) {
+		if (bgp_io_wakeup_anywhere(peer))
+			return;
+
+		schedule = !bgp_io_wakeup_count(&wakeup_peers);
+		bgp_io_wakeup_add_tail(&wakeup_peers, peer);
+		atomic_fetch_add_explicit(&peer->io_wakeups, 1,
+					  memory_order_relaxed);
+	}
+
+	if (schedule)
+		event_add_event(bm->master, bgp_io_deliver, NULL, 0,
+				&t_deliver);
+}
+
+/*
+ * Called from main pthread: schedule packet processing for all the peers the
+ * I/O pthread has collected since the last run.
+ */
+static void bgp_io_deliver(struct event *event)
+{
+	struct bgp_io_wakeup_head batch;
+	struct peer *peer;
+
+	bgp_io_wakeup_init(&batch);
+
+	frr_with_mutex (&wakeup_mtx) {
+		while ((peer = bgp_io_wakeup_pop(&wakeup_peers)))
+			bgp_io_wakeup_add_tail(&batch, peer);
+	}
+
+	while ((peer = bgp_io_wakeup_pop(&batch)))
+		event_add_event(bm->master, bgp_process_packet, peer, 0,
+				&peer->t_process_packet);
+
+	bgp_io_wakeup_fini(&batch);
+}
+
 /*
  * Called from I/O pthread when a file descriptor has become ready for writing.
  */
@@ -161,7 +227,8 @@ static int read_ibuf_work(struct peer *peer)
 
 	/* ============================================== */
 	frr_with_mutex (&peer->io_mtx) {
-		if (peer->ibuf->count >= bm->inq_limit)
+		if (peer->ibuf->count + peer->ibuf_parse->count >=
+		    bm->inq_limit)
 			return -ENOMEM;
 	}
 
@@ -197,7 +264,11 @@ static int read_ibuf_work(struct peer *peer)
 
 	frrtrace(2, frr_bgp, packet_read, peer, pkt);
 	frr_with_mutex (&peer->io_mtx) {
-		stream_fifo_push(peer->ibuf, pkt);
+		/* keep going through the workers until they are drained */
+		if (bgp_parse_workers_enabled() || peer->ibuf_parse->count)
+			stream_fifo_push(peer->ibuf_parse, pkt);
+		else
+			stream_fifo_push(peer->ibuf, pkt);
 	}
 
 	return pktsize;
@@ -209,6 +280,9 @@ static int read_ibuf_work(struct peer *peer)
  *
  * We read as much data as possible, process as many packets as we can and
  * place them on peer->ibuf for secondary processing by the main thread.
+ * If a read fills up the work buffer there's probably more data waiting, so
+ * after splitting off the packets we read again (up to BGP_READ_ROUNDS_MAX
+ * times, to be fair to other peers).
  */
 static void bgp_process_reads(struct event *thread)
 {
@@ -221,6 +295,8 @@ static void bgp_process_reads(struct event *thread)
 	bool ibuf_full = false;         /* Is peer fifo IN Buffer full */
 	static bool ibuf_full_logged;   /* Have we logged full already */
 	int ret = 1;
+	unsigned int round;             /* reads done in this run */
+	unsigned int pkts = 0;          /* packets split off ibuf_work */
 	/* clang-format on */
 
 	peer = EVENT_ARG(thread);
@@ -230,36 +306,48 @@ static void bgp_process_reads(struct event *thread)
 
 	struct frr_pthread *fpt = bgp_pth_io;
 
-	frr_with_mutex (&peer->io_mtx) {
-		status = bgp_read(peer, &code);
-	}
+	for (round = 0; round < BGP_READ_ROUNDS_MAX; round++) {
+		frr_with_mutex (&peer->io_mtx) {
+			status = bgp_read(peer, &code);
+		}
 
-	/* error checking phase */
-	if (CHECK_FLAG(status, BGP_IO_TRANS_ERR)) {
-		/* no problem; just don't process packets */
-		goto done;
-	}
+		/* error checking phase */
+		if (CHECK_FLAG(status, BGP_IO_TRANS_ERR)) {
+			/* no problem; just don't process (more) packets */
+			if (!round)
+				goto done;
+			break;
+		}
 
-	if (CHECK_FLAG(status, BGP_IO_FATAL_ERR)) {
-		/* problem; tear down session */
-		fatal = true;
+		if (CHECK_FLAG(status, BGP_IO_FATAL_ERR)) {
+			/* problem; tear down session */
+			fatal = true;
 
-		/* Handle the error in the main pthread, include the
-		 * specific state change from 'bgp_read'.
-		 */
-		event_add_event(bm->master, bgp_packet_process_error, peer,
-				code, &peer->t_process_packet_error);
-		goto done;
-	}
+			/* Handle the error in the main pthread, include the
+			 * specific state change from 'bgp_read'.
+			 */
+			event_add_event(bm->master, bgp_packet_process_error,
+					peer, code,
+					&peer->t_process_packet_error);
+			goto done;
+		}
 
-	while (true) {
-		ret = read_ibuf_work(peer);
-		if (ret <= 0)
-			break;
+		while (true) {
+			ret = read_ibuf_work(peer);
+			if (ret <= 0)
+				break;
+
+			added_pkt = true;
+			pkts++;
+		}
 
-		added_pkt = true;
+		if (ret < 0 || !CHECK_FLAG(status, BGP_IO_BUF_FILLED))
+			break;
 	}
 
+	atomic_fetch_add_explicit(&peer->io_read_pkts, pkts,
+				  memory_order_relaxed);
+
 	switch (ret) {
 	case -EBADMSG:
 		fatal = true;
@@ -294,9 +382,35 @@ done:
 
 	event_add_read(fpt->master, bgp_process_reads, peer, peer->fd,
 		       &peer->t_read);
-	if (added_pkt)
-		event_add_event(bm->master, bgp_process_packet, peer, 0,
-				&peer->t_process_packet);
+	if (added_pkt) {
+		bool to_worker;
+
+		frr_with_mutex (&peer->io_mtx) {
+			to_worker = (peer->ibuf_parse->count > 0);
+			if (to_worker)
+				bgp_parse_schedule(peer);
+		}
+		if (!to_worker)
+			bgp_io_wakeup(peer);
+	}
+}
+
+/* obuf went empty, account for how long it took to get there */
+static void bgp_write_drained(struct peer *peer)
+{
+	uint64_t busy;
+
+	peer->write_deficit = 0;
+	if (!timerisset(&peer->obuf_busy))
+		return;
+
+	busy = monotime_since(&peer->obuf_busy, NULL);
+	timerclear(&peer->obuf_busy);
+
+	peer->outq_busy_count++;
+	peer->outq_busy_usec += busy;
+	if (busy > peer->outq_busy_max_usec)
+		peer->outq_busy_max_usec = busy;
 }
 
 /*
@@ -306,6 +420,11 @@ done:
  * The amount of packets written is equal to the minimum of peer->wpkt_quanta
  * and the number of packets on the output buffer, unless an error occurs.
  *
+ * The packets written also have to fit into the peer's deficit, which gets
+ * BGP_IO_DRR_QUANTUM bytes added each time we're called.  This way every
+ * peer with a backlog gets the same share of bytes per round, no matter in
+ * which order update generation filled the output buffers.
+ *
  * If write() returns an error, the appropriate FSM event is generated.
  *
  * The return value is equal to the number of packets written
@@ -326,6 +445,8 @@ static uint16_t bgp_write(struct peer *peer)
 	unsigned int iovsz;
 	unsigned int strmsz;
 	unsigned int total_written;
+	size_t written = 0;
+	int32_t deficit;
 	time_t now;
 
 	wpkt_quanta_old = atomic_load_explicit(&peer->bgp->wpkt_quanta,
@@ -336,11 +457,20 @@ static uint16_t bgp_write(struct peer *peer)
 
 	s = stream_fifo_head(peer->obuf);
 
-	if (!s)
+	if (!s) {
+		bgp_write_drained(peer);
 		goto done;
+	}
+
+	/* cap, so a peer held up by EAGAIN doesn't save up a burst */
+	deficit = MIN(peer->write_deficit + BGP_IO_DRR_QUANTUM,
+		      BGP_MAX_PACKET_SIZE);
 
 	count = iovsz = 0;
 	while (count < wpkt_quanta_old && iovsz < array_size(iov) && s) {
+		if (STREAM_READABLE(s) > (size_t)(deficit - writenum))
+			break;
+
 		ostreams[iovsz] = s;
 		iov[iovsz].iov_base = stream_pnt(s);
 		iov[iovsz].iov_len = STREAM_READABLE(s);
@@ -350,12 +480,21 @@ static uint16_t bgp_write(struct peer *peer)
 		++count;
 	}
 
+	/* next packet doesn't fit, wait for the next round */
+	if (!iovsz) {
+		peer->write_deficit = deficit;
+		goto done;
+	}
+
 	strmsz = iovsz;
 	total_written = 0;
 
 	do {
 		num = writev(peer->fd, iov, iovsz);
 
+		if (num > 0)
+			written += num;
+
 		if (num < 0) {
 			if (!ERRNO_IO_RETRY(errno)) {
 				BGP_EVENT_ADD(peer, TCP_fatal_error);
@@ -458,6 +597,11 @@ static uint16_t bgp_write(struct peer *peer)
 		update_last_write = 1;
 	}
 
+	if (stream_fifo_head(peer->obuf))
+		peer->write_deficit = deficit - written;
+	else
+		bgp_write_drained(peer);
+
 done : {
 	now = monotime(NULL);
 	/*
@@ -481,7 +625,8 @@ done : {
 }
 
 /*
- * Reads a chunk of data from peer->fd into peer->ibuf_work.
+ * Reads a chunk of data from peer->fd directly into the free space of
+ * peer->ibuf_work.  BGP_IO_BUF_FILLED is set if all of it was used.
  *
  * code_p
  *    Pointer to location to store FSM event code in case of fatal error.
@@ -490,21 +635,22 @@ done : {
  */
 static uint16_t bgp_read(struct peer *peer, int *code_p)
 {
-	size_t readsize; /* how many bytes we want to read */
+	struct iovec iov[2]; /* free space in the work buf */
+	int iovcnt;
 	ssize_t nbytes;  /* how many bytes we actually read */
 	size_t ibuf_work_space; /* space we can read into the work buf */
 	uint16_t status = 0;
 
-	ibuf_work_space = ringbuf_space(peer->ibuf_work);
+	iovcnt = ringbuf_space_iov(peer->ibuf_work, iov);
 
-	if (ibuf_work_space == 0) {
+	if (iovcnt == 0) {
 		SET_FLAG(status, BGP_IO_WORK_FULL_ERR);
 		return status;
 	}
 
-	readsize = MIN(ibuf_work_space, sizeof(peer->ibuf_scratch));
+	ibuf_work_space = ringbuf_space(peer->ibuf_work);
 
-	nbytes = read(peer->fd, peer->ibuf_scratch, readsize);
+	nbytes = readv(peer->fd, iov, iovcnt);
 
 	/* EAGAIN or EWOULDBLOCK; come back later */
 	if (nbytes < 0 && ERRNO_IO_RETRY(errno)) {
@@ -533,8 +679,12 @@ static uint16_t bgp_read(struct peer *peer, int *code_p)
 
 		SET_FLAG(status, BGP_IO_FATAL_ERR);
 	} else {
-		assert(ringbuf_put(peer->ibuf_work, peer->ibuf_scratch, nbytes)
-		       == (size_t)nbytes);
+		ringbuf_commit(peer->ibuf_work, nbytes);
+		atomic_fetch_add_explicit(&peer->io_reads, 1,
+					  memory_order_relaxed);
+
+		if ((size_t)nbytes == ibuf_work_space)
+			SET_FLAG(status, BGP_IO_BUF_FILLED);
 	}
 
 	return status;
@@ -10,6 +10,16 @@
 
 #define BGP_WRITE_PACKET_MAX 64U
 #define BGP_READ_PACKET_MAX  10U
+#define BGP_READ_ROUNDS_MAX  4U
+
+/*
+ * Bytes each peer may write per round of the I/O pthread.  Peers are served
+ * deficit round robin: what a peer cannot use because the next packet does
+ * not fit is credited to its next round.  The same amount is used as the
+ * TCP_NOTSENT_LOWAT of the sockets, so peers only become writable again
+ * when the kernel is about to run out of data for them.
+ */
+#define BGP_IO_DRR_QUANTUM (8 * BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE)
 
 #include "bgpd/bgpd.h"
 #include "frr_pthread.h"
@@ -11,9 +11,12 @@
 
 #include "frr_pthread.h"        // for frr_pthread
 #include "hash.h"		// for hash, hash_clean, hash_create_size...
+#include "json.h"		// for json_object_int_add, json_object_new...
 #include "log.h"		// for zlog_debug
 #include "memory.h"		// for MTYPE_TMP, XFREE, XCALLOC, XMALLOC
 #include "monotime.h"		// for monotime, monotime_since
+#include "typesafe.h"		// for DECLARE_DLIST
+#include "vty.h"		// for vty_out
 
 #include "bgpd/bgpd.h"          // for peer, PEER_EVENT_KEEPALIVES_ON, peer...
 #include "bgpd/bgp_debug.h"	// for bgp_debug_neighbor_events
@@ -25,6 +28,25 @@ DEFINE_MTYPE_STATIC(BGPD, BGP_PKAT, "Peer KeepAlive Timer");
 DEFINE_MTYPE_STATIC(BGPD, BGP_COND, "BGP Peer pthread Conditional");
 DEFINE_MTYPE_STATIC(BGPD, BGP_MUTEX, "BGP Peer pthread Mutex");
 
+/*
+ * Keepalives are scheduled on a timer wheel with KA_SLOTS slots of
+ * KA_TICK_USEC each, so a wakeup only looks at the peers that are actually
+ * due instead of all of them.  Intervals longer than the wheel (~100s) just
+ * go around it more than once.
+ *
+ * A slot is run at the start of its tick, so a keepalive can go out up to
+ * one tick early.  This is intentional: it groups together peers who are
+ * due for keepalives at roughly the same time and avoids very short sleeps
+ * between them.
+ */
+#define KA_TICK_USEC 100000
+#define KA_SLOTS     1024
+
+/* recheck interval for peers with a keepalive timer of 0 */
+#define KA_IDLE_USEC 1000000
+
+PREDECL_DLIST(pkat_slot);
+
 /*
  * Peer KeepAlive Timer.
  * Associates a peer with the time of its last keepalive.
@@ -34,89 +56,171 @@ struct pkat {
 	struct peer *peer;
 	/* absolute time of last keepalive sent */
 	struct timeval last;
+
+	/* wheel slot, and when the next keepalive is due (usec) */
+	struct pkat_slot_item sitem;
+	int64_t due;
+	int64_t due_tick;
 };
 
+DECLARE_DLIST(pkat_slot, struct pkat, sitem);
+
 /* List of peers we are sending keepalives for, and associated mutex. */
 static pthread_mutex_t *peerhash_mtx;
 static pthread_cond_t *peerhash_cond;
 static struct hash *peerhash;
 
+/* the wheel, and the last tick that has been run; under peerhash_mtx */
+static struct pkat_slot_head ka_wheel[KA_SLOTS];
+static int64_t ka_tick;
+
+static int64_t ka_now(void)
+{
+	struct timeval tv;
+
+	monotime(&tv);
+	return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static int64_t ka_tv_usec(const struct timeval *tv)
+{
+	return (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+}
+
+static void pkat_schedule(struct pkat *pkat, int64_t due)
+{
+	pkat->due = due;
+	/* anything that is already due goes into the next slot to run */
+	pkat->due_tick = MAX(due / KA_TICK_USEC, ka_tick + 1);
+	pkat_slot_add_tail(&ka_wheel[pkat->due_tick % KA_SLOTS], pkat);
+}
+
+static void pkat_unschedule(struct pkat *pkat)
+{
+	if (pkat_slot_anywhere(pkat))
+		pkat_slot_del(&ka_wheel[pkat->due_tick % KA_SLOTS], pkat);
+}
+
 static struct pkat *pkat_new(struct peer *peer)
 {
-	struct pkat *pkat = XMALLOC(MTYPE_BGP_PKAT, sizeof(struct pkat));
+	struct pkat *pkat = XCALLOC(MTYPE_BGP_PKAT, sizeof(struct pkat));
+	uint32_t v_ka = atomic_load_explicit(&peer->v_keepalive,
+					     memory_order_relaxed);
+
 	pkat->peer = peer;
 	monotime(&pkat->last);
+	pkat_schedule(pkat, ka_tv_usec(&pkat->last) +
+				    (v_ka ? v_ka * 1000000LL : KA_IDLE_USEC));
 	return pkat;
 }
 
-static void pkat_del(void *pkat)
+static void pkat_del(void *arg)
 {
+	struct pkat *pkat = arg;
+
+	pkat_unschedule(pkat);
 	XFREE(MTYPE_BGP_PKAT, pkat);
 }
 
+/* bucket i counts values below 2^i ms, the last one everything above */
+static unsigned int ka_hist_bucket(int64_t usec)
+{
+	unsigned int bucket = 0;
+	int64_t msec = usec / 1000;
+
+	while (msec && bucket < BGP_KA_HIST_BUCKETS - 1) {
+		msec >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
 
 /*
- * Callback for hash_iterate. Determines if a peer needs a keepalive and if so,
- * generates and sends it.
- *
- * For any given peer, if the elapsed time since its last keepalive exceeds its
- * configured keepalive timer, a keepalive is sent to the peer and its
- * last-sent time is reset. Additionally, If the elapsed time does not exceed
- * the configured keepalive timer, but the time until the next keepalive is due
- * is within a hardcoded tolerance, a keepalive is sent as if the configured
- * timer was exceeded. Doing this helps alleviate nanosecond sleeps between
- * ticks by grouping together peers who are due for keepalives at roughly the
- * same time. This tolerance value is arbitrarily chosen to be 100ms.
- *
- * In addition, this function calculates the maximum amount of time that the
- * keepalive thread can sleep before another tick needs to take place. This is
- * equivalent to shortest time until a keepalive is due for any one peer.
- *
- * @return maximum time to wait until next update (0 if infinity)
+ * Send a keepalive for a peer whose slot is being run, unless the keepalive
+ * timer has been changed to something later in the meantime.
  */
-static void peer_process(struct hash_bucket *hb, void *arg)
+static void pkat_process(struct pkat *pkat, int64_t now, int64_t tick)
 {
-	struct pkat *pkat = hb->data;
+	struct peer *peer = pkat->peer;
+	uint32_t v_ka = atomic_load_explicit(&peer->v_keepalive,
+					     memory_order_relaxed);
+	int64_t last = ka_tv_usec(&pkat->last);
+	int64_t due = last + v_ka * 1000000LL;
+	int64_t jitter;
 
-	struct timeval *next_update = arg;
+	/* 0 keepalive timer means no keepalives */
+	if (v_ka == 0) {
+		pkat_schedule(pkat, now + KA_IDLE_USEC);
+		return;
+	}
 
-	static struct timeval elapsed;  // elapsed time since keepalive
-	static struct timeval ka = {0}; // peer->v_keepalive as a timeval
-	static struct timeval diff;     // ka - elapsed
+	if (due / KA_TICK_USEC > tick) {
+		pkat_schedule(pkat, due);
+		return;
+	}
 
-	static const struct timeval tolerance = {0, 100000};
+	if (bgp_debug_keepalive(peer))
+		zlog_debug("%s [FSM] Timer (keepalive timer expire)",
+			   peer->host);
 
-	uint32_t v_ka = atomic_load_explicit(&pkat->peer->v_keepalive,
-					     memory_order_relaxed);
+	bgp_keepalive_send(peer);
 
-	/* 0 keepalive timer means no keepalives */
-	if (v_ka == 0)
-		return;
+	/* how late we are, and how far off the interval was */
+	jitter = now - last - v_ka * 1000000LL;
+	atomic_fetch_add_explicit(&peer->ka_late_hist[ka_hist_bucket(
+					  MAX(now - due, 0))],
+				  1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&peer->ka_jitter_hist[ka_hist_bucket(
+					  jitter < 0 ? -jitter : jitter)],
+				  1, memory_order_relaxed);
 
-	/* calculate elapsed time since last keepalive */
-	monotime_since(&pkat->last, &elapsed);
+	pkat->last.tv_sec = now / 1000000;
+	pkat->last.tv_usec = now % 1000000;
+	pkat_schedule(pkat, now + v_ka * 1000000LL);
+}
 
-	/* calculate difference between elapsed time and configured time */
-	ka.tv_sec = v_ka;
-	timersub(&ka, &elapsed, &diff);
+/*
+ * Run all wheel slots up to the current time.
+ *
+ * @return absolute time (usec) of the next slot with peers in it, -1 if none
+ */
+static int64_t ka_wheel_run(int64_t now)
+{
+	int64_t tick = now / KA_TICK_USEC;
+	int64_t t;
+	struct pkat_slot_head due;
+	struct pkat *pkat;
 
-	int send_keepalive =
-		elapsed.tv_sec >= ka.tv_sec || timercmp(&diff, &tolerance, <);
+	/* after a long stall, one round over the wheel covers everything */
+	if (tick - ka_tick > KA_SLOTS)
+		ka_tick = tick - KA_SLOTS;
 
-	if (send_keepalive) {
-		if (bgp_debug_keepalive(pkat->peer))
-			zlog_debug("%s [FSM] Timer (keepalive timer expire)",
-				   pkat->peer->host);
+	pkat_slot_init(&due);
 
-		bgp_keepalive_send(pkat->peer);
-		monotime(&pkat->last);
-		memset(&elapsed, 0, sizeof(elapsed));
-		diff = ka;
+	for (t = ka_tick + 1; t <= tick; t++) {
+		struct pkat_slot_head *slot = &ka_wheel[t % KA_SLOTS];
+
+		frr_each_safe (pkat_slot, slot, pkat) {
+			/* still some rounds to go */
+			if (pkat->due_tick > tick)
+				continue;
+
+			pkat_slot_del(slot, pkat);
+			pkat_slot_add_tail(&due, pkat);
+		}
 	}
+	ka_tick = tick;
 
-	/* if calculated next update for this peer < current delay, use it */
-	if (next_update->tv_sec < 0 || timercmp(&diff, next_update, <))
-		*next_update = diff;
+	/* peers can get rescheduled into any slot, including the ones above */
+	while ((pkat = pkat_slot_pop(&due)))
+		pkat_process(pkat, now, tick);
+
+	pkat_slot_fini(&due);
+
+	for (t = tick + 1; t <= tick + KA_SLOTS; t++)
+		if (pkat_slot_count(&ka_wheel[t % KA_SLOTS]))
+			return t * KA_TICK_USEC;
+	return -1;
 }
 
 static bool peer_hash_cmp(const void *f, const void *s)
@@ -136,7 +240,11 @@ static unsigned int peer_hash_key(const void *arg)
 /* Cleanup handler / deinitializer. */
 static void bgp_keepalives_finish(void *arg)
 {
+	unsigned int i;
+
 	hash_clean_and_free(&peerhash, pkat_del);
+	for (i = 0; i < KA_SLOTS; i++)
+		pkat_slot_fini(&ka_wheel[i]);
 
 	pthread_mutex_unlock(peerhash_mtx);
 	pthread_mutex_destroy(peerhash_mtx);
@@ -154,10 +262,10 @@ void *bgp_keepalives_start(void *arg)
 	struct frr_pthread *fpt = arg;
 	fpt->master->owner = pthread_self();
 
-	struct timeval currtime = {0, 0};
-	struct timeval aftertime = {0, 0};
 	struct timeval next_update = {0, 0};
 	struct timespec next_update_ts = {0, 0};
+	int64_t next;
+	unsigned int i;
 
 	/*
 	 * The RCU mechanism for each pthread is initialized in a "locked"
@@ -189,6 +297,9 @@ void *bgp_keepalives_start(void *arg)
 
 	/* initialize peer hashtable */
 	peerhash = hash_create_size(2048, peer_hash_key, peer_hash_cmp, NULL);
+	for (i = 0; i < KA_SLOTS; i++)
+		pkat_slot_init(&ka_wheel[i]);
+	ka_tick = ka_now() / KA_TICK_USEC;
 	pthread_mutex_lock(peerhash_mtx);
 
 	/* register cleanup handler */
@@ -207,17 +318,12 @@ void *bgp_keepalives_start(void *arg)
 						       memory_order_relaxed))
 				pthread_cond_wait(peerhash_cond, peerhash_mtx);
 
-		monotime(&currtime);
-
-		next_update.tv_sec = -1;
-
-		hash_iterate(peerhash, peer_process, &next_update);
-		if (next_update.tv_sec == -1)
-			memset(&next_update, 0, sizeof(next_update));
+		next = ka_wheel_run(ka_now());
+		if (next < 0)
+			next = ka_now();
 
-		monotime_since(&currtime, &aftertime);
-
-		timeradd(&currtime, &next_update, &next_update);
+		next_update.tv_sec = next / 1000000;
+		next_update.tv_usec = next % 1000000;
 		TIMEVAL_TO_TIMESPEC(&next_update, &next_update_ts);
 	}
 
@@ -298,3 +404,126 @@ int bgp_keepalives_stop(struct frr_pthread *fpt, void **result)
 	pthread_join(fpt->thread, result);
 	return 0;
 }
+
+/* --- statistics ----------------------------------------------------------- */
+
+struct ka_stats {
+	uint64_t late[BGP_KA_HIST_BUCKETS];
+	uint64_t jitter[BGP_KA_HIST_BUCKETS];
+	uint64_t count;
+};
+
+static void ka_stats_add(struct ka_stats *stats, struct peer *peer)
+{
+	unsigned int i;
+	uint32_t late, jitter;
+
+	for (i = 0; i < BGP_KA_HIST_BUCKETS; i++) {
+		late = atomic_load_explicit(&peer->ka_late_hist[i],
+					    memory_order_relaxed);
+		jitter = atomic_load_explicit(&peer->ka_jitter_hist[i],
+					      memory_order_relaxed);
+		stats->late[i] += late;
+		stats->jitter[i] += jitter;
+		stats->count += late;
+	}
+}
+
+/* upper bound (msec) of the bucket the given percentile falls into */
+static uint32_t ka_hist_percentile(const uint64_t *hist, uint64_t count,
+				   unsigned int pct)
+{
+	uint64_t want = (count * pct + 99) / 100;
+	uint64_t sum = 0;
+	unsigned int i;
+
+	for (i = 0; i < BGP_KA_HIST_BUCKETS; i++) {
+		sum += hist[i];
+		if (sum >= want)
+			break;
+	}
+	return 1U << MIN(i, BGP_KA_HIST_BUCKETS - 1);
+}
+
+static void ka_stats_show(struct vty *vty, json_object *json,
+			  const char *name, const struct ka_stats *stats)
+{
+	json_object *json_group, *json_late, *json_jitter;
+	unsigned int i;
+
+	if (!stats->count)
+		return;
+
+	if (!json) {
+		vty_out(vty, "  %-24s %10" PRIu64 " %8u %8u %8u %8u\n", name,
+			stats->count,
+			ka_hist_percentile(stats->late, stats->count, 50),
+			ka_hist_percentile(stats->late, stats->count, 99),
+			ka_hist_percentile(stats->jitter, stats->count, 50),
+			ka_hist_percentile(stats->jitter, stats->count, 99));
+		return;
+	}
+
+	json_group = json_object_new_object();
+	json_late = json_object_new_array();
+	json_jitter = json_object_new_array();
+	for (i = 0; i < BGP_KA_HIST_BUCKETS; i++) {
+		json_object_array_add(json_late,
+				      json_object_new_int64(stats->late[i]));
+		json_object_array_add(json_jitter,
+				      json_object_new_int64(stats->jitter[i]));
+	}
+	json_object_int_add(json_group, "keepalives", stats->count);
+	json_object_int_add(json_group, "lateP50Msecs",
+			    ka_hist_percentile(stats->late, stats->count, 50));
+	json_object_int_add(json_group, "lateP99Msecs",
+			    ka_hist_percentile(stats->late, stats->count, 99));
+	json_object_int_add(json_group, "jitterP50Msecs",
+			    ka_hist_percentile(stats->jitter, stats->count, 50));
+	json_object_int_add(json_group, "jitterP99Msecs",
+			    ka_hist_percentile(stats->jitter, stats->count, 99));
+	json_object_object_add(json_group, "lateHistogram", json_late);
+	json_object_object_add(json_group, "jitterHistogram", json_jitter);
+	json_object_object_add(json, name, json_group);
+}
+
+void bgp_keepalives_show(struct vty *vty, json_object *json)
+{
+	struct listnode *node, *gnode, *pnode;
+	struct bgp *bgp;
+	struct peer_group *group;
+	struct peer *peer;
+	struct ka_stats stats;
+	json_object *json_bgp = NULL;
+
+	if (!json)
+		vty_out(vty,
+			"Keepalives sent, and how late they were and how far the interval was off\n"
+			"(50th/99th percentile, upper bound in ms):\n");
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
+		if (json) {
+			json_bgp = json_object_new_object();
+			json_object_object_add(json, bgp->name_pretty,
+					       json_bgp);
+		} else {
+			vty_out(vty, "\nInstance %s:\n", bgp->name_pretty);
+			vty_out(vty, "  %-24s %10s %8s %8s %8s %8s\n",
+				"Peer group", "Sent", "Late50", "Late99",
+				"Jitter50", "Jitter99");
+		}
+
+		for (ALL_LIST_ELEMENTS_RO(bgp->group, gnode, group)) {
+			memset(&stats, 0, sizeof(stats));
+			for (ALL_LIST_ELEMENTS_RO(group->peer, pnode, peer))
+				ka_stats_add(&stats, peer);
+			ka_stats_show(vty, json_bgp, group->name, &stats);
+		}
+
+		memset(&stats, 0, sizeof(stats));
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, pnode, peer))
+			if (!peer->group)
+				ka_stats_add(&stats, peer);
+		ka_stats_show(vty, json_bgp, "(none)", &stats);
+	}
+}
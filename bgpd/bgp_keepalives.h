@@ -49,8 +49,8 @@ extern void bgp_keepalives_init(void);
 /**
  * Entry function for keepalives pthread.
  *
- * This function loops over an internal list of peers, generating keepalives at
- * regular intervals as determined by each peer's keepalive timer.
+ * This function runs a timer wheel of peers, generating keepalives at regular
+ * intervals as determined by each peer's keepalive timer.
  *
  * See bgp_keepalives_on() for additional details.
  *
@@ -63,4 +63,9 @@ extern void *bgp_keepalives_start(void *arg);
  */
 int bgp_keepalives_stop(struct frr_pthread *fpt, void **result);
 
+/**
+ * Show keepalive lateness and jitter, summed up per peer-group.
+ */
+extern void bgp_keepalives_show(struct vty *vty, json_object *json);
+
 #endif /* _FRR_BGP_KEEPALIVES_H */
@@ -235,6 +235,7 @@ void bgp_reg_dereg_for_label(struct bgp_dest *dest, struct bgp_path_info *pi,
 	uint32_t bos = 0;
 	uint32_t exp = 0;
 	mpls_label_t label = MPLS_INVALID_LABEL;
+	mpls_label_t new_label;
 
 	mpls_lse_decode(dest->local_label, &label, &ttl, &exp, &bos);
 
@@ -270,14 +271,22 @@ void bgp_reg_dereg_for_label(struct bgp_dest *dest, struct bgp_path_info *pi,
 					zlog_debug(
 						"%s: Requesting label from LP for %pFX",
 						__func__, p);
-				/* bgp_reg_for_label_callback() will deal with
+				/* If the pool has a label at hand, register
+				 * the FEC right away.  Otherwise,
+				 * bgp_reg_for_label_callback() will deal with
 				 * fec registration when it gets a label from
 				 * the pool. This means we'll never register
 				 * FECs withoutvalid labels.
 				 */
-				bgp_lp_get(LP_TYPE_BGP_LU, dest,
-					   bgp_reg_for_label_callback);
-				return;
+				new_label = bgp_lp_get_direct(
+					LP_TYPE_BGP_LU, dest,
+					bgp_reg_for_label_callback);
+				if (new_label == MPLS_LABEL_NONE)
+					return;
+
+				dest->local_label =
+					mpls_lse_encode(new_label, 0, 0, 1);
+				bgp_set_valid_label(&dest->local_label);
 			}
 		}
 	} else {
@@ -54,9 +54,22 @@ static struct labelpool *lp;
  * we limit the chunk size to 1/16 of the label space (that's the -4 bits
  * in the definition below). This limit slightly increases our cost of
  * finding free labels in our allocated chunks.
+ *
+ * The size only doubles if the previous chunk was requested less than
+ * LP_CHUNK_GROW_INTERVAL seconds before, i.e. labels are being handed out
+ * quickly; a slow trickle of requests keeps getting small chunks.
  */
 #define LP_CHUNK_SIZE_MIN 128
 #define LP_CHUNK_SIZE_MAX (1 << (20 - 4))
+#define LP_CHUNK_GROW_INTERVAL 10
+
+/*
+ * The next chunk is requested ahead of time once fewer than
+ * 1/LP_PREFETCH_FRACTION of the next chunk size are left unallocated, so
+ * that a steady stream of requests is served from the local pool without
+ * waiting for zebra.
+ */
+#define LP_PREFETCH_FRACTION 4
 
 DEFINE_MTYPE_STATIC(BGPD, BGP_LABEL_CHUNK, "BGP Label Chunk");
 DEFINE_MTYPE_STATIC(BGPD, BGP_LABEL_FIFO, "BGP Label FIFO item");
@@ -306,6 +319,7 @@ static mpls_label_t get_label_from_pool(void *labelid)
 		bf_set_bit(chunk->allocated_map, index);
 		chunk->idx_last_allocated = index;
 		chunk->nfree -= 1;
+		lp->free_count -= 1;
 
 		return lbl;
 	}
@@ -313,6 +327,40 @@ static mpls_label_t get_label_from_pool(void *labelid)
 	return MPLS_LABEL_NONE;
 }
 
+static void lp_chunk_request(void)
+{
+	time_t now;
+
+	if (!zclient || zclient->sock < 0)
+		return;
+
+	if (zclient_send_get_label_chunk(zclient, 0, lp->next_chunksize,
+					 MPLS_LABEL_BASE_ANY) ==
+	    ZCLIENT_SEND_FAILURE)
+		return;
+
+	now = monotime(NULL);
+	lp->pending_count += lp->next_chunksize;
+	if (lp->last_chunk_request &&
+	    now - lp->last_chunk_request < LP_CHUNK_GROW_INTERVAL &&
+	    (lp->next_chunksize << 1) <= LP_CHUNK_SIZE_MAX)
+		lp->next_chunksize <<= 1;
+	lp->last_chunk_request = now;
+}
+
+static void lp_prefetch(void)
+{
+	if (lp->pending_count)
+		return;
+	if (lp->free_count >= lp->next_chunksize / LP_PREFETCH_FRACTION)
+		return;
+
+	if (BGP_DEBUG(labelpool, LABELPOOL))
+		zlog_debug("%s: %u labels left, prefetching %u", __func__,
+			   lp->free_count, lp->next_chunksize);
+	lp_chunk_request();
+}
+
 /*
  * Success indicated by value of "label" field in returned LCB
  */
@@ -335,36 +383,11 @@ static struct lp_lcb *lcb_alloc(
 	return new;
 }
 
-/*
- * Callers who need labels must supply a type, labelid, and callback.
- * The type is a value defined in bgp_labelpool.h (add types as needed).
- * The callback is for asynchronous notification of label allocation.
- * The labelid is passed as an argument to the callback. It should be unique
- * to the requested label instance.
- *
- * If zebra is not connected, callbacks with labels will be delayed
- * until connection is established. If zebra connection is lost after
- * labels have been assigned, existing assignments via this labelpool
- * module will continue until reconnection.
- *
- * When connection to zebra is reestablished, previous label assignments
- * will be invalidated (via callbacks having the "allocated" parameter unset)
- * and new labels will be automatically reassigned by this labelpool module
- * (that is, a requestor does not need to call bgp_lp_get() again if it is
- * notified via callback that its label has been lost: it will eventually
- * get another callback with a new label assignment).
- *
- * The callback function should return 0 to accept the allocation
- * and non-zero to refuse it. The callback function return value is
- * ignored for invalidations (i.e., when the "allocated" parameter is false)
- *
- * Prior requests for a given labelid are detected so that requests and
- * assignments are not duplicated.
- */
-void bgp_lp_get(
+static mpls_label_t lp_get(
 	int	type,
 	void	*labelid,
-	int	(*cbfunc)(mpls_label_t label, void *labelid, bool allocated))
+	int	(*cbfunc)(mpls_label_t label, void *labelid, bool allocated),
+	bool	direct)
 {
 	struct lp_lcb *lcb;
 	int requested = 0;
@@ -391,7 +414,13 @@ void bgp_lp_get(
 				 "%s: can't insert new LCB into ledger list",
 				 __func__);
 			XFREE(MTYPE_BGP_LABEL_CB, lcb);
-			return;
+			return MPLS_LABEL_NONE;
+		}
+
+		if (lcb->label != MPLS_LABEL_NONE) {
+			lp_prefetch();
+			if (direct)
+				return lcb->label;
 		}
 	}
 
@@ -416,11 +445,11 @@ void bgp_lp_get(
 
 		work_queue_add(lp->callback_q, q);
 
-		return;
+		return MPLS_LABEL_NONE;
 	}
 
 	if (requested)
-		return;
+		return MPLS_LABEL_NONE;
 
 	if (debug)
 		zlog_debug("%s: slow path. lcb=%p label=%u",
@@ -444,17 +473,59 @@ void bgp_lp_get(
 
 	lp_fifo_add_tail(&lp->requests, lf);
 
-	if (lp_fifo_count(&lp->requests) > lp->pending_count) {
-		if (!zclient || zclient->sock < 0)
-			return;
-		if (zclient_send_get_label_chunk(zclient, 0, lp->next_chunksize,
-						 MPLS_LABEL_BASE_ANY) !=
-		    ZCLIENT_SEND_FAILURE) {
-			lp->pending_count += lp->next_chunksize;
-			if ((lp->next_chunksize << 1) <= LP_CHUNK_SIZE_MAX)
-				lp->next_chunksize <<= 1;
-		}
-	}
+	if (lp_fifo_count(&lp->requests) > lp->pending_count)
+		lp_chunk_request();
+
+	return MPLS_LABEL_NONE;
+}
+
+/*
+ * Callers who need labels must supply a type, labelid, and callback.
+ * The type is a value defined in bgp_labelpool.h (add types as needed).
+ * The callback is for asynchronous notification of label allocation.
+ * The labelid is passed as an argument to the callback. It should be unique
+ * to the requested label instance.
+ *
+ * If zebra is not connected, callbacks with labels will be delayed
+ * until connection is established. If zebra connection is lost after
+ * labels have been assigned, existing assignments via this labelpool
+ * module will continue until reconnection.
+ *
+ * When connection to zebra is reestablished, previous label assignments
+ * will be invalidated (via callbacks having the "allocated" parameter unset)
+ * and new labels will be automatically reassigned by this labelpool module
+ * (that is, a requestor does not need to call bgp_lp_get() again if it is
+ * notified via callback that its label has been lost: it will eventually
+ * get another callback with a new label assignment).
+ *
+ * The callback function should return 0 to accept the allocation
+ * and non-zero to refuse it. The callback function return value is
+ * ignored for invalidations (i.e., when the "allocated" parameter is false)
+ *
+ * Prior requests for a given labelid are detected so that requests and
+ * assignments are not duplicated.
+ */
+void bgp_lp_get(
+	int	type,
+	void	*labelid,
+	int	(*cbfunc)(mpls_label_t label, void *labelid, bool allocated))
+{
+	lp_get(type, labelid, cbfunc, false);
+}
+
+/*
+ * Same as bgp_lp_get(), except that a new request which can be filled
+ * from the local pool gets its label returned right away, without going
+ * through the callback queue (and without the BGP LU node lock that goes
+ * with it).  Otherwise MPLS_LABEL_NONE is returned and the label comes in
+ * through cbfunc as usual.  Later invalidations always use cbfunc.
+ */
+mpls_label_t bgp_lp_get_direct(
+	int	type,
+	void	*labelid,
+	int	(*cbfunc)(mpls_label_t label, void *labelid, bool allocated))
+{
+	return lp_get(type, labelid, cbfunc, true);
 }
 
 void bgp_lp_release(
@@ -493,6 +564,7 @@ void bgp_lp_release(
 						     index));
 				bf_release_index(chunk->allocated_map, index);
 				chunk->nfree += 1;
+				lp->free_count += 1;
 				deallocated = true;
 			}
 			assert(deallocated);
@@ -532,7 +604,8 @@ void bgp_lp_event_chunk(uint8_t keep, uint32_t first, uint32_t last)
 	 */
 	listnode_add_head(lp->chunks, chunk);
 
-	lp->pending_count -= labelcount;
+	lp->pending_count -= MIN(labelcount, lp->pending_count);
+	lp->free_count += labelcount;
 
 	if (debug) {
 		zlog_debug("%s: %zu pending requests", __func__,
@@ -666,6 +739,7 @@ void bgp_lp_event_zebra_up(void)
 	 * Invalidate current list of chunks
 	 */
 	list_delete_all_node(lp->chunks);
+	lp->free_count = 0;
 
 	/*
 	 * Invalidate any existing labels and requeue them as requests
@@ -736,6 +810,7 @@ DEFUN(show_bgp_labelpool_summary, show_bgp_labelpool_summary_cmd,
 				    lp_fifo_count(&lp->requests));
 		json_object_int_add(json, "labelChunks", listcount(lp->chunks));
 		json_object_int_add(json, "pending", lp->pending_count);
+		json_object_int_add(json, "free", lp->free_count);
 		json_object_int_add(json, "reconnects", lp->reconnect_count);
 		vty_json(vty, json);
 	} else {
@@ -749,6 +824,7 @@ DEFUN(show_bgp_labelpool_summary, show_bgp_labelpool_summary_cmd,
 		vty_out(vty, "%-13s %d\n",
 			"LabelChunks:", listcount(lp->chunks));
 		vty_out(vty, "%-13s %d\n", "Pending:", lp->pending_count);
+		vty_out(vty, "%-13s %u\n", "Free:", lp->free_count);
 		vty_out(vty, "%-13s %d\n", "Reconnects:", lp->reconnect_count);
 	}
 	return CMD_SUCCESS;
@@ -1064,13 +1140,15 @@ DEFINE_MTYPE_STATIC(BGPD, LABELPOOL_TEST, "Label pool test");
 #define LPT_STAT_DELETE_FAIL 1
 #define LPT_STAT_ALLOCATED 2
 #define LPT_STAT_DEALLOCATED 3
-#define LPT_STAT_MAX 4
+#define LPT_STAT_DIRECT 4
+#define LPT_STAT_MAX 5
 
 const char *lpt_counter_names[] = {
 	"sl insert failures",
 	"sl delete failures",
 	"labels allocated",
 	"labels deallocated",
+	"labels allocated directly",
 };
 
 static uint8_t lpt_generation;
@@ -1093,6 +1171,8 @@ struct lp_test {
 	struct skiplist *timestamps_dealloc;
 	struct event *event_thread;
 	unsigned int counter[LPT_STAT_MAX];
+	bool direct; /* use bgp_lp_get_direct() */
+	int64_t last_alloc_usec; /* since starttime */
 };
 
 /* test parameters */
@@ -1117,6 +1197,7 @@ static int test_cb(mpls_label_t label, void *labelid, bool allocated)
 
 	if (allocated) {
 		++tcb->counter[LPT_STAT_ALLOCATED];
+		tcb->last_alloc_usec = monotime_since(&tcb->starttime, NULL);
 		if (!(tcb->counter[LPT_STAT_ALLOCATED] % LPT_TS_INTERVAL)) {
 			uintptr_t time_ms;
 
@@ -1178,12 +1259,22 @@ static void labelpool_test_event_handler(struct event *thread)
 		 */
 		id = ((uintptr_t)tcb->generation << 24) |
 		     (tcb->request_count & 0x00ffffff);
-		bgp_lp_get(LP_TYPE_VRF, (void *)id, test_cb);
+		if (tcb->direct) {
+			mpls_label_t label;
+
+			label = bgp_lp_get_direct(LP_TYPE_VRF, (void *)id,
+						  test_cb);
+			if (label != MPLS_LABEL_NONE) {
+				++tcb->counter[LPT_STAT_DIRECT];
+				test_cb(label, (void *)id, true);
+			}
+		} else
+			bgp_lp_get(LP_TYPE_VRF, (void *)id, test_cb);
 	}
 
 	if (tcb->request_count < tcb->request_maximum)
-		thread_add_event(bm->master, labelpool_test_event_handler, NULL,
-				 0, &tcb->event_thread);
+		event_add_event(bm->master, labelpool_test_event_handler, NULL,
+				0, &tcb->event_thread);
 }
 
 static void lptest_stop(void)
@@ -1207,7 +1298,7 @@ static void lptest_stop(void)
 	lpt_inprogress = false;
 }
 
-static int lptest_start(struct vty *vty)
+static int lptest_start(struct vty *vty, bool direct)
 {
 	struct lp_test *tcb;
 
@@ -1256,13 +1347,14 @@ static int lptest_start(struct vty *vty)
 
 	tcb->generation = lpt_generation;
 	tcb->label_type = LP_TYPE_VRF;
+	tcb->direct = direct;
 	tcb->request_maximum = LPT_MAX_COUNT;
 	tcb->request_blocksize = LPT_BLKSIZE;
 	tcb->labels = skiplist_new(0, NULL, NULL);
 	tcb->timestamps_alloc = skiplist_new(0, NULL, NULL);
 	tcb->timestamps_dealloc = skiplist_new(0, NULL, NULL);
-	thread_add_event(bm->master, labelpool_test_event_handler, NULL, 0,
-			 &tcb->event_thread);
+	event_add_event(bm->master, labelpool_test_event_handler, NULL, 0,
+			&tcb->event_thread);
 	monotime(&tcb->starttime);
 
 	skiplist_insert(lp_tests, (void *)(uintptr_t)tcb->generation, tcb);
@@ -1270,12 +1362,13 @@ static int lptest_start(struct vty *vty)
 }
 
 DEFPY(start_labelpool_perf_test, start_labelpool_perf_test_cmd,
-      "debug bgp lptest start",
+      "debug bgp lptest start [direct$direct]",
       DEBUG_STR BGP_STR
       "label pool test\n"
-      "start\n")
+      "start\n"
+      "use direct allocation, bypassing the callback queue\n")
 {
-	lptest_start(vty);
+	lptest_start(vty, !!direct);
 	return CMD_SUCCESS;
 }
 
@@ -1302,7 +1395,8 @@ static void lptest_print_stats(struct vty *vty, struct lp_test *tcb)
 		}
 	}
 
-	vty_out(vty, "Test Generation %u:\n", tcb->generation);
+	vty_out(vty, "Test Generation %u (%s):\n", tcb->generation,
+		tcb->direct ? "direct" : "callback");
 
 	vty_out(vty, "Counter   Value\n");
 	for (i = 0; i < LPT_STAT_MAX; ++i) {
@@ -1331,6 +1425,13 @@ static void lptest_print_stats(struct vty *vty, struct lp_test *tcb)
 		}
 		vty_out(vty, "\n");
 	}
+
+	if (tcb->last_alloc_usec)
+		vty_out(vty, "Throughput: %.0f labels/s (%u in %.3f s)\n\n",
+			tcb->counter[LPT_STAT_ALLOCATED] * 1e6 /
+				tcb->last_alloc_usec,
+			tcb->counter[LPT_STAT_ALLOCATED],
+			tcb->last_alloc_usec / 1e6);
 }
 
 DEFPY(show_labelpool_perf_test, show_labelpool_perf_test_cmd,
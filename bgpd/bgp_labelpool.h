@@ -29,12 +29,16 @@ struct labelpool {
 	uint32_t		pending_count;	/* requested from zebra */
 	uint32_t reconnect_count;		/* zebra reconnections */
 	uint32_t next_chunksize;		/* request this many labels */
+	uint32_t free_count;			/* in local chunks */
+	time_t last_chunk_request;		/* monotime */
 };
 
 extern void bgp_lp_init(struct event_loop *master, struct labelpool *pool);
 extern void bgp_lp_finish(void);
 extern void bgp_lp_get(int type, void *labelid,
 	int (*cbfunc)(mpls_label_t label, void *labelid, bool allocated));
+extern mpls_label_t bgp_lp_get_direct(int type, void *labelid,
+	int (*cbfunc)(mpls_label_t label, void *labelid, bool allocated));
 extern void bgp_lp_release(int type, void *labelid, mpls_label_t label);
 extern void bgp_lp_event_chunk(uint8_t keep, uint32_t first, uint32_t last);
 extern void bgp_lp_event_zebra_down(void);
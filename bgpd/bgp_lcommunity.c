@@ -18,9 +18,10 @@
 #include "bgpd/bgp_lcommunity.h"
 #include "bgpd/bgp_community_alias.h"
 #include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_intern.h"
 
 /* Hash of community attribute. */
-static struct hash *lcomhash;
+static struct bgp_intern_table lcomhash;
 
 /* Allocate a new lcommunities.  */
 static struct lcommunity *lcommunity_new(void)
@@ -237,44 +238,58 @@ static void set_lcommunity_string(struct lcommunity *lcom, bool make_json,
 	lcom->str = str_buf;
 }
 
-/* Intern Large Communities Attribute.  */
+/* Intern Large Communities Attribute.  If lcom already is interned, this
+ * just takes another reference.
+ */
 struct lcommunity *lcommunity_intern(struct lcommunity *lcom)
 {
+	struct bgp_intern_shard *shard;
 	struct lcommunity *find;
 
-	assert(lcom->refcnt == 0);
+	shard = bgp_intern_shard(&lcomhash, lcom);
+	frr_with_mutex (&shard->mtx) {
+		if (lcom->refcnt)
+			find = lcom;
+		else {
+			find = bgp_intern_shard_get(shard, lcom,
+						    hash_alloc_intern);
+			if (find == lcom)
+				lcommunity_set_sorted(find);
+		}
 
-	find = (struct lcommunity *)hash_get(lcomhash, lcom, hash_alloc_intern);
+		find->refcnt++;
+	}
 
 	if (find != lcom)
 		lcommunity_free(&lcom);
 
-	find->refcnt++;
-
-	if (!find->str)
-		set_lcommunity_string(find, false, true);
-
+	/* the string is made on demand by lcommunity_str() */
 	return find;
 }
 
 /* Unintern Large Communities Attribute.  */
 void lcommunity_unintern(struct lcommunity **lcom)
 {
+	struct bgp_intern_shard *shard;
 	struct lcommunity *ret;
 
 	if (!*lcom)
 		return;
 
-	if ((*lcom)->refcnt)
-		(*lcom)->refcnt--;
+	shard = bgp_intern_shard(&lcomhash, *lcom);
+	frr_with_mutex (&shard->mtx) {
+		if ((*lcom)->refcnt)
+			(*lcom)->refcnt--;
 
-	/* Pull off from hash.  */
-	if ((*lcom)->refcnt == 0) {
-		/* Large community must be in the hash.  */
-		ret = (struct lcommunity *)hash_release(lcomhash, *lcom);
-		assert(ret != NULL);
+		/* Pull off from hash.  */
+		if ((*lcom)->refcnt == 0) {
+			/* Large community must be in the hash.  */
+			ret = (struct lcommunity *)hash_release(shard->hash,
+								*lcom);
+			assert(ret != NULL);
 
-		lcommunity_free(lcom);
+			lcommunity_free(lcom);
+		}
 	}
 }
 
@@ -319,22 +334,24 @@ bool lcommunity_cmp(const void *arg1, const void *arg2)
 		&& memcmp(lcom1->val, lcom2->val, lcom_length(lcom1)) == 0);
 }
 
-/* Return communities hash.  */
-struct hash *lcommunity_hash(void)
+/* Walk the communities hash, see bgp_intern_table_iterate().  */
+void lcommunity_iterate(void (*func)(struct hash_bucket *, void *), void *arg)
 {
-	return lcomhash;
+	bgp_intern_table_iterate(&lcomhash, func, arg);
 }
 
 /* Initialize Large Comminities related hash. */
 void lcommunity_init(void)
 {
-	lcomhash = hash_create(lcommunity_hash_make, lcommunity_cmp,
-			       "BGP lcommunity hash");
+	bgp_intern_table_init(&lcomhash, HASH_INITIAL_SIZE,
+			      lcommunity_hash_make, lcommunity_cmp,
+			      "BGP lcommunity hash", 0);
 }
 
 void lcommunity_finish(void)
 {
-	hash_clean_and_free(&lcomhash, (void (*)(void *))lcommunity_hash_free);
+	bgp_intern_table_finish(&lcomhash,
+				(void (*)(void *))lcommunity_hash_free);
 }
 
 /* Get next Large Communities token from the string.
@@ -447,6 +464,48 @@ bool lcommunity_include(struct lcommunity *lcom, uint8_t *ptr)
 	return false;
 }
 
+void lcommunity_set_sorted(struct lcommunity *lcom)
+{
+	int i;
+
+	lcom->sorted = true;
+	for (i = 1; i < lcom->size; i++)
+		if (memcmp(lcom->val + (i - 1) * LCOMMUNITY_SIZE,
+			   lcom->val + i * LCOMMUNITY_SIZE, LCOMMUNITY_SIZE)
+		    >= 0) {
+			lcom->sorted = false;
+			return;
+		}
+}
+
+/* both sorted, binary search like community_match_sorted() */
+static bool lcommunity_match_sorted(const struct lcommunity *lcom1,
+				    const struct lcommunity *lcom2)
+{
+	int lo = 0, hi, mid, j, ret;
+	const uint8_t *want;
+
+	for (j = 0; j < lcom2->size; j++) {
+		want = lcom2->val + j * LCOMMUNITY_SIZE;
+		hi = lcom1->size;
+		while (lo < hi) {
+			mid = lo + (hi - lo) / 2;
+			ret = memcmp(lcom1->val + mid * LCOMMUNITY_SIZE, want,
+				     LCOMMUNITY_SIZE);
+			if (ret < 0)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo == lcom1->size
+		    || memcmp(lcom1->val + lo * LCOMMUNITY_SIZE, want,
+			      LCOMMUNITY_SIZE))
+			return false;
+		lo++;
+	}
+	return true;
+}
+
 bool lcommunity_match(const struct lcommunity *lcom1,
 		      const struct lcommunity *lcom2)
 {
@@ -462,6 +521,9 @@ bool lcommunity_match(const struct lcommunity *lcom1,
 	if (lcom1->size < lcom2->size)
 		return false;
 
+	if (lcom1->sorted && lcom2->sorted)
+		return lcommunity_match_sorted(lcom1, lcom2);
+
 	/* Every community on com2 needs to be on com1 for this to match */
 	while (i < lcom1->size && j < lcom2->size) {
 		if (memcmp(lcom1->val + (i * LCOMMUNITY_SIZE),
@@ -547,22 +609,67 @@ void bgp_aggr_lcommunity_remove(void *arg)
 	lcommunity_free(&lcommunity);
 }
 
-void bgp_compute_aggregate_lcommunity(struct bgp_aggregate *aggregate,
-				      struct lcommunity *lcommunity)
+/* Count the values of an lcommunity entering the aggregate's hash.  If
+ * aggr is given, the values not seen before are merged into it.
+ */
+static bool bgp_aggr_lcommunity_vals_add(struct bgp_aggregate *aggregate,
+					 struct lcommunity *lcommunity,
+					 struct lcommunity **aggr)
 {
+	bool changed = false;
+	uint8_t *lval;
+	int i;
 
-	bgp_compute_aggregate_lcommunity_hash(aggregate, lcommunity);
-	bgp_compute_aggregate_lcommunity_val(aggregate);
+	for (i = 0; i < lcommunity->size; i++) {
+		lval = lcommunity->val + i * LCOMMUNITY_SIZE;
+		if (!bgp_aggr_val_add(&aggregate->lcommunity_vals, lval,
+				      LCOMMUNITY_SIZE)
+		    || !aggr)
+			continue;
+
+		if (!*aggr)
+			*aggr = lcommunity_new();
+		lcommunity_add_val(*aggr, (struct lcommunity_val *)lval);
+		changed = true;
+	}
+	return changed;
 }
 
-void bgp_compute_aggregate_lcommunity_hash(struct bgp_aggregate *aggregate,
-					   struct lcommunity *lcommunity)
+/* Uncount the values of an lcommunity leaving the aggregate's hash.  If
+ * aggr is given, the values nobody else carries are removed from it.
+ */
+static bool bgp_aggr_lcommunity_vals_del(struct bgp_aggregate *aggregate,
+					 struct lcommunity *lcommunity,
+					 struct lcommunity **aggr)
 {
+	bool changed = false;
+	uint8_t *lval;
+	int i;
+
+	for (i = 0; i < lcommunity->size; i++) {
+		lval = lcommunity->val + i * LCOMMUNITY_SIZE;
+		if (!bgp_aggr_val_del(aggregate->lcommunity_vals, lval,
+				      LCOMMUNITY_SIZE)
+		    || !aggr || !*aggr)
+			continue;
 
+		lcommunity_del_val(*aggr, lval);
+		changed = true;
+	}
+
+	if (changed && !(*aggr)->size)
+		lcommunity_free(aggr);
+	return changed;
+}
+
+static bool bgp_aggr_lcommunity_get(struct bgp_aggregate *aggregate,
+				    struct lcommunity *lcommunity,
+				    struct lcommunity **aggr)
+{
 	struct lcommunity *aggr_lcommunity = NULL;
 
 	if ((aggregate == NULL) || (lcommunity == NULL))
-		return;
+		return false;
 
 	/* Create hash if not already created.
 	 */
@@ -582,7 +689,54 @@ void bgp_compute_aggregate_lcommunity_hash(struct bgp_aggregate *aggregate,
 
 	/* Increment reference counter.
 	 */
-	aggr_lcommunity->refcnt++;
+	if (aggr_lcommunity->refcnt++)
+		return false;
+
+	return bgp_aggr_lcommunity_vals_add(aggregate, aggr_lcommunity, aggr);
+}
+
+static bool bgp_aggr_lcommunity_put(struct bgp_aggregate *aggregate,
+				    struct lcommunity *lcommunity,
+				    struct lcommunity **aggr)
+{
+	struct lcommunity *aggr_lcommunity = NULL;
+	bool changed;
+
+	if ((!aggregate)
+	    || (!aggregate->lcommunity_hash)
+	    || (!lcommunity))
+		return false;
+
+	/* Look-up the lcommunity in the hash.
+	 */
+	aggr_lcommunity = bgp_aggr_lcommunity_lookup(aggregate, lcommunity);
+	if (!aggr_lcommunity || --aggr_lcommunity->refcnt)
+		return false;
+
+	hash_release(aggregate->lcommunity_hash, aggr_lcommunity);
+	changed = bgp_aggr_lcommunity_vals_del(aggregate, aggr_lcommunity,
+					       aggr);
+	lcommunity_free(&aggr_lcommunity);
+	return changed;
+}
+
+/* Add a route's lcommunity to the aggregate, updating the aggregate's
+ * lcommunity in place.  Returns true if the latter changed.
+ */
+bool bgp_compute_aggregate_lcommunity(struct bgp_aggregate *aggregate,
+				      struct lcommunity *lcommunity)
+{
+	if (aggregate == NULL)
+		return false;
+
+	return bgp_aggr_lcommunity_get(aggregate, lcommunity,
+				       &aggregate->lcommunity);
+}
+
+void bgp_compute_aggregate_lcommunity_hash(struct bgp_aggregate *aggregate,
+					   struct lcommunity *lcommunity)
+{
+	bgp_aggr_lcommunity_get(aggregate, lcommunity, NULL);
 }
 
 void bgp_compute_aggregate_lcommunity_val(struct bgp_aggregate *aggregate)
@@ -608,55 +762,18 @@ void bgp_compute_aggregate_lcommunity_val(struct bgp_aggregate *aggregate)
 	}
 }
 
-void bgp_remove_lcommunity_from_aggregate(struct bgp_aggregate *aggregate,
+bool bgp_remove_lcommunity_from_aggregate(struct bgp_aggregate *aggregate,
 					  struct lcommunity *lcommunity)
 {
-	struct lcommunity *aggr_lcommunity = NULL;
-	struct lcommunity *ret_lcomm = NULL;
-
-	if ((!aggregate)
-	    || (!aggregate->lcommunity_hash)
-	    || (!lcommunity))
-		return;
-
-	/* Look-up the lcommunity in the hash.
-	 */
-	aggr_lcommunity = bgp_aggr_lcommunity_lookup(aggregate, lcommunity);
-	if (aggr_lcommunity) {
-		aggr_lcommunity->refcnt--;
-
-		if (aggr_lcommunity->refcnt == 0) {
-			ret_lcomm = hash_release(aggregate->lcommunity_hash,
-						 aggr_lcommunity);
-			lcommunity_free(&ret_lcomm);
-
-			bgp_compute_aggregate_lcommunity_val(aggregate);
+	if (aggregate == NULL)
+		return false;
 
-		}
-	}
+	return bgp_aggr_lcommunity_put(aggregate, lcommunity,
+				       &aggregate->lcommunity);
 }
 
 void bgp_remove_lcomm_from_aggregate_hash(struct bgp_aggregate *aggregate,
 					  struct lcommunity *lcommunity)
 {
-	struct lcommunity *aggr_lcommunity = NULL;
-	struct lcommunity *ret_lcomm = NULL;
-
-	if ((!aggregate)
-	    || (!aggregate->lcommunity_hash)
-	    || (!lcommunity))
-		return;
-
-	/* Look-up the lcommunity in the hash.
-	 */
-	aggr_lcommunity = bgp_aggr_lcommunity_lookup(aggregate, lcommunity);
-	if (aggr_lcommunity) {
-		aggr_lcommunity->refcnt--;
-
-		if (aggr_lcommunity->refcnt == 0) {
-			ret_lcomm = hash_release(aggregate->lcommunity_hash,
-						 aggr_lcommunity);
-			lcommunity_free(&ret_lcomm);
-		}
-	}
+	bgp_aggr_lcommunity_put(aggregate, lcommunity, NULL);
 }
@@ -28,8 +28,11 @@ struct lcommunity {
 	/* Large Communities as a json object */
 	json_object *json;
 
-	/* Human readable format string.  */
+	/* Human readable format string, built on demand by lcommunity_str() */
 	char *str;
+
+	/* strictly ascending values, see struct community */
+	bool sorted;
 };
 
 /* Large community value is 12 octets.  */
@@ -51,16 +54,18 @@ extern struct lcommunity *lcommunity_intern(struct lcommunity *);
 extern bool lcommunity_cmp(const void *arg1, const void *arg2);
 extern void lcommunity_unintern(struct lcommunity **);
 extern unsigned int lcommunity_hash_make(const void *);
-extern struct hash *lcommunity_hash(void);
+extern void lcommunity_iterate(void (*func)(struct hash_bucket *, void *),
+			       void *arg);
 extern struct lcommunity *lcommunity_str2com(const char *);
 extern bool lcommunity_match(const struct lcommunity *,
 			     const struct lcommunity *);
+extern void lcommunity_set_sorted(struct lcommunity *lcom);
 extern char *lcommunity_str(struct lcommunity *, bool make_json,
 			    bool translate_alias);
 extern bool lcommunity_include(struct lcommunity *lcom, uint8_t *ptr);
 extern void lcommunity_del_val(struct lcommunity *lcom, uint8_t *ptr);
 
-extern void bgp_compute_aggregate_lcommunity(
+extern bool bgp_compute_aggregate_lcommunity(
 					struct bgp_aggregate *aggregate,
 					struct lcommunity *lcommunity);
 
@@ -70,7 +75,7 @@ extern void bgp_compute_aggregate_lcommunity_hash(
 extern void bgp_compute_aggregate_lcommunity_val(
 					struct bgp_aggregate *aggregate);
 
-extern void bgp_remove_lcommunity_from_aggregate(
+extern bool bgp_remove_lcommunity_from_aggregate(
 					struct bgp_aggregate *aggregate,
 					struct lcommunity *lcommunity);
 extern void bgp_remove_lcomm_from_aggregate_hash(
@@ -50,6 +50,7 @@
 #include "bgpd/bgp_nht.h"
 #include "bgpd/bgp_routemap_nb.h"
 #include "bgpd/bgp_community_alias.h"
+#include "bgpd/bgp_mpath.h"
 
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/rfapi_backend.h"
@@ -196,6 +197,9 @@ static __attribute__((__noreturn__)) void bgp_exit(int status)
 	if (bgp_default)
 		bgp_delete(bgp_default);
 
+	bgp_evpn_macip_batch_finish();
+	bgp_evpn_vrf_import_batch_finish();
+	vpn_leak_import_rt_finish();
 	bgp_evpn_mh_finish();
 	bgp_l3nhg_finish();
 
@@ -208,6 +212,9 @@ static __attribute__((__noreturn__)) void bgp_exit(int status)
 	/* reverse bgp_route_init */
 	bgp_route_finish();
 
+	/* holds attr references */
+	bgp_mpath_aggr_cache_flush();
+
 	/* cleanup route maps */
 	bgp_route_map_terminate();
 
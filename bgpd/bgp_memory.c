@@ -37,9 +37,13 @@ DEFINE_MTYPE(BGPD, BGP_TABLE, "BGP table");
 DEFINE_MTYPE(BGPD, BGP_NODE, "BGP node");
 DEFINE_MTYPE(BGPD, BGP_ROUTE, "BGP route");
 DEFINE_MTYPE(BGPD, BGP_ROUTE_EXTRA, "BGP ancillary route info");
+DEFINE_MTYPE(BGPD, BGP_ROUTE_EXTRA_EVPN, "BGP extra info for EVPN");
+DEFINE_MTYPE(BGPD, BGP_ROUTE_EXTRA_FS, "BGP extra info for flowspec");
+DEFINE_MTYPE(BGPD, BGP_ROUTE_EXTRA_VRFLEAK, "BGP extra info for vrf leaking");
 DEFINE_MTYPE(BGPD, BGP_CONN, "BGP connected");
 DEFINE_MTYPE(BGPD, BGP_STATIC, "BGP static");
 DEFINE_MTYPE(BGPD, BGP_ADVERTISE_ATTR, "BGP adv attr");
+DEFINE_MTYPE(BGPD, BGP_ADVERTISE_ATTR_ENC, "BGP adv attr encoding");
 DEFINE_MTYPE(BGPD, BGP_ADVERTISE, "BGP adv");
 DEFINE_MTYPE(BGPD, BGP_SYNCHRONISE, "BGP synchronise");
 DEFINE_MTYPE(BGPD, BGP_ADJ_IN, "BGP adj in");
@@ -49,6 +53,7 @@ DEFINE_MTYPE(BGPD, BGP_MPATH_INFO, "BGP multipath info");
 DEFINE_MTYPE(BGPD, AS_LIST, "BGP AS list");
 DEFINE_MTYPE(BGPD, AS_FILTER, "BGP AS filter");
 DEFINE_MTYPE(BGPD, AS_FILTER_STR, "BGP AS filter str");
+DEFINE_MTYPE(BGPD, AS_LIST_CACHE, "BGP AS list result cache");
 
 DEFINE_MTYPE(BGPD, COMMUNITY_ALIAS, "community alias");
 
@@ -87,6 +92,7 @@ DEFINE_MTYPE(BGPD, BGP_DAMP_INFO, "Dampening info");
 DEFINE_MTYPE(BGPD, BGP_DAMP_ARRAY, "BGP Dampening array");
 DEFINE_MTYPE(BGPD, BGP_REGEXP, "BGP regexp");
 DEFINE_MTYPE(BGPD, BGP_AGGREGATE, "BGP aggregate");
+DEFINE_MTYPE(BGPD, BGP_AGGREGATE_VAL, "BGP aggregate value");
 DEFINE_MTYPE(BGPD, BGP_ADDR, "BGP own address");
 DEFINE_MTYPE(BGPD, TIP_ADDR, "BGP own tunnel-ip address");
 
@@ -126,3 +132,5 @@ DEFINE_MTYPE(BGPD, EVPN_REMOTE_IP, "BGP EVPN Remote IP hash entry");
 DEFINE_MTYPE(BGPD, BGP_NOTIFICATION, "BGP Notification Message");
 
 DEFINE_MTYPE(BGPD, BGP_SOFT_VERSION, "Software Version");
+
+DEFINE_MTYPE(BGPD, BGP_SHOW_CONT, "BGP show output continuation");
@@ -33,9 +33,13 @@ DECLARE_MTYPE(BGP_TABLE);
 DECLARE_MTYPE(BGP_NODE);
 DECLARE_MTYPE(BGP_ROUTE);
 DECLARE_MTYPE(BGP_ROUTE_EXTRA);
+DECLARE_MTYPE(BGP_ROUTE_EXTRA_EVPN);
+DECLARE_MTYPE(BGP_ROUTE_EXTRA_FS);
+DECLARE_MTYPE(BGP_ROUTE_EXTRA_VRFLEAK);
 DECLARE_MTYPE(BGP_CONN);
 DECLARE_MTYPE(BGP_STATIC);
 DECLARE_MTYPE(BGP_ADVERTISE_ATTR);
+DECLARE_MTYPE(BGP_ADVERTISE_ATTR_ENC);
 DECLARE_MTYPE(BGP_ADVERTISE);
 DECLARE_MTYPE(BGP_SYNCHRONISE);
 DECLARE_MTYPE(BGP_ADJ_IN);
@@ -45,6 +49,7 @@ DECLARE_MTYPE(BGP_MPATH_INFO);
 DECLARE_MTYPE(AS_LIST);
 DECLARE_MTYPE(AS_FILTER);
 DECLARE_MTYPE(AS_FILTER_STR);
+DECLARE_MTYPE(AS_LIST_CACHE);
 
 DECLARE_MTYPE(COMMUNITY_ALIAS);
 
@@ -83,6 +88,7 @@ DECLARE_MTYPE(BGP_DAMP_INFO);
 DECLARE_MTYPE(BGP_DAMP_ARRAY);
 DECLARE_MTYPE(BGP_REGEXP);
 DECLARE_MTYPE(BGP_AGGREGATE);
+DECLARE_MTYPE(BGP_AGGREGATE_VAL);
 DECLARE_MTYPE(BGP_ADDR);
 DECLARE_MTYPE(TIP_ADDR);
 
@@ -125,4 +131,6 @@ DECLARE_MTYPE(BGP_NOTIFICATION);
 
 DECLARE_MTYPE(BGP_SOFT_VERSION);
 
+DECLARE_MTYPE(BGP_SHOW_CONT);
+
 #endif /* _QUAGGA_BGP_MEMORY_H */
@@ -15,6 +15,9 @@
 #include "memory.h"
 #include "queue.h"
 #include "filter.h"
+#include "hash.h"
+#include "jhash.h"
+#include "mempressure.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_table.h"
@@ -27,6 +30,123 @@
 #include "bgpd/bgp_lcommunity.h"
 #include "bgpd/bgp_mpath.h"
 
+DEFINE_MTYPE_STATIC(BGPD, BGP_MPATH_AGGR, "BGP multipath aggregate cache");
+
+/*
+ * Aggregate attributes built with "multipath-relax as-set", keyed by the
+ * attributes of the best path and its multipaths, in order.  Many prefixes
+ * usually share the same candidates (e.g. all routes of a VRF behind the
+ * same pair of PEs), so the AS-path and community merge only has to be
+ * done once per distinct set.  The result only depends on the key, so
+ * nothing ever needs invalidating; entries hold a reference on each attr
+ * in the key so that the pointers stay unique while cached.
+ */
+#define BGP_MPATH_AGGR_KEY_MAX	64
+#define BGP_MPATH_AGGR_MAX	4096
+
+struct bgp_mpath_aggr {
+	struct attr *result;
+	uint32_t count;
+	struct attr **attrs;
+};
+
+static struct hash *bgp_mpath_aggr_hash;
+
+static unsigned int bgp_mpath_aggr_hash_key(const void *arg)
+{
+	const struct bgp_mpath_aggr *aggr = arg;
+
+	return jhash(aggr->attrs, aggr->count * sizeof(aggr->attrs[0]),
+		     0x2f4e8a61);
+}
+
+static bool bgp_mpath_aggr_hash_cmp(const void *arg1, const void *arg2)
+{
+	const struct bgp_mpath_aggr *a1 = arg1, *a2 = arg2;
+
+	return a1->count == a2->count &&
+	       !memcmp(a1->attrs, a2->attrs, a1->count * sizeof(a1->attrs[0]));
+}
+
+static void bgp_mpath_aggr_free(void *arg)
+{
+	struct bgp_mpath_aggr *aggr = arg;
+	uint32_t i;
+
+	bgp_attr_unintern(&aggr->result);
+	for (i = 0; i < aggr->count; i++)
+		bgp_attr_unintern(&aggr->attrs[i]);
+	XFREE(MTYPE_BGP_MPATH_AGGR, aggr);
+}
+
+void bgp_mpath_aggr_cache_flush(void)
+{
+	if (!bgp_mpath_aggr_hash)
+		return;
+
+	hash_clean_and_free(&bgp_mpath_aggr_hash, bgp_mpath_aggr_free);
+}
+
+/* Fill in the key for new_best, false if it's too long to be cached */
+static bool bgp_mpath_aggr_key(struct bgp_mpath_aggr *key,
+			       struct bgp_path_info *new_best)
+{
+	struct bgp_path_info *mpinfo;
+
+	key->count = 0;
+	key->attrs[key->count++] = new_best->attr;
+	for (mpinfo = bgp_path_info_mpath_first(new_best); mpinfo;
+	     mpinfo = bgp_path_info_mpath_next(mpinfo)) {
+		if (key->count == BGP_MPATH_AGGR_KEY_MAX)
+			return false;
+		key->attrs[key->count++] = mpinfo->attr;
+	}
+	return true;
+}
+
+/* Returns a new reference on the cached aggregate, if any */
+static struct attr *bgp_mpath_aggr_lookup(struct bgp_mpath_aggr *key)
+{
+	struct bgp_mpath_aggr *aggr;
+
+	if (!bgp_mpath_aggr_hash)
+		return NULL;
+
+	aggr = hash_lookup(bgp_mpath_aggr_hash, key);
+	return aggr ? bgp_attr_intern(aggr->result) : NULL;
+}
+
+static void bgp_mpath_aggr_add(struct bgp_mpath_aggr *key,
+			       struct attr *result)
+{
+	struct bgp_mpath_aggr *aggr;
+	uint32_t i;
+
+	if (mempressure_level() != MEMPRESSURE_NONE)
+		return;
+
+	if (!bgp_mpath_aggr_hash)
+		bgp_mpath_aggr_hash =
+			hash_create(bgp_mpath_aggr_hash_key,
+				    bgp_mpath_aggr_hash_cmp,
+				    "BGP multipath aggregate cache");
+	else if (bgp_mpath_aggr_hash->count >= BGP_MPATH_AGGR_MAX)
+		/* attrs in old entries are kept alive by them; start over
+		 * rather than keep pinning them
+		 */
+		hash_clean(bgp_mpath_aggr_hash, bgp_mpath_aggr_free);
+
+	aggr = XMALLOC(MTYPE_BGP_MPATH_AGGR,
+		       sizeof(*aggr) + key->count * sizeof(aggr->attrs[0]));
+	aggr->attrs = (struct attr **)(aggr + 1);
+	aggr->count = key->count;
+	for (i = 0; i < key->count; i++)
+		aggr->attrs[i] = bgp_attr_intern(key->attrs[i]);
+	aggr->result = bgp_attr_intern(result);
+
+	(void)hash_get(bgp_mpath_aggr_hash, aggr, hash_alloc_intern);
+}
+
 /*
  * bgp_maximum_paths_set
  *
@@ -173,10 +293,11 @@ int bgp_path_info_nexthop_cmp(struct bgp_path_info *bpi1,
 	 * if they belong to same VRF
 	 */
 	if (!compare && bpi1->attr->nh_type != NEXTHOP_TYPE_BLACKHOLE) {
-		if (bpi1->extra && bpi1->extra->bgp_orig && bpi2->extra
-		    && bpi2->extra->bgp_orig) {
-			if (bpi1->extra->bgp_orig->vrf_id
-			    != bpi2->extra->bgp_orig->vrf_id) {
+		if (bpi1->extra && bpi1->extra->vrfleak &&
+		    bpi1->extra->vrfleak->bgp_orig && bpi2->extra &&
+		    bpi2->extra->vrfleak && bpi2->extra->vrfleak->bgp_orig) {
+			if (bpi1->extra->vrfleak->bgp_orig->vrf_id
+			    != bpi2->extra->vrfleak->bgp_orig->vrf_id) {
 				compare = 1;
 			}
 		}
@@ -800,6 +921,9 @@ void bgp_path_info_mpath_aggregate_update(struct bgp_path_info *new_best,
 	struct ecommunity *ecomm, *ecommerge;
 	struct lcommunity *lcomm, *lcommerge;
 	struct attr attr = {0};
+	struct attr *key_attrs[BGP_MPATH_AGGR_KEY_MAX];
+	struct bgp_mpath_aggr key = { .attrs = key_attrs };
+	bool relax, cacheable = false;
 
 	if (old_best && (old_best != new_best)
 	    && (old_attr = bgp_path_info_mpath_attr(old_best))) {
@@ -820,10 +944,17 @@ void bgp_path_info_mpath_aggregate_update(struct bgp_path_info *new_best,
 	}
 
 	attr = *new_best->attr;
+	new_attr = NULL;
+
+	relax = new_best->peer && CHECK_FLAG(new_best->peer->bgp->flags,
+					     BGP_FLAG_MULTIPATH_RELAX_AS_SET);
+	if (relax) {
+		cacheable = bgp_mpath_aggr_key(&key, new_best);
+		if (cacheable)
+			new_attr = bgp_mpath_aggr_lookup(&key);
+	}
 
-	if (new_best->peer
-	    && CHECK_FLAG(new_best->peer->bgp->flags,
-			  BGP_FLAG_MULTIPATH_RELAX_AS_SET)) {
+	if (relax && !new_attr) {
 
 		/* aggregate attribute from multipath constituents */
 		aspath = aspath_dup(attr.aspath);
@@ -904,9 +1035,14 @@ void bgp_path_info_mpath_aggregate_update(struct bgp_path_info *new_best,
 		memset(&attr.mp_nexthop_global, 0, sizeof(struct in6_addr));
 
 		/* TODO: should we set ATOMIC_AGGREGATE and AGGREGATOR? */
+
+		new_attr = bgp_attr_intern(&attr);
+		if (cacheable)
+			bgp_mpath_aggr_add(&key, new_attr);
 	}
 
-	new_attr = bgp_attr_intern(&attr);
+	if (!new_attr)
+		new_attr = bgp_attr_intern(&attr);
 
 	if (new_attr != bgp_path_info_mpath_attr(new_best)) {
 		if ((old_attr = bgp_path_info_mpath_attr(new_best)))
@@ -79,4 +79,6 @@ extern bool bgp_path_info_mpath_chkwtd(struct bgp *bgp,
 				       struct bgp_path_info *path);
 extern uint64_t bgp_path_info_mpath_cumbw(struct bgp_path_info *path);
 
+extern void bgp_mpath_aggr_cache_flush(void);
+
 #endif /* _FRR_BGP_MPATH_H */
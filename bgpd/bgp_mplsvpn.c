@@ -14,6 +14,8 @@
 #include "filter.h"
 #include "mpls.h"
 #include "json.h"
+#include "jhash.h"
+#include "hash.h"
 #include "zclient.h"
 
 #include "bgpd/bgpd.h"
@@ -39,11 +41,296 @@
 #include "bgpd/rfapi/rfapi_backend.h"
 #endif
 
+DEFINE_MTYPE_STATIC(BGPD, VPN_IMPORT_RT, "BGP VPN import RT index");
+
 /*
  * Definitions and external declarations.
  */
 extern struct zclient *zclient;
 
+/*
+ * Route target to importing VRF index, used when leaking VPN routes into
+ * VRFs so that only the instances importing one of the route's RTs are
+ * visited. The index is rebuilt from the "rt vpn import" lists of all
+ * instances the first time it is used after any of them changed.
+ */
+struct vpn_import_rt {
+	afi_t afi;
+	struct ecommunity_val rt;
+
+	/* instances importing this RT */
+	struct list *vrfs;
+
+	/* VPN updates and withdraws that carried this RT */
+	uint64_t updates;
+	uint64_t withdraws;
+};
+
+static struct hash *vpn_import_rt_hash;
+static bool vpn_import_rt_stale = true;
+static uint32_t vpn_import_rt_gen;
+
+/* instances whose import list can't be indexed (non 8 byte RTs) */
+static struct list *vpn_import_rt_unindexed[AFI_MAX];
+
+static unsigned int vpn_import_rt_hash_key(const void *arg)
+{
+	const struct vpn_import_rt *irt = arg;
+
+	return jhash(irt->rt.val, ECOMMUNITY_SIZE, irt->afi);
+}
+
+static bool vpn_import_rt_hash_cmp(const void *arg1, const void *arg2)
+{
+	const struct vpn_import_rt *irt1 = arg1;
+	const struct vpn_import_rt *irt2 = arg2;
+
+	return irt1->afi == irt2->afi &&
+	       !memcmp(irt1->rt.val, irt2->rt.val, ECOMMUNITY_SIZE);
+}
+
+static void *vpn_import_rt_alloc(void *arg)
+{
+	const struct vpn_import_rt *key = arg;
+	struct vpn_import_rt *irt;
+
+	irt = XCALLOC(MTYPE_VPN_IMPORT_RT, sizeof(*irt));
+	irt->afi = key->afi;
+	irt->rt = key->rt;
+	irt->vrfs = list_new();
+
+	return irt;
+}
+
+static void vpn_import_rt_free(void *arg)
+{
+	struct vpn_import_rt *irt = arg;
+
+	list_delete(&irt->vrfs);
+	XFREE(MTYPE_VPN_IMPORT_RT, irt);
+}
+
+void vpn_leak_import_rt_invalidate(void)
+{
+	vpn_import_rt_stale = true;
+}
+
+static void vpn_import_rt_reset(struct hash_bucket *bucket, void *arg)
+{
+	struct vpn_import_rt *irt = bucket->data;
+
+	list_delete_all_node(irt->vrfs);
+}
+
+static void vpn_import_rt_sweep(struct hash_bucket *bucket, void *arg)
+{
+	struct vpn_import_rt *irt = bucket->data;
+
+	if (listcount(irt->vrfs))
+		return;
+
+	hash_release(vpn_import_rt_hash, irt);
+	vpn_import_rt_free(irt);
+}
+
+/* Update the index if needed; entries still in use keep their counters */
+static void vpn_import_rt_refresh(void)
+{
+	struct vpn_import_rt key, *irt;
+	struct listnode *node;
+	struct ecommunity *ecom;
+	struct bgp *bgp;
+	uint32_t i;
+	afi_t afi;
+
+	if (!vpn_import_rt_stale)
+		return;
+
+	if (!vpn_import_rt_hash)
+		vpn_import_rt_hash = hash_create(vpn_import_rt_hash_key,
+						 vpn_import_rt_hash_cmp,
+						 "BGP VPN import RT index");
+
+	hash_iterate(vpn_import_rt_hash, vpn_import_rt_reset, NULL);
+	for (afi = AFI_IP; afi < AFI_MAX; afi++) {
+		if (!vpn_import_rt_unindexed[afi])
+			vpn_import_rt_unindexed[afi] = list_new();
+		list_delete_all_node(vpn_import_rt_unindexed[afi]);
+	}
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
+		for (afi = AFI_IP; afi < AFI_MAX; afi++) {
+			ecom = bgp->vpn_policy[afi]
+				       .rtlist[BGP_VPN_POLICY_DIR_FROMVPN];
+			if (!ecom || !ecom->size)
+				continue;
+
+			if (ecom->unit_size != ECOMMUNITY_SIZE) {
+				listnode_add(vpn_import_rt_unindexed[afi], bgp);
+				continue;
+			}
+
+			key.afi = afi;
+			for (i = 0; i < ecom->size; i++) {
+				memcpy(key.rt.val,
+				       ecom->val + (i * ECOMMUNITY_SIZE),
+				       ECOMMUNITY_SIZE);
+				irt = hash_get(vpn_import_rt_hash, &key,
+					       vpn_import_rt_alloc);
+				if (!listcount(irt->vrfs) ||
+				    listgetdata(listtail(irt->vrfs)) != bgp)
+					listnode_add(irt->vrfs, bgp);
+			}
+		}
+	}
+
+	hash_iterate(vpn_import_rt_hash, vpn_import_rt_sweep, NULL);
+	vpn_import_rt_stale = false;
+}
+
+/*
+ * Call fn for every instance that may import a VPN route with these
+ * extended communities, each instance at most once.
+ */
+static void vpn_import_rt_foreach(afi_t afi, struct ecommunity *ecom,
+				  bool withdraw,
+				  void (*fn)(struct bgp *bgp, void *arg),
+				  void *arg)
+{
+	struct vpn_import_rt key, *irt;
+	struct listnode *node, *nnode;
+	struct bgp *bgp;
+	uint32_t i;
+
+	if (!ecom || !ecom->size)
+		return;
+
+	vpn_import_rt_refresh();
+
+	/* only 8 byte values can match an indexed import list */
+	if (ecom->unit_size != ECOMMUNITY_SIZE) {
+		for (ALL_LIST_ELEMENTS(bm->bgp, node, nnode, bgp))
+			fn(bgp, arg);
+		return;
+	}
+
+	vpn_import_rt_gen++;
+
+	key.afi = afi;
+	for (i = 0; i < ecom->size; i++) {
+		memcpy(key.rt.val, ecom->val + (i * ECOMMUNITY_SIZE),
+		       ECOMMUNITY_SIZE);
+		irt = hash_lookup(vpn_import_rt_hash, &key);
+		if (!irt)
+			continue;
+
+		if (withdraw)
+			irt->withdraws++;
+		else
+			irt->updates++;
+
+		for (ALL_LIST_ELEMENTS(irt->vrfs, node, nnode, bgp)) {
+			if (bgp->vpn_import_gen == vpn_import_rt_gen)
+				continue;
+			bgp->vpn_import_gen = vpn_import_rt_gen;
+			fn(bgp, arg);
+		}
+	}
+
+	for (ALL_LIST_ELEMENTS(vpn_import_rt_unindexed[afi], node, nnode, bgp)) {
+		if (bgp->vpn_import_gen == vpn_import_rt_gen)
+			continue;
+		bgp->vpn_import_gen = vpn_import_rt_gen;
+		fn(bgp, arg);
+	}
+}
+
+static int vpn_import_rt_cmp(const void **a, const void **b)
+{
+	const struct vpn_import_rt *irt1 = *a;
+	const struct vpn_import_rt *irt2 = *b;
+
+	return memcmp(irt1->rt.val, irt2->rt.val, ECOMMUNITY_SIZE);
+}
+
+static void vpn_import_rt_show(struct vty *vty, afi_t afi, json_object *json)
+{
+	struct list *sorted;
+	struct listnode *node, *vnode;
+	struct vpn_import_rt *irt;
+	struct ecommunity ecom = {};
+	json_object *json_rts = NULL, *json_rt, *json_vrfs;
+	struct bgp *bgp;
+	char *rtstr;
+
+	vpn_import_rt_refresh();
+
+	if (json) {
+		json_rts = json_object_new_object();
+		json_object_object_add(json, "importRts", json_rts);
+	} else
+		vty_out(vty, "%-24s %6s %12s %12s  %s\n", "Route Target",
+			"Fanout", "Updates", "Withdraws", "VRFs");
+
+	sorted = hash_to_list(vpn_import_rt_hash);
+	list_sort(sorted, vpn_import_rt_cmp);
+
+	for (ALL_LIST_ELEMENTS_RO(sorted, node, irt)) {
+		if (irt->afi != afi)
+			continue;
+
+		ecom.size = 1;
+		ecom.unit_size = ECOMMUNITY_SIZE;
+		ecom.val = (uint8_t *)irt->rt.val;
+		rtstr = ecommunity_ecom2str(&ecom, ECOMMUNITY_FORMAT_ROUTE_MAP,
+					    0);
+
+		if (json) {
+			json_rt = json_object_new_object();
+			json_vrfs = json_object_new_array();
+			for (ALL_LIST_ELEMENTS_RO(irt->vrfs, vnode, bgp))
+				json_object_array_add(
+					json_vrfs,
+					json_object_new_string(bgp->name_pretty));
+			json_object_int_add(json_rt, "fanout",
+					    listcount(irt->vrfs));
+			json_object_int_add(json_rt, "updates", irt->updates);
+			json_object_int_add(json_rt, "withdraws",
+					    irt->withdraws);
+			json_object_object_add(json_rt, "vrfs", json_vrfs);
+			json_object_object_add(json_rts, rtstr, json_rt);
+		} else {
+			vty_out(vty, "%-24s %6u %12" PRIu64 " %12" PRIu64 " ",
+				rtstr, listcount(irt->vrfs), irt->updates,
+				irt->withdraws);
+			for (ALL_LIST_ELEMENTS_RO(irt->vrfs, vnode, bgp))
+				vty_out(vty, " %s", bgp->name_pretty);
+			vty_out(vty, "\n");
+		}
+
+		XFREE(MTYPE_ECOMMUNITY_STR, rtstr);
+	}
+
+	list_delete(&sorted);
+
+	if (json)
+		json_object_int_add(json, "unindexedVrfs",
+				    listcount(vpn_import_rt_unindexed[afi]));
+	else if (listcount(vpn_import_rt_unindexed[afi]))
+		vty_out(vty, "%u VRFs import non-indexed route targets\n",
+			listcount(vpn_import_rt_unindexed[afi]));
+}
+
+void vpn_leak_import_rt_finish(void)
+{
+	afi_t afi;
+
+	hash_clean_and_free(&vpn_import_rt_hash, vpn_import_rt_free);
+	for (afi = AFI_IP; afi < AFI_MAX; afi++)
+		list_delete(&vpn_import_rt_unindexed[afi]);
+	vpn_import_rt_stale = true;
+}
+
 extern int argv_find_and_parse_vpnvx(struct cmd_token **argv, int argc,
 				     int *index, afi_t *afi)
 {
@@ -591,29 +878,28 @@ static void sid_register(struct bgp *bgp, const struct in6_addr *sid,
 	snprintf(func->locator_name, sizeof(func->locator_name),
 		 "%s", locator_name);
 	listnode_add(bgp->srv6_functions, func);
+	(void)hash_get(bgp->srv6_function_hash, func, hash_alloc_intern);
+}
+
+static struct bgp_srv6_function *sid_lookup(struct bgp *bgp,
+					    const struct in6_addr *sid)
+{
+	struct bgp_srv6_function tmp = { .sid = *sid };
+
+	return hash_lookup(bgp->srv6_function_hash, &tmp);
 }
 
 static void sid_unregister(struct bgp *bgp, const struct in6_addr *sid)
 {
-	struct listnode *node, *nnode;
-	struct bgp_srv6_function *func;
+	struct bgp_srv6_function *func = sid_lookup(bgp, sid);
 
-	for (ALL_LIST_ELEMENTS(bgp->srv6_functions, node, nnode, func))
-		if (sid_same(&func->sid, sid)) {
-			listnode_delete(bgp->srv6_functions, func);
-			XFREE(MTYPE_BGP_SRV6_FUNCTION, func);
-		}
+	if (func)
+		bgp_srv6_function_delete(bgp, func);
 }
 
 static bool sid_exist(struct bgp *bgp, const struct in6_addr *sid)
 {
-	struct listnode *node;
-	struct bgp_srv6_function *func;
-
-	for (ALL_LIST_ELEMENTS_RO(bgp->srv6_functions, node, func))
-		if (sid_same(&func->sid, sid))
-			return true;
-	return false;
+	return sid_lookup(bgp, sid) != NULL;
 }
 
 /*
@@ -877,6 +1163,7 @@ void delete_vrf_tovpn_sid_per_af(struct bgp *bgp_vpn, struct bgp *bgp_vrf,
 		XFREE(MTYPE_BGP_SRV6_SID, bgp_vrf->vpn_policy[afi].tovpn_sid);
 	}
 	bgp_vrf->vpn_policy[afi].tovpn_sid_transpose_label = 0;
+	bgp_attr_srv6_l3vpn_put(&bgp_vrf->vpn_policy[afi].tovpn_srv6_l3vpn);
 }
 
 void delete_vrf_tovpn_sid_per_vrf(struct bgp *bgp_vpn, struct bgp *bgp_vrf)
@@ -904,6 +1191,7 @@ void delete_vrf_tovpn_sid_per_vrf(struct bgp *bgp_vpn, struct bgp *bgp_vrf)
 		XFREE(MTYPE_BGP_SRV6_SID, bgp_vrf->tovpn_sid);
 	}
 	bgp_vrf->tovpn_sid_transpose_label = 0;
+	bgp_attr_srv6_l3vpn_put(&bgp_vrf->tovpn_srv6_l3vpn);
 }
 
 void delete_vrf_tovpn_sid(struct bgp *bgp_vpn, struct bgp *bgp_vrf, afi_t afi)
@@ -1049,8 +1337,9 @@ static bool leak_update_nexthop_valid(struct bgp *to_bgp, struct bgp_dest *bn,
 
 	bpi_ultimate = bgp_get_imported_bpi_ultimate(source_bpi);
 
-	if (bpi->extra && bpi->extra->bgp_orig)
-		bgp_nexthop = bpi->extra->bgp_orig;
+	if (bpi->extra && bpi->extra->vrfleak &&
+	    bpi->extra->vrfleak->bgp_orig)
+		bgp_nexthop = bpi->extra->vrfleak->bgp_orig;
 	else
 		bgp_nexthop = bgp_orig;
 
@@ -1134,7 +1423,8 @@ leak_update(struct bgp *to_bgp, struct bgp_dest *bn,
 	 * match parent
 	 */
 	for (bpi = bgp_dest_get_bgp_path_info(bn); bpi; bpi = bpi->next) {
-		if (bpi->extra && bpi->extra->parent == parent)
+		if (bpi->extra && bpi->extra->vrfleak &&
+		    bpi->extra->vrfleak->parent == parent)
 			break;
 	}
 
@@ -1269,10 +1559,9 @@ leak_update(struct bgp *to_bgp, struct bgp_dest *bn,
 	new = info_make(ZEBRA_ROUTE_BGP, BGP_ROUTE_IMPORTED, 0,
 			to_bgp->peer_self, new_attr, bn);
 
-	if (source_bpi->peer) {
-		extra = bgp_path_info_extra_get(new);
-		extra->peer_orig = peer_lock(source_bpi->peer);
-	}
+	if (source_bpi->peer)
+		bgp_path_info_vrfleak_get(new)->peer_orig =
+			peer_lock(source_bpi->peer);
 
 	if (nexthop_self_flag)
 		bgp_path_info_set_flag(bn, new, BGP_PATH_ANNC_NH_SELF);
@@ -1309,13 +1598,13 @@ leak_update(struct bgp *to_bgp, struct bgp_dest *bn,
 	if (num_labels)
 		setlabels(new, label, num_labels);
 
-	new->extra->parent = bgp_path_info_lock(parent);
+	bgp_path_info_vrfleak_get(new)->parent = bgp_path_info_lock(parent);
 	bgp_dest_lock_node(
 		(struct bgp_dest *)((struct bgp_path_info *)parent)->net);
 	if (bgp_orig)
-		new->extra->bgp_orig = bgp_lock(bgp_orig);
+		new->extra->vrfleak->bgp_orig = bgp_lock(bgp_orig);
 	if (nexthop_orig)
-		new->extra->nexthop_orig = *nexthop_orig;
+		new->extra->vrfleak->nexthop_orig = *nexthop_orig;
 
 	if (leak_update_nexthop_valid(to_bgp, bn, new_attr, afi, safi,
 				      source_bpi, new, bgp_orig, p, debug))
@@ -1336,6 +1625,22 @@ leak_update(struct bgp *to_bgp, struct bgp_dest *bn,
 	return new;
 }
 
+/*
+ * All routes leaked from a VRF carry the same SRv6 service TLV, built from the
+ * VRF's SID.  One interned copy is kept per VRF (or VRF and AFI) and attached
+ * to each route, rather than allocating and looking up a new one per route.
+ */
+static struct bgp_attr_srv6_l3vpn *
+vpn_srv6_l3vpn_get(struct bgp_attr_srv6_l3vpn **cache,
+		   const struct bgp_attr_srv6_l3vpn *srv6_l3vpn)
+{
+	if (!bgp_attr_srv6_l3vpn_same(*cache, srv6_l3vpn)) {
+		bgp_attr_srv6_l3vpn_put(cache);
+		*cache = bgp_attr_srv6_l3vpn_get(srv6_l3vpn);
+	}
+	return *cache;
+}
+
 /* cf vnc_import_bgp_add_route_mode_nvegroup() and add_vnc_route() */
 void vpn_leak_from_vrf_update(struct bgp *to_bgp,	     /* to */
 			      struct bgp *from_bgp,	   /* from */
@@ -1352,6 +1657,9 @@ void vpn_leak_from_vrf_update(struct bgp *to_bgp,	     /* to */
 	struct bgp_dest *bn;
 	const char *debugmsg;
 	int nexthop_self_flag = 0;
+	struct srv6_locator_chunk *locator = NULL;
+	struct bgp_attr_srv6_l3vpn srv6_l3vpn = {};
+	struct bgp_attr_srv6_l3vpn **srv6_l3vpn_cache = NULL;
 
 	if (debug)
 		zlog_debug("%s: from vrf %s", __func__, from_bgp->name_pretty);
@@ -1541,15 +1849,12 @@ void vpn_leak_from_vrf_update(struct bgp *to_bgp,	     /* to */
 
 	/* Set SID for SRv6 VPN */
 	if (from_bgp->vpn_policy[afi].tovpn_sid_locator) {
-		struct srv6_locator_chunk *locator =
-			from_bgp->vpn_policy[afi].tovpn_sid_locator;
+		locator = from_bgp->vpn_policy[afi].tovpn_sid_locator;
 		encode_label(
 			from_bgp->vpn_policy[afi].tovpn_sid_transpose_label,
 			&label);
-		static_attr.srv6_l3vpn = XCALLOC(MTYPE_BGP_SRV6_L3VPN,
-				sizeof(struct bgp_attr_srv6_l3vpn));
-		static_attr.srv6_l3vpn->sid_flags = 0x00;
-		static_attr.srv6_l3vpn->endpoint_behavior =
+		srv6_l3vpn_cache = &from_bgp->vpn_policy[afi].tovpn_srv6_l3vpn;
+		srv6_l3vpn.endpoint_behavior =
 			afi == AFI_IP
 				? (CHECK_FLAG(locator->flags, SRV6_LOCATOR_USID)
 					   ? SRV6_ENDPOINT_BEHAVIOR_END_DT4_USID
@@ -1557,61 +1862,29 @@ void vpn_leak_from_vrf_update(struct bgp *to_bgp,	     /* to */
 				: (CHECK_FLAG(locator->flags, SRV6_LOCATOR_USID)
 					   ? SRV6_ENDPOINT_BEHAVIOR_END_DT6_USID
 					   : SRV6_ENDPOINT_BEHAVIOR_END_DT6);
-		static_attr.srv6_l3vpn->loc_block_len =
-			from_bgp->vpn_policy[afi]
-				.tovpn_sid_locator->block_bits_length;
-		static_attr.srv6_l3vpn->loc_node_len =
-			from_bgp->vpn_policy[afi]
-				.tovpn_sid_locator->node_bits_length;
-		static_attr.srv6_l3vpn->func_len =
-			from_bgp->vpn_policy[afi]
-				.tovpn_sid_locator->function_bits_length;
-		static_attr.srv6_l3vpn->arg_len =
-			from_bgp->vpn_policy[afi]
-				.tovpn_sid_locator->argument_bits_length;
-		static_attr.srv6_l3vpn->transposition_len =
-			from_bgp->vpn_policy[afi]
-				.tovpn_sid_locator->function_bits_length;
-		static_attr.srv6_l3vpn->transposition_offset =
-			from_bgp->vpn_policy[afi]
-				.tovpn_sid_locator->block_bits_length +
-			from_bgp->vpn_policy[afi]
-				.tovpn_sid_locator->node_bits_length;
-		;
-		memcpy(&static_attr.srv6_l3vpn->sid,
-		       &from_bgp->vpn_policy[afi]
-				.tovpn_sid_locator->prefix.prefix,
-		       sizeof(struct in6_addr));
 	} else if (from_bgp->tovpn_sid_locator) {
-		struct srv6_locator_chunk *locator =
-			from_bgp->tovpn_sid_locator;
+		locator = from_bgp->tovpn_sid_locator;
 		encode_label(from_bgp->tovpn_sid_transpose_label, &label);
-		static_attr.srv6_l3vpn =
-			XCALLOC(MTYPE_BGP_SRV6_L3VPN,
-				sizeof(struct bgp_attr_srv6_l3vpn));
-		static_attr.srv6_l3vpn->sid_flags = 0x00;
-		static_attr.srv6_l3vpn->endpoint_behavior =
+		srv6_l3vpn_cache = &from_bgp->tovpn_srv6_l3vpn;
+		srv6_l3vpn.endpoint_behavior =
 			CHECK_FLAG(locator->flags, SRV6_LOCATOR_USID)
 				? SRV6_ENDPOINT_BEHAVIOR_END_DT46_USID
 				: SRV6_ENDPOINT_BEHAVIOR_END_DT46;
-		static_attr.srv6_l3vpn->loc_block_len =
-			from_bgp->tovpn_sid_locator->block_bits_length;
-		static_attr.srv6_l3vpn->loc_node_len =
-			from_bgp->tovpn_sid_locator->node_bits_length;
-		static_attr.srv6_l3vpn->func_len =
-			from_bgp->tovpn_sid_locator->function_bits_length;
-		static_attr.srv6_l3vpn->arg_len =
-			from_bgp->tovpn_sid_locator->argument_bits_length;
-		static_attr.srv6_l3vpn->transposition_len =
-			from_bgp->tovpn_sid_locator->function_bits_length;
-		static_attr.srv6_l3vpn->transposition_offset =
-			from_bgp->tovpn_sid_locator->block_bits_length +
-			from_bgp->tovpn_sid_locator->node_bits_length;
-		memcpy(&static_attr.srv6_l3vpn->sid,
-		       &from_bgp->tovpn_sid_locator->prefix.prefix,
-		       sizeof(struct in6_addr));
 	}
 
+	if (locator) {
+		srv6_l3vpn.sid_flags = 0x00;
+		srv6_l3vpn.loc_block_len = locator->block_bits_length;
+		srv6_l3vpn.loc_node_len = locator->node_bits_length;
+		srv6_l3vpn.func_len = locator->function_bits_length;
+		srv6_l3vpn.arg_len = locator->argument_bits_length;
+		srv6_l3vpn.transposition_len = locator->function_bits_length;
+		srv6_l3vpn.transposition_offset = locator->block_bits_length +
+						  locator->node_bits_length;
+		srv6_l3vpn.sid = locator->prefix.prefix;
+		static_attr.srv6_l3vpn =
+			vpn_srv6_l3vpn_get(srv6_l3vpn_cache, &srv6_l3vpn);
+	}
 
 	new_attr = bgp_attr_intern(
 		&static_attr);	/* hashed refcounted everything */
@@ -1702,7 +1975,8 @@ void vpn_leak_from_vrf_withdraw(struct bgp *to_bgp,		/* to */
 	 * match original bpi imported from
 	 */
 	for (bpi = bgp_dest_get_bgp_path_info(bn); bpi; bpi = bpi->next) {
-		if (bpi->extra && bpi->extra->parent == path_vrf) {
+		if (bpi->extra && bpi->extra->vrfleak &&
+		    bpi->extra->vrfleak->parent == path_vrf) {
 			break;
 		}
 	}
@@ -1755,10 +2029,9 @@ void vpn_leak_from_vrf_withdraw_all(struct bgp *to_bgp, struct bgp *from_bgp,
 						   bpi->sub_type);
 				if (bpi->sub_type != BGP_ROUTE_IMPORTED)
 					continue;
-				if (!bpi->extra)
+				if (!bpi->extra || !bpi->extra->vrfleak)
 					continue;
-				if ((struct bgp *)bpi->extra->bgp_orig ==
-				    from_bgp) {
+				if (bpi->extra->vrfleak->bgp_orig == from_bgp) {
 					/* delete route */
 					if (debug)
 						zlog_debug("%s: deleting it",
@@ -1876,8 +2149,9 @@ static bool vpn_leak_to_vrf_update_onevrf(struct bgp *to_bgp,   /* to */
 	 */
 	struct bgp *src_bgp = bgp_lookup_by_rd(path_vpn, prd, afi);
 
-	if (path_vpn->extra && path_vpn->extra->bgp_orig)
-		src_vrf = path_vpn->extra->bgp_orig;
+	if (path_vpn->extra && path_vpn->extra->vrfleak &&
+	    path_vpn->extra->vrfleak->bgp_orig)
+		src_vrf = path_vpn->extra->vrfleak->bgp_orig;
 	else if (src_bgp)
 		src_vrf = src_bgp;
 	else
@@ -2085,44 +2359,109 @@ static bool vpn_leak_to_vrf_update_onevrf(struct bgp *to_bgp,   /* to */
 	return true;
 }
 
+struct vpn_leak_to_vrf_args {
+	struct bgp *from_bgp;
+	struct bgp_path_info *path_vpn;
+	struct prefix_rd *prd;
+	const struct prefix *p;
+	afi_t afi;
+	bool leak_success;
+};
+
+static void vpn_leak_to_vrf_update_cb(struct bgp *bgp, void *arg)
+{
+	struct vpn_leak_to_vrf_args *args = arg;
+	struct bgp_path_info *path_vpn = args->path_vpn;
+
+	if (!path_vpn->extra || !path_vpn->extra->vrfleak ||
+	    path_vpn->extra->vrfleak->bgp_orig != bgp) { /* no loop */
+		args->leak_success |= vpn_leak_to_vrf_update_onevrf(
+			bgp, args->from_bgp, path_vpn, args->prd);
+	}
+}
+
 bool vpn_leak_to_vrf_update(struct bgp *from_bgp,
 			    struct bgp_path_info *path_vpn,
 			    struct prefix_rd *prd)
 {
-	struct listnode *mnode, *mnnode;
-	struct bgp *bgp;
-	bool leak_success = false;
+	struct vpn_leak_to_vrf_args args = {
+		.from_bgp = from_bgp,
+		.path_vpn = path_vpn,
+		.prd = prd,
+	};
 
 	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
 
 	if (debug)
 		zlog_debug("%s: start (path_vpn=%p)", __func__, path_vpn);
 
-	/* Loop over VRFs */
-	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
+	/* Loop over the VRFs importing one of the route's RTs */
+	args.afi = family2afi(bgp_dest_get_prefix(path_vpn->net)->family);
+	vpn_import_rt_foreach(args.afi,
+			      bgp_attr_get_ecommunity(path_vpn->attr), false,
+			      vpn_leak_to_vrf_update_cb, &args);
 
-		if (!path_vpn->extra
-		    || path_vpn->extra->bgp_orig != bgp) { /* no loop */
-			leak_success |= vpn_leak_to_vrf_update_onevrf(
-				bgp, from_bgp, path_vpn, prd);
-		}
-	}
-	return leak_success;
+	return args.leak_success;
 }
 
-void vpn_leak_to_vrf_withdraw(struct bgp_path_info *path_vpn)
+static void vpn_leak_to_vrf_withdraw_cb(struct bgp *bgp, void *arg)
 {
-	const struct prefix *p;
-	afi_t afi;
+	struct vpn_leak_to_vrf_args *args = arg;
+	struct bgp_path_info *path_vpn = args->path_vpn;
+	const struct prefix *p = args->p;
+	afi_t afi = args->afi;
 	safi_t safi = SAFI_UNICAST;
-	struct bgp *bgp;
-	struct listnode *mnode, *mnnode;
 	struct bgp_dest *bn;
 	struct bgp_path_info *bpi;
 	const char *debugmsg;
 
 	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
 
+	if (!vpn_leak_from_vpn_active(bgp, afi, &debugmsg)) {
+		if (debug)
+			zlog_debug("%s: from %s, skipping: %s", __func__,
+				   bgp->name_pretty, debugmsg);
+		return;
+	}
+
+	/* Check for intersection of route targets */
+	if (!ecommunity_include(
+		    bgp->vpn_policy[afi].rtlist[BGP_VPN_POLICY_DIR_FROMVPN],
+		    bgp_attr_get_ecommunity(path_vpn->attr)))
+		return;
+
+	if (debug)
+		zlog_debug("%s: withdrawing from vrf %s", __func__,
+			   bgp->name_pretty);
+
+	bn = bgp_afi_node_get(bgp->rib[afi][safi], afi, safi, p, NULL);
+
+	for (bpi = bgp_dest_get_bgp_path_info(bn); bpi; bpi = bpi->next) {
+		if (bpi->extra && bpi->extra->vrfleak &&
+		    (struct bgp_path_info *)bpi->extra->vrfleak->parent ==
+			    path_vpn) {
+			break;
+		}
+	}
+
+	if (bpi) {
+		if (debug)
+			zlog_debug("%s: deleting bpi %p", __func__, bpi);
+		bgp_aggregate_decrement(bgp, p, bpi, afi, safi);
+		bgp_path_info_delete(bn, bpi);
+		bgp_process(bgp, bn, afi, safi);
+	}
+	bgp_dest_unlock_node(bn);
+}
+
+void vpn_leak_to_vrf_withdraw(struct bgp_path_info *path_vpn)
+{
+	struct vpn_leak_to_vrf_args args = {
+		.path_vpn = path_vpn,
+	};
+
+	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
+
 	if (debug)
 		zlog_debug("%s: entry: p=%pBD, type=%d, sub_type=%d", __func__,
 			   path_vpn->net, path_vpn->type, path_vpn->sub_type);
@@ -2146,53 +2485,13 @@ void vpn_leak_to_vrf_withdraw(struct bgp_path_info *path_vpn)
 		return;
 	}
 
-	p = bgp_dest_get_prefix(path_vpn->net);
-	afi = family2afi(p->family);
-
-	/* Loop over VRFs */
-	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
-		if (!vpn_leak_from_vpn_active(bgp, afi, &debugmsg)) {
-			if (debug)
-				zlog_debug("%s: from %s, skipping: %s",
-					   __func__, bgp->name_pretty,
-					   debugmsg);
-			continue;
-		}
-
-		/* Check for intersection of route targets */
-		if (!ecommunity_include(
-			    bgp->vpn_policy[afi]
-				    .rtlist[BGP_VPN_POLICY_DIR_FROMVPN],
-			    bgp_attr_get_ecommunity(path_vpn->attr))) {
-
-			continue;
-		}
-
-		if (debug)
-			zlog_debug("%s: withdrawing from vrf %s", __func__,
-				   bgp->name_pretty);
+	args.p = bgp_dest_get_prefix(path_vpn->net);
+	args.afi = family2afi(args.p->family);
 
-		bn = bgp_afi_node_get(bgp->rib[afi][safi], afi, safi, p, NULL);
-
-		for (bpi = bgp_dest_get_bgp_path_info(bn); bpi;
-		     bpi = bpi->next) {
-			if (bpi->extra
-			    && (struct bgp_path_info *)bpi->extra->parent
-				       == path_vpn) {
-				break;
-			}
-		}
-
-		if (bpi) {
-			if (debug)
-				zlog_debug("%s: deleting bpi %p", __func__,
-					   bpi);
-			bgp_aggregate_decrement(bgp, p, bpi, afi, safi);
-			bgp_path_info_delete(bn, bpi);
-			bgp_process(bgp, bn, afi, safi);
-		}
-		bgp_dest_unlock_node(bn);
-	}
+	/* Loop over the VRFs importing one of the route's RTs */
+	vpn_import_rt_foreach(args.afi,
+			      bgp_attr_get_ecommunity(path_vpn->attr), true,
+			      vpn_leak_to_vrf_withdraw_cb, &args);
 }
 
 void vpn_leak_to_vrf_withdraw_all(struct bgp *to_bgp, afi_t afi)
@@ -2212,9 +2511,10 @@ void vpn_leak_to_vrf_withdraw_all(struct bgp *to_bgp, afi_t afi)
 
 		for (bpi = bgp_dest_get_bgp_path_info(bn); bpi;
 		     bpi = bpi->next) {
-			if (bpi->extra && bpi->extra->bgp_orig != to_bgp &&
-			    bpi->extra->parent &&
-			    is_pi_family_vpn(bpi->extra->parent)) {
+			if (bpi->extra && bpi->extra->vrfleak &&
+			    bpi->extra->vrfleak->bgp_orig != to_bgp &&
+			    bpi->extra->vrfleak->parent &&
+			    is_pi_family_vpn(bpi->extra->vrfleak->parent)) {
 
 				/* delete route */
 				bgp_aggregate_decrement(to_bgp,
@@ -2255,8 +2555,8 @@ void vpn_leak_to_vrf_update_all(struct bgp *to_bgp, struct bgp *vpn_from,
 			for (bpi = bgp_dest_get_bgp_path_info(bn); bpi;
 			     bpi = bpi->next) {
 
-				if (bpi->extra &&
-				    bpi->extra->bgp_orig == to_bgp)
+				if (bpi->extra && bpi->extra->vrfleak &&
+				    bpi->extra->vrfleak->bgp_orig == to_bgp)
 					continue;
 
 				vpn_leak_to_vrf_update_onevrf(to_bgp, vpn_from,
@@ -2401,6 +2701,7 @@ void vpn_handle_router_id_update(struct bgp *bgp, bool withdraw,
 					bgp_import->vpn_policy[afi]
 						.rtlist[idir],
 					(struct ecommunity_val *)ecom->val);
+				vpn_leak_import_rt_invalidate();
 			}
 		} else {
 			/* New router-id derive auto RD and RT and export
@@ -2561,6 +2862,7 @@ void vrf_import_from_vrf(struct bgp *to_bgp, struct bgp *from_bgp,
 					 .rtlist[idir], ecom);
 	else
 		to_bgp->vpn_policy[afi].rtlist[idir] = ecommunity_dup(ecom);
+	vpn_leak_import_rt_invalidate();
 	SET_FLAG(to_bgp->af_flags[afi][safi], BGP_CONFIG_VRF_TO_VRF_IMPORT);
 
 	if (debug) {
@@ -2651,6 +2953,7 @@ void vrf_unimport_from_vrf(struct bgp *to_bgp, struct bgp *from_bgp,
 				   BGP_CONFIG_VRF_TO_VRF_IMPORT);
 		if (to_bgp->vpn_policy[afi].rtlist[idir])
 			ecommunity_free(&to_bgp->vpn_policy[afi].rtlist[idir]);
+		vpn_leak_import_rt_invalidate();
 	} else {
 		ecom = from_bgp->vpn_policy[afi].rtlist[edir];
 		if (ecom)
@@ -2903,6 +3206,35 @@ ALIAS(show_bgp_ip_vpn_all_rd,
        "All VPN Route Distinguishers\n"
        JSON_STR)
 
+DEFUN (show_bgp_ip_vpn_import_rt,
+       show_bgp_ip_vpn_import_rt_cmd,
+       "show bgp "BGP_AFI_CMD_STR" vpn import-rt [json]",
+       SHOW_STR
+       BGP_STR
+       BGP_VPNVX_HELP_STR
+       "Display VPN NLRI specific information\n"
+       "Route targets imported into VRFs\n"
+       JSON_STR)
+{
+	afi_t afi;
+	int idx = 0;
+	bool uj = use_json(argc, argv);
+	json_object *json = NULL;
+
+	if (!argv_find_and_parse_afi(argv, argc, &idx, &afi))
+		return CMD_SUCCESS;
+
+	if (uj)
+		json = json_object_new_object();
+
+	vpn_import_rt_show(vty, afi, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
 #ifdef KEEP_OLD_VPN_COMMANDS
 DEFUN (show_ip_bgp_vpn_rd,
        show_ip_bgp_vpn_rd_cmd,
@@ -3318,6 +3650,7 @@ void bgp_mplsvpn_init(void)
 
 	install_element(VIEW_NODE, &show_bgp_ip_vpn_all_rd_cmd);
 	install_element(VIEW_NODE, &show_bgp_ip_vpn_rd_cmd);
+	install_element(VIEW_NODE, &show_bgp_ip_vpn_import_rt_cmd);
 #ifdef KEEP_OLD_VPN_COMMANDS
 	install_element(VIEW_NODE, &show_ip_bgp_vpn_rd_cmd);
 	install_element(VIEW_NODE, &show_ip_bgp_vpn_all_cmd);
@@ -3575,6 +3908,7 @@ void bgp_vpn_leak_export(struct bgp *from_bgp)
 						to_vpolicy->rtlist[idir],
 						(struct ecommunity_val *)
 							ecom->val);
+				vpn_leak_import_rt_invalidate();
 				vrf_import_from_vrf(to_bgp, from_bgp,
 						    afi, safi);
 				break;
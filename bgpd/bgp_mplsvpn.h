@@ -64,6 +64,10 @@ extern bool vpn_leak_to_vrf_update(struct bgp *from_bgp,
 
 extern void vpn_leak_to_vrf_withdraw(struct bgp_path_info *path_vpn);
 
+/* import RT lists or the set of instances changed */
+extern void vpn_leak_import_rt_invalidate(void);
+extern void vpn_leak_import_rt_finish(void);
+
 extern void vpn_leak_zebra_vrf_label_update(struct bgp *bgp, afi_t afi);
 extern void vpn_leak_zebra_vrf_label_withdraw(struct bgp *bgp, afi_t afi);
 extern void vpn_leak_zebra_vrf_sid_update(struct bgp *bgp, afi_t afi);
@@ -208,6 +212,8 @@ static inline void vpn_leak_prechange(enum vpn_policy_direction direction,
 				      afi_t afi, struct bgp *bgp_vpn,
 				      struct bgp *bgp_vrf)
 {
+	vpn_leak_import_rt_invalidate();
+
 	/* Detect when default bgp instance is not (yet) defined by config */
 	if (!bgp_vpn)
 		return;
@@ -228,6 +234,8 @@ static inline void vpn_leak_postchange(enum vpn_policy_direction direction,
 				       afi_t afi, struct bgp *bgp_vpn,
 				       struct bgp *bgp_vrf)
 {
+	vpn_leak_import_rt_invalidate();
+
 	/* Detect when default bgp instance is not (yet) defined by config */
 	if (!bgp_vpn)
 		return;
@@ -292,10 +300,11 @@ static inline bool is_route_injectable_into_vpn(struct bgp_path_info *pi)
 
 	if (pi->sub_type != BGP_ROUTE_IMPORTED ||
 	    !pi->extra ||
-	    !pi->extra->parent)
+	    !pi->extra->vrfleak ||
+	    !pi->extra->vrfleak->parent)
 		return true;
 
-	parent_pi = (struct bgp_path_info *)pi->extra->parent;
+	parent_pi = (struct bgp_path_info *)pi->extra->vrfleak->parent;
 	dest = parent_pi->net;
 	if (!dest)
 		return true;
@@ -27,6 +27,7 @@
 #include "bgpd/bgp_open.h"
 #include "bgpd/bgp_fsm.h"
 #include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_io.h"
 #include "bgpd/bgp_debug.h"
 #include "bgpd/bgp_errors.h"
 #include "bgpd/bgp_network.h"
@@ -335,6 +336,16 @@ static void bgp_socket_set_buffer_size(const int fd)
 		setsockopt_so_sendbuf(fd, bm->socket_buffer);
 	if (getsockopt_so_recvbuf(fd) < (int)bm->socket_buffer)
 		setsockopt_so_recvbuf(fd, bm->socket_buffer);
+
+#ifdef TCP_NOTSENT_LOWAT
+	/* keep the backlog in obuf, where bgp_write() can share it out */
+	int lowat = BGP_IO_DRR_QUANTUM;
+
+	if (setsockopt(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &lowat,
+		       sizeof(lowat)) < 0)
+		zlog_debug("%s: can't set TCP_NOTSENT_LOWAT on fd %d: %s",
+			   __func__, fd, safe_strerror(errno));
+#endif
 }
 
 /* Accept bgp connection. */
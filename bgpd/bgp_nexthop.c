@@ -88,6 +88,7 @@ bool bnc_existing_for_prefix(struct bgp_nexthop_cache *bnc)
 
 void bnc_free(struct bgp_nexthop_cache *bnc)
 {
+	bgp_nht_nhg_release(bnc);
 	bnc_nexthop_free(bnc);
 	bgp_nexthop_cache_del(bnc->tree, bnc);
 	XFREE(MTYPE_BGP_NEXTHOP_CACHE, bnc);
@@ -1059,6 +1060,26 @@ static void bgp_show_nexthop(struct vty *vty, struct bgp *bgp,
 		vty_out(vty, "  Last update: %s", ctime(&tbuf));
 	}
 
+	if (json) {
+		json_object_int_add(json_nexthop, "pathsProcessed",
+				    bnc->paths_processed);
+		json_object_int_add(json_nexthop, "pathsSkipped",
+				    bnc->paths_skipped);
+	} else if (bnc->paths_skipped)
+		vty_out(vty,
+			"  Paths reprocessed %" PRIu64 ", skipped %" PRIu64
+			"\n",
+			bnc->paths_processed, bnc->paths_skipped);
+
+	if (bnc->nhg_id) {
+		if (json)
+			json_object_int_add(json_nexthop, "nhgId",
+					    bnc->nhg_id);
+		else
+			vty_out(vty, "  Installed via nexthop group %u%s\n",
+				bnc->nhg_id, bnc->nhg_gen ? "" : " (stale)");
+	}
+
 	/* show paths dependent on nexthop, if needed. */
 	if (specific)
 		bgp_show_nexthop_paths(vty, bgp, bnc, json_nexthop);
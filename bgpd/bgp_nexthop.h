@@ -87,6 +87,19 @@ struct bgp_nexthop_cache {
 	unsigned int path_count;
 	struct bgp *bgp;
 
+	/* paths queued for route processing by evaluate_paths(), and those
+	 * it could leave alone with "bgp nexthop-tracking incremental"
+	 */
+	uint64_t paths_processed;
+	uint64_t paths_skipped;
+
+	/* zebra nexthop group shared by the single-path prefixes resolving
+	 * over this nexthop ("bgp nexthop-group"), and the zebra session
+	 * generation it was last sent in (0 if stale)
+	 */
+	uint32_t nhg_id;
+	uint32_t nhg_gen;
+
 	/* This flag is set to TRUE for a bnc that is gateway IP overlay index
 	 * nexthop.
 	 */
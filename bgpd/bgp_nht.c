@@ -31,6 +31,8 @@
 #include "bgpd/bgp_flowspec_util.h"
 #include "bgpd/bgp_evpn.h"
 #include "bgpd/bgp_rd.h"
+#include "bgpd/bgp_mpath.h"
+#include "bgpd/bgp_label.h"
 
 extern struct zclient *zclient;
 
@@ -38,6 +40,12 @@ static void register_zebra_rnh(struct bgp_nexthop_cache *bnc);
 static void unregister_zebra_rnh(struct bgp_nexthop_cache *bnc);
 static int make_prefix(int afi, struct bgp_path_info *pi, struct prefix *p);
 static void bgp_nht_ifp_initial(struct event *thread);
+static void bgp_nht_nhg_update(struct bgp_nexthop_cache *bnc);
+static bool bgp_nht_path_nhg_ok(struct bgp *bgp, struct bgp_path_info *path,
+				afi_t afi, safi_t safi);
+
+/* zebra session generation for per-nexthop NHGs, see bgp_nht_path_use_nhg */
+static uint32_t bgp_nhg_zebra_gen = 1;
 
 static int bgp_isvalid_nexthop(struct bgp_nexthop_cache *bnc)
 {
@@ -54,10 +62,11 @@ static int bgp_isvalid_nexthop_for_ebgp(struct bgp_nexthop_cache *bnc,
 	struct bgp_interface *iifp;
 	struct peer *peer;
 
-	if (!path->extra || !path->extra->peer_orig)
+	if (!path->extra || !path->extra->vrfleak ||
+	    !path->extra->vrfleak->peer_orig)
 		return false;
 
-	peer = path->extra->peer_orig;
+	peer = path->extra->vrfleak->peer_orig;
 
 	/* only connected ebgp peers are valid */
 	if (peer->sort != BGP_PEER_EBGP || peer->ttl != BGP_DEFAULT_TTL ||
@@ -692,6 +701,7 @@ static void bgp_process_nexthop_update(struct bgp_nexthop_cache *bnc,
 		bnc->nexthop = NULL;
 	}
 
+	bgp_nht_nhg_update(bnc);
 	evaluate_paths(bnc);
 }
 
@@ -1100,6 +1110,53 @@ static void unregister_zebra_rnh(struct bgp_nexthop_cache *bnc)
 	sendmsg_zebra_rnh(bnc, ZEBRA_NEXTHOP_UNREGISTER);
 }
 
+/*
+ * With "bgp nexthop-tracking incremental", a nexthop update that only
+ * changed the IGP metric does not need to requeue dests whose best path
+ * outcome cannot change: the path is the only one on the dest, or it was
+ * and stays invalid.  Paths carrying AIGP or an SR-TE color still depend
+ * on the metric / nexthop details and are always processed, and so is
+ * everything while a route-map copies the metric into the advertised
+ * route ("set aigp-metric igp-metric").
+ */
+static bool evaluate_path_skip(struct bgp *bgp_path,
+			       struct bgp_nexthop_cache *bnc,
+			       struct bgp_dest *dest,
+			       struct bgp_path_info *path, afi_t afi,
+			       safi_t safi, bool was_valid, bool is_valid)
+{
+	/* only the resolution changed and the NHG the route is installed
+	 * with was already replaced in zebra
+	 */
+	if (bnc->change_flags == BGP_NEXTHOP_CHANGED && was_valid &&
+	    is_valid && bnc->nhg_id && bnc->nhg_gen == bgp_nhg_zebra_gen &&
+	    bgp_dest_get_bgp_path_info(dest) == path && !path->next &&
+	    CHECK_FLAG(path->flags, BGP_PATH_SELECTED) &&
+	    bgp_nht_path_nhg_ok(bgp_path, path, afi, safi))
+		return true;
+
+	if (!CHECK_FLAG(bgp_path->flags, BGP_FLAG_NHT_INCREMENTAL))
+		return false;
+
+	if (bnc->change_flags != BGP_NEXTHOP_METRIC_CHANGED)
+		return false;
+
+	if (bgp_route_map_uses_igp_metric())
+		return false;
+
+	if (was_valid != is_valid)
+		return false;
+
+	if (path->attr->srte_color ||
+	    CHECK_FLAG(path->attr->flag, ATTR_FLAG_BIT(BGP_ATTR_AIGP)))
+		return false;
+
+	if (!is_valid)
+		return true;
+
+	return bgp_dest_get_bgp_path_info(dest) == path && !path->next;
+}
+
 /**
  * evaluate_paths - Evaluate the paths/nets associated with a nexthop.
  * ARGUMENTS:
@@ -1258,6 +1315,13 @@ void evaluate_paths(struct bgp_nexthop_cache *bnc)
 			}
 		}
 
+		if (evaluate_path_skip(bgp_path, bnc, dest, path, afi, safi,
+				       path_valid, bnc_is_valid_nexthop)) {
+			bnc->paths_skipped++;
+			continue;
+		}
+
+		bnc->paths_processed++;
 		bgp_process(bgp_path, dest, afi, safi);
 	}
 
@@ -1431,8 +1495,8 @@ void bgp_nht_dereg_enhe_cap_intfs(struct peer *peer)
  * L3 NHGs are used for fast failover of nexthops in the dplane. These are
  * the APIs for allocating L3 NHG ids. Management of the L3 NHG itself is
  * left to the application using it.
- * PS: Currently EVPN host routes is the only app using L3 NHG for fast
- * failover of remote ES links.
+ * PS: EVPN host routes use L3 NHGs for fast failover of remote ES links,
+ * unicast routes use them per BGP nexthop with "bgp nexthop-group".
  ***************************************************************************/
 static bitfield_t bgp_nh_id_bitmap;
 static uint32_t bgp_l3nhg_start;
@@ -1513,3 +1577,214 @@ void bgp_l3nhg_id_free(uint32_t nhg_id)
 
 	bf_release_index(bgp_nh_id_bitmap, nhg_id);
 }
+
+/****************************************************************************
+ * Per-nexthop NHGs. With "bgp nexthop-group" every BGP nexthop that
+ * single-path unicast prefixes resolve over is handed to zebra once as a
+ * protocol owned nexthop group and those prefixes are installed by NHG id.
+ * An IGP change under the BGP nexthop is then a single NHG replace instead
+ * of a route update per prefix.
+ *
+ * bnc->nhg_gen records the zebra session the group was last sent in, so
+ * that groups are re-sent lazily after zebra goes away and comes back.
+ ***************************************************************************/
+static bool bgp_nht_nhg_bnc_usable(const struct bgp_nexthop_cache *bnc)
+{
+	const struct nexthop *nh;
+	unsigned int count = 0;
+
+	if (!CHECK_FLAG(bnc->flags, BGP_NEXTHOP_VALID) || !bnc->nexthop)
+		return false;
+
+	/* link-local, SR-TE and EVPN gateway nexthops carry state zebra
+	 * needs per route
+	 */
+	if (bnc->ifindex || bnc->srte_color || bnc->is_evpn_gwip_nexthop)
+		return false;
+
+	/* zebra only accepts fully resolved gateway nexthops in a proto NHG */
+	for (nh = bnc->nexthop; nh; nh = nh->next) {
+		if (++count > MULTIPATH_NUM)
+			return false;
+
+		if (CHECK_FLAG(nh->flags, NEXTHOP_FLAG_HAS_BACKUP))
+			return false;
+
+		switch (nh->type) {
+		case NEXTHOP_TYPE_IPV4_IFINDEX:
+		case NEXTHOP_TYPE_IPV6_IFINDEX:
+		case NEXTHOP_TYPE_IFINDEX:
+			break;
+		case NEXTHOP_TYPE_IPV4:
+		case NEXTHOP_TYPE_IPV6:
+		case NEXTHOP_TYPE_BLACKHOLE:
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool bgp_nht_path_nhg_ok(struct bgp *bgp, struct bgp_path_info *path,
+				afi_t afi, safi_t safi)
+{
+	struct bgp_nexthop_cache *bnc = path->nexthop;
+
+	if (!CHECK_FLAG(bgp->flags, BGP_FLAG_NHG_PER_NEXTHOP))
+		return false;
+
+	if (safi != SAFI_UNICAST || !bnc || bnc->bgp != bgp)
+		return false;
+
+	if (path->type != ZEBRA_ROUTE_BGP ||
+	    path->sub_type != BGP_ROUTE_NORMAL)
+		return false;
+
+	/* labels, SRv6 SIDs and leaked routes need per-prefix nexthops */
+	if (path->extra &&
+	    ((path->extra->num_labels &&
+	      bgp_is_valid_label(&path->extra->label[0])) ||
+	     (path->extra->vrfleak && path->extra->vrfleak->bgp_orig)))
+		return false;
+
+	if (CHECK_FLAG(path->attr->flag, ATTR_FLAG_BIT(BGP_ATTR_SRTE_COLOR)))
+		return false;
+
+	/* zebra would be handed the link-local nexthop for these */
+	if (path->attr->mp_nexthop_len == BGP_ATTR_NHLEN_IPV6_GLOBAL_AND_LL)
+		return false;
+
+	/* the table map may rewrite the nexthop */
+	if (bgp->table_map[afi][safi].name)
+		return false;
+
+	if (bgp_path_info_mpath_next(path) ||
+	    bgp_path_info_mpath_chkwtd(bgp, path))
+		return false;
+
+	return bgp_nht_nhg_bnc_usable(bnc);
+}
+
+static bool bgp_nht_nhg_send(struct bgp_nexthop_cache *bnc)
+{
+	struct zapi_nhg api_nhg = {};
+	struct zapi_nexthop *api_nh;
+	struct nexthop *nh;
+
+	if (!zclient || zclient->sock < 0)
+		return false;
+
+	api_nhg.id = bnc->nhg_id;
+	for (nh = bnc->nexthop; nh; nh = nh->next) {
+		api_nh = &api_nhg.nexthops[api_nhg.nexthop_num++];
+		zapi_nexthop_from_nexthop(api_nh, nh);
+
+		/* resolved over a connected route, the BGP nexthop itself
+		 * is the gateway
+		 */
+		if (nh->type == NEXTHOP_TYPE_IFINDEX) {
+			if (bnc->prefix.family == AF_INET) {
+				api_nh->type = NEXTHOP_TYPE_IPV4_IFINDEX;
+				api_nh->gate.ipv4 = bnc->prefix.u.prefix4;
+			} else {
+				api_nh->type = NEXTHOP_TYPE_IPV6_IFINDEX;
+				api_nh->gate.ipv6 = bnc->prefix.u.prefix6;
+			}
+		}
+	}
+
+	if (BGP_DEBUG(nht, NHT))
+		zlog_debug("%s: %pFX(%s) nhg %u with %u nexthops", __func__,
+			   &bnc->prefix, bnc->bgp->name_pretty, bnc->nhg_id,
+			   api_nhg.nexthop_num);
+
+	if (zclient_nhg_send(zclient, ZEBRA_NHG_ADD, &api_nhg) ==
+	    ZCLIENT_SEND_FAILURE) {
+		bnc->nhg_gen = 0;
+		return false;
+	}
+
+	bnc->nhg_gen = bgp_nhg_zebra_gen;
+	return true;
+}
+
+/*
+ * Install path through the NHG of its nexthop if it is eligible for one;
+ * allocates and sends the group on first use.
+ */
+bool bgp_nht_path_use_nhg(struct bgp *bgp, struct bgp_path_info *path,
+			  afi_t afi, safi_t safi, uint32_t *nhg_id)
+{
+	struct bgp_nexthop_cache *bnc;
+
+	if (!bgp_nht_path_nhg_ok(bgp, path, afi, safi))
+		return false;
+
+	bnc = path->nexthop;
+	if (!bnc->nhg_id) {
+		bnc->nhg_id = bgp_l3nhg_id_alloc();
+		if (!bnc->nhg_id)
+			return false;
+	}
+
+	if (bnc->nhg_gen != bgp_nhg_zebra_gen && !bgp_nht_nhg_send(bnc))
+		return false;
+
+	*nhg_id = bnc->nhg_id;
+	return true;
+}
+
+/* Refresh the NHG after the nexthop's resolution changed */
+static void bgp_nht_nhg_update(struct bgp_nexthop_cache *bnc)
+{
+	if (!bnc->nhg_id)
+		return;
+
+	/* routes fall back to explicit nexthops once they are reprocessed,
+	 * the group is re-sent if the nexthop becomes usable again
+	 */
+	if (!bgp_nht_nhg_bnc_usable(bnc)) {
+		bnc->nhg_gen = 0;
+		return;
+	}
+
+	if (bnc->nhg_gen == bgp_nhg_zebra_gen &&
+	    !CHECK_FLAG(bnc->change_flags, BGP_NEXTHOP_CHANGED))
+		return;
+
+	bgp_nht_nhg_send(bnc);
+}
+
+void bgp_nht_nhg_release(struct bgp_nexthop_cache *bnc)
+{
+	struct zapi_nhg api_nhg = {};
+
+	if (!bnc->nhg_id)
+		return;
+
+	/* zebra keeps the group around while routes still reference it */
+	if (zclient && zclient->sock >= 0) {
+		api_nhg.id = bnc->nhg_id;
+		zclient_nhg_send(zclient, ZEBRA_NHG_DEL, &api_nhg);
+	}
+
+	bgp_l3nhg_id_free(bnc->nhg_id);
+	bnc->nhg_id = 0;
+	bnc->nhg_gen = 0;
+}
+
+void bgp_nht_nhg_release_all(struct bgp *bgp)
+{
+	struct bgp_nexthop_cache *bnc;
+	afi_t afi;
+
+	for (afi = AFI_IP; afi < AFI_MAX; afi++)
+		frr_each (bgp_nexthop_cache, &bgp->nexthop_cache_table[afi], bnc)
+			bgp_nht_nhg_release(bnc);
+}
+
+void bgp_nht_nhg_zebra_connected(void)
+{
+	if (++bgp_nhg_zebra_gen == 0)
+		bgp_nhg_zebra_gen = 1;
+}
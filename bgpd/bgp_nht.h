@@ -84,6 +84,13 @@ extern void bgp_l3nhg_id_free(uint32_t nhg_id);
 extern void bgp_l3nhg_init(void);
 void bgp_l3nhg_finish(void);
 
+/* Shared per-nexthop NHGs for unicast routes ("bgp nexthop-group") */
+extern bool bgp_nht_path_use_nhg(struct bgp *bgp, struct bgp_path_info *path,
+				 afi_t afi, safi_t safi, uint32_t *nhg_id);
+extern void bgp_nht_nhg_release(struct bgp_nexthop_cache *bnc);
+extern void bgp_nht_nhg_release_all(struct bgp *bgp);
+extern void bgp_nht_nhg_zebra_connected(void);
+
 extern void bgp_nht_ifp_up(struct interface *ifp);
 extern void bgp_nht_ifp_down(struct interface *ifp);
 
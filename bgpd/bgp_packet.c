@@ -46,6 +46,8 @@
 #include "bgpd/bgp_updgrp.h"
 #include "bgpd/bgp_label.h"
 #include "bgpd/bgp_io.h"
+#include "bgpd/bgp_parse.h"
+#include "bgpd/bgp_updgrp_workers.h"
 #include "bgpd/bgp_keepalives.h"
 #include "bgpd/bgp_flowspec.h"
 #include "bgpd/bgp_trace.h"
@@ -116,8 +118,10 @@ static void bgp_packet_add(struct peer *peer, struct stream *s)
 		 * now, otherwise if we write another packet immediately
 		 * after it'll get confused
 		 */
-		if (!stream_fifo_count_safe(peer->obuf))
+		if (!stream_fifo_count_safe(peer->obuf)) {
 			peer->last_sendq_ok = monotime(NULL);
+			monotime(&peer->obuf_busy);
+		}
 
 		stream_fifo_push(peer->obuf, s);
 
@@ -451,6 +455,7 @@ void bgp_generate_updgrp_packets(struct event *thread)
 	struct bpacket *next_pkt;
 	uint32_t wpq;
 	uint32_t generated = 0;
+	uint64_t cpu_start;
 	afi_t afi;
 	safi_t safi;
 
@@ -482,6 +487,9 @@ void bgp_generate_updgrp_packets(struct event *thread)
 		return;
 	}
 
+	/* let independent subgroups format their UPDATEs concurrently */
+	bgp_update_workers_run(peer);
+
 	do {
 		enum bgp_af_index index;
 
@@ -494,6 +502,7 @@ void bgp_generate_updgrp_packets(struct event *thread)
 			afi = paf->afi;
 			safi = paf->safi;
 			next_pkt = paf->next_pkt_to_send;
+			cpu_start = bgp_cpu_now();
 
 			/*
 			 * Try to generate a packet for the peer if we are at
@@ -517,7 +526,8 @@ void bgp_generate_updgrp_packets(struct event *thread)
 			 * yet.
 			 */
 			if (!next_pkt || !next_pkt->buffer) {
-				if (!paf->t_announce_route) {
+				if (!paf->t_announce_route
+				    && !paf->subgroup->t_replay) {
 					/* Make sure we supress BGP UPDATES
 					 * for normal processing later again.
 					 */
@@ -559,6 +569,7 @@ void bgp_generate_updgrp_packets(struct event *thread)
 				if (CHECK_FLAG(peer->cap,
 					       PEER_CAP_RESTART_RCV)) {
 					if (!(PAF_SUBGRP(paf))->t_coalesce
+					    && !(PAF_SUBGRP(paf))->t_replay
 					    && peer->afc_nego[afi][safi]
 					    && peer->synctime
 					    && !CHECK_FLAG(
@@ -603,6 +614,9 @@ void bgp_generate_updgrp_packets(struct event *thread)
 			s = bpacket_reformat_for_peer(next_pkt, paf);
 			bgp_packet_add(peer, s);
 			bpacket_queue_advance_peer(paf);
+			bgp_cpu_account(&peer->cpu_stats[afi][safi]
+							[BGP_CPU_UPDATE_OUT],
+					cpu_start);
 		}
 	} while (s && (++generated < wpq) &&
 		 (peer->obuf->count <= bm->outq_limit));
@@ -1815,16 +1829,9 @@ static void bgp_refresh_stalepath_timer_expire(struct event *thread)
 	bgp_timer_set(peer);
 }
 
-/**
- * Process BGP UPDATE message for peer.
- *
- * Parses UPDATE and creates attribute object.
- *
- * @param peer
- * @param size size of the packet
- * @return as in summary
- */
-static int bgp_update_receive(struct peer *peer, bgp_size_t size)
+/* bgp_update_receive(), pp is what a parse worker decoded, if any */
+static int bgp_update_process(struct peer *peer, bgp_size_t size,
+			      struct bgp_preparse *pp)
 {
 	int ret, nlri_ret;
 	uint8_t *end;
@@ -1834,14 +1841,8 @@ static int bgp_update_receive(struct peer *peer, bgp_size_t size)
 	bgp_size_t update_len;
 	bgp_size_t withdraw_len;
 	bool restart = false;
-
-	enum NLRI_TYPES {
-		NLRI_UPDATE,
-		NLRI_WITHDRAW,
-		NLRI_MP_UPDATE,
-		NLRI_MP_WITHDRAW,
-		NLRI_TYPE_MAX
-	};
+	bool preparsed = pp && pp->valid;
+	struct bgp_preparse_nlri *decoded;
 	struct bgp_nlri nlris[NLRI_TYPE_MAX];
 
 	/* Status must be Established. */
@@ -1870,7 +1871,7 @@ static int bgp_update_receive(struct peer *peer, bgp_size_t size)
 	   Length is too large (i.e., if Unfeasible Routes Length + Total
 	   Attribute Length + 23 exceeds the message Length), then the Error
 	   Subcode is set to Malformed Attribute List.  */
-	if (stream_pnt(s) + 2 > end) {
+	if (!preparsed && stream_pnt(s) + 2 > end) {
 		flog_err(EC_BGP_UPDATE_RCV,
 			 "%s [Error] Update packet error (packet length is short for unfeasible length)",
 			 peer->host);
@@ -1883,7 +1884,7 @@ static int bgp_update_receive(struct peer *peer, bgp_size_t size)
 	withdraw_len = stream_getw(s);
 
 	/* Unfeasible Route Length check. */
-	if (stream_pnt(s) + withdraw_len > end) {
+	if (!preparsed && stream_pnt(s) + withdraw_len > end) {
 		flog_err(EC_BGP_UPDATE_RCV,
 			 "%s [Error] Update packet error (packet unfeasible length overflow %d)",
 			 peer->host, withdraw_len);
@@ -1902,7 +1903,7 @@ static int bgp_update_receive(struct peer *peer, bgp_size_t size)
 	}
 
 	/* Attribute total length check. */
-	if (stream_pnt(s) + 2 > end) {
+	if (!preparsed && stream_pnt(s) + 2 > end) {
 		flog_warn(
 			EC_BGP_UPDATE_PACKET_SHORT,
 			"%s [Error] Packet Error (update packet is short for attribute length)",
@@ -1916,7 +1917,7 @@ static int bgp_update_receive(struct peer *peer, bgp_size_t size)
 	attribute_len = stream_getw(s);
 
 	/* Attribute length check. */
-	if (stream_pnt(s) + attribute_len > end) {
+	if (!preparsed && stream_pnt(s) + attribute_len > end) {
 		flog_warn(
 			EC_BGP_UPDATE_PACKET_LONG,
 			"%s [Error] Packet Error (update packet attribute length overflow %d)",
@@ -1934,16 +1935,37 @@ static int bgp_update_receive(struct peer *peer, bgp_size_t size)
 	 * Complicates the flow a little though..
 	 */
 	enum bgp_attr_parse_ret attr_parse_ret = BGP_ATTR_PARSE_PROCEED;
+	uint64_t cpu_start;
 /* This define morphs the update case into a withdraw when lower levels
  * have signalled an error condition where this is best.
  */
 #define NLRI_ATTR_ARG (attr_parse_ret != BGP_ATTR_PARSE_WITHDRAW ? &attr : NULL)
 
 	/* Parse attribute when it exists. */
-	if (attribute_len) {
+	if (attribute_len && preparsed) {
+		/* attr takes over the references the worker holds */
+		attr = pp->attr;
+		pp->attr_parsed = false;
+		attr_parse_ret = pp->attr_ret;
+		nlris[NLRI_MP_UPDATE] = pp->nlris[NLRI_MP_UPDATE];
+		nlris[NLRI_MP_WITHDRAW] = pp->nlris[NLRI_MP_WITHDRAW];
+		stream_forward_getp(s, attribute_len);
+
+		if (pp->notify.code)
+			bgp_notify_send_with_data(peer, pp->notify.code,
+						  pp->notify.subcode,
+						  pp->notify.raw_data,
+						  pp->notify.length);
+		if (attr_parse_ret == BGP_ATTR_PARSE_ERROR) {
+			bgp_attr_unintern_sub(&attr);
+			return BGP_Stop;
+		}
+	} else if (attribute_len) {
+		cpu_start = bgp_cpu_now();
 		attr_parse_ret = bgp_attr_parse(peer, &attr, attribute_len,
 						&nlris[NLRI_MP_UPDATE],
 						&nlris[NLRI_MP_WITHDRAW]);
+		bgp_cpu_account(&peer->cpu_parse, cpu_start);
 		if (attr_parse_ret == BGP_ATTR_PARSE_ERROR) {
 			bgp_attr_unintern_sub(&attr);
 			return BGP_Stop;
@@ -2017,20 +2039,37 @@ static int bgp_update_receive(struct peer *peer, bgp_size_t size)
 		if (nlris[i].length == 0)
 			continue;
 
+		/* prefixes already decoded by a parse worker? */
+		decoded = preparsed && pp->decoded[i].decoded ? &pp->decoded[i]
+							      : NULL;
+
+		cpu_start = bgp_cpu_now();
 		switch (i) {
 		case NLRI_UPDATE:
 		case NLRI_MP_UPDATE:
-			nlri_ret = bgp_nlri_parse(peer, NLRI_ATTR_ARG,
-						  &nlris[i], 0);
+			if (decoded)
+				nlri_ret = bgp_preparse_nlri_process(
+					peer, NLRI_ATTR_ARG, &nlris[i],
+					decoded);
+			else
+				nlri_ret = bgp_nlri_parse(peer, NLRI_ATTR_ARG,
+							  &nlris[i], 0);
 			break;
 		case NLRI_WITHDRAW:
 		case NLRI_MP_WITHDRAW:
-			nlri_ret = bgp_nlri_parse(peer, NLRI_ATTR_ARG,
-						  &nlris[i], 1);
+			if (decoded)
+				nlri_ret = bgp_preparse_nlri_process(
+					peer, NULL, &nlris[i], decoded);
+			else
+				nlri_ret = bgp_nlri_parse(peer, NLRI_ATTR_ARG,
+							  &nlris[i], 1);
 			break;
 		default:
 			nlri_ret = BGP_NLRI_PARSE_ERROR;
 		}
+		bgp_cpu_account(&peer->cpu_stats[nlris[i].afi][nlris[i].safi]
+						[BGP_CPU_NLRI],
+				cpu_start);
 
 		if (nlri_ret < BGP_NLRI_PARSE_OK
 		    && nlri_ret != BGP_NLRI_PARSE_ERROR_PREFIX_OVERFLOW) {
@@ -2119,9 +2158,11 @@ static int bgp_update_receive(struct peer *peer, bgp_size_t size)
 				}
 			}
 
-			/* NSF delete stale route */
-			if (peer->nsf[afi][safi])
+			/* NSF delete stale route, same for snapshot paths */
+			if (peer->nsf[afi][safi] ||
+			    peer->snapshot_stale[afi][safi])
 				bgp_clear_stale_route(peer, afi, safi);
+			peer->snapshot_stale[afi][safi] = false;
 
 			zlog_info(
 				"%s: rcvd End-of-RIB for %s from %s in vrf %s",
@@ -2136,12 +2177,31 @@ static int bgp_update_receive(struct peer *peer, bgp_size_t size)
 
 	peer->update_time = monotime(NULL);
 
-	/* Notify BGP Conditional advertisement scanner process */
-	peer->advmap_table_change = true;
-
 	return Receive_UPDATE_message;
 }
 
+/**
+ * Process BGP UPDATE message for peer.
+ *
+ * Parses UPDATE and creates attribute object.
+ *
+ * @param peer
+ * @param size size of the packet
+ * @return as in summary
+ */
+static int bgp_update_receive(struct peer *peer, bgp_size_t size)
+{
+	struct bgp_preparse *pp;
+	int ret;
+
+	pp = bgp_preparse_take(peer, peer->curr);
+	ret = bgp_update_process(peer, size, pp);
+	if (pp)
+		bgp_preparse_free(pp);
+
+	return ret;
+}
+
 /**
  * Process BGP NOTIFY message for peer.
  *
@@ -2281,6 +2341,7 @@ static int bgp_route_refresh_receive(struct peer *peer, bgp_size_t size)
 	struct update_group *updgrp;
 	struct peer *updgrp_peer;
 	uint8_t subtype;
+	bool request;
 	bool force_update = false;
 	bgp_size_t msg_length =
 		size - (BGP_MSG_ROUTE_REFRESH_MIN_SIZE - BGP_HEADER_SIZE);
@@ -2528,8 +2589,14 @@ static int bgp_route_refresh_receive(struct peer *peer, bgp_size_t size)
 		UNSET_FLAG(peer->af_sflags[afi][safi],
 			   PEER_STATUS_ORF_WAIT_REFRESH);
 
+	/* BoRR and EoRR frame the routes the peer sends us again, they
+	 * don't ask for ours
+	 */
+	request = subtype != BGP_ROUTE_REFRESH_BORR
+		  && subtype != BGP_ROUTE_REFRESH_EORR;
+
 	paf = peer_af_find(peer, afi, safi);
-	if (paf && paf->subgroup) {
+	if (paf && paf->subgroup && request) {
 		if (peer->orf_plist[afi][safi]) {
 			updgrp = PAF_UPDGRP(paf);
 			updgrp_peer = UPDGRP_PEER(updgrp);
@@ -2673,7 +2740,8 @@ static int bgp_route_refresh_receive(struct peer *peer, bgp_size_t size)
 	}
 
 	/* Perform route refreshment to the peer */
-	bgp_announce_route(peer, afi, safi, force_update);
+	if (request)
+		bgp_announce_route(peer, afi, safi, force_update);
 
 	/* No FSM action necessary */
 	return BGP_PACKET_NOOP;
@@ -2884,6 +2952,11 @@ void bgp_process_packet(struct event *thread)
 	if (peer->status == Deleted || peer->status == Clearing)
 		return;
 
+	/* parse workers were turned off with packets still queued for them */
+	frr_with_mutex (&peer->io_mtx) {
+		bgp_parse_drain(peer);
+	}
+
 	unsigned int processed = 0;
 
 	while (processed < rpkt_quanta_old) {
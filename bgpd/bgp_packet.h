@@ -22,6 +22,15 @@ DECLARE_HOOK(bgp_packet_send,
 #define BGP_TOTAL_ATTR_LEN    2U
 #define BGP_UNFEASIBLE_LEN    2U
 
+/* NLRI sections of an UPDATE message */
+enum bgp_update_nlri_type {
+	NLRI_UPDATE,
+	NLRI_WITHDRAW,
+	NLRI_MP_UPDATE,
+	NLRI_MP_WITHDRAW,
+	NLRI_TYPE_MAX
+};
+
 /* When to refresh */
 #define REFRESH_IMMEDIATE 1
 #define REFRESH_DEFER     2
@@ -0,0 +1,567 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP UPDATE pre-parse worker pthreads.
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * Packets read by the I/O pthread are normally put straight on peer->ibuf
+ * for bgp_process_packet() on the main pthread.  When parse workers are
+ * configured, they are first queued on peer->ibuf_parse and handed to one
+ * of a small pool of pthreads.  For an UPDATE the worker validates the
+ * framing, runs bgp_attr_parse_stream() (the attribute, AS path, community
+ * etc. intern tables are sharded and locked, see bgp_intern.h) and decodes
+ * the IPv4/IPv6 unicast and multicast NLRI into prefix lists.  The packet
+ * then moves onward to peer->ibuf together with the result.
+ *
+ * bgp_update_receive() picks the result up and is left with the FSM
+ * checks, sending any NOTIFICATION the worker asked for, End-of-RIB and
+ * bgp_update()/bgp_withdraw() for each prefix, including the final
+ * bgp_attr_intern().  NLRI of other address families is decoded there as
+ * before.
+ *
+ * A peer is always served by the same worker so per-peer packet order is
+ * kept.
+ */
+
+#include <zebra.h>
+
+#include "frr_pthread.h"
+#include "frrevent.h"
+#include "jhash.h"
+#include "lib/json.h"
+#include "memory.h"
+#include "monotime.h"
+#include "stream.h"
+#include "vty.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_debug.h"
+#include "bgpd/bgp_packet.h"
+#include "bgpd/bgp_parse.h"
+#include "bgpd/bgp_route.h"
+
+DEFINE_MTYPE_STATIC(BGPD, BGP_PARSE_WORKER, "BGP parse worker");
+DEFINE_MTYPE_STATIC(BGPD, BGP_PREPARSE, "BGP pre-parsed UPDATE");
+
+/* upper bound of packets handled per worker task before yielding */
+#define BGP_PARSE_WORKER_QUANTA 64U
+
+struct bgp_parse_worker {
+	struct frr_pthread *fpt;
+	unsigned int index;
+
+	/* statistics, only written by the worker itself */
+	_Atomic uint64_t packets;
+	_Atomic uint64_t updates;
+	_Atomic uint64_t prefixes;
+	_Atomic uint64_t bytes;
+	_Atomic uint64_t malformed;
+	_Atomic uint64_t runs;
+	_Atomic uint64_t busy_usec;
+};
+
+static struct bgp_parse_worker **workers;
+static _Atomic unsigned int workers_active;
+static unsigned int workers_configured;
+
+unsigned int bgp_parse_workers_count(void)
+{
+	return workers_configured;
+}
+
+bool bgp_parse_workers_enabled(void)
+{
+	return atomic_load_explicit(&workers_active, memory_order_acquire) > 0;
+}
+
+static uint32_t bgp_parse_peer_key(struct peer *peer)
+{
+	return jhash(&peer, sizeof(peer), 0x8a1b2c3d);
+}
+
+static struct bgp_parse_worker *bgp_parse_worker_get(struct peer *peer)
+{
+	unsigned int count;
+
+	count = atomic_load_explicit(&workers_active, memory_order_acquire);
+	if (!count)
+		return NULL;
+
+	return workers[bgp_parse_peer_key(peer) % count];
+}
+
+/*
+ * Walk the UPDATE message and check that the section lengths are
+ * consistent with the message length.
+ */
+static void bgp_update_preparse_framing(const struct stream *pkt,
+					struct bgp_preparse *pp)
+{
+	const uint8_t *data = STREAM_DATA(pkt);
+	size_t end = stream_get_endp(pkt);
+	size_t pos = BGP_HEADER_SIZE;
+	size_t attr_end;
+
+	pp->valid = false;
+
+	if (pos + BGP_UNFEASIBLE_LEN > end)
+		return;
+	pp->withdraw_len = (data[pos] << 8) | data[pos + 1];
+	pos += BGP_UNFEASIBLE_LEN;
+
+	if (pos + pp->withdraw_len + BGP_TOTAL_ATTR_LEN > end)
+		return;
+	pos += pp->withdraw_len;
+
+	pp->attribute_len = (data[pos] << 8) | data[pos + 1];
+	pos += BGP_TOTAL_ATTR_LEN;
+
+	if (pos + pp->attribute_len > end)
+		return;
+	attr_end = pos + pp->attribute_len;
+
+	/* path attribute TLV headers */
+	while (pos < attr_end) {
+		uint8_t flags;
+		size_t hdr = 3;
+		size_t len;
+
+		if (pos + 3 > attr_end)
+			return;
+
+		flags = data[pos];
+		if (CHECK_FLAG(flags, BGP_ATTR_FLAG_EXTLEN)) {
+			if (pos + 4 > attr_end)
+				return;
+			len = (data[pos + 2] << 8) | data[pos + 3];
+			hdr = 4;
+		} else
+			len = data[pos + 2];
+
+		if (pos + hdr + len > attr_end)
+			return;
+
+		pos += hdr + len;
+		pp->attr_count++;
+	}
+
+	pp->update_len = end - attr_end;
+	pp->valid = true;
+}
+
+static int bgp_preparse_prefix_add(struct peer *peer,
+				   const struct bgp_nlri *packet,
+				   const struct prefix *p, uint32_t addpath_id,
+				   void *arg)
+{
+	struct bgp_preparse_nlri *decoded = arg;
+
+	if (decoded->count == decoded->size) {
+		decoded->size = decoded->size ? decoded->size * 2 : 16;
+		decoded->prefixes =
+			XREALLOC(MTYPE_BGP_PREPARSE, decoded->prefixes,
+				 decoded->size * sizeof(*decoded->prefixes));
+	}
+
+	decoded->prefixes[decoded->count].p = *p;
+	decoded->prefixes[decoded->count].addpath_id = addpath_id;
+	decoded->count++;
+
+	return BGP_NLRI_PARSE_OK;
+}
+
+/*
+ * Decode an UPDATE the way bgp_update_receive() does, up to the point
+ * where routes would be installed.  The peer is only read from: anything
+ * that needs acting on (a NOTIFICATION, treat-as-withdraw, End-of-RIB) is
+ * left in pp for the main pthread.
+ */
+static void bgp_update_preparse(struct peer *peer, struct stream *pkt,
+				struct bgp_preparse *pp)
+{
+	uint8_t *data = STREAM_DATA(pkt);
+	size_t getp = stream_get_getp(pkt);
+	size_t pos = BGP_HEADER_SIZE + BGP_UNFEASIBLE_LEN;
+	int i;
+
+	bgp_update_preparse_framing(pkt, pp);
+	if (!pp->valid)
+		return;
+
+	if (pp->withdraw_len) {
+		pp->nlris[NLRI_WITHDRAW].afi = AFI_IP;
+		pp->nlris[NLRI_WITHDRAW].safi = SAFI_UNICAST;
+		pp->nlris[NLRI_WITHDRAW].nlri = data + pos;
+		pp->nlris[NLRI_WITHDRAW].length = pp->withdraw_len;
+	}
+	pos += pp->withdraw_len + BGP_TOTAL_ATTR_LEN;
+
+	pp->attr.label_index = BGP_INVALID_LABEL_INDEX;
+	pp->attr.label = MPLS_INVALID_LABEL;
+	pp->attr_ret = BGP_ATTR_PARSE_PROCEED;
+	pp->attr_parsed = true;
+
+	if (pp->attribute_len) {
+		/* the main pthread reads the packet again from the start */
+		stream_set_getp(pkt, pos);
+		pp->attr_ret = bgp_attr_parse_stream(
+			peer, pkt, &pp->notify, &pp->attr, pp->attribute_len,
+			&pp->nlris[NLRI_MP_UPDATE],
+			&pp->nlris[NLRI_MP_WITHDRAW]);
+		stream_set_getp(pkt, getp);
+
+		if (pp->attr_ret == BGP_ATTR_PARSE_ERROR)
+			return;
+	}
+	pos += pp->attribute_len;
+
+	if (pp->update_len) {
+		pp->nlris[NLRI_UPDATE].afi = AFI_IP;
+		pp->nlris[NLRI_UPDATE].safi = SAFI_UNICAST;
+		pp->nlris[NLRI_UPDATE].nlri = data + pos;
+		pp->nlris[NLRI_UPDATE].length = pp->update_len;
+	}
+
+	for (i = NLRI_UPDATE; i < NLRI_TYPE_MAX; i++) {
+		struct bgp_nlri *nlri = &pp->nlris[i];
+
+		if (!nlri->nlri || !nlri->length)
+			continue;
+		if (nlri->afi != AFI_IP && nlri->afi != AFI_IP6)
+			continue;
+		if (nlri->safi != SAFI_UNICAST && nlri->safi != SAFI_MULTICAST)
+			continue;
+		/* checked again (and logged) by bgp_update_receive() */
+		if (!peer->afc[nlri->afi][nlri->safi])
+			continue;
+
+		pp->decoded[i].decoded = true;
+		pp->decoded[i].ret = bgp_nlri_decode_ip(peer, nlri,
+							bgp_preparse_prefix_add,
+							&pp->decoded[i]);
+	}
+}
+
+static void bgp_parse_peer(struct event *thread)
+{
+	struct peer *peer = EVENT_ARG(thread);
+	struct bgp_parse_worker *w;
+	struct timeval start;
+	unsigned int processed = 0;
+	bool more = false;
+
+	w = bgp_parse_worker_get(peer);
+	if (!w)
+		return;
+
+	monotime(&start);
+
+	while (processed < BGP_PARSE_WORKER_QUANTA) {
+		struct stream *pkt;
+		struct bgp_preparse *pp = NULL;
+
+		frr_with_mutex (&peer->io_mtx) {
+			pkt = stream_fifo_pop(peer->ibuf_parse);
+		}
+		if (!pkt)
+			break;
+
+		atomic_fetch_add_explicit(&w->packets, 1, memory_order_relaxed);
+		atomic_fetch_add_explicit(&w->bytes, stream_get_endp(pkt),
+					  memory_order_relaxed);
+
+		if (stream_get_endp(pkt) > BGP_HEADER_SIZE &&
+		    STREAM_DATA(pkt)[BGP_MARKER_SIZE + 2] == BGP_MSG_UPDATE) {
+			unsigned int prefixes = 0;
+			int i;
+
+			pp = XCALLOC(MTYPE_BGP_PREPARSE, sizeof(*pp));
+			pp->pkt = pkt;
+			bgp_update_preparse(peer, pkt, pp);
+
+			for (i = NLRI_UPDATE; i < NLRI_TYPE_MAX; i++)
+				prefixes += pp->decoded[i].count;
+
+			atomic_fetch_add_explicit(&w->updates, 1,
+						  memory_order_relaxed);
+			atomic_fetch_add_explicit(&w->prefixes, prefixes,
+						  memory_order_relaxed);
+			if (!pp->valid || pp->attr_ret == BGP_ATTR_PARSE_ERROR)
+				atomic_fetch_add_explicit(&w->malformed, 1,
+							  memory_order_relaxed);
+		}
+
+		frr_with_mutex (&peer->io_mtx) {
+			if (pp)
+				bgp_preparse_add_tail(&peer->preparsed, pp);
+			stream_fifo_push(peer->ibuf, pkt);
+		}
+
+		processed++;
+	}
+
+	frr_with_mutex (&peer->io_mtx) {
+		more = (peer->ibuf_parse->count > 0);
+	}
+
+	atomic_fetch_add_explicit(&w->runs, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&w->busy_usec, monotime_since(&start, NULL),
+				  memory_order_relaxed);
+
+	if (more)
+		event_add_event(w->fpt->master, bgp_parse_peer, peer, 0,
+				&peer->t_parse);
+
+	if (processed)
+		event_add_event(bm->master, bgp_process_packet, peer, 0,
+				&peer->t_process_packet);
+}
+
+/* peer->io_mtx must be held, see bgp_parse_workers_stop() */
+void bgp_parse_schedule(struct peer *peer)
+{
+	struct bgp_parse_worker *w = bgp_parse_worker_get(peer);
+
+	if (!w) {
+		/* workers went away meanwhile, main pthread drains */
+		event_add_event(bm->master, bgp_process_packet, peer, 0,
+				&peer->t_process_packet);
+		return;
+	}
+
+	event_add_event(w->fpt->master, bgp_parse_peer, peer, 0,
+			&peer->t_parse);
+}
+
+void bgp_parse_cancel(struct peer *peer)
+{
+	struct bgp_parse_worker *w = bgp_parse_worker_get(peer);
+
+	if (w)
+		event_cancel_async(w->fpt->master, &peer->t_parse, NULL);
+}
+
+void bgp_parse_drain(struct peer *peer)
+{
+	struct stream *pkt;
+
+	if (!peer->ibuf_parse || bgp_parse_workers_enabled())
+		return;
+
+	while ((pkt = stream_fifo_pop(peer->ibuf_parse)))
+		stream_fifo_push(peer->ibuf, pkt);
+}
+
+void bgp_preparse_free(struct bgp_preparse *pp)
+{
+	int i;
+
+	if (pp->attr_parsed)
+		bgp_attr_unintern_sub(&pp->attr);
+	XFREE(MTYPE_BGP_NOTIFICATION, pp->notify.raw_data);
+	for (i = NLRI_UPDATE; i < NLRI_TYPE_MAX; i++)
+		XFREE(MTYPE_BGP_PREPARSE, pp->decoded[i].prefixes);
+	XFREE(MTYPE_BGP_PREPARSE, pp);
+}
+
+int bgp_preparse_nlri_process(struct peer *peer, struct attr *attr,
+			      const struct bgp_nlri *packet,
+			      const struct bgp_preparse_nlri *decoded)
+{
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < decoded->count; i++) {
+		ret = bgp_nlri_prefix_process(peer, &decoded->prefixes[i].p,
+					      decoded->prefixes[i].addpath_id,
+					      attr, packet->afi, packet->safi);
+		if (ret != BGP_NLRI_PARSE_OK)
+			return ret;
+	}
+
+	return decoded->ret;
+}
+
+void bgp_parse_clean(struct peer *peer)
+{
+	struct bgp_preparse *pp;
+
+	if (peer->ibuf_parse)
+		stream_fifo_clean(peer->ibuf_parse);
+
+	while ((pp = bgp_preparse_pop(&peer->preparsed)))
+		bgp_preparse_free(pp);
+}
+
+struct bgp_preparse *bgp_preparse_take(struct peer *peer,
+				       const struct stream *pkt)
+{
+	struct bgp_preparse *pp;
+
+	frr_with_mutex (&peer->io_mtx) {
+		pp = bgp_preparse_first(&peer->preparsed);
+		if (pp && pp->pkt == pkt)
+			bgp_preparse_del(&peer->preparsed, pp);
+		else
+			pp = NULL;
+	}
+
+	return pp;
+}
+
+static void bgp_parse_workers_stop(void)
+{
+	struct listnode *node, *nnode;
+	struct peer *peer;
+	struct bgp *bgp;
+	unsigned int i;
+	uint32_t key;
+
+	if (!workers_configured)
+		return;
+
+	/* no new work is handed out from here on */
+	atomic_store_explicit(&workers_active, 0, memory_order_release);
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp))
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, nnode, peer)) {
+			/* wait out a concurrent bgp_parse_schedule() */
+			frr_with_mutex (&peer->io_mtx) {
+				key = bgp_parse_peer_key(peer);
+			}
+			event_cancel_async(
+				workers[key % workers_configured]->fpt->master,
+				&peer->t_parse, NULL);
+		}
+
+	for (i = 0; i < workers_configured; i++) {
+		frr_pthread_stop(workers[i]->fpt, NULL);
+		frr_pthread_destroy(workers[i]->fpt);
+		XFREE(MTYPE_BGP_PARSE_WORKER, workers[i]);
+	}
+	XFREE(MTYPE_BGP_PARSE_WORKER, workers);
+	workers_configured = 0;
+
+	/* hand whatever was still waiting over to the main pthread */
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp))
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, nnode, peer)) {
+			frr_with_mutex (&peer->io_mtx) {
+				/* a worker may have re-armed itself on exit */
+				peer->t_parse = NULL;
+				bgp_parse_drain(peer);
+				if (peer->ibuf->count)
+					event_add_event(bm->master,
+							bgp_process_packet,
+							peer, 0,
+							&peer->t_process_packet);
+			}
+		}
+}
+
+void bgp_parse_workers_set(unsigned int count)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+	char name[32];
+	char os_name[OS_THREAD_NAMELEN];
+	unsigned int i;
+
+	if (count > BGP_PARSE_WORKERS_MAX)
+		count = BGP_PARSE_WORKERS_MAX;
+	if (count == workers_configured)
+		return;
+
+	bgp_parse_workers_stop();
+	if (!count)
+		return;
+
+	workers = XCALLOC(MTYPE_BGP_PARSE_WORKER, count * sizeof(*workers));
+	for (i = 0; i < count; i++) {
+		struct bgp_parse_worker *w;
+
+		w = XCALLOC(MTYPE_BGP_PARSE_WORKER, sizeof(*w));
+		w->index = i;
+
+		snprintf(name, sizeof(name), "BGP parse worker %u", i);
+		snprintf(os_name, sizeof(os_name), "bgpd_parse%u", i);
+		w->fpt = frr_pthread_new(&attr, name, os_name);
+		frr_pthread_run(w->fpt, NULL);
+		workers[i] = w;
+	}
+	for (i = 0; i < count; i++)
+		frr_pthread_wait_running(workers[i]->fpt);
+
+	workers_configured = count;
+	atomic_store_explicit(&workers_active, count, memory_order_release);
+}
+
+void bgp_parse_workers_show(struct vty *vty, json_object *json)
+{
+	json_object *json_workers = NULL;
+	unsigned int i;
+
+	if (json) {
+		json_object_int_add(json, "workers", workers_configured);
+		json_workers = json_object_new_array();
+		json_object_object_add(json, "workerStats", json_workers);
+	} else {
+		if (!workers_configured) {
+			vty_out(vty, "BGP parse workers are disabled\n");
+			return;
+		}
+		vty_out(vty, "%-6s %12s %12s %12s %14s %10s %12s\n",
+			"Worker", "Packets", "Updates", "Prefixes", "Bytes",
+			"Malformed", "Busy(ms)");
+	}
+
+	for (i = 0; i < workers_configured; i++) {
+		struct bgp_parse_worker *w = workers[i];
+		uint64_t packets, updates, prefixes, bytes, malformed, runs,
+			busy;
+
+		packets = atomic_load_explicit(&w->packets,
+					       memory_order_relaxed);
+		updates = atomic_load_explicit(&w->updates,
+					       memory_order_relaxed);
+		prefixes = atomic_load_explicit(&w->prefixes,
+						memory_order_relaxed);
+		bytes = atomic_load_explicit(&w->bytes, memory_order_relaxed);
+		malformed = atomic_load_explicit(&w->malformed,
+						 memory_order_relaxed);
+		runs = atomic_load_explicit(&w->runs, memory_order_relaxed);
+		busy = atomic_load_explicit(&w->busy_usec,
+					    memory_order_relaxed);
+
+		if (json) {
+			json_object *json_w = json_object_new_object();
+
+			json_object_int_add(json_w, "index", w->index);
+			json_object_int_add(json_w, "packets", packets);
+			json_object_int_add(json_w, "updates", updates);
+			json_object_int_add(json_w, "prefixes", prefixes);
+			json_object_int_add(json_w, "bytes", bytes);
+			json_object_int_add(json_w, "malformed", malformed);
+			json_object_int_add(json_w, "runs", runs);
+			json_object_int_add(json_w, "busyMsecs", busy / 1000);
+			json_object_array_add(json_workers, json_w);
+		} else
+			vty_out(vty,
+				"%-6u %12" PRIu64 " %12" PRIu64 " %12" PRIu64
+				" %14" PRIu64 " %10" PRIu64 " %12" PRIu64 "\n",
+				w->index, packets, updates, prefixes, bytes,
+				malformed, busy / 1000);
+	}
+}
+
+void bgp_parse_init(void)
+{
+	workers = NULL;
+	workers_configured = 0;
+	atomic_store_explicit(&workers_active, 0, memory_order_relaxed);
+}
+
+void bgp_parse_finish(void)
+{
+	bgp_parse_workers_stop();
+}
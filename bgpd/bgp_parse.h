@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP UPDATE pre-parse worker pthreads.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#ifndef _FRR_BGP_PARSE_H
+#define _FRR_BGP_PARSE_H
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_packet.h"
+#include "typesafe.h"
+#include "stream.h"
+
+#define BGP_PARSE_WORKERS_MAX 16U
+
+/* one prefix of an NLRI section decoded by a parse worker */
+struct bgp_preparse_prefix {
+	struct prefix p;
+	uint32_t addpath_id;
+};
+
+struct bgp_preparse_nlri {
+	/* the section was decoded, else bgp_nlri_parse() has to do it */
+	bool decoded;
+
+	struct bgp_preparse_prefix *prefixes;
+	unsigned int count;
+	unsigned int size;
+
+	/* bgp_nlri_decode_ip() result, i.e. how decoding after the last
+	 * prefix went
+	 */
+	int ret;
+};
+
+/*
+ * Result of decoding a single UPDATE message off the main pthread. One of
+ * these is queued on peer->preparsed for every UPDATE that went through a
+ * parse worker, in the same order as the packets appear on peer->ibuf.
+ */
+struct bgp_preparse {
+	struct bgp_preparse_item item;
+
+	/* packet this result belongs to, only used for matching */
+	const struct stream *pkt;
+
+	/* section lengths, validated against the message length */
+	bgp_size_t withdraw_len;
+	bgp_size_t attribute_len;
+	bgp_size_t update_len;
+
+	/* number of path attributes found while walking the TLV headers */
+	uint16_t attr_count;
+
+	/* framing is consistent, the main pthread can skip length checks */
+	bool valid;
+
+	/*
+	 * bgp_attr_parse_stream() ran: attr holds references to the interned
+	 * sub-attributes, attr_ret and the MP entries of nlris are set and
+	 * notify has the NOTIFICATION to send, if any.
+	 */
+	bool attr_parsed;
+	enum bgp_attr_parse_ret attr_ret;
+	struct attr attr;
+	struct bgp_notify notify;
+
+	struct bgp_nlri nlris[NLRI_TYPE_MAX];
+	struct bgp_preparse_nlri decoded[NLRI_TYPE_MAX];
+};
+
+DECLARE_LIST(bgp_preparse, struct bgp_preparse, item);
+
+/* configured number of workers, 0 if disabled */
+extern unsigned int bgp_parse_workers_count(void);
+
+/* (re)configure the number of parse workers, 0 disables them */
+extern void bgp_parse_workers_set(unsigned int count);
+
+/* called from the I/O pthread with peer->io_mtx held */
+extern bool bgp_parse_workers_enabled(void);
+
+/* called from the I/O pthread after packets were put on peer->ibuf_parse */
+extern void bgp_parse_schedule(struct peer *peer);
+
+/* cancel any pending parse task for the peer (from bgp_reads_off()) */
+extern void bgp_parse_cancel(struct peer *peer);
+
+/*
+ * Main pthread, peer->io_mtx held: move anything still waiting for a worker
+ * onto peer->ibuf so that packet order is preserved when workers go away.
+ */
+extern void bgp_parse_drain(struct peer *peer);
+
+/* peer->io_mtx held: drop all queued pre-parse results */
+extern void bgp_parse_clean(struct peer *peer);
+
+/* fetch (and unqueue) the pre-parse result for the given packet, if any */
+extern struct bgp_preparse *bgp_preparse_take(struct peer *peer,
+					      const struct stream *pkt);
+extern void bgp_preparse_free(struct bgp_preparse *pp);
+
+/*
+ * Main pthread: install (or withdraw, attr NULL) the prefixes a worker
+ * decoded, returning as bgp_nlri_parse() would have.
+ */
+extern int bgp_preparse_nlri_process(struct peer *peer, struct attr *attr,
+				     const struct bgp_nlri *packet,
+				     const struct bgp_preparse_nlri *decoded);
+
+extern void bgp_parse_workers_show(struct vty *vty, json_object *json);
+
+extern void bgp_parse_init(void);
+extern void bgp_parse_finish(void);
+
+#endif /* _FRR_BGP_PARSE_H */
@@ -1662,12 +1662,12 @@ static void bgp_pbr_flush_iprule(struct bgp *bgp, struct bgp_pbr_action *bpa,
 		bpr->action = NULL;
 		if (bpr->path) {
 			struct bgp_path_info *path;
-			struct bgp_path_info_extra *extra;
+			struct bgp_path_info_extra_fs *extra;
 
 			/* unlink path to bpme */
 			path = (struct bgp_path_info *)bpr->path;
-			extra = bgp_path_info_extra_get(path);
-			if (extra->bgp_fs_iprule)
+			extra = path->extra ? path->extra->flowspec : NULL;
+			if (extra && extra->bgp_fs_iprule)
 				listnode_delete(extra->bgp_fs_iprule, bpr);
 			bpr->path = NULL;
 		}
@@ -1691,12 +1691,12 @@ static void bgp_pbr_flush_entry(struct bgp *bgp, struct bgp_pbr_action *bpa,
 		bpme->backpointer = NULL;
 		if (bpme->path) {
 			struct bgp_path_info *path;
-			struct bgp_path_info_extra *extra;
+			struct bgp_path_info_extra_fs *extra;
 
 			/* unlink path to bpme */
 			path = (struct bgp_path_info *)bpme->path;
-			extra = bgp_path_info_extra_get(path);
-			if (extra->bgp_fs_pbr)
+			extra = path->extra ? path->extra->flowspec : NULL;
+			if (extra && extra->bgp_fs_pbr)
 				listnode_delete(extra->bgp_fs_pbr, bpme);
 			bpme->path = NULL;
 		}
@@ -2339,8 +2339,8 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 			bpr_found = true;
 		/* already installed */
 		if (bpr_found) {
-			struct bgp_path_info_extra *extra =
-				bgp_path_info_extra_get(path);
+			struct bgp_path_info_extra_fs *extra =
+				path->extra ? path->extra->flowspec : NULL;
 
 			if (extra &&
 			    listnode_lookup_nocheck(extra->bgp_fs_iprule,
@@ -2498,8 +2498,8 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 
 	/* already installed */
 	if (bpme_found) {
-		struct bgp_path_info_extra *extra =
-			bgp_path_info_extra_get(path);
+		struct bgp_path_info_extra_fs *extra =
+			path->extra ? path->extra->flowspec : NULL;
 
 		if (extra &&
 		    listnode_lookup_nocheck(extra->bgp_fs_pbr, bpme)) {
@@ -67,6 +67,81 @@ int bgp_regexec(regex_t *regex, struct aspath *aspath)
 	return regexec(regex, aspath->str, 0, NULL, 0);
 }
 
+/*
+ * Most as-path filters are plain AS numbers glued together with `_', `^'
+ * and `$', e.g. "_65001_" or "^65001 65002_".  Those are matched by the
+ * small backtracking scanner below instead of going through regexec(),
+ * which has to run the expanded "(^|[,{}() ]|$)" alternation at every
+ * position of the string.
+ */
+bool bgp_regex_is_literal(const char *regstr)
+{
+	size_t len = strlen(regstr);
+	size_t i;
+
+	if (len && regstr[0] == '^')
+		regstr++, len--;
+	if (len && regstr[len - 1] == '$')
+		len--;
+	if (!len)
+		return false;
+
+	for (i = 0; i < len; i++)
+		if (!isdigit((unsigned char)regstr[i]) && regstr[i] != ' '
+		    && regstr[i] != '_')
+			return false;
+	return true;
+}
+
+static bool bgp_regex_delim(char c)
+{
+	return c == ',' || c == '{' || c == '}' || c == '(' || c == ')'
+	       || c == ' ';
+}
+
+static bool bgp_regex_literal_at(const char *pat, bool anchor_end,
+				 const char *str, size_t len, size_t pos)
+{
+	for (; *pat; pat++) {
+		if (*pat == '$')
+			break;
+
+		if (*pat != '_') {
+			if (pos >= len || str[pos] != *pat)
+				return false;
+			pos++;
+			continue;
+		}
+
+		/* `_' matches the start or end of the string, or a delimiter */
+		if ((pos == 0 || pos == len)
+		    && bgp_regex_literal_at(pat + 1, anchor_end, str, len, pos))
+			return true;
+		if (pos >= len || !bgp_regex_delim(str[pos]))
+			return false;
+		pos++;
+	}
+
+	return !anchor_end || pos == len;
+}
+
+bool bgp_regex_literal_match(const char *regstr, const char *str)
+{
+	size_t len = strlen(str);
+	size_t rlen = strlen(regstr);
+	bool anchor_end = rlen && regstr[rlen - 1] == '$';
+	size_t pos;
+
+	if (regstr[0] == '^')
+		return bgp_regex_literal_at(regstr + 1, anchor_end, str, len,
+					    0);
+
+	for (pos = 0; pos <= len; pos++)
+		if (bgp_regex_literal_at(regstr, anchor_end, str, len, pos))
+			return true;
+	return false;
+}
+
 void bgp_regex_free(regex_t *regex)
 {
 	regfree(regex);
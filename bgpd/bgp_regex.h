@@ -23,4 +23,8 @@ extern void bgp_regex_free(regex_t *regex);
 extern regex_t *bgp_regcomp(const char *str);
 extern int bgp_regexec(regex_t *regex, struct aspath *aspath);
 
+/* fast path for expressions made of AS numbers, `_', `^' and `$' only */
+extern bool bgp_regex_is_literal(const char *regstr);
+extern bool bgp_regex_literal_match(const char *regstr, const char *str);
+
 #endif /* _FRR_BGP_REGEX_H */
@@ -12,6 +12,7 @@
 #include "prefix.h"
 #include "linklist.h"
 #include "memory.h"
+#include "jhash.h"
 #include "command.h"
 #include "stream.h"
 #include "filter.h"
@@ -28,6 +29,7 @@
 #include "lib/json.h"
 #include "lib_errors.h"
 #include "zclient.h"
+#include "flightrec.h"
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_table.h"
 #include "bgpd/bgp_route.h"
@@ -73,9 +75,16 @@
 #include "bgpd/bgp_flowspec.h"
 #include "bgpd/bgp_flowspec_util.h"
 #include "bgpd/bgp_pbr.h"
+#include "bgpd/bgp_conditional_adv.h"
 
 #include "bgpd/bgp_route_clippy.c"
 
+/* paths and their extra info are by far the most numerous allocations in a
+ * full table and come and go in bulk, keep them in slabs
+ */
+DEFINE_MSLAB(BGP_ROUTE, sizeof(struct bgp_path_info));
+DEFINE_MSLAB_STATIC(BGP_ROUTE_EXTRA, sizeof(struct bgp_path_info_extra));
+
 DEFINE_HOOK(bgp_snmp_update_stats,
 	    (struct bgp_node *rn, struct bgp_path_info *pi, bool added),
 	    (rn, pi, added));
@@ -105,7 +114,6 @@ static const struct message bgp_pmsi_tnltype_str[] = {
 };
 
 #define VRFID_NONE_STR "-"
-#define SOFT_RECONFIG_TASK_MAX_PREFIX 25000
 
 DEFINE_HOOK(bgp_process,
 	    (struct bgp * bgp, afi_t afi, safi_t safi, struct bgp_dest *bn,
@@ -184,12 +192,9 @@ struct bgp_dest *bgp_safi_node_lookup(struct bgp_table *table, safi_t safi,
 static struct bgp_path_info_extra *bgp_path_info_extra_new(void)
 {
 	struct bgp_path_info_extra *new;
-	new = XCALLOC(MTYPE_BGP_ROUTE_EXTRA,
-		      sizeof(struct bgp_path_info_extra));
+	new = XSLAB_CALLOC(MSLAB_BGP_ROUTE_EXTRA);
 	new->label[0] = MPLS_INVALID_LABEL;
 	new->num_labels = 0;
-	new->bgp_fs_pbr = NULL;
-	new->bgp_fs_iprule = NULL;
 	return new;
 }
 
@@ -206,8 +211,9 @@ void bgp_path_info_extra_free(struct bgp_path_info_extra **extra)
 				   e->damp_info->safi);
 
 	e->damp_info = NULL;
-	if (e->parent) {
-		struct bgp_path_info *bpi = (struct bgp_path_info *)e->parent;
+	if (e->vrfleak && e->vrfleak->parent) {
+		struct bgp_path_info *bpi =
+			(struct bgp_path_info *)e->vrfleak->parent;
 
 		if (bpi->net) {
 			/* FIXME: since multiple e may have the same e->parent
@@ -227,15 +233,17 @@ void bgp_path_info_extra_free(struct bgp_path_info_extra **extra)
 				bpi->net = NULL;
 			bgp_path_info_unlock(bpi);
 		}
-		bgp_path_info_unlock(e->parent);
-		e->parent = NULL;
+		bgp_path_info_unlock(e->vrfleak->parent);
+		e->vrfleak->parent = NULL;
 	}
 
-	if (e->bgp_orig)
-		bgp_unlock(e->bgp_orig);
+	if (e->vrfleak && e->vrfleak->bgp_orig)
+		bgp_unlock(e->vrfleak->bgp_orig);
 
-	if (e->peer_orig)
-		peer_unlock(e->peer_orig);
+	if (e->vrfleak && e->vrfleak->peer_orig)
+		peer_unlock(e->vrfleak->peer_orig);
+
+	XFREE(MTYPE_BGP_ROUTE_EXTRA_VRFLEAK, e->vrfleak);
 
 	if (e->aggr_suppressors)
 		list_delete(&e->aggr_suppressors);
@@ -243,11 +251,17 @@ void bgp_path_info_extra_free(struct bgp_path_info_extra **extra)
 	if (e->mh_info)
 		bgp_evpn_path_mh_info_free(e->mh_info);
 
-	if ((*extra)->bgp_fs_iprule)
-		list_delete(&((*extra)->bgp_fs_iprule));
-	if ((*extra)->bgp_fs_pbr)
-		list_delete(&((*extra)->bgp_fs_pbr));
-	XFREE(MTYPE_BGP_ROUTE_EXTRA, *extra);
+	XFREE(MTYPE_BGP_ROUTE_EXTRA_EVPN, e->evpn);
+
+	if (e->flowspec) {
+		if (e->flowspec->bgp_fs_iprule)
+			list_delete(&e->flowspec->bgp_fs_iprule);
+		if (e->flowspec->bgp_fs_pbr)
+			list_delete(&e->flowspec->bgp_fs_pbr);
+		XFREE(MTYPE_BGP_ROUTE_EXTRA_FS, e->flowspec);
+	}
+
+	XSLAB_FREE(MSLAB_BGP_ROUTE_EXTRA, *extra);
 }
 
 /* Get bgp_path_info extra information for the given bgp_path_info, lazy
@@ -260,6 +274,43 @@ struct bgp_path_info_extra *bgp_path_info_extra_get(struct bgp_path_info *pi)
 	return pi->extra;
 }
 
+/* Feature specific parts of bgp_path_info extra information, lazy allocated
+ * (together with the extra information itself) if required.
+ */
+struct bgp_path_info_extra_evpn *
+bgp_path_info_evpn_get(struct bgp_path_info *pi)
+{
+	struct bgp_path_info_extra *e = bgp_path_info_extra_get(pi);
+
+	if (!e->evpn)
+		e->evpn = XCALLOC(MTYPE_BGP_ROUTE_EXTRA_EVPN,
+				  sizeof(struct bgp_path_info_extra_evpn));
+	return e->evpn;
+}
+
+struct bgp_path_info_extra_fs *
+bgp_path_info_flowspec_get(struct bgp_path_info *pi)
+{
+	struct bgp_path_info_extra *e = bgp_path_info_extra_get(pi);
+
+	if (!e->flowspec)
+		e->flowspec = XCALLOC(MTYPE_BGP_ROUTE_EXTRA_FS,
+				      sizeof(struct bgp_path_info_extra_fs));
+	return e->flowspec;
+}
+
+struct bgp_path_info_extra_vrfleak *
+bgp_path_info_vrfleak_get(struct bgp_path_info *pi)
+{
+	struct bgp_path_info_extra *e = bgp_path_info_extra_get(pi);
+
+	if (!e->vrfleak)
+		e->vrfleak =
+			XCALLOC(MTYPE_BGP_ROUTE_EXTRA_VRFLEAK,
+				sizeof(struct bgp_path_info_extra_vrfleak));
+	return e->vrfleak;
+}
+
 /* Free bgp route information. */
 void bgp_path_info_free_with_caller(const char *name,
 				    struct bgp_path_info *path)
@@ -276,7 +327,7 @@ void bgp_path_info_free_with_caller(const char *name,
 
 	peer_unlock(path->peer); /* bgp_path_info peer reference */
 
-	XFREE(MTYPE_BGP_ROUTE, path);
+	XSLAB_FREE(MSLAB_BGP_ROUTE, path);
 }
 
 struct bgp_path_info *bgp_path_info_lock(struct bgp_path_info *path)
@@ -380,10 +431,32 @@ static int bgp_dest_set_defer_flag(struct bgp_dest *dest, bool delete)
 	return -1;
 }
 
+/* Per-peer list the path belongs on, if any: paths in peer->bgp->rib,
+ * including the per-RD tables below it, but not in tables paths get
+ * imported into (VNI tables and the like) that stale marking ignores.
+ */
+static struct bgp_peer_paths_head *bgp_path_info_peer_paths(
+	struct bgp_dest *dest, struct bgp_path_info *pi)
+{
+	struct bgp_table *table = bgp_dest_table(dest);
+	struct bgp_table *rib;
+
+	if (!table || !pi->peer || pi->peer->bgp != table->bgp)
+		return NULL;
+
+	rib = table->bgp->rib[table->afi][table->safi];
+	if (table != rib &&
+	    (!dest->pdest || bgp_dest_table(dest->pdest) != rib))
+		return NULL;
+
+	return &pi->peer->paths[table->afi][table->safi];
+}
+
 void bgp_path_info_add_with_caller(const char *name, struct bgp_dest *dest,
 				   struct bgp_path_info *pi)
 {
 	frrtrace(3, frr_bgp, bgp_path_info_add, dest, pi, name);
+	struct bgp_peer_paths_head *head;
 	struct bgp_path_info *top;
 
 	top = bgp_dest_get_bgp_path_info(dest);
@@ -397,14 +470,42 @@ void bgp_path_info_add_with_caller(const char *name, struct bgp_dest *dest,
 	bgp_path_info_lock(pi);
 	bgp_dest_lock_node(dest);
 	peer_lock(pi->peer); /* bgp_path_info peer reference */
+
+	head = bgp_path_info_peer_paths(dest, pi);
+	if (head)
+		bgp_peer_paths_add_tail(head, pi);
+
 	bgp_dest_set_defer_flag(dest, false);
 	hook_call(bgp_snmp_update_stats, dest, pi, true);
 }
 
+/* pi stands in for its Adj-RIB-In entry or stops doing so, counted in
+ * peer->adj_in_shared for "show bgp memory"
+ */
+static void bgp_path_info_set_adj_in_shared(struct bgp_dest *dest,
+					    struct bgp_path_info *pi,
+					    bool shared)
+{
+	struct bgp_table *table = bgp_dest_table(dest);
+
+	if (shared == !!CHECK_FLAG(pi->flags, BGP_PATH_ADJ_IN_SHARED))
+		return;
+
+	if (shared) {
+		SET_FLAG(pi->flags, BGP_PATH_ADJ_IN_SHARED);
+		pi->peer->adj_in_shared[table->afi][table->safi]++;
+	} else {
+		UNSET_FLAG(pi->flags, BGP_PATH_ADJ_IN_SHARED);
+		pi->peer->adj_in_shared[table->afi][table->safi]--;
+	}
+}
+
 /* Do the actual removal of info from RIB, for use by bgp_process
    completion callback *only* */
 void bgp_path_info_reap(struct bgp_dest *dest, struct bgp_path_info *pi)
 {
+	bgp_path_info_set_adj_in_shared(dest, pi, false);
+
 	if (pi->next)
 		pi->next->prev = pi->prev;
 	if (pi->prev)
@@ -412,6 +513,9 @@ void bgp_path_info_reap(struct bgp_dest *dest, struct bgp_path_info *pi)
 	else
 		bgp_dest_set_bgp_path_info(dest, pi->next);
 
+	if (bgp_peer_paths_anywhere(pi))
+		bgp_peer_paths_del(bgp_path_info_peer_paths(dest, pi), pi);
+
 	bgp_path_info_mpath_dequeue(pi);
 	bgp_path_info_unlock(pi);
 	hook_call(bgp_snmp_update_stats, dest, pi, false);
@@ -547,8 +651,9 @@ struct bgp_path_info *bgp_get_imported_bpi_ultimate(struct bgp_path_info *info)
 		return info;
 
 	for (bpi_ultimate = info;
-	     bpi_ultimate->extra && bpi_ultimate->extra->parent;
-	     bpi_ultimate = bpi_ultimate->extra->parent)
+	     bpi_ultimate->extra && bpi_ultimate->extra->vrfleak &&
+	     bpi_ultimate->extra->vrfleak->parent;
+	     bpi_ultimate = bpi_ultimate->extra->vrfleak->parent)
 		;
 
 	return bpi_ultimate;
@@ -1698,10 +1803,14 @@ static bool bgp_check_role_applicability(afi_t afi, safi_t safi)
 	return ((afi == AFI_IP || afi == AFI_IP6) && safi == SAFI_UNICAST);
 }
 
+/* memo_key is the memo_id of the interned attribute attr is an unmodified
+ * copy of, 0 if there is none
+ */
 static int bgp_input_modifier(struct peer *peer, const struct prefix *p,
 			      struct attr *attr, afi_t afi, safi_t safi,
 			      const char *rmap_name, mpls_label_t *label,
-			      uint32_t num_labels, struct bgp_dest *dest)
+			      uint32_t num_labels, struct bgp_dest *dest,
+			      uint64_t memo_key)
 {
 	struct bgp_filter *filter;
 	struct bgp_path_info rmap_path = { 0 };
@@ -1746,7 +1855,8 @@ static int bgp_input_modifier(struct peer *peer, const struct prefix *p,
 		SET_FLAG(peer->rmap_type, PEER_RMAP_TYPE_IN);
 
 		/* Apply BGP route map to the attribute. */
-		ret = route_map_apply(rmap, p, &rmap_path);
+		ret = route_map_apply_memo(rmap, p, &rmap_path, &rmap_path,
+					   memo_key);
 
 		peer->rmap_type = 0;
 
@@ -1947,23 +2057,6 @@ void bgp_attr_add_gshut_community(struct attr *attr)
 }
 
 
-/* Notify BGP Conditional advertisement scanner process. */
-void bgp_notify_conditional_adv_scanner(struct update_subgroup *subgrp)
-{
-	struct peer *peer = SUBGRP_PEER(subgrp);
-	afi_t afi = SUBGRP_AFI(subgrp);
-	safi_t safi = SUBGRP_SAFI(subgrp);
-	struct bgp_filter *filter = &peer->filter[afi][safi];
-
-	if (!ADVERTISE_MAP_NAME(filter))
-		return;
-
-	if (!CHECK_FLAG(peer->flags, PEER_FLAG_CONFIG_NODE))
-		return;
-
-	peer->advmap_table_change = true;
-}
-
 
 void subgroup_announce_reset_nhop(uint8_t family, struct attr *attr)
 {
@@ -3011,6 +3104,9 @@ bool bgp_zebra_has_route_changed(struct bgp_path_info *selected)
 
 struct bgp_process_queue {
 	struct bgp *bgp;
+	/* all dests on pqueue belong to tables of this afi/safi */
+	afi_t afi;
+	safi_t safi;
 	STAILQ_HEAD(, bgp_dest) pqueue;
 #define BGP_PROCESS_QUEUE_EOIU_MARKER		(1 << 0)
 	unsigned int flags;
@@ -3213,6 +3309,9 @@ static void bgp_process_main_one(struct bgp *bgp, struct bgp_dest *dest,
 			__func__, dest, bgp->name_pretty, afi2str(afi),
 			safi2str(safi), old_select, new_select);
 
+	/* Condition maps look at all paths, not just the best one */
+	bgp_conditional_adv_dest_update(bgp, afi, safi, dest);
+
 	/* If best route remains the same and this is not due to user-initiated
 	 * clear, see exactly what needs to be done.
 	 */
@@ -3432,12 +3531,35 @@ void bgp_best_path_select_defer(struct bgp *bgp, afi_t afi, safi_t safi)
 			&bgp->gr_info[afi][safi].t_route_select);
 }
 
+/*
+ * Which peer caused the work isn't known once dests are batched up, so the
+ * time goes to the peer of the resulting best path.  Dests that end up
+ * without one (everything withdrawn) aren't charged to anyone.
+ */
+static void bgp_process_dest(struct bgp *bgp, struct bgp_dest *dest,
+			     afi_t afi, safi_t safi)
+{
+	struct bgp_path_info *pi;
+	uint64_t cpu_start = bgp_cpu_now();
+
+	bgp_process_main_one(bgp, dest, afi, safi);
+
+	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next)
+		if (CHECK_FLAG(pi->flags, BGP_PATH_SELECTED)) {
+			bgp_cpu_account(&pi->peer->cpu_stats[afi][safi]
+							    [BGP_CPU_BESTPATH],
+					cpu_start);
+			break;
+		}
+}
+
 static wq_item_status bgp_process_wq(struct work_queue *wq, void *data)
 {
 	struct bgp_process_queue *pqnode = data;
 	struct bgp *bgp = pqnode->bgp;
 	struct bgp_table *table;
 	struct bgp_dest *dest;
+	bool skip;
 
 	/* eoiu marker */
 	if (CHECK_FLAG(pqnode->flags, BGP_PROCESS_QUEUE_EOIU_MARKER)) {
@@ -3447,18 +3569,32 @@ static wq_item_status bgp_process_wq(struct work_queue *wq, void *data)
 		return WQ_SUCCESS;
 	}
 
+	/* The whole batch is for one afi/safi, so the instance wide checks
+	 * only need to be done once here rather than for every dest.
+	 */
+	skip = CHECK_FLAG(bgp->flags, BGP_FLAG_DELETE_IN_PROGRESS);
+
+	/* FIB changes of the whole batch go to zebra together; UPDATEs
+	 * for the update-groups are generated later from their own event
+	 * anyway, so those are already handled once per batch.
+	 */
+	bgp_zebra_batch_begin();
+
 	while (!STAILQ_EMPTY(&pqnode->pqueue)) {
 		dest = STAILQ_FIRST(&pqnode->pqueue);
 		STAILQ_REMOVE_HEAD(&pqnode->pqueue, pq);
 		STAILQ_NEXT(dest, pq) = NULL; /* complete unlink */
 		table = bgp_dest_table(dest);
 		/* note, new DESTs may be added as part of processing */
-		bgp_process_main_one(bgp, dest, table->afi, table->safi);
+		if (!skip)
+			bgp_process_dest(bgp, dest, pqnode->afi, pqnode->safi);
 
 		bgp_dest_unlock_node(dest);
 		bgp_table_unlock(table);
 	}
 
+	bgp_zebra_batch_end();
+
 	return WQ_SUCCESS;
 }
 
@@ -3486,6 +3622,7 @@ void bgp_process_queue_init(struct bgp *bgp)
 	bgp->process_queue->spec.hold = 50;
 	/* Use a higher yield value of 50ms for main queue processing */
 	bgp->process_queue->spec.yield = 50 * 1000L;
+	bgp->process_queue->spec.priority = WQ_PRIO_HIGH;
 }
 
 static struct bgp_process_queue *bgp_processq_alloc(struct bgp *bgp)
@@ -3504,9 +3641,9 @@ static struct bgp_process_queue *bgp_processq_alloc(struct bgp *bgp)
 
 void bgp_process(struct bgp *bgp, struct bgp_dest *dest, afi_t afi, safi_t safi)
 {
-#define ARBITRARY_PROCESS_QLEN		10000
 	struct work_queue *wq = bgp->process_queue;
 	struct bgp_process_queue *pqnode;
+	struct bgp_table *table;
 	int pqnode_reuse = 0;
 
 	/* already scheduled for processing? */
@@ -3534,23 +3671,30 @@ void bgp_process(struct bgp *bgp, struct bgp_dest *dest, afi_t afi, safi_t safi)
 	if (wq == NULL)
 		return;
 
+	table = bgp_dest_table(dest);
+
 	/* Add route nodes to an existing work queue item until reaching the
-	   limit only if is from the same BGP view and it's not an EOIU marker
+	   batch limit only if is from the same BGP view and afi/safi and it's
+	   not an EOIU marker
 	 */
 	if (work_queue_item_count(wq)) {
 		struct work_queue_item *item = work_queue_last_item(wq);
 		pqnode = item->data;
 
 		if (CHECK_FLAG(pqnode->flags, BGP_PROCESS_QUEUE_EOIU_MARKER)
-		    || pqnode->bgp != bgp
-		    || pqnode->queued >= ARBITRARY_PROCESS_QLEN)
+		    || pqnode->bgp != bgp || pqnode->afi != table->afi
+		    || pqnode->safi != table->safi
+		    || pqnode->queued >= bm->process_batch)
 			pqnode = bgp_processq_alloc(bgp);
 		else
 			pqnode_reuse = 1;
 	} else
 		pqnode = bgp_processq_alloc(bgp);
+
+	pqnode->afi = table->afi;
+	pqnode->safi = table->safi;
 	/* all unlocked in bgp_process_wq */
-	bgp_table_lock(bgp_dest_table(dest));
+	bgp_table_lock(table);
 
 	SET_FLAG(dest->flags, BGP_NODE_PROCESS_SCHEDULED);
 	bgp_dest_lock_node(dest);
@@ -3595,43 +3739,6 @@ static void bgp_maximum_prefix_restart_timer(struct event *thread)
 		zlog_debug("%s: %s peer_clear failed", __func__, peer->host);
 }
 
-static uint32_t bgp_filtered_routes_count(struct peer *peer, afi_t afi,
-					  safi_t safi)
-{
-	uint32_t count = 0;
-	bool filtered = false;
-	struct bgp_dest *dest;
-	struct bgp_adj_in *ain;
-	struct attr attr = {};
-	struct bgp_table *table = peer->bgp->rib[afi][safi];
-
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		for (ain = dest->adj_in; ain; ain = ain->next) {
-			const struct prefix *rn_p = bgp_dest_get_prefix(dest);
-
-			attr = *ain->attr;
-
-			if (bgp_input_filter(peer, rn_p, &attr, afi, safi)
-			    == FILTER_DENY)
-				filtered = true;
-
-			if (bgp_input_modifier(
-				    peer, rn_p, &attr, afi, safi,
-				    ROUTE_MAP_IN_NAME(&peer->filter[afi][safi]),
-				    NULL, 0, NULL)
-			    == RMAP_DENY)
-				filtered = true;
-
-			if (filtered)
-				count++;
-
-			bgp_attr_flush(&attr);
-		}
-	}
-
-	return count;
-}
-
 bool bgp_maximum_prefix_overflow(struct peer *peer, afi_t afi, safi_t safi,
 				 int always)
 {
@@ -3639,7 +3746,7 @@ bool bgp_maximum_prefix_overflow(struct peer *peer, afi_t afi, safi_t safi,
 	iana_safi_t pkt_safi;
 	uint32_t pcount = (CHECK_FLAG(peer->af_flags[afi][safi],
 				      PEER_FLAG_MAX_PREFIX_FORCE))
-				  ? bgp_filtered_routes_count(peer, afi, safi)
+				  ? peer->filtered_pcount[afi][safi]
 					    + peer->pcount[afi][safi]
 				  : peer->pcount[afi][safi];
 
@@ -3817,7 +3924,7 @@ struct bgp_path_info *info_make(int type, int sub_type, unsigned short instance,
 	struct bgp_path_info *new;
 
 	/* Make new BGP info. */
-	new = XCALLOC(MTYPE_BGP_ROUTE, sizeof(struct bgp_path_info));
+	new = XSLAB_CALLOC(MSLAB_BGP_ROUTE);
 	new->type = type;
 	new->instance = instance;
 	new->sub_type = sub_type;
@@ -3994,6 +4101,38 @@ static bool bgp_accept_own(struct peer *peer, afi_t afi, safi_t safi,
 	return false;
 }
 
+/* With "soft-reconfiguration inbound dedup", an Adj-RIB-In entry the
+ * inbound policy left alone is not kept: both would point to the same
+ * interned attr, so the path can be run through the policy again instead.
+ */
+static void bgp_adj_in_fold(struct peer *peer, afi_t afi, safi_t safi,
+			    struct bgp_dest *dest, struct bgp_path_info *pi,
+			    struct bgp_adj_in **ain)
+{
+	if (!*ain || (*ain)->filtered || (*ain)->attr != pi->attr)
+		return;
+	if (!CHECK_FLAG(peer->af_flags[afi][safi],
+			PEER_FLAG_SOFT_RECONFIG_DEDUP))
+		return;
+
+	bgp_adj_in_remove(dest, *ain);
+	*ain = NULL;
+	bgp_path_info_set_adj_in_shared(dest, pi, true);
+}
+
+static struct bgp_path_info *bgp_adj_in_shared_lookup(struct bgp_dest *dest,
+						      struct peer *peer,
+						      uint32_t addpath_id)
+{
+	struct bgp_path_info *pi;
+
+	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next)
+		if (pi->peer == peer && pi->addpath_rx_id == addpath_id &&
+		    bgp_path_adj_in_shared(pi))
+			return pi;
+	return NULL;
+}
+
 void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 		struct attr *attr, afi_t afi, safi_t safi, int type,
 		int sub_type, struct prefix_rd *prd, mpls_label_t *label,
@@ -4019,6 +4158,10 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 	safi_t orig_safi = safi;
 	bool leak_success = true;
 	int allowas_in = 0;
+	struct bgp_adj_in *ain = NULL;
+	struct bgp_cpu_stat *policy_stat;
+	uint64_t cpu_start;
+	bool deny;
 
 	if (frrtrace_enabled(frr_bgp, process_update)) {
 		char pfxprint[PREFIX2STR_BUFFER];
@@ -4027,6 +4170,8 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 		frrtrace(6, frr_bgp, process_update, peer, pfxprint, addpath_id,
 			 afi, safi, attr);
 	}
+	flightrec("bgp_update", (uintptr_t)peer, afi, safi, p->prefixlen,
+		  addpath_id);
 
 #ifdef ENABLE_BGP_VNC
 	int vnc_implicit_withdraw = 0;
@@ -4062,8 +4207,15 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 	   Adj-RIBs-In.  */
 	if (!soft_reconfig
 	    && CHECK_FLAG(peer->af_flags[afi][safi], PEER_FLAG_SOFT_RECONFIG)
+	    && !CHECK_FLAG(peer->af_sflags[afi][safi], PEER_STATUS_ADJ_IN_SHED)
 	    && peer != bgp->peer_self)
-		bgp_adj_in_set(dest, peer, attr, addpath_id);
+		ain = bgp_adj_in_set(dest, peer, attr, addpath_id);
+	else if (soft_reconfig)
+		ain = bgp_adj_in_lookup(dest, peer, addpath_id);
+
+	/* Accepted unless we end up below at filtered */
+	if (ain)
+		bgp_adj_in_set_filtered(ain, false);
 
 	/* Update permitted loop count */
 	if (CHECK_FLAG(peer->af_flags[afi][safi], PEER_FLAG_ALLOWAS_IN))
@@ -4076,6 +4228,15 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 		    && pi->addpath_rx_id == addpath_id)
 			break;
 
+	/* The path may be standing in for its Adj-RIB-In entry, but its attr
+	 * is about to be replaced: the entry has to be back for that.
+	 */
+	if (pi && CHECK_FLAG(pi->flags, BGP_PATH_ADJ_IN_SHARED)) {
+		bgp_path_info_set_adj_in_shared(dest, pi, false);
+		if (soft_reconfig && !ain)
+			ain = bgp_adj_in_set(dest, peer, attr, addpath_id);
+	}
+
 	/* AS path local-as loop check. */
 	if (peer->change_local_as) {
 		if (allowas_in)
@@ -4148,7 +4309,11 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 	}
 
 	/* Apply incoming filter.  */
-	if (bgp_input_filter(peer, p, attr, afi, orig_safi) == FILTER_DENY) {
+	policy_stat = &peer->cpu_stats[afi][orig_safi][BGP_CPU_POLICY_IN];
+	cpu_start = bgp_cpu_now();
+	deny = bgp_input_filter(peer, p, attr, afi, orig_safi) == FILTER_DENY;
+	bgp_cpu_account(policy_stat, cpu_start);
+	if (deny) {
 		peer->stat_pfx_filter++;
 		reason = "filter;";
 		goto filtered;
@@ -4198,9 +4363,16 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 	 * commands, so we need bgp_attr_flush in the error paths, until we
 	 * intern
 	 * the attr (which takes over the memory references) */
-	if (bgp_input_modifier(peer, p, &new_attr, afi, orig_safi, NULL, label,
-			       num_labels, dest)
-	    == RMAP_DENY) {
+	/* replayed Adj-RIB-In attributes are interned and shared between
+	 * prefixes and peers, the route-map outcome can be remembered
+	 */
+	cpu_start = bgp_cpu_now();
+	deny = bgp_input_modifier(peer, p, &new_attr, afi, orig_safi, NULL,
+				  label, num_labels, dest,
+				  soft_reconfig ? attr->memo_id : 0) ==
+	       RMAP_DENY;
+	bgp_cpu_account(policy_stat, cpu_start);
+	if (deny) {
 		peer->stat_pfx_filter++;
 		reason = "route-map;";
 		bgp_attr_flush(&new_attr);
@@ -4359,6 +4531,7 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 				}
 			}
 
+			bgp_adj_in_fold(peer, afi, safi, dest, pi, &ain);
 			bgp_dest_unlock_node(dest);
 			bgp_attr_unintern(&attr_new);
 
@@ -4597,8 +4770,9 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 
 			struct bgp *bgp_nexthop = bgp;
 
-			if (pi->extra && pi->extra->bgp_orig)
-				bgp_nexthop = pi->extra->bgp_orig;
+			if (pi->extra && pi->extra->vrfleak &&
+			    pi->extra->vrfleak->bgp_orig)
+				bgp_nexthop = pi->extra->vrfleak->bgp_orig;
 
 			nh_afi = BGP_ATTR_NH_AFI(afi, pi->attr);
 
@@ -4694,7 +4868,8 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 		    !leak_success) {
 			bgp_unlink_nexthop(pi);
 			bgp_path_info_delete(dest, pi);
-		}
+		} else
+			bgp_adj_in_fold(peer, afi, safi, dest, pi, &ain);
 		return;
 	} // End of implicit withdraw
 
@@ -4856,18 +5031,22 @@ void bgp_update(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 	    !leak_success) {
 		bgp_unlink_nexthop(new);
 		bgp_path_info_delete(dest, new);
-	}
+	} else
+		bgp_adj_in_fold(peer, afi, safi, dest, new, &ain);
 
 	return;
 
 /* This BGP update is filtered.  Log the reason then update BGP
    entry.  */
 filtered:
+	if (ain)
+		bgp_adj_in_set_filtered(ain, true);
+
 	if (new) {
 		bgp_unlink_nexthop(new);
 		bgp_path_info_delete(dest, new);
 		bgp_path_info_extra_free(&new->extra);
-		XFREE(MTYPE_BGP_ROUTE, new);
+		XSLAB_FREE(MSLAB_BGP_ROUTE, new);
 	}
 
 	hook_call(bgp_process, bgp, afi, safi, dest, peer, true);
@@ -4958,8 +5137,12 @@ void bgp_withdraw(struct peer *peer, const struct prefix *p,
 	 * if there was no entry, we don't need to do anything more.
 	 */
 	if (CHECK_FLAG(peer->af_flags[afi][safi], PEER_FLAG_SOFT_RECONFIG)
-	    && peer != bgp->peer_self)
-		if (!bgp_adj_in_unset(dest, peer, addpath_id)) {
+	    && !CHECK_FLAG(peer->af_sflags[afi][safi], PEER_STATUS_ADJ_IN_SHED)
+	    && peer != bgp->peer_self) {
+		pi = bgp_adj_in_shared_lookup(dest, peer, addpath_id);
+		if (pi)
+			bgp_path_info_set_adj_in_shared(dest, pi, false);
+		else if (!bgp_adj_in_unset(dest, peer, addpath_id)) {
 			peer->stat_pfx_dup_withdraw++;
 
 			if (bgp_debug_update(peer, p, NULL, 1)) {
@@ -4974,6 +5157,7 @@ void bgp_withdraw(struct peer *peer, const struct prefix *p,
 			bgp_dest_unlock_node(dest);
 			return;
 		}
+	}
 
 	/* Lookup withdrawn route. */
 	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next)
@@ -5061,6 +5245,7 @@ static void bgp_announce_route_timer_expired(struct event *t)
 
 	/* Notify BGP conditional advertisement scanner percess */
 	peer->advmap_config_change[paf->afi][paf->safi] = true;
+	bgp_conditional_adv_schedule(peer->bgp);
 }
 
 /*
@@ -5123,32 +5308,39 @@ void bgp_announce_route_all(struct peer *peer)
 }
 
 /* Flag or unflag bgp_dest to determine whether it should be treated by
- * bgp_soft_reconfig_table_task.
+ * bgp_soft_reconfig_table_walk.
  * Flag if flag is true. Unflag if flag is false.
  */
 static void bgp_soft_reconfig_table_flag(struct bgp_table *table, bool flag)
 {
 	struct bgp_dest *dest;
-	struct bgp_adj_in *ain;
+	struct bgp_adj_in_iter iter;
 
 	if (!table)
 		return;
 
+	/* any run in progress starts back at the beginning */
+	route_table_walk_cancel(&table->soft_reconfig_walk);
+
+	table->soft_reconfig_total = 0;
+	table->soft_reconfig_done = 0;
+	table->soft_reconfig_updates = 0;
+	table->soft_reconfig_start = monotime(NULL);
+
 	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		for (ain = dest->adj_in; ain; ain = ain->next) {
-			if (ain->peer != NULL)
-				break;
-		}
-		if (flag && ain != NULL && ain->peer != NULL)
+		memset(&iter, 0, sizeof(iter));
+		if (flag && bgp_adj_in_iter_next(dest, NULL, &iter)) {
 			SET_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG);
-		else
+			table->soft_reconfig_total++;
+		} else
 			UNSET_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG);
 	}
 }
 
 static void bgp_soft_reconfig_table_update(struct peer *peer,
 					   struct bgp_dest *dest,
-					   struct bgp_adj_in *ain, afi_t afi,
+					   uint32_t addpath_id,
+					   struct attr *attr, afi_t afi,
 					   safi_t safi, struct prefix_rd *prd)
 {
 	struct bgp_path_info *pi;
@@ -5170,9 +5362,52 @@ static void bgp_soft_reconfig_table_update(struct peer *peer,
 	else
 		memset(&evpn, 0, sizeof(evpn));
 
-	bgp_update(peer, bgp_dest_get_prefix(dest), ain->addpath_rx_id,
-		   ain->attr, afi, safi, ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, prd,
-		   label_pnt, num_labels, 1, &evpn);
+	bgp_update(peer, bgp_dest_get_prefix(dest), addpath_id, attr, afi, safi,
+		   ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, prd, label_pnt, num_labels,
+		   1, &evpn);
+}
+
+/* Run what peer, or every peer if NULL, sent for dest through the inbound
+ * policy again.  bgp_update() may drop the Adj-RIB-In entry it is handed or
+ * bring one back for a path that stood in for it (bgp_adj_in_fold()).  The
+ * latter are added in front of the entries already there, so the paths
+ * are done first and nothing is visited twice.
+ */
+unsigned int bgp_soft_reconfig_dest(struct peer *peer, struct bgp_dest *dest,
+				    afi_t afi, safi_t safi,
+				    struct prefix_rd *prd)
+{
+	struct bgp_adj_in *ain, *ain_next;
+	struct bgp_path_info *pi, *pi_next;
+	unsigned int updates = 0;
+
+	ain = dest->adj_in;
+
+	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi_next) {
+		pi_next = pi->next;
+
+		if (!bgp_path_adj_in_shared(pi) || (peer && pi->peer != peer))
+			continue;
+
+		bgp_soft_reconfig_table_update(pi->peer, dest,
+					       pi->addpath_rx_id, pi->attr,
+					       afi, safi, prd);
+		updates++;
+	}
+
+	for (; ain; ain = ain_next) {
+		ain_next = ain->next;
+
+		if (!ain->peer || (peer && ain->peer != peer))
+			continue;
+
+		bgp_soft_reconfig_table_update(ain->peer, dest,
+					       ain->addpath_rx_id, ain->attr,
+					       afi, safi, prd);
+		updates++;
+	}
+
+	return updates;
 }
 
 static void bgp_soft_reconfig_table(struct peer *peer, afi_t afi, safi_t safi,
@@ -5180,84 +5415,52 @@ static void bgp_soft_reconfig_table(struct peer *peer, afi_t afi, safi_t safi,
 				    struct prefix_rd *prd)
 {
 	struct bgp_dest *dest;
-	struct bgp_adj_in *ain;
 
 	if (!table)
 		table = peer->bgp->rib[afi][safi];
 
 	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest))
-		for (ain = dest->adj_in; ain; ain = ain->next) {
-			if (ain->peer != peer)
-				continue;
-
-			bgp_soft_reconfig_table_update(peer, dest, ain, afi,
-						       safi, prd);
-		}
+		bgp_soft_reconfig_dest(peer, dest, afi, safi, prd);
 }
 
 /* Do soft reconfig table per bgp table.
- * Walk on SOFT_RECONFIG_TASK_MAX_PREFIX bgp_dest,
+ * Called from the background walk over the table for each bgp_dest,
  * when BGP_NODE_SOFT_RECONFIG is set,
  * reconfig bgp_dest for list of table->soft_reconfig_peers peers.
- * Schedule a new thread to continue the job.
+ * The walk yields whenever its time slot is used up.
  * Without splitting the full job into several part,
  * vtysh waits for the job to finish before responding to a BGP command
  */
-static void bgp_soft_reconfig_table_task(struct event *thread)
+static bool bgp_soft_reconfig_table_walk(struct route_node *rn, void *arg)
 {
-	uint32_t iter, max_iter;
-	struct bgp_dest *dest;
-	struct bgp_adj_in *ain;
+	struct bgp_dest *dest = bgp_dest_from_rnode(rn);
+	struct bgp_table *table = arg;
 	struct peer *peer;
-	struct bgp_table *table;
-	struct prefix_rd *prd;
 	struct listnode *node, *nnode;
 
-	table = EVENT_ARG(thread);
-	prd = NULL;
-
-	max_iter = SOFT_RECONFIG_TASK_MAX_PREFIX;
-	if (table->soft_reconfig_init) {
-		/* first call of the function with a new srta structure.
-		 * Don't do any treatment this time on nodes
-		 * in order vtysh to respond quickly
-		 */
-		max_iter = 0;
-	}
+	if (!CHECK_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG))
+		return true;
 
-	for (iter = 0, dest = bgp_table_top(table); (dest && iter < max_iter);
-	     dest = bgp_route_next(dest)) {
-		if (!CHECK_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG))
-			continue;
+	UNSET_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG);
+	table->soft_reconfig_done++;
 
-		UNSET_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG);
+	for (ALL_LIST_ELEMENTS(table->soft_reconfig_peers, node, nnode, peer))
+		table->soft_reconfig_updates +=
+			bgp_soft_reconfig_dest(peer, dest, table->afi,
+					       table->safi, NULL);
 
-		for (ain = dest->adj_in; ain; ain = ain->next) {
-			for (ALL_LIST_ELEMENTS(table->soft_reconfig_peers, node,
-					       nnode, peer)) {
-				if (ain->peer != peer)
-					continue;
+	return true;
+}
 
-				bgp_soft_reconfig_table_update(
-					peer, dest, ain, table->afi,
-					table->safi, prd);
-				iter++;
-			}
-		}
-	}
+/* we're done, clean up the background iteration context info and
+ * schedule route annoucement
+ */
+static void bgp_soft_reconfig_table_done(void *arg)
+{
+	struct bgp_table *table = arg;
+	struct peer *peer;
+	struct listnode *node, *nnode;
 
-	/* we're either starting the initial iteration,
-	 * or we're going to continue an ongoing iteration
-	 */
-	if (dest || table->soft_reconfig_init) {
-		table->soft_reconfig_init = false;
-		event_add_event(bm->master, bgp_soft_reconfig_table_task, table,
-				0, &table->soft_reconfig_thread);
-		return;
-	}
-	/* we're done, clean up the background iteration context info and
-	schedule route annoucement
-	*/
 	for (ALL_LIST_ELEMENTS(table->soft_reconfig_peers, node, nnode, peer)) {
 		listnode_delete(table->soft_reconfig_peers, peer);
 		bgp_announce_route(peer, table->afi, table->safi, false);
@@ -5307,10 +5510,86 @@ void bgp_soft_reconfig_table_task_cancel(const struct bgp *bgp,
 
 		list_delete(&ntable->soft_reconfig_peers);
 		bgp_soft_reconfig_table_flag(ntable, false);
-		EVENT_OFF(ntable->soft_reconfig_thread);
 	}
 }
 
+/* "show bgp soft-reconfig progress": running soft_reconfig_table tasks */
+void bgp_soft_reconfig_progress_show(struct vty *vty, json_object *json)
+{
+	struct listnode *node, *pnode;
+	struct bgp *bgp;
+	struct bgp_table *table;
+	struct peer *peer;
+	json_object *json_runs = NULL;
+	json_object *json_run;
+	json_object *json_peers;
+	time_t now = monotime(NULL);
+	unsigned int count = 0;
+	int afi, safi;
+
+	if (json)
+		json_runs = json_object_new_array();
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
+		FOREACH_AFI_SAFI (afi, safi) {
+			table = bgp->rib[afi][safi];
+			if (!table || !table->soft_reconfig_peers)
+				continue;
+
+			count++;
+			if (json) {
+				json_run = json_object_new_object();
+				json_peers = json_object_new_array();
+				json_object_string_add(json_run, "vrf",
+						       bgp->name_pretty);
+				json_object_string_add(json_run, "afiSafi",
+						       get_afi_safi_str(afi,
+									safi,
+									true));
+				json_object_int_add(json_run, "prefixesTotal",
+						    table->soft_reconfig_total);
+				json_object_int_add(json_run, "prefixesDone",
+						    table->soft_reconfig_done);
+				json_object_int_add(json_run, "updates",
+						    table->soft_reconfig_updates);
+				json_object_int_add(json_run, "elapsedSecs",
+						    now - table->soft_reconfig_start);
+				for (ALL_LIST_ELEMENTS_RO(table->soft_reconfig_peers,
+							  pnode, peer))
+					json_object_array_add(
+						json_peers,
+						json_object_new_string(
+							peer->host));
+				json_object_object_add(json_run, "peers",
+						       json_peers);
+				json_object_array_add(json_runs, json_run);
+				continue;
+			}
+
+			vty_out(vty,
+				"%s %s: %" PRIu64 "/%" PRIu64
+				" prefixes, %" PRIu64
+				" updates, running for %llds\n",
+				bgp->name_pretty,
+				get_afi_safi_str(afi, safi, false),
+				table->soft_reconfig_done,
+				table->soft_reconfig_total,
+				table->soft_reconfig_updates,
+				(long long)(now - table->soft_reconfig_start));
+			vty_out(vty, "  Peers:");
+			for (ALL_LIST_ELEMENTS_RO(table->soft_reconfig_peers,
+						  pnode, peer))
+				vty_out(vty, " %s", peer->host);
+			vty_out(vty, "\n");
+		}
+	}
+
+	if (json)
+		json_object_object_add(json, "softReconfigRuns", json_runs);
+	else if (!count)
+		vty_out(vty, "No inbound soft reconfiguration in progress\n");
+}
+
 /*
  * Returns false if the peer is not configured for soft reconfig in
  */
@@ -5322,7 +5601,8 @@ bool bgp_soft_reconfig_in(struct peer *peer, afi_t afi, safi_t safi)
 	struct peer *npeer;
 	struct peer_af *paf;
 
-	if (!CHECK_FLAG(peer->af_flags[afi][safi], PEER_FLAG_SOFT_RECONFIG))
+	if (!CHECK_FLAG(peer->af_flags[afi][safi], PEER_FLAG_SOFT_RECONFIG) ||
+	    CHECK_FLAG(peer->af_sflags[afi][safi], PEER_STATUS_ADJ_IN_SHED))
 		return false;
 
 	if ((safi != SAFI_MPLS_VPN) && (safi != SAFI_ENCAP)
@@ -5331,8 +5611,6 @@ bool bgp_soft_reconfig_in(struct peer *peer, afi_t afi, safi_t safi)
 		if (!table)
 			return true;
 
-		table->soft_reconfig_init = true;
-
 		if (!table->soft_reconfig_peers)
 			table->soft_reconfig_peers = list_new();
 		npeer = NULL;
@@ -5352,10 +5630,10 @@ bool bgp_soft_reconfig_in(struct peer *peer, afi_t afi, safi_t safi)
 		 */
 		bgp_soft_reconfig_table_flag(table, true);
 
-		if (!table->soft_reconfig_thread)
-			event_add_event(bm->master,
-					bgp_soft_reconfig_table_task, table, 0,
-					&table->soft_reconfig_thread);
+		route_table_walk_start(&table->soft_reconfig_walk, bm->master,
+				       table->route_table,
+				       bgp_soft_reconfig_table_walk,
+				       bgp_soft_reconfig_table_done, table);
 		/* Cancel bgp_announce_route_timer_expired threads.
 		 * bgp_announce_route_timer_expired threads have been scheduled
 		 * to announce routes as soon as the soft_reconfigure process
@@ -5485,108 +5763,43 @@ static void bgp_clear_node_queue_init(struct peer *peer)
 	peer->clear_node_queue->spec.del_item_data = &bgp_clear_node_queue_del;
 	peer->clear_node_queue->spec.completion_func = &bgp_clear_node_complete;
 	peer->clear_node_queue->spec.max_retries = 0;
+	/* best path selection for the remaining peers goes first */
+	peer->clear_node_queue->spec.priority = WQ_PRIO_LOW;
 
 	/* we only 'lock' this peer reference when the queue is actually active
 	 */
 	peer->clear_node_queue->spec.data = peer;
 }
 
-static void bgp_clear_route_table(struct peer *peer, afi_t afi, safi_t safi,
-				  struct bgp_table *table)
+/* Only the first of the peer's paths on a dest gets it queued, the queue
+ * handler takes care of all of them (there can be several with AddPath).
+ */
+static bool bgp_clear_route_first_path(struct bgp_dest *dest,
+				       struct bgp_path_info *pi)
 {
-	struct bgp_dest *dest;
-	int force = peer->bgp->process_queue ? 0 : 1;
+	struct bgp_path_info *first;
 
-	if (!table)
-		table = peer->bgp->rib[afi][safi];
-
-	/* If still no table => afi/safi isn't configured at all or smth. */
-	if (!table)
-		return;
-
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		struct bgp_path_info *pi, *next;
-		struct bgp_adj_in *ain;
-		struct bgp_adj_in *ain_next;
-
-		/* XXX:TODO: This is suboptimal, every non-empty route_node is
-		 * queued for every clearing peer, regardless of whether it is
-		 * relevant to the peer at hand.
-		 *
-		 * Overview: There are 3 different indices which need to be
-		 * scrubbed, potentially, when a peer is removed:
-		 *
-		 * 1 peer's routes visible via the RIB (ie accepted routes)
-		 * 2 peer's routes visible by the (optional) peer's adj-in index
-		 * 3 other routes visible by the peer's adj-out index
-		 *
-		 * 3 there is no hurry in scrubbing, once the struct peer is
-		 * removed from bgp->peer, we could just GC such deleted peer's
-		 * adj-outs at our leisure.
-		 *
-		 * 1 and 2 must be 'scrubbed' in some way, at least made
-		 * invisible via RIB index before peer session is allowed to be
-		 * brought back up. So one needs to know when such a 'search' is
-		 * complete.
-		 *
-		 * Ideally:
-		 *
-		 * - there'd be a single global queue or a single RIB walker
-		 * - rather than tracking which route_nodes still need to be
-		 *   examined on a peer basis, we'd track which peers still
-		 *   aren't cleared
-		 *
-		 * Given that our per-peer prefix-counts now should be reliable,
-		 * this may actually be achievable. It doesn't seem to be a huge
-		 * problem at this time,
-		 *
-		 * It is possible that we have multiple paths for a prefix from
-		 * a peer
-		 * if that peer is using AddPath.
-		 */
-		ain = dest->adj_in;
-		while (ain) {
-			ain_next = ain->next;
-
-			if (ain->peer == peer)
-				bgp_adj_in_remove(dest, ain);
-
-			ain = ain_next;
-		}
-
-		for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = next) {
-			next = pi->next;
-			if (pi->peer != peer)
-				continue;
+	for (first = bgp_dest_get_bgp_path_info(dest); first;
+	     first = first->next)
+		if (first->peer == pi->peer)
+			break;
 
-			if (force)
-				bgp_path_info_reap(dest, pi);
-			else {
-				struct bgp_clear_node_queue *cnq;
-
-				/* both unlocked in bgp_clear_node_queue_del */
-				bgp_table_lock(bgp_dest_table(dest));
-				bgp_dest_lock_node(dest);
-				cnq = XCALLOC(
-					MTYPE_BGP_CLEAR_NODE_QUEUE,
-					sizeof(struct bgp_clear_node_queue));
-				cnq->dest = dest;
-				work_queue_add(peer->clear_node_queue, cnq);
-				break;
-			}
-		}
-	}
-	return;
+	return first == pi;
 }
 
 void bgp_clear_route(struct peer *peer, afi_t afi, safi_t safi)
 {
+	struct bgp_path_info *pi;
+	struct bgp_adj_in *ain;
 	struct bgp_dest *dest;
-	struct bgp_table *table;
+	int force = peer->bgp->process_queue ? 0 : 1;
 
 	if (peer->clear_node_queue == NULL)
 		bgp_clear_node_queue_init(peer);
 
+	/* stale paths, snapshot ones included, go away with the session */
+	peer->snapshot_stale[afi][safi] = false;
+
 	/* bgp_fsm.c keeps sessions in state Clearing, not transitioning to
 	 * Idle until it receives a Clearing_Completed event. This protects
 	 * against peers which flap faster than we can we clear, which could
@@ -5607,17 +5820,37 @@ void bgp_clear_route(struct peer *peer, afi_t afi, safi_t safi)
 	if (!peer->clear_node_queue->thread)
 		peer_lock(peer);
 
-	if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP && safi != SAFI_EVPN)
-		bgp_clear_route_table(peer, afi, safi, NULL);
-	else
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			table = bgp_dest_get_bgp_table_info(dest);
-			if (!table)
-				continue;
+	/* There are 3 different indices which need to be scrubbed when a peer
+	 * is removed:
+	 *
+	 * 1 peer's routes visible via the RIB (ie accepted routes)
+	 * 2 peer's routes visible by the (optional) peer's adj-in index
+	 * 3 other routes visible by the peer's adj-out index
+	 *
+	 * 1 and 2 are found through the peer's own lists, which also cover
+	 * the per-RD tables, so this is O(peer's routes) rather than a walk
+	 * of the whole table.  3 is left to the update groups.
+	 */
+	frr_each_safe (bgp_peer_adj_in, &peer->adj_in[afi][safi], ain)
+		bgp_adj_in_remove(ain->dest, ain);
+
+	frr_each_safe (bgp_peer_paths, &peer->paths[afi][safi], pi) {
+		dest = pi->net;
 
-			bgp_clear_route_table(peer, afi, safi, table);
+		if (force)
+			bgp_path_info_reap(dest, pi);
+		else if (bgp_clear_route_first_path(dest, pi)) {
+			struct bgp_clear_node_queue *cnq;
+
+			/* both unlocked in bgp_clear_node_queue_del */
+			bgp_table_lock(bgp_dest_table(dest));
+			bgp_dest_lock_node(dest);
+			cnq = XCALLOC(MTYPE_BGP_CLEAR_NODE_QUEUE,
+				      sizeof(struct bgp_clear_node_queue));
+			cnq->dest = dest;
+			work_queue_add(peer->clear_node_queue, cnq);
 		}
+	}
 
 	/* unlock if no nodes got added to the clear-node-queue. */
 	if (!peer->clear_node_queue->thread)
@@ -5639,28 +5872,50 @@ void bgp_clear_route_all(struct peer *peer)
 
 void bgp_clear_adj_in(struct peer *peer, afi_t afi, safi_t safi)
 {
-	struct bgp_table *table;
-	struct bgp_dest *dest;
 	struct bgp_adj_in *ain;
-	struct bgp_adj_in *ain_next;
+	struct bgp_path_info *pi;
 
-	table = peer->bgp->rib[afi][safi];
+	frr_each_safe (bgp_peer_adj_in, &peer->adj_in[afi][safi], ain)
+		bgp_adj_in_remove(ain->dest, ain);
 
-	/* It is possible that we have multiple paths for a prefix from a peer
-	 * if that peer is using AddPath.
-	 */
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		ain = dest->adj_in;
+	/* paths standing in for an entry don't anymore */
+	if (peer->adj_in_shared[afi][safi])
+		frr_each (bgp_peer_paths, &peer->paths[afi][safi], pi)
+			bgp_path_info_set_adj_in_shared(pi->net, pi, false);
+}
 
-		while (ain) {
-			ain_next = ain->next;
+/*
+ * Under hard memory pressure, drop the copy of everything received that is
+ * kept for inbound soft reconfiguration, if the peer can be asked for a
+ * route refresh instead.  Until bgp_adj_in_unshed(), nothing is stored and
+ * inbound policy changes fall back to route refresh.
+ */
+bool bgp_adj_in_shed(struct peer *peer, afi_t afi, safi_t safi)
+{
+	if (!CHECK_FLAG(peer->af_flags[afi][safi], PEER_FLAG_SOFT_RECONFIG) ||
+	    CHECK_FLAG(peer->af_sflags[afi][safi], PEER_STATUS_ADJ_IN_SHED))
+		return false;
+	if (!peer_established(peer) || !peer->afc_nego[afi][safi])
+		return false;
+	if (!CHECK_FLAG(peer->cap, PEER_CAP_REFRESH_OLD_RCV) &&
+	    !CHECK_FLAG(peer->cap, PEER_CAP_REFRESH_NEW_RCV))
+		return false;
 
-			if (ain->peer == peer)
-				bgp_adj_in_remove(dest, ain);
+	SET_FLAG(peer->af_sflags[afi][safi], PEER_STATUS_ADJ_IN_SHED);
+	bgp_clear_adj_in(peer, afi, safi);
+	return true;
+}
 
-			ain = ain_next;
-		}
-	}
+/* Start storing the Adj-RIB-In again and refill it with a route refresh */
+void bgp_adj_in_unshed(struct peer *peer, afi_t afi, safi_t safi)
+{
+	if (!CHECK_FLAG(peer->af_sflags[afi][safi], PEER_STATUS_ADJ_IN_SHED))
+		return;
+
+	UNSET_FLAG(peer->af_sflags[afi][safi], PEER_STATUS_ADJ_IN_SHED);
+	if (peer_established(peer))
+		bgp_route_refresh_send(peer, afi, safi, 0, 0, 0,
+				       BGP_ROUTE_REFRESH_NORMAL);
 }
 
 /* If any of the routes from the peer have been marked with the NO_LLGR
@@ -5670,158 +5925,127 @@ void bgp_clear_adj_in(struct peer *peer, afi_t afi, safi_t safi)
  */
 void bgp_clear_stale_route(struct peer *peer, afi_t afi, safi_t safi)
 {
-	struct bgp_dest *dest;
 	struct bgp_path_info *pi;
-	struct bgp_table *table;
+	struct bgp_dest *dest;
 
-	if (safi == SAFI_MPLS_VPN || safi == SAFI_ENCAP || safi == SAFI_EVPN) {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			struct bgp_dest *rm;
+	frr_each_safe (bgp_peer_paths, &peer->paths[afi][safi], pi) {
+		dest = pi->net;
 
-			/* look for neighbor in tables */
-			table = bgp_dest_get_bgp_table_info(dest);
-			if (!table)
-				continue;
-
-			for (rm = bgp_table_top(table); rm;
-			     rm = bgp_route_next(rm))
-				for (pi = bgp_dest_get_bgp_path_info(rm); pi;
-				     pi = pi->next) {
-					if (pi->peer != peer)
-						continue;
-					if (CHECK_FLAG(
-						    peer->af_sflags[afi][safi],
-						    PEER_STATUS_LLGR_WAIT) &&
-					    bgp_attr_get_community(pi->attr) &&
-					    !community_include(
-						    bgp_attr_get_community(
-							    pi->attr),
-						    COMMUNITY_NO_LLGR))
-						continue;
-					if (!CHECK_FLAG(pi->flags,
-							BGP_PATH_STALE))
-						continue;
+		if (CHECK_FLAG(peer->af_sflags[afi][safi],
+			       PEER_STATUS_LLGR_WAIT) &&
+		    bgp_attr_get_community(pi->attr) &&
+		    !community_include(bgp_attr_get_community(pi->attr),
+				       COMMUNITY_NO_LLGR))
+			continue;
+		if (!CHECK_FLAG(pi->flags, BGP_PATH_STALE) ||
+		    CHECK_FLAG(pi->flags, BGP_PATH_REMOVED))
+			continue;
 
-					/*
-					 * If this is VRF leaked route
-					 * process for withdraw.
-					 */
-					if (pi->sub_type ==
-						    BGP_ROUTE_IMPORTED &&
-					    peer->bgp->inst_type ==
-						    BGP_INSTANCE_TYPE_DEFAULT)
-						vpn_leak_to_vrf_withdraw(pi);
+		if (safi == SAFI_MPLS_VPN || safi == SAFI_ENCAP ||
+		    safi == SAFI_EVPN) {
+			/* If this is VRF leaked route process for withdraw. */
+			if (pi->sub_type == BGP_ROUTE_IMPORTED &&
+			    peer->bgp->inst_type == BGP_INSTANCE_TYPE_DEFAULT)
+				vpn_leak_to_vrf_withdraw(pi);
+		} else if (safi == SAFI_UNICAST &&
+			   (peer->bgp->inst_type == BGP_INSTANCE_TYPE_VRF ||
+			    peer->bgp->inst_type == BGP_INSTANCE_TYPE_DEFAULT))
+			vpn_leak_from_vrf_withdraw(bgp_get_default(), peer->bgp,
+						   pi);
 
-					bgp_rib_remove(rm, pi, peer, afi, safi);
-					break;
-				}
-		}
-	} else {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest))
-			for (pi = bgp_dest_get_bgp_path_info(dest); pi;
-			     pi = pi->next) {
-				if (pi->peer != peer)
-					continue;
-				if (CHECK_FLAG(peer->af_sflags[afi][safi],
-					       PEER_STATUS_LLGR_WAIT) &&
-				    bgp_attr_get_community(pi->attr) &&
-				    !community_include(
-					    bgp_attr_get_community(pi->attr),
-					    COMMUNITY_NO_LLGR))
-					continue;
-				if (!CHECK_FLAG(pi->flags, BGP_PATH_STALE))
-					continue;
-				if (safi == SAFI_UNICAST &&
-				    (peer->bgp->inst_type ==
-					     BGP_INSTANCE_TYPE_VRF ||
-				     peer->bgp->inst_type ==
-					     BGP_INSTANCE_TYPE_DEFAULT))
-					vpn_leak_from_vrf_withdraw(
-						bgp_get_default(), peer->bgp,
-						pi);
-
-				bgp_rib_remove(dest, pi, peer, afi, safi);
-				break;
-			}
+		bgp_rib_remove(dest, pi, peer, afi, safi);
 	}
 }
 
 void bgp_set_stale_route(struct peer *peer, afi_t afi, safi_t safi)
 {
-	struct bgp_dest *dest, *ndest;
 	struct bgp_path_info *pi;
-	struct bgp_table *table;
+	struct bgp_dest *dest;
 
-	if (safi == SAFI_MPLS_VPN || safi == SAFI_ENCAP || safi == SAFI_EVPN) {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			table = bgp_dest_get_bgp_table_info(dest);
-			if (!table)
-				continue;
+	if (!CHECK_FLAG(peer->af_sflags[afi][safi],
+			PEER_STATUS_ENHANCED_REFRESH))
+		return;
 
-			for (ndest = bgp_table_top(table); ndest;
-			     ndest = bgp_route_next(ndest)) {
-				for (pi = bgp_dest_get_bgp_path_info(ndest); pi;
-				     pi = pi->next) {
-					if (pi->peer != peer)
-						continue;
+	frr_each (bgp_peer_paths, &peer->paths[afi][safi], pi) {
+		dest = pi->net;
 
-					if ((CHECK_FLAG(
-						    peer->af_sflags[afi][safi],
-						    PEER_STATUS_ENHANCED_REFRESH))
-					    && !CHECK_FLAG(pi->flags,
-							   BGP_PATH_STALE)
-					    && !CHECK_FLAG(
-						       pi->flags,
-						       BGP_PATH_UNUSEABLE)) {
-						if (bgp_debug_neighbor_events(
-							    peer))
-							zlog_debug(
-								"%pBP route-refresh for %s/%s, marking prefix %pFX as stale",
-								peer,
-								afi2str(afi),
-								safi2str(safi),
-								bgp_dest_get_prefix(
-									ndest));
-
-						bgp_path_info_set_flag(
-							ndest, pi,
-							BGP_PATH_STALE);
-					}
-				}
-			}
-		}
-	} else {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			for (pi = bgp_dest_get_bgp_path_info(dest); pi;
-			     pi = pi->next) {
-				if (pi->peer != peer)
-					continue;
+		if (CHECK_FLAG(pi->flags, BGP_PATH_STALE) ||
+		    CHECK_FLAG(pi->flags, BGP_PATH_UNUSEABLE))
+			continue;
 
-				if ((CHECK_FLAG(peer->af_sflags[afi][safi],
-						PEER_STATUS_ENHANCED_REFRESH))
-				    && !CHECK_FLAG(pi->flags, BGP_PATH_STALE)
-				    && !CHECK_FLAG(pi->flags,
-						   BGP_PATH_UNUSEABLE)) {
-					if (bgp_debug_neighbor_events(peer))
-						zlog_debug(
-							"%pBP route-refresh for %s/%s, marking prefix %pFX as stale",
-							peer, afi2str(afi),
-							safi2str(safi),
-							bgp_dest_get_prefix(
-								dest));
+		if (bgp_debug_neighbor_events(peer))
+			zlog_debug("%pBP route-refresh for %s/%s, marking prefix %pFX as stale",
+				   peer, afi2str(afi), safi2str(safi),
+				   bgp_dest_get_prefix(dest));
 
-					bgp_path_info_set_flag(dest, pi,
-							       BGP_PATH_STALE);
-				}
-			}
-		}
+		bgp_path_info_set_flag(dest, pi, BGP_PATH_STALE);
 	}
 }
 
+/*
+ * Install a path read back from a RIB snapshot (bgp_snapshot.c).  attr is
+ * the interned post-policy attribute, so no policy is applied here.  The
+ * path is stale until the peer sends it again; whatever is left when the
+ * peer's End-of-RIB arrives is removed by bgp_clear_stale_route().
+ */
+void bgp_restore_stale_route(struct peer *peer, const struct prefix *p,
+			     uint32_t addpath_id, struct attr *attr, afi_t afi,
+			     safi_t safi)
+{
+	struct bgp *bgp = peer->bgp;
+	const struct prefix *nht_prefix = p;
+	struct bgp_path_info *pi;
+	struct bgp_dest *dest;
+	int connected = 0;
+
+	dest = bgp_afi_node_get(bgp->rib[afi][safi], afi, safi, p, NULL);
+
+	/* already received again from the peer */
+	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next)
+		if (pi->peer == peer && pi->type == ZEBRA_ROUTE_BGP &&
+		    pi->sub_type == BGP_ROUTE_NORMAL &&
+		    pi->addpath_rx_id == addpath_id) {
+			bgp_dest_unlock_node(dest);
+			return;
+		}
+
+	pi = info_make(ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, 0, peer,
+		       bgp_attr_intern(attr), dest);
+	pi->addpath_rx_id = addpath_id;
+
+	if (safi == SAFI_UNICAST) {
+		if (peer->sort == BGP_PEER_EBGP &&
+		    peer->ttl == BGP_DEFAULT_TTL &&
+		    !CHECK_FLAG(peer->flags,
+				PEER_FLAG_DISABLE_CONNECTED_CHECK) &&
+		    !CHECK_FLAG(bgp->flags, BGP_FLAG_DISABLE_NH_CONNECTED_CHK))
+			connected = 1;
+		if (CHECK_FLAG(peer->af_flags[afi][safi],
+			       PEER_FLAG_REFLECTOR_CLIENT))
+			nht_prefix = NULL;
+
+		if (bgp_find_or_add_nexthop(bgp, bgp,
+					    BGP_ATTR_NH_AFI(afi, pi->attr),
+					    safi, pi, NULL, connected,
+					    nht_prefix))
+			bgp_path_info_set_flag(dest, pi, BGP_PATH_VALID);
+	} else
+		bgp_path_info_set_flag(dest, pi, BGP_PATH_VALID);
+
+	bgp_path_info_set_flag(dest, pi, BGP_PATH_STALE);
+
+	bgp_aggregate_increment(bgp, p, pi, afi, safi);
+	bgp_path_info_add(dest, pi);
+	bgp_dest_unlock_node(dest);
+
+	bgp_process(bgp, dest, afi, safi);
+
+	if (safi == SAFI_UNICAST &&
+	    (bgp->inst_type == BGP_INSTANCE_TYPE_VRF ||
+	     bgp->inst_type == BGP_INSTANCE_TYPE_DEFAULT))
+		vpn_leak_from_vrf_update(bgp_get_default(), bgp, pi);
+}
+
 bool bgp_outbound_policy_exists(struct peer *peer, struct bgp_filter *filter)
 {
 	if (peer->sort == BGP_PEER_IBGP)
@@ -5948,10 +6172,15 @@ bool bgp_addpath_encode_rx(struct peer *peer, afi_t afi, safi_t safi)
 			      PEER_CAP_ADDPATH_AF_TX_RCV));
 }
 
-/* Parse NLRI stream.  Withdraw NLRI is recognized by NULL attr
-   value. */
-int bgp_nlri_parse_ip(struct peer *peer, struct attr *attr,
-		      struct bgp_nlri *packet)
+/*
+ * Walk the IPv4/IPv6 unicast or multicast NLRI in packet and call func
+ * for every prefix that is valid.  Only the peer's ADD-PATH capability is
+ * looked at, so this is safe to run off the main pthread too, as the
+ * parse workers do.  func returning anything but BGP_NLRI_PARSE_OK stops
+ * the walk and is passed back.
+ */
+int bgp_nlri_decode_ip(struct peer *peer, const struct bgp_nlri *packet,
+		       bgp_nlri_prefix_func func, void *arg)
 {
 	uint8_t *pnt;
 	uint8_t *lim;
@@ -5961,6 +6190,7 @@ int bgp_nlri_parse_ip(struct peer *peer, struct attr *attr,
 	safi_t safi;
 	bool addpath_capable;
 	uint32_t addpath_id;
+	int ret;
 
 	pnt = packet->nlri;
 	lim = pnt + packet->length;
@@ -6067,20 +6297,9 @@ int bgp_nlri_parse_ip(struct peer *peer, struct attr *attr,
 			}
 		}
 
-		/* Normal process. */
-		if (attr)
-			bgp_update(peer, &p, addpath_id, attr, afi, safi,
-				   ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, NULL,
-				   NULL, 0, 0, NULL);
-		else
-			bgp_withdraw(peer, &p, addpath_id, afi, safi,
-				     ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, NULL,
-				     NULL, 0, NULL);
-
-		/* Do not send BGP notification twice when maximum-prefix count
-		 * overflow. */
-		if (CHECK_FLAG(peer->sflags, PEER_STATUS_PREFIX_OVERFLOW))
-			return BGP_NLRI_PARSE_ERROR_PREFIX_OVERFLOW;
+		ret = func(peer, packet, &p, addpath_id, arg);
+		if (ret != BGP_NLRI_PARSE_OK)
+			return ret;
 	}
 
 	/* Packet length consistency check. */
@@ -6095,6 +6314,46 @@ int bgp_nlri_parse_ip(struct peer *peer, struct attr *attr,
 	return BGP_NLRI_PARSE_OK;
 }
 
+/* Install, or withdraw when attr is NULL, one prefix of an UPDATE */
+int bgp_nlri_prefix_process(struct peer *peer, const struct prefix *p,
+			    uint32_t addpath_id, struct attr *attr, afi_t afi,
+			    safi_t safi)
+{
+	/* Normal process. */
+	if (attr)
+		bgp_update(peer, p, addpath_id, attr, afi, safi,
+			   ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, NULL, NULL, 0, 0,
+			   NULL);
+	else
+		bgp_withdraw(peer, p, addpath_id, afi, safi, ZEBRA_ROUTE_BGP,
+			     BGP_ROUTE_NORMAL, NULL, NULL, 0, NULL);
+
+	/* Do not send BGP notification twice when maximum-prefix count
+	 * overflow. */
+	if (CHECK_FLAG(peer->sflags, PEER_STATUS_PREFIX_OVERFLOW))
+		return BGP_NLRI_PARSE_ERROR_PREFIX_OVERFLOW;
+
+	return BGP_NLRI_PARSE_OK;
+}
+
+static int bgp_nlri_parse_ip_prefix(struct peer *peer,
+				    const struct bgp_nlri *packet,
+				    const struct prefix *p,
+				    uint32_t addpath_id, void *arg)
+{
+	return bgp_nlri_prefix_process(peer, p, addpath_id, arg, packet->afi,
+				       packet->safi);
+}
+
+/* Parse NLRI stream.  Withdraw NLRI is recognized by NULL attr
+   value. */
+int bgp_nlri_parse_ip(struct peer *peer, struct attr *attr,
+		      struct bgp_nlri *packet)
+{
+	return bgp_nlri_decode_ip(peer, packet, bgp_nlri_parse_ip_prefix,
+				  attr);
+}
+
 static struct bgp_static *bgp_static_new(void)
 {
 	return XCALLOC(MTYPE_BGP_STATIC, sizeof(struct bgp_static));
@@ -6246,8 +6505,10 @@ void bgp_static_update(struct bgp *bgp, const struct prefix *p,
 
 				struct bgp *bgp_nexthop = bgp;
 
-				if (pi->extra && pi->extra->bgp_orig)
-					bgp_nexthop = pi->extra->bgp_orig;
+				if (pi->extra && pi->extra->vrfleak &&
+				    pi->extra->vrfleak->bgp_orig)
+					bgp_nexthop =
+						pi->extra->vrfleak->bgp_orig;
 
 				if (bgp_find_or_add_nexthop(bgp, bgp_nexthop,
 							    afi, safi, pi, NULL,
@@ -7254,6 +7515,92 @@ void bgp_aggregate_free(struct bgp_aggregate *aggregate)
 	XFREE(MTYPE_BGP_AGGREGATE, aggregate);
 }
 
+/*
+ * Counted set of the single values of the (extended, large) communities
+ * in an aggregate's community hash.  A value's count is the number of
+ * distinct communities in the hash carrying it, so the aggregate's merged
+ * community only changes when a value shows up for the first time or its
+ * last carrier goes away, and is then patched instead of being rebuilt
+ * from all contributors.
+ */
+struct bgp_aggr_val {
+	uint32_t refcnt;
+	uint8_t len;
+	uint8_t val[BGP_AGGR_VAL_MAX];
+};
+
+static unsigned int bgp_aggr_val_hash_key(const void *arg)
+{
+	const struct bgp_aggr_val *aval = arg;
+
+	return jhash(aval->val, aval->len, aval->len);
+}
+
+static bool bgp_aggr_val_hash_cmp(const void *a, const void *b)
+{
+	const struct bgp_aggr_val *aval1 = a, *aval2 = b;
+
+	return aval1->len == aval2->len &&
+	       !memcmp(aval1->val, aval2->val, aval1->len);
+}
+
+static void *bgp_aggr_val_hash_alloc(void *arg)
+{
+	struct bgp_aggr_val *aval;
+
+	aval = XMALLOC(MTYPE_BGP_AGGREGATE_VAL, sizeof(*aval));
+	memcpy(aval, arg, sizeof(*aval));
+	return aval;
+}
+
+static void bgp_aggr_val_hash_free(void *arg)
+{
+	XFREE(MTYPE_BGP_AGGREGATE_VAL, arg);
+}
+
+/* Count val, returns true if it was not in the set before. */
+bool bgp_aggr_val_add(struct hash **hash, const void *val, uint8_t len)
+{
+	struct bgp_aggr_val tmp = {}, *aval;
+
+	assert(len <= sizeof(tmp.val));
+
+	if (!*hash)
+		*hash = hash_create(bgp_aggr_val_hash_key,
+				    bgp_aggr_val_hash_cmp,
+				    "BGP Aggregator value hash");
+
+	tmp.len = len;
+	memcpy(tmp.val, val, len);
+	aval = hash_get(*hash, &tmp, bgp_aggr_val_hash_alloc);
+	return aval->refcnt++ == 0;
+}
+
+/* Uncount val, returns true if that was the last reference to it. */
+bool bgp_aggr_val_del(struct hash *hash, const void *val, uint8_t len)
+{
+	struct bgp_aggr_val tmp = {}, *aval;
+
+	if (!hash)
+		return false;
+
+	assert(len <= sizeof(tmp.val));
+	tmp.len = len;
+	memcpy(tmp.val, val, len);
+	aval = hash_lookup(hash, &tmp);
+	if (!aval || --aval->refcnt)
+		return false;
+
+	hash_release(hash, aval);
+	bgp_aggr_val_hash_free(aval);
+	return true;
+}
+
+void bgp_aggr_val_free(struct hash **hash)
+{
+	hash_clean_and_free(hash, bgp_aggr_val_hash_free);
+}
+
 /**
  * Helper function to avoid repeated code: prepare variables for a
  * `route_map_apply` call.
@@ -7399,6 +7746,20 @@ static bool bgp_aggregate_info_same(struct bgp_path_info *pi, uint8_t origin,
 	return true;
 }
 
+/*
+ * A contributor change that left the aggregate's as-path and communities
+ * alone (see bgp_compute_aggregate_aspath() and friends) and did not flip
+ * the origin cannot change the installed aggregate route, so there is no
+ * need to build and compare its attributes again.  MED matching decides
+ * on installation by itself and always takes the full path.
+ */
+static bool bgp_aggregate_unchanged(struct bgp_aggregate *aggregate,
+				    uint8_t origin)
+{
+	return aggregate->installed && aggregate->installed_origin == origin
+	       && aggregate->count > 0 && !aggregate->match_med;
+}
+
 static void bgp_aggregate_install(
 	struct bgp *bgp, afi_t afi, safi_t safi, const struct prefix *p,
 	uint8_t origin, struct aspath *aspath, struct community *community,
@@ -7434,6 +7795,8 @@ static void bgp_aggregate_install(
 		if (bgp_aggregate_info_same(orig, origin, aspath, community,
 					    ecommunity, lcommunity)) {
 			bgp_dest_unlock_node(dest);
+			aggregate->installed = true;
+			aggregate->installed_origin = origin;
 
 			if (aspath)
 				aspath_free(aspath);
@@ -7458,6 +7821,7 @@ static void bgp_aggregate_install(
 			aggregate, atomic_aggregate, p);
 
 		if (!attr) {
+			aggregate->installed = false;
 			aspath_free(aspath);
 			community_free(&community);
 			ecommunity_free(&ecommunity);
@@ -7477,8 +7841,11 @@ static void bgp_aggregate_install(
 
 		bgp_path_info_add(dest, new);
 		bgp_process(bgp, dest, afi, safi);
+		aggregate->installed = true;
+		aggregate->installed_origin = origin;
 	} else {
 	uninstall_aggregate_route:
+		aggregate->installed = false;
 		for (pi = orig; pi; pi = pi->next)
 			if (pi->peer == bgp->peer_self
 			    && pi->type == ZEBRA_ROUTE_BGP
@@ -7962,6 +8329,7 @@ void bgp_aggregate_delete(struct bgp *bgp, const struct prefix *p, afi_t afi,
 		if (aggregate->lcommunity)
 			lcommunity_free(&aggregate->lcommunity);
 	}
+	aggregate->installed = false;
 
 	bgp_dest_unlock_node(top);
 }
@@ -7978,6 +8346,7 @@ static void bgp_add_route_to_aggregate(struct bgp *bgp,
 	struct community *community = NULL;
 	struct ecommunity *ecommunity = NULL;
 	struct lcommunity *lcommunity = NULL;
+	bool changed = false;
 
 	/* If the bgp instance is being deleted or self peer is deleted
 	 * then do not create aggregate route
@@ -8038,28 +8407,34 @@ static void bgp_add_route_to_aggregate(struct bgp *bgp,
 	if (aggregate->as_set) {
 		/* Compute aggregate route's as-path.
 		 */
-		bgp_compute_aggregate_aspath(aggregate,
-					     pinew->attr->aspath);
+		changed |= bgp_compute_aggregate_aspath(aggregate,
+							pinew->attr->aspath);
 
 		/* Compute aggregate route's community.
 		 */
 		if (bgp_attr_get_community(pinew->attr))
-			bgp_compute_aggregate_community(
+			changed |= bgp_compute_aggregate_community(
 				aggregate, bgp_attr_get_community(pinew->attr));
 
 		/* Compute aggregate route's extended community.
 		 */
 		if (bgp_attr_get_ecommunity(pinew->attr))
-			bgp_compute_aggregate_ecommunity(
+			changed |= bgp_compute_aggregate_ecommunity(
 				aggregate,
 				bgp_attr_get_ecommunity(pinew->attr));
 
 		/* Compute aggregate route's large community.
 		 */
 		if (bgp_attr_get_lcommunity(pinew->attr))
-			bgp_compute_aggregate_lcommunity(
+			changed |= bgp_compute_aggregate_lcommunity(
 				aggregate,
 				bgp_attr_get_lcommunity(pinew->attr));
+	}
+
+	if (!changed && bgp_aggregate_unchanged(aggregate, origin))
+		return;
+
+	if (aggregate->as_set) {
 
 		/* Retrieve aggregate route's as-path.
 		 */
@@ -8100,6 +8475,7 @@ static void bgp_remove_route_from_aggregate(struct bgp *bgp, afi_t afi,
 	struct ecommunity *ecommunity = NULL;
 	struct lcommunity *lcommunity = NULL;
 	unsigned long match = 0;
+	bool changed = false;
 
 	/* If the bgp instance is being deleted or self peer is deleted
 	 * then do not create aggregate route
@@ -8141,25 +8517,25 @@ static void bgp_remove_route_from_aggregate(struct bgp *bgp, afi_t afi,
 	if (aggregate->as_set) {
 		/* Remove as-path from aggregate.
 		 */
-		bgp_remove_aspath_from_aggregate(aggregate,
-						 pi->attr->aspath);
+		changed |= bgp_remove_aspath_from_aggregate(aggregate,
+							    pi->attr->aspath);
 
 		if (bgp_attr_get_community(pi->attr))
 			/* Remove community from aggregate.
 			 */
-			bgp_remove_community_from_aggregate(
+			changed |= bgp_remove_community_from_aggregate(
 				aggregate, bgp_attr_get_community(pi->attr));
 
 		if (bgp_attr_get_ecommunity(pi->attr))
 			/* Remove ecommunity from aggregate.
 			 */
-			bgp_remove_ecommunity_from_aggregate(
+			changed |= bgp_remove_ecommunity_from_aggregate(
 				aggregate, bgp_attr_get_ecommunity(pi->attr));
 
 		if (bgp_attr_get_lcommunity(pi->attr))
 			/* Remove lcommunity from aggregate.
 			 */
-			bgp_remove_lcommunity_from_aggregate(
+			changed |= bgp_remove_lcommunity_from_aggregate(
 				aggregate, bgp_attr_get_lcommunity(pi->attr));
 	}
 
@@ -8176,6 +8552,9 @@ static void bgp_remove_route_from_aggregate(struct bgp *bgp, afi_t afi,
 	if (aggregate->origin != BGP_ORIGIN_UNSPECIFIED)
 		origin = aggregate->origin;
 
+	if (!changed && bgp_aggregate_unchanged(aggregate, origin))
+		return;
+
 	if (aggregate->as_set) {
 		/* Retrieve aggregate route's as-path.
 		 */
@@ -8553,6 +8932,10 @@ void bgp_free_aggregate_info(struct bgp_aggregate *aggregate)
 
 	hash_clean_and_free(&aggregate->aspath_hash, bgp_aggr_aspath_remove);
 
+	bgp_aggr_val_free(&aggregate->community_vals);
+	bgp_aggr_val_free(&aggregate->ecommunity_vals);
+	bgp_aggr_val_free(&aggregate->lcommunity_vals);
+
 	bgp_aggregate_free(aggregate);
 }
 
@@ -9130,26 +9513,27 @@ void route_vty_out(struct vty *vty, const struct prefix *p,
 	 * If vrf id of nexthop is different from that of prefix,
 	 * set up printable string to append
 	 */
-	if (path->extra && path->extra->bgp_orig) {
+	if (path->extra && path->extra->vrfleak &&
+	    path->extra->vrfleak->bgp_orig) {
 		const char *self = "";
 
 		if (nexthop_self)
 			self = "<";
 
 		nexthop_othervrf = true;
-		nexthop_vrfid = path->extra->bgp_orig->vrf_id;
+		nexthop_vrfid = path->extra->vrfleak->bgp_orig->vrf_id;
 
-		if (path->extra->bgp_orig->vrf_id == VRF_UNKNOWN)
+		if (path->extra->vrfleak->bgp_orig->vrf_id == VRF_UNKNOWN)
 			snprintf(vrf_id_str, sizeof(vrf_id_str),
 				"@%s%s", VRFID_NONE_STR, self);
 		else
 			snprintf(vrf_id_str, sizeof(vrf_id_str), "@%u%s",
-				 path->extra->bgp_orig->vrf_id, self);
+				 path->extra->vrfleak->bgp_orig->vrf_id, self);
 
-		if (path->extra->bgp_orig->inst_type
+		if (path->extra->vrfleak->bgp_orig->inst_type
 		    != BGP_INSTANCE_TYPE_DEFAULT)
 
-			nexthop_vrfname = path->extra->bgp_orig->name;
+			nexthop_vrfname = path->extra->vrfleak->bgp_orig->name;
 	} else {
 		const char *self = "";
 
@@ -10264,11 +10648,13 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 		vty_out(vty, "\n");
 
 
-	if (path->extra && path->extra->parent && !json_paths) {
+	if (path->extra && path->extra->vrfleak &&
+	    path->extra->vrfleak->parent && !json_paths) {
 		struct bgp_path_info *parent_ri;
 		struct bgp_dest *dest, *pdest;
 
-		parent_ri = (struct bgp_path_info *)path->extra->parent;
+		parent_ri =
+			(struct bgp_path_info *)path->extra->vrfleak->parent;
 		dest = parent_ri->net;
 		if (dest && dest->pdest) {
 			pdest = dest->pdest;
@@ -10571,17 +10957,18 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 	/*
 	 * Note when vrfid of nexthop is different from that of prefix
 	 */
-	if (path->extra && path->extra->bgp_orig) {
-		vrf_id_t nexthop_vrfid = path->extra->bgp_orig->vrf_id;
+	if (path->extra && path->extra->vrfleak &&
+	    path->extra->vrfleak->bgp_orig) {
+		vrf_id_t nexthop_vrfid = path->extra->vrfleak->bgp_orig->vrf_id;
 
 		if (json_paths) {
 			const char *vn;
 
-			if (path->extra->bgp_orig->inst_type
+			if (path->extra->vrfleak->bgp_orig->inst_type
 			    == BGP_INSTANCE_TYPE_DEFAULT)
 				vn = VRF_DEFAULT_NAME;
 			else
-				vn = path->extra->bgp_orig->name;
+				vn = path->extra->vrfleak->bgp_orig->name;
 
 			json_object_string_add(json_path, "nhVrfName", vn);
 
@@ -10863,7 +11250,8 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 				bgp_attr_get_community(attr)->json);
 		} else {
 			vty_out(vty, "      Community: %s\n",
-				bgp_attr_get_community(attr)->str);
+				community_str(bgp_attr_get_community(attr),
+					      false, true));
 		}
 	}
 
@@ -10894,7 +11282,8 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 				bgp_attr_get_lcommunity(attr)->json);
 		} else {
 			vty_out(vty, "      Large Community: %s\n",
-				bgp_attr_get_lcommunity(attr)->str);
+				lcommunity_str(bgp_attr_get_lcommunity(attr),
+					       false, true));
 		}
 	}
 
@@ -11167,6 +11556,9 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 #define BGP_SHOW_DAMP_HEADER "   Network          From             Reuse    Path\n"
 #define BGP_SHOW_FLAP_HEADER "   Network          From            Flaps Duration Reuse    Path\n"
 
+/* destinations walked per piece when streaming a table to vtysh */
+#define BGP_SHOW_CHUNK 1000
+
 static int bgp_show_regexp(struct vty *vty, struct bgp *bgp, const char *regstr,
 			   afi_t afi, safi_t safi, enum bgp_show_type type,
 			   bool use_json);
@@ -11179,7 +11571,8 @@ static int bgp_show_table(struct vty *vty, struct bgp *bgp, safi_t safi,
 			  void *output_arg, const char *rd, int is_last,
 			  unsigned long *output_cum, unsigned long *total_cum,
 			  unsigned long *json_header_depth, uint16_t show_flags,
-			  enum rpki_states rpki_target_state)
+			  enum rpki_states rpki_target_state,
+			  struct bgp_dest **resume)
 {
 	struct bgp_path_info *pi;
 	struct bgp_dest *dest;
@@ -11188,9 +11581,11 @@ static int bgp_show_table(struct vty *vty, struct bgp *bgp, safi_t safi,
 	int display;
 	unsigned long output_count = 0;
 	unsigned long total_count = 0;
+	unsigned long walked = 0;
 	struct prefix *p;
 	json_object *json_paths = NULL;
-	int first = 1;
+	/* a resumed walk has printed some prefixes already */
+	int first = !(resume && *resume && *output_cum);
 	bool use_json = CHECK_FLAG(show_flags, BGP_SHOW_OPT_JSON);
 	bool wide = CHECK_FLAG(show_flags, BGP_SHOW_OPT_WIDE);
 	bool all = CHECK_FLAG(show_flags, BGP_SHOW_OPT_AFI_ALL);
@@ -11245,11 +11640,16 @@ static int bgp_show_table(struct vty *vty, struct bgp *bgp, safi_t safi,
 		json_detail_header = true;
 
 	/* Start processing of routes. */
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
+	dest = (resume && *resume) ? *resume : bgp_table_top(table);
+	for (; dest; dest = bgp_route_next(dest)) {
 		const struct prefix *dest_p = bgp_dest_get_prefix(dest);
 		enum rpki_states rpki_curr_state = RPKI_NOT_BEING_USED;
 		bool json_detail_header_used = false;
 
+		/* stop here, dest stays locked until the walk is resumed */
+		if (resume && walked++ == BGP_SHOW_CHUNK)
+			break;
+
 		pi = bgp_dest_get_bgp_path_info(dest);
 		if (pi == NULL)
 			continue;
@@ -11281,7 +11681,10 @@ static int bgp_show_table(struct vty *vty, struct bgp *bgp, safi_t safi,
 				bool found = false;
 
 				if (picomm) {
-					frrstr_split(picomm->str, " ",
+					frrstr_split(community_str(picomm,
+								   false,
+								   true),
+						     " ",
 						     &communities, &num);
 					for (int i = 0; i < num; i++) {
 						const char *com2alias =
@@ -11299,9 +11702,10 @@ static int bgp_show_table(struct vty *vty, struct bgp *bgp, safi_t safi,
 
 				if (!found &&
 				    bgp_attr_get_lcommunity(pi->attr)) {
-					frrstr_split(bgp_attr_get_lcommunity(
-							     pi->attr)
-							     ->str,
+					frrstr_split(lcommunity_str(
+							     bgp_attr_get_lcommunity(
+								     pi->attr),
+							     false, true),
 						     " ", &communities, &num);
 					for (int i = 0; i < num; i++) {
 						const char *com2alias =
@@ -11639,6 +12043,12 @@ static int bgp_show_table(struct vty *vty, struct bgp *bgp, safi_t safi,
 			json_object_free(json_paths);
 	}
 
+	if (resume) {
+		*resume = dest;
+		if (dest)
+			is_last = 0;
+	}
+
 	if (output_cum) {
 		output_count += *output_cum;
 		*output_cum = output_count;
@@ -11708,7 +12118,7 @@ int bgp_show_table_rd(struct vty *vty, struct bgp *bgp, safi_t safi,
 			bgp_show_table(vty, bgp, safi, itable, type, output_arg,
 				       rd, next == NULL, &output_cum,
 				       &total_cum, &json_header_depth,
-				       show_flags, RPKI_NOT_BEING_USED);
+				       show_flags, RPKI_NOT_BEING_USED, NULL);
 			if (next == NULL)
 				show_msg = false;
 		}
@@ -11728,6 +12138,102 @@ int bgp_show_table_rd(struct vty *vty, struct bgp *bgp, safi_t safi,
 	return CMD_SUCCESS;
 }
 
+/*
+ * Full walks of big tables would otherwise put all of their output in the
+ * vty's buffer before any of it gets sent.  When streaming, the table is
+ * walked BGP_SHOW_CHUNK destinations at a time, and the next piece is only
+ * produced once vtysh has read everything before it.  The table and the
+ * instance are held locked in between.
+ */
+struct bgp_show_cont {
+	struct bgp *bgp;
+	struct bgp_table *table;
+	struct bgp_dest *dest;
+	safi_t safi;
+	enum bgp_show_type type;
+	uint16_t show_flags;
+	enum rpki_states rpki_target_state;
+
+	unsigned long output_cum;
+	unsigned long total_cum;
+	unsigned long json_header_depth;
+};
+
+static void bgp_show_cont_free(void *arg)
+{
+	struct bgp_show_cont *cont = arg;
+
+	if (cont->dest)
+		bgp_dest_unlock_node(cont->dest);
+	bgp_table_unlock(cont->table);
+	bgp_unlock(cont->bgp);
+	XFREE(MTYPE_BGP_SHOW_CONT, cont);
+}
+
+/* show the next piece of the table, returns true if there's more */
+static bool bgp_show_cont_step(struct vty *vty, struct bgp_show_cont *cont)
+{
+	bgp_show_table(vty, cont->bgp, cont->safi, cont->table, cont->type,
+		       NULL, NULL, 1, &cont->output_cum, &cont->total_cum,
+		       &cont->json_header_depth, cont->show_flags,
+		       cont->rpki_target_state, &cont->dest);
+
+	return cont->dest != NULL;
+}
+
+static void bgp_show_cont_run(struct vty *vty, void *arg)
+{
+	struct bgp_show_cont *cont = arg;
+	unsigned long i;
+
+	if (CHECK_FLAG(cont->bgp->flags, BGP_FLAG_DELETE_IN_PROGRESS)) {
+		if (CHECK_FLAG(cont->show_flags, BGP_SHOW_OPT_JSON)) {
+			for (i = 0; i < cont->json_header_depth; ++i)
+				vty_out(vty, " } ");
+			vty_out(vty, "\n");
+		} else
+			vty_out(vty, "%% BGP instance deleted\n");
+
+		bgp_show_cont_free(cont);
+		vty_out_done(vty, CMD_WARNING);
+		return;
+	}
+
+	if (bgp_show_cont_step(vty, cont)) {
+		vty_out_continue(vty, bgp_show_cont_run, bgp_show_cont_free,
+				 cont);
+		return;
+	}
+
+	bgp_show_cont_free(cont);
+	vty_out_done(vty, CMD_SUCCESS);
+}
+
+static int bgp_show_table_stream(struct vty *vty, struct bgp *bgp,
+				 safi_t safi, struct bgp_table *table,
+				 enum bgp_show_type type, uint16_t show_flags,
+				 enum rpki_states rpki_target_state)
+{
+	struct bgp_show_cont *cont;
+
+	cont = XCALLOC(MTYPE_BGP_SHOW_CONT, sizeof(*cont));
+	cont->bgp = bgp_lock(bgp);
+	cont->table = table;
+	bgp_table_lock(table);
+	cont->safi = safi;
+	cont->type = type;
+	cont->show_flags = show_flags;
+	cont->rpki_target_state = rpki_target_state;
+
+	if (bgp_show_cont_step(vty, cont))
+		vty_out_continue(vty, bgp_show_cont_run, bgp_show_cont_free,
+				 cont);
+	else
+		bgp_show_cont_free(cont);
+
+	return CMD_SUCCESS;
+}
+
 static int bgp_show(struct vty *vty, struct bgp *bgp, afi_t afi, safi_t safi,
 		    enum bgp_show_type type, void *output_arg,
 		    uint16_t show_flags, enum rpki_states rpki_target_state)
@@ -11768,9 +12274,15 @@ static int bgp_show(struct vty *vty, struct bgp *bgp, afi_t afi, safi_t safi,
 	if (safi == SAFI_EVPN)
 		return bgp_evpn_show_all_routes(vty, bgp, type, use_json, 0);
 
+	/* output_arg belongs to the command, it can't be used after that */
+	if (CHECK_FLAG(show_flags, BGP_SHOW_OPT_STREAM) && !output_arg &&
+	    vty_out_can_continue(vty))
+		return bgp_show_table_stream(vty, bgp, safi, table, type,
+					     show_flags, rpki_target_state);
+
 	return bgp_show_table(vty, bgp, safi, table, type, output_arg, NULL, 1,
 			      NULL, NULL, &json_header_depth, show_flags,
-			      rpki_target_state);
+			      rpki_target_state, NULL);
 }
 
 static void bgp_show_all_instances_routes_vty(struct vty *vty, afi_t afi,
@@ -12924,7 +13436,8 @@ DEFPY(show_ip_bgp, show_ip_bgp_cmd,
 						  show_flags);
 		else
 			return bgp_show(vty, bgp, afi, safi, sh_type,
-					output_arg, show_flags,
+					output_arg,
+					show_flags | BGP_SHOW_OPT_STREAM,
 					rpki_target_state);
 	} else {
 		struct listnode *node;
@@ -13702,6 +14215,9 @@ static void bgp_peer_count_proc(struct bgp_dest *rn, struct peer_pcounts *pc)
 
 		pc->count[PCOUNT_ALL]++;
 
+		if (bgp_path_adj_in_shared(pi))
+			pc->count[PCOUNT_ADJ_IN]++;
+
 		if (CHECK_FLAG(pi->flags, BGP_PATH_DAMPED))
 			pc->count[PCOUNT_DAMPED]++;
 		if (CHECK_FLAG(pi->flags, BGP_PATH_HISTORY))
@@ -14042,7 +14558,7 @@ show_adj_route(struct vty *vty, struct peer *peer, struct bgp_table *table,
 	       const struct prefix *match, unsigned long *output_count,
 	       unsigned long *filtered_count)
 {
-	struct bgp_adj_in *ain = NULL;
+	struct bgp_adj_in_iter ain;
 	struct bgp_adj_out *adj = NULL;
 	struct bgp_dest *dest;
 	struct bgp *bgp;
@@ -14085,22 +14601,18 @@ show_adj_route(struct vty *vty, struct peer *peer, struct bgp_table *table,
 
 		if (type == bgp_show_adj_route_received ||
 		    type == bgp_show_adj_route_filtered) {
-			for (ain = dest->adj_in; ain; ain = ain->next) {
-				if (ain->peer == peer) {
-					attr = *ain->attr;
-					break;
-				}
-			}
 			/* bail out if if adj_out is empty, or
 			 * if the prefix isn't in this peer's
 			 * adj_in
 			 */
-			if (!ain || ain->peer != peer) {
+			memset(&ain, 0, sizeof(ain));
+			if (!bgp_adj_in_iter_next(dest, peer, &ain)) {
 				if (!use_json)
 					vty_out(vty, "Network not in table\n");
 				bgp_dest_unlock_node(dest);
 				return;
 			}
+			attr = *ain.attr;
 		} else if (type == bgp_show_adj_route_advertised) {
 			bool peer_found = false;
 
@@ -14209,10 +14721,8 @@ show_adj_route(struct vty *vty, struct peer *peer, struct bgp_table *table,
 	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
 		if (type == bgp_show_adj_route_received
 		    || type == bgp_show_adj_route_filtered) {
-			for (ain = dest->adj_in; ain; ain = ain->next) {
-				if (ain->peer != peer)
-					continue;
-
+			memset(&ain, 0, sizeof(ain));
+			while (bgp_adj_in_iter_next(dest, peer, &ain)) {
 				show_adj_route_header(vty, peer, table, header1,
 						      header2, json, json_scode,
 						      json_ocode, wide, detail);
@@ -14231,7 +14741,7 @@ show_adj_route(struct vty *vty, struct peer *peer, struct bgp_table *table,
 					}
 				}
 
-				attr = *ain->attr;
+				attr = *ain.attr;
 				route_filtered = false;
 
 				/* Filter prefix using distribute list,
@@ -14247,7 +14757,8 @@ show_adj_route(struct vty *vty, struct peer *peer, struct bgp_table *table,
 				/* Filter prefix using route-map */
 				ret = bgp_input_modifier(peer, rn_p, &attr, afi,
 							 safi, rmap_name, NULL,
-							 0, NULL);
+							 0, NULL,
+							 ain.attr->memo_id);
 
 				if (type == bgp_show_adj_route_filtered &&
 					!route_filtered && ret != RMAP_DENY) {
@@ -145,9 +145,68 @@ struct bgp_sid_info {
 	uint8_t transposition_offset;
 };
 
+/* EVPN specific part of struct bgp_path_info_extra */
+struct bgp_path_info_extra_evpn {
+	/* af specific flags */
+	uint16_t af_flags;
+#define BGP_EVPN_MACIP_TYPE_SVI_IP (1 << 0)
+
+	union {
+		struct ethaddr mac; /* MAC set here for VNI IP table */
+		struct ipaddr ip;   /* IP set here for VNI MAC table */
+	} vni_info;
+};
+
+/* Flowspec specific part of struct bgp_path_info_extra */
+struct bgp_path_info_extra_fs {
+	/* presence of FS pbr firewall based entry */
+	struct list *bgp_fs_pbr;
+	/* presence of FS pbr iprule based entry */
+	struct list *bgp_fs_iprule;
+};
+
+/* Part of struct bgp_path_info_extra for routes leaked between instances
+ * (VRF <-> VPN, VRF <-> VRF and VNI imports)
+ */
+struct bgp_path_info_extra_vrfleak {
+	/*
+	 * For imported routes into a VNI (or VRF)
+	 */
+	void *parent;	    /* parent from global table */
+
+	/*
+	 * Original bgp instance for imported routes. Needed for:
+	 * 1. Find all routes from a specific vrf for deletion
+	 * 2. vrf context of original nexthop
+	 *
+	 * Store pointer to bgp instance rather than bgp->vrf_id because
+	 * bgp->vrf_id is not always valid (or may change?).
+	 *
+	 * Set to NULL if route is not imported from another bgp instance.
+	 */
+	struct bgp *bgp_orig;
+
+	/*
+	 * Original bgp session to know if the session is a
+	 * connected EBGP session or not
+	 */
+	struct peer *peer_orig;
+
+	/*
+	 * Nexthop in context of original bgp instance. Needed
+	 * for label resolution of core mpls routes exported to a vrf.
+	 * Set nexthop_orig.family to 0 if not valid.
+	 */
+	struct prefix nexthop_orig;
+};
+
 /* Ancillary information to struct bgp_path_info,
  * used for uncommonly used data (aggregation, MPLS, etc.)
  * and lazily allocated to save memory.
+ *
+ * Feature specific data lives in further side structures that are only
+ * allocated when the feature is actually used on the path, use the
+ * bgp_path_info_*_get() functions to get at them for writing.
  */
 struct bgp_path_info_extra {
 	/* Pointer to dampening structure.  */
@@ -163,10 +222,6 @@ struct bgp_path_info_extra {
 	mpls_label_t label[BGP_MAX_LABELS];
 	uint32_t num_labels;
 
-	/* af specific flags */
-	uint16_t af_flags;
-#define BGP_EVPN_MACIP_TYPE_SVI_IP (1 << 0)
-
 	/* SRv6 SID(s) for SRv6-VPN */
 	struct bgp_sid_info sid[BGP_MAX_SIDS];
 	uint32_t num_sids;
@@ -200,48 +255,10 @@ struct bgp_path_info_extra {
 	} vnc;
 #endif
 
-	/*
-	 * For imported routes into a VNI (or VRF)
-	 */
-	void *parent;	    /* parent from global table */
-	union {
-		struct ethaddr mac; /* MAC set here for VNI IP table */
-		struct ipaddr ip;   /* IP set here for VNI MAC table */
-	} vni_info;
-
-	/*
-	 * Some tunnelish parameters follow. Maybe consolidate into an
-	 * internal tunnel structure?
-	 */
+	struct bgp_path_info_extra_evpn *evpn;
+	struct bgp_path_info_extra_fs *flowspec;
+	struct bgp_path_info_extra_vrfleak *vrfleak;
 
-	/*
-	 * Original bgp instance for imported routes. Needed for:
-	 * 1. Find all routes from a specific vrf for deletion
-	 * 2. vrf context of original nexthop
-	 *
-	 * Store pointer to bgp instance rather than bgp->vrf_id because
-	 * bgp->vrf_id is not always valid (or may change?).
-	 *
-	 * Set to NULL if route is not imported from another bgp instance.
-	 */
-	struct bgp *bgp_orig;
-
-	/*
-	 * Original bgp session to know if the session is a
-	 * connected EBGP session or not
-	 */
-	struct peer *peer_orig;
-
-	/*
-	 * Nexthop in context of original bgp instance. Needed
-	 * for label resolution of core mpls routes exported to a vrf.
-	 * Set nexthop_orig.family to 0 if not valid.
-	 */
-	struct prefix nexthop_orig;
-	/* presence of FS pbr firewall based entry */
-	struct list *bgp_fs_pbr;
-	/* presence of FS pbr iprule based entry */
-	struct list *bgp_fs_iprule;
 	/* Destination Ethernet Segment links for EVPN MH */
 	struct bgp_path_mh_info *mh_info;
 };
@@ -254,6 +271,9 @@ struct bgp_path_info {
 	/* For nexthop linked list */
 	LIST_ENTRY(bgp_path_info) nh_thread;
 
+	/* For peer->paths, see bgp_path_info_add() */
+	struct bgp_peer_paths_item peer_paths;
+
 	/* Back pointer to the prefix node */
 	struct bgp_dest *net;
 
@@ -298,6 +318,8 @@ struct bgp_path_info {
 #define BGP_PATH_ANNC_NH_SELF (1 << 14)
 #define BGP_PATH_LINK_BW_CHG (1 << 15)
 #define BGP_PATH_ACCEPT_OWN (1 << 16)
+/* attr is also what the peer sent, stands in for the Adj-RIB-In entry */
+#define BGP_PATH_ADJ_IN_SHARED (1 << 17)
 
 	/* BGP route type.  This can be static, RIP, OSPF, BGP etc.  */
 	uint8_t type;
@@ -321,6 +343,8 @@ struct bgp_path_info {
 	struct bgp_addpath_info_data tx_addpath;
 };
 
+DECLARE_DLIST(bgp_peer_paths, struct bgp_path_info, peer_paths);
+
 /* Structure used in BGP path selection */
 struct bgp_path_info_pair {
 	struct bgp_path_info *old;
@@ -435,6 +459,20 @@ struct bgp_aggregate {
 	/* Aggregate route's as-path. */
 	struct aspath *aspath;
 
+	/* Counted sets of the single community, extended community and
+	 * large community values in the hashes above; see bgp_aggr_val_add.
+	 */
+	struct hash *community_vals;
+	struct hash *ecommunity_vals;
+	struct hash *lcommunity_vals;
+
+	/* The aggregate route was installed with this origin and the
+	 * attributes above, so a contributor change leaving all of them
+	 * alone does not need to go through bgp_aggregate_install.
+	 */
+	bool installed;
+	uint8_t installed_origin;
+
 	/* SAFI configuration. */
 	safi_t safi;
 
@@ -547,6 +585,13 @@ static inline int bgp_fibupd_safi(safi_t safi)
 	return 0;
 }
 
+/* pi holds what its peer sent, in lieu of an Adj-RIB-In entry */
+static inline bool bgp_path_adj_in_shared(const struct bgp_path_info *pi)
+{
+	return CHECK_FLAG(pi->flags, BGP_PATH_ADJ_IN_SHARED) &&
+	       !CHECK_FLAG(pi->flags, BGP_PATH_REMOVED);
+}
+
 /* Flag if the route path's family matches params. */
 static inline bool is_pi_family_matching(struct bgp_path_info *pi,
 					 afi_t afi, safi_t safi)
@@ -653,6 +698,8 @@ DECLARE_HOOK(bgp_process,
 #define BGP_SHOW_OPT_JSON_DETAIL (1 << 7)
 #define BGP_SHOW_OPT_TERSE (1 << 8)
 #define BGP_SHOW_OPT_ROUTES_DETAIL (1 << 9)
+/* the command prints nothing after the table, so it may be continued */
+#define BGP_SHOW_OPT_STREAM (1 << 10)
 
 /* Prototypes. */
 extern void bgp_rib_remove(struct bgp_dest *dest, struct bgp_path_info *pi,
@@ -670,17 +717,27 @@ extern void bgp_default_originate(struct peer *, afi_t, safi_t, int);
 extern void bgp_soft_reconfig_table_task_cancel(const struct bgp *bgp,
 						const struct bgp_table *table,
 						const struct peer *peer);
+extern void bgp_soft_reconfig_progress_show(struct vty *vty,
+					    json_object *json);
 
 /*
  * If this peer is configured for soft reconfig in then do the work
  * and return true.  If it is not return false; and do nothing
  */
 extern bool bgp_soft_reconfig_in(struct peer *peer, afi_t afi, safi_t safi);
+extern unsigned int bgp_soft_reconfig_dest(struct peer *peer,
+					   struct bgp_dest *dest, afi_t afi,
+					   safi_t safi, struct prefix_rd *prd);
 extern void bgp_clear_route(struct peer *, afi_t, safi_t);
 extern void bgp_clear_route_all(struct peer *);
 extern void bgp_clear_adj_in(struct peer *, afi_t, safi_t);
+extern bool bgp_adj_in_shed(struct peer *peer, afi_t afi, safi_t safi);
+extern void bgp_adj_in_unshed(struct peer *peer, afi_t afi, safi_t safi);
 extern void bgp_clear_stale_route(struct peer *, afi_t, safi_t);
 extern void bgp_set_stale_route(struct peer *peer, afi_t afi, safi_t safi);
+extern void bgp_restore_stale_route(struct peer *peer, const struct prefix *p,
+				    uint32_t addpath_id, struct attr *attr,
+				    afi_t afi, safi_t safi);
 extern bool bgp_outbound_policy_exists(struct peer *, struct bgp_filter *);
 extern bool bgp_inbound_policy_exists(struct peer *, struct bgp_filter *);
 
@@ -693,11 +750,19 @@ extern struct bgp_path_info *
 bgp_get_imported_bpi_ultimate(struct bgp_path_info *info);
 extern void bgp_path_info_add(struct bgp_dest *dest, struct bgp_path_info *pi);
 extern void bgp_path_info_extra_free(struct bgp_path_info_extra **extra);
+/* struct bgp_path_info is allocated from this slab, see info_make() */
+DECLARE_MSLAB(BGP_ROUTE);
 extern void bgp_path_info_reap(struct bgp_dest *dest, struct bgp_path_info *pi);
 extern void bgp_path_info_delete(struct bgp_dest *dest,
 				 struct bgp_path_info *pi);
 extern struct bgp_path_info_extra *
 bgp_path_info_extra_get(struct bgp_path_info *path);
+extern struct bgp_path_info_extra_evpn *
+bgp_path_info_evpn_get(struct bgp_path_info *path);
+extern struct bgp_path_info_extra_fs *
+bgp_path_info_flowspec_get(struct bgp_path_info *path);
+extern struct bgp_path_info_extra_vrfleak *
+bgp_path_info_vrfleak_get(struct bgp_path_info *path);
 extern void bgp_path_info_set_flag(struct bgp_dest *dest,
 				   struct bgp_path_info *path, uint32_t flag);
 extern void bgp_path_info_unset_flag(struct bgp_dest *dest,
@@ -707,6 +772,18 @@ extern void bgp_path_info_path_with_addpath_rx_str(struct bgp_path_info *pi,
 
 extern int bgp_nlri_parse_ip(struct peer *, struct attr *, struct bgp_nlri *);
 
+/* called by bgp_nlri_decode_ip() for every valid prefix */
+typedef int (*bgp_nlri_prefix_func)(struct peer *peer,
+				    const struct bgp_nlri *packet,
+				    const struct prefix *p,
+				    uint32_t addpath_id, void *arg);
+extern int bgp_nlri_decode_ip(struct peer *peer,
+			      const struct bgp_nlri *packet,
+			      bgp_nlri_prefix_func func, void *arg);
+extern int bgp_nlri_prefix_process(struct peer *peer, const struct prefix *p,
+				   uint32_t addpath_id, struct attr *attr,
+				   afi_t afi, safi_t safi);
+
 extern bool bgp_maximum_prefix_overflow(struct peer *, afi_t, safi_t, int);
 
 extern void bgp_redistribute_add(struct bgp *bgp, struct prefix *p,
@@ -803,8 +880,6 @@ extern void route_vty_out_overlay(struct vty *vty, const struct prefix *p,
 				  struct bgp_path_info *path, int display,
 				  json_object *json);
 
-extern void bgp_notify_conditional_adv_scanner(struct update_subgroup *subgrp);
-
 extern void subgroup_process_announce_selected(struct update_subgroup *subgrp,
 					       struct bgp_path_info *selected,
 					       struct bgp_dest *dest,
@@ -879,6 +954,16 @@ extern void bgp_path_info_add_with_caller(const char *caller,
 					  struct bgp_dest *dest,
 					  struct bgp_path_info *pi);
 extern void bgp_aggregate_free(struct bgp_aggregate *aggregate);
+
+/* Longest single value counted by bgp_aggr_val_add (IPv6 extended
+ * communities).
+ */
+#define BGP_AGGR_VAL_MAX 20
+
+extern bool bgp_aggr_val_add(struct hash **hash, const void *val,
+			     uint8_t len);
+extern bool bgp_aggr_val_del(struct hash *hash, const void *val, uint8_t len);
+extern void bgp_aggr_val_free(struct hash **hash);
 #define bgp_path_info_add(A, B)                                                \
 	bgp_path_info_add_with_caller(__func__, (A), (B))
 #define bgp_path_info_free(B) bgp_path_info_free_with_caller(__func__, (B))
@@ -59,6 +59,7 @@
 #include "bgpd/bgp_encap_types.h"
 #include "bgpd/bgp_mpath.h"
 #include "bgpd/bgp_script.h"
+#include "bgpd/bgp_conditional_adv.h"
 
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/bgp_rfapi_cfg.h"
@@ -354,21 +355,38 @@ enum frrlua_rm_status {
 	LUA_RM_MATCH_AND_CHANGE,
 };
 
+/*
+ * The script is loaded on first use and kept with the compiled rule, so the
+ * Lua state is reused for every path the rule runs on.  Changes to the script
+ * are picked up when the rule is configured again.
+ */
+struct route_match_script {
+	char *name;
+	struct frrscript *fs;
+};
+
+static const char *routematch_function = "route_match";
+
 static enum route_map_cmd_result_t
 route_match_script(void *rule, const struct prefix *prefix, void *object)
 {
-	const char *scriptname = rule;
-	const char *routematch_function = "route_match";
+	struct route_match_script *rms = rule;
+	const char *scriptname = rms->name;
 	struct bgp_path_info *path = (struct bgp_path_info *)object;
 
-	struct frrscript *fs = frrscript_new(scriptname);
-
-	if (frrscript_load(fs, routematch_function, NULL)) {
-		zlog_err(
-			"Issue loading script or function; defaulting to no match");
-		return RMAP_NOMATCH;
+	if (!rms->fs) {
+		rms->fs = frrscript_new(scriptname);
+		if (frrscript_load(rms->fs, routematch_function, NULL)) {
+			zlog_err(
+				"Issue loading script or function; defaulting to no match");
+			frrscript_delete(rms->fs);
+			rms->fs = NULL;
+			return RMAP_NOMATCH;
+		}
 	}
 
+	struct frrscript *fs = rms->fs;
+
 	struct attr newattr = *path->attr;
 
 	int result = frrscript_call(
@@ -388,6 +406,9 @@ route_match_script(void *rule, const struct prefix *prefix, void *object)
 
 	int status = RMAP_NOMATCH;
 
+	if (!action)
+		return RMAP_NOMATCH;
+
 	switch (*action) {
 	case LUA_RM_FAILURE:
 		zlog_err(
@@ -421,23 +442,27 @@ route_match_script(void *rule, const struct prefix *prefix, void *object)
 
 	XFREE(MTYPE_SCRIPT_RES, action);
 
-	frrscript_delete(fs);
-
 	return status;
 }
 
 static void *route_match_script_compile(const char *arg)
 {
-	char *scriptname;
+	struct route_match_script *rms;
 
-	scriptname = XSTRDUP(MTYPE_ROUTE_MAP_COMPILED, arg);
+	rms = XCALLOC(MTYPE_ROUTE_MAP_COMPILED, sizeof(*rms));
+	rms->name = XSTRDUP(MTYPE_ROUTE_MAP_COMPILED, arg);
 
-	return scriptname;
+	return rms;
 }
 
 static void route_match_script_free(void *rule)
 {
-	XFREE(MTYPE_ROUTE_MAP_COMPILED, rule);
+	struct route_match_script *rms = rule;
+
+	if (rms->fs)
+		frrscript_delete(rms->fs);
+	XFREE(MTYPE_ROUTE_MAP_COMPILED, rms->name);
+	XFREE(MTYPE_ROUTE_MAP_COMPILED, rms);
 }
 
 static const struct route_map_rule_cmd route_match_script_cmd = {
@@ -500,7 +525,8 @@ static const struct route_map_rule_cmd route_match_ip_address_cmd = {
 	"ip address",
 	route_match_ip_address,
 	route_match_ip_address_compile,
-	route_match_ip_address_free
+	route_match_ip_address_free,
+	.pure = true,
 };
 
 /* `match ip next-hop <IP_ADDRESS_ACCESS_LIST_NAME>' */
@@ -716,7 +742,8 @@ static const struct route_map_rule_cmd
 	"ip address prefix-list",
 	route_match_ip_address_prefix_list,
 	route_match_ip_address_prefix_list_compile,
-	route_match_ip_address_prefix_list_free
+	route_match_ip_address_prefix_list_free,
+	.pure = true,
 };
 
 /* `match ip next-hop prefix-list PREFIX_LIST' */
@@ -1267,12 +1294,13 @@ route_match_vrl_source_vrf(void *rule, const struct prefix *prefix,
 	if (strncmp(vrf_name, "n/a", VRF_NAMSIZ) == 0)
 		return RMAP_NOMATCH;
 
-	if (path->extra == NULL || path->extra->bgp_orig == NULL)
+	if (path->extra == NULL || path->extra->vrfleak == NULL ||
+	    path->extra->vrfleak->bgp_orig == NULL)
 		return RMAP_NOMATCH;
 
-	if (strncmp(vrf_name, vrf_id_to_name(path->extra->bgp_orig->vrf_id),
-		    VRF_NAMSIZ)
-	    == 0)
+	if (strncmp(vrf_name,
+		    vrf_id_to_name(path->extra->vrfleak->bgp_orig->vrf_id),
+		    VRF_NAMSIZ) == 0)
 		return RMAP_MATCH;
 
 	return RMAP_NOMATCH;
@@ -1312,8 +1340,9 @@ route_match_alias(void *rule, const struct prefix *prefix, void *object)
 
 	if (bgp_attr_get_community(path->attr)) {
 		found = false;
-		frrstr_split(bgp_attr_get_community(path->attr)->str, " ",
-			     &communities, &num);
+		frrstr_split(community_str(bgp_attr_get_community(path->attr),
+					   false, true),
+			     " ", &communities, &num);
 		for (int i = 0; i < num; i++) {
 			const char *com2alias =
 				bgp_community2alias(communities[i]);
@@ -1328,8 +1357,9 @@ route_match_alias(void *rule, const struct prefix *prefix, void *object)
 
 	if (bgp_attr_get_lcommunity(path->attr)) {
 		found = false;
-		frrstr_split(bgp_attr_get_lcommunity(path->attr)->str, " ",
-			     &communities, &num);
+		frrstr_split(lcommunity_str(bgp_attr_get_lcommunity(path->attr),
+					    false, true),
+			     " ", &communities, &num);
 		for (int i = 0; i < num; i++) {
 			const char *com2alias =
 				bgp_community2alias(communities[i]);
@@ -1410,7 +1440,8 @@ static const struct route_map_rule_cmd route_match_local_pref_cmd = {
 	"local-preference",
 	route_match_local_pref,
 	route_match_local_pref_compile,
-	route_match_local_pref_free
+	route_match_local_pref_free,
+	.pure = true,
 };
 
 /* `match metric METRIC' */
@@ -1433,6 +1464,7 @@ static const struct route_map_rule_cmd route_match_metric_cmd = {
 	route_match_metric,
 	route_value_compile,
 	route_value_free,
+	.pure = true,
 };
 
 /* `match as-path ASPATH' */
@@ -1474,7 +1506,8 @@ static const struct route_map_rule_cmd route_match_aspath_cmd = {
 	"as-path",
 	route_match_aspath,
 	route_match_aspath_compile,
-	route_match_aspath_free
+	route_match_aspath_free,
+	.pure = true,
 };
 
 /* `match community COMMUNIY' */
@@ -1568,7 +1601,8 @@ static const struct route_map_rule_cmd route_match_community_cmd = {
 	route_match_community,
 	route_match_community_compile,
 	route_match_community_free,
-	route_match_get_community_key
+	route_match_get_community_key,
+	.pure = true,
 };
 
 /* Match function for lcommunity match. */
@@ -1638,7 +1672,8 @@ static const struct route_map_rule_cmd route_match_lcommunity_cmd = {
 	route_match_lcommunity,
 	route_match_lcommunity_compile,
 	route_match_lcommunity_free,
-	route_match_get_community_key
+	route_match_get_community_key,
+	.pure = true,
 };
 
 
@@ -1689,7 +1724,8 @@ static const struct route_map_rule_cmd route_match_ecommunity_cmd = {
 	"extcommunity",
 	route_match_ecommunity,
 	route_match_ecommunity_compile,
-	route_match_ecommunity_free
+	route_match_ecommunity_free,
+	.pure = true,
 };
 
 /* `match nlri` and `set nlri` are replaced by `address-family ipv4`
@@ -1738,7 +1774,8 @@ static const struct route_map_rule_cmd route_match_origin_cmd = {
 	"origin",
 	route_match_origin,
 	route_match_origin_compile,
-	route_match_origin_free
+	route_match_origin_free,
+	.pure = true,
 };
 
 /* match probability  { */
@@ -1863,6 +1900,7 @@ static const struct route_map_rule_cmd route_match_tag_cmd = {
 	route_match_tag,
 	route_map_rule_tag_compile,
 	route_map_rule_tag_free,
+	.pure = true,
 };
 
 static enum route_map_cmd_result_t
@@ -3104,16 +3142,31 @@ route_set_aigp_metric(void *rule, const struct prefix *pfx, void *object)
 	return RMAP_OKAY;
 }
 
+/* "set aigp-metric igp-metric" rules, those follow nexthop metric changes */
+static unsigned int route_set_aigp_igp_metric_count;
+
 static void *route_set_aigp_metric_compile(const char *arg)
 {
+	if (strmatch(arg, "igp-metric"))
+		route_set_aigp_igp_metric_count++;
+
 	return XSTRDUP(MTYPE_ROUTE_MAP_COMPILED, arg);
 }
 
 static void route_set_aigp_metric_free(void *rule)
 {
+	if (strmatch(rule, "igp-metric"))
+		route_set_aigp_igp_metric_count--;
+
 	XFREE(MTYPE_ROUTE_MAP_COMPILED, rule);
 }
 
+/* Can the outcome of any route-map depend on the IGP metric of a nexthop? */
+bool bgp_route_map_uses_igp_metric(void)
+{
+	return route_set_aigp_igp_metric_count > 0;
+}
+
 static const struct route_map_rule_cmd route_set_aigp_metric_cmd = {
 	"aigp-metric",
 	route_set_aigp_metric,
@@ -3280,7 +3333,8 @@ static const struct route_map_rule_cmd route_match_ipv6_address_cmd = {
 	"ipv6 address",
 	route_match_ipv6_address,
 	route_match_ipv6_address_compile,
-	route_match_ipv6_address_free
+	route_match_ipv6_address_free,
+	.pure = true,
 };
 
 /* `match ipv6 next-hop ACCESSLIST6_NAME' */
@@ -3457,7 +3511,8 @@ static const struct route_map_rule_cmd
 	"ipv6 address prefix-list",
 	route_match_ipv6_address_prefix_list,
 	route_match_ipv6_address_prefix_list_compile,
-	route_match_ipv6_address_prefix_list_free
+	route_match_ipv6_address_prefix_list_free,
+	.pure = true,
 };
 
 /* `match ipv6 next-hop type <TYPE>' */
@@ -4016,7 +4071,9 @@ static void bgp_route_map_process_peer(const char *rmap_name,
 
 		if (route_update && peer_established(peer)) {
 			if (CHECK_FLAG(peer->af_flags[afi][safi],
-				       PEER_FLAG_SOFT_RECONFIG)) {
+				       PEER_FLAG_SOFT_RECONFIG) &&
+			    !CHECK_FLAG(peer->af_sflags[afi][safi],
+					PEER_STATUS_ADJ_IN_SHED)) {
 				if (bgp_debug_update(peer, NULL, NULL, 1))
 					zlog_debug(
 						"Processing route_map %s(%s:%s) update on peer %s (inbound, soft-reconfig)",
@@ -4068,6 +4125,8 @@ static void bgp_route_map_process_peer(const char *rmap_name,
 
 	/* Notify BGP conditional advertisement scanner percess */
 	peer->advmap_config_change[afi][safi] = true;
+	if (filter->advmap.aname)
+		bgp_conditional_adv_schedule(peer->bgp);
 }
 
 static void bgp_route_map_update_peer_group(const char *rmap_name,
@@ -4151,6 +4210,12 @@ static void bgp_route_map_process_update(struct bgp *bgp, const char *rmap_name,
 		}
 	}
 
+	/* route-server clients grouped by what the route-map contains may
+	 * no longer belong together
+	 */
+	if (CHECK_FLAG(bgp->flags, BGP_FLAG_RS_SHARED_VIEWS))
+		update_group_rs_adjust(bgp, rmap_name);
+
 	/* for outbound/default-orig route-maps, process for groups */
 	update_group_policy_update(bgp, BGP_POLICY_ROUTE_MAP, rmap_name,
 				   route_update, 0);
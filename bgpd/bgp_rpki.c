@@ -23,8 +23,10 @@
 #include "command.h"
 #include "linklist.h"
 #include "memory.h"
+#include "monotime.h"
 #include "frrevent.h"
 #include "filter.h"
+#include "table.h"
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_table.h"
 #include "bgp_advertise.h"
@@ -131,6 +133,28 @@ static unsigned int retry_interval;
 static int rpki_sync_socket_rtr;
 static int rpki_sync_socket_bgpd;
 
+/* ROA changes read off the sync socket per callback at most */
+#define RPKI_SYNC_BATCH 1024
+
+/*
+ * Prefixes of ROAs that changed since the last revalidation run, one trie
+ * per address family.  A ROA covered by another pending ROA needs no walk
+ * of its own, the covering ROA's subtree already contains its routes.
+ */
+static struct route_table *rpki_pending[AFI_MAX];
+static struct event *t_rpki_revalidate;
+
+static struct {
+	uint64_t lookups;
+	uint64_t lookup_usec;
+	uint64_t lookup_max_usec;
+	uint64_t roa_updates;
+	uint64_t roa_coalesced;
+	uint64_t revalidation_runs;
+	uint64_t dests_revalidated;
+	uint64_t full_revalidations;
+} rpki_stats;
+
 static struct cmd_node rpki_node = {
 	.name = "rpki",
 	.node = RPKI_NODE,
@@ -359,7 +383,7 @@ inline bool is_stopping(void)
 	return rtr_is_stopping;
 }
 
-static void pfx_record_to_prefix(struct pfx_record *record,
+static void pfx_record_to_prefix(const struct pfx_record *record,
 				 struct prefix *prefix)
 {
 	prefix->prefixlen = record->min_len;
@@ -374,40 +398,124 @@ static void pfx_record_to_prefix(struct pfx_record *record,
 	}
 }
 
-struct rpki_revalidate_prefix {
-	struct bgp *bgp;
-	struct prefix prefix;
-	afi_t afi;
-	safi_t safi;
-};
-
-static void rpki_revalidate_prefix(struct event *thread)
+/* revalidate all routes below the ROA prefix, returns number of dests */
+static unsigned int rpki_revalidate_subtree(struct bgp *bgp, afi_t afi,
+					    safi_t safi,
+					    const struct prefix *prefix)
 {
-	struct rpki_revalidate_prefix *rrp = EVENT_ARG(thread);
 	struct bgp_dest *match, *node;
+	unsigned int count = 0;
 
-	match = bgp_table_subtree_lookup(rrp->bgp->rib[rrp->afi][rrp->safi],
-					 &rrp->prefix);
+	match = bgp_table_subtree_lookup(bgp->rib[afi][safi], prefix);
 
 	node = match;
 
 	while (node) {
 		if (bgp_dest_has_bgp_path_info_data(node)) {
-			revalidate_bgp_node(node, rrp->afi, rrp->safi);
+			revalidate_bgp_node(node, afi, safi);
+			count++;
 		}
 
 		node = bgp_route_next_until(node, match);
 	}
 
-	XFREE(MTYPE_BGP_RPKI_REVALIDATE, rrp);
+	return count;
 }
 
-static void bgpd_sync_callback(struct event *thread)
+static bool rpki_pending_covered(const struct route_node *rn)
 {
-	struct bgp *bgp;
+	const struct route_node *parent;
+
+	for (parent = rn->parent; parent; parent = parent->parent)
+		if (parent->info)
+			return true;
+
+	return false;
+}
+
+static void rpki_revalidate_pending(struct event *thread)
+{
+	struct route_table *pending;
+	struct route_node *rn;
 	struct listnode *node;
+	struct bgp *bgp;
+	afi_t afi;
+	safi_t safi;
+
+	rpki_stats.revalidation_runs++;
+
+	for (afi = AFI_IP; afi <= AFI_IP6; afi++) {
+		/* changes arriving while we are busy go into a new trie */
+		pending = rpki_pending[afi];
+		rpki_pending[afi] = route_table_init();
+
+		for (rn = route_top(pending); rn; rn = route_next(rn)) {
+			if (!rn->info)
+				continue;
+
+			if (rpki_pending_covered(rn)) {
+				rpki_stats.roa_coalesced++;
+				continue;
+			}
+
+			for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
+				for (safi = SAFI_UNICAST; safi < SAFI_MAX;
+				     safi++) {
+					if (!bgp->rib[afi][safi])
+						continue;
+
+					rpki_stats.dests_revalidated +=
+						rpki_revalidate_subtree(bgp,
+									afi,
+									safi,
+									&rn->p);
+				}
+			}
+		}
+
+		route_table_finish(pending);
+	}
+}
+
+static void rpki_pending_add(const struct pfx_record *rec)
+{
 	struct prefix prefix;
+	struct route_node *rn;
+	afi_t afi;
+
+	pfx_record_to_prefix(rec, &prefix);
+	afi = (rec->prefix.ver == LRTR_IPV4) ? AFI_IP : AFI_IP6;
+
+	rpki_stats.roa_updates++;
+
+	rn = route_node_get(rpki_pending[afi], &prefix);
+	if (rn->info) {
+		/* changed again before we got around to it */
+		route_unlock_node(rn);
+		rpki_stats.roa_coalesced++;
+		return;
+	}
+	rn->info = rpki_pending;
+
+	event_add_event(bm->master, rpki_revalidate_pending, NULL, 0,
+			&t_rpki_revalidate);
+}
+
+static void rpki_pending_flush(void)
+{
+	afi_t afi;
+
+	EVENT_OFF(t_rpki_revalidate);
+	for (afi = AFI_IP; afi <= AFI_IP6; afi++) {
+		route_table_finish(rpki_pending[afi]);
+		rpki_pending[afi] = route_table_init();
+	}
+}
+
+static void bgpd_sync_callback(struct event *thread)
+{
 	struct pfx_record rec;
+	unsigned int i;
 
 	event_add_read(bm->master, bgpd_sync_callback, NULL,
 		       rpki_sync_socket_bgpd, NULL);
@@ -419,61 +527,33 @@ static void bgpd_sync_callback(struct event *thread)
 
 		atomic_store_explicit(&rtr_update_overflow, 0,
 				      memory_order_seq_cst);
-		revalidate_all_routes();
-		return;
-	}
 
-	int retval =
-		read(rpki_sync_socket_bgpd, &rec, sizeof(struct pfx_record));
-	if (retval != sizeof(struct pfx_record)) {
-		RPKI_DEBUG("Could not read from rpki_sync_socket_bgpd");
+		/* everything gets revalidated anyway */
+		rpki_pending_flush();
+		rpki_stats.full_revalidations++;
+		revalidate_all_routes();
 		return;
 	}
-	pfx_record_to_prefix(&rec, &prefix);
-
-	afi_t afi = (rec.prefix.ver == LRTR_IPV4) ? AFI_IP : AFI_IP6;
 
-	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
-		safi_t safi;
-
-		for (safi = SAFI_UNICAST; safi < SAFI_MAX; safi++) {
-			struct bgp_table *table = bgp->rib[afi][safi];
-			struct rpki_revalidate_prefix *rrp;
+	for (i = 0; i < RPKI_SYNC_BATCH; i++) {
+		ssize_t retval = read(rpki_sync_socket_bgpd, &rec,
+				      sizeof(struct pfx_record));
 
-			if (!table)
-				continue;
-
-			rrp = XCALLOC(MTYPE_BGP_RPKI_REVALIDATE, sizeof(*rrp));
-			rrp->bgp = bgp;
-			rrp->prefix = prefix;
-			rrp->afi = afi;
-			rrp->safi = safi;
-			event_add_event(bm->master, rpki_revalidate_prefix, rrp,
-					0, &bgp->t_revalidate[afi][safi]);
+		if (retval == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			break;
+		if (retval != sizeof(struct pfx_record)) {
+			RPKI_DEBUG("Could not read from rpki_sync_socket_bgpd");
+			break;
 		}
+
+		rpki_pending_add(&rec);
 	}
 }
 
 static void revalidate_bgp_node(struct bgp_dest *bgp_dest, afi_t afi,
 				safi_t safi)
 {
-	struct bgp_adj_in *ain;
-
-	for (ain = bgp_dest->adj_in; ain; ain = ain->next) {
-		struct bgp_path_info *path =
-			bgp_dest_get_bgp_path_info(bgp_dest);
-		mpls_label_t *label = NULL;
-		uint32_t num_labels = 0;
-
-		if (path && path->extra) {
-			label = path->extra->label;
-			num_labels = path->extra->num_labels;
-		}
-		(void)bgp_update(ain->peer, bgp_dest_get_prefix(bgp_dest),
-				 ain->addpath_rx_id, ain->attr, afi, safi,
-				 ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, NULL, label,
-				 num_labels, 1, NULL);
-	}
+	bgp_soft_reconfig_dest(NULL, bgp_dest, afi, safi, NULL);
 }
 
 /*
@@ -604,6 +684,9 @@ static int bgp_rpki_init(struct event_loop *master)
 	polling_period = POLLING_PERIOD_DEFAULT;
 	expire_interval = EXPIRE_INTERVAL_DEFAULT;
 	retry_interval = RETRY_INTERVAL_DEFAULT;
+	rpki_pending[AFI_IP] = route_table_init();
+	rpki_pending[AFI_IP6] = route_table_init();
+
 	install_cli_commands();
 	rpki_init_sync_socket();
 	return 0;
@@ -614,6 +697,10 @@ static int bgp_rpki_fini(void)
 	stop();
 	list_delete(&cache_list);
 
+	EVENT_OFF(t_rpki_revalidate);
+	route_table_finish(rpki_pending[AFI_IP]);
+	route_table_finish(rpki_pending[AFI_IP6]);
+
 	close(rpki_sync_socket_rtr);
 	close(rpki_sync_socket_bgpd);
 
@@ -832,6 +919,8 @@ static int rpki_validate_prefix(struct peer *peer, struct attr *attr,
 	as_t as_number = 0;
 	struct lrtr_ip_addr ip_addr_prefix;
 	enum pfxv_state result;
+	struct timeval start;
+	uint64_t elapsed;
 
 	if (!is_synchronized())
 		return RPKI_NOT_BEING_USED;
@@ -878,9 +967,16 @@ static int rpki_validate_prefix(struct peer *peer, struct attr *attr,
 	}
 
 	// Do the actual validation
+	monotime(&start);
 	rtr_mgr_validate(rtr_config, as_number, &ip_addr_prefix,
 			 prefix->prefixlen, &result);
 
+	elapsed = monotime_since(&start, NULL);
+	rpki_stats.lookups++;
+	rpki_stats.lookup_usec += elapsed;
+	if (elapsed > rpki_stats.lookup_max_usec)
+		rpki_stats.lookup_max_usec = elapsed;
+
 	// Print Debug output
 	switch (result) {
 	case BGP_PFXV_STATE_VALID:
@@ -1530,6 +1626,59 @@ DEFPY (show_rpki_cache_server,
 	return CMD_SUCCESS;
 }
 
+DEFPY (show_rpki_statistics,
+       show_rpki_statistics_cmd,
+       "show rpki statistics [json$uj]",
+       SHOW_STR
+       RPKI_OUTPUT_STRING
+       "Show validation and revalidation statistics\n"
+       JSON_STR)
+{
+	struct json_object *json;
+	uint64_t avg = 0;
+
+	if (rpki_stats.lookups)
+		avg = rpki_stats.lookup_usec / rpki_stats.lookups;
+
+	if (!uj) {
+		vty_out(vty, "Validation lookups: %" PRIu64 "\n",
+			rpki_stats.lookups);
+		vty_out(vty,
+			"Lookup time: %" PRIu64 " usec average, %" PRIu64
+			" usec max\n",
+			avg, rpki_stats.lookup_max_usec);
+		vty_out(vty,
+			"ROA updates received: %" PRIu64 ", %" PRIu64
+			" coalesced\n",
+			rpki_stats.roa_updates, rpki_stats.roa_coalesced);
+		vty_out(vty,
+			"Revalidation runs: %" PRIu64
+			", full revalidations: %" PRIu64 "\n",
+			rpki_stats.revalidation_runs,
+			rpki_stats.full_revalidations);
+		vty_out(vty, "Destinations revalidated: %" PRIu64 "\n",
+			rpki_stats.dests_revalidated);
+		return CMD_SUCCESS;
+	}
+
+	json = json_object_new_object();
+	json_object_int_add(json, "lookups", rpki_stats.lookups);
+	json_object_int_add(json, "lookupAvgUsecs", avg);
+	json_object_int_add(json, "lookupMaxUsecs", rpki_stats.lookup_max_usec);
+	json_object_int_add(json, "roaUpdates", rpki_stats.roa_updates);
+	json_object_int_add(json, "roaUpdatesCoalesced",
+			    rpki_stats.roa_coalesced);
+	json_object_int_add(json, "revalidationRuns",
+			    rpki_stats.revalidation_runs);
+	json_object_int_add(json, "fullRevalidations",
+			    rpki_stats.full_revalidations);
+	json_object_int_add(json, "destsRevalidated",
+			    rpki_stats.dests_revalidated);
+	vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
 DEFPY (show_rpki_cache_connection,
        show_rpki_cache_connection_cmd,
        "show rpki cache-connection [json$uj]",
@@ -1769,6 +1918,7 @@ static void install_cli_commands(void)
 	install_element(VIEW_NODE, &show_rpki_cache_server_cmd);
 	install_element(VIEW_NODE, &show_rpki_prefix_cmd);
 	install_element(VIEW_NODE, &show_rpki_as_number_cmd);
+	install_element(VIEW_NODE, &show_rpki_statistics_cmd);
 
 	/* Install debug commands */
 	install_element(CONFIG_NODE, &debug_rpki_cmd);
@@ -127,21 +127,72 @@ void lua_pushpeer(lua_State *L, const struct peer *peer)
 	lua_setfield(L, -2, "stats");
 }
 
+/*
+ * Attributes are passed as a view (see frrlua_view_push()), since they are
+ * pushed for every path a "match script" route-map runs on.  Fields other
+ * than aspath can be written and go straight into the attr that was passed.
+ */
+#define LUA_ATTR_VIEW "bgp.attr"
+
+static int lua_attr_view_index(lua_State *L)
+{
+	const struct attr *attr = frrlua_view_check(L, 1, LUA_ATTR_VIEW);
+	const char *key = luaL_checkstring(L, 2);
+
+	if (strmatch(key, "metric"))
+		lua_pushinteger(L, attr->med);
+	else if (strmatch(key, "ifindex"))
+		lua_pushinteger(L, attr->nh_ifindex);
+	else if (strmatch(key, "aspath"))
+		lua_pushstring(L, attr->aspath->str);
+	else if (strmatch(key, "localpref"))
+		lua_pushinteger(L, attr->local_pref);
+	else
+		lua_pushnil(L);
+	return 1;
+}
+
+static int lua_attr_view_newindex(lua_State *L)
+{
+	struct attr *attr = (struct attr *)frrlua_view_check(L, 1,
+							     LUA_ATTR_VIEW);
+	const char *key = luaL_checkstring(L, 2);
+	lua_Integer val = luaL_checkinteger(L, 3);
+
+	if (strmatch(key, "metric"))
+		attr->med = val;
+	else if (strmatch(key, "ifindex"))
+		attr->nh_ifindex = val;
+	else if (strmatch(key, "localpref"))
+		attr->local_pref = val;
+	else
+		return luaL_error(L, "attribute '%s' can't be set", key);
+	return 0;
+}
+
+static const luaL_Reg lua_attr_view_meta[] = {
+	{ "__index", lua_attr_view_index },
+	{ "__newindex", lua_attr_view_newindex },
+	{},
+};
+
 void lua_pushattr(lua_State *L, const struct attr *attr)
 {
-	lua_newtable(L);
-	lua_pushinteger(L, attr->med);
-	lua_setfield(L, -2, "metric");
-	lua_pushinteger(L, attr->nh_ifindex);
-	lua_setfield(L, -2, "ifindex");
-	lua_pushstring(L, attr->aspath->str);
-	lua_setfield(L, -2, "aspath");
-	lua_pushinteger(L, attr->local_pref);
-	lua_setfield(L, -2, "localpref");
+	frrlua_view_push(L, LUA_ATTR_VIEW, lua_attr_view_meta, attr);
 }
 
 void lua_decode_attr(lua_State *L, int idx, struct attr *attr)
 {
+	const struct attr *view = frrlua_view_get(L, idx, LUA_ATTR_VIEW);
+
+	/* Changes through a view are already in the attr it was pushed for */
+	if (view) {
+		if (view != attr)
+			*attr = *view;
+		lua_pop(L, 1);
+		return;
+	}
+
 	lua_getfield(L, idx, "metric");
 	attr->med = lua_tointeger(L, -1);
 	lua_pop(L, 1);
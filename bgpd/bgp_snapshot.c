@@ -0,0 +1,767 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP RIB snapshots for warm restarts.
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * With "bgp rib-snapshot FILE", the paths received from configured peers
+ * are written to FILE periodically and at shutdown.  When bgpd starts
+ * again and its configuration has been read, they are put back into the
+ * RIB as stale paths, so best paths exist before the peers have sent their
+ * tables again.  From there on the graceful restart stale path handling
+ * takes over: paths the peer sends again lose the stale flag, End-of-RIB
+ * removes the others, and if it never comes they are dropped when the
+ * stale path timer expires.
+ *
+ * The file is used through mmap() as it is: a header, a table of peers,
+ * fixed size path records and an offset table into the attributes.  Each
+ * attribute is stored once however many paths refer to it, and is only
+ * decoded once a path using it gets restored.  Host byte order is used
+ * throughout the fixed parts, a snapshot is only meant to be read back on
+ * the system that wrote it.
+ */
+
+#include <zebra.h>
+#include <sys/mman.h>
+
+#include "jhash.h"
+#include "lib/json.h"
+#include "memory.h"
+#include "monotime.h"
+#include "sockunion.h"
+#include "stream.h"
+#include "typesafe.h"
+#include "vty.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_debug.h"
+#include "bgpd/bgp_errors.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_snapshot.h"
+#include "bgpd/bgp_vty.h"
+
+DEFINE_MTYPE_STATIC(BGPD, BGP_SNAPSHOT, "BGP RIB snapshot");
+
+#define BGP_SNAPSHOT_MAGIC "FRRBGPRS"
+#define BGP_SNAPSHOT_VERSION 1
+#define BGP_SNAPSHOT_BYTEORDER 0x01020304U
+
+/* encoded attributes larger than this are not stored */
+#define BGP_SNAPSHOT_ATTR_MAX 65536
+
+struct bgp_snapshot_hdr {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteorder;
+
+	/* wall clock */
+	int64_t created;
+
+	uint32_t npeers;
+	uint32_t nattrs;
+	uint64_t npaths;
+
+	/* file offsets of the tables */
+	uint64_t peers_off;
+	uint64_t paths_off;
+	/* nattrs offsets, each to a uint32_t length followed by the data */
+	uint64_t attrs_off;
+
+	uint64_t size;
+};
+
+struct bgp_snapshot_peer {
+	/* empty for the default instance */
+	char name[64];
+	/* address, or interface for unnumbered peers */
+	char peer[64];
+};
+
+struct bgp_snapshot_path {
+	uint32_t peer;
+	uint32_t attr;
+	uint32_t addpath_rx_id;
+	uint16_t afi;
+	uint8_t safi;
+	uint8_t prefixlen;
+	uint8_t prefix[16];
+};
+
+PREDECL_HASH(bgp_snapshot_attrs);
+
+struct bgp_snapshot_attr {
+	struct bgp_snapshot_attrs_item item;
+	struct attr *attr;
+	/* UINT32_MAX if the attribute can't be stored */
+	uint32_t index;
+};
+
+static int bgp_snapshot_attr_cmp(const struct bgp_snapshot_attr *a,
+				 const struct bgp_snapshot_attr *b)
+{
+	return numcmp((uintptr_t)a->attr, (uintptr_t)b->attr);
+}
+
+static uint32_t bgp_snapshot_attr_hash(const struct bgp_snapshot_attr *a)
+{
+	return jhash(&a->attr, sizeof(a->attr), 0x5ab1e5ed);
+}
+
+DECLARE_HASH(bgp_snapshot_attrs, struct bgp_snapshot_attr, item,
+	     bgp_snapshot_attr_cmp, bgp_snapshot_attr_hash);
+
+static struct {
+	char *path;
+	unsigned int interval;
+	struct event *t_write;
+	bool restored;
+
+	/* last write */
+	time_t write_time;
+	uint64_t write_usec;
+	uint64_t write_paths;
+	uint32_t write_attrs;
+	uint64_t write_bytes;
+	int write_errno;
+
+	/* restore at startup */
+	time_t restore_time;
+	time_t restore_created;
+	uint64_t restore_usec;
+	uint64_t restore_paths;
+	uint64_t restore_skipped;
+} snapshot = {
+	.interval = BGP_SNAPSHOT_INTERVAL_DEFAULT,
+};
+
+/* the families that can be stored, see bgp_attr_snapshot_put() */
+#define FOREACH_SNAPSHOT_AFI_SAFI(afi, safi)                                   \
+	for (afi = AFI_IP; afi <= AFI_IP6; afi++)                              \
+		for (safi = SAFI_UNICAST; safi <= SAFI_MULTICAST; safi++)
+
+const char *bgp_snapshot_path(void)
+{
+	return snapshot.path;
+}
+
+unsigned int bgp_snapshot_interval(void)
+{
+	return snapshot.interval;
+}
+
+static bool bgp_snapshot_peer_ok(struct peer *peer)
+{
+	return !CHECK_FLAG(peer->sflags, PEER_STATUS_GROUP) &&
+	       !peer_dynamic_neighbor(peer) && peer != peer->bgp->peer_self;
+}
+
+static bool bgp_snapshot_path_ok(const struct bgp_path_info *pi)
+{
+	if (pi->type != ZEBRA_ROUTE_BGP || pi->sub_type != BGP_ROUTE_NORMAL)
+		return false;
+	if (CHECK_FLAG(pi->flags, BGP_PATH_REMOVED | BGP_PATH_HISTORY))
+		return false;
+
+	/* labeled unicast shares the table, labels are not kept */
+	return !pi->extra || !pi->extra->num_labels;
+}
+
+static const char *bgp_snapshot_peer_name(struct peer *peer)
+{
+	return peer->conf_if ? peer->conf_if : peer->host;
+}
+
+static bool bgp_snapshot_fwrite(FILE *fp, const void *data, size_t len,
+				uint64_t *off)
+{
+	if (len && fwrite(data, len, 1, fp) != 1)
+		return false;
+	*off += len;
+	return true;
+}
+
+static void bgp_snapshot_grow(uint64_t **offsets, uint32_t *alloc)
+{
+	*alloc = MAX(*alloc * 2, 1024U);
+	*offsets = XREALLOC(MTYPE_BGP_SNAPSHOT, *offsets,
+			    *alloc * sizeof(**offsets));
+}
+
+/* first pass: store every attribute in use once, in order of appearance */
+static bool bgp_snapshot_write_attrs(FILE *fp, uint64_t *off,
+				     struct bgp_snapshot_attrs_head *attrs,
+				     uint64_t **offsets, uint32_t *nattrs)
+{
+	struct bgp_snapshot_attr ref, *sa;
+	struct bgp_path_info *pi;
+	struct listnode *mnode, *node;
+	struct stream *s;
+	struct peer *peer;
+	struct bgp *bgp;
+	uint32_t alloc = 0, len;
+	afi_t afi;
+	safi_t safi;
+	bool ok = true;
+
+	s = stream_new(BGP_SNAPSHOT_ATTR_MAX);
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, mnode, bgp))
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
+			if (!bgp_snapshot_peer_ok(peer))
+				continue;
+
+			FOREACH_SNAPSHOT_AFI_SAFI (afi, safi)
+				frr_each (bgp_peer_paths,
+					  &peer->paths[afi][safi], pi) {
+					if (!bgp_snapshot_path_ok(pi))
+						continue;
+
+					ref.attr = pi->attr;
+					if (bgp_snapshot_attrs_find(attrs,
+								    &ref))
+						continue;
+
+					sa = XCALLOC(MTYPE_BGP_SNAPSHOT,
+						     sizeof(*sa));
+					sa->attr = pi->attr;
+					sa->index = UINT32_MAX;
+					bgp_snapshot_attrs_add(attrs, sa);
+
+					stream_reset(s);
+					if (!bgp_attr_snapshot_put(s, pi->attr))
+						continue;
+
+					if (*nattrs == alloc)
+						bgp_snapshot_grow(offsets,
+								  &alloc);
+
+					sa->index = *nattrs;
+					(*offsets)[(*nattrs)++] = *off;
+
+					len = stream_get_endp(s);
+					ok = bgp_snapshot_fwrite(fp, &len,
+								 sizeof(len),
+								 off) &&
+					     bgp_snapshot_fwrite(fp,
+								 STREAM_DATA(s),
+								 len, off);
+					if (!ok)
+						goto out;
+				}
+		}
+
+out:
+	stream_free(s);
+	return ok;
+}
+
+/* second pass: the peers and their paths, same order as the first one */
+static bool bgp_snapshot_write_paths(FILE *fp, uint64_t *off,
+				     struct bgp_snapshot_attrs_head *attrs,
+				     uint64_t *npaths)
+{
+	struct bgp_snapshot_path rec;
+	struct bgp_snapshot_attr ref, *sa;
+	struct bgp_path_info *pi;
+	struct listnode *mnode, *node;
+	const struct prefix *p;
+	struct peer *peer;
+	struct bgp *bgp;
+	uint32_t index = 0;
+	iana_afi_t pkt_afi;
+	iana_safi_t pkt_safi;
+	afi_t afi;
+	safi_t safi;
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, mnode, bgp))
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
+			if (!bgp_snapshot_peer_ok(peer))
+				continue;
+
+			FOREACH_SNAPSHOT_AFI_SAFI (afi, safi) {
+				bgp_map_afi_safi_int2iana(afi, safi, &pkt_afi,
+							  &pkt_safi);
+
+				frr_each (bgp_peer_paths,
+					  &peer->paths[afi][safi], pi) {
+					if (!bgp_snapshot_path_ok(pi))
+						continue;
+
+					ref.attr = pi->attr;
+					sa = bgp_snapshot_attrs_find(attrs,
+								     &ref);
+					if (!sa || sa->index == UINT32_MAX)
+						continue;
+
+					p = bgp_dest_get_prefix(pi->net);
+					memset(&rec, 0, sizeof(rec));
+					rec.peer = index;
+					rec.attr = sa->index;
+					rec.addpath_rx_id = pi->addpath_rx_id;
+					rec.afi = pkt_afi;
+					rec.safi = pkt_safi;
+					rec.prefixlen = p->prefixlen;
+					memcpy(rec.prefix, &p->u.prefix,
+					       prefix_blen(p));
+
+					if (!bgp_snapshot_fwrite(fp, &rec,
+								 sizeof(rec),
+								 off))
+						return false;
+					(*npaths)++;
+				}
+			}
+			index++;
+		}
+
+	return true;
+}
+
+static bool bgp_snapshot_write_peers(FILE *fp, uint64_t *off,
+				     uint32_t *npeers)
+{
+	struct bgp_snapshot_peer rec;
+	struct listnode *mnode, *node;
+	struct peer *peer;
+	struct bgp *bgp;
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, mnode, bgp))
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
+			if (!bgp_snapshot_peer_ok(peer))
+				continue;
+
+			memset(&rec, 0, sizeof(rec));
+			if (bgp->name)
+				strlcpy(rec.name, bgp->name, sizeof(rec.name));
+			strlcpy(rec.peer, bgp_snapshot_peer_name(peer),
+				sizeof(rec.peer));
+
+			if (!bgp_snapshot_fwrite(fp, &rec, sizeof(rec), off))
+				return false;
+			(*npeers)++;
+		}
+
+	return true;
+}
+
+int bgp_snapshot_write(void)
+{
+	struct bgp_snapshot_attrs_head attrs;
+	struct bgp_snapshot_attr *sa;
+	struct bgp_snapshot_hdr hdr = {};
+	char tmpname[MAXPATHLEN];
+	uint64_t *offsets = NULL;
+	uint64_t off = sizeof(hdr);
+	static const uint8_t pad[8];
+	struct timeval start;
+	bool ok;
+	FILE *fp;
+	int fd;
+
+	if (!snapshot.path)
+		return -1;
+
+	monotime(&start);
+	snprintf(tmpname, sizeof(tmpname), "%s.tmp", snapshot.path);
+
+	fd = open(tmpname, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	fp = fd >= 0 ? fdopen(fd, "w") : NULL;
+	if (!fp) {
+		snapshot.write_errno = errno;
+		flog_warn(EC_BGP_SNAPSHOT, "%s: %s: %s", __func__, tmpname,
+			  safe_strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+
+	memcpy(hdr.magic, BGP_SNAPSHOT_MAGIC, sizeof(hdr.magic));
+	hdr.version = BGP_SNAPSHOT_VERSION;
+	hdr.byteorder = BGP_SNAPSHOT_BYTEORDER;
+	hdr.created = time(NULL);
+
+	bgp_snapshot_attrs_init(&attrs);
+
+	/* header is written last, once everything is known */
+	ok = fseek(fp, sizeof(hdr), SEEK_SET) == 0;
+
+	hdr.peers_off = off;
+	ok = ok && bgp_snapshot_write_peers(fp, &off, &hdr.npeers);
+	ok = ok && bgp_snapshot_write_attrs(fp, &off, &attrs, &offsets,
+					    &hdr.nattrs);
+
+	/* keep the fixed size records aligned */
+	ok = ok && bgp_snapshot_fwrite(fp, pad, (8 - off % 8) % 8, &off);
+	hdr.paths_off = off;
+	ok = ok && bgp_snapshot_write_paths(fp, &off, &attrs, &hdr.npaths);
+
+	hdr.attrs_off = off;
+	ok = ok && bgp_snapshot_fwrite(fp, offsets,
+				       hdr.nattrs * sizeof(uint64_t), &off);
+	hdr.size = off;
+
+	ok = ok && fseek(fp, 0, SEEK_SET) == 0 &&
+	     fwrite(&hdr, sizeof(hdr), 1, fp) == 1;
+	ok = ok && fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+	if (!ok)
+		snapshot.write_errno = errno;
+	ok = fclose(fp) == 0 && ok;
+
+	while ((sa = bgp_snapshot_attrs_pop(&attrs)))
+		XFREE(MTYPE_BGP_SNAPSHOT, sa);
+	bgp_snapshot_attrs_fini(&attrs);
+	XFREE(MTYPE_BGP_SNAPSHOT, offsets);
+
+	if (ok && rename(tmpname, snapshot.path) == 0) {
+		snapshot.write_errno = 0;
+		snapshot.write_time = hdr.created;
+		snapshot.write_usec = monotime_since(&start, NULL);
+		snapshot.write_paths = hdr.npaths;
+		snapshot.write_attrs = hdr.nattrs;
+		snapshot.write_bytes = hdr.size;
+
+		if (BGP_DEBUG(graceful_restart, GRACEFUL_RESTART))
+			zlog_debug("RIB snapshot %s: %" PRIu64
+				   " paths, %u attributes in %" PRIu64 " ms",
+				   snapshot.path, hdr.npaths, hdr.nattrs,
+				   snapshot.write_usec / 1000);
+		return 0;
+	}
+
+	if (!snapshot.write_errno)
+		snapshot.write_errno = errno;
+	flog_warn(EC_BGP_SNAPSHOT, "%s: writing %s failed: %s", __func__,
+		  snapshot.path, safe_strerror(snapshot.write_errno));
+	unlink(tmpname);
+	return -1;
+}
+
+static void bgp_snapshot_timer(struct event *thread)
+{
+	event_add_timer(bm->master, bgp_snapshot_timer, NULL,
+			snapshot.interval, &snapshot.t_write);
+
+	bgp_snapshot_write();
+}
+
+void bgp_snapshot_set(const char *path, unsigned int interval)
+{
+	EVENT_OFF(snapshot.t_write);
+	XFREE(MTYPE_BGP_SNAPSHOT, snapshot.path);
+	snapshot.interval = interval;
+
+	if (!path)
+		return;
+
+	snapshot.path = XSTRDUP(MTYPE_BGP_SNAPSHOT, path);
+	event_add_timer(bm->master, bgp_snapshot_timer, NULL,
+			snapshot.interval, &snapshot.t_write);
+}
+
+/* no End-of-RIB came in time, drop what the peers didn't send again */
+static void bgp_snapshot_stale_expire(struct event *thread)
+{
+	struct bgp *bgp = EVENT_ARG(thread);
+	struct listnode *node;
+	struct peer *peer;
+	afi_t afi;
+	safi_t safi;
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer))
+		FOREACH_SNAPSHOT_AFI_SAFI (afi, safi) {
+			if (!peer->snapshot_stale[afi][safi])
+				continue;
+
+			if (bgp_debug_neighbor_events(peer))
+				zlog_debug(
+					"%pBP %s snapshot stale timer expired",
+					peer,
+					get_afi_safi_str(afi, safi, false));
+
+			peer->snapshot_stale[afi][safi] = false;
+			bgp_clear_stale_route(peer, afi, safi);
+		}
+}
+
+static struct peer *
+bgp_snapshot_peer_lookup(const struct bgp_snapshot_peer *rec)
+{
+	union sockunion su;
+	struct bgp *bgp;
+	struct peer *peer;
+
+	if (!memchr(rec->name, '\0', sizeof(rec->name)) ||
+	    !memchr(rec->peer, '\0', sizeof(rec->peer)))
+		return NULL;
+
+	bgp = rec->name[0] ? bgp_lookup_by_name(rec->name) : bgp_get_default();
+	if (!bgp)
+		return NULL;
+
+	peer = peer_lookup_by_conf_if(bgp, rec->peer);
+	if (!peer && str2sockunion(rec->peer, &su) == 0)
+		peer = peer_lookup(bgp, &su);
+	if (!peer || !bgp_snapshot_peer_ok(peer))
+		return NULL;
+
+	return peer;
+}
+
+static bool bgp_snapshot_hdr_ok(const struct bgp_snapshot_hdr *hdr,
+				size_t size)
+{
+	if (memcmp(hdr->magic, BGP_SNAPSHOT_MAGIC, sizeof(hdr->magic)) ||
+	    hdr->version != BGP_SNAPSHOT_VERSION ||
+	    hdr->byteorder != BGP_SNAPSHOT_BYTEORDER || hdr->size != size)
+		return false;
+
+	if (hdr->peers_off > size ||
+	    hdr->npeers > (size - hdr->peers_off) /
+				  sizeof(struct bgp_snapshot_peer))
+		return false;
+	if (hdr->paths_off > size || hdr->paths_off % 8 ||
+	    hdr->npaths > (size - hdr->paths_off) /
+				  sizeof(struct bgp_snapshot_path))
+		return false;
+	if (hdr->attrs_off > size ||
+	    hdr->nattrs > (size - hdr->attrs_off) / sizeof(uint64_t))
+		return false;
+
+	return true;
+}
+
+static struct attr *bgp_snapshot_attr_get(const uint8_t *map, size_t size,
+					  const struct bgp_snapshot_hdr *hdr,
+					  uint32_t index, struct bgp *bgp,
+					  struct stream *s)
+{
+	uint64_t off;
+	uint32_t len;
+
+	memcpy(&off, map + hdr->attrs_off + index * sizeof(uint64_t),
+	       sizeof(off));
+	if (off > size - sizeof(len))
+		return NULL;
+	memcpy(&len, map + off, sizeof(len));
+	if (len > size - off - sizeof(len) || len > STREAM_SIZE(s))
+		return NULL;
+
+	stream_reset(s);
+	stream_put(s, map + off + sizeof(len), len);
+	return bgp_attr_snapshot_get(bgp, s);
+}
+
+static void bgp_snapshot_load(const uint8_t *map, size_t size)
+{
+	const struct bgp_snapshot_hdr *hdr = (const void *)map;
+	const struct bgp_snapshot_path *paths;
+	struct bgp_snapshot_peer prec;
+	struct peer **peers;
+	struct attr **attrs;
+	struct stream *s;
+	struct prefix p;
+	afi_t afi;
+	safi_t safi;
+	uint64_t i;
+
+	peers = XCALLOC(MTYPE_BGP_SNAPSHOT,
+			MAX(hdr->npeers, 1U) * sizeof(*peers));
+	attrs = XCALLOC(MTYPE_BGP_SNAPSHOT,
+			MAX(hdr->nattrs, 1U) * sizeof(*attrs));
+	s = stream_new(BGP_SNAPSHOT_ATTR_MAX);
+
+	for (i = 0; i < hdr->npeers; i++) {
+		memcpy(&prec, map + hdr->peers_off + i * sizeof(prec),
+		       sizeof(prec));
+		peers[i] = bgp_snapshot_peer_lookup(&prec);
+	}
+
+	paths = (const void *)(map + hdr->paths_off);
+	for (i = 0; i < hdr->npaths; i++) {
+		const struct bgp_snapshot_path *rec = &paths[i];
+		struct peer *peer;
+
+		peer = rec->peer < hdr->npeers ? peers[rec->peer] : NULL;
+		if (!peer || rec->attr >= hdr->nattrs ||
+		    bgp_map_afi_safi_iana2int(rec->afi, rec->safi, &afi,
+					      &safi) ||
+		    (afi != AFI_IP && afi != AFI_IP6) ||
+		    (safi != SAFI_UNICAST && safi != SAFI_MULTICAST) ||
+		    !peer->afc[afi][safi] ||
+		    rec->prefixlen > (afi == AFI_IP ? IPV4_MAX_BITLEN
+						    : IPV6_MAX_BITLEN)) {
+			snapshot.restore_skipped++;
+			continue;
+		}
+
+		if (!attrs[rec->attr])
+			attrs[rec->attr] = bgp_snapshot_attr_get(map, size, hdr,
+								 rec->attr,
+								 peer->bgp, s);
+		if (!attrs[rec->attr]) {
+			snapshot.restore_skipped++;
+			continue;
+		}
+
+		memset(&p, 0, sizeof(p));
+		p.family = afi2family(afi);
+		p.prefixlen = rec->prefixlen;
+		memcpy(&p.u.prefix, rec->prefix, prefix_blen(&p));
+		apply_mask(&p);
+
+		bgp_restore_stale_route(peer, &p, rec->addpath_rx_id,
+					attrs[rec->attr], afi, safi);
+		peer->snapshot_stale[afi][safi] = true;
+		snapshot.restore_paths++;
+
+		if (!peer->bgp->t_snapshot_stale)
+			event_add_timer(bm->master, bgp_snapshot_stale_expire,
+					peer->bgp, peer->bgp->stalepath_time,
+					&peer->bgp->t_snapshot_stale);
+	}
+
+	for (i = 0; i < hdr->nattrs; i++)
+		if (attrs[i])
+			bgp_attr_unintern(&attrs[i]);
+
+	stream_free(s);
+	XFREE(MTYPE_BGP_SNAPSHOT, attrs);
+	XFREE(MTYPE_BGP_SNAPSHOT, peers);
+}
+
+void bgp_snapshot_restore(void)
+{
+	const struct bgp_snapshot_hdr *hdr;
+	struct timeval start;
+	struct stat st;
+	void *map;
+	int fd;
+
+	/* the startup configuration only, never a later reload */
+	if (snapshot.restored)
+		return;
+	snapshot.restored = true;
+	if (!snapshot.path)
+		return;
+
+	fd = open(snapshot.path, O_RDONLY);
+	if (fd < 0) {
+		if (errno != ENOENT)
+			flog_warn(EC_BGP_SNAPSHOT, "%s: %s: %s", __func__,
+				  snapshot.path, safe_strerror(errno));
+		return;
+	}
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(*hdr)) {
+		flog_warn(EC_BGP_SNAPSHOT, "%s: %s is truncated", __func__,
+			  snapshot.path);
+		close(fd);
+		return;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		flog_warn(EC_BGP_SNAPSHOT, "%s: mmap %s: %s", __func__,
+			  snapshot.path, safe_strerror(errno));
+		return;
+	}
+
+	hdr = map;
+	if (!bgp_snapshot_hdr_ok(hdr, st.st_size)) {
+		flog_warn(EC_BGP_SNAPSHOT, "%s: %s is not a usable snapshot",
+			  __func__, snapshot.path);
+		goto out;
+	}
+
+	/* anything older than a couple of write intervals is not worth it */
+	if (time(NULL) - hdr->created > 2 * (time_t)snapshot.interval) {
+		zlog_info("RIB snapshot %s is too old, not restoring it",
+			  snapshot.path);
+		goto out;
+	}
+
+	monotime(&start);
+	snapshot.restore_time = time(NULL);
+	snapshot.restore_created = hdr->created;
+	bgp_snapshot_load(map, st.st_size);
+	snapshot.restore_usec = monotime_since(&start, NULL);
+
+	zlog_info("RIB snapshot %s: restored %" PRIu64 " paths (%" PRIu64
+		  " skipped) in %" PRIu64 " ms",
+		  snapshot.path, snapshot.restore_paths,
+		  snapshot.restore_skipped, snapshot.restore_usec / 1000);
+
+out:
+	munmap(map, st.st_size);
+}
+
+void bgp_snapshot_show(struct vty *vty, json_object *json)
+{
+	if (json) {
+		if (!snapshot.path)
+			return;
+
+		json_object_string_add(json, "file", snapshot.path);
+		json_object_int_add(json, "intervalSecs", snapshot.interval);
+		json_object_int_add(json, "lastWrite", snapshot.write_time);
+		json_object_int_add(json, "lastWriteMsecs",
+				    snapshot.write_usec / 1000);
+		json_object_int_add(json, "lastWritePaths",
+				    snapshot.write_paths);
+		json_object_int_add(json, "lastWriteAttributes",
+				    snapshot.write_attrs);
+		json_object_int_add(json, "lastWriteBytes",
+				    snapshot.write_bytes);
+		if (snapshot.write_errno)
+			json_object_string_add(
+				json, "lastWriteError",
+				safe_strerror(snapshot.write_errno));
+		if (snapshot.restore_time) {
+			json_object_int_add(json, "restoredCreated",
+					    snapshot.restore_created);
+			json_object_int_add(json, "restoredPaths",
+					    snapshot.restore_paths);
+			json_object_int_add(json, "restoreSkipped",
+					    snapshot.restore_skipped);
+			json_object_int_add(json, "restoreMsecs",
+					    snapshot.restore_usec / 1000);
+		}
+		return;
+	}
+
+	if (!snapshot.path) {
+		vty_out(vty, "BGP RIB snapshots are disabled\n");
+		return;
+	}
+
+	vty_out(vty, "File: %s, every %u seconds\n", snapshot.path,
+		snapshot.interval);
+	if (snapshot.write_time)
+		vty_out(vty,
+			"Last write: %" PRIu64 " paths, %u attributes, %" PRIu64
+			" bytes in %" PRIu64 " ms, %lld seconds ago\n",
+			snapshot.write_paths, snapshot.write_attrs,
+			snapshot.write_bytes, snapshot.write_usec / 1000,
+			(long long)(time(NULL) - snapshot.write_time));
+	else
+		vty_out(vty, "Last write: never\n");
+	if (snapshot.write_errno)
+		vty_out(vty, "Last write failed: %s\n",
+			safe_strerror(snapshot.write_errno));
+	if (snapshot.restore_time)
+		vty_out(vty,
+			"Restored at startup: %" PRIu64 " paths (%" PRIu64
+			" skipped) in %" PRIu64
+			" ms, snapshot was %lld seconds old\n",
+			snapshot.restore_paths, snapshot.restore_skipped,
+			snapshot.restore_usec / 1000,
+			(long long)(snapshot.restore_time -
+				    snapshot.restore_created));
+}
+
+void bgp_snapshot_finish(void)
+{
+	EVENT_OFF(snapshot.t_write);
+	if (snapshot.path)
+		bgp_snapshot_write();
+	XFREE(MTYPE_BGP_SNAPSHOT, snapshot.path);
+}
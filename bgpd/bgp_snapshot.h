@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP RIB snapshots for warm restarts.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#ifndef _FRR_BGP_SNAPSHOT_H
+#define _FRR_BGP_SNAPSHOT_H
+
+#include "lib/json.h"
+#include "vty.h"
+
+#define BGP_SNAPSHOT_INTERVAL_DEFAULT 300
+
+/* configured file, NULL if snapshots are disabled */
+extern const char *bgp_snapshot_path(void);
+extern unsigned int bgp_snapshot_interval(void);
+
+/* enable (or reconfigure) snapshots, path NULL disables them */
+extern void bgp_snapshot_set(const char *path, unsigned int interval);
+
+/* write a snapshot now, 0 on success */
+extern int bgp_snapshot_write(void);
+
+/*
+ * Put the paths of the configured file back into the RIB as stale paths.
+ * Only does something once, on the end of the startup configuration.
+ */
+extern void bgp_snapshot_restore(void);
+
+extern void bgp_snapshot_show(struct vty *vty, json_object *json);
+
+/* final snapshot on shutdown */
+extern void bgp_snapshot_finish(void);
+
+#endif /* _FRR_BGP_SNAPSHOT_H */
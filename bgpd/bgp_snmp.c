@@ -30,6 +30,116 @@
 #include "bgpd/bgp_snmp_bgp4v2.h"
 #include "bgpd/bgp_mplsvpn_snmp.h"
 
+/*
+ * Snapshots of the default instance's unicast paths, per afi, in the order of
+ * the bgp4PathAttrTable and bgp4v2NlriTable rows: prefix, prefix length and
+ * peer address.  Only paths from peers of the prefix's family are listed,
+ * the exact lookups can't find the others anyway.
+ */
+static struct smux_index_cache *bgp_snmp_path_cache[AFI_MAX];
+
+struct bgp_snmp_path_arg {
+	struct bgp *bgp;
+	afi_t afi;
+};
+
+static void bgp_snmp_path_fill(struct smux_index_cache *cache, void *arg)
+{
+	struct bgp_snmp_path_arg *pa = arg;
+	size_t alen = pa->afi == AFI_IP ? IN_ADDR_SIZE : IN6_ADDR_SIZE;
+	uint8_t index[2 * IN6_ADDR_SIZE + 1];
+	struct bgp_path_info *path;
+	struct bgp_dest *dest;
+
+	for (dest = bgp_table_top(pa->bgp->rib[pa->afi][SAFI_UNICAST]); dest;
+	     dest = bgp_route_next(dest)) {
+		const struct prefix *p = bgp_dest_get_prefix(dest);
+
+		memcpy(index, &p->u.prefix, alen);
+		index[alen] = p->prefixlen;
+
+		for (path = bgp_dest_get_bgp_path_info(dest); path;
+		     path = path->next) {
+			if (sockunion_family(&path->peer->su) != p->family)
+				continue;
+
+			memcpy(index + alen + 1,
+			       sockunion_get_addr(&path->peer->su), alen);
+			smux_index_cache_add(cache, index, NULL);
+		}
+	}
+}
+
+struct bgp_path_info *bgp_snmp_path_next(struct bgp *bgp, afi_t afi,
+					 oid name[], size_t *length,
+					 size_t namelen)
+{
+	struct bgp_snmp_path_arg arg = { .bgp = bgp, .afi = afi };
+	size_t alen = afi == AFI_IP ? IN_ADDR_SIZE : IN6_ADDR_SIZE;
+	size_t index_len = 2 * alen + 1;
+	oid key[2 * IN6_ADDR_SIZE + 1], index[2 * IN6_ADDR_SIZE + 1];
+	const oid *kp = name + namelen;
+	size_t len = *length - namelen;
+	struct bgp_path_info *path = NULL;
+	struct bgp_dest *dest;
+	struct prefix p;
+	uint8_t paddr[IN6_ADDR_SIZE];
+	size_t i;
+
+	if (!bgp_snmp_path_cache[afi])
+		bgp_snmp_path_cache[afi] = smux_index_cache_new(
+			index_len, 0, bgp_snmp_path_fill);
+
+	while (smux_index_cache_lookup(bgp_snmp_path_cache[afi], kp, len,
+				       false, index, &arg)) {
+		memset(&p, 0, sizeof(p));
+		p.family = afi2family(afi);
+		for (i = 0; i < alen; i++) {
+			((uint8_t *)&p.u.prefix)[i] = index[i];
+			paddr[i] = index[alen + 1 + i];
+		}
+		p.prefixlen = index[alen];
+
+		/* the snapshot may be older than the table */
+		dest = bgp_node_lookup(bgp->rib[afi][SAFI_UNICAST], &p);
+		if (dest) {
+			for (path = bgp_dest_get_bgp_path_info(dest); path;
+			     path = path->next)
+				if (sockunion_family(&path->peer->su)
+					    == p.family
+				    && !memcmp(sockunion_get_addr(
+						       &path->peer->su),
+					       paddr, alen))
+					break;
+
+			bgp_dest_unlock_node(dest);
+		}
+		if (path)
+			break;
+
+		memcpy(key, index, index_len * sizeof(oid));
+		kp = key;
+		len = index_len;
+	}
+
+	if (!path)
+		return NULL;
+
+	*length = namelen + index_len;
+	for (i = 0; i < index_len; i++)
+		name[namelen + i] = index[i];
+	return path;
+}
+
+static int bgp_snmp_fini(void)
+{
+	afi_t afi;
+
+	for (afi = AFI_IP; afi < AFI_MAX; afi++)
+		smux_index_cache_free(&bgp_snmp_path_cache[afi]);
+	return 0;
+}
+
 static int bgp_snmp_init(struct event_loop *tm)
 {
 	smux_init(tm);
@@ -44,6 +154,7 @@ static int bgp_snmp_module_init(void)
 	hook_register(peer_status_changed, bgpTrapEstablished);
 	hook_register(peer_backward_transition, bgpTrapBackwardTransition);
 	hook_register(frr_late_init, bgp_snmp_init);
+	hook_register(frr_fini, bgp_snmp_fini);
 	return 0;
 }
 
@@ -15,4 +15,13 @@
 #define IPADDRESS ASN_IPADDRESS
 #define GAUGE32 ASN_UNSIGNED
 
+/*
+ * GETNEXT for the path attribute tables, from a snapshot of the unicast
+ * table of afi.  The index after namelen is prefix, prefix length and peer
+ * address; name and length are updated to the row found.
+ */
+extern struct bgp_path_info *bgp_snmp_path_next(struct bgp *bgp, afi_t afi,
+						oid name[], size_t *length,
+						size_t namelen);
+
 #endif /* _FRR_BGP_SNMP_H_ */
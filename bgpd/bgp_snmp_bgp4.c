@@ -415,10 +415,22 @@ static struct bgp_path_info *bgp4PathAttrLookup(struct variable *v, oid name[],
 			for (path = bgp_dest_get_bgp_path_info(dest); path;
 			     path = path->next)
 				if (sockunion_same(&path->peer->su, &su))
-					return path;
+					break;
 
 			bgp_dest_unlock_node(dest);
+			return path;
 		}
+	} else if (smux_index_cache_enabled()) {
+		path = bgp_snmp_path_next(bgp, AFI_IP, name, length,
+					  v->namelen);
+		if (path) {
+			const struct prefix *rn_p =
+				bgp_dest_get_prefix(path->net);
+
+			addr->prefix = rn_p->u.prefix4;
+			addr->prefixlen = rn_p->prefixlen;
+		}
+		return path;
 	} else {
 		offset = name + v->namelen;
 		offsetlen = *length - v->namelen;
@@ -468,14 +468,22 @@ bgp4v2PathAttrLookup(struct variable *v, oid name[], size_t *length,
 			for (path = bgp_dest_get_bgp_path_info(dest); path;
 			     path = path->next)
 				if (sockunion_same(&path->peer->su, &su))
-					return path;
+					break;
 
 			bgp_dest_unlock_node(dest);
+			return path;
 		}
 
 		return NULL;
 	}
 
+	if (smux_index_cache_enabled()) {
+		path = bgp_snmp_path_next(bgp, afi, name, length, namelen);
+		if (path)
+			prefix_copy(addr, bgp_dest_get_prefix(path->net));
+		return path;
+	}
+
 	offset = name + namelen;
 	offsetlen = *length - namelen;
 	len = offsetlen;
@@ -12,12 +12,115 @@
 #include "filter.h"
 #include "command.h"
 #include "printfrr.h"
+#include "typesafe.h"
+#include "lib/json.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_table.h"
 #include "bgp_addpath.h"
 #include "bgp_trace.h"
 
+DEFINE_MTYPE_STATIC(BGPD, BGP_NODE_POOL, "BGP node pool");
+
+/*
+ * Node pools.
+ *
+ * By default every bgp_node is a separate allocation scattered over the
+ * heap, and walking a large table means a cache miss (and often a TLB
+ * miss) per node.  Tables created with a pool carve their nodes out of
+ * chunks of BGP_NODE_CHUNK_SIZE nodes instead, so nodes created together,
+ * e.g. a full table learned from one peer, sit next to each other.  Free
+ * nodes are chained through their pdest field, and a chunk goes back to
+ * the allocator as soon as its last node is destroyed.
+ */
+#define BGP_NODE_CHUNK_SIZE 512
+
+PREDECL_DLIST(bgp_node_chunks);
+
+struct bgp_node_chunk {
+	struct bgp_node_chunks_item item;
+	struct bgp_node_pool *pool;
+
+	struct bgp_node *free;
+	unsigned int used;
+	unsigned int carved;
+
+	struct bgp_node nodes[BGP_NODE_CHUNK_SIZE];
+};
+
+DECLARE_DLIST(bgp_node_chunks, struct bgp_node_chunk, item);
+
+struct bgp_node_pool {
+	/* chunks that have at least one free node */
+	struct bgp_node_chunks_head partial;
+
+	size_t chunks;
+	size_t nodes;
+};
+
+/* totals over all pools, for "show bgp node-pool" */
+static size_t bgp_node_pool_tables;
+static size_t bgp_node_pool_chunks;
+static size_t bgp_node_pool_nodes;
+
+static struct bgp_node *bgp_node_pool_get(struct bgp_node_pool *pool)
+{
+	struct bgp_node_chunk *chunk;
+	struct bgp_node *node;
+
+	chunk = bgp_node_chunks_first(&pool->partial);
+	if (!chunk) {
+		/* nodes are cleared as they are handed out */
+		chunk = XMALLOC(MTYPE_BGP_NODE_POOL, sizeof(*chunk));
+		chunk->pool = pool;
+		chunk->free = NULL;
+		chunk->used = 0;
+		chunk->carved = 0;
+		bgp_node_chunks_add_head(&pool->partial, chunk);
+		pool->chunks++;
+		bgp_node_pool_chunks++;
+	}
+
+	if (chunk->free) {
+		node = chunk->free;
+		chunk->free = node->pdest;
+	} else
+		node = &chunk->nodes[chunk->carved++];
+
+	if (++chunk->used == BGP_NODE_CHUNK_SIZE)
+		bgp_node_chunks_del(&pool->partial, chunk);
+
+	memset(node, 0, sizeof(*node));
+	node->chunk = chunk;
+	pool->nodes++;
+	bgp_node_pool_nodes++;
+
+	return node;
+}
+
+static void bgp_node_pool_put(struct bgp_node *node)
+{
+	struct bgp_node_chunk *chunk = node->chunk;
+	struct bgp_node_pool *pool = chunk->pool;
+
+	pool->nodes--;
+	bgp_node_pool_nodes--;
+
+	if (chunk->used-- == BGP_NODE_CHUNK_SIZE)
+		bgp_node_chunks_add_head(&pool->partial, chunk);
+
+	if (!chunk->used) {
+		bgp_node_chunks_del(&pool->partial, chunk);
+		pool->chunks--;
+		bgp_node_pool_chunks--;
+		XFREE(MTYPE_BGP_NODE_POOL, chunk);
+		return;
+	}
+
+	node->pdest = chunk->free;
+	chunk->free = node;
+}
+
 void bgp_table_lock(struct bgp_table *rt)
 {
 	rt->lock++;
@@ -35,6 +138,14 @@ void bgp_table_unlock(struct bgp_table *rt)
 	route_table_finish(rt->route_table);
 	rt->route_table = NULL;
 
+	if (rt->pool) {
+		/* route_table_finish() destroyed every node */
+		assert(!rt->pool->nodes);
+		bgp_node_chunks_fini(&rt->pool->partial);
+		XFREE(MTYPE_BGP_NODE_POOL, rt->pool);
+		bgp_node_pool_tables--;
+	}
+
 	XFREE(MTYPE_BGP_TABLE, rt);
 }
 
@@ -88,8 +199,13 @@ const char *bgp_dest_get_prefix_str(struct bgp_dest *dest)
 static struct route_node *bgp_node_create(route_table_delegate_t *delegate,
 					  struct route_table *table)
 {
+	struct bgp_table *rt = table->info;
 	struct bgp_node *node;
-	node = XCALLOC(MTYPE_BGP_NODE, sizeof(struct bgp_node));
+
+	if (rt && rt->pool)
+		node = bgp_node_pool_get(rt->pool);
+	else
+		node = XCALLOC(MTYPE_BGP_NODE, sizeof(struct bgp_node));
 
 	RB_INIT(bgp_adj_out_rb, &node->adj_out);
 	return bgp_dest_to_rnode(node);
@@ -112,7 +228,10 @@ static void bgp_node_destroy(route_table_delegate_t *delegate,
 					 rt->afi, rt->safi);
 	}
 
-	XFREE(MTYPE_BGP_NODE, bgp_node);
+	if (bgp_node->chunk)
+		bgp_node_pool_put(bgp_node);
+	else
+		XFREE(MTYPE_BGP_NODE, bgp_node);
 }
 
 /*
@@ -126,11 +245,24 @@ route_table_delegate_t bgp_table_delegate = {.create_node = bgp_node_create,
  * bgp_table_init
  */
 struct bgp_table *bgp_table_init(struct bgp *bgp, afi_t afi, safi_t safi)
+{
+	return bgp_table_init_ext(bgp, afi, safi,
+				  bm && bm->table_pool[afi][safi]);
+}
+
+struct bgp_table *bgp_table_init_ext(struct bgp *bgp, afi_t afi, safi_t safi,
+				     bool pool)
 {
 	struct bgp_table *rt;
 
 	rt = XCALLOC(MTYPE_BGP_TABLE, sizeof(struct bgp_table));
 
+	if (pool) {
+		rt->pool = XCALLOC(MTYPE_BGP_NODE_POOL, sizeof(*rt->pool));
+		bgp_node_chunks_init(&rt->pool->partial);
+		bgp_node_pool_tables++;
+	}
+
 	rt->route_table = route_table_init_with_delegate(&bgp_table_delegate);
 
 	/*
@@ -222,6 +354,29 @@ struct bgp_node *bgp_table_subtree_lookup(const struct bgp_table *table,
 	return matched;
 }
 
+void bgp_table_pool_show(struct vty *vty, json_object *json)
+{
+	size_t bytes = bgp_node_pool_chunks * sizeof(struct bgp_node_chunk);
+
+	if (json) {
+		json_object_int_add(json, "tables", bgp_node_pool_tables);
+		json_object_int_add(json, "chunks", bgp_node_pool_chunks);
+		json_object_int_add(json, "nodes", bgp_node_pool_nodes);
+		json_object_int_add(json, "bytes", bytes);
+		return;
+	}
+
+	vty_out(vty, "Tables using node pools: %zu\n", bgp_node_pool_tables);
+	vty_out(vty, "Chunks: %zu of %u nodes, %zu bytes\n",
+		bgp_node_pool_chunks, BGP_NODE_CHUNK_SIZE, bytes);
+	vty_out(vty, "Nodes in use: %zu (%zu%% of capacity)\n",
+		bgp_node_pool_nodes,
+		bgp_node_pool_chunks
+			? bgp_node_pool_nodes * 100
+				  / (bgp_node_pool_chunks * BGP_NODE_CHUNK_SIZE)
+			: 0);
+}
+
 printfrr_ext_autoreg_p("BD", printfrr_bd);
 static ssize_t printfrr_bd(struct fbuf *buf, struct printfrr_eargs *ea,
 			   const void *ptr)
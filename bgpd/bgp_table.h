@@ -17,6 +17,9 @@
 #include "bgpd.h"
 #include "bgp_advertise.h"
 
+struct bgp_node_pool;
+struct bgp_node_chunk;
+
 struct bgp_table {
 	/* table belongs to this instance */
 	struct bgp *bgp;
@@ -28,14 +31,22 @@ struct bgp_table {
 	int lock;
 
 	/* soft_reconfig_table in progress */
-	bool soft_reconfig_init;
-	struct event *soft_reconfig_thread;
+	struct route_table_walk soft_reconfig_walk;
+
+	/* progress of the current soft_reconfig_table run */
+	uint64_t soft_reconfig_total;
+	uint64_t soft_reconfig_done;
+	uint64_t soft_reconfig_updates;
+	time_t soft_reconfig_start;
 
 	/* list of peers on which soft_reconfig_table has to run */
 	struct list *soft_reconfig_peers;
 
 	struct route_table *route_table;
 	uint64_t version;
+
+	/* nodes are carved out of contiguous chunks, see bgp_table.c */
+	struct bgp_node_pool *pool;
 };
 
 enum bgp_path_selection_reason {
@@ -104,6 +115,9 @@ struct bgp_node {
 	struct bgp_addpath_node_data tx_addpath;
 
 	enum bgp_path_selection_reason reason;
+
+	/* chunk this node was carved from, NULL if allocated on its own */
+	struct bgp_node_chunk *chunk;
 };
 
 extern void bgp_delete_listnode(struct bgp_dest *dest);
@@ -118,6 +132,9 @@ typedef struct bgp_table_iter_t_ {
 } bgp_table_iter_t;
 
 extern struct bgp_table *bgp_table_init(struct bgp *bgp, afi_t, safi_t);
+extern struct bgp_table *bgp_table_init_ext(struct bgp *bgp, afi_t afi,
+					    safi_t safi, bool pool);
+extern void bgp_table_pool_show(struct vty *vty, json_object *json);
 extern void bgp_table_lock(struct bgp_table *);
 extern void bgp_table_unlock(struct bgp_table *);
 extern void bgp_table_finish(struct bgp_table **);
@@ -259,6 +259,24 @@ static void peer2_updgrp_copy(struct update_group *updgrp, struct peer_af *paf)
 	updgrp->afid = paf->afid;
 	updgrp->bgp = src->bgp;
 
+	/*
+	 * Route-server clients may share a group with any peer whose outbound
+	 * route-map has the same entries, whatever it is called.  The key is
+	 * taken once here, the route-map can change under an existing group
+	 * and the hash table needs a stable value; update_group_rs_adjust()
+	 * moves the peers away when that happens.
+	 */
+	updgrp->export_key = 0;
+	if (CHECK_FLAG(src->bgp->flags, BGP_FLAG_RS_SHARED_VIEWS)
+	    && CHECK_FLAG(src->af_flags[paf->afi][paf->safi],
+			  PEER_FLAG_RSERVER_CLIENT)
+	    && src->filter[paf->afi][paf->safi].map[RMAP_OUT].name) {
+		updgrp->export_key = route_map_content_hash(
+			src->filter[paf->afi][paf->safi].map[RMAP_OUT].name);
+		if (!updgrp->export_key)
+			updgrp->export_key = 1;
+	}
+
 	conf_copy(dst, src, paf->afi, paf->safi);
 }
 
@@ -356,7 +374,9 @@ static unsigned int updgrp_hash_key_make(const void *p)
 					strlen(peer->group->name), SEED1),
 				  key);
 
-	if (filter->map[RMAP_OUT].name)
+	if (updgrp->export_key)
+		key = jhash_1word(updgrp->export_key, key);
+	else if (filter->map[RMAP_OUT].name)
 		key = jhash_1word(jhash(filter->map[RMAP_OUT].name,
 					strlen(filter->map[RMAP_OUT].name),
 					SEED1),
@@ -462,6 +482,8 @@ static unsigned int updgrp_hash_key_make(const void *p)
 			peer->group ? peer->group->name : "(NONE)",
 			ROUTE_MAP_OUT_NAME(filter) ? ROUTE_MAP_OUT_NAME(filter)
 						   : "(NONE)");
+		zlog_debug("%pBP Update Group Hash: rmap out content: %u", peer,
+			   updgrp->export_key);
 		zlog_debug(
 			"%pBP Update Group Hash: dlist out: %s plist out: %s aslist out: %s usmap out: %s advmap: %s %d",
 			peer,
@@ -577,11 +599,21 @@ static bool updgrp_hash_cmp(const void *p1, const void *p2)
 	if (pe1->local_role != pe2->local_role)
 		return false;
 
-	/* route-map names should be the same */
-	if ((fl1->map[RMAP_OUT].name && !fl2->map[RMAP_OUT].name)
-	    || (!fl1->map[RMAP_OUT].name && fl2->map[RMAP_OUT].name)
-	    || (fl1->map[RMAP_OUT].name && fl2->map[RMAP_OUT].name
-		&& strcmp(fl1->map[RMAP_OUT].name, fl2->map[RMAP_OUT].name)))
+	/* route-map names should be the same, or for route-server clients
+	 * sharing views, the route-maps themselves
+	 */
+	if (!!grp1->export_key != !!grp2->export_key)
+		return false;
+
+	if (grp1->export_key) {
+		if (!route_map_content_same(fl1->map[RMAP_OUT].name,
+					    fl2->map[RMAP_OUT].name))
+			return false;
+	} else if ((fl1->map[RMAP_OUT].name && !fl2->map[RMAP_OUT].name)
+		   || (!fl1->map[RMAP_OUT].name && fl2->map[RMAP_OUT].name)
+		   || (fl1->map[RMAP_OUT].name && fl2->map[RMAP_OUT].name
+		       && strcmp(fl1->map[RMAP_OUT].name,
+				 fl2->map[RMAP_OUT].name)))
 		return false;
 
 	if ((fl1->dlist[FILTER_OUT].name && !fl2->dlist[FILTER_OUT].name)
@@ -657,6 +689,61 @@ static void peer_lonesoul_or_not(struct peer *peer, int set)
 	update_group_adjust_peer_afs(peer);
 }
 
+/*
+ * Show what a group formed with "bgp route-server shared-views" shares:
+ * the route-maps its members are configured with and the Adj-RIB-Out
+ * entries that exist once for all of them.
+ */
+static void update_group_show_shared_view(struct update_group *updgrp,
+					  struct vty *vty,
+					  json_object *json_updgrp)
+{
+	struct update_subgroup *subgrp;
+	struct peer_af *paf;
+	struct list *names = list_new();
+	struct listnode *node;
+	const char *name, *seen;
+	json_object *json_view = NULL;
+	json_object *json_names = NULL;
+	uint32_t adj_count = 0;
+	int peers = 0;
+
+	UPDGRP_FOREACH_SUBGRP (updgrp, subgrp) {
+		adj_count += subgrp->adj_count;
+		SUBGRP_FOREACH_PEER (subgrp, paf) {
+			peers++;
+			name = ROUTE_MAP_OUT_NAME(
+				&paf->peer->filter[updgrp->afi][updgrp->safi]);
+			if (!name)
+				continue;
+			for (ALL_LIST_ELEMENTS_RO(names, node, seen))
+				if (!strcmp(seen, name))
+					break;
+			if (!node)
+				listnode_add(names, (void *)name);
+		}
+	}
+
+	if (json_updgrp) {
+		json_view = json_object_new_object();
+		json_names = json_object_new_array();
+		for (ALL_LIST_ELEMENTS_RO(names, node, name))
+			json_array_string_add(json_names, name);
+		json_object_object_add(json_view, "routeMaps", json_names);
+		json_object_int_add(json_view, "peers", peers);
+		json_object_int_add(json_view, "adjOutEntries", adj_count);
+		json_object_object_add(json_updgrp, "sharedView", json_view);
+	} else {
+		vty_out(vty,
+			"  Shared view: %d peers, %u route-maps, %u adj-out entries\n",
+			peers, listcount(names), adj_count);
+		for (ALL_LIST_ELEMENTS_RO(names, node, name))
+			vty_out(vty, "    %s\n", name);
+	}
+
+	list_delete(&names);
+}
+
 /*
  * subgroup_total_packets_enqueued
  *
@@ -747,6 +834,9 @@ static int update_group_show_walkcb(struct update_group *updgrp, void *arg)
 				filter->map[RMAP_OUT].name);
 	}
 
+	if (updgrp->export_key)
+		update_group_show_shared_view(updgrp, vty, json_updgrp);
+
 	if (ctx->uj)
 		json_object_int_add(json_updgrp, "minRouteAdvInt",
 				    updgrp->conf->v_routeadv);
@@ -873,6 +963,8 @@ static int update_group_show_walkcb(struct update_group *updgrp, void *arg)
 				json_subgrp, "needsRefresh",
 				CHECK_FLAG(subgrp->flags,
 					   SUBGRP_FLAG_NEEDS_REFRESH));
+			json_object_boolean_add(json_subgrp, "tableReplay",
+						!!subgrp->t_replay);
 		} else {
 			vty_out(vty, "    Join events: %u\n",
 				subgrp->join_events);
@@ -905,6 +997,8 @@ static int update_group_show_walkcb(struct update_group *updgrp, void *arg)
 			vty_out(vty, "    Advertise list: %s\n",
 				advertise_list_is_empty(subgrp) ? "empty"
 								: "not empty");
+			if (subgrp->t_replay)
+				vty_out(vty, "    Table replay: in progress\n");
 			vty_out(vty, "    Flags: %s\n",
 				CHECK_FLAG(subgrp->flags,
 					   SUBGRP_FLAG_NEEDS_REFRESH)
@@ -1101,6 +1195,7 @@ static void update_subgroup_delete(struct update_subgroup *subgrp)
 
 	EVENT_OFF(subgrp->t_merge_check);
 	EVENT_OFF(subgrp->t_coalesce);
+	subgroup_replay_cancel(subgrp);
 
 	bpacket_queue_cleanup(SUBGRP_PKTQ(subgrp));
 	subgroup_clear_table(subgrp);
@@ -1306,6 +1401,13 @@ static bool update_subgroup_ready_for_merge(struct update_subgroup *subgrp)
 	if (update_subgroup_needs_refresh(subgrp))
 		return false;
 
+	/*
+	 * Nor while the table is still being walked in batches, part of
+	 * the adj_out isn't settled yet.
+	 */
+	if (subgrp->t_replay)
+		return false;
+
 	return true;
 }
 
@@ -1477,6 +1579,9 @@ static void update_subgroup_copy_adj_out(struct update_subgroup *source,
 					      aout->addpath_tx_id);
 		aout_copy->attr =
 			aout->attr ? bgp_attr_intern(aout->attr) : NULL;
+		/* what was sent, a queued advertisement isn't copied */
+		if (!aout->adv)
+			aout_copy->attr_hash = aout->attr_hash;
 	}
 
 	dest->scount = source->scount;
@@ -1852,6 +1957,96 @@ void update_subgroup_split_peer(struct peer_af *paf,
 	update_subgroup_add_peer(subgrp, paf, 1);
 }
 
+/*
+ * A subgroup of updgrp whose Adj-RIB-Out is complete, that a peer coming
+ * from subgroup from can be synced against.
+ */
+static struct update_subgroup *
+update_group_settled_subgroup(struct update_group *updgrp,
+			      struct update_subgroup *from)
+{
+	struct update_subgroup *subgrp;
+
+	UPDGRP_FOREACH_SUBGRP (updgrp, subgrp) {
+		if (update_subgroup_needs_refresh(subgrp) || subgrp->t_replay
+		    || subgrp->t_coalesce)
+			continue;
+
+		if (CHECK_FLAG(subgrp->sflags, SUBGRP_STATUS_DEFAULT_ORIGINATE)
+		    != CHECK_FLAG(from->sflags,
+				  SUBGRP_STATUS_DEFAULT_ORIGINATE))
+			continue;
+
+		return subgrp;
+	}
+
+	return NULL;
+}
+
+/*
+ * update_group_switch_peer
+ *
+ * After an outbound policy change, move the peer into the update group
+ * matching its new configuration without re-announcing the whole table,
+ * if that group already has a settled subgroup: the peer is split off with
+ * the Adj-RIB-Out it was sent, and only where that differs from the settled
+ * subgroup's are routes sent or withdrawn.  Its subgroup merges into the
+ * settled one afterwards.
+ *
+ * Returns false if the peer wasn't moved, the caller has to fall back to
+ * update_group_adjust_peer() and a full announcement then.
+ */
+bool update_group_switch_peer(struct peer_af *paf)
+{
+	struct update_group *updgrp;
+	struct update_subgroup *from, *target;
+	struct peer *peer;
+	uint32_t count;
+
+	if (!paf || !paf->subgroup)
+		return false;
+
+	peer = PAF_PEER(paf);
+	from = paf->subgroup;
+	if (!peer_established(peer)
+	    || !CHECK_FLAG(peer->flags, PEER_FLAG_CONFIG_NODE)
+	    || !peer->afc_nego[paf->afi][paf->safi])
+		return false;
+
+	/* Addpath and conditional advertisement keep more than the adj-out
+	 * state, and a peer waiting for ORF must not be sent anything yet.
+	 */
+	if (bgp_addpath_encode_tx(peer, paf->afi, paf->safi)
+	    || ADVERTISE_MAP_NAME(&peer->filter[paf->afi][paf->safi])
+	    || CHECK_FLAG(peer->af_sflags[paf->afi][paf->safi],
+			  PEER_STATUS_ORF_WAIT_REFRESH))
+		return false;
+
+	if (update_subgroup_needs_refresh(from) || from->t_replay)
+		return false;
+
+	updgrp = update_group_find(paf);
+	if (!updgrp || updgrp == from->update_group)
+		return false;
+
+	target = update_group_settled_subgroup(updgrp, from);
+	if (!target)
+		return false;
+
+	update_subgroup_split_peer(paf, updgrp);
+	update_subgroup_set_needs_refresh(paf->subgroup, 0);
+	count = subgroup_announce_diff(paf->subgroup, target);
+
+	if (BGP_DEBUG(update_groups, UPDATE_GROUPS))
+		zlog_debug("u%" PRIu64 ":s%" PRIu64
+			   " peer %s synced to u%" PRIu64 ":s%" PRIu64
+			   ", %u routes differed",
+			   updgrp->id, paf->subgroup->id, peer->host,
+			   updgrp->id, target->id, count);
+
+	return true;
+}
+
 void update_bgp_group_init(struct bgp *bgp)
 {
 	int afid;
@@ -1933,6 +2128,10 @@ void update_group_show_stats(struct bgp *bgp, struct vty *vty)
 		bgp->update_group_stats.peer_refreshes_combined);
 	vty_out(vty, "Merge checks triggered: %u\n",
 		bgp->update_group_stats.merge_checks_triggered);
+	vty_out(vty, "Attribute encoding cache hits: %" PRIu64 "\n",
+		bgp->update_group_stats.attr_enc_hits);
+	vty_out(vty, "Attribute encoding cache misses: %" PRIu64 "\n",
+		bgp->update_group_stats.attr_enc_misses);
 }
 
 /*
@@ -2006,6 +2205,54 @@ void update_group_adjust_peer(struct peer_af *paf)
 	return;
 }
 
+static bool updgrp_rmap_out_is(const struct peer *peer,
+			       const struct peer_af *paf, const char *name)
+{
+	const struct bgp_filter *filter = &peer->filter[paf->afi][paf->safi];
+	const char *out = ROUTE_MAP_OUT_NAME(filter);
+
+	return out && !strcmp(out, name);
+}
+
+/*
+ * Regroup the route-server clients that may be affected by a change of
+ * route-map rmap_name (all of them if NULL, for "bgp route-server
+ * shared-views" being toggled).  A client is affected if it uses the
+ * route-map, or if the group it was put in was formed around it.
+ */
+void update_group_rs_adjust(struct bgp *bgp, const char *rmap_name)
+{
+	struct listnode *node, *nnode;
+	struct peer *peer;
+	struct peer_af *paf;
+	struct update_subgroup *subgrp;
+	enum bgp_af_index index;
+
+	for (ALL_LIST_ELEMENTS(bgp->peer, node, nnode, peer)) {
+		if (CHECK_FLAG(peer->sflags, PEER_STATUS_GROUP))
+			continue;
+
+		for (index = BGP_AF_START; index < BGP_AF_MAX; index++) {
+			paf = peer->peer_af_array[index];
+			if (!paf)
+				continue;
+			if (!CHECK_FLAG(peer->af_flags[paf->afi][paf->safi],
+					PEER_FLAG_RSERVER_CLIENT))
+				continue;
+
+			subgrp = paf->subgroup;
+			if (rmap_name
+			    && !updgrp_rmap_out_is(peer, paf, rmap_name)
+			    && !(subgrp
+				 && updgrp_rmap_out_is(SUBGRP_PEER(subgrp), paf,
+						       rmap_name)))
+				continue;
+
+			update_group_adjust_peer(paf);
+		}
+	}
+}
+
 int update_group_adjust_soloness(struct peer *peer, int set)
 {
 	struct peer_group *group;
@@ -91,6 +91,10 @@ struct bpacket {
 	bpacket_attr_vec_arr arr;
 
 	unsigned int ver;
+
+	uint8_t flags;
+/* buffer was handed to the last peer's obuf, see bpacket_reformat_for_peer */
+#define BPACKET_FLAG_BUFFER_DONATED (1 << 0)
 };
 
 struct bpacket_queue {
@@ -133,6 +137,11 @@ struct update_group {
 	uint32_t subgrps_deleted;
 
 	uint32_t num_dbg_en_peers;
+
+	/* route_map_content_hash() of the outbound route-map, if peers are
+	 * grouped by its entries (bgp route-server shared-views), else 0
+	 */
+	uint32_t export_key;
 };
 
 /*
@@ -202,6 +211,10 @@ struct update_subgroup {
 
 	struct event *t_merge_check;
 
+	/* table walk in batches, see subgroup_replay_table() */
+	struct event *t_replay;
+	struct bgp_dest *replay_dest;
+
 	/* table version that the subgroup has caught up to. */
 	uint64_t version;
 
@@ -280,6 +293,10 @@ struct updwalk_context {
 	struct vty *vty;
 	struct bgp_dest *dest;
 	struct bgp_path_info *pi;
+	/* Paths of dest for addpath TX, NULL if every subgroup has to
+	 * look at them itself.
+	 */
+	struct bgp_addpath_tx_set *tx_set;
 	uint64_t updgrp_id;
 	uint64_t subgrp_id;
 	enum bgp_policy_type policy_type;
@@ -355,6 +372,8 @@ extern void update_group_show(struct bgp *bgp, afi_t afi, safi_t safi,
 			      struct vty *vty, uint64_t subgrp_id, bool uj);
 extern void update_group_show_stats(struct bgp *bgp, struct vty *vty);
 extern void update_group_adjust_peer(struct peer_af *paf);
+extern bool update_group_switch_peer(struct peer_af *paf);
+extern void update_group_rs_adjust(struct bgp *bgp, const char *rmap_name);
 extern int update_group_adjust_soloness(struct peer *peer, int set);
 
 extern void update_subgroup_remove_peer(struct update_subgroup *,
@@ -401,6 +420,19 @@ unsigned int bpacket_queue_virtual_length(struct peer_af *paf);
 extern void bpacket_queue_show_vty(struct bpacket_queue *q, struct vty *vty);
 bool subgroup_packets_to_build(struct update_subgroup *subgrp);
 extern struct bpacket *subgroup_update_packet(struct update_subgroup *s);
+/* split variant of the above for the update worker pthreads, see
+ * bgp_updgrp_workers.c
+ */
+extern struct stream *subgroup_update_packet_concurrent(
+	struct update_subgroup *subgrp, struct bgp_advertise **advp,
+	struct bpacket_attr_vec_arr *vecarr, unsigned int *nadv, bool *flush);
+extern struct bpacket *
+subgroup_update_packet_commit(struct update_subgroup *subgrp,
+			      struct stream *packet,
+			      struct bpacket_attr_vec_arr *vecarr,
+			      unsigned int nadv);
+extern void subgroup_update_packet_flush(struct update_subgroup *subgrp);
+extern void bgp_adv_attr_enc_free(struct bgp_adv_attr_enc **enc);
 extern struct bpacket *subgroup_withdraw_packet(struct update_subgroup *s);
 extern struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 						struct peer_af *paf);
@@ -450,8 +482,11 @@ extern void bgp_adj_out_set_subgroup(struct bgp_dest *dest,
 extern void bgp_adj_out_unset_subgroup(struct bgp_dest *dest,
 				       struct update_subgroup *subgrp,
 				       char withdraw, uint32_t addpath_tx_id);
+extern void subgroup_replay_cancel(struct update_subgroup *subgrp);
 void subgroup_announce_table(struct update_subgroup *subgrp,
 			     struct bgp_table *table);
+extern uint32_t subgroup_announce_diff(struct update_subgroup *subgrp,
+				       struct update_subgroup *target);
 extern void subgroup_trigger_write(struct update_subgroup *subgrp);
 
 extern int update_group_clear_update_dbg(struct update_group *updgrp,
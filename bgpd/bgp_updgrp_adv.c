@@ -36,6 +36,8 @@
 #include "bgpd/bgp_advertise.h"
 #include "bgpd/bgp_addpath.h"
 
+DEFINE_MSLAB_STATIC(BGP_ADJ_OUT, sizeof(struct bgp_adj_out));
+
 
 /********************
  * PRIVATE FUNCTIONS
@@ -84,7 +86,7 @@ static void adj_free(struct bgp_adj_out *adj)
 	RB_REMOVE(bgp_adj_out_rb, &adj->dest->adj_out, adj);
 	bgp_dest_unlock_node(adj->dest);
 
-	XFREE(MTYPE_BGP_ADJ_OUT, adj);
+	XSLAB_FREE(MSLAB_BGP_ADJ_OUT, adj);
 }
 
 static void subgrp_withdraw_stale_addpath(struct updwalk_context *ctx,
@@ -120,6 +122,59 @@ static void subgrp_withdraw_stale_addpath(struct updwalk_context *ctx,
 	}
 }
 
+/*
+ * Addpath announcement of a dest to a subgroup from the dest's TX set,
+ * so only the paths the peers' strategy sends are run through the
+ * outbound policy, and only this subgroup's adj-out entries are checked
+ * for withdrawal.
+ */
+static void subgrp_announce_addpath_set(struct updwalk_context *ctx,
+					struct update_subgroup *subgrp)
+{
+	struct bgp_addpath_tx_set *set = ctx->tx_set;
+	struct bgp_adj_out lookup, *adj, *adj_next;
+	struct bgp_path_info *pi;
+	afi_t afi = SUBGRP_AFI(subgrp);
+	safi_t safi = SUBGRP_SAFI(subgrp);
+	struct peer *peer = SUBGRP_PEER(subgrp);
+	uint64_t mask;
+	unsigned int i;
+
+	mask = bgp_addpath_tx_set_mask(set, peer, afi, safi);
+
+	/* adj-out entries are sorted by subgroup first */
+	lookup.subgroup = subgrp;
+	lookup.addpath_tx_id = 0;
+	for (adj = RB_NFIND(bgp_adj_out_rb, &ctx->dest->adj_out, &lookup);
+	     adj && adj->subgroup == subgrp; adj = adj_next) {
+		adj_next = RB_NEXT(bgp_adj_out_rb, adj);
+
+		if (!bgp_addpath_tx_set_has_id(set, mask, peer, afi, safi,
+					       adj->addpath_tx_id))
+			subgroup_process_announce_selected(
+				subgrp, NULL, ctx->dest, adj->addpath_tx_id);
+	}
+
+	for (i = 0; i < set->count; i++) {
+		pi = set->paths[i];
+
+		/* Skip the bestpath for now */
+		if (!(mask & (1ULL << i)) || pi == ctx->pi)
+			continue;
+
+		subgroup_process_announce_selected(
+			subgrp, pi, ctx->dest,
+			bgp_addpath_id_for_peer(peer, afi, safi,
+						&pi->tx_addpath));
+	}
+
+	if (ctx->pi)
+		subgroup_process_announce_selected(
+			subgrp, ctx->pi, ctx->dest,
+			bgp_addpath_id_for_peer(peer, afi, safi,
+						&ctx->pi->tx_addpath));
+}
+
 static int group_announce_route_walkcb(struct update_group *updgrp, void *arg)
 {
 	struct updwalk_context *ctx = arg;
@@ -151,7 +206,9 @@ static int group_announce_route_walkcb(struct update_group *updgrp, void *arg)
 		if (!subgrp->t_coalesce) {
 
 			/* An update-group that uses addpath */
-			if (addpath_capable) {
+			if (addpath_capable && ctx->tx_set) {
+				subgrp_announce_addpath_set(ctx, subgrp);
+			} else if (addpath_capable) {
 				subgrp_withdraw_stale_addpath(ctx, subgrp);
 
 				for (pi = bgp_dest_get_bgp_path_info(ctx->dest);
@@ -203,9 +260,6 @@ static int group_announce_route_walkcb(struct update_group *updgrp, void *arg)
 				}
 			}
 		}
-
-		/* Notify BGP Conditional advertisement */
-		bgp_notify_conditional_adv_scanner(subgrp);
 	}
 
 	return UPDWALK_CONTINUE;
@@ -387,7 +441,7 @@ struct bgp_adj_out *bgp_adj_out_alloc(struct update_subgroup *subgrp,
 {
 	struct bgp_adj_out *adj;
 
-	adj = XCALLOC(MTYPE_BGP_ADJ_OUT, sizeof(struct bgp_adj_out));
+	adj = XSLAB_CALLOC(MSLAB_BGP_ADJ_OUT);
 	adj->subgroup = subgrp;
 	adj->addpath_tx_id = addpath_tx_id;
 
@@ -645,99 +699,94 @@ void subgroup_clear_table(struct update_subgroup *subgrp)
 		bgp_adj_out_remove_subgroup(aout->dest, aout, subgrp);
 }
 
-/*
- * subgroup_announce_table
- */
-void subgroup_announce_table(struct update_subgroup *subgrp,
-			     struct bgp_table *table)
+static safi_t subgroup_rib_safi(struct update_subgroup *subgrp)
 {
-	struct bgp_dest *dest;
+	if (SUBGRP_SAFI(subgrp) == SAFI_LABELED_UNICAST)
+		return SAFI_UNICAST;
+	return SUBGRP_SAFI(subgrp);
+}
+
+/* Bring the Adj-RIB-Out of the subgroup for dest in line with the table */
+static void subgroup_announce_dest(struct update_subgroup *subgrp,
+				   struct bgp_dest *dest, bool addpath_capable)
+{
+	const struct prefix *dest_p = bgp_dest_get_prefix(dest);
 	struct bgp_path_info *ri;
 	struct attr attr;
 	struct peer *peer;
 	afi_t afi;
 	safi_t safi;
 	safi_t safi_rib;
-	bool addpath_capable;
 	struct bgp *bgp;
 	bool advertise;
 
 	peer = SUBGRP_PEER(subgrp);
 	afi = SUBGRP_AFI(subgrp);
 	safi = SUBGRP_SAFI(subgrp);
+	safi_rib = subgroup_rib_safi(subgrp);
 	bgp = SUBGRP_INST(subgrp);
-	addpath_capable = bgp_addpath_encode_tx(peer, afi, safi);
 
-	if (safi == SAFI_LABELED_UNICAST)
-		safi_rib = SAFI_UNICAST;
-	else
-		safi_rib = safi;
-
-	if (!table)
-		table = peer->bgp->rib[afi][safi_rib];
-
-	if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP && safi != SAFI_EVPN
-	    && CHECK_FLAG(peer->af_flags[afi][safi],
-			  PEER_FLAG_DEFAULT_ORIGINATE))
-		subgroup_default_originate(subgrp, 0);
-
-	subgrp->pscount = 0;
-	SET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
-
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		const struct prefix *dest_p = bgp_dest_get_prefix(dest);
-
-		/* Check if the route can be advertised */
-		advertise = bgp_check_advertise(bgp, dest);
+	/* Check if the route can be advertised */
+	advertise = bgp_check_advertise(bgp, dest);
 
-		for (ri = bgp_dest_get_bgp_path_info(dest); ri; ri = ri->next) {
+	for (ri = bgp_dest_get_bgp_path_info(dest); ri; ri = ri->next) {
 
-			if (!bgp_check_selected(ri, peer, addpath_capable, afi,
-						safi_rib))
-				continue;
+		if (!bgp_check_selected(ri, peer, addpath_capable, afi,
+					safi_rib))
+			continue;
 
-			if (subgroup_announce_check(dest, ri, subgrp, dest_p,
-						    &attr, NULL)) {
-				/* Check if route can be advertised */
-				if (advertise) {
-					if (!bgp_check_withdrawal(bgp, dest)) {
-						struct attr *adv_attr =
-							bgp_attr_intern(&attr);
+		if (subgroup_announce_check(dest, ri, subgrp, dest_p, &attr,
+					    NULL)) {
+			/* Check if route can be advertised */
+			if (advertise) {
+				if (!bgp_check_withdrawal(bgp, dest)) {
+					struct attr *adv_attr =
+						bgp_attr_intern(&attr);
 
-						bgp_adj_out_set_subgroup(
-							dest, subgrp, adv_attr,
-							ri);
-					} else
-						bgp_adj_out_unset_subgroup(
-							dest, subgrp, 1,
-							bgp_addpath_id_for_peer(
-								peer, afi,
-								safi_rib,
-								&ri->tx_addpath));
-				}
-			} else {
-				/* If default originate is enabled for
-				 * the peer, do not send explicit
-				 * withdraw. This will prevent deletion
-				 * of default route advertised through
-				 * default originate
-				 */
-				if (CHECK_FLAG(peer->af_flags[afi][safi],
-					       PEER_FLAG_DEFAULT_ORIGINATE) &&
-				    is_default_prefix(
-					    bgp_dest_get_prefix(dest)))
-					break;
-
-				bgp_adj_out_unset_subgroup(
-					dest, subgrp, 1,
-					bgp_addpath_id_for_peer(
-						peer, afi, safi_rib,
-						&ri->tx_addpath));
+					bgp_adj_out_set_subgroup(dest, subgrp,
+								 adv_attr, ri);
+				} else
+					bgp_adj_out_unset_subgroup(
+						dest, subgrp, 1,
+						bgp_addpath_id_for_peer(
+							peer, afi, safi_rib,
+							&ri->tx_addpath));
 			}
+		} else {
+			/* If default originate is enabled for
+			 * the peer, do not send explicit
+			 * withdraw. This will prevent deletion
+			 * of default route advertised through
+			 * default originate
+			 */
+			if (CHECK_FLAG(peer->af_flags[afi][safi],
+				       PEER_FLAG_DEFAULT_ORIGINATE) &&
+			    is_default_prefix(bgp_dest_get_prefix(dest)))
+				break;
+
+			bgp_adj_out_unset_subgroup(
+				dest, subgrp, 1,
+				bgp_addpath_id_for_peer(peer, afi, safi_rib,
+							&ri->tx_addpath));
 		}
 	}
-	UNSET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+}
 
+static void subgroup_announce_start(struct update_subgroup *subgrp)
+{
+	struct peer *peer = SUBGRP_PEER(subgrp);
+	afi_t afi = SUBGRP_AFI(subgrp);
+	safi_t safi = SUBGRP_SAFI(subgrp);
+
+	if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP && safi != SAFI_EVPN
+	    && CHECK_FLAG(peer->af_flags[afi][safi],
+			  PEER_FLAG_DEFAULT_ORIGINATE))
+		subgroup_default_originate(subgrp, 0);
+}
+
+static void subgroup_announce_done(struct update_subgroup *subgrp,
+				   struct bgp_table *table)
+{
 	/*
 	 * We walked through the whole table -- make sure our version number
 	 * is consistent with the one on the table. This should allow
@@ -754,6 +803,161 @@ void subgroup_announce_table(struct update_subgroup *subgrp,
 	update_subgroup_trigger_merge_check(subgrp, 0);
 }
 
+/*
+ * subgroup_announce_table
+ */
+void subgroup_announce_table(struct update_subgroup *subgrp,
+			     struct bgp_table *table)
+{
+	struct bgp_dest *dest;
+	struct peer *peer;
+	bool addpath_capable;
+
+	peer = SUBGRP_PEER(subgrp);
+	addpath_capable = bgp_addpath_encode_tx(peer, SUBGRP_AFI(subgrp),
+						SUBGRP_SAFI(subgrp));
+
+	if (!table)
+		table = peer->bgp->rib[SUBGRP_AFI(subgrp)]
+				      [subgroup_rib_safi(subgrp)];
+
+	subgroup_announce_start(subgrp);
+
+	subgrp->pscount = 0;
+	SET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+
+	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest))
+		subgroup_announce_dest(subgrp, dest, addpath_capable);
+
+	UNSET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+
+	subgroup_announce_done(subgrp, table);
+}
+
+/* whether the peers have, or are about to be sent, a route for adj */
+static bool adj_announced(const struct bgp_adj_out *adj)
+{
+	if (adj->adv)
+		return adj->adv->baa != NULL;
+	return adj->attr != NULL;
+}
+
+/*
+ * Bring the Adj-RIB-Out of subgrp in line with that of target, a subgroup
+ * of the same update group, instead of walking the whole table.  Both have
+ * the same outbound policy, so target already holds what a walk would come
+ * up with; only the routes where they differ are run through the policy
+ * again or withdrawn.  Addpath isn't handled.  Returns the number of routes
+ * that differed.
+ */
+uint32_t subgroup_announce_diff(struct update_subgroup *subgrp,
+				struct update_subgroup *target)
+{
+	struct bgp_adj_out *aout, *taout, *adj;
+	uint32_t count = 0;
+
+	subgroup_announce_start(subgrp);
+
+	SUBGRP_FOREACH_ADJ (target, taout) {
+		if (!adj_announced(taout))
+			continue;
+
+		adj = adj_lookup(taout->dest, subgrp, taout->addpath_tx_id);
+		if (adj && adj_announced(adj)
+		    && adj->attr_hash == taout->attr_hash)
+			continue;
+
+		subgroup_announce_dest(subgrp, taout->dest, false);
+		count++;
+	}
+
+	SUBGRP_FOREACH_ADJ_SAFE (subgrp, aout, adj) {
+		if (!adj_announced(aout))
+			continue;
+
+		taout = adj_lookup(aout->dest, target, aout->addpath_tx_id);
+		if (taout && adj_announced(taout))
+			continue;
+
+		bgp_adj_out_unset_subgroup(aout->dest, subgrp, 1,
+					   aout->addpath_tx_id);
+		count++;
+	}
+
+	subgrp->pscount = target->pscount;
+	subgrp->version = MAX(subgrp->version, target->version);
+	update_subgroup_trigger_merge_check(subgrp, 0);
+
+	return count;
+}
+
+/*
+ * Announce the table to the subgroup bgp->replay_batch nodes at a time,
+ * resuming from subgrp->replay_dest after a pause of bgp->replay_delay ms.
+ * Unlike a single pass, the prefix sent count isn't rebuilt from scratch:
+ * it is kept accurate by the adj-out changes themselves, since routes can
+ * be announced and withdrawn between the batches.
+ */
+static void subgroup_replay_table(struct event *thread)
+{
+	struct update_subgroup *subgrp = EVENT_ARG(thread);
+	struct peer *peer = SUBGRP_PEER(subgrp);
+	struct bgp *bgp = SUBGRP_INST(subgrp);
+	struct bgp_table *table;
+	struct bgp_dest *dest;
+	bool addpath_capable;
+	uint32_t batch, count;
+
+	/* the setting may have been removed since the walk started */
+	batch = bgp->replay_batch ? bgp->replay_batch : UINT32_MAX;
+	table = bgp->rib[SUBGRP_AFI(subgrp)][subgroup_rib_safi(subgrp)];
+	addpath_capable = bgp_addpath_encode_tx(peer, SUBGRP_AFI(subgrp),
+						SUBGRP_SAFI(subgrp));
+
+	/* the lock taken on the cursor is handed over to bgp_route_next() */
+	dest = subgrp->replay_dest;
+	subgrp->replay_dest = NULL;
+	if (!dest)
+		dest = bgp_table_top(table);
+
+	for (count = 0; dest && count < batch;
+	     dest = bgp_route_next(dest), count++)
+		subgroup_announce_dest(subgrp, dest, addpath_capable);
+
+	if (dest) {
+		subgrp->replay_dest = dest;
+		event_add_timer_msec(bm->master, subgroup_replay_table, subgrp,
+				     bgp->replay_delay, &subgrp->t_replay);
+		return;
+	}
+
+	subgroup_announce_done(subgrp, table);
+
+	/* nothing may have changed in the last batch, make sure the peers
+	 * get to send EoR/EoRR
+	 */
+	subgroup_trigger_write(subgrp);
+}
+
+void subgroup_replay_cancel(struct update_subgroup *subgrp)
+{
+	EVENT_OFF(subgrp->t_replay);
+	if (subgrp->replay_dest) {
+		bgp_dest_unlock_node(subgrp->replay_dest);
+		subgrp->replay_dest = NULL;
+	}
+}
+
+static void subgroup_replay_start(struct update_subgroup *subgrp)
+{
+	/* a new request needs the whole table again */
+	subgroup_replay_cancel(subgrp);
+
+	subgroup_announce_start(subgrp);
+	event_add_event(bm->master, subgroup_replay_table, subgrp, 0,
+			&subgrp->t_replay);
+}
+
 /*
  * subgroup_announce_route
  *
@@ -781,9 +985,12 @@ void subgroup_announce_route(struct update_subgroup *subgrp)
 
 	if (SUBGRP_SAFI(subgrp) != SAFI_MPLS_VPN
 	    && SUBGRP_SAFI(subgrp) != SAFI_ENCAP
-	    && SUBGRP_SAFI(subgrp) != SAFI_EVPN)
-		subgroup_announce_table(subgrp, NULL);
-	else
+	    && SUBGRP_SAFI(subgrp) != SAFI_EVPN) {
+		if (SUBGRP_INST(subgrp)->replay_batch)
+			subgroup_replay_start(subgrp);
+		else
+			subgroup_announce_table(subgrp, NULL);
+	} else
 		for (dest = bgp_table_top(update_subgroup_rib(subgrp)); dest;
 		     dest = bgp_route_next(dest)) {
 			table = bgp_dest_get_bgp_table_info(dest);
@@ -1035,8 +1242,11 @@ void group_announce_route(struct bgp *bgp, afi_t afi, safi_t safi,
 			  struct bgp_dest *dest, struct bgp_path_info *pi)
 {
 	struct updwalk_context ctx;
+	struct bgp_addpath_tx_set tx_set;
+
 	ctx.pi = pi;
 	ctx.dest = dest;
+	ctx.tx_set = NULL;
 
 	/* If suppress fib is enabled, the route will be advertised when
 	 * FIB status is received
@@ -1044,6 +1254,13 @@ void group_announce_route(struct bgp *bgp, afi_t afi, safi_t safi,
 	if (!bgp_check_advertise(bgp, dest))
 		return;
 
+	/* Which paths each addpath strategy sends is the same for all
+	 * update groups, work it out only once.
+	 */
+	if (bgp_addpath_is_addpath_used(&bgp->tx_addpath, afi, safi)
+	    && bgp_addpath_tx_set_build(&tx_set, dest))
+		ctx.tx_set = &tx_set;
+
 	update_group_af_walk(bgp, afi, safi, group_announce_route_walkcb, &ctx);
 }
 
@@ -19,6 +19,7 @@
 #include "sockunion.h"
 #include "network.h"
 #include "memory.h"
+#include "mempressure.h"
 #include "filter.h"
 #include "routemap.h"
 #include "log.h"
@@ -61,7 +62,7 @@ struct bpacket *bpacket_alloc(void)
 
 void bpacket_free(struct bpacket *pkt)
 {
-	if (pkt->buffer)
+	if (pkt->buffer && !CHECK_FLAG(pkt->flags, BPACKET_FLAG_BUFFER_DONATED))
 		stream_free(pkt->buffer);
 	pkt->buffer = NULL;
 	XFREE(MTYPE_BGP_PACKET, pkt);
@@ -329,6 +330,24 @@ void bpacket_queue_show_vty(struct bpacket_queue *q, struct vty *vty)
 	return;
 }
 
+/*
+ * Is paf the last peer that still has to send pkt, with pkt at the head of
+ * the queue?  If so, the bpacket_queue_advance_peer() following the
+ * reformat is going to free pkt, so its buffer can be handed over instead
+ * of being copied.
+ */
+static bool bpacket_last_reader(struct bpacket *pkt, struct peer_af *paf)
+{
+	return pkt == bpacket_queue_first(PAF_PKTQ(paf)) &&
+	       LIST_FIRST(&pkt->peers) == paf &&
+	       LIST_NEXT(paf, pkt_train) == NULL;
+}
+
+/*
+ * Build the stream to put on the peer's output queue for pkt. The caller
+ * must advance the peer past pkt right after this, the buffer of pkt may
+ * have been donated to the returned stream.
+ */
 struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 					 struct peer_af *paf)
 {
@@ -337,7 +356,11 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 	struct peer *peer;
 	struct bgp_filter *filter;
 
-	s = stream_dup(pkt->buffer);
+	if (bpacket_last_reader(pkt, paf)) {
+		s = pkt->buffer;
+		SET_FLAG(pkt->flags, BPACKET_FLAG_BUFFER_DONATED);
+	} else
+		s = stream_dup(pkt->buffer);
 	peer = PAF_PEER(paf);
 
 	vec = &pkt->arr.entries[BGP_ATTR_VEC_NH];
@@ -636,11 +659,142 @@ bool subgroup_packets_to_build(struct update_subgroup *subgrp)
 	return false;
 }
 
-/* Make BGP update packet.  */
-struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
-{
+/*
+ * Encoded path attributes (everything but MP_REACH_NLRI) of a
+ * bgp_advertise_attr, as produced by bgp_packet_attribute() for the
+ * subgroup owning it.  Vector offsets are relative to the start of the
+ * attributes.
+ */
+struct bgp_adv_attr_enc {
+	/*
+	 * inputs besides the attr that the encoding depends on; the subgroup
+	 * is identified by its id, which unlike its address is never reused
+	 */
+	uint64_t subgrp_id;
+	struct peer *from;
+
 	struct bpacket_attr_vec_arr vecarr;
-	struct bpacket *pkt;
+
+	bgp_size_t len;
+	uint8_t data[];
+};
+
+void bgp_adv_attr_enc_free(struct bgp_adv_attr_enc **enc)
+{
+	if (!*enc)
+		return;
+
+	if ((*enc)->from)
+		peer_unlock((*enc)->from);
+	XFREE(MTYPE_BGP_ADVERTISE_ATTR_ENC, *enc);
+}
+
+/*
+ * Put the path attributes for baa on s, reusing the cached encoding when
+ * it was built for the same subgroup/from pair.  AIGP depends on the path
+ * (not only on the attr), so attributes carrying it are never cached.
+ * Nothing new is cached while under memory pressure either.
+ *
+ * With concurrent set this runs on an update worker pthread; the cache is
+ * only read then, and statistics are not updated as they are shared
+ * between the subgroups of an update group.
+ */
+static bgp_size_t subgroup_packet_attribute(struct stream *s,
+					    struct bgp_advertise_attr *baa,
+					    struct bpacket_attr_vec_arr *vecarr,
+					    struct update_subgroup *subgrp,
+					    struct peer *from,
+					    struct bgp_path_info *path,
+					    bool concurrent)
+{
+	struct peer *peer = SUBGRP_PEER(subgrp);
+	struct bgp_adv_attr_enc *enc = baa->enc;
+	size_t start = stream_get_endp(s);
+	bgp_size_t len;
+	int i;
+
+	if (enc && enc->subgrp_id == subgrp->id && enc->from == from &&
+	    STREAM_WRITEABLE(s) >= enc->len) {
+		stream_put(s, enc->data, enc->len);
+		for (i = 0; i < BGP_ATTR_VEC_MAX; i++) {
+			vecarr->entries[i] = enc->vecarr.entries[i];
+			if (CHECK_FLAG(vecarr->entries[i].flags,
+				       BPKT_ATTRVEC_FLAGS_UPDATED))
+				vecarr->entries[i].offset += start;
+		}
+		if (!concurrent)
+			UPDGRP_GLOBAL_STAT(subgrp->update_group,
+					   attr_enc_hits)++;
+		return enc->len;
+	}
+
+	len = bgp_packet_attribute(NULL, peer, s, baa->attr, vecarr, NULL,
+				   SUBGRP_AFI(subgrp), SUBGRP_SAFI(subgrp),
+				   from, NULL, NULL, 0, 0, 0, path);
+	if (concurrent)
+		return len;
+
+	UPDGRP_GLOBAL_STAT(subgrp->update_group, attr_enc_misses)++;
+
+	if (CHECK_FLAG(baa->attr->flag, ATTR_FLAG_BIT(BGP_ATTR_AIGP)))
+		return len;
+
+	bgp_adv_attr_enc_free(&baa->enc);
+	if (mempressure_level() != MEMPRESSURE_NONE)
+		return len;
+
+	enc = XMALLOC(MTYPE_BGP_ADVERTISE_ATTR_ENC, sizeof(*enc) + len);
+	enc->subgrp_id = subgrp->id;
+	enc->from = from ? peer_lock(from) : NULL;
+	enc->len = len;
+	memcpy(enc->data, STREAM_DATA(s) + start, len);
+	for (i = 0; i < BGP_ATTR_VEC_MAX; i++) {
+		enc->vecarr.entries[i] = vecarr->entries[i];
+		if (CHECK_FLAG(vecarr->entries[i].flags,
+			       BPKT_ATTRVEC_FLAGS_UPDATED))
+			enc->vecarr.entries[i].offset -= start;
+	}
+	baa->enc = enc;
+
+	return len;
+}
+
+/*
+ * Synchronize the adj-out of the first queued advertisement of the
+ * subgroup with what was just put into an UPDATE, and drop the
+ * advertisement.  Returns the next queued advertisement.
+ */
+static struct bgp_advertise *
+subgroup_update_packet_sync(struct update_subgroup *subgrp)
+{
+	struct bgp_advertise *adv = bgp_adv_fifo_first(&subgrp->sync->update);
+	struct bgp_adj_out *adj = adv->adj;
+
+	if (adj->attr)
+		bgp_attr_unintern(&adj->attr);
+	else
+		subgrp->scount++;
+
+	adj->attr = bgp_attr_intern(adv->baa->attr);
+	return bgp_advertise_clean_subgroup(subgrp, adj);
+}
+
+/*
+ * Format one UPDATE from the subgroup's advertisement FIFO, starting at
+ * *advp.  In sync mode every advertisement consumed is synchronized and
+ * removed right away (see subgroup_update_packet_sync()).  Otherwise
+ * (concurrent, on an update worker pthread) shared state is not touched:
+ * *advp is moved past the consumed advertisements, their count is written
+ * to *nadv and the caller syncs them on the main pthread later.  If the
+ * attributes cannot fit into a message, *flush is set (concurrent) or the
+ * FIFO is flushed (sync) and NULL is returned.
+ */
+static struct stream *
+subgroup_update_packet_build(struct update_subgroup *subgrp,
+			     struct bgp_advertise **advp,
+			     struct bpacket_attr_vec_arr *vecarr,
+			     bool concurrent, unsigned int *nadv, bool *flush)
+{
 	struct peer *peer;
 	struct stream *s;
 	struct stream *snlri;
@@ -667,12 +821,6 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 	mpls_label_t label = MPLS_INVALID_LABEL, *label_pnt = NULL;
 	uint32_t num_labels = 0;
 
-	if (!subgrp)
-		return NULL;
-
-	if (bpacket_queue_is_full(SUBGRP_INST(subgrp), SUBGRP_PKTQ(subgrp)))
-		return NULL;
-
 	peer = SUBGRP_PEER(subgrp);
 	afi = SUBGRP_AFI(subgrp);
 	safi = SUBGRP_SAFI(subgrp);
@@ -681,12 +829,13 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 	snlri = subgrp->scratch;
 	stream_reset(snlri);
 
-	bpacket_attr_vec_arr_reset(&vecarr);
+	bpacket_attr_vec_arr_reset(vecarr);
 
 	addpath_capable = bgp_addpath_encode_tx(peer, afi, safi);
 	addpath_overhead = addpath_capable ? BGP_ADDPATH_ID_LEN : 0;
 
-	adv = bgp_adv_fifo_first(&subgrp->sync->update);
+	*nadv = 0;
+	adv = *advp;
 	while (adv) {
 		const struct prefix *dest_p;
 
@@ -738,9 +887,9 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 
 			/* 5: Encode all the attributes, except MP_REACH_NLRI
 			 * attr. */
-			total_attr_len = bgp_packet_attribute(
-				NULL, peer, s, adv->baa->attr, &vecarr, NULL,
-				afi, safi, from, NULL, NULL, 0, 0, 0, path);
+			total_attr_len = subgroup_packet_attribute(
+				s, adv->baa, vecarr, subgrp, from, path,
+				concurrent);
 
 			space_remaining =
 				STREAM_CONCAT_REMAIN(s, snlri, STREAM_SIZE(s))
@@ -758,6 +907,14 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 					"u%" PRIu64 ":s%" PRIu64" attributes too long, cannot send UPDATE",
 					subgrp->update_group->id, subgrp->id);
 
+				stream_reset(s);
+				stream_reset(snlri);
+				*advp = NULL;
+				if (concurrent) {
+					*flush = true;
+					return NULL;
+				}
+
 				/* Flush the FIFO update queue */
 				while (adv)
 					adv = bgp_advertise_clean_subgroup(
@@ -765,8 +922,9 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 				return NULL;
 			}
 
-			if (BGP_DEBUG(update, UPDATE_OUT)
-			    || BGP_DEBUG(update, UPDATE_PREFIX)) {
+			if (!concurrent &&
+			    (BGP_DEBUG(update, UPDATE_OUT) ||
+			     BGP_DEBUG(update, UPDATE_PREFIX))) {
 				memset(send_attr_str, 0, BUFSIZ);
 				send_attr_printed = 0;
 				bgp_dump_attr(adv->baa->attr, send_attr_str,
@@ -796,7 +954,7 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 
 			if (stream_empty(snlri))
 				mpattrlen_pos = bgp_packet_mpattr_start(
-					snlri, peer, afi, safi, &vecarr,
+					snlri, peer, afi, safi, vecarr,
 					adv->baa->attr);
 
 			bgp_packet_mpattr_prefix(snlri, afi, safi, dest_p, prd,
@@ -806,8 +964,10 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 		}
 
 		num_pfx++;
+		(*nadv)++;
 
-		if (bgp_debug_update(NULL, dest_p, subgrp->update_group, 0)) {
+		if (!concurrent &&
+		    bgp_debug_update(NULL, dest_p, subgrp->update_group, 0)) {
 			char pfx_buf[BGP_PRD_PATH_STRLEN];
 
 			if (!send_attr_printed) {
@@ -843,14 +1003,12 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 		}
 
 		/* Synchnorize attribute.  */
-		if (adj->attr)
-			bgp_attr_unintern(&adj->attr);
+		if (concurrent)
+			adv = bgp_adv_fifo_next(&subgrp->sync->update, adv);
 		else
-			subgrp->scount++;
-
-		adj->attr = bgp_attr_intern(adv->baa->attr);
-		adv = bgp_advertise_clean_subgroup(subgrp, adj);
+			adv = subgroup_update_packet_sync(subgrp);
 	}
+	*advp = adv;
 
 	if (!stream_empty(s)) {
 		if (!stream_empty(snlri)) {
@@ -863,11 +1021,12 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 
 		if (!stream_empty(snlri)) {
 			packet = stream_dupcat(s, snlri, mpattr_pos);
-			bpacket_attr_vec_arr_update(&vecarr, mpattr_pos);
+			bpacket_attr_vec_arr_update(vecarr, mpattr_pos);
 		} else
 			packet = stream_dup(s);
 		bgp_packet_set_size(packet);
-		if (bgp_debug_update(NULL, NULL, subgrp->update_group, 0))
+		if (!concurrent &&
+		    bgp_debug_update(NULL, NULL, subgrp->update_group, 0))
 			zlog_debug(
 				"u%" PRIu64 ":s%" PRIu64
 				" send UPDATE len %zd (max message len: %hu) numpfx %d",
@@ -875,14 +1034,63 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 				(stream_get_endp(packet)
 				 - stream_get_getp(packet)),
 				peer->max_packet_size, num_pfx);
-		pkt = bpacket_queue_add(SUBGRP_PKTQ(subgrp), packet, &vecarr);
 		stream_reset(s);
 		stream_reset(snlri);
-		return pkt;
+		return packet;
 	}
 	return NULL;
 }
 
+/* Make BGP update packet.  */
+struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
+{
+	struct bpacket_attr_vec_arr vecarr;
+	struct bgp_advertise *adv;
+	struct stream *packet;
+	unsigned int nadv;
+
+	if (!subgrp)
+		return NULL;
+
+	if (bpacket_queue_is_full(SUBGRP_INST(subgrp), SUBGRP_PKTQ(subgrp)))
+		return NULL;
+
+	adv = bgp_adv_fifo_first(&subgrp->sync->update);
+	packet = subgroup_update_packet_build(subgrp, &adv, &vecarr, false,
+					      &nadv, NULL);
+	if (!packet)
+		return NULL;
+
+	return bpacket_queue_add(SUBGRP_PKTQ(subgrp), packet, &vecarr);
+}
+
+struct stream *subgroup_update_packet_concurrent(
+	struct update_subgroup *subgrp, struct bgp_advertise **advp,
+	struct bpacket_attr_vec_arr *vecarr, unsigned int *nadv, bool *flush)
+{
+	return subgroup_update_packet_build(subgrp, advp, vecarr, true, nadv,
+					    flush);
+}
+
+struct bpacket *
+subgroup_update_packet_commit(struct update_subgroup *subgrp,
+			      struct stream *packet,
+			      struct bpacket_attr_vec_arr *vecarr, unsigned int nadv)
+{
+	while (nadv--)
+		subgroup_update_packet_sync(subgrp);
+
+	return bpacket_queue_add(SUBGRP_PKTQ(subgrp), packet, vecarr);
+}
+
+void subgroup_update_packet_flush(struct update_subgroup *subgrp)
+{
+	struct bgp_advertise *adv;
+
+	while ((adv = bgp_adv_fifo_first(&subgrp->sync->update)))
+		bgp_advertise_clean_subgroup(subgrp, adv->adj);
+}
+
 /* Make BGP withdraw packet.  */
 /* For ipv4 unicast:
    16-octet marker | 2-octet length | 1-octet type |
@@ -0,0 +1,432 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP UPDATE generation worker pthreads.
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * Normally bgp_generate_updgrp_packets() formats UPDATEs for one subgroup
+ * at a time on the main pthread.  After a large change (e.g. a full table
+ * arriving) many independent subgroups have advertisements pending at the
+ * same time, and formatting them is then mostly attribute and NLRI
+ * encoding that does not depend on anything outside of the subgroup.
+ *
+ * When update workers are configured, the first subgroup that needs a
+ * packet triggers a batch: all eligible subgroups of the instance are
+ * handed to the worker pool (the main pthread takes part too) and the main
+ * pthread blocks until the batch is done.  While a subgroup is in a batch
+ * its advertisement FIFO and adj-outs belong to the job working on it; the
+ * workers only read them and never intern, unintern or free anything.
+ * Once everybody is done the main pthread synchronizes the adj-outs and
+ * queues the packets in order, exactly as subgroup_update_packet() would
+ * have done.
+ *
+ * Subgroups that are coalescing, have withdrawals queued or a peer whose
+ * MRAI timer is running are left to the regular path, so update-delay,
+ * coalesce-time and advertisement-interval behave the same as without
+ * workers.
+ */
+
+#include <zebra.h>
+
+#include "frr_pthread.h"
+#include "frrevent.h"
+#include "lib/json.h"
+#include "memory.h"
+#include "monotime.h"
+#include "stream.h"
+#include "vty.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_advertise.h"
+#include "bgpd/bgp_debug.h"
+#include "bgpd/bgp_fsm.h"
+#include "bgpd/bgp_updgrp.h"
+#include "bgpd/bgp_updgrp_workers.h"
+
+DEFINE_MTYPE_STATIC(BGPD, BGP_UPDATE_WORKER, "BGP update worker");
+DEFINE_MTYPE_STATIC(BGPD, BGP_UPDATE_BATCH, "BGP update worker batch");
+
+/* packets formatted per subgroup and batch at most */
+#define BGP_UPDATE_JOB_PKTS 16U
+
+/* a batch needs at least this many subgroups to be worth it */
+#define BGP_UPDATE_BATCH_MIN 2U
+
+struct bgp_update_worker {
+	struct frr_pthread *fpt;
+	struct event *t_run;
+	unsigned int index;
+
+	/* statistics, only written by the worker itself */
+	_Atomic uint64_t jobs;
+	_Atomic uint64_t packets;
+	_Atomic uint64_t busy_usec;
+};
+
+struct bgp_update_job {
+	struct update_subgroup *subgrp;
+	unsigned int budget;
+
+	/* results */
+	unsigned int count;
+	bool flush;
+	struct {
+		struct stream *packet;
+		struct bpacket_attr_vec_arr vecarr;
+		unsigned int nadv;
+	} pkts[BGP_UPDATE_JOB_PKTS];
+};
+
+struct bgp_update_batch {
+	struct bgp_update_job *jobs;
+	unsigned int njobs;
+	unsigned int alloc;
+
+	_Atomic unsigned int next;
+
+	pthread_mutex_t mtx;
+	pthread_cond_t cond;
+	unsigned int running;
+};
+
+static struct bgp_update_worker **workers;
+static unsigned int workers_configured;
+
+/* only used from the main pthread */
+static struct bgp_update_batch batch = {
+	.mtx = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+static struct {
+	uint64_t batches;
+	uint64_t subgroups;
+	uint64_t packets;
+	uint64_t main_jobs;
+} stats;
+
+unsigned int bgp_update_workers_count(void)
+{
+	return workers_configured;
+}
+
+static void bgp_update_job_run(struct bgp_update_job *job)
+{
+	struct update_subgroup *subgrp = job->subgrp;
+	struct bgp_advertise *adv;
+
+	adv = bgp_adv_fifo_first(&subgrp->sync->update);
+	while (adv && job->count < job->budget && !job->flush) {
+		struct stream *packet;
+		unsigned int nadv;
+
+		packet = subgroup_update_packet_concurrent(
+			subgrp, &adv, &job->pkts[job->count].vecarr, &nadv,
+			&job->flush);
+		if (!packet)
+			break;
+
+		job->pkts[job->count].packet = packet;
+		job->pkts[job->count].nadv = nadv;
+		job->count++;
+	}
+}
+
+/* run jobs off the batch until none are left, returns number of packets */
+static unsigned int bgp_update_batch_work(unsigned int *jobs)
+{
+	unsigned int packets = 0;
+	unsigned int i;
+
+	*jobs = 0;
+	while ((i = atomic_fetch_add_explicit(&batch.next, 1,
+					      memory_order_relaxed)) <
+	       batch.njobs) {
+		bgp_update_job_run(&batch.jobs[i]);
+		packets += batch.jobs[i].count;
+		(*jobs)++;
+	}
+
+	return packets;
+}
+
+static void bgp_update_worker_run(struct event *thread)
+{
+	struct bgp_update_worker *w = EVENT_ARG(thread);
+	struct timeval start;
+	unsigned int jobs, packets;
+
+	monotime(&start);
+	packets = bgp_update_batch_work(&jobs);
+
+	atomic_fetch_add_explicit(&w->jobs, jobs, memory_order_relaxed);
+	atomic_fetch_add_explicit(&w->packets, packets, memory_order_relaxed);
+	atomic_fetch_add_explicit(&w->busy_usec, monotime_since(&start, NULL),
+				  memory_order_relaxed);
+
+	frr_with_mutex (&batch.mtx) {
+		if (--batch.running == 0)
+			pthread_cond_signal(&batch.cond);
+	}
+}
+
+static bool bgp_update_subgrp_eligible(struct update_subgroup *subgrp)
+{
+	struct peer_af *paf;
+
+	if (!bgp_adv_fifo_count(&subgrp->sync->update) ||
+	    bgp_adv_fifo_count(&subgrp->sync->withdraw) ||
+	    bgp_adv_fifo_count(&subgrp->sync->withdraw_low))
+		return false;
+
+	if (subgrp->t_coalesce || !SUBGRP_PEER(subgrp) ||
+	    !peer_established(SUBGRP_PEER(subgrp)))
+		return false;
+
+	if (bpacket_queue_is_full(SUBGRP_INST(subgrp), SUBGRP_PKTQ(subgrp)))
+		return false;
+
+	SUBGRP_FOREACH_PEER (subgrp, paf)
+		if (PAF_PEER(paf)->t_routeadv)
+			return false;
+
+	return true;
+}
+
+static int bgp_update_collect_walkcb(struct update_group *updgrp, void *arg)
+{
+	struct update_subgroup *subgrp;
+	struct bgp_update_job *job;
+	unsigned int space;
+
+	UPDGRP_FOREACH_SUBGRP (updgrp, subgrp) {
+		if (!bgp_update_subgrp_eligible(subgrp))
+			continue;
+
+		if (batch.njobs == batch.alloc) {
+			batch.alloc = batch.alloc ? batch.alloc * 2 : 32;
+			batch.jobs = XREALLOC(MTYPE_BGP_UPDATE_BATCH, batch.jobs,
+					      batch.alloc *
+						      sizeof(*batch.jobs));
+		}
+
+		space = SUBGRP_INST(subgrp)->default_subgroup_pkt_queue_max -
+			subgrp->pkt_queue.curr_count;
+
+		job = &batch.jobs[batch.njobs++];
+		memset(job, 0, sizeof(*job));
+		job->subgrp = subgrp;
+		job->budget = MIN(space, BGP_UPDATE_JOB_PKTS);
+	}
+
+	return UPDWALK_CONTINUE;
+}
+
+static void bgp_update_batch_commit(void)
+{
+	unsigned int i, j;
+
+	for (i = 0; i < batch.njobs; i++) {
+		struct bgp_update_job *job = &batch.jobs[i];
+
+		for (j = 0; j < job->count; j++)
+			subgroup_update_packet_commit(job->subgrp,
+						      job->pkts[j].packet,
+						      &job->pkts[j].vecarr,
+						      job->pkts[j].nadv);
+		if (job->flush)
+			subgroup_update_packet_flush(job->subgrp);
+
+		if (job->count)
+			subgroup_trigger_write(job->subgrp);
+		stats.packets += job->count;
+	}
+}
+
+/* does the peer need a packet that a batch could produce? */
+static bool bgp_update_peer_wants(struct peer *peer)
+{
+	enum bgp_af_index index;
+	struct peer_af *paf;
+	struct bpacket *next_pkt;
+
+	for (index = BGP_AF_START; index < BGP_AF_MAX; index++) {
+		paf = peer->peer_af_array[index];
+		if (!paf || !PAF_SUBGRP(paf))
+			continue;
+
+		next_pkt = paf->next_pkt_to_send;
+		if (next_pkt && next_pkt->buffer)
+			continue;
+
+		if (bgp_update_subgrp_eligible(PAF_SUBGRP(paf)))
+			return true;
+	}
+
+	return false;
+}
+
+bool bgp_update_workers_run(struct peer *peer)
+{
+	unsigned int i, jobs;
+
+	if (!workers_configured)
+		return false;
+
+	/* debug output needs the main pthread, see subgroup_update_packet */
+	if (BGP_DEBUG(update, UPDATE_OUT) || BGP_DEBUG(update, UPDATE_PREFIX))
+		return false;
+
+	if (!bgp_update_peer_wants(peer))
+		return false;
+
+	batch.njobs = 0;
+	update_group_walk(peer->bgp, bgp_update_collect_walkcb, NULL);
+	if (batch.njobs < BGP_UPDATE_BATCH_MIN)
+		return false;
+
+	atomic_store_explicit(&batch.next, 0, memory_order_relaxed);
+	batch.running = MIN(workers_configured, batch.njobs - 1);
+
+	/* the mutex orders the job setup above before the workers start */
+	frr_with_mutex (&batch.mtx) {
+		for (i = 0; i < batch.running; i++)
+			event_add_event(workers[i]->fpt->master,
+					bgp_update_worker_run, workers[i], 0,
+					&workers[i]->t_run);
+	}
+
+	bgp_update_batch_work(&jobs);
+	stats.main_jobs += jobs;
+
+	frr_with_mutex (&batch.mtx) {
+		while (batch.running)
+			pthread_cond_wait(&batch.cond, &batch.mtx);
+	}
+
+	bgp_update_batch_commit();
+
+	stats.batches++;
+	stats.subgroups += batch.njobs;
+	batch.njobs = 0;
+	return true;
+}
+
+static void bgp_update_workers_stop(void)
+{
+	unsigned int i;
+
+	if (!workers_configured)
+		return;
+
+	/* batches are always finished before returning to the event loop */
+	for (i = 0; i < workers_configured; i++) {
+		frr_pthread_stop(workers[i]->fpt, NULL);
+		frr_pthread_destroy(workers[i]->fpt);
+		XFREE(MTYPE_BGP_UPDATE_WORKER, workers[i]);
+	}
+	XFREE(MTYPE_BGP_UPDATE_WORKER, workers);
+	workers_configured = 0;
+}
+
+void bgp_update_workers_set(unsigned int count)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+	char name[32];
+	char os_name[OS_THREAD_NAMELEN];
+	unsigned int i;
+
+	if (count > BGP_UPDATE_WORKERS_MAX)
+		count = BGP_UPDATE_WORKERS_MAX;
+	if (count == workers_configured)
+		return;
+
+	bgp_update_workers_stop();
+	if (!count)
+		return;
+
+	workers = XCALLOC(MTYPE_BGP_UPDATE_WORKER, count * sizeof(*workers));
+	for (i = 0; i < count; i++) {
+		struct bgp_update_worker *w;
+
+		w = XCALLOC(MTYPE_BGP_UPDATE_WORKER, sizeof(*w));
+		w->index = i;
+
+		snprintf(name, sizeof(name), "BGP update worker %u", i);
+		snprintf(os_name, sizeof(os_name), "bgpd_upd%u", i);
+		w->fpt = frr_pthread_new(&attr, name, os_name);
+		frr_pthread_run(w->fpt, NULL);
+		workers[i] = w;
+	}
+	for (i = 0; i < count; i++)
+		frr_pthread_wait_running(workers[i]->fpt);
+
+	workers_configured = count;
+}
+
+void bgp_update_workers_show(struct vty *vty, json_object *json)
+{
+	json_object *json_workers = NULL;
+	unsigned int i;
+
+	if (json) {
+		json_object_int_add(json, "workers", workers_configured);
+		json_object_int_add(json, "batches", stats.batches);
+		json_object_int_add(json, "subgroups", stats.subgroups);
+		json_object_int_add(json, "packets", stats.packets);
+		json_object_int_add(json, "mainPthreadJobs", stats.main_jobs);
+		json_workers = json_object_new_array();
+		json_object_object_add(json, "workerStats", json_workers);
+	} else {
+		if (!workers_configured) {
+			vty_out(vty, "BGP update workers are disabled\n");
+			return;
+		}
+		vty_out(vty,
+			"%" PRIu64 " batches, %" PRIu64 " subgroups, %" PRIu64
+			" packets, %" PRIu64 " jobs run on the main pthread\n",
+			stats.batches, stats.subgroups, stats.packets,
+			stats.main_jobs);
+		vty_out(vty, "%-6s %12s %12s %12s\n", "Worker", "Jobs",
+			"Packets", "Busy(ms)");
+	}
+
+	for (i = 0; i < workers_configured; i++) {
+		struct bgp_update_worker *w = workers[i];
+		uint64_t jobs, packets, busy;
+
+		jobs = atomic_load_explicit(&w->jobs, memory_order_relaxed);
+		packets = atomic_load_explicit(&w->packets,
+					       memory_order_relaxed);
+		busy = atomic_load_explicit(&w->busy_usec,
+					    memory_order_relaxed);
+
+		if (json) {
+			json_object *json_w = json_object_new_object();
+
+			json_object_int_add(json_w, "index", w->index);
+			json_object_int_add(json_w, "jobs", jobs);
+			json_object_int_add(json_w, "packets", packets);
+			json_object_int_add(json_w, "busyMsecs", busy / 1000);
+			json_object_array_add(json_workers, json_w);
+		} else
+			vty_out(vty,
+				"%-6u %12" PRIu64 " %12" PRIu64 " %12" PRIu64
+				"\n",
+				w->index, jobs, packets, busy / 1000);
+	}
+}
+
+void bgp_update_workers_init(void)
+{
+	workers = NULL;
+	workers_configured = 0;
+}
+
+void bgp_update_workers_finish(void)
+{
+	bgp_update_workers_stop();
+	XFREE(MTYPE_BGP_UPDATE_BATCH, batch.jobs);
+	batch.alloc = 0;
+}
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* BGP UPDATE generation worker pthreads.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#ifndef _FRR_BGP_UPDGRP_WORKERS_H
+#define _FRR_BGP_UPDGRP_WORKERS_H
+
+#include "bgpd/bgpd.h"
+
+#define BGP_UPDATE_WORKERS_MAX 16U
+
+/* configured number of workers, 0 if disabled */
+extern unsigned int bgp_update_workers_count(void);
+
+/* (re)configure the number of update workers, 0 disables them */
+extern void bgp_update_workers_set(unsigned int count);
+
+/*
+ * Main pthread, from bgp_generate_updgrp_packets(): if the peer is waiting
+ * for an UPDATE to be formatted, format pending UPDATEs of all eligible
+ * subgroups of its instance concurrently and queue the resulting packets.
+ * Does nothing (and returns false) if workers are disabled or there is not
+ * enough independent work to be worth it.
+ */
+extern bool bgp_update_workers_run(struct peer *peer);
+
+extern void bgp_update_workers_show(struct vty *vty, json_object *json);
+
+extern void bgp_update_workers_init(void);
+extern void bgp_update_workers_finish(void);
+
+#endif /* _FRR_BGP_UPDGRP_WORKERS_H */
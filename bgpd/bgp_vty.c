@@ -53,7 +53,12 @@
 #include "bgpd/bgp_packet.h"
 #include "bgpd/bgp_updgrp.h"
 #include "bgpd/bgp_bfd.h"
+#include "bgpd/bgp_intern.h"
 #include "bgpd/bgp_io.h"
+#include "bgpd/bgp_keepalives.h"
+#include "bgpd/bgp_parse.h"
+#include "bgpd/bgp_snapshot.h"
+#include "bgpd/bgp_updgrp_workers.h"
 #include "bgpd/bgp_evpn.h"
 #include "bgpd/bgp_evpn_vty.h"
 #include "bgpd/bgp_evpn_mh.h"
@@ -304,10 +309,8 @@ static int bgp_srv6_locator_unset(struct bgp *bgp)
 	}
 
 	/* refresh functions */
-	for (ALL_LIST_ELEMENTS(bgp->srv6_functions, node, nnode, func)) {
-		listnode_delete(bgp->srv6_functions, func);
-		XFREE(MTYPE_BGP_SRV6_FUNCTION, func);
-	}
+	for (ALL_LIST_ELEMENTS(bgp->srv6_functions, node, nnode, func))
+		bgp_srv6_function_delete(bgp, func);
 
 	/* refresh tovpn_sid */
 	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp_vrf)) {
@@ -2459,6 +2462,17 @@ void bgp_config_write_coalesce_time(struct vty *vty, struct bgp *bgp)
 		vty_out(vty, " coalesce-time %u\n", bgp->coalesce_time);
 }
 
+static void bgp_config_write_table_replay(struct vty *vty, struct bgp *bgp)
+{
+	if (!bgp->replay_batch)
+		return;
+
+	vty_out(vty, " table-replay batch %u", bgp->replay_batch);
+	if (bgp->replay_delay)
+		vty_out(vty, " delay %u", bgp->replay_delay);
+	vty_out(vty, "\n");
+}
+
 /* BGP TCP keepalive */
 static void bgp_config_tcp_keepalive(struct vty *vty, struct bgp *bgp)
 {
@@ -2501,6 +2515,39 @@ DEFUN (no_bgp_coalesce_time,
 	return CMD_SUCCESS;
 }
 
+DEFPY (bgp_table_replay,
+       bgp_table_replay_cmd,
+       "table-replay batch (100-1000000)$batch [delay (1-10000)$delay]",
+       "Announce tables to update-groups in batches\n"
+       "Number of prefixes per batch\n"
+       "Number of prefixes\n"
+       "Pause between batches\n"
+       "Pause in milliseconds\n")
+{
+	VTY_DECLVAR_CONTEXT(bgp, bgp);
+
+	bgp->replay_batch = batch;
+	bgp->replay_delay = delay_str ? delay : 0;
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_bgp_table_replay,
+       no_bgp_table_replay_cmd,
+       "no table-replay [batch (100-1000000) [delay (1-10000)]]",
+       NO_STR
+       "Announce tables to update-groups in batches\n"
+       "Number of prefixes per batch\n"
+       "Number of prefixes\n"
+       "Pause between batches\n"
+       "Pause in milliseconds\n")
+{
+	VTY_DECLVAR_CONTEXT(bgp, bgp);
+
+	bgp->replay_batch = 0;
+	bgp->replay_delay = 0;
+	return CMD_SUCCESS;
+}
+
 /* Maximum-paths configuration */
 DEFUN (bgp_maxpaths,
        bgp_maxpaths_cmd,
@@ -3728,6 +3775,75 @@ DEFPY (bgp_bestpath_aigp,
 	return CMD_SUCCESS;
 }
 
+DEFPY (bgp_nht_incremental,
+       bgp_nht_incremental_cmd,
+       "[no$no] bgp nexthop-tracking incremental",
+       NO_STR
+       BGP_STR
+       "Nexthop tracking\n"
+       "Only reprocess routes whose best path can change on IGP metric updates\n")
+{
+	VTY_DECLVAR_CONTEXT(bgp, bgp);
+
+	if (no)
+		UNSET_FLAG(bgp->flags, BGP_FLAG_NHT_INCREMENTAL);
+	else
+		SET_FLAG(bgp->flags, BGP_FLAG_NHT_INCREMENTAL);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (bgp_nhg_per_nexthop,
+       bgp_nhg_per_nexthop_cmd,
+       "[no$no] bgp nexthop-group",
+       NO_STR
+       BGP_STR
+       "Install single-path unicast routes via a zebra nexthop group per BGP nexthop\n")
+{
+	VTY_DECLVAR_CONTEXT(bgp, bgp);
+	afi_t afi;
+
+	if (!!no == !CHECK_FLAG(bgp->flags, BGP_FLAG_NHG_PER_NEXTHOP))
+		return CMD_SUCCESS;
+
+	if (no)
+		UNSET_FLAG(bgp->flags, BGP_FLAG_NHG_PER_NEXTHOP);
+	else
+		SET_FLAG(bgp->flags, BGP_FLAG_NHG_PER_NEXTHOP);
+
+	/* move installed routes over before the groups go away */
+	for (afi = AFI_IP; afi <= AFI_IP6; afi++)
+		bgp_zebra_announce_table(bgp, afi, SAFI_UNICAST);
+
+	if (no)
+		bgp_nht_nhg_release_all(bgp);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (bgp_rs_shared_views,
+       bgp_rs_shared_views_cmd,
+       "[no$no] bgp route-server shared-views",
+       NO_STR
+       BGP_STR
+       "Route-server configuration\n"
+       "Group route-server clients by outbound route-map contents instead of name\n")
+{
+	VTY_DECLVAR_CONTEXT(bgp, bgp);
+
+	if (!!no == !CHECK_FLAG(bgp->flags, BGP_FLAG_RS_SHARED_VIEWS))
+		return CMD_SUCCESS;
+
+	if (no)
+		UNSET_FLAG(bgp->flags, BGP_FLAG_RS_SHARED_VIEWS);
+	else
+		SET_FLAG(bgp->flags, BGP_FLAG_RS_SHARED_VIEWS);
+
+	update_group_rs_adjust(bgp, NULL);
+
+	return CMD_SUCCESS;
+}
+
 /* "bgp bestpath compare-routerid" configuration.  */
 DEFUN (bgp_bestpath_compare_router_id,
        bgp_bestpath_compare_router_id_cmd,
@@ -6278,35 +6394,60 @@ ALIAS_HIDDEN(
 /* neighbor soft-reconfig. */
 DEFUN (neighbor_soft_reconfiguration,
        neighbor_soft_reconfiguration_cmd,
-       "neighbor <A.B.C.D|X:X::X:X|WORD> soft-reconfiguration inbound",
+       "neighbor <A.B.C.D|X:X::X:X|WORD> soft-reconfiguration inbound [dedup]",
        NEIGHBOR_STR
        NEIGHBOR_ADDR_STR2
        "Per neighbor soft reconfiguration\n"
-       "Allow inbound soft reconfiguration for this neighbor\n")
+       "Allow inbound soft reconfiguration for this neighbor\n"
+       "Do not keep routes the inbound policy leaves unchanged twice\n")
 {
 	int idx_peer = 1;
-	return peer_af_flag_set_vty(vty, argv[idx_peer]->arg, bgp_node_afi(vty),
-				    bgp_node_safi(vty),
-				    PEER_FLAG_SOFT_RECONFIG);
+	int idx_dedup = 4;
+	int ret;
+
+	ret = peer_af_flag_set_vty(vty, argv[idx_peer]->arg, bgp_node_afi(vty),
+				   bgp_node_safi(vty), PEER_FLAG_SOFT_RECONFIG);
+	if (ret != CMD_SUCCESS)
+		return ret;
+
+	if (argc > idx_dedup)
+		return peer_af_flag_set_vty(vty, argv[idx_peer]->arg,
+					    bgp_node_afi(vty),
+					    bgp_node_safi(vty),
+					    PEER_FLAG_SOFT_RECONFIG_DEDUP);
+	return peer_af_flag_unset_vty(vty, argv[idx_peer]->arg,
+				      bgp_node_afi(vty), bgp_node_safi(vty),
+				      PEER_FLAG_SOFT_RECONFIG_DEDUP);
 }
 
 ALIAS_HIDDEN(neighbor_soft_reconfiguration,
 	     neighbor_soft_reconfiguration_hidden_cmd,
-	     "neighbor <A.B.C.D|X:X::X:X|WORD> soft-reconfiguration inbound",
+	     "neighbor <A.B.C.D|X:X::X:X|WORD> soft-reconfiguration inbound [dedup]",
 	     NEIGHBOR_STR NEIGHBOR_ADDR_STR2
 	     "Per neighbor soft reconfiguration\n"
-	     "Allow inbound soft reconfiguration for this neighbor\n")
+	     "Allow inbound soft reconfiguration for this neighbor\n"
+	     "Do not keep routes the inbound policy leaves unchanged twice\n")
 
 DEFUN (no_neighbor_soft_reconfiguration,
        no_neighbor_soft_reconfiguration_cmd,
-       "no neighbor <A.B.C.D|X:X::X:X|WORD> soft-reconfiguration inbound",
+       "no neighbor <A.B.C.D|X:X::X:X|WORD> soft-reconfiguration inbound [dedup]",
        NO_STR
        NEIGHBOR_STR
        NEIGHBOR_ADDR_STR2
        "Per neighbor soft reconfiguration\n"
-       "Allow inbound soft reconfiguration for this neighbor\n")
+       "Allow inbound soft reconfiguration for this neighbor\n"
+       "Do not keep routes the inbound policy leaves unchanged twice\n")
 {
 	int idx_peer = 2;
+	int idx_dedup = 5;
+	int ret;
+
+	ret = peer_af_flag_unset_vty(vty, argv[idx_peer]->arg,
+				     bgp_node_afi(vty), bgp_node_safi(vty),
+				     PEER_FLAG_SOFT_RECONFIG_DEDUP);
+	if (ret != CMD_SUCCESS || argc > idx_dedup)
+		return ret;
+
 	return peer_af_flag_unset_vty(vty, argv[idx_peer]->arg,
 				      bgp_node_afi(vty), bgp_node_safi(vty),
 				      PEER_FLAG_SOFT_RECONFIG);
@@ -6314,10 +6455,11 @@ DEFUN (no_neighbor_soft_reconfiguration,
 
 ALIAS_HIDDEN(no_neighbor_soft_reconfiguration,
 	     no_neighbor_soft_reconfiguration_hidden_cmd,
-	     "no neighbor <A.B.C.D|X:X::X:X|WORD> soft-reconfiguration inbound",
+	     "no neighbor <A.B.C.D|X:X::X:X|WORD> soft-reconfiguration inbound [dedup]",
 	     NO_STR NEIGHBOR_STR NEIGHBOR_ADDR_STR2
 	     "Per neighbor soft reconfiguration\n"
-	     "Allow inbound soft reconfiguration for this neighbor\n")
+	     "Allow inbound soft reconfiguration for this neighbor\n"
+	     "Do not keep routes the inbound policy leaves unchanged twice\n")
 
 DEFUN (neighbor_route_reflector_client,
        neighbor_route_reflector_client_cmd,
@@ -10723,6 +10865,24 @@ DEFUN(show_bgp_martian_nexthop_db, show_bgp_martian_nexthop_db_cmd,
 	return CMD_SUCCESS;
 }
 
+/* Adj-RIB-In entries not kept due to soft-reconfiguration inbound dedup */
+static unsigned long bgp_adj_in_shared_count(void)
+{
+	struct listnode *node, *pnode;
+	struct bgp *bgp;
+	struct peer *peer;
+	afi_t afi;
+	safi_t safi;
+	unsigned long count = 0;
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp))
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, pnode, peer))
+			FOREACH_AFI_SAFI (afi, safi)
+				count += peer->adj_in_shared[afi][safi];
+
+	return count;
+}
+
 DEFUN (show_bgp_memory,
        show_bgp_memory_cmd,
        "show [ip] bgp memory",
@@ -10732,6 +10892,7 @@ DEFUN (show_bgp_memory,
        "Global BGP memory statistics\n")
 {
 	char memstrbuf[MTYPE_MEMSTR_LEN];
+	struct bgp_intern_stats attr_stats;
 	unsigned long count;
 
 	/* RIB related usage stats */
@@ -10750,6 +10911,29 @@ DEFUN (show_bgp_memory,
 			mtype_memstr(
 				memstrbuf, sizeof(memstrbuf),
 				count * sizeof(struct bgp_path_info_extra)));
+	if ((count = mtype_stats_alloc(MTYPE_BGP_ROUTE_EXTRA_VRFLEAK)))
+		vty_out(vty, "  %ld with vrf leaking info, using %s of memory\n",
+			count,
+			mtype_memstr(memstrbuf, sizeof(memstrbuf),
+				     count * sizeof(struct
+						    bgp_path_info_extra_vrfleak)));
+	if ((count = mtype_stats_alloc(MTYPE_BGP_ROUTE_EXTRA_EVPN)))
+		vty_out(vty, "  %ld with EVPN info, using %s of memory\n",
+			count,
+			mtype_memstr(memstrbuf, sizeof(memstrbuf),
+				     count * sizeof(struct
+						    bgp_path_info_extra_evpn)));
+	if ((count = mtype_stats_alloc(MTYPE_BGP_ROUTE_EXTRA_FS)))
+		vty_out(vty, "  %ld with flowspec info, using %s of memory\n",
+			count,
+			mtype_memstr(memstrbuf, sizeof(memstrbuf),
+				     count * sizeof(struct
+						    bgp_path_info_extra_fs)));
+	if ((count = mtype_stats_alloc(MTYPE_BGP_DAMP_INFO)))
+		vty_out(vty, "  %ld with dampening info, using %s of memory\n",
+			count,
+			mtype_memstr(memstrbuf, sizeof(memstrbuf),
+				     count * sizeof(struct bgp_damp_info)));
 
 	if ((count = mtype_stats_alloc(MTYPE_BGP_STATIC)))
 		vty_out(vty, "%ld Static routes, using %s of memory\n", count,
@@ -10766,10 +10950,24 @@ DEFUN (show_bgp_memory,
 		vty_out(vty, "%ld Adj-In entries, using %s of memory\n", count,
 			mtype_memstr(memstrbuf, sizeof(memstrbuf),
 				     count * sizeof(struct bgp_adj_in)));
-	if ((count = mtype_stats_alloc(MTYPE_BGP_ADJ_OUT)))
+	if ((count = bgp_adj_in_shared_count()))
+		vty_out(vty,
+			"%ld Adj-In entries shared with paths, saving %s of memory\n",
+			count,
+			mtype_memstr(memstrbuf, sizeof(memstrbuf),
+				     count * sizeof(struct bgp_adj_in)));
+	if ((count = mtype_stats_alloc(MTYPE_BGP_ADJ_OUT))) {
+		unsigned long pending = mtype_stats_alloc(MTYPE_BGP_ADVERTISE);
+
 		vty_out(vty, "%ld Adj-Out entries, using %s of memory\n", count,
 			mtype_memstr(memstrbuf, sizeof(memstrbuf),
 				     count * sizeof(struct bgp_adj_out)));
+		vty_out(vty,
+			"  %lu with an advertisement in flight, using %s of memory\n",
+			pending,
+			mtype_memstr(memstrbuf, sizeof(memstrbuf),
+				     pending * sizeof(struct bgp_advertise)));
+	}
 
 	if ((count = mtype_stats_alloc(MTYPE_BGP_NEXTHOP_CACHE)))
 		vty_out(vty, "%ld Nexthop cache entries, using %s of memory\n",
@@ -10792,6 +10990,22 @@ DEFUN (show_bgp_memory,
 	if ((count = attr_unknown_count()))
 		vty_out(vty, "%ld unknown attributes\n", count);
 
+	attr_intern_stats_get(&attr_stats);
+	vty_out(vty,
+		"Attribute intern table: %u shards, %lu of %lu buckets used, average chain %.2f, max average chain per shard %lu\n",
+		attr_stats.shards, attr_stats.used_buckets, attr_stats.buckets,
+		attr_stats.used_buckets ? (double)attr_stats.entries /
+						  attr_stats.used_buckets
+					: 0.0,
+		attr_stats.max_chain);
+	vty_out(vty,
+		"Attribute intern lookups: %" PRIu64 ", hits %" PRIu64
+		" (%.1f%%)\n",
+		attr_stats.lookups, attr_stats.hits,
+		attr_stats.lookups ? (double)attr_stats.hits * 100.0 /
+					     attr_stats.lookups
+				   : 0.0);
+
 	/* AS_PATH attributes */
 	count = aspath_count();
 	vty_out(vty, "%ld BGP AS-PATH entries, using %s of memory\n", count,
@@ -11516,6 +11730,10 @@ static int bgp_show_summary(struct vty *vty, struct bgp *bgp, int afi, int safi,
 
 				json_object_int_add(json_peer, "pfxRcd",
 						    peer->pcount[afi][pfx_rcd_safi]);
+				json_object_int_add(
+					json_peer, "pfxFiltered",
+					peer->filtered_pcount[afi]
+							     [pfx_rcd_safi]);
 
 				if (paf && PAF_SUBGRP(paf))
 					json_object_int_add(
@@ -12585,6 +12803,14 @@ static void bgp_show_peer_afi(struct vty *vty, struct peer *p, afi_t afi,
 		if (CHECK_FLAG(p->af_flags[afi][safi], PEER_FLAG_SOFT_RECONFIG))
 			json_object_boolean_true_add(json_addr,
 						     "inboundSoftConfigPermit");
+		if (CHECK_FLAG(p->af_sflags[afi][safi],
+			       PEER_STATUS_ADJ_IN_SHED))
+			json_object_boolean_true_add(
+				json_addr, "adjRibInShedMemoryPressure");
+		if (CHECK_FLAG(p->af_flags[afi][safi],
+			       PEER_FLAG_SOFT_RECONFIG_DEDUP))
+			json_object_int_add(json_addr, "adjRibInShared",
+					    p->adj_in_shared[afi][safi]);
 
 		if (CHECK_FLAG(p->af_flags[afi][safi],
 			       PEER_FLAG_REMOVE_PRIVATE_AS_ALL_REPLACE))
@@ -12784,6 +13010,10 @@ static void bgp_show_peer_afi(struct vty *vty, struct peer *p, afi_t afi,
 		/* Receive prefix count */
 		json_object_int_add(json_addr, "acceptedPrefixCounter",
 				    p->pcount[afi][safi]);
+		if (CHECK_FLAG(p->af_flags[afi][safi],
+			       PEER_FLAG_SOFT_RECONFIG))
+			json_object_int_add(json_addr, "filteredPrefixCounter",
+					    p->filtered_pcount[afi][safi]);
 		if (paf && PAF_SUBGRP(paf))
 			json_object_int_add(json_addr, "sentPrefixCounter",
 						(PAF_SUBGRP(paf))->scount);
@@ -12910,6 +13140,15 @@ static void bgp_show_peer_afi(struct vty *vty, struct peer *p, afi_t afi,
 		if (CHECK_FLAG(p->af_flags[afi][safi], PEER_FLAG_SOFT_RECONFIG))
 			vty_out(vty,
 				"  Inbound soft reconfiguration allowed\n");
+		if (CHECK_FLAG(p->af_sflags[afi][safi],
+			       PEER_STATUS_ADJ_IN_SHED))
+			vty_out(vty,
+				"  Adj-RIB-In dropped under memory pressure\n");
+		if (CHECK_FLAG(p->af_flags[afi][safi],
+			       PEER_FLAG_SOFT_RECONFIG_DEDUP))
+			vty_out(vty,
+				"  Adj-RIB-In shared with %u accepted paths\n",
+				p->adj_in_shared[afi][safi]);
 
 		if (CHECK_FLAG(p->af_flags[afi][safi],
 			       PEER_FLAG_REMOVE_PRIVATE_AS_ALL_REPLACE))
@@ -13105,6 +13344,10 @@ static void bgp_show_peer_afi(struct vty *vty, struct peer *p, afi_t afi,
 		/* Receive prefix count */
 		vty_out(vty, "  %u accepted prefixes\n",
 			p->pcount[afi][safi]);
+		if (CHECK_FLAG(p->af_flags[afi][safi],
+			       PEER_FLAG_SOFT_RECONFIG))
+			vty_out(vty, "  %u filtered prefixes\n",
+				p->filtered_pcount[afi][safi]);
 
 		/* maximum-prefix-out */
 		if (CHECK_FLAG(p->af_flags[afi][safi],
@@ -14589,12 +14832,36 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, bool use_json,
 							 memory_order_relaxed));
 		json_object_int_add(json_stat, "totalSent", PEER_TOTAL_TX(p));
 		json_object_int_add(json_stat, "totalRecv", PEER_TOTAL_RX(p));
+		json_object_int_add(json_stat, "ioReads",
+				    atomic_load_explicit(&p->io_reads,
+							 memory_order_relaxed));
+		json_object_int_add(json_stat, "ioReadPackets",
+				    atomic_load_explicit(&p->io_read_pkts,
+							 memory_order_relaxed));
+		json_object_int_add(json_stat, "ioWakeups",
+				    atomic_load_explicit(&p->io_wakeups,
+							 memory_order_relaxed));
+		frr_with_mutex (&p->io_mtx) {
+			uint64_t busy_avg = 0;
+
+			if (p->outq_busy_count)
+				busy_avg = p->outq_busy_usec /
+					   p->outq_busy_count;
+			json_object_int_add(json_stat, "outqBusyCount",
+					    p->outq_busy_count);
+			json_object_int_add(json_stat, "outqBusyAvgMsecs",
+					    busy_avg / 1000);
+			json_object_int_add(json_stat, "outqBusyMaxMsecs",
+					    p->outq_busy_max_usec / 1000);
+		}
 		json_object_object_add(json_neigh, "messageStats", json_stat);
 	} else {
 		atomic_size_t outq_count, inq_count, open_out, open_in,
 			notify_out, notify_in, update_out, update_in,
 			keepalive_out, keepalive_in, refresh_out, refresh_in,
 			dynamic_cap_out, dynamic_cap_in;
+		uint64_t io_reads, io_read_pkts, io_wakeups;
+		uint64_t busy_count, busy_usec, busy_max_usec;
 		outq_count = atomic_load_explicit(&p->obuf->count,
 						  memory_order_relaxed);
 		inq_count = atomic_load_explicit(&p->ibuf->count,
@@ -14623,6 +14890,17 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, bool use_json,
 						       memory_order_relaxed);
 		dynamic_cap_in = atomic_load_explicit(&p->dynamic_cap_in,
 						      memory_order_relaxed);
+		io_reads = atomic_load_explicit(&p->io_reads,
+						memory_order_relaxed);
+		io_read_pkts = atomic_load_explicit(&p->io_read_pkts,
+						    memory_order_relaxed);
+		io_wakeups = atomic_load_explicit(&p->io_wakeups,
+						  memory_order_relaxed);
+		frr_with_mutex (&p->io_mtx) {
+			busy_count = p->outq_busy_count;
+			busy_usec = p->outq_busy_usec;
+			busy_max_usec = p->outq_busy_max_usec;
+		}
 
 		/* Packet counts. */
 		vty_out(vty, "  Message statistics:\n");
@@ -14643,6 +14921,18 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, bool use_json,
 			dynamic_cap_out, dynamic_cap_in);
 		vty_out(vty, "    Total:         %10u %10u\n",
 			(uint32_t)PEER_TOTAL_TX(p), (uint32_t)PEER_TOTAL_RX(p));
+		vty_out(vty,
+			"    Reads %" PRIu64 ", %.1f packets per read; wakeups %" PRIu64
+			", %.1f packets per wakeup\n",
+			io_reads,
+			io_reads ? (double)io_read_pkts / io_reads : 0.0,
+			io_wakeups,
+			io_wakeups ? (double)io_read_pkts / io_wakeups : 0.0);
+		vty_out(vty,
+			"    Outq drained %" PRIu64 " times, %.1f ms average, %.1f ms max\n",
+			busy_count,
+			busy_count ? busy_usec / 1000.0 / busy_count : 0.0,
+			busy_max_usec / 1000.0);
 	}
 
 	if (use_json) {
@@ -15449,6 +15739,127 @@ DEFUN (show_ip_bgp_neighbors,
 	return bgp_show_neighbor_vty(vty, vrf, sh_type, sh_arg, uj);
 }
 
+static const char *const bgp_cpu_stage_name[BGP_CPU_STAGE_MAX][2] = {
+	[BGP_CPU_NLRI] = { "NLRI processing", "nlri" },
+	[BGP_CPU_POLICY_IN] = { "Inbound policy", "inboundPolicy" },
+	[BGP_CPU_BESTPATH] = { "Best path", "bestPath" },
+	[BGP_CPU_UPDATE_OUT] = { "Outbound UPDATEs", "updateOut" },
+};
+
+static void bgp_cpu_stat_show(struct vty *vty, json_object *json,
+			      const char *name, const char *jname,
+			      const struct bgp_cpu_stat *stat)
+{
+	json_object *json_stat;
+
+	if (json) {
+		json_stat = json_object_new_object();
+		json_object_int_add(json_stat, "count", stat->count);
+		json_object_int_add(json_stat, "usecs", stat->nsec / 1000);
+		json_object_object_add(json, jname, json_stat);
+		return;
+	}
+
+	vty_out(vty, "    %-20s %12" PRIu64 " %14" PRIu64 " %10" PRIu64 "\n",
+		name, stat->count, stat->nsec / 1000,
+		stat->count ? stat->nsec / stat->count : 0);
+}
+
+static void bgp_show_peer_cpu(struct vty *vty, struct peer *peer,
+			      json_object *json)
+{
+	json_object *json_afs = NULL, *json_af = NULL;
+	const struct bgp_cpu_stat *stats;
+	enum bgp_cpu_stage stage;
+	afi_t afi;
+	safi_t safi;
+
+	if (json) {
+		json_object_string_add(json, "peer", peer->host);
+		bgp_cpu_stat_show(vty, json, NULL, "updateParse",
+				  &peer->cpu_parse);
+		json_afs = json_object_new_object();
+		json_object_object_add(json, "afiSafis", json_afs);
+	} else {
+		vty_out(vty, "BGP neighbor %s, main pthread time\n",
+			peer->host);
+		vty_out(vty, "    %-20s %12s %14s %10s\n", "", "Count",
+			"Total (usec)", "Avg (nsec)");
+		bgp_cpu_stat_show(vty, NULL, "UPDATE parsing", NULL,
+				  &peer->cpu_parse);
+	}
+
+	FOREACH_AFI_SAFI (afi, safi) {
+		stats = peer->cpu_stats[afi][safi];
+
+		for (stage = 0; stage < BGP_CPU_STAGE_MAX; stage++)
+			if (stats[stage].count)
+				break;
+		if (stage == BGP_CPU_STAGE_MAX)
+			continue;
+
+		if (json) {
+			json_af = json_object_new_object();
+			json_object_object_add(json_afs,
+					       get_afi_safi_str(afi, safi, true),
+					       json_af);
+		} else
+			vty_out(vty, "  %s\n",
+				get_afi_safi_str(afi, safi, false));
+
+		for (stage = 0; stage < BGP_CPU_STAGE_MAX; stage++)
+			bgp_cpu_stat_show(vty, json_af,
+					  bgp_cpu_stage_name[stage][0],
+					  bgp_cpu_stage_name[stage][1],
+					  &stats[stage]);
+	}
+}
+
+DEFPY (show_ip_bgp_neighbor_statistics,
+       show_ip_bgp_neighbor_statistics_cmd,
+       "show [ip] bgp [<view|vrf> VIEWVRFNAME$vrf] neighbors <A.B.C.D|X:X::X:X|WORD>$neighbor statistics [json]$uj",
+       SHOW_STR
+       IP_STR
+       BGP_STR
+       BGP_INSTANCE_HELP_STR
+       "Detailed information on TCP and BGP neighbor connections\n"
+       "Neighbor to display information about\n"
+       "Neighbor to display information about\n"
+       "Neighbor on BGP configured interface\n"
+       "Main pthread time spent on the neighbor\n"
+       JSON_STR)
+{
+	json_object *json = NULL;
+	struct bgp *bgp;
+	struct peer *peer;
+
+	if (vrf && !strmatch(vrf, VRF_DEFAULT_NAME))
+		bgp = bgp_lookup_by_name(vrf);
+	else
+		bgp = bgp_get_default();
+	if (!bgp) {
+		if (uj)
+			vty_out(vty, "{}\n");
+		else
+			vty_out(vty, "%% BGP instance not found\n");
+		return CMD_WARNING;
+	}
+
+	peer = peer_lookup_in_view(vty, bgp, neighbor, !!uj);
+	if (!peer)
+		return CMD_WARNING;
+
+	if (uj)
+		json = json_object_new_object();
+
+	bgp_show_peer_cpu(vty, peer, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
 /* Show BGP's AS paths internal data.  There are both `show [ip] bgp
    paths' and `show ip mbgp paths'.  Those functions results are the
    same.*/
@@ -15489,10 +15900,9 @@ DEFUN (show_ip_bgp_community_info,
 {
 	vty_out(vty, "Address Refcnt Community\n");
 
-	hash_iterate(community_hash(),
-		     (void (*)(struct hash_bucket *,
-			       void *))community_show_all_iterator,
-		     vty);
+	community_iterate((void (*)(struct hash_bucket *,
+				    void *))community_show_all_iterator,
+			  vty);
 
 	return CMD_SUCCESS;
 }
@@ -15518,10 +15928,9 @@ DEFUN (show_ip_bgp_lcommunity_info,
 {
 	vty_out(vty, "Address Refcnt Large-community\n");
 
-	hash_iterate(lcommunity_hash(),
-		     (void (*)(struct hash_bucket *,
-			       void *))lcommunity_show_all_iterator,
-		     vty);
+	lcommunity_iterate((void (*)(struct hash_bucket *,
+				     void *))lcommunity_show_all_iterator,
+			   vty);
 
 	return CMD_SUCCESS;
 }
@@ -17899,8 +18308,12 @@ static void bgp_config_write_peer_af(struct vty *vty, struct bgp *bgp,
 
 	/* Soft reconfiguration inbound. */
 	if (peergroup_af_flag_check(peer, afi, safi, PEER_FLAG_SOFT_RECONFIG)) {
-		vty_out(vty, "  neighbor %s soft-reconfiguration inbound\n",
-			addr);
+		vty_out(vty, "  neighbor %s soft-reconfiguration inbound%s\n",
+			addr,
+			CHECK_FLAG(peer->af_flags[afi][safi],
+				   PEER_FLAG_SOFT_RECONFIG_DEDUP)
+				? " dedup"
+				: "");
 	}
 
 	/* maximum-prefix. */
@@ -18162,6 +18575,32 @@ int bgp_config_write(struct vty *vty)
 	if (bm->outq_limit != BM_DEFAULT_Q_LIMIT)
 		vty_out(vty, "bgp output-queue-limit %u\n", bm->outq_limit);
 
+	if (bm->process_batch != BM_DEFAULT_PROCESS_BATCH)
+		vty_out(vty, "bgp route-processing batch-size %u\n",
+			bm->process_batch);
+
+	/* BGP UPDATE parse workers */
+	if (bgp_parse_workers_count())
+		vty_out(vty, "bgp parse-workers %u\n",
+			bgp_parse_workers_count());
+
+	if (bgp_update_workers_count())
+		vty_out(vty, "bgp update-workers %u\n",
+			bgp_update_workers_count());
+
+	if (bgp_snapshot_path()) {
+		vty_out(vty, "bgp rib-snapshot %s", bgp_snapshot_path());
+		if (bgp_snapshot_interval() != BGP_SNAPSHOT_INTERVAL_DEFAULT)
+			vty_out(vty, " interval %u", bgp_snapshot_interval());
+		vty_out(vty, "\n");
+	}
+
+	/* BGP table node pools */
+	FOREACH_AFI_SAFI (afi, safi)
+		if (bm->table_pool[afi][safi])
+			vty_out(vty, "bgp node-pool %s %s\n",
+				afi2str_lower(afi), safi2str(safi));
+
 	/* BGP configuration. */
 	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
 
@@ -18350,6 +18789,8 @@ int bgp_config_write(struct vty *vty)
 		/* coalesce time */
 		bgp_config_write_coalesce_time(vty, bgp);
 
+		bgp_config_write_table_replay(vty, bgp);
+
 		/* BGP per-instance graceful-shutdown */
 		/* BGP-wide settings and per-instance settings are mutually
 		 * exclusive.
@@ -18432,6 +18873,12 @@ int bgp_config_write(struct vty *vty)
 			vty_out(vty, " bgp bestpath compare-routerid\n");
 		if (CHECK_FLAG(bgp->flags, BGP_FLAG_COMPARE_AIGP))
 			vty_out(vty, " bgp bestpath aigp\n");
+		if (CHECK_FLAG(bgp->flags, BGP_FLAG_NHT_INCREMENTAL))
+			vty_out(vty, " bgp nexthop-tracking incremental\n");
+		if (CHECK_FLAG(bgp->flags, BGP_FLAG_NHG_PER_NEXTHOP))
+			vty_out(vty, " bgp nexthop-group\n");
+		if (CHECK_FLAG(bgp->flags, BGP_FLAG_RS_SHARED_VIEWS))
+			vty_out(vty, " bgp route-server shared-views\n");
 		if (CHECK_FLAG(bgp->flags, BGP_FLAG_MED_CONFED)
 		    || CHECK_FLAG(bgp->flags, BGP_FLAG_MED_MISSING_AS_WORST)) {
 			vty_out(vty, " bgp bestpath med");
@@ -18773,6 +19220,9 @@ static void bgp_config_finish(struct event *t)
 	struct listnode *node;
 	struct bgp *bgp;
 
+	/* peers are configured, but not started yet */
+	bgp_snapshot_restore();
+
 	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp))
 		hook_call(bgp_config_end, bgp);
 }
@@ -18931,6 +19381,270 @@ DEFPY (no_bgp_outq_limit,
 	return CMD_SUCCESS;
 }
 
+DEFPY (bgp_process_batch,
+       bgp_process_batch_cmd,
+       "bgp route-processing batch-size (1-1000000)$size",
+       BGP_STR
+       "Route processing (best path selection) work queue\n"
+       "Maximum number of prefixes handled per work queue item\n"
+       "Number of prefixes\n")
+{
+	bm->process_batch = size;
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_bgp_process_batch,
+       no_bgp_process_batch_cmd,
+       "no bgp route-processing batch-size [(1-1000000)]",
+       NO_STR
+       BGP_STR
+       "Route processing (best path selection) work queue\n"
+       "Maximum number of prefixes handled per work queue item\n"
+       "Number of prefixes\n")
+{
+	bm->process_batch = BM_DEFAULT_PROCESS_BATCH;
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (bgp_parse_workers,
+       bgp_parse_workers_cmd,
+       "bgp parse-workers (1-16)$count",
+       BGP_STR
+       "Decode received UPDATE messages in a pool of worker pthreads\n"
+       "Number of worker pthreads\n")
+{
+	bgp_parse_workers_set(count);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_bgp_parse_workers,
+       no_bgp_parse_workers_cmd,
+       "no bgp parse-workers [(1-16)]",
+       NO_STR
+       BGP_STR
+       "Decode received UPDATE messages in a pool of worker pthreads\n"
+       "Number of worker pthreads\n")
+{
+	bgp_parse_workers_set(0);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (bgp_update_workers,
+       bgp_update_workers_cmd,
+       "bgp update-workers (1-16)$count",
+       BGP_STR
+       "Format outgoing UPDATE messages in a pool of worker pthreads\n"
+       "Number of worker pthreads\n")
+{
+	bgp_update_workers_set(count);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_bgp_update_workers,
+       no_bgp_update_workers_cmd,
+       "no bgp update-workers [(1-16)]",
+       NO_STR
+       BGP_STR
+       "Format outgoing UPDATE messages in a pool of worker pthreads\n"
+       "Number of worker pthreads\n")
+{
+	bgp_update_workers_set(0);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (bgp_rib_snapshot,
+       bgp_rib_snapshot_cmd,
+       "bgp rib-snapshot FILENAME$filename [interval (60-86400)$interval]",
+       BGP_STR
+       "Keep a snapshot of the received paths to restore on startup\n"
+       "Snapshot file\n"
+       "Interval between snapshots\n"
+       "Interval in seconds\n")
+{
+	char path[MAXPATHLEN];
+
+	if (filename[0] != DIRECTORY_SEP)
+		snprintf(path, sizeof(path), "%s/%s", vty_get_cwd(), filename);
+	else
+		strlcpy(path, filename, sizeof(path));
+
+	bgp_snapshot_set(path, interval_str ? interval
+					    : BGP_SNAPSHOT_INTERVAL_DEFAULT);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_bgp_rib_snapshot,
+       no_bgp_rib_snapshot_cmd,
+       "no bgp rib-snapshot [FILENAME [interval (60-86400)]]",
+       NO_STR
+       BGP_STR
+       "Keep a snapshot of the received paths to restore on startup\n"
+       "Snapshot file\n"
+       "Interval between snapshots\n"
+       "Interval in seconds\n")
+{
+	bgp_snapshot_set(NULL, BGP_SNAPSHOT_INTERVAL_DEFAULT);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (bgp_node_pool,
+       bgp_node_pool_cmd,
+       "[no$no] bgp node-pool <ipv4|ipv6>$afi_str <unicast|multicast|vpn|labeled-unicast|flowspec>$safi_str",
+       NO_STR
+       BGP_STR
+       "Allocate table nodes from contiguous pools\n"
+       "Address Family\n"
+       "Address Family\n"
+       "Address Family modifier\n"
+       "Address Family modifier\n"
+       "Address Family modifier\n"
+       "Address Family modifier\n"
+       "Address Family modifier\n")
+{
+	afi_t afi = bgp_vty_afi_from_str(afi_str);
+	safi_t safi = bgp_vty_safi_from_str(safi_str);
+
+	/* only applies to tables created from now on */
+	bm->table_pool[afi][safi] = !no;
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_bgp_node_pool,
+       show_bgp_node_pool_cmd,
+       "show bgp node-pool [json]$uj",
+       SHOW_STR
+       BGP_STR
+       "BGP table node pool statistics\n"
+       JSON_STR)
+{
+	json_object *json = NULL;
+
+	if (uj)
+		json = json_object_new_object();
+
+	bgp_table_pool_show(vty, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_bgp_parse_workers,
+       show_bgp_parse_workers_cmd,
+       "show bgp parse-workers [json]$uj",
+       SHOW_STR
+       BGP_STR
+       "BGP UPDATE parse worker statistics\n"
+       JSON_STR)
+{
+	json_object *json = NULL;
+
+	if (uj)
+		json = json_object_new_object();
+
+	bgp_parse_workers_show(vty, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_bgp_update_workers,
+       show_bgp_update_workers_cmd,
+       "show bgp update-workers [json]$uj",
+       SHOW_STR
+       BGP_STR
+       "BGP UPDATE generation worker statistics\n"
+       JSON_STR)
+{
+	json_object *json = NULL;
+
+	if (uj)
+		json = json_object_new_object();
+
+	bgp_update_workers_show(vty, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_bgp_rib_snapshot,
+       show_bgp_rib_snapshot_cmd,
+       "show bgp rib-snapshot [json]$uj",
+       SHOW_STR
+       BGP_STR
+       "BGP RIB snapshot status\n"
+       JSON_STR)
+{
+	json_object *json = NULL;
+
+	if (uj)
+		json = json_object_new_object();
+
+	bgp_snapshot_show(vty, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_bgp_keepalive_stats,
+       show_bgp_keepalive_stats_cmd,
+       "show bgp keepalive-statistics [json]$uj",
+       SHOW_STR
+       BGP_STR
+       "BGP keepalive lateness and jitter per peer-group\n"
+       JSON_STR)
+{
+	json_object *json = NULL;
+
+	if (uj)
+		json = json_object_new_object();
+
+	bgp_keepalives_show(vty, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_bgp_soft_reconfig_progress,
+       show_bgp_soft_reconfig_progress_cmd,
+       "show bgp soft-reconfig progress [json]$uj",
+       SHOW_STR
+       BGP_STR
+       "Inbound soft reconfiguration\n"
+       "Progress of the running inbound soft reconfigurations\n"
+       JSON_STR)
+{
+	json_object *json = NULL;
+
+	if (uj)
+		json = json_object_new_object();
+
+	bgp_soft_reconfig_progress_show(vty, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
 
 /* Initialization of BGP interface. */
 static void bgp_vty_if_init(void)
@@ -18986,6 +19700,26 @@ void bgp_vty_init(void)
 	install_element(CONFIG_NODE, &no_bgp_inq_limit_cmd);
 	install_element(CONFIG_NODE, &bgp_outq_limit_cmd);
 	install_element(CONFIG_NODE, &no_bgp_outq_limit_cmd);
+	install_element(CONFIG_NODE, &bgp_process_batch_cmd);
+	install_element(CONFIG_NODE, &no_bgp_process_batch_cmd);
+
+	/* "bgp parse-workers" commands */
+	install_element(CONFIG_NODE, &bgp_parse_workers_cmd);
+	install_element(CONFIG_NODE, &no_bgp_parse_workers_cmd);
+	install_element(VIEW_NODE, &show_bgp_parse_workers_cmd);
+
+	/* "bgp update-workers" commands */
+	install_element(CONFIG_NODE, &bgp_update_workers_cmd);
+	install_element(CONFIG_NODE, &no_bgp_update_workers_cmd);
+	install_element(VIEW_NODE, &show_bgp_update_workers_cmd);
+	install_element(CONFIG_NODE, &bgp_rib_snapshot_cmd);
+	install_element(CONFIG_NODE, &no_bgp_rib_snapshot_cmd);
+	install_element(VIEW_NODE, &show_bgp_rib_snapshot_cmd);
+	install_element(VIEW_NODE, &show_bgp_keepalive_stats_cmd);
+	install_element(VIEW_NODE, &show_ip_bgp_neighbor_statistics_cmd);
+	install_element(CONFIG_NODE, &bgp_node_pool_cmd);
+	install_element(VIEW_NODE, &show_bgp_node_pool_cmd);
+	install_element(VIEW_NODE, &show_bgp_soft_reconfig_progress_cmd);
 
 	/* "bgp local-mac" hidden commands. */
 	install_element(CONFIG_NODE, &bgp_local_mac_cmd);
@@ -19082,6 +19816,8 @@ void bgp_vty_init(void)
 
 	install_element(BGP_NODE, &bgp_coalesce_time_cmd);
 	install_element(BGP_NODE, &no_bgp_coalesce_time_cmd);
+	install_element(BGP_NODE, &bgp_table_replay_cmd);
+	install_element(BGP_NODE, &no_bgp_table_replay_cmd);
 
 	/* "maximum-paths" commands. */
 	install_element(BGP_NODE, &bgp_maxpaths_hidden_cmd);
@@ -19205,6 +19941,9 @@ void bgp_vty_init(void)
 
 	/* "bgp bestpath aigp" commands */
 	install_element(BGP_NODE, &bgp_bestpath_aigp_cmd);
+	install_element(BGP_NODE, &bgp_nht_incremental_cmd);
+	install_element(BGP_NODE, &bgp_nhg_per_nexthop_cmd);
+	install_element(BGP_NODE, &bgp_rs_shared_views_cmd);
 
 	/* "bgp bestpath compare-routerid" commands */
 	install_element(BGP_NODE, &bgp_bestpath_compare_router_id_cmd);
@@ -1284,6 +1284,38 @@ static bool bgp_zebra_use_nhop_weighted(struct bgp *bgp, struct attr *attr,
 	return true;
 }
 
+/*
+ * Routes from the same remote VRF share SID and label, so they tend to come
+ * in runs with the same transposition.  Remember the last one.
+ */
+static struct bgp_zebra_sid_cache {
+	struct in6_addr sid;
+	uint32_t label;
+	uint8_t offset;
+	uint8_t len;
+	struct in6_addr transposed;
+} bgp_zebra_sid_cache;
+
+static void bgp_zebra_transpose_sid(struct in6_addr *sid, uint32_t label,
+				    uint8_t offset, uint8_t len)
+{
+	struct bgp_zebra_sid_cache *cache = &bgp_zebra_sid_cache;
+
+	/* label 0 is never transposed, so the initial state doesn't match */
+	if (cache->label == label && cache->offset == offset &&
+	    cache->len == len && sid_same(&cache->sid, sid)) {
+		*sid = cache->transposed;
+		return;
+	}
+
+	cache->sid = *sid;
+	cache->label = label;
+	cache->offset = offset;
+	cache->len = len;
+	transpose_sid(sid, label, offset, len);
+	cache->transposed = *sid;
+}
+
 void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 			struct bgp_path_info *info, struct bgp *bgp, afi_t afi,
 			safi_t safi)
@@ -1342,7 +1374,8 @@ void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 	/*
 	 * vrf leaking support (will have only one nexthop)
 	 */
-	if (info->extra && info->extra->bgp_orig)
+	if (info->extra && info->extra->vrfleak &&
+	    info->extra->vrfleak->bgp_orig)
 		nh_othervrf = 1;
 
 	/* Make Zebra API structure. */
@@ -1358,8 +1391,10 @@ void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 	    && info->sub_type == BGP_ROUTE_IMPORTED) {
 
 		/* Obtain peer from parent */
-		if (info->extra && info->extra->parent)
-			peer = ((struct bgp_path_info *)(info->extra->parent))
+		if (info->extra && info->extra->vrfleak &&
+		    info->extra->vrfleak->parent)
+			peer = ((struct bgp_path_info *)info->extra->vrfleak
+					->parent)
 				       ->peer;
 	}
 
@@ -1399,6 +1434,11 @@ void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 		api.nhgid = nhg_id;
 		if (nhg_id)
 			SET_FLAG(api.message, ZAPI_MESSAGE_NHG);
+	} else if (bgp_nht_path_use_nhg(bgp, info, afi, safi, &nhg_id)) {
+		/* single path resolving over a shared per-nexthop NHG */
+		mpinfo = NULL;
+		api.nhgid = nhg_id;
+		SET_FLAG(api.message, ZAPI_MESSAGE_NHG);
 	} else {
 		mpinfo = info;
 	}
@@ -1566,9 +1606,10 @@ void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 					continue;
 				}
 
-				transpose_sid(&api_nh->seg6_segs, nh_label,
-					      sid_info->transposition_offset,
-					      sid_info->transposition_len);
+				bgp_zebra_transpose_sid(
+					&api_nh->seg6_segs, nh_label,
+					sid_info->transposition_offset,
+					sid_info->transposition_len);
 			}
 
 			SET_FLAG(api_nh->flags, ZAPI_NEXTHOP_FLAG_SEG6);
@@ -1589,13 +1630,17 @@ void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 
 		if (info->attr->flag & ATTR_FLAG_BIT(BGP_ATTR_COMMUNITIES))
 			strlcpy(bzo.community,
-				bgp_attr_get_community(info->attr)->str,
+				community_str(bgp_attr_get_community(
+						      info->attr),
+					      false, true),
 				sizeof(bzo.community));
 
 		if (info->attr->flag
 		    & ATTR_FLAG_BIT(BGP_ATTR_LARGE_COMMUNITIES))
 			strlcpy(bzo.lcommunity,
-				bgp_attr_get_lcommunity(info->attr)->str,
+				lcommunity_str(bgp_attr_get_lcommunity(
+						       info->attr),
+					       false, true),
 				sizeof(bzo.lcommunity));
 
 		strlcpy(bzo.selection_reason, reason,
@@ -1715,6 +1760,19 @@ void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 			   zclient, &api);
 }
 
+/* Route updates in between go out to zebra in as few writes as possible */
+void bgp_zebra_batch_begin(void)
+{
+	if (zclient)
+		zclient_batch_begin(zclient);
+}
+
+void bgp_zebra_batch_end(void)
+{
+	if (zclient)
+		(void)zclient_batch_end(zclient);
+}
+
 /* Announce all routes of a table to zebra */
 void bgp_zebra_announce_table(struct bgp *bgp, afi_t afi, safi_t safi)
 {
@@ -2422,14 +2480,14 @@ static int rule_notify_owner(ZAPI_CALLBACK_ARGS)
 			bgp_pbra->install_in_progress = false;
 		} else {
 			struct bgp_path_info *path;
-			struct bgp_path_info_extra *extra;
+			struct bgp_path_info_extra_fs *extra;
 
 			bgp_pbr->installed = true;
 			bgp_pbr->install_in_progress = false;
 			bgp_pbr->action->refcnt++;
 			/* link bgp_info to bgp_pbr */
 			path = (struct bgp_path_info *)bgp_pbr->path;
-			extra = bgp_path_info_extra_get(path);
+			extra = bgp_path_info_flowspec_get(path);
 			listnode_add_force(&extra->bgp_fs_iprule,
 					   bgp_pbr);
 		}
@@ -2523,7 +2581,7 @@ static int ipset_entry_notify_owner(ZAPI_CALLBACK_ARGS)
 	case ZAPI_IPSET_ENTRY_INSTALLED:
 		{
 		struct bgp_path_info *path;
-		struct bgp_path_info_extra *extra;
+		struct bgp_path_info_extra_fs *extra;
 
 		bgp_pbime->installed = true;
 		bgp_pbime->install_in_progress = false;
@@ -2532,7 +2590,7 @@ static int ipset_entry_notify_owner(ZAPI_CALLBACK_ARGS)
 				   __func__);
 		/* link bgp_path_info to bpme */
 		path = (struct bgp_path_info *)bgp_pbime->path;
-		extra = bgp_path_info_extra_get(path);
+		extra = bgp_path_info_flowspec_get(path);
 		listnode_add_force(&extra->bgp_fs_pbr, bgp_pbime);
 		}
 		break;
@@ -2854,6 +2912,9 @@ static void bgp_zebra_connected(struct zclient *zclient)
 
 	bgp_zebra_instance_register(bgp);
 
+	/* zebra lost any nexthop groups we installed before */
+	bgp_nht_nhg_zebra_connected();
+
 	/* tell label pool that zebra is connected */
 	bgp_lp_event_zebra_up();
 
@@ -3306,10 +3367,8 @@ static int bgp_zebra_process_srv6_locator_delete(ZAPI_CALLBACK_ARGS)
 		tmp_prefi.prefixlen = 128;
 		tmp_prefi.prefix = func->sid;
 		if (prefix_match((struct prefix *)&loc.prefix,
-				 (struct prefix *)&tmp_prefi)) {
-			listnode_delete(bgp->srv6_functions, func);
-			XFREE(MTYPE_BGP_SRV6_FUNCTION, func);
-		}
+				 (struct prefix *)&tmp_prefi))
+			bgp_srv6_function_delete(bgp, func);
 	}
 
 	// refresh tovpn_sid
@@ -3464,15 +3523,79 @@ void bgp_if_init(void)
 	hook_register_prio(if_del, 0, bgp_if_delete_hook);
 }
 
+/*
+ * ipset entries derived from flowspec come in large numbers (one per NLRI
+ * and per port/protocol combination), so instead of one zapi message per
+ * entry they are collected and sent as few ZEBRA_IPSET_ENTRY_ADD/DELETE
+ * messages as possible, either when the event loop gets back to us or when
+ * the message is full.  Any other PBR message flushes the batch first, so
+ * zebra still sees everything in the order bgp_pbr.c sent it (e.g. entries
+ * are deleted before their ipset is destroyed).
+ */
+#define PBR_ENTRY_BATCH_SIZE                                                   \
+	(ZEBRA_MAX_PACKET_SIZ - ZEBRA_HEADER_SIZE - sizeof(uint32_t))
+/* unique, ipset name, two prefixes, ports and protocol */
+#define PBR_ENTRY_MAX_SIZE                                                     \
+	(4 + ZEBRA_IPSET_NAME_SIZE + 2 * (2 + IPV6_MAX_BYTELEN) + 8 + 1)
+
+static struct stream *pbr_entry_batch;
+static uint32_t pbr_entry_batch_count;
+static bool pbr_entry_batch_install;
+static struct event *pbr_entry_batch_thread;
+
+static void bgp_pbr_entry_batch_flush(void)
+{
+	struct stream *s;
+
+	EVENT_OFF(pbr_entry_batch_thread);
+
+	if (!pbr_entry_batch_count)
+		return;
+
+	if (BGP_DEBUG(zebra, ZEBRA))
+		zlog_debug("%s: %s %u ipset entries", __func__,
+			   pbr_entry_batch_install ? "add" : "delete",
+			   pbr_entry_batch_count);
+
+	s = zclient->obuf;
+	stream_reset(s);
+
+	zclient_create_header(s, pbr_entry_batch_install
+					 ? ZEBRA_IPSET_ENTRY_ADD
+					 : ZEBRA_IPSET_ENTRY_DELETE,
+			      VRF_DEFAULT);
+	stream_putl(s, pbr_entry_batch_count);
+	stream_put(s, STREAM_DATA(pbr_entry_batch),
+		   stream_get_endp(pbr_entry_batch));
+	stream_putw_at(s, 0, stream_get_endp(s));
+
+	stream_reset(pbr_entry_batch);
+	pbr_entry_batch_count = 0;
+
+	if (zclient_send_message(zclient) == ZCLIENT_SEND_FAILURE)
+		zlog_warn("%s: failed to send ipset entries to zebra",
+			  __func__);
+}
+
+static void bgp_pbr_entry_batch_timer(struct event *event)
+{
+	bgp_pbr_entry_batch_flush();
+}
+
 void bgp_zebra_init(struct event_loop *master, unsigned short instance)
 {
+	struct zclient_options opt = zclient_options_default;
+
+	/* route install results come in bulk with a full table */
+	opt.receive_notify_batch = true;
+
 	zclient_num_connects = 0;
 
 	if_zapi_callbacks(bgp_ifp_create, bgp_ifp_up,
 			  bgp_ifp_down, bgp_ifp_destroy);
 
 	/* Set default values. */
-	zclient = zclient_new(master, &zclient_options_default, bgp_handlers,
+	zclient = zclient_new(master, &opt, bgp_handlers,
 			      array_size(bgp_handlers));
 	zclient_init(zclient, ZEBRA_ROUTE_BGP, 0, &bgpd_privs);
 	zclient->zebra_connected = bgp_zebra_connected;
@@ -3481,6 +3604,10 @@ void bgp_zebra_init(struct event_loop *master, unsigned short instance)
 
 void bgp_zebra_destroy(void)
 {
+	EVENT_OFF(pbr_entry_batch_thread);
+	stream_free(pbr_entry_batch);
+	pbr_entry_batch = NULL;
+
 	if (zclient == NULL)
 		return;
 	zclient_stop(zclient);
@@ -3511,6 +3638,8 @@ void bgp_send_pbr_rule_action(struct bgp_pbr_action *pbra,
 			zlog_debug("%s: table %d fwmark %d %d", __func__,
 				   pbra->table_id, pbra->fwmark, install);
 	}
+	bgp_pbr_entry_batch_flush();
+
 	s = zclient->obuf;
 	stream_reset(s);
 
@@ -3541,6 +3670,8 @@ void bgp_send_pbr_ipset_match(struct bgp_pbr_match *pbrim, bool install)
 		zlog_debug("%s: name %s type %d %d, ID %u", __func__,
 			   pbrim->ipset_name, pbrim->type, install,
 			   pbrim->unique);
+	bgp_pbr_entry_batch_flush();
+
 	s = zclient->obuf;
 	stream_reset(s);
 
@@ -3561,28 +3692,34 @@ void bgp_send_pbr_ipset_match(struct bgp_pbr_match *pbrim, bool install)
 void bgp_send_pbr_ipset_entry_match(struct bgp_pbr_match_entry *pbrime,
 				    bool install)
 {
-	struct stream *s;
-
 	if (pbrime->install_in_progress)
 		return;
 	if (BGP_DEBUG(zebra, ZEBRA))
 		zlog_debug("%s: name %s %d %d, ID %u", __func__,
 			   pbrime->backpointer->ipset_name, pbrime->unique,
 			   install, pbrime->unique);
-	s = zclient->obuf;
-	stream_reset(s);
 
-	zclient_create_header(s,
-			      install ? ZEBRA_IPSET_ENTRY_ADD :
-			      ZEBRA_IPSET_ENTRY_DELETE,
-			      VRF_DEFAULT);
+	/* nothing would get through, same as a failed send */
+	if (zclient->sock < 0)
+		return;
 
-	stream_putl(s, 1); /* send one pbr action */
+	if (!pbr_entry_batch)
+		pbr_entry_batch = stream_new(PBR_ENTRY_BATCH_SIZE);
 
-	bgp_encode_pbr_ipset_entry_match(s, pbrime);
+	if (pbr_entry_batch_count &&
+	    (pbr_entry_batch_install != install ||
+	     STREAM_WRITEABLE(pbr_entry_batch) < PBR_ENTRY_MAX_SIZE))
+		bgp_pbr_entry_batch_flush();
 
-	stream_putw_at(s, 0, stream_get_endp(s));
-	if ((zclient_send_message(zclient) != ZCLIENT_SEND_FAILURE) && install)
+	pbr_entry_batch_install = install;
+	pbr_entry_batch_count++;
+	bgp_encode_pbr_ipset_entry_match(pbr_entry_batch, pbrime);
+
+	if (!pbr_entry_batch_thread)
+		event_add_event(bm->master, bgp_pbr_entry_batch_timer, NULL, 0,
+				&pbr_entry_batch_thread);
+
+	if (install)
 		pbrime->install_in_progress = true;
 }
 
@@ -3641,6 +3778,8 @@ void bgp_send_pbr_iptable(struct bgp_pbr_action *pba,
 		zlog_debug("%s: name %s type %d mark %d %d, ID %u", __func__,
 			   pbm->ipset_name, pbm->type, pba->fwmark, install,
 			   pbm->unique2);
+	bgp_pbr_entry_batch_flush();
+
 	s = zclient->obuf;
 	stream_reset(s);
 
@@ -10,9 +10,10 @@
 
 /* Macro to update bgp_original based on bpg_path_info */
 #define BGP_ORIGINAL_UPDATE(_bgp_orig, _mpinfo, _bgp)                          \
-	((_mpinfo->extra && _mpinfo->extra->bgp_orig                           \
-	  && _mpinfo->sub_type == BGP_ROUTE_IMPORTED)                          \
-		 ? (_bgp_orig = _mpinfo->extra->bgp_orig)                      \
+	((_mpinfo->extra && _mpinfo->extra->vrfleak &&                         \
+	  _mpinfo->extra->vrfleak->bgp_orig &&                                 \
+	  _mpinfo->sub_type == BGP_ROUTE_IMPORTED)                             \
+		 ? (_bgp_orig = _mpinfo->extra->vrfleak->bgp_orig)             \
 		 : (_bgp_orig = _bgp))
 
 /* Default weight for next hop, if doing weighted ECMP. */
@@ -31,6 +32,8 @@ extern void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 			       struct bgp_path_info *path, struct bgp *bgp,
 			       afi_t afi, safi_t safi);
 extern void bgp_zebra_announce_table(struct bgp *bgp, afi_t afi, safi_t safi);
+extern void bgp_zebra_batch_begin(void);
+extern void bgp_zebra_batch_end(void);
 extern void bgp_zebra_withdraw(const struct prefix *p,
 			       struct bgp_path_info *path, struct bgp *bgp,
 			       safi_t safi);
@@ -15,6 +15,8 @@
 #include "sockopt.h"
 #include "network.h"
 #include "memory.h"
+#include "mempressure.h"
+#include "metrics.h"
 #include "filter.h"
 #include "routemap.h"
 #include "log.h"
@@ -69,6 +71,8 @@
 #include "bgpd/bgp_evpn_vty.h"
 #include "bgpd/bgp_keepalives.h"
 #include "bgpd/bgp_io.h"
+#include "bgpd/bgp_parse.h"
+#include "bgpd/bgp_updgrp_workers.h"
 #include "bgpd/bgp_ecommunity.h"
 #include "bgpd/bgp_flowspec.h"
 #include "bgpd/bgp_labelpool.h"
@@ -77,6 +81,7 @@
 #include "bgpd/bgp_evpn_private.h"
 #include "bgpd/bgp_evpn_mh.h"
 #include "bgpd/bgp_mac.h"
+#include "bgpd/bgp_snapshot.h"
 #include "bgp_trace.h"
 
 DEFINE_MTYPE_STATIC(BGPD, PEER_TX_SHUTDOWN_MSG, "Peer shutdown message (TX)");
@@ -102,6 +107,7 @@ unsigned int bgp_suppress_fib_count;
 
 static void bgp_if_finish(struct bgp *bgp);
 static void peer_drop_dynamic_neighbor(struct peer *peer);
+static void peer_policy_change_cancel(struct peer *peer);
 
 extern struct zclient *zclient;
 
@@ -1182,8 +1188,12 @@ static void peer_free(struct peer *peer)
 	if (peer->bfd_config)
 		bgp_peer_remove_bfd_config(peer);
 
-	FOREACH_AFI_SAFI (afi, safi)
+	FOREACH_AFI_SAFI (afi, safi) {
 		bgp_addpath_set_peer_type(peer, afi, safi, BGP_ADDPATH_NONE);
+		/* every path and adj-in holds a peer reference */
+		bgp_peer_paths_fini(&peer->paths[afi][safi]);
+		bgp_peer_adj_in_fini(&peer->adj_in[afi][safi]);
+	}
 
 	if (peer->change_local_as_pretty)
 		XFREE(MTYPE_BGP, peer->change_local_as_pretty);
@@ -1339,20 +1349,57 @@ int bgp_peer_gr_init(struct peer *peer)
 	return BGP_GR_SUCCESS;
 }
 
+static unsigned int bgp_srv6_function_hash_key(const void *p)
+{
+	const struct bgp_srv6_function *func = p;
+
+	return jhash(&func->sid, sizeof(func->sid), 0);
+}
+
+static bool bgp_srv6_function_hash_cmp(const void *p1, const void *p2)
+{
+	const struct bgp_srv6_function *func1 = p1;
+	const struct bgp_srv6_function *func2 = p2;
+
+	return sid_same(&func1->sid, &func2->sid);
+}
+
+static void bgp_srv6_function_free(void *arg)
+{
+	XFREE(MTYPE_BGP_SRV6_FUNCTION, arg);
+}
+
+void bgp_srv6_function_delete(struct bgp *bgp, struct bgp_srv6_function *func)
+{
+	hash_release(bgp->srv6_function_hash, func);
+	listnode_delete(bgp->srv6_functions, func);
+	bgp_srv6_function_free(func);
+}
+
 static void bgp_srv6_init(struct bgp *bgp)
 {
 	bgp->srv6_enabled = false;
 	memset(bgp->srv6_locator_name, 0, sizeof(bgp->srv6_locator_name));
 	bgp->srv6_locator_chunks = list_new();
 	bgp->srv6_functions = list_new();
+	bgp->srv6_function_hash = hash_create(bgp_srv6_function_hash_key,
+					      bgp_srv6_function_hash_cmp,
+					      "BGP SRv6 functions");
 }
 
 static void bgp_srv6_cleanup(struct bgp *bgp)
 {
+	afi_t afi;
+
 	if (bgp->srv6_locator_chunks)
 		list_delete(&bgp->srv6_locator_chunks);
 	if (bgp->srv6_functions)
 		list_delete(&bgp->srv6_functions);
+	hash_clean_and_free(&bgp->srv6_function_hash, bgp_srv6_function_free);
+
+	bgp_attr_srv6_l3vpn_put(&bgp->tovpn_srv6_l3vpn);
+	for (afi = AFI_IP; afi < AFI_MAX; afi++)
+		bgp_attr_srv6_l3vpn_put(&bgp->vpn_policy[afi].tovpn_srv6_l3vpn);
 }
 
 /* Allocate new peer object, implicitely locked.  */
@@ -1399,6 +1446,8 @@ struct peer *peer_new(struct bgp *bgp)
 			 PEER_FLAG_SEND_LARGE_COMMUNITY);
 		peer->addpath_type[afi][safi] = BGP_ADDPATH_NONE;
 		peer->soo[afi][safi] = NULL;
+		bgp_peer_paths_init(&peer->paths[afi][safi]);
+		bgp_peer_adj_in_init(&peer->adj_in[afi][safi]);
 	}
 
 	/* set nexthop-unchanged for l2vpn evpn by default */
@@ -1413,6 +1462,8 @@ struct peer *peer_new(struct bgp *bgp)
 	/* Create buffers.  */
 	peer->ibuf = stream_fifo_new();
 	peer->obuf = stream_fifo_new();
+	peer->ibuf_parse = stream_fifo_new();
+	bgp_preparse_init(&peer->preparsed);
 	pthread_mutex_init(&peer->io_mtx, NULL);
 
 	/* We use a larger buffer for peer->obuf_work in the event that:
@@ -2514,6 +2565,7 @@ int peer_delete(struct peer *peer)
 	accept_peer = CHECK_FLAG(peer->sflags, PEER_STATUS_ACCEPT_PEER);
 
 	bgp_soft_reconfig_table_task_cancel(bgp, NULL, peer);
+	peer_policy_change_cancel(peer);
 
 	bgp_keepalives_off(peer);
 	bgp_reads_off(peer);
@@ -2605,6 +2657,13 @@ int peer_delete(struct peer *peer)
 		peer->obuf = NULL;
 	}
 
+	bgp_parse_clean(peer);
+	bgp_preparse_fini(&peer->preparsed);
+	if (peer->ibuf_parse) {
+		stream_fifo_free(peer->ibuf_parse);
+		peer->ibuf_parse = NULL;
+	}
+
 	if (peer->ibuf_work) {
 		ringbuf_del(peer->ibuf_work);
 		peer->ibuf_work = NULL;
@@ -3611,6 +3670,7 @@ int bgp_get(struct bgp **bgp_val, as_t *as, const char *name,
 	 */
 	bgp_handle_socket(bgp, vrf, VRF_UNKNOWN, true);
 	listnode_add(bm->bgp, bgp);
+	vpn_leak_import_rt_invalidate();
 
 	if (IS_BGP_INST_KNOWN_TO_ZEBRA(bgp)) {
 		if (BGP_DEBUG(zebra, ZEBRA))
@@ -3749,11 +3809,9 @@ int bgp_delete(struct bgp *bgp)
 
 	hook_call(bgp_inst_delete, bgp);
 
-	FOREACH_AFI_SAFI (afi, safi)
-		EVENT_OFF(bgp->t_revalidate[afi][safi]);
-
-	EVENT_OFF(bgp->t_condition_check);
+	bgp_conditional_adv_fini(bgp);
 	EVENT_OFF(bgp->t_startup);
+	EVENT_OFF(bgp->t_snapshot_stale);
 	EVENT_OFF(bgp->t_maxmed_onstartup);
 	EVENT_OFF(bgp->t_update_delay);
 	EVENT_OFF(bgp->t_establish_wait);
@@ -3896,6 +3954,7 @@ int bgp_delete(struct bgp *bgp)
 	 * routes to be processed still referencing the struct bgp.
 	 */
 	listnode_delete(bm->bgp, bgp);
+	vpn_leak_import_rt_invalidate();
 
 	/* Free interfaces in this instance. */
 	bgp_if_finish(bgp);
@@ -4465,6 +4524,7 @@ static const struct peer_flag_action peer_af_flag_action_list[] = {
 	{PEER_FLAG_REFLECTOR_CLIENT, 1, peer_change_reset},
 	{PEER_FLAG_RSERVER_CLIENT, 1, peer_change_reset},
 	{PEER_FLAG_SOFT_RECONFIG, 0, peer_change_reset_in},
+	{PEER_FLAG_SOFT_RECONFIG_DEDUP, 0, peer_change_none},
 	{PEER_FLAG_AS_PATH_UNCHANGED, 1, peer_change_reset_out},
 	{PEER_FLAG_NEXTHOP_UNCHANGED, 1, peer_change_reset_out},
 	{PEER_FLAG_MED_UNCHANGED, 1, peer_change_reset_out},
@@ -5677,14 +5737,20 @@ void peer_tcp_mss_unset(struct peer *peer)
 
 /*
  * Helper function that is called after the name of the policy
- * being used by a peer has changed (AF specific). Automatically
- * initiates inbound or outbound processing as needed.
+ * being used by a peer has changed (AF specific), once the change
+ * is acted on. Initiates inbound or outbound processing as needed.
  */
-void peer_on_policy_change(struct peer *peer, afi_t afi, safi_t safi,
-			   int outbound)
+static void peer_policy_change_apply(struct peer *peer, afi_t afi,
+				     safi_t safi, int outbound)
 {
 	if (outbound) {
-		update_group_adjust_peer(peer_af_find(peer, afi, safi));
+		struct peer_af *paf = peer_af_find(peer, afi, safi);
+
+		/* only the differences to its new subgroup had to be sent */
+		if (update_group_switch_peer(paf))
+			return;
+
+		update_group_adjust_peer(paf);
 		if (peer_established(peer))
 			bgp_announce_route(peer, afi, safi, false);
 	} else {
@@ -5701,6 +5767,93 @@ void peer_on_policy_change(struct peer *peer, afi_t afi, safi_t safi,
 	}
 }
 
+/*
+ * Policy changes are acted on from an event rather than immediately.  A
+ * peer-group change calls peer_on_policy_change() for each of the members,
+ * and loading a configuration usually changes several attributes of the
+ * same group in a row; with this every peer gets its update group adjusted
+ * and its routes re-announced or re-evaluated once for the whole batch.
+ */
+static struct list *peer_policy_changes;
+static struct event *t_peer_policy_change;
+
+static void peer_policy_change_run(struct event *event)
+{
+	struct peer *peer;
+	uint8_t pending;
+	afi_t afi;
+	safi_t safi;
+
+	while ((peer = listnode_head(peer_policy_changes))) {
+		list_delete_node(peer_policy_changes,
+				 listhead(peer_policy_changes));
+
+		FOREACH_AFI_SAFI (afi, safi) {
+			pending = peer->policy_change[afi][safi];
+			if (!pending)
+				continue;
+
+			peer->policy_change[afi][safi] = 0;
+			if (CHECK_FLAG(pending, PEER_POLICY_CHANGE_OUT))
+				peer_policy_change_apply(peer, afi, safi, 1);
+			if (CHECK_FLAG(pending, PEER_POLICY_CHANGE_IN))
+				peer_policy_change_apply(peer, afi, safi, 0);
+		}
+
+		peer_unlock(peer);
+	}
+
+	list_delete(&peer_policy_changes);
+}
+
+/* drop whatever is still pending for a peer that is going away */
+static void peer_policy_change_cancel(struct peer *peer)
+{
+	afi_t afi;
+	safi_t safi;
+	bool pending = false;
+
+	FOREACH_AFI_SAFI (afi, safi) {
+		if (peer->policy_change[afi][safi])
+			pending = true;
+		peer->policy_change[afi][safi] = 0;
+	}
+
+	if (pending && peer_policy_changes) {
+		listnode_delete(peer_policy_changes, peer);
+		peer_unlock(peer);
+
+		if (!listcount(peer_policy_changes)) {
+			list_delete(&peer_policy_changes);
+			EVENT_OFF(t_peer_policy_change);
+		}
+	}
+}
+
+void peer_on_policy_change(struct peer *peer, afi_t afi, safi_t safi,
+			   int outbound)
+{
+	bool queued = false;
+	afi_t a;
+	safi_t s;
+
+	FOREACH_AFI_SAFI (a, s)
+		if (peer->policy_change[a][s])
+			queued = true;
+
+	SET_FLAG(peer->policy_change[afi][safi],
+		 outbound ? PEER_POLICY_CHANGE_OUT : PEER_POLICY_CHANGE_IN);
+
+	if (!queued) {
+		if (!peer_policy_changes)
+			peer_policy_changes = list_new();
+		listnode_add(peer_policy_changes, peer_lock(peer));
+	}
+
+	event_add_event(bm->master, peer_policy_change_run, NULL, 0,
+			&t_peer_policy_change);
+}
+
 
 /* neighbor weight. */
 int peer_weight_set(struct peer *peer, afi_t afi, safi_t safi, uint16_t weight)
@@ -7859,6 +8012,8 @@ static void peer_reset_message_stats(struct peer *peer)
 				      memory_order_relaxed);
 		atomic_store_explicit(&peer->dynamic_cap_out, 0,
 				      memory_order_relaxed);
+		memset(&peer->cpu_parse, 0, sizeof(peer->cpu_parse));
+		memset(peer->cpu_stats, 0, sizeof(peer->cpu_stats));
 	}
 }
 
@@ -8038,6 +8193,8 @@ void bgp_master_init(struct event_loop *master, const int buffer_size,
 	bm->port = BGP_PORT_DEFAULT;
 	bm->addresses = addresses;
 	bm->master = master;
+	/* per-peer keepalive/hold/connect timers are restarted constantly */
+	event_master_set_timer_wheel(master, true);
 	bm->start_time = monotime(NULL);
 	bm->t_rmap_update = NULL;
 	bm->rmap_update_timer = RMAP_DEFAULT_UPDATE_TIMER;
@@ -8049,6 +8206,7 @@ void bgp_master_init(struct event_loop *master, const int buffer_size,
 	bm->tcp_dscp = IPTOS_PREC_INTERNETCONTROL;
 	bm->inq_limit = BM_DEFAULT_Q_LIMIT;
 	bm->outq_limit = BM_DEFAULT_Q_LIMIT;
+	bm->process_batch = BM_DEFAULT_PROCESS_BATCH;
 
 	bgp_mac_init();
 	/* init the rd id space.
@@ -8166,6 +8324,8 @@ void bgp_pthreads_run(void)
 
 void bgp_pthreads_finish(void)
 {
+	bgp_parse_finish();
+	bgp_update_workers_finish();
 	frr_pthread_stop_all();
 }
 
@@ -8193,15 +8353,115 @@ static int peer_unshut_after_cfg(struct bgp *bgp)
 	return 0;
 }
 
+/* Soft reconfiguration copies are dropped while under hard memory pressure
+ * (on every check, so peers that come up meanwhile are covered too) and
+ * refilled by route refresh on leaving it.  (Caches check
+ * mempressure_level() themselves before growing; the multipath aggregate
+ * cache is also emptied as soon as there is any pressure.)
+ */
+static int bgp_memory_pressure(enum mempressure_level level,
+			       enum mempressure_level prev)
+{
+	struct listnode *node, *pnode;
+	struct bgp *bgp;
+	struct peer *peer;
+	unsigned int count = 0;
+	afi_t afi;
+	safi_t safi;
+
+	if (level != MEMPRESSURE_NONE && prev == MEMPRESSURE_NONE)
+		bgp_mpath_aggr_cache_flush();
+
+	if (level != MEMPRESSURE_HARD && prev != MEMPRESSURE_HARD)
+		return 0;
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, pnode, peer)) {
+			FOREACH_AFI_SAFI (afi, safi) {
+				if (level != MEMPRESSURE_HARD)
+					bgp_adj_in_unshed(peer, afi, safi);
+				else if (bgp_adj_in_shed(peer, afi, safi))
+					count++;
+			}
+		}
+	}
+
+	if (count)
+		zlog_warn("memory pressure: dropped Adj-RIB-In of %u soft-reconfiguration peer AFI/SAFIs, using route refresh instead",
+			  count);
+	return 0;
+}
+
+/* how often the peer table is rendered for the metrics exporter */
+#define BGP_METRICS_INTERVAL_MS 1000
+
+static struct metrics_collector *bgp_metrics;
+
+static void bgp_metrics_collect(struct metrics_out *out, void *arg)
+{
+	struct listnode *mnode, *node;
+	struct bgp *bgp;
+	struct peer *peer;
+	afi_t afi;
+	safi_t safi;
+
+	metrics_family(out, "frr_bgp_peer_state", METRICS_GAUGE,
+		       "FSM state of the peer, 1 (Idle) to 6 (Established)");
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, mnode, bgp))
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer))
+			metrics_sample(out, "frr_bgp_peer_state", peer->status,
+				       "vrf", bgp->name_pretty, "peer",
+				       peer->host, NULL);
+
+	metrics_family(out, "frr_bgp_peer_prefixes_received", METRICS_GAUGE,
+		       "Prefixes accepted from the peer");
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, mnode, bgp))
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer))
+			FOREACH_AFI_SAFI (afi, safi) {
+				if (!peer->afc_nego[afi][safi])
+					continue;
+				metrics_sample(out,
+					       "frr_bgp_peer_prefixes_received",
+					       peer->pcount[afi][safi], "vrf",
+					       bgp->name_pretty, "peer",
+					       peer->host, "afi_safi",
+					       get_afi_safi_str(afi, safi,
+								true),
+					       NULL);
+			}
+
+	metrics_family(out, "frr_bgp_peer_outq_depth", METRICS_GAUGE,
+		       "Packets queued for sending to the peer");
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, mnode, bgp))
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer))
+			metrics_sample(out, "frr_bgp_peer_outq_depth",
+				       stream_fifo_count_safe(peer->obuf),
+				       "vrf", bgp->name_pretty, "peer",
+				       peer->host, NULL);
+
+	metrics_family(out, "frr_bgp_process_queue_depth", METRICS_GAUGE,
+		       "Batches waiting for best path selection");
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, mnode, bgp)) {
+		struct work_queue *wq = bgp->process_queue;
+
+		metrics_sample(out, "frr_bgp_process_queue_depth",
+			       wq ? work_queue_item_count(wq) : 0, "vrf",
+			       bgp->name_pretty, NULL);
+	}
+}
+
 void bgp_init(unsigned short instance)
 {
 	hook_register(bgp_config_end, peer_unshut_after_cfg);
+	hook_register(memory_pressure, bgp_memory_pressure);
 
 	/* allocates some vital data structures used by peer commands in
 	 * vty_init */
 
 	/* pre-init pthreads */
 	bgp_pthreads_init();
+	bgp_parse_init();
+	bgp_update_workers_init();
 
 	/* Init zebra. */
 	bgp_zebra_init(bm->master, instance);
@@ -8252,6 +8512,10 @@ void bgp_init(unsigned short instance)
 	bgp_lp_vty_init();
 
 	cmd_variable_handler_register(bgp_viewvrf_var_handlers);
+
+	bgp_metrics = metrics_snapshot_add("bgp", bm->master,
+					   BGP_METRICS_INTERVAL_MS,
+					   bgp_metrics_collect, NULL);
 }
 
 void bgp_terminate(void)
@@ -8263,6 +8527,9 @@ void bgp_terminate(void)
 
 	QOBJ_UNREG(bm);
 
+	/* while the RIB is still complete */
+	bgp_snapshot_finish();
+
 	/* Close the listener sockets first as this prevents peers from
 	 * attempting
 	 * to reconnect on receiving the peer unconfig message. In the presence
@@ -8293,6 +8560,9 @@ void bgp_terminate(void)
 
 	EVENT_OFF(bm->t_rmap_update);
 
+	metrics_collector_del(bgp_metrics);
+	bgp_metrics = NULL;
+
 	bgp_mac_finish();
 }
 
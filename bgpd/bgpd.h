@@ -31,6 +31,7 @@
 #include "bgp_addpath_types.h"
 #include "bgp_nexthop.h"
 #include "bgp_io.h"
+#include "bgp_advertise.h"
 
 #include "lib/bfd.h"
 
@@ -92,6 +93,10 @@ enum bgp_af_index {
 extern struct frr_pthread *bgp_pth_io;
 extern struct frr_pthread *bgp_pth_ka;
 
+PREDECL_LIST(bgp_preparse);
+PREDECL_DLIST(bgp_io_wakeup);
+PREDECL_DLIST(bgp_peer_paths);
+
 /* BGP master for system wide configurations and variables.  */
 struct bgp_master {
 	/* BGP instance list.  */
@@ -165,6 +170,13 @@ struct bgp_master {
 	uint32_t inq_limit;
 	uint32_t outq_limit;
 
+	/* Max number of dests handled per route processing work queue item */
+#define BM_DEFAULT_PROCESS_BATCH 10000
+	uint32_t process_batch;
+
+	/* afi/safi combinations whose tables allocate nodes from pools */
+	bool table_pool[AFI_MAX][SAFI_MAX];
+
 	QOBJ_FIELDS;
 };
 DECLARE_QOBJ_TYPE(bgp_master);
@@ -232,6 +244,8 @@ struct vpn_policy {
 	struct srv6_locator_chunk *tovpn_sid_locator;
 	uint32_t tovpn_sid_transpose_label;
 	struct in6_addr *tovpn_zebra_vrf_sid_last_sent;
+	/* interned service TLV handed to the leaked routes */
+	struct bgp_attr_srv6_l3vpn *tovpn_srv6_l3vpn;
 };
 
 /*
@@ -382,6 +396,10 @@ struct bgp {
 		uint32_t updgrps_deleted;
 		uint32_t subgrps_created;
 		uint32_t subgrps_deleted;
+
+		/* pre-encoded attribute cache, see subgroup_update_packet() */
+		uint64_t attr_enc_hits;
+		uint64_t attr_enc_misses;
 	} update_group_stats;
 
 	struct bgp_snmp_stats *snmp_stats;
@@ -409,6 +427,9 @@ struct bgp {
 	/* start-up timer on only once at the beginning */
 	struct event *t_startup;
 
+	/* drops snapshot paths the peers didn't send again, bgp_snapshot.c */
+	struct event *t_snapshot_stale;
+
 	uint32_t v_maxmed_onstartup; /* Duration of max-med on start-up */
 #define BGP_MAXMED_ONSTARTUP_UNCONFIGURED  0 /* 0 means off, its the default */
 	uint32_t maxmed_onstartup_value;     /* Max-med value when active on
@@ -431,7 +452,6 @@ struct bgp {
 	/* BGP update delay on startup */
 	struct event *t_update_delay;
 	struct event *t_establish_wait;
-	struct event *t_revalidate[AFI_MAX][SAFI_MAX];
 
 	uint8_t update_delay_over;
 	uint8_t main_zebra_update_hold;
@@ -500,6 +520,12 @@ struct bgp {
 #define BGP_FLAG_HARD_ADMIN_RESET (1ULL << 31)
 /* Evaluate the AIGP attribute during the best path selection process */
 #define BGP_FLAG_COMPARE_AIGP (1ULL << 32)
+/* Skip route processing for nexthop updates that cannot change selection */
+#define BGP_FLAG_NHT_INCREMENTAL (1ULL << 33)
+/* Install single-path unicast routes via shared per-nexthop zebra NHGs */
+#define BGP_FLAG_NHG_PER_NEXTHOP (1ULL << 34)
+/* Group route-server clients by outbound route-map contents, not its name */
+#define BGP_FLAG_RS_SHARED_VIEWS (1ULL << 35)
 
 	/* BGP default address-families.
 	 * New peers inherit enabled afi/safis from bgp instance.
@@ -641,6 +667,12 @@ struct bgp {
 	/* Actual coalesce time */
 	uint32_t coalesce_time;
 
+	/* Announce tables to subgroups this many nodes per event, pausing
+	 * replay_delay ms in between; 0 walks the whole table at once.
+	 */
+	uint32_t replay_batch;
+	uint32_t replay_delay;
+
 	/* Auto-shutdown new peers */
 	bool autoshutdown;
 
@@ -729,6 +761,11 @@ struct bgp {
 #define BGP_VRF_L3VNI_PREFIX_ROUTES_ONLY    (1 << 6)
 /* per-VRF toVPN SID */
 #define BGP_VRF_TOVPN_SID_AUTO              (1 << 7)
+/* queued for the batched import of existing EVPN routes */
+#define BGP_VRF_EVPN_IMPORT_PENDING         (1 << 8)
+
+	/* batched EVPN import pass that last visited this VRF */
+	uint32_t evpn_import_gen;
 
 	/* unique ID for auto derivation of RD for this vrf */
 	uint16_t vrf_rd_id;
@@ -754,6 +791,9 @@ struct bgp {
 
 	struct vpn_policy vpn_policy[AFI_MAX];
 
+	/* VPN to VRF leak pass that last visited this instance */
+	uint32_t vpn_import_gen;
+
 	struct bgp_pbr_config *bgp_pbr_cfg;
 
 	/* Count of peers in established state */
@@ -771,16 +811,20 @@ struct bgp {
 	uint32_t condition_check_period;
 	uint32_t condition_filter_count;
 	struct event *t_condition_check;
+	/* condition maps in use, see bgp_conditional_adv.c */
+	struct list *condadv_conds;
 
 	/* BGP VPN SRv6 backend */
 	bool srv6_enabled;
 	char srv6_locator_name[SRV6_LOCNAME_SIZE];
 	struct list *srv6_locator_chunks;
 	struct list *srv6_functions;
+	struct hash *srv6_function_hash; /* same functions, by SID */
 	uint32_t tovpn_sid_index; /* unset => set to 0 */
 	struct in6_addr *tovpn_sid;
 	struct srv6_locator_chunk *tovpn_sid_locator;
 	uint32_t tovpn_sid_transpose_label;
+	struct bgp_attr_srv6_l3vpn *tovpn_srv6_l3vpn;
 	struct in6_addr *tovpn_zebra_vrf_sid_last_sent;
 
 	/* TCP keepalive parameters for BGP connection */
@@ -1096,6 +1140,41 @@ struct llgr_info {
 	uint8_t flags;
 };
 
+/* log2(msec) buckets for the keepalive lateness and jitter histograms */
+#define BGP_KA_HIST_BUCKETS 16
+
+/*
+ * Main pthread time spent on behalf of a peer, broken down by where it went.
+ * Parsing is accounted per UPDATE, the rest per AFI/SAFI of the routes.
+ */
+enum bgp_cpu_stage {
+	BGP_CPU_NLRI,	    /* NLRI processing, includes inbound policy */
+	BGP_CPU_POLICY_IN,  /* inbound filters and route-maps */
+	BGP_CPU_BESTPATH,   /* best path selection, charged to the winner */
+	BGP_CPU_UPDATE_OUT, /* generating and formatting UPDATEs to the peer */
+	BGP_CPU_STAGE_MAX,
+};
+
+struct bgp_cpu_stat {
+	uint64_t count;
+	uint64_t nsec;
+};
+
+/* CLOCK_MONOTONIC goes through the vDSO, cheap enough to call per prefix */
+static inline uint64_t bgp_cpu_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline void bgp_cpu_account(struct bgp_cpu_stat *stat, uint64_t start)
+{
+	stat->count++;
+	stat->nsec += bgp_cpu_now() - start;
+}
+
 /* BGP neighbor structure. */
 struct peer {
 	/* BGP structure.  */
@@ -1142,9 +1221,12 @@ struct peer {
 	struct stream_fifo *ibuf; // packets waiting to be processed
 	struct stream_fifo *obuf; // packets waiting to be written
 
-	/* used as a block to deposit raw wire data to */
-	uint8_t ibuf_scratch[BGP_EXTENDED_MESSAGE_MAX_PACKET_SIZE
-			     * BGP_READ_PACKET_MAX];
+	/* packets waiting for a parse worker, and the worker results for
+	 * UPDATEs on ibuf (see bgp_parse.c); both guarded by io_mtx
+	 */
+	struct stream_fifo *ibuf_parse;
+	struct bgp_preparse_head preparsed;
+
 	struct ringbuf *ibuf_work; // WiP buffer used by bgp_read() only
 	struct stream *obuf_work;  // WiP buffer used to construct packets
 
@@ -1405,6 +1487,10 @@ struct peer {
 
 	/* NSF mode (graceful restart) */
 	uint8_t nsf[AFI_MAX][SAFI_MAX];
+	/* Stale paths restored from a RIB snapshot, see bgp_snapshot.c.  Not
+	 * in af_sflags, this has to survive bgp_stop() on failed connects.
+	 */
+	bool snapshot_stale[AFI_MAX][SAFI_MAX];
 	/* EOR Send time */
 	time_t eor_stime[AFI_MAX][SAFI_MAX];
 	/* Last update packet sent time */
@@ -1449,6 +1535,7 @@ struct peer {
 #define PEER_FLAG_MAX_PREFIX_FORCE (1ULL << 26)
 #define PEER_FLAG_DISABLE_ADDPATH_RX (1ULL << 27)
 #define PEER_FLAG_SOO (1ULL << 28)
+#define PEER_FLAG_SOFT_RECONFIG_DEDUP (1ULL << 29)
 #define PEER_FLAG_ACCEPT_OWN (1ULL << 63)
 
 	enum bgp_addpath_strat addpath_type[AFI_MAX][SAFI_MAX];
@@ -1491,6 +1578,8 @@ struct peer {
 #define PEER_STATUS_LLGR_WAIT (1U << 11)
 #define PEER_STATUS_REFRESH_PENDING (1U << 12) /* refresh request from peer */
 #define PEER_STATUS_RTT_SHUTDOWN (1U << 13) /* In shutdown state due to RTT */
+/* Adj-RIB-In dropped under memory pressure, see bgp_adj_in_shed() */
+#define PEER_STATUS_ADJ_IN_SHED (1U << 14)
 
 	/* Configured timer values. */
 	_Atomic uint32_t holdtime;
@@ -1524,9 +1613,16 @@ struct peer {
 	struct event *t_gr_stale;
 	struct event *t_llgr_stale[AFI_MAX][SAFI_MAX];
 	struct event *t_revalidate_all[AFI_MAX][SAFI_MAX];
+	/* policy changes not yet acted on, see peer_on_policy_change() */
+	uint8_t policy_change[AFI_MAX][SAFI_MAX];
+#define PEER_POLICY_CHANGE_IN (1 << 0)
+#define PEER_POLICY_CHANGE_OUT (1 << 1)
 	struct event *t_generate_updgrp_packets;
 	struct event *t_process_packet;
 	struct event *t_process_packet_error;
+	/* waiting for bgp_io_deliver(), see bgp_io.c */
+	struct bgp_io_wakeup_item io_wakeup_itm;
+	struct event *t_parse;
 	struct event *t_refresh_stalepath;
 
 	/* Thread flags. */
@@ -1578,6 +1674,32 @@ struct peer {
 	_Atomic uint32_t dynamic_cap_in;  /* Dynamic Capability input count.  */
 	_Atomic uint32_t dynamic_cap_out; /* Dynamic Capability output count. */
 
+	/* I/O pthread read statistics */
+	_Atomic uint64_t io_reads;     /* reads returning data */
+	_Atomic uint64_t io_read_pkts; /* packets split off the read data */
+	_Atomic uint64_t io_wakeups;   /* handoffs to the main pthread */
+
+	/* I/O pthread write scheduling, only updated under io_mtx.
+	 * obuf_busy is when a packet was queued to the empty output queue,
+	 * zero while it is empty; the outq_busy_* counters accumulate how
+	 * long it took to drain it again.
+	 */
+	int32_t write_deficit;
+	struct timeval obuf_busy;
+	uint64_t outq_busy_count;
+	uint64_t outq_busy_usec;
+	uint64_t outq_busy_max_usec;
+
+	/* keepalive pthread: how late keepalives went out, and how far the
+	 * interval between them was off the keepalive timer
+	 */
+	_Atomic uint32_t ka_late_hist[BGP_KA_HIST_BUCKETS];
+	_Atomic uint32_t ka_jitter_hist[BGP_KA_HIST_BUCKETS];
+
+	/* main pthread time, only touched from there */
+	struct bgp_cpu_stat cpu_parse;
+	struct bgp_cpu_stat cpu_stats[AFI_MAX][SAFI_MAX][BGP_CPU_STAGE_MAX];
+
 	uint32_t stat_pfx_filter;
 	uint32_t stat_pfx_aspath_loop;
 	uint32_t stat_pfx_originator_loop;
@@ -1650,6 +1772,23 @@ struct peer {
 	/* Accepted prefix count */
 	uint32_t pcount[AFI_MAX][SAFI_MAX];
 
+	/* Adj-RIB-In entries denied on input, only known with soft
+	 * reconfiguration inbound
+	 */
+	uint32_t filtered_pcount[AFI_MAX][SAFI_MAX];
+
+	/* Paths and Adj-RIB-In entries from this peer in bgp->rib, so
+	 * that clearing the peer and graceful restart don't have to walk
+	 * the whole table
+	 */
+	struct bgp_peer_paths_head paths[AFI_MAX][SAFI_MAX];
+	struct bgp_peer_adj_in_head adj_in[AFI_MAX][SAFI_MAX];
+
+	/* Adj-RIB-In entries left out since the path has the same attr,
+	 * see BGP_PATH_ADJ_IN_SHARED
+	 */
+	uint32_t adj_in_shared[AFI_MAX][SAFI_MAX];
+
 	/* Max prefix count. */
 	uint32_t pmax[AFI_MAX][SAFI_MAX];
 	uint8_t pmax_threshold[AFI_MAX][SAFI_MAX];
@@ -1761,7 +1900,6 @@ struct peer {
 
 	/* Conditional advertisement */
 	bool advmap_config_change[AFI_MAX][SAFI_MAX];
-	bool advmap_table_change;
 
 	/* set TCP max segment size */
 	uint32_t tcp_mss;
@@ -2163,6 +2301,7 @@ extern void bgp_init(unsigned short instance);
 extern void bgp_pthreads_run(void);
 extern void bgp_pthreads_finish(void);
 extern void bgp_route_map_init(void);
+extern bool bgp_route_map_uses_igp_metric(void);
 extern void bgp_session_reset(struct peer *);
 
 extern int bgp_option_set(int);
@@ -2387,6 +2526,8 @@ extern void bgp_shutdown_disable(struct bgp *bgp);
 
 extern void bgp_close(void);
 extern void bgp_free(struct bgp *);
+extern void bgp_srv6_function_delete(struct bgp *bgp,
+				     struct bgp_srv6_function *func);
 void bgp_gr_apply_running_config(void);
 
 /* BGP GR */
@@ -51,6 +51,8 @@ struct eigrp_neighbor *eigrp_nbr_new(struct eigrp_interface *ei)
 	/* Relate neighbor to the interface. */
 	nbr->ei = ei;
 
+	eigrp_nbr_routes_init(&nbr->routes);
+
 	/* Set default values. */
 	eigrp_nbr_state_set(nbr, EIGRP_NEIGHBOR_DOWN);
 
@@ -159,6 +161,8 @@ struct eigrp_neighbor *eigrp_nbr_lookup_by_addr_process(struct eigrp *eigrp,
 /* Delete specified EIGRP neighbor from interface. */
 void eigrp_nbr_delete(struct eigrp_neighbor *nbr)
 {
+	struct eigrp_route_descriptor *entry;
+
 	eigrp_nbr_state_set(nbr, EIGRP_NEIGHBOR_DOWN);
 	if (nbr->ei)
 		eigrp_topology_neighbor_down(nbr->ei->eigrp, nbr);
@@ -168,6 +172,13 @@ void eigrp_nbr_delete(struct eigrp_neighbor *nbr)
 	eigrp_fifo_free(nbr->multicast_queue);
 	eigrp_fifo_free(nbr->retrans_queue);
 	EVENT_OFF(nbr->t_holddown);
+	EVENT_OFF(nbr->t_reply);
+	eigrp_reply_pending_clear(nbr);
+
+	/* whatever the FSM did not remove is still active somewhere */
+	while ((entry = eigrp_nbr_routes_pop(&nbr->routes)))
+		entry->nbr_linked = false;
+	eigrp_nbr_routes_fini(&nbr->routes);
 
 	if (nbr->ei)
 		listnode_delete(nbr->ei->nbrs, nbr);
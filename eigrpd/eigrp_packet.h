@@ -105,6 +105,7 @@ extern uint32_t eigrp_query_send_all(struct eigrp *eigrp);
  */
 extern void eigrp_send_reply(struct eigrp_neighbor *nbr,
 			     struct eigrp_prefix_descriptor *pe);
+extern void eigrp_reply_pending_clear(struct eigrp_neighbor *nbr);
 extern void eigrp_reply_receive(struct eigrp *eigrp, struct ip *iph,
 				struct eigrp_header *eigrph, struct stream *s,
 				struct eigrp_interface *ei, int size);
@@ -45,46 +45,40 @@
 #include "eigrpd/eigrp_fsm.h"
 #include "eigrpd/eigrp_errors.h"
 
-void eigrp_send_reply(struct eigrp_neighbor *nbr,
-		      struct eigrp_prefix_descriptor *pe)
-{
-	struct eigrp_packet *ep;
-	uint16_t length = EIGRP_HEADER_LEN;
-	struct eigrp_interface *ei = nbr->ei;
-	struct eigrp *eigrp = ei->eigrp;
-	struct eigrp_prefix_descriptor *pe2;
-
-	// TODO: Work in progress
-	/* Filtering */
-	/* get list from eigrp process */
-	pe2 = XCALLOC(MTYPE_EIGRP_PREFIX_DESCRIPTOR,
-		      sizeof(struct eigrp_prefix_descriptor));
-	memcpy(pe2, pe, sizeof(struct eigrp_prefix_descriptor));
-
-	if (eigrp_update_prefix_apply(eigrp, ei, EIGRP_FILTER_OUT,
-				      pe2->destination)) {
-		zlog_info("REPLY SEND: Setting Metric to max");
-		pe2->reported_metric.delay = EIGRP_MAX_METRIC;
-	}
+DEFINE_MTYPE_STATIC(EIGRPD, EIGRP_PENDING_REPLY, "EIGRP pending reply");
 
-	/*
-	 * End of filtering
-	 */
+/*
+ * Replies are not sent one prefix per packet any more: they are collected
+ * per neighbor while the received packet (or neighbor loss) is processed and
+ * then packed into as few packets as the interface MTU allows.  A prefix
+ * queued twice is only replied to once, with the latest metric.
+ */
+struct eigrp_pending_reply {
+	struct eigrp_reply_pending_item item;
 
-	ep = eigrp_packet_new(EIGRP_PACKET_MTU(ei->ifp->mtu), nbr);
+	struct prefix destination;
+	struct eigrp_metrics reported_metric;
+};
 
-	/* Prepare EIGRP INIT UPDATE header */
-	eigrp_packet_header_init(EIGRP_OPC_REPLY, eigrp, ep->s, 0,
-				 eigrp->sequence_number, 0);
+static int eigrp_pending_reply_cmp(const struct eigrp_pending_reply *a,
+				   const struct eigrp_pending_reply *b)
+{
+	return prefix_cmp(&a->destination, &b->destination);
+}
 
-	// encode Authentication TLV, if needed
-	if (ei->params.auth_type == EIGRP_AUTH_TYPE_MD5
-	    && (ei->params.auth_keychain != NULL)) {
-		length += eigrp_add_authTLV_MD5_to_stream(ep->s, ei);
-	}
+static uint32_t eigrp_pending_reply_hash(const struct eigrp_pending_reply *pr)
+{
+	return prefix_hash_key(&pr->destination);
+}
 
+DECLARE_HASH(eigrp_reply_pending, struct eigrp_pending_reply, item,
+	     eigrp_pending_reply_cmp, eigrp_pending_reply_hash);
 
-	length += eigrp_add_internalTLV_to_stream(ep->s, pe2);
+static void eigrp_reply_packet_send(struct eigrp_neighbor *nbr,
+				    struct eigrp_packet *ep, uint16_t length)
+{
+	struct eigrp_interface *ei = nbr->ei;
+	struct eigrp *eigrp = ei->eigrp;
 
 	if ((ei->params.auth_type == EIGRP_AUTH_TYPE_MD5)
 	    && (ei->params.auth_keychain != NULL)) {
@@ -99,6 +93,7 @@ void eigrp_send_reply(struct eigrp_neighbor *nbr,
 
 	/*This ack number we await from neighbor*/
 	ep->sequence_number = eigrp->sequence_number;
+	eigrp->sequence_number++;
 
 	/*Put packet to retransmission queue*/
 	eigrp_fifo_push(nbr->retrans_queue, ep);
@@ -106,8 +101,91 @@ void eigrp_send_reply(struct eigrp_neighbor *nbr,
 	if (nbr->retrans_queue->count == 1) {
 		eigrp_send_packet_reliably(nbr);
 	}
+}
+
+static void eigrp_reply_send_pending(struct event *thread)
+{
+	struct eigrp_neighbor *nbr = EVENT_ARG(thread);
+	struct eigrp_interface *ei = nbr->ei;
+	struct eigrp *eigrp = ei->eigrp;
+	uint16_t eigrp_mtu = EIGRP_PACKET_MTU(ei->ifp->mtu);
+	struct eigrp_packet *ep = NULL;
+	struct eigrp_pending_reply *pr;
+	struct eigrp_prefix_descriptor pe = {};
+	uint16_t length = 0;
+
+	while ((pr = eigrp_reply_pending_pop(&nbr->reply_pending))) {
+		if (!ep) {
+			ep = eigrp_packet_new(eigrp_mtu, nbr);
+			length = EIGRP_HEADER_LEN;
+
+			eigrp_packet_header_init(EIGRP_OPC_REPLY, eigrp, ep->s,
+						 0, eigrp->sequence_number, 0);
+
+			// encode Authentication TLV, if needed
+			if (ei->params.auth_type == EIGRP_AUTH_TYPE_MD5
+			    && (ei->params.auth_keychain != NULL)) {
+				length += eigrp_add_authTLV_MD5_to_stream(ep->s,
+									  ei);
+			}
+		}
+
+		pe.destination = &pr->destination;
+		pe.reported_metric = pr->reported_metric;
+		length += eigrp_add_internalTLV_to_stream(ep->s, &pe);
+		XFREE(MTYPE_EIGRP_PENDING_REPLY, pr);
+
+		if (length + EIGRP_TLV_MAX_IPV4_BYTE > eigrp_mtu) {
+			eigrp_reply_packet_send(nbr, ep, length);
+			ep = NULL;
+		}
+	}
+
+	if (ep)
+		eigrp_reply_packet_send(nbr, ep, length);
+}
+
+void eigrp_send_reply(struct eigrp_neighbor *nbr,
+		      struct eigrp_prefix_descriptor *pe)
+{
+	struct eigrp_interface *ei = nbr->ei;
+	struct eigrp *eigrp = ei->eigrp;
+	struct eigrp_pending_reply *pr, *prev;
+
+	pr = XCALLOC(MTYPE_EIGRP_PENDING_REPLY, sizeof(*pr));
+	prefix_copy(&pr->destination, pe->destination);
+	pr->reported_metric = pe->reported_metric;
+
+	// TODO: Work in progress
+	/* Filtering */
+	/* get list from eigrp process */
+	if (eigrp_update_prefix_apply(eigrp, ei, EIGRP_FILTER_OUT,
+				      pe->destination)) {
+		zlog_info("REPLY SEND: Setting Metric to max");
+		pr->reported_metric.delay = EIGRP_MAX_METRIC;
+	}
+
+	/*
+	 * End of filtering
+	 */
+
+	prev = eigrp_reply_pending_add(&nbr->reply_pending, pr);
+	if (prev) {
+		prev->reported_metric = pr->reported_metric;
+		XFREE(MTYPE_EIGRP_PENDING_REPLY, pr);
+	}
+
+	event_add_event(master, eigrp_reply_send_pending, nbr, 0,
+			&nbr->t_reply);
+}
+
+void eigrp_reply_pending_clear(struct eigrp_neighbor *nbr)
+{
+	struct eigrp_pending_reply *pr;
 
-	XFREE(MTYPE_EIGRP_PREFIX_DESCRIPTOR, pe2);
+	while ((pr = eigrp_reply_pending_pop(&nbr->reply_pending)))
+		XFREE(MTYPE_EIGRP_PENDING_REPLY, pr);
+	eigrp_reply_pending_fini(&nbr->reply_pending);
 }
 
 /*EIGRP REPLY read function*/
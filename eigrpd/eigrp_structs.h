@@ -18,10 +18,14 @@
 #define _ZEBRA_EIGRP_STRUCTS_H_
 
 #include "filter.h"
+#include "typesafe.h"
 
 #include "eigrpd/eigrp_const.h"
 #include "eigrpd/eigrp_macros.h"
 
+PREDECL_DLIST(eigrp_nbr_routes);
+PREDECL_HASH(eigrp_reply_pending);
+
 struct eigrp_metrics {
 	uint32_t delay;
 	uint32_t bandwidth;
@@ -255,6 +259,13 @@ struct eigrp_neighbor {
 	struct list *nbr_gr_prefixes_send;
 	/* if packet is first or last during Graceful restart */
 	enum Packet_part_type nbr_gr_packet_type;
+
+	/* route descriptors advertised by this neighbor */
+	struct eigrp_nbr_routes_head routes;
+
+	/* replies not sent yet, packed into as few packets as possible */
+	struct eigrp_reply_pending_head reply_pending;
+	struct event *t_reply;
 };
 
 //---------------------------------------------------------------------------------------------------------------------------------------------
@@ -469,8 +480,13 @@ struct eigrp_route_descriptor {
 	uint8_t flags;			   // used for marking successor and FS
 
 	struct eigrp_interface *ei; // pointer for case of connected entry
+
+	struct eigrp_nbr_routes_item nbr_item;
+	bool nbr_linked;
 };
 
+DECLARE_DLIST(eigrp_nbr_routes, struct eigrp_route_descriptor, nbr_item);
+
 //---------------------------------------------------------------------------------------------------------------------------------------------
 typedef enum {
 	EIGRP_CONNECTED,
@@ -132,6 +132,28 @@ void eigrp_prefix_descriptor_add(struct route_table *topology,
 	rn->info = pe;
 }
 
+/*
+ * Keep track of the entries each neighbor advertises, so that a neighbor
+ * going away only visits its own prefixes.
+ */
+static void eigrp_route_descriptor_link(struct eigrp_route_descriptor *entry)
+{
+	if (entry->nbr_linked || !entry->adv_router)
+		return;
+
+	eigrp_nbr_routes_add_tail(&entry->adv_router->routes, entry);
+	entry->nbr_linked = true;
+}
+
+static void eigrp_route_descriptor_unlink(struct eigrp_route_descriptor *entry)
+{
+	if (!entry->nbr_linked)
+		return;
+
+	eigrp_nbr_routes_del(&entry->adv_router->routes, entry);
+	entry->nbr_linked = false;
+}
+
 /*
  * Adding topology entry to topology node
  */
@@ -146,6 +168,7 @@ void eigrp_route_descriptor_add(struct eigrp *eigrp,
 	if (listnode_lookup(node->entries, entry) == NULL) {
 		listnode_add_sort(node->entries, entry);
 		entry->prefix = node;
+		eigrp_route_descriptor_link(entry);
 
 		eigrp_zebra_route_add(eigrp, node->destination,
 				      l, node->fdistance);
@@ -200,6 +223,7 @@ void eigrp_route_descriptor_delete(struct eigrp *eigrp,
 {
 	if (listnode_lookup(node->entries, entry) != NULL) {
 		listnode_delete(node->entries, entry);
+		eigrp_route_descriptor_unlink(entry);
 		eigrp_zebra_route_delete(eigrp, node->destination);
 		XFREE(MTYPE_EIGRP_ROUTE_DESCRIPTOR, entry);
 	}
@@ -398,6 +422,7 @@ distance_done:
 	 */
 	listnode_delete(prefix->entries, entry);
 	listnode_add_sort(prefix->entries, entry);
+	eigrp_route_descriptor_link(entry);
 
 	return change;
 }
@@ -478,33 +503,24 @@ void eigrp_update_routing_table(struct eigrp *eigrp,
 void eigrp_topology_neighbor_down(struct eigrp *eigrp,
 				  struct eigrp_neighbor *nbr)
 {
-	struct listnode *node2, *node22;
-	struct eigrp_prefix_descriptor *pe;
 	struct eigrp_route_descriptor *entry;
-	struct route_node *rn;
-
-	for (rn = route_top(eigrp->topology_table); rn; rn = route_next(rn)) {
-		pe = rn->info;
-
-		if (!pe)
-			continue;
 
-		for (ALL_LIST_ELEMENTS(pe->entries, node2, node22, entry)) {
-			struct eigrp_fsm_action_message msg;
-
-			if (entry->adv_router != nbr)
-				continue;
-
-			memset(&msg, 0, sizeof(msg));
-			msg.metrics.delay = EIGRP_MAX_METRIC;
-			msg.packet_type = EIGRP_OPC_UPDATE;
-			msg.eigrp = eigrp;
-			msg.data_type = EIGRP_INT;
-			msg.adv_router = nbr;
-			msg.entry = entry;
-			msg.prefix = pe;
-			eigrp_fsm_event(&msg);
-		}
+	/*
+	 * The FSM may delete the entry (and its prefix) under us, but never
+	 * another prefix's entry, so the next one is safe to hold on to.
+	 */
+	frr_each_safe (eigrp_nbr_routes, &nbr->routes, entry) {
+		struct eigrp_fsm_action_message msg;
+
+		memset(&msg, 0, sizeof(msg));
+		msg.metrics.delay = EIGRP_MAX_METRIC;
+		msg.packet_type = EIGRP_OPC_UPDATE;
+		msg.eigrp = eigrp;
+		msg.data_type = EIGRP_INT;
+		msg.adv_router = nbr;
+		msg.entry = entry;
+		msg.prefix = entry->prefix;
+		eigrp_fsm_event(&msg);
 	}
 
 	eigrp_query_send_all(eigrp);
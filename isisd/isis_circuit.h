@@ -88,6 +88,12 @@ struct isis_circuit {
 	struct event *t_read;
 	struct event *t_send_csnp[ISIS_LEVELS];
 	struct event *t_send_psnp[ISIS_LEVELS];
+	/*
+	 * SSN flags were set on this circuit since the last PSNP, for LSP IDs
+	 * starting at psnp_start.
+	 */
+	bool psnp_pending[ISIS_LEVELS];
+	uint8_t psnp_start[ISIS_LEVELS][ISIS_SYS_ID_LEN + 2];
 	struct isis_tx_queue *tx_queue;
 	struct isis_circuit_arg
 		level_arg[ISIS_LEVELS]; /* used as argument for threads */
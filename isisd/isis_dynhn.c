@@ -17,6 +17,7 @@
 #include "command.h"
 #include "if.h"
 #include "frrevent.h"
+#include "hash.h"
 
 #include "isisd/isis_constants.h"
 #include "isisd/isis_common.h"
@@ -28,12 +29,47 @@
 #include "isisd/isis_constants.h"
 
 DEFINE_MTYPE_STATIC(ISISD, ISIS_DYNHN, "ISIS dyn hostname");
+DEFINE_MTYPE_STATIC(ISISD, ISIS_DYNHN_CACHE, "ISIS dyn hostname cache");
+
+static int isis_dynhn_id_cmp(const struct isis_dynhn *a,
+			     const struct isis_dynhn *b)
+{
+	return memcmp(a->id, b->id, ISIS_SYS_ID_LEN);
+}
+
+DECLARE_RBTREE_UNIQ(isis_dynhn_ids, struct isis_dynhn, id_item,
+		    isis_dynhn_id_cmp);
+
+static int isis_dynhn_name_cmp(const struct isis_dynhn *a,
+			       const struct isis_dynhn *b)
+{
+	return strcmp(a->hostname, b->hostname);
+}
+
+static uint32_t isis_dynhn_name_hash(const struct isis_dynhn *dyn)
+{
+	return string_hash_make(dyn->hostname);
+}
+
+DECLARE_HASH(isis_dynhn_names, struct isis_dynhn, name_item,
+	     isis_dynhn_name_cmp, isis_dynhn_name_hash);
+
+struct isis_dynhn_cache {
+	struct isis_dynhn_ids_head ids;
+	struct isis_dynhn_names_head names;
+
+	/* entries left out of names since their hostname is taken */
+	unsigned int unnamed;
+};
 
 static void dyn_cache_cleanup(struct event *);
 
 void dyn_cache_init(struct isis *isis)
 {
-	isis->dyn_cache = list_new();
+	isis->dyn_cache = XCALLOC(MTYPE_ISIS_DYNHN_CACHE,
+				  sizeof(*isis->dyn_cache));
+	isis_dynhn_ids_init(&isis->dyn_cache->ids);
+	isis_dynhn_names_init(&isis->dyn_cache->names);
 	if (!CHECK_FLAG(im->options, F_ISIS_UNIT_TEST))
 		event_add_timer(master, dyn_cache_cleanup, isis, 120,
 				&isis->t_dync_clean);
@@ -41,22 +77,66 @@ void dyn_cache_init(struct isis *isis)
 
 void dyn_cache_finish(struct isis *isis)
 {
-	struct listnode *node, *nnode;
+	struct isis_dynhn_cache *cache = isis->dyn_cache;
 	struct isis_dynhn *dyn;
 
 	EVENT_OFF(isis->t_dync_clean);
 
-	for (ALL_LIST_ELEMENTS(isis->dyn_cache, node, nnode, dyn)) {
-		list_delete_node(isis->dyn_cache, node);
+	while ((dyn = isis_dynhn_ids_pop(&cache->ids))) {
+		if (dyn->named)
+			isis_dynhn_names_del(&cache->names, dyn);
 		XFREE(MTYPE_ISIS_DYNHN, dyn);
 	}
 
-	list_delete(&isis->dyn_cache);
+	isis_dynhn_ids_fini(&cache->ids);
+	isis_dynhn_names_fini(&cache->names);
+	XFREE(MTYPE_ISIS_DYNHN_CACHE, isis->dyn_cache);
+}
+
+static void dynhn_name_add(struct isis_dynhn_cache *cache,
+			   struct isis_dynhn *dyn)
+{
+	dyn->named = !isis_dynhn_names_add(&cache->names, dyn);
+	if (!dyn->named)
+		cache->unnamed++;
+}
+
+static void dynhn_name_del(struct isis_dynhn_cache *cache,
+			   struct isis_dynhn *dyn)
+{
+	struct isis_dynhn *other;
+
+	if (!dyn->named) {
+		cache->unnamed--;
+		return;
+	}
+
+	isis_dynhn_names_del(&cache->names, dyn);
+	dyn->named = false;
+
+	/* another system with the same hostname takes over the name */
+	if (!cache->unnamed)
+		return;
+	frr_each (isis_dynhn_ids, &cache->ids, other) {
+		if (other != dyn && !other->named
+		    && !strcmp(other->hostname, dyn->hostname)) {
+			isis_dynhn_names_add(&cache->names, other);
+			other->named = true;
+			cache->unnamed--;
+			break;
+		}
+	}
+}
+
+static void dynhn_free(struct isis_dynhn_cache *cache, struct isis_dynhn *dyn)
+{
+	isis_dynhn_ids_del(&cache->ids, dyn);
+	dynhn_name_del(cache, dyn);
+	XFREE(MTYPE_ISIS_DYNHN, dyn);
 }
 
 static void dyn_cache_cleanup(struct event *thread)
 {
-	struct listnode *node, *nnode;
 	struct isis_dynhn *dyn;
 	time_t now = time(NULL);
 	struct isis *isis = NULL;
@@ -65,11 +145,10 @@ static void dyn_cache_cleanup(struct event *thread)
 
 	isis->t_dync_clean = NULL;
 
-	for (ALL_LIST_ELEMENTS(isis->dyn_cache, node, nnode, dyn)) {
+	frr_each_safe (isis_dynhn_ids, &isis->dyn_cache->ids, dyn) {
 		if ((now - dyn->refresh) < MAX_LSP_LIFETIME)
 			continue;
-		list_delete_node(isis->dyn_cache, node);
-		XFREE(MTYPE_ISIS_DYNHN, dyn);
+		dynhn_free(isis->dyn_cache, dyn);
 	}
 
 	event_add_timer(master, dyn_cache_cleanup, isis, 120,
@@ -78,31 +157,24 @@ static void dyn_cache_cleanup(struct event *thread)
 
 struct isis_dynhn *dynhn_find_by_id(struct isis *isis, const uint8_t *id)
 {
-	struct listnode *node = NULL;
-	struct isis_dynhn *dyn = NULL;
-
-	for (ALL_LIST_ELEMENTS_RO(isis->dyn_cache, node, dyn))
-		if (memcmp(dyn->id, id, ISIS_SYS_ID_LEN) == 0)
-			return dyn;
+	struct isis_dynhn ref;
 
-	return NULL;
+	memcpy(ref.id, id, ISIS_SYS_ID_LEN);
+	return isis_dynhn_ids_find(&isis->dyn_cache->ids, &ref);
 }
 
 struct isis_dynhn *dynhn_find_by_name(struct isis *isis, const char *hostname)
 {
-	struct listnode *node = NULL;
-	struct isis_dynhn *dyn = NULL;
-
-	for (ALL_LIST_ELEMENTS_RO(isis->dyn_cache, node, dyn))
-		if (strncmp(dyn->hostname, hostname, 255) == 0)
-			return dyn;
+	struct isis_dynhn ref;
 
-	return NULL;
+	strlcpy(ref.hostname, hostname, sizeof(ref.hostname));
+	return isis_dynhn_names_find(&isis->dyn_cache->names, &ref);
 }
 
 void isis_dynhn_insert(struct isis *isis, const uint8_t *id,
 		       const char *hostname, int level)
 {
+	struct isis_dynhn_cache *cache = isis->dyn_cache;
 	struct isis_dynhn *dyn;
 
 	dyn = dynhn_find_by_id(isis, id);
@@ -110,10 +182,16 @@ void isis_dynhn_insert(struct isis *isis, const uint8_t *id,
 		dyn = XCALLOC(MTYPE_ISIS_DYNHN, sizeof(struct isis_dynhn));
 		memcpy(dyn->id, id, ISIS_SYS_ID_LEN);
 		dyn->level = level;
-		listnode_add(isis->dyn_cache, dyn);
-	}
+		isis_dynhn_ids_add(&cache->ids, dyn);
+	} else if (!strcmp(dyn->hostname, hostname)) {
+		/* LSP refresh, the usual case */
+		dyn->refresh = time(NULL);
+		return;
+	} else
+		dynhn_name_del(cache, dyn);
 
 	snprintf(dyn->hostname, sizeof(dyn->hostname), "%s", hostname);
+	dynhn_name_add(cache, dyn);
 	dyn->refresh = time(NULL);
 }
 
@@ -124,8 +202,7 @@ void isis_dynhn_remove(struct isis *isis, const uint8_t *id)
 	dyn = dynhn_find_by_id(isis, id);
 	if (!dyn)
 		return;
-	listnode_delete(isis->dyn_cache, dyn);
-	XFREE(MTYPE_ISIS_DYNHN, dyn);
+	dynhn_free(isis->dyn_cache, dyn);
 }
 
 /*
@@ -136,14 +213,13 @@ void isis_dynhn_remove(struct isis *isis, const uint8_t *id)
  */
 void dynhn_print_all(struct vty *vty, struct isis *isis)
 {
-	struct listnode *node;
 	struct isis_dynhn *dyn;
 
 	vty_out(vty, "vrf     : %s\n", isis->name);
 	if (!isis->sysid_set)
 		return;
 	vty_out(vty, "Level  System ID      Dynamic Hostname\n");
-	for (ALL_LIST_ELEMENTS_RO(isis->dyn_cache, node, dyn)) {
+	frr_each (isis_dynhn_ids, &isis->dyn_cache->ids, dyn) {
 		vty_out(vty, "%-7d", dyn->level);
 		vty_out(vty, "%-15s%-15s\n", sysid_print(dyn->id),
 			dyn->hostname);
@@ -157,35 +233,14 @@ void dynhn_print_all(struct vty *vty, struct isis *isis)
 struct isis_dynhn *dynhn_snmp_next(struct isis *isis, const uint8_t *id,
 				   int level)
 {
-	struct listnode *node = NULL;
-	struct isis_dynhn *dyn = NULL;
-	struct isis_dynhn *found_dyn = NULL;
-	int res;
-
-	for (ALL_LIST_ELEMENTS_RO(isis->dyn_cache, node, dyn)) {
-		res = memcmp(dyn->id, id, ISIS_SYS_ID_LEN);
-
-		if (res < 0)
-			continue;
-
-		if (res == 0 && dyn->level <= level)
-			continue;
-
-		if (res == 0) {
-			/*
-			 * This is the best match, we can stop
-			 * searching
-			 */
-
-			found_dyn = dyn;
-			break;
-		}
+	struct isis_dynhn ref;
+	struct isis_dynhn *dyn;
 
-		if (found_dyn == NULL
-		    || memcmp(dyn->id, found_dyn->id, ISIS_SYS_ID_LEN) < 0) {
-			found_dyn = dyn;
-		}
-	}
+	/* there's one entry per system ID, at its first level */
+	memcpy(ref.id, id, ISIS_SYS_ID_LEN);
+	dyn = isis_dynhn_ids_find_gteq(&isis->dyn_cache->ids, &ref);
+	if (dyn && !memcmp(dyn->id, id, ISIS_SYS_ID_LEN) && dyn->level <= level)
+		dyn = isis_dynhn_ids_next(&isis->dyn_cache->ids, dyn);
 
-	return found_dyn;
+	return dyn;
 }
@@ -10,11 +10,26 @@
 #ifndef _ZEBRA_ISIS_DYNHN_H
 #define _ZEBRA_ISIS_DYNHN_H
 
+#include "typesafe.h"
+#include "isisd/isis_constants.h"
+
+struct isis;
+struct vty;
+
+/* entries are indexed by system ID, ordered for SNMP, and by hostname */
+PREDECL_RBTREE_UNIQ(isis_dynhn_ids);
+PREDECL_HASH(isis_dynhn_names);
+
 struct isis_dynhn {
 	uint8_t id[ISIS_SYS_ID_LEN];
 	char hostname[256];
 	time_t refresh;
 	int level;
+
+	struct isis_dynhn_ids_item id_item;
+	/* only one of several systems with the same hostname is in here */
+	struct isis_dynhn_names_item name_item;
+	bool named;
 };
 
 void dyn_cache_init(struct isis *isis);
@@ -28,6 +28,7 @@
 #include "isis_spf_private.h"
 #include "isis_zebra.h"
 #include "isis_errors.h"
+#include "isis_lfa_workers.h"
 
 DEFINE_MTYPE_STATIC(ISISD, ISIS_SPF_NODE, "ISIS SPF Node");
 DEFINE_MTYPE_STATIC(ISISD, ISIS_LFA_TIEBREAKER, "ISIS LFA Tiebreaker");
@@ -74,6 +75,54 @@ void isis_spf_node_list_clear(struct isis_spf_nodes *nodes)
 	}
 }
 
+/**
+ * Move the neighbor SPTs computed by the previous run to the list of spare
+ * SPTs, so that the next run can reuse them (and their vertices) instead of
+ * allocating new ones.
+ *
+ * @param spftree	IS-IS SPF tree
+ */
+void isis_lfa_spftrees_stash(struct isis_spftree *spftree)
+{
+	struct isis_spf_node *adj_node;
+
+	RB_FOREACH (adj_node, isis_spf_nodes, &spftree->adj_nodes) {
+		if (adj_node->lfa.spftree) {
+			listnode_add(spftree->lfa.spare_spftrees,
+				     adj_node->lfa.spftree);
+			adj_node->lfa.spftree = NULL;
+		}
+		if (adj_node->lfa.spftree_reverse) {
+			listnode_add(spftree->lfa.spare_spftrees,
+				     adj_node->lfa.spftree_reverse);
+			adj_node->lfa.spftree_reverse = NULL;
+		}
+	}
+}
+
+/* Get a spare SPT of the given type for the given root, or a new one. */
+static struct isis_spftree *lfa_spftree_get(struct isis_spftree *spftree,
+					    const uint8_t *sysid,
+					    enum spf_type type)
+{
+	struct isis_spftree *spftree_spare;
+	struct listnode *node;
+
+	for (ALL_LIST_ELEMENTS_RO(spftree->lfa.spare_spftrees, node,
+				  spftree_spare)) {
+		if (spftree_spare->type != type)
+			continue;
+
+		list_delete_node(spftree->lfa.spare_spftrees, node);
+		memcpy(spftree_spare->sysid, sysid, ISIS_SYS_ID_LEN);
+		return spftree_spare;
+	}
+
+	return isis_spftree_new(spftree->area, spftree->lspdb, sysid,
+				spftree->level, spftree->tree_id, type,
+				F_SPFTREE_NO_ADJACENCIES | F_SPFTREE_NO_ROUTES);
+}
+
 /**
  * Add new node to list of SPF nodes.
  *
@@ -1138,10 +1187,13 @@ static void lfa_calc_pq_spaces(struct isis_spftree *spftree_pc,
 			 * adjacent to the failure, if we haven't done that
 			 * before
 			 */
-			if (!adj_node->lfa.spftree_reverse)
+			if (!adj_node->lfa.spftree_reverse) {
 				adj_node->lfa.spftree_reverse =
-					isis_spf_reverse_run(
-						adj_node->lfa.spftree);
+					lfa_spftree_get(spftree,
+							adj_node->sysid,
+							SPF_TYPE_REVERSE);
+				isis_run_spf(adj_node->lfa.spftree_reverse);
+			}
 
 			lfa_calc_reach_nodes(adj_node->lfa.spftree_reverse,
 					     spftree_reverse, adj_nodes, false,
@@ -1217,6 +1269,63 @@ struct isis_spftree *isis_tilfa_compute(struct isis_area *area,
 	return spftree_pc;
 }
 
+/*
+ * Compute the pre-failure SPTs needed by the LFA algorithms: the forward SPT
+ * of all adjacent routers and, if spftree_reverse is given, the local reverse
+ * SPT. These only read the LSPDB and don't depend on each other, so they're
+ * run as one batch by the LFA workers. When workers are available the
+ * reverse SPTs of the neighbors are computed in the same batch rather than
+ * on demand by lfa_calc_pq_spaces().
+ */
+static int lfa_run_spftrees(struct isis_spftree *spftree,
+			    struct isis_spftree **spftree_reverse)
+{
+	struct isis_spftree **spftrees;
+	struct isis_spf_node *adj_node;
+	unsigned int count = 0, alloc = 1;
+	bool neighbors_reverse;
+	int ret = 0;
+
+	RB_FOREACH (adj_node, isis_spf_nodes, &spftree->adj_nodes)
+		alloc += 2;
+	spftrees = XCALLOC(MTYPE_TMP, alloc * sizeof(*spftrees));
+
+	/* Reverse SPF locally. */
+	if (spftree_reverse) {
+		*spftree_reverse = lfa_spftree_get(spftree, spftree->sysid,
+						   SPF_TYPE_REVERSE);
+		spftrees[count++] = *spftree_reverse;
+	}
+
+	neighbors_reverse = spftree_reverse && isis_lfa_workers_count();
+	if (isis_root_system_lsp(spftree->lspdb, spftree->sysid)) {
+		RB_FOREACH (adj_node, isis_spf_nodes, &spftree->adj_nodes) {
+			if (IS_DEBUG_LFA)
+				zlog_debug("ISIS-LFA: running SPF on neighbor %s",
+					   print_sys_hostname(adj_node->sysid));
+
+			/* Compute the SPT on behalf of the neighbor. */
+			adj_node->lfa.spftree = lfa_spftree_get(
+				spftree, adj_node->sysid, SPF_TYPE_FORWARD);
+			spftrees[count++] = adj_node->lfa.spftree;
+
+			if (neighbors_reverse) {
+				adj_node->lfa.spftree_reverse = lfa_spftree_get(
+					spftree, adj_node->sysid,
+					SPF_TYPE_REVERSE);
+				spftrees[count++] =
+					adj_node->lfa.spftree_reverse;
+			}
+		}
+	} else
+		ret = -1;
+
+	isis_lfa_workers_run(spftrees, count);
+	XFREE(MTYPE_TMP, spftrees);
+
+	return ret;
+}
+
 /**
  * Run forward SPF on all adjacent routers.
  *
@@ -1226,27 +1335,7 @@ struct isis_spftree *isis_tilfa_compute(struct isis_area *area,
  */
 int isis_spf_run_neighbors(struct isis_spftree *spftree)
 {
-	struct isis_lsp *lsp;
-	struct isis_spf_node *adj_node;
-
-	lsp = isis_root_system_lsp(spftree->lspdb, spftree->sysid);
-	if (!lsp)
-		return -1;
-
-	RB_FOREACH (adj_node, isis_spf_nodes, &spftree->adj_nodes) {
-		if (IS_DEBUG_LFA)
-			zlog_debug("ISIS-LFA: running SPF on neighbor %s",
-				   print_sys_hostname(adj_node->sysid));
-
-		/* Compute the SPT on behalf of the neighbor. */
-		adj_node->lfa.spftree = isis_spftree_new(
-			spftree->area, spftree->lspdb, adj_node->sysid,
-			spftree->level, spftree->tree_id, SPF_TYPE_FORWARD,
-			F_SPFTREE_NO_ADJACENCIES | F_SPFTREE_NO_ROUTES);
-		isis_run_spf(adj_node->lfa.spftree);
-	}
-
-	return 0;
+	return lfa_run_spftrees(spftree, NULL);
 }
 
 /* Find Router ID of PQ node. */
@@ -2278,13 +2367,15 @@ void isis_spf_run_lfa(struct isis_area *area, struct isis_spftree *spftree)
 	struct listnode *node;
 	int level = spftree->level;
 
-	/* Run reverse SPF locally. */
+	/*
+	 * Run reverse SPF locally (only needed by RLFA and TI-LFA) and forward
+	 * SPF on all adjacent routers.
+	 */
 	if (area->rlfa_protected_links[level - 1] > 0
 	    || area->tilfa_protected_links[level - 1] > 0)
-		spftree_reverse = isis_spf_reverse_run(spftree);
-
-	/* Run forward SPF on all adjacent routers. */
-	isis_spf_run_neighbors(spftree);
+		lfa_run_spftrees(spftree, &spftree_reverse);
+	else
+		lfa_run_spftrees(spftree, NULL);
 
 	/* Check which interfaces are protected. */
 	for (ALL_LIST_ELEMENTS_RO(area->circuit_list, node, circuit)) {
@@ -2352,6 +2443,11 @@ void isis_spf_run_lfa(struct isis_area *area, struct isis_spftree *spftree)
 		}
 	}
 
+	/*
+	 * Spare SPTs that weren't reused belong to neighbors that went away,
+	 * keep only the local reverse SPT for the next run.
+	 */
+	list_delete_all_node(spftree->lfa.spare_spftrees);
 	if (spftree_reverse)
-		isis_spftree_del(spftree_reverse);
+		listnode_add(spftree->lfa.spare_spftrees, spftree_reverse);
 }
@@ -144,6 +144,7 @@ bool isis_lfa_excise_adj_check(const struct isis_spftree *spftree,
 			       const uint8_t *id);
 bool isis_lfa_excise_node_check(const struct isis_spftree *spftree,
 				const uint8_t *id);
+void isis_lfa_spftrees_stash(struct isis_spftree *spftree);
 struct isis_spftree *isis_spf_reverse_run(const struct isis_spftree *spftree);
 int isis_spf_run_neighbors(struct isis_spftree *spftree);
 int isis_rlfa_activate(struct isis_spftree *spftree, struct rlfa *rlfa,
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * IS-IS LFA SPF worker pthreads.
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * Before the LFA, RLFA and TI-LFA algorithms can do anything they need the
+ * pre-failure SPTs as seen from the local router (reverse) and from each of
+ * its neighbors (forward and, for RLFA/TI-LFA, reverse).  On routers with
+ * many neighbors computing these dominates the run time of the protection
+ * code, but none of them depend on each other: every tree only reads the
+ * LSPDB and writes to its own vertices, adjacency lists and node lists.
+ *
+ * When LFA workers are configured, the trees are handed to the worker pool
+ * (the main pthread takes part too) and the main pthread blocks until all of
+ * them are done.  Since nothing else runs on the main pthread in the
+ * meantime, the LSPDB can't change while the workers look at it.  Everything
+ * after that (P/Q-space, post-convergence SPTs, backup routes and SR state)
+ * stays on the main pthread.
+ */
+
+#include <zebra.h>
+
+#include "frr_pthread.h"
+#include "frrevent.h"
+#include "memory.h"
+
+#include "isisd/isisd.h"
+#include "isisd/isis_spf.h"
+#include "isisd/isis_lfa_workers.h"
+
+DEFINE_MTYPE_STATIC(ISISD, ISIS_LFA_WORKER, "ISIS LFA worker");
+
+struct isis_lfa_worker {
+	struct frr_pthread *fpt;
+	struct event *t_run;
+	unsigned int index;
+};
+
+struct isis_lfa_batch {
+	struct isis_spftree **jobs;
+	unsigned int njobs;
+
+	_Atomic unsigned int next;
+
+	pthread_mutex_t mtx;
+	pthread_cond_t cond;
+	unsigned int running;
+};
+
+static struct isis_lfa_worker **workers;
+static unsigned int workers_configured;
+
+/* only used from the main pthread */
+static struct isis_lfa_batch batch = {
+	.mtx = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+unsigned int isis_lfa_workers_count(void)
+{
+	return workers_configured;
+}
+
+/* run jobs off the batch until none are left */
+static void isis_lfa_batch_work(void)
+{
+	unsigned int i;
+
+	while ((i = atomic_fetch_add_explicit(&batch.next, 1,
+					      memory_order_relaxed)) <
+	       batch.njobs)
+		isis_run_spf(batch.jobs[i]);
+}
+
+static void isis_lfa_worker_run(struct event *thread)
+{
+	isis_lfa_batch_work();
+
+	frr_with_mutex (&batch.mtx) {
+		if (--batch.running == 0)
+			pthread_cond_signal(&batch.cond);
+	}
+}
+
+void isis_lfa_workers_run(struct isis_spftree **spftrees, unsigned int count)
+{
+	unsigned int i;
+
+	/*
+	 * Debug output uses static buffers (print_sys_hostname(),
+	 * isis_format_id()), so keep everything on the main pthread then.
+	 */
+	if (!workers_configured || count < 2 || IS_DEBUG_SPF_EVENTS ||
+	    IS_DEBUG_LFA) {
+		for (i = 0; i < count; i++)
+			isis_run_spf(spftrees[i]);
+		return;
+	}
+
+	batch.jobs = spftrees;
+	batch.njobs = count;
+	atomic_store_explicit(&batch.next, 0, memory_order_relaxed);
+	batch.running = MIN(workers_configured, count - 1);
+
+	/* the mutex orders the job setup above before the workers start */
+	frr_with_mutex (&batch.mtx) {
+		for (i = 0; i < batch.running; i++)
+			event_add_event(workers[i]->fpt->master,
+					isis_lfa_worker_run, workers[i], 0,
+					&workers[i]->t_run);
+	}
+
+	isis_lfa_batch_work();
+
+	frr_with_mutex (&batch.mtx) {
+		while (batch.running)
+			pthread_cond_wait(&batch.cond, &batch.mtx);
+	}
+
+	batch.jobs = NULL;
+	batch.njobs = 0;
+}
+
+static void isis_lfa_workers_stop(void)
+{
+	unsigned int i;
+
+	if (!workers_configured)
+		return;
+
+	/* batches are always finished before returning to the event loop */
+	for (i = 0; i < workers_configured; i++) {
+		frr_pthread_stop(workers[i]->fpt, NULL);
+		frr_pthread_destroy(workers[i]->fpt);
+		XFREE(MTYPE_ISIS_LFA_WORKER, workers[i]);
+	}
+	XFREE(MTYPE_ISIS_LFA_WORKER, workers);
+	workers_configured = 0;
+}
+
+void isis_lfa_workers_set(unsigned int count)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+	char name[32];
+	char os_name[OS_THREAD_NAMELEN];
+	unsigned int i;
+
+	if (count > ISIS_LFA_WORKERS_MAX)
+		count = ISIS_LFA_WORKERS_MAX;
+	if (count == workers_configured)
+		return;
+
+	isis_lfa_workers_stop();
+	if (!count)
+		return;
+
+	workers = XCALLOC(MTYPE_ISIS_LFA_WORKER, count * sizeof(*workers));
+	for (i = 0; i < count; i++) {
+		struct isis_lfa_worker *w;
+
+		w = XCALLOC(MTYPE_ISIS_LFA_WORKER, sizeof(*w));
+		w->index = i;
+
+		snprintf(name, sizeof(name), "IS-IS LFA worker %u", i);
+		snprintf(os_name, sizeof(os_name), "isisd_lfa%u", i);
+		w->fpt = frr_pthread_new(&attr, name, os_name);
+		frr_pthread_run(w->fpt, NULL);
+		workers[i] = w;
+	}
+	for (i = 0; i < count; i++)
+		frr_pthread_wait_running(workers[i]->fpt);
+
+	workers_configured = count;
+}
+
+void isis_lfa_workers_finish(void)
+{
+	isis_lfa_workers_stop();
+}
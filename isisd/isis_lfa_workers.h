@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * IS-IS LFA SPF worker pthreads.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#ifndef _FRR_ISIS_LFA_WORKERS_H
+#define _FRR_ISIS_LFA_WORKERS_H
+
+struct isis_spftree;
+
+#define ISIS_LFA_WORKERS_MAX 16U
+
+/* configured number of workers, 0 if disabled */
+extern unsigned int isis_lfa_workers_count(void);
+
+/* (re)configure the number of LFA workers, 0 disables them */
+extern void isis_lfa_workers_set(unsigned int count);
+
+/*
+ * Run isis_run_spf() on all the given trees and return once all of them are
+ * done. The trees must not depend on each other and only read the LSPDB, the
+ * work is spread over the worker pthreads (and the calling pthread) if
+ * workers are configured.
+ */
+extern void isis_lfa_workers_run(struct isis_spftree **spftrees,
+				 unsigned int count);
+
+extern void isis_lfa_workers_finish(void);
+
+#endif /* _FRR_ISIS_LFA_WORKERS_H */
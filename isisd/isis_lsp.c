@@ -48,6 +48,7 @@
 #include "isisd/isis_nb.h"
 
 DEFINE_MTYPE_STATIC(ISISD, ISIS_LSP, "ISIS LSP");
+DEFINE_MTYPE_STATIC(ISISD, ISIS_EXT_FRAGS, "ISIS LSP external fragments");
 
 static void lsp_refresh(struct event *thread);
 static void lsp_l1_refresh_pseudo(struct event *thread);
@@ -108,8 +109,10 @@ static void lsp_destroy(struct isis_lsp *lsp)
 	if (!lsp)
 		return;
 
-	for (ALL_LIST_ELEMENTS_RO(lsp->area->circuit_list, cnode, circuit))
-		isis_tx_queue_del(circuit->tx_queue, lsp);
+	if (flags_any_set(lsp->SRMflags))
+		for (ALL_LIST_ELEMENTS_RO(lsp->area->circuit_list, cnode,
+					  circuit))
+			isis_tx_queue_del(circuit->tx_queue, lsp);
 
 	ISIS_FLAGS_CLEAR_ALL(lsp->SSNflags);
 
@@ -547,10 +550,31 @@ static void lsp_link_fragment(struct isis_lsp *lsp, struct isis_lsp *lsp0)
 	}
 }
 
+/*
+ * Check whether an update of an LSP only changes prefix information, in
+ * which case the SPT stays the same and only the routes need updating.
+ */
+static bool lsp_update_prefix_only(struct isis_lsp *lsp,
+				   struct isis_lsp_hdr *hdr,
+				   struct isis_tlvs *tlvs)
+{
+	if (!lsp->tlvs || !tlvs || !lsp->hdr.seqno || !lsp->hdr.rem_lifetime
+	    || !hdr->rem_lifetime)
+		return false;
+
+	if (ISIS_MASK_LSP_OL_BIT(lsp->hdr.lsp_bits)
+	    != ISIS_MASK_LSP_OL_BIT(hdr->lsp_bits))
+		return false;
+
+	return isis_tlvs_is_reach_equal(lsp->tlvs, tlvs);
+}
+
 void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 		struct isis_tlvs *tlvs, struct stream *stream,
 		struct isis_area *area, int level, bool confusion)
 {
+	bool prefix_only = false;
+
 	if (lsp->own_lsp) {
 		flog_err(
 			EC_LIB_DEVELOPMENT,
@@ -563,6 +587,7 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 	if (confusion) {
 		lsp_purge(lsp, level, NULL);
 	} else {
+		prefix_only = lsp_update_prefix_only(lsp, hdr, tlvs);
 		lsp_update_data(lsp, hdr, tlvs, stream, area, level);
 	}
 
@@ -573,12 +598,17 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 		memcpy(lspid, lsp->hdr.lsp_id, ISIS_SYS_ID_LEN + 1);
 		LSP_FRAGMENT(lspid) = 0;
 		lsp0 = lsp_search(&area->lspdb[level - 1], lspid);
-		if (lsp0)
+		if (lsp0) {
 			lsp_link_fragment(lsp, lsp0);
+			prefix_only = false;
+		}
 	}
 
 	if (lsp->hdr.seqno) {
-		isis_spf_schedule(lsp->area, lsp->level);
+		if (prefix_only)
+			isis_spf_schedule_prefix(lsp->area, lsp->level);
+		else
+			isis_spf_schedule(lsp->area, lsp->level);
 		isis_te_lsp_event(lsp, LSP_UPD);
 	}
 }
@@ -881,47 +911,229 @@ static uint16_t lsp_refresh_time(struct isis_lsp *lsp, uint16_t rem_lifetime)
 	return refresh_time;
 }
 
-static void lsp_build_ext_reach_ipv4(struct isis_lsp *lsp,
-				     struct isis_area *area)
+static struct isis_lsp *lsp_next_frag(uint8_t frag_num, struct isis_lsp *lsp0,
+				      struct isis_area *area, int level)
 {
-	struct route_table *er_table = get_ext_reach(area, AF_INET, lsp->level);
-	if (!er_table)
-		return;
+	struct isis_lsp *lsp;
+	uint8_t frag_id[ISIS_SYS_ID_LEN + 2];
 
-	for (struct route_node *rn = route_top(er_table); rn;
-	     rn = route_next(rn)) {
-		if (!rn->info)
-			continue;
+	memcpy(frag_id, lsp0->hdr.lsp_id, ISIS_SYS_ID_LEN + 1);
+	LSP_FRAGMENT(frag_id) = frag_num;
+
+	lsp = lsp_search(&area->lspdb[level - 1], frag_id);
+	if (lsp) {
+		lsp_clear_data(lsp);
+		if (!lsp->lspu.zero_lsp)
+			lsp_link_fragment(lsp, lsp0);
+		return lsp;
+	}
 
-		struct prefix_ipv4 *ipv4 = (struct prefix_ipv4 *)&rn->p;
-		struct isis_ext_info *info = rn->info;
+	lsp = lsp_new(area, frag_id, lsp0->hdr.rem_lifetime, 0,
+		      lsp_bits_generate(level, area->overload_bit,
+					area->attached_bit_send, area),
+		      0, lsp0, level);
+	lsp->own_lsp = 1;
+	lsp_insert(&area->lspdb[level - 1], lsp);
+	return lsp;
+}
 
-		uint32_t metric = info->metric;
-		if (metric > MAX_WIDE_PATH_METRIC)
-			metric = MAX_WIDE_PATH_METRIC;
-		if (area->oldmetric && metric > 0x3f)
-			metric = 0x3f;
+static void lsp_add_ext_reach_ipv4(struct isis_tlvs *tlvs,
+				   struct isis_area *area,
+				   struct route_node *rn)
+{
+	struct prefix_ipv4 *ipv4 = (struct prefix_ipv4 *)&rn->p;
+	struct isis_ext_info *info = rn->info;
 
-		if (area->oldmetric)
-			isis_tlvs_add_oldstyle_ip_reach(lsp->tlvs, ipv4,
-							metric);
-		if (area->newmetric) {
-			struct sr_prefix_cfg *pcfg = NULL;
+	uint32_t metric = info->metric;
+	if (metric > MAX_WIDE_PATH_METRIC)
+		metric = MAX_WIDE_PATH_METRIC;
+	if (area->oldmetric && metric > 0x3f)
+		metric = 0x3f;
 
-			if (area->srdb.enabled)
-				pcfg = isis_sr_cfg_prefix_find(area, ipv4);
+	if (area->oldmetric)
+		isis_tlvs_add_oldstyle_ip_reach(tlvs, ipv4, metric);
+	if (area->newmetric) {
+		struct sr_prefix_cfg *pcfg = NULL;
 
-			isis_tlvs_add_extended_ip_reach(lsp->tlvs, ipv4, metric,
-							true, pcfg);
+		if (area->srdb.enabled)
+			pcfg = isis_sr_cfg_prefix_find(area, ipv4);
+
+		isis_tlvs_add_extended_ip_reach(tlvs, ipv4, metric, true,
+						pcfg);
+	}
+}
+
+static void lsp_add_ext_reach_ipv6(struct isis_tlvs *tlvs,
+				   struct isis_area *area,
+				   struct route_node *rn)
+{
+	struct isis_ext_info *info = rn->info;
+	struct prefix_ipv6 *p, *src_p;
+
+	srcdest_rnode_prefixes(rn, (const struct prefix **)&p,
+			       (const struct prefix **)&src_p);
+
+	uint32_t metric = info->metric;
+	if (info->metric > MAX_WIDE_PATH_METRIC)
+		metric = MAX_WIDE_PATH_METRIC;
+
+	if (!src_p || !src_p->prefixlen) {
+		struct sr_prefix_cfg *pcfg = NULL;
+
+		if (area->srdb.enabled)
+			pcfg = isis_sr_cfg_prefix_find(area, p);
+
+		isis_tlvs_add_ipv6_reach(tlvs, isis_area_ipv6_topology(area), p,
+					 metric, true, pcfg);
+	} else if (isis_area_ipv6_dstsrc_enabled(area)) {
+		isis_tlvs_add_ipv6_dstsrc_reach(tlvs, ISIS_MT_IPV6_DSTSRC, p,
+						src_p, metric);
+	}
+}
+
+static void lsp_add_ext_reach(struct isis_tlvs *tlvs, struct isis_area *area,
+			      int family, struct route_node *rn)
+{
+	if (family == AF_INET)
+		lsp_add_ext_reach_ipv4(tlvs, area, rn);
+	else
+		lsp_add_ext_reach_ipv6(tlvs, area, rn);
+}
+
+static void lsp_build_ext_reach(struct isis_tlvs *tlvs, struct isis_area *area,
+				int level)
+{
+	int families[] = { AF_INET, AF_INET6 };
+
+	for (unsigned int i = 0; i < array_size(families); i++) {
+		struct route_table *er_table =
+			get_ext_reach(area, families[i], level);
+
+		if (!er_table)
+			continue;
+
+		for (struct route_node *rn = route_top(er_table); rn;
+		     rn = srcdest_route_next(rn)) {
+			if (rn->info)
+				lsp_add_ext_reach(tlvs, area, families[i], rn);
 		}
 	}
 }
 
-static void lsp_build_ext_reach_ipv6(struct isis_lsp *lsp,
-				     struct isis_area *area)
+void lsp_ext_frags_fini(struct isis_ext_frags *ext)
+{
+	for (unsigned int i = 0; i < array_size(ext->ranges); i++) {
+		XFREE(MTYPE_ISIS_EXT_FRAGS, ext->ranges[i]);
+		ext->count[i] = 0;
+	}
+}
+
+/* Prefixes of this fragment build: nodes[lo] up to nodes[hi - 1]. */
+struct lsp_ext_span {
+	struct prefix start;
+	unsigned int lo, hi;
+	uint8_t family_idx;
+	uint8_t frag;
+	struct isis_tlvs *tlvs;
+};
+
+struct lsp_ext_spans {
+	struct lsp_ext_span *span;
+	unsigned int count, alloc;
+};
+
+static const struct prefix *lsp_ext_key(const struct route_node *rn)
+{
+	const struct prefix *p, *src_p;
+
+	srcdest_rnode_prefixes(rn, &p, &src_p);
+	return p;
+}
+
+/* The order route_next() and srcdest_route_next() walk the prefixes in. */
+static int lsp_ext_cmp(const struct prefix *a, const struct prefix *b)
+{
+	int ret = memcmp(&a->u.prefix, &b->u.prefix, prefix_blen(a));
+
+	return ret ? ret : numcmp(a->prefixlen, b->prefixlen);
+}
+
+static struct lsp_ext_span *lsp_ext_span_insert(struct lsp_ext_spans *spans,
+						unsigned int at)
+{
+	if (spans->count == spans->alloc) {
+		spans->alloc = MAX(spans->alloc * 2, 16);
+		spans->span = XREALLOC(MTYPE_TMP, spans->span,
+				       spans->alloc * sizeof(*spans->span));
+	}
+	memmove(&spans->span[at + 1], &spans->span[at],
+		(spans->count - at) * sizeof(*spans->span));
+	spans->count++;
+	memset(&spans->span[at], 0, sizeof(*spans->span));
+	return &spans->span[at];
+}
+
+/*
+ * Split spans->span[i] into up to parts spans of about the same number of
+ * prefixes.  The prefixes of one destination are never split apart.
+ */
+static bool lsp_ext_split(struct lsp_ext_spans *spans, unsigned int i,
+			  struct route_node **nodes, unsigned int parts)
 {
-	struct route_table *er_table =
-		get_ext_reach(area, AF_INET6, lsp->level);
+	unsigned int lo = spans->span[i].lo, hi = spans->span[i].hi;
+	unsigned int at, prev = lo, n = 0;
+
+	for (unsigned int k = 1; k < parts; k++) {
+		struct lsp_ext_span *span;
+
+		at = lo + (uint64_t)(hi - lo) * k / parts;
+		if (at <= prev)
+			at = prev + 1;
+		while (at < hi && !lsp_ext_cmp(lsp_ext_key(nodes[at - 1]),
+					       lsp_ext_key(nodes[at])))
+			at++;
+		if (at >= hi)
+			break;
+
+		span = lsp_ext_span_insert(spans, i + ++n);
+		span->family_idx = spans->span[i].family_idx;
+		prefix_copy(&span->start, lsp_ext_key(nodes[at]));
+		span->lo = at;
+		span->hi = hi;
+		spans->span[i + n - 1].hi = at;
+		prev = at;
+	}
+
+	return n > 0;
+}
+
+static void lsp_free_fragments(struct list **fragments)
+{
+	struct listnode *node;
+	struct isis_tlvs *tlvs;
+
+	for (ALL_LIST_ELEMENTS_RO(*fragments, node, tlvs))
+		isis_free_tlvs(tlvs);
+	list_delete(fragments);
+}
+
+/*
+ * Pack the redistributed prefixes of one family into fragment sized spans.
+ * Prefixes go to the range they were in before; a range that doesn't fit
+ * into one fragment any more is split, one left without prefixes dropped.
+ */
+static void lsp_ext_spans_family(struct isis_area *area, int level,
+				 uint8_t fi, size_t tlv_space,
+				 struct lsp_ext_spans *spans)
+{
+	struct isis_ext_frags *ext = &area->ext_frags[level - 1];
+	int family = fi ? AF_INET6 : AF_INET;
+	struct route_table *er_table = get_ext_reach(area, family, level);
+	struct route_node **nodes = NULL;
+	unsigned int count = 0, alloc = 0, first = spans->count;
+	unsigned int r = 0, i;
+	int cur = -1;
+
 	if (!er_table)
 		return;
 
@@ -929,63 +1141,157 @@ static void lsp_build_ext_reach_ipv6(struct isis_lsp *lsp,
 	     rn = srcdest_route_next(rn)) {
 		if (!rn->info)
 			continue;
-		struct isis_ext_info *info = rn->info;
-		struct prefix_ipv6 *p, *src_p;
+		if (count == alloc) {
+			alloc = MAX(alloc * 2, 256);
+			nodes = XREALLOC(MTYPE_TMP, nodes,
+					 alloc * sizeof(*nodes));
+		}
+		nodes[count++] = rn;
+	}
 
-		srcdest_rnode_prefixes(rn, (const struct prefix **)&p,
-				       (const struct prefix **)&src_p);
+	for (i = 0; i < count; i++) {
+		const struct prefix *key = lsp_ext_key(nodes[i]);
+		struct lsp_ext_span *span;
 
-		uint32_t metric = info->metric;
-		if (info->metric > MAX_WIDE_PATH_METRIC)
-			metric = MAX_WIDE_PATH_METRIC;
+		while (r + 1 < ext->count[fi] &&
+		       lsp_ext_cmp(&ext->ranges[fi][r + 1].start, key) <= 0)
+			r++;
 
-		if (!src_p || !src_p->prefixlen) {
-			struct sr_prefix_cfg *pcfg = NULL;
+		if (cur == (int)r && spans->count > first) {
+			spans->span[spans->count - 1].hi = i + 1;
+			continue;
+		}
+
+		span = lsp_ext_span_insert(spans, spans->count);
+		span->family_idx = fi;
+		span->lo = i;
+		span->hi = i + 1;
+		if (r < ext->count[fi]) {
+			prefix_copy(&span->start, &ext->ranges[fi][r].start);
+			span->frag = ext->ranges[fi][r].frag;
+		} else
+			prefix_copy(&span->start, key);
+		cur = r;
+	}
+
+	for (i = first; i < spans->count;) {
+		struct lsp_ext_span *span = &spans->span[i];
+		struct isis_tlvs *tlvs = isis_alloc_tlvs();
+		struct list *fragments;
 
-			if (area->srdb.enabled)
-				pcfg = isis_sr_cfg_prefix_find(area, p);
+		for (unsigned int j = span->lo; j < span->hi; j++)
+			lsp_add_ext_reach(tlvs, area, family, nodes[j]);
+		fragments = isis_fragment_tlvs(tlvs, tlv_space);
+		isis_free_tlvs(tlvs);
+
+		if (!fragments) {
+			i++;
+			continue;
+		}
 
-			isis_tlvs_add_ipv6_reach(lsp->tlvs,
-						 isis_area_ipv6_topology(area),
-						 p, metric, true, pcfg);
-		} else if (isis_area_ipv6_dstsrc_enabled(area)) {
-			isis_tlvs_add_ipv6_dstsrc_reach(lsp->tlvs,
-							ISIS_MT_IPV6_DSTSRC,
-							p, src_p, metric);
+		if (listcount(fragments) > 1 &&
+		    lsp_ext_split(spans, i, nodes, listcount(fragments))) {
+			lsp_free_fragments(&fragments);
+			continue;
 		}
+
+		span = &spans->span[i];
+		span->tlvs = listgetdata(listhead(fragments));
+		list_delete_node(fragments, listhead(fragments));
+		if (listcount(fragments))
+			zlog_warn("ISIS (%s): Too many source prefixes for %pFX to fit into a fragment",
+				  area->area_tag, lsp_ext_key(nodes[span->lo]));
+		lsp_free_fragments(&fragments);
+		i++;
 	}
-}
 
-static void lsp_build_ext_reach(struct isis_lsp *lsp, struct isis_area *area)
-{
-	lsp_build_ext_reach_ipv4(lsp, area);
-	lsp_build_ext_reach_ipv6(lsp, area);
+	XFREE(MTYPE_TMP, nodes);
 }
 
-static struct isis_lsp *lsp_next_frag(uint8_t frag_num, struct isis_lsp *lsp0,
-				      struct isis_area *area, int level)
+/*
+ * Put the redistributed prefixes into fragments of their own, from
+ * fragment first_frag on.  Ranges keep their fragment number, new ones take
+ * the lowest one free.
+ */
+static void lsp_build_ext_frags(struct isis_lsp *lsp0, struct isis_area *area,
+				size_t tlv_space, unsigned int first_frag)
 {
-	struct isis_lsp *lsp;
-	uint8_t frag_id[ISIS_SYS_ID_LEN + 2];
+	int level = lsp0->level;
+	struct isis_ext_frags *ext = &area->ext_frags[level - 1];
+	struct lsp_ext_spans spans = {};
+	bool used[256] = {}, overflow = false;
+	unsigned int i, next = first_frag;
 
-	memcpy(frag_id, lsp0->hdr.lsp_id, ISIS_SYS_ID_LEN + 1);
-	LSP_FRAGMENT(frag_id) = frag_num;
+	lsp_ext_spans_family(area, level, 0, tlv_space, &spans);
+	lsp_ext_spans_family(area, level, 1, tlv_space, &spans);
 
-	lsp = lsp_search(&area->lspdb[level - 1], frag_id);
-	if (lsp) {
-		lsp_clear_data(lsp);
-		if (!lsp->lspu.zero_lsp)
-			lsp_link_fragment(lsp, lsp0);
-		return lsp;
+	for (i = 0; i < spans.count; i++) {
+		struct lsp_ext_span *span = &spans.span[i];
+
+		if (span->frag < first_frag || used[span->frag])
+			span->frag = 0;
+		else
+			used[span->frag] = true;
 	}
 
-	lsp = lsp_new(area, frag_id, lsp0->hdr.rem_lifetime, 0,
-		      lsp_bits_generate(level, area->overload_bit,
-					area->attached_bit_send, area),
-		      0, lsp0, level);
-	lsp->own_lsp = 1;
-	lsp_insert(&area->lspdb[level - 1], lsp);
-	return lsp;
+	lsp_ext_frags_fini(ext);
+
+	for (i = 0; i < spans.count; i++) {
+		struct lsp_ext_span *span = &spans.span[i];
+		struct isis_ext_range *range;
+		struct isis_lsp *frag;
+		uint8_t fi = span->family_idx;
+
+		if (!span->tlvs)
+			continue;
+
+		if (!span->frag) {
+			while (next < array_size(used) && used[next])
+				next++;
+			if (next >= array_size(used)) {
+				if (!overflow) {
+					overflow = true;
+					zlog_warn("ISIS (%s): Too much information for 256 fragments",
+						  area->area_tag);
+				}
+				isis_free_tlvs(span->tlvs);
+				continue;
+			}
+			span->frag = next;
+			used[next] = true;
+		}
+
+		frag = lsp_next_frag(span->frag, lsp0, area, level);
+		lsp_adjust_stream(frag);
+		frag->tlvs = span->tlvs;
+
+		ext->ranges[fi] = XREALLOC(MTYPE_ISIS_EXT_FRAGS,
+					   ext->ranges[fi],
+					   (ext->count[fi] + 1) * sizeof(*range));
+		range = &ext->ranges[fi][ext->count[fi]++];
+		prefix_copy(&range->start, &span->start);
+		range->frag = span->frag;
+	}
+
+	XFREE(MTYPE_TMP, spans.span);
+}
+
+/* Room for TLVs in a fragment of lsp, without touching its current PDU. */
+static size_t lsp_tlv_space(struct isis_lsp *lsp)
+{
+	struct stream *pdu = lsp->pdu;
+	struct isis_lsp_hdr hdr = lsp->hdr;
+	size_t tlv_space;
+
+	lsp->pdu = stream_new(STREAM_SIZE(pdu));
+	lsp_pack_pdu(lsp);
+	tlv_space = STREAM_WRITEABLE(lsp->pdu) - LLC_LEN;
+	stream_free(lsp->pdu);
+	lsp->pdu = pdu;
+	lsp->hdr = hdr;
+	lsp_clear_data(lsp);
+
+	return tlv_space;
 }
 
 /*
@@ -1309,17 +1615,36 @@ static void lsp_build(struct isis_lsp *lsp, struct isis_area *area)
 		}
 	}
 
-	lsp_build_ext_reach(lsp, area);
-
 	struct isis_tlvs *tlvs = lsp->tlvs;
 	lsp->tlvs = NULL;
 
 	lsp_adjust_stream(lsp);
-	lsp_pack_pdu(lsp);
-	size_t tlv_space = STREAM_WRITEABLE(lsp->pdu) - LLC_LEN;
-	lsp_clear_data(lsp);
+	size_t tlv_space = lsp_tlv_space(lsp);
 
-	struct list *fragments = isis_fragment_tlvs(tlvs, tlv_space);
+	/*
+	 * As long as everything fits into one fragment, redistributed prefixes
+	 * are packed along with the rest.  Beyond that they go into fragments
+	 * of their own, see lsp_build_ext_frags().
+	 */
+	struct isis_ext_frags *ext = &area->ext_frags[level - 1];
+	struct list *fragments = NULL;
+
+	if (ext->count[0] + ext->count[1] <= 2) {
+		struct isis_tlvs *all = isis_copy_tlvs(tlvs);
+
+		lsp_build_ext_reach(all, area, level);
+		fragments = isis_fragment_tlvs(all, tlv_space);
+		isis_free_tlvs(all);
+		if (fragments && listcount(fragments) > 1)
+			lsp_free_fragments(&fragments);
+		else if (fragments)
+			lsp_ext_frags_fini(ext);
+	}
+
+	bool ext_frags = !fragments;
+
+	if (ext_frags)
+		fragments = isis_fragment_tlvs(tlvs, tlv_space);
 	if (!fragments) {
 		zlog_warn("BUG: could not fragment own LSP:");
 		log_multiline(LOG_WARNING, "    ", "%s",
@@ -1352,6 +1677,9 @@ static void lsp_build(struct isis_lsp *lsp, struct isis_area *area)
 	}
 
 	list_delete(&fragments);
+	if (ext_frags)
+		lsp_build_ext_frags(lsp, area, tlv_space,
+				    LSP_FRAGMENT(frag->hdr.lsp_id) + 1);
 	lsp_debug("ISIS (%s): LSP construction is complete. Serializing...",
 		  area->area_tag);
 	return;
@@ -1445,7 +1773,62 @@ int lsp_generate(struct isis_area *area, int level)
 }
 
 /*
- * Search own LSPs, update holding time and flood
+ * Does the content just built for an own LSP differ from what it was last
+ * issued with?  Packed behind the current header, so that the same content
+ * gives the same HMAC-MD5 digest, too.
+ */
+static bool lsp_changed(struct isis_lsp *lsp)
+{
+	struct stream *pdu = lsp->pdu;
+	size_t len_pointer, from = ISIS_FIXED_HDR_LEN + ISIS_LSP_HDR_LEN - 1;
+	bool changed;
+
+	if (!lsp->hdr.seqno || !lsp->hdr.rem_lifetime || !lsp->tlvs ||
+	    stream_get_endp(pdu) < from)
+		return true;
+
+	lsp->pdu = stream_new(STREAM_SIZE(pdu));
+	lsp_add_auth(lsp);
+	put_lsp_hdr(lsp, &len_pointer, false);
+	isis_pack_tlvs(lsp->tlvs, lsp->pdu, len_pointer, false, true);
+
+	/* from the LSP bits on */
+	changed = stream_get_endp(lsp->pdu) != stream_get_endp(pdu) ||
+		  memcmp(STREAM_DATA(lsp->pdu) + from, STREAM_DATA(pdu) + from,
+			 stream_get_endp(pdu) - from);
+
+	stream_free(lsp->pdu);
+	lsp->pdu = pdu;
+	return changed;
+}
+
+/*
+ * Issue an own LSP fragment again if its content changed or its refresh
+ * comes due soon.  Returns the time until it has to be refreshed.
+ */
+static uint16_t lsp_regenerate_frag(struct isis_lsp *lsp, uint16_t rem_lifetime,
+				    uint16_t refresh_time, unsigned int *issued)
+{
+	uint16_t age = 0;
+
+	if (rem_lifetime > lsp->hdr.rem_lifetime)
+		age = rem_lifetime - lsp->hdr.rem_lifetime;
+
+	if (age < refresh_time - refresh_time / 4 && !lsp_changed(lsp))
+		return refresh_time - age;
+
+	lsp->hdr.rem_lifetime = rem_lifetime;
+	lsp->age_out = ZERO_AGE_LIFETIME;
+	lsp->last_generated = time(NULL);
+	lsp_flood(lsp, NULL);
+	lsp_inc_seqno(lsp, 0);
+	(*issued)++;
+
+	return refresh_time;
+}
+
+/*
+ * Search own LSPs, update holding time and flood those that changed
  */
 static int lsp_regenerate(struct isis_area *area, int level)
 {
@@ -1453,7 +1836,8 @@ static int lsp_regenerate(struct isis_area *area, int level)
 	struct isis_lsp *lsp, *frag;
 	struct listnode *node;
 	uint8_t lspid[ISIS_SYS_ID_LEN + 2];
-	uint16_t rem_lifetime, refresh_time;
+	uint16_t rem_lifetime, refresh_time, next_refresh;
+	unsigned int issued = 0;
 
 	if ((area == NULL) || (area->is_type & level) != level)
 		return ISIS_ERROR;
@@ -1474,42 +1858,45 @@ static int lsp_regenerate(struct isis_area *area, int level)
 	lsp_clear_data(lsp);
 	lsp_build(lsp, area);
 	rem_lifetime = lsp_rem_lifetime(area, level);
-	lsp->hdr.rem_lifetime = rem_lifetime;
-	lsp->last_generated = time(NULL);
-	lsp_flood(lsp, NULL);
+	refresh_time = lsp_refresh_time(lsp, rem_lifetime);
 	area->lsp_gen_count[level - 1]++;
+
+	/*
+	 * Only fragments whose content changed are issued again, and those
+	 * about to need a refresh anyway.  The others keep their sequence
+	 * number and age on until their own refresh.
+	 */
+	next_refresh = lsp_regenerate_frag(lsp, rem_lifetime, refresh_time,
+					   &issued);
+	lsp->last_generated = time(NULL);
 	for (ALL_LIST_ELEMENTS_RO(lsp->lspu.frags, node, frag)) {
 		if (!frag->tlvs) {
-			/* Updating and flooding should only affect fragments
-			 * carrying data
+			/* Purge should only be applied when the fragment has
+			 * non-zero remaining lifetime.
 			 */
+			if (frag->hdr.rem_lifetime)
+				lsp_purge(frag, level, NULL);
 			continue;
 		}
 
 		frag->hdr.lsp_bits =
 			lsp_bits_generate(level, area->overload_bit,
 					  area->attached_bit_send, area);
-		/* Set the lifetime values of all the fragments to the same
-		 * value,
-		 * so that no fragment expires before the lsp is refreshed.
-		 */
-		frag->hdr.rem_lifetime = rem_lifetime;
-		frag->age_out = ZERO_AGE_LIFETIME;
-		lsp_flood(frag, NULL);
+		next_refresh = MIN(next_refresh,
+				   lsp_regenerate_frag(frag, rem_lifetime,
+						       refresh_time, &issued));
 	}
-	lsp_seqno_update(lsp);
 
-	refresh_time = lsp_refresh_time(lsp, rem_lifetime);
 	event_add_timer(master, lsp_refresh, &area->lsp_refresh_arg[level - 1],
-			refresh_time, &area->t_lsp_refresh[level - 1]);
+			next_refresh, &area->t_lsp_refresh[level - 1]);
 	area->lsp_regenerate_pending[level - 1] = 0;
 
 	if (IS_DEBUG_UPDATE_PACKETS) {
 		zlog_debug(
-			"ISIS-Upd (%s): Refreshed our L%d LSP %s, len %hu, seq 0x%08x, cksum 0x%04hx, lifetime %hus refresh %hus",
+			"ISIS-Upd (%s): Refreshed our L%d LSP %s, len %hu, seq 0x%08x, cksum 0x%04hx, lifetime %hus refresh %hus, %u fragments issued",
 			area->area_tag, level, rawlspid_print(lsp->hdr.lsp_id),
 			lsp->hdr.pdu_len, lsp->hdr.seqno, lsp->hdr.checksum,
-			lsp->hdr.rem_lifetime, refresh_time);
+			lsp->hdr.rem_lifetime, next_refresh, issued);
 	}
 	sched_debug(
 		"ISIS (%s): Rebuilt L%d LSP. Set triggered regenerate to non-pending.",
@@ -2192,6 +2579,9 @@ void lsp_set_all_srmflags(struct isis_lsp *lsp, bool set)
 	if (!lsp->area)
 		return;
 
+	if (!set && !flags_any_set(lsp->SRMflags))
+		return;
+
 	struct list *circuit_list = lsp->area->circuit_list;
 	for (ALL_LIST_ELEMENTS_RO(circuit_list, node, circuit)) {
 		if (set) {
@@ -2367,8 +2757,8 @@ int isis_lsp_iterate_is_reach(struct isis_lsp *lsp, uint16_t mtid,
 		if (pseudo_lsp || mtid == ISIS_MT_IPV4_UNICAST)
 			te_neighs = &lsp->tlvs->extended_reach;
 		else
-			te_neighs =
-				isis_get_mt_items(&lsp->tlvs->mt_reach, mtid);
+			te_neighs = isis_lookup_mt_items(&lsp->tlvs->mt_reach,
+							 mtid);
 		if (te_neighs) {
 			head = te_neighs->head;
 			for (struct isis_extended_reach *reach =
@@ -2396,6 +2786,50 @@ int isis_lsp_iterate_is_reach(struct isis_lsp *lsp, uint16_t mtid,
 	return LSP_ITER_CONTINUE;
 }
 
+/*
+ * Same as isis_lsp_iterate_is_reach(), but walks the IS reachability TLVs in
+ * the received/generated PDU directly instead of the decoded TLV lists, the
+ * sub-TLVs are passed on packed.
+ */
+int isis_lsp_iterate_is_reach_raw(struct isis_lsp *lsp, uint16_t mtid,
+				  lsp_is_reach_raw_iter_cb cb, void *arg)
+{
+	const size_t offset = ISIS_FIXED_HDR_LEN + ISIS_LSP_HDR_LEN;
+	struct isis_lsp *frag;
+	struct listnode *node;
+	size_t len;
+
+	if (lsp->hdr.seqno == 0 || lsp->hdr.rem_lifetime == 0)
+		return LSP_ITER_CONTINUE;
+
+	if (LSP_PSEUDO_ID(lsp->hdr.lsp_id))
+		mtid = ISIS_MT_IPV4_UNICAST;
+
+	if (lsp->tlvs && lsp->pdu) {
+		len = MIN(stream_get_endp(lsp->pdu), lsp->hdr.pdu_len);
+		if (len > offset
+		    && isis_tlvs_iterate_is_reach_raw(STREAM_DATA(lsp->pdu)
+							      + offset,
+						      len - offset, mtid, cb,
+						      arg)
+			       == LSP_ITER_STOP)
+			return LSP_ITER_STOP;
+	}
+
+	/* Parse LSP fragments if it not a fragment itself. */
+	if (!LSP_FRAGMENT(lsp->hdr.lsp_id))
+		for (ALL_LIST_ELEMENTS_RO(lsp->lspu.frags, node, frag)) {
+			if (!frag->tlvs)
+				continue;
+
+			if (isis_lsp_iterate_is_reach_raw(frag, mtid, cb, arg)
+			    == LSP_ITER_STOP)
+				return LSP_ITER_STOP;
+		}
+
+	return LSP_ITER_CONTINUE;
+}
+
 void lsp_init(void)
 {
 	device_startup = true;
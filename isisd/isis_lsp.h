@@ -12,10 +12,29 @@
 #define _ZEBRA_ISIS_LSP_H
 
 #include "lib/typesafe.h"
+#include "prefix.h"
 #include "isisd/isis_pdu.h"
 
 PREDECL_RBTREE_UNIQ(lspdb);
 
+/*
+ * Once the own LSP of a level needs more than one fragment, redistributed
+ * prefixes get fragments of their own: each of them carries a range of
+ * prefixes, from its start up to the start of the next range.  Prefixes
+ * stay in their fragment across regenerations, so only fragments whose
+ * prefixes changed have to be flooded again.
+ */
+struct isis_ext_range {
+	struct prefix start;
+	uint8_t frag;
+};
+
+struct isis_ext_frags {
+	/* IPv4 and IPv6 ranges, sorted by start */
+	struct isis_ext_range *ranges[2];
+	unsigned int count[2];
+};
+
 struct isis;
 /* Structure for isis_lsp, this structure will only support the fixed
  * System ID (Currently 6) (atleast for now). In order to support more
@@ -31,6 +50,8 @@ struct isis_lsp {
 		struct isis_lsp *zero_lsp;
 	} lspu;
 	uint32_t SSNflags[ISIS_MAX_CIRCUITS];
+	/* circuits with this LSP on their TX queue, see isis_tx_queue.c */
+	uint32_t SRMflags[ISIS_MAX_CIRCUITS];
 	int level;     /* L1 or L2? */
 	int scheduled; /* scheduled for sending */
 	time_t installed;
@@ -66,6 +87,7 @@ int lsp_generate_pseudo(struct isis_circuit *circuit, int level);
 int lsp_regenerate_schedule_pseudo(struct isis_circuit *circuit, int level);
 
 bool isis_level2_adj_up(struct isis_area *area);
+void lsp_ext_frags_fini(struct isis_ext_frags *ext);
 
 struct isis_lsp *lsp_new(struct isis_area *area, uint8_t *lsp_id,
 			 uint16_t rem_lifetime, uint32_t seq_num,
@@ -139,10 +161,18 @@ typedef int (*lsp_is_reach_iter_cb)(const uint8_t *id, uint32_t metric,
 				    struct isis_ext_subtlvs *subtlvs,
 				    void *arg);
 
+/* Callback used by isis_lsp_iterate_is_reach_raw() function. */
+typedef int (*lsp_is_reach_raw_iter_cb)(const uint8_t *id, uint32_t metric,
+					bool oldmetric,
+					const uint8_t *subtlvs,
+					uint8_t subtlvs_len, void *arg);
+
 int isis_lsp_iterate_ip_reach(struct isis_lsp *lsp, int family, uint16_t mtid,
 			      lsp_ip_reach_iter_cb cb, void *arg);
 int isis_lsp_iterate_is_reach(struct isis_lsp *lsp, uint16_t mtid,
 			      lsp_is_reach_iter_cb cb, void *arg);
+int isis_lsp_iterate_is_reach_raw(struct isis_lsp *lsp, uint16_t mtid,
+				  lsp_is_reach_raw_iter_cb cb, void *arg);
 
 #define lsp_flood(lsp, circuit) \
 	_lsp_flood((lsp), (circuit), __func__, __FILE__, __LINE__)
@@ -47,6 +47,7 @@
 #include "isisd/fabricd.h"
 #include "isisd/isis_nb.h"
 #include "isisd/isis_ldp_sync.h"
+#include "isisd/isis_lfa_workers.h"
 
 /* Default configuration file name */
 #define ISISD_DEFAULT_CONFIG "isisd.conf"
@@ -74,6 +75,7 @@ struct zebra_privs_t isisd_privs = {
 /* isisd options */
 static const struct option longopts[] = {
 	{"int_num", required_argument, NULL, 'I'},
+	{"lfa-workers", required_argument, NULL, 'W'},
 	{0}};
 
 /* Master of threads. */
@@ -91,6 +93,7 @@ void sigusr1(void);
 static __attribute__((__noreturn__)) void terminate(int i)
 {
 	isis_terminate();
+	isis_lfa_workers_finish();
 	isis_sr_term();
 	isis_zebra_stop();
 	exit(i);
@@ -228,6 +231,7 @@ int main(int argc, char **argv, char **envp)
 {
 	int opt;
 	int instance = 1;
+	int lfa_workers = 0;
 
 #ifdef FABRICD
 	frr_preinit(&fabricd_di, argc, argv);
@@ -235,8 +239,9 @@ int main(int argc, char **argv, char **envp)
 	frr_preinit(&isisd_di, argc, argv);
 #endif
 	frr_opt_add(
-		"I:", longopts,
-		"  -I, --int_num      Set instance number (label-manager)\n");
+		"I:W:", longopts,
+		"  -I, --int_num      Set instance number (label-manager)\n"
+		"  -W, --lfa-workers  Number of pthreads computing LFA SPF trees\n");
 
 	/* Command line argument treatment. */
 	while (1) {
@@ -254,6 +259,16 @@ int main(int argc, char **argv, char **envp)
 				zlog_err("Instance %i out of range (1..%u)",
 					 instance, (unsigned short)-1);
 			break;
+		case 'W':
+			lfa_workers = atoi(optarg);
+			if (lfa_workers < 0 ||
+			    lfa_workers > (int)ISIS_LFA_WORKERS_MAX) {
+				fprintf(stderr,
+					"LFA workers %i out of range (0..%u)\n",
+					lfa_workers, ISIS_LFA_WORKERS_MAX);
+				exit(1);
+			}
+			break;
 		default:
 			frr_help_exit(1);
 		}
@@ -298,6 +313,7 @@ int main(int argc, char **argv, char **envp)
 	fabricd_init();
 
 	frr_config_fork();
+	isis_lfa_workers_set(lfa_workers);
 	frr_run(master);
 
 	/* Not reached. */
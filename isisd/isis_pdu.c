@@ -790,6 +790,25 @@ out:
 	return retval;
 }
 
+/*
+ * Set the SSN flag and note the LSP ID, so that the next PSNP on the circuit
+ * doesn't need to look at the LSPs before it.
+ */
+static void lsp_set_ssn(struct isis_lsp *lsp, struct isis_circuit *circuit)
+{
+	int level = lsp->level - 1;
+
+	ISIS_SET_FLAG(lsp->SSNflags, circuit);
+
+	if (!circuit->psnp_pending[level] ||
+	    memcmp(lsp->hdr.lsp_id, circuit->psnp_start[level],
+		   ISIS_SYS_ID_LEN + 2) < 0) {
+		memcpy(circuit->psnp_start[level], lsp->hdr.lsp_id,
+		       ISIS_SYS_ID_LEN + 2);
+		circuit->psnp_pending[level] = true;
+	}
+}
+
 static void lsp_flood_or_update(struct isis_lsp *lsp,
 				struct isis_circuit *circuit,
 				bool circuit_scoped)
@@ -1110,9 +1129,8 @@ dontcheckadj:
 						/* iv */
 						if (circuit->circ_type
 						    != CIRCUIT_T_BROADCAST)
-							ISIS_SET_FLAG(
-								lsp->SSNflags,
-								circuit);
+							lsp_set_ssn(lsp,
+								    circuit);
 					}
 				} /* 7.3.16.4 b) 2) */
 				else if (comp == LSP_EQUAL) {
@@ -1122,8 +1140,7 @@ dontcheckadj:
 					/* ii */
 					if (circuit->circ_type
 					    != CIRCUIT_T_BROADCAST)
-						ISIS_SET_FLAG(lsp->SSNflags,
-							      circuit);
+						lsp_set_ssn(lsp, circuit);
 				} /* 7.3.16.4 b) 3) */
 				else {
 					isis_tx_queue_add(circuit->tx_queue,
@@ -1203,7 +1220,7 @@ dontcheckadj:
 		} else if (comp == LSP_EQUAL) {
 			isis_tx_queue_del(circuit->tx_queue, lsp);
 			if (circuit->circ_type != CIRCUIT_T_BROADCAST)
-				ISIS_SET_FLAG(lsp->SSNflags, circuit);
+				lsp_set_ssn(lsp, circuit);
 		} else {
 			isis_tx_queue_add(circuit->tx_queue, lsp,
 					  TX_LSP_NORMAL);
@@ -1250,7 +1267,7 @@ dontcheckadj:
 
 			/* iv */
 			if (circuit->circ_type != CIRCUIT_T_BROADCAST)
-				ISIS_SET_FLAG(lsp->SSNflags, circuit);
+				lsp_set_ssn(lsp, circuit);
 			/* FIXME: v) */
 		}
 		/* 7.3.15.1 e) 2) LSP equal to the one in db */
@@ -1260,7 +1277,7 @@ dontcheckadj:
 				   circuit->area, level, false);
 			tlvs = NULL;
 			if (circuit->circ_type != CIRCUIT_T_BROADCAST)
-				ISIS_SET_FLAG(lsp->SSNflags, circuit);
+				lsp_set_ssn(lsp, circuit);
 		}
 		/* 7.3.15.1 e) 3) LSP older than the one in db */
 		else {
@@ -1500,7 +1517,7 @@ static int process_snp(uint8_t pdu_type, struct isis_circuit *circuit,
 					isis_tx_queue_add(circuit->tx_queue, lsp,
 							TX_LSP_NORMAL);
 				} else {
-					ISIS_SET_FLAG(lsp->SSNflags, circuit);
+					lsp_set_ssn(lsp, circuit);
 					/* if (circuit->circ_type !=
 					 * CIRCUIT_T_BROADCAST) */
 					isis_tx_queue_del(circuit->tx_queue, lsp);
@@ -1538,7 +1555,7 @@ static int process_snp(uint8_t pdu_type, struct isis_circuit *circuit,
 					   lsp);
 
 				lsp_set_all_srmflags(lsp, false);
-				ISIS_SET_FLAG(lsp->SSNflags, circuit);
+				lsp_set_ssn(lsp, circuit);
 				resync_needed = true;
 			}
 		}
@@ -2309,9 +2326,14 @@ static int send_psnp(int level, struct isis_circuit *circuit)
 	    && circuit->u.bc.is_dr[level - 1])
 		return ISIS_OK;
 
-	if (lspdb_count(&circuit->area->lspdb[level - 1]) == 0)
+	if (!circuit->psnp_pending[level - 1])
 		return ISIS_OK;
 
+	if (lspdb_count(&circuit->area->lspdb[level - 1]) == 0) {
+		circuit->psnp_pending[level - 1] = false;
+		return ISIS_OK;
+	}
+
 	if (!circuit->snd_stream)
 		return ISIS_ERROR;
 
@@ -2346,6 +2368,15 @@ static int send_psnp(int level, struct isis_circuit *circuit)
 	uint16_t num_lsps =
 		get_max_lsp_count(STREAM_WRITEABLE(circuit->snd_stream));
 
+	/* no SSN flags were set before psnp_start since the last PSNP */
+	struct lspdb_head *head = &circuit->area->lspdb[level - 1];
+	struct isis_lsp start = {};
+	struct isis_lsp *next;
+
+	memcpy(start.hdr.lsp_id, circuit->psnp_start[level - 1],
+	       ISIS_SYS_ID_LEN + 2);
+	next = lspdb_find_gteq(head, &start);
+
 	while (1) {
 		struct isis_lsp *lsp;
 
@@ -2353,15 +2384,17 @@ static int send_psnp(int level, struct isis_circuit *circuit)
 		if (CHECK_FLAG(passwd->snp_auth, SNP_AUTH_SEND))
 			isis_tlvs_add_auth(tlvs, passwd);
 
-		frr_each (lspdb, &circuit->area->lspdb[level - 1], lsp) {
-			if (ISIS_CHECK_FLAG(lsp->SSNflags, circuit))
-				isis_tlvs_add_lsp_entry(tlvs, lsp);
-
+		for (lsp = next; lsp; lsp = lspdb_next(head, lsp)) {
 			if (tlvs->lsp_entries.count == num_lsps)
 				break;
+
+			if (ISIS_CHECK_FLAG(lsp->SSNflags, circuit))
+				isis_tlvs_add_lsp_entry(tlvs, lsp);
 		}
+		next = lsp;
 
 		if (!tlvs->lsp_entries.count) {
+			circuit->psnp_pending[level - 1] = false;
 			isis_free_tlvs(tlvs);
 			return ISIS_OK;
 		}
@@ -2408,6 +2441,15 @@ static int send_psnp(int level, struct isis_circuit *circuit)
 		     entry = entry->next)
 			ISIS_CLEAR_FLAG(entry->lsp->SSNflags, circuit);
 		isis_free_tlvs(tlvs);
+
+		/* the packet went out, continue after its last entry */
+		if (next)
+			memcpy(circuit->psnp_start[level - 1], next->hdr.lsp_id,
+			       ISIS_SYS_ID_LEN + 2);
+		else {
+			circuit->psnp_pending[level - 1] = false;
+			return ISIS_OK;
+		}
 	}
 
 	return ISIS_OK;
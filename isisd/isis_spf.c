@@ -220,14 +220,25 @@ static struct isis_vertex *isis_vertex_new(struct isis_spftree *spftree,
 {
 	struct isis_vertex *vertex;
 
-	vertex = XCALLOC(MTYPE_ISIS_VERTEX, sizeof(struct isis_vertex));
+	vertex = spftree->vertex_pool;
+	if (vertex) {
+		struct list *adj_n = vertex->Adj_N;
+		struct list *parents = vertex->parents;
+
+		/* Recycle a vertex released by a previous run. */
+		spftree->vertex_pool = vertex->pool_next;
+		memset(vertex, 0, sizeof(struct isis_vertex));
+		vertex->Adj_N = adj_n;
+		vertex->parents = parents;
+	} else {
+		vertex = XCALLOC(MTYPE_ISIS_VERTEX, sizeof(struct isis_vertex));
+		vertex->Adj_N = list_new();
+		vertex->Adj_N->del = isis_vertex_adj_free;
+		vertex->parents = list_new();
+	}
 
 	isis_vertex_id_init(vertex, id, vtype);
 
-	vertex->Adj_N = list_new();
-	vertex->Adj_N->del = isis_vertex_adj_free;
-	vertex->parents = list_new();
-
 	if (CHECK_FLAG(spftree->flags, F_SPFTREE_HOPCOUNT_METRIC)) {
 		vertex->firsthops = hash_create(isis_vertex_queue_hash_key,
 						isis_vertex_queue_hash_cmp,
@@ -247,6 +258,54 @@ void isis_vertex_del(struct isis_vertex *vertex)
 	XFREE(MTYPE_ISIS_VERTEX, vertex);
 }
 
+/*
+ * Put a vertex that is no longer part of the SPT in the pool of the tree, so
+ * that the next run doesn't need to allocate it (and its lists) again.
+ */
+static void isis_vertex_release(struct isis_spftree *spftree,
+				struct isis_vertex *vertex)
+{
+	list_delete_all_node(vertex->Adj_N);
+	list_delete_all_node(vertex->parents);
+	hash_clean_and_free(&vertex->firsthops, NULL);
+
+	vertex->pool_next = spftree->vertex_pool;
+	spftree->vertex_pool = vertex;
+}
+
+/* Empty a vertex queue, releasing its vertices to the pool of the tree. */
+static void isis_vertex_queue_release(struct isis_spftree *spftree,
+				      struct isis_vertex_queue *queue)
+{
+	struct isis_vertex *vertex;
+	struct listnode *node;
+
+	hash_clean(queue->hash, NULL);
+
+	if (queue->insert_counter) {
+		while (0 == skiplist_first(queue->l.slist, NULL,
+					   (void **)&vertex)) {
+			isis_vertex_release(spftree, vertex);
+			skiplist_delete_first(queue->l.slist);
+		}
+		queue->insert_counter = 1;
+	} else {
+		for (ALL_LIST_ELEMENTS_RO(queue->l.list, node, vertex))
+			isis_vertex_release(spftree, vertex);
+		list_delete_all_node(queue->l.list);
+	}
+}
+
+static void isis_vertex_pool_free(struct isis_spftree *spftree)
+{
+	struct isis_vertex *vertex;
+
+	while ((vertex = spftree->vertex_pool)) {
+		spftree->vertex_pool = vertex->pool_next;
+		isis_vertex_del(vertex);
+	}
+}
+
 struct isis_vertex_adj *
 isis_vertex_adj_add(struct isis_spftree *spftree, struct isis_vertex *vertex,
 		    struct list *vadj_list, struct isis_spf_adj *sadj,
@@ -357,6 +416,8 @@ struct isis_spftree *isis_spftree_new(struct isis_area *area,
 	isis_rlfa_list_init(tree);
 	tree->lfa.remote.pc_spftrees = list_new();
 	tree->lfa.remote.pc_spftrees->del = (void (*)(void *))isis_spftree_del;
+	tree->lfa.spare_spftrees = list_new();
+	tree->lfa.spare_spftrees->del = (void (*)(void *))isis_spftree_del;
 	if (tree->type == SPF_TYPE_RLFA || tree->type == SPF_TYPE_TI_LFA) {
 		isis_spf_node_list_init(&tree->lfa.p_space);
 		isis_spf_node_list_init(&tree->lfa.q_space);
@@ -377,9 +438,11 @@ void isis_spftree_del(struct isis_spftree *spftree)
 		isis_spf_node_list_clear(&spftree->lfa.p_space);
 	}
 	isis_spf_node_list_clear(&spftree->adj_nodes);
+	list_delete(&spftree->lfa.spare_spftrees);
 	list_delete(&spftree->sadj_list);
 	isis_vertex_queue_free(&spftree->tents);
 	isis_vertex_queue_free(&spftree->paths);
+	isis_vertex_pool_free(spftree);
 	route_table_finish(spftree->route_table);
 	route_table_finish(spftree->route_table_backup);
 	spftree->route_table = NULL;
@@ -661,7 +724,7 @@ static void isis_spf_add_local(struct isis_spftree *spftree,
 		} else { /* vertex->d_N > cost */
 			/*         f) */
 			isis_vertex_queue_delete(&spftree->tents, vertex);
-			isis_vertex_del(vertex);
+			isis_vertex_release(spftree, vertex);
 		}
 	}
 
@@ -764,7 +827,7 @@ static void process_N(struct isis_spftree *spftree, enum vertextype vtype,
 			/*      4) */
 		} else {
 			isis_vertex_queue_delete(&spftree->tents, vertex);
-			isis_vertex_del(vertex);
+			isis_vertex_release(spftree, vertex);
 		}
 	}
 
@@ -836,7 +899,8 @@ lspfragloop:
 			   print_sys_hostname(lsp->hdr.lsp_id));
 #endif /* EXTREME_DEBUG */
 
-	if (no_overload) {
+	if (no_overload
+	    && !CHECK_FLAG(spftree->flags, F_SPFTREE_PREFIXES_ONLY)) {
 		if ((pseudo_lsp || spftree->mtid == ISIS_MT_IPV4_UNICAST)
 		    && spftree->area->oldmetric) {
 			struct isis_oldstyle_reach *r;
@@ -1238,8 +1302,8 @@ struct spf_adj_find_reverse_metric_args {
 
 static int spf_adj_find_reverse_metric_cb(const uint8_t *id, uint32_t metric,
 					  bool oldmetric,
-					  struct isis_ext_subtlvs *subtlvs,
-					  void *arg)
+					  const uint8_t *subtlvs,
+					  uint8_t subtlvs_len, void *arg)
 {
 	struct spf_adj_find_reverse_metric_args *args = arg;
 
@@ -1290,9 +1354,9 @@ static void spf_adj_get_reverse_metrics(struct isis_spftree *spftree)
 			id_self = spftree->sysid;
 		args.id_self = id_self;
 		args.reverse_metric = UINT32_MAX;
-		isis_lsp_iterate_is_reach(lsp_adj, spftree->mtid,
-					  spf_adj_find_reverse_metric_cb,
-					  &args);
+		isis_lsp_iterate_is_reach_raw(lsp_adj, spftree->mtid,
+					      spf_adj_find_reverse_metric_cb,
+					      &args);
 		if (args.reverse_metric == UINT32_MAX) {
 			/* Delete one-way adjacency. */
 			listnode_delete(spftree->sadj_list, sadj);
@@ -1414,8 +1478,8 @@ static void spf_adj_list_parse_lsp(struct isis_spftree *spftree,
 		if (pseudo_lsp || spftree->mtid == ISIS_MT_IPV4_UNICAST)
 			te_neighs = &lsp->tlvs->extended_reach;
 		else
-			te_neighs = isis_get_mt_items(&lsp->tlvs->mt_reach,
-						      spftree->mtid);
+			te_neighs = isis_lookup_mt_items(&lsp->tlvs->mt_reach,
+							 spftree->mtid);
 		if (te_neighs) {
 			head = te_neighs->head;
 			for (struct isis_extended_reach *reach =
@@ -1488,10 +1552,11 @@ static void init_spt(struct isis_spftree *spftree, int mtid)
 {
 	/* Clear data from previous run. */
 	hash_clean(spftree->prefix_sids, NULL);
+	isis_lfa_spftrees_stash(spftree);
 	isis_spf_node_list_clear(&spftree->adj_nodes);
 	list_delete_all_node(spftree->sadj_list);
-	isis_vertex_queue_clear(&spftree->tents);
-	isis_vertex_queue_clear(&spftree->paths);
+	isis_vertex_queue_release(spftree, &spftree->tents);
+	isis_vertex_queue_release(spftree, &spftree->paths);
 	isis_zebra_rlfa_unregister_all(spftree);
 	isis_rlfa_list_clear(spftree);
 	list_delete_all_node(spftree->lfa.remote.pc_spftrees);
@@ -1638,12 +1703,41 @@ static void spf_path_process(struct isis_spftree *spftree,
 	}
 }
 
+/* Generate routes once the SPT is formed. */
+static void isis_spf_build_routes(struct isis_spftree *spftree)
+{
+	struct isis_vertex *vertex;
+	struct listnode *node;
+
+	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
+		/* New-style TLVs take precedence over the old-style TLVs. */
+		switch (vertex->type) {
+		case VTYPE_IPREACH_INTERNAL:
+		case VTYPE_IPREACH_EXTERNAL:
+			if (isis_find_vertex(&spftree->paths, &vertex->N,
+					     VTYPE_IPREACH_TE))
+				continue;
+			break;
+		case VTYPE_PSEUDO_IS:
+		case VTYPE_PSEUDO_TE_IS:
+		case VTYPE_NONPSEUDO_IS:
+		case VTYPE_NONPSEUDO_TE_IS:
+		case VTYPE_ES:
+		case VTYPE_IPREACH_TE:
+		case VTYPE_IP6REACH_INTERNAL:
+		case VTYPE_IP6REACH_EXTERNAL:
+			break;
+		}
+
+		spf_path_process(spftree, vertex);
+	}
+}
+
 static void isis_spf_loop(struct isis_spftree *spftree,
 			  uint8_t *root_sysid)
 {
 	struct isis_vertex *vertex;
 	struct isis_lsp *lsp;
-	struct listnode *node;
 
 	while (isis_vertex_queue_count(&spftree->tents)) {
 		vertex = isis_vertex_queue_pop(&spftree->tents);
@@ -1673,29 +1767,7 @@ static void isis_spf_loop(struct isis_spftree *spftree,
 				     root_sysid, vertex);
 	}
 
-	/* Generate routes once the SPT is formed. */
-	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
-		/* New-style TLVs take precedence over the old-style TLVs. */
-		switch (vertex->type) {
-		case VTYPE_IPREACH_INTERNAL:
-		case VTYPE_IPREACH_EXTERNAL:
-			if (isis_find_vertex(&spftree->paths, &vertex->N,
-					     VTYPE_IPREACH_TE))
-				continue;
-			break;
-		case VTYPE_PSEUDO_IS:
-		case VTYPE_PSEUDO_TE_IS:
-		case VTYPE_NONPSEUDO_IS:
-		case VTYPE_NONPSEUDO_TE_IS:
-		case VTYPE_ES:
-		case VTYPE_IPREACH_TE:
-		case VTYPE_IP6REACH_INTERNAL:
-		case VTYPE_IP6REACH_EXTERNAL:
-			break;
-		}
-
-		spf_path_process(spftree, vertex);
-	}
+	isis_spf_build_routes(spftree);
 }
 
 struct isis_spftree *isis_run_hopcount_spf(struct isis_area *area,
@@ -1818,8 +1890,124 @@ static void isis_run_spf_with_protection(struct isis_area *area,
 		isis_spf_run_lfa(area, spftree);
 }
 
+/*
+ * Partial route calculation, used when only prefix information changed
+ * since the last run. The IS vertices of the SPT are still valid, so the
+ * prefix vertices are recomputed from the LSPs of the routers already in
+ * PATHS without running Dijkstra again. Returns false if the tree can't be
+ * reused.
+ */
+static bool isis_run_prc(struct isis_spftree *spftree)
+{
+	struct spf_preload_tent_ip_reach_args ip_reach_args;
+	struct isis_area *area = spftree->area;
+	struct isis_lsp *root_lsp, *lsp;
+	struct isis_vertex *root_vertex, *vertex;
+	struct listnode *node, *nnode;
+	struct isis_spf_adj *sadj;
+	struct timeval time_start;
+	struct timeval time_end;
+
+	if (!spftree->runcount
+	    || memcmp(spftree->sysid, area->isis->sysid, ISIS_SYS_ID_LEN)
+	    || !isis_vertex_queue_count(&spftree->paths))
+		return false;
+
+	root_lsp = isis_root_system_lsp(spftree->lspdb, spftree->sysid);
+	if (!root_lsp)
+		return false;
+
+	monotime(&time_start);
+
+	/* Drop the prefix vertices, the root always comes first in PATHS. */
+	hash_clean(spftree->prefix_sids, NULL);
+	isis_vertex_queue_release(spftree, &spftree->tents);
+	for (ALL_LIST_ELEMENTS(spftree->paths.l.list, node, nnode, vertex)) {
+		if (!VTYPE_IP(vertex->type))
+			continue;
+
+		hash_release(spftree->paths.hash, vertex);
+		list_delete_node(spftree->paths.l.list, node);
+		isis_vertex_release(spftree, vertex);
+	}
+	root_vertex = listgetdata(listhead(spftree->paths.l.list));
+
+	memset(&spftree->lfa.protection_counters, 0,
+	       sizeof(spftree->lfa.protection_counters));
+
+	SET_FLAG(spftree->flags, F_SPFTREE_PREFIXES_ONLY);
+
+	/* Local prefixes and pseudonode LSPs, as in isis_spf_preload_tent() */
+	ip_reach_args.spftree = spftree;
+	ip_reach_args.parent = root_vertex;
+	isis_lsp_iterate_ip_reach(root_lsp, spftree->family, spftree->mtid,
+				  isis_spf_preload_tent_ip_reach_cb,
+				  &ip_reach_args);
+	for (ALL_LIST_ELEMENTS_RO(spftree->sadj_list, node, sadj)) {
+		if (LSP_PSEUDO_ID(sadj->id) && sadj->lsp)
+			isis_spf_process_lsp(spftree, sadj->lsp, sadj->metric,
+					     0, spftree->sysid, root_vertex);
+	}
+
+	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
+		if (vertex == root_vertex || !VTYPE_IS(vertex->type))
+			continue;
+
+		lsp = lsp_for_vertex(spftree, vertex);
+		if (lsp)
+			isis_spf_process_lsp(spftree, lsp, vertex->d_N,
+					     vertex->depth, spftree->sysid,
+					     vertex);
+	}
+
+	UNSET_FLAG(spftree->flags, F_SPFTREE_PREFIXES_ONLY);
+
+	/* Only prefixes are left in TENT, they all go straight to PATHS. */
+	while (isis_vertex_queue_count(&spftree->tents))
+		add_to_paths(spftree, isis_vertex_queue_pop(&spftree->tents));
+
+	isis_spf_build_routes(spftree);
+
+	spftree->runcount++;
+	spftree->last_run_timestamp = time(NULL);
+	spftree->last_run_monotime = monotime(&time_end);
+	spftree->last_run_duration =
+		((time_end.tv_sec - time_start.tv_sec) * 1000000)
+		+ (time_end.tv_usec - time_start.tv_usec);
+
+	return true;
+}
+
+static void isis_run_spf_or_prc(struct isis_area *area,
+				struct isis_spftree *spftree, bool *prc)
+{
+	if (*prc && isis_run_prc(spftree))
+		return;
+
+	*prc = false;
+	isis_run_spf_with_protection(area, spftree);
+}
+
+/*
+ * Partial route calculation is only possible if no IS reachability changed
+ * since the last run and nothing but the forward SPT is needed.
+ */
+static bool isis_spf_prc_possible(struct isis_area *area, int level)
+{
+	if (fabricd || area->spf_topology_change[level - 1])
+		return false;
+
+	return !area->lfa_protected_links[level - 1]
+	       && !area->rlfa_protected_links[level - 1]
+	       && !area->tilfa_protected_links[level - 1];
+}
+
 void isis_spf_verify_routes(struct isis_area *area, struct isis_spftree **trees)
 {
+	/* routes and Prefix-SIDs that changed go to zebra in one write */
+	if (zclient)
+		zclient_batch_begin(zclient);
+
 	if (area->is_type == IS_LEVEL_1) {
 		isis_route_verify_table(area, trees[0]->route_table,
 					trees[0]->route_table_backup);
@@ -1832,6 +2020,9 @@ void isis_spf_verify_routes(struct isis_area *area, struct isis_spftree **trees)
 					trees[1]->route_table,
 					trees[1]->route_table_backup);
 	}
+
+	if (zclient)
+		(void)zclient_batch_end(zclient);
 }
 
 void isis_spf_invalidate_routes(struct isis_spftree *tree)
@@ -1859,6 +2050,10 @@ static void isis_run_spf_cb(struct event *thread)
 	struct isis_area *area = run->area;
 	int level = run->level;
 	int have_run = 0;
+	struct isis_spf_run_stats *stats;
+	struct timeval time_start;
+	uint64_t duration;
+	bool prc;
 
 	XFREE(MTYPE_ISIS_SPF_RUN, run);
 
@@ -1872,29 +2067,46 @@ static void isis_run_spf_cb(struct event *thread)
 	isis_area_delete_backup_adj_sids(area, level);
 	isis_area_invalidate_routes(area, level);
 
+	prc = isis_spf_prc_possible(area, level);
+	area->spf_topology_change[level - 1] = false;
+
 	if (IS_DEBUG_SPF_EVENTS)
-		zlog_debug("ISIS-SPF (%s) L%d SPF needed, periodic SPF",
-			   area->area_tag, level);
+		zlog_debug("ISIS-SPF (%s) L%d SPF needed, periodic SPF%s",
+			   area->area_tag, level,
+			   prc ? " (prefix changes only)" : "");
 
+	monotime(&time_start);
 	if (area->ip_circuits) {
-		isis_run_spf_with_protection(
-			area, area->spftree[SPFTREE_IPV4][level - 1]);
+		isis_run_spf_or_prc(area,
+				    area->spftree[SPFTREE_IPV4][level - 1],
+				    &prc);
 		have_run = 1;
 	}
 	if (area->ipv6_circuits) {
-		isis_run_spf_with_protection(
-			area, area->spftree[SPFTREE_IPV6][level - 1]);
+		isis_run_spf_or_prc(area,
+				    area->spftree[SPFTREE_IPV6][level - 1],
+				    &prc);
 		have_run = 1;
 	}
 	if (area->ipv6_circuits && isis_area_ipv6_dstsrc_enabled(area)) {
-		isis_run_spf_with_protection(
-			area, area->spftree[SPFTREE_DSTSRC][level - 1]);
+		isis_run_spf_or_prc(area,
+				    area->spftree[SPFTREE_DSTSRC][level - 1],
+				    &prc);
 		have_run = 1;
 	}
 
-	if (have_run)
+	if (have_run) {
 		area->spf_run_count[level]++;
 
+		duration = monotime_since(&time_start, NULL);
+		stats = &area->spf_run_stats[level - 1]
+					    [prc ? ISIS_SPF_RUN_PRC
+						 : ISIS_SPF_RUN_FULL];
+		stats->runs++;
+		stats->last_duration = duration;
+		stats->total_duration += duration;
+	}
+
 	isis_area_verify_routes(area);
 
 	/* walk all circuits and reset any spf specific flags */
@@ -1921,7 +2133,7 @@ void isis_spf_timer_free(void *run)
 	XFREE(MTYPE_ISIS_SPF_RUN, run);
 }
 
-int _isis_spf_schedule(struct isis_area *area, int level,
+int _isis_spf_schedule(struct isis_area *area, int level, bool prefix_only,
 		       const char *func, const char *file, int line)
 {
 	struct isis_spftree *spftree;
@@ -1944,6 +2156,13 @@ int _isis_spf_schedule(struct isis_area *area, int level,
 	assert(diff >= 0);
 	assert(area->is_type & level);
 
+	if (prefix_only)
+		area->spf_run_stats[level - 1][ISIS_SPF_RUN_PRC].triggers++;
+	else {
+		area->spf_run_stats[level - 1][ISIS_SPF_RUN_FULL].triggers++;
+		area->spf_topology_change[level - 1] = true;
+	}
+
 	if (IS_DEBUG_SPF_EVENTS) {
 		zlog_debug(
 			"ISIS-SPF (%s) L%d SPF schedule called, lastrun %ld sec ago Caller: %s %s:%d",
@@ -57,9 +57,13 @@ void spftree_area_del(struct isis_area *area);
 struct isis_lsp *isis_root_system_lsp(struct lspdb_head *lspdb,
 				      const uint8_t *sysid);
 #define isis_spf_schedule(area, level) \
-	_isis_spf_schedule((area), (level), __func__, \
+	_isis_spf_schedule((area), (level), false, __func__, \
 			   __FILE__, __LINE__)
-int _isis_spf_schedule(struct isis_area *area, int level,
+/* LSP change that didn't touch any IS reachability information */
+#define isis_spf_schedule_prefix(area, level) \
+	_isis_spf_schedule((area), (level), true, __func__, \
+			   __FILE__, __LINE__)
+int _isis_spf_schedule(struct isis_area *area, int level, bool prefix_only,
 		       const char *func, const char *file, int line);
 void isis_print_spftree(struct vty *vty, struct isis_spftree *spftree);
 void isis_print_routes(struct vty *vty, struct isis_spftree *spftree,
@@ -64,6 +64,7 @@ struct isis_vertex {
 	struct hash *firsthops; /* first two hops to neighbor */
 	uint64_t insert_counter;
 	uint8_t flags;
+	struct isis_vertex *pool_next; /* next vertex in the spare pool */
 };
 #define F_ISIS_VERTEX_LFA_PROTECTED	0x01
 
@@ -299,6 +300,7 @@ struct isis_spftree {
 	struct hash *prefix_sids; /* SR Prefix-SIDs. */
 	struct list *sadj_list;
 	struct isis_spf_nodes adj_nodes;
+	struct isis_vertex *vertex_pool; /* vertices kept from previous runs */
 	struct isis_area *area;    /* back pointer to area */
 	unsigned int runcount;     /* number of runs since uptime */
 	time_t last_run_timestamp; /* last run timestamp as wall time for display */
@@ -340,6 +342,9 @@ struct isis_spftree {
 			uint32_t max_metric;
 		} remote;
 
+		/* Neighbor and reverse SPTs kept for reuse by the next run. */
+		struct list *spare_spftrees;
+
 		/* Protection counters. */
 		struct {
 			uint32_t lfa[SPF_PREFIX_PRIO_MAX];
@@ -354,6 +359,7 @@ struct isis_spftree {
 #define F_SPFTREE_HOPCOUNT_METRIC 0x01
 #define F_SPFTREE_NO_ROUTES 0x02
 #define F_SPFTREE_NO_ADJACENCIES 0x04
+#define F_SPFTREE_PREFIXES_ONLY 0x08
 
 __attribute__((__unused__))
 static void isis_vertex_id_init(struct isis_vertex *vertex, const void *id,
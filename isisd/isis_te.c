@@ -531,8 +531,7 @@ static int isis_te_export(uint8_t type, void *link_state)
 		rc = ls_send_msg(zclient, &msg, NULL);
 		break;
 	case LS_MSG_TYPE_ATTRIBUTES:
-		ls_edge2msg(&msg, (struct ls_edge *)link_state);
-		rc = ls_send_msg(zclient, &msg, NULL);
+		rc = ls_send_edge(zclient, (struct ls_edge *)link_state, NULL);
 		break;
 	case LS_MSG_TYPE_PREFIX:
 		ls_subnet2msg(&msg, (struct ls_subnet *)link_state);
@@ -11,6 +11,7 @@
 #include <json-c/json_object.h>
 
 #ifdef CRYPTO_INTERNAL
+#include "hmac.h"
 #include "md5.h"
 #endif
 #include "memory.h"
@@ -4821,16 +4822,9 @@ static void update_auth_hmac_md5(struct isis_auth *auth, struct stream *s,
 		safe_auth_md5(s, &checksum, &rem_lifetime);
 
 	memset(STREAM_DATA(s) + auth->offset, 0, 16);
-#ifdef CRYPTO_OPENSSL
-	uint8_t *result = (uint8_t *)HMAC(EVP_md5(), auth->passwd,
-					  auth->plength, STREAM_DATA(s),
-					  stream_get_endp(s), NULL, NULL);
-
-	memcpy(digest, result, 16);
-#elif CRYPTO_INTERNAL
-	hmac_md5(STREAM_DATA(s), stream_get_endp(s), auth->passwd,
-		 auth->plength, digest);
-#endif
+	hmac_digest(hmac_key_lookup(KEYCHAIN_ALGO_MD5, auth->passwd,
+				    auth->plength, 0),
+		    STREAM_DATA(s), stream_get_endp(s), digest);
 	memcpy(auth->value, digest, 16);
 	memcpy(STREAM_DATA(s) + auth->offset, digest, 16);
 
@@ -5153,6 +5147,73 @@ int isis_unpack_tlvs(size_t avail_len, struct stream *stream,
 	return rv;
 }
 
+int isis_tlvs_iterate_is_reach_raw(const uint8_t *buf, size_t len,
+				   uint16_t mtid, isis_tlvs_is_reach_raw_cb cb,
+				   void *arg)
+{
+	size_t pos = 0;
+
+	while (pos + 2 <= len) {
+		uint8_t tlv_type = buf[pos];
+		uint8_t tlv_len = buf[pos + 1];
+		const uint8_t *v = buf + pos + 2;
+		size_t vpos = 0;
+		int rv;
+
+		if (pos + 2 + tlv_len > len)
+			return 0;
+		pos += 2 + tlv_len;
+
+		switch (tlv_type) {
+		case ISIS_TLV_OLDSTYLE_REACH:
+			if (mtid != ISIS_MT_IPV4_UNICAST)
+				break;
+
+			/* skip the virtual flag */
+			for (vpos = 1; vpos + 11 <= tlv_len; vpos += 11) {
+				/* default metric, 3 other metrics, IS ID */
+				rv = (*cb)(v + vpos + 4, v[vpos] & 0x3f, true,
+					   NULL, 0, arg);
+				if (rv)
+					return rv;
+			}
+			break;
+		case ISIS_TLV_EXTENDED_REACH:
+		case ISIS_TLV_MT_REACH:
+			if (tlv_type == ISIS_TLV_MT_REACH) {
+				if (tlv_len < 2 ||
+				    (((v[0] << 8) | v[1]) & ISIS_MT_MASK) !=
+					    mtid)
+					break;
+				vpos = 2;
+			} else if (mtid != ISIS_MT_IPV4_UNICAST)
+				break;
+
+			/* IS ID, 3 byte metric, sub-TLV length, sub-TLVs */
+			while (vpos + 11 <= tlv_len) {
+				uint32_t metric = (v[vpos + 7] << 16) |
+						  (v[vpos + 8] << 8) |
+						  v[vpos + 9];
+				uint8_t subtlvs_len = v[vpos + 10];
+
+				if (vpos + 11 + subtlvs_len > tlv_len)
+					break;
+
+				rv = (*cb)(v + vpos, metric, false,
+					   subtlvs_len ? v + vpos + 11 : NULL,
+					   subtlvs_len, arg);
+				if (rv)
+					return rv;
+
+				vpos += 11 + subtlvs_len;
+			}
+			break;
+		}
+	}
+
+	return 0;
+}
+
 #define TLV_OPS(_name_, _desc_)                                                \
 	static const struct tlv_ops tlv_##_name_##_ops = {                     \
 		.name = _desc_, .unpack = unpack_tlv_##_name_,                 \
@@ -5410,16 +5471,9 @@ static bool auth_validator_hmac_md5(struct isis_passwd *passwd,
 		safe_auth_md5(stream, &checksum, &rem_lifetime);
 
 	memset(STREAM_DATA(stream) + auth->offset, 0, 16);
-#ifdef CRYPTO_OPENSSL
-	uint8_t *result = (uint8_t *)HMAC(EVP_md5(), passwd->passwd,
-					  passwd->len, STREAM_DATA(stream),
-					  stream_get_endp(stream), NULL, NULL);
-
-	memcpy(digest, result, 16);
-#elif CRYPTO_INTERNAL
-	hmac_md5(STREAM_DATA(stream), stream_get_endp(stream), passwd->passwd,
-		 passwd->len, digest);
-#endif
+	hmac_digest(hmac_key_lookup(KEYCHAIN_ALGO_MD5, passwd->passwd,
+				    passwd->len, 0),
+		    STREAM_DATA(stream), stream_get_endp(stream), digest);
 	memcpy(STREAM_DATA(stream) + auth->offset, auth->value, 16);
 
 	bool rv = !memcmp(digest, auth->value, 16);
@@ -5487,6 +5541,92 @@ bool isis_tlvs_area_addresses_match(struct isis_tlvs *tlvs,
 	return false;
 }
 
+static bool oldstyle_reach_equal(const struct isis_item_list *a,
+				 const struct isis_item_list *b)
+{
+	struct isis_oldstyle_reach *ra, *rb;
+
+	if (a->count != b->count)
+		return false;
+
+	for (ra = (struct isis_oldstyle_reach *)a->head,
+	    rb = (struct isis_oldstyle_reach *)b->head;
+	     ra && rb; ra = ra->next, rb = rb->next) {
+		if (memcmp(ra->id, rb->id, sizeof(ra->id))
+		    || ra->metric != rb->metric)
+			return false;
+	}
+
+	return true;
+}
+
+static bool extended_reach_equal(const struct isis_item_list *a,
+				 const struct isis_item_list *b)
+{
+	struct isis_extended_reach *ra, *rb;
+
+	if (!a || !b)
+		return (a ? a->count : 0) == (b ? b->count : 0);
+
+	if (a->count != b->count)
+		return false;
+
+	for (ra = (struct isis_extended_reach *)a->head,
+	    rb = (struct isis_extended_reach *)b->head;
+	     ra && rb; ra = ra->next, rb = rb->next) {
+		if (memcmp(ra->id, rb->id, sizeof(ra->id))
+		    || ra->metric != rb->metric)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Check whether two instances of an LSP describe the same set of IS
+ * neighbors, i.e. whether the SPT can be affected by the change. Sub-TLVs
+ * of the IS reachability entries and everything prefix related are not
+ * taken into account.
+ */
+bool isis_tlvs_is_reach_equal(struct isis_tlvs *a, struct isis_tlvs *b)
+{
+	struct isis_mt_router_info *ia, *ib;
+	struct isis_item_list *n;
+
+	if (a->protocols_supported.count != b->protocols_supported.count
+	    || (a->protocols_supported.count
+		&& memcmp(a->protocols_supported.protocols,
+			  b->protocols_supported.protocols,
+			  a->protocols_supported.count)))
+		return false;
+
+	if (a->mt_router_info.count != b->mt_router_info.count)
+		return false;
+	for (ia = (struct isis_mt_router_info *)a->mt_router_info.head,
+	    ib = (struct isis_mt_router_info *)b->mt_router_info.head;
+	     ia && ib; ia = ia->next, ib = ib->next) {
+		if (ia->mtid != ib->mtid || ia->overload != ib->overload)
+			return false;
+	}
+
+	if (!oldstyle_reach_equal(&a->oldstyle_reach, &b->oldstyle_reach)
+	    || !extended_reach_equal(&a->extended_reach, &b->extended_reach))
+		return false;
+
+	RB_FOREACH (n, isis_mt_item_list, &a->mt_reach) {
+		if (!extended_reach_equal(
+			    n, isis_lookup_mt_items(&b->mt_reach, n->mtid)))
+			return false;
+	}
+	RB_FOREACH (n, isis_mt_item_list, &b->mt_reach) {
+		if (!extended_reach_equal(
+			    isis_lookup_mt_items(&a->mt_reach, n->mtid), n))
+			return false;
+	}
+
+	return true;
+}
+
 static void tlvs_area_addresses_to_adj(struct isis_tlvs *tlvs,
 				       struct isis_adjacency *adj,
 				       bool *changed)
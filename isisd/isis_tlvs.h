@@ -523,6 +523,22 @@ const char *isis_format_tlvs(struct isis_tlvs *tlvs, struct json_object *json);
 struct isis_tlvs *isis_copy_tlvs(struct isis_tlvs *tlvs);
 struct list *isis_fragment_tlvs(struct isis_tlvs *tlvs, size_t size);
 
+/*
+ * Zero-copy view of the IS reachability (TLVs 2, 22 and 222) in packed LSP
+ * TLVs. The callback is called in the same order as the items appear in the
+ * decoded extended_reach/mt_reach lists, with the sub-TLVs left packed
+ * (NULL if there are none). A non-zero return value from the callback stops
+ * the iteration and is returned. The data is expected to have been validated
+ * by isis_unpack_tlvs() before, malformed TLVs end the iteration silently.
+ */
+typedef int (*isis_tlvs_is_reach_raw_cb)(const uint8_t *id, uint32_t metric,
+					 bool oldmetric,
+					 const uint8_t *subtlvs,
+					 uint8_t subtlvs_len, void *arg);
+int isis_tlvs_iterate_is_reach_raw(const uint8_t *buf, size_t len,
+				   uint16_t mtid, isis_tlvs_is_reach_raw_cb cb,
+				   void *arg);
+
 #define ISIS_EXTENDED_IP_REACH_DOWN 0x80
 #define ISIS_EXTENDED_IP_REACH_SUBTLV 0x40
 
@@ -554,6 +570,7 @@ void isis_tlvs_add_global_ipv6_addresses(struct isis_tlvs *tlvs,
 					 struct list *addresses);
 int isis_tlvs_auth_is_valid(struct isis_tlvs *tlvs, struct isis_passwd *passwd,
 			    struct stream *stream, bool is_lsp);
+bool isis_tlvs_is_reach_equal(struct isis_tlvs *a, struct isis_tlvs *b);
 bool isis_tlvs_area_addresses_match(struct isis_tlvs *tlvs,
 				    struct list *addresses);
 struct isis_adjacency;
@@ -10,6 +10,7 @@
 
 #include "hash.h"
 #include "jhash.h"
+#include "wheel.h"
 
 #include "isisd/isisd.h"
 #include "isisd/isis_flags.h"
@@ -21,11 +22,20 @@
 DEFINE_MTYPE_STATIC(ISISD, TX_QUEUE, "ISIS TX Queue");
 DEFINE_MTYPE_STATIC(ISISD, TX_QUEUE_ENTRY, "ISIS TX Queue Entry");
 
+/*
+ * LSPs are retransmitted every TX_QUEUE_RETRY_MSEC until they are removed
+ * from the queue. Rather than one timer per queued LSP, entries sit on a
+ * per-circuit timer wheel once they were sent for the first time.
+ */
+#define TX_QUEUE_RETRY_MSEC 5000
+#define TX_QUEUE_WHEEL_SLOTS 50
+
 struct isis_tx_queue {
 	struct isis_circuit *circuit;
 	void (*send_event)(struct isis_circuit *circuit,
 			   struct isis_lsp *, enum isis_tx_type);
 	struct hash *hash;
+	struct timer_wheel *wheel;
 };
 
 struct isis_tx_queue_entry {
@@ -34,6 +44,9 @@ struct isis_tx_queue_entry {
 	bool is_retry;
 	struct event *retry;
 	struct isis_tx_queue *queue;
+	/* slot of the retransmit wheel, if on_wheel */
+	unsigned int slot;
+	bool on_wheel;
 };
 
 static unsigned tx_queue_hash_key(const void *p)
@@ -60,6 +73,57 @@ static bool tx_queue_hash_cmp(const void *a, const void *b)
 	return true;
 }
 
+static void tx_queue_send_event(struct event *thread);
+
+static unsigned int tx_queue_slot_key(const void *p)
+{
+	const struct isis_tx_queue_entry *e = p;
+
+	return e->slot;
+}
+
+/* the entry is due for retransmission */
+static void tx_queue_slot_run(void *p)
+{
+	struct isis_tx_queue_entry *e = p;
+
+	/* don't send from the wheel, it might remove other entries */
+	event_add_event(master, tx_queue_send_event, e, 0, &e->retry);
+}
+
+/*
+ * Put the entry on the slot the wheel will reach TX_QUEUE_RETRY_MSEC from
+ * now. It then stays there, and is run once per revolution of the wheel.
+ */
+static void tx_queue_wheel_add(struct isis_tx_queue_entry *e)
+{
+	struct timer_wheel *wheel = e->queue->wheel;
+	unsigned long remain = 0;
+	unsigned int ticks = 0;
+
+	if (wheel->timer)
+		remain = event_timer_remain_msec(wheel->timer);
+	if (remain < TX_QUEUE_RETRY_MSEC)
+		ticks = (TX_QUEUE_RETRY_MSEC - remain + wheel->nexttime - 1) /
+			wheel->nexttime;
+	if (ticks >= (unsigned int)wheel->slots)
+		ticks = wheel->slots - 1;
+
+	e->slot = (wheel->curr_slot + wheel->slots_to_skip + ticks) %
+		  wheel->slots;
+	e->on_wheel = true;
+	wheel_add_item(wheel, e);
+}
+
+static void tx_queue_wheel_del(struct isis_tx_queue_entry *e)
+{
+	if (!e->on_wheel)
+		return;
+
+	wheel_remove_item(e->queue->wheel, e);
+	e->on_wheel = false;
+}
+
 struct isis_tx_queue *isis_tx_queue_new(
 		struct isis_circuit *circuit,
 		void(*send_event)(struct isis_circuit *circuit,
@@ -72,6 +136,9 @@ struct isis_tx_queue *isis_tx_queue_new(
 	rv->send_event = send_event;
 
 	rv->hash = hash_create(tx_queue_hash_key, tx_queue_hash_cmp, NULL);
+	rv->wheel = wheel_init(master, TX_QUEUE_RETRY_MSEC,
+			       TX_QUEUE_WHEEL_SLOTS, tx_queue_slot_key,
+			       tx_queue_slot_run, "IS-IS LSP retransmit");
 	return rv;
 }
 
@@ -80,6 +147,8 @@ static void tx_queue_element_free(void *element)
 	struct isis_tx_queue_entry *e = element;
 
 	EVENT_OFF(e->retry);
+	tx_queue_wheel_del(e);
+	ISIS_CLEAR_FLAG(e->lsp->SRMflags, e->queue->circuit);
 
 	XFREE(MTYPE_TX_QUEUE_ENTRY, e);
 }
@@ -87,6 +156,7 @@ static void tx_queue_element_free(void *element)
 void isis_tx_queue_free(struct isis_tx_queue *queue)
 {
 	hash_clean_and_free(&queue->hash, tx_queue_element_free);
+	wheel_delete(queue->wheel);
 	XFREE(MTYPE_TX_QUEUE, queue);
 }
 
@@ -97,6 +167,10 @@ static struct isis_tx_queue_entry *tx_queue_find(struct isis_tx_queue *queue,
 		.lsp = lsp
 	};
 
+	/* the SRM flag tells whether there is an entry at all */
+	if (!ISIS_CHECK_FLAG(lsp->SRMflags, queue->circuit))
+		return NULL;
+
 	return hash_lookup(queue->hash, &e);
 }
 
@@ -105,7 +179,8 @@ static void tx_queue_send_event(struct event *thread)
 	struct isis_tx_queue_entry *e = EVENT_ARG(thread);
 	struct isis_tx_queue *queue = e->queue;
 
-	event_add_timer(master, tx_queue_send_event, e, 5, &e->retry);
+	if (!e->on_wheel)
+		tx_queue_wheel_add(e);
 
 	if (e->is_retry)
 		queue->circuit->area->lsp_rxmt_count++;
@@ -143,11 +218,14 @@ void _isis_tx_queue_add(struct isis_tx_queue *queue,
 		struct isis_tx_queue_entry *inserted;
 		inserted = hash_get(queue->hash, e, hash_alloc_intern);
 		assert(inserted == e);
+		ISIS_SET_FLAG(lsp->SRMflags, queue->circuit);
 	}
 
 	e->type = type;
 
+	/* send right away, and restart the retransmit interval after that */
 	EVENT_OFF(e->retry);
+	tx_queue_wheel_del(e);
 	event_add_event(master, tx_queue_send_event, e, 0, &e->retry);
 
 	e->is_retry = false;
@@ -170,10 +248,8 @@ void _isis_tx_queue_del(struct isis_tx_queue *queue, struct isis_lsp *lsp,
 			   func, file, line);
 	}
 
-	EVENT_OFF(e->retry);
-
 	hash_release(queue->hash, e);
-	XFREE(MTYPE_TX_QUEUE_ENTRY, e);
+	tx_queue_element_free(e);
 }
 
 unsigned long isis_tx_queue_len(struct isis_tx_queue *queue)
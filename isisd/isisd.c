@@ -507,6 +507,8 @@ void isis_area_destroy(struct isis_area *area)
 
 	lsp_db_fini(&area->lspdb[0]);
 	lsp_db_fini(&area->lspdb[1]);
+	lsp_ext_frags_fini(&area->ext_frags[0]);
+	lsp_ext_frags_fini(&area->ext_frags[1]);
 
 	/* invalidate and verify to delete all routes from zebra */
 	isis_area_invalidate_routes(area, area->is_type);
@@ -2268,6 +2270,23 @@ static void isis_spf_ietf_common(struct vty *vty, struct isis *isis)
 			} else {
 				vty_out(vty, "    Using legacy backoff algo\n");
 			}
+
+			for (int type = ISIS_SPF_RUN_FULL;
+			     type < ISIS_SPF_RUN_MAX; type++) {
+				struct isis_spf_run_stats *stats =
+					&area->spf_run_stats[level - 1][type];
+
+				vty_out(vty,
+					"    %s: %" PRIu64 " triggers, %" PRIu64
+					" runs, last %" PRIu64
+					" usec, total %" PRIu64 " usec\n",
+					type == ISIS_SPF_RUN_FULL
+						? "Full SPF"
+						: "Prefix-only (PRC)",
+					stats->triggers, stats->runs,
+					stats->last_duration,
+					stats->total_duration);
+			}
 		}
 	}
 }
@@ -92,7 +92,7 @@ struct isis {
 	struct event *t_dync_clean; /* dynamic hostname cache cleanup thread */
 	uint32_t circuit_ids_used[8];     /* 256 bits to track circuit ids 1 through 255 */
 	int snmp_notifications;
-	struct list *dyn_cache;
+	struct isis_dynhn_cache *dyn_cache;
 
 	struct route_table *ext_info[REDIST_PROTOCOL_COUNT];
 };
@@ -113,6 +113,20 @@ struct lsp_refresh_arg {
 	int level;
 };
 
+/* full SPF vs. partial route calculation for prefix-only changes */
+enum isis_spf_run_type {
+	ISIS_SPF_RUN_FULL = 0,
+	ISIS_SPF_RUN_PRC,
+	ISIS_SPF_RUN_MAX,
+};
+
+struct isis_spf_run_stats {
+	uint64_t triggers;
+	uint64_t runs;
+	uint64_t last_duration; /* usec */
+	uint64_t total_duration; /* usec */
+};
+
 /* for yang configuration */
 enum isis_metric_style {
 	ISIS_NARROW_METRIC = 0,
@@ -123,6 +137,7 @@ enum isis_metric_style {
 struct isis_area {
 	struct isis *isis;			       /* back pointer */
 	struct lspdb_head lspdb[ISIS_LEVELS];	       /* link-state dbs */
+	struct isis_ext_frags ext_frags[ISIS_LEVELS];  /* see isis_lsp.h */
 	struct isis_spftree *spftree[SPFTREE_COUNT][ISIS_LEVELS];
 #define DEFAULT_LSP_MTU 1497
 	unsigned int lsp_mtu;      /* Size of LSPs to generate */
@@ -227,6 +242,9 @@ struct isis_area {
 							    SPF algo
 							    parameters*/
 	struct event *spf_timer[ISIS_LEVELS];
+	/* set when an IS neighbor changed since the last SPF run */
+	bool spf_topology_change[ISIS_LEVELS];
+	struct isis_spf_run_stats spf_run_stats[ISIS_LEVELS][ISIS_SPF_RUN_MAX];
 
 	struct lsp_refresh_arg lsp_refresh_arg[ISIS_LEVELS];
 
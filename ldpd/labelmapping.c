@@ -444,8 +444,7 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 			break;
 		}
 
-		ldpe_imsg_compose_lde(imsg_type, nbr->peerid, 0, &me->map,
-		    sizeof(struct map));
+		ldpe_imsg_compose_map(imsg_type, nbr->peerid, &me->map);
 
  next:
 		TAILQ_REMOVE(&mh, me, entry);
@@ -38,6 +38,8 @@ static struct lde_nbr	*lde_nbr_new(uint32_t, struct lde_nbr *);
 static void		 lde_nbr_del(struct lde_nbr *);
 static struct lde_nbr	*lde_nbr_find(uint32_t);
 static void		 lde_nbr_clear(void);
+static void		 lde_imsg_compose_map(int, uint32_t, struct map *);
+static void		 lde_map_batch_flush(void);
 static void		 lde_nbr_addr_update(struct lde_nbr *,
 			    struct lde_addr *, int);
 static __inline int	 lde_map_compare(const struct lde_map *,
@@ -63,6 +65,12 @@ struct ldpd_conf	*ldeconf;
 struct nbr_tree		 lde_nbrs = RB_INITIALIZER(&lde_nbrs);
 
 static struct imsgev	*iev_ldpe;
+
+/* label messages for ldpe not sent yet, see lde_imsg_compose_map() */
+static struct map	 map_batch[MAP_BATCH_MAX];
+static uint16_t		 map_batch_count;
+static int		 map_batch_type;
+static uint32_t		 map_batch_peerid;
 static struct imsgev    iev_main_sync_data;
 static struct imsgev	*iev_main, *iev_main_sync;
 
@@ -225,12 +233,48 @@ int
 lde_imsg_compose_ldpe(int type, uint32_t peerid, pid_t pid, void *data,
     uint16_t datalen)
 {
+	/* keep the ordering of everything sent to ldpe */
+	lde_map_batch_flush();
+
 	if (iev_ldpe->ibuf.fd == -1)
 		return (0);
 	return (imsg_compose_event(iev_ldpe, type, peerid, pid,
 	     -1, data, datalen));
 }
 
+static void
+lde_map_batch_flush(void)
+{
+	uint16_t	 count = map_batch_count;
+
+	if (count == 0)
+		return;
+	map_batch_count = 0;
+
+	if (iev_ldpe->ibuf.fd == -1)
+		return;
+	imsg_compose_event(iev_ldpe, map_batch_type, map_batch_peerid, 0, -1,
+	    map_batch, count * sizeof(struct map));
+}
+
+/*
+ * Queue a label mapping, withdraw, release or request for ldpe.  Consecutive
+ * ones of the same type for the same neighbor go out as a single imsg, which
+ * ldpe unpacks into the neighbor's list; they are turned into LDP messages on
+ * the matching *_ADD_END message, which flushes the batch.
+ */
+static void
+lde_imsg_compose_map(int type, uint32_t peerid, struct map *map)
+{
+	if (map_batch_count && (map_batch_type != type ||
+	    map_batch_peerid != peerid || map_batch_count == MAP_BATCH_MAX))
+		lde_map_batch_flush();
+
+	map_batch_type = type;
+	map_batch_peerid = peerid;
+	map_batch[map_batch_count++] = *map;
+}
+
 /* ARGSUSED */
 static void lde_dispatch_imsg(struct event *thread)
 {
@@ -242,6 +286,7 @@ static void lde_dispatch_imsg(struct event *thread)
 	struct lde_addr		*lde_addr;
 	struct notify_msg	*nm;
 	ssize_t			 n;
+	size_t			 len;
 	int			 shut = 0;
 
 	iev->ev_read = NULL;
@@ -272,9 +317,9 @@ static void lde_dispatch_imsg(struct event *thread)
 		case IMSG_LABEL_RELEASE:
 		case IMSG_LABEL_WITHDRAW:
 		case IMSG_LABEL_ABORT:
-			if (imsg.hdr.len - IMSG_HEADER_SIZE != sizeof(struct map))
+			len = imsg.hdr.len - IMSG_HEADER_SIZE;
+			if (len == 0 || len % sizeof(struct map))
 				fatalx("lde_dispatch_imsg: wrong imsg len");
-			map = imsg.data;
 
 			ln = lde_nbr_find(imsg.hdr.peerid);
 			if (ln == NULL) {
@@ -282,22 +327,25 @@ static void lde_dispatch_imsg(struct event *thread)
 				break;
 			}
 
-			switch (imsg.hdr.type) {
-			case IMSG_LABEL_MAPPING:
-				lde_check_mapping(map, ln, 1);
-				break;
-			case IMSG_LABEL_REQUEST:
-				lde_check_request(map, ln);
-				break;
-			case IMSG_LABEL_RELEASE:
-				lde_check_release(map, ln);
-				break;
-			case IMSG_LABEL_WITHDRAW:
-				lde_check_withdraw(map, ln);
-				break;
-			case IMSG_LABEL_ABORT:
-				/* not necessary */
-				break;
+			for (map = imsg.data; len; map++,
+			    len -= sizeof(struct map)) {
+				switch (imsg.hdr.type) {
+				case IMSG_LABEL_MAPPING:
+					lde_check_mapping(map, ln, 1);
+					break;
+				case IMSG_LABEL_REQUEST:
+					lde_check_request(map, ln);
+					break;
+				case IMSG_LABEL_RELEASE:
+					lde_check_release(map, ln);
+					break;
+				case IMSG_LABEL_WITHDRAW:
+					lde_check_withdraw(map, ln);
+					break;
+				case IMSG_LABEL_ABORT:
+					/* not necessary */
+					break;
+				}
 			}
 			break;
 		case IMSG_ADDRESS_ADD:
@@ -1098,8 +1146,7 @@ lde_send_labelmapping(struct lde_nbr *ln, struct fec_node *fn, int single)
 	}
 
 	/* SL.4: send label mapping */
-	lde_imsg_compose_ldpe(IMSG_MAPPING_ADD, ln->peerid, 0,
-	    &map, sizeof(map));
+	lde_imsg_compose_map(IMSG_MAPPING_ADD, ln->peerid, &map);
 	if (single)
 		lde_imsg_compose_ldpe(IMSG_MAPPING_ADD_END, ln->peerid, 0,
 		    NULL, 0);
@@ -1153,8 +1200,7 @@ lde_send_labelwithdraw(struct lde_nbr *ln, struct fec_node *fn,
 	}
 
 	/* SWd.1: send label withdraw. */
-	lde_imsg_compose_ldpe(IMSG_WITHDRAW_ADD, ln->peerid, 0,
- 	    &map, sizeof(map));
+	lde_imsg_compose_map(IMSG_WITHDRAW_ADD, ln->peerid, &map);
 	lde_imsg_compose_ldpe(IMSG_WITHDRAW_ADD_END, ln->peerid, 0, NULL, 0);
 
 	/* SWd.2: record label withdraw. */
@@ -1267,8 +1313,7 @@ lde_send_labelrelease(struct lde_nbr *ln, struct fec_node *fn,
 		memcpy(&map, wcard, sizeof(map));
 	map.label = label;
 
-	lde_imsg_compose_ldpe(IMSG_RELEASE_ADD, ln->peerid, 0,
-	    &map, sizeof(map));
+	lde_imsg_compose_map(IMSG_RELEASE_ADD, ln->peerid, &map);
 	lde_imsg_compose_ldpe(IMSG_RELEASE_ADD_END, ln->peerid, 0, NULL, 0);
 }
 
@@ -1306,8 +1351,8 @@ lde_send_labelrequest(struct lde_nbr *ln, struct fec_node *fn,
 		lre = (struct  lde_req *)fec_find(&ln->sent_req, &fn->fec);
 		if (lre == NULL) {
 			/* SLRq.3: send label request */
-			lde_imsg_compose_ldpe(IMSG_REQUEST_ADD, ln->peerid, 0,
-			    &map, sizeof(map));
+			lde_imsg_compose_map(IMSG_REQUEST_ADD, ln->peerid,
+			    &map);
 			if (single)
 				lde_imsg_compose_ldpe(IMSG_REQUEST_ADD_END,
 				    ln->peerid, 0, NULL, 0);
@@ -1318,8 +1363,7 @@ lde_send_labelrequest(struct lde_nbr *ln, struct fec_node *fn,
 	} else {
 		/* if Wilcard just send label request */
 		/* SLRq.3: send label request */
-		lde_imsg_compose_ldpe(IMSG_REQUEST_ADD,
-		    ln->peerid, 0, &map, sizeof(map));
+		lde_imsg_compose_map(IMSG_REQUEST_ADD, ln->peerid, &map);
 		if (single)
 			lde_imsg_compose_ldpe(IMSG_REQUEST_ADD_END, ln->peerid, 0, NULL, 0);
 
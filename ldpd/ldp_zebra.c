@@ -24,7 +24,6 @@
 static void	 ifp2kif(struct interface *, struct kif *);
 static void	 ifc2kaddr(struct interface *, struct connected *,
 		    struct kaddr *);
-static int	 ldp_zebra_send_mpls_labels(int, struct kroute *);
 static int	 ldp_router_id_update(ZAPI_CALLBACK_ARGS);
 static int	 ldp_interface_address_add(ZAPI_CALLBACK_ARGS);
 static int	 ldp_interface_address_delete(ZAPI_CALLBACK_ARGS);
@@ -195,14 +194,112 @@ ldp_sync_zebra_init(void)
 	ldp_sync_zebra_send_announce();
 }
 
-static int
-ldp_zebra_send_mpls_labels(int cmd, struct kroute *kr)
+/*
+ * Label programming towards zebra.  kr_change() and kr_delete() only record
+ * the wanted state of an FTN/LSP nexthop.  After a short coalescing window,
+ * kr_flush() sends the differences to what was sent before, packing the
+ * nexthops of the same LSP into one message.  An update that doesn't change
+ * any label, or a route flapping within the window, doesn't reach zebra.
+ */
+#define KR_COALESCE_MSEC	10
+
+struct kr_state {
+	RB_ENTRY(kr_state)	 entry;
+	TAILQ_ENTRY(kr_state)	 pending_entry;
+	struct kroute		 kr;		/* wanted state */
+	struct kroute		 installed;	/* as last sent to zebra */
+	bool			 want;
+	bool			 is_installed;
+	bool			 pending;
+};
+RB_HEAD(kr_state_head, kr_state);
+RB_PROTOTYPE(kr_state_head, kr_state, entry, kr_state_compare)
+
+static struct kr_state_head kr_states = RB_INITIALIZER(&kr_states);
+static TAILQ_HEAD(, kr_state) kr_pending = TAILQ_HEAD_INITIALIZER(kr_pending);
+static struct event *kr_flush_ev;
+
+/* LSP message being built by kr_flush(), see kr_zl_add() */
+static struct zapi_labels kr_zl;
+static struct kroute kr_zl_kr;
+static int kr_zl_cmd;
+
+static __inline int
+kr_state_compare(const struct kr_state *a, const struct kr_state *b)
+{
+	const struct kroute *ka = &a->kr, *kb = &b->kr;
+	int ret;
+
+	if (ka->af != kb->af)
+		return (ka->af < kb->af ? -1 : 1);
+	if (ka->prefixlen != kb->prefixlen)
+		return (ka->prefixlen < kb->prefixlen ? -1 : 1);
+	ret = ldp_addrcmp(ka->af, &ka->prefix, &kb->prefix);
+	if (ret)
+		return (ret);
+	ret = ldp_addrcmp(ka->af, &ka->nexthop, &kb->nexthop);
+	if (ret)
+		return (ret);
+	if (ka->ifindex != kb->ifindex)
+		return (ka->ifindex < kb->ifindex ? -1 : 1);
+	if (ka->route_type != kb->route_type)
+		return (ka->route_type < kb->route_type ? -1 : 1);
+	if (ka->route_instance != kb->route_instance)
+		return (ka->route_instance < kb->route_instance ? -1 : 1);
+	return (0);
+}
+
+RB_GENERATE(kr_state_head, kr_state, entry, kr_state_compare)
+
+static void
+kr_zl_send(void)
+{
+	if (kr_zl.nexthop_num == 0)
+		return;
+
+	if (zebra_send_mpls_labels(zclient, kr_zl_cmd, &kr_zl) ==
+	    ZCLIENT_SEND_FAILURE)
+		log_warnx("%s: error %s label %s", __func__,
+		    (kr_zl_cmd == ZEBRA_MPLS_LABELS_ADD) ? "installing" :
+		    "deleting", log_label(kr_zl.local_label));
+
+	memset(&kr_zl, 0, sizeof(kr_zl));
+}
+
+/* can kr be sent as one more nexthop of the message being built? */
+static bool
+kr_zl_same_lsp(int cmd, const struct kroute *kr)
 {
-	struct zapi_labels zl = {};
+	const struct kroute *first = &kr_zl_kr;
+
+	if (kr_zl.nexthop_num == 0 || kr_zl.nexthop_num >= MULTIPATH_NUM)
+		return (false);
+	if (kr_zl_cmd != cmd || first->af != kr->af ||
+	    first->local_label != kr->local_label)
+		return (false);
+
+	/* without a remote label, the FTN isn't touched */
+	if ((first->remote_label == NO_LABEL) != (kr->remote_label == NO_LABEL))
+		return (false);
+	if (kr->remote_label == NO_LABEL)
+		return (true);
+
+	return (first->prefixlen == kr->prefixlen &&
+	    !ldp_addrcmp(kr->af, &first->prefix, &kr->prefix) &&
+	    first->route_type == kr->route_type &&
+	    first->route_instance == kr->route_instance);
+}
+
+/* add kr to the message being built; false if there's nothing to send */
+static bool
+kr_zl_add(int cmd, const struct kroute *kr)
+{
+	struct zapi_labels *zl = &kr_zl;
 	struct zapi_nexthop *znh;
+	uint32_t remote_label = kr->remote_label;
 
 	if (kr->local_label < MPLS_LABEL_RESERVED_MAX)
-		return (0);
+		return (false);
 
 	debug_zebra_out("prefix %s/%u nexthop %s ifindex %u labels %s/%s (%s)",
 	    log_addr(kr->af, &kr->prefix), kr->prefixlen,
@@ -210,45 +307,50 @@ ldp_zebra_send_mpls_labels(int cmd, struct kroute *kr)
 	    log_label(kr->local_label), log_label(kr->remote_label),
 	    (cmd == ZEBRA_MPLS_LABELS_ADD) ? "add" : "delete");
 
-	zl.type = ZEBRA_LSP_LDP;
-	zl.local_label = kr->local_label;
-
-	/* Set prefix. */
-	if (kr->remote_label != NO_LABEL) {
-		SET_FLAG(zl.message, ZAPI_LABELS_FTN);
-		zl.route.prefix.family = kr->af;
-		switch (kr->af) {
-		case AF_INET:
-			zl.route.prefix.u.prefix4 = kr->prefix.v4;
-			break;
-		case AF_INET6:
-			zl.route.prefix.u.prefix6 = kr->prefix.v6;
-			break;
-		default:
-			fatalx("ldp_zebra_send_mpls_labels: unknown af");
-		}
-		zl.route.prefix.prefixlen = kr->prefixlen;
-		zl.route.type = kr->route_type;
-		zl.route.instance = kr->route_instance;
-	}
-
 	/* If allow-broken-lsps is enabled then if an lsp is received with
 	 * no remote label, instruct the forwarding plane to pop the top-level
 	 * label and forward packets normally. This is a best-effort attempt
 	 * to deliver labeled IP packets to their final destination (instead of
 	 * dropping them).
 	 */
-	if (kr->remote_label == NO_LABEL
+	if (remote_label == NO_LABEL
 	    && !CHECK_FLAG(ldpd_conf->flags, F_LDPD_ALLOW_BROKEN_LSP)
 	    && cmd == ZEBRA_MPLS_LABELS_ADD)
-		return 0;
+		return (false);
+
+	if (!kr_zl_same_lsp(cmd, kr)) {
+		kr_zl_send();
+
+		kr_zl_cmd = cmd;
+		kr_zl_kr = *kr;
+		zl->type = ZEBRA_LSP_LDP;
+		zl->local_label = kr->local_label;
+
+		/* Set prefix. */
+		if (remote_label != NO_LABEL) {
+			SET_FLAG(zl->message, ZAPI_LABELS_FTN);
+			zl->route.prefix.family = kr->af;
+			switch (kr->af) {
+			case AF_INET:
+				zl->route.prefix.u.prefix4 = kr->prefix.v4;
+				break;
+			case AF_INET6:
+				zl->route.prefix.u.prefix6 = kr->prefix.v6;
+				break;
+			default:
+				fatalx("kr_zl_add: unknown af");
+			}
+			zl->route.prefix.prefixlen = kr->prefixlen;
+			zl->route.type = kr->route_type;
+			zl->route.instance = kr->route_instance;
+		}
+	}
 
-	if (kr->remote_label == NO_LABEL)
-		kr->remote_label = MPLS_LABEL_IMPLICIT_NULL;
+	if (remote_label == NO_LABEL)
+		remote_label = MPLS_LABEL_IMPLICIT_NULL;
 
 	/* Set nexthop. */
-	zl.nexthop_num = 1;
-	znh = &zl.nexthops[0];
+	znh = &zl->nexthops[zl->nexthop_num++];
 	switch (kr->af) {
 	case AF_INET:
 		znh->gate.ipv4 = kr->nexthop.v4;
@@ -269,24 +371,119 @@ ldp_zebra_send_mpls_labels(int cmd, struct kroute *kr)
 	}
 	znh->ifindex = kr->ifindex;
 	znh->label_num = 1;
-	znh->labels[0] = kr->remote_label;
+	znh->labels[0] = remote_label;
 
-	if (zebra_send_mpls_labels(zclient, cmd, &zl) == ZCLIENT_SEND_FAILURE)
-		return -1;
+	return (true);
+}
 
-	return 0;
+static void
+kr_flush(struct event *thread)
+{
+	struct kr_state	*ks;
+
+	while ((ks = TAILQ_FIRST(&kr_pending)) != NULL) {
+		TAILQ_REMOVE(&kr_pending, ks, pending_entry);
+		ks->pending = false;
+
+		/* a new local label is a different LSP */
+		if (ks->is_installed && (!ks->want ||
+		    ks->installed.local_label != ks->kr.local_label)) {
+			kr_zl_add(ZEBRA_MPLS_LABELS_DELETE, &ks->installed);
+			ks->is_installed = false;
+		}
+
+		if (!ks->want) {
+			RB_REMOVE(kr_state_head, &kr_states, ks);
+			free(ks);
+			continue;
+		}
+
+		if (ks->is_installed &&
+		    ks->installed.remote_label == ks->kr.remote_label)
+			continue;
+
+		if (kr_zl_add(ZEBRA_MPLS_LABELS_ADD, &ks->kr)) {
+			ks->installed = ks->kr;
+			ks->is_installed = true;
+		}
+	}
+
+	kr_zl_send();
+}
+
+static void
+kr_update(struct kroute *kr, bool want)
+{
+	struct kr_state	*ks, key;
+
+	key.kr = *kr;
+	ks = RB_FIND(kr_state_head, &kr_states, &key);
+	if (ks == NULL) {
+		/* never sent to zebra, nothing to delete */
+		if (!want)
+			return;
+
+		if ((ks = calloc(1, sizeof(*ks))) == NULL)
+			fatal(__func__);
+		ks->kr = *kr;
+		RB_INSERT(kr_state_head, &kr_states, ks);
+	}
+
+	ks->kr = *kr;
+	ks->want = want;
+	if (!ks->pending) {
+		ks->pending = true;
+		TAILQ_INSERT_TAIL(&kr_pending, ks, pending_entry);
+	}
+
+	event_add_timer_msec(master, kr_flush, NULL, KR_COALESCE_MSEC,
+	    &kr_flush_ev);
+}
+
+/* zebra lost whatever was sent over the previous connection */
+static void
+kr_reinstall(void)
+{
+	struct kr_state	*ks;
+
+	RB_FOREACH(ks, kr_state_head, &kr_states) {
+		ks->is_installed = false;
+		if (!ks->pending) {
+			ks->pending = true;
+			TAILQ_INSERT_TAIL(&kr_pending, ks, pending_entry);
+		}
+	}
+
+	if (!TAILQ_EMPTY(&kr_pending))
+		event_add_timer_msec(master, kr_flush, NULL, KR_COALESCE_MSEC,
+		    &kr_flush_ev);
+}
+
+static void
+kr_clear(void)
+{
+	struct kr_state	*ks;
+
+	EVENT_OFF(kr_flush_ev);
+	TAILQ_INIT(&kr_pending);
+	while ((ks = RB_ROOT(kr_state_head, &kr_states)) != NULL) {
+		RB_REMOVE(kr_state_head, &kr_states, ks);
+		free(ks);
+	}
 }
 
 int
 kr_change(struct kroute *kr)
 {
-	return (ldp_zebra_send_mpls_labels(ZEBRA_MPLS_LABELS_ADD, kr));
+	kr_update(kr, true);
+	return (0);
 }
 
 int
 kr_delete(struct kroute *kr)
 {
-	return (ldp_zebra_send_mpls_labels(ZEBRA_MPLS_LABELS_DELETE, kr));
+	kr_update(kr, false);
+	return (0);
 }
 
 int
@@ -657,6 +854,8 @@ ldp_zebra_connected(struct zclient *zclient)
 	ldp_zebra_opaque_register();
 
 	ldp_sync_zebra_init();
+
+	kr_reinstall();
 }
 
 static void
@@ -705,6 +904,7 @@ void
 ldp_zebra_destroy(void)
 {
 	ldp_zebra_opaque_unregister();
+	kr_clear();
 	zclient_stop(zclient);
 	zclient_free(zclient);
 	zclient = NULL;
@@ -296,6 +296,12 @@ struct map {
 #define F_MAP_PW_IFMTU	0x10	/* pseudowire interface parameter */
 #define F_MAP_PW_STATUS	0x20	/* pseudowire status */
 
+/*
+ * Label messages exchanged between ldpe and lde carry an array of maps, as
+ * many as fit into a single imsg.
+ */
+#define MAP_BATCH_MAX	((MAX_IMSGSIZE - IMSG_HEADER_SIZE) / sizeof(struct map))
+
 struct notify_msg {
 	uint32_t	status_code;
 	uint32_t	msg_id;		/* network byte order */
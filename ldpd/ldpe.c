@@ -43,6 +43,12 @@ struct ldpd_sysdep	 sysdep;
 static struct imsgev    iev_main_data;
 static struct imsgev	*iev_main, *iev_main_sync;
 static struct imsgev	*iev_lde;
+
+/* label messages for lde not sent yet, see ldpe_imsg_compose_map() */
+static struct map	 map_batch[MAP_BATCH_MAX];
+static uint16_t		 map_batch_count;
+static int		 map_batch_type;
+static uint32_t		 map_batch_peerid;
 #ifdef __OpenBSD__
 static struct event *pfkey_ev;
 #endif
@@ -255,12 +261,48 @@ int
 ldpe_imsg_compose_lde(int type, uint32_t peerid, pid_t pid, void *data,
     uint16_t datalen)
 {
+	/* keep the ordering of everything sent to lde */
+	ldpe_map_batch_flush();
+
 	if (iev_lde->ibuf.fd == -1)
 		return (0);
 	return (imsg_compose_event(iev_lde, type, peerid, pid, -1,
 	    data, datalen));
 }
 
+void
+ldpe_map_batch_flush(void)
+{
+	uint16_t	 count = map_batch_count;
+
+	if (count == 0)
+		return;
+	map_batch_count = 0;
+
+	if (iev_lde->ibuf.fd == -1)
+		return;
+	imsg_compose_event(iev_lde, map_batch_type, map_batch_peerid, 0, -1,
+	    map_batch, count * sizeof(struct map));
+}
+
+/*
+ * Queue a received label message for lde.  Consecutive ones of the same type
+ * from the same neighbor go out as a single imsg; the batch is flushed by
+ * anything else sent to lde, or by ldpe_map_batch_flush() once a PDU has
+ * been parsed.
+ */
+void
+ldpe_imsg_compose_map(int type, uint32_t peerid, struct map *map)
+{
+	if (map_batch_count && (map_batch_type != type ||
+	    map_batch_peerid != peerid || map_batch_count == MAP_BATCH_MAX))
+		ldpe_map_batch_flush();
+
+	map_batch_type = type;
+	map_batch_peerid = peerid;
+	map_batch[map_batch_count++] = *map;
+}
+
 /* ARGSUSED */
 static void ldpe_dispatch_main(struct event *thread)
 {
@@ -630,6 +672,8 @@ static void ldpe_dispatch_lde(struct event *thread)
 	struct map		*map;
 	struct notify_msg	*nm;
 	struct nbr		*nbr;
+	struct mapping_head	*mh;
+	size_t			 len;
 	int			 n, shut = 0;
 
 	iev->ev_read = NULL;
@@ -650,10 +694,9 @@ static void ldpe_dispatch_lde(struct event *thread)
 		case IMSG_RELEASE_ADD:
 		case IMSG_REQUEST_ADD:
 		case IMSG_WITHDRAW_ADD:
-			if (imsg.hdr.len - IMSG_HEADER_SIZE !=
-			    sizeof(struct map))
+			len = imsg.hdr.len - IMSG_HEADER_SIZE;
+			if (len == 0 || len % sizeof(struct map))
 				fatalx("invalid size of map request");
-			map = imsg.data;
 
 			nbr = nbr_find_peerid(imsg.hdr.peerid);
 			if (nbr == NULL)
@@ -663,18 +706,21 @@ static void ldpe_dispatch_lde(struct event *thread)
 
 			switch (imsg.hdr.type) {
 			case IMSG_MAPPING_ADD:
-				mapping_list_add(&nbr->mapping_list, map);
+				mh = &nbr->mapping_list;
 				break;
 			case IMSG_RELEASE_ADD:
-				mapping_list_add(&nbr->release_list, map);
+				mh = &nbr->release_list;
 				break;
 			case IMSG_REQUEST_ADD:
-				mapping_list_add(&nbr->request_list, map);
+				mh = &nbr->request_list;
 				break;
-			case IMSG_WITHDRAW_ADD:
-				mapping_list_add(&nbr->withdraw_list, map);
+			default:
+				mh = &nbr->withdraw_list;
 				break;
 			}
+			for (map = imsg.data; len; map++,
+			    len -= sizeof(struct map))
+				mapping_list_add(mh, map);
 			break;
 		case IMSG_MAPPING_ADD_END:
 		case IMSG_RELEASE_ADD_END:
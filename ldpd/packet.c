@@ -552,6 +552,7 @@ static void session_read(struct event *thread)
 
 			if (ret == -1) {
 				/* parser failed, giving up */
+				ldpe_map_batch_flush();
 				free(buf);
 				return;
 			}
@@ -604,6 +605,9 @@ static void session_read(struct event *thread)
 		}
 	}
 
+	/* label messages parsed above are batched towards lde */
+	ldpe_map_batch_flush();
+
 	/* shouldn't happen, session_get_pdu should be > 0 if buf was
 	 * allocated - but let's get rid of the SA warning.
 	 */
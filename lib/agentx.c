@@ -201,6 +201,9 @@ static int config_write_agentx(struct vty *vty)
 {
 	if (agentx_enabled)
 		vty_out(vty, "agentx\n");
+	if (smux_index_cache_get_ttl() != SMUX_INDEX_CACHE_TTL_DEFAULT)
+		vty_out(vty, "agentx cache-ttl %u\n",
+			smux_index_cache_get_ttl());
 	return 1;
 }
 
@@ -232,6 +235,29 @@ DEFUN (no_agentx,
 	return CMD_WARNING_CONFIG_FAILED;
 }
 
+DEFUN (agentx_cache_ttl,
+       agentx_cache_ttl_cmd,
+       "agentx cache-ttl (0-3600)",
+       "SNMP AgentX protocol settings\n"
+       "How long table index snapshots are used for GETNEXT\n"
+       "Seconds, 0 to look up every request in the live tables\n")
+{
+	smux_index_cache_set_ttl(strtoul(argv[2]->arg, NULL, 10));
+	return CMD_SUCCESS;
+}
+
+DEFUN (no_agentx_cache_ttl,
+       no_agentx_cache_ttl_cmd,
+       "no agentx cache-ttl [(0-3600)]",
+       NO_STR
+       "SNMP AgentX protocol settings\n"
+       "How long table index snapshots are used for GETNEXT\n"
+       "Seconds, 0 to look up every request in the live tables\n")
+{
+	smux_index_cache_set_ttl(SMUX_INDEX_CACHE_TTL_DEFAULT);
+	return CMD_SUCCESS;
+}
+
 static int smux_disable(void)
 {
 	agentx_enabled = false;
@@ -258,6 +284,8 @@ void smux_init(struct event_loop *tm)
 	install_node(&agentx_node);
 	install_element(CONFIG_NODE, &agentx_enable_cmd);
 	install_element(CONFIG_NODE, &no_agentx_cmd);
+	install_element(CONFIG_NODE, &agentx_cache_ttl_cmd);
+	install_element(CONFIG_NODE, &no_agentx_cache_ttl_cmd);
 
 	hook_register(frr_early_fini, smux_disable);
 }
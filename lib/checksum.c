@@ -9,18 +9,123 @@
 #include <zebra.h>
 #include "checksum.h"
 
-#define add_carry(dst, add)                                                    \
-	do {                                                                   \
-		typeof(dst) _add = (add);                                      \
-		dst += _add;                                                   \
-		if (dst < _add)                                                \
-			dst++;                                                 \
-	} while (0)
+/*
+ * Both checksums are computed over fixed size chunks by loops the compiler
+ * can turn into SIMD code.  The chunk loops are built once for the baseline
+ * instruction set and, on x86-64, once more for AVX2.  The best one the CPU
+ * supports is picked at startup.
+ */
+#define CKSUM_CHUNK 64
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CKSUM_AVX2
+#endif
+
+/*
+ * Internet checksum over whole chunks: 32-bit words are summed up in a 64bit
+ * accumulator, the carries are folded back by the caller.
+ */
+static inline __attribute__((always_inline)) uint64_t
+in_cksum_chunks(const uint8_t *ptr, size_t len)
+{
+	uint64_t sum = 0;
+	uint32_t word;
+	int i;
+
+	for (; len >= CKSUM_CHUNK; len -= CKSUM_CHUNK, ptr += CKSUM_CHUNK)
+		for (i = 0; i < CKSUM_CHUNK / 4; i++) {
+			memcpy(&word, ptr + 4 * i, sizeof(word));
+			sum += word;
+		}
+
+	return sum;
+}
+
+/*
+ * Fletcher checksum over whole chunks.  For a chunk b[0..n-1],
+ * c0 += sum(b[i]) and c1 += n * c0 + sum((n - i) * b[i]), which is the same
+ * as running c0 += b[i], c1 += c0 byte by byte.
+ */
+static inline __attribute__((always_inline)) void
+fletcher_chunks(const uint8_t *ptr, size_t len, uint32_t *c0, uint32_t *c1)
+{
+	uint32_t s0, s1, t0, t1;
+	int i;
+
+	s0 = *c0;
+	s1 = *c1;
+	for (; len >= CKSUM_CHUNK; len -= CKSUM_CHUNK, ptr += CKSUM_CHUNK) {
+		t0 = 0;
+		t1 = 0;
+		for (i = 0; i < CKSUM_CHUNK; i++) {
+			t0 += ptr[i];
+			t1 += (CKSUM_CHUNK - i) * ptr[i];
+		}
+		s1 += CKSUM_CHUNK * s0 + t1;
+		s0 += t0;
+	}
+	*c0 = s0;
+	*c1 = s1;
+}
+
+static uint64_t in_cksum_generic(const uint8_t *ptr, size_t len)
+{
+	return in_cksum_chunks(ptr, len);
+}
+
+static void fletcher_generic(const uint8_t *ptr, size_t len, uint32_t *c0,
+			     uint32_t *c1)
+{
+	fletcher_chunks(ptr, len, c0, c1);
+}
+
+#ifdef CKSUM_AVX2
+static __attribute__((target("avx2"))) uint64_t
+in_cksum_avx2(const uint8_t *ptr, size_t len)
+{
+	return in_cksum_chunks(ptr, len);
+}
+
+static __attribute__((target("avx2"))) void
+fletcher_avx2(const uint8_t *ptr, size_t len, uint32_t *c0, uint32_t *c1)
+{
+	fletcher_chunks(ptr, len, c0, c1);
+}
+#endif
+
+static uint64_t (*in_cksum_impl)(const uint8_t *ptr, size_t len) =
+	in_cksum_generic;
+static void (*fletcher_impl)(const uint8_t *ptr, size_t len, uint32_t *c0,
+			     uint32_t *c1) = fletcher_generic;
+
+const char *checksum_impl_select(bool accel)
+{
+	in_cksum_impl = in_cksum_generic;
+	fletcher_impl = fletcher_generic;
+
+#ifdef CKSUM_AVX2
+	__builtin_cpu_init();
+	if (accel && __builtin_cpu_supports("avx2")) {
+		in_cksum_impl = in_cksum_avx2;
+		fletcher_impl = fletcher_avx2;
+		return "avx2";
+	}
+#endif
+	return "generic";
+}
+
+static void checksum_init(void) __attribute__((_CONSTRUCTOR(1000)));
+static void checksum_init(void)
+{
+	checksum_impl_select(true);
+}
 
 uint16_t in_cksumv(const struct iovec *iov, size_t iov_len)
 {
 	const struct iovec *iov_end;
-	uint32_t sum = 0;
+	uint64_t sum = 0;
+	uint32_t word;
+	size_t len;
 
 	union {
 		uint8_t bytes[2];
@@ -29,9 +134,9 @@ uint16_t in_cksumv(const struct iovec *iov, size_t iov_len)
 	bool have_oddbyte = false;
 
 	/*
-	 * Our algorithm is simple, using a 32-bit accumulator (sum),
-	 * we add sequential 16-bit words to it, and at the end, fold back
-	 * all the carry bits from the top 16 bits into the lower 16 bits.
+	 * Our algorithm is simple, using a 64-bit accumulator (sum),
+	 * we add sequential 32-bit words to it, and at the end, fold back
+	 * all the carry bits from the top 48 bits into the lower 16 bits.
 	 */
 
 	for (iov_end = iov + iov_len; iov < iov_end; iov++) {
@@ -46,17 +151,21 @@ uint16_t in_cksumv(const struct iovec *iov, size_t iov_len)
 			have_oddbyte = false;
 			wordbuf.bytes[1] = *ptr++;
 
-			add_carry(sum, wordbuf.word);
+			sum += wordbuf.word;
 		}
 
-		while (ptr + 8 <= end) {
-			add_carry(sum, *(const uint32_t *)(ptr + 0));
-			add_carry(sum, *(const uint32_t *)(ptr + 4));
-			ptr += 8;
+		len = (end - ptr) & ~(size_t)(CKSUM_CHUNK - 1);
+		sum += in_cksum_impl(ptr, len);
+		ptr += len;
+
+		while (ptr + 4 <= end) {
+			memcpy(&word, ptr, sizeof(word));
+			sum += word;
+			ptr += 4;
 		}
 
 		while (ptr + 2 <= end) {
-			add_carry(sum, *(const uint16_t *)ptr);
+			sum += *(const uint16_t *)ptr;
 			ptr += 2;
 		}
 
@@ -69,20 +178,21 @@ uint16_t in_cksumv(const struct iovec *iov, size_t iov_len)
 	/* mop up an odd byte, if necessary */
 	if (have_oddbyte) {
 		wordbuf.bytes[1] = 0;
-		add_carry(sum, wordbuf.word);
+		sum += wordbuf.word;
 	}
 
 	/*
-	 * Add back carry outs from top 16 bits to low 16 bits.
+	 * Add back carry outs from top bits to low 16 bits.
 	 */
+	while (sum >> 16)
+		sum = (sum >> 16) + (sum & 0xffff);
 
-	sum = (sum >> 16) + (sum & 0xffff); /* add high-16 to low-16 */
-	sum += (sum >> 16);		    /* add carry */
 	return ~sum;
 }
 
 /* Fletcher Checksum -- Refer to RFC1008. */
-#define MODX                 4102U   /* 5802 should be fine */
+/* 5802 should be fine, but keep whole chunks in each reduction */
+#define MODX                 4096U
 
 /* To be consistent, offset is 0-based index, rather than the 1-based
    index required in the specification ISO 8473, Annex C.1 */
@@ -92,10 +202,11 @@ uint16_t fletcher_checksum(uint8_t *buffer, const size_t len,
 			   const uint16_t offset)
 {
 	uint8_t *p;
-	int x, y, c0, c1;
+	int x, y;
+	uint32_t c0, c1;
 	uint16_t checksum = 0;
 	uint16_t *csum;
-	size_t partial_len, i, left = len;
+	size_t partial_len, chunks_len, i, left = len;
 
 	if (offset != FLETCHER_CHECKSUM_VALIDATE)
 	/* Zero the csum in the packet. */
@@ -112,8 +223,12 @@ uint16_t fletcher_checksum(uint8_t *buffer, const size_t len,
 
 	while (left != 0) {
 		partial_len = MIN(left, MODX);
+		chunks_len = partial_len & ~(size_t)(CKSUM_CHUNK - 1);
+
+		fletcher_impl(p, chunks_len, &c0, &c1);
+		p += chunks_len;
 
-		for (i = 0; i < partial_len; i++) {
+		for (i = chunks_len; i < partial_len; i++) {
 			c0 = c0 + *(p++);
 			c1 += c0;
 		}
@@ -130,7 +245,7 @@ uint16_t fletcher_checksum(uint8_t *buffer, const size_t len,
 
 	if (x <= 0)
 		x += 255;
-	y = 510 - c0 - x;
+	y = 510 - (int)c0 - x;
 	if (y > 255)
 		y -= 255;
 
@@ -1,6 +1,7 @@
 #ifndef _FRR_CHECKSUM_H
 #define _FRR_CHECKSUM_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <netinet/in.h>
 
@@ -67,6 +68,13 @@ static inline uint16_t in_cksum_with_ph6(const struct ipv6_ph *ph,
 extern uint16_t fletcher_checksum(uint8_t *, const size_t len,
 				  const uint16_t offset);
 
+/*
+ * The fastest implementation supported by the CPU is selected at startup.
+ * accel = false forces the portable one; returns the name of the
+ * implementation in use.  Meant for tests and benchmarks.
+ */
+extern const char *checksum_impl_select(bool accel);
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,6 +22,10 @@
 #include "linklist.h"
 #include "vty.h"
 #include "workqueue.h"
+#include "event_channel.h"
+#include "flightrec.h"
+#include "mempressure.h"
+#include "memprof.h"
 #include "vrf.h"
 #include "command_match.h"
 #include "command_graph.h"
@@ -474,6 +478,7 @@ static int config_write_host(struct vty *vty)
 					host.enable);
 		}
 		log_config_write(vty);
+		mempressure_config_write(vty);
 
 		/* print disable always, but enable only if default is flipped
 		 * => prep for future removal of compile-time knob
@@ -2544,6 +2549,10 @@ void cmd_init(int terminal)
 
 		event_cmd_init();
 		workqueue_cmd_init();
+		event_channel_cmd_init();
+		flightrec_cmd_init();
+		mempressure_cmd_init();
+		memprof_cmd_init();
 		hash_cmd_init();
 	}
 
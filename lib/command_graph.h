@@ -25,6 +25,7 @@ extern "C" {
 #endif
 
 DECLARE_MTYPE(CMD_ARG);
+DECLARE_MTYPE(CMD_NEXTHOPS);
 
 struct vty;
 
@@ -91,8 +92,26 @@ struct cmd_token {
 	char *varname;
 
 	struct graph_node *forkjoin; // paired FORK/JOIN for JOIN/FORK
+
+	// follow set cached by the matcher, without/with NEG_ONLY_TKN
+	struct cmd_nexthops *nexthops[2];
 };
 
+/* Follow set of a graph node, see command_match.c */
+struct cmd_nexthops {
+	uint32_t gen; // cmd_graph_gen this was built for
+	unsigned int nwords, nothers;
+
+	// WORD_TKN nodes sorted by text, then all others in graph order
+	struct cmd_nexthop {
+		struct graph_node *node;
+		unsigned int pos; // position in the follow set
+	} nh[];
+};
+
+/* bumped whenever a command graph changes, invalidates cmd_nexthops */
+extern uint32_t cmd_graph_gen;
+
 /* Structure of command element. */
 struct cmd_element {
 	const char *string; /* Command specification by string. */
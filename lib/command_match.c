@@ -65,6 +65,141 @@ static enum match_type match_variable(struct cmd_token *, const char *);
 
 static enum match_type match_mac(const char *, bool);
 
+/*
+ * Follow set caching for command_match_r()
+ *
+ * Matching a line used to collect all nexthops of every node into a list
+ * and recurse into each one, most of which then fail to match the input
+ * token.  Nodes like CONFIG_NODE's start node have hundreds of keywords
+ * after them, so the follow set is now flattened once per node (and redone
+ * when a command graph changes).  Keywords are kept sorted, so only the ones
+ * the input token is a prefix of need to be looked at.
+ */
+static unsigned int nexthops_collect(struct graph_node *node, bool neg,
+				     struct cmd_nexthop *nh, unsigned int pos)
+{
+	struct graph_node *child;
+	struct cmd_token *token;
+
+	for (unsigned int i = 0; i < vector_active(node->to); i++) {
+		child = vector_slot(node->to, i);
+		token = child->data;
+
+		if (token->type == NEG_ONLY_TKN && !neg)
+			continue;
+
+		/* same as add_nexthops() */
+		if (token->type >= SPECIAL_TKN && token->type != END_TKN) {
+			pos = nexthops_collect(child, neg, nh, pos);
+			continue;
+		}
+		if (nh) {
+			nh[pos].node = child;
+			nh[pos].pos = pos;
+		}
+		pos++;
+	}
+	return pos;
+}
+
+static int nexthop_cmp_word(const void *a, const void *b)
+{
+	const struct cmd_nexthop *nha = a, *nhb = b;
+	const struct cmd_token *ta = nha->node->data, *tb = nhb->node->data;
+	int cmp = strcmp(ta->text, tb->text);
+
+	if (cmp)
+		return cmp;
+	return numcmp(nha->pos, nhb->pos);
+}
+
+static int nexthop_cmp_pos(const void *a, const void *b)
+{
+	const struct cmd_nexthop *nha = a, *nhb = b;
+
+	return numcmp(nha->pos, nhb->pos);
+}
+
+static const struct cmd_nexthops *nexthops_get(struct graph_node *node,
+					       bool neg)
+{
+	struct cmd_token *token = node->data;
+	struct cmd_nexthops *nhs = token->nexthops[neg];
+	struct cmd_nexthop *all, tmp;
+	unsigned int count, i;
+
+	if (nhs && nhs->gen == cmd_graph_gen)
+		return nhs;
+
+	XFREE(MTYPE_CMD_NEXTHOPS, token->nexthops[neg]);
+
+	count = nexthops_collect(node, neg, NULL, 0);
+	nhs = XCALLOC(MTYPE_CMD_NEXTHOPS,
+		      sizeof(*nhs) + count * sizeof(nhs->nh[0]));
+	nexthops_collect(node, neg, nhs->nh, 0);
+
+	/* move the words to the front, keeping the others in order */
+	all = nhs->nh;
+	for (i = 0; i < count; i++) {
+		if (((struct cmd_token *)all[i].node->data)->type != WORD_TKN)
+			continue;
+		tmp = all[i];
+		memmove(&all[nhs->nwords + 1], &all[nhs->nwords],
+			(i - nhs->nwords) * sizeof(all[0]));
+		all[nhs->nwords++] = tmp;
+	}
+	nhs->nothers = count - nhs->nwords;
+	qsort(all, nhs->nwords, sizeof(all[0]), nexthop_cmp_word);
+
+	nhs->gen = cmd_graph_gen;
+	token->nexthops[neg] = nhs;
+	return nhs;
+}
+
+/*
+ * Nexthops of node that can match input (NULL: only END_TKN can, since the
+ * input is done), in the order add_nexthops() would return them.  Returns
+ * the number of entries in *out, which is either buf or has to be freed.
+ */
+static unsigned int nexthops_match(struct graph_node *node, bool neg,
+				   const char *input, struct cmd_nexthop *buf,
+				   unsigned int bufsize,
+				   struct cmd_nexthop **out)
+{
+	const struct cmd_nexthops *nhs = nexthops_get(node, neg);
+	const struct cmd_nexthop *words = nhs->nh;
+	const struct cmd_nexthop *others = nhs->nh + nhs->nwords;
+	unsigned int lo = 0, hi = nhs->nwords, first, last, n;
+	size_t len = input ? strlen(input) : 0;
+
+	/* first word >= input, words starting with input follow it */
+	while (input && lo < hi) {
+		unsigned int mid = (lo + hi) / 2;
+		const struct cmd_token *tok = words[mid].node->data;
+
+		if (strcmp(tok->text, input) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	first = last = lo;
+	while (input && last < nhs->nwords &&
+	       !strncmp(((struct cmd_token *)words[last].node->data)->text,
+			input, len))
+		last++;
+
+	n = last - first + nhs->nothers;
+	*out = buf;
+	if (n > bufsize)
+		*out = XMALLOC(MTYPE_CMD_MATCHSTACK, n * sizeof(**out));
+
+	memcpy(*out, words + first, (last - first) * sizeof(**out));
+	memcpy(*out + last - first, others, nhs->nothers * sizeof(**out));
+	if (last - first)
+		qsort(*out, n, sizeof(**out), nexthop_cmp_pos);
+	return n;
+}
+
 static bool is_neg(vector vline, size_t idx)
 {
 	if (idx >= vector_active(vline) || !vector_slot(vline, idx))
@@ -235,16 +370,21 @@ static enum matcher_rv command_match_r(struct graph_node *start, vector vline,
 
 	stack[n] = start;
 
-	// pointers for iterating linklist
-	struct listnode *ln;
 	struct graph_node *gn;
+	struct cmd_nexthop nhbuf[32], *next;
+	unsigned int nnext;
 
-	// get all possible nexthops
-	struct list *next = list_new();
-	add_nexthops(next, start, NULL, 0, is_neg(vline, 1));
+	// get the nexthops that can match the next input token
+	nnext = nexthops_match(start, is_neg(vline, 1),
+			       n + 1 < vector_active(vline)
+				       ? vector_slot(vline, n + 1)
+				       : NULL,
+			       nhbuf, array_size(nhbuf), &next);
 
 	// determine the best match
-	for (ALL_LIST_ELEMENTS_RO(next, ln, gn)) {
+	for (unsigned int i = 0; i < nnext; i++) {
+		gn = next[i].node;
+
 		// if we've matched all input we're looking for END_TKN
 		if (n + 1 == vector_active(vline)) {
 			struct cmd_token *tok = gn->data;
@@ -327,7 +467,8 @@ static enum matcher_rv command_match_r(struct graph_node *start, vector vline,
 		status = MATCHER_INCOMPLETE;
 
 	// cleanup
-	list_delete(&next);
+	if (next != nhbuf)
+		XFREE(MTYPE_CMD_MATCHSTACK, next);
 
 	return status;
 }
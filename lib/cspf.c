@@ -50,39 +50,6 @@ static struct c_path *cpath_new(uint64_t key)
 	return path;
 }
 
-/**
- * Copy src Constrained Path into dst Constrained Path. A new Constrained Path
- * structure is dynamically allocated if dst is NULL. If src is NULL, the
- * function return the dst disregarding if it is NULL or not.
- *
- * @param dest	Destination Constrained Path structure
- * @param src	Source Constrained Path structure
- *
- * @return	Pointer to the destination Constrained Path structure
- */
-static struct c_path *cpath_copy(struct c_path *dest, const struct c_path *src)
-{
-	struct c_path *new_path;
-
-	if (!src)
-		return dest;
-
-	if (!dest) {
-		new_path = XCALLOC(MTYPE_PCA, sizeof(struct c_path));
-	} else {
-		new_path = dest;
-		if (dest->edges)
-			list_delete(&new_path->edges);
-	}
-
-	new_path->dst = src->dst;
-	new_path->weight = src->weight;
-	new_path->edges = list_dup(src->edges);
-	new_path->status = src->status;
-
-	return new_path;
-}
-
 /**
  * Delete Constrained Path structure. Previous allocated memory is freed.
  *
@@ -101,55 +68,51 @@ static void cpath_del(struct c_path *path)
 }
 
 /**
- * Replace the list of edges in the next Constrained Path by the list of edges
- * in the current Constrained Path.
- *
- * @param next_path	next Constrained Path structure
- * @param cur_path	current Constrained Path structure
- */
-static void cpath_replace(struct c_path *next_path, struct c_path *cur_path)
-{
-
-	if (next_path->edges)
-		list_delete(&next_path->edges);
-
-	next_path->edges = list_dup(cur_path->edges);
-}
-
-/**
- * Create a new Visited Node structure from the provided Vertex. Structure is
- * dynamically allocated.
+ * Get a Constrained Path for the computation, reusing one of a previous
+ * computation if possible. Only the result gets a list of edges.
  *
- * @param vertex	Vertex structure
+ * @param algo	CSPF structure
+ * @param key	Vertex key of the destination of this path
  *
- * @return		Pointer to the new Visited Node structure
+ * @return	Pointer to a Constrained Path structure
  */
-static struct v_node *vnode_new(struct ls_vertex *vertex)
+static struct c_path *cpath_get(struct cspf *algo, uint64_t key)
 {
-	struct v_node *vnode;
+	struct c_path *path;
 
-	if (!vertex)
-		return NULL;
+	if (algo->spare_count)
+		path = algo->spare[--algo->spare_count];
+	else
+		path = XCALLOC(MTYPE_PCA, sizeof(struct c_path));
 
-	vnode = XCALLOC(MTYPE_PCA, sizeof(struct v_node));
-	vnode->vertex = vertex;
-	vnode->key = vertex->key;
+	path->dst = key;
+	path->status = IN_PROGRESS;
+	path->edges = NULL;
+	path->weight = MAX_COST;
+	path->parent = NULL;
+	path->edge = NULL;
+	path->visited = false;
 
-	return vnode;
+	return path;
 }
 
 /**
- * Delete Visited Node structure. Previous allocated memory is freed.
+ * Give a Constrained Path back to the CSPF structure for later reuse.
  *
- * @param vnode		Visited Node structure to be deleted
+ * @param algo	CSPF structure
+ * @param path	Constrained Path structure no longer used
  */
-static void vnode_del(struct v_node *vnode)
+static void cpath_put(struct cspf *algo, struct c_path *path)
 {
-	if (!vnode)
-		return;
+	if (path->edges)
+		list_delete(&path->edges);
 
-	XFREE(MTYPE_PCA, vnode);
-	vnode = NULL;
+	if (algo->spare_count == algo->spare_size) {
+		algo->spare_size = algo->spare_size ? algo->spare_size * 2 : 64;
+		algo->spare = XREALLOC(MTYPE_PCA, algo->spare,
+				       algo->spare_size * sizeof(*algo->spare));
+	}
+	algo->spare[algo->spare_count++] = path;
 }
 
 /**
@@ -219,9 +182,8 @@ struct cspf *cspf_new(void)
 	/* Allocate New CSPF structure */
 	algo = XCALLOC(MTYPE_PCA, sizeof(struct cspf));
 
-	/* Initialize RB-Trees */
+	/* Initialize Hash and Priority Queue */
 	processed_init(&algo->processed);
-	visited_init(&algo->visited);
 	pqueue_init(&algo->pqueue);
 
 	algo->path = NULL;
@@ -246,14 +208,14 @@ struct cspf *cspf_init(struct cspf *algo, const struct ls_vertex *src,
 
 	/* Initialize Processed Path and Priority Queue with Src & Dst */
 	if (src) {
-		psrc = cpath_new(src->key);
+		psrc = cpath_get(new_algo, src->key);
 		psrc->weight = 0;
 		processed_add(&new_algo->processed, psrc);
 		pqueue_add(&new_algo->pqueue, psrc);
 		new_algo->path = psrc;
 	}
 	if (dst) {
-		new_algo->pdst = cpath_new(dst->key);
+		new_algo->pdst = cpath_get(new_algo, dst->key);
 		processed_add(&new_algo->processed, new_algo->pdst);
 	}
 
@@ -315,33 +277,17 @@ struct cspf *cspf_init_v6(struct cspf *algo, struct ls_ted *ted,
 void cspf_clean(struct cspf *algo)
 {
 	struct c_path *path;
-	struct v_node *vnode;
 
 	if (!algo)
 		return;
 
 	/* Normally, Priority Queue is empty. Clean it in case of. */
-	if (pqueue_count(&algo->pqueue)) {
-		frr_each_safe (pqueue, &algo->pqueue, path) {
-			pqueue_del(&algo->pqueue, path);
-		}
-	}
+	while (pqueue_pop(&algo->pqueue))
+		;
 
-	/* Empty Processed Path tree and associated Path */
-	if (processed_count(&algo->processed)) {
-		frr_each_safe (processed, &algo->processed, path) {
-			processed_del(&algo->processed, path);
-			cpath_del(path);
-		}
-	}
-
-	/* Empty visited Vertex tree and associated Node */
-	if (visited_count(&algo->visited)) {
-		frr_each_safe (visited, &algo->visited, vnode) {
-			visited_del(&algo->visited, vnode);
-			vnode_del(vnode);
-		}
-	}
+	/* Empty Processed Path hash, Paths are kept for the next run */
+	while ((path = processed_pop(&algo->processed)))
+		cpath_put(algo, path);
 
 	memset(&algo->csts, 0, sizeof(struct constraints));
 	algo->path = NULL;
@@ -356,10 +302,12 @@ void cspf_del(struct cspf *algo)
 	/* Empty Priority Queue and Processes Path */
 	cspf_clean(algo);
 
-	/* Then, reset Priority Queue, Processed Path and Visited RB-Tree */
+	/* Then, reset Priority Queue and Processed Path, free spare Paths */
 	pqueue_fini(&algo->pqueue);
 	processed_fini(&algo->processed);
-	visited_fini(&algo->visited);
+	while (algo->spare_count)
+		XFREE(MTYPE_PCA, algo->spare[--algo->spare_count]);
+	XFREE(MTYPE_PCA, algo->spare);
 
 	XFREE(MTYPE_PCA, algo);
 	algo = NULL;
@@ -456,41 +404,36 @@ static bool prune_edge(const struct c_path *path, const struct ls_edge *edge,
  * Relax constraints of the current path up to the destination vertex of the
  * provided Edge. This function progress in the network topology by validating
  * the next vertex on the computed path. If Vertex has not already been visited,
- * list of edges of the current path is augmented with this edge if the new cost
- * is lower than prior path up to this vertex. Current path is re-inserted in
- * the Priority Queue with its new cost i.e. current cost + edge cost.
+ * the path up to this vertex is replaced by the current path plus this edge
+ * if the new cost is lower than prior path up to this vertex. The path is
+ * re-inserted in the Priority Queue with its new cost i.e. current cost + edge
+ * cost.
  *
  * @param algo	CSPF structure
  * @param edge	Next Edge to be added to the current computed path
- *
- * @return	True if current path reach destination, false otherwise
  */
-static bool relax_constraints(struct cspf *algo, struct ls_edge *edge)
+static void relax_constraints(struct cspf *algo, struct ls_edge *edge)
 {
 
 	struct c_path pkey = {};
 	struct c_path *next_path;
-	struct v_node vnode = {};
 	uint32_t total_cost = MAX_COST;
 
 	/* Verify that we have a current computed path */
 	if (!algo->path)
-		return false;
-
-	/* Verify if we have not visited the next Vertex to avoid loop */
-	vnode.key = edge->destination->key;
-	if (visited_member(&algo->visited, &vnode)) {
-		return false;
-	}
+		return;
 
 	/*
 	 * Get Next Computed Path from next vertex key
 	 * or create a new one if it has not yet computed.
+	 * Skip it if the next Vertex has been visited to avoid loop.
 	 */
 	pkey.dst = edge->destination->key;
 	next_path = processed_find(&algo->processed, &pkey);
+	if (next_path && next_path->visited)
+		return;
 	if (!next_path) {
-		next_path = cpath_new(pkey.dst);
+		next_path = cpath_get(algo, pkey.dst);
 		processed_add(&algo->processed, next_path);
 	}
 
@@ -517,83 +460,45 @@ static bool relax_constraints(struct cspf *algo, struct ls_edge *edge)
 	}
 	if (total_cost < next_path->weight) {
 		/*
-		 * It is not possible to directly update the q_path in the
-		 * Priority Queue. Indeed, if we modify the path weight, the
-		 * Priority Queue must be re-ordered. So, we need fist to remove
-		 * the q_path if it is present in the Priority Queue, then,
-		 * update the Path, in particular the Weight, and finally
-		 * (re-)insert it in the Priority Queue.
+		 * The Priority Queue must be re-ordered if we modify the path
+		 * weight. So, remove the path if it is present in the Priority
+		 * Queue, update the Weight and the last Edge, and finally
+		 * (re-)insert it. The current path has been visited, so it
+		 * will not change anymore and the next path can refer to it.
 		 */
-		struct c_path *path;
-		frr_each_safe (pqueue, &algo->pqueue, path) {
-			if (path->dst == pkey.dst) {
-				pqueue_del(&algo->pqueue, path);
-				break;
-			}
-		}
+		if (pqueue_member(&algo->pqueue, next_path))
+			pqueue_del(&algo->pqueue, next_path);
 		next_path->weight = total_cost;
-		cpath_replace(next_path, algo->path);
-		listnode_add(next_path->edges, edge);
+		next_path->parent = algo->path;
+		next_path->edge = edge;
 		pqueue_add(&algo->pqueue, next_path);
 	}
-
-	/* Return True if we reach the destination */
-	return (next_path->dst == algo->pdst->dst);
 }
 
-struct c_path *compute_p2p_path(struct cspf *algo, struct ls_ted *ted)
+/**
+ * Run the constrained shortest path algorithm from the source of the CSPF
+ * structure until all reachable vertices have been visited.
+ *
+ * @param algo	CSPF structure
+ * @param ted	Traffic Engineering Database
+ */
+static void cspf_run(struct cspf *algo, struct ls_ted *ted)
 {
 	struct listnode *node;
 	struct ls_vertex *vertex;
 	struct ls_edge *edge;
-	struct c_path *optim_path;
-	struct v_node *vnode;
-	uint32_t cur_cost;
-
-	optim_path = cpath_new(0xFFFFFFFFFFFFFFFF);
-	optim_path->status = FAILED;
-
-	/* Check that all is correctly initialized */
-	if (!algo)
-		return optim_path;
-
-	if (!algo->csts.ctype)
-		return optim_path;
-
-	if (!algo->pdst) {
-		optim_path->status = NO_DESTINATION;
-		return optim_path;
-	}
-
-	if (!algo->path) {
-		optim_path->status = NO_SOURCE;
-		return optim_path;
-	}
-
-	if (algo->pdst->dst == algo->path->dst) {
-		optim_path->status = SAME_SRC_DST;
-		return optim_path;
-	}
-
-	optim_path->dst = algo->pdst->dst;
-	optim_path->status = IN_PROGRESS;
 
 	/*
 	 * Process all Connected Vertex until priority queue becomes empty.
 	 * Connected Vertices are added into the priority queue when
 	 * processing the next Connected Vertex: see relax_constraints()
 	 */
-	cur_cost = MAX_COST;
-	while (pqueue_count(&algo->pqueue) != 0) {
-		/* Got shortest current Path from the Priority Queue */
-		algo->path = pqueue_pop(&algo->pqueue);
-
-		/* Add destination Vertex of this path to the visited RB Tree */
+	while ((algo->path = pqueue_pop(&algo->pqueue)) != NULL) {
+		/* Mark destination Vertex of this path as visited */
 		vertex = ls_find_vertex_by_key(ted, algo->path->dst);
 		if (!vertex)
 			continue;
-		vnode = vnode_new(vertex);
-		visited_add(&algo->visited, vnode);
+		algo->path->visited = true;
 
 		/* Process all outgoing links from this Vertex */
 		for (ALL_LIST_ELEMENTS_RO(vertex->outgoing_edges, node, edge)) {
@@ -605,29 +510,160 @@ struct c_path *compute_p2p_path(struct cspf *algo, struct ls_ted *ted)
 			if (prune_edge(algo->path, edge, &algo->csts))
 				continue;
 
-			/*
-			 * Relax constraints and check if we got a shorter
-			 * candidate path
-			 */
-			if (relax_constraints(algo, edge) &&
-			    algo->pdst->weight < cur_cost) {
-				cur_cost = algo->pdst->weight;
-				cpath_copy(optim_path, algo->pdst);
-				optim_path->status = SUCCESS;
-			}
+			/* Relax constraints for a shorter candidate path */
+			relax_constraints(algo, edge);
 		}
 	}
+}
+
+/**
+ * Build the resulting Constrained Path up to the given destination, with the
+ * list of edges that compose it.
+ *
+ * @param pdst	Computed Path to the destination
+ *
+ * @return	Constrained Path with status to indicate computation success
+ */
+static struct c_path *cspf_result(const struct c_path *pdst)
+{
+	struct c_path *optim_path;
+	const struct c_path *path;
+
+	optim_path = cpath_new(0xFFFFFFFFFFFFFFFF);
+	optim_path->dst = pdst->dst;
+	optim_path->status = FAILED;
+
+	/* The destination has not been reached */
+	if (pdst->weight == MAX_COST || !pdst->edge)
+		return optim_path;
+
+	for (path = pdst; path && path->edge; path = path->parent)
+		listnode_add_head(optim_path->edges, path->edge);
+	optim_path->weight = pdst->weight;
+	optim_path->status = SUCCESS;
+
+	return optim_path;
+}
+
+/**
+ * Check that the CSPF structure is correctly initialized.
+ *
+ * @param algo	CSPF structure
+ *
+ * @return	IN_PROGRESS if the path can be computed, an error otherwise
+ */
+static enum path_status cspf_check(const struct cspf *algo)
+{
+	if (!algo || !algo->csts.ctype)
+		return FAILED;
+
+	if (!algo->pdst)
+		return NO_DESTINATION;
+
+	if (!algo->path)
+		return NO_SOURCE;
+
+	if (algo->pdst->dst == algo->path->dst)
+		return SAME_SRC_DST;
+
+	return IN_PROGRESS;
+}
+
+struct c_path *compute_p2p_path(struct cspf *algo, struct ls_ted *ted)
+{
+	struct c_path *optim_path;
+	enum path_status status;
+
+	status = cspf_check(algo);
+	if (status != IN_PROGRESS) {
+		optim_path = cpath_new(0xFFFFFFFFFFFFFFFF);
+		optim_path->status = status;
+		return optim_path;
+	}
 
 	/*
-	 * The priority queue is empty => all the possible (vertex, path)
-	 * elements have been explored. The optim_path contains the optimal
+	 * Once the priority queue is empty, all the possible (vertex, path)
+	 * elements have been explored. The result contains the optimal
 	 * path if it exists. Otherwise an empty path with status failed is
 	 * returned.
 	 */
-	if (optim_path->status == IN_PROGRESS ||
-	    listcount(optim_path->edges) == 0)
-		optim_path->status = FAILED;
+	cspf_run(algo, ted);
+	optim_path = cspf_result(algo->pdst);
 	cspf_clean(algo);
 
 	return optim_path;
 }
+
+static bool csts_same(const struct constraints *a, const struct constraints *b)
+{
+	return a->cost == b->cost && a->ctype == b->ctype && a->bw == b->bw &&
+	       a->cos == b->cos && a->type == b->type &&
+	       a->family == b->family;
+}
+
+void cspf_compute_batch(struct cspf *algo, struct ls_ted *ted,
+			struct cspf_request *reqs, size_t count)
+{
+	const struct cspf_request *prev = NULL;
+	struct cspf_request *req;
+	struct c_path pkey = {};
+	struct c_path *pdst;
+	struct cspf *work;
+	enum path_status status;
+	size_t i;
+
+	work = algo ? algo : cspf_new();
+
+	for (i = 0; i < count; i++) {
+		req = &reqs[i];
+
+		if (!req->csts.ctype)
+			status = FAILED;
+		else if (!req->dst)
+			status = NO_DESTINATION;
+		else if (!req->src)
+			status = NO_SOURCE;
+		else if (req->src->key == req->dst->key)
+			status = SAME_SRC_DST;
+		else
+			status = IN_PROGRESS;
+
+		if (status != IN_PROGRESS) {
+			req->path = cpath_new(0xFFFFFFFFFFFFFFFF);
+			req->path->status = status;
+			continue;
+		}
+
+		/*
+		 * The algorithm explores the whole graph reachable within the
+		 * constraints, so one run serves all destinations of the same
+		 * source and constraints.
+		 */
+		if (!prev || prev->src != req->src ||
+		    !csts_same(&prev->csts, &req->csts)) {
+			cspf_clean(work);
+			cspf_init(work, req->src, NULL, &req->csts);
+			cspf_run(work, ted);
+			prev = req;
+		}
+
+		pkey.dst = req->dst->key;
+		pdst = processed_find(&work->processed, &pkey);
+		if (pdst) {
+			req->path = cspf_result(pdst);
+		} else {
+			req->path = cpath_new(0xFFFFFFFFFFFFFFFF);
+			req->path->dst = req->dst->key;
+			req->path->status = FAILED;
+		}
+	}
+
+	cspf_clean(work);
+	if (!algo)
+		cspf_del(work);
+}
+
+void cspf_path_del(struct c_path *path)
+{
+	cpath_del(path);
+}
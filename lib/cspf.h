@@ -13,6 +13,7 @@
 #define _FRR_CSPF_H_
 
 #include "typesafe.h"
+#include "jhash.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,6 +27,10 @@ extern "C" {
  *  - A pruning function that keeps only links that meet constraints
  *  - A priority Queue that keeps the shortest on-going computed path
  *  - A main loop over all vertices to find the shortest path
+ * A CSPF structure is a workspace: the paths computed with it are recycled
+ * by cspf_clean() and reused by the next computation.  The TED is only read,
+ * so several pthreads may compute paths over the same TED concurrently as
+ * long as each one uses its own CSPF structure and the TED doesn't change.
  */
 
 #define MAX_COST	0xFFFFFFFF
@@ -52,56 +57,63 @@ struct constraints {
 	uint8_t family;		/* AF_INET or AF_INET6 address family */
 };
 
-/* Priority Queue for Constrained Path Computation */
-PREDECL_RBTREE_NONUNIQ(pqueue);
+/* Priority Queue for Constrained Path Computation, a d-ary heap */
+PREDECL_HEAP(pqueue);
 
 /* Processed Path for Constrained Path Computation */
-PREDECL_RBTREE_UNIQ(processed);
+PREDECL_HASH(processed);
 
 /* Constrained Path structure */
 struct c_path {
 	struct pqueue_item q_itm;    /* entry in the Priority Queue */
 	uint32_t weight;             /* Weight to sort path in Priority Queue */
-	struct processed_item p_itm; /* entry in the Processed RB Tree */
+	struct processed_item p_itm; /* entry in the Processed Hash */
 	uint64_t dst;                /* Destination vertex key of this path */
 	struct list *edges;          /* List of Edges that compose this path */
 	enum path_status status;     /* status of the computed path */
+	/* During the computation, paths only know their last edge and the
+	 * path they extend.  The edges list is built for the result. */
+	struct c_path *parent;
+	struct ls_edge *edge;
+	bool visited;                /* Destination vertex has been visited */
 };
 
 macro_inline int q_cmp(const struct c_path *p1, const struct c_path *p2)
 {
-	return numcmp(p1->weight, p2->weight);
+	if (p1->weight != p2->weight)
+		return numcmp(p1->weight, p2->weight);
+	return numcmp(p1->dst, p2->dst);
 }
-DECLARE_RBTREE_NONUNIQ(pqueue, struct c_path, q_itm, q_cmp);
+DECLARE_HEAP(pqueue, struct c_path, q_itm, q_cmp);
 
 macro_inline int p_cmp(const struct c_path *p1, const struct c_path *p2)
 {
 	return numcmp(p1->dst, p2->dst);
 }
-DECLARE_RBTREE_UNIQ(processed, struct c_path, p_itm, p_cmp);
-
-/* List of visited node */
-PREDECL_RBTREE_UNIQ(visited);
-struct v_node {
-	struct visited_item item; /* entry in the Processed RB Tree */
-	uint64_t key;
-	struct ls_vertex *vertex;
-};
-
-macro_inline int v_cmp(const struct v_node *p1, const struct v_node *p2)
+macro_inline uint32_t p_hash(const struct c_path *p)
 {
-	return numcmp(p1->key, p2->key);
+	return jhash_2words(p->dst, p->dst >> 32, 0xc5bf);
 }
-DECLARE_RBTREE_UNIQ(visited, struct v_node, item, v_cmp);
+DECLARE_HASH(processed, struct c_path, p_itm, p_cmp, p_hash);
 
 /* Path Computation algorithms structure */
 struct cspf {
 	struct pqueue_head pqueue;       /* Priority Queue */
 	struct processed_head processed; /* Paths that have been processed */
-	struct visited_head visited;     /* Vertices that have been visited */
 	struct constraints csts;         /* Constraints of the path */
 	struct c_path *path;             /* Current Computed Path */
 	struct c_path *pdst;             /* Computed Path to the destination */
+	/* Paths of previous computations, kept for reuse */
+	struct c_path **spare;
+	uint32_t spare_count, spare_size;
+};
+
+/* One request of a batch computation, see cspf_compute_batch() */
+struct cspf_request {
+	const struct ls_vertex *src;     /* Source vertex of the path */
+	const struct ls_vertex *dst;     /* Destination vertex of the path */
+	struct constraints csts;         /* Constraints of the path */
+	struct c_path *path;             /* Result, to be freed by the caller */
 };
 
 /**
@@ -191,6 +203,28 @@ extern void cspf_del(struct cspf *algo);
  */
 extern struct c_path *compute_p2p_path(struct cspf *algo, struct ls_ted *ted);
 
+/**
+ * Compute many point-to-point constrained paths over the same TED with one
+ * CSPF structure.  Consecutive requests with the same source and constraints
+ * share a single run of the algorithm, so callers should sort requests by
+ * source when computing paths for many destinations.
+ *
+ * @param algo	CSPF structure, may be null to use a temporary one
+ * @param ted	Traffic Engineering Database
+ * @param reqs	Array of requests, the path of each one is filled in
+ * @param count	Number of requests
+ */
+extern void cspf_compute_batch(struct cspf *algo, struct ls_ted *ted,
+			       struct cspf_request *reqs, size_t count);
+
+/**
+ * Delete a Constrained Path returned by compute_p2p_path() or
+ * cspf_compute_batch().
+ *
+ * @param path	Constrained Path
+ */
+extern void cspf_path_del(struct c_path *path);
+
 #ifdef __cplusplus
 }
 #endif
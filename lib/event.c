@@ -22,11 +22,14 @@
 #include "lib_errors.h"
 #include "libfrr_trace.h"
 #include "libfrr.h"
+#include "json.h"
+#include "metrics.h"
 
 DEFINE_MTYPE_STATIC(LIB, THREAD, "Thread");
 DEFINE_MTYPE_STATIC(LIB, EVENT_MASTER, "Thread master");
 DEFINE_MTYPE_STATIC(LIB, EVENT_POLL, "Thread Poll Info");
 DEFINE_MTYPE_STATIC(LIB, EVENT_STATS, "Thread stats");
+DEFINE_MTYPE_STATIC(LIB, EVENT_WHEEL, "Event timer wheel");
 
 DECLARE_LIST(event_list, struct event, eventitem);
 
@@ -54,6 +57,558 @@ static int event_timer_cmp(const struct event *a, const struct event *b)
 }
 
 DECLARE_HEAP(event_timer_list, struct event, timeritem, event_timer_cmp);
+DECLARE_DLIST(event_wheel_list, struct event, wheelitem);
+
+/*
+ * The timer wheel only sorts timers into coarse ticks.  As soon as a tick
+ * starts, everything in its slot is moved onto the timer heap, so the heap
+ * still decides the exact expiry order of everything that's about to pop.
+ * Timers that get cancelled or rescheduled before their tick comes up (the
+ * common case for keepalive/hold style timers) never touch the heap.
+ *
+ * 2048 slots of 128ms cover a bit over 4 minutes; anything further out goes
+ * straight onto the heap.
+ */
+#define EVENT_WHEEL_SHIFT 7
+#define EVENT_WHEEL_SLOTS 2048
+#define EVENT_WHEEL_MASK (EVENT_WHEEL_SLOTS - 1)
+
+struct event_timer_wheel {
+	bool enabled;
+
+	/* slots up to and including this tick have been moved to the heap */
+	uint64_t tick;
+	/* no timer on the wheel is in a slot before this tick */
+	uint64_t next;
+	size_t count;
+
+	uint64_t used[EVENT_WHEEL_SLOTS / 64];
+	struct event_wheel_list_head slots[EVENT_WHEEL_SLOTS];
+};
+
+static inline uint64_t event_wheel_tick(const struct timeval *tv)
+{
+	uint64_t msec = (uint64_t)tv->tv_sec * 1000 + tv->tv_usec / 1000;
+
+	return msec >> EVENT_WHEEL_SHIFT;
+}
+
+/* @REQUIRE m->mtx */
+static bool event_wheel_add(struct event_loop *m, struct event *thread)
+{
+	struct event_timer_wheel *w = m->wheel;
+	uint64_t tick;
+	size_t slot;
+
+	if (!w || !w->enabled)
+		return false;
+
+	tick = event_wheel_tick(&thread->u.sands);
+	if (tick <= w->tick || tick - w->tick >= EVENT_WHEEL_SLOTS)
+		return false;
+
+	slot = tick & EVENT_WHEEL_MASK;
+	event_wheel_list_add_tail(&w->slots[slot], thread);
+	w->used[slot / 64] |= 1ULL << (slot % 64);
+	if (!w->count || tick < w->next)
+		w->next = tick;
+	w->count++;
+
+	thread->on_wheel = true;
+	m->timer_stats.wheel_added++;
+	return true;
+}
+
+/* @REQUIRE m->mtx */
+static void event_wheel_del(struct event_loop *m, struct event *thread)
+{
+	struct event_timer_wheel *w = m->wheel;
+	size_t slot = event_wheel_tick(&thread->u.sands) & EVENT_WHEEL_MASK;
+
+	event_wheel_list_del(&w->slots[slot], thread);
+	if (!event_wheel_list_count(&w->slots[slot]))
+		w->used[slot / 64] &= ~(1ULL << (slot % 64));
+	w->count--;
+	thread->on_wheel = false;
+}
+
+/* @REQUIRE m->mtx */
+static void event_timer_del(struct event_loop *m, struct event *thread)
+{
+	if (thread->on_wheel)
+		event_wheel_del(m, thread);
+	else
+		event_timer_list_del(&m->timer, thread);
+}
+
+/* @REQUIRE m->mtx */
+static void event_timer_cancelled(struct event_loop *m, struct event *thread)
+{
+	m->timer_stats.cancelled++;
+	atomic_fetch_add_explicit(&thread->hist->total_timer_cancel, 1,
+				  memory_order_relaxed);
+}
+
+/*
+ * Move everything in the slots up to and including the current tick over to
+ * the heap.
+ *
+ * @REQUIRE m->mtx
+ */
+static void event_wheel_advance(struct event_loop *m,
+				const struct timeval *timenow)
+{
+	struct event_timer_wheel *w = m->wheel;
+	struct event *thread;
+	uint64_t now, tick;
+	size_t slot;
+
+	if (!w)
+		return;
+
+	now = event_wheel_tick(timenow);
+	for (tick = w->tick + 1;
+	     w->count && tick <= now && tick - w->tick < EVENT_WHEEL_SLOTS;
+	     tick++) {
+		slot = tick & EVENT_WHEEL_MASK;
+		if (!(w->used[slot / 64] & (1ULL << (slot % 64))))
+			continue;
+
+		while ((thread = event_wheel_list_pop(&w->slots[slot]))) {
+			thread->on_wheel = false;
+			w->count--;
+			event_timer_list_add(&m->timer, thread);
+			m->timer_stats.wheel_moved++;
+		}
+		w->used[slot / 64] &= ~(1ULL << (slot % 64));
+	}
+
+	if (now > w->tick)
+		w->tick = now;
+}
+
+/*
+ * Start of the first non-empty slot on the wheel, i.e. the time at which
+ * event_wheel_advance() needs to run next.
+ *
+ * @REQUIRE m->mtx
+ */
+static bool event_wheel_next(struct event_loop *m, struct timeval *tv)
+{
+	struct event_timer_wheel *w = m->wheel;
+	uint64_t tick, bits, msec;
+	size_t slot;
+
+	if (!w || !w->count)
+		return false;
+
+	/* count > 0 means some bit is set within a single turn of the wheel */
+	tick = MAX(w->next, w->tick + 1);
+	for (;;) {
+		slot = tick & EVENT_WHEEL_MASK;
+		bits = w->used[slot / 64] >> (slot % 64);
+		if (bits) {
+			tick += __builtin_ctzll(bits);
+			break;
+		}
+		tick += 64 - slot % 64;
+	}
+	w->next = tick;
+
+	msec = tick << EVENT_WHEEL_SHIFT;
+	tv->tv_sec = msec / 1000;
+	tv->tv_usec = (msec % 1000) * 1000;
+	return true;
+}
+
+void event_master_set_timer_wheel(struct event_loop *m, bool enable)
+{
+	struct timeval now;
+	size_t i;
+
+	frr_with_mutex (&m->mtx) {
+		if (!m->wheel) {
+			if (!enable)
+				return;
+
+			m->wheel = XCALLOC(MTYPE_EVENT_WHEEL, sizeof(*m->wheel));
+			for (i = 0; i < EVENT_WHEEL_SLOTS; i++)
+				event_wheel_list_init(&m->wheel->slots[i]);
+			monotime(&now);
+			m->wheel->tick = event_wheel_tick(&now);
+		}
+
+		/* timers already on the wheel are left alone, they just drain */
+		m->wheel->enabled = enable;
+	}
+}
+
+/*
+ * epoll backend for fd polling.  poll() needs the whole pollfd array on
+ * every wakeup; with epoll the kernel keeps the interest list, and we only
+ * tell it about fds whose read/write tasks changed since the last wait.
+ * A fd that loses its last task is dropped from the kernel right away, since
+ * the owner may close it and get the same number back for a new socket; the
+ * kernel forgets closed fds by itself and a cached registration would then
+ * never be re-added.  Changes between two tasks on the same fd are batched
+ * until the next wait.
+ *
+ * The read/write task arrays stay the single source of truth; the pollfd
+ * arrays in the fd_handler are left empty when epoll is in use.
+ */
+#ifdef GNU_LINUX
+#include <sys/epoll.h>
+
+#define EVENT_EPOLL_EVENTS 256
+
+/* per-fd state, besides EPOLLIN/EPOLLOUT as registered with the kernel */
+#define EVENT_EPOLL_DIRTY  0x80
+/* epoll doesn't do regular files; like poll(), they are always ready */
+#define EVENT_EPOLL_ALWAYS 0x40
+
+struct event_io_epoll {
+	int fd;
+
+	uint8_t *state;
+	int maxfd;
+	/* fds registered with the kernel */
+	unsigned int nfds;
+
+	/* fds whose tasks changed since the last event_epoll_sync() */
+	int *dirty;
+	unsigned int ndirty;
+
+	int *always;
+	unsigned int nalways;
+
+	int nevents;
+	struct epoll_event events[EVENT_EPOLL_EVENTS];
+};
+
+static bool io_backend_epoll;
+
+static void event_epoll_init(struct event_loop *m)
+{
+	struct event_io_epoll *ep;
+	struct epoll_event ev = {};
+
+	if (!io_backend_epoll)
+		return;
+
+	ep = XCALLOC(MTYPE_EVENT_POLL, sizeof(*ep));
+	ep->fd = epoll_create1(EPOLL_CLOEXEC);
+	if (ep->fd < 0) {
+		flog_err_sys(EC_LIB_SYSTEM_CALL,
+			     "epoll_create1() failed, falling back to poll(): %s",
+			     safe_strerror(errno));
+		XFREE(MTYPE_EVENT_POLL, ep);
+		return;
+	}
+
+	/* the pipe poker is always there */
+	ev.events = EPOLLIN;
+	ev.data.fd = m->io_pipe[0];
+	epoll_ctl(ep->fd, EPOLL_CTL_ADD, m->io_pipe[0], &ev);
+
+	ep->maxfd = -1;
+	ep->state = XCALLOC(MTYPE_EVENT_POLL, m->fd_limit);
+	ep->dirty = XCALLOC(MTYPE_EVENT_POLL, sizeof(int) * m->fd_limit);
+	ep->always = XCALLOC(MTYPE_EVENT_POLL, sizeof(int) * m->fd_limit);
+	m->handler.epoll = ep;
+}
+
+static void event_epoll_fini(struct event_loop *m)
+{
+	struct event_io_epoll *ep = m->handler.epoll;
+
+	if (!ep)
+		return;
+
+	close(ep->fd);
+	XFREE(MTYPE_EVENT_POLL, ep->state);
+	XFREE(MTYPE_EVENT_POLL, ep->dirty);
+	XFREE(MTYPE_EVENT_POLL, ep->always);
+	XFREE(MTYPE_EVENT_POLL, m->handler.epoll);
+}
+
+/* @REQUIRE m->mtx */
+static void event_epoll_dirty(struct event_loop *m, int fd)
+{
+	struct event_io_epoll *ep = m->handler.epoll;
+
+	if (ep->state[fd] & EVENT_EPOLL_DIRTY)
+		return;
+
+	ep->state[fd] |= EVENT_EPOLL_DIRTY;
+	ep->dirty[ep->ndirty++] = fd;
+	if (fd > ep->maxfd)
+		ep->maxfd = fd;
+}
+
+static void event_epoll_always_del(struct event_io_epoll *ep, int fd)
+{
+	for (unsigned int i = 0; i < ep->nalways; i++)
+		if (ep->always[i] == fd) {
+			ep->always[i] = ep->always[--ep->nalways];
+			break;
+		}
+}
+
+/*
+ * A read and/or write task (as POLLIN/POLLOUT in gone) is going away from
+ * fd.  If that was the last one, unregister the fd now, before the caller
+ * gets a chance to close it.
+ *
+ * @REQUIRE m->mtx
+ */
+static void event_epoll_release(struct event_loop *m, int fd, short gone)
+{
+	struct event_io_epoll *ep = m->handler.epoll;
+	uint8_t state = ep->state[fd];
+
+	if ((m->read[fd] && !(gone & POLLIN)) ||
+	    (m->write[fd] && !(gone & POLLOUT))) {
+		event_epoll_dirty(m, fd);
+		return;
+	}
+
+	if (state & EVENT_EPOLL_ALWAYS)
+		event_epoll_always_del(ep, fd);
+	else if (state & (EPOLLIN | EPOLLOUT)) {
+		/* fails if the fd was closed already, that's fine */
+		epoll_ctl(ep->fd, EPOLL_CTL_DEL, fd, NULL);
+		m->handler.stats.ctl++;
+		ep->nfds--;
+	}
+	ep->state[fd] = state & EVENT_EPOLL_DIRTY;
+}
+
+/*
+ * Bring the kernel's interest list in line with the read/write task arrays.
+ *
+ * @REQUIRE m->mtx
+ */
+static void event_epoll_sync(struct event_loop *m)
+{
+	struct event_io_epoll *ep = m->handler.epoll;
+	struct epoll_event ev = {};
+	uint8_t old, want;
+	int fd, ret;
+
+	for (unsigned int i = 0; i < ep->ndirty; i++) {
+		fd = ep->dirty[i];
+		old = ep->state[fd] & (EPOLLIN | EPOLLOUT | EVENT_EPOLL_ALWAYS);
+		want = (m->read[fd] ? EPOLLIN : 0) |
+		       (m->write[fd] ? EPOLLOUT : 0);
+
+		if (old & EVENT_EPOLL_ALWAYS) {
+			if (want)
+				want |= EVENT_EPOLL_ALWAYS;
+			else
+				event_epoll_always_del(ep, fd);
+			ep->state[fd] = want;
+			continue;
+		}
+
+		ep->state[fd] = want;
+		if (old == want)
+			continue;
+
+		ev.events = want;
+		ev.data.fd = fd;
+		m->handler.stats.ctl++;
+
+		if (!want) {
+			/* fails if the fd was closed already, that's fine */
+			epoll_ctl(ep->fd, EPOLL_CTL_DEL, fd, NULL);
+			ep->nfds--;
+			continue;
+		}
+
+		/*
+		 * The kernel drops closed fds by itself, so a fd we think is
+		 * registered may not be, and the other way around.
+		 */
+		ret = epoll_ctl(ep->fd, old ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd,
+				&ev);
+		if (ret < 0 && errno == ENOENT)
+			ret = epoll_ctl(ep->fd, EPOLL_CTL_ADD, fd, &ev);
+		else if (ret < 0 && errno == EEXIST)
+			ret = epoll_ctl(ep->fd, EPOLL_CTL_MOD, fd, &ev);
+
+		if (ret < 0 && errno == EPERM) {
+			ep->state[fd] |= EVENT_EPOLL_ALWAYS;
+			ep->always[ep->nalways++] = fd;
+			if (old)
+				ep->nfds--;
+			continue;
+		}
+		if (ret < 0)
+			flog_err_sys(EC_LIB_SYSTEM_CALL,
+				     "epoll_ctl() failed for fd %d: %s", fd,
+				     safe_strerror(errno));
+		if (!old)
+			ep->nfds++;
+	}
+	ep->ndirty = 0;
+}
+
+/* fds the loop is waiting on, 0 means there's nothing left to do */
+static unsigned int event_epoll_count(struct event_loop *m)
+{
+	struct event_io_epoll *ep = m->handler.epoll;
+
+	return ep->nfds + ep->nalways;
+}
+
+/* registered events for a fd, as POLLIN/POLLOUT */
+static short event_epoll_events(struct event_loop *m, int fd)
+{
+	uint8_t state = m->handler.epoll->state[fd];
+
+	return (state & EPOLLIN ? POLLIN : 0) | (state & EPOLLOUT ? POLLOUT : 0);
+}
+
+static int event_epoll_wait(struct event_loop *m, int timeout,
+			    const sigset_t *sigmask)
+{
+	struct event_io_epoll *ep = m->handler.epoll;
+	unsigned char trash[64];
+	int num;
+
+	if (ep->nalways)
+		timeout = 0;
+
+	num = epoll_pwait(ep->fd, ep->events, EVENT_EPOLL_EVENTS, timeout,
+			  sigmask);
+	if (num < 0)
+		return num;
+	ep->nevents = num;
+
+	for (int i = 0; i < ep->nevents; i++) {
+		if (ep->events[i].data.fd != m->io_pipe[0])
+			continue;
+
+		while (read(m->io_pipe[0], &trash, sizeof(trash)) > 0)
+			;
+		ep->events[i] = ep->events[--ep->nevents];
+		num--;
+		break;
+	}
+
+	return num + ep->nalways;
+}
+
+/* @REQUIRE m->mtx */
+static void event_epoll_ready(struct event_loop *m, struct event **thread_array,
+			      int fd)
+{
+	struct event *thread = thread_array[fd];
+
+	if (!thread)
+		return;
+
+	thread_array[fd] = NULL;
+	event_list_add_tail(&m->ready, thread);
+	thread->type = EVENT_READY;
+	event_epoll_release(m, fd, 0);
+}
+
+/* @REQUIRE m->mtx */
+static void event_epoll_process(struct event_loop *m)
+{
+	struct event_io_epoll *ep = m->handler.epoll;
+	uint32_t revents;
+	int fd;
+
+	for (int i = 0; i < ep->nevents; i++) {
+		fd = ep->events[i].data.fd;
+		revents = ep->events[i].events;
+
+		/*
+		 * As with poll(), errors go to the read task, which should
+		 * notice.  Level-triggered HUP/ERR keep coming even for write
+		 * only fds though, so those need to go to the writer too.
+		 */
+		if (revents & (EPOLLIN | EPOLLHUP | EPOLLERR))
+			event_epoll_ready(m, m->read, fd);
+		if (revents & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+			event_epoll_ready(m, m->write, fd);
+
+		event_epoll_dirty(m, fd);
+	}
+	ep->nevents = 0;
+
+	/* backwards, releasing the last task drops fd from the array */
+	for (unsigned int i = ep->nalways; i-- > 0;) {
+		fd = ep->always[i];
+
+		event_epoll_ready(m, m->read, fd);
+		event_epoll_ready(m, m->write, fd);
+		event_epoll_dirty(m, fd);
+	}
+}
+
+bool event_set_io_backend(const char *name)
+{
+	if (!strcmp(name, "poll"))
+		io_backend_epoll = false;
+	else if (!strcmp(name, "epoll"))
+		io_backend_epoll = true;
+	else
+		return false;
+	return true;
+}
+#else /* !GNU_LINUX */
+struct event_io_epoll {
+	int maxfd;
+};
+
+static void event_epoll_init(struct event_loop *m)
+{
+}
+
+static void event_epoll_fini(struct event_loop *m)
+{
+}
+
+static void event_epoll_dirty(struct event_loop *m, int fd)
+{
+}
+
+static void event_epoll_release(struct event_loop *m, int fd, short gone)
+{
+}
+
+static void event_epoll_sync(struct event_loop *m)
+{
+}
+
+static unsigned int event_epoll_count(struct event_loop *m)
+{
+	return 0;
+}
+
+static short event_epoll_events(struct event_loop *m, int fd)
+{
+	return 0;
+}
+
+static int event_epoll_wait(struct event_loop *m, int timeout,
+			    const sigset_t *sigmask)
+{
+	return -1;
+}
+
+static void event_epoll_process(struct event_loop *m)
+{
+}
+
+bool event_set_io_backend(const char *name)
+{
+	return !strcmp(name, "poll");
+}
+#endif /* !GNU_LINUX */
 
 #if defined(__APPLE__)
 #include <mach/mach.h>
@@ -119,6 +674,51 @@ static void cpu_record_hash_free(void *a)
 	XFREE(MTYPE_EVENT_STATS, hist);
 }
 
+static inline unsigned int event_hist_bucket(unsigned long usec)
+{
+	if (usec < 2)
+		return 0;
+	return MIN(63 - __builtin_clzll(usec), EVENT_HIST_BUCKETS - 1);
+}
+
+/* upper bound of the bucket that holds the given percentile */
+static unsigned long event_hist_percentile(const size_t *buckets, size_t total,
+					   unsigned int pct, size_t max)
+{
+	size_t seen = 0, want = (total * pct + 99) / 100;
+
+	for (unsigned int i = 0; i < EVENT_HIST_BUCKETS - 1; i++) {
+		seen += buckets[i];
+		if (seen >= want)
+			return MIN(2UL << i, max);
+	}
+	return max;
+}
+
+static void event_hist_load(size_t *dst, atomic_size_t *src)
+{
+	for (unsigned int i = 0; i < EVENT_HIST_BUCKETS; i++)
+		dst[i] = atomic_load_explicit(&src[i], memory_order_relaxed);
+}
+
+static json_object *event_hist_json(const size_t *buckets)
+{
+	json_object *json = json_object_new_object();
+	char key[16];
+
+	for (unsigned int i = 0; i < EVENT_HIST_BUCKETS; i++) {
+		if (!buckets[i])
+			continue;
+
+		if (i == EVENT_HIST_BUCKETS - 1)
+			snprintf(key, sizeof(key), "+Inf");
+		else
+			snprintf(key, sizeof(key), "%lu", 2UL << i);
+		json_object_int_add(json, key, buckets[i]);
+	}
+	return json;
+}
+
 static void vty_out_cpu_event_history(struct vty *vty,
 				      struct cpu_event_history *a)
 {
@@ -278,6 +878,14 @@ static void cpu_record_clear(uint8_t filter)
 						  void *))cpu_record_hash_clear,
 					args);
 			}
+
+			for (unsigned int i = 0; i < EVENT_HIST_BUCKETS; i++)
+				atomic_store_explicit(&m->timer_lag[i], 0,
+						      memory_order_relaxed);
+			atomic_store_explicit(&m->timer_lag_max, 0,
+					      memory_order_relaxed);
+			atomic_store_explicit(&m->timer_lag_avg, 0,
+					      memory_order_relaxed);
 		}
 	}
 }
@@ -342,6 +950,112 @@ DEFUN_NOSH (show_thread_cpu,
 	return CMD_SUCCESS;
 }
 
+struct cpu_histogram_args {
+	struct vty *vty;
+	json_object *json;
+};
+
+static void cpu_histogram_hash_print(struct hash_bucket *bucket, void *arg)
+{
+	struct cpu_histogram_args *args = arg;
+	struct cpu_event_history *a = bucket->data;
+	size_t buckets[EVENT_HIST_BUCKETS];
+	size_t calls = 0, max;
+	json_object *json_task;
+
+	event_hist_load(buckets, a->real_hist);
+	for (unsigned int i = 0; i < EVENT_HIST_BUCKETS; i++)
+		calls += buckets[i];
+	if (!calls)
+		return;
+
+	max = atomic_load_explicit(&a->real.max, memory_order_relaxed);
+
+	if (args->json) {
+		json_task = json_object_new_object();
+		json_object_int_add(json_task, "calls", calls);
+		json_object_int_add(json_task, "maxUsec", max);
+		json_object_object_add(json_task, "buckets",
+				       event_hist_json(buckets));
+		json_object_object_add(args->json, a->funcname, json_task);
+		return;
+	}
+
+	vty_out(args->vty, "  %-40s %10zu %8lu %8lu %8lu %8zu\n", a->funcname,
+		calls, event_hist_percentile(buckets, calls, 50, max),
+		event_hist_percentile(buckets, calls, 90, max),
+		event_hist_percentile(buckets, calls, 99, max), max);
+}
+
+static void cpu_histogram_print(struct vty *vty, struct event_loop *m,
+				json_object *json)
+{
+	const char *name = m->name ? m->name : "main";
+	struct cpu_histogram_args args = { .vty = vty };
+	size_t lag[EVENT_HIST_BUCKETS];
+	size_t timers = 0, lag_max;
+	json_object *json_loop = NULL, *json_lag;
+
+	event_hist_load(lag, m->timer_lag);
+	for (unsigned int i = 0; i < EVENT_HIST_BUCKETS; i++)
+		timers += lag[i];
+	lag_max = atomic_load_explicit(&m->timer_lag_max,
+				       memory_order_relaxed);
+
+	if (json) {
+		json_loop = json_object_new_object();
+		json_lag = json_object_new_object();
+		json_object_int_add(json_lag, "timers", timers);
+		json_object_int_add(json_lag, "maxUsec", lag_max);
+		json_object_object_add(json_lag, "buckets",
+				       event_hist_json(lag));
+		json_object_object_add(json_loop, "timerLag", json_lag);
+
+		args.json = json_object_new_object();
+		json_object_object_add(json_loop, "tasks", args.json);
+		json_object_object_add(json, name, json_loop);
+	} else {
+		vty_out(vty, "\nLatency histograms for pthread %s\n", name);
+		vty_out(vty, "  Timer lag (usec): %zu timers", timers);
+		if (timers)
+			vty_out(vty, ", p50 %lu, p90 %lu, p99 %lu, max %zu",
+				event_hist_percentile(lag, timers, 50, lag_max),
+				event_hist_percentile(lag, timers, 90, lag_max),
+				event_hist_percentile(lag, timers, 99, lag_max),
+				lag_max);
+		vty_out(vty, "\n\n  %-40s %10s %8s %8s %8s %8s\n",
+			"Task runtime (usec)", "Calls", "p50", "p90", "p99",
+			"Max");
+	}
+
+	frr_with_mutex (&m->mtx) {
+		hash_iterate(m->cpu_record, cpu_histogram_hash_print, &args);
+	}
+}
+
+DEFPY_NOSH (show_event_cpu_histogram,
+	    show_event_cpu_histogram_cmd,
+	    "show event cpu histogram [json$uj]",
+	    SHOW_STR
+	    "Event information\n"
+	    "Event CPU usage\n"
+	    "Latency histograms of task runtime and timer lag\n"
+	    JSON_STR)
+{
+	json_object *json = uj ? json_object_new_object() : NULL;
+	struct event_loop *m;
+	struct listnode *ln;
+
+	frr_with_mutex (&masters_mtx) {
+		for (ALL_LIST_ELEMENTS_RO(masters, ln, m))
+			cpu_histogram_print(vty, m, json);
+	}
+
+	if (json)
+		return vty_json(vty, json);
+	return CMD_SUCCESS;
+}
+
 DEFPY (service_cputime_stats,
        service_cputime_stats_cmd,
        "[no] service cputime-stats",
@@ -409,6 +1123,27 @@ static void show_thread_poll_helper(struct vty *vty, struct event_loop *m)
 
 	vty_out(vty, "\nShowing poll FD's for %s\n", name);
 	vty_out(vty, "----------------------%s\n", underline);
+
+	if (m->handler.epoll) {
+		struct event *rthread, *wthread;
+		int fd;
+
+		vty_out(vty, "Count: %u/%d\n", event_epoll_count(m),
+			m->fd_limit);
+		for (fd = 0; fd <= m->handler.epoll->maxfd; fd++) {
+			rthread = m->read[fd];
+			wthread = m->write[fd];
+			if (!rthread && !wthread)
+				continue;
+
+			vty_out(vty, "\t fd:%6d events:%2d\t\t%s %s\n", fd,
+				event_epoll_events(m, fd),
+				rthread ? rthread->xref->funcname : "",
+				wthread ? wthread->xref->funcname : "");
+		}
+		return;
+	}
+
 	vty_out(vty, "Count: %u/%d\n", (uint32_t)m->handler.pfdcount,
 		m->fd_limit);
 	for (i = 0; i < m->handler.pfdcount; i++) {
@@ -457,6 +1192,54 @@ DEFUN_NOSH (show_thread_poll,
 }
 
 
+static void show_event_poll_helper(struct vty *vty, struct event_loop *m)
+{
+	const char *name = m->name ? m->name : "main";
+	char underline[strlen(name) + 1];
+	unsigned int nfds;
+
+	memset(underline, '-', sizeof(underline));
+	underline[sizeof(underline) - 1] = '\0';
+
+	vty_out(vty, "\nI/O statistics for %s\n", name);
+	vty_out(vty, "---------------------%s\n", underline);
+
+	frr_with_mutex (&m->mtx) {
+		nfds = m->handler.epoll ? event_epoll_count(m)
+					: m->handler.pfdcount;
+
+		vty_out(vty, "  Backend: %s\n",
+			m->handler.epoll ? "epoll" : "poll");
+		vty_out(vty, "  File descriptors: %u/%d\n", nfds, m->fd_limit);
+		vty_out(vty, "  Waits: %zu, ready fds: %zu\n",
+			m->handler.stats.waits, m->handler.stats.events);
+		if (m->handler.epoll)
+			vty_out(vty, "  epoll_ctl() calls: %zu\n",
+				m->handler.stats.ctl);
+		else
+			vty_out(vty, "  fds passed to poll(): %zu\n",
+				m->handler.stats.polled);
+	}
+}
+
+DEFPY_NOSH (show_event_poll,
+	    show_event_poll_cmd,
+	    "show event poll",
+	    SHOW_STR
+	    "Event information\n"
+	    "I/O backend and statistics\n")
+{
+	struct listnode *node;
+	struct event_loop *m;
+
+	frr_with_mutex (&masters_mtx) {
+		for (ALL_LIST_ELEMENTS_RO(masters, node, m))
+			show_event_poll_helper(vty, m);
+	}
+
+	return CMD_SUCCESS;
+}
+
 DEFUN (clear_thread_cpu,
        clear_thread_cpu_cmd,
        "clear thread cpu [FILTER]",
@@ -497,6 +1280,14 @@ static void show_thread_timers_helper(struct vty *vty, struct event_loop *m)
 	frr_each (event_timer_list, &m->timer, thread) {
 		vty_out(vty, "  %-50s%pTH\n", thread->hist->funcname, thread);
 	}
+
+	if (!m->wheel || !m->wheel->count)
+		return;
+
+	for (size_t i = 0; i < EVENT_WHEEL_SLOTS; i++)
+		frr_each (event_wheel_list, &m->wheel->slots[i], thread)
+			vty_out(vty, "  %-50s%pTH\n", thread->hist->funcname,
+				thread);
 }
 
 DEFPY_NOSH (show_thread_timers,
@@ -517,10 +1308,80 @@ DEFPY_NOSH (show_thread_timers,
 	return CMD_SUCCESS;
 }
 
+static void show_event_timers_hash_print(struct hash_bucket *bucket,
+					 void *arg)
+{
+	struct cpu_event_history *hist = bucket->data;
+	struct vty *vty = arg;
+	size_t added, cancelled;
+
+	added = atomic_load_explicit(&hist->total_timer_add,
+				     memory_order_relaxed);
+	if (!added)
+		return;
+
+	cancelled = atomic_load_explicit(&hist->total_timer_cancel,
+					 memory_order_relaxed);
+	vty_out(vty, "  %12zu %12zu %5zu%%  %s\n", added, cancelled,
+		cancelled * 100 / added, hist->funcname);
+}
+
+static void show_event_timers_helper(struct vty *vty, struct event_loop *m)
+{
+	const char *name = m->name ? m->name : "main";
+	char underline[strlen(name) + 1];
+
+	memset(underline, '-', sizeof(underline));
+	underline[sizeof(underline) - 1] = '\0';
+
+	vty_out(vty, "\nTimer statistics for %s\n", name);
+	vty_out(vty, "-----------------------%s\n", underline);
+
+	frr_with_mutex (&m->mtx) {
+		size_t on_wheel = m->wheel ? m->wheel->count : 0;
+
+		vty_out(vty, "  Timer wheel: %s\n",
+			m->wheel && m->wheel->enabled ? "enabled" : "disabled");
+		vty_out(vty, "  Pending: %zu (heap %zu, wheel %zu)\n",
+			event_timer_list_count(&m->timer) + on_wheel,
+			event_timer_list_count(&m->timer), on_wheel);
+		vty_out(vty, "  Added: %zu, cancelled: %zu\n",
+			m->timer_stats.added, m->timer_stats.cancelled);
+		if (m->wheel)
+			vty_out(vty,
+				"  Added to wheel: %zu, moved to heap: %zu\n",
+				m->timer_stats.wheel_added,
+				m->timer_stats.wheel_moved);
+
+		vty_out(vty, "\n  %12s %12s %6s  %s\n", "Added", "Cancelled",
+			"Churn", "Task");
+		hash_iterate(m->cpu_record, show_event_timers_hash_print, vty);
+	}
+}
+
+DEFPY_NOSH (show_event_timers,
+	    show_event_timers_cmd,
+	    "show event timers",
+	    SHOW_STR
+	    "Event information\n"
+	    "Summary of timer counts and churn\n")
+{
+	struct listnode *node;
+	struct event_loop *m;
+
+	frr_with_mutex (&masters_mtx) {
+		for (ALL_LIST_ELEMENTS_RO(masters, node, m))
+			show_event_timers_helper(vty, m);
+	}
+
+	return CMD_SUCCESS;
+}
+
 void event_cmd_init(void)
 {
 	install_element(VIEW_NODE, &show_thread_cpu_cmd);
 	install_element(VIEW_NODE, &show_thread_poll_cmd);
+	install_element(VIEW_NODE, &show_event_cpu_histogram_cmd);
 	install_element(ENABLE_NODE, &clear_thread_cpu_cmd);
 
 	install_element(CONFIG_NODE, &service_cputime_stats_cmd);
@@ -530,6 +1391,8 @@ void event_cmd_init(void)
 	install_element(CONFIG_NODE, &no_service_walltime_warning_cmd);
 
 	install_element(VIEW_NODE, &show_thread_timers_cmd);
+	install_element(VIEW_NODE, &show_event_timers_cmd);
+	install_element(VIEW_NODE, &show_event_poll_cmd);
 }
 /* CLI end ------------------------------------------------------------------ */
 
@@ -614,6 +1477,8 @@ struct event_loop *event_master_create(const char *name)
 	rv->handler.copy = XCALLOC(MTYPE_EVENT_MASTER,
 				   sizeof(struct pollfd) * rv->handler.pfdsize);
 
+	event_epoll_init(rv);
+
 	/* add to list of threadmasters */
 	frr_with_mutex (&masters_mtx) {
 		if (!masters)
@@ -714,6 +1579,14 @@ void event_master_free(struct event_loop *m)
 	thread_array_free(m, m->write);
 	while ((t = event_timer_list_pop(&m->timer)))
 		thread_free(m, t);
+	if (m->wheel) {
+		for (size_t i = 0; i < EVENT_WHEEL_SLOTS; i++) {
+			while ((t = event_wheel_list_pop(&m->wheel->slots[i])))
+				thread_free(m, t);
+			event_wheel_list_fini(&m->wheel->slots[i]);
+		}
+		XFREE(MTYPE_EVENT_WHEEL, m->wheel);
+	}
 	thread_list_free(m, &m->event);
 	thread_list_free(m, &m->ready);
 	thread_list_free(m, &m->unuse);
@@ -729,6 +1602,7 @@ void event_master_free(struct event_loop *m)
 	XFREE(MTYPE_EVENT_MASTER, m->name);
 	XFREE(MTYPE_EVENT_MASTER, m->handler.pfds);
 	XFREE(MTYPE_EVENT_MASTER, m->handler.copy);
+	event_epoll_fini(m);
 	XFREE(MTYPE_EVENT_MASTER, m);
 }
 
@@ -889,10 +1763,12 @@ static int fd_poll(struct event_loop *m, const struct timeval *timer_wait,
 	rcu_assert_read_unlocked();
 
 	/* add poll pipe poker */
-	assert(count + 1 < m->handler.pfdsize);
-	m->handler.copy[count].fd = m->io_pipe[0];
-	m->handler.copy[count].events = POLLIN;
-	m->handler.copy[count].revents = 0x00;
+	if (!m->handler.epoll) {
+		assert(count + 1 < m->handler.pfdsize);
+		m->handler.copy[count].fd = m->io_pipe[0];
+		m->handler.copy[count].events = POLLIN;
+		m->handler.copy[count].revents = 0x00;
+	}
 
 	/* We need to deal with a signal-handling race here: we
 	 * don't want to miss a crucial signal, such as SIGTERM or SIGINT,
@@ -917,6 +1793,13 @@ static int fd_poll(struct event_loop *m, const struct timeval *timer_wait,
 		pthread_sigmask(SIG_SETMASK, NULL, &origsigs);
 	}
 
+	if (m->handler.epoll) {
+		/* epoll_pwait() swaps the signal mask just like ppoll() */
+		num = event_epoll_wait(m, timeout, &origsigs);
+		pthread_sigmask(SIG_SETMASK, &origsigs, NULL);
+		goto done;
+	}
+
 #if defined(HAVE_PPOLL)
 	struct timespec ts, *tsp;
 
@@ -940,7 +1823,8 @@ done:
 	if (num < 0 && errno == EINTR)
 		*eintr_p = true;
 
-	if (num > 0 && m->handler.copy[count].revents != 0 && num--)
+	if (!m->handler.epoll && num > 0 &&
+	    m->handler.copy[count].revents != 0 && num--)
 		while (read(m->io_pipe[0], &trash, sizeof(trash)) > 0)
 			;
 
@@ -984,6 +1868,12 @@ void _event_add_read_write(const struct xref_eventsched *xref,
 		else
 			thread_array = m->write;
 
+		if (m->handler.epoll) {
+			thread = thread_get(m, dir, func, arg, xref);
+			event_epoll_dirty(m, fd);
+			goto added;
+		}
+
 		/*
 		 * if we already have a pollfd for our file descriptor, find and
 		 * use it
@@ -1015,6 +1905,7 @@ void _event_add_read_write(const struct xref_eventsched *xref,
 		if (queuepos == m->handler.pfdcount)
 			m->handler.pfdcount++;
 
+added:
 		if (thread) {
 			frr_with_mutex (&thread->mtx) {
 				thread->u.fd = fd;
@@ -1039,6 +1930,7 @@ static void _event_add_timer_timeval(const struct xref_eventsched *xref,
 {
 	struct event *thread;
 	struct timeval t;
+	bool wheel_first = false;
 
 	assert(m != NULL);
 
@@ -1061,18 +1953,26 @@ static void _event_add_timer_timeval(const struct xref_eventsched *xref,
 
 		frr_with_mutex (&thread->mtx) {
 			thread->u.sands = t;
-			event_timer_list_add(&m->timer, thread);
+			thread->on_wheel = false;
+			if (event_wheel_add(m, thread))
+				wheel_first = m->wheel->next ==
+					      event_wheel_tick(&t);
+			else
+				event_timer_list_add(&m->timer, thread);
 			if (t_ptr) {
 				*t_ptr = thread;
 				thread->ref = t_ptr;
 			}
 		}
+		m->timer_stats.added++;
+		atomic_fetch_add_explicit(&thread->hist->total_timer_add, 1,
+					  memory_order_relaxed);
 
 		/* The timer list is sorted - if this new timer
 		 * might change the time we'll wait for, give the pthread
 		 * a chance to re-compute.
 		 */
-		if (event_timer_list_first(&m->timer) == thread)
+		if (wheel_first || event_timer_list_first(&m->timer) == thread)
 			AWAKEN(m);
 	}
 #define ONEYEAR2SEC (60 * 60 * 24 * 365)
@@ -1179,6 +2079,12 @@ static void event_cancel_rw(struct event_loop *master, int fd, short state,
 	/* find the index of corresponding pollfd */
 	nfds_t i;
 
+	/* the caller clears the task array afterwards */
+	if (master->handler.epoll) {
+		event_epoll_release(master, fd, state & (POLLIN | POLLOUT));
+		return;
+	}
+
 	/* Cancel POLLHUP too just in case some bozo set it */
 	state |= POLLHUP;
 
@@ -1275,6 +2181,24 @@ static void cancel_arg_helper(struct event_loop *master,
 		return;
 
 	/* Check the io tasks */
+	if (master->handler.epoll) {
+		for (fd = 0; fd <= master->handler.epoll->maxfd; fd++) {
+			struct event **arrays[2] = {master->read, master->write};
+
+			for (i = 0; i < array_size(arrays); i++) {
+				t = arrays[i][fd];
+				if (!t || t->arg != cr->eventobj)
+					continue;
+
+				arrays[i][fd] = NULL;
+				event_epoll_release(master, fd, 0);
+				if (t->ref)
+					*t->ref = NULL;
+				thread_add_unuse(master, t);
+			}
+		}
+	}
+
 	for (i = 0; i < master->handler.pfdcount;) {
 		pfd = master->handler.pfds + i;
 
@@ -1315,6 +2239,7 @@ static void cancel_arg_helper(struct event_loop *master,
 
 		if (t->arg == cr->eventobj) {
 			event_timer_list_del(&master->timer, t);
+			event_timer_cancelled(master, t);
 			if (t->ref)
 				*t->ref = NULL;
 			thread_add_unuse(master, t);
@@ -1322,6 +2247,22 @@ static void cancel_arg_helper(struct event_loop *master,
 
 		t = t_next;
 	}
+
+	if (!master->wheel || !master->wheel->count)
+		return;
+
+	for (size_t i = 0; i < EVENT_WHEEL_SLOTS; i++) {
+		frr_each_safe (event_wheel_list, &master->wheel->slots[i], t) {
+			if (t->arg != cr->eventobj)
+				continue;
+
+			event_wheel_del(master, t);
+			event_timer_cancelled(master, t);
+			if (t->ref)
+				*t->ref = NULL;
+			thread_add_unuse(master, t);
+		}
+	}
 }
 
 /**
@@ -1376,7 +2317,8 @@ static void do_event_cancel(struct event_loop *master)
 			thread_array = master->write;
 			break;
 		case EVENT_TIMER:
-			event_timer_list_del(&master->timer, thread);
+			event_timer_del(master, thread);
+			event_timer_cancelled(master, thread);
 			break;
 		case EVENT_EVENT:
 			list = &master->event;
@@ -1562,15 +2504,19 @@ void event_cancel_async(struct event_loop *master, struct event **thread,
 }
 /* ------------------------------------------------------------------------- */
 
-static struct timeval *thread_timer_wait(struct event_timer_list_head *timers,
+static struct timeval *thread_timer_wait(struct event_loop *m,
 					 struct timeval *timer_val)
 {
-	if (!event_timer_list_count(timers))
-		return NULL;
+	struct event *next_timer = event_timer_list_first(&m->timer);
+	const struct timeval *next = next_timer ? &next_timer->u.sands : NULL;
+	struct timeval wheel;
 
-	struct event *next_timer = event_timer_list_first(timers);
+	if (event_wheel_next(m, &wheel) && (!next || timercmp(&wheel, next, <)))
+		next = &wheel;
+	if (!next)
+		return NULL;
 
-	monotime_until(&next_timer->u.sands, timer_val);
+	monotime_until(next, timer_val);
 	return timer_val;
 }
 
@@ -1696,6 +2642,8 @@ static unsigned int thread_process_timers(struct event_loop *m,
 	struct event *thread;
 	unsigned int ready = 0;
 
+	event_wheel_advance(m, timenow);
+
 	while ((thread = event_timer_list_first(&m->timer))) {
 		if (timercmp(timenow, &thread->u.sands, <))
 			break;
@@ -1806,13 +2754,17 @@ struct event *event_fetch(struct event_loop *m, struct event *fetch)
 		 * once per loop to avoid starvation by events
 		 */
 		if (!event_list_count(&m->ready))
-			tw = thread_timer_wait(&m->timer, &tv);
+			tw = thread_timer_wait(m, &tv);
 
 		if (event_list_count(&m->ready) ||
 		    (tw && !timercmp(tw, &zerotime, >)))
 			tw = &zerotime;
 
-		if (!tw && m->handler.pfdcount == 0) { /* die */
+		if (m->handler.epoll)
+			event_epoll_sync(m);
+
+		if (!tw && m->handler.pfdcount == 0 &&
+		    (!m->handler.epoll || !event_epoll_count(m))) { /* die */
 			pthread_mutex_unlock(&m->mtx);
 			fetch = NULL;
 			break;
@@ -1825,6 +2777,8 @@ struct event *event_fetch(struct event_loop *m, struct event *fetch)
 		m->handler.copycount = m->handler.pfdcount;
 		memcpy(m->handler.copy, m->handler.pfds,
 		       m->handler.copycount * sizeof(struct pollfd));
+		m->handler.stats.waits++;
+		m->handler.stats.polled += m->handler.copycount;
 
 		pthread_mutex_unlock(&m->mtx);
 		{
@@ -1854,8 +2808,13 @@ struct event *event_fetch(struct event_loop *m, struct event *fetch)
 		thread_process_timers(m, &now);
 
 		/* Post I/O to ready queue. */
-		if (num > 0)
-			thread_process_io(m, num);
+		if (num > 0) {
+			m->handler.stats.events += num;
+			if (m->handler.epoll)
+				event_epoll_process(m);
+			else
+				thread_process_io(m, num);
+		}
 
 		pthread_mutex_unlock(&m->mtx);
 
@@ -1958,6 +2917,72 @@ void event_getrusage(RUSAGE_T *r)
 #endif
 }
 
+unsigned long event_loop_lag(struct event_loop *m)
+{
+	return atomic_load_explicit(&m->timer_lag_avg, memory_order_relaxed);
+}
+
+void event_loop_metrics(struct metrics_out *out)
+{
+	struct listnode *node;
+	struct event_loop *m;
+	size_t lag[EVENT_HIST_BUCKETS];
+
+	metrics_family(out, "frr_event_timer_lag_usec", METRICS_HISTOGRAM,
+		       "How late timers ran, per pthread");
+
+	frr_with_mutex (&masters_mtx) {
+		for (ALL_LIST_ELEMENTS_RO(masters, node, m)) {
+			event_hist_load(lag, m->timer_lag);
+			metrics_log2_histogram(out, "frr_event_timer_lag_usec",
+					       lag, EVENT_HIST_BUCKETS,
+					       "thread",
+					       m->name ? m->name : "main");
+		}
+	}
+
+	metrics_family(out, "frr_event_timer_lag_max_usec", METRICS_GAUGE,
+		       "Largest timer lag seen, per pthread");
+
+	frr_with_mutex (&masters_mtx) {
+		for (ALL_LIST_ELEMENTS_RO(masters, node, m))
+			metrics_sample(out, "frr_event_timer_lag_max_usec",
+				       atomic_load_explicit(&m->timer_lag_max,
+							    memory_order_relaxed),
+				       "thread", m->name ? m->name : "main",
+				       NULL);
+	}
+}
+
+/* how long after its scheduled time a timer actually got to run */
+static void event_timer_lag(struct event_loop *m, const struct event *thread,
+			    const struct timeval *start)
+{
+	struct timeval lag;
+	size_t usec = 0, exp;
+
+	if (timercmp(start, &thread->u.sands, >)) {
+		timersub(start, &thread->u.sands, &lag);
+		usec = lag.tv_sec * TIMER_SECOND_MICRO + lag.tv_usec;
+	}
+
+	atomic_fetch_add_explicit(&m->timer_lag[event_hist_bucket(usec)], 1,
+				  memory_order_relaxed);
+
+	/* only the loop's own pthread writes this */
+	exp = atomic_load_explicit(&m->timer_lag_avg, memory_order_relaxed);
+	atomic_store_explicit(&m->timer_lag_avg, exp - exp / 8 + usec / 8,
+			      memory_order_relaxed);
+
+	exp = atomic_load_explicit(&m->timer_lag_max, memory_order_relaxed);
+	while (exp < usec &&
+	       !atomic_compare_exchange_weak_explicit(&m->timer_lag_max, &exp,
+						      usec,
+						      memory_order_relaxed,
+						      memory_order_relaxed))
+		;
+}
+
 /*
  * Call a thread.
  *
@@ -2003,6 +3028,12 @@ void event_call(struct event *thread)
 
 	walltime = event_consumed_time(&after, &before, &cputime);
 
+	atomic_fetch_add_explicit(
+		&thread->hist->real_hist[event_hist_bucket(walltime)], 1,
+		memory_order_relaxed);
+	if (thread->add_type == EVENT_TIMER)
+		event_timer_lag(thread->master, thread, &before.real);
+
 	/* update walltime */
 	atomic_fetch_add_explicit(&thread->hist->real.total, walltime,
 				  memory_order_seq_cst);
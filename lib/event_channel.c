@@ -0,0 +1,313 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Cross-pthread message channel.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#ifdef GNU_LINUX
+#include <sys/eventfd.h>
+#endif
+
+#include "event_channel.h"
+#include "command.h"
+#include "frr_pthread.h"
+#include "lib_errors.h"
+#include "memory.h"
+#include "network.h"
+#include "typesafe.h"
+
+DEFINE_MTYPE_STATIC(LIB, EVENT_CHANNEL, "Event channel");
+
+DECLARE_ATOMLIST(event_channel_msgs, struct event_channel_msg, item);
+
+PREDECL_DLIST(event_channels);
+
+struct event_channel {
+	struct event_channels_item itm;
+
+	char *name;
+	struct event_loop *loop;
+	const struct event_channel_ops *ops;
+	void *arg;
+	size_t limit;
+
+	struct event_channel_msgs_head msgs;
+
+	/*
+	 * Messages sent and not received yet.  Unlike the list's count this
+	 * is bumped before a message is queued, which makes the limit exact
+	 * with concurrent senders.
+	 */
+	atomic_size_t depth;
+
+	/* wakeup fd, both are the same for an eventfd */
+	int fd_rd, fd_wr;
+	struct event *t_read;
+	struct event *t_run;
+
+	/* the consumer has been poked and hasn't run yet */
+	atomic_bool wake_pending;
+	/* a send failed since the last resume callback */
+	atomic_bool full;
+
+	atomic_size_t sent;
+	atomic_size_t received;
+	atomic_size_t wakeups;
+	atomic_size_t rejected;
+	atomic_size_t max_depth;
+};
+
+DECLARE_DLIST(event_channels, struct event_channel, itm);
+
+static pthread_mutex_t channels_mtx = PTHREAD_MUTEX_INITIALIZER;
+static struct event_channels_head channels = INIT_DLIST(channels);
+
+static void event_channel_read(struct event *event);
+static void event_channel_run(struct event *event);
+
+static void event_channel_poke(struct event_channel *chan)
+{
+#ifdef GNU_LINUX
+	uint64_t one = 1;
+#else
+	uint8_t one = 1;
+#endif
+
+	atomic_fetch_add_explicit(&chan->wakeups, 1, memory_order_relaxed);
+	if (write(chan->fd_wr, &one, sizeof(one)) < 0 && errno != EAGAIN)
+		flog_err_sys(EC_LIB_SYSTEM_CALL,
+			     "%s: wakeup for channel %s failed: %s", __func__,
+			     chan->name, safe_strerror(errno));
+}
+
+static void event_channel_drain_fd(struct event_channel *chan)
+{
+	uint8_t trash[64];
+
+	while (read(chan->fd_rd, trash, sizeof(trash)) > 0)
+		;
+}
+
+struct event_channel *event_channel_new(const char *name,
+					struct event_loop *loop, size_t limit,
+					const struct event_channel_ops *ops,
+					void *arg)
+{
+	struct event_channel *chan;
+
+	chan = XCALLOC(MTYPE_EVENT_CHANNEL, sizeof(*chan));
+	chan->name = XSTRDUP(MTYPE_EVENT_CHANNEL, name);
+	chan->loop = loop;
+	chan->limit = limit;
+	chan->ops = ops;
+	chan->arg = arg;
+	event_channel_msgs_init(&chan->msgs);
+
+#ifdef GNU_LINUX
+	chan->fd_rd = chan->fd_wr = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (chan->fd_rd < 0) {
+		flog_err_sys(EC_LIB_SYSTEM_CALL, "%s: eventfd() failed: %s",
+			     __func__, safe_strerror(errno));
+		exit(1);
+	}
+#else
+	int fds[2];
+
+	if (pipe(fds) < 0) {
+		flog_err_sys(EC_LIB_SYSTEM_CALL, "%s: pipe() failed: %s",
+			     __func__, safe_strerror(errno));
+		exit(1);
+	}
+	set_nonblocking(fds[0]);
+	set_nonblocking(fds[1]);
+	set_cloexec(fds[0]);
+	set_cloexec(fds[1]);
+	chan->fd_rd = fds[0];
+	chan->fd_wr = fds[1];
+#endif
+
+	event_add_read(loop, event_channel_read, chan, chan->fd_rd,
+		       &chan->t_read);
+
+	frr_with_mutex (&channels_mtx) {
+		event_channels_add_tail(&channels, chan);
+	}
+	return chan;
+}
+
+void event_channel_free(struct event_channel **chanp,
+			void (*del_msg)(struct event_channel_msg *msg))
+{
+	struct event_channel *chan = *chanp;
+	struct event_channel_msg *msg;
+
+	if (!chan)
+		return;
+
+	frr_with_mutex (&channels_mtx) {
+		event_channels_del(&channels, chan);
+	}
+
+	event_cancel(&chan->t_read);
+	event_cancel(&chan->t_run);
+
+	while ((msg = event_channel_msgs_pop(&chan->msgs)))
+		if (del_msg)
+			del_msg(msg);
+	event_channel_msgs_fini(&chan->msgs);
+
+	close(chan->fd_rd);
+	if (chan->fd_wr != chan->fd_rd)
+		close(chan->fd_wr);
+
+	XFREE(MTYPE_EVENT_CHANNEL, chan->name);
+	XFREE(MTYPE_EVENT_CHANNEL, *chanp);
+}
+
+bool event_channel_send(struct event_channel *chan,
+			struct event_channel_msg *msg)
+{
+	size_t depth, max;
+
+	depth = atomic_fetch_add_explicit(&chan->depth, 1,
+					  memory_order_relaxed) + 1;
+	if (chan->limit && depth > chan->limit) {
+		atomic_fetch_sub_explicit(&chan->depth, 1,
+					  memory_order_relaxed);
+		atomic_fetch_add_explicit(&chan->rejected, 1,
+					  memory_order_relaxed);
+		atomic_store_explicit(&chan->full, true, memory_order_relaxed);
+		return false;
+	}
+
+	max = atomic_load_explicit(&chan->max_depth, memory_order_relaxed);
+	while (max < depth &&
+	       !atomic_compare_exchange_weak_explicit(&chan->max_depth, &max,
+						      depth,
+						      memory_order_relaxed,
+						      memory_order_relaxed))
+		;
+
+	event_channel_msgs_add_tail(&chan->msgs, msg);
+	atomic_fetch_add_explicit(&chan->sent, 1, memory_order_relaxed);
+
+	/*
+	 * Only poke the consumer once until it runs.  This has to come after
+	 * the message is on the list: the consumer clears the flag before
+	 * looking at the list, so either it sees the message or we poke it.
+	 */
+	if (!atomic_exchange_explicit(&chan->wake_pending, true,
+				      memory_order_seq_cst))
+		event_channel_poke(chan);
+
+	return true;
+}
+
+struct event_channel_msg *event_channel_recv(struct event_channel *chan)
+{
+	struct event_channel_msg *msg;
+
+	msg = event_channel_msgs_pop(&chan->msgs);
+	if (!msg)
+		return NULL;
+
+	atomic_fetch_sub_explicit(&chan->depth, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&chan->received, 1, memory_order_relaxed);
+	return msg;
+}
+
+size_t event_channel_recv_batch(struct event_channel *chan,
+				struct event_channel_msg **msgs, size_t max)
+{
+	size_t i;
+
+	for (i = 0; i < max; i++) {
+		msgs[i] = event_channel_recv(chan);
+		if (!msgs[i])
+			break;
+	}
+	return i;
+}
+
+size_t event_channel_depth(struct event_channel *chan)
+{
+	return atomic_load_explicit(&chan->depth, memory_order_relaxed);
+}
+
+static void event_channel_deliver(struct event_channel *chan)
+{
+	atomic_store_explicit(&chan->wake_pending, false, memory_order_seq_cst);
+
+	chan->ops->recv(chan, chan->arg);
+
+	if (chan->limit && atomic_load_explicit(&chan->full,
+						memory_order_relaxed) &&
+	    event_channel_depth(chan) <= chan->limit / 2) {
+		atomic_store_explicit(&chan->full, false,
+				      memory_order_relaxed);
+		if (chan->ops->resume)
+			chan->ops->resume(chan, chan->arg);
+	}
+
+	/* recv() stopped early, or a message is still being added */
+	if (event_channel_msgs_count(&chan->msgs))
+		event_add_event(chan->loop, event_channel_run, chan, 0,
+				&chan->t_run);
+}
+
+static void event_channel_read(struct event *event)
+{
+	struct event_channel *chan = EVENT_ARG(event);
+
+	event_add_read(chan->loop, event_channel_read, chan, chan->fd_rd,
+		       &chan->t_read);
+
+	event_channel_drain_fd(chan);
+	event_channel_deliver(chan);
+}
+
+static void event_channel_run(struct event *event)
+{
+	event_channel_deliver(EVENT_ARG(event));
+}
+
+DEFUN_NOSH (show_event_channels,
+	    show_event_channels_cmd,
+	    "show event channels",
+	    SHOW_STR
+	    "Event information\n"
+	    "Cross-pthread message channels\n")
+{
+	struct event_channel *chan;
+
+	vty_out(vty, "%-32s %8s %8s %8s %10s %10s %10s %10s\n", "Channel",
+		"Depth", "Limit", "Max", "Sent", "Received", "Wakeups",
+		"Rejected");
+
+	frr_with_mutex (&channels_mtx) {
+		frr_each (event_channels, &channels, chan)
+			vty_out(vty,
+				"%-32s %8zu %8zu %8zu %10zu %10zu %10zu %10zu\n",
+				chan->name, event_channel_depth(chan),
+				chan->limit,
+				atomic_load_explicit(&chan->max_depth,
+						     memory_order_relaxed),
+				atomic_load_explicit(&chan->sent,
+						     memory_order_relaxed),
+				atomic_load_explicit(&chan->received,
+						     memory_order_relaxed),
+				atomic_load_explicit(&chan->wakeups,
+						     memory_order_relaxed),
+				atomic_load_explicit(&chan->rejected,
+						     memory_order_relaxed));
+	}
+
+	return CMD_SUCCESS;
+}
+
+void event_channel_cmd_init(void)
+{
+	install_element(VIEW_NODE, &show_event_channels_cmd);
+}
@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Cross-pthread message channel.
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * Any number of pthreads can send messages to a channel, which delivers them
+ * on the event loop of the one pthread that consumes them.  Messages are
+ * queued on a lock-free list; the consumer is woken up through a file
+ * descriptor (an eventfd on Linux) and only once for any number of messages
+ * sent until it gets to run.
+ *
+ * Channels can be bounded: event_channel_send() fails once the limit is
+ * reached, and the resume callback tells the consumer when the channel has
+ * drained to half of its limit again, so producers can be restarted.
+ */
+
+#ifndef _FRR_EVENT_CHANNEL_H
+#define _FRR_EVENT_CHANNEL_H
+
+#include "atomlist.h"
+#include "frrevent.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+PREDECL_ATOMLIST(event_channel_msgs);
+
+/* embed this in the messages sent over a channel */
+struct event_channel_msg {
+	struct event_channel_msgs_item item;
+};
+
+struct event_channel;
+
+struct event_channel_ops {
+	/*
+	 * Consumer pthread: messages are waiting, fetch them with
+	 * event_channel_recv() or event_channel_recv_batch().  Anything left
+	 * on the channel on return is delivered again on the next run.
+	 */
+	void (*recv)(struct event_channel *chan, void *arg);
+
+	/*
+	 * Consumer pthread, optional: a send failed because the channel was
+	 * full, and it has drained to half its limit since.
+	 */
+	void (*resume)(struct event_channel *chan, void *arg);
+};
+
+/*
+ * Create a channel delivering to the given event loop.  limit is the
+ * maximum number of queued messages, 0 for no limit.
+ */
+extern struct event_channel *event_channel_new(const char *name,
+					       struct event_loop *loop,
+					       size_t limit,
+					       const struct event_channel_ops *ops,
+					       void *arg);
+
+/*
+ * Consumer pthread, with no producers left; messages still on the channel
+ * are handed to del_msg (if given).
+ */
+extern void event_channel_free(struct event_channel **chanp,
+			       void (*del_msg)(struct event_channel_msg *msg));
+
+/* Any pthread.  Returns false (and doesn't queue msg) if the channel is full */
+extern bool event_channel_send(struct event_channel *chan,
+			       struct event_channel_msg *msg);
+
+/* Consumer pthread.  NULL if there's nothing (left) to receive */
+extern struct event_channel_msg *event_channel_recv(struct event_channel *chan);
+extern size_t event_channel_recv_batch(struct event_channel *chan,
+				       struct event_channel_msg **msgs,
+				       size_t max);
+
+/* messages currently queued (including ones still being added) */
+extern size_t event_channel_depth(struct event_channel *chan);
+
+extern void event_channel_cmd_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_EVENT_CHANNEL_H */
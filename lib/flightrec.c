@@ -0,0 +1,411 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Flight recorder: per-pthread binary trace rings.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include <sys/mman.h>
+
+#include "flightrec.h"
+#include "command.h"
+#include "frr_pthread.h"
+#include "memory.h"
+#include "printfrr.h"
+#include "typesafe.h"
+#include "zlog.h"
+
+#ifndef thread_local
+#define thread_local __thread
+#endif
+
+DEFINE_MTYPE_STATIC(LIB, FLIGHTREC, "Flight recorder");
+
+/*
+ * On-disk layout, also parsed by tools/frr_flightrec.py - keep in sync.
+ * Everything is in host byte order.
+ */
+#define FLIGHTREC_MAGIC "FRRFLTR1"
+#define FLIGHTREC_RECS	4096
+
+struct flightrec_hdr {
+	char magic[8];
+	uint32_t hdr_size;
+	uint32_t rec_size;
+	uint32_t nrecs;
+	uint32_t _pad;
+	int64_t tid;
+	/* CLOCK_REALTIME - CLOCK_MONOTONIC when the ring was set up, in ns */
+	int64_t realtime_offset;
+	/* number of records written so far */
+	_Atomic uint64_t head;
+
+	uint8_t _pad2[16];
+};
+
+struct flightrec_rec {
+	/*
+	 * head value after this record was written; 0 while the record is
+	 * being written.  Readers check it is the same before and after
+	 * copying the record.
+	 */
+	_Atomic uint64_t seq;
+	/* CLOCK_MONOTONIC, in ns */
+	uint64_t ts;
+	/* struct xref_flightrec *, resolved through the sites file */
+	uint64_t xref;
+	uint64_t args[FLIGHTREC_NARGS];
+};
+
+#define FLIGHTREC_SIZE                                                         \
+	(sizeof(struct flightrec_hdr) +                                        \
+	 FLIGHTREC_RECS * sizeof(struct flightrec_rec))
+
+PREDECL_DLIST(flightrec_rings);
+
+struct flightrec_ring {
+	struct flightrec_rings_item itm;
+
+	struct flightrec_hdr *hdr;
+	struct flightrec_rec *recs;
+	bool do_unlink;
+};
+
+DECLARE_DLIST(flightrec_rings, struct flightrec_ring, itm);
+
+static pthread_mutex_t rings_mtx = PTHREAD_MUTEX_INITIALIZER;
+static struct flightrec_rings_head rings = INIT_DLIST(rings);
+
+static thread_local struct flightrec_ring *flightrec_ring;
+
+static pthread_mutex_t sites_mtx = PTHREAD_MUTEX_INITIALIZER;
+static int sites_fd = -1;
+
+static int64_t timespec_ns(const struct timespec *ts)
+{
+	return (int64_t)ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+/* append a line describing the call site, so records can be decoded */
+static void flightrec_describe(const struct xref_flightrec *xref,
+			       struct xrefdata_flightrec *xrd)
+{
+	char buf[1024];
+	ssize_t len;
+
+	frr_with_mutex (&sites_mtx) {
+		if (atomic_load_explicit(&xrd->described, memory_order_relaxed))
+			break;
+
+		if (sites_fd < 0) {
+			sites_fd = openat(zlog_tmpdirfd, "flightrec.sites",
+					  O_WRONLY | O_CREAT | O_APPEND |
+						  O_CLOEXEC,
+					  0600);
+			if (sites_fd < 0)
+				break;
+			fchown(sites_fd, zlog_uid, zlog_gid);
+		}
+
+		len = snprintfrr(buf, sizeof(buf),
+				 "%#jx\t%s\t%s\t%d\t%s\t%s\t%s\n",
+				 (uintmax_t)(uintptr_t)xref,
+				 xrd->xrefdata.uid, xref->xref.file,
+				 xref->xref.line, xref->xref.func, xref->name,
+				 xref->args);
+		if (len >= (ssize_t)sizeof(buf)) {
+			len = sizeof(buf);
+			buf[len - 1] = '\n';
+		}
+		if (write(sites_fd, buf, len) != len)
+			break;
+
+		atomic_store_explicit(&xrd->described, true,
+				      memory_order_relaxed);
+	}
+}
+
+void flightrec_write(const struct xref_flightrec *xref,
+		     struct xrefdata_flightrec *xrd,
+		     const uint64_t args[FLIGHTREC_NARGS])
+{
+	struct flightrec_ring *ring = flightrec_ring;
+	struct flightrec_rec *rec;
+	struct timespec ts;
+	uint64_t seq;
+
+	if (!ring)
+		return;
+
+	if (!atomic_load_explicit(&xrd->described, memory_order_relaxed))
+		flightrec_describe(xref, xrd);
+
+	/* only this pthread ever writes to the ring */
+	seq = atomic_load_explicit(&ring->hdr->head, memory_order_relaxed);
+	rec = &ring->recs[seq % FLIGHTREC_RECS];
+
+	atomic_store_explicit(&rec->seq, 0, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	rec->ts = timespec_ns(&ts);
+	rec->xref = (uintptr_t)xref;
+	memcpy(rec->args, args, sizeof(rec->args));
+
+	atomic_store_explicit(&rec->seq, seq + 1, memory_order_release);
+	atomic_store_explicit(&ring->hdr->head, seq + 1, memory_order_release);
+}
+
+void flightrec_thread_init(void)
+{
+	struct flightrec_ring *ring;
+	struct timespec mono, real;
+	char mmpath[MAXPATHLEN];
+	void *mmbuf;
+	int mmfd;
+
+	if (flightrec_ring || zlog_tmpdirfd < 0)
+		return;
+
+	snprintfrr(mmpath, sizeof(mmpath), "flightrec.%jd", zlog_gettid());
+
+	mmfd = openat(zlog_tmpdirfd, mmpath,
+		      O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+	if (mmfd < 0) {
+		zlog_err("failed to open flight recorder \"%s\": %s", mmpath,
+			 strerror(errno));
+		return;
+	}
+	fchown(mmfd, zlog_uid, zlog_gid);
+
+	if (ftruncate(mmfd, FLIGHTREC_SIZE) < 0) {
+		zlog_err("failed to allocate flight recorder \"%s\": %s",
+			 mmpath, strerror(errno));
+		goto out_unlink;
+	}
+
+	mmbuf = mmap(NULL, FLIGHTREC_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+		     mmfd, 0);
+	if (mmbuf == MAP_FAILED) {
+		zlog_err("failed to mmap flight recorder \"%s\": %s", mmpath,
+			 strerror(errno));
+		goto out_unlink;
+	}
+	close(mmfd);
+
+	ring = XCALLOC(MTYPE_FLIGHTREC, sizeof(*ring));
+	ring->hdr = mmbuf;
+	ring->recs = (struct flightrec_rec *)(ring->hdr + 1);
+	ring->do_unlink = true;
+
+	clock_gettime(CLOCK_MONOTONIC, &mono);
+	clock_gettime(CLOCK_REALTIME, &real);
+
+	ring->hdr->hdr_size = sizeof(struct flightrec_hdr);
+	ring->hdr->rec_size = sizeof(struct flightrec_rec);
+	ring->hdr->nrecs = FLIGHTREC_RECS;
+	ring->hdr->tid = zlog_gettid();
+	ring->hdr->realtime_offset = timespec_ns(&real) - timespec_ns(&mono);
+	/* last, so the decoder doesn't pick up a half-initialized file */
+	memcpy(ring->hdr->magic, FLIGHTREC_MAGIC, sizeof(ring->hdr->magic));
+
+	frr_with_mutex (&rings_mtx) {
+		flightrec_rings_add_tail(&rings, ring);
+	}
+	flightrec_ring = ring;
+	return;
+
+out_unlink:
+	unlinkat(zlog_tmpdirfd, mmpath, 0);
+	close(mmfd);
+}
+
+void flightrec_thread_fini(void)
+{
+	struct flightrec_ring *ring = flightrec_ring;
+	char mmpath[MAXPATHLEN];
+
+	if (!ring)
+		return;
+
+	flightrec_ring = NULL;
+	frr_with_mutex (&rings_mtx) {
+		flightrec_rings_del(&rings, ring);
+	}
+
+	munmap(ring->hdr, FLIGHTREC_SIZE);
+
+	snprintfrr(mmpath, sizeof(mmpath), "flightrec.%jd", zlog_gettid());
+	if (ring->do_unlink && unlinkat(zlog_tmpdirfd, mmpath, 0))
+		zlog_err("unlink flight recorder: %s (%d)", strerror(errno),
+			 errno);
+
+	XFREE(MTYPE_FLIGHTREC, ring);
+}
+
+void flightrec_fini(void)
+{
+	frr_with_mutex (&sites_mtx) {
+		if (sites_fd < 0)
+			break;
+
+		close(sites_fd);
+		sites_fd = -1;
+		unlinkat(zlog_tmpdirfd, "flightrec.sites", 0);
+	}
+}
+
+/* dumping */
+
+struct flightrec_snap {
+	int64_t tid;
+	struct flightrec_rec rec;
+};
+
+/* copy up to max of the newest records in a ring, skipping torn ones */
+static size_t flightrec_snap_ring(struct flightrec_ring *ring,
+				  struct flightrec_snap *out, size_t max)
+{
+	struct flightrec_rec *rec;
+	uint64_t head, seq, s1, s2;
+	size_t n = 0;
+
+	head = atomic_load_explicit(&ring->hdr->head, memory_order_acquire);
+	if (max > FLIGHTREC_RECS)
+		max = FLIGHTREC_RECS;
+	if (max > head)
+		max = head;
+
+	for (seq = head - max + 1; seq <= head; seq++) {
+		rec = &ring->recs[(seq - 1) % FLIGHTREC_RECS];
+
+		s1 = atomic_load_explicit(&rec->seq, memory_order_acquire);
+		out[n].rec.ts = rec->ts;
+		out[n].rec.xref = rec->xref;
+		memcpy(out[n].rec.args, rec->args, sizeof(rec->args));
+		atomic_thread_fence(memory_order_acquire);
+		s2 = atomic_load_explicit(&rec->seq, memory_order_relaxed);
+
+		/* overwritten while we were looking */
+		if (s1 != seq || s2 != seq)
+			continue;
+
+		out[n].tid = ring->hdr->tid;
+		n++;
+	}
+	return n;
+}
+
+static int flightrec_snap_cmp(const void *a, const void *b)
+{
+	const struct flightrec_snap *sa = a, *sb = b;
+
+	return numcmp(sa->rec.ts, sb->rec.ts);
+}
+
+/* print "name arg=value ..." with the casts taken off the arguments */
+static void flightrec_show_rec(struct vty *vty, const struct flightrec_snap *s,
+			       int64_t now_ns)
+{
+	const struct xref_flightrec *xref;
+	const char *p, *end;
+	char line[512];
+	size_t pos, i;
+	int depth;
+	bool hex;
+
+	xref = (const struct xref_flightrec *)(uintptr_t)s->rec.xref;
+
+	pos = snprintfrr(line, sizeof(line), "%10.6f %8jd %s",
+			 (double)((int64_t)s->rec.ts - now_ns) / 1e9,
+			 (intmax_t)s->tid, xref->name);
+
+	p = xref->args;
+	for (i = 0; i < FLIGHTREC_NARGS && p && *p && pos < sizeof(line);
+	     i++) {
+		while (*p == ' ')
+			p++;
+
+		hex = false;
+		if (*p == '(') {
+			hex = !strncmp(p, "(uintptr_t)", 11);
+			for (depth = 0; *p; p++) {
+				if (*p == '(')
+					depth++;
+				else if (*p == ')' && --depth == 0)
+					break;
+			}
+			if (*p)
+				p++;
+		}
+
+		for (end = p, depth = 0; *end; end++) {
+			if (*end == '(')
+				depth++;
+			else if (*end == ')')
+				depth--;
+			else if (*end == ',' && depth == 0)
+				break;
+		}
+
+		if (hex)
+			pos += snprintfrr(line + pos, sizeof(line) - pos,
+					  " %.*s=%#" PRIx64, (int)(end - p), p,
+					  s->rec.args[i]);
+		else
+			pos += snprintfrr(line + pos, sizeof(line) - pos,
+					  " %.*s=%" PRIu64, (int)(end - p), p,
+					  s->rec.args[i]);
+
+		p = *end ? end + 1 : NULL;
+	}
+
+	vty_out(vty, "%s\n", line);
+}
+
+#include "lib/flightrec_clippy.c"
+
+DEFPY_NOSH (show_trace_dump,
+	    show_trace_dump_cmd,
+	    "show trace dump [(1-65536)$count]",
+	    SHOW_STR
+	    "Flight recorder traces\n"
+	    "Dump the most recent records of all pthreads\n"
+	    "Number of records (default 100)\n")
+{
+	struct flightrec_ring *ring;
+	struct flightrec_snap *snaps;
+	struct timespec now;
+	size_t nsnaps, n = 0, i;
+
+	if (!count)
+		count = 100;
+
+	frr_with_mutex (&rings_mtx) {
+		nsnaps = flightrec_rings_count(&rings) *
+			 MIN((size_t)count, FLIGHTREC_RECS);
+		snaps = XCALLOC(MTYPE_TMP, MAX(nsnaps, 1) * sizeof(*snaps));
+
+		frr_each (flightrec_rings, &rings, ring)
+			n += flightrec_snap_ring(ring, snaps + n,
+						 MIN((size_t)count,
+						     FLIGHTREC_RECS));
+	}
+
+	qsort(snaps, n, sizeof(*snaps), flightrec_snap_cmp);
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	vty_out(vty, "%10s %8s %s\n", "Time", "TID", "Record");
+	for (i = n > (size_t)count ? n - count : 0; i < n; i++)
+		flightrec_show_rec(vty, &snaps[i], timespec_ns(&now));
+
+	XFREE(MTYPE_TMP, snaps);
+	return CMD_SUCCESS;
+}
+
+void flightrec_cmd_init(void)
+{
+	install_element(VIEW_NODE, &show_trace_dump_cmd);
+}
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Flight recorder: per-pthread binary trace rings.
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * flightrec() puts a fixed-size binary record (timestamp, call site and up
+ * to FLIGHTREC_NARGS integer arguments) into a ring owned by the calling
+ * pthread.  Nothing is formatted and no locks are taken, so this is cheap
+ * enough to leave on in hot paths all the time.  The rings are memory-mapped
+ * files in the daemon's temporary directory (next to the log buffers), so
+ * they survive a crash; "show trace dump" decodes them at runtime and
+ * tools/frr_flightrec.py offline.
+ *
+ * Call sites are xrefs, records point at them.  The first time a call site
+ * is hit, it is described in the "flightrec.sites" file for the offline
+ * decoder.
+ */
+
+#ifndef _FRR_FLIGHTREC_H
+#define _FRR_FLIGHTREC_H
+
+#include "frratomic.h"
+#include "xref.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLIGHTREC_NARGS 5
+
+struct xref_flightrec {
+	struct xref xref;
+
+	const char *name;
+	/* stringified arguments, for display */
+	const char *args;
+};
+
+struct xrefdata_flightrec {
+	struct xrefdata xrefdata;
+
+	/* call site has been written to the sites file */
+	atomic_bool described;
+};
+
+extern void flightrec_write(const struct xref_flightrec *xref,
+			    struct xrefdata_flightrec *xrd,
+			    const uint64_t args[FLIGHTREC_NARGS]);
+
+/*
+ * flightrec("name", arg, ...) with up to FLIGHTREC_NARGS integer arguments;
+ * pointers need to be cast to uintptr_t.
+ */
+#define flightrec(name_, ...)                                                  \
+	do {                                                                   \
+		static struct xrefdata_flightrec _xrefdata = {                 \
+			.xrefdata =                                            \
+				{                                              \
+					.xref = NULL,                          \
+					.uid = {},                             \
+					.hashstr = (name_),                    \
+					.hashu32 = {},                         \
+				},                                             \
+		};                                                             \
+		static const struct xref_flightrec _xref __attribute__(        \
+			(used)) = {                                            \
+			.xref = XREF_INIT(XREFT_FLIGHTREC,                     \
+					  &_xrefdata.xrefdata, __func__),      \
+			.name = (name_),                                       \
+			.args = (#__VA_ARGS__),                                \
+		};                                                             \
+		XREF_LINK(_xref.xref);                                         \
+		flightrec_write(&_xref, &_xrefdata,                            \
+				(const uint64_t[FLIGHTREC_NARGS]){             \
+					__VA_ARGS__});                         \
+	} while (0)
+
+/* set up / tear down the calling pthread's ring */
+extern void flightrec_thread_init(void);
+extern void flightrec_thread_fini(void);
+
+/* remove the sites file on a clean exit */
+extern void flightrec_fini(void);
+
+extern void flightrec_cmd_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_FLIGHTREC_H */
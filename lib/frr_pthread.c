@@ -17,6 +17,7 @@
 #include "zlog.h"
 #include "libfrr.h"
 #include "libfrr_trace.h"
+#include "flightrec.h"
 
 DEFINE_MTYPE_STATIC(LIB, FRR_PTHREAD, "FRR POSIX Thread");
 DEFINE_MTYPE_STATIC(LIB, PTHREAD_PRIM, "POSIX sync primitives");
@@ -278,6 +279,7 @@ static void *fpt_run(void *arg)
 	fpt->master->owner = pthread_self();
 
 	zlog_tls_buffer_init();
+	flightrec_thread_init();
 
 	int sleeper[2];
 	pipe(sleeper);
@@ -300,6 +302,7 @@ static void *fpt_run(void *arg)
 	close(sleeper[1]);
 	close(sleeper[0]);
 
+	flightrec_thread_fini();
 	zlog_tls_buffer_fini();
 
 	return NULL;
@@ -39,6 +39,10 @@ struct rusage_t {
 
 PREDECL_LIST(event_list);
 PREDECL_HEAP(event_timer_list);
+PREDECL_DLIST(event_wheel_list);
+
+struct event_timer_wheel;
+struct event_io_epoll;
 
 struct fd_handler {
 	/* number of pfd that fit in the allocated space of pfds. This is a
@@ -55,6 +59,16 @@ struct fd_handler {
 	struct pollfd *copy;
 	/* number of pollfds stored in copy */
 	nfds_t copycount;
+
+	/* epoll backend state, NULL if poll() is used */
+	struct event_io_epoll *epoll;
+
+	struct {
+		size_t waits;  /* poll()/epoll_wait() calls */
+		size_t polled; /* fds handed to poll() */
+		size_t events; /* fds reported ready */
+		size_t ctl;    /* epoll_ctl() calls */
+	} stats;
 };
 
 struct xref_eventsched {
@@ -65,6 +79,20 @@ struct xref_eventsched {
 	uint32_t event_type;
 };
 
+/*
+ * Latency histograms use log2 buckets of microseconds: [0, 2), [2, 4), ...
+ * [2^22, 2^23) and everything from 2^23 (~8.4s) on in the last one.
+ */
+#define EVENT_HIST_BUCKETS 24
+
+/* Timer churn counters, protected by the loop's mtx */
+struct event_timer_stats {
+	size_t added;
+	size_t cancelled;
+	size_t wheel_added;
+	size_t wheel_moved;
+};
+
 /* Master of the theads. */
 struct event_loop {
 	char *name;
@@ -72,6 +100,8 @@ struct event_loop {
 	struct event **read;
 	struct event **write;
 	struct event_timer_list_head timer;
+	struct event_timer_wheel *wheel;
+	struct event_timer_stats timer_stats;
 	struct event_list_head event, ready, unuse;
 	struct list *cancel_req;
 	bool canceled;
@@ -89,6 +119,12 @@ struct event_loop {
 
 	bool ready_run_loop;
 	RUSAGE_T last_getrusage;
+
+	/* how late timers ran compared to when they were scheduled for */
+	atomic_size_t timer_lag[EVENT_HIST_BUCKETS];
+	atomic_size_t timer_lag_max;
+	/* moving average of the above, in us */
+	atomic_size_t timer_lag_avg;
 };
 
 /* Event types. */
@@ -108,6 +144,7 @@ struct event {
 	enum event_types add_type; /* event type */
 	struct event_list_item eventitem;
 	struct event_timer_list_item timeritem;
+	struct event_wheel_list_item wheelitem;
 	struct event **ref;	      /* external reference (if given) */
 	struct event_loop *master;    /* pointer to the struct event_loop */
 	void (*func)(struct event *e); /* event function */
@@ -123,6 +160,7 @@ struct event {
 	const struct xref_eventsched *xref; /* origin location */
 	pthread_mutex_t mtx;		    /* mutex for thread.c functions */
 	bool ignore_timer_late;
+	bool on_wheel;		      /* timer is on the wheel, not the heap */
 };
 
 #ifdef _FRR_ATTRIBUTE_PRINTFRR
@@ -136,10 +174,13 @@ struct cpu_event_history {
 	atomic_size_t total_starv_warn;
 	atomic_size_t total_calls;
 	atomic_size_t total_active;
+	atomic_size_t total_timer_add;
+	atomic_size_t total_timer_cancel;
 	struct time_stats {
 		atomic_size_t total, max;
 	} real;
 	struct time_stats cpu;
+	atomic_size_t real_hist[EVENT_HIST_BUCKETS];
 	atomic_uint_fast32_t types;
 	const char *funcname;
 };
@@ -214,6 +255,28 @@ void event_master_set_name(struct event_loop *master, const char *name);
 extern void event_master_free(struct event_loop *m);
 extern void event_master_free_unused(struct event_loop *m);
 
+/*
+ * Put short timers (up to a few minutes out) on a timer wheel in front of
+ * the timer heap, which makes adding and cancelling them O(1).  Meant for
+ * loops with a lot of timer churn, e.g. keepalive/hold timers that get
+ * restarted far more often than they expire.  Timers still expire in the
+ * same order.
+ */
+extern void event_master_set_timer_wheel(struct event_loop *m, bool enable);
+
+/*
+ * Select how event loops created after this wait for I/O, "poll" (default)
+ * or "epoll" (Linux only).  Returns false if the backend isn't available.
+ */
+extern bool event_set_io_backend(const char *name);
+
+/* recent average of how late timers run on this loop, in microseconds */
+extern unsigned long event_loop_lag(struct event_loop *m);
+
+/* timer lag of all event loops, for the metrics exporter */
+struct metrics_out;
+extern void event_loop_metrics(struct metrics_out *out);
+
 extern void _event_add_read_write(const struct xref_eventsched *xref,
 				  struct event_loop *master,
 				  void (*fn)(struct event *), void *arg, int fd,
@@ -75,6 +75,80 @@ void *lua_toprefix(lua_State *L, int idx)
 	return p;
 }
 
+struct frrlua_view {
+	const void *ptr;
+};
+
+void frrlua_view_push(lua_State *L, const char *tname, const luaL_Reg *meta,
+		      const void *ptr)
+{
+	struct frrlua_view *view;
+
+	/* The view itself is kept in its metatable */
+	if (luaL_newmetatable(L, tname)) {
+		luaL_setfuncs(L, meta, 0);
+		lua_newuserdata(L, sizeof(struct frrlua_view));
+		lua_pushvalue(L, -2);
+		lua_setmetatable(L, -2);
+		lua_setfield(L, -2, "__view");
+	}
+	lua_getfield(L, -1, "__view");
+	lua_remove(L, -2);
+
+	view = lua_touserdata(L, -1);
+	view->ptr = ptr;
+}
+
+const void *frrlua_view_get(lua_State *L, int idx, const char *tname)
+{
+	struct frrlua_view *view = luaL_testudata(L, idx, tname);
+
+	return view ? view->ptr : NULL;
+}
+
+const void *frrlua_view_check(lua_State *L, int idx, const char *tname)
+{
+	struct frrlua_view *view = luaL_checkudata(L, idx, tname);
+
+	return view->ptr;
+}
+
+static int lua_prefix_view_tostring(lua_State *L)
+{
+	const struct prefix *prefix = frrlua_view_check(L, 1, "frr.prefix");
+	char buffer[PREFIX_STRLEN];
+
+	lua_pushstring(L, prefix2str(prefix, buffer, PREFIX_STRLEN));
+	return 1;
+}
+
+static int lua_prefix_view_index(lua_State *L)
+{
+	const struct prefix *prefix = frrlua_view_check(L, 1, "frr.prefix");
+	const char *key = luaL_checkstring(L, 2);
+
+	if (strmatch(key, "network"))
+		return lua_prefix_view_tostring(L);
+	if (strmatch(key, "length"))
+		lua_pushinteger(L, prefix->prefixlen);
+	else if (strmatch(key, "family"))
+		lua_pushinteger(L, prefix->family);
+	else
+		lua_pushnil(L);
+	return 1;
+}
+
+static const luaL_Reg lua_prefix_view_meta[] = {
+	{ "__index", lua_prefix_view_index },
+	{ "__tostring", lua_prefix_view_tostring },
+	{},
+};
+
+void lua_pushprefix_view(lua_State *L, const struct prefix *prefix)
+{
+	frrlua_view_push(L, "frr.prefix", lua_prefix_view_meta, prefix);
+}
+
 void lua_pushinterface(lua_State *L, const struct interface *ifp)
 {
 	lua_newtable(L);
@@ -41,6 +41,29 @@ void lua_pushprefix(lua_State *L, const struct prefix *prefix);
 
 void lua_decode_prefix(lua_State *L, int idx, struct prefix *prefix);
 
+/*
+ * Views: instead of copying an object into a new table, push a userdata that
+ * refers to it and whose metatable (registered as tname, with the
+ * functions in meta) reads the fields on access.  There is one view per
+ * type and Lua state, pointed at the object on every push, so passing
+ * an object to a script allocates nothing.  A view is only valid during
+ * the call it was pushed for.
+ */
+void frrlua_view_push(lua_State *L, const char *tname, const luaL_Reg *meta,
+		      const void *ptr);
+
+/* Object of the view at idx, NULL if that isn't a view of type tname */
+const void *frrlua_view_get(lua_State *L, int idx, const char *tname);
+
+/* Same, raises a Lua error if it isn't one; for the meta functions */
+const void *frrlua_view_check(lua_State *L, int idx, const char *tname);
+
+/*
+ * Pushes a read-only view of a prefix with the same fields as
+ * lua_pushprefix(); used for const prefixes passed to frrscript_call.
+ */
+void lua_pushprefix_view(lua_State *L, const struct prefix *prefix);
+
 /*
  * Converts the Lua value at idx to a prefix.
  *
@@ -15,6 +15,8 @@
 #include "memory.h"
 #include "hash.h"
 #include "log.h"
+#include "monotime.h"
+#include "vty.h"
 
 
 DEFINE_MTYPE_STATIC(LIB, SCRIPT, "Scripting");
@@ -205,6 +207,7 @@ void *lua_function_alloc(void *arg)
 
 	lfs->name = tmp->name;
 	lfs->L = tmp->L;
+	lfs->ref = tmp->ref;
 	return lfs;
 }
 
@@ -220,9 +223,18 @@ static void lua_function_free(void *data)
 
 int _frrscript_call_lua(struct lua_function_state *lfs, int nargs)
 {
-
+	struct timeval start;
+	uint64_t usec;
 	int ret;
+
+	monotime(&start);
 	ret = lua_pcall(lfs->L, nargs, 1, 0);
+	usec = monotime_since(&start, NULL);
+
+	lfs->calls++;
+	lfs->total_usec += usec;
+	if (usec > lfs->max_usec)
+		lfs->max_usec = usec;
 
 	switch (ret) {
 	case LUA_OK:
@@ -270,6 +282,9 @@ int _frrscript_call_lua(struct lua_function_state *lfs, int nargs)
 	}
 
 done:
+	if (ret != LUA_OK)
+		lfs->errors++;
+
 	/* LUA_OK is 0, so we can just return lua_pcall's result directly */
 	return ret;
 }
@@ -331,6 +346,10 @@ void frrscript_register_type_codecs(struct frrscript_codec *codecs)
 		frrscript_register_type_codec(&codecs[i]);
 }
 
+DECLARE_DLIST(frrscript_list, struct frrscript, item);
+
+static struct frrscript_list_head frrscript_all;
+
 struct frrscript *frrscript_new(const char *name)
 {
 	struct frrscript *fs = XCALLOC(MTYPE_SCRIPT, sizeof(struct frrscript));
@@ -339,6 +358,7 @@ struct frrscript *frrscript_new(const char *name)
 	fs->lua_function_hash =
 		hash_create(lua_function_hash_key, lua_function_hash_cmp,
 			    "Lua function state hash");
+	frrscript_list_add_tail(&frrscript_all, fs);
 	return fs;
 }
 
@@ -374,9 +394,10 @@ int frrscript_load(struct frrscript *fs, const char *function_name,
 			 script_name, function_name);
 		goto fail;
 	}
-	/* Then pop the function (frrscript_call will push it when it needs it)
+	/* Then keep a reference to it (and pop it), frrscript_call pushes it
+	 * from there rather than looking up the global by name every time.
 	 */
-	lua_pop(L, 1);
+	int ref = luaL_ref(L, LUA_REGISTRYINDEX);
 
 	if (load_cb && (*load_cb)(fs) != 0) {
 		zlog_err(
@@ -386,7 +407,9 @@ int frrscript_load(struct frrscript *fs, const char *function_name,
 	}
 
 	/* Add the Lua function state to frrscript */
-	struct lua_function_state key = {.name = function_name, .L = L};
+	struct lua_function_state key = {
+		.name = function_name, .L = L, .ref = ref
+	};
 
 	(void)hash_get(fs->lua_function_hash, &key, lua_function_alloc);
 
@@ -398,17 +421,63 @@ fail:
 
 void frrscript_delete(struct frrscript *fs)
 {
+	frrscript_list_del(&frrscript_all, fs);
 	hash_clean_and_free(&fs->lua_function_hash, lua_function_free);
 	XFREE(MTYPE_SCRIPT, fs->name);
 	XFREE(MTYPE_SCRIPT, fs);
 }
 
+static int frrscript_stats_show_fn(struct hash_bucket *bucket, void *arg)
+{
+	struct lua_function_state *lfs = bucket->data;
+	struct frrscript *fs = ((void **)arg)[0];
+	struct vty *vty = ((void **)arg)[1];
+
+	vty_out(vty, "%-20s %-20s %10" PRIu64 " %8" PRIu64 " %10" PRIu64
+		     " %10" PRIu64 "\n",
+		fs->name, lfs->name, lfs->calls, lfs->errors,
+		lfs->calls ? lfs->total_usec / lfs->calls : 0, lfs->max_usec);
+	return HASHWALK_CONTINUE;
+}
+
+void frrscript_stats_show(struct vty *vty)
+{
+	struct frrscript *fs;
+
+	vty_out(vty, "%-20s %-20s %10s %8s %10s %10s\n", "Script", "Function",
+		"Calls", "Errors", "Avg(usec)", "Max(usec)");
+	frr_each (frrscript_list, &frrscript_all, fs) {
+		void *arg[2] = { fs, vty };
+
+		hash_walk(fs->lua_function_hash, frrscript_stats_show_fn, arg);
+	}
+}
+
+static int frrscript_stats_clear_fn(struct hash_bucket *bucket, void *arg)
+{
+	struct lua_function_state *lfs = bucket->data;
+
+	lfs->calls = lfs->errors = 0;
+	lfs->total_usec = lfs->max_usec = 0;
+	return HASHWALK_CONTINUE;
+}
+
+void frrscript_stats_clear(void)
+{
+	struct frrscript *fs;
+
+	frr_each (frrscript_list, &frrscript_all, fs)
+		hash_walk(fs->lua_function_hash, frrscript_stats_clear_fn,
+			  NULL);
+}
+
 void frrscript_init(const char *sd)
 {
 	codec_hash = hash_create(codec_hash_key, codec_hash_cmp,
 				 "Lua type encoders");
 
 	strlcpy(scriptdir, sd, sizeof(scriptdir));
+	frrscript_list_init(&frrscript_all);
 
 	/* Register core library types */
 	frrscript_register_type_codecs(frrscript_codecs_lib);
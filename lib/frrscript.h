@@ -69,14 +69,28 @@ struct frrscript_codec {
 struct lua_function_state {
 	const char *name;
 	lua_State *L;
+
+	/* Registry reference to the function, taken at load time */
+	int ref;
+
+	/* Call counters, see frrscript_stats_show() */
+	uint64_t calls;
+	uint64_t errors;
+	uint64_t total_usec;
+	uint64_t max_usec;
 };
 
+PREDECL_DLIST(frrscript_list);
+
 struct frrscript {
 	/* Script name */
 	char *name;
 
 	/* Hash of Lua function name to Lua function state */
 	struct hash *lua_function_hash;
+
+	/* All scripts, for stats */
+	struct frrscript_list_item item;
 };
 
 
@@ -121,6 +135,13 @@ int frrscript_load(struct frrscript *fs, const char *function_name,
  */
 void frrscript_delete(struct frrscript *fs);
 
+/*
+ * Show call counts and latency for the functions of every loaded script.
+ */
+struct vty;
+void frrscript_stats_show(struct vty *vty);
+void frrscript_stats_clear(void);
+
 /*
  * Register a Lua codec for a type.
  *
@@ -202,7 +223,7 @@ time_t * : lua_pushtimet,                                       \
 char * : lua_pushstring_wrapper,                                \
 struct attr * : lua_pushattr,                                   \
 struct peer * : lua_pushpeer,                                   \
-const struct prefix * : lua_pushprefix,                         \
+const struct prefix * : lua_pushprefix_view,                    \
 const struct ipaddr * : lua_pushipaddr,                         \
 const struct ethaddr * : lua_pushethaddr,                       \
 const struct nexthop_group * : lua_pushnexthop_group,           \
@@ -250,7 +271,7 @@ int _frrscript_call_lua(struct lua_function_state *lfs, int nargs);
  * frrscript_load. So this wrapper will:
  * 1) Find the Lua function state, which contains the Lua state
  * 2) Clear the Lua state (there may be leftovers items from previous call)
- * 3) Push the Lua function (f)
+ * 3) Push the Lua function (f), from the reference taken by frrscript_load
  * 4) Map frrscript_call arguments onto their encoder and decoders, push those
  * 5) Call _frrscript_call_lua (Lua execution takes place)
  * 6) Write back to frrscript_call arguments using their decoders
@@ -278,7 +299,7 @@ int _frrscript_call_lua(struct lua_function_state *lfs, int nargs);
 		})                                                                                                                                                 \
 			    : ({                                                                                                                                   \
 				      lua_settop(lfs->L, 0);                                                                                                       \
-				      lua_getglobal(lfs->L, f);                                                                                                    \
+				      lua_rawgeti(lfs->L, LUA_REGISTRYINDEX, lfs->ref);                                                                            \
 				      MAP_LISTS(ENCODE_ARGS, ##__VA_ARGS__);                                                                                       \
 				      _frrscript_call_lua(                                                                                                         \
 					      lfs, PP_NARG(__VA_ARGS__));                                                                                          \
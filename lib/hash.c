@@ -23,18 +23,25 @@ DEFINE_MTYPE_STATIC(LIB, HASH_INDEX, "Hash Index");
 static pthread_mutex_t _hashes_mtx = PTHREAD_MUTEX_INITIALIZER;
 static struct list *_hashes;
 
-struct hash *hash_create_size(unsigned int size,
-			      unsigned int (*hash_key)(const void *),
-			      bool (*hash_cmp)(const void *, const void *),
-			      const char *name)
+static void hash_open_alloc(struct hash *hash, unsigned int size);
+
+struct hash *hash_create_flags(unsigned int size,
+			       unsigned int (*hash_key)(const void *),
+			       bool (*hash_cmp)(const void *, const void *),
+			       const char *name, unsigned int flags)
 {
 	struct hash *hash;
 
 	assert((size & (size - 1)) == 0);
 	hash = XCALLOC(MTYPE_HASH, sizeof(struct hash));
-	hash->index =
-		XCALLOC(MTYPE_HASH_INDEX, sizeof(struct hash_bucket *) * size);
-	hash->size = size;
+	hash->flags = flags;
+	if (flags & HASH_OPEN_ADDRESSING)
+		hash_open_alloc(hash, size);
+	else {
+		hash->index = XCALLOC(MTYPE_HASH_INDEX,
+				      sizeof(struct hash_bucket *) * size);
+		hash->size = size;
+	}
 	hash->hash_key = hash_key;
 	hash->hash_cmp = hash_cmp;
 	hash->count = 0;
@@ -51,6 +58,14 @@ struct hash *hash_create_size(unsigned int size,
 	return hash;
 }
 
+struct hash *hash_create_size(unsigned int size,
+			      unsigned int (*hash_key)(const void *),
+			      bool (*hash_cmp)(const void *, const void *),
+			      const char *name)
+{
+	return hash_create_flags(size, hash_key, hash_cmp, name, 0);
+}
+
 struct hash *hash_create(unsigned int (*hash_key)(const void *),
 			 bool (*hash_cmp)(const void *, const void *),
 			 const char *name)
@@ -122,6 +137,248 @@ static void hash_expand(struct hash *hash)
 	hash->index = new_index;
 }
 
+/*
+ * Open addressing (HASH_OPEN_ADDRESSING)
+ *
+ * Linear probing on the upper bits of the key multiplied with the golden
+ * ratio, so that keys that only differ in their upper bits (common with the
+ * hash functions used around here) don't all end up in one cluster.  The
+ * control byte array is what the probe loop mostly touches: a slot is only
+ * looked at if its control byte matches the lower 7 bits of the key.
+ *
+ * Deleted slots become tombstones (unless the probe sequence ends right
+ * behind them anyway), entries never move except on a rehash.  This keeps
+ * deleting the current entry from hash_iterate()/hash_walk() safe.
+ */
+#define HASH_CTRL_EMPTY	  0x80
+#define HASH_CTRL_DELETED 0xfe
+#define HASH_CTRL_FULL(c) (!((c) & 0x80))
+#define HASH_OPEN_MIN	  8
+
+static inline uint8_t hash_open_h2(unsigned int key)
+{
+	return key & 0x7f;
+}
+
+static inline unsigned int hash_open_h1(const struct hash *hash,
+					unsigned int key)
+{
+	return (key * 0x9e3779b1U) >> hash->shift;
+}
+
+/* entries + tombstones allowed before the table is rehashed */
+static inline unsigned int hash_open_limit(unsigned int size)
+{
+	return size - size / 8;
+}
+
+static void hash_open_alloc(struct hash *hash, unsigned int size)
+{
+	size = MAX(size, HASH_OPEN_MIN);
+
+	hash->slots = XCALLOC(MTYPE_HASH_INDEX,
+			      sizeof(struct hash_bucket) * size);
+	hash->ctrl = XMALLOC(MTYPE_HASH_INDEX, size);
+	memset(hash->ctrl, HASH_CTRL_EMPTY, size);
+	hash->size = size;
+	hash->shift = 32 - __builtin_ctz(size);
+	hash->tombstones = 0;
+}
+
+/* first free (empty or deleted) slot for the key */
+static unsigned int hash_open_free_slot(const struct hash *hash,
+					unsigned int key)
+{
+	unsigned int mask = hash->size - 1;
+	unsigned int i = hash_open_h1(hash, key);
+
+	while (HASH_CTRL_FULL(hash->ctrl[i]))
+		i = (i + 1) & mask;
+	return i;
+}
+
+static void hash_open_rehash(struct hash *hash, unsigned int new_size)
+{
+	struct hash_bucket *old_slots = hash->slots;
+	uint8_t *old_ctrl = hash->ctrl;
+	unsigned int i, j, old_size = hash->size;
+
+	hash_open_alloc(hash, new_size);
+	hash->generation++;
+
+	for (i = 0; i < old_size; i++) {
+		if (!HASH_CTRL_FULL(old_ctrl[i]))
+			continue;
+
+		j = hash_open_free_slot(hash, old_slots[i].key);
+		hash->ctrl[j] = old_ctrl[i];
+		hash->slots[j] = old_slots[i];
+	}
+
+	hash->stats.empty = hash->size - hash->count;
+
+	XFREE(MTYPE_HASH_INDEX, old_slots);
+	XFREE(MTYPE_HASH_INDEX, old_ctrl);
+}
+
+/*
+ * Returns the slot holding data, or -1 with *freep set to the slot it
+ * should be inserted in.
+ */
+static int hash_open_find(struct hash *hash, unsigned int key, void *data,
+			  unsigned int *freep)
+{
+	unsigned int mask = hash->size - 1;
+	unsigned int i = hash_open_h1(hash, key);
+	uint8_t h2 = hash_open_h2(key);
+	bool have_free = false;
+	uint8_t c;
+
+	/* there is always at least one empty slot, see hash_open_limit() */
+	for (;; i = (i + 1) & mask) {
+		c = hash->ctrl[i];
+
+		if (c == h2 && hash->slots[i].key == key &&
+		    (*hash->hash_cmp)(hash->slots[i].data, data))
+			return i;
+
+		if (c == HASH_CTRL_EMPTY)
+			break;
+		if (c == HASH_CTRL_DELETED && !have_free) {
+			*freep = i;
+			have_free = true;
+		}
+	}
+	if (!have_free)
+		*freep = i;
+	return -1;
+}
+
+static void *hash_open_get(struct hash *hash, void *data,
+			   void *(*alloc_func)(void *))
+{
+	unsigned int key, slot, new_size, generation;
+	void *newdata;
+	int found;
+
+	if (!alloc_func && !hash->count)
+		return NULL;
+
+	key = (*hash->hash_key)(data);
+	found = hash_open_find(hash, key, data, &slot);
+	if (found >= 0)
+		return hash->slots[found].data;
+
+	if (!alloc_func)
+		return NULL;
+
+	generation = hash->generation;
+	newdata = (*alloc_func)(data);
+	if (newdata == NULL)
+		return NULL;
+
+	/*
+	 * alloc_func may have added entries itself (e.g. zebra NHGs), taking
+	 * the slot or even rehashing the table.
+	 */
+	if (generation != hash->generation ||
+	    HASH_CTRL_FULL(hash->ctrl[slot]))
+		slot = hash_open_free_slot(hash, key);
+
+	if (hash->ctrl[slot] == HASH_CTRL_EMPTY &&
+	    hash->count + hash->tombstones + 1 > hash_open_limit(hash->size)) {
+		/*
+		 * Grow if at least half full, otherwise get rid of the
+		 * tombstones.  max_size can only hold the table back until
+		 * it actually fills up.
+		 */
+		new_size = hash->size;
+		if (hash->count + 1 > hash->size / 2)
+			new_size *= 2;
+		if (hash->max_size && new_size > hash->max_size &&
+		    hash->count + 1 <= hash_open_limit(hash->size))
+			new_size = hash->size;
+
+		hash_open_rehash(hash, new_size);
+		slot = hash_open_free_slot(hash, key);
+	}
+
+	if (hash->ctrl[slot] == HASH_CTRL_DELETED)
+		hash->tombstones--;
+	hash->ctrl[slot] = hash_open_h2(key);
+	hash->slots[slot].len = 1;
+	hash->slots[slot].next = NULL;
+	hash->slots[slot].key = key;
+	hash->slots[slot].data = newdata;
+	hash->count++;
+	hash->stats.empty--;
+	atomic_fetch_add_explicit(&hash->stats.ssq, 1, memory_order_relaxed);
+
+	frrtrace(3, frr_libfrr, hash_insert, hash, data, key);
+
+	return newdata;
+}
+
+static void *hash_open_release(struct hash *hash, void *data)
+{
+	unsigned int key, slot, mask = hash->size - 1;
+	void *ret;
+	int found;
+
+	if (!hash->count)
+		return NULL;
+
+	key = (*hash->hash_key)(data);
+	found = hash_open_find(hash, key, data, &slot);
+	if (found < 0)
+		return NULL;
+
+	ret = hash->slots[found].data;
+	hash->slots[found].data = NULL;
+
+	/* nothing probes past an empty slot, no need for a tombstone then */
+	if (hash->ctrl[(found + 1) & mask] == HASH_CTRL_EMPTY)
+		hash->ctrl[found] = HASH_CTRL_EMPTY;
+	else {
+		hash->ctrl[found] = HASH_CTRL_DELETED;
+		hash->tombstones++;
+	}
+	hash->count--;
+	hash->stats.empty++;
+	atomic_fetch_sub_explicit(&hash->stats.ssq, 1, memory_order_relaxed);
+
+	return ret;
+}
+
+static int hash_open_walk(struct hash *hash,
+			  int (*func)(struct hash_bucket *, void *), void *arg)
+{
+	unsigned int i;
+
+	for (i = 0; i < hash->size; i++)
+		if (HASH_CTRL_FULL(hash->ctrl[i]) &&
+		    (*func)(&hash->slots[i], arg) == HASHWALK_ABORT)
+			return HASHWALK_ABORT;
+	return HASHWALK_CONTINUE;
+}
+
+static void hash_open_clean(struct hash *hash, void (*free_func)(void *))
+{
+	unsigned int i;
+
+	for (i = 0; i < hash->size; i++) {
+		if (HASH_CTRL_FULL(hash->ctrl[i]) && free_func)
+			(*free_func)(hash->slots[i].data);
+		hash->slots[i].data = NULL;
+	}
+	memset(hash->ctrl, HASH_CTRL_EMPTY, hash->size);
+
+	hash->count = 0;
+	hash->tombstones = 0;
+	hash->stats.ssq = 0;
+	hash->stats.empty = hash->size;
+}
+
 void *hash_get(struct hash *hash, void *data, void *(*alloc_func)(void *))
 {
 	frrtrace(2, frr_libfrr, hash_get, hash, data);
@@ -131,6 +388,9 @@ void *hash_get(struct hash *hash, void *data, void *(*alloc_func)(void *))
 	void *newdata;
 	struct hash_bucket *bucket;
 
+	if (hash->flags & HASH_OPEN_ADDRESSING)
+		return hash_open_get(hash, data, alloc_func);
+
 	if (!alloc_func && !hash->count)
 		return NULL;
 
@@ -202,6 +462,12 @@ void *hash_release(struct hash *hash, void *data)
 	struct hash_bucket *bucket;
 	struct hash_bucket *pp;
 
+	if (hash->flags & HASH_OPEN_ADDRESSING) {
+		ret = hash_open_release(hash, data);
+		frrtrace(3, frr_libfrr, hash_release, hash, data, ret);
+		return ret;
+	}
+
 	key = (*hash->hash_key)(data);
 	index = key & (hash->size - 1);
 
@@ -243,6 +509,13 @@ void hash_iterate(struct hash *hash, void (*func)(struct hash_bucket *, void *),
 	struct hash_bucket *hb;
 	struct hash_bucket *hbnext;
 
+	if (hash->flags & HASH_OPEN_ADDRESSING) {
+		for (i = 0; i < hash->size; i++)
+			if (HASH_CTRL_FULL(hash->ctrl[i]))
+				(*func)(&hash->slots[i], arg);
+		return;
+	}
+
 	for (i = 0; i < hash->size; i++)
 		for (hb = hash->index[i]; hb; hb = hbnext) {
 			/* get pointer to next hash bucket here, in case (*func)
@@ -261,6 +534,11 @@ void hash_walk(struct hash *hash, int (*func)(struct hash_bucket *, void *),
 	struct hash_bucket *hbnext;
 	int ret = HASHWALK_CONTINUE;
 
+	if (hash->flags & HASH_OPEN_ADDRESSING) {
+		hash_open_walk(hash, func, arg);
+		return;
+	}
+
 	for (i = 0; i < hash->size; i++) {
 		for (hb = hash->index[i]; hb; hb = hbnext) {
 			/* get pointer to next hash bucket here, in case (*func)
@@ -280,6 +558,11 @@ void hash_clean(struct hash *hash, void (*free_func)(void *))
 	struct hash_bucket *hb;
 	struct hash_bucket *next;
 
+	if (hash->flags & HASH_OPEN_ADDRESSING) {
+		hash_open_clean(hash, free_func);
+		return;
+	}
+
 	for (i = 0; i < hash->size; i++) {
 		for (hb = hash->index[i]; hb; hb = next) {
 			next = hb->next;
@@ -336,6 +619,8 @@ void hash_free(struct hash *hash)
 	XFREE(MTYPE_HASH, hash->name);
 
 	XFREE(MTYPE_HASH_INDEX, hash->index);
+	XFREE(MTYPE_HASH_INDEX, hash->slots);
+	XFREE(MTYPE_HASH_INDEX, hash->ctrl);
 	XFREE(MTYPE_HASH, hash);
 }
 
@@ -383,6 +668,10 @@ DEFUN_NOSH(show_hash_stats,
 	 *   As a rule of thumb this number should be less than 2, and ideally
 	 *   <= 1 for optimal performance. A number larger than 3 generally
 	 *   indicates a poor hash function.
+	 *
+	 * Open addressing tables (marked "(open)") hold at most one element
+	 * per bucket, so for them the load factor is the fill ratio and the
+	 * other numbers carry no information.
 	 */
 
 	double lf;    // load factor
@@ -422,8 +711,11 @@ DEFUN_NOSH(show_hash_stats,
 		stdv = sqrt(var);
 		fstdv = sqrt(fvar);
 
-		ttable_add_row(tt, "%s|%d|%ld|%.0f%%|%.2lf|%.2lf|%.2lf|%.2lf",
-			       h->name, h->size, h->count,
+		ttable_add_row(tt, "%s%s|%d|%ld|%.0f%%|%.2lf|%.2lf|%.2lf|%.2lf",
+			       h->name,
+			       (h->flags & HASH_OPEN_ADDRESSING) ? " (open)"
+								 : "",
+			       h->size, h->count,
 			       (h->stats.empty / (double)h->size) * 100, lf,
 			       stdv, flf, fstdv);
 	}
@@ -21,6 +21,9 @@ extern "C" {
 #define HASHWALK_CONTINUE 0
 #define HASHWALK_ABORT -1
 
+/* flags for hash_create_flags() */
+#define HASH_OPEN_ADDRESSING (1 << 0)
+
 struct hash_bucket {
 	/*
 	 * if this bucket is the head of the linked listed, len denotes the
@@ -46,9 +49,22 @@ struct hashstats {
 };
 
 struct hash {
-	/* Hash bucket. */
+	/* Hash bucket.  NULL for HASH_OPEN_ADDRESSING tables. */
 	struct hash_bucket **index;
 
+	/*
+	 * HASH_OPEN_ADDRESSING: the entries are stored in slots, with one
+	 * control byte per slot (empty, deleted, or 7 bits of the key).
+	 */
+	struct hash_bucket *slots;
+	uint8_t *ctrl;
+	unsigned int tombstones;
+	/* bumped on every rehash, slot indexes are stale after one */
+	unsigned int generation;
+	uint8_t shift;
+
+	unsigned int flags;
+
 	/* Hash table size. Must be power of 2 */
 	unsigned int size;
 
@@ -139,6 +155,29 @@ hash_create_size(unsigned int size, unsigned int (*hash_key)(const void *),
 		 bool (*hash_cmp)(const void *, const void *),
 		 const char *name);
 
+/*
+ * Create a hash table, with flags.
+ *
+ * HASH_OPEN_ADDRESSING makes the table store entries inline in one array
+ * (linear probing on a multiplicatively mixed key, with a control byte per
+ * slot) instead of allocating a bucket per entry and chaining them.  This
+ * saves an allocation and a pointer chase per entry and is faster for
+ * lookups, at the cost of growing earlier (at 7/8 load).  The API is the
+ * same, except that:
+ *
+ * - the struct hash_bucket passed to iteration callbacks is the slot in the
+ *   table; it is only valid until the next insertion.
+ * - hash->index is NULL, don't walk it directly - use hash_iterate() or
+ *   hash_walk().
+ * - max_size is only honored as long as the table doesn't fill up.
+ *
+ * The other parameters are as for hash_create_size().
+ */
+extern struct hash *
+hash_create_flags(unsigned int size, unsigned int (*hash_key)(const void *),
+		  bool (*hash_cmp)(const void *, const void *),
+		  const char *name, unsigned int flags);
+
 /*
  * Retrieve or insert data from / into a hash table.
  *
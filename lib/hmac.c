@@ -0,0 +1,314 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * HMAC with precomputed key state.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "hmac.h"
+#include "hook.h"
+#include "libfrr.h"
+#include "memory.h"
+#ifndef CRYPTO_OPENSSL
+#include "md5.h"
+#include "sha256.h"
+#endif
+
+DEFINE_MTYPE_STATIC(LIB, HMAC_KEY, "HMAC key state");
+
+#define HMAC_IPAD 0x36
+#define HMAC_OPAD 0x5c
+#define HMAC_MAX_BLOCK 128
+
+/* digest length and natural block size */
+static const struct {
+	uint8_t length;
+	uint8_t block;
+} hmac_algo[KEYCHAIN_ALGO_MAX] = {
+	[KEYCHAIN_ALGO_MD5] = { 16, 64 },
+	[KEYCHAIN_ALGO_HMAC_SHA1] = { 20, 64 },
+	[KEYCHAIN_ALGO_HMAC_SHA256] = { 32, 64 },
+	[KEYCHAIN_ALGO_HMAC_SHA384] = { 48, 128 },
+	[KEYCHAIN_ALGO_HMAC_SHA512] = { 64, 128 },
+};
+
+/* Thin layer over the digest implementation in use */
+#ifdef CRYPTO_OPENSSL
+struct hmac_ctx {
+	EVP_MD_CTX *evp;
+};
+
+static const EVP_MD *hmac_evp_md(enum keychain_hash_algo algo)
+{
+	switch (algo) {
+	case KEYCHAIN_ALGO_MD5:
+		return EVP_md5();
+	case KEYCHAIN_ALGO_HMAC_SHA1:
+		return EVP_sha1();
+	case KEYCHAIN_ALGO_HMAC_SHA256:
+		return EVP_sha256();
+	case KEYCHAIN_ALGO_HMAC_SHA384:
+		return EVP_sha384();
+	case KEYCHAIN_ALGO_HMAC_SHA512:
+		return EVP_sha512();
+	case KEYCHAIN_ALGO_NULL:
+	case KEYCHAIN_ALGO_MAX:
+		break;
+	}
+	return NULL;
+}
+
+static bool hmac_ctx_supported(enum keychain_hash_algo algo)
+{
+	return hmac_evp_md(algo) != NULL;
+}
+
+static void hmac_ctx_new(struct hmac_ctx *ctx)
+{
+	ctx->evp = EVP_MD_CTX_new();
+}
+
+static void hmac_ctx_free(struct hmac_ctx *ctx)
+{
+	EVP_MD_CTX_free(ctx->evp);
+	ctx->evp = NULL;
+}
+
+static void hmac_ctx_init(struct hmac_ctx *ctx, enum keychain_hash_algo algo)
+{
+	EVP_DigestInit_ex(ctx->evp, hmac_evp_md(algo), NULL);
+}
+
+static void hmac_ctx_copy(struct hmac_ctx *dst, const struct hmac_ctx *src)
+{
+	EVP_MD_CTX_copy_ex(dst->evp, src->evp);
+}
+
+static void hmac_ctx_update(struct hmac_ctx *ctx, enum keychain_hash_algo algo,
+			    const void *data, size_t len)
+{
+	EVP_DigestUpdate(ctx->evp, data, len);
+}
+
+static void hmac_ctx_final(struct hmac_ctx *ctx, enum keychain_hash_algo algo,
+			   uint8_t *digest)
+{
+	unsigned int len;
+
+	EVP_DigestFinal_ex(ctx->evp, digest, &len);
+}
+#else /* !CRYPTO_OPENSSL */
+struct hmac_ctx {
+	union {
+		MD5_CTX md5;
+		SHA256_CTX sha256;
+	} u;
+};
+
+static bool hmac_ctx_supported(enum keychain_hash_algo algo)
+{
+	return algo == KEYCHAIN_ALGO_MD5 || algo == KEYCHAIN_ALGO_HMAC_SHA256;
+}
+
+static void hmac_ctx_new(struct hmac_ctx *ctx)
+{
+}
+
+static void hmac_ctx_free(struct hmac_ctx *ctx)
+{
+}
+
+static void hmac_ctx_init(struct hmac_ctx *ctx, enum keychain_hash_algo algo)
+{
+	memset(ctx, 0, sizeof(*ctx));
+	if (algo == KEYCHAIN_ALGO_MD5)
+		MD5Init(&ctx->u.md5);
+	else
+		SHA256_Init(&ctx->u.sha256);
+}
+
+static void hmac_ctx_copy(struct hmac_ctx *dst, const struct hmac_ctx *src)
+{
+	*dst = *src;
+}
+
+static void hmac_ctx_update(struct hmac_ctx *ctx, enum keychain_hash_algo algo,
+			    const void *data, size_t len)
+{
+	if (algo == KEYCHAIN_ALGO_MD5)
+		MD5Update(&ctx->u.md5, data, len);
+	else
+		SHA256_Update(&ctx->u.sha256, data, len);
+}
+
+static void hmac_ctx_final(struct hmac_ctx *ctx, enum keychain_hash_algo algo,
+			   uint8_t *digest)
+{
+	if (algo == KEYCHAIN_ALGO_MD5)
+		MD5Final(digest, &ctx->u.md5);
+	else
+		SHA256_Final(digest, &ctx->u.sha256);
+}
+#endif /* !CRYPTO_OPENSSL */
+
+struct hmac_key {
+	enum keychain_hash_algo algo;
+	size_t block;
+
+	/* digest states after the inner and outer pads */
+	struct hmac_ctx ictx;
+	struct hmac_ctx octx;
+
+	/* what the states were built from, to validate cached ones */
+	size_t keylen;
+	uint8_t key[];
+};
+
+static size_t hmac_block(enum keychain_hash_algo algo, size_t block)
+{
+	return block ? block : hmac_algo[algo].block;
+}
+
+struct hmac_key *hmac_key_new(enum keychain_hash_algo algo, const void *key,
+			      size_t keylen, size_t block)
+{
+	struct hmac_key *hk;
+	uint8_t pad[HMAC_MAX_BLOCK];
+	uint8_t hashed[KEYCHAIN_MAX_HASH_SIZE];
+	const uint8_t *k = key;
+	size_t klen = keylen;
+	size_t i;
+
+	if (algo <= KEYCHAIN_ALGO_NULL || algo >= KEYCHAIN_ALGO_MAX
+	    || !hmac_ctx_supported(algo))
+		return NULL;
+
+	block = hmac_block(algo, block);
+	if (block > HMAC_MAX_BLOCK)
+		return NULL;
+
+	hk = XCALLOC(MTYPE_HMAC_KEY, sizeof(*hk) + keylen);
+	hk->algo = algo;
+	hk->block = block;
+	hk->keylen = keylen;
+	memcpy(hk->key, key, keylen);
+
+	hmac_ctx_new(&hk->ictx);
+	hmac_ctx_new(&hk->octx);
+
+	/* keys longer than the pad are replaced by their digest */
+	if (klen > block) {
+		hmac_ctx_init(&hk->ictx, algo);
+		hmac_ctx_update(&hk->ictx, algo, key, keylen);
+		hmac_ctx_final(&hk->ictx, algo, hashed);
+		k = hashed;
+		klen = hmac_algo[algo].length;
+	}
+
+	memset(pad, HMAC_IPAD, block);
+	for (i = 0; i < klen; i++)
+		pad[i] ^= k[i];
+	hmac_ctx_init(&hk->ictx, algo);
+	hmac_ctx_update(&hk->ictx, algo, pad, block);
+
+	memset(pad, HMAC_OPAD, block);
+	for (i = 0; i < klen; i++)
+		pad[i] ^= k[i];
+	hmac_ctx_init(&hk->octx, algo);
+	hmac_ctx_update(&hk->octx, algo, pad, block);
+
+	explicit_bzero(pad, sizeof(pad));
+	explicit_bzero(hashed, sizeof(hashed));
+
+	return hk;
+}
+
+void hmac_key_free(struct hmac_key **hkp)
+{
+	struct hmac_key *hk = *hkp;
+
+	if (!hk)
+		return;
+
+	hmac_ctx_free(&hk->ictx);
+	hmac_ctx_free(&hk->octx);
+	explicit_bzero(hk, sizeof(*hk) + hk->keylen);
+	XFREE(MTYPE_HMAC_KEY, *hkp);
+}
+
+static bool hmac_key_same(const struct hmac_key *hk,
+			  enum keychain_hash_algo algo, const void *key,
+			  size_t keylen, size_t block)
+{
+	return hk->algo == algo && hk->block == hmac_block(algo, block)
+	       && hk->keylen == keylen && !memcmp(hk->key, key, keylen);
+}
+
+struct hmac_key *hmac_key_get(struct hmac_key **cache,
+			      enum keychain_hash_algo algo, const void *key,
+			      size_t keylen, size_t block)
+{
+	if (*cache && hmac_key_same(*cache, algo, key, keylen, block))
+		return *cache;
+
+	hmac_key_free(cache);
+	*cache = hmac_key_new(algo, key, keylen, block);
+	return *cache;
+}
+
+/* states of hmac_key_lookup(), replaced round robin */
+#define HMAC_CACHE_SIZE 8
+static struct hmac_key *hmac_cache[HMAC_CACHE_SIZE];
+static unsigned int hmac_cache_next;
+static bool hmac_cache_registered;
+
+static int hmac_cache_fini(void)
+{
+	for (unsigned int i = 0; i < HMAC_CACHE_SIZE; i++)
+		hmac_key_free(&hmac_cache[i]);
+	return 0;
+}
+
+struct hmac_key *hmac_key_lookup(enum keychain_hash_algo algo,
+				 const void *key, size_t keylen, size_t block)
+{
+	unsigned int i;
+
+	for (i = 0; i < HMAC_CACHE_SIZE; i++)
+		if (hmac_cache[i]
+		    && hmac_key_same(hmac_cache[i], algo, key, keylen, block))
+			return hmac_cache[i];
+
+	if (!hmac_cache_registered) {
+		hook_register(frr_fini, hmac_cache_fini);
+		hmac_cache_registered = true;
+	}
+
+	i = hmac_cache_next++ % HMAC_CACHE_SIZE;
+	return hmac_key_get(&hmac_cache[i], algo, key, keylen, block);
+}
+
+size_t hmac_digest_len(const struct hmac_key *hk)
+{
+	return hmac_algo[hk->algo].length;
+}
+
+void hmac_digest(const struct hmac_key *hk, const void *data, size_t len,
+		 uint8_t *digest)
+{
+	uint8_t inner[KEYCHAIN_MAX_HASH_SIZE];
+	struct hmac_ctx ctx;
+
+	hmac_ctx_new(&ctx);
+
+	hmac_ctx_copy(&ctx, &hk->ictx);
+	hmac_ctx_update(&ctx, hk->algo, data, len);
+	hmac_ctx_final(&ctx, hk->algo, inner);
+
+	hmac_ctx_copy(&ctx, &hk->octx);
+	hmac_ctx_update(&ctx, hk->algo, inner, hmac_algo[hk->algo].length);
+	hmac_ctx_final(&ctx, hk->algo, digest);
+
+	hmac_ctx_free(&ctx);
+}
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * HMAC with precomputed key state.
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * The digest state after hashing the inner and outer key pads only depends
+ * on the key, so it is computed once and cloned for each message instead of
+ * being rebuilt (and the message copied after the pad) for every packet.
+ * Digests come from libcrypto when FRR is built with OpenSSL, which uses the
+ * CPU's SHA extensions where available, or from lib/md5.c and lib/sha256.c.
+ */
+
+#ifndef _FRR_HMAC_H
+#define _FRR_HMAC_H
+
+#include "keychain.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct hmac_key;
+
+/*
+ * Build the state for key.  block is the pad length; 0 selects the block
+ * size of the digest, as in RFC 2104.  A key longer than the pad is hashed
+ * first.  Returns NULL if algo isn't available in this build.
+ */
+extern struct hmac_key *hmac_key_new(enum keychain_hash_algo algo,
+				     const void *key, size_t keylen,
+				     size_t block);
+extern void hmac_key_free(struct hmac_key **hkp);
+
+/*
+ * Return *cache if it was built from the same parameters, otherwise
+ * (re)build it.  Meant to be used with a pointer embedded in the object
+ * holding the key, e.g. struct key.
+ */
+extern struct hmac_key *hmac_key_get(struct hmac_key **cache,
+				     enum keychain_hash_algo algo,
+				     const void *key, size_t keylen,
+				     size_t block);
+
+/*
+ * Same, for keys with no object to hold the state, e.g. passwords stored
+ * in a fixed size buffer.  A few recently used states are kept by the
+ * library; the returned one is valid until the next call.
+ */
+extern struct hmac_key *hmac_key_lookup(enum keychain_hash_algo algo,
+					const void *key, size_t keylen,
+					size_t block);
+
+extern size_t hmac_digest_len(const struct hmac_key *hk);
+
+/* digest must have room for hmac_digest_len() bytes */
+extern void hmac_digest(const struct hmac_key *hk, const void *data,
+			size_t len, uint8_t *digest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_HMAC_H */
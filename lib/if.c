@@ -21,6 +21,7 @@
 #include "log.h"
 #include "northbound_cli.h"
 #include "admin_group.h"
+#include "jhash.h"
 #include "lib/if_clippy.c"
 
 DEFINE_MTYPE_STATIC(LIB, IF, "Interface");
@@ -29,6 +30,7 @@ DEFINE_MTYPE_STATIC(LIB, CONNECTED, "Connected");
 DEFINE_MTYPE_STATIC(LIB, NBR_CONNECTED, "Neighbor Connected");
 DEFINE_MTYPE(LIB, CONNECTED_LABEL, "Connected interface label");
 DEFINE_MTYPE_STATIC(LIB, IF_LINK_PARAMS, "Informational Link Parameters");
+DEFINE_MTYPE_STATIC(LIB, IF_ADDR, "Interface address index");
 
 static void if_set_name(struct interface *ifp, const char *name);
 static struct interface *if_lookup_by_ifindex(ifindex_t ifindex,
@@ -144,6 +146,213 @@ static int if_cmp_index_func(const struct interface *ifp1,
 		return -1;
 }
 
+/*
+ * Interface names and ifindexes are unique across VRF-lite VRFs, which all
+ * share one network namespace, so lookups that don't know the VRF use these
+ * instead of going through every VRF.  With the netns backend the same
+ * name/ifindex shows up in several VRFs; only one of them is indexed then
+ * and the others are counted as shadowed, to find a replacement when the
+ * indexed one goes away.
+ */
+static int if_names_cmp(const struct interface *ifp1,
+			const struct interface *ifp2)
+{
+	return strcmp(ifp1->name, ifp2->name);
+}
+
+static uint32_t if_names_hash(const struct interface *ifp)
+{
+	return jhash(ifp->name, strlen(ifp->name), 0x9b1e5f03);
+}
+
+DECLARE_HASH(if_names, struct interface, names_item, if_names_cmp,
+	     if_names_hash);
+
+static int if_indexes_cmp(const struct interface *ifp1,
+			  const struct interface *ifp2)
+{
+	return numcmp(ifp1->ifindex, ifp2->ifindex);
+}
+
+static uint32_t if_indexes_hash(const struct interface *ifp)
+{
+	return jhash_1word(ifp->ifindex, 0x47c2d8a1);
+}
+
+DECLARE_HASH(if_indexes, struct interface, indexes_item, if_indexes_cmp,
+	     if_indexes_hash);
+
+static struct if_names_head if_names_all[1] = { INIT_HASH(if_names_all[0]) };
+static struct if_indexes_head if_indexes_all[1] = {
+	INIT_HASH(if_indexes_all[0]),
+};
+static unsigned int if_names_shadowed, if_indexes_shadowed;
+
+static void if_name_link(struct interface *ifp)
+{
+	if (IFNAME_RB_INSERT(ifp->vrf, ifp))
+		return;
+
+	if (if_names_add(if_names_all, ifp))
+		if_names_shadowed++;
+}
+
+static void if_name_unlink(struct interface *ifp)
+{
+	struct interface *other = NULL;
+	struct vrf *vrf;
+
+	IFNAME_RB_REMOVE(ifp->vrf, ifp);
+
+	if (ifp->name[0] == '\0')
+		return;
+	if (if_names_find(if_names_all, ifp) != ifp) {
+		if (if_names_shadowed)
+			if_names_shadowed--;
+		return;
+	}
+
+	if_names_del(if_names_all, ifp);
+	if (!if_names_shadowed)
+		return;
+
+	RB_FOREACH (vrf, vrf_name_head, &vrfs_by_name) {
+		other = RB_FIND(if_name_head, &vrf->ifaces_by_name, ifp);
+		if (other)
+			break;
+	}
+	if (other) {
+		if_names_add(if_names_all, other);
+		if_names_shadowed--;
+	}
+}
+
+static int if_index_link(struct interface *ifp)
+{
+	if (IFINDEX_RB_INSERT(ifp->vrf, ifp))
+		return -1;
+
+	if (if_indexes_add(if_indexes_all, ifp))
+		if_indexes_shadowed++;
+	return 0;
+}
+
+static void if_index_unlink(struct interface *ifp)
+{
+	struct interface *other = NULL;
+	struct vrf *vrf;
+
+	IFINDEX_RB_REMOVE(ifp->vrf, ifp);
+
+	if (if_indexes_find(if_indexes_all, ifp) != ifp) {
+		if (if_indexes_shadowed)
+			if_indexes_shadowed--;
+		return;
+	}
+
+	if_indexes_del(if_indexes_all, ifp);
+	if (!if_indexes_shadowed)
+		return;
+
+	RB_FOREACH (vrf, vrf_id_head, &vrfs_by_id) {
+		other = RB_FIND(if_index_head, &vrf->ifaces_by_index, ifp);
+		if (other)
+			break;
+	}
+	if (other) {
+		if_indexes_add(if_indexes_all, other);
+		if_indexes_shadowed--;
+	}
+}
+
+/*
+ * Local addresses, by VRF.  Several connected can carry the same address
+ * (on different interfaces, or with different prefix lengths), they are
+ * all kept on the entry.
+ */
+PREDECL_HASH(if_addrs);
+
+struct if_addr {
+	struct if_addrs_item item;
+
+	const struct vrf *vrf;
+	struct prefix addr;
+	struct list *connected;
+};
+
+static int if_addrs_cmp(const struct if_addr *a, const struct if_addr *b)
+{
+	if (a->vrf != b->vrf)
+		return numcmp((uintptr_t)a->vrf, (uintptr_t)b->vrf);
+	return prefix_cmp(&a->addr, &b->addr);
+}
+
+static uint32_t if_addrs_hash(const struct if_addr *ia)
+{
+	return jhash_2words(prefix_hash_key(&ia->addr),
+			    (uint32_t)(uintptr_t)ia->vrf, 0x6e3a1c59);
+}
+
+DECLARE_HASH(if_addrs, struct if_addr, item, if_addrs_cmp, if_addrs_hash);
+
+static struct if_addrs_head if_addrs_all[1] = { INIT_HASH(if_addrs_all[0]) };
+
+static bool if_addr_key(struct if_addr *key, const struct vrf *vrf,
+			const struct prefix *p)
+{
+	if (!vrf || !p || (p->family != AF_INET && p->family != AF_INET6))
+		return false;
+
+	memset(&key->addr, 0, sizeof(key->addr));
+	key->vrf = vrf;
+	key->addr.family = p->family;
+	key->addr.prefixlen = p->family == AF_INET ? IPV4_MAX_BITLEN
+						   : IPV6_MAX_BITLEN;
+	if (p->family == AF_INET)
+		key->addr.u.prefix4 = p->u.prefix4;
+	else
+		key->addr.u.prefix6 = p->u.prefix6;
+	return true;
+}
+
+static void if_addr_index(struct connected *ifc)
+{
+	struct if_addr key, *ia;
+
+	if (!ifc->ifp || !if_addr_key(&key, ifc->ifp->vrf, ifc->address))
+		return;
+
+	ia = if_addrs_find(if_addrs_all, &key);
+	if (!ia) {
+		ia = XCALLOC(MTYPE_IF_ADDR, sizeof(*ia));
+		ia->vrf = key.vrf;
+		ia->addr = key.addr;
+		ia->connected = list_new();
+		if_addrs_add(if_addrs_all, ia);
+	}
+	listnode_add(ia->connected, ifc);
+}
+
+static void if_addr_unindex(struct connected *ifc)
+{
+	struct if_addr key, *ia;
+
+	if (!ifc->ifp || !if_addr_key(&key, ifc->ifp->vrf, ifc->address))
+		return;
+
+	ia = if_addrs_find(if_addrs_all, &key);
+	if (!ia)
+		return;
+
+	listnode_delete(ia->connected, ifc);
+	if (listcount(ia->connected))
+		return;
+
+	if_addrs_del(if_addrs_all, ia);
+	list_delete(&ia->connected);
+	XFREE(MTYPE_IF_ADDR, ia);
+}
+
 static void ifp_connected_free(void *arg)
 {
 	struct connected *c = arg;
@@ -223,25 +432,29 @@ static struct interface *if_create_name(const char *name, struct vrf *vrf)
 /* Create new interface structure. */
 void if_update_to_new_vrf(struct interface *ifp, vrf_id_t vrf_id)
 {
-	struct vrf *old_vrf, *vrf;
+	struct listnode *node;
+	struct connected *ifc;
 
 	/* remove interface from old master vrf list */
-	old_vrf = ifp->vrf;
-
 	if (ifp->name[0] != '\0')
-		IFNAME_RB_REMOVE(old_vrf, ifp);
+		if_name_unlink(ifp);
 
 	if (ifp->ifindex != IFINDEX_INTERNAL)
-		IFINDEX_RB_REMOVE(old_vrf, ifp);
+		if_index_unlink(ifp);
 
-	vrf = vrf_get(vrf_id, NULL);
-	ifp->vrf = vrf;
+	for (ALL_LIST_ELEMENTS_RO(ifp->connected, node, ifc))
+		if_addr_unindex(ifc);
+
+	ifp->vrf = vrf_get(vrf_id, NULL);
 
 	if (ifp->name[0] != '\0')
-		IFNAME_RB_INSERT(vrf, ifp);
+		if_name_link(ifp);
 
 	if (ifp->ifindex != IFINDEX_INTERNAL)
-		IFINDEX_RB_INSERT(vrf, ifp);
+		if_index_link(ifp);
+
+	for (ALL_LIST_ELEMENTS_RO(ifp->connected, node, ifc))
+		if_addr_index(ifc);
 }
 
 
@@ -262,11 +475,10 @@ void if_delete_retain(struct interface *ifp)
 void if_delete(struct interface **ifp)
 {
 	struct interface *ptr = *ifp;
-	struct vrf *vrf = ptr->vrf;
 
-	IFNAME_RB_REMOVE(vrf, ptr);
+	if_name_unlink(ptr);
 	if (ptr->ifindex != IFINDEX_INTERNAL)
-		IFINDEX_RB_REMOVE(vrf, ptr);
+		if_index_unlink(ptr);
 
 	if_delete_retain(ptr);
 
@@ -389,11 +601,17 @@ struct interface *if_lookup_by_name_vrf(const char *name, struct vrf *vrf)
 static struct interface *if_lookup_by_name_all_vrf(const char *name)
 {
 	struct vrf *vrf;
-	struct interface *ifp;
+	struct interface *ifp, if_tmp;
 
 	if (!name || strnlen(name, INTERFACE_NAMSIZ) == INTERFACE_NAMSIZ)
 		return NULL;
 
+	if (!vrf_is_backend_netns()) {
+		strlcpy(if_tmp.name, name, sizeof(if_tmp.name));
+		return if_names_find(if_names_all, &if_tmp);
+	}
+
+	/* same name in several namespaces, keep the VRF order */
 	RB_FOREACH (vrf, vrf_name_head, &vrfs_by_name) {
 		ifp = if_lookup_by_name_vrf(name, vrf);
 		if (ifp)
@@ -405,19 +623,13 @@ static struct interface *if_lookup_by_name_all_vrf(const char *name)
 
 static struct interface *if_lookup_by_index_all_vrf(ifindex_t ifindex)
 {
-	struct vrf *vrf;
-	struct interface *ifp;
+	struct interface if_tmp;
 
 	if (ifindex == IFINDEX_INTERNAL)
 		return NULL;
 
-	RB_FOREACH (vrf, vrf_id_head, &vrfs_by_id) {
-		ifp = if_lookup_by_ifindex(ifindex, vrf->vrf_id);
-		if (ifp)
-			return ifp;
-	}
-
-	return NULL;
+	if_tmp.ifindex = ifindex;
+	return if_indexes_find(if_indexes_all, &if_tmp);
 }
 
 /* Lookup interface by IP address.
@@ -432,37 +644,29 @@ static struct interface *if_lookup_by_index_all_vrf(ifindex_t ifindex)
 struct interface *if_lookup_address_local(const void *src, int family,
 					  vrf_id_t vrf_id)
 {
-	struct vrf *vrf = vrf_lookup_by_id(vrf_id);
 	struct listnode *cnode;
-	struct interface *ifp, *best_down = NULL;
-	struct prefix *p;
+	struct interface *best_down = NULL;
+	struct if_addr key, *ia;
 	struct connected *c;
+	struct prefix p = {};
 
-	if (family != AF_INET && family != AF_INET6)
-		return NULL;
+	p.family = family;
+	if (family == AF_INET)
+		p.u.prefix4 = *(const struct in_addr *)src;
+	else if (family == AF_INET6)
+		p.u.prefix6 = *(const struct in6_addr *)src;
 
-	FOR_ALL_INTERFACES (vrf, ifp) {
-		for (ALL_LIST_ELEMENTS_RO(ifp->connected, cnode, c)) {
-			p = c->address;
-
-			if (!p || p->family != family)
-				continue;
-
-			if (family == AF_INET) {
-				if (!IPV4_ADDR_SAME(&p->u.prefix4,
-						    (struct in_addr *)src))
-					continue;
-			} else if (family == AF_INET6) {
-				if (!IPV6_ADDR_SAME(&p->u.prefix6,
-						    (struct in6_addr *)src))
-					continue;
-			}
+	if (!if_addr_key(&key, vrf_lookup_by_id(vrf_id), &p))
+		return NULL;
+	ia = if_addrs_find(if_addrs_all, &key);
+	if (!ia)
+		return NULL;
 
-			if (if_is_up(ifp))
-				return ifp;
-			if (!best_down)
-				best_down = ifp;
-		}
+	for (ALL_LIST_ELEMENTS_RO(ia->connected, cnode, c)) {
+		if (if_is_up(c->ifp))
+			return c->ifp;
+		if (!best_down)
+			best_down = c->ifp;
 	}
 	return best_down;
 }
@@ -627,7 +831,7 @@ int if_set_index(struct interface *ifp, ifindex_t ifindex)
 		return -1;
 
 	if (ifp->ifindex != IFINDEX_INTERNAL)
-		IFINDEX_RB_REMOVE(ifp->vrf, ifp);
+		if_index_unlink(ifp);
 
 	ifp->ifindex = ifindex;
 
@@ -637,7 +841,7 @@ int if_set_index(struct interface *ifp, ifindex_t ifindex)
 		 * already an interface with the desired ifindex at the top of
 		 * the function. Nevertheless.
 		 */
-		if (IFINDEX_RB_INSERT(ifp->vrf, ifp))
+		if (if_index_link(ifp))
 			return -1;
 	}
 
@@ -650,12 +854,12 @@ static void if_set_name(struct interface *ifp, const char *name)
 		return;
 
 	if (ifp->name[0] != '\0')
-		IFNAME_RB_REMOVE(ifp->vrf, ifp);
+		if_name_unlink(ifp);
 
 	strlcpy(ifp->name, name, sizeof(ifp->name));
 
 	if (ifp->name[0] != '\0')
-		IFNAME_RB_INSERT(ifp->vrf, ifp);
+		if_name_link(ifp);
 }
 
 /* Does interface up ? */
@@ -809,6 +1013,18 @@ struct connected *connected_new(void)
 	return XCALLOC(MTYPE_CONNECTED, sizeof(struct connected));
 }
 
+void connected_add(struct interface *ifp, struct connected *ifc)
+{
+	listnode_add(ifp->connected, ifc);
+	if_addr_index(ifc);
+}
+
+void connected_del(struct interface *ifp, struct connected *ifc)
+{
+	listnode_delete(ifp->connected, ifc);
+	if_addr_unindex(ifc);
+}
+
 /* Allocate nbr connected structure. */
 struct nbr_connected *nbr_connected_new(void)
 {
@@ -820,6 +1036,9 @@ void connected_free(struct connected **connected)
 {
 	struct connected *ptr = *connected;
 
+	/* in case it is freed while still on the interface */
+	if_addr_unindex(ptr);
+
 	prefix_free(&ptr->address);
 	prefix_free(&ptr->destination);
 
@@ -952,7 +1171,7 @@ struct connected *connected_delete_by_prefix(struct interface *ifp,
 		next = node->next;
 
 		if (connected_same_prefix(ifc->address, p)) {
-			listnode_delete(ifp->connected, ifc);
+			connected_del(ifp, ifc);
 			return ifc;
 		}
 	}
@@ -1001,7 +1220,7 @@ struct connected *connected_add_by_prefix(struct interface *ifp,
 	}
 
 	/* Add connected address to the interface. */
-	listnode_add(ifp->connected, ifc);
+	connected_add(ifp, ifc);
 	return ifc;
 }
 
@@ -11,6 +11,7 @@
 #include "memory.h"
 #include "qobj.h"
 #include "hook.h"
+#include "typesafe.h"
 #include "admin_group.h"
 
 #ifdef __cplusplus
@@ -206,10 +207,17 @@ struct if_link_params {
 #define INTERFACE_LINK_PARAMS_SIZE   sizeof(struct if_link_params)
 #define HAS_LINK_PARAMS(ifp)  ((ifp)->link_params != NULL)
 
+PREDECL_HASH(if_names);
+PREDECL_HASH(if_indexes);
+
 /* Interface structure */
 struct interface {
 	RB_ENTRY(interface) name_entry, index_entry;
 
+	/* global name/ifindex indexes, for lookups across all VRFs */
+	struct if_names_item names_item;
+	struct if_indexes_item indexes_item;
+
 	/* Interface name.  This should probably never be changed after the
 	   interface is created, because the configuration info for this
 	   interface
@@ -576,7 +584,9 @@ extern ifindex_t ifname2ifindex(const char *ifname, vrf_id_t vrf_id);
 /* Connected address functions. */
 extern struct connected *connected_new(void);
 extern void connected_free(struct connected **connected);
-extern void connected_add(struct interface *, struct connected *);
+/* put ifc on (or take it off) ifp->connected, ifc->address must be set */
+extern void connected_add(struct interface *ifp, struct connected *ifc);
+extern void connected_del(struct interface *ifp, struct connected *ifc);
 extern struct connected *
 connected_add_by_prefix(struct interface *, struct prefix *, struct prefix *);
 extern struct connected *connected_delete_by_prefix(struct interface *,
@@ -10,6 +10,7 @@
 #include "memory.h"
 #include "linklist.h"
 #include "keychain.h"
+#include "hmac.h"
 
 DEFINE_MTYPE_STATIC(LIB, KEY, "Key");
 DEFINE_MTYPE_STATIC(LIB, KEYCHAIN, "Key chain");
@@ -44,6 +45,7 @@ static struct key *key_new(void)
 static void key_free(struct key *key)
 {
 	QOBJ_UNREG(key);
+	hmac_key_free(&key->hmac);
 	XFREE(MTYPE_KEY, key);
 }
 
@@ -77,6 +77,9 @@ struct key {
 	struct key_range send;
 	struct key_range accept;
 
+	/* HMAC state for string, built on first use */
+	struct hmac_key *hmac;
+
 	QOBJ_FIELDS;
 };
 DECLARE_QOBJ_TYPE(key);
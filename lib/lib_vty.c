@@ -25,6 +25,8 @@
 #include "defaults.h"
 #include "lib_vty.h"
 #include "northbound_cli.h"
+#include "frrscript.h"
+#include "stream.h"
 
 /* Looking up memory status from vty interface. */
 #include "vector.h"
@@ -112,6 +114,48 @@ static int qmem_walker(void *arg, struct memgroup *mg, struct memtype *mt)
 	return 0;
 }
 
+struct memslab_walk_args {
+	struct vty *vty;
+	bool header;
+};
+
+static int memslab_walker(void *arg, struct memslab *ms)
+{
+	struct memslab_walk_args *args = arg;
+	struct vty *vty = args->vty;
+
+	if (!args->header) {
+		vty_out(vty, "--- slab allocators ---\n");
+		vty_out(vty, "%-30s: %8s %6s %8s %8s %9s\n", "Type", "Current#",
+			"Size", "Capacity", "Pages", "Released");
+		args->header = true;
+	}
+	vty_out(vty, "%-30s: %8zu %6zu %8zu %8zu %9zu\n", ms->mt->name,
+		ms->n_alloc, ms->size, ms->pages * ms->objs_per_page,
+		ms->pages, ms->pages_released);
+	return 0;
+}
+
+struct stream_pool_walk_args {
+	struct vty *vty;
+	bool header;
+};
+
+static int stream_pool_walker(void *arg, const struct stream_pool_stats *st)
+{
+	struct stream_pool_walk_args *args = arg;
+	struct vty *vty = args->vty;
+
+	if (!args->header) {
+		vty_out(vty, "--- stream pools ---\n");
+		vty_out(vty, "%-30s: %8s %12s %12s %9s\n", "Size", "Spare",
+			"Reused", "Allocated", "Released");
+		args->header = true;
+	}
+	vty_out(vty, "%-30zu: %8zu %12zu %12zu %9zu\n", st->size, st->depot,
+		st->hits, st->misses, st->released);
+	return 0;
+}
 
 DEFUN_NOSH (show_memory,
 	    show_memory_cmd,
@@ -119,11 +163,16 @@ DEFUN_NOSH (show_memory,
 	    "Show running system information\n"
 	    "Memory statistics\n")
 {
+	struct memslab_walk_args args = { .vty = vty };
+	struct stream_pool_walk_args sp_args = { .vty = vty };
+
 #ifdef HAVE_MALLINFO
 	show_memory_mallinfo(vty);
 #endif /* HAVE_MALLINFO */
 
 	qmem_walk(qmem_walker, vty);
+	memslab_walk(memslab_walker, &args);
+	stream_pool_walk(stream_pool_walker, &sp_args);
 	return CMD_SUCCESS;
 }
 
@@ -204,6 +253,30 @@ DEFUN (frr_version,
 	return CMD_SUCCESS;
 }
 
+#ifdef HAVE_SCRIPTING
+DEFUN (show_scripting_stats,
+       show_scripting_stats_cmd,
+       "show scripting stats",
+       SHOW_STR
+       "Lua scripting\n"
+       "Call counts and latency per script function\n")
+{
+	frrscript_stats_show(vty);
+	return CMD_SUCCESS;
+}
+
+DEFUN (clear_scripting_stats,
+       clear_scripting_stats_cmd,
+       "clear scripting stats",
+       CLEAR_STR
+       "Lua scripting\n"
+       "Call counts and latency per script function\n")
+{
+	frrscript_stats_clear();
+	return CMD_SUCCESS;
+}
+#endif /* HAVE_SCRIPTING */
+
 static struct call_back {
 	time_t readin_time;
 
@@ -290,6 +363,10 @@ void lib_cmd_init(void)
 
 	install_element(VIEW_NODE, &show_memory_cmd);
 	install_element(VIEW_NODE, &show_modules_cmd);
+#ifdef HAVE_SCRIPTING
+	install_element(VIEW_NODE, &show_scripting_stats_cmd);
+	install_element(ENABLE_NODE, &clear_scripting_stats_cmd);
+#endif
 
 	install_element(CONFIG_NODE, &start_config_cmd);
 	install_element(CONFIG_NODE, &end_config_cmd);
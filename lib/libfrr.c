@@ -32,6 +32,8 @@
 #include "defaults.h"
 #include "frrscript.h"
 #include "systemd.h"
+#include "flightrec.h"
+#include "stream.h"
 
 DEFINE_HOOK(frr_early_init, (struct event_loop * tm), (tm));
 DEFINE_HOOK(frr_late_init, (struct event_loop * tm), (tm));
@@ -96,6 +98,7 @@ static void opt_extend(const struct optspec *os)
 #define OPTION_LOGGING   1007
 #define OPTION_LIMIT_FDS 1008
 #define OPTION_SCRIPTDIR 1009
+#define OPTION_IO_BACKEND 1010
 
 static const struct option lo_always[] = {
 	{"help", no_argument, NULL, 'h'},
@@ -112,6 +115,7 @@ static const struct option lo_always[] = {
 	{"log-level", required_argument, NULL, OPTION_LOGLEVEL},
 	{"command-log-always", no_argument, NULL, OPTION_LOGGING},
 	{"limit-fds", required_argument, NULL, OPTION_LIMIT_FDS},
+	{"io-backend", required_argument, NULL, OPTION_IO_BACKEND},
 	{NULL}};
 static const struct optspec os_always = {
 	"hvdM:F:N:o:",
@@ -127,7 +131,8 @@ static const struct optspec os_always = {
 	"      --scriptdir    Override scripts directory\n"
 	"      --log          Set Logging to stdout, syslog, or file:<name>\n"
 	"      --log-level    Set Logging Level to use, debug, info, warn, etc\n"
-	"      --limit-fds    Limit number of fds supported\n",
+	"      --limit-fds    Limit number of fds supported\n"
+	"      --io-backend   Wait for I/O using poll (default) or epoll\n",
 	lo_always};
 
 
@@ -618,6 +623,14 @@ static int frr_opt(int opt)
 	case OPTION_LIMIT_FDS:
 		di->limit_fds = strtoul(optarg, &err, 0);
 		break;
+	case OPTION_IO_BACKEND:
+		if (!event_set_io_backend(optarg)) {
+			fprintf(stderr,
+				"I/O backend \"%s\" is not available on this system\n",
+				optarg);
+			errors++;
+		}
+		break;
 	default:
 		return 1;
 	}
@@ -1028,6 +1041,7 @@ void frr_config_fork(void)
 		di->pid_file = pidfile_default;
 	pid_output(di->pid_file);
 	zlog_tls_buffer_init();
+	flightrec_thread_init();
 }
 
 static void frr_vty_serv(void)
@@ -1215,6 +1229,9 @@ void frr_fini(void)
 	/* signal_init -> nothing needed */
 	event_master_free(master);
 	master = NULL;
+	flightrec_thread_fini();
+	flightrec_fini();
+	stream_pool_fini();
 	zlog_tls_buffer_fini();
 	zlog_fini();
 	/* frrmod_init -> nothing needed / hooks */
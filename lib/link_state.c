@@ -206,6 +206,8 @@ void ls_attributes_del(struct ls_attributes *attr)
 
 	admin_group_term(&attr->ext_admin_group);
 
+	XFREE(MTYPE_LS_DB, attr->name);
+
 	XFREE(MTYPE_LS_DB, attr);
 }
 
@@ -226,108 +228,209 @@ int ls_attributes_same(struct ls_attributes *l1, struct ls_attributes *l2)
 		return 0;
 
 	/* Finally, check each individual parameters that are valid */
-	if (CHECK_FLAG(l1->flags, LS_ATTR_NAME)
-	    && strncmp(l1->name, l2->name, MAX_NAME_LENGTH) != 0)
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_METRIC) && (l1->metric != l2->metric))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_TE_METRIC)
+	return ls_attributes_diff(l1, l2) == LS_ATTR_UNSET;
+}
+
+uint32_t ls_attributes_diff(const struct ls_attributes *l1,
+			    const struct ls_attributes *l2)
+{
+	uint32_t diff, both;
+
+	/* Parameters that are only valid on one side have changed */
+	diff = l1->flags ^ l2->flags;
+	both = l1->flags & l2->flags;
+
+	if (CHECK_FLAG(both, LS_ATTR_NAME) && strcmp(l1->name, l2->name) != 0)
+		SET_FLAG(diff, LS_ATTR_NAME);
+	if (CHECK_FLAG(both, LS_ATTR_METRIC) && (l1->metric != l2->metric))
+		SET_FLAG(diff, LS_ATTR_METRIC);
+	if (CHECK_FLAG(both, LS_ATTR_TE_METRIC)
 	    && (l1->standard.te_metric != l2->standard.te_metric))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_ADM_GRP)
+		SET_FLAG(diff, LS_ATTR_TE_METRIC);
+	if (CHECK_FLAG(both, LS_ATTR_ADM_GRP)
 	    && (l1->standard.admin_group != l2->standard.admin_group))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_EXT_ADM_GRP) &&
+		SET_FLAG(diff, LS_ATTR_ADM_GRP);
+	if (CHECK_FLAG(both, LS_ATTR_EXT_ADM_GRP) &&
 	    !admin_group_cmp(&l1->ext_admin_group, &l2->ext_admin_group))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_LOCAL_ADDR)
+		SET_FLAG(diff, LS_ATTR_EXT_ADM_GRP);
+	if (CHECK_FLAG(both, LS_ATTR_LOCAL_ADDR)
 	    && !IPV4_ADDR_SAME(&l1->standard.local, &l2->standard.local))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_NEIGH_ADDR)
+		SET_FLAG(diff, LS_ATTR_LOCAL_ADDR);
+	if (CHECK_FLAG(both, LS_ATTR_NEIGH_ADDR)
 	    && !IPV4_ADDR_SAME(&l1->standard.remote, &l2->standard.remote))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_LOCAL_ADDR6)
+		SET_FLAG(diff, LS_ATTR_NEIGH_ADDR);
+	if (CHECK_FLAG(both, LS_ATTR_LOCAL_ADDR6)
 	    && !IPV6_ADDR_SAME(&l1->standard.local6, &l2->standard.local6))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_NEIGH_ADDR6)
+		SET_FLAG(diff, LS_ATTR_LOCAL_ADDR6);
+	if (CHECK_FLAG(both, LS_ATTR_NEIGH_ADDR6)
 	    && !IPV6_ADDR_SAME(&l1->standard.remote6, &l2->standard.remote6))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_LOCAL_ID)
+		SET_FLAG(diff, LS_ATTR_NEIGH_ADDR6);
+	if (CHECK_FLAG(both, LS_ATTR_LOCAL_ID)
 	    && (l1->standard.local_id != l2->standard.local_id))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_NEIGH_ID)
+		SET_FLAG(diff, LS_ATTR_LOCAL_ID);
+	if (CHECK_FLAG(both, LS_ATTR_NEIGH_ID)
 	    && (l1->standard.remote_id != l2->standard.remote_id))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_MAX_BW)
+		SET_FLAG(diff, LS_ATTR_NEIGH_ID);
+	if (CHECK_FLAG(both, LS_ATTR_MAX_BW)
 	    && (l1->standard.max_bw != l2->standard.max_bw))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_MAX_RSV_BW)
+		SET_FLAG(diff, LS_ATTR_MAX_BW);
+	if (CHECK_FLAG(both, LS_ATTR_MAX_RSV_BW)
 	    && (l1->standard.max_rsv_bw != l2->standard.max_rsv_bw))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_UNRSV_BW)
+		SET_FLAG(diff, LS_ATTR_MAX_RSV_BW);
+	if (CHECK_FLAG(both, LS_ATTR_UNRSV_BW)
 	    && memcmp(&l1->standard.unrsv_bw, &l2->standard.unrsv_bw, 32) != 0)
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_REMOTE_AS)
+		SET_FLAG(diff, LS_ATTR_UNRSV_BW);
+	if (CHECK_FLAG(both, LS_ATTR_REMOTE_AS)
 	    && (l1->standard.remote_as != l2->standard.remote_as))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_REMOTE_ADDR)
+		SET_FLAG(diff, LS_ATTR_REMOTE_AS);
+	if (CHECK_FLAG(both, LS_ATTR_REMOTE_ADDR)
 	    && !IPV4_ADDR_SAME(&l1->standard.remote_addr,
 			       &l2->standard.remote_addr))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_REMOTE_ADDR6)
+		SET_FLAG(diff, LS_ATTR_REMOTE_ADDR);
+	if (CHECK_FLAG(both, LS_ATTR_REMOTE_ADDR6)
 	    && !IPV6_ADDR_SAME(&l1->standard.remote_addr6,
 			       &l2->standard.remote_addr6))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_DELAY)
+		SET_FLAG(diff, LS_ATTR_REMOTE_ADDR6);
+	if (CHECK_FLAG(both, LS_ATTR_DELAY)
 	    && (l1->extended.delay != l2->extended.delay))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_MIN_MAX_DELAY)
+		SET_FLAG(diff, LS_ATTR_DELAY);
+	if (CHECK_FLAG(both, LS_ATTR_MIN_MAX_DELAY)
 	    && ((l1->extended.min_delay != l2->extended.min_delay)
 		|| (l1->extended.max_delay != l2->extended.max_delay)))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_JITTER)
+		SET_FLAG(diff, LS_ATTR_MIN_MAX_DELAY);
+	if (CHECK_FLAG(both, LS_ATTR_JITTER)
 	    && (l1->extended.jitter != l2->extended.jitter))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_PACKET_LOSS)
+		SET_FLAG(diff, LS_ATTR_JITTER);
+	if (CHECK_FLAG(both, LS_ATTR_PACKET_LOSS)
 	    && (l1->extended.pkt_loss != l2->extended.pkt_loss))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_AVA_BW)
+		SET_FLAG(diff, LS_ATTR_PACKET_LOSS);
+	if (CHECK_FLAG(both, LS_ATTR_AVA_BW)
 	    && (l1->extended.ava_bw != l2->extended.ava_bw))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_RSV_BW)
+		SET_FLAG(diff, LS_ATTR_AVA_BW);
+	if (CHECK_FLAG(both, LS_ATTR_RSV_BW)
 	    && (l1->extended.rsv_bw != l2->extended.rsv_bw))
-		return 0;
-	if (CHECK_FLAG(l1->flags, LS_ATTR_USE_BW)
+		SET_FLAG(diff, LS_ATTR_RSV_BW);
+	if (CHECK_FLAG(both, LS_ATTR_USE_BW)
 	    && (l1->extended.used_bw != l2->extended.used_bw))
-		return 0;
+		SET_FLAG(diff, LS_ATTR_USE_BW);
 	for (int i = 0; i < LS_ADJ_MAX; i++) {
-		if (!CHECK_FLAG(l1->flags, (LS_ATTR_ADJ_SID << i)))
+		if (!CHECK_FLAG(both, (LS_ATTR_ADJ_SID << i)))
 			continue;
 		if ((l1->adj_sid[i].sid != l2->adj_sid[i].sid)
 		    || (l1->adj_sid[i].flags != l2->adj_sid[i].flags)
 		    || (l1->adj_sid[i].weight != l2->adj_sid[i].weight))
-			return 0;
+			SET_FLAG(diff, (LS_ATTR_ADJ_SID << i));
 		if (((l1->adv.origin == ISIS_L1) || (l1->adv.origin == ISIS_L2))
 		    && (memcmp(&l1->adj_sid[i].neighbor.sysid,
 			       &l2->adj_sid[i].neighbor.sysid, ISO_SYS_ID_LEN)
 			!= 0))
-			return 0;
+			SET_FLAG(diff, (LS_ATTR_ADJ_SID << i));
 		if (((l1->adv.origin == OSPFv2) || (l1->adv.origin == STATIC)
 		     || (l1->adv.origin == DIRECT))
 		    && (i < ADJ_PRI_IPV6)
 		    && (!IPV4_ADDR_SAME(&l1->adj_sid[i].neighbor.addr,
 					&l2->adj_sid[i].neighbor.addr)))
-			return 0;
+			SET_FLAG(diff, (LS_ATTR_ADJ_SID << i));
 	}
-	if (CHECK_FLAG(l1->flags, LS_ATTR_SRLG)
+	if (CHECK_FLAG(both, LS_ATTR_SRLG)
 	    && ((l1->srlg_len != l2->srlg_len)
 		|| memcmp(l1->srlgs, l2->srlgs,
 			  l1->srlg_len * sizeof(uint32_t))
 			   != 0))
-		return 0;
+		SET_FLAG(diff, LS_ATTR_SRLG);
 
-	/* OK, l1 & l2 are equal */
-	return 1;
+	return diff;
+}
+
+struct ls_attributes *ls_attributes_copy(const struct ls_attributes *src)
+{
+	struct ls_attributes *new;
+
+	new = XCALLOC(MTYPE_LS_DB, sizeof(struct ls_attributes));
+	admin_group_init(&new->ext_admin_group);
+	new->adv = src->adv;
+	ls_attributes_merge(new, src, src->flags);
+
+	return new;
+}
+
+void ls_attributes_merge(struct ls_attributes *dst,
+			 const struct ls_attributes *src, uint32_t mask)
+{
+	uint32_t set = src->flags & mask;
+
+	dst->flags = (dst->flags & ~mask) | set;
+
+	if (CHECK_FLAG(mask, LS_ATTR_NAME)) {
+		XFREE(MTYPE_LS_DB, dst->name);
+		if (CHECK_FLAG(set, LS_ATTR_NAME))
+			dst->name = XSTRDUP(MTYPE_LS_DB, src->name);
+	}
+	if (CHECK_FLAG(set, LS_ATTR_METRIC))
+		dst->metric = src->metric;
+	if (CHECK_FLAG(set, LS_ATTR_TE_METRIC))
+		dst->standard.te_metric = src->standard.te_metric;
+	if (CHECK_FLAG(set, LS_ATTR_ADM_GRP))
+		dst->standard.admin_group = src->standard.admin_group;
+	if (CHECK_FLAG(set, LS_ATTR_EXT_ADM_GRP))
+		admin_group_copy(&dst->ext_admin_group, &src->ext_admin_group);
+	else if (CHECK_FLAG(mask, LS_ATTR_EXT_ADM_GRP))
+		admin_group_clear(&dst->ext_admin_group);
+	if (CHECK_FLAG(set, LS_ATTR_LOCAL_ADDR))
+		dst->standard.local = src->standard.local;
+	if (CHECK_FLAG(set, LS_ATTR_NEIGH_ADDR))
+		dst->standard.remote = src->standard.remote;
+	if (CHECK_FLAG(set, LS_ATTR_LOCAL_ADDR6))
+		dst->standard.local6 = src->standard.local6;
+	if (CHECK_FLAG(set, LS_ATTR_NEIGH_ADDR6))
+		dst->standard.remote6 = src->standard.remote6;
+	if (CHECK_FLAG(set, LS_ATTR_LOCAL_ID))
+		dst->standard.local_id = src->standard.local_id;
+	if (CHECK_FLAG(set, LS_ATTR_NEIGH_ID))
+		dst->standard.remote_id = src->standard.remote_id;
+	if (CHECK_FLAG(set, LS_ATTR_MAX_BW))
+		dst->standard.max_bw = src->standard.max_bw;
+	if (CHECK_FLAG(set, LS_ATTR_MAX_RSV_BW))
+		dst->standard.max_rsv_bw = src->standard.max_rsv_bw;
+	if (CHECK_FLAG(set, LS_ATTR_UNRSV_BW))
+		memcpy(dst->standard.unrsv_bw, src->standard.unrsv_bw,
+		       sizeof(dst->standard.unrsv_bw));
+	if (CHECK_FLAG(set, LS_ATTR_REMOTE_AS))
+		dst->standard.remote_as = src->standard.remote_as;
+	if (CHECK_FLAG(set, LS_ATTR_REMOTE_ADDR))
+		dst->standard.remote_addr = src->standard.remote_addr;
+	if (CHECK_FLAG(set, LS_ATTR_REMOTE_ADDR6))
+		dst->standard.remote_addr6 = src->standard.remote_addr6;
+	if (CHECK_FLAG(set, LS_ATTR_DELAY))
+		dst->extended.delay = src->extended.delay;
+	if (CHECK_FLAG(set, LS_ATTR_MIN_MAX_DELAY)) {
+		dst->extended.min_delay = src->extended.min_delay;
+		dst->extended.max_delay = src->extended.max_delay;
+	}
+	if (CHECK_FLAG(set, LS_ATTR_JITTER))
+		dst->extended.jitter = src->extended.jitter;
+	if (CHECK_FLAG(set, LS_ATTR_PACKET_LOSS))
+		dst->extended.pkt_loss = src->extended.pkt_loss;
+	if (CHECK_FLAG(set, LS_ATTR_AVA_BW))
+		dst->extended.ava_bw = src->extended.ava_bw;
+	if (CHECK_FLAG(set, LS_ATTR_RSV_BW))
+		dst->extended.rsv_bw = src->extended.rsv_bw;
+	if (CHECK_FLAG(set, LS_ATTR_USE_BW))
+		dst->extended.used_bw = src->extended.used_bw;
+	for (int i = 0; i < LS_ADJ_MAX; i++)
+		if (CHECK_FLAG(set, (LS_ATTR_ADJ_SID << i)))
+			dst->adj_sid[i] = src->adj_sid[i];
+	if (CHECK_FLAG(mask, LS_ATTR_SRLG)) {
+		XFREE(MTYPE_LS_DB, dst->srlgs);
+		dst->srlg_len = 0;
+		if (CHECK_FLAG(set, LS_ATTR_SRLG) && src->srlg_len) {
+			dst->srlgs = XCALLOC(MTYPE_LS_DB,
+					     src->srlg_len * sizeof(uint32_t));
+			memcpy(dst->srlgs, src->srlgs,
+			       src->srlg_len * sizeof(uint32_t));
+			dst->srlg_len = src->srlg_len;
+		}
+	}
 }
 
 /**
@@ -832,6 +935,7 @@ void ls_edge_del(struct ls_ted *ted, struct ls_edge *edge)
 	ls_disconnect_edge(edge);
 	/* Then remove it from the Data Base */
 	edges_del(&ted->edges, edge);
+	ls_attributes_del(edge->exported);
 	XFREE(MTYPE_LS_DB, edge);
 }
 
@@ -1039,6 +1143,65 @@ void ls_ted_clean(struct ls_ted *ted)
 
 }
 
+static size_t ls_attributes_memory(const struct ls_attributes *attr)
+{
+	size_t size;
+
+	if (attr == NULL)
+		return 0;
+
+	size = sizeof(*attr) + attr->srlg_len * sizeof(uint32_t);
+	size += attr->ext_admin_group.bitmap.m * sizeof(word_t);
+	if (attr->name)
+		size += strlen(attr->name) + 1;
+
+	return size;
+}
+
+static size_t ls_list_memory(const struct list *list)
+{
+	if (list == NULL)
+		return 0;
+
+	return sizeof(*list) + listcount(list) * sizeof(struct listnode);
+}
+
+size_t ls_ted_memory(struct ls_ted *ted)
+{
+	struct ls_vertex *vertex;
+	struct ls_edge *edge;
+	struct ls_subnet *subnet;
+	size_t size;
+
+	if (ted == NULL)
+		return 0;
+
+	size = sizeof(*ted);
+
+	frr_each (vertices, &ted->vertices, vertex) {
+		size += sizeof(*vertex);
+		if (vertex->node)
+			size += sizeof(struct ls_node);
+		size += ls_list_memory(vertex->incoming_edges);
+		size += ls_list_memory(vertex->outgoing_edges);
+		size += ls_list_memory(vertex->prefixes);
+	}
+
+	frr_each (edges, &ted->edges, edge) {
+		size += sizeof(*edge);
+		size += ls_attributes_memory(edge->attributes);
+		size += ls_attributes_memory(edge->exported);
+	}
+
+	frr_each (subnets, &ted->subnets, subnet) {
+		size += sizeof(*subnet);
+		if (subnet->ls_pref)
+			size += sizeof(struct ls_prefix);
+	}
+
+	return size;
+}
+
 void ls_connect(struct ls_vertex *vertex, struct ls_edge *edge, bool source)
 {
 	if (vertex == NULL || edge == NULL)
@@ -1197,9 +1360,11 @@ stream_failure:
 	return NULL;
 }
 
-static struct ls_attributes *ls_parse_attributes(struct stream *s)
+static struct ls_attributes *ls_parse_attributes(struct stream *s,
+						 uint32_t *changed)
 {
 	struct ls_attributes *attr;
+	uint32_t present;
 	uint8_t nb_ext_adm_grp;
 	uint32_t bitmap_data;
 	size_t len;
@@ -1210,17 +1375,28 @@ static struct ls_attributes *ls_parse_attributes(struct stream *s)
 
 	STREAM_GET(&attr->adv, s, sizeof(struct ls_node_id));
 	STREAM_GETL(s, attr->flags);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_NAME)) {
+	/*
+	 * Delta only carries the changed parameters which are still valid.
+	 * The others are not valid in the parsed Attributes.
+	 */
+	present = attr->flags;
+	if (changed) {
+		STREAM_GETL(s, *changed);
+		present &= *changed;
+		attr->flags = present;
+	}
+	if (CHECK_FLAG(present, LS_ATTR_NAME)) {
 		STREAM_GETC(s, len);
+		attr->name = XCALLOC(MTYPE_LS_DB, len + 1);
 		STREAM_GET(attr->name, s, len);
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_METRIC))
+	if (CHECK_FLAG(present, LS_ATTR_METRIC))
 		STREAM_GETL(s, attr->metric);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_TE_METRIC))
+	if (CHECK_FLAG(present, LS_ATTR_TE_METRIC))
 		STREAM_GETL(s, attr->standard.te_metric);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_ADM_GRP))
+	if (CHECK_FLAG(present, LS_ATTR_ADM_GRP))
 		STREAM_GETL(s, attr->standard.admin_group);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_EXT_ADM_GRP)) {
+	if (CHECK_FLAG(present, LS_ATTR_EXT_ADM_GRP)) {
 		/* Extended Administrative Group */
 		STREAM_GETC(s, nb_ext_adm_grp);
 		for (size_t i = 0; i < nb_ext_adm_grp; i++) {
@@ -1229,76 +1405,76 @@ static struct ls_attributes *ls_parse_attributes(struct stream *s)
 					     bitmap_data, i);
 		}
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_LOCAL_ADDR))
+	if (CHECK_FLAG(present, LS_ATTR_LOCAL_ADDR))
 		attr->standard.local.s_addr = stream_get_ipv4(s);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_NEIGH_ADDR))
+	if (CHECK_FLAG(present, LS_ATTR_NEIGH_ADDR))
 		attr->standard.remote.s_addr = stream_get_ipv4(s);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_LOCAL_ADDR6))
+	if (CHECK_FLAG(present, LS_ATTR_LOCAL_ADDR6))
 		STREAM_GET(&attr->standard.local6, s, IPV6_MAX_BYTELEN);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_NEIGH_ADDR6))
+	if (CHECK_FLAG(present, LS_ATTR_NEIGH_ADDR6))
 		STREAM_GET(&attr->standard.remote6, s, IPV6_MAX_BYTELEN);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_LOCAL_ID))
+	if (CHECK_FLAG(present, LS_ATTR_LOCAL_ID))
 		STREAM_GETL(s, attr->standard.local_id);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_NEIGH_ID))
+	if (CHECK_FLAG(present, LS_ATTR_NEIGH_ID))
 		STREAM_GETL(s, attr->standard.remote_id);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_MAX_BW))
+	if (CHECK_FLAG(present, LS_ATTR_MAX_BW))
 		STREAM_GETF(s, attr->standard.max_bw);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_MAX_RSV_BW))
+	if (CHECK_FLAG(present, LS_ATTR_MAX_RSV_BW))
 		STREAM_GETF(s, attr->standard.max_rsv_bw);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_UNRSV_BW))
+	if (CHECK_FLAG(present, LS_ATTR_UNRSV_BW))
 		for (len = 0; len < MAX_CLASS_TYPE; len++)
 			STREAM_GETF(s, attr->standard.unrsv_bw[len]);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_REMOTE_AS))
+	if (CHECK_FLAG(present, LS_ATTR_REMOTE_AS))
 		STREAM_GETL(s, attr->standard.remote_as);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_REMOTE_ADDR))
+	if (CHECK_FLAG(present, LS_ATTR_REMOTE_ADDR))
 		attr->standard.remote_addr.s_addr = stream_get_ipv4(s);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_REMOTE_ADDR6))
+	if (CHECK_FLAG(present, LS_ATTR_REMOTE_ADDR6))
 		STREAM_GET(&attr->standard.remote_addr6, s, IPV6_MAX_BYTELEN);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_DELAY))
+	if (CHECK_FLAG(present, LS_ATTR_DELAY))
 		STREAM_GETL(s, attr->extended.delay);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_MIN_MAX_DELAY)) {
+	if (CHECK_FLAG(present, LS_ATTR_MIN_MAX_DELAY)) {
 		STREAM_GETL(s, attr->extended.min_delay);
 		STREAM_GETL(s, attr->extended.max_delay);
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_JITTER))
+	if (CHECK_FLAG(present, LS_ATTR_JITTER))
 		STREAM_GETL(s, attr->extended.jitter);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_PACKET_LOSS))
+	if (CHECK_FLAG(present, LS_ATTR_PACKET_LOSS))
 		STREAM_GETL(s, attr->extended.pkt_loss);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_AVA_BW))
+	if (CHECK_FLAG(present, LS_ATTR_AVA_BW))
 		STREAM_GETF(s, attr->extended.ava_bw);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_RSV_BW))
+	if (CHECK_FLAG(present, LS_ATTR_RSV_BW))
 		STREAM_GETF(s, attr->extended.rsv_bw);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_USE_BW))
+	if (CHECK_FLAG(present, LS_ATTR_USE_BW))
 		STREAM_GETF(s, attr->extended.used_bw);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_ADJ_SID)) {
+	if (CHECK_FLAG(present, LS_ATTR_ADJ_SID)) {
 		STREAM_GETL(s, attr->adj_sid[ADJ_PRI_IPV4].sid);
 		STREAM_GETC(s, attr->adj_sid[ADJ_PRI_IPV4].flags);
 		STREAM_GETC(s, attr->adj_sid[ADJ_PRI_IPV4].weight);
 		attr->adj_sid[ADJ_PRI_IPV4].neighbor.addr.s_addr =
 			stream_get_ipv4(s);
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_BCK_ADJ_SID)) {
+	if (CHECK_FLAG(present, LS_ATTR_BCK_ADJ_SID)) {
 		STREAM_GETL(s, attr->adj_sid[ADJ_BCK_IPV4].sid);
 		STREAM_GETC(s, attr->adj_sid[ADJ_BCK_IPV4].flags);
 		STREAM_GETC(s, attr->adj_sid[ADJ_BCK_IPV4].weight);
 		attr->adj_sid[ADJ_BCK_IPV4].neighbor.addr.s_addr =
 			stream_get_ipv4(s);
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_ADJ_SID6)) {
+	if (CHECK_FLAG(present, LS_ATTR_ADJ_SID6)) {
 		STREAM_GETL(s, attr->adj_sid[ADJ_PRI_IPV6].sid);
 		STREAM_GETC(s, attr->adj_sid[ADJ_PRI_IPV6].flags);
 		STREAM_GETC(s, attr->adj_sid[ADJ_PRI_IPV6].weight);
 		STREAM_GET(attr->adj_sid[ADJ_PRI_IPV6].neighbor.sysid, s,
 			   ISO_SYS_ID_LEN);
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_BCK_ADJ_SID6)) {
+	if (CHECK_FLAG(present, LS_ATTR_BCK_ADJ_SID6)) {
 		STREAM_GETL(s, attr->adj_sid[ADJ_BCK_IPV6].sid);
 		STREAM_GETC(s, attr->adj_sid[ADJ_BCK_IPV6].flags);
 		STREAM_GETC(s, attr->adj_sid[ADJ_BCK_IPV6].weight);
 		STREAM_GET(attr->adj_sid[ADJ_BCK_IPV6].neighbor.sysid, s,
 			   ISO_SYS_ID_LEN);
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_SRLG)) {
+	if (CHECK_FLAG(present, LS_ATTR_SRLG)) {
 		STREAM_GETC(s, len);
 		attr->srlgs = XCALLOC(MTYPE_LS_DB, len*sizeof(uint32_t));
 		attr->srlg_len = len;
@@ -1312,9 +1488,7 @@ stream_failure:
 	zlog_err("LS(%s): Could not parse Link State Attributes. Abort!",
 		 __func__);
 	/* Clean memory allocation */
-	if (attr->srlgs != NULL)
-		XFREE(MTYPE_LS_DB, attr->srlgs);
-	XFREE(MTYPE_LS_DB, attr);
+	ls_attributes_del(attr);
 	return NULL;
 
 }
@@ -1371,7 +1545,9 @@ struct ls_message *ls_parse_msg(struct stream *s)
 		break;
 	case LS_MSG_TYPE_ATTRIBUTES:
 		STREAM_GET(&msg->remote_id, s, sizeof(struct ls_node_id));
-		msg->data.attr = ls_parse_attributes(s);
+		msg->data.attr = ls_parse_attributes(
+			s, msg->event == LS_MSG_EVENT_DELTA ? &msg->changed
+							    : NULL);
 		break;
 	case LS_MSG_TYPE_PREFIX:
 		msg->data.prefix = ls_parse_prefix(s);
@@ -1434,28 +1610,35 @@ static int ls_format_node(struct stream *s, struct ls_node *node)
 	return 0;
 }
 
-static int ls_format_attributes(struct stream *s, struct ls_attributes *attr)
+static int ls_format_attributes(struct stream *s, struct ls_attributes *attr,
+				const uint32_t *changed)
 {
 	size_t len, nb_ext_adm_grp;
+	uint32_t present;
 
 	/* Push Advertise node information first */
 	stream_put(s, &attr->adv, sizeof(struct ls_node_id));
 
 	/* Push Flags & Origin then LS attributes if there are present */
 	stream_putl(s, attr->flags);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_NAME)) {
+	present = attr->flags;
+	if (changed) {
+		stream_putl(s, *changed);
+		present &= *changed;
+	}
+	if (CHECK_FLAG(present, LS_ATTR_NAME)) {
 		len = strlen(attr->name);
 		stream_putc(s, len + 1);
 		stream_put(s, attr->name, len);
 		stream_putc(s, '\0');
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_METRIC))
+	if (CHECK_FLAG(present, LS_ATTR_METRIC))
 		stream_putl(s, attr->metric);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_TE_METRIC))
+	if (CHECK_FLAG(present, LS_ATTR_TE_METRIC))
 		stream_putl(s, attr->standard.te_metric);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_ADM_GRP))
+	if (CHECK_FLAG(present, LS_ATTR_ADM_GRP))
 		stream_putl(s, attr->standard.admin_group);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_EXT_ADM_GRP)) {
+	if (CHECK_FLAG(present, LS_ATTR_EXT_ADM_GRP)) {
 		/* Extended Administrative Group */
 		nb_ext_adm_grp = admin_group_nb_words(&attr->ext_admin_group);
 		stream_putc(s, nb_ext_adm_grp);
@@ -1463,76 +1646,76 @@ static int ls_format_attributes(struct stream *s, struct ls_attributes *attr)
 			stream_putl(s, admin_group_get_offset(
 					       &attr->ext_admin_group, i));
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_LOCAL_ADDR))
+	if (CHECK_FLAG(present, LS_ATTR_LOCAL_ADDR))
 		stream_put_ipv4(s, attr->standard.local.s_addr);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_NEIGH_ADDR))
+	if (CHECK_FLAG(present, LS_ATTR_NEIGH_ADDR))
 		stream_put_ipv4(s, attr->standard.remote.s_addr);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_LOCAL_ADDR6))
+	if (CHECK_FLAG(present, LS_ATTR_LOCAL_ADDR6))
 		stream_put(s, &attr->standard.local6, IPV6_MAX_BYTELEN);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_NEIGH_ADDR6))
+	if (CHECK_FLAG(present, LS_ATTR_NEIGH_ADDR6))
 		stream_put(s, &attr->standard.remote6, IPV6_MAX_BYTELEN);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_LOCAL_ID))
+	if (CHECK_FLAG(present, LS_ATTR_LOCAL_ID))
 		stream_putl(s, attr->standard.local_id);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_NEIGH_ID))
+	if (CHECK_FLAG(present, LS_ATTR_NEIGH_ID))
 		stream_putl(s, attr->standard.remote_id);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_MAX_BW))
+	if (CHECK_FLAG(present, LS_ATTR_MAX_BW))
 		stream_putf(s, attr->standard.max_bw);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_MAX_RSV_BW))
+	if (CHECK_FLAG(present, LS_ATTR_MAX_RSV_BW))
 		stream_putf(s, attr->standard.max_rsv_bw);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_UNRSV_BW))
+	if (CHECK_FLAG(present, LS_ATTR_UNRSV_BW))
 		for (len = 0; len < MAX_CLASS_TYPE; len++)
 			stream_putf(s, attr->standard.unrsv_bw[len]);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_REMOTE_AS))
+	if (CHECK_FLAG(present, LS_ATTR_REMOTE_AS))
 		stream_putl(s, attr->standard.remote_as);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_REMOTE_ADDR))
+	if (CHECK_FLAG(present, LS_ATTR_REMOTE_ADDR))
 		stream_put_ipv4(s, attr->standard.remote_addr.s_addr);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_REMOTE_ADDR6))
+	if (CHECK_FLAG(present, LS_ATTR_REMOTE_ADDR6))
 		stream_put(s, &attr->standard.remote_addr6, IPV6_MAX_BYTELEN);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_DELAY))
+	if (CHECK_FLAG(present, LS_ATTR_DELAY))
 		stream_putl(s, attr->extended.delay);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_MIN_MAX_DELAY)) {
+	if (CHECK_FLAG(present, LS_ATTR_MIN_MAX_DELAY)) {
 		stream_putl(s, attr->extended.min_delay);
 		stream_putl(s, attr->extended.max_delay);
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_JITTER))
+	if (CHECK_FLAG(present, LS_ATTR_JITTER))
 		stream_putl(s, attr->extended.jitter);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_PACKET_LOSS))
+	if (CHECK_FLAG(present, LS_ATTR_PACKET_LOSS))
 		stream_putl(s, attr->extended.pkt_loss);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_AVA_BW))
+	if (CHECK_FLAG(present, LS_ATTR_AVA_BW))
 		stream_putf(s, attr->extended.ava_bw);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_RSV_BW))
+	if (CHECK_FLAG(present, LS_ATTR_RSV_BW))
 		stream_putf(s, attr->extended.rsv_bw);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_USE_BW))
+	if (CHECK_FLAG(present, LS_ATTR_USE_BW))
 		stream_putf(s, attr->extended.used_bw);
-	if (CHECK_FLAG(attr->flags, LS_ATTR_ADJ_SID)) {
+	if (CHECK_FLAG(present, LS_ATTR_ADJ_SID)) {
 		stream_putl(s, attr->adj_sid[ADJ_PRI_IPV4].sid);
 		stream_putc(s, attr->adj_sid[ADJ_PRI_IPV4].flags);
 		stream_putc(s, attr->adj_sid[ADJ_PRI_IPV4].weight);
 		stream_put_ipv4(
 			s, attr->adj_sid[ADJ_PRI_IPV4].neighbor.addr.s_addr);
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_BCK_ADJ_SID)) {
+	if (CHECK_FLAG(present, LS_ATTR_BCK_ADJ_SID)) {
 		stream_putl(s, attr->adj_sid[ADJ_BCK_IPV4].sid);
 		stream_putc(s, attr->adj_sid[ADJ_BCK_IPV4].flags);
 		stream_putc(s, attr->adj_sid[ADJ_BCK_IPV4].weight);
 		stream_put_ipv4(
 			s, attr->adj_sid[ADJ_BCK_IPV4].neighbor.addr.s_addr);
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_ADJ_SID6)) {
+	if (CHECK_FLAG(present, LS_ATTR_ADJ_SID6)) {
 		stream_putl(s, attr->adj_sid[ADJ_PRI_IPV6].sid);
 		stream_putc(s, attr->adj_sid[ADJ_PRI_IPV6].flags);
 		stream_putc(s, attr->adj_sid[ADJ_PRI_IPV6].weight);
 		stream_put(s, attr->adj_sid[ADJ_PRI_IPV6].neighbor.sysid,
 			   ISO_SYS_ID_LEN);
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_BCK_ADJ_SID6)) {
+	if (CHECK_FLAG(present, LS_ATTR_BCK_ADJ_SID6)) {
 		stream_putl(s, attr->adj_sid[ADJ_BCK_IPV6].sid);
 		stream_putc(s, attr->adj_sid[ADJ_BCK_IPV6].flags);
 		stream_putc(s, attr->adj_sid[ADJ_BCK_IPV6].weight);
 		stream_put(s, attr->adj_sid[ADJ_BCK_IPV6].neighbor.sysid,
 			   ISO_SYS_ID_LEN);
 	}
-	if (CHECK_FLAG(attr->flags, LS_ATTR_SRLG)) {
+	if (CHECK_FLAG(present, LS_ATTR_SRLG)) {
 		stream_putc(s, attr->srlg_len);
 		for (len = 0; len < attr->srlg_len; len++)
 			stream_putl(s, attr->srlgs[len]);
@@ -1585,7 +1768,10 @@ static int ls_format_msg(struct stream *s, struct ls_message *msg)
 	case LS_MSG_TYPE_ATTRIBUTES:
 		/* Add remote node first */
 		stream_put(s, &msg->remote_id, sizeof(struct ls_node_id));
-		return ls_format_attributes(s, msg->data.attr);
+		return ls_format_attributes(s, msg->data.attr,
+					    msg->event == LS_MSG_EVENT_DELTA
+						    ? &msg->changed
+						    : NULL);
 	case LS_MSG_TYPE_PREFIX:
 		return ls_format_prefix(s, msg->data.prefix);
 	default:
@@ -1640,6 +1826,43 @@ int ls_send_msg(struct zclient *zclient, struct ls_message *msg,
 
 	return zclient_send_message(zclient);
 }
+int ls_send_edge(struct zclient *zclient, struct ls_edge *edge,
+		 struct zapi_opaque_reg_info *dst)
+{
+	struct ls_message msg;
+	int rc;
+
+	ls_edge2msg(&msg, edge);
+
+	/* Only send what changed since the last export of this Edge */
+	if (msg.event == LS_MSG_EVENT_UPDATE && edge->exported
+	    && ls_node_id_same(edge->exported->adv, edge->attributes->adv)) {
+		msg.changed = ls_attributes_diff(edge->exported,
+						 edge->attributes);
+		if (msg.changed == LS_ATTR_UNSET)
+			return 0;
+		msg.event = LS_MSG_EVENT_DELTA;
+		SET_FLAG(msg.changed, LS_ATTR_KEY_MASK);
+	}
+
+	rc = ls_send_msg(zclient, &msg, dst);
+	if (rc < 0)
+		return rc;
+
+	/* Keep a copy of what the consumers now know about this Edge */
+	if (msg.event == LS_MSG_EVENT_DELTA) {
+		ls_attributes_merge(edge->exported, edge->attributes,
+				    msg.changed);
+		return rc;
+	}
+	ls_attributes_del(edge->exported);
+	edge->exported = NULL;
+	if (msg.event != LS_MSG_EVENT_DELETE && edge->attributes)
+		edge->exported = ls_attributes_copy(edge->attributes);
+
+	return rc;
+}
+
 struct ls_message *ls_vertex2msg(struct ls_message *msg,
 				 struct ls_vertex *vertex)
 {
@@ -1805,6 +2028,20 @@ struct ls_edge *ls_msg2edge(struct ls_ted *ted, struct ls_message *msg,
 		if (edge)
 			edge->status = UPDATE;
 		break;
+	case LS_MSG_EVENT_DELTA:
+		/* Apply changed parameters to the Attributes we already have */
+		edge = ls_find_edge_by_source(ted, attr);
+		if (edge) {
+			edge->attributes->adv = attr->adv;
+			ls_attributes_merge(edge->attributes, attr,
+					    msg->changed);
+			edge->status = UPDATE;
+		} else
+			zlog_warn("LS(%s): Got delta for unknown Edge",
+				  __func__);
+		ls_attributes_del(attr);
+		msg->data.attr = edge ? edge->attributes : NULL;
+		break;
 	case LS_MSG_EVENT_DELETE:
 		edge = ls_find_edge_by_source(ted, attr);
 		if (edge) {
@@ -1924,6 +2161,12 @@ int ls_sync_ted(struct ls_ted *ted, struct zclient *zclient,
 	frr_each(edges, &ted->edges, edge) {
 		ls_edge2msg(&msg, edge);
 		ls_send_msg(zclient, &msg, dst);
+		/*
+		 * The new consumer did not get the previous exports, so the
+		 * next update of this Edge must be a complete one.
+		 */
+		ls_attributes_del(edge->exported);
+		edge->exported = NULL;
 	}
 	frr_each(subnets, &ted->subnets, subnet) {
 		ls_subnet2msg(&msg, subnet);
@@ -2684,6 +2927,7 @@ void ls_show_ted(struct ls_ted *ted, struct vty *vty, struct json_object *json,
 				    edges_count(&ted->edges));
 		json_object_int_add(jted, "subnetsCount",
 				    subnets_count(&ted->subnets));
+		json_object_int_add(jted, "memoryBytes", ls_ted_memory(ted));
 		ls_show_vertices(ted, NULL, jted, verbose);
 		ls_show_edges(ted, NULL, jted, verbose);
 		ls_show_subnets(ted, NULL, jted, verbose);
@@ -2698,9 +2942,10 @@ void ls_show_ted(struct ls_ted *ted, struct vty *vty, struct json_object *json,
 		ls_show_edges(ted, vty, NULL, verbose);
 		ls_show_subnets(ted, vty, NULL, verbose);
 		vty_out(vty,
-			"\n\tTotal: %zu Vertices, %zu Edges, %zu Subnets\n\n",
+			"\n\tTotal: %zu Vertices, %zu Edges, %zu Subnets\n",
 			vertices_count(&ted->vertices),
 			edges_count(&ted->edges), subnets_count(&ted->subnets));
+		vty_out(vty, "\tMemory: %zu bytes\n\n", ls_ted_memory(ted));
 	}
 }
 
@@ -159,11 +159,15 @@ struct ls_node {
 #define LS_ATTR_SRLG		0x10000000
 #define LS_ATTR_EXT_ADM_GRP 0x20000000
 
+/* Parameters which identify the Link and are always part of a delta */
+#define LS_ATTR_KEY_MASK	(LS_ATTR_LOCAL_ADDR | LS_ATTR_LOCAL_ADDR6 \
+				 | LS_ATTR_LOCAL_ID)
+
 /* Link State Attributes */
 struct ls_attributes {
 	uint32_t flags;			/* Flag for parameters validity */
 	struct ls_node_id adv;		/* Adv. Router of this Link State */
-	char name[MAX_NAME_LENGTH];	/* Name of the Edge. Could be null */
+	char *name;			/* Name of the Edge. Could be null */
 	uint32_t metric;		/* IGP standard metric */
 	struct ls_standard {		/* Standard TE metrics */
 		uint32_t te_metric;		/* Traffic Engineering metric */
@@ -306,6 +310,41 @@ extern void ls_attributes_del(struct ls_attributes *attr);
 extern int ls_attributes_same(struct ls_attributes *a1,
 			      struct ls_attributes *a2);
 
+/**
+ * Compare two Link State Attributes parameter by parameter. A parameter is
+ * reported as changed if it is valid in only one of the two Attributes, or if
+ * it is valid in both with a different value. Advertising router is ignored.
+ *
+ * @param a1	First Link State Attributes to be compare
+ * @param a2	Second Link State Attributes to be compare
+ *
+ * @return	Mask of LS_ATTR_* flags which differ, LS_ATTR_UNSET if none
+ */
+extern uint32_t ls_attributes_diff(const struct ls_attributes *a1,
+				   const struct ls_attributes *a2);
+
+/**
+ * Duplicate Link State Attributes, including SRLGs, name and extended admin
+ * group. Structure is dynamically allocated.
+ *
+ * @param src	Link State Attributes to be copied
+ *
+ * @return	New Link State Attributes
+ */
+extern struct ls_attributes *
+ls_attributes_copy(const struct ls_attributes *src);
+
+/**
+ * Overwrite the parameters selected by mask in dst with those of src. A
+ * parameter selected by mask but not valid in src is removed from dst.
+ *
+ * @param dst	Link State Attributes to be updated
+ * @param src	Link State Attributes that provide the new values
+ * @param mask	Bit mask of LS_ATTR_* flags to be merged
+ */
+extern void ls_attributes_merge(struct ls_attributes *dst,
+				const struct ls_attributes *src, uint32_t mask);
+
 /**
  * Create a new Link State Prefix. Structure is dynamically allocated.
  *
@@ -390,6 +429,7 @@ struct ls_edge {
 	struct edges_item entry;	/* Entry in RB tree */
 	uint64_t key;			/* Unique Key identifier */
 	struct ls_attributes *attributes;	/* Link State attributes */
+	struct ls_attributes *exported;	/* Attributes as last exported */
 	struct ls_vertex *source;	/* Pointer to the source Vertex */
 	struct ls_vertex *destination;	/* Pointer to the destination Vertex */
 };
@@ -746,6 +786,16 @@ extern void ls_ted_del_all(struct ls_ted **ted);
  */
 extern void ls_ted_clean(struct ls_ted *ted);
 
+/**
+ * Compute the memory used by the Link State Data Base i.e. Vertices, Edges,
+ * SubNets and all the Link State Nodes, Attributes and Prefixes they hold.
+ *
+ * @param ted	Link State Data Base
+ *
+ * @return	Memory footprint in bytes
+ */
+extern size_t ls_ted_memory(struct ls_ted *ted);
+
 /**
  * Connect Source and Destination Vertices by given Edge. Only non NULL source
  * and destination vertices are connected.
@@ -812,6 +862,7 @@ extern void ls_disconnect_edge(struct ls_edge *edge);
 #define LS_MSG_EVENT_ADD	2
 #define LS_MSG_EVENT_UPDATE	3
 #define LS_MSG_EVENT_DELETE	4
+#define LS_MSG_EVENT_DELTA	5	/* Changed Attributes only */
 
 /* ZAPI Opaque Link State Message sub-Type */
 #define LS_MSG_TYPE_NODE	1
@@ -823,6 +874,7 @@ struct ls_message {
 	uint8_t event;		/* Message Event: Sync, Add, Update, Delete */
 	uint8_t type;		/* Message Data Type: Node, Attribute, Prefix */
 	struct ls_node_id remote_id;	/* Remote Link State Node ID */
+	uint32_t changed;	/* Delta: LS_ATTR_* parameters carried */
 	union {
 		struct ls_node *node;		/* Link State Node */
 		struct ls_attributes *attr;	/* Link State Attributes */
@@ -891,6 +943,22 @@ extern void ls_delete_msg(struct ls_message *msg);
 extern int ls_send_msg(struct zclient *zclient, struct ls_message *msg,
 		       struct zapi_opaque_reg_info *dst);
 
+/**
+ * Send Link State Edge as new ZAPI Opaque message of type Link State. An
+ * update of an Edge which has already been sent only carries the Attributes
+ * parameters that changed since (LS_MSG_EVENT_DELTA), and nothing is sent if
+ * none did. A copy of the Attributes as sent is kept in the Edge for that.
+ *
+ * @param zclient	Zebra Client
+ * @param edge		Link State Edge to be sent
+ * @param dst		Destination daemon for unicast message,
+ *			NULL for broadcast message
+ *
+ * @return		0 on success, -1 otherwise
+ */
+extern int ls_send_edge(struct zclient *zclient, struct ls_edge *edge,
+			struct zapi_opaque_reg_info *dst);
+
 /**
  * Create a new Link State Message from a Link State Vertex. If Link State
  * Message is NULL, a new data structure is dynamically allocated.
@@ -457,7 +457,12 @@ static const struct zebra_desc_table command_types[] = {
 	DESC_ENTRY(ZEBRA_TC_CLASS_ADD),
 	DESC_ENTRY(ZEBRA_TC_CLASS_DELETE),
 	DESC_ENTRY(ZEBRA_TC_FILTER_ADD),
-	DESC_ENTRY(ZEBRA_TC_FILTER_DELETE)};
+	DESC_ENTRY(ZEBRA_TC_FILTER_DELETE),
+	DESC_ENTRY(ZEBRA_ROUTE_ADD_BATCH),
+	DESC_ENTRY(ZEBRA_ROUTE_NOTIFY_OWNER_BATCH),
+	DESC_ENTRY(ZEBRA_IPMR_ROUTE_STATS_BULK),
+	DESC_ENTRY(ZEBRA_INTERFACE_STATE_BULK),
+	DESC_ENTRY(ZEBRA_REDISTRIBUTE_ROUTE_BULK)};
 #undef DESC_ENTRY
 
 static const struct zebra_desc_table unknown = {0, "unknown", '?'};
@@ -27,6 +27,8 @@ static unsigned logmsgs_with_persist_bt;
 
 static const int log_default_lvl = LOG_DEBUG;
 
+#define LOG_ASYNC_LIMIT_DEFAULT 1024
+
 static int log_config_stdout_lvl = ZLOG_DISABLED;
 static int log_config_syslog_lvl = ZLOG_DISABLED;
 static int log_cmdline_stdout_lvl = ZLOG_DISABLED;
@@ -170,6 +172,8 @@ DEFUN_NOSH (show_logging,
 	    "Show current logging configuration\n")
 {
 	int stdout_prio;
+	size_t async_depth;
+	uint64_t async_dropped, async_delayed;
 
 	log_show_syslog(vty);
 
@@ -191,6 +195,15 @@ DEFUN_NOSH (show_logging,
 			zlog_priority[zt_file.prio_min], zt_file.filename);
 	vty_out(vty, "\n");
 
+	if (zlog_file_async_stats(&zt_file, &async_depth, &async_dropped,
+				  &async_delayed))
+		vty_out(vty,
+			"  asynchronous: %zu of %u batches queued, %s when full, %" PRIu64
+			" messages dropped, %" PRIu64 " delayed\n",
+			async_depth, zt_file.async_limit,
+			zt_file.async_block ? "waiting" : "dropping",
+			async_dropped, async_delayed);
+
 	if (zt_filterfile.parent.prio_min != ZLOG_DISABLED
 	    && zt_filterfile.parent.filename)
 		vty_out(vty, "Filtered-file logging: level %s, filename %s\n",
@@ -753,6 +766,37 @@ DEFPY (log_immediate_mode,
 	return CMD_SUCCESS;
 }
 
+DEFPY (config_log_async,
+       config_log_async_cmd,
+       "log async [limit (1-65536)$limit] [block$block]",
+       "Logging control\n"
+       "Write the log file from a separate pthread\n"
+       "Maximum number of queued message batches\n"
+       "Number of batches\n"
+       "Wait for the writer instead of dropping messages when full\n")
+{
+	zt_file.async_limit = limit_str ? limit : LOG_ASYNC_LIMIT_DEFAULT;
+	zt_file.async_block = !!block;
+	zlog_file_set_other(&zt_file);
+	return CMD_SUCCESS;
+}
+
+DEFUN (no_config_log_async,
+       no_config_log_async_cmd,
+       "no log async [limit (1-65536)] [block]",
+       NO_STR
+       "Logging control\n"
+       "Write the log file from a separate pthread\n"
+       "Maximum number of queued message batches\n"
+       "Number of batches\n"
+       "Wait for the writer instead of dropping messages when full\n")
+{
+	zt_file.async_limit = 0;
+	zt_file.async_block = false;
+	zlog_file_set_other(&zt_file);
+	return CMD_SUCCESS;
+}
+
 void log_config_write(struct vty *vty)
 {
 	bool show_cmdline_hint = false;
@@ -828,6 +872,15 @@ void log_config_write(struct vty *vty)
 		vty_out(vty, "log timestamp precision %d\n",
 			zt_file.ts_subsec);
 
+	if (zt_file.async_limit) {
+		vty_out(vty, "log async");
+		if (zt_file.async_limit != LOG_ASYNC_LIMIT_DEFAULT)
+			vty_out(vty, " limit %u", zt_file.async_limit);
+		if (zt_file.async_block)
+			vty_out(vty, " block");
+		vty_out(vty, "\n");
+	}
+
 	if (!zlog_get_prefix_ec())
 		vty_out(vty, "no log error-category\n");
 	if (!zlog_get_prefix_xid())
@@ -896,6 +949,8 @@ void log_cmd_init(void)
 	install_element(CONFIG_NODE, &no_config_log_record_priority_cmd);
 	install_element(CONFIG_NODE, &config_log_timestamp_precision_cmd);
 	install_element(CONFIG_NODE, &no_config_log_timestamp_precision_cmd);
+	install_element(CONFIG_NODE, &config_log_async_cmd);
+	install_element(CONFIG_NODE, &no_config_log_async_cmd);
 	install_element(CONFIG_NODE, &config_log_ec_cmd);
 	install_element(CONFIG_NODE, &config_log_xid_cmd);
 
@@ -6,6 +6,7 @@
 #include <zebra.h>
 
 #include <stdlib.h>
+#include <sys/mman.h>
 #ifdef HAVE_MALLOC_H
 #include <malloc.h>
 #endif
@@ -17,8 +18,10 @@
 #endif
 
 #include "memory.h"
+#include "memprof.h"
 #include "log.h"
 #include "libfrr_trace.h"
+#include "frr_pthread.h"
 
 static struct memgroup *mg_first = NULL;
 struct memgroup **mg_insert = &mg_first;
@@ -27,7 +30,8 @@ DEFINE_MGROUP(LIB, "libfrr");
 DEFINE_MTYPE(LIB, TMP, "Temporary memory");
 DEFINE_MTYPE(LIB, BITFIELD, "Bitfield memory");
 
-static inline void mt_count_alloc(struct memtype *mt, size_t size, void *ptr)
+static inline void mt_count_alloc_sz(struct memtype *mt, size_t size,
+				     size_t mallocsz)
 {
 	size_t current;
 	size_t oldsize;
@@ -52,8 +56,6 @@ static inline void mt_count_alloc(struct memtype *mt, size_t size, void *ptr)
 				      memory_order_relaxed);
 
 #ifdef HAVE_MALLOC_USABLE_SIZE
-	size_t mallocsz = malloc_usable_size(ptr);
-
 	current = mallocsz + atomic_fetch_add_explicit(&mt->total, mallocsz,
 						       memory_order_relaxed);
 	oldsize = atomic_load_explicit(&mt->max_size, memory_order_relaxed);
@@ -66,20 +68,38 @@ static inline void mt_count_alloc(struct memtype *mt, size_t size, void *ptr)
 #endif
 }
 
-static inline void mt_count_free(struct memtype *mt, void *ptr)
+static inline void mt_count_alloc(struct memtype *mt, size_t size, void *ptr)
+{
+#ifdef HAVE_MALLOC_USABLE_SIZE
+	mt_count_alloc_sz(mt, size, malloc_usable_size(ptr));
+#else
+	mt_count_alloc_sz(mt, size, size);
+#endif
+}
+
+static inline void mt_count_free_sz(struct memtype *mt, void *ptr,
+				    size_t mallocsz)
 {
 	frrtrace(2, frr_libfrr, memfree, mt, ptr);
+	memprof_free(ptr);
 
 	assert(mt->n_alloc);
 	atomic_fetch_sub_explicit(&mt->n_alloc, 1, memory_order_relaxed);
 
 #ifdef HAVE_MALLOC_USABLE_SIZE
-	size_t mallocsz = malloc_usable_size(ptr);
-
 	atomic_fetch_sub_explicit(&mt->total, mallocsz, memory_order_relaxed);
 #endif
 }
 
+static inline void mt_count_free(struct memtype *mt, void *ptr)
+{
+#ifdef HAVE_MALLOC_USABLE_SIZE
+	mt_count_free_sz(mt, ptr, malloc_usable_size(ptr));
+#else
+	mt_count_free_sz(mt, ptr, 0);
+#endif
+}
+
 static inline void *mt_checkalloc(struct memtype *mt, void *ptr, size_t size)
 {
 	frrtrace(3, frr_libfrr, memalloc, mt, ptr, size);
@@ -92,6 +112,7 @@ static inline void *mt_checkalloc(struct memtype *mt, void *ptr, size_t size)
 		return NULL;
 	}
 	mt_count_alloc(mt, size, ptr);
+	memprof_alloc(mt, ptr, size);
 	return ptr;
 }
 
@@ -146,6 +167,208 @@ int qmem_walk(qmem_walk_fn *func, void *arg)
 	return 0;
 }
 
+/* slab allocator */
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#define MEMSLAB_ALIGN 16
+#define MEMSLAB_ROUNDUP(x) (((x) + MEMSLAB_ALIGN - 1) & ~(MEMSLAB_ALIGN - 1))
+
+/* lives at the start of each MEMSLAB_PAGE_SIZE aligned page */
+struct memslab_page {
+	struct memslab_page *next, *prev;
+	struct memslab *slab;
+
+	/* freed objects, chained through their first word */
+	void *free;
+	/* objects currently handed out */
+	unsigned int used;
+	/* objects ever handed out from the never touched tail of the page */
+	unsigned int carved;
+};
+
+#define MEMSLAB_HDR_SIZE MEMSLAB_ROUNDUP(sizeof(struct memslab_page))
+
+static struct memslab *ms_first;
+static struct memslab **ms_insert = &ms_first;
+
+static inline size_t memslab_stride(const struct memslab *ms)
+{
+	return MEMSLAB_ROUNDUP(MAX(ms->size, sizeof(void *)));
+}
+
+void memslab_register(struct memslab *ms)
+{
+	ms->objs_per_page = (MEMSLAB_PAGE_SIZE - MEMSLAB_HDR_SIZE) /
+			    memslab_stride(ms);
+	assert(ms->objs_per_page > 0);
+
+	ms->ref = ms_insert;
+	*ms_insert = ms;
+	ms_insert = &ms->next;
+}
+
+void memslab_unregister(struct memslab *ms)
+{
+	if (ms->next)
+		ms->next->ref = ms->ref;
+	else
+		ms_insert = ms->ref;
+	*ms->ref = ms->next;
+
+	/* live objects may still be around at exit, only drop the spare */
+	if (ms->spare) {
+		munmap(ms->spare, MEMSLAB_PAGE_SIZE);
+		ms->spare = NULL;
+		ms->pages--;
+	}
+}
+
+static struct memslab_page *memslab_page_new(struct memslab *ms)
+{
+	uintptr_t base, aligned;
+	size_t head, tail;
+	void *map;
+
+	/* over-map so an aligned page can be cut out of the mapping, this is
+	 * what allows qslab_free() to find the page header from the pointer
+	 */
+	map = mmap(NULL, 2 * MEMSLAB_PAGE_SIZE, PROT_READ | PROT_WRITE,
+		   MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+	if (map == MAP_FAILED)
+		memory_oom(MEMSLAB_PAGE_SIZE, ms->mt->name);
+
+	base = (uintptr_t)map;
+	aligned = (base + MEMSLAB_PAGE_SIZE - 1) & ~(MEMSLAB_PAGE_SIZE - 1);
+	head = aligned - base;
+	tail = MEMSLAB_PAGE_SIZE - head;
+
+	if (head)
+		munmap(map, head);
+	if (tail)
+		munmap((void *)(aligned + MEMSLAB_PAGE_SIZE), tail);
+
+	ms->pages++;
+	return (struct memslab_page *)aligned;
+}
+
+static void memslab_page_init(struct memslab *ms, struct memslab_page *page)
+{
+	/* the mapping is zeroed or fully reused, only the header matters */
+	page->next = page->prev = NULL;
+	page->slab = ms;
+	page->free = NULL;
+	page->used = 0;
+	page->carved = 0;
+}
+
+static void memslab_partial_add(struct memslab *ms, struct memslab_page *page)
+{
+	page->prev = NULL;
+	page->next = ms->partial;
+	if (ms->partial)
+		ms->partial->prev = page;
+	ms->partial = page;
+}
+
+static void memslab_partial_del(struct memslab *ms, struct memslab_page *page)
+{
+	if (page->prev)
+		page->prev->next = page->next;
+	else
+		ms->partial = page->next;
+	if (page->next)
+		page->next->prev = page->prev;
+	page->next = page->prev = NULL;
+}
+
+void *qslab_calloc(struct memslab *ms)
+{
+	struct memslab_page *page;
+	size_t stride = memslab_stride(ms);
+	void *obj;
+
+	frr_with_mutex (&ms->mtx) {
+		page = ms->partial;
+		if (!page) {
+			if (ms->spare) {
+				page = ms->spare;
+				ms->spare = NULL;
+			} else
+				page = memslab_page_new(ms);
+
+			memslab_page_init(ms, page);
+			memslab_partial_add(ms, page);
+		}
+
+		if (page->free) {
+			obj = page->free;
+			page->free = *(void **)obj;
+		} else
+			obj = (char *)page + MEMSLAB_HDR_SIZE +
+			      stride * page->carved++;
+
+		if (++page->used == ms->objs_per_page)
+			memslab_partial_del(ms, page);
+		ms->n_alloc++;
+	}
+
+	memset(obj, 0, ms->size);
+	frrtrace(3, frr_libfrr, memalloc, ms->mt, obj, ms->size);
+	mt_count_alloc_sz(ms->mt, ms->size, stride);
+	return obj;
+}
+
+void qslab_free(struct memslab *ms, void *ptr)
+{
+	struct memslab_page *page;
+
+	if (!ptr)
+		return;
+
+	page = (struct memslab_page *)((uintptr_t)ptr &
+				       ~(uintptr_t)(MEMSLAB_PAGE_SIZE - 1));
+	assert(page->slab == ms);
+
+	mt_count_free_sz(ms->mt, ptr, memslab_stride(ms));
+
+	frr_with_mutex (&ms->mtx) {
+		if (page->used == ms->objs_per_page)
+			memslab_partial_add(ms, page);
+
+		*(void **)ptr = page->free;
+		page->free = ptr;
+		page->used--;
+		ms->n_alloc--;
+
+		if (page->used)
+			break;
+
+		memslab_partial_del(ms, page);
+		if (!ms->spare) {
+			ms->spare = page;
+			break;
+		}
+
+		munmap(page, MEMSLAB_PAGE_SIZE);
+		ms->pages--;
+		ms->pages_released++;
+	}
+}
+
+int memslab_walk(memslab_walk_fn *func, void *arg)
+{
+	struct memslab *ms;
+	int rv;
+
+	for (ms = ms_first; ms; ms = ms->next)
+		if ((rv = func(arg, ms)))
+			return rv;
+	return 0;
+}
+
 struct exit_dump_args {
 	FILE *fp;
 	const char *prefix;
@@ -9,6 +9,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <pthread.h>
 #include <frratomic.h>
 #include "compiler.h"
 
@@ -171,6 +172,96 @@ static inline size_t mtype_stats_alloc(struct memtype *mt)
 	return mt->n_alloc;
 }
 
+/*
+ * Slab allocator for large numbers of fixed size objects.
+ *
+ * Objects are carved out of MEMSLAB_PAGE_SIZE pages mapped directly from the
+ * system.  A page is unmapped again as soon as its last object is freed (one
+ * empty page is kept around to avoid thrashing), so memory goes back to the
+ * system after mass deletions instead of staying behind as heap
+ * fragmentation.  Allocations are still accounted to the given memtype.
+ *
+ * macro usage:
+ *
+ *    DEFINE_MTYPE_STATIC(MYDAEMON, FOO, "foo objects");
+ *    DEFINE_MSLAB(FOO, sizeof(struct foo));
+ *
+ *    foo = XSLAB_CALLOC(MSLAB_FOO);
+ *    XSLAB_FREE(MSLAB_FOO, foo);
+ *
+ * Objects from a slab must only ever be freed with XSLAB_FREE on the same
+ * slab.  All functions are thread safe.
+ */
+#define MEMSLAB_PAGE_SIZE (64 * 1024)
+
+struct memslab_page;
+
+struct memslab {
+	struct memslab *next, **ref;
+	struct memtype *mt;
+	size_t size;
+
+	pthread_mutex_t mtx;
+
+	/* pages that have at least one free object */
+	struct memslab_page *partial;
+	/* fully unused page kept for the next allocation */
+	struct memslab_page *spare;
+
+	size_t objs_per_page;
+	size_t pages;
+	size_t n_alloc;
+	size_t pages_released;
+};
+
+extern void memslab_register(struct memslab *ms);
+extern void memslab_unregister(struct memslab *ms);
+
+#define DECLARE_MSLAB(name)                                                    \
+	extern struct memslab MSLAB_##name[1]                                  \
+	/* end */
+
+#define DEFINE_MSLAB_ATTR(mname, attr, objsize)                                \
+	attr struct memslab MSLAB_##mname[1] = { {                             \
+		.mt = MTYPE_##mname,                                           \
+		.size = (objsize),                                             \
+		.mtx = PTHREAD_MUTEX_INITIALIZER,                              \
+	} };                                                                   \
+	static void _msinit_##mname(void) __attribute__((_CONSTRUCTOR(1002))); \
+	static void _msinit_##mname(void)                                      \
+	{                                                                      \
+		memslab_register(MSLAB_##mname);                               \
+	}                                                                      \
+	static void _msfini_##mname(void) __attribute__((_DESTRUCTOR(1002)));  \
+	static void _msfini_##mname(void)                                      \
+	{                                                                      \
+		memslab_unregister(MSLAB_##mname);                             \
+	}                                                                      \
+	MACRO_REQUIRE_SEMICOLON() /* end */
+
+#define DEFINE_MSLAB(name, objsize)                                            \
+	DEFINE_MSLAB_ATTR(name, , objsize)                                     \
+	/* end */
+
+#define DEFINE_MSLAB_STATIC(name, objsize)                                     \
+	DEFINE_MSLAB_ATTR(name, static, objsize)                               \
+	/* end */
+
+extern void *qslab_calloc(struct memslab *ms)
+	__attribute__((malloc, nonnull(1) _RET_NONNULL));
+extern void qslab_free(struct memslab *ms, void *ptr)
+	__attribute__((nonnull(1)));
+
+#define XSLAB_CALLOC(mslab)		qslab_calloc(mslab)
+#define XSLAB_FREE(mslab, ptr)                                                 \
+	do {                                                                   \
+		qslab_free(mslab, ptr);                                        \
+		ptr = NULL;                                                    \
+	} while (0)
+
+typedef int memslab_walk_fn(void *arg, struct memslab *ms);
+extern int memslab_walk(memslab_walk_fn *func, void *arg);
+
 /* NB: calls are ordered by memgroup; and there is a call with mt == NULL for
  * each memgroup (so that a header can be printed, and empty memgroups show)
  *
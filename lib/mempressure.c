@@ -0,0 +1,403 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Memory pressure levels from MTYPE accounting.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "mempressure.h"
+#include "command.h"
+#include "frrevent.h"
+#include "libfrr.h"
+#include "memory.h"
+#include "monotime.h"
+#include "typesafe.h"
+
+DEFINE_MTYPE_STATIC(LIB, MEMPRESSURE, "Memory pressure limit");
+
+DEFINE_HOOK(memory_pressure,
+	    (enum mempressure_level level, enum mempressure_level prev),
+	    (level, prev));
+
+#define MEMPRESSURE_INTERVAL 1
+
+/* a limit is only left again once usage drops below 90% of it, so that
+ * shedding a cache doesn't immediately flip the level back and forth
+ */
+#define MEMPRESSURE_HYST(limit) ((limit) / 10 * 9)
+
+#define MIB(val) ((uint64_t)(val) << 20)
+
+PREDECL_DLIST(mp_limits);
+
+struct mp_limit {
+	struct mp_limits_item item;
+
+	/* first word of the memgroup name, NULL for the whole daemon */
+	char *group;
+	/* configured as "memory pressure daemon NAME ...", written back so */
+	bool daemon_scoped;
+
+	/* bytes, hard is 0 if not set */
+	uint64_t soft, hard;
+
+	uint64_t usage;
+	enum mempressure_level level;
+};
+
+DECLARE_DLIST(mp_limits, struct mp_limit, item);
+
+static struct mp_limits_head mp_limits[1] = { INIT_DLIST(mp_limits[0]) };
+
+static struct event_loop *mp_loop;
+static struct event *t_mp_check;
+
+static enum mempressure_level mp_level;
+static uint64_t mp_total;
+static uint64_t mp_entered[MEMPRESSURE_HARD + 1];
+static time_t mp_changed;
+
+enum mempressure_level mempressure_level(void)
+{
+	return mp_level;
+}
+
+const char *mempressure_level_str(enum mempressure_level level)
+{
+	switch (level) {
+	case MEMPRESSURE_NONE:
+		return "none";
+	case MEMPRESSURE_SOFT:
+		return "soft";
+	case MEMPRESSURE_HARD:
+		return "hard";
+	}
+	return "?";
+}
+
+/* groups are named by the first word of their description, e.g. "bgpd" or
+ * "BMP" for "BMP (BGP Monitoring Protocol)"
+ */
+static bool mp_group_match(const char *mgname, const char *group)
+{
+	size_t len = strcspn(mgname, " ");
+
+	return strlen(group) == len && !strncasecmp(mgname, group, len);
+}
+
+static uint64_t mp_mt_bytes(const struct memtype *mt)
+{
+#ifdef HAVE_MALLOC_USABLE_SIZE
+	return mt->total;
+#else
+	if (mt->size == SIZE_VAR)
+		return 0;
+	return (uint64_t)mt->n_alloc * mt->size;
+#endif
+}
+
+static int mp_sample_walker(void *arg, struct memgroup *mg,
+			    struct memtype *mt)
+{
+	struct mp_limit *lim;
+	uint64_t bytes;
+
+	if (!mt)
+		return 0;
+
+	bytes = mp_mt_bytes(mt);
+	mp_total += bytes;
+	frr_each (mp_limits, mp_limits, lim)
+		if (lim->group && mp_group_match(mg->name, lim->group))
+			lim->usage += bytes;
+	return 0;
+}
+
+static void mp_sample(void)
+{
+	struct mp_limit *lim;
+
+	mp_total = 0;
+	frr_each (mp_limits, mp_limits, lim)
+		lim->usage = 0;
+
+	qmem_walk(mp_sample_walker, NULL);
+
+	frr_each (mp_limits, mp_limits, lim)
+		if (!lim->group)
+			lim->usage = mp_total;
+}
+
+static enum mempressure_level mp_limit_level(const struct mp_limit *lim)
+{
+	if (lim->hard &&
+	    (lim->usage >= lim->hard ||
+	     (lim->level == MEMPRESSURE_HARD &&
+	      lim->usage >= MEMPRESSURE_HYST(lim->hard))))
+		return MEMPRESSURE_HARD;
+	if (lim->usage >= lim->soft ||
+	    (lim->level != MEMPRESSURE_NONE &&
+	     lim->usage >= MEMPRESSURE_HYST(lim->soft)))
+		return MEMPRESSURE_SOFT;
+	return MEMPRESSURE_NONE;
+}
+
+static void mp_set_level(enum mempressure_level level)
+{
+	enum mempressure_level prev = mp_level;
+
+	if (level != prev) {
+		mp_level = level;
+		mp_changed = monotime(NULL);
+		if (level > prev)
+			mp_entered[level]++;
+	}
+
+	/* keep calling while under pressure, caches may grow back */
+	if (level != MEMPRESSURE_NONE || prev != MEMPRESSURE_NONE)
+		hook_call(memory_pressure, level, prev);
+}
+
+static void mp_check(struct event *event);
+
+static void mp_schedule(void)
+{
+	if (!mp_limits_count(mp_limits)) {
+		EVENT_OFF(t_mp_check);
+		if (mp_level != MEMPRESSURE_NONE)
+			mp_set_level(MEMPRESSURE_NONE);
+		return;
+	}
+
+	if (mp_loop)
+		event_add_timer(mp_loop, mp_check, NULL, MEMPRESSURE_INTERVAL,
+				&t_mp_check);
+}
+
+static void mp_check(struct event *event)
+{
+	enum mempressure_level level = MEMPRESSURE_NONE, new;
+	struct mp_limit *lim;
+
+	mp_sample();
+
+	frr_each (mp_limits, mp_limits, lim) {
+		new = mp_limit_level(lim);
+		if (new != lim->level)
+			zlog_warn("memory pressure: %s%s at %" PRIu64
+				  " MiB, level %s (was %s)",
+				  lim->group ? "group " : "daemon",
+				  lim->group ? lim->group : "",
+				  lim->usage >> 20, mempressure_level_str(new),
+				  mempressure_level_str(lim->level));
+		lim->level = new;
+		level = MAX(level, new);
+	}
+
+	mp_set_level(level);
+	mp_schedule();
+}
+
+static struct mp_limit *mp_limit_find(const char *group)
+{
+	struct mp_limit *lim;
+
+	frr_each (mp_limits, mp_limits, lim) {
+		if (!group && !lim->group)
+			return lim;
+		if (group && lim->group && !strcasecmp(group, lim->group))
+			return lim;
+	}
+	return NULL;
+}
+
+static void mp_limit_free(struct mp_limit *lim)
+{
+	mp_limits_del(mp_limits, lim);
+	XFREE(MTYPE_MEMPRESSURE, lim->group);
+	XFREE(MTYPE_MEMPRESSURE, lim);
+}
+
+static int mp_group_find_walker(void *arg, struct memgroup *mg,
+				struct memtype *mt)
+{
+	const char *group = arg;
+
+	return !mt && mp_group_match(mg->name, group);
+}
+
+#include "lib/mempressure_clippy.c"
+
+DEFPY (memory_pressure_limit,
+       memory_pressure_limit_cmd,
+       "memory pressure [daemon WORD$dname] [group WORD$group] soft-limit (1-4194304)$soft [hard-limit (1-4194304)$hard]",
+       "Memory usage control\n"
+       "Limits at which subsystems start shedding memory\n"
+       "Only apply in one daemon\n"
+       "Daemon name\n"
+       "Only count one memory group\n"
+       "Memory group, first word of its name in \"show memory\"\n"
+       "Usage at which caches are dropped\n"
+       "Megabytes\n"
+       "Usage at which optional state is dropped too\n"
+       "Megabytes\n")
+{
+	struct mp_limit *lim;
+
+	if (dname && strcmp(dname, frr_get_progname()))
+		return CMD_SUCCESS;
+
+	if (hard_str && hard <= soft) {
+		vty_out(vty, "%% hard-limit must be above soft-limit\n");
+		return CMD_WARNING_CONFIG_FAILED;
+	}
+	if (group && !qmem_walk(mp_group_find_walker, (void *)group)) {
+		/* other daemons in an integrated config may have it */
+		if (!dname)
+			return CMD_SUCCESS;
+		vty_out(vty, "%% No memory group \"%s\" in %s\n", group,
+			dname);
+		return CMD_WARNING_CONFIG_FAILED;
+	}
+
+	lim = mp_limit_find(group);
+	if (!lim) {
+		lim = XCALLOC(MTYPE_MEMPRESSURE, sizeof(*lim));
+		if (group)
+			lim->group = XSTRDUP(MTYPE_MEMPRESSURE, group);
+		mp_limits_add_tail(mp_limits, lim);
+	}
+	lim->daemon_scoped = !!dname;
+	lim->soft = MIB(soft);
+	lim->hard = hard_str ? MIB(hard) : 0;
+
+	mp_schedule();
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_memory_pressure_limit,
+       no_memory_pressure_limit_cmd,
+       "no memory pressure [daemon WORD$dname] [group WORD$group] [soft-limit (1-4194304) [hard-limit (1-4194304)]]",
+       NO_STR
+       "Memory usage control\n"
+       "Limits at which subsystems start shedding memory\n"
+       "Only apply in one daemon\n"
+       "Daemon name\n"
+       "Only count one memory group\n"
+       "Memory group, first word of its name in \"show memory\"\n"
+       "Usage at which caches are dropped\n"
+       "Megabytes\n"
+       "Usage at which optional state is dropped too\n"
+       "Megabytes\n")
+{
+	struct mp_limit *lim;
+
+	if (dname && strcmp(dname, frr_get_progname()))
+		return CMD_SUCCESS;
+
+	lim = mp_limit_find(group);
+	if (lim)
+		mp_limit_free(lim);
+
+	mp_schedule();
+	return CMD_SUCCESS;
+}
+
+static void mp_show_bytes(struct vty *vty, uint64_t bytes)
+{
+	if (bytes)
+		vty_out(vty, " %7" PRIu64 " MiB", bytes >> 20);
+	else
+		vty_out(vty, " %11s", "-");
+}
+
+DEFUN_NOSH (show_memory_pressure,
+	    show_memory_pressure_cmd,
+	    "show memory pressure",
+	    SHOW_STR
+	    "Memory statistics\n"
+	    "Memory pressure limits and state\n")
+{
+	struct mp_limit *lim;
+	char buf[32], name[48];
+
+	/* levels are from the last check, usage is current */
+	mp_sample();
+
+	vty_out(vty, "Memory pressure level: %s",
+		mempressure_level_str(mp_level));
+	if (mp_changed)
+		vty_out(vty, ", changed %s ago",
+			frrtime_to_interval(monotime(NULL) - mp_changed, buf,
+					    sizeof(buf)));
+	vty_out(vty, "\n");
+	vty_out(vty, "Entered soft pressure %" PRIu64 " times, hard %" PRIu64
+		     " times\n",
+		mp_entered[MEMPRESSURE_SOFT], mp_entered[MEMPRESSURE_HARD]);
+	vty_out(vty, "Tracked allocations: %" PRIu64 " MiB\n", mp_total >> 20);
+
+	if (!mp_limits_count(mp_limits)) {
+		vty_out(vty, "No limits configured\n");
+		return CMD_SUCCESS;
+	}
+
+	vty_out(vty, "\n%-30s %11s %11s %11s  %s\n", "Limit", "Usage", "Soft",
+		"Hard", "Level");
+	frr_each (mp_limits, mp_limits, lim) {
+		if (lim->group)
+			snprintf(name, sizeof(name), "group %s", lim->group);
+		else
+			snprintf(name, sizeof(name), "daemon");
+		vty_out(vty, "%-30s", name);
+		vty_out(vty, " %7" PRIu64 " MiB", lim->usage >> 20);
+		mp_show_bytes(vty, lim->soft);
+		mp_show_bytes(vty, lim->hard);
+		vty_out(vty, "  %s\n", mempressure_level_str(lim->level));
+	}
+	return CMD_SUCCESS;
+}
+
+void mempressure_config_write(struct vty *vty)
+{
+	struct mp_limit *lim;
+
+	frr_each (mp_limits, mp_limits, lim) {
+		vty_out(vty, "memory pressure");
+		if (lim->daemon_scoped)
+			vty_out(vty, " daemon %s", frr_get_progname());
+		if (lim->group)
+			vty_out(vty, " group %s", lim->group);
+		vty_out(vty, " soft-limit %" PRIu64, lim->soft >> 20);
+		if (lim->hard)
+			vty_out(vty, " hard-limit %" PRIu64, lim->hard >> 20);
+		vty_out(vty, "\n");
+	}
+}
+
+static int mp_late_init(struct event_loop *tm)
+{
+	mp_loop = tm;
+	mp_schedule();
+	return 0;
+}
+
+static int mp_fini(void)
+{
+	struct mp_limit *lim;
+
+	EVENT_OFF(t_mp_check);
+	while ((lim = mp_limits_first(mp_limits)))
+		mp_limit_free(lim);
+	return 0;
+}
+
+void mempressure_cmd_init(void)
+{
+	hook_register(frr_late_init, mp_late_init);
+	hook_register(frr_fini, mp_fini);
+
+	install_element(CONFIG_NODE, &memory_pressure_limit_cmd);
+	install_element(CONFIG_NODE, &no_memory_pressure_limit_cmd);
+	install_element(VIEW_NODE, &show_memory_pressure_cmd);
+}
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Memory pressure levels from MTYPE accounting.
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * Soft and hard limits can be configured for the whole daemon and for
+ * single memory groups (as listed in "show memory").  Usage is sampled from
+ * the MTYPE counters once a second; the highest level of any limit is the
+ * daemon's pressure level.  While under pressure, the memory_pressure hook
+ * is called on every check, so subsystems can shed caches and stop growing
+ * optional state.  It is called once more when pressure goes away.
+ */
+
+#ifndef _FRR_MEMPRESSURE_H
+#define _FRR_MEMPRESSURE_H
+
+#include "hook.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct vty;
+
+enum mempressure_level {
+	MEMPRESSURE_NONE = 0,
+	MEMPRESSURE_SOFT,
+	MEMPRESSURE_HARD,
+};
+
+/* level is the new one, prev the level at the previous check.  Return value
+ * is ignored.
+ */
+DECLARE_HOOK(memory_pressure,
+	     (enum mempressure_level level, enum mempressure_level prev),
+	     (level, prev));
+
+extern enum mempressure_level mempressure_level(void);
+extern const char *mempressure_level_str(enum mempressure_level level);
+
+extern void mempressure_config_write(struct vty *vty);
+extern void mempressure_cmd_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_MEMPRESSURE_H */
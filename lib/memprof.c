@@ -0,0 +1,462 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Sampling heap profiler for MTYPE allocations.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include <math.h>
+#include <dlfcn.h>
+
+#ifdef HAVE_LIBUNWIND
+#define UNW_LOCAL_ONLY
+#include <libunwind.h>
+#elif defined(HAVE_GLIBC_BACKTRACE)
+#include <execinfo.h>
+#endif
+
+#include "memprof.h"
+#include "command.h"
+#include "frr_pthread.h"
+#include "jhash.h"
+#include "memory.h"
+#include "network.h"
+#include "typesafe.h"
+
+DEFINE_MTYPE_STATIC(LIB, MEMPROF, "Memory profile samples");
+
+#ifndef thread_local
+#define thread_local __thread
+#endif
+
+#define MEMPROF_DEFAULT_RATE (512 * 1024)
+#define MEMPROF_DEPTH 32
+/* mp_backtrace() and memprof_alloc_slow() */
+#define MEMPROF_SKIP 2
+
+atomic_size_t memprof_rate;
+atomic_size_t memprof_live;
+
+PREDECL_HASH(mp_buckets);
+PREDECL_HASH(mp_samples);
+
+/* all samples of one MTYPE taken with the same call stack */
+struct mp_bucket {
+	struct mp_buckets_item item;
+
+	struct memtype *mt;
+	uint32_t hash;
+	unsigned int depth;
+
+	uint64_t alloc_count, alloc_bytes;
+	uint64_t inuse_count, inuse_bytes;
+
+	void *pcs[MEMPROF_DEPTH];
+};
+
+/* a sampled allocation that hasn't been freed yet */
+struct mp_sample {
+	struct mp_samples_item item;
+
+	void *ptr;
+	size_t size;
+	struct mp_bucket *bucket;
+};
+
+static int mp_bucket_cmp(const struct mp_bucket *a, const struct mp_bucket *b)
+{
+	if (a->mt != b->mt)
+		return numcmp((uintptr_t)a->mt, (uintptr_t)b->mt);
+	if (a->depth != b->depth)
+		return numcmp(a->depth, b->depth);
+	return memcmp(a->pcs, b->pcs, a->depth * sizeof(a->pcs[0]));
+}
+
+static uint32_t mp_bucket_hash(const struct mp_bucket *b)
+{
+	return b->hash;
+}
+
+DECLARE_HASH(mp_buckets, struct mp_bucket, item, mp_bucket_cmp,
+	     mp_bucket_hash);
+
+static int mp_sample_cmp(const struct mp_sample *a, const struct mp_sample *b)
+{
+	return numcmp((uintptr_t)a->ptr, (uintptr_t)b->ptr);
+}
+
+static uint32_t mp_sample_hash(const struct mp_sample *s)
+{
+	uint64_t addr = (uintptr_t)s->ptr;
+
+	return jhash_2words(addr, addr >> 32, 0);
+}
+
+DECLARE_HASH(mp_samples, struct mp_sample, item, mp_sample_cmp,
+	     mp_sample_hash);
+
+static pthread_mutex_t mp_mtx = PTHREAD_MUTEX_INITIALIZER;
+static struct mp_buckets_head mp_buckets[1] = { INIT_HASH(mp_buckets[0]) };
+static struct mp_samples_head mp_samples[1] = { INIT_HASH(mp_samples[0]) };
+
+/* rate of the samples currently held, for unsampling */
+static size_t mp_sample_rate;
+
+/* bytes left until this thread takes its next sample */
+static thread_local int64_t mp_countdown;
+/* this thread is in here already, don't profile our own allocations */
+static thread_local bool mp_busy;
+
+/* exponentially distributed, like pprof's unsampling expects */
+static int64_t mp_next_interval(size_t rate)
+{
+	double u = (frr_weak_random() + 1.0) / (RAND_MAX + 2.0);
+
+	return (int64_t)(-log(u) * rate) + 1;
+}
+
+static int __attribute__((noinline)) mp_backtrace(void **pcs, int max)
+{
+#ifdef HAVE_LIBUNWIND
+	return unw_backtrace(pcs, max);
+#elif defined(HAVE_GLIBC_BACKTRACE)
+	return backtrace(pcs, max);
+#else
+	return 0;
+#endif
+}
+
+/* needs mp_mtx */
+static void mp_sample_drop(struct mp_sample *s)
+{
+	s->bucket->inuse_count--;
+	s->bucket->inuse_bytes -= s->size;
+	mp_samples_del(mp_samples, s);
+	XFREE(MTYPE_MEMPROF, s);
+	atomic_fetch_sub_explicit(&memprof_live, 1, memory_order_relaxed);
+}
+
+void memprof_alloc_slow(struct memtype *mt, void *ptr, size_t size)
+{
+	size_t rate = atomic_load_explicit(&memprof_rate, memory_order_relaxed);
+	void *pcs[MEMPROF_DEPTH + MEMPROF_SKIP];
+	struct mp_bucket ref, *bucket;
+	struct mp_sample *s, *prev;
+	int depth;
+
+	if (mp_busy || !rate)
+		return;
+
+	mp_countdown -= size;
+	if (mp_countdown > 0)
+		return;
+
+	mp_busy = true;
+	mp_countdown = mp_next_interval(rate);
+
+	depth = mp_backtrace(pcs, array_size(pcs)) - MEMPROF_SKIP;
+	if (depth < 0)
+		depth = 0;
+
+	ref.mt = mt;
+	ref.depth = depth;
+	memcpy(ref.pcs, pcs + MEMPROF_SKIP, depth * sizeof(pcs[0]));
+	ref.hash = jhash(ref.pcs, depth * sizeof(pcs[0]),
+			 (uintptr_t)mt >> 4);
+
+	frr_with_mutex (&mp_mtx) {
+		bucket = mp_buckets_find(mp_buckets, &ref);
+		if (!bucket) {
+			bucket = XCALLOC(MTYPE_MEMPROF, sizeof(*bucket));
+			bucket->mt = mt;
+			bucket->hash = ref.hash;
+			bucket->depth = ref.depth;
+			memcpy(bucket->pcs, ref.pcs, depth * sizeof(pcs[0]));
+			mp_buckets_add(mp_buckets, bucket);
+		}
+		bucket->alloc_count++;
+		bucket->alloc_bytes += size;
+		bucket->inuse_count++;
+		bucket->inuse_bytes += size;
+
+		s = XCALLOC(MTYPE_MEMPROF, sizeof(*s));
+		s->ptr = ptr;
+		s->size = size;
+		s->bucket = bucket;
+		atomic_fetch_add_explicit(&memprof_live, 1,
+					  memory_order_relaxed);
+
+		/* the old one was freed behind our back */
+		prev = mp_samples_add(mp_samples, s);
+		if (prev) {
+			mp_sample_drop(prev);
+			mp_samples_add(mp_samples, s);
+		}
+		mp_sample_rate = rate;
+	}
+
+	mp_busy = false;
+}
+
+void memprof_free_slow(void *ptr)
+{
+	struct mp_sample ref, *s;
+
+	if (mp_busy)
+		return;
+
+	mp_busy = true;
+	ref.ptr = ptr;
+	frr_with_mutex (&mp_mtx) {
+		s = mp_samples_find(mp_samples, &ref);
+		if (s)
+			mp_sample_drop(s);
+	}
+	mp_busy = false;
+}
+
+/* drop what has been freed, so the numbers start over */
+static void mp_reset(void)
+{
+	struct mp_bucket *bucket;
+
+	mp_busy = true;
+	frr_with_mutex (&mp_mtx) {
+		frr_each_safe (mp_buckets, mp_buckets, bucket) {
+			if (bucket->inuse_count) {
+				bucket->alloc_count = bucket->inuse_count;
+				bucket->alloc_bytes = bucket->inuse_bytes;
+				continue;
+			}
+			mp_buckets_del(mp_buckets, bucket);
+			XFREE(MTYPE_MEMPROF, bucket);
+		}
+	}
+	mp_busy = false;
+}
+
+/*
+ * Copy the buckets out, printing them to the vty allocates memory and
+ * mp_mtx can't be held for that.
+ */
+static struct mp_bucket *mp_snapshot(size_t *count, size_t *rate)
+{
+	struct mp_bucket *snap, *bucket;
+	size_t alloc, n = 0;
+
+	frr_with_mutex (&mp_mtx) {
+		alloc = mp_buckets_count(mp_buckets);
+	}
+
+	/* a few more may have shown up meanwhile, they can wait */
+	snap = XCALLOC(MTYPE_TMP, (alloc + 1) * sizeof(*snap));
+
+	frr_with_mutex (&mp_mtx) {
+		frr_each (mp_buckets, mp_buckets, bucket) {
+			if (n == alloc)
+				break;
+			snap[n++] = *bucket;
+		}
+		*rate = mp_sample_rate;
+	}
+
+	*count = n;
+	return snap;
+}
+
+/* estimated real bytes for sampled ones, same as pprof's heap_v2 */
+static double mp_unsample(uint64_t count, uint64_t bytes, size_t rate)
+{
+	double avg;
+
+	if (!count || !rate)
+		return bytes;
+
+	avg = (double)bytes / count;
+	return bytes / (1.0 - exp(-avg / rate));
+}
+
+static void mp_show_pprof(struct vty *vty)
+{
+	struct mp_bucket *snap;
+	uint64_t inuse_count = 0, inuse_bytes = 0;
+	uint64_t alloc_count = 0, alloc_bytes = 0;
+	size_t count, rate;
+	FILE *fp;
+	char line[512];
+
+	snap = mp_snapshot(&count, &rate);
+
+	for (size_t i = 0; i < count; i++) {
+		inuse_count += snap[i].inuse_count;
+		inuse_bytes += snap[i].inuse_bytes;
+		alloc_count += snap[i].alloc_count;
+		alloc_bytes += snap[i].alloc_bytes;
+	}
+
+	vty_out(vty,
+		"heap profile: %" PRIu64 ": %" PRIu64 " [%" PRIu64 ": %" PRIu64
+		"] @ heap_v2/%zu\n",
+		inuse_count, inuse_bytes, alloc_count, alloc_bytes, rate);
+
+	for (size_t i = 0; i < count; i++) {
+		struct mp_bucket *b = &snap[i];
+
+		vty_out(vty,
+			"%" PRIu64 ": %" PRIu64 " [%" PRIu64 ": %" PRIu64
+			"] @",
+			b->inuse_count, b->inuse_bytes, b->alloc_count,
+			b->alloc_bytes);
+		for (unsigned int j = 0; j < b->depth; j++)
+			vty_out(vty, " %p", b->pcs[j]);
+		vty_out(vty, "\n");
+	}
+
+	XFREE(MTYPE_TMP, snap);
+
+	/* pprof needs these to symbolize the addresses */
+	vty_out(vty, "\nMAPPED_LIBRARIES:\n");
+	fp = fopen("/proc/self/maps", "r");
+	if (!fp)
+		return;
+	while (fgets(line, sizeof(line), fp))
+		vty_out(vty, "%s", line);
+	fclose(fp);
+}
+
+static int mp_cmp_inuse(const void *a, const void *b)
+{
+	const struct mp_bucket *ba = a, *bb = b;
+
+	if (ba->mt != bb->mt)
+		return strcmp(ba->mt->name, bb->mt->name);
+	return -numcmp(ba->inuse_bytes, bb->inuse_bytes);
+}
+
+static void mp_show_frame(struct vty *vty, void *pc)
+{
+	Dl_info dli;
+
+	if (dladdr(pc, &dli) && dli.dli_sname)
+		vty_out(vty, "      %s+%#lx\n", dli.dli_sname,
+			(unsigned long)((char *)pc - (char *)dli.dli_saddr));
+	else
+		vty_out(vty, "      %p\n", pc);
+}
+
+/* how many call sites to list per MTYPE, and frames for each */
+#define MEMPROF_SUMMARY_SITES  3
+#define MEMPROF_SUMMARY_FRAMES 4
+
+static void mp_show_summary(struct vty *vty)
+{
+	struct mp_bucket *snap;
+	size_t count, rate, i, j, sites;
+
+	snap = mp_snapshot(&count, &rate);
+	qsort(snap, count, sizeof(*snap), mp_cmp_inuse);
+
+	vty_out(vty, "Sampling every %zu bytes, %zu samples live\n",
+		atomic_load_explicit(&memprof_rate, memory_order_relaxed),
+		atomic_load_explicit(&memprof_live, memory_order_relaxed));
+	vty_out(vty, "%-30s %14s %14s %8s\n", "Type", "In use (est.)",
+		"Allocated", "Sites");
+
+	for (i = 0; i < count; i = j) {
+		double inuse = 0, alloc = 0;
+
+		for (j = i; j < count && snap[j].mt == snap[i].mt; j++) {
+			inuse += mp_unsample(snap[j].inuse_count,
+					     snap[j].inuse_bytes, rate);
+			alloc += mp_unsample(snap[j].alloc_count,
+					     snap[j].alloc_bytes, rate);
+		}
+
+		vty_out(vty, "%-30s %14.0f %14.0f %8zu\n", snap[i].mt->name,
+			inuse, alloc, j - i);
+
+		sites = MIN(j - i, (size_t)MEMPROF_SUMMARY_SITES);
+		for (size_t k = i; k < i + sites; k++) {
+			if (!snap[k].inuse_bytes)
+				break;
+
+			vty_out(vty, "    %.0f bytes in use from:\n",
+				mp_unsample(snap[k].inuse_count,
+					    snap[k].inuse_bytes, rate));
+			for (unsigned int f = 0;
+			     f < MIN(snap[k].depth, MEMPROF_SUMMARY_FRAMES); f++)
+				mp_show_frame(vty, snap[k].pcs[f]);
+		}
+	}
+
+	XFREE(MTYPE_TMP, snap);
+}
+
+#include "lib/memprof_clippy.c"
+
+DEFPY (memory_profile,
+       memory_profile_cmd,
+       "memory profile [sample-bytes (4096-1073741824)$rate]",
+       "Memory usage control\n"
+       "Sample allocation call stacks\n"
+       "Average bytes allocated between samples\n"
+       "Bytes\n")
+{
+#if !defined(HAVE_LIBUNWIND) && !defined(HAVE_GLIBC_BACKTRACE)
+	vty_out(vty, "%% Built without backtrace support\n");
+	return CMD_WARNING;
+#endif
+	atomic_store_explicit(&memprof_rate,
+			      rate_str ? (size_t)rate : MEMPROF_DEFAULT_RATE,
+			      memory_order_relaxed);
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_memory_profile,
+       no_memory_profile_cmd,
+       "no memory profile [sample-bytes (4096-1073741824)]",
+       NO_STR
+       "Memory usage control\n"
+       "Sample allocation call stacks\n"
+       "Average bytes allocated between samples\n"
+       "Bytes\n")
+{
+	/* samples taken so far stay until freed or cleared */
+	atomic_store_explicit(&memprof_rate, 0, memory_order_relaxed);
+	return CMD_SUCCESS;
+}
+
+DEFPY (clear_memory_profile,
+       clear_memory_profile_cmd,
+       "clear memory profile",
+       CLEAR_STR
+       "Memory statistics\n"
+       "Allocation call stack samples\n")
+{
+	mp_reset();
+	return CMD_SUCCESS;
+}
+
+DEFPY_NOSH (show_memory_profile,
+	    show_memory_profile_cmd,
+	    "show memory profile [summary$summary]",
+	    SHOW_STR
+	    "Memory statistics\n"
+	    "Allocation call stack samples, in pprof heap profile format\n"
+	    "Totals per MTYPE and top call sites instead\n")
+{
+	if (summary)
+		mp_show_summary(vty);
+	else
+		mp_show_pprof(vty);
+	return CMD_SUCCESS;
+}
+
+void memprof_cmd_init(void)
+{
+	install_element(ENABLE_NODE, &memory_profile_cmd);
+	install_element(ENABLE_NODE, &no_memory_profile_cmd);
+	install_element(ENABLE_NODE, &clear_memory_profile_cmd);
+	install_element(VIEW_NODE, &show_memory_profile_cmd);
+}
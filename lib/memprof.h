@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Sampling heap profiler for MTYPE allocations.
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * While enabled with "memory profile", a backtrace is taken about every
+ * sample-bytes bytes allocated through qmalloc() & co.  Samples are
+ * aggregated per MTYPE and call stack, and tracked until freed, so both
+ * the allocated and the in-use numbers are known.  "show memory profile"
+ * prints them in the legacy pprof heap profile format; pprof does the
+ * unsampling itself from the rate in the header.
+ */
+
+#ifndef _FRR_MEMPROF_H
+#define _FRR_MEMPROF_H
+
+#include "frratomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct memtype;
+
+/* sampling interval in bytes, 0 while off */
+extern atomic_size_t memprof_rate;
+/* sampled allocations not freed yet */
+extern atomic_size_t memprof_live;
+
+extern void memprof_alloc_slow(struct memtype *mt, void *ptr, size_t size);
+extern void memprof_free_slow(void *ptr);
+
+/* called by lib/memory.c for every tracked allocation and free */
+static inline void memprof_alloc(struct memtype *mt, void *ptr, size_t size)
+{
+	if (__builtin_expect(atomic_load_explicit(&memprof_rate,
+						  memory_order_relaxed) != 0,
+			     0))
+		memprof_alloc_slow(mt, ptr, size);
+}
+
+static inline void memprof_free(void *ptr)
+{
+	if (__builtin_expect(atomic_load_explicit(&memprof_live,
+						  memory_order_relaxed) != 0,
+			     0))
+		memprof_free_slow(ptr);
+}
+
+extern void memprof_cmd_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_MEMPROF_H */
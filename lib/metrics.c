@@ -0,0 +1,370 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Statistics for export in the OpenMetrics text format
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "frr_pthread.h"
+#include "frrcu.h"
+#include "memory.h"
+#include "metrics.h"
+#include "monotime.h"
+#include "printfrr.h"
+#include "typesafe.h"
+
+DEFINE_MTYPE_STATIC(LIB, METRICS_COLLECTOR, "Metrics collector");
+DEFINE_MTYPE_STATIC(LIB, METRICS_TEXT, "Metrics text");
+
+struct metrics_out {
+	char *buf;
+	size_t len;
+	size_t size;
+};
+
+/* rendered snapshot, freed with RCU since the exporter may be reading it */
+struct metrics_text {
+	struct rcu_head rcu;
+	size_t len;
+	char text[];
+};
+
+PREDECL_DLIST(metrics_collectors);
+
+struct metrics_collector {
+	struct metrics_collectors_item item;
+
+	char *name;
+	metrics_collect_fn fn;
+	void *arg;
+
+	/* snapshots only */
+	struct event_loop *loop;
+	unsigned int interval_ms;
+	_Atomic int64_t refreshed_ms;
+	struct metrics_text *_Atomic text;
+	struct event *t_refresh;
+};
+
+DECLARE_DLIST(metrics_collectors, struct metrics_collector, item);
+
+/* collectors only run under this, so deleting one never races a scrape */
+static pthread_mutex_t metrics_mtx = PTHREAD_MUTEX_INITIALIZER;
+static struct metrics_collectors_head metrics_collectors =
+	INIT_DLIST(metrics_collectors);
+
+static void metrics_out_init(struct metrics_out *out, size_t size)
+{
+	out->buf = XMALLOC(MTYPE_METRICS_TEXT, size);
+	out->buf[0] = '\0';
+	out->len = 0;
+	out->size = size;
+}
+
+static PRINTFRR(2, 3) void metrics_printf(struct metrics_out *out,
+					  const char *fmt, ...)
+{
+	va_list ap;
+	ssize_t n;
+
+	for (;;) {
+		va_start(ap, fmt);
+		n = vsnprintfrr(out->buf + out->len, out->size - out->len, fmt,
+				ap);
+		va_end(ap);
+
+		if (n < 0)
+			return;
+		if ((size_t)n < out->size - out->len) {
+			out->len += n;
+			return;
+		}
+		out->size = MAX(out->size * 2, out->len + n + 1);
+		out->buf = XREALLOC(MTYPE_METRICS_TEXT, out->buf, out->size);
+	}
+}
+
+static void metrics_put(struct metrics_out *out, const char *text, size_t len)
+{
+	if (out->len + len >= out->size) {
+		out->size = MAX(out->size * 2, out->len + len + 1);
+		out->buf = XREALLOC(MTYPE_METRICS_TEXT, out->buf, out->size);
+	}
+	memcpy(out->buf + out->len, text, len);
+	out->len += len;
+	out->buf[out->len] = '\0';
+}
+
+static void metrics_escape(struct metrics_out *out, const char *value)
+{
+	const char *p;
+
+	for (p = value; *p; p++) {
+		switch (*p) {
+		case '\\':
+			metrics_put(out, "\\\\", 2);
+			break;
+		case '"':
+			metrics_put(out, "\\\"", 2);
+			break;
+		case '\n':
+			metrics_put(out, "\\n", 2);
+			break;
+		default:
+			metrics_put(out, p, 1);
+		}
+	}
+}
+
+void metrics_family(struct metrics_out *out, const char *name,
+		    enum metrics_type type, const char *help)
+{
+	static const char *const type_names[] = {
+		[METRICS_COUNTER] = "counter",
+		[METRICS_GAUGE] = "gauge",
+		[METRICS_HISTOGRAM] = "histogram",
+	};
+
+	metrics_printf(out, "# TYPE %s %s\n", name, type_names[type]);
+	if (help)
+		metrics_printf(out, "# HELP %s %s\n", name, help);
+}
+
+static void metrics_vsample(struct metrics_out *out, const char *name,
+			    uint64_t value, va_list ap)
+{
+	const char *label, *lvalue;
+	bool labels = false;
+
+	metrics_printf(out, "%s", name);
+	while ((label = va_arg(ap, const char *))) {
+		lvalue = va_arg(ap, const char *);
+		metrics_printf(out, "%c%s=\"", labels ? ',' : '{', label);
+		metrics_escape(out, lvalue ? lvalue : "");
+		metrics_put(out, "\"", 1);
+		labels = true;
+	}
+	metrics_printf(out, "%s %" PRIu64 "\n", labels ? "}" : "", value);
+}
+
+void metrics_sample(struct metrics_out *out, const char *name,
+		    uint64_t value, ...)
+{
+	va_list ap;
+
+	va_start(ap, value);
+	metrics_vsample(out, name, value, ap);
+	va_end(ap);
+}
+
+void metrics_log2_histogram(struct metrics_out *out, const char *name,
+			    const size_t *buckets, unsigned int nbuckets,
+			    const char *label, const char *value)
+{
+	char bname[128], cname[128], le[24];
+	uint64_t total = 0;
+
+	snprintf(bname, sizeof(bname), "%s_bucket", name);
+	snprintf(cname, sizeof(cname), "%s_count", name);
+
+	for (unsigned int i = 0; i < nbuckets; i++) {
+		total += buckets[i];
+		if (i == nbuckets - 1)
+			snprintf(le, sizeof(le), "+Inf");
+		else
+			snprintf(le, sizeof(le), "%llu", 2ULL << i);
+
+		if (label)
+			metrics_sample(out, bname, total, label, value, "le",
+				       le, NULL);
+		else
+			metrics_sample(out, bname, total, "le", le, NULL);
+	}
+
+	if (label)
+		metrics_sample(out, cname, total, label, value, NULL);
+	else
+		metrics_sample(out, cname, total, NULL);
+}
+
+static int64_t metrics_now_ms(void)
+{
+	struct timeval tv;
+
+	monotime(&tv);
+	return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static struct metrics_collector *metrics_collector_new(const char *name,
+						       metrics_collect_fn fn,
+						       void *arg)
+{
+	struct metrics_collector *mc;
+
+	mc = XCALLOC(MTYPE_METRICS_COLLECTOR, sizeof(*mc));
+	mc->name = XSTRDUP(MTYPE_METRICS_COLLECTOR, name);
+	mc->fn = fn;
+	mc->arg = arg;
+	return mc;
+}
+
+struct metrics_collector *metrics_collector_add(const char *name,
+						metrics_collect_fn fn,
+						void *arg)
+{
+	struct metrics_collector *mc = metrics_collector_new(name, fn, arg);
+
+	frr_with_mutex (&metrics_mtx) {
+		metrics_collectors_add_tail(&metrics_collectors, mc);
+	}
+	return mc;
+}
+
+/* runs on the snapshot's loop */
+static void metrics_snapshot_refresh(struct event *thread)
+{
+	struct metrics_collector *mc = EVENT_ARG(thread);
+	struct metrics_text *text, *old;
+	struct metrics_out out;
+
+	metrics_out_init(&out, 4096);
+	mc->fn(&out, mc->arg);
+
+	text = XMALLOC(MTYPE_METRICS_TEXT, sizeof(*text) + out.len + 1);
+	text->len = out.len;
+	memcpy(text->text, out.buf, out.len + 1);
+	XFREE(MTYPE_METRICS_TEXT, out.buf);
+
+	old = atomic_exchange_explicit(&mc->text, text, memory_order_acq_rel);
+	rcu_free(MTYPE_METRICS_TEXT, old, rcu);
+
+	atomic_store_explicit(&mc->refreshed_ms, metrics_now_ms(),
+			      memory_order_relaxed);
+}
+
+struct metrics_collector *metrics_snapshot_add(const char *name,
+					       struct event_loop *loop,
+					       unsigned int interval_ms,
+					       metrics_collect_fn fn, void *arg)
+{
+	struct metrics_collector *mc = metrics_collector_new(name, fn, arg);
+
+	mc->loop = loop;
+	mc->interval_ms = interval_ms;
+	atomic_store_explicit(&mc->refreshed_ms, INT64_MIN / 2,
+			      memory_order_relaxed);
+
+	frr_with_mutex (&metrics_mtx) {
+		metrics_collectors_add_tail(&metrics_collectors, mc);
+	}
+	return mc;
+}
+
+void metrics_collector_del(struct metrics_collector *mc)
+{
+	struct metrics_text *text;
+
+	frr_with_mutex (&metrics_mtx) {
+		metrics_collectors_del(&metrics_collectors, mc);
+	}
+
+	if (mc->loop) {
+		event_cancel(&mc->t_refresh);
+		text = atomic_exchange_explicit(&mc->text, NULL,
+						memory_order_acq_rel);
+		rcu_free(MTYPE_METRICS_TEXT, text, rcu);
+	}
+
+	XFREE(MTYPE_METRICS_COLLECTOR, mc->name);
+	XFREE(MTYPE_METRICS_COLLECTOR, mc);
+}
+
+struct metrics_mem_args {
+	struct metrics_out *out;
+	bool bytes;
+};
+
+static int metrics_mem_walk(void *arg, struct memgroup *mg, struct memtype *mt)
+{
+	struct metrics_mem_args *args = arg;
+	size_t val;
+
+	if (!mt)
+		return 0;
+
+	if (args->bytes) {
+#ifdef HAVE_MALLOC_USABLE_SIZE
+		val = atomic_load_explicit(&mt->total, memory_order_relaxed);
+#else
+		val = atomic_load_explicit(&mt->size, memory_order_relaxed);
+		if (val == SIZE_VAR)
+			return 0;
+		val *= atomic_load_explicit(&mt->n_alloc, memory_order_relaxed);
+#endif
+		metrics_sample(args->out, "frr_memory_bytes", val, "group",
+			       mg->name, "type", mt->name, NULL);
+	} else {
+		val = atomic_load_explicit(&mt->n_alloc, memory_order_relaxed);
+		metrics_sample(args->out, "frr_memory_allocations", val,
+			       "group", mg->name, "type", mt->name, NULL);
+	}
+	return 0;
+}
+
+static void metrics_builtin(struct metrics_out *out)
+{
+	struct metrics_mem_args args = { .out = out };
+
+	metrics_family(out, "frr_memory_allocations", METRICS_GAUGE,
+		       "Live allocations per memory type");
+	qmem_walk(metrics_mem_walk, &args);
+
+	args.bytes = true;
+	metrics_family(out, "frr_memory_bytes", METRICS_GAUGE,
+		       "Bytes allocated per memory type");
+	qmem_walk(metrics_mem_walk, &args);
+
+	event_loop_metrics(out);
+}
+
+char *metrics_render(size_t *len)
+{
+	struct metrics_collector *mc;
+	struct metrics_text *text;
+	struct metrics_out out;
+	int64_t now = metrics_now_ms();
+
+	metrics_out_init(&out, 65536);
+	metrics_builtin(&out);
+
+	frr_with_mutex (&metrics_mtx) {
+		frr_each (metrics_collectors, &metrics_collectors, mc) {
+			if (!mc->loop) {
+				mc->fn(&out, mc->arg);
+				continue;
+			}
+
+			text = atomic_load_explicit(&mc->text,
+						    memory_order_acquire);
+			if (text)
+				metrics_put(&out, text->text, text->len);
+
+			if (now - atomic_load_explicit(&mc->refreshed_ms,
+						       memory_order_relaxed) >=
+			    mc->interval_ms)
+				event_add_event(mc->loop,
+						metrics_snapshot_refresh, mc, 0,
+						&mc->t_refresh);
+		}
+	}
+
+	metrics_printf(&out, "# EOF\n");
+	*len = out.len;
+	return out.buf;
+}
+
+void metrics_text_free(char *text)
+{
+	XFREE(MTYPE_METRICS_TEXT, text);
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Statistics for export in the OpenMetrics text format
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * Daemons register collectors here; the metrics module serves them over
+ * HTTP from its own pthread.  Nothing is rendered unless that module is
+ * loaded and scraped.
+ *
+ * There are two kinds of collectors:
+ *
+ * - plain collectors run on the exporter pthread for every scrape.  They
+ *   must only read data that is safe to access from there, i.e. atomics or
+ *   structures protected by their own lock.
+ *
+ * - snapshots are rendered on the pthread owning the data (normally the
+ *   main pthread) and published with RCU.  A scrape serves the last one and
+ *   asks the owner for a new one if it is older than the snapshot's
+ *   interval, so the owner does at most one rendering per interval, however
+ *   often the exporter gets scraped.
+ */
+
+#ifndef _FRR_METRICS_H
+#define _FRR_METRICS_H
+
+#include <stdint.h>
+
+#include "frrevent.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum metrics_type {
+	METRICS_COUNTER,
+	METRICS_GAUGE,
+	METRICS_HISTOGRAM,
+};
+
+/* rendered OpenMetrics text */
+struct metrics_out;
+
+typedef void (*metrics_collect_fn)(struct metrics_out *out, void *arg);
+
+/*
+ * Start a metric family.  name is the family name without suffixes, i.e.
+ * "frr_bgp_peer_state" or "frr_event_timer_lag_usec".
+ */
+extern void metrics_family(struct metrics_out *out, const char *name,
+			   enum metrics_type type, const char *help);
+
+/*
+ * Add a sample, followed by NULL terminated pairs of label names and
+ * values. name includes any suffix such as _total or _bucket.  Label values
+ * are escaped as needed.
+ *
+ *   metrics_sample(out, "frr_bgp_peer_state", 6, "peer", peer->host, NULL);
+ */
+extern void metrics_sample(struct metrics_out *out, const char *name,
+			   uint64_t value, ...);
+
+/*
+ * Add the _bucket and _count samples of a histogram with log2 buckets:
+ * [0, 2), [2, 4), ... and everything from 2^(nbuckets - 1) on in the last
+ * one.  label and value may be NULL for a histogram without labels.
+ */
+extern void metrics_log2_histogram(struct metrics_out *out, const char *name,
+				   const size_t *buckets, unsigned int nbuckets,
+				   const char *label, const char *value);
+
+struct metrics_collector;
+
+/* fn runs on the exporter pthread */
+extern struct metrics_collector *metrics_collector_add(const char *name,
+						       metrics_collect_fn fn,
+						       void *arg);
+extern void metrics_collector_del(struct metrics_collector *mc);
+
+/*
+ * fn runs as an event on loop, at most once per interval_ms, and only
+ * while somebody scrapes the exporter.  Must be added and deleted from the
+ * pthread running loop.
+ */
+extern struct metrics_collector *
+metrics_snapshot_add(const char *name, struct event_loop *loop,
+		     unsigned int interval_ms, metrics_collect_fn fn,
+		     void *arg);
+
+/*
+ * Render all collectors into a newly allocated, NUL terminated buffer, to
+ * be released with metrics_text_free().  Called by the exporter.
+ */
+extern char *metrics_render(size_t *len);
+extern void metrics_text_free(char *text);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_METRICS_H */
@@ -0,0 +1,397 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * OpenMetrics exporter: serves the registered metrics over HTTP
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * Load with -M metrics[:[ADDRESS:]PORT].  Requests are handled on a
+ * pthread of their own, so scraping doesn't go through the CLI and doesn't
+ * take the main pthread; see lib/metrics.h for how the data is collected.
+ */
+
+#include <zebra.h>
+
+#include <netdb.h>
+
+#include "frr_pthread.h"
+#include "libfrr.h"
+#include "memory.h"
+#include "metrics.h"
+#include "module.h"
+#include "monotime.h"
+#include "network.h"
+#include "sockopt.h"
+#include "typesafe.h"
+#include "version.h"
+
+DEFINE_MTYPE_STATIC(LIB, METRICS_CONN, "Metrics HTTP connection");
+
+#define METRICS_DEFAULT_ADDR "127.0.0.1"
+#define METRICS_DEFAULT_PORT "9342"
+
+/* nobody needs more than a few scrapers, don't let them pile up */
+#define METRICS_MAX_CONNS 16
+#define METRICS_REQ_MAX 4096
+#define METRICS_TIMEOUT 10
+
+PREDECL_DLIST(metrics_conns);
+
+struct metrics_conn {
+	struct metrics_conns_item item;
+
+	int fd;
+	char req[METRICS_REQ_MAX];
+	size_t req_len;
+
+	char *resp;
+	size_t resp_len;
+	size_t resp_off;
+
+	struct event *t_read;
+	struct event *t_write;
+	struct event *t_timeout;
+};
+
+DECLARE_DLIST(metrics_conns, struct metrics_conn, item);
+
+static struct frr_pthread *metrics_pth;
+static struct metrics_conns_head metrics_conns;
+static struct event *t_accept;
+static int metrics_sock = -1;
+static struct metrics_collector *metrics_self;
+
+static _Atomic uint64_t metrics_scrapes;
+static _Atomic uint64_t metrics_render_usec;
+
+static void metrics_conn_read(struct event *thread);
+static void metrics_conn_write(struct event *thread);
+
+static void metrics_conn_free(struct metrics_conn *conn)
+{
+	metrics_conns_del(&metrics_conns, conn);
+	event_cancel(&conn->t_read);
+	event_cancel(&conn->t_write);
+	event_cancel(&conn->t_timeout);
+	close(conn->fd);
+	XFREE(MTYPE_METRICS_CONN, conn->resp);
+	XFREE(MTYPE_METRICS_CONN, conn);
+}
+
+static void metrics_conn_timeout(struct event *thread)
+{
+	metrics_conn_free(EVENT_ARG(thread));
+}
+
+static void metrics_conn_respond(struct metrics_conn *conn, const char *status,
+				 const char *type, const char *body,
+				 size_t body_len)
+{
+	char hdr[256];
+	int hdr_len;
+
+	hdr_len = snprintf(hdr, sizeof(hdr),
+			   "HTTP/1.1 %s\r\n"
+			   "Content-Type: %s\r\n"
+			   "Content-Length: %zu\r\n"
+			   "Connection: close\r\n\r\n",
+			   status, type, body_len);
+
+	conn->resp = XMALLOC(MTYPE_METRICS_CONN, hdr_len + body_len);
+	memcpy(conn->resp, hdr, hdr_len);
+	memcpy(conn->resp + hdr_len, body, body_len);
+	conn->resp_len = hdr_len + body_len;
+	conn->resp_off = 0;
+
+	event_add_write(metrics_pth->master, metrics_conn_write, conn,
+			conn->fd, &conn->t_write);
+}
+
+static void metrics_conn_request(struct metrics_conn *conn)
+{
+	static const char openmetrics[] =
+		"application/openmetrics-text; version=1.0.0; charset=utf-8";
+	static const char prometheus[] = "text/plain; version=0.0.4";
+	char *body, *line_end, *path, *sp;
+	struct timeval start;
+	size_t len;
+
+	line_end = strpbrk(conn->req, "\r\n");
+	if (line_end)
+		*line_end = '\0';
+
+	if (strncmp(conn->req, "GET ", 4)) {
+		metrics_conn_respond(conn, "405 Method Not Allowed",
+				     "text/plain", "", 0);
+		return;
+	}
+
+	path = conn->req + 4;
+	sp = strchr(path, ' ');
+	if (sp)
+		*sp = '\0';
+	if (strcmp(path, "/metrics") && strcmp(path, "/")) {
+		metrics_conn_respond(conn, "404 Not Found", "text/plain", "",
+				     0);
+		return;
+	}
+
+	monotime(&start);
+	body = metrics_render(&len);
+	atomic_store_explicit(&metrics_render_usec,
+			      monotime_since(&start, NULL),
+			      memory_order_relaxed);
+	atomic_fetch_add_explicit(&metrics_scrapes, 1, memory_order_relaxed);
+
+	/* the headers are after the request line we just cut off */
+	metrics_conn_respond(conn, "200 OK",
+			     line_end && strstr(line_end + 1,
+						"application/openmetrics-text")
+				     ? openmetrics
+				     : prometheus,
+			     body, len);
+	metrics_text_free(body);
+}
+
+static void metrics_conn_read(struct event *thread)
+{
+	struct metrics_conn *conn = EVENT_ARG(thread);
+	ssize_t nb;
+
+	nb = read(conn->fd, conn->req + conn->req_len,
+		  sizeof(conn->req) - conn->req_len - 1);
+	if (nb < 0 && ERRNO_IO_RETRY(errno)) {
+		event_add_read(metrics_pth->master, metrics_conn_read, conn,
+			       conn->fd, &conn->t_read);
+		return;
+	}
+	if (nb <= 0) {
+		metrics_conn_free(conn);
+		return;
+	}
+
+	conn->req_len += nb;
+	conn->req[conn->req_len] = '\0';
+
+	if (strstr(conn->req, "\r\n\r\n") || strstr(conn->req, "\n\n")) {
+		metrics_conn_request(conn);
+		return;
+	}
+	if (conn->req_len == sizeof(conn->req) - 1) {
+		metrics_conn_respond(conn, "431 Request Header Fields Too Large",
+				     "text/plain", "", 0);
+		return;
+	}
+
+	event_add_read(metrics_pth->master, metrics_conn_read, conn, conn->fd,
+		       &conn->t_read);
+}
+
+static void metrics_conn_write(struct event *thread)
+{
+	struct metrics_conn *conn = EVENT_ARG(thread);
+	ssize_t nb;
+
+	nb = write(conn->fd, conn->resp + conn->resp_off,
+		   conn->resp_len - conn->resp_off);
+	if (nb < 0 && !ERRNO_IO_RETRY(errno)) {
+		metrics_conn_free(conn);
+		return;
+	}
+	if (nb > 0)
+		conn->resp_off += nb;
+
+	if (conn->resp_off < conn->resp_len) {
+		event_add_write(metrics_pth->master, metrics_conn_write, conn,
+				conn->fd, &conn->t_write);
+		return;
+	}
+
+	metrics_conn_free(conn);
+}
+
+static void metrics_accept(struct event *thread)
+{
+	struct metrics_conn *conn;
+	int fd;
+
+	event_add_read(metrics_pth->master, metrics_accept, NULL, metrics_sock,
+		       &t_accept);
+
+	fd = accept(metrics_sock, NULL, NULL);
+	if (fd < 0)
+		return;
+
+	if (metrics_conns_count(&metrics_conns) >= METRICS_MAX_CONNS) {
+		close(fd);
+		return;
+	}
+
+	set_nonblocking(fd);
+	set_cloexec(fd);
+
+	conn = XCALLOC(MTYPE_METRICS_CONN, sizeof(*conn));
+	conn->fd = fd;
+	metrics_conns_add_tail(&metrics_conns, conn);
+
+	event_add_read(metrics_pth->master, metrics_conn_read, conn, fd,
+		       &conn->t_read);
+	event_add_timer(metrics_pth->master, metrics_conn_timeout, conn,
+			METRICS_TIMEOUT, &conn->t_timeout);
+}
+
+static void metrics_self_collect(struct metrics_out *out, void *arg)
+{
+	metrics_family(out, "frr_metrics_scrapes", METRICS_COUNTER,
+		       "Scrapes served by this exporter");
+	metrics_sample(out, "frr_metrics_scrapes_total",
+		       atomic_load_explicit(&metrics_scrapes,
+					    memory_order_relaxed),
+		       NULL);
+	metrics_family(out, "frr_metrics_render_usec", METRICS_GAUGE,
+		       "Time the previous scrape took to render");
+	metrics_sample(out, "frr_metrics_render_usec",
+		       atomic_load_explicit(&metrics_render_usec,
+					    memory_order_relaxed),
+		       NULL);
+}
+
+static int metrics_listen(const char *args)
+{
+	struct addrinfo hints = {
+		.ai_family = AF_UNSPEC,
+		.ai_socktype = SOCK_STREAM,
+		.ai_flags = AI_PASSIVE | AI_NUMERICHOST | AI_NUMERICSERV,
+	};
+	struct addrinfo *res;
+	char buf[256];
+	const char *addr = NULL, *port;
+	char *host, *colon;
+	int sock, ret;
+
+	strlcpy(buf, args ? args : "", sizeof(buf));
+	colon = strrchr(buf, ':');
+	if (colon) {
+		*colon = '\0';
+		host = buf;
+		port = colon + 1;
+		/* [2001:db8::1]:9342 */
+		if (host[0] == '[' && host[strlen(host) - 1] == ']') {
+			host[strlen(host) - 1] = '\0';
+			host++;
+		}
+		addr = host;
+	} else
+		port = buf;
+
+	if (!addr || !*addr)
+		addr = METRICS_DEFAULT_ADDR;
+	if (!*port)
+		port = METRICS_DEFAULT_PORT;
+
+	ret = getaddrinfo(addr, port, &hints, &res);
+	if (ret) {
+		zlog_err("metrics: invalid listen address %s port %s: %s",
+			 addr, port, gai_strerror(ret));
+		return -1;
+	}
+
+	sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+	if (sock < 0) {
+		zlog_err("metrics: socket: %s", safe_strerror(errno));
+		freeaddrinfo(res);
+		return -1;
+	}
+
+	sockopt_reuseaddr(sock);
+	set_nonblocking(sock);
+	set_cloexec(sock);
+
+	if (bind(sock, res->ai_addr, res->ai_addrlen) < 0 ||
+	    listen(sock, METRICS_MAX_CONNS) < 0) {
+		zlog_err("metrics: can't listen on %s port %s: %s", addr, port,
+			 safe_strerror(errno));
+		close(sock);
+		freeaddrinfo(res);
+		return -1;
+	}
+
+	freeaddrinfo(res);
+	zlog_info("metrics: exporter listening on %s port %s", addr, port);
+	return sock;
+}
+
+static int metrics_finish(void)
+{
+	struct metrics_conn *conn;
+
+	if (!metrics_pth)
+		return 0;
+
+	frr_pthread_stop(metrics_pth, NULL);
+
+	/* the pthread is gone, its pending events go with its loop */
+	while ((conn = metrics_conns_pop(&metrics_conns))) {
+		close(conn->fd);
+		XFREE(MTYPE_METRICS_CONN, conn->resp);
+		XFREE(MTYPE_METRICS_CONN, conn);
+	}
+	metrics_conns_fini(&metrics_conns);
+
+	close(metrics_sock);
+	metrics_sock = -1;
+
+	metrics_collector_del(metrics_self);
+	metrics_self = NULL;
+
+	frr_pthread_destroy(metrics_pth);
+	metrics_pth = NULL;
+	return 0;
+}
+
+/*
+ * Like the gRPC module, the pthread is only started once the event loop
+ * runs, i.e. after the daemon has forked.
+ */
+static void metrics_very_late_init(struct event *thread)
+{
+	metrics_sock = metrics_listen(THIS_MODULE->load_args);
+	if (metrics_sock < 0) {
+		zlog_err("metrics: failed to start the exporter");
+		return;
+	}
+
+	metrics_conns_init(&metrics_conns);
+	metrics_self = metrics_collector_add("metrics", metrics_self_collect,
+					     NULL);
+
+	metrics_pth = frr_pthread_new(NULL, "metrics exporter", "metrics");
+	if (frr_pthread_run(metrics_pth, NULL) < 0) {
+		zlog_err("metrics: can't create pthread: %s",
+			 safe_strerror(errno));
+		frr_pthread_destroy(metrics_pth);
+		metrics_pth = NULL;
+		metrics_collector_del(metrics_self);
+		close(metrics_sock);
+		metrics_sock = -1;
+		return;
+	}
+
+	event_add_read(metrics_pth->master, metrics_accept, NULL, metrics_sock,
+		       &t_accept);
+}
+
+static int metrics_late_init(struct event_loop *tm)
+{
+	hook_register(frr_fini, metrics_finish);
+	event_add_event(tm, metrics_very_late_init, NULL, 0, NULL);
+	return 0;
+}
+
+static int metrics_module_init(void)
+{
+	hook_register(frr_late_init, metrics_late_init);
+	return 0;
+}
+
+FRR_MODULE_SETUP(.name = "metrics", .version = FRR_VERSION,
+		 .description = "OpenMetrics statistics exporter",
+		 .init = metrics_module_init);
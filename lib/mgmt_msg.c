@@ -11,8 +11,12 @@
 #include "sockopt.h"
 #include "stream.h"
 #include "frrevent.h"
+#include "monotime.h"
 #include "mgmt_msg.h"
 
+/* Streams written out with a single writev() */
+#define MGMT_MSG_WRITE_IOVS 32
+
 
 #define MGMT_MSG_DBG(dbgtag, fmt, ...)                                         \
 	do {                                                                   \
@@ -134,8 +138,10 @@ bool mgmt_msg_procbufs(struct mgmt_msg_state *ms,
 	const char *dbgtag = debug ? ms->idtag : NULL;
 	struct mgmt_msg_hdr *mhdr;
 	struct stream *work;
+	struct timeval start;
 	uint8_t *data;
 	size_t left, nproc;
+	int64_t usec;
 
 	MGMT_MSG_DBG(dbgtag, "Have %zu streams to process", ms->inq.count);
 
@@ -156,8 +162,13 @@ bool mgmt_msg_procbufs(struct mgmt_msg_state *ms,
 			assert(mhdr->marker == MGMT_MSG_MARKER);
 			assert(left >= mhdr->len);
 
+			monotime(&start);
 			handle_msg(user, (uint8_t *)(mhdr + 1),
 				   mhdr->len - sizeof(struct mgmt_msg_hdr));
+			usec = monotime_since(&start, NULL);
+			ms->rx_proc_usec += usec;
+			if ((uint64_t)usec > ms->rx_proc_max_usec)
+				ms->rx_proc_max_usec = usec;
 			ms->nrxm++;
 			nproc++;
 		}
@@ -174,7 +185,8 @@ bool mgmt_msg_procbufs(struct mgmt_msg_state *ms,
 
 /**
  * Write data from a onto the socket, using streams that have been queued for
- * sending by mgmt_msg_send_msg. This function should be reschedulable.
+ * sending by mgmt_msg_send_msg. Up to MGMT_MSG_WRITE_IOVS streams are written
+ * with each system call. This function should be reschedulable.
  *
  * Args:
  *	ms: mgmt_msg_state for this process.
@@ -193,10 +205,13 @@ enum mgmt_msg_wsched mgmt_msg_write(struct mgmt_msg_state *ms, int fd,
 				    bool debug)
 {
 	const char *dbgtag = debug ? ms->idtag : NULL;
+	struct iovec iov[MGMT_MSG_WRITE_IOVS];
 	struct stream *s;
 	size_t nproc = 0;
+	int64_t usec;
 	ssize_t left;
 	ssize_t n;
+	int niov;
 
 	if (ms->outs) {
 		MGMT_MSG_DBG(dbgtag,
@@ -208,10 +223,18 @@ enum mgmt_msg_wsched mgmt_msg_write(struct mgmt_msg_state *ms, int fd,
 
 	for (s = stream_fifo_head(&ms->outq); s && nproc < ms->max_write_buf;
 	     s = stream_fifo_head(&ms->outq)) {
-		left = STREAM_READABLE(s);
-		assert(left);
+		left = 0;
+		for (niov = 0; s && niov < MGMT_MSG_WRITE_IOVS &&
+			       nproc + niov < ms->max_write_buf;
+		     s = s->next, niov++) {
+			iov[niov].iov_base = STREAM_DATA(s) +
+					     stream_get_getp(s);
+			iov[niov].iov_len = STREAM_READABLE(s);
+			assert(iov[niov].iov_len);
+			left += iov[niov].iov_len;
+		}
 
-		n = stream_flush(s, fd);
+		n = writev(fd, iov, niov);
 		if (n <= 0) {
 			if (n == 0)
 				MGMT_MSG_ERR(ms,
@@ -235,16 +258,24 @@ enum mgmt_msg_wsched mgmt_msg_write(struct mgmt_msg_state *ms, int fd,
 		}
 
 		ms->ntxb += n;
-		if (n != left) {
-			MGMT_MSG_DBG(dbgtag, "short stream write %zd of %zd", n,
-				     left);
-			stream_forward_getp(s, n);
-			return MSW_SCHED_STREAM;
+		ms->nwrites++;
+		MGMT_MSG_DBG(dbgtag, "wrote %zd bytes from %d streams", n,
+			     niov);
+
+		/* free the streams that went out, advance a partial one */
+		while (n) {
+			s = stream_fifo_head(&ms->outq);
+			if (n < (ssize_t)STREAM_READABLE(s)) {
+				MGMT_MSG_DBG(dbgtag,
+					     "short stream write, %zd left",
+					     STREAM_READABLE(s) - n);
+				stream_forward_getp(s, n);
+				return MSW_SCHED_STREAM;
+			}
+			n -= STREAM_READABLE(s);
+			stream_free(stream_fifo_pop(&ms->outq));
+			nproc++;
 		}
-
-		stream_free(stream_fifo_pop(&ms->outq));
-		MGMT_MSG_DBG(dbgtag, "wrote stream of %zd bytes", n);
-		nproc++;
 	}
 	if (s) {
 		MGMT_MSG_DBG(
@@ -253,6 +284,17 @@ enum mgmt_msg_wsched mgmt_msg_write(struct mgmt_msg_state *ms, int fd,
 			ms->max_write_buf, ms->outq.count);
 		return MSW_SCHED_WRITES_OFF;
 	}
+
+	/* how long the oldest message waited to be written */
+	if (timerisset(&ms->tx_queued)) {
+		usec = monotime_since(&ms->tx_queued, NULL);
+		ms->tx_wait_usec += usec;
+		if ((uint64_t)usec > ms->tx_wait_max_usec)
+			ms->tx_wait_max_usec = usec;
+		ms->ntx_waits++;
+		timerclear(&ms->tx_queued);
+	}
+
 	MGMT_MSG_DBG(dbgtag, "flushed all streams from output q");
 	return MSW_SCHED_NONE;
 }
@@ -306,6 +348,9 @@ int mgmt_msg_send_msg(struct mgmt_msg_state *ms, void *msg, size_t len,
 	}
 	s = ms->outs;
 
+	if (!timerisset(&ms->tx_queued))
+		monotime(&ms->tx_queued);
+
 	/* We have a stream with space, pack the message into it. */
 	mhdr = (struct mgmt_msg_hdr *)(STREAM_DATA(s) + s->endp);
 	mhdr->marker = MGMT_MSG_MARKER;
@@ -388,6 +433,7 @@ size_t mgmt_msg_reset_writes(struct mgmt_msg_state *ms)
 	for (s = stream_fifo_pop(&ms->outq); s;
 	     s = stream_fifo_pop(&ms->outq), nproc++)
 		stream_free(s);
+	timerclear(&ms->tx_queued);
 
 	return nproc;
 }
@@ -403,6 +449,7 @@ void mgmt_msg_init(struct mgmt_msg_state *ms, size_t max_read_buf,
 	ms->max_write_buf = max_read_buf;
 	ms->max_msg_sz = max_msg_sz;
 	ms->idtag = strdup(idtag);
+	monotime(&ms->start);
 }
 
 void mgmt_msg_destroy(struct mgmt_msg_state *ms)
@@ -21,6 +21,20 @@ struct mgmt_msg_state {
 	uint64_t nrxb;		/* number of received bytes */
 	uint64_t ntxm;		/* number of sent messages */
 	uint64_t ntxb;		/* number of sent bytes */
+	uint64_t nwrites;	/* number of socket writes */
+	struct timeval start;	/* when the counters started */
+
+	/* handling time of received messages */
+	uint64_t rx_proc_usec;
+	uint64_t rx_proc_max_usec;
+	/*
+	 * Time from a message being queued with nothing else pending until
+	 * all output is written, i.e. the longest any message waited.
+	 */
+	struct timeval tx_queued;
+	uint64_t tx_wait_usec;
+	uint64_t tx_wait_max_usec;
+	uint64_t ntx_waits;
 	size_t max_read_buf;	/* should replace with max time value */
 	size_t max_write_buf;	/* should replace with max time value */
 	size_t max_msg_sz;
@@ -472,6 +472,25 @@ uint32_t nexthop_group_hash(const struct nexthop_group *nhg)
 	return key;
 }
 
+uint64_t nexthop_group_fingerprint(const struct nexthop_group *nhg)
+{
+	struct nexthop *nh;
+	uint32_t key = 0;
+	uint32_t top = 0x3c6ef372;
+
+	for (ALL_NEXTHOPS_PTR(nhg, nh)) {
+		key = jhash_1word(nexthop_hash(nh), key);
+
+		/* Resolved nexthops are not part of a group's identity */
+		if (nh->rparent)
+			continue;
+
+		top = jhash_3words(nh->type, nh->vrf_id, nh->weight, top);
+	}
+
+	return ((uint64_t)key << 32) | top;
+}
+
 void nexthop_group_mark_duplicates(struct nexthop_group *nhg)
 {
 	struct nexthop *nexthop, *prev;
@@ -53,6 +53,14 @@ void copy_nexthops(struct nexthop **tnh, const struct nexthop *nh,
 
 uint32_t nexthop_group_hash_no_recurse(const struct nexthop_group *nhg);
 uint32_t nexthop_group_hash(const struct nexthop_group *nhg);
+
+/*
+ * 64-bit fingerprint of a group, in one walk: the upper half is
+ * nexthop_group_hash(), the lower half only covers fields of the top-level
+ * nexthops that nexthop_same() compares. Groups whose lower halves differ
+ * can never be the same.
+ */
+uint64_t nexthop_group_fingerprint(const struct nexthop_group *nhg);
 void nexthop_group_mark_duplicates(struct nexthop_group *nhg);
 
 /* Add a nexthop to a list, enforcing the canonical sort order. */
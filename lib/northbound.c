@@ -22,6 +22,7 @@
 DEFINE_MTYPE_STATIC(LIB, NB_NODE, "Northbound Node");
 DEFINE_MTYPE_STATIC(LIB, NB_CONFIG, "Northbound Configuration");
 DEFINE_MTYPE_STATIC(LIB, NB_CONFIG_ENTRY, "Northbound Configuration Entry");
+DEFINE_MTYPE_STATIC(LIB, NB_CONFIG_EDIT, "Northbound Configuration Edit");
 
 /* Running configuration - shouldn't be modified directly. */
 struct nb_config *running_config;
@@ -70,12 +71,14 @@ static int nb_transaction_process(enum nb_event event,
 				  char *errmsg, size_t errmsg_len);
 static void nb_transaction_apply_finish(struct nb_transaction *transaction,
 					char *errmsg, size_t errmsg_len);
+struct nb_oper_walk;
 static int nb_oper_data_iter_node(const struct lysc_node *snode,
 				  const char *xpath, const void *list_entry,
 				  const struct yang_list_keys *list_keys,
 				  struct yang_translator *translator,
 				  bool first, uint32_t flags,
-				  nb_oper_data_cb cb, void *arg);
+				  nb_oper_data_cb cb, void *arg,
+				  struct nb_oper_walk *walk);
 
 static int nb_node_check_config_only(const struct lysc_node *snode, void *arg)
 {
@@ -294,6 +297,101 @@ static int nb_node_validate(const struct lysc_node *snode, void *arg)
 	return YANG_ITER_CONTINUE;
 }
 
+struct nb_config_edit {
+	struct nb_config_edits_item item;
+	char *xpath;
+};
+
+static int nb_config_edit_cmp(const struct nb_config_edit *a,
+			      const struct nb_config_edit *b)
+{
+	return strcmp(a->xpath, b->xpath);
+}
+
+static uint32_t nb_config_edit_hash(const struct nb_config_edit *edit)
+{
+	return string_hash_make(edit->xpath);
+}
+
+DECLARE_HASH(nb_config_edits, struct nb_config_edit, item, nb_config_edit_cmp,
+	     nb_config_edit_hash);
+
+static void nb_config_edits_reset(struct nb_config *config, bool valid)
+{
+	struct nb_config_edit *edit;
+
+	while ((edit = nb_config_edits_pop(&config->edits))) {
+		XFREE(MTYPE_NB_CONFIG_EDIT, edit->xpath);
+		XFREE(MTYPE_NB_CONFIG_EDIT, edit);
+	}
+	config->edits_valid = valid;
+}
+
+static void nb_config_edits_record(struct nb_config *config, const char *xpath)
+{
+	struct nb_config_edit *edit, ref;
+
+	if (!config->edits_valid)
+		return;
+
+	ref.xpath = (char *)xpath;
+	if (nb_config_edits_find(&config->edits, &ref))
+		return;
+
+	if (nb_config_edits_count(&config->edits) >= NB_CONFIG_EDITS_MAX) {
+		nb_config_edits_reset(config, false);
+		return;
+	}
+
+	edit = XCALLOC(MTYPE_NB_CONFIG_EDIT, sizeof(*edit));
+	edit->xpath = XSTRDUP(MTYPE_NB_CONFIG_EDIT, xpath);
+	nb_config_edits_add(&config->edits, edit);
+}
+
+static void nb_config_edits_record_dnode(struct nb_config *config,
+					 const struct lyd_node *dnode)
+{
+	char *xpath;
+
+	if (!config->edits_valid)
+		return;
+
+	xpath = lyd_path(dnode, LYD_PATH_STD, NULL, 0);
+	if (!xpath) {
+		nb_config_edits_reset(config, false);
+		return;
+	}
+	nb_config_edits_record(config, xpath);
+	free(xpath);
+}
+
+static int nb_lyd_diff_get_op(const struct lyd_node *dnode);
+
+/* Record everything a libyang diff (e.g. from validation) touched. */
+static void nb_config_edits_record_diff(struct nb_config *config,
+					const struct lyd_node *diff)
+{
+	const struct lyd_node *root, *dnode;
+
+	LY_LIST_FOR (diff, root) {
+		LYD_TREE_DFS_BEGIN (root, dnode) {
+			switch (nb_lyd_diff_get_op(dnode)) {
+			case 'c':
+			case 'd':
+				nb_config_edits_record_dnode(config, dnode);
+				LYD_TREE_DFS_continue = 1;
+				break;
+			case 'r':
+				nb_config_edits_record_dnode(config, dnode);
+				break;
+			default:
+				break;
+			}
+			LYD_TREE_DFS_END(root, dnode);
+		}
+	}
+}
+
 struct nb_config *nb_config_new(struct lyd_node *dnode)
 {
 	struct nb_config *config;
@@ -306,6 +404,7 @@ struct nb_config *nb_config_new(struct lyd_node *dnode)
 	config->version = 0;
 
 	RB_INIT(nb_config_cbs, &config->cfg_chgs);
+	nb_config_edits_init(&config->edits);
 
 	return config;
 }
@@ -315,6 +414,8 @@ void nb_config_free(struct nb_config *config)
 	if (config->dnode)
 		yang_dnode_free(config->dnode);
 	nb_config_diff_del_changes(&config->cfg_chgs);
+	nb_config_edits_reset(config, false);
+	nb_config_edits_fini(&config->edits);
 	XFREE(MTYPE_NB_CONFIG, config);
 }
 
@@ -327,6 +428,8 @@ struct nb_config *nb_config_dup(const struct nb_config *config)
 	dup->version = config->version;
 
 	RB_INIT(nb_config_cbs, &dup->cfg_chgs);
+	nb_config_edits_init(&dup->edits);
+	dup->edits_valid = (config == running_config);
 
 	return dup;
 }
@@ -339,6 +442,7 @@ int nb_config_merge(struct nb_config *config_dst, struct nb_config *config_src,
 	ret = lyd_merge_siblings(&config_dst->dnode, config_src->dnode, 0);
 	if (ret != 0)
 		flog_warn(EC_LIB_LIBYANG, "%s: lyd_merge() failed", __func__);
+	nb_config_edits_reset(config_dst, false);
 
 	if (!preserve_source)
 		nb_config_free(config_src);
@@ -353,6 +457,9 @@ void nb_config_replace(struct nb_config *config_dst,
 	if (config_src->version != 0)
 		config_dst->version = config_src->version;
 
+	if (config_dst != running_config)
+		nb_config_edits_reset(config_dst, config_src == running_config);
+
 	/* Update dnode. */
 	if (config_dst->dnode)
 		yang_dnode_free(config_dst->dnode);
@@ -365,6 +472,171 @@ void nb_config_replace(struct nb_config *config_dst,
 	}
 }
 
+static int nb_config_dnode_cmp(const void *a, const void *b)
+{
+	const struct lyd_node *const *na = a, *const *nb = b;
+
+	if (*na < *nb)
+		return -1;
+	return *na > *nb;
+}
+
+static bool nb_config_dnodes_has_parent(const struct lyd_node **dnodes,
+					size_t count,
+					const struct lyd_node *dnode)
+{
+	const struct lyd_node *parent;
+
+	for (parent = lyd_parent(dnode); parent; parent = lyd_parent(parent))
+		if (bsearch(&parent, dnodes, count, sizeof(dnodes[0]),
+			    nb_config_dnode_cmp))
+			return true;
+	return false;
+}
+
+/*
+ * The edits whose node, in either data tree, isn't below the node of
+ * another edit, nor missing from both.  Diffing or copying just these
+ * covers all of them.  Returns their number; *rootsp is to be freed by the
+ * caller.
+ */
+static size_t nb_config_edits_roots(const struct lyd_node *dnode1,
+				    const struct lyd_node *dnode2,
+				    const struct nb_config_edits_head *edits,
+				    const struct nb_config_edit ***rootsp)
+{
+	size_t count = nb_config_edits_count(edits);
+	const struct lyd_node **old, **new, **dnodes;
+	const struct nb_config_edit **all, **roots;
+	const struct nb_config_edit *edit;
+	size_t i = 0, nroots = 0, ndnodes = 0;
+
+	*rootsp = NULL;
+	if (!count)
+		return 0;
+
+	all = XCALLOC(MTYPE_TMP, count * sizeof(*all));
+	old = XCALLOC(MTYPE_TMP, count * sizeof(*old));
+	new = XCALLOC(MTYPE_TMP, count * sizeof(*new));
+	dnodes = XCALLOC(MTYPE_TMP, 2 * count * sizeof(*dnodes));
+
+	frr_each (nb_config_edits_const, edits, edit) {
+		all[i] = edit;
+		old[i] = yang_dnode_get(dnode1, edit->xpath);
+		new[i] = yang_dnode_get(dnode2, edit->xpath);
+		if (old[i])
+			dnodes[ndnodes++] = old[i];
+		if (new[i])
+			dnodes[ndnodes++] = new[i];
+		i++;
+	}
+	qsort(dnodes, ndnodes, sizeof(dnodes[0]), nb_config_dnode_cmp);
+
+	roots = XCALLOC(MTYPE_TMP, count * sizeof(*roots));
+	for (i = 0; i < count; i++) {
+		if (!old[i] && !new[i])
+			continue;
+
+		/* covered by an edited parent */
+		if ((old[i] &&
+		     nb_config_dnodes_has_parent(dnodes, ndnodes, old[i])) ||
+		    (new[i] &&
+		     nb_config_dnodes_has_parent(dnodes, ndnodes, new[i])))
+			continue;
+
+		roots[nroots++] = all[i];
+	}
+
+	XFREE(MTYPE_TMP, dnodes);
+	XFREE(MTYPE_TMP, new);
+	XFREE(MTYPE_TMP, old);
+	XFREE(MTYPE_TMP, all);
+
+	*rootsp = roots;
+	return nroots;
+}
+
+/* Make the subtree at xpath in 'dst' (or its absence) the same as in 'src' */
+static bool nb_config_copy_subtree(struct nb_config *dst,
+				   const struct nb_config *src,
+				   const char *xpath)
+{
+	struct lyd_node *dnode, *parent = NULL, *dup;
+	const struct lyd_node *snode;
+	char *parent_xpath;
+
+	dnode = yang_dnode_get(dst->dnode, xpath);
+	if (dnode) {
+		/* keep pointing at the data tree */
+		if (dnode == dst->dnode)
+			dst->dnode = dnode->next ? dnode->next
+				     : dnode->prev != dnode ? dnode->prev
+							    : NULL;
+		lyd_free_tree(dnode);
+	}
+
+	snode = yang_dnode_get(src->dnode, xpath);
+	if (!snode)
+		return true;
+
+	if (lyd_parent(snode)) {
+		parent_xpath = lyd_path(lyd_parent(snode), LYD_PATH_STD, NULL,
+					0);
+		if (!parent_xpath)
+			return false;
+		parent = yang_dnode_get(dst->dnode, parent_xpath);
+		free(parent_xpath);
+		/* an edited parent would have been copied instead */
+		if (!parent)
+			return false;
+	}
+
+	if (lyd_dup_single(snode, (struct lyd_node_inner *)parent,
+			   LYD_DUP_RECURSIVE | LYD_DUP_WITH_FLAGS, &dup))
+		return false;
+	if (!parent &&
+	    lyd_insert_sibling(dst->dnode, dup, &dst->dnode) != LY_SUCCESS) {
+		lyd_free_tree(dup);
+		return false;
+	}
+
+	return true;
+}
+
+void nb_config_replace_edits(struct nb_config *config_dst,
+			     struct nb_config *config_src)
+{
+	const struct nb_config_edit **roots;
+	struct nb_config *candidate = NULL;
+	bool copied = false;
+	size_t count, i;
+
+	if (config_dst == running_config)
+		candidate = config_src;
+	else if (config_src == running_config)
+		candidate = config_dst;
+
+	if (candidate && candidate->edits_valid &&
+	    candidate->version == running_config->version) {
+		count = nb_config_edits_roots(config_dst->dnode,
+					      config_src->dnode,
+					      &candidate->edits, &roots);
+		copied = true;
+		for (i = 0; copied && i < count; i++)
+			copied = nb_config_copy_subtree(config_dst, config_src,
+							roots[i]->xpath);
+		XFREE(MTYPE_TMP, roots);
+	}
+
+	/* a failed copy leaves config_dst half done, replace it all */
+	if (!copied)
+		nb_config_replace(config_dst, config_src, true);
+
+	/* both are the same now */
+	if (candidate)
+		nb_config_edits_reset(candidate, true);
+}
+
 /* Generate the nb_config_cbs tree. */
 static inline int nb_config_cb_compare(const struct nb_config_cb *a,
 				       const struct nb_config_cb *b)
@@ -539,56 +811,19 @@ static inline void nb_config_diff_dnode_log(const char *context,
 #endif
 
 /*
- * Calculate the delta between two different configurations.
- *
- * NOTE: 'config1' is the reference DB, while 'config2' is
- * the DB being compared against 'config1'. Typically 'config1'
- * should be the Running DB and 'config2' is the Candidate DB.
+ * Turn a libyang diff between 'config1' and 'config2' into northbound
+ * configuration changes.
  */
-void nb_config_diff(const struct nb_config *config1,
-		    const struct nb_config *config2,
-		    struct nb_config_cbs *changes)
+static void nb_config_diff_walk(const struct nb_config *config1,
+				const struct nb_config *config2,
+				const struct lyd_node *diff, uint32_t *seq,
+				struct nb_config_cbs *changes)
 {
-	struct lyd_node *diff = NULL;
 	const struct lyd_node *root, *dnode;
 	struct lyd_node *target;
 	int op;
-	LY_ERR err;
 	char *path;
 
-#if 0 /* Useful (noisy) when debugging diff code, and for improving later */
-	if (DEBUG_MODE_CHECK(&nb_dbg_cbs_config, DEBUG_MODE_ALL)) {
-		LY_LIST_FOR(config1->dnode, root) {
-			LYD_TREE_DFS_BEGIN(root, dnode) {
-				nb_config_diff_dnode_log("from", dnode);
-				LYD_TREE_DFS_END(root, dnode);
-			}
-		}
-		LY_LIST_FOR(config2->dnode, root) {
-			LYD_TREE_DFS_BEGIN(root, dnode) {
-				nb_config_diff_dnode_log("to", dnode);
-				LYD_TREE_DFS_END(root, dnode);
-			}
-		}
-	}
-#endif
-
-	err = lyd_diff_siblings(config1->dnode, config2->dnode,
-				LYD_DIFF_DEFAULTS, &diff);
-	assert(!err);
-
-	if (diff && DEBUG_MODE_CHECK(&nb_dbg_cbs_config, DEBUG_MODE_ALL)) {
-		char *s;
-
-		if (!lyd_print_mem(&s, diff, LYD_JSON,
-				   LYD_PRINT_WITHSIBLINGS | LYD_PRINT_WD_ALL)) {
-			zlog_debug("%s: %s", __func__, s);
-			free(s);
-		}
-	}
-
-	uint32_t seq = 0;
-
 	LY_LIST_FOR (diff, root) {
 		LYD_TREE_DFS_BEGIN (root, dnode) {
 			op = nb_lyd_diff_get_op(dnode);
@@ -599,7 +834,7 @@ void nb_config_diff(const struct nb_config *config1,
 			if (DEBUG_MODE_CHECK(&nb_dbg_cbs_config, DEBUG_MODE_ALL)) {
 				char context[80];
 				snprintf(context, sizeof(context),
-					 "iterating diff: oper: %c seq: %u", op, seq);
+					 "iterating diff: oper: %c seq: %u", op, *seq);
 				nb_config_diff_dnode_log_path(context, path, dnode);
 			}
 #endif
@@ -614,7 +849,7 @@ void nb_config_diff(const struct nb_config *config1,
 				   */
 				target = yang_dnode_get(config2->dnode, path);
 				assert(target);
-				nb_config_diff_created(target, &seq, changes);
+				nb_config_diff_created(target, seq, changes);
 
 				/* Skip rest of sub-tree, move to next sibling
 				 */
@@ -623,7 +858,7 @@ void nb_config_diff(const struct nb_config *config1,
 			case 'd': /* delete */
 				target = yang_dnode_get(config1->dnode, path);
 				assert(target);
-				nb_config_diff_deleted(target, &seq, changes);
+				nb_config_diff_deleted(target, seq, changes);
 
 				/* Skip rest of sub-tree, move to next sibling
 				 */
@@ -634,7 +869,7 @@ void nb_config_diff(const struct nb_config *config1,
 				target = yang_dnode_get(config2->dnode, path);
 				assert(target);
 				nb_config_diff_add_change(changes, NB_OP_MODIFY,
-							  &seq, target);
+							  seq, target);
 				break;
 			case 'n': /* none */
 			default:
@@ -645,9 +880,102 @@ void nb_config_diff(const struct nb_config *config1,
 		}
 	}
 
+}
+
+/*
+ * Calculate the delta between two different configurations.
+ *
+ * NOTE: 'config1' is the reference DB, while 'config2' is
+ * the DB being compared against 'config1'. Typically 'config1'
+ * should be the Running DB and 'config2' is the Candidate DB.
+ */
+void nb_config_diff(const struct nb_config *config1,
+		    const struct nb_config *config2,
+		    struct nb_config_cbs *changes)
+{
+	struct lyd_node *diff = NULL;
+	uint32_t seq = 0;
+	LY_ERR err;
+
+#if 0 /* Useful (noisy) when debugging diff code, and for improving later */
+	if (DEBUG_MODE_CHECK(&nb_dbg_cbs_config, DEBUG_MODE_ALL)) {
+		LY_LIST_FOR(config1->dnode, root) {
+			LYD_TREE_DFS_BEGIN(root, dnode) {
+				nb_config_diff_dnode_log("from", dnode);
+				LYD_TREE_DFS_END(root, dnode);
+			}
+		}
+		LY_LIST_FOR(config2->dnode, root) {
+			LYD_TREE_DFS_BEGIN(root, dnode) {
+				nb_config_diff_dnode_log("to", dnode);
+				LYD_TREE_DFS_END(root, dnode);
+			}
+		}
+	}
+#endif
+
+	err = lyd_diff_siblings(config1->dnode, config2->dnode,
+				LYD_DIFF_DEFAULTS, &diff);
+	assert(!err);
+
+	if (diff && DEBUG_MODE_CHECK(&nb_dbg_cbs_config, DEBUG_MODE_ALL)) {
+		char *s;
+
+		if (!lyd_print_mem(&s, diff, LYD_JSON,
+				   LYD_PRINT_WITHSIBLINGS | LYD_PRINT_WD_ALL)) {
+			zlog_debug("%s: %s", __func__, s);
+			free(s);
+		}
+	}
+
+	nb_config_diff_walk(config1, config2, diff, &seq, changes);
 	lyd_free_all(diff);
 }
 
+/*
+ * Same as nb_config_diff(), but only looks at the subtrees recorded as
+ * edited in 'config2', which must be based on 'config1'.
+ */
+static void nb_config_diff_edits(const struct nb_config *config1,
+				 const struct nb_config *config2,
+				 struct nb_config_cbs *changes)
+{
+	const struct nb_config_edit **roots;
+	const struct lyd_node *old, *new;
+	struct lyd_node *diff;
+	size_t count, i;
+	uint32_t seq = 0;
+	LY_ERR err;
+
+	count = nb_config_edits_roots(config1->dnode, config2->dnode,
+				      &config2->edits, &roots);
+	for (i = 0; i < count; i++) {
+		old = yang_dnode_get(config1->dnode, roots[i]->xpath);
+		new = yang_dnode_get(config2->dnode, roots[i]->xpath);
+
+		diff = NULL;
+		err = lyd_diff_tree(old, new, LYD_DIFF_DEFAULTS, &diff);
+		assert(!err);
+		nb_config_diff_walk(config1, config2, diff, &seq, changes);
+		lyd_free_all(diff);
+	}
+	XFREE(MTYPE_TMP, roots);
+}
+
+/*
+ * Diff a candidate against the running configuration, using the edits
+ * recorded on the candidate if they're still valid.
+ */
+static void nb_candidate_diff(const struct nb_config *candidate,
+			      struct nb_config_cbs *changes)
+{
+	if (candidate->edits_valid &&
+	    candidate->version == running_config->version)
+		nb_config_diff_edits(running_config, candidate, changes);
+	else
+		nb_config_diff(running_config, candidate, changes);
+}
+
 int nb_candidate_edit(struct nb_config *candidate,
 		      const struct nb_node *nb_node,
 		      enum nb_operation operation, const char *xpath,
@@ -677,7 +1005,12 @@ int nb_candidate_edit(struct nb_config *candidate,
 				  "%s: lyd_new_path(%s) failed: %d", __func__,
 				  xpath_edit, err);
 			return NB_ERR;
-		} else if (dnode) {
+		}
+		/* an updated value doesn't come back as a created node */
+		nb_config_edits_record(candidate, xpath_edit);
+		if (dnode) {
+			nb_config_edits_record_dnode(candidate, dnode);
+
 			/* Create default nodes */
 			LY_ERR err = lyd_new_implicit_tree(
 				dnode, LYD_IMPLICIT_NO_STATE, NULL);
@@ -697,6 +1030,7 @@ int nb_candidate_edit(struct nb_config *candidate,
 				nb_node->dep_cbs.get_dependency_xpath(
 					dnode, dep_xpath);
 
+				nb_config_edits_record(candidate, dep_xpath);
 				err = lyd_new_path(candidate->dnode,
 						   ly_native_ctx, dep_xpath,
 						   NULL, LYD_NEW_PATH_UPDATE,
@@ -729,9 +1063,13 @@ int nb_candidate_edit(struct nb_config *candidate,
 			nb_node->dep_cbs.get_dependant_xpath(dnode, dep_xpath);
 
 			dep_dnode = yang_dnode_get(candidate->dnode, dep_xpath);
-			if (dep_dnode)
+			if (dep_dnode) {
+				nb_config_edits_record_dnode(candidate,
+							     dep_dnode);
 				lyd_free_tree(dep_dnode);
+			}
 		}
+		nb_config_edits_record_dnode(candidate, dnode);
 		lyd_free_tree(dnode);
 		break;
 	case NB_OP_MOVE:
@@ -946,14 +1284,26 @@ int nb_candidate_update(struct nb_config *candidate)
 int nb_candidate_validate_yang(struct nb_config *candidate, bool no_state,
 			       char *errmsg, size_t errmsg_len)
 {
+	struct lyd_node *diff = NULL;
+
+	/*
+	 * Validation can add and remove nodes anywhere (defaults, "when"
+	 * conditions), keep track of those for the incremental diff.
+	 */
 	if (lyd_validate_all(&candidate->dnode, ly_native_ctx,
 			     no_state ? LYD_VALIDATE_NO_STATE
 				      : LYD_VALIDATE_PRESENT,
-			     NULL) != 0) {
+			     candidate->edits_valid ? &diff : NULL) != 0) {
+		lyd_free_all(diff);
 		yang_print_errors(ly_native_ctx, errmsg, errmsg_len);
 		return NB_ERR_VALIDATION;
 	}
 
+	if (diff) {
+		nb_config_edits_record_diff(candidate, diff);
+		lyd_free_all(diff);
+	}
+
 	return NB_OK;
 }
 
@@ -1009,7 +1359,7 @@ int nb_candidate_diff_and_validate_yang(struct nb_context *context,
 		return NB_ERR_VALIDATION;
 
 	RB_INIT(nb_config_cbs, changes);
-	nb_config_diff(running_config, candidate, changes);
+	nb_candidate_diff(candidate, changes);
 
 	return NB_OK;
 }
@@ -1052,7 +1402,7 @@ int nb_candidate_commit_prepare(struct nb_context context,
 	}
 
 	RB_INIT(nb_config_cbs, &changes);
-	nb_config_diff(running_config, candidate, &changes);
+	nb_candidate_diff(candidate, &changes);
 	if (!ignore_zero_change && RB_EMPTY(nb_config_cbs, &changes)) {
 		snprintf(
 			errmsg, errmsg_len,
@@ -1108,6 +1458,9 @@ void nb_candidate_commit_apply(struct nb_transaction *transaction,
 	transaction->config->version++;
 	nb_config_replace(running_config, transaction->config, true);
 
+	/* The candidate is a copy of running now, start tracking afresh. */
+	nb_config_edits_reset(transaction->config, true);
+
 	/* Record transaction. */
 	if (save_transaction && nb_db_enabled
 	    && nb_db_transaction_save(transaction, transaction_id) != NB_OK)
@@ -1832,12 +2185,107 @@ static void nb_transaction_apply_finish(struct nb_transaction *transaction,
 	}
 }
 
+/* Paging state of an operational data walk */
+struct nb_oper_walk {
+	struct nb_oper_page *page;
+
+	/* Keyed list entries on the way to the end of the previous page. */
+	struct {
+		const struct lysc_node *snode;
+		struct yang_list_keys keys;
+	} levels[NB_OPER_PAGE_MAX_DEPTH];
+	unsigned int nlevels;
+
+	/* Skipping ahead to levels[level] (nothing is returned meanwhile). */
+	bool skipping;
+	unsigned int level;
+
+	/* Entries of keyless lists can't be resumed at. */
+	unsigned int keyless;
+
+	/* The page is full. */
+	bool done;
+};
+
+static bool nb_oper_walk_done(const struct nb_oper_walk *walk)
+{
+	return walk && walk->done;
+}
+
+/* Is snode before the resume point (and not on the way to it)? */
+static bool nb_oper_walk_skip(const struct nb_oper_walk *walk,
+			      const struct lysc_node *snode)
+{
+	const struct lysc_node *target;
+
+	if (!walk || !walk->skipping)
+		return false;
+
+	for (target = walk->levels[walk->level].snode; target;
+	     target = target->parent)
+		if (target == snode)
+			return false;
+	return true;
+}
+
+static const void *nb_oper_walk_resume_entry(struct nb_oper_walk *walk,
+					     const struct nb_node *nb_node,
+					     const void *parent_list_entry)
+{
+	const struct yang_list_keys *keys = &walk->levels[walk->level].keys;
+	struct yang_list_keys entry_keys;
+	const void *list_entry = NULL;
+	unsigned int i;
+
+	assert(walk->levels[walk->level].snode == nb_node->snode);
+
+	if (nb_node->cbs.lookup_entry)
+		return nb_callback_lookup_entry(nb_node, parent_list_entry,
+						keys);
+
+	/* No shortcut, walk the list up to the entry. */
+	while ((list_entry = nb_callback_get_next(nb_node, parent_list_entry,
+						  list_entry))) {
+		memset(&entry_keys, 0, sizeof(entry_keys));
+		if (nb_callback_get_keys(nb_node, list_entry, &entry_keys) !=
+		    NB_OK)
+			return NULL;
+		if (entry_keys.num != keys->num)
+			continue;
+		for (i = 0; i < keys->num; i++)
+			if (strcmp(entry_keys.key[i], keys->key[i]))
+				break;
+		if (i == keys->num)
+			return list_entry;
+	}
+
+	return NULL;
+}
+
+static int nb_oper_data_emit(struct nb_oper_walk *walk, nb_oper_data_cb cb,
+			     const struct lysc_node *snode,
+			     struct yang_translator *translator,
+			     struct yang_data *data, void *arg)
+{
+	if (walk) {
+		/* Returned on a previous page already. */
+		if (walk->skipping) {
+			yang_data_free(data);
+			return NB_OK;
+		}
+		walk->page->items++;
+	}
+
+	return (*cb)(snode, translator, data, arg);
+}
+
 static int nb_oper_data_iter_children(const struct lysc_node *snode,
 				      const char *xpath, const void *list_entry,
 				      const struct yang_list_keys *list_keys,
 				      struct yang_translator *translator,
 				      bool first, uint32_t flags,
-				      nb_oper_data_cb cb, void *arg)
+				      nb_oper_data_cb cb, void *arg,
+				      struct nb_oper_walk *walk)
 {
 	const struct lysc_node *child;
 
@@ -1846,8 +2294,8 @@ static int nb_oper_data_iter_children(const struct lysc_node *snode,
 
 		ret = nb_oper_data_iter_node(child, xpath, list_entry,
 					     list_keys, translator, false,
-					     flags, cb, arg);
-		if (ret != NB_OK)
+					     flags, cb, arg, walk);
+		if (ret != NB_OK || nb_oper_walk_done(walk))
 			return ret;
 	}
 
@@ -1858,7 +2306,8 @@ static int nb_oper_data_iter_leaf(const struct nb_node *nb_node,
 				  const char *xpath, const void *list_entry,
 				  const struct yang_list_keys *list_keys,
 				  struct yang_translator *translator,
-				  uint32_t flags, nb_oper_data_cb cb, void *arg)
+				  uint32_t flags, nb_oper_data_cb cb, void *arg,
+				  struct nb_oper_walk *walk)
 {
 	struct yang_data *data;
 
@@ -1874,7 +2323,8 @@ static int nb_oper_data_iter_leaf(const struct nb_node *nb_node,
 		/* Leaf of type "empty" is not present. */
 		return NB_OK;
 
-	return (*cb)(nb_node->snode, translator, data, arg);
+	return nb_oper_data_emit(walk, cb, nb_node->snode, translator, data,
+				 arg);
 }
 
 static int nb_oper_data_iter_container(const struct nb_node *nb_node,
@@ -1883,7 +2333,7 @@ static int nb_oper_data_iter_container(const struct nb_node *nb_node,
 				       const struct yang_list_keys *list_keys,
 				       struct yang_translator *translator,
 				       uint32_t flags, nb_oper_data_cb cb,
-				       void *arg)
+				       void *arg, struct nb_oper_walk *walk)
 {
 	const struct lysc_node *snode = nb_node->snode;
 
@@ -1900,7 +2350,7 @@ static int nb_oper_data_iter_container(const struct nb_node *nb_node,
 			/* Presence container is not present. */
 			return NB_OK;
 
-		ret = (*cb)(snode, translator, data, arg);
+		ret = nb_oper_data_emit(walk, cb, snode, translator, data, arg);
 		if (ret != NB_OK)
 			return ret;
 	}
@@ -1917,7 +2367,8 @@ static int nb_oper_data_iter_container(const struct nb_node *nb_node,
 
 	/* Iterate over the child nodes. */
 	return nb_oper_data_iter_children(snode, xpath, list_entry, list_keys,
-					  translator, false, flags, cb, arg);
+					  translator, false, flags, cb, arg,
+					  walk);
 }
 
 static int
@@ -1925,7 +2376,8 @@ nb_oper_data_iter_leaflist(const struct nb_node *nb_node, const char *xpath,
 			   const void *parent_list_entry,
 			   const struct yang_list_keys *parent_list_keys,
 			   struct yang_translator *translator, uint32_t flags,
-			   nb_oper_data_cb cb, void *arg)
+			   nb_oper_data_cb cb, void *arg,
+			   struct nb_oper_walk *walk)
 {
 	const void *list_entry = NULL;
 
@@ -1946,7 +2398,8 @@ nb_oper_data_iter_leaflist(const struct nb_node *nb_node, const char *xpath,
 		if (data == NULL)
 			continue;
 
-		ret = (*cb)(nb_node->snode, translator, data, arg);
+		ret = nb_oper_data_emit(walk, cb, nb_node->snode, translator,
+					data, arg);
 		if (ret != NB_OK)
 			return ret;
 	} while (list_entry);
@@ -1954,27 +2407,108 @@ nb_oper_data_iter_leaflist(const struct nb_node *nb_node, const char *xpath,
 	return NB_OK;
 }
 
+static int nb_oper_data_iter_list_entry(const struct nb_node *nb_node,
+					const char *xpath_list,
+					const void *list_entry,
+					uint32_t position,
+					struct yang_translator *translator,
+					uint32_t flags, nb_oper_data_cb cb,
+					void *arg, struct nb_oper_walk *walk)
+{
+	const struct lysc_node *snode = nb_node->snode;
+	const struct lysc_node_leaf *skey;
+	struct yang_list_keys list_keys = {};
+	char xpath[XPATH_MAXLEN * 2];
+	bool keyless;
+	int ret;
+
+	keyless = CHECK_FLAG(nb_node->flags, F_NB_NODE_KEYLESS_LIST);
+	if (!keyless) {
+		/* Obtain the list entry keys. */
+		if (nb_callback_get_keys(nb_node, list_entry, &list_keys)
+		    != NB_OK) {
+			flog_warn(EC_LIB_NB_CB_STATE,
+				  "%s: failed to get list keys", __func__);
+			return NB_ERR;
+		}
+
+		/* Build XPath of the list entry. */
+		strlcpy(xpath, xpath_list, sizeof(xpath));
+		unsigned int i = 0;
+		LY_FOR_KEYS (snode, skey) {
+			assert(i < list_keys.num);
+			snprintf(xpath + strlen(xpath),
+				 sizeof(xpath) - strlen(xpath), "[%s='%s']",
+				 skey->name, list_keys.key[i]);
+			i++;
+		}
+		assert(i == list_keys.num);
+	} else {
+		/*
+		 * Keyless list - build XPath using a positional index.
+		 */
+		snprintf(xpath, sizeof(xpath), "%s[%u]", xpath_list, position);
+	}
+
+	/* Iterate over the child nodes. */
+	if (walk && keyless)
+		walk->keyless++;
+	ret = nb_oper_data_iter_children(snode, xpath, list_entry, &list_keys,
+					 translator, false, flags, cb, arg,
+					 walk);
+	if (walk && keyless)
+		walk->keyless--;
+	if (ret != NB_OK || !walk)
+		return ret;
+
+	/* End the page after this entry once it is full. */
+	if (!keyless && !walk->keyless && !walk->skipping && !walk->done &&
+	    walk->page->max_items &&
+	    walk->page->items >= walk->page->max_items) {
+		strlcpy(walk->page->cursor, xpath, sizeof(walk->page->cursor));
+		walk->done = true;
+	}
+
+	return NB_OK;
+}
+
 static int nb_oper_data_iter_list(const struct nb_node *nb_node,
 				  const char *xpath_list,
 				  const void *parent_list_entry,
 				  const struct yang_list_keys *parent_list_keys,
 				  struct yang_translator *translator,
-				  uint32_t flags, nb_oper_data_cb cb, void *arg)
+				  uint32_t flags, nb_oper_data_cb cb, void *arg,
+				  struct nb_oper_walk *walk)
 {
-	const struct lysc_node *snode = nb_node->snode;
 	const void *list_entry = NULL;
 	uint32_t position = 1;
+	int ret;
 
 	if (CHECK_FLAG(nb_node->flags, F_NB_NODE_CONFIG_ONLY))
 		return NB_OK;
 
+	/* The previous page ended in (or below) an entry of this list. */
+	if (walk && walk->skipping) {
+		list_entry = nb_oper_walk_resume_entry(walk, nb_node,
+						       parent_list_entry);
+		if (!list_entry)
+			return NB_ERR_NOT_FOUND;
+
+		if (++walk->level == walk->nlevels) {
+			/* That entry was complete, carry on after it. */
+			walk->skipping = false;
+		} else {
+			ret = nb_oper_data_iter_list_entry(nb_node, xpath_list,
+							   list_entry, 0,
+							   translator, flags,
+							   cb, arg, walk);
+			if (ret != NB_OK || nb_oper_walk_done(walk))
+				return ret;
+		}
+	}
+
 	/* Iterate over all list entries. */
 	do {
-		const struct lysc_node_leaf *skey;
-		struct yang_list_keys list_keys = {};
-		char xpath[XPATH_MAXLEN * 2];
-		int ret;
-
 		/* Obtain list entry. */
 		list_entry = nb_callback_get_next(nb_node, parent_list_entry,
 						  list_entry);
@@ -1982,43 +2516,11 @@ static int nb_oper_data_iter_list(const struct nb_node *nb_node,
 			/* End of the list. */
 			break;
 
-		if (!CHECK_FLAG(nb_node->flags, F_NB_NODE_KEYLESS_LIST)) {
-			/* Obtain the list entry keys. */
-			if (nb_callback_get_keys(nb_node, list_entry,
-						 &list_keys)
-			    != NB_OK) {
-				flog_warn(EC_LIB_NB_CB_STATE,
-					  "%s: failed to get list keys",
-					  __func__);
-				return NB_ERR;
-			}
-
-			/* Build XPath of the list entry. */
-			strlcpy(xpath, xpath_list, sizeof(xpath));
-			unsigned int i = 0;
-			LY_FOR_KEYS (snode, skey) {
-				assert(i < list_keys.num);
-				snprintf(xpath + strlen(xpath),
-					 sizeof(xpath) - strlen(xpath),
-					 "[%s='%s']", skey->name,
-					 list_keys.key[i]);
-				i++;
-			}
-			assert(i == list_keys.num);
-		} else {
-			/*
-			 * Keyless list - build XPath using a positional index.
-			 */
-			snprintf(xpath, sizeof(xpath), "%s[%u]", xpath_list,
-				 position);
-			position++;
-		}
-
-		/* Iterate over the child nodes. */
-		ret = nb_oper_data_iter_children(
-			nb_node->snode, xpath, list_entry, &list_keys,
-			translator, false, flags, cb, arg);
-		if (ret != NB_OK)
+		ret = nb_oper_data_iter_list_entry(nb_node, xpath_list,
+						   list_entry, position++,
+						   translator, flags, cb, arg,
+						   walk);
+		if (ret != NB_OK || nb_oper_walk_done(walk))
 			return ret;
 	} while (list_entry);
 
@@ -2031,7 +2533,8 @@ static int nb_oper_data_iter_node(const struct lysc_node *snode,
 				  const struct yang_list_keys *list_keys,
 				  struct yang_translator *translator,
 				  bool first, uint32_t flags,
-				  nb_oper_data_cb cb, void *arg)
+				  nb_oper_data_cb cb, void *arg,
+				  struct nb_oper_walk *walk)
 {
 	struct nb_node *nb_node;
 	char xpath[XPATH_MAXLEN];
@@ -2041,6 +2544,9 @@ static int nb_oper_data_iter_node(const struct lysc_node *snode,
 	    && CHECK_FLAG(snode->nodetype, LYS_CONTAINER | LYS_LIST))
 		return NB_OK;
 
+	if (nb_oper_walk_skip(walk, snode))
+		return NB_OK;
+
 	/* Update XPath. */
 	strlcpy(xpath, xpath_parent, sizeof(xpath));
 	if (!first && snode->nodetype != LYS_USES) {
@@ -2068,27 +2574,27 @@ static int nb_oper_data_iter_node(const struct lysc_node *snode,
 	case LYS_CONTAINER:
 		ret = nb_oper_data_iter_container(nb_node, xpath, list_entry,
 						  list_keys, translator, flags,
-						  cb, arg);
+						  cb, arg, walk);
 		break;
 	case LYS_LEAF:
 		ret = nb_oper_data_iter_leaf(nb_node, xpath, list_entry,
 					     list_keys, translator, flags, cb,
-					     arg);
+					     arg, walk);
 		break;
 	case LYS_LEAFLIST:
 		ret = nb_oper_data_iter_leaflist(nb_node, xpath, list_entry,
 						 list_keys, translator, flags,
-						 cb, arg);
+						 cb, arg, walk);
 		break;
 	case LYS_LIST:
 		ret = nb_oper_data_iter_list(nb_node, xpath, list_entry,
 					     list_keys, translator, flags, cb,
-					     arg);
+					     arg, walk);
 		break;
 	case LYS_USES:
 		ret = nb_oper_data_iter_children(snode, xpath, list_entry,
 						 list_keys, translator, false,
-						 flags, cb, arg);
+						 flags, cb, arg, walk);
 		break;
 	default:
 		break;
@@ -2097,8 +2603,84 @@ static int nb_oper_data_iter_node(const struct lysc_node *snode,
 	return ret;
 }
 
-int nb_oper_data_iterate(const char *xpath, struct yang_translator *translator,
-			 uint32_t flags, nb_oper_data_cb cb, void *arg)
+/*
+ * Set up a walk to skip ahead to the end of the previous page.  The first
+ * 'skip' keyed list entries on the way are the ones given in the XPath
+ * being iterated over.
+ */
+static int nb_oper_walk_resume_init(struct nb_oper_walk *walk,
+				    const char *xpath, const char *cursor,
+				    unsigned int skip)
+{
+	struct lyd_node *dnode, *dn, *child;
+	struct yang_list_keys *keys;
+	struct list *list_dnodes;
+	struct listnode *ln;
+	int ret = NB_OK;
+
+	if (strncmp(cursor, xpath, strlen(xpath))) {
+		flog_warn(EC_LIB_NB_OPERATIONAL_DATA,
+			  "%s: resume point %s is not below %s", __func__,
+			  cursor, xpath);
+		return NB_ERR;
+	}
+
+	LY_ERR err = lyd_new_path(NULL, ly_native_ctx, cursor, NULL,
+				  LYD_NEW_PATH_UPDATE, &dnode);
+	if (err || !dnode) {
+		flog_warn(EC_LIB_LIBYANG, "%s: lyd_new_path(%s) failed",
+			  __func__, cursor);
+		return NB_ERR;
+	}
+
+	list_dnodes = list_new();
+	for (dn = dnode; dn; dn = lyd_parent(dn)) {
+		if (dn->schema->nodetype != LYS_LIST || !lyd_child(dn))
+			continue;
+		listnode_add_head(list_dnodes, dn);
+	}
+
+	for (ALL_LIST_ELEMENTS_RO(list_dnodes, ln, dn)) {
+		unsigned int n = 0;
+
+		if (skip) {
+			skip--;
+			continue;
+		}
+		if (walk->nlevels == NB_OPER_PAGE_MAX_DEPTH) {
+			ret = NB_ERR;
+			break;
+		}
+
+		keys = &walk->levels[walk->nlevels].keys;
+		walk->levels[walk->nlevels].snode = dn->schema;
+		LY_LIST_FOR (lyd_child(dn), child) {
+			if (!lysc_is_key(child->schema))
+				break;
+			strlcpy(keys->key[n], yang_dnode_get_string(child, NULL),
+				sizeof(keys->key[n]));
+			n++;
+		}
+		keys->num = n;
+		walk->nlevels++;
+	}
+
+	list_delete(&list_dnodes);
+	yang_dnode_free(dnode);
+
+	if (ret == NB_OK && !walk->nlevels)
+		ret = NB_ERR;
+	if (ret != NB_OK)
+		flog_warn(EC_LIB_NB_OPERATIONAL_DATA,
+			  "%s: invalid resume point %s", __func__, cursor);
+	walk->skipping = (ret == NB_OK);
+	return ret;
+}
+
+static int nb_oper_data_walk(const char *xpath,
+			     struct yang_translator *translator,
+			     uint32_t flags, nb_oper_data_cb cb, void *arg,
+			     struct nb_oper_walk *walk, const char *cursor)
 {
 	struct nb_node *nb_node;
 	const void *list_entry = NULL;
@@ -2195,15 +2777,27 @@ int nb_oper_data_iterate(const char *xpath, struct yang_translator *translator,
 		}
 	}
 
+	if (cursor && cursor[0] &&
+	    nb_oper_walk_resume_init(walk, xpath, cursor,
+				     listcount(list_dnodes)) != NB_OK) {
+		list_delete(&list_dnodes);
+		yang_dnode_free(dnode);
+		return NB_ERR;
+	}
+
 	/* If a list entry was given, iterate over that list entry only. */
 	if (dnode->schema->nodetype == LYS_LIST && lyd_child(dnode))
 		ret = nb_oper_data_iter_children(
 			nb_node->snode, xpath, list_entry, &list_keys,
-			translator, true, flags, cb, arg);
+			translator, true, flags, cb, arg, walk);
 	else
 		ret = nb_oper_data_iter_node(nb_node->snode, xpath, list_entry,
 					     &list_keys, translator, true,
-					     flags, cb, arg);
+					     flags, cb, arg, walk);
+
+	/* The entry the previous page ended with is gone. */
+	if (ret == NB_OK && walk && walk->skipping)
+		ret = NB_ERR_NOT_FOUND;
 
 	list_delete(&list_dnodes);
 	yang_dnode_free(dnode);
@@ -2211,6 +2805,40 @@ int nb_oper_data_iterate(const char *xpath, struct yang_translator *translator,
 	return ret;
 }
 
+int nb_oper_data_iterate(const char *xpath, struct yang_translator *translator,
+			 uint32_t flags, nb_oper_data_cb cb, void *arg)
+{
+	return nb_oper_data_walk(xpath, translator, flags, cb, arg, NULL,
+				 NULL);
+}
+
+int nb_oper_data_iterate_page(const char *xpath,
+			      struct yang_translator *translator,
+			      uint32_t flags, struct nb_oper_page *page,
+			      nb_oper_data_cb cb, void *arg)
+{
+	struct nb_oper_walk *walk;
+	char *cursor;
+	int ret;
+
+	/* page->cursor is overwritten on the way */
+	cursor = XSTRDUP(MTYPE_TMP, page->cursor);
+	page->cursor[0] = '\0';
+	page->items = 0;
+
+	walk = XCALLOC(MTYPE_TMP, sizeof(*walk));
+	walk->page = page;
+
+	ret = nb_oper_data_walk(xpath, translator, flags, cb, arg, walk,
+				cursor);
+	if (ret != NB_OK || !walk->done)
+		page->cursor[0] = '\0';
+
+	XFREE(MTYPE_TMP, walk);
+	XFREE(MTYPE_TMP, cursor);
+	return ret;
+}
+
 bool nb_operation_is_valid(enum nb_operation operation,
 			   const struct lysc_node *snode)
 {
@@ -2690,6 +3318,7 @@ void nb_init(struct event_loop *tm,
 	     size_t nmodules, bool db_enabled)
 {
 	struct yang_module *loaded[nmodules], **loadedp = loaded;
+	const char *names[nmodules];
 	bool explicit_compile;
 
 	/*
@@ -2703,7 +3332,10 @@ void nb_init(struct event_loop *tm,
 
 	nb_db_enabled = db_enabled;
 
-	yang_init(true, explicit_compile);
+	for (size_t i = 0; i < nmodules; i++)
+		names[i] = modules[i]->name;
+	yang_init_shared(YANG_SHARED_CTX_PATH, names, nmodules,
+			 explicit_compile);
 
 	/* Load YANG modules and their corresponding northbound callbacks. */
 	for (size_t i = 0; i < nmodules; i++) {
@@ -11,6 +11,7 @@
 #include "hook.h"
 #include "linklist.h"
 #include "openbsd-tree.h"
+#include "typesafe.h"
 #include "yang.h"
 #include "yang_translator.h"
 
@@ -699,11 +700,25 @@ struct nb_transaction {
 	struct nb_config_cbs changes;
 };
 
+PREDECL_HASH(nb_config_edits);
+
+/* More edits than this and commits just diff the whole configuration. */
+#define NB_CONFIG_EDITS_MAX 1024
+
 /* Northbound configuration. */
 struct nb_config {
 	struct lyd_node *dnode;
 	uint32_t version;
 	struct nb_config_cbs cfg_chgs;
+
+	/*
+	 * XPaths changed by nb_candidate_edit() (and by validation) since
+	 * this configuration was last a copy of the running configuration.
+	 * While valid, committing only needs to diff these subtrees against
+	 * the running configuration instead of the whole data tree.
+	 */
+	struct nb_config_edits_head edits;
+	bool edits_valid;
 };
 
 /* Callback function used by nb_oper_data_iterate(). */
@@ -714,6 +729,25 @@ typedef int (*nb_oper_data_cb)(const struct lysc_node *snode,
 /* Iterate over direct child nodes only. */
 #define NB_OPER_DATA_ITER_NORECURSE 0x0001
 
+/* Maximum nesting of keyed lists a paged iteration can resume in. */
+#define NB_OPER_PAGE_MAX_DEPTH 16
+
+/* State of a paged iteration, see nb_oper_data_iterate_page(). */
+struct nb_oper_page {
+	/* Number of data nodes per page (0: no limit). */
+	uint32_t max_items;
+
+	/*
+	 * XPath of the list entry the previous page ended with, empty to
+	 * start from the beginning.  Updated for the next page, empty once
+	 * there's nothing left.
+	 */
+	char cursor[XPATH_MAXLEN * 2];
+
+	/* Number of data nodes returned for this page. */
+	uint32_t items;
+};
+
 /* Hooks. */
 DECLARE_HOOK(nb_notification_send, (const char *xpath, struct list *arguments),
 	     (xpath, arguments));
@@ -842,6 +876,22 @@ extern void nb_config_replace(struct nb_config *config_dst,
 			      struct nb_config *config_src,
 			      bool preserve_source);
 
+/*
+ * Same as nb_config_replace() preserving the source, but when one of the
+ * configurations is the running one and the other a candidate based on it,
+ * only the subtrees recorded as edited in the candidate are copied.  Used
+ * to commit a candidate or to discard its changes, at a cost that depends
+ * on the size of the changes instead of the whole configuration.
+ *
+ * config_dst
+ *    Configuration to be replaced.
+ *
+ * config_src
+ *    Configuration to replace config_dst.
+ */
+extern void nb_config_replace_edits(struct nb_config *config_dst,
+				    struct nb_config *config_src);
+
 /*
  * Edit a candidate configuration.
  *
@@ -1282,6 +1332,33 @@ extern int nb_oper_data_iterate(const char *xpath,
 				struct yang_translator *translator,
 				uint32_t flags, nb_oper_data_cb cb, void *arg);
 
+/*
+ * Iterate over one page of operational data.
+ *
+ * Works like nb_oper_data_iterate(), but stops after the first list entry
+ * that makes the page reach page->max_items data nodes (a page always ends
+ * with a complete entry of a keyed list, so it can be a bit larger).  Call
+ * it again with the same xpath and page to get the next page, which starts
+ * with the entry after page->cursor.
+ *
+ * No state is kept between pages, so concurrent changes to the data are
+ * fine: entries added or removed before the cursor are not seen.
+ *
+ * xpath, translator, flags, cb, arg
+ *    Same as for nb_oper_data_iterate().
+ *
+ * page
+ *    Page size and cursor, see struct nb_oper_page.
+ *
+ * Returns:
+ *    NB_OK on success, NB_ERR_NOT_FOUND if the entry the previous page
+ *    ended with is gone, NB_ERR otherwise.
+ */
+extern int nb_oper_data_iterate_page(const char *xpath,
+				     struct yang_translator *translator,
+				     uint32_t flags, struct nb_oper_page *page,
+				     nb_oper_data_cb cb, void *arg);
+
 /*
  * Validate if the northbound operation is valid for the given node.
  *
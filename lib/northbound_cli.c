@@ -1499,6 +1499,7 @@ DEFPY (show_yang_module,
 	struct ly_ctx *ly_ctx;
 	struct yang_translator *translator = NULL;
 	const struct lys_module *module;
+	const char *version;
 	struct ttable *tt;
 	uint32_t idx = 0;
 
@@ -1528,8 +1529,15 @@ DEFPY (show_yang_module,
 			 module->implemented ? 'I' : ' ',
 			 LY_ARRAY_COUNT(module->deviated_by) ? 'D' : ' ');
 
-		ttable_add_row(tt, "%s|%s|%s|%s|%s", module->name,
-			       (module->parsed->version == 2) ? "1.1" : "1.0",
+		/* a shared context only has the compiled modules */
+		if (!module->parsed)
+			version = "-";
+		else if (module->parsed->version == 2)
+			version = "1.1";
+		else
+			version = "1.0";
+
+		ttable_add_row(tt, "%s|%s|%s|%s|%s", module->name, version,
 			       module->revision ? module->revision : "-", flags,
 			       module->ns);
 	}
@@ -1538,6 +1546,8 @@ DEFPY (show_yang_module,
 	if (tt->nrows > 1) {
 		char *table;
 
+		if (!translator)
+			yang_ctx_show(vty);
 		vty_out(vty, " Flags: I - Implemented, D - Deviated\n\n");
 
 		table = ttable_dump(tt, "\n");
@@ -19,6 +19,7 @@
 #include "northbound_db.h"
 #include "frr_pthread.h"
 
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <memory>
@@ -26,6 +27,12 @@
 
 #define GRPC_DEFAULT_PORT 50051
 
+// Pthreads encoding Get responses, so that the main pthread only collects data
+#define GRPC_ENCODE_THREADS 4
+
+// Notifications queued per subscriber before new ones get dropped
+#define GRPC_SUBSCRIBE_QUEUE_MAX 1024
+
 
 // ------------------------------------------------------
 //                 File Local Variables
@@ -42,8 +49,14 @@ static struct event_loop *main_master;
 
 static struct frr_pthread *fpt;
 
+static struct frr_pthread *encode_fpts[GRPC_ENCODE_THREADS];
+
 static bool grpc_running;
 
+// Capture these objects so we can try to shut down cleanly
+static pthread_mutex_t s_server_lock = PTHREAD_MUTEX_INITIALIZER;
+static grpc::Server *s_server;
+
 #define grpc_debug(...)                                                        \
 	do {                                                                   \
 		if (nb_dbg_client_grpc)                                        \
@@ -151,6 +164,13 @@ class RpcStateBase
 		grpc_debug("%s RPC: %s -> %s on grpc-io-thread", name,
 			   call_states[this->entered_state],
 			   call_states[this->state]);
+
+		/*
+		 * RPCs that stay open (subscriptions) don't wait for the
+		 * previous one to finish before accepting the next.
+		 */
+		if (this->entered_state == CREATE && this->concurrent)
+			this->do_request(service, cq, false);
 		/*
 		 * We schedule the callback on the main pthread, and wait for
 		 * the state to transition out of the PROCESS state. The new
@@ -167,7 +187,15 @@ class RpcStateBase
 		grpc_debug("%s RPC in %s on grpc-io-thread", name,
 			   call_states[this->state]);
 
-		if (this->state == FINISH) {
+		/*
+		 * The rest (encoding and writing the response) happens on an
+		 * encoder pthread, which takes over the RPC until its next
+		 * operation completes.
+		 */
+		if (this->offload(service, cq))
+			return true;
+
+		if (this->state == FINISH && !this->concurrent) {
 			/*
 			 * Server is done (FINISH) so prep to receive a new
 			 * request of this type. We could do this earlier but
@@ -179,6 +207,16 @@ class RpcStateBase
 		return true;
 	}
 
+	/*
+	 * Finish processing on an encoder pthread, if the RPC has anything to
+	 * do there.  Returns false if the RPC is done processing.
+	 */
+	virtual bool offload(frr::Northbound::AsyncService *service,
+			     grpc::ServerCompletionQueue *cq)
+	{
+		return false;
+	}
+
       protected:
 	virtual CallState run_mainthread(struct event *thread) = 0;
 
@@ -213,6 +251,9 @@ class RpcStateBase
 
       public:
 	const char *name;
+
+	// Accept new RPCs of this type while this one is still open.
+	bool concurrent = false;
 };
 
 /*
@@ -285,18 +326,24 @@ class StreamRpcState : public RpcStateBase
 		void *);
 
 	StreamRpcState(reqsfunc_t rfunc, bool (*cb)(StreamRpcState<Q, S, X> *),
-		       const char *name)
+		       const char *name,
+		       bool (*encode_cb)(StreamRpcState<Q, S, X> *) = NULL,
+		       bool concurrent = false)
 	    : RpcStateBase(name), requestsf(rfunc), callback(cb),
-	      async_responder(&ctx){};
+	      encode_callback(encode_cb), async_responder(&ctx)
+	{
+		this->concurrent = concurrent;
+	};
 
 	void do_request(::frr::Northbound::AsyncService *service,
 			::grpc::ServerCompletionQueue *cq,
 			bool no_copy) override
 	{
 		grpc_debug("%s, posting a request for: %s", __func__, name);
-		auto copy =
-			no_copy ? this
-				: new StreamRpcState(requestsf, callback, name);
+		auto copy = no_copy ? this
+				    : new StreamRpcState(requestsf, callback,
+							 name, encode_callback,
+							 concurrent);
 		(service->*requestsf)(&copy->ctx, &copy->request,
 				      &copy->async_responder, cq, cq, copy);
 	}
@@ -309,6 +356,24 @@ class StreamRpcState : public RpcStateBase
 			return FINISH;
 	}
 
+	bool offload(frr::Northbound::AsyncService *service,
+		     grpc::ServerCompletionQueue *cq) override
+	{
+		static unsigned int next;
+		struct frr_pthread *encode_fpt;
+
+		if (!encode_pending)
+			return false;
+		assert(encode_callback);
+
+		this->service = service;
+		this->cq = cq;
+		encode_fpt = encode_fpts[next++ % GRPC_ENCODE_THREADS];
+		event_add_event(encode_fpt->master, c_encode_callback,
+				(void *)this, 0, NULL);
+		return true;
+	}
+
 	Q request;
 	S response;
 	grpc::ServerAsyncWriter<S> async_responder;
@@ -316,7 +381,45 @@ class StreamRpcState : public RpcStateBase
 	bool (*callback)(StreamRpcState<Q, S, X> *);
 	reqsfunc_t requestsf = NULL;
 
+	/*
+	 * If callback sets encode_pending, encode_callback is called on an
+	 * encoder pthread next to fill in response and encode_status.  It
+	 * returns false if that's the last response.
+	 */
+	bool (*encode_callback)(StreamRpcState<Q, S, X> *);
+	bool encode_pending = false;
+	grpc::Status encode_status;
+
 	X context;
+
+      private:
+	static void c_encode_callback(struct event *thread)
+	{
+		auto _tag = static_cast<StreamRpcState<Q, S, X> *>(
+			EVENT_ARG(thread));
+		bool more;
+
+		_tag->encode_pending = false;
+		_tag->response.Clear();
+		_tag->encode_status = grpc::Status::OK;
+		more = _tag->encode_callback(_tag);
+
+		/*
+		 * Writing the response comes last: as soon as it's done, the
+		 * RPC is back on the grpc-io-thread.
+		 */
+		_tag->state = more ? MORE : FINISH;
+		if (!more) {
+			_tag->do_request(_tag->service, _tag->cq, false);
+			_tag->async_responder.WriteAndFinish(
+				_tag->response, grpc::WriteOptions(),
+				_tag->encode_status, _tag);
+		} else
+			_tag->async_responder.Write(_tag->response, _tag);
+	}
+
+	frr::Northbound::AsyncService *service = NULL;
+	grpc::ServerCompletionQueue *cq = NULL;
 };
 
 // ------------------------------------------------------
@@ -438,11 +541,18 @@ static int get_oper_data_cb(const struct lysc_node *snode,
 	return (ret == 0) ? NB_OK : NB_ERR;
 }
 
-static struct lyd_node *get_dnode_state(const std::string &path)
+static struct lyd_node *get_dnode_state(const std::string &path,
+				       struct nb_oper_page *page, int *ret)
 {
 	struct lyd_node *dnode = yang_dnode_new(ly_native_ctx, false);
-	if (nb_oper_data_iterate(path.c_str(), NULL, 0, get_oper_data_cb, dnode)
-	    != NB_OK) {
+
+	if (page)
+		*ret = nb_oper_data_iterate_page(path.c_str(), NULL, 0, page,
+						 get_oper_data_cb, dnode);
+	else
+		*ret = nb_oper_data_iterate(path.c_str(), NULL, 0,
+					    get_oper_data_cb, dnode);
+	if (*ret != NB_OK) {
 		yang_dnode_free(dnode);
 		return NULL;
 	}
@@ -450,9 +560,9 @@ static struct lyd_node *get_dnode_state(const std::string &path)
 	return dnode;
 }
 
-static grpc::Status get_path(frr::DataTree *dt, const std::string &path,
-			     int type, LYD_FORMAT lyd_format,
-			     bool with_defaults)
+// Main pthread: collect the requested data, see get_path_encode().
+static grpc::Status get_path(struct lyd_node **dnodep, const std::string &path,
+			     int type, struct nb_oper_page *page = NULL)
 {
 	struct lyd_node *dnode_config = NULL;
 	struct lyd_node *dnode_state = NULL;
@@ -470,10 +580,16 @@ static grpc::Status get_path(frr::DataTree *dt, const std::string &path,
 	// Operational data.
 	if (type == frr::GetRequest_DataType_ALL
 	    || type == frr::GetRequest_DataType_STATE) {
-		dnode_state = get_dnode_state(path);
+		int ret;
+
+		dnode_state = get_dnode_state(path, page, &ret);
 		if (!dnode_state) {
 			if (dnode_config)
 				yang_dnode_free(dnode_config);
+			if (page && ret == NB_ERR_NOT_FOUND)
+				return grpc::Status(
+					grpc::StatusCode::NOT_FOUND,
+					"Page token no longer valid");
 			return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
 					    "Failed to fetch operational data");
 		}
@@ -506,6 +622,15 @@ static grpc::Status get_path(frr::DataTree *dt, const std::string &path,
 		break;
 	}
 
+	*dnodep = dnode_final;
+	return grpc::Status::OK;
+}
+
+// Any pthread: encode (and free) what get_path() returned.
+static grpc::Status get_path_encode(frr::DataTree *dt,
+				    struct lyd_node *dnode_final, int type,
+				    LYD_FORMAT lyd_format, bool with_defaults)
+{
 	// Validate data to create implicit default nodes if necessary.
 	int validate_opts = 0;
 	if (type == frr::GetRequest_DataType_CONFIG)
@@ -569,14 +694,32 @@ grpc::Status HandleUnaryGetCapabilities(
 }
 
 // Define the context variable type for this streaming handler
-typedef std::list<std::string> GetContextType;
+struct GetContextType {
+	std::list<std::string> paths;
+
+	// Operational data is returned one page per response when paging.
+	bool paged = false;
+	struct nb_oper_page page = {};
+
+	// Collected on the main pthread, to be encoded.
+	struct lyd_node *dnode = NULL;
+	grpc::Status status;
+	std::string next_page_token;
+
+	~GetContextType()
+	{
+		if (dnode)
+			yang_dnode_free(dnode);
+	}
+};
 
 bool HandleStreamingGet(
 	StreamRpcState<frr::GetRequest, frr::GetResponse, GetContextType> *tag)
 {
 	grpc_debug("%s: entered", __func__);
 
-	auto mypathps = &tag->context;
+	auto mypathps = &tag->context.paths;
+	struct nb_oper_page *page = &tag->context.page;
 	if (tag->is_initial_process()) {
 		// Fill our context container first time through
 		grpc_debug("%s: initialize streaming state", __func__);
@@ -584,47 +727,96 @@ bool HandleStreamingGet(
 		for (const std::string &path : paths) {
 			mypathps->push_back(std::string(path));
 		}
+
+		// Request: uint32 page_size = 5;
+		// Request: string page_token = 6;
+		const std::string &token = tag->request.page_token();
+		if (tag->request.page_size() || !token.empty()) {
+			int type = tag->request.type();
+
+			if (type != frr::GetRequest_DataType_STATE
+			    || (!token.empty() && paths.size() != 1)
+			    || token.size() >= sizeof(page->cursor)) {
+				tag->async_responder.Finish(
+					grpc::Status(
+						grpc::StatusCode::
+							INVALID_ARGUMENT,
+						"Paging needs STATE data and one path per page token"),
+					tag);
+				return false;
+			}
+			tag->context.paged = true;
+			page->max_items = tag->request.page_size();
+			strlcpy(page->cursor, token.c_str(),
+				sizeof(page->cursor));
+		}
 	}
 
 	// Request: DataType type = 1;
 	int type = tag->request.type();
-	// Request: Encoding encoding = 2;
-	frr::Encoding encoding = tag->request.encoding();
-	// Request: bool with_defaults = 3;
-	bool with_defaults = tag->request.with_defaults();
 
 	if (mypathps->empty()) {
 		tag->async_responder.Finish(grpc::Status::OK, tag);
 		return false;
 	}
 
-	frr::GetResponse response;
-	grpc::Status status;
+	// The response is encoded and written by HandleStreamingGetEncode().
+	tag->encode_pending = true;
+	tag->context.status =
+		get_path(&tag->context.dnode, mypathps->back().c_str(), type,
+			 tag->context.paged ? page : NULL);
+	if (!tag->context.status.ok())
+		return false;
 
-	// Response: int64 timestamp = 1;
-	response.set_timestamp(time(NULL));
+	if (tag->context.paged && page->cursor[0]) {
+		tag->context.next_page_token = page->cursor;
+		return true;
+	}
+	tag->context.next_page_token.clear();
 
-	// Response: DataTree data = 2;
-	auto *data = response.mutable_data();
-	data->set_encoding(tag->request.encoding());
-	status = get_path(data, mypathps->back().c_str(), type,
-			  encoding2lyd_format(encoding), with_defaults);
+	mypathps->pop_back();
+	return !mypathps->empty();
+}
 
-	if (!status.ok()) {
-		tag->async_responder.WriteAndFinish(
-			response, grpc::WriteOptions(), status, tag);
+bool HandleStreamingGetEncode(
+	StreamRpcState<frr::GetRequest, frr::GetResponse, GetContextType> *tag)
+{
+	struct lyd_node *dnode = tag->context.dnode;
+
+	grpc_debug("%s: entered", __func__);
+
+	// Request: DataType type = 1;
+	int type = tag->request.type();
+	// Request: Encoding encoding = 2;
+	frr::Encoding encoding = tag->request.encoding();
+	// Request: bool with_defaults = 3;
+	bool with_defaults = tag->request.with_defaults();
+
+	tag->context.dnode = NULL;
+
+	// Response: int64 timestamp = 1;
+	tag->response.set_timestamp(time(NULL));
+
+	if (!tag->context.status.ok()) {
+		tag->encode_status = tag->context.status;
 		return false;
 	}
 
-	mypathps->pop_back();
-	if (mypathps->empty()) {
-		tag->async_responder.WriteAndFinish(
-			response, grpc::WriteOptions(), grpc::Status::OK, tag);
+	// Response: DataTree data = 2;
+	auto *data = tag->response.mutable_data();
+	data->set_encoding(encoding);
+	tag->encode_status =
+		get_path_encode(data, dnode, type,
+				encoding2lyd_format(encoding), with_defaults);
+	if (!tag->encode_status.ok())
 		return false;
-	} else {
-		tag->async_responder.Write(response, tag);
-		return true;
-	}
+
+	// Response: string next_page_token = 3;
+	if (!tag->context.next_page_token.empty())
+		tag->response.set_next_page_token(
+			tag->context.next_page_token);
+
+	return tag->get_state() == MORE;
 }
 
 grpc::Status HandleUnaryCreateCandidate(
@@ -1084,6 +1276,135 @@ grpc::Status HandleUnaryExecute(
 	return grpc::Status::OK;
 }
 
+/*
+ * Subscriptions stay open until the client goes away, getting every YANG
+ * notification sent under one of the requested paths.  Notifications are
+ * written from the main pthread (see frr_grpc_notification_send()), one at a
+ * time; the completion of each write runs HandleStreamingSubscribe(), which
+ * writes the next one.
+ *
+ * The subscriber list is locked because subscriptions are deleted on the
+ * grpc-io-thread once a write fails.  A subscriber that goes away while
+ * nothing is queued for it is only noticed with the next notification.
+ */
+struct SubscribeContextType;
+
+static pthread_mutex_t s_subscribers_lock = PTHREAD_MUTEX_INITIALIZER;
+static std::list<SubscribeContextType *> s_subscribers;
+
+struct SubscribeContextType {
+	std::list<std::string> paths;
+
+	// Front is being written if writing is set.
+	std::list<frr::SubscribeResponse> queue;
+	bool writing = false;
+
+	grpc::ServerAsyncWriter<frr::SubscribeResponse> *writer = NULL;
+	void *tag = NULL;
+
+	bool match(const char *xpath) const
+	{
+		if (paths.empty())
+			return true;
+		for (const std::string &path : paths)
+			if (!strncmp(xpath, path.c_str(), path.size()))
+				return true;
+		return false;
+	}
+
+	// Main pthread.
+	void write_next(void)
+	{
+		if (writing || queue.empty())
+			return;
+		writing = true;
+		writer->Write(queue.front(), tag);
+	}
+
+	~SubscribeContextType()
+	{
+		pthread_mutex_lock(&s_subscribers_lock);
+		s_subscribers.remove(this);
+		pthread_mutex_unlock(&s_subscribers_lock);
+	}
+};
+
+bool HandleStreamingSubscribe(
+	StreamRpcState<frr::SubscribeRequest, frr::SubscribeResponse,
+		       SubscribeContextType> *tag)
+{
+	auto sub = &tag->context;
+
+	grpc_debug("%s: entered", __func__);
+
+	if (tag->is_initial_process()) {
+		// Request: repeated string path = 1;
+		for (const std::string &path : tag->request.path())
+			sub->paths.push_back(path);
+
+		sub->writer = &tag->async_responder;
+		sub->tag = tag;
+		pthread_mutex_lock(&s_subscribers_lock);
+		s_subscribers.push_back(sub);
+		pthread_mutex_unlock(&s_subscribers_lock);
+		return true;
+	}
+
+	// A write is done.
+	sub->queue.pop_front();
+	sub->writing = false;
+	sub->write_next();
+	return true;
+}
+
+static int frr_grpc_notification_send(const char *xpath,
+				      struct list *arguments)
+{
+	frr::SubscribeResponse response;
+	struct yang_data *data;
+	struct listnode *node;
+	bool running;
+
+	pthread_mutex_lock(&s_server_lock);
+	running = grpc_running;
+	pthread_mutex_unlock(&s_server_lock);
+	if (!running)
+		return NB_OK;
+
+	// Response: int64 timestamp = 1;
+	response.set_timestamp(time(NULL));
+
+	// Response: string path = 2;
+	response.set_path(xpath);
+
+	// Response: repeated PathValue arguments = 3;
+	if (arguments) {
+		for (ALL_LIST_ELEMENTS_RO(arguments, node, data)) {
+			frr::PathValue *pv = response.add_arguments();
+
+			pv->set_path(data->xpath);
+			if (data->value)
+				pv->set_value(data->value);
+		}
+	}
+
+	pthread_mutex_lock(&s_subscribers_lock);
+	for (SubscribeContextType *sub : s_subscribers) {
+		if (!sub->match(xpath))
+			continue;
+		if (sub->queue.size() >= GRPC_SUBSCRIBE_QUEUE_MAX) {
+			grpc_debug("%s: subscriber %p is behind, dropped %s",
+				   __func__, sub, xpath);
+			continue;
+		}
+		sub->queue.push_back(response);
+		sub->write_next();
+	}
+	pthread_mutex_unlock(&s_subscribers_lock);
+
+	return NB_OK;
+}
+
 // ------------------------------------------------------
 //        Thread Initialization and Run Functions
 // ------------------------------------------------------
@@ -1108,15 +1429,34 @@ grpc::Status HandleUnaryExecute(
 		_rpcState->do_request(&service, cq.get(), true);               \
 	} while (0)
 
+// Streaming RPC with responses encoded off the main pthread
+#define REQUEST_NEWRPC_STREAMING_ENCODE(NAME)                                  \
+	do {                                                                   \
+		auto _rpcState = new StreamRpcState<frr::NAME##Request,        \
+						    frr::NAME##Response,       \
+						    NAME##ContextType>(        \
+			&frr::Northbound::AsyncService::Request##NAME,         \
+			&HandleStreaming##NAME, #NAME,                         \
+			&HandleStreaming##NAME##Encode);                       \
+		_rpcState->do_request(&service, cq.get(), true);               \
+	} while (0)
+
+// Streaming RPC that stays open, any number of them at a time
+#define REQUEST_NEWRPC_STREAMING_CONCURRENT(NAME)                              \
+	do {                                                                   \
+		auto _rpcState = new StreamRpcState<frr::NAME##Request,        \
+						    frr::NAME##Response,       \
+						    NAME##ContextType>(        \
+			&frr::Northbound::AsyncService::Request##NAME,         \
+			&HandleStreaming##NAME, #NAME, NULL, true);            \
+		_rpcState->do_request(&service, cq.get(), true);               \
+	} while (0)
+
 struct grpc_pthread_attr {
 	struct frr_pthread_attr attr;
 	unsigned long port;
 };
 
-// Capture these objects so we can try to shut down cleanly
-static pthread_mutex_t s_server_lock = PTHREAD_MUTEX_INITIALIZER;
-static grpc::Server *s_server;
-
 static void *grpc_pthread_start(void *arg)
 {
 	struct frr_pthread *fpt = static_cast<frr_pthread *>(arg);
@@ -1129,6 +1469,16 @@ static void *grpc_pthread_start(void *arg)
 
 	frr_pthread_set_name(fpt);
 
+	for (uint i = 0; i < GRPC_ENCODE_THREADS; i++) {
+		char name[32], os_name[OS_THREAD_NAMELEN];
+
+		snprintf(name, sizeof(name), "gRPC encoder %u", i);
+		snprintf(os_name, sizeof(os_name), "grpc-enc%u", i);
+		encode_fpts[i] = frr_pthread_new(NULL, name, os_name);
+		frr_pthread_run(encode_fpts[i], NULL);
+		frr_pthread_wait_running(encode_fpts[i]);
+	}
+
 	server_address << "0.0.0.0:" << port;
 	builder.AddListeningPort(server_address.str(),
 				 grpc::InsecureServerCredentials());
@@ -1158,8 +1508,9 @@ static void *grpc_pthread_start(void *arg)
 	REQUEST_NEWRPC(Execute, NULL);
 
 	/* Schedule streaming RPC handlers */
-	REQUEST_NEWRPC_STREAMING(Get);
+	REQUEST_NEWRPC_STREAMING_ENCODE(Get);
 	REQUEST_NEWRPC_STREAMING(ListTransactions);
+	REQUEST_NEWRPC_STREAMING_CONCURRENT(Subscribe);
 
 	zlog_notice("gRPC server listening on %s",
 		    server_address.str().c_str());
@@ -1176,12 +1527,29 @@ static void *grpc_pthread_start(void *arg)
 		grpc_debug("%s: got next from CQ tag: %p ok: %d", __func__, tag,
 			   ok);
 
+		RpcStateBase *rpc = static_cast<RpcStateBase *>(tag);
 		if (!ok) {
-			delete static_cast<RpcStateBase *>(tag);
-			break;
+			bool running;
+
+			pthread_mutex_lock(&s_server_lock);
+			running = grpc_running;
+			pthread_mutex_unlock(&s_server_lock);
+			if (!running) {
+				delete rpc;
+				break;
+			}
+
+			/*
+			 * The client went away while a response was being
+			 * written, keep accepting RPCs of this type.
+			 */
+			grpc_debug("%s RPC: client gone [delete]", rpc->name);
+			if (rpc->get_state() == MORE && !rpc->concurrent)
+				rpc->do_request(&service, cq.get(), false);
+			delete rpc;
+			continue;
 		}
 
-		RpcStateBase *rpc = static_cast<RpcStateBase *>(tag);
 		if (rpc->get_state() != FINISH)
 			rpc->run(&service, cq.get());
 		else {
@@ -1209,6 +1577,12 @@ static void *grpc_pthread_start(void *arg)
 		delete static_cast<RpcStateBase *>(tag);
 	}
 
+	for (uint i = 0; i < GRPC_ENCODE_THREADS; i++) {
+		frr_pthread_stop(encode_fpts[i], NULL);
+		frr_pthread_destroy(encode_fpts[i]);
+		encode_fpts[i] = NULL;
+	}
+
 	zlog_info("%s: exiting from grpc pthread", __func__);
 	return NULL;
 }
@@ -1251,7 +1625,8 @@ static int frr_grpc_finish(void)
 	grpc_running = false;
 	if (s_server) {
 		grpc_debug("%s: shutdown server", __func__);
-		s_server->Shutdown();
+		// Don't wait for subscriptions, they never end on their own.
+		s_server->Shutdown(std::chrono::system_clock::now());
 		s_server = NULL;
 	}
 	pthread_mutex_unlock(&s_server_lock);
@@ -1302,6 +1677,7 @@ static int frr_grpc_module_late_init(struct event_loop *tm)
 {
 	main_master = tm;
 	hook_register(frr_fini, frr_grpc_finish);
+	hook_register(nb_notification_send, frr_grpc_notification_send);
 	event_add_event(tm, frr_grpc_module_very_late_init, NULL, 0, NULL);
 	return 0;
 }
@@ -23,6 +23,7 @@ DEFINE_MTYPE_STATIC(LIB, PREFIX_LIST, "Prefix List");
 DEFINE_MTYPE_STATIC(LIB, MPREFIX_LIST_STR, "Prefix List Str");
 DEFINE_MTYPE_STATIC(LIB, PREFIX_LIST_ENTRY, "Prefix List Entry");
 DEFINE_MTYPE_STATIC(LIB, PREFIX_LIST_TRIE, "Prefix List Trie Table");
+DEFINE_MTYPE_STATIC(LIB, PREFIX_LIST_COMPILED, "Prefix List Compiled Trie");
 
 /* not currently changeable, code assumes bytes further down */
 #define PLC_BITS	8
@@ -44,6 +45,72 @@ struct pltrie_table {
 	struct pltrie_entry entries[PLC_LEN];
 };
 
+/*
+ * Compiled lookup structure.
+ *
+ * The byte trie above keeps one next_best chain per trie slot, and lists
+ * with many overlapping ge/le entries end up with long chains that
+ * prefix_list_apply_ext() has to scan entry by entry.  Once a list has
+ * been looked up often enough since its last change, it is compiled into
+ * a path-compressed binary trie held in two flat arrays.  Each node has
+ * its entries sorted by sequence number plus the lowest sequence number
+ * anywhere below it, so a lookup is a single walk down the prefix bits
+ * that stops as soon as nothing below can beat the current best match.
+ *
+ * Any change to the list throws the compiled trie away; it is rebuilt
+ * after another count / PLC_COMPILE_RATIO lookups, which keeps the cost
+ * of rebuilding proportional to the lookups made while the list is
+ * being edited.
+ */
+#define PLC_COMPILE_MIN		64	/* smaller lists use the byte trie */
+#define PLC_COMPILE_RATIO	8
+
+struct plc_entry {
+	int64_t seq;
+	struct prefix_list_entry *pentry;
+	uint8_t ge;
+	uint8_t le;
+	uint8_t exact;
+};
+
+struct plc_node {
+	uint8_t key[16];
+	uint8_t len;
+
+	/* 0 is the root and therefore never anybody's child */
+	uint32_t child[2];
+
+	uint32_t ent_first;
+	uint32_t ent_count;
+
+	/* lowest sequence number in this node and below */
+	int64_t min_seq;
+};
+
+struct plc_trie {
+	uint8_t family;
+	uint32_t node_count;
+	struct plc_node *nodes;
+	struct plc_entry *entries;
+};
+
+static bool plc_enabled = true;
+
+static void plc_free(struct prefix_list *plist)
+{
+	struct plc_trie *trie = plist->compiled;
+
+	plist->lookups_since_change = 0;
+	plist->compile_failed = false;
+
+	if (!trie)
+		return;
+
+	XFREE(MTYPE_PREFIX_LIST_COMPILED, trie->nodes);
+	XFREE(MTYPE_PREFIX_LIST_COMPILED, trie->entries);
+	XFREE(MTYPE_PREFIX_LIST_COMPILED, plist->compiled);
+}
+
 /* Master structure of prefix_list. */
 struct prefix_master {
 	/* The latest update. */
@@ -243,6 +310,7 @@ void prefix_list_delete(struct prefix_list *plist)
 	XFREE(MTYPE_MPREFIX_LIST_STR, plist->name);
 
 	XFREE(MTYPE_PREFIX_LIST_TRIE, plist->trie);
+	plc_free(plist);
 
 	prefix_list_free(plist);
 }
@@ -382,6 +450,8 @@ static void prefix_list_trie_del(struct prefix_list *plist,
 	size_t validbits = pentry->prefix.prefixlen;
 	struct pltrie_table *table, **tables[PLC_MAXLEVEL];
 
+	plc_free(plist);
+
 	table = plist->trie;
 	for (depth = 0; validbits > PLC_BITS && depth < maxdepth - 1; depth++) {
 		uint8_t byte = bytes[depth];
@@ -471,6 +541,8 @@ static void prefix_list_trie_add(struct prefix_list *plist,
 	size_t validbits = pentry->prefix.prefixlen;
 	struct pltrie_table *table;
 
+	plc_free(plist);
+
 	table = plist->trie;
 	while (validbits > PLC_BITS && depth > 1) {
 		if (!table->entries[*bytes].next_table)
@@ -719,6 +791,228 @@ static int prefix_list_entry_match(struct prefix_list_entry *pentry,
 	return 1;
 }
 
+static inline unsigned int plc_bit(const uint8_t *key, unsigned int bit)
+{
+	return (key[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+/* number of leading bits a and b have in common, at most maxlen */
+static unsigned int plc_common(const uint8_t *a, const uint8_t *b,
+			       unsigned int maxlen)
+{
+	unsigned int i = 0;
+
+	while (i + 8 <= maxlen && a[i >> 3] == b[i >> 3])
+		i += 8;
+	while (i < maxlen && plc_bit(a, i) == plc_bit(b, i))
+		i++;
+	return i;
+}
+
+static uint32_t plc_node_new(struct plc_trie *trie, const uint8_t *key,
+			     unsigned int len)
+{
+	struct plc_node *node = &trie->nodes[trie->node_count];
+	unsigned int bytes = len / 8;
+
+	memcpy(node->key, key, bytes);
+	if (len % 8)
+		node->key[bytes] = key[bytes] & (0xff << (8 - len % 8));
+	node->len = len;
+	node->min_seq = INT64_MAX;
+
+	return trie->node_count++;
+}
+
+static uint32_t plc_node_get(struct plc_trie *trie, const uint8_t *key,
+			     unsigned int len)
+{
+	uint32_t cur = 0, c, n, g;
+	unsigned int bit, common;
+
+	while (trie->nodes[cur].len != len) {
+		bit = plc_bit(key, trie->nodes[cur].len);
+		c = trie->nodes[cur].child[bit];
+		if (!c) {
+			n = plc_node_new(trie, key, len);
+			trie->nodes[cur].child[bit] = n;
+			return n;
+		}
+
+		common = plc_common(key, trie->nodes[c].key,
+				    MIN(len, trie->nodes[c].len));
+		if (common == trie->nodes[c].len) {
+			cur = c;
+			continue;
+		}
+
+		/* key sits between cur and c, or forks off c's path */
+		g = plc_node_new(trie, key, common);
+		trie->nodes[g].child[plc_bit(trie->nodes[c].key, common)] = c;
+		trie->nodes[cur].child[bit] = g;
+		if (common == len)
+			return g;
+
+		n = plc_node_new(trie, key, len);
+		trie->nodes[g].child[plc_bit(key, common)] = n;
+		return n;
+	}
+	return cur;
+}
+
+static int64_t plc_min_seq(struct plc_trie *trie, uint32_t idx)
+{
+	struct plc_node *node = &trie->nodes[idx];
+	int64_t seq = INT64_MAX, below;
+	unsigned int i;
+
+	if (node->ent_count)
+		seq = trie->entries[node->ent_first].seq;
+	for (i = 0; i < 2; i++) {
+		if (!node->child[i])
+			continue;
+		below = plc_min_seq(trie, node->child[i]);
+		if (below < seq)
+			seq = below;
+	}
+
+	node->min_seq = seq;
+	return seq;
+}
+
+static void plc_compile(struct prefix_list *plist)
+{
+	struct plc_trie *trie;
+	struct prefix_list_entry *pentry;
+	struct plc_entry *ent;
+	struct plc_node *node;
+	uint32_t *slot, i, pos;
+	uint8_t family = plist->head->prefix.family;
+
+	for (pentry = plist->head; pentry; pentry = pentry->next)
+		if (pentry->prefix.family != family
+		    || (family != AF_INET && family != AF_INET6)) {
+			plist->compile_failed = true;
+			return;
+		}
+
+	trie = XCALLOC(MTYPE_PREFIX_LIST_COMPILED, sizeof(*trie));
+	trie->family = family;
+	/* every insertion adds at most two nodes */
+	trie->nodes = XCALLOC(MTYPE_PREFIX_LIST_COMPILED,
+			      sizeof(*trie->nodes) * (2 * plist->count + 1));
+	trie->entries = XCALLOC(MTYPE_PREFIX_LIST_COMPILED,
+				sizeof(*trie->entries) * plist->count);
+	slot = XCALLOC(MTYPE_TMP, sizeof(*slot) * plist->count);
+
+	plc_node_new(trie, plist->head->prefix.u.val, 0);
+
+	i = 0;
+	for (pentry = plist->head; pentry; pentry = pentry->next) {
+		slot[i] = plc_node_get(trie, pentry->prefix.u.val,
+				       pentry->prefix.prefixlen);
+		trie->nodes[slot[i]].ent_count++;
+		i++;
+	}
+
+	pos = 0;
+	for (i = 0; i < trie->node_count; i++) {
+		node = &trie->nodes[i];
+		node->ent_first = pos;
+		pos += node->ent_count;
+		node->ent_count = 0;
+	}
+
+	/* plist->head is ordered by seq, so each node's run is as well */
+	i = 0;
+	for (pentry = plist->head; pentry; pentry = pentry->next) {
+		node = &trie->nodes[slot[i++]];
+		ent = &trie->entries[node->ent_first + node->ent_count++];
+		ent->seq = pentry->seq;
+		ent->pentry = pentry;
+		ent->ge = pentry->ge;
+		ent->le = pentry->le;
+		ent->exact = !pentry->le && !pentry->ge;
+	}
+
+	XFREE(MTYPE_TMP, slot);
+
+	plc_min_seq(trie, 0);
+	plist->compiled = trie;
+}
+
+static struct prefix_list_entry *plc_lookup(const struct plc_trie *trie,
+					    const struct prefix *p,
+					    bool address_mode)
+{
+	const struct plc_node *node = &trie->nodes[0];
+	const struct plc_entry *ent, *end;
+	struct prefix_list_entry *pbest = NULL;
+	int64_t best_seq = INT64_MAX;
+	const uint8_t *key = p->u.val;
+	unsigned int plen = p->prefixlen;
+	uint32_t idx;
+
+	if (p->family != trie->family)
+		return NULL;
+
+	while (node->min_seq < best_seq) {
+		ent = &trie->entries[node->ent_first];
+		for (end = ent + node->ent_count; ent < end; ent++) {
+			if (ent->seq >= best_seq)
+				break;
+			if (!address_mode) {
+				if (ent->exact) {
+					if (plen != node->len)
+						continue;
+				} else if ((ent->le && plen > ent->le)
+					   || (ent->ge && plen < ent->ge))
+					continue;
+			}
+			pbest = ent->pentry;
+			best_seq = ent->seq;
+			break;
+		}
+
+		if (node->len >= plen)
+			break;
+		idx = node->child[plc_bit(key, node->len)];
+		if (!idx)
+			break;
+		node = &trie->nodes[idx];
+		if (node->len > plen
+		    || plc_common(node->key, key, node->len) != node->len)
+			break;
+	}
+	return pbest;
+}
+
+void prefix_list_compile(struct prefix_list *plist)
+{
+	if (!plist->compiled && !plist->compile_failed && plist->head)
+		plc_compile(plist);
+}
+
+void prefix_list_compile_enable(bool enable)
+{
+	plc_enabled = enable;
+}
+
+/* decide whether this lookup should go through the compiled trie */
+static bool plc_wanted(struct prefix_list *plist)
+{
+	if (plist->compiled)
+		return true;
+	if (plist->compile_failed || plist->count < PLC_COMPILE_MIN)
+		return false;
+	if (++plist->lookups_since_change
+	    < (unsigned int)plist->count / PLC_COMPILE_RATIO)
+		return false;
+
+	plc_compile(plist);
+	return plist->compiled != NULL;
+}
+
 enum prefix_list_type prefix_list_apply_ext(
 	struct prefix_list *plist,
 	const struct prefix_list_entry **which,
@@ -745,6 +1039,11 @@ enum prefix_list_type prefix_list_apply_ext(
 		return PREFIX_PERMIT;
 	}
 
+	if (plc_enabled && plc_wanted(plist)) {
+		pbest = plc_lookup(plist->compiled, p, address_mode);
+		goto done;
+	}
+
 	depth = plist->master->trie_depth;
 	table = plist->trie;
 	while (1) {
@@ -779,6 +1078,7 @@ enum prefix_list_type prefix_list_apply_ext(
 		break;
 	}
 
+done:
 	if (which) {
 		if (pbest)
 			*which = pbest;
@@ -916,6 +1216,9 @@ static void vty_show_prefix_entry(struct vty *vty, json_object *json, afi_t afi,
 					    plist->head ? plist->head->seq : 0);
 			json_object_int_add(json_pl, "sequenceEnd",
 					    plist->tail ? plist->tail->seq : 0);
+			if (plist->compiled)
+				json_object_int_add(json_pl, "compiledNodes",
+						    plist->compiled->node_count);
 		} else {
 			vty_out(vty, "ip%s prefix-list %s:\n",
 				afi == AFI_IP ? "" : "v6", plist->name);
@@ -930,6 +1233,9 @@ static void vty_show_prefix_entry(struct vty *vty, json_object *json, afi_t afi,
 				plist->count, plist->rangecount,
 				plist->head ? plist->head->seq : 0,
 				plist->tail ? plist->tail->seq : 0);
+			if (plist->compiled)
+				vty_out(vty, "   compiled lookup: %u nodes\n",
+					plist->compiled->node_count);
 		}
 	}
 
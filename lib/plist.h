@@ -62,6 +62,15 @@ prefix_list_apply_ext(struct prefix_list *plist,
 #define prefix_list_apply(A, B) \
 	prefix_list_apply_ext((A), NULL, (B), false)
 
+/*
+ * Large prefix-lists are compiled into a faster lookup structure once they
+ * have been stable for a while.  prefix_list_compile() does that right away,
+ * e.g. after bulk loading a list; prefix_list_compile_enable(false) makes
+ * lookups use the incremental trie only.
+ */
+extern void prefix_list_compile(struct prefix_list *plist);
+extern void prefix_list_compile_enable(bool enable);
+
 extern struct prefix_list *prefix_bgp_orf_lookup(afi_t, const char *);
 extern struct stream *prefix_bgp_orf_entry(struct stream *,
 					   struct prefix_list *, uint8_t,
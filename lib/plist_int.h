@@ -12,6 +12,7 @@ extern "C" {
 #endif
 
 struct pltrie_table;
+struct plc_trie;
 
 PREDECL_RBTREE_UNIQ(plist);
 
@@ -30,6 +31,11 @@ struct prefix_list {
 	struct prefix_list_entry *tail;
 
 	struct pltrie_table *trie;
+
+	/* compiled lookup structure, built on demand, see plist.c */
+	struct plc_trie *compiled;
+	unsigned int lookups_since_change;
+	bool compile_failed;
 };
 
 /* Each prefix-list's entry. */
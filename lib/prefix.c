@@ -32,6 +32,55 @@ static const uint8_t maskbit[] = {0x00, 0x80, 0xc0, 0xe0, 0xf0,
 
 #define MASKBIT(offset)  ((0xff << (PNBBY - (offset))) & 0xff)
 
+/*
+ * Word-at-a-time helpers for the IPv4/IPv6 fast paths below.  Addresses are
+ * loaded as native endian words (memcpy() compiles to plain loads and avoids
+ * alignment/aliasing trouble) and masked with masks in network byte order,
+ * so byte swapping is only needed where the order matters (prefix_cmp).
+ * An IPv6 address is handled as 2 64-bit words, which the compiler turns
+ * into SSE/NEON operations where that is worth it.
+ */
+static inline uint64_t pfx_load64(const uint8_t *p)
+{
+	uint64_t val;
+
+	memcpy(&val, p, sizeof(val));
+	return val;
+}
+
+static inline void pfx_store64(uint8_t *p, uint64_t val)
+{
+	memcpy(p, &val, sizeof(val));
+}
+
+static inline uint64_t pfx_ntoh64(uint64_t val)
+{
+#if BYTE_ORDER == LITTLE_ENDIAN
+	return __builtin_bswap64(val);
+#else
+	return val;
+#endif
+}
+
+/* mask for the first bits (0-32) of an IPv4 address, network byte order */
+static inline uint32_t pfx_mask32(unsigned int bits)
+{
+	return bits ? htonl(0xffffffffU << (32 - bits)) : 0;
+}
+
+/* mask for the first bits (0-64) of a 64-bit word, network byte order */
+static inline uint64_t pfx_mask64(unsigned int bits)
+{
+	return bits ? pfx_ntoh64(UINT64_MAX << (64 - bits)) : 0;
+}
+
+/* split an IPv6 prefix length (0-128) into the masks for its 2 words */
+static inline void pfx_mask128(unsigned int bits, uint64_t *m0, uint64_t *m1)
+{
+	*m0 = pfx_mask64(MIN(bits, 64U));
+	*m1 = pfx_mask64(bits > 64 ? bits - 64 : 0);
+}
+
 int is_zero_mac(const struct ethaddr *mac)
 {
 	int i = 0;
@@ -221,6 +270,18 @@ int prefix_match(union prefixconstptr unet, union prefixconstptr upfx)
 	np = n->u.val;
 	pp = p->u.val;
 
+	if (n->family == AF_INET && n->prefixlen <= IPV4_MAX_BITLEN)
+		return !((n->u.prefix4.s_addr ^ p->u.prefix4.s_addr) &
+			 pfx_mask32(n->prefixlen));
+
+	if (n->family == AF_INET6 && n->prefixlen <= IPV6_MAX_BITLEN) {
+		uint64_t m0, m1;
+
+		pfx_mask128(n->prefixlen, &m0, &m1);
+		return !(((pfx_load64(np) ^ pfx_load64(pp)) & m0) |
+			 ((pfx_load64(np + 8) ^ pfx_load64(pp + 8)) & m1));
+	}
+
 	offset = n->prefixlen / PNBBY;
 	shift = n->prefixlen % PNBBY;
 
@@ -379,8 +440,9 @@ int prefix_same(union prefixconstptr up1, union prefixconstptr up2)
 			if (IPV4_ADDR_SAME(&p1->u.prefix4, &p2->u.prefix4))
 				return 1;
 		if (p1->family == AF_INET6)
-			if (IPV6_ADDR_SAME(&p1->u.prefix6.s6_addr,
-					   &p2->u.prefix6.s6_addr))
+			if (pfx_load64(p1->u.val) == pfx_load64(p2->u.val) &&
+			    pfx_load64(p1->u.val + 8) ==
+				    pfx_load64(p2->u.val + 8))
 				return 1;
 		if (p1->family == AF_ETHERNET)
 			if (!memcmp(&p1->u.prefix_eth, &p2->u.prefix_eth,
@@ -455,6 +517,28 @@ int prefix_cmp(union prefixconstptr up1, union prefixconstptr up2)
 
 	if (p1->prefixlen != p2->prefixlen)
 		return numcmp(p1->prefixlen, p2->prefixlen);
+
+	if (p1->family == AF_INET && p1->prefixlen <= IPV4_MAX_BITLEN) {
+		uint32_t mask = pfx_mask32(p1->prefixlen);
+
+		return numcmp(ntohl(p1->u.prefix4.s_addr & mask),
+			      ntohl(p2->u.prefix4.s_addr & mask));
+	}
+
+	if (p1->family == AF_INET6 && p1->prefixlen <= IPV6_MAX_BITLEN) {
+		uint64_t m0, m1, a, b;
+
+		pfx_mask128(p1->prefixlen, &m0, &m1);
+		a = pfx_ntoh64(pfx_load64(pp1) & m0);
+		b = pfx_ntoh64(pfx_load64(pp2) & m0);
+		if (a != b)
+			return numcmp(a, b);
+
+		a = pfx_ntoh64(pfx_load64(pp1 + 8) & m1);
+		b = pfx_ntoh64(pfx_load64(pp2 + 8) & m1);
+		return numcmp(a, b);
+	}
+
 	offset = p1->prefixlen / PNBBY;
 	shift = p1->prefixlen % PNBBY;
 
@@ -815,6 +899,16 @@ void apply_mask_ipv6(struct prefix_ipv6 *p)
 	int index;
 	int offset;
 
+	if (p->prefixlen <= IPV6_MAX_BITLEN) {
+		uint64_t m0, m1;
+
+		pnt = (uint8_t *)&p->prefix;
+		pfx_mask128(p->prefixlen, &m0, &m1);
+		pfx_store64(pnt, pfx_load64(pnt) & m0);
+		pfx_store64(pnt + 8, pfx_load64(pnt + 8) & m1);
+		return;
+	}
+
 	index = p->prefixlen / 8;
 
 	if (index < 16) {
@@ -1287,9 +1381,10 @@ char *prefix_mac2str(const struct ethaddr *mac, char *buf, int size)
 
 unsigned prefix_hash_key(const void *pp)
 {
+	const struct prefix *p = pp;
 	struct prefix copy;
 
-	if (((struct prefix *)pp)->family == AF_FLOWSPEC) {
+	if (p->family == AF_FLOWSPEC) {
 		uint32_t len;
 		void *temp;
 
@@ -1307,6 +1402,24 @@ unsigned prefix_hash_key(const void *pp)
 		copy.u.prefix_flowspec.ptr = (uintptr_t)NULL;
 		return len;
 	}
+
+	/*
+	 * Same bytes as below without going through prefix_copy(); only the
+	 * first PSIZE(prefixlen) bytes of the address are hashed.  Don't copy
+	 * more than that, callers may pass a struct prefix_ipv4.
+	 */
+	if ((p->family == AF_INET && p->prefixlen <= IPV4_MAX_BITLEN) ||
+	    (p->family == AF_INET6 && p->prefixlen <= IPV6_MAX_BITLEN)) {
+		memset(&copy, 0, sizeof(copy));
+		copy.family = p->family;
+		copy.prefixlen = p->prefixlen;
+		memcpy(copy.u.val, p->u.val, PSIZE(p->prefixlen));
+		return jhash(&copy,
+			     offsetof(struct prefix, u.prefix) +
+				     PSIZE(copy.prefixlen),
+			     0x55aa5a5a);
+	}
+
 	/* make sure *all* unused bits are zero, particularly including
 	 * alignment /
 	 * padding and unused prefix bytes. */
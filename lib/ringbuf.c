@@ -58,6 +58,35 @@ size_t ringbuf_put(struct ringbuf *buf, const void *data, size_t size)
 	return copysize;
 }
 
+int ringbuf_space_iov(struct ringbuf *buf, struct iovec iov[2])
+{
+	size_t space = ringbuf_space(buf);
+	size_t tail = MIN(space, buf->size - buf->end);
+
+	if (!space)
+		return 0;
+
+	iov[0].iov_base = buf->data + buf->end;
+	iov[0].iov_len = tail;
+	if (tail == space)
+		return 1;
+
+	iov[1].iov_base = buf->data;
+	iov[1].iov_len = space - tail;
+	return 2;
+}
+
+void ringbuf_commit(struct ringbuf *buf, size_t size)
+{
+	assert(size <= ringbuf_space(buf));
+
+	if (!size)
+		return;
+
+	buf->end = (buf->end + size) % buf->size;
+	buf->empty = false;
+}
+
 size_t ringbuf_get(struct ringbuf *buf, void *data, size_t size)
 {
 	uint8_t *dp = data;
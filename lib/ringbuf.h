@@ -64,6 +64,24 @@ size_t ringbuf_space(struct ringbuf *buf);
  */
 size_t ringbuf_put(struct ringbuf *buf, const void *data, size_t size);
 
+/*
+ * Get the free space of the buffer as (up to) two iovecs, so it can be
+ * written to directly, e.g. with readv(). Data written there only becomes
+ * part of the buffer after ringbuf_commit().
+ *
+ * @param iov	array of two iovecs to fill in
+ * @return number of iovecs filled in; 0 if the buffer is full
+ */
+int ringbuf_space_iov(struct ringbuf *buf, struct iovec iov[2]);
+
+/*
+ * Add data written directly into the space returned by ringbuf_space_iov()
+ * to the buffer.
+ *
+ * @param size	how much data was written; must not exceed ringbuf_space()
+ */
+void ringbuf_commit(struct ringbuf *buf, size_t size);
+
 /*
  * Get data from the ring buffer.
  *
@@ -31,6 +31,7 @@ DEFINE_MTYPE_STATIC(LIB, ROUTE_MAP_RULE_STR, "Route map rule str");
 DEFINE_MTYPE(LIB, ROUTE_MAP_COMPILED, "Route map compiled");
 DEFINE_MTYPE_STATIC(LIB, ROUTE_MAP_DEP, "Route map dependency");
 DEFINE_MTYPE_STATIC(LIB, ROUTE_MAP_DEP_DATA, "Route map dependency data");
+DEFINE_MTYPE_STATIC(LIB, ROUTE_MAP_MEMO, "Route map memoized results");
 
 DEFINE_QOBJ_TYPE(route_map_index);
 DEFINE_QOBJ_TYPE(route_map);
@@ -707,6 +708,7 @@ static void route_map_free_map(struct route_map *map)
 		list->head = map->next;
 
 	hash_release(route_map_master_hash, map);
+	XFREE(MTYPE_ROUTE_MAP_MEMO, map->memo);
 	XFREE(MTYPE_ROUTE_MAP_NAME, map->name);
 	XFREE(MTYPE_ROUTE_MAP, map);
 }
@@ -770,6 +772,93 @@ struct route_map *route_map_lookup_warn_noexist(struct vty *vty, const char *nam
 	return route_map;
 }
 
+static uint32_t route_map_rules_hash(const struct route_map_rule_list *list,
+				     uint32_t key)
+{
+	const struct route_map_rule *rule;
+
+	for (rule = list->head; rule; rule = rule->next) {
+		key = jhash(rule->cmd->str, strlen(rule->cmd->str), key);
+		if (rule->rule_str)
+			key = jhash(rule->rule_str, strlen(rule->rule_str),
+				    key);
+	}
+	return key;
+}
+
+static bool route_map_rules_same(const struct route_map_rule_list *l1,
+				 const struct route_map_rule_list *l2)
+{
+	const struct route_map_rule *r1, *r2;
+
+	for (r1 = l1->head, r2 = l2->head; r1 && r2;
+	     r1 = r1->next, r2 = r2->next) {
+		if (r1->cmd != r2->cmd)
+			return false;
+		if (!!r1->rule_str != !!r2->rule_str)
+			return false;
+		if (r1->rule_str && strcmp(r1->rule_str, r2->rule_str))
+			return false;
+	}
+	return !r1 && !r2;
+}
+
+uint32_t route_map_content_hash(const char *name)
+{
+	struct route_map *map = route_map_lookup_by_name(name);
+	struct route_map_index *index;
+	uint32_t key = 0xd1f4a3b5;
+
+	if (!map)
+		return name ? 1 : 0;
+
+	for (index = map->head; index; index = index->next) {
+		key = jhash_3words(index->pref, index->type, index->exitpolicy,
+				   key);
+		key = jhash_1word(index->nextpref, key);
+		if (index->nextrm)
+			key = jhash(index->nextrm, strlen(index->nextrm), key);
+		key = route_map_rules_hash(&index->match_list, key);
+		key = route_map_rules_hash(&index->set_list, key);
+	}
+	return key;
+}
+
+bool route_map_content_same(const char *name1, const char *name2)
+{
+	struct route_map *m1, *m2;
+	struct route_map_index *i1, *i2;
+
+	if (!name1 || !name2)
+		return !name1 && !name2;
+	if (!strcmp(name1, name2))
+		return true;
+
+	/* two references to maps that don't exist (yet) can't be told apart
+	 * once one of them is created, so keep them separate
+	 */
+	m1 = route_map_lookup_by_name(name1);
+	m2 = route_map_lookup_by_name(name2);
+	if (!m1 || !m2)
+		return false;
+
+	for (i1 = m1->head, i2 = m2->head; i1 && i2;
+	     i1 = i1->next, i2 = i2->next) {
+		if (i1->pref != i2->pref || i1->type != i2->type
+		    || i1->exitpolicy != i2->exitpolicy
+		    || i1->nextpref != i2->nextpref)
+			return false;
+		if (!!i1->nextrm != !!i2->nextrm)
+			return false;
+		if (i1->nextrm && strcmp(i1->nextrm, i2->nextrm))
+			return false;
+		if (!route_map_rules_same(&i1->match_list, &i2->match_list)
+		    || !route_map_rules_same(&i1->set_list, &i2->set_list))
+			return false;
+	}
+	return !i1 && !i2;
+}
+
 int route_map_mark_updated(const char *name)
 {
 	struct route_map *map;
@@ -903,6 +992,17 @@ static void vty_show_route_map_entry(struct vty *vty, struct route_map *map,
 					map->optimization_disabled);
 		json_object_boolean_add(json_rmap, "processedChange",
 					map->to_be_processed);
+		if (map->memo_hits || map->memo_misses) {
+			json_object_int_add(json_rmap, "memoHits",
+					    map->memo_hits);
+			json_object_int_add(json_rmap, "memoMisses",
+					    map->memo_misses);
+			json_object_int_add(json_rmap, "memoEvalNsecAvg",
+					    map->memo_misses
+						    ? map->memo_eval_nsec /
+							      map->memo_misses
+						    : 0);
+		}
 		json_object_object_add(json_rmap, "rules", json_rules);
 	} else {
 		vty_out(vty,
@@ -911,6 +1011,14 @@ static void vty_show_route_map_entry(struct vty *vty, struct route_map *map,
 			map->name, map->applied - map->applied_clear,
 			map->optimization_disabled ? "disabled" : "enabled",
 			map->to_be_processed ? "true" : "false");
+		if (map->memo_hits || map->memo_misses)
+			vty_out(vty,
+				" Memoized results: %" PRIu64 " hits, %" PRIu64
+				" misses, %" PRIu64 " ns per evaluation\n",
+				map->memo_hits, map->memo_misses,
+				map->memo_misses ? map->memo_eval_nsec /
+							   map->memo_misses
+						 : 0);
 	}
 
 	for (index = map->head; index; index = index->next) {
@@ -1119,6 +1227,7 @@ void route_map_index_delete(struct route_map_index *index, int notify)
 	struct route_map_rule *rule;
 
 	QOBJ_UNREG(index);
+	route_map_memo_flush();
 
 	if (CHECK_FLAG(rmap_debug, DEBUG_ROUTEMAP))
 		zlog_debug("Deleting route-map %s sequence %d",
@@ -1199,6 +1308,7 @@ route_map_index_add(struct route_map *map, enum route_map_type type, int pref)
 	index->map = map;
 	index->type = type;
 	index->pref = pref;
+	route_map_memo_flush();
 
 	/* Compare preference. */
 	for (point = map->head; point; point = point->next)
@@ -1443,6 +1553,8 @@ enum rmap_compile_rets route_map_add_match(struct route_map_index *index,
 	if (cmd == NULL)
 		return RMAP_RULE_MISSING;
 
+	route_map_memo_flush();
+
 	/* Next call compile function for this match statement. */
 	if (cmd->func_compile) {
 		compile = (*cmd->func_compile)(match_arg);
@@ -1551,6 +1663,8 @@ enum rmap_compile_rets route_map_delete_match(struct route_map_index *index,
 	if (cmd == NULL)
 		return RMAP_RULE_MISSING;
 
+	route_map_memo_flush();
+
 	for (rule = index->match_list.head; rule; rule = rule->next)
 		if (rule->cmd == cmd && (rulecmp(rule->rule_str, match_arg) == 0
 					 || match_arg == NULL)) {
@@ -2465,6 +2579,8 @@ void route_map_notify_pentry_dependencies(const char *affected_name,
 	if (!affected_name || !pentry)
 		return;
 
+	route_map_memo_flush();
+
 	upd8_hash = route_map_get_dep_hash(event);
 	if (!upd8_hash)
 		return;
@@ -2532,10 +2648,10 @@ void route_map_notify_pentry_dependencies(const char *affected_name,
 
    We need to make sure our route-map processing matches the above
 */
-route_map_result_t route_map_apply_ext(struct route_map *map,
-				       const struct prefix *prefix,
-				       void *match_object, void *set_object,
-				       int *pref)
+static route_map_result_t
+route_map_apply_internal(struct route_map *map, const struct prefix *prefix,
+			 void *match_object, void *set_object, int *pref,
+			 struct route_map_index **matched)
 {
 	static int recursion = 0;
 	enum route_map_cmd_result_t match_ret = RMAP_NOMATCH;
@@ -2657,6 +2773,9 @@ route_map_result_t route_map_apply_ext(struct route_map *map,
 			 */
 			continue;
 		} else if (match_ret == RMAP_MATCH) {
+			if (matched)
+				*matched = index;
+
 			if (index->type == RMAP_PERMIT)
 			/* 'action' */
 			{
@@ -2743,6 +2862,145 @@ route_map_apply_end:
 	return (ret);
 }
 
+route_map_result_t route_map_apply_ext(struct route_map *map,
+				       const struct prefix *prefix,
+				       void *match_object, void *set_object,
+				       int *pref)
+{
+	return route_map_apply_internal(map, prefix, match_object, set_object,
+					pref, NULL);
+}
+
+/*
+ * Memoized route-map results.
+ *
+ * When every entry of a map only uses pure match rules, exits on match and
+ * calls no other map, the outcome of applying it is fully described by the
+ * first entry that matched (or by the deny/permit result when none did)
+ * and only depends on the prefix and the caller's key. Those outcomes are
+ * kept in a direct mapped table per map; a hit runs the set actions of the
+ * remembered entry without evaluating any match rule.
+ *
+ * Any change to a route-map, or to a list a route-map depends on, bumps
+ * route_map_memo_gen which drops all remembered outcomes at once.
+ */
+#define ROUTE_MAP_MEMO_SIZE 1024
+
+struct route_map_memo_entry {
+	uint64_t key;
+	uint32_t gen;
+	route_map_result_t ret;
+	struct route_map_index *index;
+	struct prefix prefix;
+};
+
+struct route_map_memo {
+	struct route_map_memo_entry entries[ROUTE_MAP_MEMO_SIZE];
+};
+
+static uint32_t route_map_memo_gen = 1;
+
+void route_map_memo_flush(void)
+{
+	if (++route_map_memo_gen == 0)
+		route_map_memo_gen = 1;
+}
+
+static bool route_map_memo_eligible(struct route_map *map)
+{
+	struct route_map_index *index;
+	struct route_map_rule *rule;
+
+	if (map->memo_gen == route_map_memo_gen)
+		return map->memo_ok;
+
+	map->memo_gen = route_map_memo_gen;
+	map->memo_ok = false;
+
+	for (index = map->head; index; index = index->next) {
+		if (index->exitpolicy != RMAP_EXIT || index->nextrm)
+			return false;
+
+		for (rule = index->match_list.head; rule; rule = rule->next)
+			if (!rule->cmd->pure)
+				return false;
+	}
+
+	map->memo_ok = true;
+	return true;
+}
+
+static uint64_t route_map_memo_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+route_map_result_t route_map_apply_memo(struct route_map *map,
+					const struct prefix *prefix,
+					void *match_object, void *set_object,
+					uint64_t key)
+{
+	struct route_map_memo_entry *entry;
+	struct route_map_index *index = NULL;
+	struct route_map_rule *set;
+	route_map_result_t ret;
+	uint64_t start;
+	uint32_t slot;
+
+	if (!key || !map || !map->head || !route_map_memo_eligible(map))
+		return route_map_apply_internal(map, prefix, match_object,
+						set_object, NULL, NULL);
+
+	if (!map->memo)
+		map->memo = XCALLOC(MTYPE_ROUTE_MAP_MEMO,
+				    sizeof(struct route_map_memo));
+
+	slot = jhash_3words((uint32_t)key, (uint32_t)(key >> 32),
+			    prefix_hash_key(prefix), 0x5a17c0de) &
+	       (ROUTE_MAP_MEMO_SIZE - 1);
+	entry = &map->memo->entries[slot];
+
+	if (entry->gen == route_map_memo_gen && entry->key == key &&
+	    prefix_same(&entry->prefix, prefix)) {
+		map->applied++;
+		map->memo_hits++;
+
+		index = entry->index;
+		if (index) {
+			index->applied++;
+			if (index->type == RMAP_PERMIT)
+				for (set = index->set_list.head; set;
+				     set = set->next)
+					(void)(*set->cmd->func_apply)(
+						set->value, prefix, set_object);
+		}
+
+		if (CHECK_FLAG(rmap_debug, DEBUG_ROUTEMAP))
+			zlog_debug("Route-map: %s, prefix: %pFX, result: %s (memoized)",
+				   map->name, prefix,
+				   route_map_result_str(entry->ret));
+
+		return entry->ret;
+	}
+
+	start = route_map_memo_nsec();
+	ret = route_map_apply_internal(map, prefix, match_object, set_object,
+				       NULL, &index);
+	map->memo_eval_nsec += route_map_memo_nsec() - start;
+	map->memo_misses++;
+
+	entry->key = key;
+	entry->gen = route_map_memo_gen;
+	entry->ret = ret;
+	entry->index = index;
+	prefix_copy(&entry->prefix, prefix);
+
+	return ret;
+}
+
 void route_map_add_hook(void (*func)(const char *))
 {
 	route_map_master.add_hook = func;
@@ -3045,6 +3303,8 @@ void route_map_upd8_dependency(route_map_event_t type, const char *arg,
 {
 	struct hash *upd8_hash = NULL;
 
+	route_map_memo_flush();
+
 	if ((upd8_hash = route_map_get_dep_hash(type))) {
 		route_map_dep_update(upd8_hash, arg, rmap_name, type);
 
@@ -3070,6 +3330,8 @@ void route_map_notify_dependencies(const char *affected_name,
 	if (!affected_name)
 		return;
 
+	route_map_memo_flush();
+
 	name = XSTRDUP(MTYPE_ROUTE_MAP_NAME, affected_name);
 
 	if ((upd8_hash = route_map_get_dep_hash(event)) == NULL) {
@@ -3097,6 +3359,9 @@ static void clear_route_map_helper(struct route_map *map)
 	struct route_map_index *index;
 
 	map->applied_clear = map->applied;
+	map->memo_hits = 0;
+	map->memo_misses = 0;
+	map->memo_eval_nsec = 0;
 	for (index = map->head; index; index = index->next)
 		index->applied_clear = index->applied;
 }
@@ -106,6 +106,11 @@ struct route_map_rule_cmd {
 
 	/** To get the rule key after Compilation **/
 	void *(*func_get_rmap_rule_key)(void *val);
+
+	/* Match result only depends on the prefix and on the data the key
+	 * passed to route_map_apply_memo() stands for, see there.
+	 */
+	bool pure;
 };
 
 /* Route map apply error. */
@@ -211,6 +216,14 @@ struct route_map {
 	uint64_t applied;
 	uint64_t applied_clear;
 
+	/* route_map_apply_memo() results and counters */
+	struct route_map_memo *memo;
+	uint32_t memo_gen;
+	bool memo_ok;
+	uint64_t memo_hits;
+	uint64_t memo_misses;
+	uint64_t memo_eval_nsec;
+
 	/* Counter to track active usage of this route-map */
 	uint16_t use_count;
 
@@ -472,6 +485,16 @@ extern struct route_map *route_map_lookup_by_name(const char *name);
 /* Simple helper to warn if route-map does not exist. */
 struct route_map *route_map_lookup_warn_noexist(struct vty *vty, const char *name);
 
+/*
+ * Compare route-maps by their entries rather than their name: two maps are
+ * the same if they have the same entries with the same match and set
+ * clauses, in the same order.  Maps called from an entry are compared by
+ * name.  A map that isn't defined only equals itself.  The hash is
+ * consistent with route_map_content_same().
+ */
+extern uint32_t route_map_content_hash(const char *name);
+extern bool route_map_content_same(const char *name1, const char *name2);
+
 /* Apply route map to the object. */
 extern route_map_result_t route_map_apply_ext(struct route_map *map,
 					      const struct prefix *prefix,
@@ -480,6 +503,23 @@ extern route_map_result_t route_map_apply_ext(struct route_map *map,
 #define route_map_apply(map, prefix, object)                                   \
 	route_map_apply_ext(map, prefix, object, object, NULL)
 
+/*
+ * Same as route_map_apply_ext(), but the outcome may be remembered per
+ * (key, prefix) and replayed for later calls with the same pair. key must
+ * uniquely identify the match data the "pure" match rules look at for the
+ * lifetime of the daemon (e.g. an id of an immutable interned attribute),
+ * 0 disables memoization for the call. Only maps whose entries all use
+ * pure match rules, exit on match and do not call other maps are memoized;
+ * set actions of the matching entry are always run.
+ */
+extern route_map_result_t route_map_apply_memo(struct route_map *map,
+					       const struct prefix *prefix,
+					       void *match_object,
+					       void *set_object, uint64_t key);
+
+/* Forget all memoized results, for changes route-maps are not told about */
+extern void route_map_memo_flush(void);
+
 extern void route_map_add_hook(void (*func)(const char *));
 extern void route_map_delete_hook(void (*func)(const char *));
 
@@ -269,6 +269,7 @@ static int lib_route_map_entry_action_modify(struct nb_cb_modify_args *args)
 		rmi = nb_running_get_entry(args->dnode, NULL, true);
 		rmi->type = yang_dnode_get_enum(args->dnode, NULL);
 		map = rmi->map;
+		route_map_memo_flush();
 
 		/* Execute event hook. */
 		if (route_map_master.event_hook) {
@@ -383,6 +384,7 @@ lib_route_map_entry_exit_policy_modify(struct nb_cb_modify_args *args)
 	case NB_EV_APPLY:
 		rmi = nb_running_get_entry(args->dnode, NULL, true);
 		policy = yang_dnode_get_enum(args->dnode, NULL);
+		route_map_memo_flush();
 
 		switch (policy) {
 		case 0: /* permit-or-deny */
@@ -65,8 +65,13 @@ DEFINE_MTYPE_STATIC(LIB, SKIP_LIST_STATS, "Skiplist Counters");
 #define newStatsOfLevel(l)                                                     \
 	XCALLOC(MTYPE_SKIP_LIST_STATS, ((l) + 1) * sizeof(int))
 
-static int randomsLeft;
-static int randomBits;
+#ifndef thread_local
+#define thread_local __thread
+#endif
+
+/* per pthread, skiplists may be built concurrently on different pthreads */
+static thread_local int randomsLeft;
+static thread_local int randomBits;
 
 #ifdef SKIPLIST_DEBUG
 #define CHECKLAST(sl)                                                          \
@@ -140,6 +140,45 @@ extern int smux_trap_multi_index(struct variable *vp, size_t vp_len,
 				 const struct trap_object *trapobj,
 				 size_t trapobjlen, uint8_t sptrap);
 
+/*
+ * Index snapshots, for GETNEXT on tables that can only be answered by
+ * walking the data, or whose rows aren't kept in index order.
+ *
+ * fill() adds one entry per row: the row's index, one byte per
+ * sub-identifier (addresses, prefix lengths, small enums), and data_len
+ * bytes of payload, e.g. what's needed to find the live row again.  The
+ * entries are then sorted, so a lookup is a binary search.  The snapshot is
+ * rebuilt on a lookup once it's older than "agentx cache-ttl"; rows that
+ * went away in between must be skipped by the caller.  With a TTL of 0
+ * callers should use their own lookup instead.
+ */
+#define SMUX_INDEX_CACHE_TTL_DEFAULT 10
+
+struct smux_index_cache;
+typedef void (*smux_index_fill_fn)(struct smux_index_cache *cache, void *arg);
+
+extern struct smux_index_cache *smux_index_cache_new(size_t index_len,
+						     size_t data_len,
+						     smux_index_fill_fn fill);
+extern void smux_index_cache_free(struct smux_index_cache **cachep);
+extern void smux_index_cache_invalidate(struct smux_index_cache *cache);
+extern void smux_index_cache_add(struct smux_index_cache *cache,
+				 const uint8_t *index, const void *data);
+
+/*
+ * Find the entry equal to index if exact, else the first one after it (index
+ * may be shorter than index_len for GETNEXT).  Copies the entry's index to
+ * found and returns its payload, or NULL if there is none.  arg is passed to
+ * fill() if the snapshot needs to be rebuilt.
+ */
+extern const void *smux_index_cache_lookup(struct smux_index_cache *cache,
+					   const oid *index, size_t len,
+					   bool exact, oid *found, void *arg);
+
+extern bool smux_index_cache_enabled(void);
+extern void smux_index_cache_set_ttl(unsigned int ttl);
+extern unsigned int smux_index_cache_get_ttl(void);
+
 extern void smux_events_update(void);
 extern int oid_compare(const oid *, int, const oid *, int);
 extern void oid2in_addr(oid[], int, struct in_addr *);
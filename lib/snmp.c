@@ -8,6 +8,8 @@
 #include <net-snmp/net-snmp-config.h>
 #include <net-snmp/net-snmp-includes.h>
 
+#include "memory.h"
+#include "monotime.h"
 #include "smux.h"
 
 int oid_compare(const oid *o1, int o1_len, const oid *o2, int o2_len)
@@ -179,3 +181,177 @@ int smux_header_table(struct variable *v, oid *name, size_t *length, int exact,
 
 	return MATCH_SUCCEEDED;
 }
+
+/* Index snapshots */
+
+DEFINE_MTYPE_STATIC(LIB, SNMP_INDEX_CACHE, "SNMP table index snapshot");
+
+#define SMUX_INDEX_ALIGN(x) (((x) + 7) & ~(size_t)7)
+
+struct smux_index_cache {
+	size_t index_len;
+	size_t data_len;
+	size_t entry_size;
+	smux_index_fill_fn fill;
+
+	uint8_t *entries;
+	size_t count;
+	size_t alloc;
+
+	bool valid;
+	struct timeval built;
+};
+
+static unsigned int smux_index_cache_ttl = SMUX_INDEX_CACHE_TTL_DEFAULT;
+
+void smux_index_cache_set_ttl(unsigned int ttl)
+{
+	smux_index_cache_ttl = ttl;
+}
+
+unsigned int smux_index_cache_get_ttl(void)
+{
+	return smux_index_cache_ttl;
+}
+
+bool smux_index_cache_enabled(void)
+{
+	return smux_index_cache_ttl != 0;
+}
+
+struct smux_index_cache *smux_index_cache_new(size_t index_len,
+					      size_t data_len,
+					      smux_index_fill_fn fill)
+{
+	struct smux_index_cache *cache;
+
+	cache = XCALLOC(MTYPE_SNMP_INDEX_CACHE, sizeof(*cache));
+	cache->index_len = index_len;
+	cache->data_len = data_len;
+	/* payload after the index, aligned for whatever it holds */
+	cache->entry_size =
+		SMUX_INDEX_ALIGN(SMUX_INDEX_ALIGN(index_len) + data_len);
+	cache->fill = fill;
+	return cache;
+}
+
+void smux_index_cache_free(struct smux_index_cache **cachep)
+{
+	struct smux_index_cache *cache = *cachep;
+
+	if (!cache)
+		return;
+
+	XFREE(MTYPE_SNMP_INDEX_CACHE, cache->entries);
+	XFREE(MTYPE_SNMP_INDEX_CACHE, *cachep);
+}
+
+void smux_index_cache_invalidate(struct smux_index_cache *cache)
+{
+	cache->valid = false;
+}
+
+void smux_index_cache_add(struct smux_index_cache *cache, const uint8_t *index,
+			  const void *data)
+{
+	uint8_t *entry;
+
+	if (cache->count == cache->alloc) {
+		cache->alloc = MAX(cache->alloc * 2, 1024U);
+		cache->entries = XREALLOC(MTYPE_SNMP_INDEX_CACHE,
+					  cache->entries,
+					  cache->alloc * cache->entry_size);
+	}
+
+	entry = cache->entries + cache->count++ * cache->entry_size;
+	memcpy(entry, index, cache->index_len);
+	if (cache->data_len)
+		memcpy(entry + SMUX_INDEX_ALIGN(cache->index_len), data,
+		       cache->data_len);
+}
+
+/* qsort() has no context argument; the sort runs on the main pthread only */
+static size_t smux_index_sort_len;
+
+static int smux_index_entry_cmp(const void *a, const void *b)
+{
+	return memcmp(a, b, smux_index_sort_len);
+}
+
+/* Compare a (possibly partial) OID index against an entry's index */
+static int smux_index_key_cmp(const oid *key, size_t len, const uint8_t *entry,
+			      size_t index_len)
+{
+	size_t i;
+
+	for (i = 0; i < MIN(len, index_len); i++) {
+		if (key[i] < entry[i])
+			return -1;
+		if (key[i] > entry[i])
+			return 1;
+	}
+	if (len < index_len)
+		return -1;
+	if (len > index_len)
+		return 1;
+	return 0;
+}
+
+static void smux_index_cache_refresh(struct smux_index_cache *cache, void *arg)
+{
+	if (cache->valid && monotime_since(&cache->built, NULL) <
+				    (int64_t)smux_index_cache_ttl * 1000000)
+		return;
+
+	cache->count = 0;
+	cache->fill(cache, arg);
+
+	smux_index_sort_len = cache->index_len;
+	qsort(cache->entries, cache->count, cache->entry_size,
+	      smux_index_entry_cmp);
+
+	/* give memory back if the table shrunk a lot */
+	if (cache->alloc > 1024 && cache->count < cache->alloc / 4) {
+		cache->alloc = MAX(cache->count, 1024U);
+		cache->entries = XREALLOC(MTYPE_SNMP_INDEX_CACHE,
+					  cache->entries,
+					  cache->alloc * cache->entry_size);
+	}
+
+	monotime(&cache->built);
+	cache->valid = true;
+}
+
+const void *smux_index_cache_lookup(struct smux_index_cache *cache,
+				    const oid *index, size_t len, bool exact,
+				    oid *found, void *arg)
+{
+	size_t lo = 0, hi, i;
+	const uint8_t *entry;
+	int cmp;
+
+	smux_index_cache_refresh(cache, arg);
+
+	/* first entry whose index is >= (exact) or > (GETNEXT) the key */
+	hi = cache->count;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		entry = cache->entries + mid * cache->entry_size;
+		cmp = smux_index_key_cmp(index, len, entry, cache->index_len);
+		if (cmp > 0 || (cmp == 0 && !exact))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == cache->count)
+		return NULL;
+
+	entry = cache->entries + lo * cache->entry_size;
+	if (exact && smux_index_key_cmp(index, len, entry, cache->index_len))
+		return NULL;
+
+	for (i = 0; i < cache->index_len; i++)
+		found[i] = entry[i];
+	return entry + SMUX_INDEX_ALIGN(cache->index_len);
+}
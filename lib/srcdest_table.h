@@ -28,6 +28,10 @@
  *
  * NB: info can be NULL on the destination rnode, if there are only srcdest
  * routes for a particular destination prefix.
+ *
+ * Both levels are plain route_tables, so an exact (dst, src) lookup is two
+ * prefix hash lookups rather than two tree walks; only longest-prefix match
+ * walks the trees.  "test_srcdest_table bench" measures the operations.
  */
 
 #include "prefix.h"
@@ -85,14 +85,248 @@ DEFINE_MTYPE_STATIC(LIB, STREAM_FIFO, "Stream FIFO");
 		}                                                              \
 	} while (0);
 
+/*
+ * Streams are allocated and freed for every packet, so blocks for a few
+ * size classes are kept for reuse.  Each pthread has a small cache per
+ * class; when it runs full or empty, a batch of streams is moved to or from
+ * a shared depot.  Streams are often allocated on one pthread (I/O) and
+ * freed on another, so the depot is what makes the caches work.
+ *
+ * The cache and depot sizes are scaled so that each class holds roughly the
+ * same amount of memory.
+ */
+#define STREAM_POOL_CACHE_BYTES (256 * 1024)
+#define STREAM_POOL_CACHE_MAX	32
+#define STREAM_POOL_DEPOT_BYTES (1024 * 1024)
+#define STREAM_POOL_DEPOT_MAX	512
+
+struct stream_pool {
+	size_t size;
+	unsigned int cache_max, batch, depot_max;
+
+	pthread_mutex_t mtx;
+	struct stream *depot;
+	unsigned int depot_count;
+
+	/* updated under mtx, caches add their counts when they get here */
+	size_t hits, misses, released;
+};
+
+#define STREAM_POOL_CACHE_N(sz)                                                \
+	MAX(MIN(STREAM_POOL_CACHE_BYTES / (sz), STREAM_POOL_CACHE_MAX), 2)
+#define STREAM_POOL_DEPOT_N(sz)                                                \
+	MAX(MIN(STREAM_POOL_DEPOT_BYTES / (sz), STREAM_POOL_DEPOT_MAX), 2)
+
+#define STREAM_POOL_INIT(sz)                                                   \
+	{                                                                      \
+		.size = (sz),                                                  \
+		.cache_max = STREAM_POOL_CACHE_N(sz),                          \
+		.batch = STREAM_POOL_CACHE_N(sz) / 2,                          \
+		.depot_max = STREAM_POOL_DEPOT_N(sz),                          \
+		.mtx = PTHREAD_MUTEX_INITIALIZER,                              \
+	}
+
+/* 16384 is ZEBRA_MAX_PACKET_SIZ, BGP extended messages fit into 65536 */
+static struct stream_pool stream_pools[] = {
+	STREAM_POOL_INIT(256),	 STREAM_POOL_INIT(1024),
+	STREAM_POOL_INIT(4096),	 STREAM_POOL_INIT(16384),
+	STREAM_POOL_INIT(65536),
+};
+
+#define STREAM_POOLS array_size(stream_pools)
+
+struct stream_pool_cache {
+	bool registered;
+
+	struct stream *head[STREAM_POOLS];
+	unsigned int count[STREAM_POOLS];
+	size_t hits[STREAM_POOLS], misses[STREAM_POOLS];
+};
+
+#ifndef thread_local
+#define thread_local __thread
+#endif
+
+static thread_local struct stream_pool_cache stream_pool_cache;
+
+static pthread_key_t stream_pool_key;
+static pthread_once_t stream_pool_once = PTHREAD_ONCE_INIT;
+
+/* move all but keep streams from the cache to the depot */
+static void stream_pool_flush(struct stream_pool_cache *cache, size_t cls,
+			      unsigned int keep)
+{
+	struct stream_pool *pool = &stream_pools[cls];
+	struct stream *s;
+
+	frr_with_mutex (&pool->mtx) {
+		pool->hits += cache->hits[cls];
+		pool->misses += cache->misses[cls];
+		cache->hits[cls] = cache->misses[cls] = 0;
+
+		while (cache->count[cls] > keep) {
+			s = cache->head[cls];
+			cache->head[cls] = s->next;
+			cache->count[cls]--;
+
+			if (pool->depot_count >= pool->depot_max) {
+				pool->released++;
+				XFREE(MTYPE_STREAM, s);
+				continue;
+			}
+			s->next = pool->depot;
+			pool->depot = s;
+			pool->depot_count++;
+		}
+	}
+}
+
+/* pthread exit */
+static void stream_pool_thread_fini(void *arg)
+{
+	struct stream_pool_cache *cache = arg;
+	size_t cls;
+
+	for (cls = 0; cls < STREAM_POOLS; cls++)
+		stream_pool_flush(cache, cls, 0);
+	cache->registered = false;
+}
+
+static void stream_pool_init(void)
+{
+	pthread_key_create(&stream_pool_key, stream_pool_thread_fini);
+}
+
+static struct stream_pool_cache *stream_pool_cache_get(void)
+{
+	struct stream_pool_cache *cache = &stream_pool_cache;
+
+	if (!cache->registered) {
+		pthread_once(&stream_pool_once, stream_pool_init);
+		pthread_setspecific(stream_pool_key, cache);
+		cache->registered = true;
+	}
+	return cache;
+}
+
+static struct stream *stream_pool_get(size_t cls)
+{
+	struct stream_pool_cache *cache = stream_pool_cache_get();
+	struct stream_pool *pool = &stream_pools[cls];
+	struct stream *s;
+
+	if (!cache->head[cls]) {
+		frr_with_mutex (&pool->mtx) {
+			while (pool->depot && cache->count[cls] < pool->batch) {
+				s = pool->depot;
+				pool->depot = s->next;
+				pool->depot_count--;
+
+				s->next = cache->head[cls];
+				cache->head[cls] = s;
+				cache->count[cls]++;
+			}
+		}
+	}
+
+	s = cache->head[cls];
+	if (s) {
+		cache->head[cls] = s->next;
+		cache->count[cls]--;
+		cache->hits[cls]++;
+		return s;
+	}
+
+	cache->misses[cls]++;
+	return XMALLOC(MTYPE_STREAM, sizeof(struct stream) + pool->size);
+}
+
+static void stream_pool_put(size_t cls, struct stream *s)
+{
+	struct stream_pool_cache *cache = stream_pool_cache_get();
+	struct stream_pool *pool = &stream_pools[cls];
+
+	if (cache->count[cls] >= pool->cache_max)
+		stream_pool_flush(cache, cls, pool->cache_max - pool->batch);
+
+	s->next = cache->head[cls];
+	cache->head[cls] = s;
+	cache->count[cls]++;
+}
+
+int stream_pool_walk(stream_pool_walk_fn *func, void *arg)
+{
+	struct stream_pool_cache *cache = &stream_pool_cache;
+	struct stream_pool_stats stats;
+	size_t cls;
+	int rv;
+
+	for (cls = 0; cls < STREAM_POOLS; cls++) {
+		struct stream_pool *pool = &stream_pools[cls];
+
+		/* only picks up the counters of the calling pthread, the
+		 * others' are added as they go through the depot
+		 */
+		stream_pool_flush(cache, cls, cache->count[cls]);
+
+		frr_with_mutex (&pool->mtx) {
+			stats.size = pool->size;
+			stats.depot = pool->depot_count;
+			stats.hits = pool->hits;
+			stats.misses = pool->misses;
+			stats.released = pool->released;
+		}
+		rv = func(arg, &stats);
+		if (rv)
+			return rv;
+	}
+	return 0;
+}
+
+void stream_pool_fini(void)
+{
+	struct stream_pool_cache *cache = &stream_pool_cache;
+	struct stream *s;
+	size_t cls;
+
+	for (cls = 0; cls < STREAM_POOLS; cls++) {
+		struct stream_pool *pool = &stream_pools[cls];
+
+		while ((s = cache->head[cls])) {
+			cache->head[cls] = s->next;
+			XFREE(MTYPE_STREAM, s);
+		}
+		cache->count[cls] = 0;
+
+		frr_with_mutex (&pool->mtx) {
+			while ((s = pool->depot)) {
+				pool->depot = s->next;
+				XFREE(MTYPE_STREAM, s);
+			}
+			pool->depot_count = 0;
+		}
+	}
+}
+
 /* Make stream buffer. */
 struct stream *stream_new(size_t size)
 {
 	struct stream *s;
+	size_t cls;
 
 	assert(size > 0);
 
-	s = XMALLOC(MTYPE_STREAM, sizeof(struct stream) + size);
+	for (cls = 0; cls < STREAM_POOLS; cls++)
+		if (size <= stream_pools[cls].size)
+			break;
+
+	if (cls < STREAM_POOLS) {
+		s = stream_pool_get(cls);
+		s->pool = cls + 1;
+	} else {
+		s = XMALLOC(MTYPE_STREAM, sizeof(struct stream) + size);
+		s->pool = 0;
+	}
 
 	s->getp = s->endp = 0;
 	s->next = NULL;
@@ -106,7 +340,10 @@ void stream_free(struct stream *s)
 	if (!s)
 		return;
 
-	XFREE(MTYPE_STREAM, s);
+	if (s->pool)
+		stream_pool_put(s->pool - 1, s);
+	else
+		XFREE(MTYPE_STREAM, s);
 }
 
 struct stream *stream_copy(struct stream *dest, const struct stream *src)
@@ -160,7 +397,17 @@ size_t stream_resize_inplace(struct stream **sptr, size_t newsize)
 
 	STREAM_VERIFY_SANE(orig);
 
-	orig = XREALLOC(MTYPE_STREAM, orig, sizeof(struct stream) + newsize);
+	if (orig->pool && newsize > stream_pools[orig->pool - 1].size) {
+		/* pooled blocks can't be realloc'd, move to a plain one */
+		struct stream *pooled = orig;
+
+		orig = XMALLOC(MTYPE_STREAM, sizeof(struct stream) + newsize);
+		memcpy(orig, pooled, sizeof(struct stream) + pooled->endp);
+		orig->pool = 0;
+		stream_free(pooled);
+	} else if (!orig->pool)
+		orig = XREALLOC(MTYPE_STREAM, orig,
+				sizeof(struct stream) + newsize);
 
 	orig->size = newsize;
 
@@ -95,6 +95,7 @@ struct stream {
 	size_t getp;	       /* next get position */
 	size_t endp;	       /* last valid data position */
 	size_t size;	       /* size of data segment */
+	size_t pool;	       /* size class + 1 if from a pool, else 0 */
 	unsigned char data[];  /* data pointer */
 };
 
@@ -135,6 +136,24 @@ struct stream_fifo {
  */
 extern struct stream *stream_new(size_t);
 extern void stream_free(struct stream *);
+
+/* stream_new() and stream_free() keep blocks of common sizes for reuse,
+ * see there.  Counters for "show memory", and freeing everything at exit.
+ */
+struct stream_pool_stats {
+	/* data size of the class */
+	size_t size;
+	/* streams held in the shared depot (not counting per-pthread caches) */
+	size_t depot;
+	/* allocations served from a pool / with malloc */
+	size_t hits, misses;
+	/* frees that went to the system because the depot was full */
+	size_t released;
+};
+
+typedef int stream_pool_walk_fn(void *arg, const struct stream_pool_stats *st);
+extern int stream_pool_walk(stream_pool_walk_fn *func, void *arg);
+extern void stream_pool_fini(void);
 /* Copy 'src' into 'dest', returns 'dest' */
 extern struct stream *stream_copy(struct stream *dest,
 				  const struct stream *src);
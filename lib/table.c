@@ -12,11 +12,18 @@
 #include "table.h"
 #include "memory.h"
 #include "sockunion.h"
+#include "frrevent.h"
 #include "libfrr_trace.h"
 
 DEFINE_MTYPE_STATIC(LIB, ROUTE_TABLE, "Route table");
 DEFINE_MTYPE(LIB, ROUTE_NODE, "Route node");
 
+/* Links are stored with release semantics and loaded with acquire semantics
+ * by the _rcu lookups, so those never see a node before it's set up.
+ */
+#define rn_publish(ptr, val) __atomic_store_n(&(ptr), (val), __ATOMIC_RELEASE)
+#define rn_deref(ptr) __atomic_load_n(&(ptr), __ATOMIC_ACQUIRE)
+
 static void route_table_free(struct route_table *);
 
 static int route_table_hash_cmp(const struct route_node *a,
@@ -123,7 +130,10 @@ static void route_table_free(struct route_table *rt)
 	assert(rt->count == 0);
 
 	rn_hash_node_fini(&rt->hash);
-	XFREE(MTYPE_ROUTE_TABLE, rt);
+	if (rt->rcu)
+		rcu_free(MTYPE_ROUTE_TABLE, rt, rcu_head);
+	else
+		XFREE(MTYPE_ROUTE_TABLE, rt);
 	return;
 }
 
@@ -173,7 +183,7 @@ static void set_link(struct route_node *node, struct route_node *new)
 {
 	unsigned int bit = prefix_bit(&new->p.u.prefix, node->p.prefixlen);
 
-	node->link[bit] = new;
+	rn_publish(node->link[bit], new);
 	new->parent = node;
 }
 
@@ -234,6 +244,58 @@ struct route_node *route_node_match_ipv6(struct route_table *table,
 	return route_node_match(table, &p);
 }
 
+/* Same as route_node_match(), for other threads; the hash isn't safe for
+ * them, so this only walks the tree.
+ */
+struct route_node *route_node_match_rcu(struct route_table *table,
+					union prefixconstptr pu)
+{
+	const struct prefix *p = pu.p;
+	struct route_node *node;
+	struct route_node *matched = NULL;
+
+	rcu_assert_read_locked();
+
+	node = rn_deref(table->top);
+	while (node && node->p.prefixlen <= p->prefixlen
+	       && prefix_match(&node->p, p)) {
+		if (route_node_get_info_rcu(node))
+			matched = node;
+
+		if (node->p.prefixlen == p->prefixlen)
+			break;
+
+		node = rn_deref(
+			node->link[prefix_bit(&p->u.prefix, node->p.prefixlen)]);
+	}
+
+	return matched;
+}
+
+struct route_node *route_node_lookup_rcu(struct route_table *table,
+					 union prefixconstptr pu)
+{
+	struct prefix p;
+	struct route_node *node;
+
+	rcu_assert_read_locked();
+
+	prefix_copy(&p, pu.p);
+	apply_mask(&p);
+
+	node = rn_deref(table->top);
+	while (node && node->p.prefixlen <= p.prefixlen
+	       && prefix_match(&node->p, &p)) {
+		if (node->p.prefixlen == p.prefixlen)
+			return route_node_get_info_rcu(node) ? node : NULL;
+
+		node = rn_deref(
+			node->link[prefix_bit(&p.u.prefix, node->p.prefixlen)]);
+	}
+
+	return NULL;
+}
+
 /* Lookup same prefix node.  Return NULL when we can't find route. */
 struct route_node *route_node_lookup(struct route_table *table,
 				     union prefixconstptr pu)
@@ -300,7 +362,7 @@ struct route_node *route_node_get(struct route_table *table,
 		if (match)
 			set_link(match, new);
 		else
-			table->top = new;
+			rn_publish(table->top, new);
 	} else {
 		new = route_node_new(table);
 		route_common(&node->p, p, &new->p);
@@ -312,7 +374,7 @@ struct route_node *route_node_get(struct route_table *table,
 		if (match)
 			set_link(match, new);
 		else
-			table->top = new;
+			rn_publish(table->top, new);
 
 		if (new->p.prefixlen != p->prefixlen) {
 			match = new;
@@ -349,13 +411,14 @@ void route_node_delete(struct route_node *node)
 	if (child)
 		child->parent = parent;
 
+	/* the node itself keeps pointing at child for readers still on it */
 	if (parent) {
 		if (parent->l_left == node)
-			parent->l_left = child;
+			rn_publish(parent->l_left, child);
 		else
-			parent->l_right = child;
+			rn_publish(parent->l_right, child);
 	} else
-		node->table->top = child;
+		rn_publish(node->table->top, child);
 
 	node->table->count--;
 
@@ -505,6 +568,46 @@ route_table_delegate_t *route_table_get_default_delegate(void)
 	return &default_delegate;
 }
 
+/* nodes of route_table_init_rcu() tables */
+struct route_node_rcu {
+	struct route_node node;
+	struct rcu_head rcu_head;
+};
+
+static struct route_node *
+route_node_rcu_create(route_table_delegate_t *delegate,
+		      struct route_table *table)
+{
+	struct route_node_rcu *rnr;
+
+	rnr = XCALLOC(MTYPE_ROUTE_NODE, sizeof(struct route_node_rcu));
+	return &rnr->node;
+}
+
+static void route_node_rcu_destroy(route_table_delegate_t *delegate,
+				   struct route_table *table,
+				   struct route_node *node)
+{
+	struct route_node_rcu *rnr;
+
+	rnr = container_of(node, struct route_node_rcu, node);
+	rcu_free(MTYPE_ROUTE_NODE, rnr, rcu_head);
+}
+
+static route_table_delegate_t rcu_delegate = {
+	.create_node = route_node_rcu_create,
+	.destroy_node = route_node_rcu_destroy,
+};
+
+struct route_table *route_table_init_rcu(void)
+{
+	struct route_table *rt;
+
+	rt = route_table_init_with_delegate(&rcu_delegate);
+	rt->rcu = true;
+	return rt;
+}
+
 /*
  * route_table_init
  */
@@ -714,6 +817,65 @@ struct route_node *route_table_get_next(struct route_table *table,
 	return node;
 }
 
+/* first node with info at or after rn, in iteration order */
+static struct route_node *route_table_diff_next(struct route_node *rn)
+{
+	while (rn && !rn->info)
+		rn = route_next(rn);
+	return rn;
+}
+
+/*
+ * route_table_diff
+ *
+ * Compare two tables in a single ordered walk over both.
+ *
+ * @see table.h
+ */
+void route_table_diff(struct route_table *old_table,
+		      struct route_table *new_table,
+		      route_table_diff_same_func_t same,
+		      route_table_diff_func_t cb, void *arg,
+		      struct route_table_diff_stats *stats)
+{
+	struct route_table_diff_stats dummy;
+	struct route_node *orn, *nrn;
+	int cmp;
+
+	if (!stats)
+		stats = &dummy;
+	memset(stats, 0, sizeof(*stats));
+
+	orn = old_table ? route_table_diff_next(route_top(old_table)) : NULL;
+	nrn = new_table ? route_table_diff_next(route_top(new_table)) : NULL;
+
+	while (orn || nrn) {
+		if (orn && nrn)
+			cmp = route_table_prefix_iter_cmp(&orn->p, &nrn->p);
+		else
+			cmp = orn ? -1 : 1;
+
+		if (cmp < 0) {
+			stats->removed++;
+			cb(orn, NULL, arg);
+			orn = route_table_diff_next(route_next(orn));
+		} else if (cmp > 0) {
+			stats->added++;
+			cb(NULL, nrn, arg);
+			nrn = route_table_diff_next(route_next(nrn));
+		} else {
+			if (same(orn, nrn, arg))
+				stats->unchanged++;
+			else {
+				stats->changed++;
+				cb(orn, nrn, arg);
+			}
+			orn = route_table_diff_next(route_next(orn));
+			nrn = route_table_diff_next(route_next(nrn));
+		}
+	}
+}
+
 /*
  * route_table_iter_init
  */
@@ -779,3 +941,88 @@ void route_table_iter_cleanup(route_table_iter_t *iter)
 	 */
 	iter->state = RT_ITER_STATE_DONE;
 }
+
+static void route_table_walk_run(struct event *event);
+
+static void route_table_walk_schedule(struct route_table_walk *walk)
+{
+	event_add_event(walk->loop, route_table_walk_run, walk, 0,
+			&walk->t_walk);
+	if (walk->yield_usec)
+		event_set_yield_time(walk->t_walk, walk->yield_usec);
+}
+
+static void route_table_walk_run(struct event *event)
+{
+	struct route_table_walk *walk = EVENT_ARG(event);
+	struct route_node *rn;
+
+	/* the lock on the cursor is handed over to route_next() */
+	rn = walk->cursor;
+	walk->cursor = NULL;
+	walk->runs++;
+
+	while (rn) {
+		walk->current = rn;
+		walk->visited++;
+
+		if (!walk->fn(rn, walk->arg)) {
+			/* fn may have cancelled or restarted us already */
+			if (walk->current == rn) {
+				walk->current = NULL;
+				route_unlock_node(rn);
+			}
+			return;
+		}
+
+		/* cancelled or restarted from fn, rn was unlocked there */
+		if (walk->current != rn)
+			return;
+
+		walk->current = NULL;
+		rn = route_next(rn);
+
+		if (rn && event_should_yield(event)) {
+			walk->cursor = rn;
+			route_table_walk_schedule(walk);
+			return;
+		}
+	}
+
+	if (walk->done)
+		walk->done(walk->arg);
+}
+
+void route_table_walk_start(struct route_table_walk *walk,
+			    struct event_loop *loop, struct route_table *table,
+			    route_table_walk_fn fn, void (*done)(void *arg),
+			    void *arg)
+{
+	route_table_walk_cancel(walk);
+
+	walk->loop = loop;
+	walk->table = table;
+	walk->fn = fn;
+	walk->done = done;
+	walk->arg = arg;
+	walk->visited = 0;
+	walk->runs = 0;
+
+	/* nothing is done right away, the caller gets to return first */
+	walk->cursor = route_top(table);
+	route_table_walk_schedule(walk);
+}
+
+void route_table_walk_cancel(struct route_table_walk *walk)
+{
+	EVENT_OFF(walk->t_walk);
+
+	if (walk->cursor) {
+		route_unlock_node(walk->cursor);
+		walk->cursor = NULL;
+	}
+	if (walk->current) {
+		route_unlock_node(walk->current);
+		walk->current = NULL;
+	}
+}
@@ -11,6 +11,7 @@
 #include "hash.h"
 #include "prefix.h"
 #include "typesafe.h"
+#include "frrcu.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -63,6 +64,10 @@ struct route_table {
 	 * User data.
 	 */
 	void *info;
+
+	/* looked up from other threads, see route_table_init_rcu() */
+	bool rcu;
+	struct rcu_head rcu_head;
 };
 
 /*
@@ -172,6 +177,37 @@ route_table_init_with_delegate(route_table_delegate_t *delegate);
 
 extern route_table_delegate_t *route_table_get_default_delegate(void);
 
+/*
+ * Tables for lockless lookups from other pthreads.
+ *
+ * Nodes of such a table are freed through RCU and are only linked into the
+ * tree once they are fully set up, so other threads can use the _rcu
+ * lookups below inside rcu_read_lock() while the owning thread keeps
+ * changing the table.  Those lookups don't touch the node's lock count; the
+ * node they return stays valid until rcu_read_unlock() and must not be
+ * modified.  A lookup racing with a change may or may not see it.  All
+ * other functions remain for the owning thread only.
+ *
+ * Info read from other threads has to be set with route_node_set_info_rcu()
+ * and freed with rcu_free() or similar.  route_table_finish() defers
+ * freeing the table itself the same way.
+ */
+extern struct route_table *route_table_init_rcu(void);
+extern struct route_node *route_node_match_rcu(struct route_table *table,
+					       union prefixconstptr pu);
+extern struct route_node *route_node_lookup_rcu(struct route_table *table,
+						union prefixconstptr pu);
+
+static inline void *route_node_get_info_rcu(const struct route_node *node)
+{
+	return __atomic_load_n(&node->info, __ATOMIC_ACQUIRE);
+}
+
+static inline void route_node_set_info_rcu(struct route_node *node, void *info)
+{
+	__atomic_store_n(&node->info, info, __ATOMIC_RELEASE);
+}
+
 static inline void *route_table_get_info(struct route_table *table)
 {
 	return table->info;
@@ -214,6 +250,39 @@ extern struct route_node *route_table_get_next(struct route_table *table,
 extern int route_table_prefix_iter_cmp(const struct prefix *p1,
 				       const struct prefix *p2);
 
+/*
+ * Table diff.
+ *
+ * route_table_diff() walks two tables of the same address family in
+ * iteration order at the same time and calls 'cb' once for every prefix
+ * that only has an entry (non-NULL info) in one of them, with the other
+ * node being NULL, and for every prefix in both for which 'same' returns
+ * false.  Unchanged entries are only counted.  This replaces the usual
+ * "walk the new table and look each entry up in the old one, then walk the
+ * old table and look each entry up in the new one" with a single pass.
+ *
+ * 'cb' may clear the info of the nodes it is passed, but must not add or
+ * delete other entries in either table.  Plain (non-srcdest) tables only.
+ */
+typedef bool (*route_table_diff_same_func_t)(const struct route_node *old_rn,
+					     const struct route_node *new_rn,
+					     void *arg);
+typedef void (*route_table_diff_func_t)(struct route_node *old_rn,
+					struct route_node *new_rn, void *arg);
+
+struct route_table_diff_stats {
+	unsigned long added;
+	unsigned long removed;
+	unsigned long changed;
+	unsigned long unchanged;
+};
+
+extern void route_table_diff(struct route_table *old_table,
+			     struct route_table *new_table,
+			     route_table_diff_same_func_t same,
+			     route_table_diff_func_t cb, void *arg,
+			     struct route_table_diff_stats *stats);
+
 /*
  * Iterator functions.
  */
@@ -222,6 +291,60 @@ extern void route_table_iter_init(route_table_iter_t *iter,
 extern void route_table_iter_pause(route_table_iter_t *iter);
 extern void route_table_iter_cleanup(route_table_iter_t *iter);
 
+/*
+ * Walk over a route table in the background, from an event that yields
+ * whenever event_should_yield() says the time slot is used up and picks
+ * up again at the next node in a new event.
+ *
+ * While the walk is paused the node it resumes at is kept locked, so
+ * the table can be changed freely in between: nodes added before that
+ * are not visited, nodes added after it are.  fn may also remove the
+ * info of the node it is called for.  The table has to outlive the walk,
+ * cancel it before finishing the table.
+ */
+struct event;
+struct event_loop;
+
+/* return false to end the walk early, done is not called then */
+typedef bool (*route_table_walk_fn)(struct route_node *rn, void *arg);
+
+struct route_table_walk {
+	struct event_loop *loop;
+	struct route_table *table;
+
+	route_table_walk_fn fn;
+	void (*done)(void *arg);
+	void *arg;
+
+	/* usecs per run, 0 for the default time slot */
+	unsigned long yield_usec;
+
+	/* locked node to resume at, and the one fn is called for */
+	struct route_node *cursor;
+	struct route_node *current;
+	struct event *t_walk;
+
+	/* nodes visited and runs taken so far */
+	unsigned long visited;
+	unsigned int runs;
+};
+
+/*
+ * (Re)start a walk from the top of table, any walk in progress on the
+ * same struct is cancelled first.
+ */
+extern void route_table_walk_start(struct route_table_walk *walk,
+				   struct event_loop *loop,
+				   struct route_table *table,
+				   route_table_walk_fn fn,
+				   void (*done)(void *arg), void *arg);
+extern void route_table_walk_cancel(struct route_table_walk *walk);
+
+static inline bool route_table_walk_running(const struct route_table_walk *walk)
+{
+	return walk->t_walk || walk->current;
+}
+
 /*
  * Inline functions.
  */
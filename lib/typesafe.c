@@ -18,6 +18,7 @@
 DEFINE_MTYPE_STATIC(LIB, TYPEDHASH_BUCKET, "Typed-hash bucket");
 DEFINE_MTYPE_STATIC(LIB, SKIPLIST_OFLOW, "Skiplist overflow");
 DEFINE_MTYPE_STATIC(LIB, HEAP_ARRAY, "Typed-heap array");
+DEFINE_MTYPE_STATIC(LIB, SORTARRAY_ARRAY, "Typed-sorted-array array");
 
 struct slist_item typesafe_slist_sentinel = { NULL };
 
@@ -598,3 +599,54 @@ void typesafe_heap_pullup(struct heap_head *head, uint32_t pos,
 
 	heap_consistency_check(head, cmpfn, 0);
 }
+
+/* sorted array */
+
+static void sarray_resize(struct sarray_head *head, uint32_t newsize)
+{
+	if (newsize == 0) {
+		XFREE(MTYPE_SORTARRAY_ARRAY, head->array);
+		head->arraysz = 0;
+		return;
+	}
+
+	head->array = XREALLOC(MTYPE_SORTARRAY_ARRAY, head->array,
+			       newsize * sizeof(struct sarray_item *));
+	head->arraysz = newsize;
+}
+
+void typesafe_sarray_insert(struct sarray_head *head, uint32_t pos,
+			    struct sarray_item *item)
+{
+	uint32_t i;
+
+	if (head->count == head->arraysz) {
+		assert(head->arraysz < 0x80000000U);
+		sarray_resize(head, head->arraysz ? head->arraysz * 2 : 8);
+	}
+
+	memmove(&head->array[pos + 1], &head->array[pos],
+		(head->count - pos) * sizeof(head->array[0]));
+	head->array[pos] = item;
+	head->count++;
+
+	for (i = pos; i < head->count; i++)
+		head->array[i]->index = i;
+}
+
+void typesafe_sarray_remove(struct sarray_head *head, uint32_t pos)
+{
+	uint32_t i;
+
+	head->count--;
+	memmove(&head->array[pos], &head->array[pos + 1],
+		(head->count - pos) * sizeof(head->array[0]));
+
+	for (i = pos; i < head->count; i++)
+		head->array[i]->index = i;
+
+	if (head->count == 0)
+		sarray_resize(head, 0);
+	else if (head->arraysz > 8 && head->count < head->arraysz / 4)
+		sarray_resize(head, head->arraysz / 2);
+}
@@ -1145,6 +1145,209 @@ extern struct sskip_item *typesafe_skiplist_del(
 			const struct sskip_item *b));
 extern struct sskip_item *typesafe_skiplist_pop(struct sskip_head *head);
 
+/* sorted array of item pointers
+ *
+ * Lookups are a binary search on one contiguous array, with the compare
+ * function inlined, instead of following pointers through items scattered
+ * all over memory, and walking the container is sequential.  Adding and
+ * deleting items moves the tail of the array though, so this is meant for
+ * small sets that are searched much more often than they change.
+ */
+
+/* don't use these structs directly */
+struct sarray_item {
+	uint32_t index;
+};
+
+struct sarray_head {
+	struct sarray_item **array;
+	uint32_t arraysz, count;
+};
+
+/* use as:
+ *
+ * PREDECL_SORTARRAY(namelist)
+ * struct name {
+ *   struct namelist_item nlitem;
+ * }
+ * DECLARE_SORTARRAY(namelist, struct name, nlitem, cmpfunc)
+ */
+#define _PREDECL_SORTARRAY(prefix)                                             \
+struct prefix ## _head { struct sarray_head sa; };                             \
+struct prefix ## _item { struct sarray_item si; };                             \
+MACRO_REQUIRE_SEMICOLON() /* end */
+
+#define INIT_SORTARRAY_UNIQ(var)	{ }
+#define INIT_SORTARRAY_NONUNIQ(var)	{ }
+
+#define PREDECL_SORTARRAY_UNIQ(prefix)                                         \
+	_PREDECL_SORTARRAY(prefix)
+#define PREDECL_SORTARRAY_NONUNIQ(prefix)                                      \
+	_PREDECL_SORTARRAY(prefix)
+
+/* index of the first item that doesn't compare lower than item */
+#define _SORTARRAY_POS(prefix, type, field, name, cmpfn)                       \
+macro_inline uint32_t prefix ## name(const struct prefix##_head *h,            \
+				     const type *item)                         \
+{                                                                              \
+	uint32_t lo = 0, hi = h->sa.count, mid;                                \
+	while (lo < hi) {                                                      \
+		mid = lo + (hi - lo) / 2;                                      \
+		if (cmpfn(container_of(h->sa.array[mid], type, field.si),      \
+			  item) < 0)                                           \
+			lo = mid + 1;                                          \
+		else                                                           \
+			hi = mid;                                              \
+	}                                                                      \
+	return lo;                                                             \
+}                                                                              \
+/* ... */
+
+#define _DECLARE_SORTARRAY(prefix, type, field, cmpfn_nuq, cmpfn_uq)           \
+                                                                               \
+macro_inline void prefix ## _init(struct prefix##_head *h)                     \
+{                                                                              \
+	memset(h, 0, sizeof(*h));                                              \
+}                                                                              \
+macro_inline void prefix ## _fini(struct prefix##_head *h)                     \
+{                                                                              \
+	assert(h->sa.count == 0);                                              \
+	memset(h, 0, sizeof(*h));                                              \
+}                                                                              \
+_SORTARRAY_POS(prefix, type, field, __pos_nuq, cmpfn_nuq)                      \
+_SORTARRAY_POS(prefix, type, field, __pos_uq, cmpfn_uq)                        \
+macro_inline type *prefix ## _add(struct prefix##_head *h, type *item)         \
+{                                                                              \
+	uint32_t pos = prefix ## __pos_uq(h, item);                            \
+	if (pos < h->sa.count && !cmpfn_uq(container_of(h->sa.array[pos],      \
+						type, field.si), item))        \
+		return container_of(h->sa.array[pos], type, field.si);         \
+	typesafe_sarray_insert(&h->sa, pos, &item->field.si);                  \
+	return NULL;                                                           \
+}                                                                              \
+macro_inline const type *prefix ## _const_find_gteq(                           \
+		const struct prefix##_head *h, const type *item)               \
+{                                                                              \
+	uint32_t pos = prefix ## __pos_nuq(h, item);                           \
+	if (pos >= h->sa.count)                                                \
+		return NULL;                                                   \
+	return container_of(h->sa.array[pos], type, field.si);                 \
+}                                                                              \
+macro_inline const type *prefix ## _const_find_lt(                             \
+		const struct prefix##_head *h, const type *item)               \
+{                                                                              \
+	uint32_t pos = prefix ## __pos_nuq(h, item);                           \
+	if (pos == 0)                                                          \
+		return NULL;                                                   \
+	return container_of(h->sa.array[pos - 1], type, field.si);             \
+}                                                                              \
+TYPESAFE_FIND_CMP(prefix, type)                                                \
+macro_pure bool prefix ## _member(const struct prefix##_head *h,               \
+				  const type *item)                            \
+{                                                                              \
+	uint32_t idx = item->field.si.index;                                   \
+	if (idx >= h->sa.count)                                                \
+		return false;                                                  \
+	return h->sa.array[idx] == &item->field.si;                            \
+}                                                                              \
+macro_inline type *prefix ## _del(struct prefix##_head *h, type *item)         \
+{                                                                              \
+	if (!prefix ## _member(h, item))                                       \
+		return NULL;                                                   \
+	typesafe_sarray_remove(&h->sa, item->field.si.index);                  \
+	return item;                                                           \
+}                                                                              \
+macro_inline type *prefix ## _pop(struct prefix##_head *h)                     \
+{                                                                              \
+	struct sarray_item *sitem;                                             \
+	if (h->sa.count == 0)                                                  \
+		return NULL;                                                   \
+	sitem = h->sa.array[0];                                                \
+	typesafe_sarray_remove(&h->sa, 0);                                     \
+	return container_of(sitem, type, field.si);                            \
+}                                                                              \
+TYPESAFE_SWAP_ALL_SIMPLE(prefix)                                               \
+macro_pure const type *prefix ## _const_first(const struct prefix##_head *h)   \
+{                                                                              \
+	if (h->sa.count == 0)                                                  \
+		return NULL;                                                   \
+	return container_of(h->sa.array[0], type, field.si);                   \
+}                                                                              \
+macro_pure const type *prefix ## _const_next(const struct prefix##_head *h,    \
+					     const type *item)                 \
+{                                                                              \
+	uint32_t idx = item->field.si.index + 1;                               \
+	if (idx >= h->sa.count)                                                \
+		return NULL;                                                   \
+	return container_of(h->sa.array[idx], type, field.si);                 \
+}                                                                              \
+TYPESAFE_FIRST_NEXT(prefix, type)                                              \
+macro_pure type *prefix ## _next_safe(struct prefix##_head *h, type *item)     \
+{                                                                              \
+	if (!item)                                                             \
+		return NULL;                                                   \
+	return prefix ## _next(h, item);                                       \
+}                                                                              \
+macro_pure const type *prefix ## _const_last(const struct prefix##_head *h)    \
+{                                                                              \
+	if (h->sa.count == 0)                                                  \
+		return NULL;                                                   \
+	return container_of(h->sa.array[h->sa.count - 1], type, field.si);     \
+}                                                                              \
+macro_pure const type *prefix ## _const_prev(const struct prefix##_head *h,    \
+					     const type *item)                 \
+{                                                                              \
+	uint32_t idx = item->field.si.index;                                   \
+	if (idx == 0)                                                          \
+		return NULL;                                                   \
+	return container_of(h->sa.array[idx - 1], type, field.si);             \
+}                                                                              \
+TYPESAFE_LAST_PREV(prefix, type)                                               \
+macro_pure type *prefix ## _prev_safe(struct prefix##_head *h, type *item)     \
+{                                                                              \
+	if (!item)                                                             \
+		return NULL;                                                   \
+	return prefix ## _prev(h, item);                                       \
+}                                                                              \
+macro_pure size_t prefix ## _count(const struct prefix##_head *h)              \
+{                                                                              \
+	return h->sa.count;                                                    \
+}                                                                              \
+MACRO_REQUIRE_SEMICOLON() /* end */
+
+#define DECLARE_SORTARRAY_UNIQ(prefix, type, field, cmpfn)                     \
+	_DECLARE_SORTARRAY(prefix, type, field, cmpfn, cmpfn);                 \
+                                                                               \
+macro_inline const type *prefix ## _const_find(const struct prefix##_head *h,  \
+					       const type *item)               \
+{                                                                              \
+	const type *found = prefix ## _const_find_gteq(h, item);               \
+	if (!found || cmpfn(found, item))                                      \
+		return NULL;                                                   \
+	return found;                                                          \
+}                                                                              \
+TYPESAFE_FIND(prefix, type)                                                    \
+MACRO_REQUIRE_SEMICOLON() /* end */
+
+#define DECLARE_SORTARRAY_NONUNIQ(prefix, type, field, cmpfn)                  \
+macro_inline int _ ## prefix ## _cmp(const type *a, const type *b)             \
+{                                                                              \
+	int cmpval = cmpfn(a, b);                                              \
+	if (cmpval)                                                            \
+		return cmpval;                                                 \
+	if (a < b)                                                             \
+		return -1;                                                     \
+	if (a > b)                                                             \
+		return 1;                                                      \
+	return 0;                                                              \
+}                                                                              \
+	_DECLARE_SORTARRAY(prefix, type, field, cmpfn, _ ## prefix ## _cmp);   \
+MACRO_REQUIRE_SEMICOLON() /* end */
+
+extern void typesafe_sarray_insert(struct sarray_head *head, uint32_t pos,
+				   struct sarray_item *item);
+extern void typesafe_sarray_remove(struct sarray_head *head, uint32_t pos);
+
 #ifdef __cplusplus
 }
 #endif
@@ -61,7 +61,8 @@ enum vty_event {
 #ifdef VTYSH
 	VTYSH_SERV,
 	VTYSH_READ,
-	VTYSH_WRITE
+	VTYSH_WRITE,
+	VTYSH_CONTINUE
 #endif /* VTYSH */
 };
 
@@ -121,21 +122,11 @@ static char integrate_default[] = SYSCONFDIR INTEGRATE_DEFAULT_CONFIG;
 static bool do_log_commands;
 static bool do_log_commands_perm;
 
-void vty_mgmt_resume_response(struct vty *vty, bool success)
+/* send the result of a command that finished after returning to vtysh */
+static void vtysh_resume_response(struct vty *vty, int ret)
 {
 	uint8_t header[4] = {0, 0, 0, 0};
-	int ret = CMD_SUCCESS;
-
-	if (!vty->mgmt_req_pending) {
-		zlog_err(
-			"vty response called without setting mgmt_req_pending");
-		return;
-	}
-
-	if (!success)
-		ret = CMD_WARNING_CONFIG_FAILED;
 
-	vty->mgmt_req_pending = false;
 	header[3] = ret;
 	buffer_put(vty->obuf, header, 4);
 
@@ -151,6 +142,73 @@ void vty_mgmt_resume_response(struct vty *vty, bool success)
 		vty_event(VTYSH_READ, vty);
 }
 
+void vty_mgmt_resume_response(struct vty *vty, bool success)
+{
+	int ret = CMD_SUCCESS;
+
+	if (!vty->mgmt_req_pending) {
+		zlog_err(
+			"vty response called without setting mgmt_req_pending");
+		return;
+	}
+
+	if (!success)
+		ret = CMD_WARNING_CONFIG_FAILED;
+
+	vty->mgmt_req_pending = false;
+	vtysh_resume_response(vty, ret);
+}
+
+bool vty_out_can_continue(struct vty *vty)
+{
+	/*
+	 * Terminals page through their output and everything else wants it
+	 * all before the command returns; "| include" filtering and fd
+	 * passing are tied to the command's execution as well.
+	 */
+	return vty->type == VTY_SHELL_SERV && !vty->filter &&
+	       vty->pass_fd == -1 && !vty->mgmt_req_pending;
+}
+
+/* run the continuation once everything written so far has been sent */
+static void vty_out_cont_kick(struct vty *vty)
+{
+	if (buffer_empty(vty->obuf))
+		vty_event(VTYSH_CONTINUE, vty);
+	else if (!vty->t_write)
+		vty_event(VTYSH_WRITE, vty);
+}
+
+void vty_out_continue(struct vty *vty, void (*cb)(struct vty *vty, void *arg),
+		      void (*free_arg)(void *arg), void *arg)
+{
+	assert(vty_out_can_continue(vty));
+
+	vty->out_cont = cb;
+	vty->out_cont_free = free_arg;
+	vty->out_cont_arg = arg;
+	vty_out_cont_kick(vty);
+}
+
+void vty_out_done(struct vty *vty, int ret)
+{
+	vtysh_resume_response(vty, ret);
+}
+
+static void vty_out_cont_run(struct event *thread)
+{
+	struct vty *vty = EVENT_ARG(thread);
+	void (*cb)(struct vty *vty, void *arg) = vty->out_cont;
+	void *arg = vty->out_cont_arg;
+
+	/* cb owns arg now, and either continues again or finishes */
+	vty->out_cont = NULL;
+	vty->out_cont_free = NULL;
+	vty->out_cont_arg = NULL;
+
+	cb(vty, arg);
+}
+
 void vty_frame(struct vty *vty, const char *format, ...)
 {
 	va_list args;
@@ -2153,6 +2211,8 @@ static int vtysh_flush(struct vty *vty)
 		vty_close(vty);
 		return -1;
 	case BUFFER_EMPTY:
+		if (vty->out_cont)
+			vty_out_cont_kick(vty);
 		break;
 	}
 	return 0;
@@ -2256,6 +2316,12 @@ static void vtysh_read(struct event *thread)
 				if (vty->mgmt_req_pending)
 					return;
 
+				/* the command's output continues from events,
+				 * see vty_out_continue()
+				 */
+				if (vty->out_cont)
+					return;
+
 				/* warning: watchfrr hardcodes this result write
 				 */
 				header[3] = ret;
@@ -2325,6 +2391,10 @@ void vty_close(struct vty *vty)
 	EVENT_OFF(vty->t_read);
 	EVENT_OFF(vty->t_write);
 	EVENT_OFF(vty->t_timeout);
+	EVENT_OFF(vty->t_out_cont);
+
+	if (vty->out_cont_free)
+		vty->out_cont_free(vty->out_cont_arg);
 
 	if (vty->pass_fd != -1) {
 		close(vty->pass_fd);
@@ -2821,6 +2891,7 @@ static void vty_event_serv(enum vty_event event, struct vty_serv *vty_serv)
 	case VTY_TIMEOUT_RESET:
 	case VTYSH_READ:
 	case VTYSH_WRITE:
+	case VTYSH_CONTINUE:
 		assert(!"vty_event_serv() called incorrectly");
 	}
 }
@@ -2837,6 +2908,10 @@ static void vty_event(enum vty_event event, struct vty *vty)
 		event_add_write(vty_master, vtysh_write, vty, vty->wfd,
 				&vty->t_write);
 		break;
+	case VTYSH_CONTINUE:
+		event_add_event(vty_master, vty_out_cont_run, vty, 0,
+				&vty->t_out_cont);
+		break;
 #endif /* VTYSH */
 	case VTY_READ:
 		event_add_read(vty_master, vty_read, vty, vty->fd,
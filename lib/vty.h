@@ -223,6 +223,12 @@ struct vty {
 	uint64_t mgmt_req_id;
 	bool mgmt_req_pending;
 	bool mgmt_locked_candidate_ds;
+
+	/* command output continued from events, see vty_out_continue() */
+	void (*out_cont)(struct vty *vty, void *arg);
+	void (*out_cont_free)(void *arg);
+	void *out_cont_arg;
+	struct event *t_out_cont;
 };
 
 static inline void vty_push_context(struct vty *vty, int node, uint64_t id)
@@ -401,6 +407,21 @@ extern int vty_mgmt_send_lockds_req(struct vty *vty, Mgmtd__DatastoreId ds_id,
 				    bool lock);
 extern void vty_mgmt_resume_response(struct vty *vty, bool success);
 
+/*
+ * Commands producing a lot of output can hand it out in pieces instead of
+ * building all of it in the vty's output buffer: when vty_out_can_continue()
+ * says so, the command calls vty_out_continue() and returns.  cb is then run
+ * from an event each time the output written so far has been sent, so a
+ * slow reader holds the command back, and must in turn call either
+ * vty_out_continue() again or vty_out_done() with the command's result.
+ * free_arg is called on arg if the vty is closed while output is pending.
+ */
+extern bool vty_out_can_continue(struct vty *vty);
+extern void vty_out_continue(struct vty *vty,
+			     void (*cb)(struct vty *vty, void *arg),
+			     void (*free_arg)(void *arg), void *arg);
+extern void vty_out_done(struct vty *vty, int ret);
+
 static inline bool vty_needs_implicit_commit(struct vty *vty)
 {
 	return (frr_get_cli_mode() == FRR_CLI_CLASSIC
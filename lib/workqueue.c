@@ -26,6 +26,33 @@ static struct list *work_queues = &_work_queues;
 
 #define WORK_QUEUE_MIN_GRANULARITY 1
 
+/* bounds for the adaptive time budget */
+#define WORK_QUEUE_MIN_BUDGET (1000UL)
+#define WORK_QUEUE_MAX_BUDGET_FACTOR 8
+
+/* share of its budget a queue gets while a higher class has work */
+#define WORK_QUEUE_THROTTLE_FACTOR 4
+
+/* unplugged queues with items, per class */
+static unsigned int work_queues_busy[WQ_PRIO_HIGH + 1];
+
+/* keep work_queues_busy in line, after items come and go or on plugging */
+static void work_queue_busy_update(struct work_queue *wq)
+{
+	int busy = -1;
+
+	if (!work_queue_empty(wq) && CHECK_FLAG(wq->flags, WQ_UNPLUGGED))
+		busy = wq->spec.priority;
+	if (busy == wq->busy_class)
+		return;
+
+	if (wq->busy_class >= 0)
+		work_queues_busy[wq->busy_class]--;
+	if (busy >= 0)
+		work_queues_busy[busy]++;
+	wq->busy_class = busy;
+}
+
 static struct work_queue_item *work_queue_item_new(struct work_queue *wq)
 {
 	struct work_queue_item *item;
@@ -52,6 +79,7 @@ static void work_queue_item_remove(struct work_queue *wq,
 		wq->spec.del_item_data(wq, item->data);
 
 	work_queue_item_dequeue(wq, item);
+	work_queue_busy_update(wq);
 
 	work_queue_item_free(item);
 
@@ -79,6 +107,9 @@ struct work_queue *work_queue_new(struct event_loop *m, const char *queue_name)
 	new->spec.hold = WORK_QUEUE_DEFAULT_HOLD;
 	new->spec.yield = EVENT_YIELD_TIME_SLOT;
 	new->spec.retry = WORK_QUEUE_DEFAULT_RETRY;
+	new->spec.priority = WQ_PRIO_NORMAL;
+	new->spec.lag_target = WORK_QUEUE_DEFAULT_LAG_TARGET;
+	new->busy_class = -1;
 
 	return new;
 }
@@ -96,6 +127,8 @@ void work_queue_free_and_null(struct work_queue **wqp)
 	}
 
 	listnode_delete(work_queues, wq);
+	UNSET_FLAG(wq->flags, WQ_UNPLUGGED);
+	work_queue_busy_update(wq);
 
 	XFREE(MTYPE_WORK_QUEUE_NAME, wq->name);
 	XFREE(MTYPE_WORK_QUEUE, wq);
@@ -143,6 +176,7 @@ void work_queue_add(struct work_queue *wq, void *data)
 
 	item->data = data;
 	work_queue_item_enqueue(wq, item);
+	work_queue_busy_update(wq);
 
 	work_queue_schedule(wq, wq->spec.hold);
 
@@ -167,20 +201,30 @@ DEFUN (show_work_queues,
 	struct listnode *node;
 	struct work_queue *wq;
 
-	vty_out(vty, "%c %8s %5s %8s %8s %21s\n", ' ', "List", "(ms) ",
-		"Q. Runs", "Yields", "Cycle Counts   ");
-	vty_out(vty, "%c %8s %5s %8s %8s %7s %6s %8s %6s %s\n", 'P', "Items",
-		"Hold", "Total", "Total", "Best", "Gran.", "Total", "Avg.",
-		"Name");
+	static const char *const prio_str[] = {
+		[WQ_PRIO_LOW] = "low",
+		[WQ_PRIO_NORMAL] = "norm",
+		[WQ_PRIO_HIGH] = "high",
+	};
+
+	vty_out(vty, "%c %8s %5s %8s %8s %21s %4s %8s %8s\n", ' ', "List",
+		"(ms) ", "Q. Runs", "Yields", "Cycle Counts   ", "", "Budget",
+		"Throttle");
+	vty_out(vty, "%c %8s %5s %8s %8s %7s %6s %8s %6s %4s %8s %8s %s\n", 'P',
+		"Items", "Hold", "Total", "Total", "Best", "Gran.", "Total",
+		"Avg.", "Prio", "(us)", "Total", "Name");
 
 	for (ALL_LIST_ELEMENTS_RO(work_queues, node, wq)) {
-		vty_out(vty, "%c %8d %5d %8ld %8ld %7d %6d %8ld %6u %s\n",
+		vty_out(vty,
+			"%c %8d %5d %8ld %8ld %7d %6d %8ld %6u %4s %8lu %8lu %s\n",
 			(CHECK_FLAG(wq->flags, WQ_UNPLUGGED) ? ' ' : 'P'),
 			work_queue_item_count(wq), wq->spec.hold, wq->runs,
 			wq->yields, wq->cycles.best, wq->cycles.granularity,
 			wq->cycles.total,
 			(wq->runs) ? (unsigned int)(wq->cycles.total / wq->runs)
 				   : 0,
+			prio_str[wq->spec.priority],
+			wq->budget ? wq->budget : wq->spec.yield, wq->throttled,
 			wq->name);
 	}
 
@@ -200,6 +244,7 @@ void work_queue_plug(struct work_queue *wq)
 	EVENT_OFF(wq->thread);
 
 	UNSET_FLAG(wq->flags, WQ_UNPLUGGED);
+	work_queue_busy_update(wq);
 }
 
 /* unplug queue, schedule it again, if appropriate
@@ -208,11 +253,61 @@ void work_queue_plug(struct work_queue *wq)
 void work_queue_unplug(struct work_queue *wq)
 {
 	SET_FLAG(wq->flags, WQ_UNPLUGGED);
+	work_queue_busy_update(wq);
 
 	/* if thread isnt already waiting, add one */
 	work_queue_schedule(wq, wq->spec.hold);
 }
 
+/* Time budget for this run: while a queue of a higher class has work, give
+ * it most of the time.  (All work queues run on the main pthread, so this
+ * doesn't bother telling event loops apart.)
+ */
+static unsigned long work_queue_run_budget(struct work_queue *wq)
+{
+	int prio;
+
+	if (!wq->budget)
+		wq->budget = wq->spec.yield;
+
+	/* spec.priority may have been changed since */
+	work_queue_busy_update(wq);
+
+	for (prio = wq->spec.priority + 1; prio <= WQ_PRIO_HIGH; prio++) {
+		if (!work_queues_busy[prio])
+			continue;
+
+		wq->throttled++;
+		return MAX(wq->budget / WORK_QUEUE_THROTTLE_FACTOR,
+			   WORK_QUEUE_MIN_BUDGET);
+	}
+
+	return wq->budget;
+}
+
+/* Tune the time budget against how late timers on the event loop run:
+ * back off quickly when the loop lags behind, grow slowly while the queue
+ * still has work to do and there's headroom.
+ */
+static void work_queue_adapt_budget(struct work_queue *wq, bool yielded)
+{
+	unsigned long lag, max;
+
+	if (!wq->spec.lag_target) {
+		wq->budget = wq->spec.yield;
+		return;
+	}
+
+	lag = event_loop_lag(wq->master);
+	max = MAX(wq->spec.yield * WORK_QUEUE_MAX_BUDGET_FACTOR,
+		  WORK_QUEUE_MIN_BUDGET);
+
+	if (lag > wq->spec.lag_target)
+		wq->budget = MAX(wq->budget / 2, WORK_QUEUE_MIN_BUDGET);
+	else if (yielded && lag < wq->spec.lag_target / 2)
+		wq->budget = MIN(wq->budget + wq->budget / 8 + 1, max);
+}
+
 /* timer thread to process a work queue
  * will reschedule itself if required,
  * otherwise work_queue_item_add
@@ -251,6 +346,8 @@ void work_queue_run(struct event *thread)
 	if (wq->cycles.granularity == 0)
 		wq->cycles.granularity = WORK_QUEUE_MIN_GRANULARITY;
 
+	event_set_yield_time(thread, work_queue_run_budget(wq));
+
 	STAILQ_FOREACH_SAFE (item, &wq->items, wq, titem) {
 		assert(item->data);
 
@@ -347,6 +444,7 @@ stats:
 	wq->cycles.total += cycles;
 	if (yielded)
 		wq->yields++;
+	work_queue_adapt_budget(wq, yielded);
 
 	/* Is the queue done yet? If it is, call the completion callback. */
 	if (!work_queue_empty(wq)) {
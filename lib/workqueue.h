@@ -23,6 +23,19 @@ DECLARE_MTYPE(WORK_QUEUE);
 /* Retry for queue that is 'blocked' or 'retry later' */
 #define WORK_QUEUE_DEFAULT_RETRY 0
 
+/* Event loop timer lag the time budget is tuned against, in usec */
+#define WORK_QUEUE_DEFAULT_LAG_TARGET (50 * 1000L)
+
+/*
+ * While a queue of a higher class has work on the same event loop, queues
+ * of lower classes only get a fraction of their time budget.
+ */
+enum work_queue_priority {
+	WQ_PRIO_LOW = 0,
+	WQ_PRIO_NORMAL,
+	WQ_PRIO_HIGH,
+};
+
 /* action value, for use by item processor and item error handlers */
 typedef enum {
 	WQ_SUCCESS = 0,
@@ -80,6 +93,14 @@ struct work_queue {
 			yield; /* yield time in us for associated thread */
 
 		uint32_t retry; /* Optional retry timeout if queue is blocked */
+
+		enum work_queue_priority priority;
+
+		/* Timer lag (see event_loop_lag()) to aim for, in us.  The
+		 * time budget per run starts out at ->yield and is adjusted
+		 * to keep the event loop below this; 0 disables that.
+		 */
+		unsigned long lag_target;
 	} spec;
 
 	/* remaining fields should be opaque to users */
@@ -88,6 +109,9 @@ struct work_queue {
 	int item_count;       /* queued items */
 	unsigned long runs;   /* runs count */
 	unsigned long yields; /* yields count */
+	unsigned long budget; /* current time budget per run, in us */
+	unsigned long throttled; /* runs cut short for higher classes */
+	int busy_class; /* class this is counted as busy in, -1 if not */
 
 	struct {
 		unsigned int best;
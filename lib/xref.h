@@ -27,6 +27,8 @@ enum xref_type {
 
 	XREFT_DEFUN = 0x300,
 	XREFT_INSTALL_ELEMENT = 0x301,
+
+	XREFT_FLIGHTREC = 0x400,
 };
 
 /* struct xref is the "const" part;  struct xrefdata is the writable part. */
@@ -6,7 +6,11 @@
 
 #include <zebra.h>
 
+#include <sys/mman.h>
+
 #include "log.h"
+#include "monotime.h"
+#include "vty.h"
 #include "lib_errors.h"
 #include "yang.h"
 #include "yang_translator.h"
@@ -18,6 +22,13 @@ DEFINE_MTYPE_STATIC(LIB, YANG_DATA, "YANG data structure");
 /* libyang container. */
 struct ly_ctx *ly_native_ctx;
 
+/* how ly_native_ctx was set up, for "show yang module" */
+static struct timeval yang_init_time;
+static int64_t yang_load_usec;
+static const char *yang_shared_path;
+static void *yang_shared_mem;
+static size_t yang_shared_size;
+
 static struct yang_module_embed *embeds, **embedupd = &embeds;
 
 void yang_module_embed(struct yang_module_embed *embed)
@@ -102,8 +113,13 @@ struct yang_module *yang_module_load(const char *module_name)
 	struct yang_module *module;
 	const struct lys_module *module_info;
 
-	module_info =
-		ly_ctx_load_module(ly_native_ctx, module_name, NULL, NULL);
+	/* a shared context can't be changed, it has everything already */
+	if (yang_shared_mem)
+		module_info = ly_ctx_get_module_implemented(ly_native_ctx,
+							    module_name);
+	else
+		module_info = ly_ctx_load_module(ly_native_ctx, module_name,
+						 NULL, NULL);
 	if (!module_info) {
 		flog_err(EC_LIB_YANG_MODULE_LOAD,
 			 "%s: failed to load data model: %s", __func__,
@@ -122,6 +138,7 @@ struct yang_module *yang_module_load(const char *module_name)
 		exit(1);
 	}
 
+	yang_load_usec = monotime_since(&yang_init_time, NULL);
 	return module;
 }
 
@@ -732,11 +749,18 @@ struct ly_ctx *yang_ctx_new_setup(bool embedded_modules, bool explicit_compile)
 	return ctx;
 }
 
-void yang_init(bool embedded_modules, bool defer_compile)
+static void yang_init_ly(void)
 {
+	monotime(&yang_init_time);
+
 	/* Initialize libyang global parameters that affect all containers. */
 	ly_set_log_clb(ly_log_cb, 1);
 	ly_log_options(LY_LOLOG | LY_LOSTORE);
+}
+
+void yang_init(bool embedded_modules, bool defer_compile)
+{
+	yang_init_ly();
 
 	/* Initialize libyang container for native models. */
 	ly_native_ctx = yang_ctx_new_setup(embedded_modules, defer_compile);
@@ -748,8 +772,223 @@ void yang_init(bool embedded_modules, bool defer_compile)
 	yang_translator_init();
 }
 
+#if defined(HAVE_LY_CTX_NEW_PRINTED) && UINTPTR_MAX > UINT32_MAX
+/*
+ * A printed context is full of pointers into itself, so it has to be
+ * mapped at the address it was printed at.  That's somewhere in the
+ * middle of the (64-bit) address space, away from where the kernel puts
+ * the heap, libraries and stacks.
+ */
+#define YANG_SHARED_ADDR ((void *)0x3f5a00000000ULL)
+#define YANG_SHARED_MAGIC "FRRYCTX1"
+
+/* the context itself starts after the header, page aligned on anything */
+#define YANG_SHARED_OFFSET 65536
+
+struct yang_shared_hdr {
+	char magic[8];
+	char frr_version[32];
+	char ly_version[32];
+	uint64_t addr;
+	uint64_t size;
+};
+
+static void yang_shared_hdr_init(struct yang_shared_hdr *hdr, size_t size)
+{
+	memset(hdr, 0, sizeof(*hdr));
+	memcpy(hdr->magic, YANG_SHARED_MAGIC, sizeof(hdr->magic));
+	strlcpy(hdr->frr_version, FRR_VERSION, sizeof(hdr->frr_version));
+	strlcpy(hdr->ly_version, ly_version_so.str, sizeof(hdr->ly_version));
+	hdr->addr = (uintptr_t)YANG_SHARED_ADDR;
+	hdr->size = size;
+}
+
+static struct ly_ctx *yang_shared_map(const char *path,
+				      const char *const modules[],
+				      size_t nmodules)
+{
+	struct yang_shared_hdr hdr, ref;
+	struct ly_ctx *ctx = NULL;
+	struct stat st;
+	void *mem;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		if (errno != ENOENT)
+			zlog_warn("cannot open shared YANG context %s: %s",
+				  path, safe_strerror(errno));
+		return NULL;
+	}
+
+	if (read(fd, &hdr, sizeof(hdr)) != (ssize_t)sizeof(hdr) ||
+	    fstat(fd, &st)) {
+		zlog_warn("cannot read shared YANG context %s: %s", path,
+			  safe_strerror(errno));
+		close(fd);
+		return NULL;
+	}
+
+	yang_shared_hdr_init(&ref, hdr.size);
+	if (memcmp(&hdr, &ref, sizeof(hdr)) ||
+	    (uint64_t)st.st_size < YANG_SHARED_OFFSET + hdr.size) {
+		zlog_warn("shared YANG context %s was built for another FRR or libyang version, ignoring it",
+			  path);
+		close(fd);
+		return NULL;
+	}
+
+	/*
+	 * Copy-on-write: the pages stay shared with the page cache, and so
+	 * with the other daemons, until written to.  That only happens for
+	 * the snode->priv pointers of the modules the daemon has callbacks
+	 * for, see nb_node_new().
+	 */
+	mem = mmap(YANG_SHARED_ADDR, hdr.size, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE, fd, YANG_SHARED_OFFSET);
+	close(fd);
+	if (mem == MAP_FAILED) {
+		zlog_warn("cannot map shared YANG context %s: %s", path,
+			  safe_strerror(errno));
+		return NULL;
+	}
+	if (mem != YANG_SHARED_ADDR) {
+		zlog_warn("shared YANG context %s: address %p is in use",
+			  path, YANG_SHARED_ADDR);
+		munmap(mem, hdr.size);
+		return NULL;
+	}
+
+	if (ly_ctx_new_printed(mem, &ctx) != LY_SUCCESS) {
+		zlog_warn("shared YANG context %s is not usable", path);
+		munmap(mem, hdr.size);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < nmodules; i++) {
+		if (ly_ctx_get_module_implemented(ctx, modules[i]))
+			continue;
+
+		zlog_warn("shared YANG context %s does not have %s, ignoring it",
+			  path, modules[i]);
+		munmap(mem, hdr.size);
+		return NULL;
+	}
+
+	yang_shared_mem = mem;
+	yang_shared_size = hdr.size;
+	yang_shared_path = path;
+	return ctx;
+}
+
+int yang_ctx_shared_write(const char *path)
+{
+	struct yang_shared_hdr hdr;
+	char tmppath[PATH_MAX];
+	void *mem, *mem_end;
+	size_t size;
+	int fd, ret = -1;
+
+	size = ly_ctx_compiled_size(ly_native_ctx);
+
+	mem = mmap(YANG_SHARED_ADDR, size, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED)
+		return -1;
+	if (mem != YANG_SHARED_ADDR) {
+		errno = EADDRINUSE;
+		goto out_unmap;
+	}
+
+	if (ly_ctx_compiled_print(ly_native_ctx, mem, &mem_end) !=
+	    LY_SUCCESS) {
+		errno = EINVAL;
+		goto out_unmap;
+	}
+	assert((size_t)((char *)mem_end - (char *)mem) == size);
+
+	snprintf(tmppath, sizeof(tmppath), "%s.tmp", path);
+	fd = open(tmppath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		goto out_unmap;
+
+	yang_shared_hdr_init(&hdr, size);
+	if (pwrite(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) ||
+	    pwrite(fd, mem, size, YANG_SHARED_OFFSET) != (ssize_t)size ||
+	    fsync(fd) || rename(tmppath, path)) {
+		close(fd);
+		unlink(tmppath);
+		goto out_unmap;
+	}
+	close(fd);
+	ret = 0;
+
+out_unmap:
+	munmap(mem, size);
+	return ret;
+}
+#else
+static struct ly_ctx *yang_shared_map(const char *path,
+				      const char *const modules[],
+				      size_t nmodules)
+{
+	return NULL;
+}
+
+int yang_ctx_shared_write(const char *path)
+{
+	errno = ENOTSUP;
+	return -1;
+}
+#endif
+
+void yang_init_shared(const char *path, const char *const modules[],
+		      size_t nmodules, bool defer_compile)
+{
+	yang_init_ly();
+
+	ly_native_ctx = yang_shared_map(path, modules, nmodules);
+	if (ly_native_ctx)
+		zlog_info("using shared YANG context %s (%zu KiB)", path,
+			  yang_shared_size / 1024);
+	else
+		ly_native_ctx = yang_ctx_new_setup(true, defer_compile);
+	if (!ly_native_ctx) {
+		flog_err(EC_LIB_LIBYANG, "%s: ly_ctx_new() failed", __func__);
+		exit(1);
+	}
+
+	yang_translator_init();
+}
+
+void yang_ctx_show(struct vty *vty)
+{
+	if (yang_shared_mem) {
+		vty_out(vty,
+			" Shared context %s, %zu KiB mapped, loaded in %" PRId64
+			" ms\n",
+			yang_shared_path, yang_shared_size / 1024,
+			yang_load_usec / 1000);
+		return;
+	}
+
+#ifdef HAVE_LY_CTX_NEW_PRINTED
+	vty_out(vty,
+		" Private context, %d KiB compiled, loaded in %" PRId64
+		" ms\n",
+		ly_ctx_compiled_size(ly_native_ctx) / 1024,
+		yang_load_usec / 1000);
+#else
+	vty_out(vty, " Private context, loaded in %" PRId64 " ms\n",
+		yang_load_usec / 1000);
+#endif
+}
+
 void yang_init_loading_complete(void)
 {
+	if (yang_shared_mem)
+		return;
+
 	/* Compile everything */
 	if (ly_ctx_compile(ly_native_ctx) != LY_SUCCESS) {
 		flog_err(EC_LIB_YANG_MODULE_LOAD,
@@ -757,6 +996,7 @@ void yang_init_loading_complete(void)
 			 ly_errmsg(ly_native_ctx));
 		exit(1);
 	}
+	yang_load_usec = monotime_since(&yang_init_time, NULL);
 }
 
 void yang_terminate(void)
@@ -778,6 +1018,14 @@ void yang_terminate(void)
 		XFREE(MTYPE_YANG_MODULE, module);
 	}
 
+	if (yang_shared_mem) {
+		/* nothing in there belongs to us */
+		munmap(yang_shared_mem, yang_shared_size);
+		yang_shared_mem = NULL;
+		ly_native_ctx = NULL;
+		return;
+	}
+
 	ly_ctx_destroy(ly_native_ctx);
 }
 
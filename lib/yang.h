@@ -608,6 +608,28 @@ extern const char *yang_print_errors(struct ly_ctx *ly_ctx, char *buf,
  */
 extern void yang_init(bool embedded_modules, bool defer_compile);
 
+/* installed by "make install" with --enable-yang-shared-context */
+#define YANG_SHARED_CTX_PATH YANG_MODELS_PATH "/frr-yang.ctx"
+
+/*
+ * Like yang_init(), but use the shared compiled context at path if there
+ * is a usable one with all of the listed modules in it, see
+ * tools/gen_yang_context.  Modules can't be added to it, so
+ * yang_module_load() only looks them up then.
+ */
+extern void yang_init_shared(const char *path, const char *const modules[],
+			     size_t nmodules, bool defer_compile);
+
+/*
+ * Print the compiled native context into a file yang_init_shared() can
+ * use.  Returns -1 with errno set on failure.
+ */
+extern int yang_ctx_shared_write(const char *path);
+
+/* "show yang module" summary of how the native context was set up */
+struct vty;
+extern void yang_ctx_show(struct vty *vty);
+
 /*
  * Should be called after yang_init and all yang_module_load()s have been done,
  * compiles all modules loaded into the yang context.
@@ -70,6 +70,7 @@ struct zclient *zclient_new(struct event_loop *master,
 	zclient->n_handlers = n_handlers;
 
 	zclient->receive_notify = opt->receive_notify;
+	zclient->receive_notify_batch = opt->receive_notify_batch;
 	zclient->synchronous = opt->synchronous;
 
 	return zclient;
@@ -170,6 +171,7 @@ void zclient_stop(struct zclient *zclient)
 
 	/* Empty the write buffer. */
 	buffer_reset(zclient->wb);
+	zclient->batch = 0;
 
 	/* Close socket. */
 	if (zclient->sock >= 0) {
@@ -286,6 +288,11 @@ enum zclient_send_status zclient_send_message(struct zclient *zclient)
 {
 	if (zclient->sock < 0)
 		return ZCLIENT_SEND_FAILURE;
+	if (zclient->batch) {
+		buffer_put(zclient->wb, STREAM_DATA(zclient->obuf),
+			   stream_get_endp(zclient->obuf));
+		return ZCLIENT_SEND_BUFFERED;
+	}
 	switch (buffer_write(zclient->wb, zclient->sock,
 			     STREAM_DATA(zclient->obuf),
 			     stream_get_endp(zclient->obuf))) {
@@ -307,6 +314,39 @@ enum zclient_send_status zclient_send_message(struct zclient *zclient)
 	return ZCLIENT_SEND_SUCCESS;
 }
 
+void zclient_batch_begin(struct zclient *zclient)
+{
+	zclient->batch++;
+}
+
+enum zclient_send_status zclient_batch_end(struct zclient *zclient)
+{
+	if (!zclient->batch || --zclient->batch)
+		return ZCLIENT_SEND_BUFFERED;
+	if (zclient->sock < 0)
+		return ZCLIENT_SEND_FAILURE;
+	/* already waiting for the socket to drain */
+	if (zclient->t_write)
+		return ZCLIENT_SEND_BUFFERED;
+
+	switch (buffer_flush_available(zclient->wb, zclient->sock)) {
+	case BUFFER_ERROR:
+		flog_err(EC_LIB_ZAPI_SOCKET,
+			 "%s: buffer_flush_available failed to zclient fd %d, closing",
+			 __func__, zclient->sock);
+		return zclient_failed(zclient);
+	case BUFFER_EMPTY:
+		return ZCLIENT_SEND_SUCCESS;
+	case BUFFER_PENDING:
+		event_add_write(zclient->master, zclient_flush_data, zclient,
+				zclient->sock, &zclient->t_write);
+		return ZCLIENT_SEND_BUFFERED;
+	}
+
+	/* should not get here */
+	return ZCLIENT_SEND_SUCCESS;
+}
+
 /*
  * If we add more data to this structure please ensure that
  * struct zmsghdr in lib/zclient.h is updated as appropriate.
@@ -400,6 +440,7 @@ enum zclient_send_status zclient_send_hello(struct zclient *zclient)
 			stream_putc(s, 1);
 		else
 			stream_putc(s, 0);
+		stream_putc(s, zclient->receive_notify_batch);
 
 		stream_putw_at(s, 0, stream_get_endp(s));
 		return zclient_send_message(zclient);
@@ -757,14 +798,14 @@ static void zclient_connect(struct event *t)
 	zclient_start(zclient);
 }
 
-enum zclient_send_status zclient_send_rnh(struct zclient *zclient, int command,
-					  const struct prefix *p, safi_t safi,
-					  bool connected, bool resolve_via_def,
-					  vrf_id_t vrf_id)
+/*
+ * Encodes a nexthop (un)registration, for callers that want to send several
+ * messages in one write.  zclient_send_rnh() encodes and sends it right away.
+ */
+void zapi_rnh_encode(struct stream *s, int command, const struct prefix *p,
+		     safi_t safi, bool connected, bool resolve_via_def,
+		     vrf_id_t vrf_id)
 {
-	struct stream *s;
-
-	s = zclient->obuf;
 	stream_reset(s);
 	zclient_create_header(s, command, vrf_id);
 	stream_putc(s, (connected) ? 1 : 0);
@@ -783,6 +824,15 @@ enum zclient_send_status zclient_send_rnh(struct zclient *zclient, int command,
 		break;
 	}
 	stream_putw_at(s, 0, stream_get_endp(s));
+}
+
+enum zclient_send_status zclient_send_rnh(struct zclient *zclient, int command,
+					  const struct prefix *p, safi_t safi,
+					  bool connected, bool resolve_via_def,
+					  vrf_id_t vrf_id)
+{
+	zapi_rnh_encode(zclient->obuf, command, p, safi, connected,
+			resolve_via_def, vrf_id);
 
 	return zclient_send_message(zclient);
 }
@@ -817,6 +867,75 @@ zclient_route_send(uint8_t cmd, struct zclient *zclient, struct zapi_route *api)
 	return zclient_send_message(zclient);
 }
 
+/*
+ * Install a set of routes that only differ in their prefix with as few
+ * ZEBRA_ROUTE_ADD_BATCH messages as possible.  All other attributes are
+ * taken from api, which must refer to a nexthop group by ID and cannot
+ * carry a source prefix; api->prefix is overwritten.
+ *
+ * Each message is a regular route add for the first prefix, followed by
+ * the number of further prefixes and then each of them as length and
+ * address octets of the same family.
+ */
+enum zclient_send_status
+zclient_route_send_batch(struct zclient *zclient, struct zapi_route *api,
+			 const struct prefix *prefixes, uint32_t count)
+{
+	enum zclient_send_status status = ZCLIENT_SEND_SUCCESS;
+	struct stream *s = zclient->obuf;
+	uint32_t i = 0, n;
+	size_t cntp;
+	int psize;
+
+	if (!CHECK_FLAG(api->message, ZAPI_MESSAGE_NHG) ||
+	    CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX)) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: route batches need a nexthop group ID and no source prefix",
+			 __func__);
+		return ZCLIENT_SEND_FAILURE;
+	}
+
+	while (i < count) {
+		api->prefix = prefixes[i++];
+		if (zapi_route_encode(ZEBRA_ROUTE_ADD_BATCH, s, api) < 0)
+			return ZCLIENT_SEND_FAILURE;
+
+		cntp = stream_get_endp(s);
+		stream_putw(s, 0);
+
+		for (n = 0; i < count && n < UINT16_MAX; n++, i++) {
+			if (prefixes[i].family != api->prefix.family) {
+				flog_err(EC_LIB_ZAPI_ENCODE,
+					 "%s: prefix %pFX: mixed address families in batch",
+					 __func__, &prefixes[i]);
+				return ZCLIENT_SEND_FAILURE;
+			}
+
+			psize = PSIZE(prefixes[i].prefixlen);
+			if (STREAM_WRITEABLE(s) < (size_t)psize + 1)
+				break;
+
+			stream_putc(s, prefixes[i].prefixlen);
+			stream_write(s, &prefixes[i].u.prefix, psize);
+		}
+
+		stream_putw_at(s, cntp, n);
+		stream_putw_at(s, 0, stream_get_endp(s));
+
+		switch (zclient_send_message(zclient)) {
+		case ZCLIENT_SEND_FAILURE:
+			return ZCLIENT_SEND_FAILURE;
+		case ZCLIENT_SEND_BUFFERED:
+			status = ZCLIENT_SEND_BUFFERED;
+			break;
+		case ZCLIENT_SEND_SUCCESS:
+			break;
+		}
+	}
+
+	return status;
+}
+
 static int zapi_nexthop_labels_cmp(const struct zapi_nexthop *next1,
 				   const struct zapi_nexthop *next2)
 {
@@ -1778,6 +1897,82 @@ stream_failure:
 	return false;
 }
 
+/*
+ * ZEBRA_ROUTE_NOTIFY_OWNER_BATCH carries the result for a number of
+ * prefixes that share note, table, afi and safi.  Each of them is handed
+ * to the daemon's ZEBRA_ROUTE_NOTIFY_OWNER handler as if it had been sent
+ * on its own, so daemons keep using zapi_route_notify_decode() and only
+ * have to set receive_notify_batch to get these.
+ */
+static int zclient_route_notify_batch(ZAPI_CALLBACK_ARGS)
+{
+	zclient_handler *handler = NULL;
+	struct stream *s = zclient->ibuf;
+	struct stream *single;
+	enum zapi_route_notify_owner note;
+	uint8_t family, afi, safi;
+	uint32_t table_id;
+	uint16_t count, i;
+	struct prefix p;
+	int psize;
+
+	if (ZEBRA_ROUTE_NOTIFY_OWNER < zclient->n_handlers)
+		handler = zclient->handlers[ZEBRA_ROUTE_NOTIFY_OWNER];
+	if (!handler)
+		return 0;
+
+	STREAM_GET(&note, s, sizeof(note));
+	STREAM_GETC(s, family);
+	STREAM_GETL(s, table_id);
+	STREAM_GETC(s, afi);
+	STREAM_GETC(s, safi);
+	STREAM_GETW(s, count);
+
+	memset(&p, 0, sizeof(p));
+	p.family = family;
+
+	single = stream_new(ZEBRA_HEADER_SIZE + sizeof(note) + 8 +
+			    sizeof(p.u.prefix));
+
+	for (i = 0; i < count; i++) {
+		if (STREAM_READABLE(s) < 1)
+			break;
+		p.prefixlen = stream_getc(s);
+		psize = PSIZE(p.prefixlen);
+		if (p.prefixlen > prefix_blen(&p) * 8 ||
+		    STREAM_READABLE(s) < (size_t)psize)
+			break;
+		memset(&p.u, 0, sizeof(p.u));
+		stream_get(&p.u.prefix, s, psize);
+
+		/* same layout as a single ZEBRA_ROUTE_NOTIFY_OWNER */
+		stream_reset(single);
+		stream_put(single, &note, sizeof(note));
+		stream_putc(single, p.family);
+		stream_putc(single, p.prefixlen);
+		stream_put(single, &p.u.prefix, prefix_blen(&p));
+		stream_putl(single, table_id);
+		stream_putc(single, afi);
+		stream_putc(single, safi);
+
+		zclient->ibuf = single;
+		handler(ZEBRA_ROUTE_NOTIFY_OWNER, zclient,
+			stream_get_endp(single), vrf_id);
+		zclient->ibuf = s;
+	}
+
+	if (i < count)
+		flog_err(EC_LIB_ZAPI_MISSMATCH,
+			 "%s: truncated route notification batch, %u of %u read",
+			 __func__, i, count);
+
+	stream_free(single);
+	return 0;
+
+stream_failure:
+	return -1;
+}
+
 bool zapi_rule_notify_decode(struct stream *s, uint32_t *seqno,
 			     uint32_t *priority, uint32_t *unique, char *ifname,
 			     enum zapi_rule_notify_owner *note)
@@ -2143,6 +2338,7 @@ int zebra_route_notify_send(int command, struct zclient *zclient, bool set)
 
 	zclient_create_header(s, command, 0);
 	stream_putc(s, !!set);
+	stream_putc(s, zclient->receive_notify_batch);
 
 	stream_putw_at(s, 0, stream_get_endp(s));
 
@@ -2376,6 +2572,101 @@ static int zclient_interface_down(ZAPI_CALLBACK_ARGS)
 	return 0;
 }
 
+/*
+ * ZEBRA_INTERFACE_STATE_BULK: a run of ZEBRA_INTERFACE_UP/DOWN updates in
+ * one message.  Each entry is the command and its length, followed by the
+ * interface as in the single messages; an entry for an interface we don't
+ * know is skipped.
+ */
+static int zclient_interface_state_bulk(ZAPI_CALLBACK_ARGS)
+{
+	struct interface *ifp;
+	struct stream *s = zclient->ibuf;
+	uint16_t count, ifcmd, len, i;
+	size_t next;
+
+	STREAM_GETW(s, count);
+
+	for (i = 0; i < count; i++) {
+		STREAM_GETW(s, ifcmd);
+		STREAM_GETW(s, len);
+		if (STREAM_READABLE(s) < len)
+			goto stream_failure;
+		next = stream_get_getp(s) + len;
+
+		ifp = zebra_interface_state_read(s, vrf_id);
+		if (ifp) {
+			if (ifcmd == ZEBRA_INTERFACE_UP)
+				if_up_via_zapi(ifp);
+			else
+				if_down_via_zapi(ifp);
+		}
+
+		stream_set_getp(s, next);
+	}
+
+	return 0;
+
+stream_failure:
+	return -1;
+}
+
+/*
+ * ZEBRA_REDISTRIBUTE_ROUTE_BULK: a number of ZEBRA_REDISTRIBUTE_ROUTE_ADD
+ * and _DEL messages, each complete with its header.  They are handed to
+ * the daemon's handlers as if they had been sent on their own.
+ */
+static int zclient_redistribute_route_bulk(ZAPI_CALLBACK_ARGS)
+{
+	zclient_handler *handler;
+	struct stream *s = zclient->ibuf;
+	struct stream *single;
+	struct zmsghdr hdr;
+	uint16_t count, i;
+
+	STREAM_GETW(s, count);
+
+	single = stream_new(ZEBRA_MAX_PACKET_SIZ);
+
+	for (i = 0; i < count; i++) {
+		if (STREAM_READABLE(s) < ZEBRA_HEADER_SIZE)
+			break;
+
+		stream_reset(single);
+		stream_put(single, stream_pnt(s), ZEBRA_HEADER_SIZE);
+		zapi_parse_header(single, &hdr);
+		if (hdr.length < ZEBRA_HEADER_SIZE ||
+		    STREAM_READABLE(s) < hdr.length)
+			break;
+
+		stream_put(single, stream_pnt(s) + ZEBRA_HEADER_SIZE,
+			   hdr.length - ZEBRA_HEADER_SIZE);
+		stream_forward_getp(s, hdr.length);
+
+		handler = NULL;
+		if (hdr.command < zclient->n_handlers)
+			handler = zclient->handlers[hdr.command];
+		if (!handler)
+			continue;
+
+		zclient->ibuf = single;
+		handler(hdr.command, zclient, hdr.length - ZEBRA_HEADER_SIZE,
+			hdr.vrf_id);
+		zclient->ibuf = s;
+	}
+
+	if (i < count)
+		flog_err(EC_LIB_ZAPI_MISSMATCH,
+			 "%s: truncated redistribution bulk message, %u of %u read",
+			 __func__, i, count);
+
+	stream_free(single);
+	return 0;
+
+stream_failure:
+	return -1;
+}
+
 static int zclient_handle_error(ZAPI_CALLBACK_ARGS)
 {
 	enum zebra_error_types error;
@@ -4011,6 +4302,8 @@ static zclient_handler *const lib_handlers[] = {
 	/* fundamentals */
 	[ZEBRA_CAPABILITIES] = zclient_capability_decode,
 	[ZEBRA_ERROR] = zclient_handle_error,
+	[ZEBRA_ROUTE_NOTIFY_OWNER_BATCH] = zclient_route_notify_batch,
+	[ZEBRA_REDISTRIBUTE_ROUTE_BULK] = zclient_redistribute_route_bulk,
 
 	/* VRF & interface code is shared in lib */
 	[ZEBRA_VRF_ADD] = zclient_vrf_add,
@@ -4019,6 +4312,7 @@ static zclient_handler *const lib_handlers[] = {
 	[ZEBRA_INTERFACE_DELETE] = zclient_interface_delete,
 	[ZEBRA_INTERFACE_UP] = zclient_interface_up,
 	[ZEBRA_INTERFACE_DOWN] = zclient_interface_down,
+	[ZEBRA_INTERFACE_STATE_BULK] = zclient_interface_state_bulk,
 
 	/* BFD */
 	[ZEBRA_BFD_DEST_REPLAY] = zclient_bfd_session_replay,
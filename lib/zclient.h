@@ -232,8 +232,16 @@ typedef enum {
 	ZEBRA_TC_CLASS_DELETE,
 	ZEBRA_TC_FILTER_ADD,
 	ZEBRA_TC_FILTER_DELETE,
+	ZEBRA_ROUTE_ADD_BATCH,
+	ZEBRA_ROUTE_NOTIFY_OWNER_BATCH,
+	ZEBRA_IPMR_ROUTE_STATS_BULK,
+	ZEBRA_INTERFACE_STATE_BULK,
+	ZEBRA_REDISTRIBUTE_ROUTE_BULK,
 } zebra_message_types_t;
 
+/* ZEBRA_IPMR_ROUTE_STATS_BULK: last message of a reply */
+#define ZAPI_IPMR_STATS_BULK_LAST 0x01
+
 enum zebra_error_types {
 	ZEBRA_UNKNOWN_ERROR,    /* Error of unknown type */
 	ZEBRA_NO_VRF,		/* Vrf in header was not found */
@@ -298,6 +306,9 @@ struct zclient {
 	/* Do we care about failure events for route install? */
 	bool receive_notify;
 
+	/* Can route owner notifications be sent in batches? */
+	bool receive_notify_batch;
+
 	/* Is this a synchronous client? */
 	bool synchronous;
 
@@ -329,6 +340,9 @@ struct zclient {
 	/* Thread to write buffered data to zebra. */
 	struct event *t_write;
 
+	/* zclient_batch_begin() nesting, messages are only queued meanwhile */
+	int batch;
+
 	/* Redistribute information. */
 	uint8_t redist_default; /* clients protocol */
 	unsigned short instance;
@@ -813,6 +827,7 @@ enum zebra_neigh_state { ZEBRA_NEIGH_INACTIVE = 0, ZEBRA_NEIGH_ACTIVE = 1 };
 
 struct zclient_options {
 	bool receive_notify;
+	bool receive_notify_batch;
 	bool synchronous;
 };
 
@@ -949,6 +964,15 @@ extern void zclient_redistribute_default(int command, struct zclient *,
  */
 extern enum zclient_send_status zclient_send_message(struct zclient *);
 
+/*
+ * Between these, zclient_send_message() only appends to the write buffer,
+ * and everything goes out in as few writes as possible at the outermost
+ * zclient_batch_end().  For senders of many small messages in a row, e.g.
+ * label updates after an SPF run.
+ */
+extern void zclient_batch_begin(struct zclient *zclient);
+extern enum zclient_send_status zclient_batch_end(struct zclient *zclient);
+
 /* create header for command, length to be filled in by user later */
 extern void zclient_create_header(struct stream *, uint16_t, vrf_id_t);
 /*
@@ -1074,9 +1098,15 @@ extern int zebra_read_pw_status_update(ZAPI_CALLBACK_ARGS,
 extern enum zclient_send_status zclient_route_send(uint8_t, struct zclient *,
 						   struct zapi_route *);
 extern enum zclient_send_status
+zclient_route_send_batch(struct zclient *zclient, struct zapi_route *api,
+			 const struct prefix *prefixes, uint32_t count);
+extern enum zclient_send_status
 zclient_send_rnh(struct zclient *zclient, int command, const struct prefix *p,
 		 safi_t safi, bool connected, bool resolve_via_default,
 		 vrf_id_t vrf_id);
+extern void zapi_rnh_encode(struct stream *s, int command,
+			    const struct prefix *p, safi_t safi, bool connected,
+			    bool resolve_via_default, vrf_id_t vrf_id);
 int zapi_nexthop_encode(struct stream *s, const struct zapi_nexthop *api_nh,
 			uint32_t api_flags, uint32_t api_message);
 extern int zapi_route_encode(uint8_t, struct stream *, struct zapi_route *);
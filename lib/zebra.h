@@ -230,6 +230,27 @@ static inline int sendmmsg(int fd, struct mmsghdr *mmh, unsigned int len,
 }
 #endif
 
+#if !defined(HAVE_STRUCT_MMSGHDR_MSG_HDR) || !defined(HAVE_SENDMMSG) ||        \
+	!defined(HAVE_RECVMMSG)
+#define recvmmsg frr_recvmmsg
+
+/* one recvmsg() per message; stop at the first error (e.g. EAGAIN) */
+static inline int recvmmsg(int fd, struct mmsghdr *mmh, unsigned int len,
+			   int flags, struct timespec *timeout)
+{
+	unsigned int i;
+	ssize_t rv;
+
+	for (i = 0; i < len; i++) {
+		rv = recvmsg(fd, &mmh[i].msg_hdr, flags);
+		if (rv < 0)
+			return i ? (int)i : -1;
+		mmh[i].msg_len = rv;
+	}
+	return len;
+}
+#endif
+
 /*
  * RFC 3542 defines several macros for using struct cmsghdr.
  * Here, we define those that are not present
@@ -72,8 +72,8 @@ static atomic_bool zlog_ec = true, zlog_xid = true;
  * we need to chown() things so we don't get permission errors later when
  * trying to delete things on shutdown
  */
-static uid_t zlog_uid = -1;
-static gid_t zlog_gid = -1;
+uid_t zlog_uid = -1;
+gid_t zlog_gid = -1;
 
 DECLARE_ATOMLIST(zlog_targets, struct zlog_target, head);
 static struct zlog_targets_head zlog_targets;
@@ -217,7 +217,7 @@ static inline void zlog_tls_set(struct zlog_tls *val)
 #endif
 
 #ifdef CAN_DO_TLS
-static intmax_t zlog_gettid(void)
+intmax_t zlog_gettid(void)
 {
 #ifndef __OpenBSD__
 	/* accessing a TLS variable is much faster than a syscall */
@@ -341,6 +341,11 @@ void zlog_tls_buffer_fini(void)
 }
 
 #else /* !CAN_DO_TLS */
+intmax_t zlog_gettid(void)
+{
+	return (intmax_t)getpid();
+}
+
 void zlog_tls_buffer_init(void)
 {
 }
@@ -31,6 +31,9 @@ DECLARE_MGROUP(LOG);
 extern char zlog_prefix[];
 extern size_t zlog_prefixsz;
 extern int zlog_tmpdirfd;
+/* owner for files created in zlog_tmpdirfd */
+extern uid_t zlog_uid;
+extern gid_t zlog_gid;
 extern int zlog_instance;
 extern const char *zlog_progname;
 
@@ -274,6 +277,9 @@ extern void zlog_tls_buffer_init(void);
 extern void zlog_tls_buffer_flush(void);
 extern void zlog_tls_buffer_fini(void);
 
+/* kernel thread ID of the calling pthread (as printed with log messages) */
+extern intmax_t zlog_gettid(void);
+
 /* Enable or disable 'immediate' output - default is to buffer messages. */
 extern void zlog_set_immediate(bool set_p);
 
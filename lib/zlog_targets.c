@@ -9,6 +9,7 @@
 #include <syslog.h>
 
 #include "memory.h"
+#include "atomlist.h"
 #include "frrcu.h"
 #include "frr_pthread.h"
 #include "printfrr.h"
@@ -26,6 +27,7 @@ DEFINE_MTYPE_STATIC(LOG, LOG_FD,        "log file target");
 DEFINE_MTYPE_STATIC(LOG, LOG_FD_NAME,   "log file name");
 DEFINE_MTYPE_STATIC(LOG, LOG_FD_ROTATE, "log file rotate helper");
 DEFINE_MTYPE_STATIC(LOG, LOG_SYSL,      "syslog target");
+DEFINE_MTYPE_STATIC(LOG, LOG_ASYNC,     "log file async batch");
 
 struct zlt_fd {
 	struct zlog_target zt;
@@ -35,6 +37,13 @@ struct zlt_fd {
 	char ts_subsec;
 	bool record_priority;
 
+	/* asynchronous mode, see zlog_fd_async() */
+	unsigned int async_limit;
+	bool async_block;
+	atomic_uint_fast32_t async_depth;
+	atomic_uint_fast64_t async_dropped;
+	atomic_uint_fast64_t async_delayed;
+
 	struct rcu_head_close head_close;
 };
 
@@ -146,6 +155,322 @@ static void zlog_fd_sigsafe(struct zlog_target *zt, const char *text,
 	writev(fd, iov, array_size(iov));
 }
 
+/*
+ * asynchronous file targets
+ *
+ * Instead of writing to the file from whichever pthread is logging, the
+ * messages are formatted into one buffer per batch and put on a lock-free
+ * queue for a writer pthread.  That pthread is started when the first
+ * asynchronous target is set up and shared by all of them.  A target only
+ * allows async_limit batches to be queued; past that, messages are either
+ * dropped or the logging pthread waits for the writer to catch up.
+ *
+ * Queued batches point at their target, so targets can't just be rcu_free'd
+ * when replaced.  Instead, once nothing can log to a target anymore (i.e.
+ * after an RCU grace period), a "retire" batch is queued behind everything
+ * else, and the writer closes and frees the target when it gets there.
+ */
+
+PREDECL_ATOMLIST(zlog_async_batches);
+
+struct zlog_async_batch {
+	struct zlog_async_batches_item itm;
+
+	struct zlt_fd *zlt;
+	bool retire;
+
+	size_t len;
+	char text[];
+};
+
+DECLARE_ATOMLIST(zlog_async_batches, struct zlog_async_batch, itm);
+
+static struct zlog_async_batches_head zlog_async_queue;
+
+static pthread_mutex_t zlog_async_mtx = PTHREAD_MUTEX_INITIALIZER;
+/* writer waiting for batches */
+static pthread_cond_t zlog_async_cond = PTHREAD_COND_INITIALIZER;
+/* logging pthreads waiting for space (async_block) */
+static pthread_cond_t zlog_async_space = PTHREAD_COND_INITIALIZER;
+
+#ifndef thread_local
+#define thread_local __thread
+#endif
+
+/* under zlog_async_mtx */
+static bool zlog_async_running;
+static pthread_t zlog_async_thread;
+
+/* running and not being stopped, checked by logging pthreads */
+static atomic_bool zlog_async_active;
+static atomic_bool zlog_async_sleeping;
+static atomic_uint_fast32_t zlog_async_waiters;
+static thread_local bool zlog_async_is_writer;
+
+static void zlog_async_wake(void)
+{
+	if (!atomic_load_explicit(&zlog_async_sleeping, memory_order_seq_cst))
+		return;
+
+	frr_with_mutex (&zlog_async_mtx) {
+		pthread_cond_signal(&zlog_async_cond);
+	}
+}
+
+static void zlog_async_write(struct zlog_async_batch *batch)
+{
+	struct zlt_fd *zlt = batch->zlt;
+	size_t pos = 0;
+	ssize_t nwr;
+	int fd;
+
+	if (batch->retire) {
+		close(zlt->fd);
+		XFREE(MTYPE_LOG_FD, zlt);
+		XFREE(MTYPE_LOG_ASYNC, batch);
+		return;
+	}
+
+	fd = atomic_load_explicit(&zlt->fd, memory_order_relaxed);
+	while (pos < batch->len) {
+		nwr = write(fd, batch->text + pos, batch->len - pos);
+		if (nwr < 0 && errno == EINTR)
+			continue;
+		if (nwr <= 0)
+			break;
+		pos += nwr;
+	}
+
+	atomic_fetch_sub_explicit(&zlt->async_depth, 1, memory_order_relaxed);
+	XFREE(MTYPE_LOG_ASYNC, batch);
+
+	if (atomic_load_explicit(&zlog_async_waiters, memory_order_relaxed)) {
+		frr_with_mutex (&zlog_async_mtx) {
+			pthread_cond_broadcast(&zlog_async_space);
+		}
+	}
+}
+
+static void *zlog_async_run(void *arg)
+{
+	struct zlog_async_batch *batch;
+	bool stop = false;
+
+	rcu_thread_start(arg);
+	zlog_async_is_writer = true;
+
+	while (true) {
+		batch = zlog_async_batches_pop(&zlog_async_queue);
+		if (batch) {
+			zlog_async_write(batch);
+			continue;
+		}
+		if (stop)
+			break;
+
+		/* don't hold up RCU (and retired targets) while idle */
+		rcu_read_unlock();
+		frr_with_mutex (&zlog_async_mtx) {
+			atomic_store_explicit(&zlog_async_sleeping, true,
+					      memory_order_seq_cst);
+			while (!zlog_async_batches_count(&zlog_async_queue) &&
+			       atomic_load_explicit(&zlog_async_active,
+						    memory_order_relaxed))
+				pthread_cond_wait(&zlog_async_cond,
+						  &zlog_async_mtx);
+			atomic_store_explicit(&zlog_async_sleeping, false,
+					      memory_order_relaxed);
+			/* drain what's left before exiting */
+			stop = !atomic_load_explicit(&zlog_async_active,
+						     memory_order_relaxed);
+		}
+		rcu_read_lock();
+	}
+	return NULL;
+}
+
+/* under zlog_async_mtx */
+static void zlog_async_start(void)
+{
+	struct rcu_thread *rcu_thread;
+	sigset_t oldsigs, blocksigs;
+
+	if (zlog_async_running)
+		return;
+
+	sigfillset(&blocksigs);
+	pthread_sigmask(SIG_BLOCK, &blocksigs, &oldsigs);
+
+	rcu_thread = rcu_thread_prepare();
+	atomic_store_explicit(&zlog_async_active, true, memory_order_relaxed);
+	if (pthread_create(&zlog_async_thread, NULL, zlog_async_run,
+			   rcu_thread) == 0)
+		zlog_async_running = true;
+	else {
+		atomic_store_explicit(&zlog_async_active, false,
+				      memory_order_relaxed);
+		rcu_thread_unprepare(rcu_thread);
+	}
+
+	pthread_sigmask(SIG_SETMASK, &oldsigs, NULL);
+}
+
+static void zlog_async_stop(void)
+{
+	struct zlog_async_batch *batch;
+
+	/* asynchronous targets write directly from here on */
+	frr_with_mutex (&zlog_async_mtx) {
+		if (!zlog_async_running)
+			return;
+
+		atomic_store_explicit(&zlog_async_active, false,
+				      memory_order_seq_cst);
+		pthread_cond_signal(&zlog_async_cond);
+		pthread_cond_broadcast(&zlog_async_space);
+	}
+
+	pthread_join(zlog_async_thread, NULL);
+
+	frr_with_mutex (&zlog_async_mtx) {
+		zlog_async_running = false;
+	}
+
+	/* batches from pthreads that were just about to queue them */
+	while ((batch = zlog_async_batches_pop(&zlog_async_queue)))
+		zlog_async_write(batch);
+}
+
+static void zlog_fd_async(struct zlog_target *zt, struct zlog_msg *msgs[],
+			  size_t nmsgs)
+{
+	struct zlt_fd *zte = container_of(zt, struct zlt_fd, zt);
+	struct zlog_async_batch *batch;
+	struct timespec deadline;
+	size_t i, len = 0, lines = 0, textlen;
+	const char *text;
+
+	/* the writer can't wait for itself */
+	if (!atomic_load_explicit(&zlog_async_active, memory_order_relaxed) ||
+	    zlog_async_is_writer) {
+		zlog_fd(zt, msgs, nmsgs);
+		return;
+	}
+
+	for (i = 0; i < nmsgs; i++) {
+		int prio = zlog_msg_prio(msgs[i]);
+
+		if (prio > zt->prio_min)
+			continue;
+
+		zlog_msg_text(msgs[i], &textlen);
+		len += TS_LEN + zlog_prefixsz + textlen + 1;
+		if (zte->record_priority)
+			len += strlen(prionames[prio]);
+		lines++;
+	}
+	if (!lines)
+		return;
+
+	if (atomic_fetch_add_explicit(&zte->async_depth, 1,
+				      memory_order_relaxed) >=
+	    zte->async_limit) {
+		if (!zte->async_block) {
+			atomic_fetch_sub_explicit(&zte->async_depth, 1,
+						  memory_order_relaxed);
+			atomic_fetch_add_explicit(&zte->async_dropped, lines,
+						  memory_order_relaxed);
+			return;
+		}
+
+		atomic_fetch_add_explicit(&zte->async_delayed, lines,
+					  memory_order_relaxed);
+		atomic_fetch_add_explicit(&zlog_async_waiters, 1,
+					  memory_order_relaxed);
+
+		/* only the writer frees up space, so it doesn't matter
+		 * that our own batch is counted in the depth while waiting
+		 */
+		frr_with_mutex (&zlog_async_mtx) {
+			while (atomic_load_explicit(&zte->async_depth,
+						    memory_order_relaxed) >
+				       zte->async_limit &&
+			       atomic_load_explicit(&zlog_async_active,
+						    memory_order_relaxed)) {
+				/* wakeups can race with the check above */
+				clock_gettime(CLOCK_REALTIME, &deadline);
+				deadline.tv_nsec += 10 * 1000 * 1000;
+				if (deadline.tv_nsec >= 1000000000) {
+					deadline.tv_sec++;
+					deadline.tv_nsec -= 1000000000;
+				}
+				pthread_cond_timedwait(&zlog_async_space,
+						       &zlog_async_mtx,
+						       &deadline);
+			}
+		}
+
+		atomic_fetch_sub_explicit(&zlog_async_waiters, 1,
+					  memory_order_relaxed);
+	}
+
+	batch = XMALLOC(MTYPE_LOG_ASYNC, sizeof(*batch) + len);
+	batch->zlt = zte;
+	batch->retire = false;
+	batch->len = 0;
+
+	for (i = 0; i < nmsgs; i++) {
+		int prio = zlog_msg_prio(msgs[i]);
+		struct fbuf fbuf;
+
+		if (prio > zt->prio_min)
+			continue;
+
+		fbuf.buf = batch->text;
+		fbuf.pos = batch->text + batch->len;
+		fbuf.len = len;
+		zlog_msg_ts(msgs[i], &fbuf, ZLOG_TS_LEGACY | zte->ts_subsec);
+		batch->len = fbuf.pos - batch->text;
+		batch->text[batch->len++] = ' ';
+
+		if (zte->record_priority) {
+			memcpy(batch->text + batch->len, prionames[prio],
+			       strlen(prionames[prio]));
+			batch->len += strlen(prionames[prio]);
+		}
+
+		memcpy(batch->text + batch->len, zlog_prefix, zlog_prefixsz);
+		batch->len += zlog_prefixsz;
+
+		text = zlog_msg_text(msgs[i], &textlen);
+		memcpy(batch->text + batch->len, text, textlen + 1);
+		batch->len += textlen + 1;
+	}
+
+	zlog_async_batches_add_tail(&zlog_async_queue, batch);
+	zlog_async_wake();
+}
+
+/* RCU thread, nothing can be logging to zlt anymore */
+static void zlog_async_retire(struct zlt_fd *zlt)
+{
+	struct zlog_async_batch *batch;
+
+	frr_with_mutex (&zlog_async_mtx) {
+		if (zlog_async_running) {
+			batch = XCALLOC(MTYPE_LOG_ASYNC, sizeof(*batch));
+			batch->zlt = zlt;
+			batch->retire = true;
+			zlog_async_batches_add_tail(&zlog_async_queue, batch);
+			pthread_cond_signal(&zlog_async_cond);
+			return;
+		}
+	}
+
+	close(zlt->fd);
+	XFREE(MTYPE_LOG_FD, zlt);
+}
+
 /*
  * (re-)configuration
  */
@@ -163,6 +488,11 @@ static void zlog_file_target_free(struct zlt_fd *zlt)
 	if (!zlt)
 		return;
 
+	if (zlt->zt.logfn == zlog_fd_async) {
+		rcu_call(zlog_async_retire, zlt, zt.rcu_head);
+		return;
+	}
+
 	rcu_close(&zlt->head_close, zlt->fd);
 	rcu_free(MTYPE_LOG_FD, zlt, zt.rcu_head);
 }
@@ -218,6 +548,26 @@ static bool zlog_file_cycle(struct zlog_cfg_file *zcf)
 		zlt->zt.prio_min = zcf->prio_min;
 		zlt->zt.logfn = zcf->zlog_wrap ? zcf->zlog_wrap : zlog_fd;
 		zlt->zt.logfn_sigsafe = zlog_fd_sigsafe;
+
+		if (zcf->async_limit && !zcf->zlog_wrap) {
+			zlt->zt.logfn = zlog_fd_async;
+			zlt->async_limit = zcf->async_limit;
+			zlt->async_block = zcf->async_block;
+
+			/* keep counting across reconfiguration */
+			if (zcf->active) {
+				zlt->async_dropped = atomic_load_explicit(
+					&zcf->active->async_dropped,
+					memory_order_relaxed);
+				zlt->async_delayed = atomic_load_explicit(
+					&zcf->active->async_delayed,
+					memory_order_relaxed);
+			}
+
+			frr_with_mutex (&zlog_async_mtx) {
+				zlog_async_start();
+			}
+		}
 	} while (0);
 
 	old = zlog_target_replace(zcf->active ? &zcf->active->zt : NULL,
@@ -269,6 +619,25 @@ struct rcu_close_rotate {
 	struct rcu_head head_self;
 };
 
+bool zlog_file_async_stats(struct zlog_cfg_file *zcf, size_t *depth,
+			   uint64_t *dropped, uint64_t *delayed)
+{
+	frr_with_mutex (&zcf->cfg_mtx) {
+		if (!zcf->active || zcf->active->zt.logfn != zlog_fd_async)
+			return false;
+
+		*depth = atomic_load_explicit(&zcf->active->async_depth,
+					      memory_order_relaxed);
+		*dropped = atomic_load_explicit(&zcf->active->async_dropped,
+						memory_order_relaxed);
+		*delayed = atomic_load_explicit(&zcf->active->async_delayed,
+						memory_order_relaxed);
+		return true;
+	}
+	assert(0);
+	return false;
+}
+
 bool zlog_file_rotate(struct zlog_cfg_file *zcf)
 {
 	struct rcu_close_rotate *rcr;
@@ -376,6 +745,7 @@ static int zlt_init(const char *progname, const char *protoname,
 
 static int zlt_fini(void)
 {
+	zlog_async_stop();
 	closelog();
 	return 0;
 }
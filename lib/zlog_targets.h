@@ -28,6 +28,13 @@ struct zlog_cfg_file {
 	char ts_subsec;
 	bool record_priority;
 
+	/* write from a separate pthread, with at most async_limit message
+	 * batches queued (0 = write directly).  When the queue is full,
+	 * messages are dropped unless async_block is set.
+	 */
+	unsigned int async_limit;
+	bool async_block;
+
 	/* call zlog_file_set_filename/fd() to change this */
 	char *filename;
 	int fd;
@@ -44,6 +51,10 @@ extern bool zlog_file_set_filename(struct zlog_cfg_file *zcf, const char *name);
 extern bool zlog_file_set_fd(struct zlog_cfg_file *zcf, int fd);
 extern bool zlog_file_rotate(struct zlog_cfg_file *zcf);
 
+/* false if the target isn't active and asynchronous */
+extern bool zlog_file_async_stats(struct zlog_cfg_file *zcf, size_t *depth,
+				  uint64_t *dropped, uint64_t *delayed);
+
 extern void zlog_fd(struct zlog_target *zt, struct zlog_msg *msgs[],
 		    size_t nmsgs);
 
@@ -12,6 +12,7 @@
 #include "network.h"
 #include "libfrr.h"
 #include "mgmt_msg.h"
+#include "monotime.h"
 #include "mgmt_pb.h"
 #include "mgmtd/mgmt.h"
 #include "mgmtd/mgmt_memory.h"
@@ -990,6 +991,30 @@ int mgmt_be_get_subscr_info_for_xpath(
 	return 0;
 }
 
+static void mgmt_be_adapter_msg_stats_write(struct vty *vty,
+					    const struct mgmt_msg_state *ms)
+{
+	int64_t usec = monotime_since(&ms->start, NULL);
+	double secs = usec > 0 ? usec / 1e6 : 1;
+
+	vty_out(vty,
+		"    Socket-Writes: \t\t%" PRIu64 " (%.1f msgs/write)\n",
+		ms->nwrites,
+		ms->nwrites ? (double)ms->ntxm / ms->nwrites : 0.0);
+	vty_out(vty, "    Throughput (B/s): \t\trecv %.0f, sent %.0f\n",
+		ms->nrxb / secs, ms->ntxb / secs);
+	vty_out(vty,
+		"    Msg-Proc-Time (uSecs): \tavg %" PRIu64 ", max %" PRIu64
+		"\n",
+		ms->nrxm ? ms->rx_proc_usec / ms->nrxm : 0,
+		ms->rx_proc_max_usec);
+	vty_out(vty,
+		"    Send-Wait-Time (uSecs): \tavg %" PRIu64 ", max %" PRIu64
+		"\n",
+		ms->ntx_waits ? ms->tx_wait_usec / ms->ntx_waits : 0,
+		ms->tx_wait_max_usec);
+}
+
 void mgmt_be_adapter_status_write(struct vty *vty)
 {
 	struct mgmt_be_client_adapter *adapter;
@@ -1009,6 +1034,7 @@ void mgmt_be_adapter_status_write(struct vty *vty)
 			adapter->mstate.ntxm);
 		vty_out(vty, "    Bytes-Sent: \t\t%" PRIu64 "\n",
 			adapter->mstate.ntxb);
+		mgmt_be_adapter_msg_stats_write(vty, &adapter->mstate);
 	}
 	vty_out(vty, "  Total: %d\n",
 		(int)mgmt_be_adapters_count(&mgmt_be_adapters));
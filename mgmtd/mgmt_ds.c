@@ -93,21 +93,31 @@ static int mgmt_ds_replace_dst_with_src_ds(struct mgmt_ds_ctx *src,
 		return -1;
 	MGMTD_DS_DBG("Replacing %d with %d", dst->ds_id, src->ds_id);
 
-	src_dnode = src->config_ds ? src->root.cfg_root->dnode
-				   : dst->root.dnode_root;
-	dst_dnode = dst->config_ds ? dst->root.cfg_root->dnode
-				   : dst->root.dnode_root;
+	if (src->config_ds && dst->config_ds) {
+		/*
+		 * Between running and candidate, only what was edited in the
+		 * candidate gets copied.
+		 */
+		nb_config_replace_edits(dst->root.cfg_root,
+					src->root.cfg_root);
+	} else {
+		src_dnode = src->config_ds ? src->root.cfg_root->dnode
+					   : dst->root.dnode_root;
+		dst_dnode = dst->config_ds ? dst->root.cfg_root->dnode
+					   : dst->root.dnode_root;
 
-	if (dst_dnode)
-		yang_dnode_free(dst_dnode);
+		if (dst_dnode)
+			yang_dnode_free(dst_dnode);
 
-	/* Not using nb_config_replace as the oper ds does not contain nb_config
-	 */
-	dst_dnode = yang_dnode_dup(src_dnode);
-	if (dst->config_ds)
-		dst->root.cfg_root->dnode = dst_dnode;
-	else
-		dst->root.dnode_root = dst_dnode;
+		/* Not using nb_config_replace as the oper ds does not contain
+		 * nb_config
+		 */
+		dst_dnode = yang_dnode_dup(src_dnode);
+		if (dst->config_ds)
+			dst->root.cfg_root->dnode = dst_dnode;
+		else
+			dst->root.dnode_root = dst_dnode;
+	}
 
 	if (src->ds_id == MGMTD_DS_CANDIDATE) {
 		/*
@@ -141,11 +151,17 @@ static int mgmt_ds_merge_src_with_dst_ds(struct mgmt_ds_ctx *src,
 
 	MGMTD_DS_DBG("Merging DS %d with %d", dst->ds_id, src->ds_id);
 
-	src_dnode = src->config_ds ? src->root.cfg_root->dnode
-				   : dst->root.dnode_root;
-	dst_dnode = dst->config_ds ? &dst->root.cfg_root->dnode
-				   : &dst->root.dnode_root;
-	ret = lyd_merge_siblings(dst_dnode, src_dnode, 0);
+	if (src->config_ds && dst->config_ds) {
+		/* also drops the candidate's record of edits */
+		ret = nb_config_merge(dst->root.cfg_root, src->root.cfg_root,
+				      true);
+	} else {
+		src_dnode = src->config_ds ? src->root.cfg_root->dnode
+					   : dst->root.dnode_root;
+		dst_dnode = dst->config_ds ? &dst->root.cfg_root->dnode
+					   : &dst->root.dnode_root;
+		ret = lyd_merge_siblings(dst_dnode, src_dnode, 0);
+	}
 	if (ret != 0) {
 		MGMTD_DS_ERR("lyd_merge() failed with err %d", ret);
 		return ret;
@@ -189,12 +205,8 @@ static int mgmt_ds_load_cfg_from_file(const char *filepath,
 
 void mgmt_ds_reset_candidate(void)
 {
-	struct lyd_node *dnode = mm->candidate_ds->root.cfg_root->dnode;
-	if (dnode)
-		yang_dnode_free(dnode);
-
-	dnode = yang_dnode_new(ly_native_ctx, true);
-	mm->candidate_ds->root.cfg_root->dnode = dnode;
+	nb_config_replace(mm->candidate_ds->root.cfg_root, nb_config_new(NULL),
+			  false);
 }
 
 
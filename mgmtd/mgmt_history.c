@@ -21,8 +21,13 @@ struct mgmt_cmt_info_t {
 	char cmtid_str[MGMTD_MD5_HASH_STR_HEX_LEN];
 	char time_str[MGMTD_COMMIT_TIME_STR_LEN];
 	char cmt_json_file[PATH_MAX];
+
+	/* not saved in the index file, everything above is */
+	struct mgmt_cmt_timing timing;
 };
 
+#define MGMT_CMT_INFO_SAVED_LEN offsetof(struct mgmt_cmt_info_t, timing)
+
 
 DECLARE_DLIST(mgmt_cmt_infos, struct mgmt_cmt_info_t, cmts);
 
@@ -116,7 +121,7 @@ static struct mgmt_cmt_info_t *mgmt_history_find_cmt_record(const char *cmtid_st
 static bool mgmt_history_read_cmt_record_index(void)
 {
 	FILE *fp;
-	struct mgmt_cmt_info_t cmt_info;
+	struct mgmt_cmt_info_t cmt_info = {};
 	struct mgmt_cmt_info_t *new;
 	int cnt = 0;
 
@@ -127,7 +132,7 @@ static bool mgmt_history_read_cmt_record_index(void)
 		return false;
 	}
 
-	while ((fread(&cmt_info, sizeof(cmt_info), 1, fp)) > 0) {
+	while ((fread(&cmt_info, MGMT_CMT_INFO_SAVED_LEN, 1, fp)) > 0) {
 		if (cnt < MGMTD_MAX_COMMIT_LIST) {
 			if (!mgmt_history_record_exists(cmt_info.cmt_json_file)) {
 				zlog_err(
@@ -159,7 +164,6 @@ static bool mgmt_history_dump_cmt_record_index(void)
 	FILE *fp;
 	int ret = 0;
 	struct mgmt_cmt_info_t *cmt_info;
-	struct mgmt_cmt_info_t cmt_info_set[10];
 	int cnt = 0;
 
 	mgmt_history_remove_file((char *)MGMTD_COMMIT_INDEX_FILE_NAME);
@@ -171,8 +175,7 @@ static bool mgmt_history_dump_cmt_record_index(void)
 	}
 
 	FOREACH_CMT_REC (mm, cmt_info) {
-		memcpy(&cmt_info_set[cnt], cmt_info,
-		       sizeof(struct mgmt_cmt_info_t));
+		ret += fwrite(cmt_info, MGMT_CMT_INFO_SAVED_LEN, 1, fp);
 		cnt++;
 	}
 
@@ -181,7 +184,6 @@ static bool mgmt_history_dump_cmt_record_index(void)
 		return false;
 	}
 
-	ret = fwrite(&cmt_info_set, sizeof(struct mgmt_cmt_info_t), cnt, fp);
 	fclose(fp);
 	if (ret != cnt) {
 		zlog_err("Write record failed");
@@ -339,6 +341,32 @@ int mgmt_history_rollback_n(struct vty *vty, int num_cmts)
 	return ret;
 }
 
+static void mgmt_history_show_timing(struct vty *vty,
+				     const struct mgmt_cmt_timing *timing)
+{
+	enum mgmt_be_client_id id;
+
+	/* records read back from the index file have no timing */
+	if (!timing->total_usec)
+		return;
+
+	vty_out(vty,
+		"\t  Phases: prep %u, txn-create %u, send-cfg %u, apply-cfg %u, txn-delete %u, total %u uSecs\n",
+		timing->prep_usec, timing->txn_create_usec,
+		timing->send_cfg_usec, timing->apply_cfg_usec,
+		timing->txn_delete_usec, timing->total_usec);
+
+	FOREACH_MGMTD_BE_CLIENT_ID (id) {
+		if (!timing->be[id].batches)
+			continue;
+		vty_out(vty,
+			"\t  %s: %u batches, txn-create +%u, cfg-data +%u, apply +%u uSecs\n",
+			mgmt_be_client_id2name(id), timing->be[id].batches,
+			timing->be[id].txn_create_usec,
+			timing->be[id].cfgdata_usec, timing->be[id].apply_usec);
+	}
+}
+
 void show_mgmt_cmt_history(struct vty *vty)
 {
 	struct mgmt_cmt_info_t *cmt_info;
@@ -349,6 +377,7 @@ void show_mgmt_cmt_history(struct vty *vty)
 	FOREACH_CMT_REC (mm, cmt_info) {
 		vty_out(vty, "  %d\t%s  %s\n", slno, cmt_info->cmtid_str,
 			cmt_info->time_str);
+		mgmt_history_show_timing(vty, &cmt_info->timing);
 		slno++;
 	}
 }
@@ -360,6 +389,14 @@ void mgmt_history_new_record(struct mgmt_ds_ctx *ds_ctx)
 	mgmt_history_dump_cmt_record_index();
 }
 
+void mgmt_history_record_timing(const struct mgmt_cmt_timing *timing)
+{
+	struct mgmt_cmt_info_t *cmt_info = mgmt_cmt_infos_first(&mm->cmts);
+
+	if (cmt_info)
+		cmt_info->timing = *timing;
+}
+
 void mgmt_history_init(void)
 {
 	/* Create commit record for previously stored commit-apply */
@@ -9,11 +9,33 @@
 #define _FRR_MGMTD_HISTORY_H_
 
 #include "vrf.h"
+#include "mgmt_be_client.h"
 
 PREDECL_DLIST(mgmt_cmt_infos);
 
 struct mgmt_ds_ctx;
 
+/*
+ * Where the time went for one commit, in microseconds.  The phases are the
+ * time spent in each commit phase, the backend times are relative to the
+ * start of the commit (i.e. when the replies from that backend came in).
+ */
+struct mgmt_cmt_timing {
+	uint32_t prep_usec;
+	uint32_t txn_create_usec;
+	uint32_t send_cfg_usec;
+	uint32_t apply_cfg_usec;
+	uint32_t txn_delete_usec;
+	uint32_t total_usec;
+
+	struct {
+		uint32_t batches;
+		uint32_t txn_create_usec;
+		uint32_t cfgdata_usec;
+		uint32_t apply_usec;
+	} be[MGMTD_BE_CLIENT_ID_MAX];
+};
+
 /*
  * Rollback specific commit from commit history.
  *
@@ -51,6 +73,9 @@ extern void show_mgmt_cmt_history(struct vty *vty);
 
 extern void mgmt_history_new_record(struct mgmt_ds_ctx *ds_ctx);
 
+/* Attach the timing breakdown of a commit to the newest history record */
+extern void mgmt_history_record_timing(const struct mgmt_cmt_timing *timing);
+
 extern void mgmt_history_destroy(void);
 extern void mgmt_history_init(void);
 
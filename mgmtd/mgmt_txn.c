@@ -160,6 +160,11 @@ struct mgmt_commit_cfg_req {
 	uint64_t next_batch_id;
 
 	struct mgmt_commit_stats *cmt_stats;
+
+	/* Timing breakdown for the commit history, see mgmt_txn_phase_done() */
+	struct timeval start;
+	struct timeval phase_start;
+	struct mgmt_cmt_timing timing;
 };
 
 struct mgmt_get_data_reply {
@@ -296,6 +301,41 @@ static int
 mgmt_move_be_commit_to_next_phase(struct mgmt_txn_ctx *txn,
 				     struct mgmt_be_client_adapter *adapter);
 
+/* usecs since the commit started, for the per-backend timestamps */
+static uint32_t mgmt_txn_cmt_usec(struct mgmt_commit_cfg_req *cmtcfg_req)
+{
+	return monotime_since(&cmtcfg_req->start, NULL);
+}
+
+/* Account the time spent in the current phase, a new one starts now */
+static void mgmt_txn_phase_done(struct mgmt_commit_cfg_req *cmtcfg_req)
+{
+	struct mgmt_cmt_timing *timing = &cmtcfg_req->timing;
+	uint32_t usec = monotime_since(&cmtcfg_req->phase_start, NULL);
+
+	switch (cmtcfg_req->curr_phase) {
+	case MGMTD_COMMIT_PHASE_PREPARE_CFG:
+		timing->prep_usec += usec;
+		break;
+	case MGMTD_COMMIT_PHASE_TXN_CREATE:
+		timing->txn_create_usec += usec;
+		break;
+	case MGMTD_COMMIT_PHASE_SEND_CFG:
+		timing->send_cfg_usec += usec;
+		break;
+	case MGMTD_COMMIT_PHASE_APPLY_CFG:
+		timing->apply_cfg_usec += usec;
+		break;
+	case MGMTD_COMMIT_PHASE_TXN_DELETE:
+		timing->txn_delete_usec += usec;
+		break;
+	case MGMTD_COMMIT_PHASE_MAX:
+		break;
+	}
+
+	monotime(&cmtcfg_req->phase_start);
+}
+
 static struct mgmt_txn_be_cfg_batch *
 mgmt_txn_cfg_batch_alloc(struct mgmt_txn_ctx *txn,
 			  enum mgmt_be_client_id id,
@@ -321,6 +361,7 @@ mgmt_txn_cfg_batch_alloc(struct mgmt_txn_ctx *txn,
 
 	txn->commit_cfg_req->req.commit_cfg.last_be_cfg_batch[id] =
 		cfg_btch;
+	txn->commit_cfg_req->req.commit_cfg.timing.be[id].batches++;
 	if (!txn->commit_cfg_req->req.commit_cfg.next_batch_id)
 		txn->commit_cfg_req->req.commit_cfg.next_batch_id++;
 	cfg_btch->batch_id =
@@ -466,6 +507,9 @@ static struct mgmt_txn_req *mgmt_txn_req_alloc(struct mgmt_txn_ctx *txn,
 			hash_create(mgmt_txn_cfgbatch_hash_key,
 				    mgmt_txn_cfgbatch_hash_cmp,
 				    "MGMT Config Batches");
+		monotime(&txn_req->req.commit_cfg.start);
+		txn_req->req.commit_cfg.phase_start =
+			txn_req->req.commit_cfg.start;
 		break;
 	case MGMTD_TXN_PROC_GETCFG:
 		txn_req->req.get_data =
@@ -751,6 +795,10 @@ static int mgmt_txn_send_commit_cfg_reply(struct mgmt_txn_ctx *txn,
 
 	success = (result == MGMTD_SUCCESS || result == MGMTD_NO_CFG_CHANGES);
 
+	mgmt_txn_phase_done(&txn->commit_cfg_req->req.commit_cfg);
+	txn->commit_cfg_req->req.commit_cfg.timing.total_usec =
+		mgmt_txn_cmt_usec(&txn->commit_cfg_req->req.commit_cfg);
+
 	if (!txn->commit_cfg_req->req.commit_cfg.implicit && txn->session_id
 	    && mgmt_fe_send_commit_cfg_reply(
 		       txn->session_id, txn->txn_id,
@@ -799,6 +847,12 @@ static int mgmt_txn_send_commit_cfg_reply(struct mgmt_txn_ctx *txn,
 					 txn->commit_cfg_req->req.commit_cfg
 						 .dst_ds_ctx,
 					 create_cmt_info_rec);
+			if (create_cmt_info_rec &&
+			    txn->commit_cfg_req->req.commit_cfg.dst_ds_id ==
+				    MGMTD_DS_RUNNING)
+				mgmt_history_record_timing(
+					&txn->commit_cfg_req->req.commit_cfg
+						 .timing);
 		}
 
 		/*
@@ -935,6 +989,7 @@ mgmt_try_move_commit_to_next_phase(struct mgmt_txn_ctx *txn,
 	 * If we are here, it means all the clients has moved to next phase.
 	 * So we can move the whole commit to next phase.
 	 */
+	mgmt_txn_phase_done(cmtcfg_req);
 	cmtcfg_req->curr_phase = cmtcfg_req->next_phase;
 	cmtcfg_req->next_phase++;
 	MGMTD_TXN_DBG(
@@ -1312,6 +1367,7 @@ mgmt_txn_prep_config_validation_done:
 	}
 
 	/* Move to the Transaction Create Phase */
+	mgmt_txn_phase_done(&txn->commit_cfg_req->req.commit_cfg);
 	txn->commit_cfg_req->req.commit_cfg.curr_phase =
 		MGMTD_COMMIT_PHASE_TXN_CREATE;
 	mgmt_txn_register_event(txn, MGMTD_TXN_PROC_COMMITCFG);
@@ -1544,6 +1600,37 @@ static int mgmt_txn_send_be_cfg_apply(struct mgmt_txn_ctx *txn)
 	return 0;
 }
 
+/*
+ * Batches that got their CFGDATA_CREATE reply before the whole commit had
+ * moved to SEND_CFG (see mgmt_txn_notify_be_cfgdata_reply()) are done
+ * with this phase already.
+ */
+static void
+mgmt_txn_collect_early_cfgdata_replies(struct mgmt_txn_ctx *txn,
+				       struct mgmt_commit_cfg_req *cmtcfg_req)
+{
+	struct mgmt_txn_be_cfg_batch *cfg_btch;
+	enum mgmt_be_client_id id;
+	bool found = false;
+
+	FOREACH_MGMTD_BE_CLIENT_ID (id) {
+		FOREACH_TXN_CFG_BATCH_IN_LIST (&cmtcfg_req->curr_batches[id],
+					       cfg_btch) {
+			if (cfg_btch->comm_phase !=
+			    MGMTD_COMMIT_PHASE_APPLY_CFG)
+				continue;
+			mgmt_move_txn_cfg_batch_to_next(
+				cmtcfg_req, cfg_btch,
+				&cmtcfg_req->curr_batches[id],
+				&cmtcfg_req->next_batches[id], false, 0);
+			found = true;
+		}
+	}
+
+	if (found)
+		mgmt_try_move_commit_to_next_phase(txn, cmtcfg_req);
+}
+
 static void mgmt_txn_process_commit_cfg(struct event *thread)
 {
 	struct mgmt_txn_ctx *txn;
@@ -1592,6 +1679,7 @@ static void mgmt_txn_process_commit_cfg(struct event *thread)
 			"Txn:%p Session:0x%llx, trigger sending CFG_APPLY_REQ to all backend clients",
 			txn, (unsigned long long)txn->session_id);
 #endif /* ifndef MGMTD_LOCAL_VALIDATIONS_ENABLED */
+		mgmt_txn_collect_early_cfgdata_replies(txn, cmtcfg_req);
 		break;
 	case MGMTD_COMMIT_PHASE_APPLY_CFG:
 		if (mm->perf_stats_en)
@@ -2544,6 +2632,8 @@ int mgmt_txn_notify_be_txn_reply(uint64_t txn_id, bool create,
 			 */
 			assert(cmtcfg_req->curr_phase
 			       == MGMTD_COMMIT_PHASE_TXN_CREATE);
+			cmtcfg_req->timing.be[adapter->id].txn_create_usec =
+				mgmt_txn_cmt_usec(cmtcfg_req);
 
 			/*
 			 * Send CFGDATA_CREATE-REQs to the backend immediately.
@@ -2601,6 +2691,21 @@ int mgmt_txn_notify_be_cfgdata_reply(
 		"CFGDATA_CREATE_REQ sent to '%s' was successful for Txn %p, Batch %p, Err: %s",
 		adapter->name, txn, cfg_btch,
 		error_if_any ? error_if_any : "None");
+	cmtcfg_req->timing.be[adapter->id].cfgdata_usec =
+		mgmt_txn_cmt_usec(cmtcfg_req);
+
+	/*
+	 * Config data goes out to each backend as soon as its TXN_CREATE
+	 * reply is in, so a fast backend can reply before the others have
+	 * even created the transaction.  Its batches are still parked on
+	 * the next list then; just mark them, the SEND_CFG phase picks them
+	 * up.
+	 */
+	if (cmtcfg_req->curr_phase != MGMTD_COMMIT_PHASE_SEND_CFG) {
+		cfg_btch->comm_phase = MGMTD_COMMIT_PHASE_APPLY_CFG;
+		return 0;
+	}
+
 	mgmt_move_txn_cfg_batch_to_next(
 		cmtcfg_req, cfg_btch, &cmtcfg_req->curr_batches[adapter->id],
 		&cmtcfg_req->next_batches[adapter->id], true,
@@ -2658,6 +2763,8 @@ int mgmt_txn_notify_be_cfg_apply_reply(uint64_t txn_id, bool success,
 		 * Send TXN-DELETE to wrap up the transaction for this backend.
 		 */
 		SET_FLAG(adapter->flags, MGMTD_BE_ADAPTER_FLAGS_CFG_SYNCED);
+		cmtcfg_req->timing.be[adapter->id].apply_usec =
+			mgmt_txn_cmt_usec(cmtcfg_req);
 		mgmt_txn_send_be_txn_delete(txn, adapter);
 	}
 
@@ -14,5 +14,6 @@ extern int netlink_mcast_nflog_group;
 int netlink_configure_arp(unsigned int ifindex, int pf);
 void netlink_update_binding(struct interface *ifp, union sockunion *proto,
 			    union sockunion *nbma);
+void netlink_flush_binding_updates(void);
 void netlink_set_nflog_group(int nlgroup);
 
@@ -17,18 +17,105 @@
 #include "frrevent.h"
 #include "stream.h"
 #include "prefix.h"
+#include "jhash.h"
+#include "memory.h"
+#include "typesafe.h"
 #include "nhrpd.h"
 #include "netlink.h"
 #include "znl.h"
 
+DEFINE_MTYPE_STATIC(NHRPD, NHRP_NEIGH_UPDATE, "NHRP neighbor update");
+
 int netlink_nflog_group;
 static int netlink_log_fd = -1;
 static struct event *netlink_log_thread;
 
+/*
+ * Neighbor bindings are not sent to zebra right away.  Updates are collected
+ * until the current event is done, so that a neighbor changed several times
+ * in a row (e.g. a burst of registrations from one spoke) is programmed once,
+ * with the last binding, and all of them go out in as few writes as possible.
+ */
+PREDECL_HASH(nhrp_neigh_updates);
+
+struct nhrp_neigh_update {
+	struct nhrp_neigh_updates_item item;
+
+	ifindex_t ifindex;
+	vrf_id_t vrf_id;
+	union sockunion proto;
+	union sockunion nbma;
+	bool del;
+};
+
+static int nhrp_neigh_update_cmp(const struct nhrp_neigh_update *a,
+				 const struct nhrp_neigh_update *b)
+{
+	if (a->vrf_id != b->vrf_id)
+		return numcmp(a->vrf_id, b->vrf_id);
+	if (a->ifindex != b->ifindex)
+		return numcmp(a->ifindex, b->ifindex);
+	return sockunion_cmp(&a->proto, &b->proto);
+}
+
+static uint32_t nhrp_neigh_update_hash(const struct nhrp_neigh_update *u)
+{
+	return jhash_2words(u->ifindex, u->vrf_id, sockunion_hash(&u->proto));
+}
+
+DECLARE_HASH(nhrp_neigh_updates, struct nhrp_neigh_update, item,
+	     nhrp_neigh_update_cmp, nhrp_neigh_update_hash);
+
+static struct nhrp_neigh_updates_head neigh_updates;
+static struct event *t_neigh_updates;
+
+static void netlink_flush_bindings(struct event *t)
+{
+	struct nhrp_neigh_update *u;
+	struct interface *ifp;
+
+	while ((u = nhrp_neigh_updates_pop(&neigh_updates))) {
+		ifp = if_lookup_by_index(u->ifindex, u->vrf_id);
+		if (ifp)
+			nhrp_queue_zebra_nbr(&u->proto,
+					     u->del ? NULL : &u->nbma, ifp);
+		XFREE(MTYPE_NHRP_NEIGH_UPDATE, u);
+	}
+	nhrp_flush_zebra_nbr();
+}
+
 void netlink_update_binding(struct interface *ifp, union sockunion *proto,
 			    union sockunion *nbma)
 {
-	nhrp_send_zebra_nbr(proto, nbma, ifp);
+	struct nhrp_neigh_update key = {}, *u;
+
+	key.ifindex = ifp->ifindex;
+	key.vrf_id = ifp->vrf->vrf_id;
+	key.proto = *proto;
+
+	nhrp_stats.neigh_updates++;
+
+	u = nhrp_neigh_updates_find(&neigh_updates, &key);
+	if (u)
+		nhrp_stats.neigh_coalesced++;
+	else {
+		u = XCALLOC(MTYPE_NHRP_NEIGH_UPDATE, sizeof(*u));
+		*u = key;
+		nhrp_neigh_updates_add(&neigh_updates, u);
+	}
+
+	u->del = !nbma;
+	if (nbma)
+		u->nbma = *nbma;
+
+	event_add_event(master, netlink_flush_bindings, NULL, 0,
+			&t_neigh_updates);
+}
+
+void netlink_flush_binding_updates(void)
+{
+	EVENT_OFF(t_neigh_updates);
+	netlink_flush_bindings(NULL);
 }
 
 static void netlink_log_register(int fd, int group)
@@ -16,6 +16,65 @@ DEFINE_MTYPE_STATIC(NHRPD, NHRP_CACHE_CONFIG, "NHRP cache config entry");
 
 unsigned long nhrp_cache_counts[NHRP_CACHE_NUM_TYPES];
 
+/*
+ * Expiry of all cache entries runs off one timer, armed for the earliest
+ * entry in a heap, instead of one timer per entry.
+ */
+static int nhrp_cache_expiry_cmp(const struct nhrp_cache *a,
+				 const struct nhrp_cache *b)
+{
+	return numcmp(a->expiry_at, b->expiry_at);
+}
+
+DECLARE_HEAP(nhrp_cache_expiry, struct nhrp_cache, expiry_item,
+	     nhrp_cache_expiry_cmp);
+
+static struct nhrp_cache_expiry_head cache_expiry;
+static struct event *t_cache_expiry;
+
+static void nhrp_cache_expiry_run(struct event *t);
+
+static void nhrp_cache_expiry_arm(void)
+{
+	struct nhrp_cache *c = nhrp_cache_expiry_first(&cache_expiry);
+	time_t now;
+
+	if (!c) {
+		EVENT_OFF(t_cache_expiry);
+		return;
+	}
+
+	now = monotime(NULL);
+	EVENT_OFF(t_cache_expiry);
+	event_add_timer(master, nhrp_cache_expiry_run, NULL,
+			c->expiry_at > now ? c->expiry_at - now : 0,
+			&t_cache_expiry);
+}
+
+static void nhrp_cache_expiry_cancel(struct nhrp_cache *c)
+{
+	bool first;
+
+	if (!c->expiry_at)
+		return;
+
+	first = nhrp_cache_expiry_first(&cache_expiry) == c;
+	nhrp_cache_expiry_del(&cache_expiry, c);
+	c->expiry_at = 0;
+	if (first)
+		nhrp_cache_expiry_arm();
+}
+
+static void nhrp_cache_expiry_set(struct nhrp_cache *c, time_t expires)
+{
+	nhrp_cache_expiry_cancel(c);
+
+	c->expiry_at = expires;
+	nhrp_cache_expiry_add(&cache_expiry, c);
+	if (nhrp_cache_expiry_first(&cache_expiry) == c)
+		nhrp_cache_expiry_arm();
+}
+
 const char *const nhrp_cache_type_str[] = {
 		[NHRP_CACHE_INVALID] = "invalid",
 		[NHRP_CACHE_INCOMPLETE] = "incomplete",
@@ -74,6 +133,7 @@ static void nhrp_cache_free(struct nhrp_cache *c)
 	nhrp_peer_unref(c->new.peer);
 	EVENT_OFF(c->t_timeout);
 	EVENT_OFF(c->t_auth);
+	nhrp_cache_expiry_cancel(c);
 	XFREE(MTYPE_NHRP_CACHE, c);
 }
 
@@ -203,14 +263,21 @@ static void nhrp_cache_do_free(struct event *t)
 	nhrp_cache_free(c);
 }
 
-static void nhrp_cache_do_timeout(struct event *t)
+static void nhrp_cache_expiry_run(struct event *t)
 {
-	struct nhrp_cache *c = EVENT_ARG(t);
-
-	c->t_timeout = NULL;
-	if (c->cur.type != NHRP_CACHE_INVALID)
-		nhrp_cache_update_binding(c, c->cur.type, -1, NULL, 0, NULL,
-					  NULL);
+	time_t now = monotime(NULL);
+	struct nhrp_cache *c;
+
+	while ((c = nhrp_cache_expiry_first(&cache_expiry))
+	       && c->expiry_at <= now) {
+		nhrp_cache_expiry_pop(&cache_expiry);
+		c->expiry_at = 0;
+		nhrp_stats.cache_expired++;
+		if (c->cur.type != NHRP_CACHE_INVALID)
+			nhrp_cache_update_binding(c, c->cur.type, -1, NULL, 0,
+						  NULL, NULL);
+	}
+	nhrp_cache_expiry_arm();
 }
 
 static void nhrp_cache_update_route(struct nhrp_cache *c)
@@ -321,6 +388,7 @@ static void nhrp_cache_reset_new(struct nhrp_cache *c)
 static void nhrp_cache_update_timers(struct nhrp_cache *c)
 {
 	EVENT_OFF(c->t_timeout);
+	nhrp_cache_expiry_cancel(c);
 
 	switch (c->cur.type) {
 	case NHRP_CACHE_INVALID:
@@ -337,9 +405,7 @@ static void nhrp_cache_update_timers(struct nhrp_cache *c)
 	case NHRP_CACHE_LOCAL:
 	case NHRP_CACHE_NUM_TYPES:
 		if (c->cur.expires)
-			event_add_timer(master, nhrp_cache_do_timeout, c,
-					c->cur.expires - monotime(NULL),
-					&c->t_timeout);
+			nhrp_cache_expiry_set(c, c->cur.expires);
 		break;
 	}
 }
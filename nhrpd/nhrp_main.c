@@ -23,6 +23,7 @@
 
 #include "nhrpd.h"
 #include "nhrp_errors.h"
+#include "netlink.h"
 
 DEFINE_MGROUP(NHRPD, "NHRP");
 
@@ -85,6 +86,7 @@ static void nhrp_request_stop(void)
 
 	nhrp_shortcut_terminate();
 	nhrp_nhs_terminate();
+	netlink_flush_binding_updates();
 	nhrp_zebra_terminate();
 	vici_terminate();
 	evmgr_terminate();
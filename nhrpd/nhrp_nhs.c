@@ -37,6 +37,7 @@ static void nhrp_reg_reply(struct nhrp_reqid *reqid, void *arg)
 
 	if (p->hdr->type != NHRP_PACKET_REGISTRATION_REPLY) {
 		debugf(NHRP_DEBUG_COMMON, "NHS: Registration failed");
+		nhrp_stats.reg_rep_fail++;
 		return;
 	}
 
@@ -58,8 +59,11 @@ static void nhrp_reg_reply(struct nhrp_reqid *reqid, void *arg)
 		debugf(NHRP_DEBUG_COMMON, "NHS: CIE MTU: %d", mtu);
 	}
 
-	if (!ok)
+	if (!ok) {
+		nhrp_stats.reg_rep_fail++;
 		return;
+	}
+	nhrp_stats.reg_rep_ok++;
 
 	/* Parse extensions */
 	sockunion_family(&nifp->nat_nbma) = AF_UNSPEC;
@@ -236,6 +240,7 @@ static void nhrp_reg_send_req(struct event *t)
 
 	nhrp_packet_complete(zb, hdr);
 	nhrp_peer_send(r->peer, zb);
+	nhrp_stats.reg_req_tx++;
 	zbuf_free(zb);
 }
 
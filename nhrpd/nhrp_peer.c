@@ -21,6 +21,8 @@
 
 DEFINE_MTYPE_STATIC(NHRPD, NHRP_PEER, "NHRP peer entry");
 
+struct nhrp_stats nhrp_stats;
+
 struct ipv6hdr {
 	uint8_t priority_version;
 	uint8_t flow_lbl[3];
@@ -609,6 +611,19 @@ err:
 	zbuf_free(zb);
 }
 
+static void nhrp_stats_reg_received(void)
+{
+	time_t now = monotime(NULL);
+	unsigned int slot = now % NHRP_STATS_WINDOW;
+
+	nhrp_stats.reg_req_rx++;
+	if (nhrp_stats.reg_req_window_sec[slot] != now) {
+		nhrp_stats.reg_req_window_sec[slot] = now;
+		nhrp_stats.reg_req_window[slot] = 0;
+	}
+	nhrp_stats.reg_req_window[slot]++;
+}
+
 static void nhrp_handle_registration_request(struct nhrp_packet_parser *p)
 {
 	struct interface *ifp = p->ifp;
@@ -624,6 +639,7 @@ static void nhrp_handle_registration_request(struct nhrp_packet_parser *p)
 	void *pay;
 
 	debugf(NHRP_DEBUG_COMMON, "Parsing and replying to Registration Req");
+	nhrp_stats_reg_received();
 	hostprefix_len = 8 * sockunion_get_addrlen(&p->if_ad->addr);
 
 	if (!sockunion_same(&p->src_nbma, &p->peer->vc->remote.nbma))
@@ -649,6 +665,7 @@ static void nhrp_handle_registration_request(struct nhrp_packet_parser *p)
 
 	while ((cie = nhrp_cie_pull(&payload, hdr, &cie_nbma, &cie_proto))
 	       != NULL) {
+		nhrp_stats.reg_cie++;
 		prefix_len = cie->prefix_length;
 		if (prefix_len == 0 || prefix_len >= hostprefix_len)
 			prefix_len = hostprefix_len;
@@ -700,6 +717,7 @@ static void nhrp_handle_registration_request(struct nhrp_packet_parser *p)
 		}
 
 		cie->code = NHRP_CODE_SUCCESS;
+		nhrp_stats.reg_cie_ok++;
 	}
 
 	/* Handle extensions */
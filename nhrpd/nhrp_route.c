@@ -464,6 +464,56 @@ void nhrp_send_zebra_nbr(union sockunion *in,
 	zclient_send_message(zclient);
 }
 
+/* largest neighbor message: header, two IPv6 addresses, ifindex and state */
+#define NHRP_ZEBRA_NBR_MAX                                                     \
+	(ZEBRA_HEADER_SIZE + 2 * (1 + sizeof(struct in6_addr)) + 8)
+
+/*
+ * Same as nhrp_send_zebra_nbr(), but several messages share one write to
+ * zebra.  Nothing else may use zclient->obuf until nhrp_flush_zebra_nbr().
+ */
+static bool nhrp_zebra_nbr_batch;
+
+void nhrp_queue_zebra_nbr(union sockunion *in, union sockunion *out,
+			  struct interface *ifp)
+{
+	struct stream *s;
+	size_t start;
+
+	if (!zclient || zclient->sock < 0)
+		return;
+	s = zclient->obuf;
+	if (!nhrp_zebra_nbr_batch) {
+		stream_reset(s);
+		nhrp_zebra_nbr_batch = true;
+	} else if (STREAM_WRITEABLE(s) < NHRP_ZEBRA_NBR_MAX) {
+		zclient_send_message(zclient);
+		stream_reset(s);
+		nhrp_stats.neigh_batches++;
+	}
+
+	start = stream_get_endp(s);
+	zclient_neigh_ip_encode(s, out ? ZEBRA_NEIGH_IP_ADD :
+				ZEBRA_NEIGH_IP_DEL, in, out,
+				ifp, out ? ZEBRA_NEIGH_STATE_REACHABLE
+				: ZEBRA_NEIGH_STATE_FAILED);
+	stream_putw_at(s, start, stream_get_endp(s) - start);
+	nhrp_stats.neigh_sent++;
+}
+
+void nhrp_flush_zebra_nbr(void)
+{
+	if (!nhrp_zebra_nbr_batch)
+		return;
+	nhrp_zebra_nbr_batch = false;
+
+	if (!zclient || zclient->sock < 0)
+		return;
+	zclient_send_message(zclient);
+	stream_reset(zclient->obuf);
+	nhrp_stats.neigh_batches++;
+}
+
 int nhrp_send_zebra_gre_request(struct interface *ifp)
 {
 	return zclient_send_zebra_gre_request(zclient, ifp);
@@ -18,6 +18,23 @@ DEFINE_MTYPE_STATIC(NHRPD, NHRP_SHORTCUT, "NHRP shortcut");
 
 static struct route_table *shortcut_rib[AFI_MAX];
 
+/*
+ * The holding time based expiry of all shortcuts shares one timer, armed
+ * for the earliest shortcut in a heap.  The short purge timers stay on
+ * t_timer.
+ */
+static int nhrp_shortcut_expiry_cmp(const struct nhrp_shortcut *a,
+				    const struct nhrp_shortcut *b)
+{
+	return numcmp(a->expiry_at, b->expiry_at);
+}
+
+DECLARE_HEAP(nhrp_shortcut_expiry, struct nhrp_shortcut, expiry_item,
+	     nhrp_shortcut_expiry_cmp);
+
+static struct nhrp_shortcut_expiry_head shortcut_expiry;
+static struct event *t_shortcut_expiry;
+
 static void nhrp_shortcut_do_purge(struct event *t);
 static void nhrp_shortcut_delete(struct nhrp_shortcut *s);
 static void nhrp_shortcut_send_resolution_req(struct nhrp_shortcut *s);
@@ -31,14 +48,75 @@ static void nhrp_shortcut_check_use(struct nhrp_shortcut *s)
 	}
 }
 
-static void nhrp_shortcut_do_expire(struct event *t)
+static void nhrp_shortcut_expiry_run(struct event *t);
+
+static void nhrp_shortcut_expiry_arm(void)
 {
-	struct nhrp_shortcut *s = EVENT_ARG(t);
+	struct nhrp_shortcut *s = nhrp_shortcut_expiry_first(&shortcut_expiry);
+	time_t now;
+
+	EVENT_OFF(t_shortcut_expiry);
+	if (!s)
+		return;
+
+	now = monotime(NULL);
+	event_add_timer(master, nhrp_shortcut_expiry_run, NULL,
+			s->expiry_at > now ? s->expiry_at - now : 0,
+			&t_shortcut_expiry);
+}
+
+static void nhrp_shortcut_expiry_cancel(struct nhrp_shortcut *s)
+{
+	bool first;
+
+	if (!s->expiry_at)
+		return;
+
+	first = nhrp_shortcut_expiry_first(&shortcut_expiry) == s;
+	nhrp_shortcut_expiry_del(&shortcut_expiry, s);
+	s->expiry_at = 0;
+	if (first)
+		nhrp_shortcut_expiry_arm();
+}
+
+static void nhrp_shortcut_expiry_set(struct nhrp_shortcut *s, time_t delay)
+{
+	nhrp_shortcut_expiry_cancel(s);
 
-	event_add_timer(master, nhrp_shortcut_do_purge, s, s->holding_time / 3,
-			&s->t_timer);
-	s->expiring = 1;
-	nhrp_shortcut_check_use(s);
+	s->expiry_at = monotime(NULL) + delay;
+	nhrp_shortcut_expiry_add(&shortcut_expiry, s);
+	if (nhrp_shortcut_expiry_first(&shortcut_expiry) == s)
+		nhrp_shortcut_expiry_arm();
+}
+
+/* stop both the holding time expiry and any pending purge */
+static void nhrp_shortcut_timers_off(struct nhrp_shortcut *s)
+{
+	EVENT_OFF(s->t_timer);
+	nhrp_shortcut_expiry_cancel(s);
+}
+
+static void nhrp_shortcut_expiry_run(struct event *t)
+{
+	time_t now = monotime(NULL);
+	struct nhrp_shortcut *s;
+
+	while ((s = nhrp_shortcut_expiry_first(&shortcut_expiry))
+	       && s->expiry_at <= now) {
+		nhrp_shortcut_expiry_pop(&shortcut_expiry);
+		s->expiry_at = 0;
+
+		if (s->expiring) {
+			nhrp_stats.shortcut_expired++;
+			nhrp_shortcut_delete(s);
+			continue;
+		}
+
+		nhrp_shortcut_expiry_set(s, s->holding_time / 3);
+		s->expiring = 1;
+		nhrp_shortcut_check_use(s);
+	}
+	nhrp_shortcut_expiry_arm();
 }
 
 static void nhrp_shortcut_cache_notify(struct notifier_block *n,
@@ -123,12 +201,11 @@ static void nhrp_shortcut_update_binding(struct nhrp_shortcut *s,
 		s->route_installed = 0;
 	}
 
-	EVENT_OFF(s->t_timer);
+	nhrp_shortcut_timers_off(s);
 	if (holding_time) {
 		s->expiring = 0;
 		s->holding_time = holding_time;
-		event_add_timer(master, nhrp_shortcut_do_expire, s,
-				2 * holding_time / 3, &s->t_timer);
+		nhrp_shortcut_expiry_set(s, 2 * holding_time / 3);
 	}
 }
 
@@ -137,7 +214,7 @@ static void nhrp_shortcut_delete(struct nhrp_shortcut *s)
 	struct route_node *rn;
 	afi_t afi = family2afi(PREFIX_FAMILY(s->p));
 
-	EVENT_OFF(s->t_timer);
+	nhrp_shortcut_timers_off(s);
 	nhrp_reqid_free(&nhrp_packet_reqid, &s->reqid);
 
 	debugf(NHRP_DEBUG_ROUTE, "Shortcut %pFX purged", s->p);
@@ -204,7 +281,7 @@ static void nhrp_shortcut_recv_resolution_rep(struct nhrp_reqid *reqid,
 	int holding_time = pp->if_ad->holdtime;
 
 	nhrp_reqid_free(&nhrp_packet_reqid, &s->reqid);
-	EVENT_OFF(s->t_timer);
+	nhrp_shortcut_timers_off(s);
 	event_add_timer(master, nhrp_shortcut_do_purge, s, 1, &s->t_timer);
 
 	if (pp->hdr->type != NHRP_PACKET_RESOLUTION_REPLY) {
@@ -454,7 +531,7 @@ void nhrp_shortcut_initiate(union sockunion *addr)
 	s = nhrp_shortcut_get(&p);
 	if (s && s->type != NHRP_CACHE_INCOMPLETE) {
 		s->addr = *addr;
-		EVENT_OFF(s->t_timer);
+		nhrp_shortcut_timers_off(s);
 		event_add_timer(master, nhrp_shortcut_do_purge, s, 30,
 				&s->t_timer);
 		nhrp_shortcut_send_resolution_req(s);
@@ -469,6 +546,7 @@ void nhrp_shortcut_init(void)
 
 void nhrp_shortcut_terminate(void)
 {
+	EVENT_OFF(t_shortcut_expiry);
 	route_table_finish(shortcut_rib[AFI_IP]);
 	route_table_finish(shortcut_rib[AFI_IP6]);
 }
@@ -499,7 +577,7 @@ struct purge_ctx {
 
 void nhrp_shortcut_purge(struct nhrp_shortcut *s, int force)
 {
-	EVENT_OFF(s->t_timer);
+	nhrp_shortcut_timers_off(s);
 	nhrp_reqid_free(&nhrp_packet_reqid, &s->reqid);
 
 	if (force) {
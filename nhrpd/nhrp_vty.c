@@ -1050,6 +1050,77 @@ DEFUN(show_dmvpn, show_dmvpn_cmd,
 	return CMD_SUCCESS;
 }
 
+DEFUN(show_dmvpn_statistics, show_dmvpn_statistics_cmd,
+	"show dmvpn statistics [json]",
+	SHOW_STR
+	"DMVPN information\n"
+	"Registration, expiry and neighbor programming counters\n"
+	JSON_STR)
+{
+	bool uj = use_json(argc, argv);
+	struct nhrp_stats *st = &nhrp_stats;
+	struct json_object *json;
+	time_t now = monotime(NULL);
+	unsigned long window = 0, peak = 0;
+	unsigned int i;
+
+	/* only seconds of the last minute count, the current one included */
+	for (i = 0; i < NHRP_STATS_WINDOW; i++) {
+		if (now - st->reg_req_window_sec[i] >= NHRP_STATS_WINDOW)
+			continue;
+		window += st->reg_req_window[i];
+		peak = MAX(peak, st->reg_req_window[i]);
+	}
+
+	if (uj) {
+		json = json_object_new_object();
+		json_object_int_add(json, "registrationsReceived",
+				    st->reg_req_rx);
+		json_object_int_add(json, "registrationCies", st->reg_cie);
+		json_object_int_add(json, "registrationCiesAccepted",
+				    st->reg_cie_ok);
+		json_object_int_add(json, "registrationsLastMinute", window);
+		json_object_int_add(json, "registrationsPeakPerSecond", peak);
+		json_object_int_add(json, "registrationsSent", st->reg_req_tx);
+		json_object_int_add(json, "registrationRepliesOk",
+				    st->reg_rep_ok);
+		json_object_int_add(json, "registrationRepliesFailed",
+				    st->reg_rep_fail);
+		json_object_int_add(json, "cacheExpired", st->cache_expired);
+		json_object_int_add(json, "shortcutsExpired",
+				    st->shortcut_expired);
+		json_object_int_add(json, "neighborUpdates", st->neigh_updates);
+		json_object_int_add(json, "neighborUpdatesCoalesced",
+				    st->neigh_coalesced);
+		json_object_int_add(json, "neighborMessagesSent",
+				    st->neigh_sent);
+		json_object_int_add(json, "neighborWrites", st->neigh_batches);
+		vty_json(vty, json);
+		return CMD_SUCCESS;
+	}
+
+	vty_out(vty, "Registrations received:  %" PRIu64 " (%" PRIu64
+		" CIEs, %" PRIu64 " accepted)\n",
+		st->reg_req_rx, st->reg_cie, st->reg_cie_ok);
+	vty_out(vty, "  last minute:           %lu (%lu.%lu/s, peak %lu/s)\n",
+		window, window / NHRP_STATS_WINDOW,
+		(window * 10 / NHRP_STATS_WINDOW) % 10, peak);
+	vty_out(vty, "Registrations sent:      %" PRIu64 " (%" PRIu64
+		" ok, %" PRIu64 " failed)\n",
+		st->reg_req_tx, st->reg_rep_ok, st->reg_rep_fail);
+	vty_out(vty, "Cache entries expired:   %" PRIu64 "\n",
+		st->cache_expired);
+	vty_out(vty, "Shortcuts expired:       %" PRIu64 "\n",
+		st->shortcut_expired);
+	vty_out(vty, "Neighbor updates:        %" PRIu64 " (%" PRIu64
+		" coalesced)\n",
+		st->neigh_updates, st->neigh_coalesced);
+	vty_out(vty, "Neighbor messages sent:  %" PRIu64 " in %" PRIu64
+		" writes\n",
+		st->neigh_sent, st->neigh_batches);
+	return CMD_SUCCESS;
+}
+
 static void clear_nhrp_cache(struct nhrp_cache *c, void *data)
 {
 	struct info_ctx *ctx = data;
@@ -1227,6 +1298,7 @@ void nhrp_config_init(void)
 	/* global commands */
 	install_element(VIEW_NODE, &show_ip_nhrp_cmd);
 	install_element(VIEW_NODE, &show_dmvpn_cmd);
+	install_element(VIEW_NODE, &show_dmvpn_statistics_cmd);
 	install_element(ENABLE_NODE, &clear_nhrp_cmd);
 
 	install_element(ENABLE_NODE, &show_debugging_nhrp_cmd);
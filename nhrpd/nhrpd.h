@@ -93,6 +93,9 @@ void nhrp_send_zebra_configure_arp(struct interface *ifp, int family);
 void nhrp_send_zebra_nbr(union sockunion *in,
 			 union sockunion *out,
 			 struct interface *ifp);
+void nhrp_queue_zebra_nbr(union sockunion *in, union sockunion *out,
+			  struct interface *ifp);
+void nhrp_flush_zebra_nbr(void);
 
 void nhrp_send_zebra_gre_source_set(struct interface *ifp,
 				    unsigned int link_idx,
@@ -212,6 +215,34 @@ enum nhrp_cache_type {
 extern const char *const nhrp_cache_type_str[];
 extern unsigned long nhrp_cache_counts[NHRP_CACHE_NUM_TYPES];
 
+#define NHRP_STATS_WINDOW 60
+
+struct nhrp_stats {
+	/* hub side */
+	uint64_t reg_req_rx;
+	uint64_t reg_cie;
+	uint64_t reg_cie_ok;
+	/* registrations received per second over the last minute */
+	uint32_t reg_req_window[NHRP_STATS_WINDOW];
+	time_t reg_req_window_sec[NHRP_STATS_WINDOW];
+
+	/* spoke side */
+	uint64_t reg_req_tx;
+	uint64_t reg_rep_ok;
+	uint64_t reg_rep_fail;
+
+	uint64_t cache_expired;
+	uint64_t shortcut_expired;
+
+	/* neighbor programming towards zebra */
+	uint64_t neigh_updates;
+	uint64_t neigh_coalesced;
+	uint64_t neigh_sent;
+	uint64_t neigh_batches;
+};
+
+extern struct nhrp_stats nhrp_stats;
+
 struct nhrp_cache_config {
 	struct interface *ifp;
 	union sockunion remote_addr;
@@ -219,6 +250,9 @@ struct nhrp_cache_config {
 	union sockunion nbma;
 };
 
+PREDECL_HEAP(nhrp_cache_expiry);
+PREDECL_HEAP(nhrp_shortcut_expiry);
+
 struct nhrp_cache {
 	struct interface *ifp;
 	union sockunion remote_addr;
@@ -235,6 +269,10 @@ struct nhrp_cache {
 	struct event *t_timeout;
 	struct event *t_auth;
 
+	/* cur.expires, while queued on the shared expiry heap */
+	struct nhrp_cache_expiry_item expiry_item;
+	time_t expiry_at;
+
 	struct {
 		enum nhrp_cache_type type;
 		union sockunion remote_nbma_natoa;
@@ -253,6 +291,10 @@ struct nhrp_shortcut {
 	struct nhrp_reqid reqid;
 	struct event *t_timer;
 
+	/* holding time based expiry, on the shared expiry heap */
+	struct nhrp_shortcut_expiry_item expiry_item;
+	time_t expiry_at;
+
 	enum nhrp_cache_type type;
 	unsigned int holding_time;
 	unsigned route_installed : 1;
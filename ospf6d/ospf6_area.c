@@ -485,6 +485,10 @@ void ospf6_area_show(struct vty *vty, struct ospf6_area *oa,
 		} else
 			json_object_boolean_false_add(json_area, "spfHasRun");
 
+		json_object_int_add(json_area, "intraFullRuns",
+				    oa->intra_full_runs);
+		json_object_int_add(json_area, "intraIncrementalRuns",
+				    oa->intra_incremental_runs);
 
 		json_object_object_add(json_areas, oa->name, json_area);
 
@@ -524,6 +528,10 @@ void ospf6_area_show(struct vty *vty, struct ospf6_area *oa,
 			}
 		} else
 			vty_out(vty, "SPF has not been run\n");
+
+		vty_out(vty,
+			"     Intra-area route calculations: %u full, %u incremental\n",
+			oa->intra_full_runs, oa->intra_incremental_runs);
 	}
 }
 
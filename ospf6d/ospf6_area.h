@@ -60,6 +60,10 @@ struct ospf6_area {
 
 	uint32_t spf_calculation; /* SPF calculation count */
 
+	/* intra-area route calculations, full and limited to SPF changes */
+	uint32_t intra_full_runs;
+	uint32_t intra_incremental_runs;
+
 	struct event *thread_router_lsa;
 	struct event *thread_intra_prefix_lsa;
 	uint32_t router_lsa_size_limit;
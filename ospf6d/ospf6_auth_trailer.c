@@ -22,9 +22,9 @@
 #include "ospf6_route.h"
 #include "ospf6_zebra.h"
 #include "lib/keychain.h"
+#include "lib/hmac.h"
 
 unsigned char conf_debug_ospf6_auth[2];
-DEFINE_MTYPE_STATIC(OSPF6D, OSPF6_AUTH_HASH_XOR, "OSPF6 auth hash xor");
 
 /*Apad is the hexadecimal value 0x878FE1F3. */
 const uint8_t ospf6_hash_apad_max[KEYCHAIN_MAX_HASH_SIZE] = {
@@ -36,34 +36,6 @@ const uint8_t ospf6_hash_apad_max[KEYCHAIN_MAX_HASH_SIZE] = {
 	0xf3, 0x87, 0x8f, 0xe1, 0xf3, 0x87, 0x8f, 0xe1, 0xf3,
 };
 
-const uint8_t ospf6_hash_ipad_max[KEYCHAIN_ALGO_MAX_INTERNAL_BLK_SIZE] = {
-	0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
-	0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
-	0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
-	0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
-	0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
-	0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
-	0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
-	0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
-	0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
-	0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
-	0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
-};
-
-const uint8_t ospf6_hash_opad_max[KEYCHAIN_ALGO_MAX_INTERNAL_BLK_SIZE] = {
-	0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c,
-	0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c,
-	0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c,
-	0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c,
-	0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c,
-	0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c,
-	0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c,
-	0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c,
-	0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c,
-	0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c,
-	0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c, 0x5c,
-};
-
 void ospf6_auth_hdr_dump_send(struct ospf6_header *ospfh, uint16_t length)
 {
 	struct ospf6_auth_hdr *ospf6_at_hdr;
@@ -127,21 +99,6 @@ void ospf6_auth_hdr_dump_recv(struct ospf6_header *ospfh, uint16_t length,
 	}
 }
 
-unsigned char *ospf6_hash_message_xor(unsigned char *mes1,
-				      unsigned char *mes2,
-				      uint32_t len)
-{
-	unsigned char *result;
-	uint32_t i;
-
-	result = XCALLOC(MTYPE_OSPF6_AUTH_HASH_XOR, len);
-
-	for (i = 0; i < len; i++)
-		result[i] = mes1[i] ^ mes2[i];
-
-	return result;
-}
-
 static void md5_digest(unsigned char *mes, uint32_t len,
 		       unsigned char *digest)
 {
@@ -529,7 +486,7 @@ int ospf6_auth_check_digest(struct ospf6_header *oh, struct ospf6_interface *oi,
 
 	ospf6_auth_update_digest(oi, oh, ospf6_auth, auth_str,
 				 (oh_len + auth_len + lls_block_len),
-				 hash_algo);
+				 hash_algo, key ? &key->hmac : NULL);
 
 #ifdef CRYPTO_OPENSSL
 	ret = CRYPTO_memcmp(temp_hash, ospf6_auth->data, hash_len);
@@ -639,7 +596,7 @@ void ospf6_auth_digest_send(struct in6_addr *src, struct ospf6_interface *oi,
 	memcpy(ospf6_auth->data, apad, hash_len);
 
 	ospf6_auth_update_digest(oi, oh, ospf6_auth, auth_str, pkt_len,
-				 hash_algo);
+				 hash_algo, key ? &key->hmac : NULL);
 
 	/* There is a optimisation that is done to ensure that
 	 * for every packet flow keychain lib API are called
@@ -660,56 +617,43 @@ void ospf6_auth_digest_send(struct in6_addr *src, struct ospf6_interface *oi,
 	}
 }
 
+/* The HMAC key is the auth string followed by the CPID (RFC 7166 4.5), hashed
+ * if longer than the digest and padded to keychain_get_block_size().  The
+ * state after the pads is kept in *cache, or in the hmac library's cache if
+ * the key doesn't come from a keychain.
+ */
 void ospf6_auth_update_digest(struct ospf6_interface *oi,
 			      struct ospf6_header *oh,
 			      struct ospf6_auth_hdr *ospf6_auth, char *auth_str,
-			      uint32_t pkt_len, enum keychain_hash_algo algo)
+			      uint32_t pkt_len, enum keychain_hash_algo algo,
+			      struct hmac_key **cache)
 {
 	static const uint16_t cpid = 1;
 	uint32_t hash_len = keychain_get_hash_len(algo);
 	uint32_t block_s = keychain_get_block_size(algo);
 	uint32_t k_len = strlen(auth_str);
 	uint32_t ks_len = strlen(auth_str) + sizeof(cpid);
-	unsigned char ipad[block_s];
-	unsigned char opad[block_s];
-	unsigned char ko[block_s], ks[ks_len], tmp[hash_len];
-	unsigned char *first = NULL;
-	unsigned char *second = NULL;
-	unsigned char first_mes[block_s + pkt_len];
-	unsigned char second_mes[block_s + pkt_len];
-	unsigned char first_hash[hash_len];
-	unsigned char second_hash[hash_len];
-
-	memset(ko, 0, sizeof(ko));
+	unsigned char ks[ks_len], tmp[hash_len];
+	const unsigned char *ko = ks;
+	uint32_t ko_len = ks_len;
+	struct hmac_key *hk;
+
 	memcpy(ks, auth_str, k_len);
 	memcpy(ks + k_len, &cpid, sizeof(cpid));
 	if (ks_len > hash_len) {
 		ospf6_hash_hmac_sha_digest(algo, ks, ks_len, tmp);
-		memcpy(ko, tmp, hash_len);
-	} else
-		memcpy(ko, ks, ks_len);
-
-	memcpy(ipad, ospf6_hash_ipad_max, block_s);
-	memcpy(opad, ospf6_hash_opad_max, block_s);
-
-	first = ospf6_hash_message_xor((unsigned char *)&ipad, ko, block_s);
-	second = ospf6_hash_message_xor((unsigned char *)&opad, ko, block_s);
-
-	memcpy(first_mes, first, block_s);
-	memcpy(first_mes + block_s, oh, pkt_len);
-
-	ospf6_hash_hmac_sha_digest(algo, first_mes, (block_s + pkt_len),
-				   first_hash);
-
-	memcpy(second_mes, second, block_s);
-	memcpy(second_mes + block_s, first_hash, hash_len);
+		ko = tmp;
+		ko_len = hash_len;
+	}
 
-	ospf6_hash_hmac_sha_digest(algo, second_mes, (block_s + hash_len),
-				   second_hash);
+	if (cache)
+		hk = hmac_key_get(cache, algo, ko, ko_len, block_s);
+	else
+		hk = hmac_key_lookup(algo, ko, ko_len, block_s);
+	if (!hk)
+		return;
 
-	memcpy(ospf6_auth->data, second_hash, hash_len);
-	XFREE(MTYPE_OSPF6_AUTH_HASH_XOR, first);
-	XFREE(MTYPE_OSPF6_AUTH_HASH_XOR, second);
+	hmac_digest(hk, oh, pkt_len, ospf6_auth->data);
 }
 
 DEFUN (debug_ospf6_auth,
@@ -7,6 +7,7 @@
 #define __OSPF6_AUTH_TRAILER_H__
 
 #include "lib/keychain.h"
+#include "lib/hmac.h"
 #include "ospf6_message.h"
 
 #define OSPF6_AUTH_HDR_MIN_SIZE 16
@@ -53,8 +54,6 @@ enum ospf6_auth_err {
 void ospf6_auth_hdr_dump_send(struct ospf6_header *ospfh, uint16_t length);
 void ospf6_auth_hdr_dump_recv(struct ospf6_header *ospfh, uint16_t length,
 			      unsigned int lls_len);
-unsigned char *ospf6_hash_message_xor(unsigned char *mes1, unsigned char *mes2,
-				      uint32_t len);
 uint16_t ospf6_auth_len_get(struct ospf6_interface *oi);
 int ospf6_auth_validate_pkt(struct ospf6_interface *oi, unsigned int *pkt_len,
 			    struct ospf6_header *oh, unsigned int *at_len,
@@ -64,7 +63,8 @@ int ospf6_auth_check_digest(struct ospf6_header *oh, struct ospf6_interface *oi,
 void ospf6_auth_update_digest(struct ospf6_interface *oi,
 			      struct ospf6_header *oh,
 			      struct ospf6_auth_hdr *ospf6_auth, char *auth_str,
-			      uint32_t pkt_len, enum keychain_hash_algo algo);
+			      uint32_t pkt_len, enum keychain_hash_algo algo,
+			      struct hmac_key **cache);
 void ospf6_auth_digest_send(struct in6_addr *src, struct ospf6_interface *oi,
 			    struct ospf6_header *oh, uint16_t auth_len,
 			    uint32_t pkt_len);
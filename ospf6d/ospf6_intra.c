@@ -2048,7 +2048,101 @@ void ospf6_intra_prefix_lsa_remove(struct ospf6_lsa *lsa)
 		zlog_debug("Trailing garbage ignored");
 }
 
-void ospf6_intra_route_calculation(struct ospf6_area *oa)
+static bool ospf6_intra_ls_changed(struct route_table *ls_changed,
+				   struct prefix *ls_prefix)
+{
+	struct route_node *rn;
+
+	rn = route_node_lookup(ls_changed, ls_prefix);
+	if (!rn)
+		return false;
+
+	route_unlock_node(rn);
+	return true;
+}
+
+/* Does the route use any of the link state entries changed by the SPF? */
+static bool ospf6_intra_route_affected(struct ospf6_route *route,
+				       struct route_table *ls_changed)
+{
+	struct listnode *node;
+	struct ospf6_path *path;
+
+	if (ospf6_intra_ls_changed(ls_changed, &route->path.ls_prefix))
+		return true;
+
+	for (ALL_LIST_ELEMENTS_RO(route->paths, node, path))
+		if (ospf6_intra_ls_changed(ls_changed, &path->ls_prefix))
+			return true;
+
+	return false;
+}
+
+/*
+ * Mark the routes needing a recalculation after a SPF run that changed
+ * the link state entries in ls_changed.  Those routes are recalculated from
+ * all LSAs contributing to them, the LSAs are flagged as OSPF6_LSA_RECALC.
+ */
+static void ospf6_intra_route_mark_affected(struct ospf6_area *oa,
+					    struct route_table *ls_changed)
+{
+	struct ospf6_route *route;
+	struct listnode *node;
+	struct ospf6_path *path;
+	struct ospf6_lsa *lsa;
+
+	for (route = ospf6_route_head(oa->route_table); route;
+	     route = ospf6_route_next(route)) {
+		if (!ospf6_intra_route_affected(route, ls_changed)) {
+			route->flag = 0;
+			continue;
+		}
+
+		route->flag = OSPF6_ROUTE_REMOVE;
+		for (ALL_LIST_ELEMENTS_RO(route->paths, node, path)) {
+			if (path->origin.type
+			    != htons(OSPF6_LSTYPE_INTRA_PREFIX))
+				continue;
+
+			lsa = ospf6_lsdb_lookup(path->origin.type,
+						path->origin.id,
+						path->origin.adv_router,
+						oa->lsdb);
+			if (lsa)
+				SET_FLAG(lsa->flag, OSPF6_LSA_RECALC);
+		}
+	}
+}
+
+static bool ospf6_intra_prefix_lsa_affected(struct ospf6_lsa *lsa,
+					    struct route_table *ls_changed)
+{
+	struct ospf6_intra_prefix_lsa *intra_prefix_lsa;
+	struct prefix ls_prefix;
+
+	if (CHECK_FLAG(lsa->flag, OSPF6_LSA_RECALC)) {
+		UNSET_FLAG(lsa->flag, OSPF6_LSA_RECALC);
+		return true;
+	}
+
+	intra_prefix_lsa = (struct ospf6_intra_prefix_lsa *)
+		OSPF6_LSA_HEADER_END(lsa->header);
+	ospf6_linkstate_prefix(intra_prefix_lsa->ref_adv_router,
+			       intra_prefix_lsa->ref_id, &ls_prefix);
+
+	return ospf6_intra_ls_changed(ls_changed, &ls_prefix);
+}
+
+/*
+ * Recalculate the intra-area routes of an area after its SPF tree was
+ * rebuilt.  If ls_changed is given it holds the link state entries (in
+ * spf_table) that were added, removed or whose cost or nexthops changed in
+ * the last run, and only the routes depending on those are recalculated.
+ * Everything else is still valid as intra-area-prefix LSA updates are
+ * processed when they arrive.
+ */
+void ospf6_intra_route_calculation(struct ospf6_area *oa,
+				   struct route_table *ls_changed)
 {
 	struct ospf6_route *route, *nroute;
 	uint16_t type;
@@ -2058,32 +2152,53 @@ void ospf6_intra_route_calculation(struct ospf6_area *oa)
 	char buf[PREFIX2STR_BUFFER];
 
 	if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX))
-		zlog_debug("Re-examin intra-routes for area %s", oa->name);
+		zlog_debug("Re-examin %s intra-routes for area %s",
+			   ls_changed ? "affected" : "all", oa->name);
 
 	hook_add = oa->route_table->hook_add;
 	hook_remove = oa->route_table->hook_remove;
 	oa->route_table->hook_add = NULL;
 	oa->route_table->hook_remove = NULL;
 
-	for (route = ospf6_route_head(oa->route_table); route;
-	     route = ospf6_route_next(route))
-		route->flag = OSPF6_ROUTE_REMOVE;
-
 	type = htons(OSPF6_LSTYPE_INTRA_PREFIX);
-	for (ALL_LSDB_TYPED(oa->lsdb, type, lsa))
-		ospf6_intra_prefix_lsa_add(lsa);
+	if (ls_changed) {
+		oa->intra_incremental_runs++;
+
+		ospf6_intra_route_mark_affected(oa, ls_changed);
+
+		for (ALL_LSDB_TYPED(oa->lsdb, type, lsa))
+			if (ospf6_intra_prefix_lsa_affected(lsa, ls_changed))
+				ospf6_intra_prefix_lsa_add(lsa);
+	} else {
+		oa->intra_full_runs++;
+
+		for (route = ospf6_route_head(oa->route_table); route;
+		     route = ospf6_route_next(route))
+			route->flag = OSPF6_ROUTE_REMOVE;
+
+		for (ALL_LSDB_TYPED(oa->lsdb, type, lsa))
+			ospf6_intra_prefix_lsa_add(lsa);
+	}
 
 	oa->route_table->hook_add = hook_add;
 	oa->route_table->hook_remove = hook_remove;
 
 	for (route = ospf6_route_head(oa->route_table); route; route = nroute) {
+		nroute = ospf6_route_next(route);
+
+		/* not looked at by an incremental run */
+		if (ls_changed
+		    && !CHECK_FLAG(route->flag, OSPF6_ROUTE_ADD
+							| OSPF6_ROUTE_CHANGE
+							| OSPF6_ROUTE_REMOVE))
+			continue;
+
 		if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX)) {
 			prefix2str(&route->prefix, buf, sizeof(buf));
 			zlog_debug("%s: route %s, flag 0x%x", __func__, buf,
 				   route->flag);
 		}
 
-		nroute = ospf6_route_next(route);
 		if (CHECK_FLAG(route->flag, OSPF6_ROUTE_REMOVE)
 		    && CHECK_FLAG(route->flag, OSPF6_ROUTE_ADD)) {
 			UNSET_FLAG(route->flag, OSPF6_ROUTE_REMOVE);
@@ -2167,9 +2282,35 @@ static void ospf6_brouter_debug_print(struct ospf6_route *brouter)
 		   listcount(brouter->nh_list));
 }
 
+/*
+ * Find the entry ospf6_route_add() would replace when adding key to the
+ * border router table, NULL if key would be added as another path.
+ */
+static struct ospf6_route *
+ospf6_intra_brouter_lookup_old(struct ospf6_route_table *table,
+			       struct ospf6_route *key)
+{
+	struct ospf6_route *current;
+
+	for (current = ospf6_route_lookup(&key->prefix, table); current;
+	     current = current->next) {
+		if (!ospf6_route_is_same(current, key))
+			break;
+		if (current->type != key->type)
+			continue;
+		if (ospf6_route_is_same_origin(current, key))
+			return current;
+		if (ospf6_route_cmp(current, key) > 0)
+			break;
+	}
+
+	return NULL;
+}
+
 void ospf6_intra_brouter_calculation(struct ospf6_area *oa)
 {
-	struct ospf6_route *brouter, *nbrouter, *copy;
+	struct ospf6_route *brouter, *nbrouter, *copy, *old;
+	struct ospf6_route key_route, *key = &key_route;
 	void (*hook_add)(struct ospf6_route *) = NULL;
 	void (*hook_remove)(struct ospf6_route *) = NULL;
 	uint32_t brouter_id;
@@ -2226,10 +2367,23 @@ void ospf6_intra_brouter_calculation(struct ospf6_area *oa)
 		    || !OSPF6_OPT_ISSET(brouter->path.options, OSPF6_OPT_R))
 			continue;
 
-		copy = ospf6_route_copy(brouter);
-		copy->type = OSPF6_DEST_TYPE_ROUTER;
-		copy->path.area_id = oa->area_id;
-		ospf6_route_add(copy, oa->ospf6->brouter_table);
+		/*
+		 * Most border routers are unchanged by a SPF run, don't copy
+		 * them just to find out ospf6_route_add() has nothing to do.
+		 */
+		*key = *brouter;
+		key->type = OSPF6_DEST_TYPE_ROUTER;
+		key->path.area_id = oa->area_id;
+		old = ospf6_intra_brouter_lookup_old(oa->ospf6->brouter_table,
+						     key);
+		if (old && ospf6_route_is_identical(old, key)) {
+			SET_FLAG(old->flag, OSPF6_ROUTE_ADD);
+		} else {
+			copy = ospf6_route_copy(brouter);
+			copy->type = OSPF6_DEST_TYPE_ROUTER;
+			copy->path.area_id = oa->area_id;
+			ospf6_route_add(copy, oa->ospf6->brouter_table);
+		}
 
 		if (IS_OSPF6_DEBUG_BROUTER_SPECIFIC_ROUTER_ID(brouter_id)
 		    || IS_OSPF6_DEBUG_ROUTE(MEMORY)) {
@@ -228,7 +228,9 @@ extern void ospf6_intra_prefix_lsa_originate_stub(struct event *thread);
 extern void ospf6_intra_prefix_lsa_add(struct ospf6_lsa *lsa);
 extern void ospf6_intra_prefix_lsa_remove(struct ospf6_lsa *lsa);
 extern void ospf6_orig_as_external_lsa(struct event *thread);
-extern void ospf6_intra_route_calculation(struct ospf6_area *oa);
+struct route_table;
+extern void ospf6_intra_route_calculation(struct ospf6_area *oa,
+					  struct route_table *ls_changed);
 extern void ospf6_intra_brouter_calculation(struct ospf6_area *oa);
 extern void ospf6_intra_prefix_route_ecmp_path(struct ospf6_area *oa,
 					       struct ospf6_route *old,
@@ -142,6 +142,7 @@ struct ospf6_lsa {
 #define OSPF6_LSA_UNAPPROVED 0x10
 #define OSPF6_LSA_SEQWRAPPED 0x20
 #define OSPF6_LSA_FLUSH      0x40
+#define OSPF6_LSA_RECALC     0x80 /* intra-area route recalc pending */
 
 struct ospf6_lsa_handler {
 	uint16_t lh_type; /* host byte order */
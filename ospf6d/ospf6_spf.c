@@ -12,6 +12,7 @@
 #include "command.h"
 #include "vty.h"
 #include "prefix.h"
+#include "table.h"
 #include "linklist.h"
 #include "frrevent.h"
 #include "lib_errors.h"
@@ -590,6 +591,127 @@ static void ospf6_spf_log_database(struct ospf6_area *oa)
 	zlog_debug("%s", buffer);
 }
 
+static char ospf6_spf_changed_mark;
+
+static void ospf6_spf_mark_changed(struct route_table **table,
+				   struct prefix *p)
+{
+	struct route_node *rn;
+
+	if (!*table)
+		*table = route_table_init();
+
+	rn = route_node_get(*table, p);
+	if (rn->info)
+		route_unlock_node(rn);
+	else
+		rn->info = &ospf6_spf_changed_mark;
+}
+
+static void ospf6_spf_changed_free(struct route_table *table)
+{
+	struct route_node *rn;
+
+	if (!table)
+		return;
+
+	for (rn = route_top(table); rn; rn = route_next(rn))
+		if (rn->info) {
+			rn->info = NULL;
+			route_unlock_node(rn);
+		}
+
+	route_table_finish(table);
+}
+
+static bool ospf6_spf_entry_same(struct ospf6_route *a, struct ospf6_route *b)
+{
+	return a->path.cost == b->path.cost
+	       && !memcmp(a->path.options, b->path.options,
+			  sizeof(a->path.options))
+	       && a->path.router_bits == b->path.router_bits
+	       && ospf6_route_cmp_nexthops(a, b);
+}
+
+/*
+ * Compare the previous and the new SPF tree of an area, returns the link
+ * state entries that appeared, disappeared or changed (NULL if none did).
+ */
+static struct route_table *
+ospf6_spf_table_changes(struct ospf6_route_table *old_table,
+			struct ospf6_route_table *new_table)
+{
+	struct route_table *changed = NULL;
+	struct ospf6_route *route, *other;
+
+	for (route = ospf6_route_head(new_table); route;
+	     route = ospf6_route_next(route)) {
+		other = ospf6_route_lookup(&route->prefix, old_table);
+		if (!other || !ospf6_spf_entry_same(route, other))
+			ospf6_spf_mark_changed(&changed, &route->prefix);
+	}
+
+	for (route = ospf6_route_head(old_table); route;
+	     route = ospf6_route_next(route))
+		if (!ospf6_route_lookup(&route->prefix, new_table))
+			ospf6_spf_mark_changed(&changed, &route->prefix);
+
+	return changed;
+}
+
+/*
+ * Intra-area routes only depend on the SPF tree and on the intra-area-prefix
+ * LSAs, which are processed as they arrive.  So if the only thing that
+ * happened since the last run are topology changes the intra-area routes
+ * referencing unchanged parts of the tree can be left alone.  On an ABR the
+ * area ranges are recomputed from scratch and need to see every route.
+ */
+static bool ospf6_spf_intra_full(struct ospf6 *ospf6)
+{
+	const unsigned int topology = OSPF6_SPF_FLAGS_ROUTER_LSA_ADDED
+				      | OSPF6_SPF_FLAGS_ROUTER_LSA_REMOVED
+				      | OSPF6_SPF_FLAGS_NETWORK_LSA_ADDED
+				      | OSPF6_SPF_FLAGS_NETWORK_LSA_REMOVED
+				      | OSPF6_SPF_FLAGS_LINK_LSA_ADDED
+				      | OSPF6_SPF_FLAGS_LINK_LSA_REMOVED
+				      | OSPF6_SPF_FLAGS_ROUTER_LSA_ORIGINATED
+				      | OSPF6_SPF_FLAGS_NETWORK_LSA_ORIGINATED;
+
+	return CHECK_FLAG(ospf6->spf_reason, ~topology)
+	       || ospf6_check_and_set_router_abr(ospf6);
+}
+
+static void ospf6_spf_area_calculation(struct ospf6 *ospf6,
+				       struct ospf6_area *oa, bool full)
+{
+	struct ospf6_route_table *old_table = NULL;
+	struct route_table *changed = NULL;
+
+	/* keep the previous tree around to find out what changed */
+	if (!full && oa->spf_calculation) {
+		old_table = oa->spf_table;
+		oa->spf_table = OSPF6_ROUTE_TABLE_CREATE(AREA, SPF_RESULTS);
+		oa->spf_table->scope = oa;
+	}
+
+	ospf6_spf_calculation(ospf6->router_id, oa->spf_table, oa);
+
+	if (old_table) {
+		changed = ospf6_spf_table_changes(old_table, oa->spf_table);
+		ospf6_spf_table_finish(old_table);
+		ospf6_route_table_delete(old_table);
+
+		/* nothing to do, pass an empty table */
+		if (!changed)
+			changed = route_table_init();
+	}
+
+	ospf6_intra_route_calculation(oa, changed);
+	ospf6_intra_brouter_calculation(oa);
+
+	ospf6_spf_changed_free(changed);
+}
+
 static void ospf6_spf_calculation_thread(struct event *t)
 {
 	struct ospf6_area *oa;
@@ -598,6 +720,7 @@ static void ospf6_spf_calculation_thread(struct event *t)
 	struct listnode *node;
 	int areas_processed = 0;
 	char rbuf[32];
+	bool full;
 
 	ospf6 = (struct ospf6 *)EVENT_ARG(t);
 
@@ -608,6 +731,8 @@ static void ospf6_spf_calculation_thread(struct event *t)
 	if (ospf6_check_and_set_router_abr(ospf6))
 		ospf6_abr_range_reset_cost(ospf6);
 
+	full = ospf6_spf_intra_full(ospf6);
+
 	for (ALL_LIST_ELEMENTS_RO(ospf6->area_list, node, oa)) {
 
 		if (oa == ospf6->backbone)
@@ -619,9 +744,7 @@ static void ospf6_spf_calculation_thread(struct event *t)
 		if (IS_OSPF6_DEBUG_SPF(DATABASE))
 			ospf6_spf_log_database(oa);
 
-		ospf6_spf_calculation(ospf6->router_id, oa->spf_table, oa);
-		ospf6_intra_route_calculation(oa);
-		ospf6_intra_brouter_calculation(oa);
+		ospf6_spf_area_calculation(ospf6, oa, full);
 
 		areas_processed++;
 	}
@@ -634,11 +757,7 @@ static void ospf6_spf_calculation_thread(struct event *t)
 		if (IS_OSPF6_DEBUG_SPF(DATABASE))
 			ospf6_spf_log_database(ospf6->backbone);
 
-		ospf6_spf_calculation(ospf6->router_id,
-				      ospf6->backbone->spf_table,
-				      ospf6->backbone);
-		ospf6_intra_route_calculation(ospf6->backbone);
-		ospf6_intra_brouter_calculation(ospf6->backbone);
+		ospf6_spf_area_calculation(ospf6, ospf6->backbone, full);
 		areas_processed++;
 	}
 
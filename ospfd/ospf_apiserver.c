@@ -22,6 +22,7 @@
 #include "hash.h"
 #include "sockunion.h" /* for inet_aton() */
 #include "buffer.h"
+#include "network.h"
 
 #include <sys/types.h>
 
@@ -48,6 +49,7 @@
 
 DEFINE_MTYPE_STATIC(OSPFD, APISERVER, "API Server");
 DEFINE_MTYPE_STATIC(OSPFD, APISERVER_MSGFILTER, "API Server Message Filter");
+DEFINE_MTYPE_STATIC(OSPFD, APISERVER_DUMP, "API Server LSDB dump");
 
 /* This is an implementation of an API to the OSPF daemon that allows
  * external applications to access the OSPF daemon through socket
@@ -62,6 +64,9 @@ DEFINE_MTYPE_STATIC(OSPFD, APISERVER_MSGFILTER, "API Server Message Filter");
 /* List of all active connections. */
 struct list *apiserver_list;
 
+static void apiserver_dump_free(struct ospf_apiserver *apiserv);
+static void apiserver_dump_resume(struct ospf_apiserver *apiserv);
+
 /* -----------------------------------------------------------
  * Functions to lookup interfaces
  * -----------------------------------------------------------
@@ -265,6 +270,7 @@ struct ospf_apiserver *ospf_apiserver_new(int fd_sync, int fd_async)
 #endif /* USE_ASYNC_READ */
 	new->t_sync_write = NULL;
 	new->t_async_write = NULL;
+	new->dump = NULL;
 
 	new->filter->typemask = 0; /* filter all LSAs */
 	new->filter->origin = ANY_ORIGIN;
@@ -319,6 +325,8 @@ void ospf_apiserver_free(struct ospf_apiserver *apiserv)
 	EVENT_OFF(apiserv->t_sync_write);
 	EVENT_OFF(apiserv->t_async_write);
 
+	apiserver_dump_free(apiserv);
+
 	/* Unregister all opaque types that application registered
 	   and flush opaque LSAs if still in LSDB. */
 
@@ -419,10 +427,64 @@ void ospf_apiserver_read(struct event *thread)
 	msg_free(msg);
 }
 
+/*
+ * Write out as many queued messages as fit into one buffer with a single
+ * system call.  The stream carries no framing beyond the message headers,
+ * so this is invisible to the client.
+ */
+#define APISERVER_WRITE_BATCH (64 * 1024)
+
+static int ospf_apiserver_write_fifo(int fd, struct msg_fifo *fifo)
+{
+	static uint8_t buf[APISERVER_WRITE_BATCH];
+	struct msg *msg;
+	size_t len = 0;
+	uint16_t l;
+	ssize_t wlen;
+
+	static_assert(APISERVER_WRITE_BATCH
+			      >= sizeof(struct apimsghdr) + OSPF_MAX_LSA_SIZE,
+		      "API write buffer can't hold a message");
+
+	while ((msg = msg_fifo_head(fifo))) {
+		/* Length of OSPF LSA payload */
+		l = ntohs(msg->hdr.msglen);
+		if (l > OSPF_MAX_LSA_SIZE) {
+			zlog_warn("%s: wrong LSA size %d", __func__, l);
+			return -1;
+		}
+		if (len + sizeof(struct apimsghdr) + l > sizeof(buf))
+			break;
+
+		if (IS_DEBUG_OSPF_EVENT)
+			msg_print(msg);
+
+		memcpy(buf + len, &msg->hdr, sizeof(struct apimsghdr));
+		len += sizeof(struct apimsghdr);
+		memcpy(buf + len, STREAM_DATA(msg->s), l);
+		len += l;
+
+		/* Once a message is dequeued, it should be freed anyway. */
+		msg_free(msg_fifo_pop(fifo));
+	}
+
+	wlen = writen(fd, buf, len);
+	if (wlen < 0) {
+		zlog_warn("%s: writen %s", __func__, safe_strerror(errno));
+		return -1;
+	} else if (wlen == 0) {
+		zlog_warn("%s: Connection closed by peer", __func__);
+		return -1;
+	} else if ((size_t)wlen != len) {
+		zlog_warn("%s: Cannot write API message", __func__);
+		return -1;
+	}
+	return 0;
+}
+
 void ospf_apiserver_sync_write(struct event *thread)
 {
 	struct ospf_apiserver *apiserv;
-	struct msg *msg;
 	int fd;
 	int rc = -1;
 
@@ -444,19 +506,12 @@ void ospf_apiserver_sync_write(struct event *thread)
 			   ntohs(apiserv->peer_sync.sin_port));
 
 	/* Check whether there is really a message in the fifo. */
-	msg = msg_fifo_pop(apiserv->out_sync_fifo);
-	if (!msg) {
+	if (!msg_fifo_head(apiserv->out_sync_fifo)) {
 		zlog_warn("API: %s: No message in Sync-FIFO?", __func__);
 		return;
 	}
 
-	if (IS_DEBUG_OSPF_EVENT)
-		msg_print(msg);
-
-	rc = msg_write(fd, msg);
-
-	/* Once a message is dequeued, it should be freed anyway. */
-	msg_free(msg);
+	rc = ospf_apiserver_write_fifo(fd, apiserv->out_sync_fifo);
 
 	if (rc < 0) {
 		zlog_warn("%s: write failed on fd=%d", __func__, fd);
@@ -482,7 +537,6 @@ out:
 void ospf_apiserver_async_write(struct event *thread)
 {
 	struct ospf_apiserver *apiserv;
-	struct msg *msg;
 	int fd;
 	int rc = -1;
 
@@ -504,19 +558,12 @@ void ospf_apiserver_async_write(struct event *thread)
 			   ntohs(apiserv->peer_async.sin_port));
 
 	/* Check whether there is really a message in the fifo. */
-	msg = msg_fifo_pop(apiserv->out_async_fifo);
-	if (!msg) {
+	if (!msg_fifo_head(apiserv->out_async_fifo)) {
 		zlog_warn("API: %s: No message in Async-FIFO?", __func__);
 		return;
 	}
 
-	if (IS_DEBUG_OSPF_EVENT)
-		msg_print(msg);
-
-	rc = msg_write(fd, msg);
-
-	/* Once a message is dequeued, it should be freed anyway. */
-	msg_free(msg);
+	rc = ospf_apiserver_write_fifo(fd, apiserv->out_async_fifo);
 
 	if (rc < 0) {
 		zlog_warn("%s: write failed on fd=%d", __func__, fd);
@@ -530,6 +577,8 @@ void ospf_apiserver_async_write(struct event *thread)
 				     apiserv->fd_async, apiserv);
 	}
 
+	apiserver_dump_resume(apiserv);
+
 out:
 
 	if (rc < 0) {
@@ -1177,65 +1226,161 @@ int ospf_apiserver_handle_register_event(struct ospf_apiserver *apiserv,
  * -----------------------------------------------------------
  */
 
-static int apiserver_sync_callback(struct ospf_lsa *lsa, void *p_arg,
-				   int int_arg)
+/*
+ * The LSDB is dumped from a snapshot of the matching LSAs taken when the
+ * request comes in.  It is fed into the async fifo a chunk at a time and
+ * only while the fifo is short, so a large LSDB neither sits in the fifo
+ * as messages nor blocks ospfd until the client has read all of it.
+ */
+#define APISERVER_DUMP_CHUNK 256
+/* pause the dump at this many queued async messages, resume below LOW */
+#define APISERVER_DUMP_FIFO_HIGH 1024
+#define APISERVER_DUMP_FIFO_LOW 256
+
+struct apiserver_dump_entry {
+	struct ospf_lsa *lsa;
+	/* to find the LSDB the LSA has to still be in when it is sent */
+	struct in_addr area_id;
+};
+
+struct ospf_apiserver_dump {
+	uint32_t seqnum;
+
+	struct apiserver_dump_entry *entries;
+	size_t count, alloc;
+	size_t pos;
+
+	/* LSAs replaced or removed before their turn */
+	size_t skipped;
+
+	struct event *t_run;
+};
+
+static void apiserver_dump_free(struct ospf_apiserver *apiserv)
 {
-	struct ospf_apiserver *apiserv;
-	int seqnum;
-	struct msg *msg;
-	struct param_t {
-		struct ospf_apiserver *apiserv;
-		struct lsa_filter_type *filter;
-	} * param;
-	int rc = -1;
+	struct ospf_apiserver_dump *dump = apiserv->dump;
 
-	/* Sanity check */
-	assert(lsa->data);
-	assert(p_arg);
+	if (!dump)
+		return;
 
-	param = (struct param_t *)p_arg;
-	apiserv = param->apiserv;
-	seqnum = (uint32_t)int_arg;
+	EVENT_OFF(dump->t_run);
+	for (; dump->pos < dump->count; dump->pos++)
+		ospf_lsa_unlock(&dump->entries[dump->pos].lsa);
+	XFREE(MTYPE_APISERVER_DUMP, dump->entries);
+	XFREE(MTYPE_APISERVER_DUMP, apiserv->dump);
+}
+
+static void apiserver_dump_add(struct ospf_apiserver_dump *dump,
+			       struct ospf_lsa *lsa,
+			       const struct lsa_filter_type *filter)
+{
+	struct apiserver_dump_entry *e;
 
 	/* Check origin in filter. */
-	if ((param->filter->origin == ANY_ORIGIN)
-	    || (param->filter->origin == (lsa->flags & OSPF_LSA_SELF))) {
+	if ((filter->origin != ANY_ORIGIN)
+	    && (filter->origin != (lsa->flags & OSPF_LSA_SELF)))
+		return;
 
-		/* Default area for AS-External and Opaque11 LSAs */
-		struct in_addr area_id = {.s_addr = 0L};
+	if (dump->count == dump->alloc) {
+		dump->alloc = dump->alloc ? dump->alloc * 2 : 1024;
+		dump->entries = XREALLOC(MTYPE_APISERVER_DUMP, dump->entries,
+					 dump->alloc * sizeof(*dump->entries));
+	}
 
-		/* Default interface for non Opaque9 LSAs */
-		struct in_addr ifaddr = {.s_addr = 0L};
+	e = &dump->entries[dump->count++];
+	e->lsa = ospf_lsa_lock(lsa);
+	e->area_id.s_addr = lsa->area ? lsa->area->area_id.s_addr : 0;
+}
 
-		if (lsa->area) {
-			area_id = lsa->area->area_id;
-		}
-		if (lsa->data->type == OSPF_OPAQUE_LINK_LSA) {
-			ifaddr = lsa->oi->address->u.prefix4;
-		}
+/* Send one LSA of the dump, if it still is the current one */
+static void apiserver_dump_send(struct ospf_apiserver *apiserv,
+				struct ospf *ospf,
+				struct apiserver_dump_entry *e)
+{
+	struct ospf_apiserver_dump *dump = apiserv->dump;
+	struct ospf_lsa *lsa = e->lsa;
+	struct ospf_lsdb *lsdb = ospf->lsdb;
+	struct ospf_area *area = NULL;
+	/* Default interface for non Opaque9 LSAs */
+	struct in_addr ifaddr = {.s_addr = 0L};
+	struct msg *msg;
 
-		msg = new_msg_lsa_change_notify(
-			MSG_LSA_UPDATE_NOTIFY, seqnum, ifaddr, area_id,
-			lsa->flags & OSPF_LSA_SELF, lsa->data);
-		if (!msg) {
-			zlog_warn("%s: new_msg_update failed", __func__);
-#ifdef NOTYET
-			/* Cannot allocate new message. What should we do? */
-			/*        ospf_apiserver_free (apiserv);*/ /* Do nothing
-								      here XXX
-								      */
-#endif
-			goto out;
-		}
+	if (lsa->data->type != OSPF_AS_EXTERNAL_LSA
+	    && lsa->data->type != OSPF_OPAQUE_AS_LSA) {
+		area = ospf_area_lookup_by_area_id(ospf, e->area_id);
+		lsdb = area ? area->lsdb : NULL;
+	}
 
-		/* Send LSA */
-		ospf_apiserver_send_msg(apiserv, msg);
-		msg_free(msg);
+	/* the client got notified of whatever replaced it, or its removal */
+	if (!lsdb || ospf_lsdb_lookup(lsdb, lsa) != lsa) {
+		dump->skipped++;
+		return;
 	}
-	rc = 0;
 
-out:
-	return rc;
+	if (lsa->data->type == OSPF_OPAQUE_LINK_LSA)
+		ifaddr = lsa->oi->address->u.prefix4;
+
+	msg = new_msg_lsa_change_notify(MSG_LSA_UPDATE_NOTIFY, dump->seqnum,
+					ifaddr, e->area_id,
+					lsa->flags & OSPF_LSA_SELF, lsa->data);
+	if (!msg) {
+		zlog_warn("%s: new_msg_update failed", __func__);
+		return;
+	}
+
+	/* Send LSA */
+	ospf_apiserver_send_msg(apiserv, msg);
+	msg_free(msg);
+}
+
+static void apiserver_dump_run(struct event *thread)
+{
+	struct ospf_apiserver *apiserv = EVENT_ARG(thread);
+	struct ospf_apiserver_dump *dump = apiserv->dump;
+	struct ospf *ospf;
+	unsigned int i;
+
+	ospf = ospf_lookup_by_vrf_id(VRF_DEFAULT);
+	if (!ospf) {
+		apiserver_dump_free(apiserv);
+		return;
+	}
+
+	for (i = 0; i < APISERVER_DUMP_CHUNK && dump->pos < dump->count;
+	     i++, dump->pos++) {
+		/* resumed from ospf_apiserver_async_write() */
+		if (apiserv->out_async_fifo->count >= APISERVER_DUMP_FIFO_HIGH)
+			return;
+
+		apiserver_dump_send(apiserv, ospf, &dump->entries[dump->pos]);
+		ospf_lsa_unlock(&dump->entries[dump->pos].lsa);
+	}
+
+	if (dump->pos < dump->count) {
+		event_add_event(master, apiserver_dump_run, apiserv, 0,
+				&dump->t_run);
+		return;
+	}
+
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug("API: LSDB dump to %pI4/%u done, %zu LSAs, %zu skipped",
+			   &apiserv->peer_async.sin_addr,
+			   ntohs(apiserv->peer_async.sin_port), dump->count,
+			   dump->skipped);
+
+	apiserver_dump_free(apiserv);
+}
+
+/* called as the async fifo drains */
+static void apiserver_dump_resume(struct ospf_apiserver *apiserv)
+{
+	struct ospf_apiserver_dump *dump = apiserv->dump;
+
+	if (!dump || dump->t_run
+	    || apiserv->out_async_fifo->count >= APISERVER_DUMP_FIFO_LOW)
+		return;
+
+	event_add_event(master, apiserver_dump_run, apiserv, 0, &dump->t_run);
 }
 
 int ospf_apiserver_handle_sync_lsdb(struct ospf_apiserver *apiserv,
@@ -1245,10 +1390,8 @@ int ospf_apiserver_handle_sync_lsdb(struct ospf_apiserver *apiserv,
 	uint32_t seqnum;
 	int rc = 0;
 	struct msg_sync_lsdb *smsg;
-	struct ospf_apiserver_param_t {
-		struct ospf_apiserver *apiserv;
-		struct lsa_filter_type *filter;
-	} param;
+	struct lsa_filter_type *filter;
+	struct ospf_apiserver_dump *dump;
 	uint16_t mask;
 	struct route_node *rn;
 	struct ospf_lsa *lsa;
@@ -1261,14 +1404,17 @@ int ospf_apiserver_handle_sync_lsdb(struct ospf_apiserver *apiserv,
 	seqnum = msg_get_seq(msg);
 	/* Set sync msg. */
 	smsg = (struct msg_sync_lsdb *)STREAM_DATA(msg->s);
-
-	/* Set parameter struct. */
-	param.apiserv = apiserv;
-	param.filter = &smsg->filter;
+	filter = &smsg->filter;
 
 	/* Remember mask. */
 	mask = ntohs(smsg->filter.typemask);
 
+	/* A new request replaces a dump still in progress */
+	apiserver_dump_free(apiserv);
+	dump = XCALLOC(MTYPE_APISERVER_DUMP, sizeof(*dump));
+	dump->seqnum = seqnum;
+	apiserv->dump = dump;
+
 	/* Iterate over all areas. */
 	for (ALL_LIST_ELEMENTS(ospf->areas, node, nnode, area)) {
 		int i;
@@ -1295,28 +1441,22 @@ int ospf_apiserver_handle_sync_lsdb(struct ospf_apiserver *apiserv,
 			/* Check msg type. */
 			if (mask & Power2[OSPF_ROUTER_LSA])
 				LSDB_LOOP (ROUTER_LSDB(area), rn, lsa)
-					apiserver_sync_callback(
-						lsa, (void *)&param, seqnum);
+					apiserver_dump_add(dump, lsa, filter);
 			if (mask & Power2[OSPF_NETWORK_LSA])
 				LSDB_LOOP (NETWORK_LSDB(area), rn, lsa)
-					apiserver_sync_callback(
-						lsa, (void *)&param, seqnum);
+					apiserver_dump_add(dump, lsa, filter);
 			if (mask & Power2[OSPF_SUMMARY_LSA])
 				LSDB_LOOP (SUMMARY_LSDB(area), rn, lsa)
-					apiserver_sync_callback(
-						lsa, (void *)&param, seqnum);
+					apiserver_dump_add(dump, lsa, filter);
 			if (mask & Power2[OSPF_ASBR_SUMMARY_LSA])
 				LSDB_LOOP (ASBR_SUMMARY_LSDB(area), rn, lsa)
-					apiserver_sync_callback(
-						lsa, (void *)&param, seqnum);
+					apiserver_dump_add(dump, lsa, filter);
 			if (mask & Power2[OSPF_OPAQUE_LINK_LSA])
 				LSDB_LOOP (OPAQUE_LINK_LSDB(area), rn, lsa)
-					apiserver_sync_callback(
-						lsa, (void *)&param, seqnum);
+					apiserver_dump_add(dump, lsa, filter);
 			if (mask & Power2[OSPF_OPAQUE_AREA_LSA])
 				LSDB_LOOP (OPAQUE_AREA_LSDB(area), rn, lsa)
-					apiserver_sync_callback(
-						lsa, (void *)&param, seqnum);
+					apiserver_dump_add(dump, lsa, filter);
 		}
 	}
 
@@ -1324,18 +1464,28 @@ int ospf_apiserver_handle_sync_lsdb(struct ospf_apiserver *apiserv,
 	if (ospf->lsdb) {
 		if (mask & Power2[OSPF_AS_EXTERNAL_LSA])
 			LSDB_LOOP (EXTERNAL_LSDB(ospf), rn, lsa)
-				apiserver_sync_callback(lsa, (void *)&param,
-							seqnum);
+				apiserver_dump_add(dump, lsa, filter);
 	}
 
 	/* For AS-external opaque LSAs */
 	if (ospf->lsdb) {
 		if (mask & Power2[OSPF_OPAQUE_AS_LSA])
 			LSDB_LOOP (OPAQUE_AS_LSDB(ospf), rn, lsa)
-				apiserver_sync_callback(lsa, (void *)&param,
-							seqnum);
+				apiserver_dump_add(dump, lsa, filter);
 	}
 
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug("API: LSDB dump to %pI4/%u, %zu LSAs",
+			   &apiserv->peer_async.sin_addr,
+			   ntohs(apiserv->peer_async.sin_port), dump->count);
+
+	/*
+	 * Reply right away, the LSAs arrive on the async connection.  A
+	 * client blocked on the reply would otherwise not be reading them,
+	 * and the dump would never get past the flow control.
+	 */
+	event_add_event(master, apiserver_dump_run, apiserv, 0, &dump->t_run);
+
 	/* Send a reply back to client with return code */
 	rc = ospf_apiserver_send_reply(apiserv, seqnum, rc);
 	return rc;
@@ -54,6 +54,9 @@ struct ospf_apiserver {
 #endif /* USE_ASYNC_READ */
 	struct event *t_sync_write;
 	struct event *t_async_write;
+
+	/* LSDB dump in progress, if any */
+	struct ospf_apiserver_dump *dump;
 };
 
 enum ospf_apiserver_event {
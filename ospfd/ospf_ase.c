@@ -549,14 +549,186 @@ static int ospf_ase_compare_tables(struct ospf *ospf,
 	return 0;
 }
 
-static void ospf_ase_calculate_timer(struct event *t)
+static void ospf_ase_calculate_full(struct ospf *ospf)
 {
-	struct ospf *ospf;
 	struct ospf_lsa *lsa;
 	struct route_node *rn;
 	struct listnode *node;
 	struct ospf_area *area;
+
+	/* Calculate external route for each AS-external-LSA */
+	LSDB_LOOP (EXTERNAL_LSDB(ospf), rn, lsa)
+		ospf_ase_calculate_route(ospf, lsa);
+
+	/*  This version simple adds to the table all NSSA areas  */
+	if (ospf->anyNSSA)
+		for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+			if (IS_DEBUG_OSPF_NSSA)
+				zlog_debug("%s: looking at area %pI4",
+					   __func__, &area->area_id);
+
+			if (area->external_routing == OSPF_AREA_NSSA)
+				LSDB_LOOP (NSSA_LSDB(area), rn, lsa)
+					ospf_ase_calculate_route(ospf, lsa);
+		}
+	/* kevinm: And add the NSSA routes in ospf_top */
+	LSDB_LOOP (NSSA_LSDB(ospf), rn, lsa)
+		ospf_ase_calculate_route(ospf, lsa);
+
+	/* Compare old and new external routing table and install the
+	   difference info zebra/kernel */
+	ospf_ase_compare_tables(ospf, ospf->new_external_route,
+				ospf->old_external_route);
+
+	/* Delete old external routing table */
+	ospf_route_table_free(ospf->old_external_route);
+	ospf->old_external_route = ospf->new_external_route;
+	ospf->new_external_route = route_table_init();
+}
+
+/* Does the route calculated from this LSA depend on a changed route? */
+static bool ospf_ase_lsa_affected(struct ospf *ospf, struct ospf_lsa *lsa)
+{
+	struct as_external_lsa *al = (struct as_external_lsa *)lsa->data;
+	struct prefix_ipv4 p = {
+		.family = AF_INET,
+		.prefixlen = IPV4_MAX_BITLEN,
+	};
+	struct route_node *rn;
+
+	/* (3) the route to the ASBR */
+	if (ospf->ase_changed_asbrs) {
+		p.prefix = lsa->data->adv_router;
+		rn = route_node_lookup(ospf->ase_changed_asbrs,
+				       (struct prefix *)&p);
+		if (rn) {
+			route_unlock_node(rn);
+			return true;
+		}
+	}
+
+	/* (3) the best match for the forwarding address */
+	if (al->e[0].fwd_addr.s_addr != INADDR_ANY &&
+	    ospf->ase_changed_routes) {
+		p.prefix = al->e[0].fwd_addr;
+		rn = route_node_match(ospf->ase_changed_routes,
+				      (struct prefix *)&p);
+		if (rn) {
+			route_unlock_node(rn);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Recalculate the external route to a destination from all of its LSAs,
+ * and install the difference.
+ */
+static void ospf_ase_update_prefix(struct ospf *ospf, struct prefix_ipv4 *p,
+				   struct list *lsas)
+{
+	struct listnode *node;
+	struct ospf_lsa *lsa;
+	struct route_node *rn, *rn2;
+	struct route_table *tmp_old;
+
+	for (ALL_LIST_ELEMENTS_RO(lsas, node, lsa))
+		ospf_ase_calculate_route(ospf, lsa);
+
+	/* prepare temporary old routing table for compare */
+	tmp_old = route_table_init();
+	rn = route_node_lookup(ospf->old_external_route, (struct prefix *)p);
+	if (rn && rn->info) {
+		rn2 = route_node_get(tmp_old, (struct prefix *)p);
+		rn2->info = rn->info;
+		route_unlock_node(rn);
+	}
+
+	/* install changes to zebra */
+	ospf_ase_compare_tables(ospf, ospf->new_external_route, tmp_old);
+
+	/* update ospf->old_external_route table */
+	if (rn && rn->info)
+		ospf_route_free((struct ospf_route *)rn->info);
+
+	rn2 = route_node_lookup(ospf->new_external_route, (struct prefix *)p);
+	/* if new route exists, install it to ospf->old_external_route */
+	if (rn2 && rn2->info) {
+		if (!rn)
+			rn = route_node_get(ospf->old_external_route,
+					    (struct prefix *)p);
+		rn->info = rn2->info;
+	} else {
+		/* remove route node from ospf->old_external_route */
+		if (rn) {
+			rn->info = NULL;
+			route_unlock_node(rn);
+		}
+	}
+
+	if (rn2) {
+		/* rn2->info is stored in route node of ospf->old_external_route
+		 */
+		rn2->info = NULL;
+		route_unlock_node(rn2);
+		route_unlock_node(rn2);
+	}
+
+	route_table_finish(tmp_old);
+}
+
+/*
+ * Incremental calculation: only revisit the destinations for which an
+ * intra/inter-area route changed, or with an LSA whose ASBR or forwarding
+ * address route changed since the last calculation.
+ */
+static unsigned int ospf_ase_calculate_incremental(struct ospf *ospf)
+{
+	struct route_node *rn, *changed;
+	struct listnode *node;
+	struct ospf_lsa *lsa;
+	struct list *lsas;
+	unsigned int count = 0;
+	bool affected;
+
+	for (rn = route_top(ospf->external_lsas); rn; rn = route_next(rn)) {
+		if ((lsas = rn->info) == NULL || list_isempty(lsas))
+			continue;
+
+		affected = false;
+		if (ospf->ase_changed_routes) {
+			changed = route_node_lookup(ospf->ase_changed_routes,
+						    &rn->p);
+			if (changed) {
+				route_unlock_node(changed);
+				affected = true;
+			}
+		}
+		for (ALL_LIST_ELEMENTS_RO(lsas, node, lsa)) {
+			if (affected)
+				break;
+			affected = ospf_ase_lsa_affected(ospf, lsa);
+		}
+
+		if (!affected)
+			continue;
+
+		ospf_ase_update_prefix(ospf, (struct prefix_ipv4 *)&rn->p,
+				       lsas);
+		count++;
+	}
+
+	return count;
+}
+
+static void ospf_ase_calculate_timer(struct event *t)
+{
+	struct ospf *ospf;
 	struct timeval start_time, stop_time;
+	unsigned int count = 0;
+	bool full;
 
 	ospf = EVENT_ARG(t);
 	ospf->t_ase_calc = NULL;
@@ -566,45 +738,31 @@ static void ospf_ase_calculate_timer(struct event *t)
 
 		monotime(&start_time);
 
-		/* Calculate external route for each AS-external-LSA */
-		LSDB_LOOP (EXTERNAL_LSDB(ospf), rn, lsa)
-			ospf_ase_calculate_route(ospf, lsa);
-
-		/*  This version simple adds to the table all NSSA areas  */
-		if (ospf->anyNSSA)
-			for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
-				if (IS_DEBUG_OSPF_NSSA)
-					zlog_debug("%s: looking at area %pI4",
-						   __func__, &area->area_id);
-
-				if (area->external_routing == OSPF_AREA_NSSA)
-					LSDB_LOOP (NSSA_LSDB(area), rn, lsa)
-						ospf_ase_calculate_route(ospf,
-									 lsa);
-			}
-		/* kevinm: And add the NSSA routes in ospf_top */
-		LSDB_LOOP (NSSA_LSDB(ospf), rn, lsa)
-			ospf_ase_calculate_route(ospf, lsa);
-
-		/* Compare old and new external routing table and install the
-		   difference info zebra/kernel */
-		ospf_ase_compare_tables(ospf, ospf->new_external_route,
-					ospf->old_external_route);
-
-		/* Delete old external routing table */
-		ospf_route_table_free(ospf->old_external_route);
-		ospf->old_external_route = ospf->new_external_route;
-		ospf->new_external_route = route_table_init();
+		full = ospf->ase_full_required;
+		if (full) {
+			ospf_ase_calculate_full(ospf);
+			ospf->ase_full_required = false;
+			ospf->ase_full_runs++;
+		} else {
+			count = ospf_ase_calculate_incremental(ospf);
+			ospf->ase_incremental_runs++;
+		}
+		ospf_ase_changes_free(ospf);
 
 		monotime(&stop_time);
 
-		if (IS_DEBUG_OSPF_EVENT)
+		if (IS_DEBUG_OSPF_EVENT) {
 			zlog_info(
 				"SPF Processing Time(usecs): External Routes: %lld",
 				(stop_time.tv_sec - start_time.tv_sec)
 						* 1000000LL
 					+ (stop_time.tv_usec
 					   - start_time.tv_usec));
+			if (!full)
+				zlog_info(
+					"    (incremental, %u destinations revisited)",
+					count);
+		}
 	}
 
 	/*
@@ -625,6 +783,142 @@ void ospf_ase_calculate_schedule(struct ospf *ospf)
 	ospf->ase_calc = 1;
 }
 
+/* Marks the nodes of the tables of changed routes. */
+static char ospf_ase_changed_mark;
+
+static void ospf_ase_mark_changed(struct route_table **table,
+				  const struct prefix *p)
+{
+	struct route_node *rn;
+
+	if (!*table)
+		*table = route_table_init();
+
+	rn = route_node_get(*table, p);
+	if (rn->info)
+		route_unlock_node(rn);
+	else
+		rn->info = &ospf_ase_changed_mark;
+}
+
+static void ospf_ase_changed_table_free(struct route_table **table)
+{
+	struct route_node *rn;
+
+	if (!*table)
+		return;
+
+	for (rn = route_top(*table); rn; rn = route_next(rn))
+		if (rn->info) {
+			rn->info = NULL;
+			route_unlock_node(rn);
+		}
+
+	route_table_finish(*table);
+	*table = NULL;
+}
+
+void ospf_ase_changes_free(struct ospf *ospf)
+{
+	ospf_ase_changed_table_free(&ospf->ase_changed_routes);
+	ospf_ase_changed_table_free(&ospf->ase_changed_asbrs);
+}
+
+/* Compare the parts of ASBR routes that external routes depend on. */
+static bool ospf_ase_asbr_route_same(struct ospf_route *or1,
+				     struct ospf_route *or2)
+{
+	struct listnode *n1, *n2;
+	struct ospf_path *op1, *op2;
+
+	if (!or1 || !or2)
+		return or1 == or2;
+
+	if (or1->cost != or2->cost || or1->path_type != or2->path_type ||
+	    or1->u.std.flags != or2->u.std.flags ||
+	    or1->u.std.external_routing != or2->u.std.external_routing ||
+	    !IPV4_ADDR_SAME(&or1->u.std.area_id, &or2->u.std.area_id))
+		return false;
+
+	if (listcount(or1->paths) != listcount(or2->paths))
+		return false;
+
+	for (n1 = listhead(or1->paths), n2 = listhead(or2->paths); n1 && n2;
+	     n1 = listnextnode_unchecked(n1), n2 = listnextnode_unchecked(n2)) {
+		op1 = listgetdata(n1);
+		op2 = listgetdata(n2);
+
+		if (!IPV4_ADDR_SAME(&op1->nexthop, &op2->nexthop) ||
+		    op1->ifindex != op2->ifindex)
+			return false;
+	}
+
+	return true;
+}
+
+static void ospf_ase_asbrs_changed(struct ospf *ospf,
+				   struct route_table *rtrs,
+				   struct route_table *other)
+{
+	struct route_node *rn;
+
+	for (rn = route_top(rtrs); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		if (!ospf_ase_asbr_route_same(
+			    ospf_find_asbr_route(ospf, rtrs,
+						 (struct prefix_ipv4 *)&rn->p),
+			    ospf_find_asbr_route(ospf, other,
+						 (struct prefix_ipv4 *)&rn->p)))
+			ospf_ase_mark_changed(&ospf->ase_changed_asbrs,
+					      &rn->p);
+	}
+}
+
+static void ospf_ase_routes_changed(struct ospf *ospf,
+				    struct route_table *rt,
+				    struct route_table *other)
+{
+	struct route_node *rn;
+
+	for (rn = route_top(rt); rn; rn = route_next(rn))
+		if (rn->info &&
+		    !ospf_route_match_same(other, (struct prefix_ipv4 *)&rn->p,
+					   rn->info))
+			ospf_ase_mark_changed(&ospf->ase_changed_routes,
+					      &rn->p);
+}
+
+/*
+ * Called after a SPF run, before the new routing tables replace
+ * ospf->new_table and ospf->new_rtrs: schedule an ASE calculation, and note
+ * which routes changed so that the next one can be done incrementally. Any
+ * change that isn't visible in the routing tables (e.g. configuration)
+ * requires a full calculation.
+ */
+void ospf_ase_calculate_schedule_changes(struct ospf *ospf,
+					 struct route_table *new_table,
+					 struct route_table *new_rtrs,
+					 bool full)
+{
+	ospf_ase_calculate_schedule(ospf);
+
+	if (full || !ospf->new_table || !ospf->new_rtrs)
+		ospf->ase_full_required = true;
+
+	if (ospf->ase_full_required) {
+		ospf_ase_changes_free(ospf);
+		return;
+	}
+
+	ospf_ase_routes_changed(ospf, ospf->new_table, new_table);
+	ospf_ase_routes_changed(ospf, new_table, ospf->new_table);
+
+	ospf_ase_asbrs_changed(ospf, ospf->new_rtrs, new_rtrs);
+	ospf_ase_asbrs_changed(ospf, new_rtrs, ospf->new_rtrs);
+}
+
 void ospf_ase_calculate_timer_add(struct ospf *ospf)
 {
 	if (ospf == NULL)
@@ -706,10 +1000,8 @@ void ospf_ase_external_lsas_finish(struct route_table *rt)
 void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
 {
 	struct list *lsas;
-	struct listnode *node;
-	struct route_node *rn, *rn2;
+	struct route_node *rn;
 	struct prefix_ipv4 p;
-	struct route_table *tmp_old;
 	struct as_external_lsa *al;
 
 	al = (struct as_external_lsa *)lsa->data;
@@ -740,47 +1032,5 @@ void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
 	lsas = rn->info;
 	route_unlock_node(rn);
 
-	for (ALL_LIST_ELEMENTS_RO(lsas, node, lsa))
-		ospf_ase_calculate_route(ospf, lsa);
-
-	/* prepare temporary old routing table for compare */
-	tmp_old = route_table_init();
-	rn = route_node_lookup(ospf->old_external_route, (struct prefix *)&p);
-	if (rn && rn->info) {
-		rn2 = route_node_get(tmp_old, (struct prefix *)&p);
-		rn2->info = rn->info;
-		route_unlock_node(rn);
-	}
-
-	/* install changes to zebra */
-	ospf_ase_compare_tables(ospf, ospf->new_external_route, tmp_old);
-
-	/* update ospf->old_external_route table */
-	if (rn && rn->info)
-		ospf_route_free((struct ospf_route *)rn->info);
-
-	rn2 = route_node_lookup(ospf->new_external_route, (struct prefix *)&p);
-	/* if new route exists, install it to ospf->old_external_route */
-	if (rn2 && rn2->info) {
-		if (!rn)
-			rn = route_node_get(ospf->old_external_route,
-					    (struct prefix *)&p);
-		rn->info = rn2->info;
-	} else {
-		/* remove route node from ospf->old_external_route */
-		if (rn) {
-			rn->info = NULL;
-			route_unlock_node(rn);
-		}
-	}
-
-	if (rn2) {
-		/* rn2->info is stored in route node of ospf->old_external_route
-		 */
-		rn2->info = NULL;
-		route_unlock_node(rn2);
-		route_unlock_node(rn2);
-	}
-
-	route_table_finish(tmp_old);
+	ospf_ase_update_prefix(ospf, &p, lsas);
 }
@@ -15,6 +15,11 @@ ospf_find_asbr_route_through_area(struct route_table *, struct prefix_ipv4 *,
 
 extern int ospf_ase_calculate_route(struct ospf *, struct ospf_lsa *);
 extern void ospf_ase_calculate_schedule(struct ospf *);
+extern void ospf_ase_calculate_schedule_changes(struct ospf *ospf,
+						struct route_table *new_table,
+						struct route_table *new_rtrs,
+						bool full);
+extern void ospf_ase_changes_free(struct ospf *ospf);
 extern void ospf_ase_calculate_timer_add(struct ospf *);
 
 extern void ospf_ase_external_lsas_finish(struct route_table *);
@@ -504,6 +504,7 @@ static void ospf_if_reset_stats(struct ospf_interface *oi)
 	oi->ls_req_in = oi->ls_req_out = 0;
 	oi->ls_upd_in = oi->ls_upd_out = 0;
 	oi->ls_ack_in = oi->ls_ack_out = 0;
+	oi->ls_upd_lsa_out = oi->ls_upd_coalesced = oi->ls_rxmt_lsa_out = 0;
 }
 
 void ospf_if_stream_unset(struct ospf_interface *oi)
@@ -216,6 +216,8 @@ struct ospf_interface {
 	struct list *opaque_lsa_self;      /* Type-9 Opaque-LSAs */
 
 	struct route_table *ls_upd_queue;
+	/* LSAs were added to ls_upd_queue since it was last coalesced */
+	bool ls_upd_coalesce;
 
 	struct list *ls_ack; /* Link State Acknowledgment list. */
 
@@ -248,6 +250,9 @@ struct ospf_interface {
 	uint32_t ls_upd_out;   /* LS update message output count. */
 	uint32_t ls_ack_in;    /* LS Ack message input count. */
 	uint32_t ls_ack_out;   /* LS Ack message output count. */
+	uint32_t ls_upd_lsa_out;   /* LSAs sent in LS update messages. */
+	uint32_t ls_upd_coalesced; /* superseded LSAs dropped before sending. */
+	uint32_t ls_rxmt_lsa_out;  /* LSAs queued for retransmission. */
 	uint32_t discarded;    /* discarded input count by error. */
 	uint32_t state_change; /* Number of status change. */
 
@@ -16,6 +16,7 @@
 #include "log.h"
 #include "frrevent.h"
 #include "hash.h"
+#include "jhash.h"
 #include "sockunion.h" /* for inet_aton() */
 #include "checksum.h"
 #include "network.h"
@@ -178,13 +179,25 @@ int ospf_lsa_checksum_valid(struct lsa_header *lsa)
 }
 
 
-/* Create OSPF LSA. */
-struct ospf_lsa *ospf_lsa_new(void)
+/*
+ * LSA data allocated together with the LSA follows it directly, this saves
+ * an allocation and keeps the header next to the LSA in memory.
+ */
+#define OSPF_LSA_DATA_INLINE(L) ((void *)(L)->data == (void *)((L) + 1))
+
+static struct ospf_lsa *ospf_lsa_alloc(size_t size)
 {
 	struct ospf_lsa *new;
 
-	new = XCALLOC(MTYPE_OSPF_LSA, sizeof(struct ospf_lsa));
+	new = XCALLOC(MTYPE_OSPF_LSA, sizeof(struct ospf_lsa) + size);
+	if (size)
+		new->data = (struct lsa_header *)(new + 1);
 
+	return new;
+}
+
+static void ospf_lsa_init(struct ospf_lsa *new)
+{
 	new->flags = 0;
 	new->lock = 1;
 	new->retransmit_counter = 0;
@@ -194,6 +207,15 @@ struct ospf_lsa *ospf_lsa_new(void)
 	new->vrf_id = VRF_DEFAULT;
 	new->to_be_acknowledged = 0;
 	new->opaque_zero_len_delete = 0;
+}
+
+/* Create OSPF LSA. */
+struct ospf_lsa *ospf_lsa_new(void)
+{
+	struct ospf_lsa *new;
+
+	new = ospf_lsa_alloc(0);
+	ospf_lsa_init(new);
 
 	return new;
 }
@@ -202,8 +224,8 @@ struct ospf_lsa *ospf_lsa_new_and_data(size_t size)
 {
 	struct ospf_lsa *new;
 
-	new = ospf_lsa_new();
-	new->data = ospf_lsa_data_new(size);
+	new = ospf_lsa_alloc(size);
+	ospf_lsa_init(new);
 	new->size = size;
 
 	return new;
@@ -217,13 +239,14 @@ struct ospf_lsa *ospf_lsa_dup(struct ospf_lsa *lsa)
 	if (lsa == NULL)
 		return NULL;
 
-	new = XCALLOC(MTYPE_OSPF_LSA, sizeof(struct ospf_lsa));
+	new = ospf_lsa_alloc(ntohs(lsa->data->length));
 
 	memcpy(new, lsa, sizeof(struct ospf_lsa));
 	UNSET_FLAG(new->flags, OSPF_LSA_DISCARD);
 	new->lock = 1;
 	new->retransmit_counter = 0;
-	new->data = ospf_lsa_data_dup(lsa->data);
+	new->data = (struct lsa_header *)(new + 1);
+	memcpy(new->data, lsa->data, ntohs(lsa->data->length));
 
 	/* kevinm: Clear the refresh_list, otherwise there are going
 	   to be problems when we try to remove the LSA from the
@@ -247,7 +270,7 @@ void ospf_lsa_free(struct ospf_lsa *lsa)
 		zlog_debug("LSA: freed %p", (void *)lsa);
 
 	/* Delete LSA data. */
-	if (lsa->data != NULL)
+	if (lsa->data != NULL && !OSPF_LSA_DATA_INLINE(lsa))
 		ospf_lsa_data_free(lsa->data);
 
 	assert(lsa->refresh_list < 0);
@@ -2266,6 +2289,144 @@ struct ospf_lsa *ospf_external_lsa_originate(struct ospf *ospf,
 	return new;
 }
 
+/*
+ * AS-external-LSAs for routes zebra redistributes are not originated while
+ * the routes are read.  The route is queued, and the queue is worked off
+ * from an event, OSPF_EXT_BATCH_MAX routes per run: the route is looked up
+ * again, checked against the redistribution policy and its LSA built,
+ * installed and flooded.  So a route going away or changing again while
+ * queued costs nothing, the LSAs of a run go out packed into the same LS
+ * Updates, and reading from zebra isn't held up by flooding.
+ *
+ * The refresh of a large batch is spread over more of the refresh interval
+ * than the usual jitter, so that it doesn't come back as one burst every
+ * 30 minutes.  That is only a wider choice of refresher slot.
+ */
+#define OSPF_EXT_BATCH_MAX 1000
+/* refreshes per second a batch is spread to, at most */
+#define OSPF_EXT_REFRESH_RATE 100
+
+struct ospf_ext_pending {
+	struct ospf_ext_pending_item hitem;
+	struct ospf_ext_order_item oitem;
+
+	uint8_t type;
+	unsigned short instance;
+	struct prefix_ipv4 p;
+};
+
+static int ospf_ext_pending_cmp(const struct ospf_ext_pending *a,
+				const struct ospf_ext_pending *b)
+{
+	if (a->type != b->type)
+		return numcmp(a->type, b->type);
+	if (a->instance != b->instance)
+		return numcmp(a->instance, b->instance);
+	return prefix_cmp(&a->p, &b->p);
+}
+
+static uint32_t ospf_ext_pending_hash(const struct ospf_ext_pending *a)
+{
+	return jhash_3words(a->p.prefix.s_addr, a->p.prefixlen,
+			    (a->type << 16) | a->instance, 0xd1e5a7e5);
+}
+
+DECLARE_HASH(ospf_ext_pending, struct ospf_ext_pending, hitem,
+	     ospf_ext_pending_cmp, ospf_ext_pending_hash);
+DECLARE_DLIST(ospf_ext_order, struct ospf_ext_pending, oitem);
+
+void ospf_external_lsa_batch_init(struct ospf *ospf)
+{
+	ospf_ext_pending_init(&ospf->ext_pending);
+	ospf_ext_order_init(&ospf->ext_order);
+}
+
+void ospf_external_lsa_batch_finish(struct ospf *ospf)
+{
+	struct ospf_ext_pending *pend;
+
+	EVENT_OFF(ospf->t_external_lsa_batch);
+
+	while ((pend = ospf_ext_order_pop(&ospf->ext_order))) {
+		ospf_ext_pending_del(&ospf->ext_pending, pend);
+		XFREE(MTYPE_OSPF_EXTERNAL_PENDING, pend);
+	}
+	ospf_ext_pending_fini(&ospf->ext_pending);
+	ospf_ext_order_fini(&ospf->ext_order);
+}
+
+size_t ospf_external_lsa_pending(struct ospf *ospf)
+{
+	return ospf_ext_order_count(&ospf->ext_order);
+}
+
+static void ospf_external_lsa_batch(struct event *thread)
+{
+	struct ospf *ospf = EVENT_ARG(thread);
+	struct ospf_ext_pending *pend;
+	struct external_info *ei;
+	unsigned int done = 0;
+	size_t spread;
+
+	spread = ospf_ext_order_count(&ospf->ext_order) / OSPF_EXT_REFRESH_RATE;
+	ospf->lsa_refresh_spread = MIN(spread, UINT16_MAX);
+
+	while (done < OSPF_EXT_BATCH_MAX &&
+	       (pend = ospf_ext_order_pop(&ospf->ext_order))) {
+		ospf_ext_pending_del(&ospf->ext_pending, pend);
+		ei = ospf_external_info_lookup(ospf, pend->type,
+					       pend->instance, &pend->p);
+		XFREE(MTYPE_OSPF_EXTERNAL_PENDING, pend);
+
+		/*
+		 * Gone, or taken care of by an aggregate or a refresh since
+		 * it was queued.
+		 */
+		if (!ei || ospf_external_aggr_match(ospf, &ei->p) ||
+		    ospf_external_info_find_lsa(ospf, &ei->p))
+			continue;
+
+		if (!ospf_redistribute_check(ospf, ei, NULL))
+			continue;
+
+		ospf_external_lsa_originate(ospf, ei);
+		done++;
+	}
+
+	ospf->lsa_refresh_spread = 0;
+
+	if (IS_DEBUG_OSPF(lsa, LSA_GENERATE))
+		zlog_debug("LSA[Type5]: originated %u AS-external-LSAs, %zu queued",
+			   done, ospf_ext_order_count(&ospf->ext_order));
+
+	if (ospf_ext_order_count(&ospf->ext_order))
+		event_add_event(master, ospf_external_lsa_batch, ospf, 0,
+				&ospf->t_external_lsa_batch);
+}
+
+/* Queue the origination of the AS-external-LSA for a redistributed route. */
+void ospf_external_lsa_originate_queue(struct ospf *ospf,
+				       struct external_info *ei)
+{
+	struct ospf_ext_pending *pend, ref = {};
+
+	ref.type = ei->type;
+	ref.instance = ei->instance;
+	ref.p = ei->p;
+	if (ospf_ext_pending_find(&ospf->ext_pending, &ref))
+		return;
+
+	pend = XCALLOC(MTYPE_OSPF_EXTERNAL_PENDING, sizeof(*pend));
+	pend->type = ref.type;
+	pend->instance = ref.instance;
+	pend->p = ref.p;
+	ospf_ext_pending_add(&ospf->ext_pending, pend);
+	ospf_ext_order_add_tail(&ospf->ext_order, pend);
+
+	event_add_event(master, ospf_external_lsa_batch, ospf, 0,
+			&ospf->t_external_lsa_batch);
+}
+
 static struct external_info *ospf_default_external_info(struct ospf *ospf)
 {
 	int type;
@@ -2931,6 +3092,10 @@ struct ospf_lsa *ospf_lsa_install(struct ospf *ospf, struct ospf_interface *oi,
 		}
 	}
 
+	/* Let SPF know whether the topology may have changed. */
+	if (rt_recalc)
+		ospf_spf_lsa_changed(ospf, old, lsa);
+
 	/* discard old LSA from LSDB */
 	if (old != NULL)
 		ospf_discard_from_db(ospf, lsdb, lsa);
@@ -3275,6 +3440,7 @@ static int ospf_lsa_maxage_walker_remover(struct ospf *ospf,
 				ospf_ase_incremental_update(ospf, lsa);
 				break;
 			default:
+				ospf_spf_lsa_changed(ospf, lsa, NULL);
 				ospf_spf_calculate_schedule(ospf,
 							    SPF_FLAG_MAXAGE);
 				break;
@@ -3981,6 +4147,9 @@ void ospf_refresher_register_lsa(struct ospf *ospf, struct ospf_lsa *lsa)
 		 * 1680s
 		 * and 1740s.
 		 */
+		/* LSAs originated in bulk get a wider window */
+		min_delay -= MIN(ospf->lsa_refresh_spread, min_delay / 2);
+
 		delay = (frr_weak_random() % (max_delay - min_delay))
 			+ min_delay;
 
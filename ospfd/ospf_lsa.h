@@ -276,6 +276,11 @@ extern void ospf_external_lsa_flush(struct ospf *, uint8_t,
 
 extern struct in_addr ospf_get_ip_from_ifp(struct ospf_interface *);
 
+extern void ospf_external_lsa_batch_init(struct ospf *ospf);
+extern void ospf_external_lsa_batch_finish(struct ospf *ospf);
+extern void ospf_external_lsa_originate_queue(struct ospf *ospf,
+					      struct external_info *ei);
+extern size_t ospf_external_lsa_pending(struct ospf *ospf);
 extern struct ospf_lsa *ospf_external_lsa_originate(struct ospf *,
 						    struct external_info *);
 extern void ospf_external_lsa_rid_change(struct ospf *ospf);
@@ -10,12 +10,63 @@
 #include "table.h"
 #include "memory.h"
 #include "log.h"
+#include "jhash.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_asbr.h"
 #include "ospfd/ospf_lsa.h"
 #include "ospfd/ospf_lsdb.h"
 
+DEFINE_MTYPE_STATIC(OSPFD, OSPF_LSDB_ENTRY, "OSPF LSDB index entry");
+
+struct ospf_lsdb_entry {
+	struct ospf_lsdb_index_item item;
+	struct ospf_lsa *lsa;
+};
+
+static int ospf_lsdb_entry_cmp(const struct ospf_lsdb_entry *e1,
+			       const struct ospf_lsdb_entry *e2)
+{
+	if (e1->lsa->data->id.s_addr != e2->lsa->data->id.s_addr)
+		return e1->lsa->data->id.s_addr < e2->lsa->data->id.s_addr
+			       ? -1
+			       : 1;
+	if (e1->lsa->data->adv_router.s_addr !=
+	    e2->lsa->data->adv_router.s_addr)
+		return e1->lsa->data->adv_router.s_addr <
+				       e2->lsa->data->adv_router.s_addr
+			       ? -1
+			       : 1;
+	return 0;
+}
+
+static uint32_t ospf_lsdb_entry_hash(const struct ospf_lsdb_entry *e)
+{
+	return jhash_2words(e->lsa->data->id.s_addr,
+			    e->lsa->data->adv_router.s_addr, 0);
+}
+
+DECLARE_HASH(ospf_lsdb_index, struct ospf_lsdb_entry, item,
+	     ospf_lsdb_entry_cmp, ospf_lsdb_entry_hash);
+
+static struct ospf_lsdb_entry *
+ospf_lsdb_entry_lookup(struct ospf_lsdb *lsdb, uint8_t type, struct in_addr id,
+		       struct in_addr adv_router)
+{
+	struct lsa_header lsah = {
+		.id = id,
+		.adv_router = adv_router,
+	};
+	struct ospf_lsa lsa = {
+		.data = &lsah,
+	};
+	struct ospf_lsdb_entry ref = {
+		.lsa = &lsa,
+	};
+
+	return ospf_lsdb_index_find(&lsdb->type[type].index, &ref);
+}
+
 struct ospf_lsdb *ospf_lsdb_new(void)
 {
 	struct ospf_lsdb *new;
@@ -30,8 +81,10 @@ void ospf_lsdb_init(struct ospf_lsdb *lsdb)
 {
 	int i;
 
-	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
+	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++) {
 		lsdb->type[i].db = route_table_init();
+		ospf_lsdb_index_init(&lsdb->type[i].index);
+	}
 }
 
 void ospf_lsdb_free(struct ospf_lsdb *lsdb)
@@ -48,8 +101,10 @@ void ospf_lsdb_cleanup(struct ospf_lsdb *lsdb)
 
 	ospf_lsdb_delete_all(lsdb);
 
-	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
+	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++) {
 		route_table_finish(lsdb->type[i].db);
+		ospf_lsdb_index_fini(&lsdb->type[i].index);
+	}
 }
 
 void ls_prefix_set(struct prefix_ls *lp, struct ospf_lsa *lsa)
@@ -66,6 +121,7 @@ static void ospf_lsdb_delete_entry(struct ospf_lsdb *lsdb,
 				   struct route_node *rn)
 {
 	struct ospf_lsa *lsa = rn->info;
+	struct ospf_lsdb_entry *entry;
 
 	if (!lsa)
 		return;
@@ -92,6 +148,13 @@ static void ospf_lsdb_delete_entry(struct ospf_lsdb *lsdb,
 	    (lsa->area->fr_info.indication_lsa_self == lsa))
 		lsa->area->fr_info.indication_lsa_self = NULL;
 
+	entry = ospf_lsdb_entry_lookup(lsdb, lsa->data->type, lsa->data->id,
+				       lsa->data->adv_router);
+	if (entry) {
+		ospf_lsdb_index_del(&lsdb->type[lsa->data->type].index, entry);
+		XFREE(MTYPE_OSPF_LSDB_ENTRY, entry);
+	}
+
 	rn->info = NULL;
 	route_unlock_node(rn);
 #ifdef MONITOR_LSDB_CHANGE
@@ -108,6 +171,7 @@ void ospf_lsdb_add(struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 	struct route_table *table;
 	struct prefix_ls lp;
 	struct route_node *rn;
+	struct ospf_lsdb_entry *entry;
 
 	table = lsdb->type[lsa->data->type].db;
 	ls_prefix_set(&lp, lsa);
@@ -140,6 +204,10 @@ void ospf_lsdb_add(struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 #endif /* MONITOR_LSDB_CHANGE */
 	lsdb->type[lsa->data->type].checksum += ntohs(lsa->data->checksum);
 	rn->info = ospf_lsa_lock(lsa); /* lsdb */
+
+	entry = XCALLOC(MTYPE_OSPF_LSDB_ENTRY, sizeof(*entry));
+	entry->lsa = lsa;
+	ospf_lsdb_index_add(&lsdb->type[lsa->data->type].index, entry);
 }
 
 void ospf_lsdb_delete(struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
@@ -147,11 +215,19 @@ void ospf_lsdb_delete(struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 	struct route_table *table;
 	struct prefix_ls lp;
 	struct route_node *rn;
+	struct ospf_lsdb_entry *find;
 
 	if (!lsdb || !lsa)
 		return;
 
 	assert(lsa->data->type < OSPF_MAX_LSA);
+
+	/* cheap check before walking the table */
+	find = ospf_lsdb_entry_lookup(lsdb, lsa->data->type, lsa->data->id,
+				      lsa->data->adv_router);
+	if (!find || find->lsa != lsa)
+		return;
+
 	table = lsdb->type[lsa->data->type].db;
 	ls_prefix_set(&lp, lsa);
 	if ((rn = route_node_lookup(table, (struct prefix *)&lp))) {
@@ -177,46 +253,19 @@ void ospf_lsdb_delete_all(struct ospf_lsdb *lsdb)
 
 struct ospf_lsa *ospf_lsdb_lookup(struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 {
-	struct route_table *table;
-	struct prefix_ls lp;
-	struct route_node *rn;
-	struct ospf_lsa *find;
-
-	table = lsdb->type[lsa->data->type].db;
-	ls_prefix_set(&lp, lsa);
-	rn = route_node_lookup(table, (struct prefix *)&lp);
-	if (rn) {
-		find = rn->info;
-		route_unlock_node(rn);
-		return find;
-	}
-	return NULL;
+	return ospf_lsdb_lookup_by_id(lsdb, lsa->data->type, lsa->data->id,
+				      lsa->data->adv_router);
 }
 
 struct ospf_lsa *ospf_lsdb_lookup_by_id(struct ospf_lsdb *lsdb, uint8_t type,
 					struct in_addr id,
 					struct in_addr adv_router)
 {
-	struct route_table *table;
-	struct prefix_ls lp;
-	struct route_node *rn;
-	struct ospf_lsa *find;
+	struct ospf_lsdb_entry *find;
 
-	table = lsdb->type[type].db;
-
-	memset(&lp, 0, sizeof(lp));
-	lp.family = AF_UNSPEC;
-	lp.prefixlen = 64;
-	lp.id = id;
-	lp.adv_router = adv_router;
+	find = ospf_lsdb_entry_lookup(lsdb, type, id, adv_router);
 
-	rn = route_node_lookup(table, (struct prefix *)&lp);
-	if (rn) {
-		find = rn->info;
-		route_unlock_node(rn);
-		return find;
-	}
-	return NULL;
+	return find ? find->lsa : NULL;
 }
 
 struct ospf_lsa *ospf_lsdb_lookup_by_id_next(struct ospf_lsdb *lsdb,
@@ -7,6 +7,10 @@
 #ifndef _ZEBRA_OSPF_LSDB_H
 #define _ZEBRA_OSPF_LSDB_H
 
+#include "typesafe.h"
+
+PREDECL_HASH(ospf_lsdb_index);
+
 /* OSPF LSDB structure. */
 struct ospf_lsdb {
 	struct {
@@ -14,6 +18,11 @@ struct ospf_lsdb {
 		unsigned long count_self;
 		unsigned int checksum;
 		struct route_table *db;
+		/*
+		 * Index on (LS ID, advertising router) for exact lookups, db
+		 * is kept for ordered iteration.
+		 */
+		struct ospf_lsdb_index_head index;
 	} type[OSPF_MAX_LSA];
 	unsigned long total;
 #define MONITOR_LSDB_CHANGE 1 /* XXX */
@@ -43,6 +43,7 @@
 #include "ospfd/ospf_errors.h"
 #include "ospfd/ospf_ldp_sync.h"
 #include "ospfd/ospf_routemap_nb.h"
+#include "ospfd/ospf_ti_lfa.h"
 
 /* ospfd privileges */
 zebra_capabilities_t _caps_p[] = {ZCAP_NET_RAW, ZCAP_BIND, ZCAP_NET_ADMIN,
@@ -64,6 +65,7 @@ struct zebra_privs_t ospfd_privs = {
 const struct option longopts[] = {
 	{"instance", required_argument, NULL, 'n'},
 	{"apiserver", no_argument, NULL, 'a'},
+	{"ti-lfa-workers", required_argument, NULL, 'W'},
 	{0}
 };
 
@@ -137,15 +139,18 @@ FRR_DAEMON_INFO(ospfd, OSPF, .vty_port = OSPF_VTY_PORT,
 /* OSPFd main routine. */
 int main(int argc, char **argv)
 {
+	int ti_lfa_workers = 0;
+
 #ifdef SUPPORT_OSPF_API
 	/* OSPF apiserver is disabled by default. */
 	ospf_apiserver_enable = 0;
 #endif /* SUPPORT_OSPF_API */
 
 	frr_preinit(&ospfd_di, argc, argv);
-	frr_opt_add("n:a", longopts,
+	frr_opt_add("n:aW:", longopts,
 		    "  -n, --instance     Set the instance id\n"
-		    "  -a, --apiserver    Enable OSPF apiserver\n");
+		    "  -a, --apiserver    Enable OSPF apiserver\n"
+		    "  -W, --ti-lfa-workers Number of pthreads computing TI-LFA P/Q spaces\n");
 
 	while (1) {
 		int opt;
@@ -161,6 +166,17 @@ int main(int argc, char **argv)
 			if (ospf_instance < 1)
 				exit(0);
 			break;
+		case 'W':
+			ti_lfa_workers = atoi(optarg);
+			if (ti_lfa_workers < 0 ||
+			    ti_lfa_workers > (int)OSPF_TI_LFA_WORKERS_MAX) {
+				fprintf(stderr,
+					"TI-LFA workers %i out of range (0..%u)\n",
+					ti_lfa_workers,
+					OSPF_TI_LFA_WORKERS_MAX);
+				exit(1);
+			}
+			break;
 		case 0:
 			break;
 #ifdef SUPPORT_OSPF_API
@@ -217,6 +233,7 @@ int main(int argc, char **argv)
 	ospf_error_init();
 
 	frr_config_fork();
+	ospf_ti_lfa_workers_set(ti_lfa_workers);
 	frr_run(master);
 
 	/* Not reached. */
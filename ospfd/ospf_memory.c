@@ -26,7 +26,6 @@ DEFINE_MTYPE(OSPFD, OSPF_LSDB, "OSPF LSDB");
 DEFINE_MTYPE(OSPFD, OSPF_PACKET, "OSPF packet");
 DEFINE_MTYPE(OSPFD, OSPF_FIFO, "OSPF FIFO queue");
 DEFINE_MTYPE(OSPFD, OSPF_VERTEX, "OSPF vertex");
-DEFINE_MTYPE(OSPFD, OSPF_VERTEX_PARENT, "OSPF vertex parent");
 DEFINE_MTYPE(OSPFD, OSPF_NEXTHOP, "OSPF nexthop");
 DEFINE_MTYPE(OSPFD, OSPF_PATH, "OSPF path");
 DEFINE_MTYPE(OSPFD, OSPF_VL_DATA, "OSPF VL data");
@@ -45,3 +44,6 @@ DEFINE_MTYPE(OSPFD, OSPF_GR_HELPER, "OSPF Graceful Restart Helper");
 DEFINE_MTYPE(OSPFD, OSPF_EXTERNAL_RT_AGGR, "OSPF External Route Summarisation");
 DEFINE_MTYPE(OSPFD, OSPF_P_SPACE, "OSPF TI-LFA P-Space");
 DEFINE_MTYPE(OSPFD, OSPF_Q_SPACE, "OSPF TI-LFA Q-Space");
+DEFINE_MTYPE(OSPFD, OSPF_TI_LFA_WORKER, "OSPF TI-LFA worker");
+DEFINE_MTYPE(OSPFD, OSPF_TI_LFA_STATS, "OSPF TI-LFA statistics");
+DEFINE_MTYPE(OSPFD, OSPF_EXTERNAL_PENDING, "OSPF pending external LSA");
@@ -25,7 +25,6 @@ DECLARE_MTYPE(OSPF_LSDB);
 DECLARE_MTYPE(OSPF_PACKET);
 DECLARE_MTYPE(OSPF_FIFO);
 DECLARE_MTYPE(OSPF_VERTEX);
-DECLARE_MTYPE(OSPF_VERTEX_PARENT);
 DECLARE_MTYPE(OSPF_NEXTHOP);
 DECLARE_MTYPE(OSPF_PATH);
 DECLARE_MTYPE(OSPF_VL_DATA);
@@ -44,5 +43,8 @@ DECLARE_MTYPE(OSPF_GR_HELPER);
 DECLARE_MTYPE(OSPF_EXTERNAL_RT_AGGR);
 DECLARE_MTYPE(OSPF_P_SPACE);
 DECLARE_MTYPE(OSPF_Q_SPACE);
+DECLARE_MTYPE(OSPF_TI_LFA_WORKER);
+DECLARE_MTYPE(OSPF_TI_LFA_STATS);
+DECLARE_MTYPE(OSPF_EXTERNAL_PENDING);
 
 #endif /* _QUAGGA_OSPF_MEMORY_H */
@@ -23,6 +23,8 @@
 #endif
 #include "vrf.h"
 #include "lib_errors.h"
+#include "hash.h"
+#include "jhash.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_network.h"
@@ -510,9 +512,11 @@ void ospf_ls_upd_timer(struct event *thread)
 			}
 		}
 
-		if (listcount(update) > 0)
+		if (listcount(update) > 0) {
+			nbr->oi->ls_rxmt_lsa_out += listcount(update);
 			ospf_ls_upd_send(nbr, update, OSPF_SEND_PACKET_DIRECT,
 					 0);
+		}
 		list_delete(&update);
 	}
 
@@ -3630,6 +3634,7 @@ static int ospf_make_ls_upd(struct ospf_interface *oi, struct list *update,
 
 	/* Now set #LSAs. */
 	stream_putl_at(s, pp, count);
+	oi->ls_upd_lsa_out += count;
 
 	if (IS_DEBUG_OSPF_EVENT)
 		zlog_debug("%s: Stop", __func__);
@@ -4103,6 +4108,66 @@ static void ospf_ls_upd_queue_send(struct ospf_interface *oi,
 	}
 }
 
+/* LS update queue entries are keyed on the LSA identification */
+static unsigned int ospf_ls_upd_queued_key(const void *data)
+{
+	const struct ospf_lsa *lsa = listgetdata((struct listnode *)data);
+
+	return jhash_3words(lsa->data->type, lsa->data->id.s_addr,
+			    lsa->data->adv_router.s_addr, 0);
+}
+
+static bool ospf_ls_upd_queued_cmp(const void *d1, const void *d2)
+{
+	const struct ospf_lsa *lsa1 = listgetdata((struct listnode *)d1);
+	const struct ospf_lsa *lsa2 = listgetdata((struct listnode *)d2);
+
+	return lsa1->data->type == lsa2->data->type &&
+	       IPV4_ADDR_SAME(&lsa1->data->id, &lsa2->data->id) &&
+	       IPV4_ADDR_SAME(&lsa1->data->adv_router,
+			      &lsa2->data->adv_router);
+}
+
+/*
+ * When the same LSA was queued more than once for a destination (e.g. it was
+ * refreshed or received again within the coalescing window), only send the
+ * most recent instance, at the position of the first one.
+ */
+static void ospf_ls_upd_list_coalesce(struct ospf_interface *oi,
+				      struct list *update)
+{
+	struct hash *queued;
+	struct listnode *node, *nnode, *first;
+	struct ospf_lsa *lsa, *old;
+
+	if (listcount(update) < 2)
+		return;
+
+	queued = hash_create_size(listcount(update), ospf_ls_upd_queued_key,
+				  ospf_ls_upd_queued_cmp,
+				  "OSPF LS update coalescing");
+
+	for (node = listhead(update); node; node = nnode) {
+		nnode = listnextnode(node);
+		lsa = listgetdata(node);
+
+		first = hash_get(queued, node, hash_alloc_intern);
+		if (first == node)
+			continue;
+
+		old = listgetdata(first);
+		if (ospf_lsa_more_recent(old, lsa) < 0) {
+			first->data = lsa;
+			lsa = old;
+		}
+		list_delete_node(update, node);
+		ospf_lsa_unlock(&lsa); /* oi->ls_upd_queue */
+		oi->ls_upd_coalesced++;
+	}
+
+	hash_free(queued);
+}
+
 static void ospf_ls_upd_send_queue_event(struct event *thread)
 {
 	struct ospf_interface *oi = EVENT_ARG(thread);
@@ -4110,8 +4175,10 @@ static void ospf_ls_upd_send_queue_event(struct event *thread)
 	struct route_node *rnext;
 	struct list *update;
 	char again = 0;
+	bool coalesce = oi->ls_upd_coalesce;
 
 	oi->t_ls_upd_event = NULL;
+	oi->ls_upd_coalesce = false;
 
 	if (IS_DEBUG_OSPF_EVENT)
 		zlog_debug("%s start", __func__);
@@ -4124,6 +4191,9 @@ static void ospf_ls_upd_send_queue_event(struct event *thread)
 
 		update = (struct list *)rn->info;
 
+		if (coalesce)
+			ospf_ls_upd_list_coalesce(oi, update);
+
 		ospf_ls_upd_queue_send(oi, update, rn->p.u.prefix4, 0);
 
 		/* list might not be empty. */
@@ -4211,9 +4281,23 @@ void ospf_ls_upd_send(struct ospf_neighbor *nbr, struct list *update, int flag,
 			ospf_ls_upd_queue_send(oi, send_update_list,
 					       rn->p.u.prefix4, 1);
 		}
-	} else
-		event_add_event(master, ospf_ls_upd_send_queue_event, oi, 0,
-				&oi->t_ls_upd_event);
+	} else {
+		/*
+		 * Give other LSAs flooded out of this interface within the
+		 * coalescing window a chance to share the same packets. The
+		 * window starts with the first LSA queued, so flooding is never
+		 * delayed by more than that.
+		 */
+		oi->ls_upd_coalesce = true;
+		if (oi->ospf->flood_delay)
+			event_add_timer_msec(master,
+					     ospf_ls_upd_send_queue_event, oi,
+					     oi->ospf->flood_delay,
+					     &oi->t_ls_upd_event);
+		else
+			event_add_event(master, ospf_ls_upd_send_queue_event,
+					oi, 0, &oi->t_ls_upd_event);
+	}
 }
 
 static void ospf_ls_ack_send_list(struct ospf_interface *oi, struct list *ack,
@@ -132,31 +132,6 @@ void ospf_route_table_free(struct route_table *rt)
 	route_table_finish(rt);
 }
 
-/* If a prefix exists in the new routing table, then return 1,
-   otherwise return 0. Since the ZEBRA-RIB does an implicit
-   withdraw, it is not necessary to send a delete, an add later
-   will act like an implicit delete. */
-static int ospf_route_exist_new_table(struct route_table *rt,
-				      struct prefix_ipv4 *prefix)
-{
-	struct route_node *rn;
-
-	assert(rt);
-	assert(prefix);
-
-	rn = route_node_lookup(rt, (struct prefix *)prefix);
-	if (!rn) {
-		return 0;
-	}
-	route_unlock_node(rn);
-
-	if (!rn->info) {
-		return 0;
-	}
-
-	return 1;
-}
-
 static int ospf_route_backup_path_same(struct sr_nexthop_info *srni1,
 				       struct sr_nexthop_info *srni2)
 {
@@ -186,28 +161,15 @@ static int ospf_route_backup_path_same(struct sr_nexthop_info *srni1,
 	return 1;
 }
 
-/* If a prefix and a nexthop match any route in the routing table,
-   then return 1, otherwise return 0. */
-int ospf_route_match_same(struct route_table *rt, struct prefix_ipv4 *prefix,
-			  struct ospf_route *newor)
+/* If the old route has the same type, cost and nexthops as the new one,
+   return 1, otherwise return 0. */
+static int ospf_route_same(struct ospf_route *or, struct ospf_route *newor)
 {
-	struct route_node *rn;
-	struct ospf_route * or ;
 	struct ospf_path *op;
 	struct ospf_path *newop;
 	struct listnode *n1;
 	struct listnode *n2;
 
-	if (!rt || !prefix)
-		return 0;
-
-	rn = route_node_lookup(rt, (struct prefix *)prefix);
-	if (!rn || !rn->info)
-		return 0;
-
-	route_unlock_node(rn);
-
-	or = rn->info;
 	if (or->type == newor->type && or->cost == newor->cost) {
 		if (or->changed)
 			return 0;
@@ -235,13 +197,31 @@ int ospf_route_match_same(struct route_table *rt, struct prefix_ipv4 *prefix,
 								 &newop->srni))
 					return 0;
 			}
-			return 1;
-		} else if (prefix_same(&rn->p, (struct prefix *)prefix))
-			return 1;
+		}
+		return 1;
 	}
 	return 0;
 }
 
+/* If a prefix and a nexthop match any route in the routing table,
+   then return 1, otherwise return 0. */
+int ospf_route_match_same(struct route_table *rt, struct prefix_ipv4 *prefix,
+			  struct ospf_route *newor)
+{
+	struct route_node *rn;
+
+	if (!rt || !prefix)
+		return 0;
+
+	rn = route_node_lookup(rt, (struct prefix *)prefix);
+	if (!rn || !rn->info)
+		return 0;
+
+	route_unlock_node(rn);
+
+	return ospf_route_same(rn->info, newor);
+}
+
 /* delete routes generated from AS-External routes if there is a inter/intra
  * area route
  */
@@ -272,44 +252,46 @@ static void ospf_route_delete_same_ext(struct ospf *ospf,
 	}
 }
 
-/* rt: Old, cmprt: New */
-static void ospf_route_delete_uniq(struct ospf *ospf, struct route_table *rt,
-				   struct route_table *cmprt)
+static bool ospf_route_install_same(const struct route_node *old_rn,
+				    const struct route_node *new_rn, void *arg)
 {
-	struct route_node *rn;
+	return ospf_route_same(old_rn->info, new_rn->info);
+}
+
+/* Send a route that differs between the old and the new table to zebra. */
+static void ospf_route_install_diff(struct route_node *old_rn,
+				    struct route_node *new_rn, void *arg)
+{
+	struct ospf *ospf = arg;
 	struct ospf_route * or ;
 
-	for (rn = route_top(rt); rn; rn = route_next(rn))
-		if ((or = rn->info) != NULL)
-			if (or->path_type == OSPF_PATH_INTRA_AREA ||
-			    or->path_type == OSPF_PATH_INTER_AREA) {
-				if (or->type == OSPF_DESTINATION_NETWORK) {
-					if (!ospf_route_exist_new_table(
-						    cmprt,
-						    (struct prefix_ipv4 *)&rn
-							    ->p))
-						ospf_zebra_delete(
-							ospf,
-							(struct prefix_ipv4
-								 *)&rn->p,
-							or);
-				} else if (or->type == OSPF_DESTINATION_DISCARD)
-					if (!ospf_route_exist_new_table(
-						    cmprt,
-						    (struct prefix_ipv4 *)&rn
-							    ->p))
-						ospf_zebra_delete_discard(
-							ospf,
-							(struct prefix_ipv4
-								 *)&rn->p);
-			}
+	/* Deleted route. Changed routes are replaced by zebra implicitly. */
+	if (!new_rn) {
+		or = old_rn->info;
+		if (or->path_type != OSPF_PATH_INTRA_AREA &&
+		    or->path_type != OSPF_PATH_INTER_AREA)
+			return;
+
+		if (or->type == OSPF_DESTINATION_NETWORK)
+			ospf_zebra_delete(ospf,
+					  (struct prefix_ipv4 *)&old_rn->p, or);
+		else if (or->type == OSPF_DESTINATION_DISCARD)
+			ospf_zebra_delete_discard(ospf, (struct prefix_ipv4 *)
+								&old_rn->p);
+		return;
+	}
+
+	or = new_rn->info;
+	if (or->type == OSPF_DESTINATION_NETWORK)
+		ospf_zebra_add(ospf, (struct prefix_ipv4 *)&new_rn->p, or);
+	else if (or->type == OSPF_DESTINATION_DISCARD)
+		ospf_zebra_add_discard(ospf, (struct prefix_ipv4 *)&new_rn->p);
 }
 
 /* Install routes to table. */
 void ospf_route_install(struct ospf *ospf, struct route_table *rt)
 {
-	struct route_node *rn;
-	struct ospf_route * or ;
+	struct route_table_diff_stats stats;
 
 	/* rt contains new routing table, new_table contains an old one.
 	   updating pointers */
@@ -319,31 +301,18 @@ void ospf_route_install(struct ospf *ospf, struct route_table *rt)
 	ospf->old_table = ospf->new_table;
 	ospf->new_table = rt;
 
-	/* Delete old routes. */
-	if (ospf->old_table)
-		ospf_route_delete_uniq(ospf, ospf->old_table, rt);
+	/* Delete external routes superseded by inter/intra area ones. */
 	if (ospf->old_external_route)
 		ospf_route_delete_same_ext(ospf, ospf->old_external_route, rt);
 
-	/* Install new routes. */
-	for (rn = route_top(rt); rn; rn = route_next(rn))
-		if ((or = rn->info) != NULL) {
-			if (or->type == OSPF_DESTINATION_NETWORK) {
-				if (!ospf_route_match_same(
-					    ospf->old_table,
-					    (struct prefix_ipv4 *)&rn->p, or))
-					ospf_zebra_add(
-						ospf,
-						(struct prefix_ipv4 *)&rn->p,
-						or);
-			} else if (or->type == OSPF_DESTINATION_DISCARD)
-				if (!ospf_route_match_same(
-					    ospf->old_table,
-					    (struct prefix_ipv4 *)&rn->p, or))
-					ospf_zebra_add_discard(
-						ospf,
-						(struct prefix_ipv4 *)&rn->p);
-		}
+	/* Delete old routes and install new or changed ones. */
+	route_table_diff(ospf->old_table, rt, ospf_route_install_same,
+			 ospf_route_install_diff, ospf, &stats);
+
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug("%s: %lu added, %lu changed, %lu removed, %lu unchanged",
+			   __func__, stats.added, stats.changed, stats.removed,
+			   stats.unchanged);
 }
 
 /* RFC2328 16.1. (4). For "router". */
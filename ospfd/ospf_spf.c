@@ -15,6 +15,7 @@
 #include "table.h"
 #include "log.h"
 #include "sockunion.h" /* for inet_ntop () */
+#include "jhash.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_interface.h"
@@ -57,7 +58,7 @@ static void ospf_spf_set_reason(ospf_spf_reason_t reason)
 	spf_reason_flags |= 1 << reason;
 }
 
-static void ospf_vertex_free(void *);
+static void ospf_vertex_free(struct vertex *v);
 
 /*
  * Heap related functions, for the managment of the candidates, to
@@ -78,7 +79,138 @@ static int vertex_cmp(const struct vertex *v1, const struct vertex *v2)
 	}
 	return 0;
 }
-DECLARE_SKIPLIST_NONUNIQ(vertex_pqueue, struct vertex, pqi, vertex_cmp);
+
+/* Ties are broken by address, i.e. mostly by order of creation. */
+static int vertex_pqueue_cmp(const struct vertex *v1, const struct vertex *v2)
+{
+	int ret = vertex_cmp(v1, v2);
+
+	if (ret)
+		return ret;
+	if (v1 < v2)
+		return -1;
+	return v1 > v2;
+}
+DECLARE_HEAP(vertex_pqueue, struct vertex, pqi, vertex_pqueue_cmp);
+
+static int vertex_ids_cmp(const struct vertex *v1, const struct vertex *v2)
+{
+	return IPV4_ADDR_CMP(&v1->id, &v2->id);
+}
+
+static uint32_t vertex_ids_hash(const struct vertex *v)
+{
+	return jhash_1word(v->id.s_addr, 0);
+}
+DECLARE_HASH(vertex_ids, struct vertex, idi, vertex_ids_cmp, vertex_ids_hash);
+
+/*
+ * The vertices and vertex parents of a SPF tree are carved out of an arena
+ * that belongs to the tree's vertex list, and released all at once by
+ * ospf_spf_cleanup(). Vertices dropped from a tree before that only give
+ * back their lists. The arena also indexes the vertices by ID, which is what
+ * ospf_spf_vertex_find() looks at for vertex lists.
+ */
+#define OSPF_SPF_ARENA_CHUNK_SIZE 16384
+
+struct ospf_spf_chunk {
+	struct ospf_spf_chunk *next;
+	size_t used;
+	uintptr_t data[];
+};
+
+struct ospf_spf_arena {
+	struct ospf_spf_chunk *chunks;
+	struct list *vertex_list;
+
+	/* first vertex of vertex_list for every ID */
+	struct vertex_ids_head ids;
+};
+
+static struct ospf_spf_arena *ospf_spf_arena_new(struct list *vertex_list)
+{
+	struct ospf_spf_arena *arena;
+
+	arena = XCALLOC(MTYPE_OSPF_VERTEX, sizeof(*arena));
+	arena->vertex_list = vertex_list;
+	vertex_ids_init(&arena->ids);
+
+	return arena;
+}
+
+static void *ospf_spf_arena_alloc(struct ospf_spf_arena *arena, size_t size)
+{
+	struct ospf_spf_chunk *chunk = arena->chunks;
+	size_t space = OSPF_SPF_ARENA_CHUNK_SIZE - sizeof(*chunk);
+	void *ret;
+
+	size = (size + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
+	assert(size <= space);
+
+	if (!chunk || chunk->used + size > space) {
+		chunk = XMALLOC(MTYPE_OSPF_VERTEX, OSPF_SPF_ARENA_CHUNK_SIZE);
+		chunk->next = arena->chunks;
+		chunk->used = 0;
+		arena->chunks = chunk;
+	}
+
+	ret = (char *)chunk->data + chunk->used;
+	chunk->used += size;
+
+	return memset(ret, 0, size);
+}
+
+static void ospf_spf_arena_free(struct ospf_spf_arena *arena)
+{
+	struct ospf_spf_chunk *chunk;
+
+	while (vertex_ids_pop(&arena->ids))
+		;
+	vertex_ids_fini(&arena->ids);
+
+	while ((chunk = arena->chunks)) {
+		arena->chunks = chunk->next;
+		XFREE(MTYPE_OSPF_VERTEX, chunk);
+	}
+	XFREE(MTYPE_OSPF_VERTEX, arena);
+}
+
+/* the arena holding the vertices of a vertex list, if it is one */
+static struct ospf_spf_arena *ospf_spf_arena_of(struct list *vertex_list)
+{
+	struct vertex *v = listnode_head(vertex_list);
+
+	if (v && v->arena && v->arena->vertex_list == vertex_list)
+		return v->arena;
+	return NULL;
+}
+
+/* Put a new vertex on the vertex list of its arena. */
+static void ospf_spf_vertex_link(struct vertex *v)
+{
+	listnode_add(v->arena->vertex_list, v);
+	vertex_ids_add(&v->arena->ids, v);
+}
+
+static void ospf_spf_vertex_unlink(struct vertex *v)
+{
+	struct ospf_spf_arena *arena = v->arena;
+	struct listnode *node;
+	struct vertex *other;
+
+	listnode_delete(arena->vertex_list, v);
+
+	if (vertex_ids_find(&arena->ids, v) != v)
+		return;
+
+	/* Another vertex with the same ID might be next in line. */
+	vertex_ids_del(&arena->ids, v);
+	for (ALL_LIST_ELEMENTS_RO(arena->vertex_list, node, other))
+		if (other->id.s_addr == v->id.s_addr) {
+			vertex_ids_add(&arena->ids, other);
+			break;
+		}
+}
 
 static void lsdb_clean_stat(struct ospf_lsdb *lsdb)
 {
@@ -95,6 +227,128 @@ static void lsdb_clean_stat(struct ospf_lsdb *lsdb)
 	}
 }
 
+/*
+ * Candidate state of an LSA during a SPF calculation: LSA_SPF_NOT_EXPLORED,
+ * LSA_SPF_IN_SPFTREE or the candidate vertex. Normally kept in lsa->stat;
+ * calculations that run concurrently on the same LSDB (TI-LFA workers) keep
+ * their vertices in a private hash instead, keyed by LSA.
+ */
+static unsigned int spf_lsa_stat_key(const void *data)
+{
+	const struct vertex *v = data;
+
+	return jhash(&v->lsa_p, sizeof(v->lsa_p), 0);
+}
+
+static bool spf_lsa_stat_cmp(const void *a, const void *b)
+{
+	const struct vertex *va = a, *vb = b;
+
+	return va->lsa_p == vb->lsa_p;
+}
+
+static struct vertex *ospf_spf_lsa_stat(struct ospf_area *area,
+					struct ospf_lsa *lsa)
+{
+	struct vertex *v, search = {.lsa_p = lsa};
+
+	if (!area->spf_lsa_stat)
+		return lsa->stat;
+
+	v = hash_lookup(area->spf_lsa_stat, &search);
+	if (v && CHECK_FLAG(v->flags, OSPF_VERTEX_IN_SPFTREE))
+		return LSA_SPF_IN_SPFTREE;
+	return v;
+}
+
+static void ospf_spf_lsa_stat_set(struct ospf_area *area, struct ospf_lsa *lsa,
+				  struct vertex *v)
+{
+	struct vertex search = {.lsa_p = lsa};
+
+	if (!area->spf_lsa_stat) {
+		lsa->stat = v;
+		return;
+	}
+
+	if (v == LSA_SPF_NOT_EXPLORED)
+		hash_release(area->spf_lsa_stat, &search);
+	else if (v == LSA_SPF_IN_SPFTREE) {
+		v = hash_lookup(area->spf_lsa_stat, &search);
+		if (v)
+			SET_FLAG(v->flags, OSPF_VERTEX_IN_SPFTREE);
+	} else
+		(void)hash_get(area->spf_lsa_stat, v, hash_alloc_intern);
+}
+
+void ospf_spf_lsa_stat_init(struct ospf_area *area)
+{
+	area->spf_lsa_stat = hash_create(spf_lsa_stat_key, spf_lsa_stat_cmp,
+					 "OSPF SPF LSA state");
+}
+
+void ospf_spf_lsa_stat_fini(struct ospf_area *area)
+{
+	hash_clean_and_free(&area->spf_lsa_stat, NULL);
+}
+
+/*
+ * Read-only index of the router and network LSAs of an area, used instead
+ * of the LSDB by concurrent SPF calculations: LSDB lookups lock and unlock
+ * route nodes, which isn't safe to do from several pthreads at once.
+ */
+static unsigned int spf_lsdb_snapshot_key(const void *data)
+{
+	const struct ospf_lsa *lsa = data;
+
+	return jhash_2words(lsa->data->type, lsa->data->id.s_addr, 0);
+}
+
+static bool spf_lsdb_snapshot_cmp(const void *a, const void *b)
+{
+	const struct ospf_lsa *la = a, *lb = b;
+
+	return la->data->type == lb->data->type &&
+	       la->data->id.s_addr == lb->data->id.s_addr;
+}
+
+void ospf_spf_lsdb_snapshot(struct ospf_area *area)
+{
+	struct route_node *rn;
+	struct ospf_lsa *lsa;
+
+	area->spf_lsdb_snapshot = hash_create(spf_lsdb_snapshot_key,
+					      spf_lsdb_snapshot_cmp,
+					      "OSPF SPF LSDB snapshot");
+
+	/* Router LSAs are looked up with advertising router == ID. */
+	LSDB_LOOP (ROUTER_LSDB(area), rn, lsa)
+		if (lsa->data->id.s_addr == lsa->data->adv_router.s_addr)
+			(void)hash_get(area->spf_lsdb_snapshot, lsa,
+				       hash_alloc_intern);
+
+	/* Keep the first network LSA per ID, like ospf_lsa_lookup_by_id(). */
+	LSDB_LOOP (NETWORK_LSDB(area), rn, lsa)
+		(void)hash_get(area->spf_lsdb_snapshot, lsa, hash_alloc_intern);
+}
+
+void ospf_spf_lsdb_snapshot_free(struct ospf_area *area)
+{
+	hash_clean_and_free(&area->spf_lsdb_snapshot, NULL);
+}
+
+static struct ospf_lsa *ospf_spf_lsa_lookup(struct ospf_area *area,
+					    uint32_t type, struct in_addr id)
+{
+	struct lsa_header hdr = {.type = type, .id = id};
+	struct ospf_lsa search = {.data = &hdr};
+
+	if (area->spf_lsdb_snapshot)
+		return hash_lookup(area->spf_lsdb_snapshot, &search);
+
+	return ospf_lsa_lookup_by_id(area, type, id);
+}
+
 static struct vertex_nexthop *vertex_nexthop_new(void)
 {
 	return XCALLOC(MTYPE_OSPF_NEXTHOP, sizeof(struct vertex_nexthop));
@@ -154,7 +408,7 @@ static struct vertex_parent *vertex_parent_new(struct vertex *v, int backlink,
 {
 	struct vertex_parent *new;
 
-	new = XMALLOC(MTYPE_OSPF_VERTEX_PARENT, sizeof(struct vertex_parent));
+	new = ospf_spf_arena_alloc(v->arena, sizeof(struct vertex_parent));
 
 	new->parent = v;
 	new->backlink = backlink;
@@ -164,11 +418,11 @@ static struct vertex_parent *vertex_parent_new(struct vertex *v, int backlink,
 	return new;
 }
 
+/* the vertex parent itself lives in the arena */
 static void vertex_parent_free(struct vertex_parent *p)
 {
 	vertex_nexthop_free(p->local_nexthop);
 	vertex_nexthop_free(p->nexthop);
-	XFREE(MTYPE_OSPF_VERTEX_PARENT, p);
 }
 
 int vertex_parent_cmp(void *aa, void *bb)
@@ -178,15 +432,18 @@ int vertex_parent_cmp(void *aa, void *bb)
 }
 
 static struct vertex *ospf_vertex_new(struct ospf_area *area,
+				      struct ospf_spf_arena *arena,
 				      struct ospf_lsa *lsa)
 {
 	struct vertex *new;
 
-	new = XCALLOC(MTYPE_OSPF_VERTEX, sizeof(struct vertex));
+	new = ospf_spf_arena_alloc(arena, sizeof(struct vertex));
 
+	new->arena = arena;
 	new->flags = 0;
 	new->type = lsa->data->type;
 	new->id = lsa->data->id;
+	new->adv_router = lsa->data->adv_router;
 	new->lsa = lsa->data;
 	new->children = list_new();
 	new->parents = list_new();
@@ -194,9 +451,9 @@ static struct vertex *ospf_vertex_new(struct ospf_area *area,
 	new->parents->cmp = vertex_parent_cmp;
 	new->lsa_p = lsa;
 
-	lsa->stat = new;
+	ospf_spf_lsa_stat_set(area, lsa, new);
 
-	listnode_add(area->spf_vertex_list, new);
+	ospf_spf_vertex_link(new);
 
 	if (IS_DEBUG_OSPF_EVENT)
 		zlog_debug("%s: Created %s vertex %pI4", __func__,
@@ -207,15 +464,8 @@ static struct vertex *ospf_vertex_new(struct ospf_area *area,
 	return new;
 }
 
-static void ospf_vertex_free(void *data)
+static void ospf_vertex_lists_free(struct vertex *v)
 {
-	struct vertex *v = data;
-
-	if (IS_DEBUG_OSPF_EVENT)
-		zlog_debug("%s: Free %s vertex %pI4", __func__,
-			   v->type == OSPF_VERTEX_ROUTER ? "Router" : "Network",
-			   &v->lsa->id);
-
 	if (v->children)
 		list_delete(&v->children);
 
@@ -223,8 +473,18 @@ static void ospf_vertex_free(void *data)
 		list_delete(&v->parents);
 
 	v->lsa = NULL;
+}
+
+/* Drop a vertex from its tree, its memory is released with the arena. */
+static void ospf_vertex_free(struct vertex *v)
+{
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug("%s: Free %s vertex %pI4", __func__,
+			   v->type == OSPF_VERTEX_ROUTER ? "Router" : "Network",
+			   &v->id);
 
-	XFREE(MTYPE_OSPF_VERTEX, v);
+	ospf_spf_vertex_unlink(v);
+	ospf_vertex_lists_free(v);
 }
 
 static void ospf_vertex_dump(const char *msg, struct vertex *v,
@@ -279,12 +539,22 @@ static void ospf_vertex_add_parent(struct vertex *v)
 	}
 }
 
-/* Find a vertex according to its router id */
+/*
+ * Find a vertex according to its router id, either in the vertex list of a
+ * SPF tree or in any other list of vertices (e.g. children).
+ */
 struct vertex *ospf_spf_vertex_find(struct in_addr id, struct list *vertex_list)
 {
+	struct ospf_spf_arena *arena = ospf_spf_arena_of(vertex_list);
 	struct listnode *node;
 	struct vertex *found;
 
+	if (arena) {
+		struct vertex search = {.id = id};
+
+		return vertex_ids_find(&arena->ids, &search);
+	}
+
 	for (ALL_LIST_ELEMENTS_RO(vertex_list, node, found)) {
 		if (found->id.s_addr == id.s_addr)
 			return found;
@@ -324,31 +594,41 @@ struct vertex *ospf_spf_vertex_by_nexthop(struct vertex *root,
 	return NULL;
 }
 
-/* Create a deep copy of a SPF vertex without children and parents */
-static struct vertex *ospf_spf_vertex_copy(struct vertex *vertex)
+/*
+ * Create a deep copy of a SPF vertex without children and parents, and put
+ * it on the vertex list of the given arena.
+ */
+static struct vertex *ospf_spf_vertex_copy(struct ospf_spf_arena *arena,
+					   struct vertex *vertex)
 {
 	struct vertex *copy;
 
-	copy = XCALLOC(MTYPE_OSPF_VERTEX, sizeof(struct vertex));
+	copy = ospf_spf_arena_alloc(arena, sizeof(struct vertex));
 
 	memcpy(copy, vertex, sizeof(struct vertex));
+	memset(&copy->pqi, 0, sizeof(copy->pqi));
+	memset(&copy->idi, 0, sizeof(copy->idi));
+	copy->arena = arena;
 	copy->parents = list_new();
 	copy->parents->del = (void (*)(void *))vertex_parent_free;
 	copy->parents->cmp = vertex_parent_cmp;
 	copy->children = list_new();
 
+	ospf_spf_vertex_link(copy);
+
 	return copy;
 }
 
 /* Create a deep copy of a SPF vertex_parent */
 static struct vertex_parent *
-ospf_spf_vertex_parent_copy(struct vertex_parent *vertex_parent)
+ospf_spf_vertex_parent_copy(struct ospf_spf_arena *arena,
+			    struct vertex_parent *vertex_parent)
 {
 	struct vertex_parent *vertex_parent_copy;
 	struct vertex_nexthop *nexthop_copy, *local_nexthop_copy;
 
 	vertex_parent_copy =
-		XCALLOC(MTYPE_OSPF_VERTEX, sizeof(struct vertex_parent));
+		ospf_spf_arena_alloc(arena, sizeof(struct vertex_parent));
 
 	nexthop_copy = vertex_nexthop_new();
 	local_nexthop_copy = vertex_nexthop_new();
@@ -365,30 +645,37 @@ ospf_spf_vertex_parent_copy(struct vertex_parent *vertex_parent)
 	return vertex_parent_copy;
 }
 
-/* Create a deep copy of a SPF tree */
+/*
+ * Create a deep copy of a SPF tree. The vertex list must be empty at the
+ * top level call, the copy gets its own arena.
+ */
 void ospf_spf_copy(struct vertex *vertex, struct list *vertex_list)
 {
+	struct ospf_spf_arena *arena;
 	struct listnode *node;
 	struct vertex *vertex_copy, *child, *child_copy, *parent_copy;
 	struct vertex_parent *vertex_parent, *vertex_parent_copy;
 
+	arena = ospf_spf_arena_of(vertex_list);
+	if (!arena) {
+		assert(list_isempty(vertex_list));
+		arena = ospf_spf_arena_new(vertex_list);
+	}
+
 	/* First check if the node is already in the vertex list */
 	vertex_copy = ospf_spf_vertex_find(vertex->id, vertex_list);
-	if (!vertex_copy) {
-		vertex_copy = ospf_spf_vertex_copy(vertex);
-		listnode_add(vertex_list, vertex_copy);
-	}
+	if (!vertex_copy)
+		vertex_copy = ospf_spf_vertex_copy(arena, vertex);
 
 	/* Copy all parents, create parent nodes if necessary */
 	for (ALL_LIST_ELEMENTS_RO(vertex->parents, node, vertex_parent)) {
 		parent_copy = ospf_spf_vertex_find(vertex_parent->parent->id,
 						   vertex_list);
-		if (!parent_copy) {
-			parent_copy =
-				ospf_spf_vertex_copy(vertex_parent->parent);
-			listnode_add(vertex_list, parent_copy);
-		}
-		vertex_parent_copy = ospf_spf_vertex_parent_copy(vertex_parent);
+		if (!parent_copy)
+			parent_copy = ospf_spf_vertex_copy(
+				arena, vertex_parent->parent);
+		vertex_parent_copy =
+			ospf_spf_vertex_parent_copy(arena, vertex_parent);
 		vertex_parent_copy->parent = parent_copy;
 		listnode_add(vertex_copy->parents, vertex_parent_copy);
 	}
@@ -396,10 +683,8 @@ void ospf_spf_copy(struct vertex *vertex, struct list *vertex_list)
 	/* Copy all children, create child nodes if necessary */
 	for (ALL_LIST_ELEMENTS_RO(vertex->children, node, child)) {
 		child_copy = ospf_spf_vertex_find(child->id, vertex_list);
-		if (!child_copy) {
-			child_copy = ospf_spf_vertex_copy(child);
-			listnode_add(vertex_list, child_copy);
-		}
+		if (!child_copy)
+			child_copy = ospf_spf_vertex_copy(arena, child);
 		listnode_add(vertex_copy->children, child_copy);
 	}
 
@@ -457,7 +742,6 @@ static void ospf_spf_remove_branch(struct vertex_parent *vertex_parent,
 						       grandchild, vertex_list);
 			}
 		}
-		listnode_delete(vertex_list, child);
 		ospf_vertex_free(child);
 	}
 }
@@ -538,11 +822,10 @@ static void ospf_spf_init(struct ospf_area *area, struct ospf_lsa *root_lsa,
 
 	/* Create vertex list */
 	vertex_list = list_new();
-	vertex_list->del = ospf_vertex_free;
 	area->spf_vertex_list = vertex_list;
 
 	/* Create root node. */
-	v = ospf_vertex_new(area, root_lsa);
+	v = ospf_vertex_new(area, ospf_spf_arena_new(vertex_list), root_lsa);
 	area->spf = v;
 
 	area->spf_dry_run = is_dry_run;
@@ -1309,6 +1592,7 @@ static void ospf_spf_next(struct vertex *v, struct ospf_area *area,
 			  struct vertex_pqueue_head *candidate)
 {
 	struct ospf_lsa *w_lsa = NULL;
+	struct vertex *w_stat;
 	uint8_t *p;
 	uint8_t *lim;
 	struct router_lsa_link *l = NULL;
@@ -1380,9 +1664,8 @@ static void ospf_spf_next(struct vertex *v, struct ospf_area *area,
 					zlog_debug(
 						"looking up LSA through VL: %pI4",
 						&l->link_id);
-				w_lsa = ospf_lsa_lookup(area->ospf, area,
-							OSPF_ROUTER_LSA,
-							l->link_id, l->link_id);
+				w_lsa = ospf_spf_lsa_lookup(
+					area, OSPF_ROUTER_LSA, l->link_id);
 				if (w_lsa && IS_DEBUG_OSPF_EVENT)
 					zlog_debug("found Router LSA %pI4",
 						   &l->link_id);
@@ -1392,7 +1675,7 @@ static void ospf_spf_next(struct vertex *v, struct ospf_area *area,
 					zlog_debug(
 						"Looking up Network LSA, ID: %pI4",
 						&l->link_id);
-				w_lsa = ospf_lsa_lookup_by_id(
+				w_lsa = ospf_spf_lsa_lookup(
 					area, OSPF_NETWORK_LSA, l->link_id);
 				if (w_lsa && IS_DEBUG_OSPF_EVENT)
 					zlog_debug("found the LSA");
@@ -1422,8 +1705,7 @@ static void ospf_spf_next(struct vertex *v, struct ospf_area *area,
 			p += sizeof(struct in_addr);
 
 			/* Lookup the vertex W's LSA. */
-			w_lsa = ospf_lsa_lookup_by_id(area, OSPF_ROUTER_LSA,
-						      *r);
+			w_lsa = ospf_spf_lsa_lookup(area, OSPF_ROUTER_LSA, *r);
 			if (w_lsa && IS_DEBUG_OSPF_EVENT)
 				zlog_debug("found Router LSA %pI4",
 					   &w_lsa->data->id);
@@ -1459,7 +1741,8 @@ static void ospf_spf_next(struct vertex *v, struct ospf_area *area,
 		 * (c) If vertex W is already on the shortest-path tree, examine
 		 * the next link in the LSA.
 		 */
-		if (w_lsa->stat == LSA_SPF_IN_SPFTREE) {
+		w_stat = ospf_spf_lsa_stat(area, w_lsa);
+		if (w_stat == LSA_SPF_IN_SPFTREE) {
 			if (IS_DEBUG_OSPF_EVENT)
 				zlog_debug("The LSA is already in SPF");
 			continue;
@@ -1476,23 +1759,23 @@ static void ospf_spf_next(struct vertex *v, struct ospf_area *area,
 		/* calculate link cost D -- moved above */
 
 		/* Is there already vertex W in candidate list? */
-		if (w_lsa->stat == LSA_SPF_NOT_EXPLORED) {
+		if (w_stat == LSA_SPF_NOT_EXPLORED) {
 			/* prepare vertex W. */
-			w = ospf_vertex_new(area, w_lsa);
+			w = ospf_vertex_new(area, v->arena, w_lsa);
 
 			/* Calculate nexthop to W. */
 			if (ospf_nexthop_calculation(area, v, w, l, distance,
 						     lsa_pos))
 				vertex_pqueue_add(candidate, w);
 			else {
-				listnode_delete(area->spf_vertex_list, w);
+				ospf_spf_lsa_stat_set(area, w_lsa,
+						      LSA_SPF_NOT_EXPLORED);
 				ospf_vertex_free(w);
-				w_lsa->stat = LSA_SPF_NOT_EXPLORED;
 				if (IS_DEBUG_OSPF_EVENT)
 					zlog_debug("Nexthop Calc failed");
 			}
-		} else if (w_lsa->stat != LSA_SPF_IN_SPFTREE) {
-			w = w_lsa->stat;
+		} else {
+			w = w_stat;
 			if (w->distance < distance) {
 				continue;
 			}
@@ -1677,6 +1960,10 @@ void ospf_rtrs_free(struct route_table *rtrs)
 
 void ospf_spf_cleanup(struct vertex *spf, struct list *vertex_list)
 {
+	struct ospf_spf_arena *arena;
+	struct listnode *node;
+	struct vertex *v;
+
 	/*
 	 * Free nexthop information, canonical versions of which are
 	 * attached the first level of router vertices attached to the
@@ -1685,9 +1972,17 @@ void ospf_spf_cleanup(struct vertex *spf, struct list *vertex_list)
 	if (spf)
 		ospf_canonical_nexthops_free(spf);
 
-	/* Free SPF vertices list with deconstructor ospf_vertex_free. */
-	if (vertex_list)
-		list_delete(&vertex_list);
+	if (!vertex_list)
+		return;
+
+	/* Free the vertices' lists, then all of their memory in one go. */
+	arena = ospf_spf_arena_of(vertex_list);
+	for (ALL_LIST_ELEMENTS_RO(vertex_list, node, v))
+		ospf_vertex_lists_free(v);
+	list_delete(&vertex_list);
+
+	if (arena)
+		ospf_spf_arena_free(arena);
 }
 
 /* Calculating the shortest-path tree for an area, see RFC2328 16.1. */
@@ -1724,7 +2019,10 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 	 * This function scans all the LSA database and set the stat field to
 	 * LSA_SPF_NOT_EXPLORED.
 	 */
-	lsdb_clean_stat(area->lsdb);
+	if (area->spf_lsa_stat)
+		hash_clean(area->spf_lsa_stat, NULL);
+	else
+		lsdb_clean_stat(area->lsdb);
 
 	/* Create a new heap for the candidates. */
 	vertex_pqueue_init(&candidate);
@@ -1744,7 +2042,7 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 	 * part of the tree.
 	 */
 	v = area->spf;
-	v->lsa_p->stat = LSA_SPF_IN_SPFTREE;
+	ospf_spf_lsa_stat_set(area, v->lsa_p, LSA_SPF_IN_SPFTREE);
 
 	for (;;) {
 		/* RFC2328 16.1. (2). */
@@ -1756,7 +2054,7 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 			/* No more vertices left. */
 			break;
 
-		v->lsa_p->stat = LSA_SPF_IN_SPFTREE;
+		ospf_spf_lsa_stat_set(area, v->lsa_p, LSA_SPF_IN_SPFTREE);
 
 		ospf_vertex_add_parent(v);
 
@@ -1791,12 +2089,14 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 	/* Increment SPF Calculation Counter. */
 	area->spf_calculation++;
 
-	monotime(&area->ospf->ts_spf);
+	/* Concurrent calculations leave the instance alone. */
+	if (!area->spf_lsa_stat)
+		monotime(&area->ospf->ts_spf);
 	area->ts_spf = area->ospf->ts_spf;
 
 	if (IS_DEBUG_OSPF_EVENT)
-		zlog_debug("%s: Stop. %zd vertices", __func__,
-			   mtype_stats_alloc(MTYPE_OSPF_VERTEX));
+		zlog_debug("%s: Stop. %u vertices", __func__,
+			   listcount(area->spf_vertex_list));
 }
 
 void ospf_spf_calculate_area(struct ospf *ospf, struct ospf_area *area,
@@ -1811,12 +2111,249 @@ void ospf_spf_calculate_area(struct ospf *ospf, struct ospf_area *area,
 		ospf_ti_lfa_compute(area, new_table,
 				    ospf->ti_lfa_protection_type);
 
-	ospf_spf_cleanup(area->spf, area->spf_vertex_list);
+	/*
+	 * Keep the SPT for partial route calculation, unless TI-LFA is in
+	 * use, as that always needs a full run.
+	 */
+	ospf_spf_saved_free(area);
+	if (!ospf->ti_lfa_enabled) {
+		area->spf_saved = area->spf;
+		area->spf_saved_vertex_list = area->spf_vertex_list;
+	} else
+		ospf_spf_cleanup(area->spf, area->spf_vertex_list);
+
+	area->spf = NULL;
+	area->spf_vertex_list = NULL;
+}
+
+void ospf_spf_saved_free(struct ospf_area *area)
+{
+	ospf_spf_cleanup(area->spf_saved, area->spf_saved_vertex_list);
+
+	area->spf_saved = NULL;
+	area->spf_saved_vertex_list = NULL;
+}
+
+/* Skip over stub links, returns NULL if there are no other links left. */
+static uint8_t *ospf_router_lsa_skip_stubs(uint8_t *p, uint8_t *lim)
+{
+	struct router_lsa_link *l;
+
+	while (p < lim) {
+		l = (struct router_lsa_link *)p;
+		if (l->m[0].type != LSA_LINK_TYPE_STUB)
+			return p;
+
+		p += OSPF_ROUTER_LSA_LINK_SIZE
+		     + (l->m[0].tos_count * OSPF_ROUTER_LSA_TOS_SIZE);
+	}
+
+	return NULL;
+}
+
+/*
+ * Check whether two instances of a router-LSA only differ in their stub
+ * links. The SPT does not depend on those, so the saved tree stays valid.
+ */
+static bool ospf_router_lsa_stub_change(struct lsa_header *old,
+					struct lsa_header *new)
+{
+	struct router_lsa *orl = (struct router_lsa *)old;
+	struct router_lsa *nrl = (struct router_lsa *)new;
+	uint8_t *op, *olim, *np, *nlim;
+	struct router_lsa_link *l;
+	size_t len;
+
+	if (orl->flags != nrl->flags)
+		return false;
+
+	op = ((uint8_t *)old) + OSPF_LSA_HEADER_SIZE + 4;
+	olim = ((uint8_t *)old) + ntohs(old->length);
+	np = ((uint8_t *)new) + OSPF_LSA_HEADER_SIZE + 4;
+	nlim = ((uint8_t *)new) + ntohs(new->length);
+
+	for (;;) {
+		op = ospf_router_lsa_skip_stubs(op, olim);
+		np = ospf_router_lsa_skip_stubs(np, nlim);
+		if (!op || !np)
+			return !op && !np;
+
+		l = (struct router_lsa_link *)op;
+		len = OSPF_ROUTER_LSA_LINK_SIZE
+		      + (l->m[0].tos_count * OSPF_ROUTER_LSA_TOS_SIZE);
+		if (op + len > olim || np + len > nlim || memcmp(op, np, len))
+			return false;
+
+		op += len;
+		np += len;
+	}
+}
+
+/*
+ * Called for every LSA change that requires route recalculation, with
+ * either old or new being NULL for an added or removed LSA. Flags the
+ * next SPF run as full when the topology might have changed; stub-only
+ * router-LSA changes and summary-LSAs only need a partial calculation.
+ */
+void ospf_spf_lsa_changed(struct ospf *ospf, struct ospf_lsa *old,
+			  struct ospf_lsa *new)
+{
+	struct ospf_lsa *lsa = new ? new : old;
+
+	switch (lsa->data->type) {
+	case OSPF_SUMMARY_LSA:
+	case OSPF_ASBR_SUMMARY_LSA:
+		return;
+	case OSPF_ROUTER_LSA:
+		if (old && new && !IS_LSA_MAXAGE(old) && !IS_LSA_MAXAGE(new)
+		    && !ospf_lsa_is_self_originated(ospf, new)
+		    && ospf_router_lsa_stub_change(old->data, new->data))
+			return;
+		break;
+	case OSPF_NETWORK_LSA:
+		break;
+	default:
+		return;
+	}
+
+	if (IS_DEBUG_OSPF_EVENT && !ospf->spf_full_required)
+		zlog_debug("SPF: %s %pI4 adv %pI4 changed, full SPF required",
+			   lookup_msg(ospf_lsa_type_msg, lsa->data->type,
+				      NULL),
+			   &lsa->data->id, &lsa->data->adv_router);
+
+	ospf->spf_full_required = true;
+}
+
+/*
+ * Point the vertices of the saved SPT back at the LSAs currently in the
+ * LSDB. Returns false if any of them went away.
+ */
+static bool ospf_spf_saved_refresh(struct ospf_area *area)
+{
+	struct listnode *node;
+	struct vertex *v;
+	struct ospf_lsa *lsa;
+
+	for (ALL_LIST_ELEMENTS_RO(area->spf_saved_vertex_list, node, v)) {
+		if (v == area->spf_saved)
+			lsa = area->router_lsa_self;
+		else
+			lsa = ospf_lsdb_lookup_by_id(area->lsdb, v->type, v->id,
+						     v->adv_router);
+		if (!lsa || IS_LSA_MAXAGE(lsa))
+			return false;
+
+		v->lsa_p = lsa;
+		v->lsa = lsa->data;
+		UNSET_FLAG(v->flags, OSPF_VERTEX_PROCESSED);
+	}
+
+	return true;
+}
+
+/* Can the saved SPTs be used instead of running Dijkstra again? */
+static bool ospf_spf_partial_possible(struct ospf *ospf)
+{
+	struct ospf_area *area;
+	struct listnode *node;
+
+	if (ospf->spf_full_required || ospf->ti_lfa_enabled
+	    || listcount(ospf->vlinks))
+		return false;
+
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+		if (!area->router_lsa_self) {
+			if (area->spf_saved)
+				return false;
+			continue;
+		}
+
+		if (!area->spf_saved || !ospf_spf_saved_refresh(area))
+			return false;
+	}
+
+	return true;
+}
+
+static int ospf_vertex_order_cmp(const void *a, const void *b)
+{
+	return vertex_cmp(*(const struct vertex **)a,
+			  *(const struct vertex **)b);
+}
+
+/*
+ * Partial route calculation: rebuild the intra-area routes of an area from
+ * its saved SPT, in the order Dijkstra added the vertices, and redo the
+ * stub processing (RFC 2328 16.1. (4) and 16.1.1).
+ */
+static void ospf_spf_partial_area(struct ospf_area *area,
+				  struct route_table *new_table,
+				  struct route_table *all_rtrs,
+				  struct route_table *new_rtrs)
+{
+	struct vertex **order;
+	struct listnode *node;
+	struct vertex *v;
+	unsigned int i, count = 0;
+
+	if (!area->spf_saved)
+		return;
+
+	area->spf = area->spf_saved;
+	area->spf_vertex_list = area->spf_saved_vertex_list;
+	area->spf_dry_run = false;
+	area->spf_root_node = true;
+
+	area->abr_count = 0;
+	area->asbr_count = 0;
+
+	order = XCALLOC(MTYPE_TMP,
+			listcount(area->spf_vertex_list) * sizeof(*order));
+	for (ALL_LIST_ELEMENTS_RO(area->spf_vertex_list, node, v))
+		if (v != area->spf)
+			order[count++] = v;
+	qsort(order, count, sizeof(*order), ospf_vertex_order_cmp);
+
+	for (i = 0; i < count; i++) {
+		v = order[i];
+
+		if (v->type != OSPF_VERTEX_ROUTER)
+			ospf_intra_add_transit(new_table, v, area);
+		else {
+			if (new_rtrs)
+				ospf_intra_add_router(new_rtrs, v, area, false);
+			if (all_rtrs)
+				ospf_intra_add_router(all_rtrs, v, area, true);
+		}
+	}
+
+	XFREE(MTYPE_TMP, order);
+
+	ospf_spf_process_stubs(area, area->spf, new_table, 0);
+
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug("%s: area %pI4, %u vertices reused", __func__,
+			   &area->area_id, count + 1);
 
 	area->spf = NULL;
 	area->spf_vertex_list = NULL;
 }
 
+static void ospf_spf_partial_areas(struct ospf *ospf,
+				   struct route_table *new_table,
+				   struct route_table *all_rtrs,
+				   struct route_table *new_rtrs)
+{
+	struct ospf_area *area;
+	struct listnode *node;
+
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		ospf_spf_partial_area(area, new_table, all_rtrs, new_rtrs);
+
+	monotime(&ospf->ts_spf);
+}
+
 void ospf_spf_calculate_areas(struct ospf *ospf, struct route_table *new_table,
 			      struct route_table *all_rtrs,
 			      struct route_table *new_rtrs)
@@ -1851,6 +2388,7 @@ static void ospf_spf_calculate_schedule_worker(struct event *thread)
 	unsigned long ia_time, prune_time, rt_time;
 	unsigned long abr_time, total_spf_time, spf_time;
 	char rbuf[32]; /* reason_buf */
+	bool partial;
 
 	if (IS_DEBUG_OSPF_EVENT)
 		zlog_debug("SPF: Timer (SPF calculation expire)");
@@ -1868,7 +2406,19 @@ static void ospf_spf_calculate_schedule_worker(struct event *thread)
 	if (CHECK_FLAG(ospf->opaque, OPAQUE_OPERATION_READY_BIT))
 		all_rtrs = route_table_init();
 
-	ospf_spf_calculate_areas(ospf, new_table, all_rtrs, new_rtrs);
+	/*
+	 * If none of the changes since the last run affected the SPTs, reuse
+	 * them and only recalculate the routes.
+	 */
+	partial = ospf_spf_partial_possible(ospf);
+	if (partial) {
+		ospf_spf_partial_areas(ospf, new_table, all_rtrs, new_rtrs);
+		ospf->spf_partial_runs++;
+	} else {
+		ospf_spf_calculate_areas(ospf, new_table, all_rtrs, new_rtrs);
+		ospf->spf_full_runs++;
+	}
+	ospf->spf_full_required = false;
 	spf_time = monotime_since(&spf_start_time, NULL);
 
 	ospf_vl_shut_unapproved(ospf);
@@ -1891,9 +2441,18 @@ static void ospf_spf_calculate_schedule_worker(struct event *thread)
 	/*
 	 * Calculate AS external routes, see RFC 2328 16.4.
 	 * There is a dedicated routing table for external routes which is not
-	 * handled here directly
+	 * handled here directly. Unless the SPF run was triggered by something
+	 * that isn't visible in the routing tables, only the external routes
+	 * depending on a changed route need to be recalculated.
 	 */
-	ospf_ase_calculate_schedule(ospf);
+	ospf_ase_calculate_schedule_changes(
+		ospf, new_table, new_rtrs,
+		(spf_reason_flags &
+		 ~((1 << SPF_FLAG_ROUTER_LSA_INSTALL) |
+		   (1 << SPF_FLAG_NETWORK_LSA_INSTALL) |
+		   (1 << SPF_FLAG_SUMMARY_LSA_INSTALL) |
+		   (1 << SPF_FLAG_ASBR_SUMMARY_LSA_INSTALL) |
+		   (1 << SPF_FLAG_MAXAGE))) != 0);
 	ospf_ase_calculate_timer_add(ospf);
 
 	if (IS_DEBUG_OSPF_EVENT)
@@ -1973,7 +2532,8 @@ static void ospf_spf_calculate_schedule_worker(struct event *thread)
 
 	if (IS_DEBUG_OSPF_EVENT) {
 		zlog_info("SPF Processing Time(usecs): %ld", total_spf_time);
-		zlog_info("            SPF Time: %ld", spf_time);
+		zlog_info("            SPF Time: %ld%s", spf_time,
+			  partial ? " (partial)" : "");
 		zlog_info("           InterArea: %ld", ia_time);
 		zlog_info("               Prune: %ld", prune_time);
 		zlog_info("        RouteInstall: %ld", rt_time);
@@ -2003,6 +2563,25 @@ void ospf_spf_calculate_schedule(struct ospf *ospf, ospf_spf_reason_t reason)
 
 	ospf_spf_set_reason(reason);
 
+	/*
+	 * LSA changes tell us themselves whether they need a full run, see
+	 * ospf_spf_lsa_changed(). Anything else might touch the topology.
+	 */
+	switch (reason) {
+	case SPF_FLAG_ROUTER_LSA_INSTALL:
+	case SPF_FLAG_NETWORK_LSA_INSTALL:
+	case SPF_FLAG_SUMMARY_LSA_INSTALL:
+	case SPF_FLAG_ASBR_SUMMARY_LSA_INSTALL:
+	case SPF_FLAG_MAXAGE:
+		break;
+	case SPF_FLAG_ABR_STATUS_CHANGE:
+	case SPF_FLAG_ASBR_STATUS_CHANGE:
+	case SPF_FLAG_CONFIG_CHANGE:
+	case SPF_FLAG_GR_FINISH:
+		ospf->spf_full_required = true;
+		break;
+	}
+
 	/* SPF calculation timer is already scheduled. */
 	if (ospf->t_spf_calc) {
 		if (IS_DEBUG_OSPF_EVENT)
@@ -15,16 +15,25 @@
 
 /* values for vertex->flags */
 #define OSPF_VERTEX_PROCESSED      0x01
+#define OSPF_VERTEX_IN_SPFTREE     0x02 /* only with area->spf_lsa_stat */
 
 /* The "root" is the node running the SPF calculation */
 
-PREDECL_SKIPLIST_NONUNIQ(vertex_pqueue);
+PREDECL_HEAP(vertex_pqueue);
+PREDECL_HASH(vertex_ids);
+
+/* storage of the vertices of one SPF tree, see ospf_spf.c */
+struct ospf_spf_arena;
+
 /* A router or network in an area */
 struct vertex {
 	struct vertex_pqueue_item pqi;
+	struct vertex_ids_item idi;
+	struct ospf_spf_arena *arena;
 	uint8_t flags;
 	uint8_t type;		/* copied from LSA header */
 	struct in_addr id;      /* copied from LSA header */
+	struct in_addr adv_router; /* copied from LSA header */
 	struct ospf_lsa *lsa_p;
 	struct lsa_header *lsa; /* Router or Network LSA */
 	uint32_t distance;      /* from root to this vertex */
@@ -74,6 +83,13 @@ extern void ospf_spf_calculate_areas(struct ospf *ospf,
 				     struct route_table *new_rtrs);
 extern void ospf_rtrs_free(struct route_table *);
 extern void ospf_spf_cleanup(struct vertex *spf, struct list *vertex_list);
+extern void ospf_spf_saved_free(struct ospf_area *area);
+extern void ospf_spf_lsa_changed(struct ospf *ospf, struct ospf_lsa *old,
+				 struct ospf_lsa *new);
+extern void ospf_spf_lsa_stat_init(struct ospf_area *area);
+extern void ospf_spf_lsa_stat_fini(struct ospf_area *area);
+extern void ospf_spf_lsdb_snapshot(struct ospf_area *area);
+extern void ospf_spf_lsdb_snapshot_free(struct ospf_area *area);
 extern void ospf_spf_copy(struct vertex *vertex, struct list *vertex_list);
 extern void ospf_spf_remove_resource(struct vertex *vertex,
 				     struct list *vertex_list,
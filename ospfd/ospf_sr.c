@@ -1970,9 +1970,12 @@ void ospf_sr_update_task(struct ospf *ospf)
 
 	osr_debug("SR (%s): Start SPF update", __func__);
 
+	/* unchanged NHLFEs aren't sent, the others go in one write */
+	ospf_zebra_sr_batch_begin();
 	hash_iterate(OspfSR.neighbors, (void (*)(struct hash_bucket *,
 						 void *))ospf_sr_nhlfe_update,
 		     NULL);
+	ospf_zebra_sr_batch_end();
 
 	monotime(&stop_time);
 
@@ -10,6 +10,10 @@
 #include "prefix.h"
 #include "table.h"
 #include "printfrr.h"
+#include "frr_pthread.h"
+#include "frrevent.h"
+#include "vty.h"
+#include "json.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_asbr.h"
@@ -766,10 +770,10 @@ static void ospf_ti_lfa_generate_post_convergence_spf(struct ospf_area *area,
 	area->spf_protected_resource = NULL;
 }
 
-static void
-ospf_ti_lfa_generate_p_space(struct ospf_area *area, struct vertex *child,
-			     struct protected_resource *protected_resource,
-			     bool recursive, struct list *pc_path)
+static struct p_space *
+ospf_ti_lfa_p_space_new(struct ospf_area *area, struct vertex *child,
+			struct protected_resource *protected_resource,
+			bool recursive, struct list *pc_path)
 {
 	struct vertex *spf_orig;
 	struct list *vertex_list, *vertex_list_orig;
@@ -810,10 +814,239 @@ ospf_ti_lfa_generate_p_space(struct ospf_area *area, struct vertex *child,
 	area->spf = spf_orig;
 	area->spf_vertex_list = vertex_list_orig;
 
+	return p_space;
+}
+
+static void
+ospf_ti_lfa_generate_p_space(struct ospf_area *area, struct vertex *child,
+			     struct protected_resource *protected_resource,
+			     bool recursive, struct list *pc_path)
+{
+	struct p_space *p_space;
+
+	p_space = ospf_ti_lfa_p_space_new(area, child, protected_resource,
+					  recursive, pc_path);
+
 	/* We are finished, store the new P space */
 	p_spaces_add(area->p_spaces, p_space);
 }
 
+/*
+ * The P space (including post-convergence SPF and Q spaces) of every
+ * protected resource is computed as an independent job. The SPF code keeps
+ * the state of a calculation in the area, so each job runs on a private copy
+ * of it and only the results are merged back by the main pthread.
+ *
+ * With TI-LFA workers configured the jobs run concurrently: lookups then go
+ * through a read-only snapshot of the router and network LSAs, and each job
+ * keeps the candidate state of the LSAs to itself (see ospf_spf.c). The main
+ * pthread takes part and blocks until all jobs are done, so nothing can
+ * change the LSDB in the meantime.
+ */
+struct ospf_ti_lfa_job {
+	struct ospf_area *area;
+	struct vertex *child;
+	struct protected_resource *protected_resource;
+
+	/* results */
+	struct p_space *p_space;
+	uint64_t usecs;
+};
+
+struct ospf_ti_lfa_batch {
+	struct ospf_ti_lfa_job *jobs;
+	unsigned int njobs;
+	unsigned int alloc;
+
+	_Atomic unsigned int next;
+	bool concurrent;
+
+	pthread_mutex_t mtx;
+	pthread_cond_t cond;
+	unsigned int running;
+};
+
+struct ospf_ti_lfa_worker {
+	struct frr_pthread *fpt;
+	struct event *t_run;
+};
+
+/* Statistics of the last computation, per protected resource. */
+struct ospf_ti_lfa_resource_stats {
+	char resource[PROTECTED_RESOURCE_STRLEN];
+	uint32_t q_spaces;
+	uint32_t label_stacks;
+	uint64_t usecs;
+};
+
+struct ospf_ti_lfa_stats {
+	uint32_t runs;
+	time_t last_run;
+	uint64_t last_usecs;
+	uint64_t total_usecs;
+	unsigned int last_pthreads;
+
+	struct ospf_ti_lfa_resource_stats *resources;
+	unsigned int count;
+};
+
+static struct ospf_ti_lfa_worker **workers;
+static unsigned int workers_configured;
+
+/* only used from the main pthread */
+static struct ospf_ti_lfa_batch batch = {
+	.mtx = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void ospf_ti_lfa_job_add(struct ospf_area *area, struct vertex *child,
+				struct protected_resource *protected_resource)
+{
+	struct ospf_ti_lfa_job *job;
+
+	if (batch.njobs == batch.alloc) {
+		batch.alloc = batch.alloc ? batch.alloc * 2 : 16;
+		batch.jobs = XREALLOC(MTYPE_OSPF_TI_LFA_WORKER, batch.jobs,
+				      batch.alloc * sizeof(*batch.jobs));
+	}
+
+	job = &batch.jobs[batch.njobs++];
+	memset(job, 0, sizeof(*job));
+	job->area = area;
+	job->child = child;
+	job->protected_resource = protected_resource;
+}
+
+static void ospf_ti_lfa_job_run(struct ospf_ti_lfa_job *job)
+{
+	struct ospf_area area = *job->area;
+	struct timeval start;
+
+	monotime(&start);
+
+	if (batch.concurrent)
+		ospf_spf_lsa_stat_init(&area);
+
+	job->p_space = ospf_ti_lfa_p_space_new(
+		&area, job->child, job->protected_resource, true, NULL);
+
+	if (batch.concurrent)
+		ospf_spf_lsa_stat_fini(&area);
+
+	job->usecs = monotime_since(&start, NULL);
+}
+
+/* run jobs off the batch until none are left */
+static void ospf_ti_lfa_batch_work(void)
+{
+	unsigned int i;
+
+	while ((i = atomic_fetch_add_explicit(&batch.next, 1,
+					      memory_order_relaxed)) <
+	       batch.njobs)
+		ospf_ti_lfa_job_run(&batch.jobs[i]);
+}
+
+static void ospf_ti_lfa_worker_run(struct event *thread)
+{
+	ospf_ti_lfa_batch_work();
+
+	frr_with_mutex (&batch.mtx) {
+		if (--batch.running == 0)
+			pthread_cond_signal(&batch.cond);
+	}
+}
+
+static void ospf_ti_lfa_stats_update(struct ospf_area *area,
+				     uint64_t usecs)
+{
+	struct ospf_ti_lfa_stats *stats;
+	unsigned int i;
+
+	if (!area->ti_lfa_stats)
+		area->ti_lfa_stats = XCALLOC(MTYPE_OSPF_TI_LFA_STATS,
+					     sizeof(*area->ti_lfa_stats));
+	stats = area->ti_lfa_stats;
+
+	stats->runs++;
+	stats->last_run = monotime(NULL);
+	stats->last_usecs = usecs;
+	stats->total_usecs += usecs;
+	stats->last_pthreads = batch.concurrent
+				       ? MIN(workers_configured,
+					     batch.njobs - 1) + 1
+				       : 1;
+
+	XFREE(MTYPE_OSPF_TI_LFA_STATS, stats->resources);
+	stats->count = batch.njobs;
+	if (!batch.njobs)
+		return;
+
+	stats->resources = XCALLOC(MTYPE_OSPF_TI_LFA_STATS,
+				   batch.njobs * sizeof(*stats->resources));
+	for (i = 0; i < batch.njobs; i++) {
+		struct ospf_ti_lfa_job *job = &batch.jobs[i];
+		struct ospf_ti_lfa_resource_stats *res = &stats->resources[i];
+		struct q_space *q_space;
+
+		ospf_print_protected_resource(job->protected_resource,
+					      res->resource);
+		res->usecs = job->usecs;
+		frr_each (q_spaces, job->p_space->q_spaces, q_space) {
+			res->q_spaces++;
+			if (q_space->label_stack)
+				res->label_stacks++;
+		}
+	}
+}
+
+static void ospf_ti_lfa_batch_run(struct ospf_area *area)
+{
+	struct timeval start;
+	unsigned int i;
+
+	monotime(&start);
+
+	/* Keep debug output in order by running everything here. */
+	batch.concurrent = workers_configured && batch.njobs > 1 &&
+			   !IS_DEBUG_OSPF_EVENT && !IS_DEBUG_OSPF_TI_LFA;
+
+	if (batch.concurrent) {
+		ospf_spf_lsdb_snapshot(area);
+
+		atomic_store_explicit(&batch.next, 0, memory_order_relaxed);
+		batch.running = MIN(workers_configured, batch.njobs - 1);
+
+		/* the mutex orders the job setup above before the workers */
+		frr_with_mutex (&batch.mtx) {
+			for (i = 0; i < batch.running; i++)
+				event_add_event(workers[i]->fpt->master,
+						ospf_ti_lfa_worker_run,
+						workers[i], 0,
+						&workers[i]->t_run);
+		}
+
+		ospf_ti_lfa_batch_work();
+
+		frr_with_mutex (&batch.mtx) {
+			while (batch.running)
+				pthread_cond_wait(&batch.cond, &batch.mtx);
+		}
+
+		ospf_spf_lsdb_snapshot_free(area);
+	} else {
+		for (i = 0; i < batch.njobs; i++)
+			ospf_ti_lfa_job_run(&batch.jobs[i]);
+	}
+
+	/* Merge the P spaces, in the order they'd have been generated. */
+	for (i = 0; i < batch.njobs; i++)
+		p_spaces_add(area->p_spaces, batch.jobs[i].p_space);
+
+	ospf_ti_lfa_stats_update(area, monotime_since(&start, NULL));
+	batch.njobs = 0;
+}
+
 void ospf_ti_lfa_generate_p_spaces(struct ospf_area *area,
 				   enum protection_type protection_type)
 {
@@ -866,9 +1099,8 @@ void ospf_ti_lfa_generate_p_spaces(struct ospf_area *area,
 					protected_resource->router_id,
 					root->children);
 				if (child)
-					ospf_ti_lfa_generate_p_space(
-						area, child, protected_resource,
-						true, NULL);
+					ospf_ti_lfa_job_add(area, child,
+							    protected_resource);
 			}
 
 			continue;
@@ -915,13 +1147,14 @@ void ospf_ti_lfa_generate_p_spaces(struct ospf_area *area,
 						protection_type;
 					protected_resource->link = l;
 
-					ospf_ti_lfa_generate_p_space(
-						area, child, protected_resource,
-						true, NULL);
+					ospf_ti_lfa_job_add(area, child,
+							    protected_resource);
 				}
 			}
 		}
 	}
+
+	ospf_ti_lfa_batch_run(area);
 }
 
 static struct p_space *ospf_ti_lfa_get_p_space_by_path(struct ospf_area *area,
@@ -1100,3 +1333,146 @@ void ospf_ti_lfa_compute(struct ospf_area *area, struct route_table *new_table,
 	/* Cleanup P spaces and related datastructures including Q spaces. */
 	ospf_ti_lfa_free_p_spaces(area);
 }
+
+void ospf_ti_lfa_stats_free(struct ospf_area *area)
+{
+	if (!area->ti_lfa_stats)
+		return;
+
+	XFREE(MTYPE_OSPF_TI_LFA_STATS, area->ti_lfa_stats->resources);
+	XFREE(MTYPE_OSPF_TI_LFA_STATS, area->ti_lfa_stats);
+}
+
+void ospf_ti_lfa_show_statistics(struct vty *vty, struct ospf_area *area,
+				 json_object *json)
+{
+	struct ospf_ti_lfa_stats *stats = area->ti_lfa_stats;
+	json_object *json_area = NULL, *json_resources = NULL;
+	char buf[OSPF_TIME_DUMP_SIZE];
+	unsigned int i;
+
+	if (json) {
+		json_area = json_object_new_object();
+		json_object_object_addf(json, json_area, "%pI4",
+					&area->area_id);
+	} else
+		vty_out(vty, "Area %pI4:\n", &area->area_id);
+
+	if (!stats) {
+		if (!json)
+			vty_out(vty, "  No TI-LFA computation yet\n\n");
+		return;
+	}
+
+	frrtime_to_interval(monotime(NULL) - stats->last_run, buf,
+			    sizeof(buf));
+
+	if (json) {
+		json_object_int_add(json_area, "runs", stats->runs);
+		json_object_string_add(json_area, "lastRunAgo", buf);
+		json_object_int_add(json_area, "lastRunUsecs",
+				    stats->last_usecs);
+		json_object_int_add(json_area, "totalUsecs",
+				    stats->total_usecs);
+		json_object_int_add(json_area, "pthreads",
+				    stats->last_pthreads);
+		json_resources = json_object_new_array();
+		json_object_object_add(json_area, "protectedResources",
+				       json_resources);
+	} else {
+		vty_out(vty,
+			"  Runs: %u, last %s ago, took %" PRIu64
+			" usecs with %u pthread(s), %" PRIu64
+			" usecs in total\n",
+			stats->runs, buf, stats->last_usecs,
+			stats->last_pthreads, stats->total_usecs);
+		if (stats->count)
+			vty_out(vty, "  %-50s %8s %12s %12s\n",
+				"Protected resource", "Q spaces",
+				"Label stacks", "Time (usecs)");
+	}
+
+	for (i = 0; i < stats->count; i++) {
+		struct ospf_ti_lfa_resource_stats *res = &stats->resources[i];
+		json_object *json_res;
+
+		if (!json) {
+			vty_out(vty, "  %-50s %8u %12u %12" PRIu64 "\n",
+				res->resource, res->q_spaces,
+				res->label_stacks, res->usecs);
+			continue;
+		}
+
+		json_res = json_object_new_object();
+		json_object_string_add(json_res, "resource", res->resource);
+		json_object_int_add(json_res, "qSpaces", res->q_spaces);
+		json_object_int_add(json_res, "labelStacks",
+				    res->label_stacks);
+		json_object_int_add(json_res, "usecs", res->usecs);
+		json_object_array_add(json_resources, json_res);
+	}
+
+	if (!json)
+		vty_out(vty, "\n");
+}
+
+static void ospf_ti_lfa_workers_stop(void)
+{
+	unsigned int i;
+
+	if (!workers_configured)
+		return;
+
+	/* batches are always finished before returning to the event loop */
+	for (i = 0; i < workers_configured; i++) {
+		frr_pthread_stop(workers[i]->fpt, NULL);
+		frr_pthread_destroy(workers[i]->fpt);
+		XFREE(MTYPE_OSPF_TI_LFA_WORKER, workers[i]);
+	}
+	XFREE(MTYPE_OSPF_TI_LFA_WORKER, workers);
+	workers_configured = 0;
+}
+
+void ospf_ti_lfa_workers_set(unsigned int count)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+	char name[32];
+	char os_name[OS_THREAD_NAMELEN];
+	unsigned int i;
+
+	if (count > OSPF_TI_LFA_WORKERS_MAX)
+		count = OSPF_TI_LFA_WORKERS_MAX;
+	if (count == workers_configured)
+		return;
+
+	ospf_ti_lfa_workers_stop();
+	if (!count)
+		return;
+
+	workers = XCALLOC(MTYPE_OSPF_TI_LFA_WORKER, count * sizeof(*workers));
+	for (i = 0; i < count; i++) {
+		struct ospf_ti_lfa_worker *w;
+
+		w = XCALLOC(MTYPE_OSPF_TI_LFA_WORKER, sizeof(*w));
+
+		snprintf(name, sizeof(name), "OSPF TI-LFA worker %u", i);
+		snprintf(os_name, sizeof(os_name), "ospfd_tilfa%u", i);
+		w->fpt = frr_pthread_new(&attr, name, os_name);
+		frr_pthread_run(w->fpt, NULL);
+		workers[i] = w;
+	}
+	for (i = 0; i < count; i++)
+		frr_pthread_wait_running(workers[i]->fpt);
+
+	workers_configured = count;
+}
+
+void ospf_ti_lfa_workers_finish(void)
+{
+	ospf_ti_lfa_workers_stop();
+	XFREE(MTYPE_OSPF_TI_LFA_WORKER, batch.jobs);
+	batch.alloc = 0;
+}
@@ -10,6 +10,8 @@
 
 #define PROTECTED_RESOURCE_STRLEN 100
 
+#define OSPF_TI_LFA_WORKERS_MAX 16U
+
 extern void ospf_ti_lfa_compute(struct ospf_area *area,
 				struct route_table *new_table,
 				enum protection_type protection_type);
@@ -23,4 +25,13 @@ extern void ospf_ti_lfa_free_p_spaces(struct ospf_area *area);
 void ospf_print_protected_resource(
 	struct protected_resource *protected_resource, char *buf);
 
+extern void ospf_ti_lfa_stats_free(struct ospf_area *area);
+extern void ospf_ti_lfa_show_statistics(struct vty *vty,
+					struct ospf_area *area,
+					json_object *json);
+
+/* (re)configure the number of TI-LFA workers, 0 disables them */
+extern void ospf_ti_lfa_workers_set(unsigned int count);
+extern void ospf_ti_lfa_workers_finish(void);
+
 #endif /* _OSPF_TI_LFA_H */
@@ -33,6 +33,7 @@
 #include "ospfd/ospf_flood.h"
 #include "ospfd/ospf_abr.h"
 #include "ospfd/ospf_spf.h"
+#include "ospfd/ospf_ti_lfa.h"
 #include "ospfd/ospf_route.h"
 #include "ospfd/ospf_zebra.h"
 /*#include "ospfd/ospf_routemap.h" */
@@ -2366,6 +2367,25 @@ DEFUN (no_ospf_timers_lsa_min_arrival,
 	return CMD_SUCCESS;
 }
 
+DEFPY (ospf_timers_lsa_flood_delay,
+       ospf_timers_lsa_flood_delay_cmd,
+       "[no] timers lsa flood-delay ![(0-1000)$delay]",
+       NO_STR
+       "Adjust routing timers\n"
+       "OSPF LSA timers\n"
+       "Delay before sending flooded LSAs, to pack them in fewer LS Updates\n"
+       "Delay in milliseconds\n")
+{
+	VTY_DECLVAR_INSTANCE_CONTEXT(ospf, ospf);
+
+	if (no)
+		ospf->flood_delay = OSPF_FLOOD_DELAY_DEFAULT;
+	else
+		ospf->flood_delay = delay;
+
+	return CMD_SUCCESS;
+}
+
 DEFUN (ospf_neighbor,
        ospf_neighbor_cmd,
        "neighbor A.B.C.D [priority (0-255) [poll-interval (1-65535)]]",
@@ -3237,6 +3257,14 @@ static int show_ip_ospf_common(struct vty *vty, struct ospf *ospf,
 					    time_store);
 		} else
 			json_object_boolean_true_add(json_vrf, "spfHasNotRun");
+		json_object_int_add(json_vrf, "spfFullRuns",
+				    ospf->spf_full_runs);
+		json_object_int_add(json_vrf, "spfPartialRuns",
+				    ospf->spf_partial_runs);
+		json_object_int_add(json_vrf, "aseFullRuns",
+				    ospf->ase_full_runs);
+		json_object_int_add(json_vrf, "aseIncrementalRuns",
+				    ospf->ase_incremental_runs);
 	} else {
 		vty_out(vty, " SPF algorithm ");
 		if (ospf->ts_spf.tv_sec || ospf->ts_spf.tv_usec) {
@@ -3249,6 +3277,12 @@ static int show_ip_ospf_common(struct vty *vty, struct ospf *ospf,
 						  timebuf, sizeof(timebuf)));
 		} else
 			vty_out(vty, "has not been run\n");
+		vty_out(vty,
+			" SPF runs: %u full, %u partial route calculation\n",
+			ospf->spf_full_runs, ospf->spf_partial_runs);
+		vty_out(vty,
+			" External route calculations: %u full, %u incremental\n",
+			ospf->ase_full_runs, ospf->ase_incremental_runs);
 	}
 
 	if (json) {
@@ -3265,6 +3299,8 @@ static int show_ip_ospf_common(struct vty *vty, struct ospf *ospf,
 				    ospf->min_ls_interval);
 		json_object_int_add(json_vrf, "lsaMinArrivalMsecs",
 				    ospf->min_ls_arrival);
+		json_object_int_add(json_vrf, "lsaFloodDelayMsecs",
+				    ospf->flood_delay);
 		/* Show write multiplier values */
 		json_object_int_add(json_vrf, "writeMultiplier",
 				    ospf->write_oi_count);
@@ -3291,6 +3327,9 @@ static int show_ip_ospf_common(struct vty *vty, struct ospf *ospf,
 			ospf->min_ls_interval);
 		vty_out(vty, " LSA minimum arrival %d msecs\n",
 			ospf->min_ls_arrival);
+		if (ospf->flood_delay)
+			vty_out(vty, " LSA flood delay %u msecs\n",
+				ospf->flood_delay);
 
 		/* Show write multiplier values */
 		vty_out(vty, " Write Multiplier set to %d \n",
@@ -3354,6 +3393,13 @@ static int show_ip_ospf_common(struct vty *vty, struct ospf *ospf,
 			ospf_lsdb_checksum(ospf->lsdb, OSPF_AS_EXTERNAL_LSA));
 	}
 
+	if (json)
+		json_object_int_add(json_vrf, "lsaExternalPending",
+				    ospf_external_lsa_pending(ospf));
+	else if (ospf_external_lsa_pending(ospf))
+		vty_out(vty, " External LSAs waiting to be originated: %zu\n",
+			ospf_external_lsa_pending(ospf));
+
 	if (json) {
 		json_object_int_add(
 			json_vrf, "lsaAsopaqueCounter",
@@ -3913,6 +3959,22 @@ static void show_ip_ospf_interface_sub(struct vty *vty, struct ospf *ospf,
 				ospf_nbr_count(oi, 0),
 				ospf_nbr_count(oi, NSM_Full));
 
+		if (use_json) {
+			json_object_int_add(json_interface_sub,
+					    "lsaFloodedCount",
+					    oi->ls_upd_lsa_out);
+			json_object_int_add(json_interface_sub,
+					    "lsaCoalescedCount",
+					    oi->ls_upd_coalesced);
+			json_object_int_add(json_interface_sub,
+					    "lsaRetransmittedCount",
+					    oi->ls_rxmt_lsa_out);
+		} else
+			vty_out(vty,
+				"  LSAs sent %u in %u LS Updates, %u superseded before sending, %u retransmitted\n",
+				oi->ls_upd_lsa_out, oi->ls_upd_out,
+				oi->ls_upd_coalesced, oi->ls_rxmt_lsa_out);
+
 		ospf_interface_bfd_show(vty, ifp, json_interface_sub);
 
 		/* OSPF Authentication information */
@@ -4032,6 +4094,12 @@ static void show_ip_ospf_interface_traffic_sub(struct vty *vty,
 				    oi->ls_upd_in);
 		json_object_int_add(json_interface_sub, "lsUpdOut",
 				    oi->ls_upd_out);
+		json_object_int_add(json_interface_sub, "lsUpdLsaOut",
+				    oi->ls_upd_lsa_out);
+		json_object_int_add(json_interface_sub, "lsUpdCoalesced",
+				    oi->ls_upd_coalesced);
+		json_object_int_add(json_interface_sub, "lsRxmtLsaOut",
+				    oi->ls_rxmt_lsa_out);
 		json_object_int_add(json_interface_sub, "lsAckIn",
 				    oi->ls_ack_in);
 		json_object_int_add(json_interface_sub, "lsAckOut",
@@ -11087,6 +11155,94 @@ DEFUN (show_ip_ospf_instance_border_routers,
 	return show_ip_ospf_border_routers_common(vty, ospf, 0, NULL);
 }
 
+static void show_ip_ospf_ti_lfa_statistics_common(struct vty *vty,
+						  struct ospf *ospf,
+						  uint8_t use_vrf,
+						  json_object *json)
+{
+	json_object *json_vrf = NULL, *json_areas = NULL;
+	struct ospf_area *area;
+	struct listnode *node;
+
+	if (json) {
+		json_vrf = use_vrf ? json_object_new_object() : json;
+		json_areas = json_object_new_object();
+	}
+
+	if (ospf->instance) {
+		if (!json)
+			vty_out(vty, "\nOSPF Instance: %d\n\n", ospf->instance);
+		else
+			json_object_int_add(json_vrf, "ospfInstance",
+					    ospf->instance);
+	}
+
+	ospf_show_vrf_name(ospf, vty, json_vrf, use_vrf);
+
+	if (!ospf->ti_lfa_enabled && !json)
+		vty_out(vty, "TI-LFA is not enabled\n");
+
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		ospf_ti_lfa_show_statistics(vty, area, json_areas);
+
+	if (json) {
+		json_object_boolean_add(json_vrf, "tiLfaEnabled",
+					ospf->ti_lfa_enabled);
+		json_object_object_add(json_vrf, "areas", json_areas);
+		if (use_vrf)
+			json_object_object_add(json, ospf_get_name(ospf),
+					       json_vrf);
+	}
+}
+
+DEFPY (show_ip_ospf_ti_lfa_statistics,
+       show_ip_ospf_ti_lfa_statistics_cmd,
+       "show ip ospf [vrf <NAME|all>$vrf_name] ti-lfa statistics [json$uj]",
+       SHOW_STR
+       IP_STR
+       "OSPF information\n"
+       VRF_CMD_HELP_STR
+       "All VRFs\n"
+       "Topology Independent LFA\n"
+       "Per protected resource computation statistics\n"
+       JSON_STR)
+{
+	struct ospf *ospf;
+	struct listnode *node;
+	json_object *json = NULL;
+	bool all_vrf = vrf_name && strmatch(vrf_name, "all");
+
+	if (uj)
+		json = json_object_new_object();
+
+	if (all_vrf) {
+		for (ALL_LIST_ELEMENTS_RO(om->ospf, node, ospf)) {
+			if (!ospf->oi_running)
+				continue;
+			show_ip_ospf_ti_lfa_statistics_common(vty, ospf, 1,
+							      json);
+		}
+	} else {
+		if (vrf_name)
+			ospf = ospf_lookup_by_inst_name(0, vrf_name);
+		else
+			ospf = ospf_lookup_by_vrf_id(VRF_DEFAULT);
+
+		if (ospf && ospf->oi_running)
+			show_ip_ospf_ti_lfa_statistics_common(vty, ospf,
+							      !!vrf_name,
+							      json);
+		else if (!uj)
+			vty_out(vty, "%% OSPF is not enabled in vrf %s\n",
+				vrf_name ? vrf_name : VRF_DEFAULT_NAME);
+	}
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
 static int show_ip_ospf_route_common(struct vty *vty, struct ospf *ospf,
 				     json_object *json, uint8_t use_vrf)
 {
@@ -12415,6 +12571,9 @@ static int ospf_config_write_one(struct vty *vty, struct ospf *ospf)
 	if (ospf->min_ls_arrival != OSPF_MIN_LS_ARRIVAL)
 		vty_out(vty, " timers lsa min-arrival %d\n",
 			ospf->min_ls_arrival);
+	if (ospf->flood_delay != OSPF_FLOOD_DELAY_DEFAULT)
+		vty_out(vty, " timers lsa flood-delay %u\n",
+			ospf->flood_delay);
 
 	/* Write multiplier print. */
 	if (ospf->write_oi_count != OSPF_WRITE_INTERFACE_COUNT_DEFAULT)
@@ -12559,6 +12718,7 @@ void ospf_vty_show_init(void)
 	/* "show ip ospf route" commands. */
 	install_element(VIEW_NODE, &show_ip_ospf_route_cmd);
 	install_element(VIEW_NODE, &show_ip_ospf_border_routers_cmd);
+	install_element(VIEW_NODE, &show_ip_ospf_ti_lfa_statistics_cmd);
 	install_element(VIEW_NODE, &show_ip_ospf_reachable_routers_cmd);
 
 	install_element(VIEW_NODE, &show_ip_ospf_instance_route_cmd);
@@ -13060,6 +13220,7 @@ void ospf_vty_init(void)
 	install_element(OSPF_NODE, &no_ospf_timers_min_ls_interval_cmd);
 	install_element(OSPF_NODE, &ospf_timers_lsa_min_arrival_cmd);
 	install_element(OSPF_NODE, &no_ospf_timers_lsa_min_arrival_cmd);
+	install_element(OSPF_NODE, &ospf_timers_lsa_flood_delay_cmd);
 
 	/* refresh timer commands */
 	install_element(OSPF_NODE, &ospf_refresh_timer_cmd);
@@ -21,6 +21,8 @@
 #include "route_opaque.h"
 #include "lib/bfd.h"
 #include "nexthop.h"
+#include "typesafe.h"
+#include "jhash.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_interface.h"
@@ -41,6 +43,37 @@
 
 DEFINE_MTYPE_STATIC(OSPFD, OSPF_EXTERNAL, "OSPF External route table");
 DEFINE_MTYPE_STATIC(OSPFD, OSPF_REDISTRIBUTE, "OSPF Redistriute");
+DEFINE_MTYPE_STATIC(OSPFD, OSPF_SR_LSP, "OSPF SR Prefix-SID LSP");
+
+/*
+ * Prefix-SID LSPs as last sent to zebra, by input label.  Every SPF run
+ * recomputes all Prefix-SIDs, mostly to the NHLFEs they already have; those
+ * aren't sent again.
+ */
+PREDECL_HASH(ospf_sr_lsps);
+
+struct ospf_sr_lsp {
+	struct ospf_sr_lsps_item item;
+	mpls_label_t label;
+	size_t len;
+	uint8_t msg[];
+};
+
+static int ospf_sr_lsp_cmp(const struct ospf_sr_lsp *a,
+			   const struct ospf_sr_lsp *b)
+{
+	return numcmp(a->label, b->label);
+}
+
+static uint32_t ospf_sr_lsp_hash(const struct ospf_sr_lsp *lsp)
+{
+	return jhash_1word(lsp->label, 0);
+}
+
+DECLARE_HASH(ospf_sr_lsps, struct ospf_sr_lsp, item, ospf_sr_lsp_cmp,
+	     ospf_sr_lsp_hash);
+
+static struct ospf_sr_lsps_head ospf_sr_lsps[1];
 
 
 /* Zebra structure to hold current status. */
@@ -583,6 +616,50 @@ void ospf_external_del(struct ospf *ospf, uint8_t type, unsigned short instance)
 			0, &ospf->t_default_routemap_timer);
 }
 
+static struct ospf_sr_lsp *ospf_sr_lsp_find(mpls_label_t label)
+{
+	struct ospf_sr_lsp ref = { .label = label };
+
+	return ospf_sr_lsps_find(ospf_sr_lsps, &ref);
+}
+
+static void ospf_sr_lsp_forget(mpls_label_t label)
+{
+	struct ospf_sr_lsp *lsp = ospf_sr_lsp_find(label);
+
+	if (lsp) {
+		ospf_sr_lsps_del(ospf_sr_lsps, lsp);
+		XFREE(MTYPE_OSPF_SR_LSP, lsp);
+	}
+}
+
+/* Remember the encoded message in s, false if it is what was sent last */
+static bool ospf_sr_lsp_changed(mpls_label_t label, struct stream *s)
+{
+	struct ospf_sr_lsp *lsp = ospf_sr_lsp_find(label);
+	size_t len = stream_get_endp(s);
+
+	if (lsp && lsp->len == len && !memcmp(lsp->msg, STREAM_DATA(s), len))
+		return false;
+
+	ospf_sr_lsp_forget(label);
+	lsp = XMALLOC(MTYPE_OSPF_SR_LSP, sizeof(*lsp) + len);
+	lsp->label = label;
+	lsp->len = len;
+	memcpy(lsp->msg, STREAM_DATA(s), len);
+	ospf_sr_lsps_add(ospf_sr_lsps, lsp);
+	return true;
+}
+
+/* zebra lost or never had what was sent, e.g. after it restarted */
+static void ospf_sr_lsps_flush(void)
+{
+	struct ospf_sr_lsp *lsp;
+
+	while ((lsp = ospf_sr_lsps_pop(ospf_sr_lsps)))
+		XFREE(MTYPE_OSPF_SR_LSP, lsp);
+}
+
 /* Update NHLFE for Prefix SID */
 void ospf_zebra_update_prefix_sid(const struct sr_prefix *srp)
 {
@@ -693,8 +770,16 @@ void ospf_zebra_update_prefix_sid(const struct sr_prefix *srp)
 		return;
 	}
 
-	/* Finally, send message to zebra. */
-	(void)zebra_send_mpls_labels(zclient, ZEBRA_MPLS_LABELS_REPLACE, &zl);
+	/* Finally, send message to zebra, unless it has it already. */
+	if (zapi_labels_encode(zclient->obuf, ZEBRA_MPLS_LABELS_REPLACE,
+			       &zl) < 0)
+		return;
+	if (!ospf_sr_lsp_changed(zl.local_label, zclient->obuf)) {
+		osr_debug("SR (%s): Labels %u unchanged", __func__,
+			  zl.local_label);
+		return;
+	}
+	(void)zclient_send_message(zclient);
 }
 
 /* Remove NHLFE for Prefix-SID */
@@ -721,9 +806,20 @@ void ospf_zebra_delete_prefix_sid(const struct sr_prefix *srp)
 	}
 
 	/* Send message to zebra. */
+	ospf_sr_lsp_forget(zl.local_label);
 	(void)zebra_send_mpls_labels(zclient, ZEBRA_MPLS_LABELS_DELETE, &zl);
 }
 
+void ospf_zebra_sr_batch_begin(void)
+{
+	zclient_batch_begin(zclient);
+}
+
+void ospf_zebra_sr_batch_end(void)
+{
+	(void)zclient_batch_end(zclient);
+}
+
 /* Send MPLS Label entry to Zebra for installation or deletion */
 void ospf_zebra_send_adjacency_sid(int cmd, struct sr_nhlfe nhlfe)
 {
@@ -1400,16 +1496,11 @@ static int ospf_zebra_read_route(ZAPI_CALLBACK_ARGS)
 					current = ospf_external_info_find_lsa(
 						ospf, &ei->p);
 					if (!current) {
-						/* Check the
-						 * AS-external-LSA
-						 * should be
-						 * originated.
+						/* Originated in batches,
+						 * the redistribution
+						 * policy is checked then.
 						 */
-						if (!ospf_redistribute_check(
-							    ospf, ei, NULL))
-							return 0;
-
-						ospf_external_lsa_originate(
+						ospf_external_lsa_originate_queue(
 							ospf, ei);
 					} else {
 						if (IS_DEBUG_OSPF(
@@ -2061,6 +2152,8 @@ int ospf_zebra_label_manager_connect(void)
 
 static void ospf_zebra_connected(struct zclient *zclient)
 {
+	ospf_sr_lsps_flush();
+
 	/* Send the client registration */
 	bfd_client_sendmsg(zclient, ZEBRA_BFD_CLIENT_REGISTER, VRF_DEFAULT);
 
@@ -2145,6 +2238,7 @@ void ospf_zebra_init(struct event_loop *master, unsigned short instance)
 			      array_size(ospf_handlers));
 	zclient_init(zclient, ZEBRA_ROUTE_OSPF, instance, &ospfd_privs);
 	zclient->zebra_connected = ospf_zebra_connected;
+	ospf_sr_lsps_init(ospf_sr_lsps);
 
 	/* Initialize special zclient for synchronous message exchanges. */
 	struct zclient_options options = zclient_options_default;
@@ -2166,6 +2260,15 @@ void ospf_zebra_init(struct event_loop *master, unsigned short instance)
 	prefix_list_delete_hook(ospf_prefix_list_update);
 }
 
+void ospf_zebra_terminate(void)
+{
+	ospf_sr_lsps_flush();
+	ospf_sr_lsps_fini(ospf_sr_lsps);
+
+	zclient_stop(zclient);
+	zclient_free(zclient);
+}
+
 void ospf_zebra_send_arp(const struct interface *ifp, const struct prefix *p)
 {
 	zclient_send_neigh_discovery_req(zclient, ifp, p);
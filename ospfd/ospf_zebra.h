@@ -55,6 +55,9 @@ struct sr_nhlfe;
 extern void ospf_zebra_update_prefix_sid(const struct sr_prefix *srp);
 extern void ospf_zebra_delete_prefix_sid(const struct sr_prefix *srp);
 extern void ospf_zebra_send_adjacency_sid(int cmd, struct sr_nhlfe nhlfe);
+/* queue label updates between these, to send them in one go */
+extern void ospf_zebra_sr_batch_begin(void);
+extern void ospf_zebra_sr_batch_end(void);
 
 extern void ospf_external_del(struct ospf *, uint8_t, unsigned short);
 extern struct ospf_redist *ospf_redist_lookup(struct ospf *, uint8_t,
@@ -80,6 +83,7 @@ extern int ospf_distance_set(struct vty *, struct ospf *, const char *,
 extern int ospf_distance_unset(struct vty *, struct ospf *, const char *,
 			       const char *, const char *);
 extern void ospf_zebra_init(struct event_loop *m, unsigned short instance);
+extern void ospf_zebra_terminate(void);
 extern void ospf_zebra_vrf_register(struct ospf *ospf);
 extern void ospf_zebra_vrf_deregister(struct ospf *ospf);
 bool ospf_external_default_routemap_apply_walk(
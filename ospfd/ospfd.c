@@ -37,6 +37,7 @@
 #include "ospfd/ospf_neighbor.h"
 #include "ospfd/ospf_nsm.h"
 #include "ospfd/ospf_spf.h"
+#include "ospfd/ospf_ti_lfa.h"
 #include "ospfd/ospf_packet.h"
 #include "ospfd/ospf_dump.h"
 #include "ospfd/ospf_route.h"
@@ -359,6 +360,7 @@ struct ospf *ospf_new_alloc(unsigned short instance, const char *name)
 	new->new_external_route = route_table_init();
 	new->old_external_route = route_table_init();
 	new->external_lsas = route_table_init();
+	new->ase_full_required = true;
 
 	new->stub_router_startup_time = OSPF_STUB_ROUTER_UNCONFIGURED;
 	new->stub_router_shutdown_time = OSPF_STUB_ROUTER_UNCONFIGURED;
@@ -374,6 +376,7 @@ struct ospf *ospf_new_alloc(unsigned short instance, const char *name)
 	/* LSA timers */
 	new->min_ls_interval = OSPF_MIN_LS_INTERVAL;
 	new->min_ls_arrival = OSPF_MIN_LS_ARRIVAL;
+	new->flood_delay = OSPF_FLOOD_DELAY_DEFAULT;
 
 	/* SPF timer value init. */
 	new->spf_delay = OSPF_SPF_DELAY_DEFAULT;
@@ -401,6 +404,7 @@ struct ospf *ospf_new_alloc(unsigned short instance, const char *name)
 	event_add_timer(master, ospf_lsa_refresh_walker, new,
 			new->lsa_refresh_interval, &new->t_lsa_refresher);
 	new->lsa_refresher_started = monotime(NULL);
+	ospf_external_lsa_batch_init(new);
 
 	new->ibuf = stream_new(OSPF_MAX_PACKET_SIZE + 1);
 
@@ -588,6 +592,7 @@ static void ospf_deferred_shutdown_finish(struct ospf *ospf)
 	/* ospfd being shut-down? If so, was this the last ospf instance? */
 	if (CHECK_FLAG(om->options, OSPF_MASTER_SHUTDOWN)
 	    && (listcount(om->ospf) == 0)) {
+		ospf_ti_lfa_workers_finish();
 		frr_fini();
 		exit(0);
 	}
@@ -675,10 +680,10 @@ void ospf_terminate(void)
 	 * One or more ospf_finish()'s may have deferred shutdown to a timer
 	 * thread
 	 */
-	zclient_stop(zclient);
-	zclient_free(zclient);
+	ospf_zebra_terminate();
 
 done:
+	ospf_ti_lfa_workers_finish();
 	frr_fini();
 }
 
@@ -814,6 +819,7 @@ static void ospf_finish_final(struct ospf *ospf)
 	EVENT_OFF(ospf->t_default_routemap_timer);
 	EVENT_OFF(ospf->t_external_aggr);
 	EVENT_OFF(ospf->gr_info.t_grace_period);
+	ospf_external_lsa_batch_finish(ospf);
 
 	LSDB_LOOP (OPAQUE_AS_LSDB(ospf), rn, lsa)
 		ospf_discard_from_db(ospf, ospf->lsdb, lsa);
@@ -860,6 +866,7 @@ static void ospf_finish_final(struct ospf *ospf)
 	if (ospf->external_lsas) {
 		ospf_ase_external_lsas_finish(ospf->external_lsas);
 	}
+	ospf_ase_changes_free(ospf);
 
 	for (i = ZEBRA_ROUTE_SYSTEM; i <= ZEBRA_ROUTE_MAX; i++) {
 		struct list *ext_list;
@@ -1005,6 +1012,9 @@ static void ospf_area_free(struct ospf_area *area)
 
 	ospf_lsa_unlock(&area->router_lsa_self);
 
+	ospf_spf_saved_free(area);
+	ospf_ti_lfa_stats_free(area);
+
 	route_table_finish(area->ranges);
 	list_delete(&area->oiflist);
 
@@ -1509,6 +1519,9 @@ static void ospf_area_type_set(struct ospf_area *area, int type)
 
 	area->external_routing = type;
 
+	/* Changes which NSSA LSAs are considered. */
+	area->ospf->ase_full_required = true;
+
 	if (IS_DEBUG_OSPF_EVENT)
 		zlog_debug("Area[%pI4]: Configured as %s",
 			   &area->area_id,
@@ -148,6 +148,10 @@ struct ospf_gr_info {
 	struct event *t_grace_period;
 };
 
+/* AS-external-LSAs waiting to be originated, see ospf_lsa.c */
+PREDECL_HASH(ospf_ext_pending);
+PREDECL_DLIST(ospf_ext_order);
+
 /* OSPF instance structure. */
 struct ospf {
 	/* OSPF's running state based on the '[no] router ospf [<instance>]'
@@ -203,6 +207,8 @@ struct ospf {
 	unsigned int min_ls_interval; /* minimum delay between LSAs (in msec) */
 	unsigned int min_ls_arrival;  /* minimum interarrival time between LSAs
 					 (in msec) */
+	unsigned int flood_delay; /* LS Update coalescing window (in msec) */
+#define OSPF_FLOOD_DELAY_DEFAULT 0
 
 	/* SPF parameters */
 	unsigned int spf_delay;	/* SPF delay time. */
@@ -211,6 +217,13 @@ struct ospf {
 	unsigned int
 		spf_hold_multiplier; /* Adaptive multiplier for hold time */
 
+	/* Set when the pending SPF run can't reuse the saved SPF trees. */
+	bool spf_full_required;
+
+	/* SPF statistics (full Dijkstra runs vs. partial recalculations). */
+	uint32_t spf_full_runs;
+	uint32_t spf_partial_runs;
+
 	int default_originate;	/* Default information originate. */
 #define DEFAULT_ORIGINATE_NONE		0
 #define DEFAULT_ORIGINATE_ZEBRA		1
@@ -231,6 +244,19 @@ struct ospf {
 	/* Flags. */
 	int ase_calc;	/* ASE calculation flag. */
 
+	/*
+	 * Network and ASBR routes that changed since the last ASE calculation,
+	 * only the external routes depending on them are recalculated unless
+	 * ase_full_required is set. See ospf_ase.c.
+	 */
+	bool ase_full_required;
+	struct route_table *ase_changed_routes;
+	struct route_table *ase_changed_asbrs;
+
+	/* ASE statistics (full vs. incremental calculations). */
+	uint32_t ase_full_runs;
+	uint32_t ase_incremental_runs;
+
 	struct list *opaque_lsa_self; /* Type-11 Opaque-LSAs */
 
 	/* Routing tables. */
@@ -317,6 +343,13 @@ struct ospf {
 #define OSPF_LSA_REFRESH_INTERVAL_DEFAULT 10
 	uint16_t lsa_refresh_interval;
 	uint16_t lsa_refresh_timer;
+	/* extra seconds to spread the refresh of LSAs being originated */
+	uint16_t lsa_refresh_spread;
+
+	/* Redistributed routes whose AS-external-LSA is yet to be built. */
+	struct ospf_ext_pending_head ext_pending;
+	struct ospf_ext_order_head ext_order;
+	struct event *t_external_lsa_batch;
 
 	/* Distance parameter. */
 	uint8_t distance_all;
@@ -565,6 +598,10 @@ struct ospf_area {
 	struct vertex *spf;
 	struct list *spf_vertex_list;
 
+	/* SPT of the last full run, reused for partial route calculation. */
+	struct vertex *spf_saved;
+	struct list *spf_saved_vertex_list;
+
 	bool spf_dry_run;   /* flag for checking if the SPF calculation is
 			       intended for the local RIB */
 	bool spf_root_node; /* flag for checking if the calculating node is the
@@ -586,6 +623,17 @@ struct ospf_area {
 	/* reverse SPF (used for TI-LFA Q spaces) */
 	bool spf_reversed;
 
+	/*
+	 * For SPF calculations running concurrently on TI-LFA workers: a
+	 * read-only index of the router and network LSAs of the area, and the
+	 * per-calculation candidate state otherwise kept in lsa->stat.
+	 */
+	struct hash *spf_lsdb_snapshot;
+	struct hash *spf_lsa_stat;
+
+	/* TI-LFA computation statistics. */
+	struct ospf_ti_lfa_stats *ti_lfa_stats;
+
 	/* Time stamps. */
 	struct timeval ts_spf; /* SPF calculation time stamp. */
 
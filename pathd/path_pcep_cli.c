@@ -1194,6 +1194,17 @@ static void print_pcep_session(struct vty *vty, struct pce_opts *pce_opts,
 	vty_out(vty, " Next PcReq ID %d\n", pcc_info->next_reqid);
 	vty_out(vty, " Next PLSP  ID %d\n", pcc_info->next_plspid);
 
+	if (pcc_info->status == PCEP_PCC_SYNCHRONIZING)
+		vty_out(vty,
+			" Synchronizing for %u ms, %u LSPs in %u PCRpt messages\n",
+			pcc_info->sync_duration_ms, pcc_info->sync_lsps,
+			pcc_info->sync_msgs);
+	else if (pcc_info->status == PCEP_PCC_OPERATING)
+		vty_out(vty,
+			" Synchronized in %u ms, %u LSPs in %u PCRpt messages\n",
+			pcc_info->sync_duration_ms, pcc_info->sync_lsps,
+			pcc_info->sync_msgs);
+
 	if (session != NULL) {
 		if (pcc_info->status == PCEP_PCC_SYNCHRONIZING
 		    || pcc_info->status == PCEP_PCC_OPERATING) {
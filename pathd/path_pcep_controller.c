@@ -40,6 +40,7 @@ enum pcep_ctrl_event_type {
 };
 
 struct pcep_ctrl_event_data {
+	struct pcep_ctrl_events_item item;
 	struct ctrl_state *ctrl_state;
 	enum pcep_ctrl_event_type type;
 	uint32_t sub_type;
@@ -47,6 +48,8 @@ struct pcep_ctrl_event_data {
 	void *payload;
 };
 
+DECLARE_LIST(pcep_ctrl_events, struct pcep_ctrl_event_data, item);
+
 struct pcep_main_event_data {
 	pcep_main_event_handler_t handler;
 	int pcc_id;
@@ -111,6 +114,7 @@ static int send_to_thread_with_cb(struct ctrl_state *ctrl_state, int pcc_id,
 				  uint32_t sub_type, void *payload,
 				  pcep_ctrl_thread_callback event_cb);
 static void pcep_thread_event_handler(struct event *thread);
+static void pcep_thread_event_process(struct pcep_ctrl_event_data *data);
 static int pcep_thread_event_update_pcc_options(struct ctrl_state *ctrl_state,
 						struct pcc_opts *opts);
 static int pcep_thread_event_update_pce_options(struct ctrl_state *ctrl_state,
@@ -186,6 +190,8 @@ int pcep_ctrl_initialize(struct event_loop *main_thread,
 	ctrl_state->main = main_thread;
 	ctrl_state->self = (*fpt)->master;
 	ctrl_state->main_event_handler = event_handler;
+	pthread_mutex_init(&ctrl_state->event_mtx, NULL);
+	pcep_ctrl_events_init(&ctrl_state->event_queue);
 	ctrl_state->pcc_count = 0;
 	ctrl_state->pcc_last_id = 0;
 	ctrl_state->pcc_opts =
@@ -508,6 +514,16 @@ void pcep_thread_finish_event_handler(struct event *thread)
 		}
 	}
 
+	/* Events still queued are dropped, as they were before queuing */
+	struct pcep_ctrl_event_data *data;
+
+	frr_with_mutex (&ctrl_state->event_mtx) {
+		while ((data = pcep_ctrl_events_pop(&ctrl_state->event_queue)))
+			XFREE(MTYPE_PCEP, data);
+	}
+	pcep_ctrl_events_fini(&ctrl_state->event_queue);
+	pthread_mutex_destroy(&ctrl_state->event_mtx);
+
 	XFREE(MTYPE_PCEP, ctrl_state->pcc_opts);
 	XFREE(MTYPE_PCEP, ctrl_state);
 	fpt->data = NULL;
@@ -694,6 +710,7 @@ int send_to_thread_with_cb(struct ctrl_state *ctrl_state, int pcc_id,
 			   void *payload, pcep_ctrl_thread_callback event_cb)
 {
 	struct pcep_ctrl_event_data *data;
+	bool schedule;
 
 	data = XCALLOC(MTYPE_PCEP, sizeof(*data));
 	data->ctrl_state = ctrl_state;
@@ -702,15 +719,51 @@ int send_to_thread_with_cb(struct ctrl_state *ctrl_state, int pcc_id,
 	data->pcc_id = pcc_id;
 	data->payload = payload;
 
-	event_add_event(ctrl_state->self, event_cb, (void *)data, 0, NULL);
+	if (event_cb != pcep_thread_event_handler) {
+		event_add_event(ctrl_state->self, event_cb, (void *)data, 0,
+				NULL);
+		return 0;
+	}
+
+	/*
+	 * Events for the default handler are queued, and only the first one
+	 * wakes the controller thread up.  A full synchronization posts one
+	 * event per candidate path, this saves a cross-thread event each.
+	 */
+	frr_with_mutex (&ctrl_state->event_mtx) {
+		pcep_ctrl_events_add_tail(&ctrl_state->event_queue, data);
+		schedule = !ctrl_state->event_scheduled;
+		ctrl_state->event_scheduled = true;
+	}
+
+	if (schedule)
+		event_add_event(ctrl_state->self, pcep_thread_event_handler,
+				(void *)ctrl_state, 0, NULL);
 
 	return 0;
 }
 
 void pcep_thread_event_handler(struct event *thread)
+{
+	struct ctrl_state *ctrl_state = EVENT_ARG(thread);
+	struct pcep_ctrl_events_head events;
+	struct pcep_ctrl_event_data *data;
+
+	pcep_ctrl_events_init(&events);
+	frr_with_mutex (&ctrl_state->event_mtx) {
+		pcep_ctrl_events_swap_all(&events, &ctrl_state->event_queue);
+		ctrl_state->event_scheduled = false;
+	}
+
+	while ((data = pcep_ctrl_events_pop(&events)))
+		pcep_thread_event_process(data);
+
+	pcep_ctrl_events_fini(&events);
+}
+
+void pcep_thread_event_process(struct pcep_ctrl_event_data *data)
 {
 	/* data unpacking */
-	struct pcep_ctrl_event_data *data = EVENT_ARG(thread);
 	assert(data != NULL);
 	struct ctrl_state *ctrl_state = data->ctrl_state;
 	assert(ctrl_state != NULL);
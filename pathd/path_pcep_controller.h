@@ -6,11 +6,14 @@
 #ifndef _PATH_PCEP_CONTROLLER_H_
 #define _PATH_PCEP_CONTROLLER_H_
 
+#include "typesafe.h"
 #include "pathd/path_pcep.h"
 
 struct ctrl_state;
 struct pcc_state;
 
+PREDECL_LIST(pcep_ctrl_events);
+
 enum pcep_main_event_type {
 	PCEP_MAIN_EVENT_UNDEFINED = 0,
 	PCEP_MAIN_EVENT_START_SYNC,
@@ -40,6 +43,11 @@ struct ctrl_state {
 	int pcc_count;
 	int pcc_last_id;
 	struct pcc_state *pcc[MAX_PCC];
+	/* Events posted to the controller thread, handled by a single event
+	 * however many are queued */
+	pthread_mutex_t event_mtx;
+	struct pcep_ctrl_events_head event_queue;
+	bool event_scheduled;
 };
 
 /* Timer handling data structures */
@@ -94,6 +102,10 @@ struct pcep_pcc_info {
 	bool is_best_multi_pce;
 	bool previous_best;
 	uint8_t precedence;
+	/* Initial synchronization, the ongoing one or the last */
+	uint32_t sync_duration_ms;
+	uint32_t sync_lsps;
+	uint32_t sync_msgs;
 };
 
 /* Functions called from the main thread */
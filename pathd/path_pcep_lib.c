@@ -316,6 +316,39 @@ struct pcep_message *pcep_lib_format_report(struct pcep_caps *caps,
 	return pcep_msg_create_report(objs);
 }
 
+/* Appends the state report of a path to a list of them, which can be sent
+ * as a single PCRpt message (RFC 8231 section 6.1).  A NULL list is created.
+ */
+double_linked_list *pcep_lib_append_report(struct pcep_caps *caps,
+					   struct path *path,
+					   double_linked_list *reports)
+{
+	double_linked_list *objs = pcep_lib_format_path(caps, path);
+	double_linked_list_node *node;
+
+	if (reports == NULL)
+		reports = dll_initialize();
+	for (node = objs->head; node != NULL; node = node->next_node)
+		dll_append(reports, node->data);
+	dll_destroy(objs);
+
+	return reports;
+}
+
+struct pcep_message *pcep_lib_format_report_list(double_linked_list *reports)
+{
+	return pcep_msg_create_report(reports);
+}
+
+void pcep_lib_free_report_list(double_linked_list *reports)
+{
+	double_linked_list_node *node;
+
+	for (node = reports->head; node != NULL; node = node->next_node)
+		pcep_obj_free_object(node->data);
+	dll_destroy(reports);
+}
+
 static struct pcep_object_rp *create_rp(uint32_t reqid)
 {
 	double_linked_list *rp_tlvs;
@@ -82,6 +82,8 @@ static void send_pcep_error(struct pcc_state *pcc_state,
 			    enum pcep_error_value error_value,
 			    struct path *trigger_path);
 static void send_report(struct pcc_state *pcc_state, struct path *path);
+static void queue_sync_report(struct pcc_state *pcc_state, struct path *path);
+static void flush_sync_reports(struct pcc_state *pcc_state);
 static void send_comp_request(struct ctrl_state *ctrl_state,
 			      struct pcc_state *pcc_state,
 			      struct req_entry *req);
@@ -427,6 +429,11 @@ int pcep_pcc_disable(struct ctrl_state *ctrl_state, struct pcc_state *pcc_state)
 	case PCEP_PCC_OPERATING:
 		PCEP_DEBUG("%s Disconnecting PCC...", pcc_state->tag);
 		cancel_comp_requests(ctrl_state, pcc_state);
+		if (pcc_state->sync_reports) {
+			pcep_lib_free_report_list(pcc_state->sync_reports);
+			pcc_state->sync_reports = NULL;
+			pcc_state->sync_report_count = 0;
+		}
 		pcep_lib_disconnect(pcc_state->sess);
 		/* No need to remove if any PCEs is connected */
 		if (get_pce_count_connected(ctrl_state->pcc) == 0) {
@@ -472,7 +479,10 @@ void pcep_pcc_sync_path(struct ctrl_state *ctrl_state,
 		if (filter_path(pcc_state, path)) {
 			PCEP_DEBUG("%s Synchronizing path %s", pcc_state->tag,
 				   path->name);
-			send_report(pcc_state, path);
+			if (pcc_state->status == PCEP_PCC_SYNCHRONIZING)
+				queue_sync_report(pcc_state, path);
+			else
+				send_report(pcc_state, path);
 		} else {
 			PCEP_DEBUG(
 				"%s Skipping %s candidate path %s synchronization",
@@ -492,6 +502,8 @@ void pcep_pcc_sync_done(struct ctrl_state *ctrl_state,
 	    && pcc_state->status != PCEP_PCC_OPERATING)
 		return;
 
+	flush_sync_reports(pcc_state);
+
 	if (pcc_state->caps.is_stateful
 	    && pcc_state->status == PCEP_PCC_SYNCHRONIZING) {
 		struct path *path = pcep_new_path();
@@ -511,10 +523,16 @@ void pcep_pcc_sync_done(struct ctrl_state *ctrl_state,
 		pcep_free_path(path);
 	}
 
+	if (pcc_state->status == PCEP_PCC_SYNCHRONIZING)
+		pcc_state->sync_duration_ms =
+			monotime_since(&pcc_state->sync_start, NULL) / 1000;
+
 	pcc_state->synchronized = true;
 	pcc_state->status = PCEP_PCC_OPERATING;
 
-	PCEP_DEBUG("%s Synchronization done", pcc_state->tag);
+	PCEP_DEBUG("%s Synchronization done, %u LSPs in %u messages, %u ms",
+		   pcc_state->tag, pcc_state->sync_lsps, pcc_state->sync_msgs,
+		   pcc_state->sync_duration_ms);
 
 	/* Start the computation request accumulated during synchronization */
 	RB_FOREACH (req, req_entry_head, &pcc_state->requests) {
@@ -686,6 +704,10 @@ void pcep_pcc_pcep_event_handler(struct ctrl_state *ctrl_state,
 		pcc_state->status = PCEP_PCC_SYNCHRONIZING;
 		pcc_state->retry_count = 0;
 		pcc_state->synchronized = false;
+		monotime(&pcc_state->sync_start);
+		pcc_state->sync_duration_ms = 0;
+		pcc_state->sync_lsps = 0;
+		pcc_state->sync_msgs = 0;
 		PCEP_DEBUG("%s Starting PCE synchronization", pcc_state->tag);
 		cancel_session_timeout(ctrl_state, pcc_state);
 		pcep_pcc_calculate_best_pce(ctrl_state->pcc);
@@ -1120,6 +1142,13 @@ void pcep_pcc_copy_pcc_info(struct pcc_state **pcc,
 	}
 	pcc_info->next_plspid = pcc_state->next_plspid;
 	pcc_info->next_reqid = pcc_state->next_reqid;
+	if (pcc_state->status == PCEP_PCC_SYNCHRONIZING)
+		pcc_info->sync_duration_ms =
+			monotime_since(&pcc_state->sync_start, NULL) / 1000;
+	else
+		pcc_info->sync_duration_ms = pcc_state->sync_duration_ms;
+	pcc_info->sync_lsps = pcc_state->sync_lsps;
+	pcc_info->sync_msgs = pcc_state->sync_msgs;
 	pcc_info->status = pcc_state->status;
 	pcc_info->pcc_id = pcc_state->id;
 	pthread_mutex_lock(&g_pcc_info_mtx);
@@ -1593,6 +1622,38 @@ void send_report(struct pcc_state *pcc_state, struct path *path)
 	send_pcep_message(pcc_state, report);
 }
 
+/*
+ * During the initial synchronization, the state reports are not sent one
+ * PCRpt each but several LSPs to a message, RFC 8231 allows a list of them.
+ */
+void queue_sync_report(struct pcc_state *pcc_state, struct path *path)
+{
+	path->req_id = 0;
+	specialize_outgoing_path(pcc_state, path);
+	PCEP_DEBUG_PATH("%s Queuing path %s: %s", pcc_state->tag, path->name,
+			format_path(path));
+	pcc_state->sync_reports = pcep_lib_append_report(
+		&pcc_state->caps, path, pcc_state->sync_reports);
+	pcc_state->sync_lsps++;
+
+	if (++pcc_state->sync_report_count >= PCEP_MAX_SYNC_REPORTS)
+		flush_sync_reports(pcc_state);
+}
+
+void flush_sync_reports(struct pcc_state *pcc_state)
+{
+	struct pcep_message *report;
+
+	if (pcc_state->sync_reports == NULL)
+		return;
+
+	report = pcep_lib_format_report_list(pcc_state->sync_reports);
+	pcc_state->sync_reports = NULL;
+	pcc_state->sync_report_count = 0;
+	pcc_state->sync_msgs++;
+	send_pcep_message(pcc_state, report);
+}
+
 /* Updates the path for the PCE, updating the delegation and creation flags */
 void specialize_outgoing_path(struct pcc_state *pcc_state, struct path *path)
 {
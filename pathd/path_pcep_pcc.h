@@ -17,6 +17,10 @@ enum pcc_status {
 	PCEP_PCC_OPERATING
 };
 
+/* LSPs per PCRpt message during the initial synchronization; that keeps
+ * the message well below the 64K PCEP limit even with long EROs */
+#define PCEP_MAX_SYNC_REPORTS 32
+
 PREDECL_HASH(plspid_map);
 PREDECL_HASH(nbkey_map);
 PREDECL_HASH(req_map);
@@ -66,6 +70,14 @@ struct pcc_state {
 	pcep_session *sess;
 	uint32_t retry_count;
 	bool synchronized;
+	/* State reports of the initial synchronization not sent yet */
+	double_linked_list *sync_reports;
+	uint32_t sync_report_count;
+	/* Initial synchronization metrics, duration of the last one */
+	struct timeval sync_start;
+	uint32_t sync_duration_ms;
+	uint32_t sync_lsps;
+	uint32_t sync_msgs;
 	struct event *t_reconnect;
 	struct event *t_update_best;
 	struct event *t_session_timeout;
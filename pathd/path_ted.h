@@ -99,6 +99,7 @@ void path_ted_show_debugging(struct vty *vty);
 #define LS_MSG_EVENT_PRINT(event) event == LS_MSG_EVENT_ADD?"add"\
 		    : event == LS_MSG_EVENT_DELETE?"del"\
 		    : event == LS_MSG_EVENT_UPDATE?"upd"\
+		    : event == LS_MSG_EVENT_DELTA?"dlt"\
 		    : event == LS_MSG_EVENT_SYNC?"syn"\
 		    : event == LS_MSG_EVENT_SYNC?"und" : "none"
 #define LS_MSG_TYPE_PRINT(type) type == LS_MSG_TYPE_NODE?"node"\
@@ -668,34 +668,57 @@ bool pbr_map_check_valid(const char *name)
 	return pbrm->valid;
 }
 
+/* Whether a sequence uses the given nexthop-group, configured or internal */
+static bool pbr_map_sequence_uses_nhg(const struct pbr_map_sequence *pbrms,
+				      const char *nh_group)
+{
+	if (pbrms->nhgrp_name && !strcmp(nh_group, pbrms->nhgrp_name))
+		return true;
+	if (pbrms->nhg && !strcmp(nh_group, pbrms->internal_nhg_name))
+		return true;
+	return false;
+}
+
+static void pbr_map_check_sequence(struct pbr_map_sequence *pbrms,
+				   bool changed);
+
+/*
+ * Only the sequences using the nexthop-group are touched, and the map
+ * they belong to is validated once rather than once per sequence.
+ */
 void pbr_map_schedule_policy_from_nhg(const char *nh_group, bool installed)
 {
 	struct pbr_map_sequence *pbrms;
 	struct pbr_map *pbrm;
 	struct listnode *node;
+	bool found;
+
+	pbr_zebra_stats.nhg_changes++;
 
 	RB_FOREACH (pbrm, pbr_map_entry_head, &pbr_maps) {
 		DEBUGD(&pbr_dbg_map, "%s: Looking at %s", __func__, pbrm->name);
+		found = false;
 		for (ALL_LIST_ELEMENTS_RO(pbrm->seqnumbers, node, pbrms)) {
 			DEBUGD(&pbr_dbg_map, "    NH Grp name: %s",
 			       pbrms->nhgrp_name ?
 			       pbrms->nhgrp_name : pbrms->internal_nhg_name);
 
-			if (pbrms->nhgrp_name
-			    && (strcmp(nh_group, pbrms->nhgrp_name) == 0)) {
+			if (pbr_map_sequence_uses_nhg(pbrms, nh_group)) {
 				pbrms->nhs_installed = installed;
-
-				pbr_map_check(pbrms, false);
+				found = true;
 			}
+		}
 
-			if (pbrms->nhg
-			    && (strcmp(nh_group, pbrms->internal_nhg_name)
-				== 0)) {
-				pbrms->nhs_installed = installed;
+		if (!found)
+			continue;
 
-				pbr_map_check(pbrms, false);
+		pbr_map_check_valid_internal(pbrm);
+
+		for (ALL_LIST_ELEMENTS_RO(pbrm->seqnumbers, node, pbrms))
+			if (pbr_map_sequence_uses_nhg(pbrms, nh_group)) {
+				pbr_zebra_stats.nhg_change_seqs++;
+				pbr_map_check_sequence(pbrms, false);
 			}
-		}
 	}
 }
 
@@ -763,40 +786,47 @@ void pbr_map_check_nh_group_change(const char *nh_group)
 	struct pbr_map *pbrm;
 	struct listnode *node, *inode;
 	struct pbr_map_interface *pmi;
-	bool found_name;
+	struct nexthop_group_cmd *nhgc = NULL;
+	bool found, original;
+
+	pbr_zebra_stats.nhg_changes++;
 
 	RB_FOREACH (pbrm, pbr_map_entry_head, &pbr_maps) {
+		found = false;
 		for (ALL_LIST_ELEMENTS_RO(pbrm->seqnumbers, node, pbrms)) {
-			found_name = false;
-			if (pbrms->nhgrp_name)
-				found_name =
-					!strcmp(nh_group, pbrms->nhgrp_name);
-			else if (pbrms->nhg)
-				found_name = !strcmp(nh_group,
-						     pbrms->internal_nhg_name);
-
-			if (found_name) {
-				bool original = pbrm->valid;
-
-				/* Set data we were waiting on */
-				if (pbrms->nhgrp_name)
-					pbr_nht_set_seq_nhg_data(
-						pbrms,
-						nhgc_find(pbrms->nhgrp_name));
-
-				pbr_map_check_valid_internal(pbrm);
-
-				if (pbrm->valid && (original != pbrm->valid))
-					pbr_map_install(pbrm);
-
-				if (pbrm->valid == false)
-					for (ALL_LIST_ELEMENTS_RO(
-						     pbrm->incoming, inode,
-						     pmi))
-						pbr_send_pbr_map(pbrms, pmi,
-								 false, false);
+			if (!pbr_map_sequence_uses_nhg(pbrms, nh_group))
+				continue;
+
+			found = true;
+			pbr_zebra_stats.nhg_change_seqs++;
+
+			/* Set data we were waiting on */
+			if (pbrms->nhgrp_name &&
+			    !strcmp(nh_group, pbrms->nhgrp_name)) {
+				if (!nhgc)
+					nhgc = nhgc_find(nh_group);
+				pbr_nht_set_seq_nhg_data(pbrms, nhgc);
 			}
 		}
+
+		if (!found)
+			continue;
+
+		original = pbrm->valid;
+		pbr_map_check_valid_internal(pbrm);
+
+		if (pbrm->valid && (original != pbrm->valid))
+			pbr_map_install(pbrm);
+
+		if (pbrm->valid)
+			continue;
+
+		for (ALL_LIST_ELEMENTS_RO(pbrm->seqnumbers, node, pbrms))
+			if (pbr_map_sequence_uses_nhg(pbrms, nh_group))
+				for (ALL_LIST_ELEMENTS_RO(pbrm->incoming, inode,
+							  pmi))
+					pbr_send_pbr_map(pbrms, pmi, false,
+							 false);
 	}
 }
 
@@ -861,18 +891,13 @@ void pbr_map_check_interface_nh_group_change(const char *nh_group,
 	}
 }
 
-void pbr_map_check(struct pbr_map_sequence *pbrms, bool changed)
+/* Installs or removes a sequence according to its last validation */
+static void pbr_map_check_sequence(struct pbr_map_sequence *pbrms,
+				   bool changed)
 {
-	struct pbr_map *pbrm;
+	struct pbr_map *pbrm = pbrms->parent;
 	bool install;
 
-	pbrm = pbrms->parent;
-	DEBUGD(&pbr_dbg_map, "%s: for %s(%u)", __func__, pbrm->name,
-	       pbrms->seqno);
-	if (pbr_map_check_valid(pbrm->name))
-		DEBUGD(&pbr_dbg_map, "We are totally valid %s",
-		       pbrm->name);
-
 	if (pbrms->reason == PBR_MAP_VALID_SEQUENCE_NUMBER) {
 		install = true;
 		DEBUGD(&pbr_dbg_map, "%s: Installing %s(%u) reason: %" PRIu64,
@@ -891,6 +916,20 @@ void pbr_map_check(struct pbr_map_sequence *pbrms, bool changed)
 		pbr_map_pbrms_uninstall(pbrms);
 }
 
+void pbr_map_check(struct pbr_map_sequence *pbrms, bool changed)
+{
+	struct pbr_map *pbrm;
+
+	pbrm = pbrms->parent;
+	DEBUGD(&pbr_dbg_map, "%s: for %s(%u)", __func__, pbrm->name,
+	       pbrms->seqno);
+	if (pbr_map_check_valid(pbrm->name))
+		DEBUGD(&pbr_dbg_map, "We are totally valid %s",
+		       pbrm->name);
+
+	pbr_map_check_sequence(pbrms, changed);
+}
+
 void pbr_map_install(struct pbr_map *pbrm)
 {
 	struct pbr_map_sequence *pbrms;
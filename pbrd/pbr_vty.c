@@ -830,6 +830,14 @@ DEFPY (show_pbr,
 	pbr_nht_write_table_range(vty);
 	pbr_nht_write_rule_range(vty);
 
+	vty_out(vty, "Rules installed %" PRIu64 ", deleted %" PRIu64
+		", in %" PRIu64 " zebra messages\n",
+		pbr_zebra_stats.rules_installed, pbr_zebra_stats.rules_deleted,
+		pbr_zebra_stats.rule_msgs);
+	vty_out(vty, "Nexthop-group changes %" PRIu64 ", sequences updated %"
+		PRIu64 "\n",
+		pbr_zebra_stats.nhg_changes, pbr_zebra_stats.nhg_change_seqs);
+
 	return CMD_SUCCESS;
 }
 
@@ -33,6 +33,22 @@ DEFINE_MTYPE_STATIC(PBRD, PBR_INTERFACE, "PBR Interface");
 /* Zebra structure to hold current status. */
 struct zclient *zclient;
 
+struct pbr_zebra_stats pbr_zebra_stats;
+
+/*
+ * Rules are not sent one message each.  Consecutive rule installs (or
+ * deletes) are encoded into the same ZEBRA_RULE_ADD (or _DELETE) message,
+ * which goes out when the command changes, when it is full, or at the end
+ * of the current event.  Zebra hands each rule to the dataplane on its own
+ * anyway, where they are batched into netlink messages.
+ */
+#define PBR_RULE_ENCODE_MAX 256
+
+static struct stream *pbr_rule_obuf;
+static uint16_t pbr_rule_cmd;
+static uint32_t pbr_rule_count;
+static struct event *t_pbr_rule_flush;
+
 struct pbr_interface *pbr_if_new(struct interface *ifp)
 {
 	struct pbr_interface *pbr_ifp;
@@ -437,6 +453,8 @@ void pbr_zebra_init(void)
 
 	zclient_init(zclient, ZEBRA_ROUTE_PBR, 0, &pbr_privs);
 	zclient->zebra_connected = zebra_connected;
+
+	pbr_rule_obuf = stream_new(ZEBRA_MAX_PACKET_SIZ);
 }
 
 void pbr_send_rnh(struct nexthop *nhop, bool reg)
@@ -552,11 +570,41 @@ static void pbr_encode_pbr_map_sequence(struct stream *s,
 	stream_put(s, ifp->name, INTERFACE_NAMSIZ);
 }
 
+static void pbr_send_rules(void)
+{
+	struct stream *s = pbr_rule_obuf;
+
+	EVENT_OFF(t_pbr_rule_flush);
+	if (!pbr_rule_count)
+		return;
+
+	/* count of rules, right after the header */
+	stream_putl_at(s, ZEBRA_HEADER_SIZE, pbr_rule_count);
+	stream_putw_at(s, 0, stream_get_endp(s));
+
+	DEBUGD(&pbr_dbg_zebra, "%s: %s %u rules", __func__,
+	       pbr_rule_cmd == ZEBRA_RULE_ADD ? "Installing" : "Deleting",
+	       pbr_rule_count);
+
+	stream_copy(zclient->obuf, s);
+	stream_reset(s);
+	pbr_rule_count = 0;
+
+	zclient_send_message(zclient);
+	pbr_zebra_stats.rule_msgs++;
+}
+
+static void pbr_send_rules_event(struct event *thread)
+{
+	pbr_send_rules();
+}
+
 bool pbr_send_pbr_map(struct pbr_map_sequence *pbrms,
 		      struct pbr_map_interface *pmi, bool install, bool changed)
 {
 	struct pbr_map *pbrm = pbrms->parent;
-	struct stream *s;
+	struct stream *s = pbr_rule_obuf;
+	uint16_t cmd = install ? ZEBRA_RULE_ADD : ZEBRA_RULE_DELETE;
 	uint64_t is_installed = (uint64_t)1 << pmi->install_bit;
 
 	is_installed &= pbrms->installed;
@@ -577,27 +625,31 @@ bool pbr_send_pbr_map(struct pbr_map_sequence *pbrms,
 	if (!install && !is_installed)
 		return false;
 
-	s = zclient->obuf;
-	stream_reset(s);
-
-	zclient_create_header(s,
-			      install ? ZEBRA_RULE_ADD : ZEBRA_RULE_DELETE,
-			      VRF_DEFAULT);
+	if (pbr_rule_count && (pbr_rule_cmd != cmd ||
+			       STREAM_WRITEABLE(s) < PBR_RULE_ENCODE_MAX))
+		pbr_send_rules();
 
-	/*
-	 * We are sending one item at a time at the moment
-	 */
-	stream_putl(s, 1);
+	if (!pbr_rule_count) {
+		zclient_create_header(s, cmd, VRF_DEFAULT);
+		/* number of rules, filled in when sending */
+		stream_putl(s, 0);
+		pbr_rule_cmd = cmd;
+	}
 
 	DEBUGD(&pbr_dbg_zebra, "%s:    %s %s seq %u %d %s %u", __func__,
 	       install ? "Installing" : "Deleting", pbrm->name, pbrms->seqno,
 	       install, pmi->ifp->name, pmi->delete);
 
 	pbr_encode_pbr_map_sequence(s, pbrms, pmi->ifp);
+	pbr_rule_count++;
 
-	stream_putw_at(s, 0, stream_get_endp(s));
+	if (install)
+		pbr_zebra_stats.rules_installed++;
+	else
+		pbr_zebra_stats.rules_deleted++;
 
-	zclient_send_message(zclient);
+	event_add_event(master, pbr_send_rules_event, NULL, 0,
+			&t_pbr_rule_flush);
 
 	return true;
 }
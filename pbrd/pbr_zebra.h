@@ -13,6 +13,19 @@ struct pbr_interface {
 
 extern struct event_loop *master;
 
+/* Rule programming counters, shown by "show pbr" */
+struct pbr_zebra_stats {
+	uint64_t rules_installed;
+	uint64_t rules_deleted;
+	/* ZEBRA_RULE_ADD/DELETE messages carrying the above */
+	uint64_t rule_msgs;
+	/* nexthop-group changes, and the sequences they touched */
+	uint64_t nhg_changes;
+	uint64_t nhg_change_seqs;
+};
+
+extern struct pbr_zebra_stats pbr_zebra_stats;
+
 extern void pbr_zebra_init(void);
 
 extern void route_add(struct pbr_nexthop_group_cache *pnhgc,
@@ -28,6 +28,18 @@
 #include "pcep_utils_logging.h"
 #include "pcep_utils_memory.h"
 
+#ifndef thread_local
+#define thread_local __thread
+#endif
+
+/* Messages are encoded into this buffer and then copied once into an exactly
+ * sized allocation.  The encoders rely on it being zeroed for padding and
+ * reserved fields, but only the part the previous message used is cleared,
+ * so small messages like keepalives don't pay for all of the 64k.
+ */
+static thread_local uint8_t encode_buffer[PCEP_MESSAGE_LENGTH];
+static thread_local uint32_t encode_buffer_used;
+
 #define ANY_OBJECT 0
 #define NO_OBJECT -1
 #define NUM_CHECKED_OBJECTS 4
@@ -65,6 +77,23 @@ static const enum pcep_object_classes MANDATORY_MESSAGE_OBJECT_CLASSES[13][4] =
 		 ANY_OBJECT}, /* PCEP_TYPE_INITIATE = 12 */
 };
 
+static void rebase_encoded_object(struct pcep_object_header *obj,
+				  const uint8_t *from, const uint8_t *to)
+{
+	double_linked_list_node *node;
+	struct pcep_object_tlv_header *tlv;
+
+	if (obj->encoded_object != NULL)
+		obj->encoded_object = to + (obj->encoded_object - from);
+
+	node = (obj->tlv_list == NULL ? NULL : obj->tlv_list->head);
+	for (; node != NULL; node = node->next_node) {
+		tlv = node->data;
+		if (tlv->encoded_tlv != NULL)
+			tlv->encoded_tlv = to + (tlv->encoded_tlv - from);
+	}
+}
+
 /* PCEP Message Common Header, According to RFC 5440
  *
  *   0                   1                   2                   3
@@ -90,10 +119,9 @@ void pcep_encode_message(struct pcep_message *message,
 		return;
 	}
 
-	/* Internal buffer used for the entire message. Later, once the entire
-	 * length is known, memory will be allocated and this buffer will be
-	 * copied. */
-	uint8_t message_buffer[PCEP_MESSAGE_LENGTH] = {0};
+	uint8_t *message_buffer = encode_buffer;
+
+	memset(message_buffer, 0, encode_buffer_used);
 
 	/* Write the message header. The message header length will be
 	 * written when the entire length is known. */
@@ -102,26 +130,15 @@ void pcep_encode_message(struct pcep_message *message,
 	message_buffer[0] = (message->msg_header->pcep_version << 5) & 0xf0;
 	message_buffer[1] = message->msg_header->type;
 
-	if (message->obj_list == NULL) {
-		net_order_length = htons(message_length);
-		memcpy(message_buffer + 2, &net_order_length,
-		       sizeof(net_order_length));
-		message->encoded_message =
-			pceplib_malloc(PCEPLIB_MESSAGES, message_length);
-		memcpy(message->encoded_message, message_buffer,
-		       message_length);
-		message->encoded_message_length = message_length;
-
-		return;
-	}
-
 	/* Encode each of the objects */
-	double_linked_list_node *node = message->obj_list->head;
+	double_linked_list_node *node =
+		(message->obj_list == NULL ? NULL : message->obj_list->head);
 	for (; node != NULL; node = node->next_node) {
 		message_length +=
 			pcep_encode_object(node->data, versioning,
 					   message_buffer + message_length);
 		if (message_length >= PCEP_MESSAGE_LENGTH) {
+			encode_buffer_used = PCEP_MESSAGE_LENGTH;
 			message->encoded_message = NULL;
 			message->encoded_message_length = 0;
 			return;
@@ -134,6 +151,14 @@ void pcep_encode_message(struct pcep_message *message,
 		pceplib_malloc(PCEPLIB_MESSAGES, message_length);
 	memcpy(message->encoded_message, message_buffer, message_length);
 	message->encoded_message_length = message_length;
+	encode_buffer_used = message_length;
+
+	/* The objects and TLVs point into the encode buffer, move them over to
+	 * the message copy */
+	node = (message->obj_list == NULL ? NULL : message->obj_list->head);
+	for (; node != NULL; node = node->next_node)
+		rebase_encoded_object(node->data, message_buffer,
+				      message->encoded_message);
 }
 
 /*
@@ -312,7 +337,7 @@ struct pcep_message *pcep_decode_message(const uint8_t *msg_buf)
 	uint16_t bytes_read = MESSAGE_HEADER_LENGTH;
 	while ((msg_length - bytes_read) >= OBJECT_HEADER_LENGTH) {
 		struct pcep_object_header *obj_hdr =
-			pcep_decode_object(msg_buf + bytes_read);
+			pcep_decode_object(msg->encoded_message + bytes_read);
 
 		if (obj_hdr == NULL) {
 			pcep_log(LOG_INFO, "%s: Discarding invalid message",
@@ -19,6 +19,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <assert.h>
+#include <sys/uio.h>
 
 #include "pcep_socket_comm_internals.h"
 #include "pcep_socket_comm_loop.h"
@@ -27,7 +28,10 @@
 #include "pcep_utils_logging.h"
 #include "pcep_utils_memory.h"
 
-void write_message(int socket_fd, const char *message, unsigned int msg_length);
+/* Queued messages are written with one writev() per this many messages */
+#define SOCKET_COMM_MAX_IOV 64
+
+void write_messages(int socket_fd, struct iovec *iov, int iovcnt);
 unsigned int read_message(int socket_fd, char *received_message,
 			  unsigned int max_message_size);
 int build_fd_sets(pcep_socket_comm_handle *socket_comm_handle);
@@ -63,30 +67,39 @@ bool comm_session_exists_locking(pcep_socket_comm_handle *socket_comm_handle,
 }
 
 
-void write_message(int socket_fd, const char *message, unsigned int msg_length)
+/* Write several messages in as few system calls as possible, the iovec
+ * array is consumed in the process */
+void write_messages(int socket_fd, struct iovec *iov, int iovcnt)
 {
-	ssize_t bytes_sent = 0;
-	unsigned int total_bytes_sent = 0;
+	ssize_t bytes_sent;
 
-	while ((uint32_t)bytes_sent < msg_length) {
-		bytes_sent = write(socket_fd, message + total_bytes_sent,
-				   msg_length);
+	while (iovcnt > 0) {
+		bytes_sent = writev(socket_fd, iov, iovcnt);
 
 		pcep_log(
 			LOG_INFO,
-			"%s: [%ld-%ld] socket_comm writing on socket fd [%d] msg_lenth [%u] bytes sent [%d]",
-			__func__, time(NULL), pthread_self(), socket_fd,
-			msg_length, bytes_sent);
+			"%s: [%ld-%ld] socket_comm writing on socket fd [%d] num_msgs [%d] bytes sent [%zd]",
+			__func__, time(NULL), pthread_self(), socket_fd, iovcnt,
+			bytes_sent);
 
 		if (bytes_sent < 0) {
 			if (errno != EAGAIN && errno != EWOULDBLOCK) {
-				pcep_log(LOG_WARNING, "%s: send() failure",
+				pcep_log(LOG_WARNING, "%s: writev() failure",
 					 __func__);
 
 				return;
 			}
-		} else {
-			total_bytes_sent += bytes_sent;
+			continue;
+		}
+
+		while (iovcnt > 0 && (size_t)bytes_sent >= iov->iov_len) {
+			bytes_sent -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (iovcnt > 0) {
+			iov->iov_base = (char *)iov->iov_base + bytes_sent;
+			iov->iov_len -= bytes_sent;
 		}
 	}
 }
@@ -285,6 +298,42 @@ void handle_reads(pcep_socket_comm_handle *socket_comm_handle)
 }
 
 
+/* Send all queued messages of a session, SOCKET_COMM_MAX_IOV at a time */
+static bool write_queued_messages(pcep_socket_comm_session *comm_session)
+{
+	pcep_socket_comm_queued_message *batch[SOCKET_COMM_MAX_IOV];
+	struct iovec iov[SOCKET_COMM_MAX_IOV];
+	bool msg_written = false;
+	int count, i;
+
+	do {
+		for (count = 0; count < SOCKET_COMM_MAX_IOV; count++) {
+			batch[count] =
+				queue_dequeue(comm_session->message_queue);
+			if (batch[count] == NULL)
+				break;
+			iov[count].iov_base =
+				(void *)batch[count]->encoded_message;
+			iov[count].iov_len = batch[count]->msg_length;
+		}
+		if (count == 0)
+			break;
+
+		msg_written = true;
+		write_messages(comm_session->socket_fd, iov, count);
+		for (i = 0; i < count; i++) {
+			if (batch[i]->free_after_send) {
+				pceplib_free(PCEPLIB_MESSAGES,
+					     (void *)batch[i]->encoded_message);
+			}
+			pceplib_free(PCEPLIB_MESSAGES, batch[i]);
+		}
+	} while (count == SOCKET_COMM_MAX_IOV);
+
+	return msg_written;
+}
+
+
 void handle_writes(pcep_socket_comm_handle *socket_comm_handle)
 {
 	pthread_mutex_lock(&(socket_comm_handle->socket_comm_mutex));
@@ -320,22 +369,7 @@ void handle_writes(pcep_socket_comm_handle *socket_comm_handle)
 
 			/* dequeue all the comm_session messages and send them
 			 */
-			pcep_socket_comm_queued_message *queued_message =
-				queue_dequeue(comm_session->message_queue);
-			while (queued_message != NULL) {
-				msg_written = true;
-				write_message(comm_session->socket_fd,
-					      queued_message->encoded_message,
-					      queued_message->msg_length);
-				if (queued_message->free_after_send) {
-					pceplib_free(PCEPLIB_MESSAGES,
-						     (void *)queued_message
-							     ->encoded_message);
-				}
-				pceplib_free(PCEPLIB_MESSAGES, queued_message);
-				queued_message = queue_dequeue(
-					comm_session->message_queue);
-			}
+			msg_written = write_queued_messages(comm_session);
 		}
 
 		/* check if the socket should be closed after writing */
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+/*
+ * This file is part of the PCEPlib, a PCEP protocol library.
+ *
+ * Encode/decode benchmark for large PCRpt and PCUpd messages, as sent during
+ * the state synchronization of a PCC with many LSPs.
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <arpa/inet.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pcep_msg_encoding.h"
+#include "pcep_msg_messages.h"
+#include "pcep_msg_objects.h"
+#include "pcep_msg_tools.h"
+#include "pcep_utils_double_linked_list.h"
+#include "pcep_utils_memory.h"
+
+#define ROUNDS 2000
+/* SRP + LSP + 10 hop ERO, about 150 bytes per LSP */
+#define LSPS_PER_MSG 256
+#define ERO_HOPS 10
+
+static void append_lsp(double_linked_list *obj_list, uint32_t plsp_id)
+{
+	double_linked_list *ero_list = dll_initialize();
+	struct in_addr node = {.s_addr = htonl(0x0a000000 + plsp_id)};
+	int i;
+
+	dll_append(obj_list, pcep_obj_create_srp(false, plsp_id, NULL));
+	dll_append(obj_list,
+		   pcep_obj_create_lsp(plsp_id, PCEP_LSP_OPERATIONAL_UP, false,
+				       true, false, false, true, NULL));
+	for (i = 0; i < ERO_HOPS; i++)
+		dll_append(ero_list, pcep_obj_create_ro_subobj_sr_ipv4_node(
+					     false, false, false, true,
+					     16000 + i, &node));
+	dll_append(obj_list, pcep_obj_create_ero(ero_list));
+}
+
+static struct pcep_message *create_report(void)
+{
+	double_linked_list *obj_list = dll_initialize();
+	uint32_t i;
+
+	for (i = 1; i <= LSPS_PER_MSG; i++)
+		append_lsp(obj_list, i);
+	return pcep_msg_create_report(obj_list);
+}
+
+static struct pcep_message *create_update(void)
+{
+	double_linked_list *obj_list = dll_initialize();
+
+	append_lsp(obj_list, 1);
+	return pcep_msg_create_update(obj_list);
+}
+
+static double elapsed(struct timespec *a, struct timespec *b)
+{
+	return (b->tv_sec - a->tv_sec) + (b->tv_nsec - a->tv_nsec) / 1e9;
+}
+
+static void bench(const char *name, struct pcep_message *msg,
+		  struct pcep_versioning *versioning)
+{
+	struct timespec t0, t1, t2;
+	struct pcep_message *decoded;
+	uint16_t length;
+	uint8_t *copy;
+	int i;
+
+	pcep_encode_message(msg, versioning);
+	assert(msg->encoded_message != NULL);
+	length = msg->encoded_message_length;
+	copy = malloc(length);
+	memcpy(copy, msg->encoded_message, length);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0; i < ROUNDS; i++) {
+		pceplib_free(PCEPLIB_MESSAGES, msg->encoded_message);
+		msg->encoded_message = NULL;
+		pcep_encode_message(msg, versioning);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	assert(msg->encoded_message_length == length);
+	assert(!memcmp(msg->encoded_message, copy, length));
+
+	for (i = 0; i < ROUNDS; i++) {
+		decoded = pcep_decode_message(copy);
+		assert(decoded != NULL);
+		assert(decoded->obj_list->num_entries
+		       == msg->obj_list->num_entries);
+		pcep_msg_free_message(decoded);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t2);
+
+	printf("%-10s %5u bytes %4u objects  encode %8.1f MB/s  decode %8.1f MB/s\n",
+	       name, length, msg->obj_list->num_entries,
+	       (double)length * ROUNDS / elapsed(&t0, &t1) / 1e6,
+	       (double)length * ROUNDS / elapsed(&t1, &t2) / 1e6);
+
+	free(copy);
+}
+
+int main(int argc, char **argv)
+{
+	struct pcep_versioning *versioning = create_default_pcep_versioning();
+	struct pcep_message *msg;
+
+	/* Unused parameters cause compilation warnings */
+	(void)argc;
+	(void)argv;
+
+	msg = pcep_msg_create_keepalive();
+	bench("Keepalive", msg, versioning);
+	pcep_msg_free_message(msg);
+
+	msg = create_update();
+	bench("PCUpd", msg, versioning);
+	pcep_msg_free_message(msg);
+
+	msg = create_report();
+	bench("PCRpt", msg, versioning);
+	pcep_msg_free_message(msg);
+
+	destroy_pcep_versioning(versioning);
+	return 0;
+}
@@ -629,7 +629,7 @@ void pim_bsm_clear(struct pim_instance *pim)
 	pim_rp_refresh_group_to_rp_mapping(pim);
 
 
-	frr_each (rb_pim_upstream, &pim->upstream_head, up) {
+	frr_each (rb_pim_upstream_star_g, &pim->upstream_star_g_head, up) {
 		/* Find the upstream (*, G) whose upstream address is same as
 		 * the RP
 		 */
@@ -693,7 +693,7 @@ static void igmp_show_statistics(struct pim_instance *pim, struct vty *vty,
 
 	FOR_ALL_INTERFACES (pim->vrf, ifp) {
 		struct pim_interface *pim_ifp;
-		struct listnode *sock_node, *source_node, *group_node;
+		struct listnode *sock_node, *group_node;
 		struct gm_sock *igmp;
 		struct gm_group *group;
 		struct gm_source *src;
@@ -719,8 +719,7 @@ static void igmp_show_statistics(struct pim_instance *pim, struct vty *vty,
 
 		for (ALL_LIST_ELEMENTS_RO(pim_ifp->gm_group_list, group_node,
 					  group)) {
-			for (ALL_LIST_ELEMENTS_RO(group->group_source_list,
-						  source_node, src)) {
+			frr_each (gm_sources, &group->group_sources, src) {
 				if (pim_addr_is_any(src->source_addr))
 					continue;
 
@@ -754,6 +753,10 @@ static void igmp_show_statistics(struct pim_instance *pim, struct vty *vty,
 		json_object_int_add(json_row, "reportV1", igmp_stats.report_v1);
 		json_object_int_add(json_row, "reportV2", igmp_stats.report_v2);
 		json_object_int_add(json_row, "reportV3", igmp_stats.report_v3);
+		json_object_int_add(json_row, "reportV3Usec",
+				    igmp_stats.report_v3_usec);
+		json_object_int_add(json_row, "reportV3UsecMax",
+				    igmp_stats.report_v3_usec_max);
 		json_object_int_add(json_row, "mtraceResponse",
 				    igmp_stats.mtrace_rsp);
 		json_object_int_add(json_row, "mtraceRequest",
@@ -797,6 +800,10 @@ static void igmp_show_statistics(struct pim_instance *pim, struct vty *vty,
 			igmp_stats.report_v2);
 		vty_out(vty, "V3 report               : %u\n",
 			igmp_stats.report_v3);
+		vty_out(vty, "V3 report time (usec)   : %" PRIu64 "\n",
+			igmp_stats.report_v3_usec);
+		vty_out(vty, "V3 report max (usec)    : %u\n",
+			igmp_stats.report_v3_usec_max);
 		vty_out(vty, "mtrace response         : %u\n",
 			igmp_stats.mtrace_rsp);
 		vty_out(vty, "mtrace request          : %u\n",
@@ -901,16 +908,14 @@ static void igmp_show_groups(struct pim_instance *pim, struct vty *vty, bool uj)
 						       hhmmss);
 				json_object_int_add(
 					json_group, "sourcesCount",
-					grp->group_source_list ? listcount(
-						grp->group_source_list)
-							       : 0);
+					gm_sources_count(&grp->group_sources));
 				json_object_int_add(json_group, "version",
 						    grp->igmp_version);
 				json_object_string_add(json_group, "uptime",
 						       uptime);
 				json_object_array_add(json_groups, json_group);
 			} else {
-				vty_out(vty, "%-16s %-15s %4s %8s %4d %d %8s\n",
+				vty_out(vty, "%-16s %-15s %4s %8s %4zu %d %8s\n",
 					ifp->name, group_str,
 					grp->igmp_version == 3
 						? (grp->group_filtermode_isexcl
@@ -918,9 +923,7 @@ static void igmp_show_groups(struct pim_instance *pim, struct vty *vty, bool uj)
 							   : "INCL")
 						: "----",
 					hhmmss,
-					grp->group_source_list ? listcount(
-						grp->group_source_list)
-							       : 0,
+					gm_sources_count(&grp->group_sources),
 					grp->igmp_version, uptime);
 			}
 		} /* scan igmp groups */
@@ -952,7 +955,6 @@ static void igmp_show_group_retransmission(struct pim_instance *pim,
 					  grp)) {
 			char group_str[INET_ADDRSTRLEN];
 			char grp_retr_mmss[10];
-			struct listnode *src_node;
 			struct gm_source *src;
 			int grp_retr_sources = 0;
 
@@ -965,8 +967,7 @@ static void igmp_show_group_retransmission(struct pim_instance *pim,
 
 			/* count group sources with retransmission state
 			 */
-			for (ALL_LIST_ELEMENTS_RO(grp->group_source_list,
-						  src_node, src)) {
+			frr_each (gm_sources, &grp->group_sources, src) {
 				if (src->source_query_retransmit_count > 0) {
 					++grp_retr_sources;
 				}
@@ -1013,15 +1014,13 @@ static void igmp_show_sources(struct pim_instance *pim, struct vty *vty,
 		for (ALL_LIST_ELEMENTS_RO(pim_ifp->gm_group_list, grpnode,
 					  grp)) {
 			char group_str[INET_ADDRSTRLEN];
-			struct listnode *srcnode;
 			struct gm_source *src;
 
 			pim_inet4_dump("<group?>", grp->group_addr, group_str,
 				       sizeof(group_str));
 
 			/* scan group sources */
-			for (ALL_LIST_ELEMENTS_RO(grp->group_source_list,
-						  srcnode, src)) {
+			frr_each (gm_sources, &grp->group_sources, src) {
 				char source_str[INET_ADDRSTRLEN];
 				char mmss[10];
 				char uptime[10];
@@ -1122,15 +1121,13 @@ static void igmp_show_source_retransmission(struct pim_instance *pim,
 		for (ALL_LIST_ELEMENTS_RO(pim_ifp->gm_group_list, grpnode,
 					  grp)) {
 			char group_str[INET_ADDRSTRLEN];
-			struct listnode *srcnode;
 			struct gm_source *src;
 
 			pim_inet4_dump("<group?>", grp->group_addr, group_str,
 				       sizeof(group_str));
 
 			/* scan group sources */
-			for (ALL_LIST_ELEMENTS_RO(grp->group_source_list,
-						  srcnode, src)) {
+			frr_each (gm_sources, &grp->group_sources, src) {
 				char source_str[INET_ADDRSTRLEN];
 
 				pim_inet4_dump("<source?>", src->source_addr,
@@ -5605,6 +5602,102 @@ DEFUN (show_ip_msdp_sa_detail_vrf_all,
 	return CMD_SUCCESS;
 }
 
+static void ip_msdp_show_sa_summary(struct pim_instance *pim, struct vty *vty,
+				    bool uj)
+{
+	struct pim_msdp *msdp = &pim->msdp;
+	unsigned long total = msdp->sa_list ? listcount(msdp->sa_list) : 0;
+	size_t memory;
+	size_t cached_tlvs = 0;
+	json_object *json;
+
+	/* the entries, plus their hash bucket and list node */
+	memory = total * (sizeof(struct pim_msdp_sa) +
+			  sizeof(struct hash_bucket) + sizeof(struct listnode));
+	if (msdp->sa_cache)
+		cached_tlvs = stream_fifo_count_safe(msdp->sa_cache);
+
+	if (uj) {
+		json = json_object_new_object();
+		json_object_int_add(json, "saCount", total);
+		json_object_int_add(json, "saLocalCount", msdp->local_cnt);
+		json_object_int_add(json, "saMemory", memory);
+		json_object_int_add(json, "encodedTlvs", cached_tlvs);
+		json_object_int_add(json, "encodedBytes", msdp->sa_cache_bytes);
+		json_object_int_add(json, "encodedBuilds",
+				    msdp->sa_cache_builds);
+		json_object_int_add(json, "forwardedTlvs", msdp->sa_fwd_tlvs);
+		json_object_int_add(json, "forwardedEntries",
+				    msdp->sa_fwd_entries);
+		vty_json(vty, json);
+		return;
+	}
+
+	vty_out(vty, "SA cache entries       : %lu (%u local)\n", total,
+		msdp->local_cnt);
+	vty_out(vty, "SA cache memory        : %zu bytes\n", memory);
+	vty_out(vty, "Encoded local SA TLVs  : %zu (%zu bytes, %u builds)\n",
+		cached_tlvs, msdp->sa_cache_bytes, msdp->sa_cache_builds);
+	vty_out(vty, "Forwarded SA TLVs      : %u (%u entries)\n",
+		msdp->sa_fwd_tlvs, msdp->sa_fwd_entries);
+}
+
+DEFUN (show_ip_msdp_sa_summary,
+       show_ip_msdp_sa_summary_cmd,
+       "show ip msdp [vrf NAME] sa summary [json]",
+       SHOW_STR
+       IP_STR
+       MSDP_STR
+       VRF_CMD_HELP_STR
+       "MSDP active-source information\n"
+       "SA cache summary and memory usage\n"
+       JSON_STR)
+{
+	bool uj = use_json(argc, argv);
+	int idx = 2;
+	struct vrf *vrf = pim_cmd_lookup_vrf(vty, argv, argc, &idx);
+
+	if (!vrf)
+		return CMD_WARNING;
+
+	ip_msdp_show_sa_summary(vrf->info, vty, uj);
+
+	return CMD_SUCCESS;
+}
+
+DEFUN (show_ip_msdp_sa_summary_vrf_all,
+       show_ip_msdp_sa_summary_vrf_all_cmd,
+       "show ip msdp vrf all sa summary [json]",
+       SHOW_STR
+       IP_STR
+       MSDP_STR
+       VRF_CMD_HELP_STR
+       "MSDP active-source information\n"
+       "SA cache summary and memory usage\n"
+       JSON_STR)
+{
+	bool uj = use_json(argc, argv);
+	struct vrf *vrf;
+	bool first = true;
+
+	if (uj)
+		vty_out(vty, "{ ");
+	RB_FOREACH (vrf, vrf_name_head, &vrfs_by_name) {
+		if (uj) {
+			if (!first)
+				vty_out(vty, ", ");
+			vty_out(vty, " \"%s\": ", vrf->name);
+			first = false;
+		} else
+			vty_out(vty, "VRF: %s\n", vrf->name);
+		ip_msdp_show_sa_summary(vrf->info, vty, uj);
+	}
+	if (uj)
+		vty_out(vty, "}\n");
+
+	return CMD_SUCCESS;
+}
+
 static void ip_msdp_show_sa_addr(struct pim_instance *pim, struct vty *vty,
 				 const char *addr, bool uj)
 {
@@ -6417,6 +6510,8 @@ void pim_cmd_init(void)
 	install_element(VIEW_NODE, &show_ip_msdp_peer_detail_vrf_all_cmd);
 	install_element(VIEW_NODE, &show_ip_msdp_sa_detail_cmd);
 	install_element(VIEW_NODE, &show_ip_msdp_sa_detail_vrf_all_cmd);
+	install_element(VIEW_NODE, &show_ip_msdp_sa_summary_cmd);
+	install_element(VIEW_NODE, &show_ip_msdp_sa_summary_vrf_all_cmd);
 	install_element(VIEW_NODE, &show_ip_msdp_sa_sg_cmd);
 	install_element(VIEW_NODE, &show_ip_msdp_sa_sg_vrf_all_cmd);
 	install_element(VIEW_NODE, &show_ip_msdp_mesh_group_cmd);
@@ -1912,6 +1912,41 @@ void pim_show_jp_agg_list(struct pim_instance *pim, struct vty *vty)
 	vty_out(vty, "%s\n", table);
 	XFREE(MTYPE_TMP, table);
 	ttable_del(tt);
+
+	/* Periodic J/P statistics per neighbor. */
+	tt = ttable_new(&ttable_styles[TTSTYLE_BLANK]);
+	ttable_add_row(tt,
+		       "Interface|RPF Nbr|Packets|Sources|Sources/Packet|Groups Built|Groups Reused");
+	tt->style.cell.rpad = 2;
+	tt->style.corner = '+';
+	ttable_restyle(tt);
+
+	FOR_ALL_INTERFACES (pim->vrf, ifp) {
+		pim_ifp = ifp->info;
+		if (!pim_ifp)
+			continue;
+
+		for (ALL_LIST_ELEMENTS_RO(pim_ifp->pim_neighbor_list, n_node,
+					  neigh)) {
+			struct pim_jp_agg_stats *stats = &neigh->jp_agg_stats;
+
+			ttable_add_row(tt,
+				       "%s|%pPAs|%" PRIu64 "|%" PRIu64 "|%" PRIu64
+				       "|%" PRIu64 "|%" PRIu64,
+				       ifp->name, &neigh->source_addr,
+				       stats->packets, stats->sources,
+				       stats->packets ? stats->sources /
+								stats->packets
+						      : 0,
+				       stats->groups_built,
+				       stats->groups_reused);
+		}
+	}
+
+	table = ttable_dump(tt, "\n");
+	vty_out(vty, "%s\n", table);
+	XFREE(MTYPE_TMP, table);
+	ttable_del(tt);
 }
 
 int pim_show_membership_cmd_helper(const char *vrf, struct vty *vty, bool uj)
@@ -3469,6 +3504,7 @@ static void show_scan_oil_stats(struct pim_instance *pim, struct vty *vty,
 	char uptime_scan_oil[10];
 	char uptime_mroute_add[10];
 	char uptime_mroute_del[10];
+	char uptime_mroute_stats[10];
 
 	pim_time_uptime_begin(uptime_scan_oil, sizeof(uptime_scan_oil), now,
 			      pim->scan_oil_last);
@@ -3476,14 +3512,19 @@ static void show_scan_oil_stats(struct pim_instance *pim, struct vty *vty,
 			      pim->mroute_add_last);
 	pim_time_uptime_begin(uptime_mroute_del, sizeof(uptime_mroute_del), now,
 			      pim->mroute_del_last);
+	pim_time_uptime_begin(uptime_mroute_stats, sizeof(uptime_mroute_stats),
+			      now, pim->mroute_stats_last / 1000000);
 
 	vty_out(vty,
 		"Scan OIL - Last: %s  Events: %lld\n"
 		"MFC Add  - Last: %s  Events: %lld\n"
-		"MFC Del  - Last: %s  Events: %lld\n",
+		"MFC Del  - Last: %s  Events: %lld\n"
+		"MFC Stat - Last: %s  Dumps: %lld  Lookups: %lld\n",
 		uptime_scan_oil, (long long)pim->scan_oil_events,
 		uptime_mroute_add, (long long)pim->mroute_add_events,
-		uptime_mroute_del, (long long)pim->mroute_del_events);
+		uptime_mroute_del, (long long)pim->mroute_del_events,
+		uptime_mroute_stats, (long long)pim->mroute_stats_dumps,
+		(long long)pim->mroute_stats_single);
 }
 
 void show_multicast_interfaces(struct pim_instance *pim, struct vty *vty,
@@ -4085,6 +4126,9 @@ void show_mroute_count(struct pim_instance *pim, struct vty *vty,
 		ttable_restyle(tt);
 	}
 
+	/* one dump for all of them */
+	pim_mroute_stats_refresh(pim);
+
 	/* Print PIM and IGMP route counts */
 	frr_each (rb_pim_oil, &pim->channel_oil_head, c_oil)
 		show_mroute_count_per_channel_oil(c_oil, json, tt);
@@ -4194,6 +4238,8 @@ int clear_ip_mroute_count_command(struct vty *vty, const char *name)
 		return CMD_WARNING;
 
 	pim = v->info;
+	pim_mroute_stats_refresh(pim);
+
 	frr_each (rb_pim_oil, &pim->channel_oil_head, c_oil) {
 		if (!c_oil->installed)
 			continue;
@@ -324,7 +324,7 @@ int pim_hello_recv(struct interface *ifp, pim_addr src_addr, uint8_t *tlv_buf,
 					neigh->generation_id, &src_addr,
 					ifp->name);
 
-			pim_upstream_rpf_genid_changed(pim_ifp->pim,
+			pim_upstream_rpf_genid_changed(pim_ifp->pim, ifp,
 						       neigh->source_addr);
 
 			pim_neighbor_delete(ifp, neigh, "GenID mismatch");
@@ -1394,26 +1394,30 @@ void pim_ifchannel_scan_forward_start(struct interface *new_ifp)
 {
 	struct pim_interface *new_pim_ifp = new_ifp->info;
 	struct pim_instance *pim = new_pim_ifp->pim;
-	struct interface *ifp;
+	struct pim_upstream *up, *next, lookup;
+	struct listnode *node;
+	struct pim_ifchannel *ch;
 
-	FOR_ALL_INTERFACES (pim->vrf, ifp) {
-		struct pim_interface *loop_pim_ifp = ifp->info;
-		struct pim_ifchannel *ch;
+	/* only the upstreams with new_ifp as RPF interface are of interest */
+	memset(&lookup, 0, sizeof(lookup));
+	lookup.rpf_idx_ifp = new_ifp;
 
-		if (!loop_pim_ifp)
-			continue;
+	for (up = rb_pim_upstream_rpf_find_gteq(&pim->upstream_rpf_head,
+						&lookup);
+	     up && up->rpf_idx_ifp == new_ifp; up = next) {
+		next = rb_pim_upstream_rpf_next(&pim->upstream_rpf_head, up);
 
-		if (new_pim_ifp == loop_pim_ifp)
+		if (up->channel_oil)
 			continue;
 
-		RB_FOREACH (ch, pim_ifchannel_rb, &loop_pim_ifp->ifchannel_rb) {
-			if (ch->ifjoin_state == PIM_IFJOIN_JOIN) {
-				struct pim_upstream *up = ch->upstream;
-				if ((!up->channel_oil)
-				    && (up->rpf.source_nexthop
-						.interface == new_ifp))
-					pim_forward_start(ch);
-			}
+		for (ALL_LIST_ELEMENTS_RO(up->ifchannels, node, ch)) {
+			struct pim_interface *loop_pim_ifp = ch->interface->info;
+
+			if (!loop_pim_ifp || new_pim_ifp == loop_pim_ifp)
+				continue;
+
+			if (ch->ifjoin_state == PIM_IFJOIN_JOIN)
+				pim_forward_start(ch);
 		}
 	}
 }
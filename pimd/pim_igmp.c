@@ -38,7 +38,7 @@ void igmp_anysource_forward_start(struct pim_instance *pim,
 	struct in_addr src_addr = {.s_addr = 0};
 	/* Any source (*,G) is forwarded only if mode is EXCLUDE {empty} */
 	assert(group->group_filtermode_isexcl);
-	assert(listcount(group->group_source_list) < 1);
+	assert(gm_sources_count(&group->group_sources) < 1);
 
 	source = igmp_get_source_by_addr(group, src_addr, NULL);
 	if (!source) {
@@ -116,7 +116,6 @@ void igmp_source_forward_reevaluate_all(struct pim_instance *pim)
 		/* scan igmp groups */
 		for (ALL_LIST_ELEMENTS(pim_ifp->gm_group_list, grpnode,
 				       grp_nextnode, grp)) {
-			struct listnode *srcnode;
 			struct gm_source *src;
 			int is_grp_ssm;
 
@@ -133,9 +132,8 @@ void igmp_source_forward_reevaluate_all(struct pim_instance *pim)
 				igmp_group_delete(grp);
 			} else {
 				/* scan group sources */
-				for (ALL_LIST_ELEMENTS_RO(
-					     grp->group_source_list, srcnode,
-					     src)) {
+				frr_each (gm_sources, &grp->group_sources,
+					  src) {
 					igmp_source_forward_reevaluate_one(
 						pim, src, is_grp_ssm);
 				} /* scan group sources */
@@ -993,7 +991,11 @@ void igmp_startup_mode_on(struct gm_sock *igmp)
 
 static void igmp_group_free(struct gm_group *group)
 {
-	list_delete(&group->group_source_list);
+	struct gm_source *src;
+
+	while ((src = gm_sources_pop(&group->group_sources)))
+		igmp_source_free(src);
+	gm_sources_fini(&group->group_sources);
 
 	XFREE(MTYPE_PIM_IGMP_GROUP, group);
 }
@@ -1027,8 +1029,6 @@ static void igmp_group_count_decr(struct pim_interface *pim_ifp)
 
 void igmp_group_delete(struct gm_group *group)
 {
-	struct listnode *src_node;
-	struct listnode *src_nextnode;
 	struct gm_source *src;
 	struct pim_interface *pim_ifp = group->interface->info;
 
@@ -1040,8 +1040,7 @@ void igmp_group_delete(struct gm_group *group)
 			   group_str, group->interface->name);
 	}
 
-	for (ALL_LIST_ELEMENTS(group->group_source_list, src_node, src_nextnode,
-			       src)) {
+	frr_each_safe (gm_sources, &group->group_sources, src) {
 		igmp_source_delete(src);
 	}
 
@@ -1058,7 +1057,7 @@ void igmp_group_delete(struct gm_group *group)
 void igmp_group_delete_empty_include(struct gm_group *group)
 {
 	assert(!group->group_filtermode_isexcl);
-	assert(!listcount(group->group_source_list));
+	assert(!gm_sources_count(&group->group_sources));
 
 	igmp_group_delete(group);
 }
@@ -1321,7 +1320,7 @@ static void igmp_group_timer(struct event *t)
 	/* Any source (*,G) is forwarded only if mode is EXCLUDE {empty} */
 	igmp_anysource_forward_stop(group);
 
-	igmp_source_delete_expired(group->group_source_list);
+	igmp_source_delete_expired(group);
 
 	assert(!group->group_filtermode_isexcl);
 
@@ -1331,7 +1330,7 @@ static void igmp_group_timer(struct event *t)
 	  If there are no more source records for the group, delete group
 	  record.
 	*/
-	if (listcount(group->group_source_list) < 1) {
+	if (gm_sources_count(&group->group_sources) < 1) {
 		igmp_group_delete_empty_include(group);
 	}
 }
@@ -1429,8 +1428,7 @@ struct gm_group *igmp_add_group_by_addr(struct gm_sock *igmp,
 
 	group = XCALLOC(MTYPE_PIM_IGMP_GROUP, sizeof(*group));
 
-	group->group_source_list = list_new();
-	group->group_source_list->del = (void (*)(void *))igmp_source_free;
+	gm_sources_init(&group->group_sources);
 
 	group->t_group_timer = NULL;
 	group->t_group_query_retransmit_timer = NULL;
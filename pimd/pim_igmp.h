@@ -12,6 +12,8 @@
 #include <zebra.h>
 #include "vty.h"
 #include "linklist.h"
+#include "typesafe.h"
+#include "pim_addr.h"
 #include "pim_igmp_stats.h"
 #include "pim_str.h"
 
@@ -142,7 +144,11 @@ static inline void pim_igmp_other_querier_timer_off(struct gm_sock *igmp)
 #define IGMP_SOURCE_DONT_DELETE(flags)     ((flags) &= ~IGMP_SOURCE_MASK_DELETE)
 #define IGMP_SOURCE_DONT_SEND(flags)       ((flags) &= ~IGMP_SOURCE_MASK_SEND)
 
+PREDECL_RBTREE_UNIQ(gm_sources);
+
 struct gm_source {
+	struct gm_sources_item item;
+
 	pim_addr source_addr;
 	struct event *t_source_timer;
 	struct gm_group *source_group; /* back pointer */
@@ -157,6 +163,15 @@ struct gm_source {
 	int source_query_retransmit_count;
 };
 
+static inline int gm_source_cmp(const struct gm_source *a,
+				const struct gm_source *b)
+{
+	return pim_addr_cmp(a->source_addr, b->source_addr);
+}
+
+/* sorted by address, so report sources are matched in O(log n) */
+DECLARE_RBTREE_UNIQ(gm_sources, struct gm_source, item, gm_source_cmp);
+
 struct gm_group {
 	/*
 	  RFC 3376: 6.2.2. Definition of Group Timers
@@ -180,7 +195,7 @@ struct gm_group {
 	int igmp_version;
 	pim_addr group_addr;
 	int group_filtermode_isexcl;    /* 0=INCLUDE, 1=EXCLUDE */
-	struct list *group_source_list; /* list of struct gm_source */
+	struct gm_sources_head group_sources;
 	time_t group_creation;
 	struct interface *interface;
 	int64_t last_igmp_v1_report_dsec;
@@ -37,6 +37,9 @@ void igmp_stats_add(struct igmp_stats *a, struct igmp_stats *b)
 	a->joins_failed += b->joins_failed;
 	a->general_queries_sent += b->general_queries_sent;
 	a->group_queries_sent += b->group_queries_sent;
+	a->report_v3_usec += b->report_v3_usec;
+	a->report_v3_usec_max = MAX(a->report_v3_usec_max,
+				    b->report_v3_usec_max);
 	a->total_recv_messages += b->query_v1 + b->query_v2 + b->query_v3 +
 				  b->report_v1 + b->report_v2 + b->report_v3 +
 				  b->leave_v2 + b->mtrace_rsp + b->mtrace_req;
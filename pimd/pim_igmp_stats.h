@@ -28,6 +28,9 @@ struct igmp_stats {
 	uint32_t general_queries_sent;
 	uint32_t group_queries_sent;
 	uint32_t total_recv_messages;
+	/* time spent processing IGMPv3 reports: total, and the longest one */
+	uint64_t report_v3_usec;
+	uint32_t report_v3_usec_max;
 };
 
 #if PIM_IPV == 4
@@ -164,7 +164,7 @@ static void igmp_source_timer(struct event *t)
 		  group
 		  record.
 		*/
-		if (!listcount(group->group_source_list)) {
+		if (!gm_sources_count(&group->group_sources)) {
 			igmp_group_delete_empty_include(group);
 		}
 	}
@@ -250,31 +250,28 @@ void igmp_source_reset_gmi(struct gm_group *group, struct gm_source *source)
 
 static void source_mark_delete_flag(struct gm_group *group)
 {
-	struct listnode *src_node;
 	struct gm_source *src;
 
-	for (ALL_LIST_ELEMENTS_RO(group->group_source_list, src_node, src)) {
+	frr_each (gm_sources, &group->group_sources, src) {
 		IGMP_SOURCE_DO_DELETE(src->source_flags);
 	}
 }
 
 static void source_mark_send_flag(struct gm_group *group)
 {
-	struct listnode *src_node;
 	struct gm_source *src;
 
-	for (ALL_LIST_ELEMENTS_RO(group->group_source_list, src_node, src)) {
+	frr_each (gm_sources, &group->group_sources, src) {
 		IGMP_SOURCE_DO_SEND(src->source_flags);
 	}
 }
 
 static int source_mark_send_flag_by_timer(struct gm_group *group)
 {
-	struct listnode *src_node;
 	struct gm_source *src;
 	int num_marked_sources = 0;
 
-	for (ALL_LIST_ELEMENTS_RO(group->group_source_list, src_node, src)) {
+	frr_each (gm_sources, &group->group_sources, src) {
 		/* Is source timer running? */
 		if (src->t_source_timer) {
 			IGMP_SOURCE_DO_SEND(src->source_flags);
@@ -287,12 +284,11 @@ static int source_mark_send_flag_by_timer(struct gm_group *group)
 	return num_marked_sources;
 }
 
-static void source_clear_send_flag(struct list *source_list)
+static void source_clear_send_flag(struct gm_group *group)
 {
-	struct listnode *src_node;
 	struct gm_source *src;
 
-	for (ALL_LIST_ELEMENTS_RO(source_list, src_node, src)) {
+	frr_each (gm_sources, &group->group_sources, src) {
 		IGMP_SOURCE_DONT_SEND(src->source_flags);
 	}
 }
@@ -306,7 +302,7 @@ static void group_exclude_fwd_anysrc_ifempty(struct gm_group *group)
 
 	assert(group->group_filtermode_isexcl);
 
-	if (listcount(group->group_source_list) < 1) {
+	if (gm_sources_count(&group->group_sources) < 1) {
 		igmp_anysource_forward_start(pim_ifp->pim, group);
 	}
 }
@@ -374,11 +370,11 @@ void igmp_source_delete(struct gm_source *source)
 	source_channel_oil_detach(source);
 
 	/*
-	  notice that listnode_delete() can't be moved
+	  notice that gm_sources_del() can't be moved
 	  into igmp_source_free() because the later is
-	  called by list_delete_all_node()
+	  called by igmp_group_free() after popping the source
 	*/
-	listnode_delete(group->group_source_list, source);
+	gm_sources_del(&group->group_sources, source);
 
 	src.s_addr = source->source_addr.s_addr;
 	igmp_source_free(source);
@@ -386,30 +382,26 @@ void igmp_source_delete(struct gm_source *source)
 	/* Group source list is empty and current source is * then
 	 *,G group going away so do not trigger start */
 	if (group->group_filtermode_isexcl
-	    && (listcount(group->group_source_list) != 0)
+	    && (gm_sources_count(&group->group_sources) != 0)
 	    && src.s_addr != INADDR_ANY) {
 		group_exclude_fwd_anysrc_ifempty(group);
 	}
 }
 
-static void source_delete_by_flag(struct list *source_list)
+static void source_delete_by_flag(struct gm_group *group)
 {
-	struct listnode *src_node;
-	struct listnode *src_nextnode;
 	struct gm_source *src;
 
-	for (ALL_LIST_ELEMENTS(source_list, src_node, src_nextnode, src))
+	frr_each_safe (gm_sources, &group->group_sources, src)
 		if (IGMP_SOURCE_TEST_DELETE(src->source_flags))
 			igmp_source_delete(src);
 }
 
-void igmp_source_delete_expired(struct list *source_list)
+void igmp_source_delete_expired(struct gm_group *group)
 {
-	struct listnode *src_node;
-	struct listnode *src_nextnode;
 	struct gm_source *src;
 
-	for (ALL_LIST_ELEMENTS(source_list, src_node, src_nextnode, src))
+	frr_each_safe (gm_sources, &group->group_sources, src)
 		if (!src->t_source_timer)
 			igmp_source_delete(src);
 }
@@ -417,14 +409,9 @@ void igmp_source_delete_expired(struct list *source_list)
 struct gm_source *igmp_find_source_by_addr(struct gm_group *group,
 					   struct in_addr src_addr)
 {
-	struct listnode *src_node;
-	struct gm_source *src;
-
-	for (ALL_LIST_ELEMENTS_RO(group->group_source_list, src_node, src))
-		if (src_addr.s_addr == src->source_addr.s_addr)
-			return src;
+	struct gm_source ref = { .source_addr = src_addr };
 
-	return 0;
+	return gm_sources_find(&group->group_sources, &ref);
 }
 
 struct gm_source *igmp_get_source_by_addr(struct gm_group *group,
@@ -464,7 +451,7 @@ struct gm_source *igmp_get_source_by_addr(struct gm_group *group,
 	src->source_query_retransmit_count = 0;
 	src->source_channel_oil = NULL;
 
-	listnode_add(group->group_source_list, src);
+	gm_sources_add(&group->group_sources, src);
 
 	/* Any source (*,G) is forwarded only if mode is EXCLUDE {empty} */
 	igmp_anysource_forward_stop(group);
@@ -493,7 +480,7 @@ static void allow(struct gm_sock *igmp, struct in_addr from,
 			return;
 		}
 		if (group->group_filtermode_isexcl) {
-			if (listcount(group->group_source_list) == 1) {
+			if (gm_sources_count(&group->group_sources) == 1) {
 				struct in_addr star = {.s_addr = INADDR_ANY};
 
 				source = igmp_find_source_by_addr(group, star);
@@ -600,7 +587,7 @@ static void isex_excl(struct gm_group *group, int num_sources,
 	}
 
 	/* E.5: delete all sources marked with deletion flag: (X-A) and (Y-A) */
-	source_delete_by_flag(group->group_source_list);
+	source_delete_by_flag(group);
 }
 
 static void isex_incl(struct gm_group *group, int num_sources,
@@ -639,7 +626,7 @@ static void isex_incl(struct gm_group *group, int num_sources,
 	} /* scan received sources */
 
 	/* I.5: delete all sources marked with deletion flag (A-B) */
-	source_delete_by_flag(group->group_source_list);
+	source_delete_by_flag(group);
 
 	group->group_filtermode_isexcl = 1; /* boolean=true */
 
@@ -688,7 +675,7 @@ void igmpv3_report_isex(struct gm_sock *igmp, struct in_addr from,
 static void toin_incl(struct gm_group *group, int num_sources,
 		      struct in_addr *sources)
 {
-	int num_sources_tosend = listcount(group->group_source_list);
+	int num_sources_tosend = gm_sources_count(&group->group_sources);
 	int i;
 
 	/* Set SEND flag for all known sources (A) */
@@ -813,7 +800,7 @@ static void toex_incl(struct gm_group *group, int num_sources,
 	source_mark_delete_flag(group);
 
 	/* Clear off SEND flag from all known sources (A) */
-	source_clear_send_flag(group->group_source_list);
+	source_clear_send_flag(group);
 
 	/* Scan received sources (B) */
 	for (i = 0; i < num_sources; ++i) {
@@ -838,7 +825,7 @@ static void toex_incl(struct gm_group *group, int num_sources,
 	group->group_filtermode_isexcl = 1; /* boolean=true */
 
 	/* Delete all sources marked with DELETE flag (A-B) */
-	source_delete_by_flag(group->group_source_list);
+	source_delete_by_flag(group);
 
 	/* Send sources marked with SEND flag: Q(G,A*B) */
 	if (num_sources_tosend > 0) {
@@ -860,7 +847,7 @@ static void toex_excl(struct gm_group *group, int num_sources,
 	source_mark_delete_flag(group);
 
 	/* clear off SEND flag from all known sources (X,Y) */
-	source_clear_send_flag(group->group_source_list);
+	source_clear_send_flag(group);
 
 	if (num_sources == 0) {
 		struct gm_source *source;
@@ -918,7 +905,7 @@ static void toex_excl(struct gm_group *group, int num_sources,
 	  Delete (X-A)
 	  Delete (Y-A)
 	*/
-	source_delete_by_flag(group->group_source_list);
+	source_delete_by_flag(group);
 
 	/* send sources marked with SEND flag: Q(G,A-Y) */
 	if (num_sources_tosend > 0) {
@@ -1070,7 +1057,6 @@ static int group_retransmit_sources(struct gm_group *group,
 	struct in_addr *source_addr2;
 	int num_sources_tosend1;
 	int num_sources_tosend2;
-	struct listnode *src_node;
 	struct gm_source *src;
 	int num_retransmit_sources_left = 0;
 
@@ -1084,7 +1070,7 @@ static int group_retransmit_sources(struct gm_group *group,
 	lmqt_msec = lmqc * lmqi_msec;
 
 	/* Scan all group sources */
-	for (ALL_LIST_ELEMENTS_RO(group->group_source_list, src_node, src)) {
+	frr_each (gm_sources, &group->group_sources, src) {
 
 		/* Source has retransmission state? */
 		if (src->source_query_retransmit_count < 1)
@@ -1327,7 +1313,6 @@ static void source_query_send_by_flag(struct gm_group *group,
 				      int num_sources_tosend)
 {
 	struct pim_interface *pim_ifp;
-	struct listnode *src_node;
 	struct gm_source *src;
 	long lmqc;      /* Last Member Query Count */
 	long lmqi_msec; /* Last Member Query Interval */
@@ -1352,7 +1337,7 @@ static void source_query_send_by_flag(struct gm_group *group,
 	  Query Count].
 	  o Lower source timer to LMQT.
 	*/
-	for (ALL_LIST_ELEMENTS_RO(group->group_source_list, src_node, src)) {
+	frr_each (gm_sources, &group->group_sources, src) {
 		if (IGMP_SOURCE_TEST_SEND(src->source_flags)) {
 			/* source "src" in X of group G */
 			if (igmp_source_timer_remain_msec(src) > lmqt_msec) {
@@ -1376,7 +1361,7 @@ static void block_excl(struct gm_group *group, int num_sources,
 	int i;
 
 	/* 1. clear off SEND flag from all known sources (X,Y) */
-	source_clear_send_flag(group->group_source_list);
+	source_clear_send_flag(group);
 
 	/* 2. scan received sources (A) */
 	for (i = 0; i < num_sources; ++i) {
@@ -1422,7 +1407,7 @@ static void block_incl(struct gm_group *group, int num_sources,
 	int i;
 
 	/* 1. clear off SEND flag from all known sources (B) */
-	source_clear_send_flag(group->group_source_list);
+	source_clear_send_flag(group);
 
 	/* 2. scan received sources (A) */
 	for (i = 0; i < num_sources; ++i) {
@@ -1869,8 +1854,9 @@ static bool igmp_pkt_grp_addr_ok(struct interface *ifp, const char *from_str,
 	return true;
 }
 
-int igmp_v3_recv_report(struct gm_sock *igmp, struct in_addr from,
-			const char *from_str, char *igmp_msg, int igmp_msg_len)
+static int igmp_v3_report_process(struct gm_sock *igmp, struct in_addr from,
+				  const char *from_str, char *igmp_msg,
+				  int igmp_msg_len)
 {
 	int num_groups;
 	uint8_t *group_record;
@@ -2035,3 +2021,22 @@ int igmp_v3_recv_report(struct gm_sock *igmp, struct in_addr from,
 
 	return 0;
 }
+
+int igmp_v3_recv_report(struct gm_sock *igmp, struct in_addr from,
+			const char *from_str, char *igmp_msg, int igmp_msg_len)
+{
+	struct timeval start;
+	int64_t usec;
+	int ret;
+
+	monotime(&start);
+	ret = igmp_v3_report_process(igmp, from, from_str, igmp_msg,
+				     igmp_msg_len);
+	usec = monotime_since(&start, NULL);
+
+	igmp->igmp_stats.report_v3_usec += usec;
+	if (usec > igmp->igmp_stats.report_v3_usec_max)
+		igmp->igmp_stats.report_v3_usec_max = usec;
+
+	return ret;
+}
@@ -46,7 +46,7 @@ void igmp_source_reset_gmi(struct gm_group *group, struct gm_source *source);
 
 void igmp_source_free(struct gm_source *source);
 void igmp_source_delete(struct gm_source *source);
-void igmp_source_delete_expired(struct list *source_list);
+void igmp_source_delete_expired(struct gm_group *group);
 
 void igmpv3_report_isin(struct gm_sock *igmp, struct in_addr from,
 			struct in_addr group_addr, int num_sources,
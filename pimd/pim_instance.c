@@ -23,6 +23,7 @@
 #include "pim_bsm.h"
 #include "pim_mlag.h"
 #include "pim_sock.h"
+#include "pim_zlookup.h"
 
 static void pim_instance_terminate(struct pim_instance *pim)
 {
@@ -46,6 +47,7 @@ static void pim_instance_terminate(struct pim_instance *pim)
 
 	/* Traverse and cleanup rpf_hash */
 	hash_clean_and_free(&pim->rpf_hash, (void *)pim_rp_list_hash_clean);
+	pim_zlookup_cache_flush(pim);
 
 	pim_if_terminate(pim);
 
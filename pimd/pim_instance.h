@@ -129,6 +129,12 @@ struct pim_instance {
 	int64_t mroute_del_events;
 	int64_t mroute_del_last;
 
+	/* bulk mroute statistics dumps, see pim_mroute_stats_refresh() */
+	int64_t mroute_stats_last; /* usec */
+	int64_t mroute_stats_dumps;
+	int64_t mroute_stats_single;
+	uint32_t mroute_stats_gen;
+
 	struct interface *regiface;
 
 	// List of static routes;
@@ -136,6 +142,8 @@ struct pim_instance {
 
 	// Upstream vrf specific information
 	struct rb_pim_upstream_head upstream_head;
+	struct rb_pim_upstream_rpf_head upstream_rpf_head;
+	struct rb_pim_upstream_star_g_head upstream_star_g_head;
 	struct timer_wheel *upstream_sg_wheel;
 
 	/*
@@ -426,7 +426,52 @@ int pim_joinprune_recv(struct interface *ifp, struct pim_neighbor *neigh,
  *  |        Pruned Source Address n (Encoded-Source format)        |
  *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
  */
-int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
+static void pim_joinprune_send_packet(struct pim_interface *pim_ifp,
+				      struct pim_rpf *rpf, uint8_t *pim_msg,
+				      size_t packet_size,
+				      struct pim_jp_agg_stats *stats)
+{
+	pim_msg_build_header(pim_ifp->primary_address,
+			     qpim_all_pim_routers_addr, pim_msg, packet_size,
+			     PIM_MSG_TYPE_JOIN_PRUNE, false);
+	if (pim_msg_send(pim_ifp->pim_sock_fd, pim_ifp->primary_address,
+			 qpim_all_pim_routers_addr, pim_msg, packet_size,
+			 rpf->source_nexthop.interface)) {
+		zlog_warn("%s: could not send PIM message on interface %s",
+			  __func__, rpf->source_nexthop.interface->name);
+	}
+
+	if (stats)
+		stats->packets++;
+}
+
+static void pim_joinprune_msg_init(struct pim_rpf *rpf, uint8_t *pim_msg,
+				   size_t *packet_size, size_t *packet_left)
+{
+	struct pim_jp *msg = (struct pim_jp *)pim_msg;
+
+	memset(msg, 0, sizeof(*msg));
+
+	pim_msg_addr_encode_ucast((uint8_t *)&msg->addr, rpf->rpf_addr);
+	msg->reserved = 0;
+	msg->holdtime = htons(PIM_JP_HOLDTIME);
+
+	*packet_size = sizeof(struct pim_msg_header);
+	*packet_size += sizeof(pim_encoded_unicast);
+	*packet_size += 4; // reserved (1) + groups (1) + holdtime (2)
+
+	*packet_left = rpf->source_nexthop.interface->mtu - 24;
+	*packet_left -= *packet_size;
+}
+
+/*
+ * Group records are taken as they were encoded last time if the group
+ * keeps them (see pim_jp_agg_group_encoded_set()), so a periodic refresh
+ * of unchanged state is mostly copying.  stats, if given, is updated with
+ * what was sent.
+ */
+int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups,
+		       struct pim_jp_agg_stats *stats)
 {
 	struct pim_jp_agg_group *group;
 	struct pim_interface *pim_ifp = NULL;
@@ -479,25 +524,12 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 	for (ALL_LIST_ELEMENTS(groups, node, nnode, group)) {
 		if (new_packet) {
 			msg = (struct pim_jp *)pim_msg;
-
-			memset(msg, 0, sizeof(*msg));
-
-			pim_msg_addr_encode_ucast((uint8_t *)&msg->addr,
-						  rpf->rpf_addr);
-			msg->reserved = 0;
-			msg->holdtime = htons(PIM_JP_HOLDTIME);
-
+			pim_joinprune_msg_init(rpf, pim_msg, &packet_size,
+					       &packet_left);
 			new_packet = false;
 
 			grp = &msg->groups[0];
 			curr_ptr = (uint8_t *)grp;
-			packet_size = sizeof(struct pim_msg_header);
-			packet_size += sizeof(pim_encoded_unicast);
-			packet_size +=
-				4; // reserved (1) + groups (1) + holdtime (2)
-
-			packet_left = rpf->source_nexthop.interface->mtu - 24;
-			packet_left -= packet_size;
 		}
 		if (PIM_DEBUG_PIM_J_P)
 			zlog_debug(
@@ -505,42 +537,20 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 				__func__, &group->group, &rpf->rpf_addr,
 				rpf->source_nexthop.interface->name);
 
-		group_size = pim_msg_get_jp_group_size(group->sources);
+		if (group->encoded)
+			group_size = group->encoded_len;
+		else
+			group_size = pim_msg_get_jp_group_size(group->sources);
 		if (group_size > packet_left) {
-			pim_msg_build_header(pim_ifp->primary_address,
-					     qpim_all_pim_routers_addr, pim_msg,
-					     packet_size,
-					     PIM_MSG_TYPE_JOIN_PRUNE, false);
-			if (pim_msg_send(pim_ifp->pim_sock_fd,
-					 pim_ifp->primary_address,
-					 qpim_all_pim_routers_addr, pim_msg,
-					 packet_size,
-					 rpf->source_nexthop.interface)) {
-				zlog_warn(
-					"%s: could not send PIM message on interface %s",
-					__func__,
-					rpf->source_nexthop.interface->name);
-			}
+			pim_joinprune_send_packet(pim_ifp, rpf, pim_msg,
+						  packet_size, stats);
 
 			msg = (struct pim_jp *)pim_msg;
-			memset(msg, 0, sizeof(*msg));
-
-			pim_msg_addr_encode_ucast((uint8_t *)&msg->addr,
-						  rpf->rpf_addr);
-			msg->reserved = 0;
-			msg->holdtime = htons(PIM_JP_HOLDTIME);
-
-			new_packet = false;
+			pim_joinprune_msg_init(rpf, pim_msg, &packet_size,
+					       &packet_left);
 
 			grp = &msg->groups[0];
 			curr_ptr = (uint8_t *)grp;
-			packet_size = sizeof(struct pim_msg_header);
-			packet_size += sizeof(pim_encoded_unicast);
-			packet_size +=
-				4; // reserved (1) + groups (1) + holdtime (2)
-
-			packet_left = rpf->source_nexthop.interface->mtu - 24;
-			packet_left -= packet_size;
 		}
 
 		msg->num_groups++;
@@ -551,7 +561,18 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 		curr_ptr += group_size;
 		packet_left -= group_size;
 		packet_size += group_size;
-		pim_msg_build_jp_groups(grp, group, group_size);
+		if (group->encoded) {
+			memcpy(grp, group->encoded, group_size);
+			if (stats)
+				stats->groups_reused++;
+		} else {
+			pim_msg_build_jp_groups(grp, group, group_size);
+			pim_jp_agg_group_encoded_set(group, grp, group_size);
+			if (stats)
+				stats->groups_built++;
+		}
+		if (stats)
+			stats->sources += ntohs(grp->joins) + ntohs(grp->prunes);
 
 		if (!pim_ifp->pim_passive_enable) {
 			pim_ifp->pim_ifstat_join_send += ntohs(grp->joins);
@@ -567,38 +588,15 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 		grp = (struct pim_jp_groups *)curr_ptr;
 		if (packet_left < sizeof(struct pim_jp_groups)
 		    || msg->num_groups == 255) {
-			pim_msg_build_header(pim_ifp->primary_address,
-					     qpim_all_pim_routers_addr, pim_msg,
-					     packet_size,
-					     PIM_MSG_TYPE_JOIN_PRUNE, false);
-			if (pim_msg_send(pim_ifp->pim_sock_fd,
-					 pim_ifp->primary_address,
-					 qpim_all_pim_routers_addr, pim_msg,
-					 packet_size,
-					 rpf->source_nexthop.interface)) {
-				zlog_warn(
-					"%s: could not send PIM message on interface %s",
-					__func__,
-					rpf->source_nexthop.interface->name);
-			}
-
+			pim_joinprune_send_packet(pim_ifp, rpf, pim_msg,
+						  packet_size, stats);
 			new_packet = true;
 		}
 	}
 
 
-	if (!new_packet) {
-		// msg->num_groups = htons (msg->num_groups);
-		pim_msg_build_header(
-			pim_ifp->primary_address, qpim_all_pim_routers_addr,
-			pim_msg, packet_size, PIM_MSG_TYPE_JOIN_PRUNE, false);
-		if (pim_msg_send(pim_ifp->pim_sock_fd, pim_ifp->primary_address,
-				 qpim_all_pim_routers_addr, pim_msg,
-				 packet_size, rpf->source_nexthop.interface)) {
-			zlog_warn(
-				"%s: could not send PIM message on interface %s",
-				__func__, rpf->source_nexthop.interface->name);
-		}
-	}
+	if (!new_packet)
+		pim_joinprune_send_packet(pim_ifp, rpf, pim_msg, packet_size,
+					  stats);
 	return 0;
 }
@@ -16,6 +16,7 @@
 int pim_joinprune_recv(struct interface *ifp, struct pim_neighbor *neigh,
 		       pim_addr src_addr, uint8_t *tlv_buf, int tlv_buf_size);
 
-int pim_joinprune_send(struct pim_rpf *nexthop, struct list *groups);
+int pim_joinprune_send(struct pim_rpf *nexthop, struct list *groups,
+		       struct pim_jp_agg_stats *stats);
 
 #endif /* PIM_JOIN_H */
@@ -18,9 +18,40 @@
 #include "pim_join.h"
 #include "pim_iface.h"
 
+static void pim_jp_agg_group_encoded_clear(struct pim_jp_agg_group *jag)
+{
+	XFREE(MTYPE_PIM_JP_AGG_ENCODED, jag->encoded);
+	jag->encoded_len = 0;
+}
+
+/*
+ * Keep the encoded group record for the next periodic J/P.  Not for
+ * records with (*,G) entries, those depend on more than the source list:
+ * they carry the RP address and the (S,G,rpt) prunes of the children.
+ */
+void pim_jp_agg_group_encoded_set(struct pim_jp_agg_group *jag,
+				  const void *encoded, size_t len)
+{
+	struct listnode *node;
+	struct pim_jp_sources *js;
+
+	if (!jag->cache)
+		return;
+
+	for (ALL_LIST_ELEMENTS_RO(jag->sources, node, js))
+		if (pim_addr_is_any(js->up->sg.src))
+			return;
+
+	pim_jp_agg_group_encoded_clear(jag);
+	jag->encoded = XMALLOC(MTYPE_PIM_JP_AGG_ENCODED, len);
+	memcpy(jag->encoded, encoded, len);
+	jag->encoded_len = len;
+}
+
 void pim_jp_agg_group_list_free(struct pim_jp_agg_group *jag)
 {
 	list_delete(&jag->sources);
+	pim_jp_agg_group_encoded_clear(jag);
 
 	XFREE(MTYPE_PIM_JP_AGG_GROUP, jag);
 }
@@ -85,6 +116,7 @@ void pim_jp_agg_clear_group(struct list *group)
 			XFREE(MTYPE_PIM_JP_AGG_SOURCE, js);
 		}
 		list_delete(&jag->sources);
+		pim_jp_agg_group_encoded_clear(jag);
 		listnode_delete(group, jag);
 		XFREE(MTYPE_PIM_JP_AGG_GROUP, jag);
 	}
@@ -155,10 +187,12 @@ void pim_jp_agg_remove_group(struct list *group, struct pim_upstream *up,
 		js->up = NULL;
 		listnode_delete(jag->sources, js);
 		XFREE(MTYPE_PIM_JP_AGG_SOURCE, js);
+		pim_jp_agg_group_encoded_clear(jag);
 	}
 
 	if (jag->sources->count == 0) {
 		list_delete(&jag->sources);
+		pim_jp_agg_group_encoded_clear(jag);
 		listnode_delete(group, jag);
 		XFREE(MTYPE_PIM_JP_AGG_GROUP, jag);
 	}
@@ -253,6 +287,8 @@ void pim_jp_agg_add_group(struct list *group, struct pim_upstream *up,
 		jag = XCALLOC(MTYPE_PIM_JP_AGG_GROUP,
 			      sizeof(struct pim_jp_agg_group));
 		jag->group = up->sg.grp;
+		/* only the neighbor lists are sent periodically */
+		jag->cache = !!nbr;
 		jag->sources = list_new();
 		jag->sources->cmp = pim_jp_agg_src_cmp;
 		jag->sources->del = (void (*)(void *))pim_jp_agg_src_free;
@@ -278,11 +314,13 @@ void pim_jp_agg_add_group(struct list *group, struct pim_upstream *up,
 		js->up = up;
 		js->is_join = is_join;
 		listnode_add_sort(jag->sources, js);
+		pim_jp_agg_group_encoded_clear(jag);
 	} else {
 		if (js->is_join != is_join) {
 			listnode_delete(jag->sources, js);
 			js->is_join = is_join;
 			listnode_add_sort(jag->sources, js);
+			pim_jp_agg_group_encoded_clear(jag);
 		}
 	}
 }
@@ -324,7 +362,7 @@ void pim_jp_agg_single_upstream_send(struct pim_rpf *rpf,
 				     struct pim_upstream *up, bool is_join)
 {
 	struct list groups, sources;
-	struct pim_jp_agg_group jag;
+	struct pim_jp_agg_group jag = {};
 	struct pim_jp_sources js;
 
 	/* skip JP upstream messages if source is directly connected */
@@ -345,7 +383,7 @@ void pim_jp_agg_single_upstream_send(struct pim_rpf *rpf,
 	js.up = up;
 	js.is_join = is_join;
 
-	pim_joinprune_send(rpf, &groups);
+	pim_joinprune_send(rpf, &groups, NULL);
 
 	list_delete_all_node(jag.sources);
 	list_delete_all_node(&groups);
@@ -17,12 +17,30 @@ struct pim_jp_sources {
 struct pim_jp_agg_group {
 	pim_addr group;
 	struct list *sources;
+
+	/*
+	 * Group record as last sent, reused until the sources change.
+	 * Only kept for groups on an aggregation list (cache set).
+	 */
+	bool cache;
+	uint8_t *encoded;
+	size_t encoded_len;
+};
+
+struct pim_jp_agg_stats {
+	uint64_t packets;
+	uint64_t sources;
+	/* group records built from the sources, or reused as encoded */
+	uint64_t groups_built;
+	uint64_t groups_reused;
 };
 
 void pim_jp_agg_upstream_verification(struct pim_upstream *up, bool ignore);
 int pim_jp_agg_is_in_list(struct list *group, struct pim_upstream *up);
 
 void pim_jp_agg_group_list_free(struct pim_jp_agg_group *jag);
+void pim_jp_agg_group_encoded_set(struct pim_jp_agg_group *jag,
+				  const void *encoded, size_t len);
 int pim_jp_agg_group_list_cmp(void *arg1, void *arg2);
 
 void pim_jp_agg_clear_group(struct list *group);
@@ -32,8 +32,10 @@ DEFINE_MTYPE(PIMD, PIM_MSDP_MG_MBR, "PIM MSDP mesh group mbr");
 DEFINE_MTYPE(PIMD, PIM_SEC_ADDR, "PIM secondary address");
 DEFINE_MTYPE(PIMD, PIM_JP_AGG_GROUP, "PIM JP AGG Group");
 DEFINE_MTYPE(PIMD, PIM_JP_AGG_SOURCE, "PIM JP AGG Source");
+DEFINE_MTYPE(PIMD, PIM_JP_AGG_ENCODED, "PIM JP AGG Encoded Group");
 DEFINE_MTYPE(PIMD, PIM_PIM_INSTANCE, "PIM global state");
 DEFINE_MTYPE(PIMD, PIM_NEXTHOP_CACHE, "PIM nexthop cache state");
+DEFINE_MTYPE(PIMD, PIM_ZLOOKUP_CACHE, "PIM zebra lookup cache");
 DEFINE_MTYPE(PIMD, PIM_SSM_INFO, "PIM SSM configuration");
 DEFINE_MTYPE(PIMD, PIM_PLIST_NAME, "PIM Prefix List Names");
 DEFINE_MTYPE(PIMD, PIM_VXLAN_SG, "PIM VxLAN mroute cache");
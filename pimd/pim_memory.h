@@ -31,8 +31,10 @@ DECLARE_MTYPE(PIM_MSDP_MG_MBR);
 DECLARE_MTYPE(PIM_SEC_ADDR);
 DECLARE_MTYPE(PIM_JP_AGG_GROUP);
 DECLARE_MTYPE(PIM_JP_AGG_SOURCE);
+DECLARE_MTYPE(PIM_JP_AGG_ENCODED);
 DECLARE_MTYPE(PIM_PIM_INSTANCE);
 DECLARE_MTYPE(PIM_NEXTHOP_CACHE);
+DECLARE_MTYPE(PIM_ZLOOKUP_CACHE);
 DECLARE_MTYPE(PIM_SSM_INFO);
 DECLARE_MTYPE(PIM_PLIST_NAME);
 DECLARE_MTYPE(PIM_VXLAN_SG);
@@ -1308,10 +1308,48 @@ int pim_mroute_del(struct channel_oil *c_oil, const char *name)
 	return 0;
 }
 
-void pim_mroute_update_counters(struct channel_oil *c_oil)
+/*
+ * Counters from a bulk dump are good for this long, usec.  Checks on the
+ * upstream wheel are spread over its whole period, so this bounds the number
+ * of dumps per period no matter how many mroutes there are.
+ */
+#define PIM_MROUTE_STATS_MAX_AGE (5 * 1000 * 1000)
+
+/*
+ * Ask zebra for the counters of all mroutes in the vrf at once, entries
+ * that showed up in the dump are updated from it until it is too old.
+ */
+void pim_mroute_stats_refresh(struct pim_instance *pim)
+{
+	int ret;
+
+	/* 0 is the generation of entries never seen in a dump */
+	if (++pim->mroute_stats_gen == 0)
+		pim->mroute_stats_gen = 1;
+
+	pim->mroute_stats_last = pim_time_monotonic_usec();
+	++pim->mroute_stats_dumps;
+
+	ret = pim_zlookup_sg_statistics_bulk(pim);
+	if (ret < 0 && PIM_DEBUG_MROUTE)
+		zlog_debug("%s: vrf %s bulk mroute statistics failed: %d",
+			   __func__, pim->vrf->name, ret);
+}
+
+static bool pim_mroute_stats_cached(struct channel_oil *c_oil)
+{
+	struct pim_instance *pim = c_oil->pim;
+
+	if (pim_time_monotonic_usec() - pim->mroute_stats_last >
+	    PIM_MROUTE_STATS_MAX_AGE)
+		pim_mroute_stats_refresh(pim);
+
+	return c_oil->stats.gen == pim->mroute_stats_gen;
+}
+
+static bool pim_mroute_update_counters_start(struct channel_oil *c_oil)
 {
 	struct pim_instance *pim = c_oil->pim;
-	pim_sioc_sg_req sgreq;
 
 	c_oil->cc.oldpktcnt = c_oil->cc.pktcnt;
 	c_oil->cc.oldbytecnt = c_oil->cc.bytecnt;
@@ -1327,9 +1365,19 @@ void pim_mroute_update_counters(struct channel_oil *c_oil)
 			zlog_debug("Channel%pSG is not installed no need to collect data from kernel",
 				   &sg);
 		}
-		return;
+		return false;
 	}
 
+	return true;
+}
+
+/* ask zebra and the kernel about this one entry */
+static void pim_mroute_update_counters_single(struct channel_oil *c_oil)
+{
+	struct pim_instance *pim = c_oil->pim;
+	pim_sioc_sg_req sgreq;
+
+	++pim->mroute_stats_single;
 
 	memset(&sgreq, 0, sizeof(sgreq));
 
@@ -1360,3 +1408,32 @@ void pim_mroute_update_counters(struct channel_oil *c_oil)
 	c_oil->cc.wrong_if = sgreq.wrong_if;
 	return;
 }
+
+/*
+ * Update the counters from the last bulk dump if it is recent enough and
+ * has the entry, else look it up on its own.
+ */
+void pim_mroute_update_counters(struct channel_oil *c_oil)
+{
+	if (!pim_mroute_update_counters_start(c_oil))
+		return;
+
+	if (!pim_mroute_stats_cached(c_oil)) {
+		pim_mroute_update_counters_single(c_oil);
+		return;
+	}
+
+	c_oil->cc.lastused = c_oil->stats.lastused;
+	c_oil->cc.pktcnt = c_oil->stats.pktcnt;
+	c_oil->cc.bytecnt = c_oil->stats.bytecnt;
+	c_oil->cc.wrong_if = c_oil->stats.wrong_if;
+}
+
+/* for callers that can't live with counters a few seconds old */
+void pim_mroute_update_counters_now(struct channel_oil *c_oil)
+{
+	if (!pim_mroute_update_counters_start(c_oil))
+		return;
+
+	pim_mroute_update_counters_single(c_oil);
+}
@@ -154,6 +154,8 @@ void pim_static_mroute_iif_update(struct channel_oil *c_oil,
 int pim_mroute_del(struct channel_oil *c_oil, const char *name);
 
 void pim_mroute_update_counters(struct channel_oil *c_oil);
+void pim_mroute_update_counters_now(struct channel_oil *c_oil);
+void pim_mroute_stats_refresh(struct pim_instance *pim);
 bool pim_mroute_allow_iif_in_oil(struct channel_oil *c_oil,
 		int oif_index);
 int pim_mroute_msg(struct pim_instance *pim, const char *buf, size_t buf_size,
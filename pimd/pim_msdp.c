@@ -339,6 +339,7 @@ static void pim_msdp_sa_deref(struct pim_msdp_sa *sa,
 			}
 			if (sa->pim->msdp.local_cnt)
 				--sa->pim->msdp.local_cnt;
+			sa->pim->msdp.sa_cache_stale = true;
 		}
 	}
 
@@ -401,6 +402,7 @@ void pim_msdp_sa_ref(struct pim_instance *pim, struct pim_msdp_peer *mp,
 		if (!(sa->flags & PIM_MSDP_SAF_LOCAL)) {
 			sa->flags |= PIM_MSDP_SAF_LOCAL;
 			++sa->pim->msdp.local_cnt;
+			sa->pim->msdp.sa_cache_stale = true;
 			if (PIM_DEBUG_MSDP_EVENTS) {
 				zlog_debug("MSDP SA %s added locally",
 					   sa->sg_str);
@@ -1030,6 +1032,7 @@ struct pim_msdp_peer *pim_msdp_peer_add(struct pim_instance *pim,
 	mp->local = *local;
 	/* XXX: originator_id setting needs to move to the mesh group */
 	pim->msdp.originator_id = *local;
+	pim->msdp.sa_cache_stale = true;
 	pim_msdp_addr2su(&mp->su_local, mp->local);
 	if (mesh_group_name)
 		mp->mesh_group_name =
@@ -1327,6 +1330,8 @@ static void pim_msdp_enable(struct pim_instance *pim)
 	}
 	pim->msdp.flags |= PIM_MSDPF_ENABLE;
 	pim->msdp.work_obuf = stream_new(PIM_MSDP_MAX_PACKET_SIZE);
+	pim->msdp.sa_cache = stream_fifo_new();
+	pim->msdp.sa_cache_stale = true;
 	pim_msdp_sa_adv_timer_setup(pim, true /* start */);
 	/* setup sa cache based on local sources */
 	pim_msdp_sa_local_setup(pim);
@@ -1381,6 +1386,10 @@ void pim_msdp_exit(struct pim_instance *pim)
 	if (pim->msdp.work_obuf)
 		stream_free(pim->msdp.work_obuf);
 	pim->msdp.work_obuf = NULL;
+
+	if (pim->msdp.sa_cache)
+		stream_fifo_free(pim->msdp.sa_cache);
+	pim->msdp.sa_cache = NULL;
 }
 
 void pim_msdp_mg_src_add(struct pim_instance *pim, struct pim_msdp_mg *mg,
@@ -190,6 +190,19 @@ struct pim_msdp {
 	/* keep a scratch pad for building SA TLVs */
 	struct stream *work_obuf;
 
+	/*
+	 * SA TLVs for the local sources, built once and sent as they are
+	 * until the local sources change.
+	 */
+	struct stream_fifo *sa_cache;
+	bool sa_cache_stale;
+	size_t sa_cache_bytes;
+	uint32_t sa_cache_builds;
+
+	/* SA TLVs (and entries in them) forwarded to other peers */
+	uint32_t sa_fwd_tlvs;
+	uint32_t sa_fwd_entries;
+
 	struct in_addr originator_id;
 
 	/** List of mesh groups. */
@@ -320,8 +320,8 @@ void pim_msdp_pkt_ka_tx(struct pim_msdp_peer *mp)
 	pim_msdp_pkt_send(mp, s);
 }
 
-static void pim_msdp_pkt_sa_push_to_one_peer(struct pim_instance *pim,
-					     struct pim_msdp_peer *mp)
+static void pim_msdp_pkt_sa_push_to_one_peer(struct pim_msdp_peer *mp,
+					     struct stream *sa_s)
 {
 	struct stream *s;
 
@@ -329,7 +329,7 @@ static void pim_msdp_pkt_sa_push_to_one_peer(struct pim_instance *pim,
 		/* don't tx anything unless a session is established */
 		return;
 	}
-	s = stream_dup(pim->msdp.work_obuf);
+	s = stream_dup(sa_s);
 	if (s) {
 		pim_msdp_pkt_send(mp, s);
 		mp->flags |= PIM_MSDP_PEERF_SA_JUST_SENT;
@@ -338,19 +338,19 @@ static void pim_msdp_pkt_sa_push_to_one_peer(struct pim_instance *pim,
 
 /* push the stream into the obuf fifo of all the peers */
 static void pim_msdp_pkt_sa_push(struct pim_instance *pim,
-				 struct pim_msdp_peer *mp)
+				 struct pim_msdp_peer *mp, struct stream *s)
 {
 	struct listnode *mpnode;
 
 	if (mp) {
-		pim_msdp_pkt_sa_push_to_one_peer(pim, mp);
+		pim_msdp_pkt_sa_push_to_one_peer(mp, s);
 	} else {
 		for (ALL_LIST_ELEMENTS_RO(pim->msdp.peer_list, mpnode, mp)) {
 			if (PIM_DEBUG_MSDP_INTERNAL) {
 				zlog_debug("MSDP peer %s pim_msdp_pkt_sa_push",
 					   mp->key_str);
 			}
-			pim_msdp_pkt_sa_push_to_one_peer(pim, mp);
+			pim_msdp_pkt_sa_push_to_one_peer(mp, s);
 		}
 	}
 }
@@ -374,22 +374,41 @@ static int pim_msdp_pkt_sa_fill_hdr(struct pim_instance *pim, int local_cnt,
 	return local_cnt;
 }
 
-static void pim_msdp_pkt_sa_fill_one(struct pim_msdp_sa *sa)
+static void pim_msdp_pkt_sa_fill_one(struct pim_instance *pim,
+				     const pim_sgaddr *sg)
 {
-	stream_put3(sa->pim->msdp.work_obuf, 0 /* reserved */);
-	stream_putc(sa->pim->msdp.work_obuf, 32 /* sprefix len */);
-	stream_put_ipv4(sa->pim->msdp.work_obuf, sa->sg.grp.s_addr);
-	stream_put_ipv4(sa->pim->msdp.work_obuf, sa->sg.src.s_addr);
+	stream_put3(pim->msdp.work_obuf, 0 /* reserved */);
+	stream_putc(pim->msdp.work_obuf, 32 /* sprefix len */);
+	stream_put_ipv4(pim->msdp.work_obuf, sg->grp.s_addr);
+	stream_put_ipv4(pim->msdp.work_obuf, sg->src.s_addr);
 }
 
-static void pim_msdp_pkt_sa_gen(struct pim_instance *pim,
-				struct pim_msdp_peer *mp)
+/* keep a copy of the SA TLV in the scratch pad for the periodic updates */
+static void pim_msdp_pkt_sa_cache_add(struct pim_instance *pim)
+{
+	struct stream *s = stream_dup(pim->msdp.work_obuf);
+
+	stream_fifo_push(pim->msdp.sa_cache, s);
+	pim->msdp.sa_cache_bytes += stream_get_endp(s);
+}
+
+/*
+ * Encode the SAs of all local sources.  This is only done when the set of
+ * local sources (or the originator-id) changed since the last time, every
+ * other advertisement sends the same TLVs again.
+ */
+static void pim_msdp_pkt_sa_cache_build(struct pim_instance *pim)
 {
 	struct listnode *sanode;
 	struct pim_msdp_sa *sa;
 	int sa_count;
 	int local_cnt = pim->msdp.local_cnt;
 
+	stream_fifo_clean(pim->msdp.sa_cache);
+	pim->msdp.sa_cache_bytes = 0;
+	pim->msdp.sa_cache_stale = false;
+	++pim->msdp.sa_cache_builds;
+
 	sa_count = 0;
 	if (PIM_DEBUG_MSDP_INTERNAL) {
 		zlog_debug("  sa gen  %d", local_cnt);
@@ -407,10 +426,10 @@ static void pim_msdp_pkt_sa_gen(struct pim_instance *pim,
 			continue;
 		}
 		/* add sa into scratch pad */
-		pim_msdp_pkt_sa_fill_one(sa);
+		pim_msdp_pkt_sa_fill_one(pim, &sa->sg);
 		++sa_count;
 		if (sa_count >= PIM_MSDP_SA_MAX_ENTRY_CNT) {
-			pim_msdp_pkt_sa_push(pim, mp);
+			pim_msdp_pkt_sa_cache_add(pim);
 			/* reset headers */
 			sa_count = 0;
 			if (PIM_DEBUG_MSDP_INTERNAL) {
@@ -423,9 +442,20 @@ static void pim_msdp_pkt_sa_gen(struct pim_instance *pim,
 	}
 
 	if (sa_count) {
-		pim_msdp_pkt_sa_push(pim, mp);
+		pim_msdp_pkt_sa_cache_add(pim);
 	}
-	return;
+}
+
+static void pim_msdp_pkt_sa_gen(struct pim_instance *pim,
+				struct pim_msdp_peer *mp)
+{
+	struct stream *s;
+
+	if (pim->msdp.sa_cache_stale)
+		pim_msdp_pkt_sa_cache_build(pim);
+
+	for (s = pim->msdp.sa_cache->head; s; s = s->next)
+		pim_msdp_pkt_sa_push(pim, mp, s);
 }
 
 static void pim_msdp_pkt_sa_tx_done(struct pim_instance *pim)
@@ -452,8 +482,8 @@ void pim_msdp_pkt_sa_tx(struct pim_instance *pim)
 void pim_msdp_pkt_sa_tx_one(struct pim_msdp_sa *sa)
 {
 	pim_msdp_pkt_sa_fill_hdr(sa->pim, 1 /* cnt */, sa->rp);
-	pim_msdp_pkt_sa_fill_one(sa);
-	pim_msdp_pkt_sa_push(sa->pim, NULL);
+	pim_msdp_pkt_sa_fill_one(sa->pim, &sa->sg);
+	pim_msdp_pkt_sa_push(sa->pim, NULL, sa->pim->msdp.work_obuf);
 	pim_msdp_pkt_sa_tx_done(sa->pim);
 }
 
@@ -464,22 +494,48 @@ void pim_msdp_pkt_sa_tx_to_one_peer(struct pim_msdp_peer *mp)
 	pim_msdp_pkt_sa_tx_done(mp->pim);
 }
 
-void pim_msdp_pkt_sa_tx_one_to_one_peer(struct pim_msdp_peer *mp,
-					struct in_addr rp, pim_sgaddr sg)
+/*
+ * Forwards the SAs received in one TLV to the peers that are not in the RPF
+ * to the RP nor in the same mesh group as the peer from which we received
+ * the message.  If the message group is not set, i.e. "default", then we
+ * assume that the message must be forwarded.  The SAs are encoded once into
+ * as few TLVs as possible and the same TLVs go to all of those peers.
+ */
+static void pim_msdp_pkt_sa_fwd(struct pim_msdp_peer *mp, struct in_addr rp,
+				const pim_sgaddr *sgs, int cnt)
 {
-	struct pim_msdp_sa sa;
-
-	/* Fills the SA header. */
-	pim_msdp_pkt_sa_fill_hdr(mp->pim, 1, rp);
-
-	/* Fills the message contents. */
-	sa.pim = mp->pim;
-	sa.sg = sg;
-	pim_msdp_pkt_sa_fill_one(&sa);
+	struct pim_instance *pim = mp->pim;
+	struct listnode *peer_node;
+	struct pim_msdp_peer *peer;
+	int i, j, tlv_cnt;
+
+	for (i = 0; i < cnt; i += tlv_cnt) {
+		tlv_cnt = MIN(cnt - i, PIM_MSDP_SA_MAX_ENTRY_CNT);
+
+		pim_msdp_pkt_sa_fill_hdr(pim, tlv_cnt, rp);
+		for (j = 0; j < tlv_cnt; j++)
+			pim_msdp_pkt_sa_fill_one(pim, &sgs[i + j]);
+
+		++pim->msdp.sa_fwd_tlvs;
+		pim->msdp.sa_fwd_entries += tlv_cnt;
+
+		for (ALL_LIST_ELEMENTS_RO(pim->msdp.peer_list, peer_node,
+					  peer)) {
+			/* Not a RPF peer, so skip it. */
+			if (pim_msdp_peer_rpf_check(peer, rp))
+				continue;
+			/* Don't forward inside the meshed group. */
+			if ((mp->flags & PIM_MSDP_PEERF_IN_GROUP) &&
+			    strcmp(mp->mesh_group_name,
+				   peer->mesh_group_name) == 0)
+				continue;
+
+			pim_msdp_pkt_sa_push_to_one_peer(peer,
+							 pim->msdp.work_obuf);
+		}
+	}
 
-	/* Pushes the message. */
-	pim_msdp_pkt_sa_push(sa.pim, mp);
-	pim_msdp_pkt_sa_tx_done(sa.pim);
+	pim_msdp_pkt_sa_tx_done(pim);
 }
 
 static void pim_msdp_pkt_rxed_with_fatal_error(struct pim_msdp_peer *mp)
@@ -497,53 +553,39 @@ static void pim_msdp_pkt_ka_rx(struct pim_msdp_peer *mp, int len)
 	pim_msdp_peer_pkt_rxed(mp);
 }
 
-static void pim_msdp_pkt_sa_rx_one(struct pim_msdp_peer *mp, struct in_addr rp)
+/* returns false if the entry is to be ignored */
+static bool pim_msdp_pkt_sa_rx_one(struct pim_msdp_peer *mp, struct in_addr rp,
+				   pim_sgaddr *sg)
 {
 	int prefix_len;
-	pim_sgaddr sg;
-	struct listnode *peer_node;
-	struct pim_msdp_peer *peer;
 
 	/* just throw away the three reserved bytes */
 	stream_get3(mp->ibuf);
 	prefix_len = stream_getc(mp->ibuf);
 
-	memset(&sg, 0, sizeof(sg));
-	sg.grp.s_addr = stream_get_ipv4(mp->ibuf);
-	sg.src.s_addr = stream_get_ipv4(mp->ibuf);
+	memset(sg, 0, sizeof(*sg));
+	sg->grp.s_addr = stream_get_ipv4(mp->ibuf);
+	sg->src.s_addr = stream_get_ipv4(mp->ibuf);
 
 	if (prefix_len != IPV4_MAX_BITLEN) {
 		/* ignore SA update if the prefix length is not 32 */
 		flog_err(EC_PIM_MSDP_PACKET,
 			 "rxed sa update with invalid prefix length %d",
 			 prefix_len);
-		return;
+		return false;
 	}
 	if (PIM_DEBUG_MSDP_PACKETS) {
-		zlog_debug("  sg %pSG", &sg);
-	}
-	pim_msdp_sa_ref(mp->pim, mp, &sg, rp);
-
-	/* Forwards the SA to the peers that are not in the RPF to the RP nor in
-	 * the same mesh group as the peer from which we received the message.
-	 * If the message group is not set, i.e. "default", then we assume that
-	 * the message must be forwarded.*/
-	for (ALL_LIST_ELEMENTS_RO(mp->pim->msdp.peer_list, peer_node, peer)) {
-		/* Not a RPF peer, so skip it. */
-		if (pim_msdp_peer_rpf_check(peer, rp))
-			continue;
-		/* Don't forward inside the meshed group. */
-		if ((mp->flags & PIM_MSDP_PEERF_IN_GROUP)
-		    && strcmp(mp->mesh_group_name, peer->mesh_group_name) == 0)
-			continue;
-
-		pim_msdp_pkt_sa_tx_one_to_one_peer(peer, rp, sg);
+		zlog_debug("  sg %pSG", sg);
 	}
+	pim_msdp_sa_ref(mp->pim, mp, sg, rp);
+	return true;
 }
 
 static void pim_msdp_pkt_sa_rx(struct pim_msdp_peer *mp, int len)
 {
+	pim_sgaddr sgs[UINT8_MAX];
 	int entry_cnt;
+	int fwd_cnt = 0;
 	int i;
 	struct in_addr rp; /* Last RP address associated with this SA */
 
@@ -584,8 +626,16 @@ static void pim_msdp_pkt_sa_rx(struct pim_msdp_peer *mp, int len)
 
 	/* update SA cache */
 	for (i = 0; i < entry_cnt; ++i) {
-		pim_msdp_pkt_sa_rx_one(mp, rp);
+		if (pim_msdp_pkt_sa_rx_one(mp, rp, &sgs[fwd_cnt]))
+			++fwd_cnt;
 	}
+
+	/*
+	 * Only forward once the whole TLV went into the cache, updating it
+	 * can lead to local SAs being sent, which reuses the scratch pad.
+	 */
+	if (fwd_cnt)
+		pim_msdp_pkt_sa_fwd(mp, rp, sgs, fwd_cnt);
 }
 
 static void pim_msdp_pkt_rx(struct pim_msdp_peer *mp)
@@ -97,12 +97,10 @@ static void pim_if_membership_refresh(struct interface *ifp)
 
 	/* scan igmp groups */
 	for (ALL_LIST_ELEMENTS_RO(pim_ifp->gm_group_list, grpnode, grp)) {
-		struct listnode *srcnode;
 		struct gm_source *src;
 
 		/* scan group sources */
-		for (ALL_LIST_ELEMENTS_RO(grp->group_source_list, srcnode,
-					  src)) {
+		frr_each (gm_sources, &grp->group_sources, src) {
 
 			if (IGMP_SOURCE_TEST_FORWARDING(src->source_flags)) {
 				pim_sgaddr sg;
@@ -479,7 +477,6 @@ static void change_query_max_response_time(struct interface *ifp,
 
 	/* scan socket groups */
 	for (ALL_LIST_ELEMENTS_RO(pim_ifp->gm_group_list, grp_node, grp)) {
-		struct listnode *src_node;
 		struct gm_source *src;
 
 		/* reset group timers for groups in EXCLUDE mode */
@@ -487,8 +484,7 @@ static void change_query_max_response_time(struct interface *ifp,
 			igmp_group_reset_gmi(grp);
 
 		/* scan group sources */
-		for (ALL_LIST_ELEMENTS_RO(grp->group_source_list, src_node,
-					  src)) {
+		frr_each (gm_sources, &grp->group_sources, src) {
 
 			/* reset source timers for sources with running
 			 * timers
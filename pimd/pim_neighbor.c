@@ -13,6 +13,7 @@
 #include "vty.h"
 #include "plist.h"
 #include "lib_errors.h"
+#include "network.h"
 
 #include "pimd.h"
 #include "pim_instance.h"
@@ -238,6 +239,23 @@ void pim_neighbor_timer_reset(struct pim_neighbor *neigh, uint16_t holdtime)
 			neigh->holdtime, &neigh->t_expire_timer);
 }
 
+/*
+ * Neighbors tend to come up together (daemon start, interface up), spread
+ * their periodic J/P so the refresh of a lot of state doesn't happen all at
+ * the same time every t_periodic.  The first one goes out somewhere in the
+ * second half of t_periodic, the next ones up to 10% early so they keep
+ * drifting apart.  Early is fine: the holdtime is 3.5 * t_periodic.
+ */
+static uint32_t pim_neighbor_jp_interval_msec(bool first)
+{
+	uint32_t msec = router->t_periodic * 1000;
+
+	if (first)
+		return msec / 2 + frr_weak_random() % (msec / 2 + 1);
+
+	return msec - frr_weak_random() % (msec / 10 + 1);
+}
+
 static void on_neighbor_jp_timer(struct event *t)
 {
 	struct pim_neighbor *neigh = EVENT_ARG(t);
@@ -251,17 +269,19 @@ static void on_neighbor_jp_timer(struct event *t)
 
 	rpf.source_nexthop.interface = neigh->interface;
 	rpf.rpf_addr = neigh->source_addr;
-	pim_joinprune_send(&rpf, neigh->upstream_jp_agg);
+	pim_joinprune_send(&rpf, neigh->upstream_jp_agg, &neigh->jp_agg_stats);
 
-	event_add_timer(router->master, on_neighbor_jp_timer, neigh,
-			router->t_periodic, &neigh->jp_timer);
+	event_add_timer_msec(router->master, on_neighbor_jp_timer, neigh,
+			     pim_neighbor_jp_interval_msec(false),
+			     &neigh->jp_timer);
 }
 
 static void pim_neighbor_start_jp_timer(struct pim_neighbor *neigh)
 {
 	EVENT_OFF(neigh->jp_timer);
-	event_add_timer(router->master, on_neighbor_jp_timer, neigh,
-			router->t_periodic, &neigh->jp_timer);
+	event_add_timer_msec(router->master, on_neighbor_jp_timer, neigh,
+			     pim_neighbor_jp_interval_msec(true),
+			     &neigh->jp_timer);
 }
 
 static struct pim_neighbor *
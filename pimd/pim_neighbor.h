@@ -16,6 +16,7 @@
 #include "pim_tlv.h"
 #include "pim_iface.h"
 #include "pim_str.h"
+#include "pim_jp_agg.h"
 
 struct pim_neighbor {
 	int64_t creation; /* timestamp of creation */
@@ -32,6 +33,7 @@ struct pim_neighbor {
 
 	struct event *jp_timer;
 	struct list *upstream_jp_agg;
+	struct pim_jp_agg_stats jp_agg_stats;
 	struct bfd_session_params *bfd_session;
 };
 
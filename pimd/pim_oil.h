@@ -53,6 +53,18 @@ struct channel_counts {
 	unsigned long oldwrong_if;
 };
 
+/*
+ * Counters of an mroute from the last bulk statistics dump it showed up in,
+ * gen is the pim instance's mroute_stats_gen of that dump.
+ */
+struct channel_stats {
+	uint32_t gen;
+	unsigned long long lastused;
+	unsigned long pktcnt;
+	unsigned long bytecnt;
+	unsigned long wrong_if;
+};
+
 /*
   qpim_channel_oil_list holds a list of struct channel_oil.
 
@@ -97,6 +109,7 @@ struct channel_oil {
 	time_t oif_creation[MAXVIFS];
 	uint32_t oif_flags[MAXVIFS];
 	struct channel_counts cc;
+	struct channel_stats stats;
 	struct pim_upstream *up;
 	time_t mroute_creation;
 };
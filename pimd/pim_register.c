@@ -663,7 +663,7 @@ int pim_register_recv(struct interface *ifp, pim_addr dest_addr,
 			 * then set the spt bit as appropriate
 			 */
 			if (upstream->sptbit != PIM_UPSTREAM_SPTBIT_TRUE) {
-				pim_mroute_update_counters(
+				pim_mroute_update_counters_now(
 					upstream->channel_oil);
 				/*
 				 * Have we seen packets?
@@ -521,7 +521,7 @@ int pim_rp_new(struct pim_instance *pim, pim_addr rp_addr, struct prefix group,
 					"%s: NHT Register rp_all addr %pPA grp %pFX ",
 					__func__, &nht_p, &rp_all->group);
 
-			frr_each (rb_pim_upstream, &pim->upstream_head, up) {
+			frr_each (rb_pim_upstream_star_g, &pim->upstream_star_g_head, up) {
 				/* Find (*, G) upstream whose RP is not
 				 * configured yet
 				 */
@@ -615,7 +615,7 @@ int pim_rp_new(struct pim_instance *pim, pim_addr rp_addr, struct prefix group,
 			   rp_info, &rp_info->group,
 			   rn ? route_node_get_lock_count(rn) : 0);
 
-	frr_each (rb_pim_upstream, &pim->upstream_head, up) {
+	frr_each (rb_pim_upstream_star_g, &pim->upstream_star_g_head, up) {
 		if (pim_addr_is_any(up->sg.src)) {
 			struct prefix grp;
 			struct rp_info *trp_info;
@@ -742,7 +742,7 @@ int pim_rp_del(struct pim_instance *pim, pim_addr rp_addr, struct prefix group,
 	rp_all = pim_rp_find_match_group(pim, &g_all);
 
 	if (rp_all == rp_info) {
-		frr_each (rb_pim_upstream, &pim->upstream_head, up) {
+		frr_each (rb_pim_upstream_star_g, &pim->upstream_star_g_head, up) {
 			/* Find the upstream (*, G) whose upstream address is
 			 * same as the deleted RP
 			 */
@@ -790,7 +790,7 @@ int pim_rp_del(struct pim_instance *pim, pim_addr rp_addr, struct prefix group,
 
 	pim_rp_refresh_group_to_rp_mapping(pim);
 
-	frr_each (rb_pim_upstream, &pim->upstream_head, up) {
+	frr_each (rb_pim_upstream_star_g, &pim->upstream_star_g_head, up) {
 		/* Find the upstream (*, G) whose upstream address is same as
 		 * the deleted RP
 		 */
@@ -881,7 +881,7 @@ int pim_rp_change(struct pim_instance *pim, pim_addr new_rp_addr,
 
 	listnode_add_sort(pim->rp_list, rp_info);
 
-	frr_each (rb_pim_upstream, &pim->upstream_head, up) {
+	frr_each (rb_pim_upstream_star_g, &pim->upstream_star_g_head, up) {
 		if (pim_addr_is_any(up->sg.src)) {
 			struct prefix grp;
 			struct rp_info *trp_info;
@@ -231,6 +231,7 @@ enum pim_rpf_result pim_rpf_update(struct pim_instance *pim,
 	}
 
 	rpf->rpf_addr = pim_rpf_find_rpf_addr(up);
+	pim_upstream_rpf_index(up);
 
 	if (pim_rpf_addr_is_inaddr_any(rpf) && PIM_DEBUG_ZEBRA) {
 		/* RPF'(S,G) not found */
@@ -310,6 +311,7 @@ void pim_upstream_rpf_clear(struct pim_instance *pim,
 		up->rpf.rpf_addr = PIMADDR_ANY;
 		pim_upstream_mroute_iif_update(up->channel_oil, __func__);
 	}
+	pim_upstream_rpf_index(up);
 }
 
 /*
@@ -239,6 +239,9 @@ struct pim_upstream *pim_upstream_del(struct pim_instance *pim,
 	up->parent = NULL;
 
 	rb_pim_upstream_del(&pim->upstream_head, up);
+	rb_pim_upstream_rpf_del(&pim->upstream_rpf_head, up);
+	if (pim_addr_is_any(up->sg.src))
+		rb_pim_upstream_star_g_del(&pim->upstream_star_g_head, up);
 
 	if (notify_msdp) {
 		pim_msdp_up_del(pim, &up->sg);
@@ -816,6 +819,26 @@ void pim_upstream_fill_static_iif(struct pim_upstream *up,
 		ZEBRA_CONNECT_DISTANCE_DEFAULT;
 	up->rpf.source_nexthop.mrib_route_metric = 0;
 	up->rpf.rpf_addr = PIMADDR_ANY;
+	pim_upstream_rpf_index(up);
+}
+
+/*
+ * The RPF index is sorted on the RPF interface and RPF'(S,G) recorded in
+ * the upstream, not on up->rpf itself, so it stays consistent while up->rpf
+ * is being updated.  This has to be called after every change to those.
+ */
+void pim_upstream_rpf_index(struct pim_upstream *up)
+{
+	struct pim_instance *pim = up->pim;
+
+	if (up->rpf_idx_ifp == up->rpf.source_nexthop.interface &&
+	    !pim_addr_cmp(up->rpf_idx_addr, up->rpf.rpf_addr))
+		return;
+
+	rb_pim_upstream_rpf_del(&pim->upstream_rpf_head, up);
+	up->rpf_idx_ifp = up->rpf.source_nexthop.interface;
+	up->rpf_idx_addr = up->rpf.rpf_addr;
+	rb_pim_upstream_rpf_add(&pim->upstream_rpf_head, up);
 }
 
 static struct pim_upstream *pim_upstream_new(struct pim_instance *pim,
@@ -837,6 +860,10 @@ static struct pim_upstream *pim_upstream_new(struct pim_instance *pim,
 		ch->upstream = up;
 
 	rb_pim_upstream_add(&pim->upstream_head, up);
+	/* not resolved yet: indexed with no RPF interface and RPF' */
+	rb_pim_upstream_rpf_add(&pim->upstream_rpf_head, up);
+	if (pim_addr_is_any(up->sg.src))
+		rb_pim_upstream_star_g_add(&pim->upstream_star_g_head, up);
 	/* Set up->upstream_addr as INADDR_ANY, if RP is not
 	 * configured and retain the upstream data structure
 	 */
@@ -1242,14 +1269,22 @@ void pim_upstream_update_join_desired(struct pim_instance *pim,
   it so that it expires after t_override seconds.
 */
 void pim_upstream_rpf_genid_changed(struct pim_instance *pim,
-				    pim_addr neigh_addr)
+				    struct interface *ifp, pim_addr neigh_addr)
 {
-	struct pim_upstream *up;
+	struct pim_upstream *up, lookup;
 
 	/*
-	 * Scan all (S,G) upstreams searching for RPF'(S,G)=neigh_addr
+	 * Scan the (S,G) upstreams with RPF'(S,G)=neigh_addr on ifp
 	 */
-	frr_each (rb_pim_upstream, &pim->upstream_head, up) {
+	memset(&lookup, 0, sizeof(lookup));
+	lookup.rpf_idx_ifp = ifp;
+	lookup.rpf_idx_addr = neigh_addr;
+
+	for (up = rb_pim_upstream_rpf_find_gteq(&pim->upstream_rpf_head,
+						&lookup);
+	     up && up->rpf_idx_ifp == ifp &&
+	     !pim_addr_cmp(up->rpf_idx_addr, neigh_addr);
+	     up = rb_pim_upstream_rpf_next(&pim->upstream_rpf_head, up)) {
 		pim_addr rpf_addr;
 
 		rpf_addr = up->rpf.rpf_addr;
@@ -1881,6 +1916,30 @@ void pim_upstream_find_new_rpf(struct pim_instance *pim)
 	struct pim_upstream *up;
 	struct pim_rpf old;
 	enum pim_rpf_result rpf_result;
+	struct pim_nexthop_cache *pnc;
+	pim_addr *addrs;
+	size_t count = 0;
+
+	/*
+	 * Resolve the addresses NHT has no answer for yet in one batch,
+	 * rather than with one zebra round trip each below.
+	 */
+	addrs = XCALLOC(MTYPE_TMP,
+			MAX(rb_pim_upstream_count(&pim->upstream_head), 1U) *
+				sizeof(*addrs));
+	frr_each (rb_pim_upstream, &pim->upstream_head, up) {
+		if (pim_addr_is_any(up->upstream_addr) ||
+		    !pim_rpf_addr_is_inaddr_any(&up->rpf))
+			continue;
+
+		old.rpf_addr = up->upstream_addr;
+		pnc = pim_nexthop_cache_find(pim, &old);
+		if (pnc && CHECK_FLAG(pnc->flags, PIM_NEXTHOP_ANSWER_RECEIVED))
+			continue;
+		addrs[count++] = up->upstream_addr;
+	}
+	zclient_lookup_nexthop_batch(pim, addrs, count);
+	XFREE(MTYPE_TMP, addrs);
 
 	/*
 	 * Scan all (S,G) upstreams searching for RPF'(S,G)=neigh_addr
@@ -1931,6 +1990,8 @@ void pim_upstream_terminate(struct pim_instance *pim)
 	}
 
 	rb_pim_upstream_fini(&pim->upstream_head);
+	rb_pim_upstream_rpf_fini(&pim->upstream_rpf_head);
+	rb_pim_upstream_star_g_fini(&pim->upstream_star_g_head);
 
 	if (pim->upstream_sg_wheel)
 		wheel_delete(pim->upstream_sg_wheel);
@@ -2162,4 +2223,6 @@ void pim_upstream_init(struct pim_instance *pim)
 			   pim_upstream_sg_running, name);
 
 	rb_pim_upstream_init(&pim->upstream_head);
+	rb_pim_upstream_rpf_init(&pim->upstream_rpf_head);
+	rb_pim_upstream_star_g_init(&pim->upstream_star_g_head);
 }
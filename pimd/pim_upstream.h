@@ -185,6 +185,8 @@ struct pim_up_mlag {
 };
 
 PREDECL_RBTREE_UNIQ(rb_pim_upstream);
+PREDECL_RBTREE_UNIQ(rb_pim_upstream_rpf);
+PREDECL_RBTREE_UNIQ(rb_pim_upstream_star_g);
 /*
   Upstream (S,G) channel in Joined state
   (S,G) in the "Not Joined" state is not represented
@@ -215,6 +217,14 @@ PREDECL_RBTREE_UNIQ(rb_pim_upstream);
 struct pim_upstream {
 	struct pim_instance *pim;
 	struct rb_pim_upstream_item upstream_rb;
+	/*
+	 * Secondary indexes: by RPF interface and RPF'(S,G) (as recorded in
+	 * rpf_idx_*, see pim_upstream_rpf_index()) and the (*,G) entries.
+	 */
+	struct rb_pim_upstream_rpf_item upstream_rpf_rb;
+	struct rb_pim_upstream_star_g_item upstream_star_g_rb;
+	struct interface *rpf_idx_ifp;
+	pim_addr rpf_idx_addr;
 	struct pim_upstream *parent;
 	pim_addr upstream_addr;		  /* Who we are talking to */
 	pim_addr upstream_register;       /*Who we received a register from*/
@@ -313,6 +323,7 @@ void pim_upstream_join_timer_decrease_to_t_override(const char *debug_label,
 void pim_upstream_join_timer_restart(struct pim_upstream *up,
 				     struct pim_rpf *old);
 void pim_upstream_rpf_genid_changed(struct pim_instance *pim,
+				    struct interface *ifp,
 				    pim_addr neigh_addr);
 void pim_upstream_rpf_interface_changed(struct pim_upstream *up,
 					struct interface *old_rpf_ifp);
@@ -361,6 +372,30 @@ int pim_upstream_compare(const struct pim_upstream *up1,
 			 const struct pim_upstream *up2);
 DECLARE_RBTREE_UNIQ(rb_pim_upstream, struct pim_upstream, upstream_rb,
 		    pim_upstream_compare);
+DECLARE_RBTREE_UNIQ(rb_pim_upstream_star_g, struct pim_upstream,
+		    upstream_star_g_rb, pim_upstream_compare);
+
+static inline int pim_upstream_rpf_compare(const struct pim_upstream *up1,
+					   const struct pim_upstream *up2)
+{
+	int ret;
+
+	if (up1->rpf_idx_ifp != up2->rpf_idx_ifp)
+		return (uintptr_t)up1->rpf_idx_ifp < (uintptr_t)up2->rpf_idx_ifp
+			       ? -1
+			       : 1;
+
+	ret = pim_addr_cmp(up1->rpf_idx_addr, up2->rpf_idx_addr);
+	if (ret)
+		return ret;
+
+	return pim_sgaddr_cmp(up1->sg, up2->sg);
+}
+DECLARE_RBTREE_UNIQ(rb_pim_upstream_rpf, struct pim_upstream, upstream_rpf_rb,
+		    pim_upstream_rpf_compare);
+
+/* (re)index up after up->rpf changed */
+void pim_upstream_rpf_index(struct pim_upstream *up);
 
 void pim_upstream_register_reevaluate(struct pim_instance *pim);
 
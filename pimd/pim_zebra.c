@@ -255,7 +255,7 @@ void pim_zebra_update_all_interfaces(struct pim_instance *pim)
 
 			rpf.source_nexthop.interface = ifp;
 			rpf.rpf_addr = us->address;
-			pim_joinprune_send(&rpf, us->us);
+			pim_joinprune_send(&rpf, us->us, NULL);
 			pim_jp_agg_clear_group(us->us);
 		}
 	}
@@ -15,6 +15,8 @@
 #include "prefix.h"
 #include "vty.h"
 #include "lib_errors.h"
+#include "jhash.h"
+#include "typesafe.h"
 
 #include "pimd.h"
 #include "pim_instance.h"
@@ -25,10 +27,110 @@
 #include "pim_oil.h"
 #include "pim_zlookup.h"
 #include "pim_addr.h"
+#include "pim_time.h"
+#include "pim_memory.h"
 
 static struct zclient *zlookup = NULL;
 struct event *zlookup_read;
 
+/*
+ * Results of zclient_lookup_nexthop(), so that many (S,G)/(*,G) entries
+ * resolving the same address do not each go to zebra.  Entries are valid
+ * until the next route change reported by NHT (last_route_change_time),
+ * the same rule pim_nexthop_lookup() uses for its last lookup.
+ */
+PREDECL_HASH(zlookup_cache);
+
+struct zlookup_entry {
+	struct zlookup_cache_item item;
+
+	struct pim_instance *pim;
+	pim_addr addr;
+	int64_t time;
+
+	int num_ifindex;
+	struct pim_zlookup_nexthop nexthop_tab[];
+};
+
+static int zlookup_entry_cmp(const struct zlookup_entry *a,
+			     const struct zlookup_entry *b)
+{
+	if (a->pim != b->pim)
+		return numcmp((uintptr_t)a->pim, (uintptr_t)b->pim);
+	return pim_addr_cmp(a->addr, b->addr);
+}
+
+static uint32_t zlookup_entry_hash(const struct zlookup_entry *e)
+{
+	return jhash(&e->addr, sizeof(e->addr), (uintptr_t)e->pim);
+}
+
+DECLARE_HASH(zlookup_cache, struct zlookup_entry, item, zlookup_entry_cmp,
+	     zlookup_entry_hash);
+
+static struct zlookup_cache_head zlookup_cache[1] = {
+	INIT_HASH(zlookup_cache[0]),
+};
+
+/* max. requests in flight on the lookup socket during a batch */
+#define ZLOOKUP_BATCH_WINDOW 64
+
+static struct zlookup_entry *zlookup_cache_get(struct pim_instance *pim,
+					       pim_addr addr)
+{
+	struct zlookup_entry ref = { .pim = pim, .addr = addr }, *e;
+
+	e = zlookup_cache_find(zlookup_cache, &ref);
+	if (!e || e->time <= pim->last_route_change_time)
+		return NULL;
+	return e;
+}
+
+static void zlookup_cache_put(struct pim_instance *pim, pim_addr addr,
+			      const struct pim_zlookup_nexthop nexthop_tab[],
+			      int num_ifindex)
+{
+	struct zlookup_entry ref = { .pim = pim, .addr = addr }, *e;
+
+	num_ifindex = MIN(num_ifindex, router->multipath);
+
+	e = zlookup_cache_find(zlookup_cache, &ref);
+	if (!e) {
+		e = XCALLOC(MTYPE_PIM_ZLOOKUP_CACHE,
+			    sizeof(*e) + router->multipath *
+						 sizeof(e->nexthop_tab[0]));
+		e->pim = pim;
+		e->addr = addr;
+		zlookup_cache_add(zlookup_cache, e);
+	}
+
+	e->time = pim_time_monotonic_usec();
+	e->num_ifindex = num_ifindex;
+	memcpy(e->nexthop_tab, nexthop_tab,
+	       num_ifindex * sizeof(e->nexthop_tab[0]));
+}
+
+/* drop what the last route changes made useless, pim NULL for all */
+static void zlookup_cache_sweep(struct pim_instance *pim, bool all)
+{
+	struct zlookup_entry *e;
+
+	frr_each_safe (zlookup_cache, zlookup_cache, e) {
+		if (pim && e->pim != pim)
+			continue;
+		if (!all && e->time > e->pim->last_route_change_time)
+			continue;
+
+		zlookup_cache_del(zlookup_cache, e);
+		XFREE(MTYPE_PIM_ZLOOKUP_CACHE, e);
+	}
+}
+
+void pim_zlookup_cache_flush(struct pim_instance *pim)
+{
+	zlookup_cache_sweep(pim, true);
+}
+
 static void zclient_lookup_sched(struct zclient *zlookup, int delay);
 static void zclient_lookup_read_pipe(struct event *thread);
 
@@ -114,6 +216,7 @@ static void zclient_lookup_failed(struct zclient *zlookup)
 
 void zclient_lookup_free(void)
 {
+	zlookup_cache_sweep(NULL, true);
 	EVENT_OFF(zlookup_read);
 	zclient_stop(zlookup);
 	zclient_free(zlookup);
@@ -307,18 +410,13 @@ static int zclient_read_nexthop(struct pim_instance *pim,
 	return num_ifindex;
 }
 
-static int zclient_lookup_nexthop_once(struct pim_instance *pim,
-				       struct pim_zlookup_nexthop nexthop_tab[],
-				       const int tab_size, pim_addr addr)
+static int zclient_lookup_nexthop_send(struct pim_instance *pim,
+				       pim_addr addr)
 {
 	struct stream *s;
 	int ret;
 	struct ipaddr ipaddr;
 
-	if (PIM_DEBUG_PIM_NHT_DETAIL)
-		zlog_debug("%s: addr=%pPAs(%s)", __func__, &addr,
-			   pim->vrf->name);
-
 	/* Check socket. */
 	if (zlookup->sock < 0) {
 		flog_err(EC_LIB_ZAPI_SOCKET,
@@ -361,6 +459,23 @@ static int zclient_lookup_nexthop_once(struct pim_instance *pim,
 		return -3;
 	}
 
+	return 0;
+}
+
+static int zclient_lookup_nexthop_once(struct pim_instance *pim,
+				       struct pim_zlookup_nexthop nexthop_tab[],
+				       const int tab_size, pim_addr addr)
+{
+	int ret;
+
+	if (PIM_DEBUG_PIM_NHT_DETAIL)
+		zlog_debug("%s: addr=%pPAs(%s)", __func__, &addr,
+			   pim->vrf->name);
+
+	ret = zclient_lookup_nexthop_send(pim, addr);
+	if (ret < 0)
+		return ret;
+
 	return zclient_read_nexthop(pim, zlookup, nexthop_tab, tab_size, addr);
 }
 
@@ -380,19 +495,18 @@ void zclient_lookup_read_pipe(struct event *thread)
 	zclient_lookup_nexthop_once(pim, nexthop_tab, 10, l);
 	event_add_timer(router->master, zclient_lookup_read_pipe, zlookup, 60,
 			&zlookup_read);
+
+	zlookup_cache_sweep(NULL, false);
 }
 
-int zclient_lookup_nexthop(struct pim_instance *pim,
-			   struct pim_zlookup_nexthop nexthop_tab[],
-			   const int tab_size, pim_addr addr,
-			   int max_lookup)
+static int zclient_lookup_nexthop_recursive(
+	struct pim_instance *pim, struct pim_zlookup_nexthop nexthop_tab[],
+	const int tab_size, pim_addr addr, int max_lookup)
 {
 	int lookup;
 	uint32_t route_metric = 0xFFFFFFFF;
 	uint8_t protocol_distance = 0xFF;
 
-	pim->nexthop_lookups++;
-
 	for (lookup = 0; lookup < max_lookup; ++lookup) {
 		int num_ifindex;
 		int first_ifindex;
@@ -477,6 +591,87 @@ int zclient_lookup_nexthop(struct pim_instance *pim,
 	return -2;
 }
 
+int zclient_lookup_nexthop(struct pim_instance *pim,
+			   struct pim_zlookup_nexthop nexthop_tab[],
+			   const int tab_size, pim_addr addr,
+			   int max_lookup)
+{
+	struct zlookup_entry *e;
+	int num_ifindex;
+
+	e = zlookup_cache_get(pim, addr);
+	if (e) {
+		pim->nexthop_lookups_avoided++;
+		num_ifindex = MIN(e->num_ifindex, tab_size);
+		memcpy(nexthop_tab, e->nexthop_tab,
+		       num_ifindex * sizeof(nexthop_tab[0]));
+		return num_ifindex;
+	}
+
+	pim->nexthop_lookups++;
+
+	num_ifindex = zclient_lookup_nexthop_recursive(pim, nexthop_tab,
+						       tab_size, addr,
+						       max_lookup);
+	/* failures are not kept, they may just be a lost zebra connection */
+	if (num_ifindex > 0)
+		zlookup_cache_put(pim, addr, nexthop_tab, num_ifindex);
+
+	return num_ifindex;
+}
+
+/*
+ * Resolve a batch of addresses into the cache before their users ask for
+ * them one by one.  The requests are pipelined on the lookup socket, up
+ * to ZLOOKUP_BATCH_WINDOW at a time, so a batch costs a few round trips
+ * instead of one per address; zebra answers in order.  Answers that need
+ * a recursive lookup are left for zclient_lookup_nexthop() to finish.
+ */
+void zclient_lookup_nexthop_batch(struct pim_instance *pim,
+				  const pim_addr *addrs, size_t count)
+{
+	struct pim_zlookup_nexthop nexthop_tab[router->multipath];
+	pim_addr sent[ZLOOKUP_BATCH_WINDOW];
+	size_t pos = 0, nsent, i, j;
+	int num_ifindex;
+
+	if (!zlookup || zlookup->sock < 0 || pim->vrf->vrf_id == VRF_UNKNOWN)
+		return;
+
+	while (pos < count) {
+		for (nsent = 0; pos < count && nsent < ZLOOKUP_BATCH_WINDOW;
+		     pos++) {
+			if (pim_addr_is_any(addrs[pos]) ||
+			    zlookup_cache_get(pim, addrs[pos]))
+				continue;
+			for (j = 0; j < nsent; j++)
+				if (!pim_addr_cmp(sent[j], addrs[pos]))
+					break;
+			if (j < nsent)
+				continue;
+
+			if (zclient_lookup_nexthop_send(pim, addrs[pos]) < 0)
+				return;
+			sent[nsent++] = addrs[pos];
+		}
+
+		for (i = 0; i < nsent; i++) {
+			pim->nexthop_lookups++;
+
+			memset(nexthop_tab, 0, sizeof(nexthop_tab));
+			num_ifindex = zclient_read_nexthop(pim, zlookup,
+							   nexthop_tab,
+							   router->multipath,
+							   sent[i]);
+			if (zlookup->sock < 0)
+				return;
+			if (num_ifindex > 0 && nexthop_tab[0].ifindex > 0)
+				zlookup_cache_put(pim, sent[i], nexthop_tab,
+						  num_ifindex);
+		}
+	}
+}
+
 void pim_zlookup_show_ip_multicast(struct vty *vty)
 {
 	vty_out(vty, "Zclient lookup socket: ");
@@ -485,6 +680,8 @@ void pim_zlookup_show_ip_multicast(struct vty *vty)
 	} else {
 		vty_out(vty, "<null zclient>\n");
 	}
+	vty_out(vty, "Zclient lookup cache: %zu entries\n",
+		zlookup_cache_count(zlookup_cache));
 }
 
 int pim_zlookup_sg_statistics(struct channel_oil *c_oil)
@@ -572,3 +769,105 @@ int pim_zlookup_sg_statistics(struct channel_oil *c_oil)
 
 	return 0;
 }
+
+/*
+ * Fetch the counters of all (S,G) entries in the vrf's multicast table with
+ * one request.  Zebra answers with as many messages as needed, the counters
+ * are stored in c_oil->stats of every channel oil found.
+ */
+int pim_zlookup_sg_statistics_bulk(struct pim_instance *pim)
+{
+	struct stream *s = zlookup->obuf;
+	uint16_t command = 0;
+	uint8_t flags = 0;
+	struct channel_oil *c_oil;
+	pim_sgaddr sg;
+	uint32_t count, i;
+	int suc = 0;
+	int ret;
+
+	if (zlookup->sock < 0) {
+		flog_err(EC_LIB_ZAPI_SOCKET,
+			 "%s: zclient lookup socket is not connected",
+			 __func__);
+		zclient_lookup_failed(zlookup);
+		return -1;
+	}
+
+	if (pim->vrf->vrf_id == VRF_UNKNOWN) {
+		zlog_notice("%s: VRF: %s does not fully exist yet, delaying lookup",
+			    __func__, pim->vrf->name);
+		return -1;
+	}
+
+	stream_reset(s);
+	zclient_create_header(s, ZEBRA_IPMR_ROUTE_STATS_BULK, pim->vrf->vrf_id);
+	stream_putl(s, PIM_AF);
+	stream_putw_at(s, 0, stream_get_endp(s));
+
+	ret = writen(zlookup->sock, s->data, stream_get_endp(s));
+	if (ret <= 0) {
+		flog_err(
+			EC_LIB_SOCKET,
+			"%s: writen() failure: %d writing to zclient lookup socket",
+			__func__, errno);
+		return -1;
+	}
+
+	s = zlookup->ibuf;
+
+	while (!CHECK_FLAG(flags, ZAPI_IPMR_STATS_BULK_LAST)) {
+		int err;
+		uint16_t length = 0;
+		vrf_id_t vrf_id;
+		uint8_t marker;
+		uint8_t version;
+
+		stream_reset(s);
+		err = zclient_read_header(s, zlookup->sock, &length, &marker,
+					  &version, &vrf_id, &command);
+		if (err < 0) {
+			flog_err(EC_LIB_ZAPI_MISSMATCH,
+				 "%s: zclient_read_header() failed", __func__);
+			zclient_lookup_failed(zlookup);
+			return -1;
+		}
+
+		if (command != ZEBRA_IPMR_ROUTE_STATS_BULK)
+			continue;
+
+		STREAM_GETC(s, flags);
+		STREAM_GETL(s, suc);
+		STREAM_GETL(s, count);
+
+		for (i = 0; i < count; i++) {
+			uint64_t lastused, pktcnt, bytecnt, wrong_if;
+
+			STREAM_GET(&sg.src, s, sizeof(pim_addr));
+			STREAM_GET(&sg.grp, s, sizeof(pim_addr));
+			STREAM_GETQ(s, lastused);
+			STREAM_GETQ(s, pktcnt);
+			STREAM_GETQ(s, bytecnt);
+			STREAM_GETQ(s, wrong_if);
+
+			c_oil = pim_find_channel_oil(pim, &sg);
+			if (!c_oil)
+				continue;
+
+			c_oil->stats.gen = pim->mroute_stats_gen;
+			c_oil->stats.lastused = lastused;
+			c_oil->stats.pktcnt = pktcnt;
+			c_oil->stats.bytecnt = bytecnt;
+			c_oil->stats.wrong_if = wrong_if;
+		}
+	}
+
+	return suc;
+
+stream_failure:
+	flog_err(EC_LIB_ZAPI_MISSMATCH,
+		 "%s: malformed mroute statistics from zebra(%s)", __func__,
+		 pim->vrf->name);
+	zclient_lookup_failed(zlookup);
+	return -1;
+}
@@ -31,7 +31,13 @@ int zclient_lookup_nexthop(struct pim_instance *pim,
 			   const int tab_size, pim_addr addr,
 			   int max_lookup);
 
+/* warm the lookup cache for many addresses at once */
+void zclient_lookup_nexthop_batch(struct pim_instance *pim,
+				  const pim_addr *addrs, size_t count);
+void pim_zlookup_cache_flush(struct pim_instance *pim);
+
 void pim_zlookup_show_ip_multicast(struct vty *vty);
 
 int pim_zlookup_sg_statistics(struct channel_oil *c_oil);
+int pim_zlookup_sg_statistics_bulk(struct pim_instance *pim);
 #endif /* PIM_ZLOOKUP_H */
@@ -147,6 +147,24 @@ static void rip_garbage_collect(struct event *t)
 
 static void rip_timeout_update(struct rip *rip, struct rip_info *rinfo);
 
+/*
+ * Set the route change flag, and remember the route so that the next
+ * triggered update doesn't have to walk the whole table.
+ */
+static void rip_route_changed(struct rip *rip, struct rip_info *rinfo)
+{
+	struct route_node *crn;
+
+	SET_FLAG(rinfo->flags, RIP_RTF_CHANGED);
+
+	crn = route_node_get(rip->changed, &rinfo->rp->p);
+	if (crn->info) {
+		route_unlock_node(crn);
+		return;
+	}
+	crn->info = route_lock_node(rinfo->rp);
+}
+
 /* Add new route to the ECMP list.
  * RETURN: the new entry added in the list, or NULL if it is not the first
  *         entry and ECMP is not allowed.
@@ -177,7 +195,7 @@ struct rip_info *rip_ecmp_add(struct rip *rip, struct rip_info *rinfo_new)
 
 	/* Set the route change flag on the first entry. */
 	rinfo = listgetdata(listhead(list));
-	SET_FLAG(rinfo->flags, RIP_RTF_CHANGED);
+	rip_route_changed(rip, rinfo);
 
 	/* Signal the output process to trigger an update (see section 2.5). */
 	rip_event(rip, RIP_TRIGGERED_UPDATE, 0);
@@ -228,7 +246,7 @@ struct rip_info *rip_ecmp_replace(struct rip *rip, struct rip_info *rinfo_new)
 	}
 
 	/* Set the route change flag. */
-	SET_FLAG(rinfo->flags, RIP_RTF_CHANGED);
+	rip_route_changed(rip, rinfo);
 
 	/* Signal the output process to trigger an update (see section 2.5). */
 	rip_event(rip, RIP_TRIGGERED_UPDATE, 0);
@@ -278,7 +296,7 @@ struct rip_info *rip_ecmp_delete(struct rip *rip, struct rip_info *rinfo)
 
 	/* Set the route change flag on the first entry. */
 	rinfo = listgetdata(listhead(list));
-	SET_FLAG(rinfo->flags, RIP_RTF_CHANGED);
+	rip_route_changed(rip, rinfo);
 
 	/* Signal the output process to trigger an update (see section 2.5). */
 	rip_event(rip, RIP_TRIGGERED_UPDATE, 0);
@@ -656,7 +674,7 @@ static void rip_rte_process(struct rte *rte, struct sockaddr_in *from,
 					/* - Set the route change flag on the
 					 * first entry. */
 					rinfo = listgetdata(listhead(list));
-					SET_FLAG(rinfo->flags, RIP_RTF_CHANGED);
+					rip_route_changed(rip, rinfo);
 					rip_event(rip, RIP_TRIGGERED_UPDATE, 0);
 				}
 			}
@@ -1599,7 +1617,7 @@ void rip_redistribute_delete(struct rip *rip, int type, int sub_type,
 					     rip_garbage_collect,
 					     rip->garbage_time);
 				EVENT_OFF(rinfo->t_timeout);
-				rinfo->flags |= RIP_RTF_CHANGED;
+				rip_route_changed(rip, rinfo);
 
 				if (IS_RIP_DEBUG_EVENT)
 					zlog_debug(
@@ -2022,6 +2040,8 @@ void rip_output_process(struct connected *ifc, struct sockaddr_in *to,
 	int ret;
 	struct stream *s;
 	struct route_node *rp;
+	struct route_node *crn;
+	struct route_table *table;
 	struct rip_info *rinfo;
 	struct rip_interface *ri;
 	struct prefix_ipv4 *p;
@@ -2093,7 +2113,14 @@ void rip_output_process(struct connected *ifc, struct sockaddr_in *to,
 			subnetted = 1;
 	}
 
-	for (rp = route_top(rip->table); rp; rp = route_next(rp)) {
+	/* A triggered update only needs to look at the changed routes. */
+	table = (route_type == rip_changed_route) ? rip->changed : rip->table;
+
+	for (crn = route_top(table); crn; crn = route_next(crn)) {
+		rp = (route_type == rip_changed_route) ? crn->info : crn;
+		if (rp == NULL)
+			continue;
+
 		list = rp->info;
 
 		if (list == NULL)
@@ -2497,25 +2524,28 @@ static void rip_update(struct event *t)
 	rip_event(rip, RIP_UPDATE_EVENT, 0);
 }
 
-/* Walk down the RIP routing table then clear changed flag. */
+/* Walk down the changed routes then clear changed flag. */
 static void rip_clear_changed_flag(struct rip *rip)
 {
-	struct route_node *rp;
+	struct route_node *crn, *rp;
 	struct rip_info *rinfo = NULL;
 	struct list *list = NULL;
 	struct listnode *listnode = NULL;
 
-	for (rp = route_top(rip->table); rp; rp = route_next(rp)) {
-		list = rp->info;
-
-		if (list == NULL)
+	for (crn = route_top(rip->changed); crn; crn = route_next(crn)) {
+		rp = crn->info;
+		if (rp == NULL)
 			continue;
 
-		for (ALL_LIST_ELEMENTS_RO(list, listnode, rinfo)) {
-			UNSET_FLAG(rinfo->flags, RIP_RTF_CHANGED);
-			/* This flag can be set only on the first entry. */
-			break;
+		list = rp->info;
+		if (list) {
+			for (ALL_LIST_ELEMENTS_RO(list, listnode, rinfo))
+				UNSET_FLAG(rinfo->flags, RIP_RTF_CHANGED);
 		}
+
+		crn->info = NULL;
+		route_unlock_node(rp);
+		route_unlock_node(crn);
 	}
 }
 
@@ -2588,7 +2618,7 @@ void rip_redistribute_withdraw(struct rip *rip, int type)
 		RIP_TIMER_ON(rinfo->t_garbage_collect, rip_garbage_collect,
 			     rip->garbage_time);
 		EVENT_OFF(rinfo->t_timeout);
-		rinfo->flags |= RIP_RTF_CHANGED;
+		rip_route_changed(rip, rinfo);
 
 		if (IS_RIP_DEBUG_EVENT) {
 			struct prefix_ipv4 *p = (struct prefix_ipv4 *)&rp->p;
@@ -2654,6 +2684,7 @@ struct rip *rip_create(const char *vrf_name, struct vrf *vrf, int socket)
 	/* Initialize RIP data structures. */
 	rip->table = route_table_init();
 	route_table_set_info(rip->table, rip);
+	rip->changed = route_table_init();
 	rip->neighbor = route_table_init();
 	rip->peer_list = list_new();
 	rip->peer_list->cmp = (int (*)(void *, void *))rip_peer_list_cmp;
@@ -2909,7 +2940,7 @@ void rip_ecmp_disable(struct rip *rip)
 		rip_zebra_ipv4_add(rip, rp);
 
 		/* Set the route change flag. */
-		SET_FLAG(rinfo->flags, RIP_RTF_CHANGED);
+		rip_route_changed(rip, rinfo);
 
 		/* Signal the output process to trigger an update. */
 		rip_event(rip, RIP_TRIGGERED_UPDATE, 0);
@@ -3332,6 +3363,8 @@ void rip_clean(struct rip *rip)
 		if (rip->redist[i].route_map.name)
 			free(rip->redist[i].route_map.name);
 
+	rip_clear_changed_flag(rip);
+	route_table_finish(rip->changed);
 	route_table_finish(rip->table);
 	route_table_finish(rip->neighbor);
 	list_delete(&rip->peer_list);
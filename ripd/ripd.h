@@ -110,6 +110,11 @@ struct rip {
 	/* RIP routing information base. */
 	struct route_table *table;
 
+	/* Routes changed since the last triggered update, pointing to their
+	 * node in the table above.
+	 */
+	struct route_table *changed;
+
 	/* RIP static neighbors. */
 	struct route_table *neighbor;
 
@@ -434,6 +434,24 @@ static void ripng_garbage_collect(struct event *t)
 
 static void ripng_timeout_update(struct ripng *ripng, struct ripng_info *rinfo);
 
+/*
+ * Set the route change flag, and remember the route so that the next
+ * triggered update doesn't have to walk the whole table.
+ */
+static void ripng_route_changed(struct ripng *ripng, struct ripng_info *rinfo)
+{
+	struct route_node *crn;
+
+	SET_FLAG(rinfo->flags, RIPNG_RTF_CHANGED);
+
+	crn = route_node_get(ripng->changed, agg_node_get_prefix(rinfo->rp));
+	if (crn->info) {
+		route_unlock_node(crn);
+		return;
+	}
+	crn->info = agg_lock_node(rinfo->rp);
+}
+
 /* Add new route to the ECMP list.
  * RETURN: the new entry added in the list, or NULL if it is not the first
  *         entry and ECMP is not allowed.
@@ -467,7 +485,7 @@ struct ripng_info *ripng_ecmp_add(struct ripng *ripng,
 
 	/* Set the route change flag on the first entry. */
 	rinfo = listgetdata(listhead(list));
-	SET_FLAG(rinfo->flags, RIPNG_RTF_CHANGED);
+	ripng_route_changed(ripng, rinfo);
 
 	/* Signal the output process to trigger an update. */
 	ripng_event(ripng, RIPNG_TRIGGERED_UPDATE, 0);
@@ -522,7 +540,7 @@ struct ripng_info *ripng_ecmp_replace(struct ripng *ripng,
 	ripng_aggregate_increment(rp, rinfo);
 
 	/* Set the route change flag. */
-	SET_FLAG(rinfo->flags, RIPNG_RTF_CHANGED);
+	ripng_route_changed(ripng, rinfo);
 
 	/* Signal the output process to trigger an update. */
 	ripng_event(ripng, RIPNG_TRIGGERED_UPDATE, 0);
@@ -576,7 +594,7 @@ struct ripng_info *ripng_ecmp_delete(struct ripng *ripng,
 
 	/* Set the route change flag on the first entry. */
 	rinfo = listgetdata(listhead(list));
-	SET_FLAG(rinfo->flags, RIPNG_RTF_CHANGED);
+	ripng_route_changed(ripng, rinfo);
 
 	/* Signal the output process to trigger an update. */
 	ripng_event(ripng, RIPNG_TRIGGERED_UPDATE, 0);
@@ -1012,7 +1030,7 @@ void ripng_redistribute_delete(struct ripng *ripng, int type, int sub_type,
 				/* Aggregate count decrement. */
 				ripng_aggregate_decrement(rp, rinfo);
 
-				rinfo->flags |= RIPNG_RTF_CHANGED;
+				ripng_route_changed(ripng, rinfo);
 
 				if (IS_RIPNG_DEBUG_EVENT)
 					zlog_debug(
@@ -1051,7 +1069,7 @@ void ripng_redistribute_withdraw(struct ripng *ripng, int type)
 				/* Aggregate count decrement. */
 				ripng_aggregate_decrement(rp, rinfo);
 
-				rinfo->flags |= RIPNG_RTF_CHANGED;
+				ripng_route_changed(ripng, rinfo);
 
 				if (IS_RIPNG_DEBUG_EVENT) {
 					struct prefix_ipv6 *p =
@@ -1370,22 +1388,28 @@ static void ripng_read(struct event *thread)
 	}
 }
 
-/* Walk down the RIPng routing table then clear changed flag. */
+/* Walk down the changed routes then clear changed flag. */
 static void ripng_clear_changed_flag(struct ripng *ripng)
 {
+	struct route_node *crn;
 	struct agg_node *rp;
 	struct ripng_info *rinfo = NULL;
 	struct list *list = NULL;
 	struct listnode *listnode = NULL;
 
-	for (rp = agg_route_top(ripng->table); rp; rp = agg_route_next(rp))
+	for (crn = route_top(ripng->changed); crn; crn = route_next(crn)) {
+		rp = crn->info;
+		if (rp == NULL)
+			continue;
+
 		if ((list = rp->info) != NULL)
-			for (ALL_LIST_ELEMENTS_RO(list, listnode, rinfo)) {
+			for (ALL_LIST_ELEMENTS_RO(list, listnode, rinfo))
 				UNSET_FLAG(rinfo->flags, RIPNG_RTF_CHANGED);
-				/* This flag can be set only on the first entry.
-				 */
-				break;
-			}
+
+		crn->info = NULL;
+		agg_unlock_node(rp);
+		route_unlock_node(crn);
+	}
 }
 
 /* Regular update of RIPng route.  Send all routing formation to RIPng
@@ -1532,6 +1556,8 @@ void ripng_output_process(struct interface *ifp, struct sockaddr_in6 *to,
 	struct ripng *ripng;
 	int ret;
 	struct agg_node *rp;
+	struct route_node *crn;
+	struct route_table *table;
 	struct ripng_info *rinfo;
 	struct ripng_interface *ri;
 	struct ripng_aggregate *aggregate;
@@ -1555,7 +1581,17 @@ void ripng_output_process(struct interface *ifp, struct sockaddr_in6 *to,
 
 	ripng_rte_list = ripng_rte_new();
 
-	for (rp = agg_route_top(ripng->table); rp; rp = agg_route_next(rp)) {
+	/* A triggered update only needs to look at the changed routes. */
+	table = (route_type == ripng_changed_route) ? ripng->changed
+						     : ripng->table->route_table;
+
+	for (crn = route_top(table); crn; crn = route_next(crn)) {
+		rp = (route_type == ripng_changed_route)
+			     ? crn->info
+			     : agg_node_from_rnode(crn);
+		if (rp == NULL)
+			continue;
+
 		if ((list = rp->info) != NULL
 		    && (rinfo = listgetdata(listhead(list))) != NULL
 		    && rinfo->suppress == 0) {
@@ -1822,6 +1858,7 @@ struct ripng *ripng_create(const char *vrf_name, struct vrf *vrf, int socket)
 
 	/* Initialize RIPng data structures. */
 	ripng->table = agg_table_init();
+	ripng->changed = route_table_init();
 	agg_set_table_info(ripng->table, ripng);
 	ripng->peer_list = list_new();
 	ripng->peer_list->cmp = (int (*)(void *, void *))ripng_peer_list_cmp;
@@ -2204,7 +2241,7 @@ void ripng_ecmp_disable(struct ripng *ripng)
 			ripng_zebra_ipv6_add(ripng, rp);
 
 			/* Set the route change flag. */
-			SET_FLAG(rinfo->flags, RIPNG_RTF_CHANGED);
+			ripng_route_changed(ripng, rinfo);
 
 			/* Signal the output process to trigger an update. */
 			ripng_event(ripng, RIPNG_TRIGGERED_UPDATE, 0);
@@ -2349,6 +2386,8 @@ void ripng_clean(struct ripng *ripng)
 		if (ripng->redist[i].route_map.name)
 			free(ripng->redist[i].route_map.name);
 
+	ripng_clear_changed_flag(ripng);
+	route_table_finish(ripng->changed);
 	agg_table_finish(ripng->table);
 	list_delete(&ripng->peer_list);
 	distribute_list_delete(&ripng->distribute_ctx);
@@ -105,6 +105,11 @@ struct ripng {
 	/* RIPng routing information base. */
 	struct agg_table *table;
 
+	/* Routes changed since the last triggered update, pointing to their
+	 * node in the table above.
+	 */
+	struct route_table *changed;
+
 	/* Linked list of RIPng peers. */
 	struct list *peer_list;
 
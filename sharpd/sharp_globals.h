@@ -11,6 +11,23 @@
 
 DECLARE_MGROUP(SHARPD);
 
+/* Latency histogram, bucket i counts samples of [2^i, 2^(i+1)) usec */
+#define SHARP_LAT_BUCKETS 32
+
+struct sharp_latency {
+	uint64_t hist[SHARP_LAT_BUCKETS];
+	uint64_t count;
+	uint64_t sum;
+	uint64_t min;
+	uint64_t max;
+};
+
+enum sharp_latency_type {
+	SHARP_LAT_INSTALL,
+	SHARP_LAT_REMOVE,
+	SHARP_LAT_MAX,
+};
+
 struct sharp_routes {
 	/* The original prefix for route installation */
 	struct prefix orig_prefix;
@@ -36,6 +53,18 @@ struct sharp_routes {
 	struct timeval t_start;
 	struct timeval t_end;
 
+	/*
+	 * Send time in usec of each route of the current run, indexed by
+	 * the offset from lat_base, cleared once zebra notified about it.
+	 */
+	uint64_t *sent_usec;
+	uint32_t sent_alloc;
+	uint32_t lat_routes;
+	struct prefix lat_base;
+
+	/* Zebra notification latency, across repeats of a command */
+	struct sharp_latency lat[SHARP_LAT_MAX];
+
 	char opaque[ZAPI_MESSAGE_OPAQUE_LENGTH];
 };
 
@@ -15,6 +15,13 @@
 #include "vrf.h"
 #include "zclient.h"
 #include "frr_pthread.h"
+#include "json.h"
+#include "libfrr.h"
+#include "zlog_targets.h"
+#include "zlog_5424.h"
+#include "zlog_live.h"
+
+#include <sys/un.h>
 
 #include "sharpd/sharp_vty.h"
 
@@ -27,6 +34,8 @@ static unsigned lp_burst;
 static size_t lp_ctr, lp_expect;
 static struct rusage lp_rusage;
 static struct vty *lp_vty;
+/* "sharp logpump benchmark" below is running */
+static bool lpb_active;
 
 extern struct event_loop *master;
 
@@ -123,7 +132,7 @@ static const struct frr_pthread_attr attr = {
 void sharp_logpump_run(struct vty *vty, unsigned duration, unsigned frequency,
 		       unsigned burst)
 {
-	if (lpt != NULL) {
+	if (lpt != NULL || lpb_active) {
 		vty_out(vty, "logpump already running\n");
 		return;
 	}
@@ -141,3 +150,536 @@ void sharp_logpump_run(struct vty *vty, unsigned duration, unsigned frequency,
 	lpt = frr_pthread_new(&attr, "logpump", "logpump");
 	frr_pthread_run(lpt, NULL);
 }
+
+/*
+ * "sharp logpump benchmark": the same load against each log target in turn.
+ * Every run has a number of pthreads log a fixed number of messages as fast
+ * as they can, for each of the payload sizes below.  Runs are sequenced from
+ * the main event loop, and a timer on it measures how late it gets to run
+ * while the pthreads are busy logging.
+ *
+ * The targets are set up privately for the benchmark, the log configuration
+ * of the daemon is left alone - anything it has at debug level gets all the
+ * messages too, and shows up in every result including "none".
+ */
+enum lpb_target {
+	LPB_NONE = 0,
+	LPB_FILE,
+	LPB_FILE_ASYNC,
+	LPB_SYSLOG,
+	LPB_5424_UNIX,
+	LPB_LIVE,
+};
+#define LPB_TARGET_MAX (LPB_LIVE + 1)
+
+static const char *const lpb_target_names[LPB_TARGET_MAX] = {
+	[LPB_NONE] = "none",
+	[LPB_FILE] = "file",
+	[LPB_FILE_ASYNC] = "file-async",
+	[LPB_SYSLOG] = "syslog",
+	[LPB_5424_UNIX] = "5424-unix",
+	[LPB_LIVE] = "live",
+};
+
+/* bytes of payload appended to each message */
+static const size_t lpb_sizes[] = { 32, 256, 1024, 4096 };
+static char lpb_payload[4096];
+
+#define LPB_THREADS_MAX	 16
+#define LPB_TICK_MSEC	 10
+/* for sinks and asynchronous writers to catch up before collecting */
+#define LPB_SETTLE_MSEC	 100
+/* event loop latency at which a tick counts as late */
+#define LPB_LATE_USEC	 1000
+
+struct lpb_thread {
+	struct frr_pthread *fpt;
+	size_t msgs;
+	uint64_t cpu_nsec;
+};
+
+static struct lpb {
+	struct vty *vty;
+	bool use_json;
+	size_t count;
+	unsigned int nthreads;
+	unsigned int targets;
+
+	/* current run */
+	enum lpb_target target;
+	size_t size_idx;
+	struct lpb_thread threads[LPB_THREADS_MAX];
+	unsigned int running;
+	bool collect;
+	struct timeval start;
+	int64_t wall_usec;
+
+	struct event *t_tick, *t_next;
+	struct timeval tick_sched;
+	uint64_t lat_samples, lat_sum, lat_max, lat_late;
+
+	char dir[256];
+	char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+	struct zlog_cfg_file zcf;
+	struct zlog_cfg_5424 z5424;
+	struct zlog_live_cfg live;
+	int syslog_prio;
+
+	/* reads from 5424-unix and live, counting what got through */
+	struct frr_pthread *sink;
+	int sink_fd;
+	atomic_bool sink_stop;
+	atomic_size_t sink_msgs, sink_bytes;
+
+	json_object *json, *json_targets, *json_runs;
+} lpb;
+
+static void lpb_next(struct event *event);
+
+static int lpb_join(struct frr_pthread *fpt, void **res)
+{
+	return pthread_join(fpt->thread, res);
+}
+
+static void lpb_pump_done(struct event *event)
+{
+	if (--lpb.running)
+		return;
+
+	lpb.wall_usec = monotime_since(&lpb.start, NULL);
+	lpb.collect = true;
+	event_cancel(&lpb.t_tick);
+	event_add_timer_msec(master, lpb_next, NULL, LPB_SETTLE_MSEC,
+			     &lpb.t_next);
+}
+
+static void *lpb_pump_run(void *arg)
+{
+	struct frr_pthread *fpt = arg;
+	struct lpb_thread *lt = fpt->data;
+	int size = lpb_sizes[lpb.size_idx];
+	struct timespec cpu;
+	size_t i;
+
+	zlog_tls_buffer_init();
+
+	for (i = 0; i < lpb.count; i++)
+		zlog_debug("log pump: %zu %.*s", i, size, lpb_payload);
+
+	zlog_tls_buffer_fini();
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+	lt->msgs = i;
+	lt->cpu_nsec = cpu.tv_sec * 1000000000ULL + cpu.tv_nsec;
+
+	event_add_event(master, lpb_pump_done, NULL, 0, NULL);
+	return NULL;
+}
+
+static const struct frr_pthread_attr lpb_pump_attr = {
+	.start = lpb_pump_run,
+	.stop = lpb_join,
+};
+
+static void *lpb_sink_run(void *arg)
+{
+	struct pollfd pfd = { .fd = lpb.sink_fd, .events = POLLIN };
+	char buf[8192];
+	ssize_t n;
+
+	while (!atomic_load_explicit(&lpb.sink_stop, memory_order_relaxed)) {
+		if (poll(&pfd, 1, 100) <= 0)
+			continue;
+
+		while ((n = recv(lpb.sink_fd, buf, sizeof(buf), MSG_DONTWAIT)) >
+		       0) {
+			atomic_fetch_add_explicit(&lpb.sink_msgs, 1,
+						  memory_order_relaxed);
+			atomic_fetch_add_explicit(&lpb.sink_bytes, n,
+						  memory_order_relaxed);
+		}
+	}
+	return NULL;
+}
+
+static const struct frr_pthread_attr lpb_sink_attr = {
+	.start = lpb_sink_run,
+	.stop = lpb_join,
+};
+
+static void lpb_sink_start(int fd)
+{
+	lpb.sink_fd = fd;
+	atomic_store_explicit(&lpb.sink_stop, false, memory_order_relaxed);
+	lpb.sink = frr_pthread_new(&lpb_sink_attr, "logpump sink",
+				   "logpump-sink");
+	frr_pthread_run(lpb.sink, NULL);
+}
+
+static void lpb_sink_stop(void)
+{
+	if (lpb.sink) {
+		atomic_store_explicit(&lpb.sink_stop, true,
+				      memory_order_relaxed);
+		frr_pthread_stop(lpb.sink, NULL);
+		frr_pthread_destroy(lpb.sink);
+		lpb.sink = NULL;
+	}
+	if (lpb.sink_fd != -1)
+		close(lpb.sink_fd);
+	lpb.sink_fd = -1;
+}
+
+static int lpb_unix_sink(const char *path)
+{
+	struct sockaddr_un sun = { .sun_family = AF_UNIX };
+	int fd, bufsize = 4 * 1024 * 1024;
+
+	strlcpy(sun.sun_path, path, sizeof(sun.sun_path));
+
+	fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+	if (fd < 0)
+		return -1;
+	if (bind(fd, (struct sockaddr *)&sun, sizeof(sun))) {
+		close(fd);
+		return -1;
+	}
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+	return fd;
+}
+
+static bool lpb_target_start(enum lpb_target target)
+{
+	int fd;
+
+	switch (target) {
+	case LPB_NONE:
+		return true;
+
+	case LPB_FILE:
+	case LPB_FILE_ASYNC:
+		snprintf(lpb.path, sizeof(lpb.path), "%s/file.log", lpb.dir);
+		zlog_file_init(&lpb.zcf);
+		lpb.zcf.prio_min = LOG_DEBUG;
+		if (target == LPB_FILE_ASYNC)
+			lpb.zcf.async_limit = 1024;
+		return zlog_file_set_filename(&lpb.zcf, lpb.path);
+
+	case LPB_SYSLOG:
+		lpb.syslog_prio = zlog_syslog_get_prio_min();
+		zlog_syslog_set_prio_min(LOG_DEBUG);
+		return true;
+
+	case LPB_5424_UNIX:
+		snprintf(lpb.path, sizeof(lpb.path), "%s/5424.sock", lpb.dir);
+		fd = lpb_unix_sink(lpb.path);
+		if (fd < 0)
+			return false;
+		lpb_sink_start(fd);
+
+		memset(&lpb.z5424, 0, sizeof(lpb.z5424));
+		zlog_5424_init(&lpb.z5424);
+		lpb.z5424.facility = LOG_DAEMON;
+		lpb.z5424.prio_min = LOG_DEBUG;
+		lpb.z5424.fmt = ZLOG_FMT_5424;
+		lpb.z5424.dst = ZLOG_5424_DST_UNIX;
+		lpb.z5424.filename = lpb.path;
+		lpb.z5424.file_uid = (uid_t)-1;
+		lpb.z5424.file_gid = (gid_t)-1;
+		lpb.z5424.master = master;
+		return zlog_5424_apply_dst(&lpb.z5424);
+
+	case LPB_LIVE:
+		zlog_live_open(&lpb.live, LOG_DEBUG, &fd);
+		if (zlog_live_is_null(&lpb.live))
+			return false;
+		lpb_sink_start(fd);
+		return true;
+	}
+
+	return false;
+}
+
+static void lpb_target_stop(enum lpb_target target)
+{
+	switch (target) {
+	case LPB_NONE:
+		break;
+
+	case LPB_FILE:
+	case LPB_FILE_ASYNC:
+		zlog_file_fini(&lpb.zcf);
+		unlink(lpb.path);
+		break;
+
+	case LPB_SYSLOG:
+		zlog_syslog_set_prio_min(lpb.syslog_prio);
+		break;
+
+	case LPB_5424_UNIX:
+		zlog_5424_fini(&lpb.z5424, false);
+		lpb_sink_stop();
+		unlink(lpb.path);
+		break;
+
+	case LPB_LIVE:
+		zlog_live_close(&lpb.live);
+		lpb_sink_stop();
+		break;
+	}
+}
+
+static void lpb_tick(struct event *event)
+{
+	int64_t lat;
+
+	lat = monotime_since(&lpb.tick_sched, NULL) - LPB_TICK_MSEC * 1000;
+	if (lat < 0)
+		lat = 0;
+
+	lpb.lat_samples++;
+	lpb.lat_sum += lat;
+	lpb.lat_max = MAX(lpb.lat_max, (uint64_t)lat);
+	if (lat >= LPB_LATE_USEC)
+		lpb.lat_late++;
+
+	monotime(&lpb.tick_sched);
+	event_add_timer_msec(master, lpb_tick, NULL, LPB_TICK_MSEC,
+			     &lpb.t_tick);
+}
+
+static void lpb_run_start(void)
+{
+	unsigned int i;
+
+	atomic_store_explicit(&lpb.sink_msgs, 0, memory_order_relaxed);
+	atomic_store_explicit(&lpb.sink_bytes, 0, memory_order_relaxed);
+	lpb.lat_samples = lpb.lat_sum = lpb.lat_max = lpb.lat_late = 0;
+
+	monotime(&lpb.tick_sched);
+	event_add_timer_msec(master, lpb_tick, NULL, LPB_TICK_MSEC,
+			     &lpb.t_tick);
+
+	monotime(&lpb.start);
+	lpb.running = lpb.nthreads;
+	for (i = 0; i < lpb.nthreads; i++) {
+		struct lpb_thread *lt = &lpb.threads[i];
+		char name[16];
+
+		snprintf(name, sizeof(name), "logpump%u", i);
+		memset(lt, 0, sizeof(*lt));
+		lt->fpt = frr_pthread_new(&lpb_pump_attr, name, name);
+		lt->fpt->data = lt;
+		frr_pthread_run(lt->fpt, NULL);
+	}
+}
+
+/* results of the run that just finished */
+static void lpb_run_collect(void)
+{
+	size_t size = lpb_sizes[lpb.size_idx];
+	size_t msgs = 0, lost = 0;
+	ssize_t delivered = -1;
+	uint64_t cpu_nsec = 0, dropped, delayed;
+	size_t depth;
+	double rate, cpu_per_msg, lat_avg;
+	json_object *jr;
+	struct stat st;
+	unsigned int i;
+
+	for (i = 0; i < lpb.nthreads; i++) {
+		struct lpb_thread *lt = &lpb.threads[i];
+
+		frr_pthread_stop(lt->fpt, NULL);
+		frr_pthread_destroy(lt->fpt);
+		lt->fpt = NULL;
+
+		msgs += lt->msgs;
+		cpu_nsec += lt->cpu_nsec;
+	}
+
+	rate = (double)msgs * 1000000. / (double)MAX(lpb.wall_usec, 1);
+	cpu_per_msg = (double)cpu_nsec / (double)MAX(msgs, 1);
+	lat_avg = (double)lpb.lat_sum / (double)MAX(lpb.lat_samples, 1);
+
+	jr = json_object_new_object();
+	json_object_int_add(jr, "payloadBytes", size);
+	json_object_int_add(jr, "messages", msgs);
+	json_object_int_add(jr, "wallUsecs", lpb.wall_usec);
+	json_object_double_add(jr, "messagesPerSecond", rate);
+	json_object_double_add(jr, "cpuNsecsPerMessage", cpu_per_msg);
+	json_object_int_add(jr, "eventLoopSamples", lpb.lat_samples);
+	json_object_double_add(jr, "eventLoopLatencyAvgUsecs", lat_avg);
+	json_object_int_add(jr, "eventLoopLatencyMaxUsecs", lpb.lat_max);
+	json_object_int_add(jr, "eventLoopLateSamples", lpb.lat_late);
+
+	switch (lpb.target) {
+	case LPB_NONE:
+	case LPB_SYSLOG:
+		break;
+
+	case LPB_FILE:
+	case LPB_FILE_ASYNC:
+		delivered = msgs;
+		if (zlog_file_async_stats(&lpb.zcf, &depth, &dropped,
+					  &delayed)) {
+			delivered = msgs - MIN(dropped, msgs);
+			json_object_int_add(jr, "asyncDelayed", delayed);
+		}
+		if (!stat(lpb.path, &st))
+			json_object_int_add(jr, "outputBytes", st.st_size);
+		/* start over for the next run, the file is in append mode */
+		if (truncate(lpb.path, 0))
+			zlog_warn("logpump: could not truncate %s: %s",
+				  lpb.path, safe_strerror(errno));
+		break;
+
+	case LPB_5424_UNIX:
+		zlog_5424_state(&lpb.z5424, &lost, NULL, NULL, NULL);
+		json_object_int_add(jr, "lost", lost);
+		/* fallthru */
+	case LPB_LIVE:
+		delivered = atomic_load_explicit(&lpb.sink_msgs,
+						 memory_order_relaxed);
+		json_object_int_add(jr, "outputBytes",
+				    atomic_load_explicit(&lpb.sink_bytes,
+							 memory_order_relaxed));
+		break;
+	}
+
+	if (delivered >= 0)
+		json_object_int_add(jr, "delivered", delivered);
+	json_object_array_add(lpb.json_runs, jr);
+
+	if (lpb.use_json)
+		return;
+
+	vty_out(lpb.vty, "%-10s %7zu %12.0f %11.1f",
+		lpb_target_names[lpb.target], size, rate, cpu_per_msg);
+	if (delivered >= 0)
+		vty_out(lpb.vty, " %9.1f%%",
+			(double)delivered * 100. / (double)MAX(msgs, 1));
+	else
+		vty_out(lpb.vty, " %10s", "-");
+	vty_out(lpb.vty, " %9.1f %9" PRIu64 " %6" PRIu64 "\n", lat_avg,
+		lpb.lat_max, lpb.lat_late);
+}
+
+static void lpb_finish(void)
+{
+	if (rmdir(lpb.dir))
+		zlog_warn("logpump: could not remove %s: %s", lpb.dir,
+			  safe_strerror(errno));
+
+	if (lpb.use_json)
+		vty_json(lpb.vty, lpb.json);
+	else {
+		vty_out(lpb.vty, "\nlogpump benchmark done\n");
+		json_object_free(lpb.json);
+	}
+	lpb.json = NULL;
+	lpb_active = false;
+}
+
+/* collects the last run if any, then starts the next or finishes */
+static void lpb_next(struct event *event)
+{
+	json_object *jt;
+
+	if (lpb.collect) {
+		lpb_run_collect();
+		lpb.collect = false;
+
+		if (++lpb.size_idx == array_size(lpb_sizes)) {
+			lpb_target_stop(lpb.target);
+			lpb.size_idx = 0;
+			lpb.target++;
+		}
+	}
+
+	while (lpb.target < LPB_TARGET_MAX &&
+	       !CHECK_FLAG(lpb.targets, 1U << lpb.target))
+		lpb.target++;
+
+	if (lpb.target == LPB_TARGET_MAX) {
+		lpb_finish();
+		return;
+	}
+
+	if (lpb.size_idx == 0) {
+		jt = json_object_new_object();
+		json_object_object_add(lpb.json_targets,
+				       lpb_target_names[lpb.target], jt);
+
+		if (!lpb_target_start(lpb.target)) {
+			json_object_string_add(jt, "error",
+					       "could not set up target");
+			if (!lpb.use_json)
+				vty_out(lpb.vty,
+					"%-10s could not set up target\n",
+					lpb_target_names[lpb.target]);
+
+			lpb_target_stop(lpb.target);
+			lpb.target++;
+			event_add_event(master, lpb_next, NULL, 0, &lpb.t_next);
+			return;
+		}
+
+		lpb.json_runs = json_object_new_array();
+		json_object_object_add(jt, "runs", lpb.json_runs);
+	}
+
+	lpb_run_start();
+}
+
+void sharp_logpump_benchmark(struct vty *vty, size_t count,
+			     unsigned int threads, const char *target,
+			     bool json)
+{
+	enum lpb_target i;
+
+	if (lpt != NULL || lpb_active) {
+		vty_out(vty, "logpump already running\n");
+		return;
+	}
+
+	memset(&lpb, 0, sizeof(lpb));
+	lpb.sink_fd = -1;
+
+	for (i = 0; i < LPB_TARGET_MAX; i++)
+		if (!target || strmatch(target, lpb_target_names[i]))
+			SET_FLAG(lpb.targets, 1U << i);
+
+	snprintf(lpb.dir, sizeof(lpb.dir), "%s/logpump.XXXXXX", frr_vtydir);
+	if (!mkdtemp(lpb.dir)) {
+		vty_out(vty, "%% could not create %s: %s\n", lpb.dir,
+			safe_strerror(errno));
+		return;
+	}
+
+	memset(lpb_payload, 'x', sizeof(lpb_payload));
+
+	lpb_active = true;
+	lpb.vty = vty;
+	lpb.use_json = json;
+	lpb.count = count;
+	lpb.nthreads = MIN(threads, LPB_THREADS_MAX);
+
+	lpb.json = json_object_new_object();
+	json_object_int_add(lpb.json, "threads", lpb.nthreads);
+	json_object_int_add(lpb.json, "messagesPerThread", count);
+	json_object_int_add(lpb.json, "eventLoopTickMsecs", LPB_TICK_MSEC);
+	lpb.json_targets = json_object_new_object();
+	json_object_object_add(lpb.json, "targets", lpb.json_targets);
+
+	if (!json) {
+		vty_out(vty, "starting logpump benchmark...\n");
+		vty_out(vty,
+			"keep this VTY open and press Enter to see results\n\n");
+		vty_out(vty, "%-10s %7s %12s %11s %10s %9s %9s %6s\n",
+			"Target", "Payload", "Msgs/s", "CPU ns/msg",
+			"Delivered", "Loop avg", "Loop max", "Late");
+	}
+
+	event_add_event(master, lpb_next, NULL, 0, &lpb.t_next);
+}
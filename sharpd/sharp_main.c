@@ -30,9 +30,9 @@
 #include "nexthop_group.h"
 #include "link_state.h"
 
+#include "sharp_globals.h"
 #include "sharp_zebra.h"
 #include "sharp_vty.h"
-#include "sharp_globals.h"
 #include "sharp_nht.h"
 
 DEFINE_MGROUP(SHARPD, "sharpd");
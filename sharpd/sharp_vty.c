@@ -157,17 +157,35 @@ DEFPY(sharp_nht_data_dump,
 
 DEFPY (install_routes_data_dump,
        install_routes_data_dump_cmd,
-       "sharp data route",
+       "sharp data route [json$uj]",
        "Sharp routing Protocol\n"
        "Data about what is going on\n"
-       "Route Install/Removal Information\n")
+       "Route Install/Removal Information\n"
+       JSON_STR)
 {
 	struct timeval r;
+	json_object *json;
 
 	timersub(&sg.r.t_end, &sg.r.t_start, &r);
+
+	if (uj) {
+		json = json_object_new_object();
+		json_object_string_addf(json, "prefix", "%pFX",
+					&sg.r.orig_prefix);
+		json_object_int_add(json, "total", sg.r.total_routes);
+		json_object_int_add(json, "installed", sg.r.installed_routes);
+		json_object_int_add(json, "removed", sg.r.removed_routes);
+		json_object_int_add(json, "elapsedUsec",
+				    r.tv_sec * 1000000LL + r.tv_usec);
+		sharp_route_latency_show(vty, json);
+		vty_json(vty, json);
+		return CMD_SUCCESS;
+	}
+
 	vty_out(vty, "Prefix: %pFX Total: %u %u %u Time: %jd.%ld\n",
 		&sg.r.orig_prefix, sg.r.total_routes, sg.r.installed_routes,
 		sg.r.removed_routes, (intmax_t)r.tv_sec, (long)r.tv_usec);
+	sharp_route_latency_show(vty, NULL);
 
 	return CMD_SUCCESS;
 }
@@ -210,6 +228,7 @@ DEFPY (install_routes,
 
 	sg.r.total_routes = routes;
 	sg.r.installed_routes = 0;
+	sharp_route_latency_reset(SHARP_LAT_INSTALL);
 
 	if (rpt >= 2)
 		sg.r.repeat = rpt * 2;
@@ -354,6 +373,7 @@ DEFPY (install_seg6_routes,
 
 	sg.r.total_routes = routes;
 	sg.r.installed_routes = 0;
+	sharp_route_latency_reset(SHARP_LAT_INSTALL);
 
 	if (rpt >= 2)
 		sg.r.repeat = rpt * 2;
@@ -451,6 +471,7 @@ DEFPY (install_seg6local_routes,
 
 	sg.r.total_routes = routes;
 	sg.r.installed_routes = 0;
+	sharp_route_latency_reset(SHARP_LAT_INSTALL);
 
 	if (rpt >= 2)
 		sg.r.repeat = rpt * 2;
@@ -566,6 +587,7 @@ DEFPY (remove_routes,
 
 	sg.r.total_routes = routes;
 	sg.r.removed_routes = 0;
+	sharp_route_latency_reset(SHARP_LAT_REMOVE);
 	uint32_t rts;
 
 	memset(&prefix, 0, sizeof(prefix));
@@ -770,6 +792,30 @@ DEFPY (logpump,
 	return CMD_SUCCESS;
 }
 
+DEFPY (logpump_benchmark,
+       logpump_benchmark_cmd,
+       "sharp logpump benchmark [{messages (100-10000000)|threads (1-16)|target <none|file|file-async|syslog|5424-unix|live>$target}] [json$uj]",
+       SHARP_STR
+       "Generate bulk log messages for testing\n"
+       "Compare the cost of the log targets\n"
+       "Messages per pthread and run\n"
+       "Messages per pthread and run\n"
+       "Number of pthreads logging at the same time\n"
+       "Number of pthreads logging at the same time\n"
+       "Benchmark a single target\n"
+       "No target of its own, only what is configured\n"
+       "Log file\n"
+       "Log file written from a separate pthread\n"
+       "Syslog\n"
+       "RFC 5424 syslog to a unix datagram socket\n"
+       "Live log stream, as used by terminal monitor\n"
+       JSON_STR)
+{
+	sharp_logpump_benchmark(vty, messages_str ? messages : 20000,
+				threads_str ? threads : 4, target, !!uj);
+	return CMD_SUCCESS;
+}
+
 DEFPY (create_session,
        create_session_cmd,
        "sharp create session (1-1024)",
@@ -1245,6 +1291,7 @@ DEFPY (show_sharp_cspf,
 	}
 	if (path->status != SUCCESS) {
 		vty_out(vty, "Path computation failed: %d\n", path->status);
+		cspf_path_del(path);
 		return CMD_SUCCESS;
 	}
 
@@ -1260,6 +1307,7 @@ DEFPY (show_sharp_cspf,
 				&edge->attributes->standard.remote6);
 	}
 	vty_out(vty, "\n");
+	cspf_path_del(path);
 
 	return CMD_SUCCESS;
 }
@@ -1398,6 +1446,7 @@ void sharp_vty_init(void)
 	install_element(ENABLE_NODE, &sharp_lsp_prefix_v4_cmd);
 	install_element(ENABLE_NODE, &sharp_remove_lsp_prefix_v4_cmd);
 	install_element(ENABLE_NODE, &logpump_cmd);
+	install_element(ENABLE_NODE, &logpump_benchmark_cmd);
 	install_element(ENABLE_NODE, &create_session_cmd);
 	install_element(ENABLE_NODE, &remove_session_cmd);
 	install_element(ENABLE_NODE, &send_opaque_cmd);
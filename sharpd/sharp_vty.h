@@ -13,5 +13,8 @@ struct vty;
 
 extern void sharp_logpump_run(struct vty *vty, unsigned duration,
 			      unsigned frequency, unsigned burst);
+extern void sharp_logpump_benchmark(struct vty *vty, size_t count,
+				    unsigned int threads, const char *target,
+				    bool json);
 
 #endif
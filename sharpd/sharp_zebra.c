@@ -17,6 +17,7 @@
 #include "nexthop_group.h"
 #include "link_state.h"
 #include "tc.h"
+#include "json.h"
 
 #include "sharp_globals.h"
 #include "sharp_nht.h"
@@ -32,6 +33,7 @@ extern struct event_loop *master;
 extern struct zebra_privs_t sharp_privs;
 
 DEFINE_MTYPE_STATIC(SHARPD, ZC, "Test zclients");
+DEFINE_MTYPE_STATIC(SHARPD, ROUTE_TIMES, "Route send times");
 
 /* Struct to hold list of test zclients */
 struct sharp_zclient {
@@ -223,6 +225,156 @@ struct buffer_delay {
 	char *opaque;
 } wb;
 
+static uint64_t sharp_usec(void)
+{
+	struct timeval tv;
+
+	monotime(&tv);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+/* Prepare for recording the latency of routes starting at p */
+static void sharp_route_latency_start(const struct prefix *p, uint32_t routes)
+{
+	if (routes > sg.r.sent_alloc) {
+		XFREE(MTYPE_ROUTE_TIMES, sg.r.sent_usec);
+		sg.r.sent_usec = XCALLOC(MTYPE_ROUTE_TIMES,
+					 routes * sizeof(*sg.r.sent_usec));
+		sg.r.sent_alloc = routes;
+	} else
+		memset(sg.r.sent_usec, 0, routes * sizeof(*sg.r.sent_usec));
+
+	sg.r.lat_base = *p;
+	sg.r.lat_routes = routes;
+}
+
+/* Offset of p from the first route of the run, -1 if not one of ours */
+static int64_t sharp_route_index(const struct prefix *p)
+{
+	const struct prefix *base = &sg.r.lat_base;
+	uint32_t off;
+
+	if (p->family != base->family)
+		return -1;
+
+	if (p->family == AF_INET)
+		off = ntohl(p->u.prefix4.s_addr) -
+		      ntohl(base->u.prefix4.s_addr);
+	else {
+		if (memcmp(p->u.val32, base->u.val32, 3 * sizeof(uint32_t)))
+			return -1;
+		off = ntohl(p->u.val32[3]) - ntohl(base->u.val32[3]);
+	}
+
+	if (off >= sg.r.lat_routes)
+		return -1;
+
+	return off;
+}
+
+static void sharp_route_sent(const struct prefix *p, uint64_t now)
+{
+	int64_t idx = sharp_route_index(p);
+
+	if (idx >= 0)
+		sg.r.sent_usec[idx] = now;
+}
+
+static void sharp_route_notified(enum sharp_latency_type type,
+				 const struct prefix *p)
+{
+	struct sharp_latency *lat = &sg.r.lat[type];
+	int64_t idx = sharp_route_index(p);
+	uint64_t usec;
+	unsigned int bucket = 0;
+
+	if (idx < 0 || !sg.r.sent_usec[idx])
+		return;
+
+	usec = sharp_usec() - sg.r.sent_usec[idx];
+	sg.r.sent_usec[idx] = 0;
+
+	if (usec > 1)
+		bucket = MIN(63 - __builtin_clzll(usec), SHARP_LAT_BUCKETS - 1);
+
+	lat->hist[bucket]++;
+	if (!lat->count || usec < lat->min)
+		lat->min = usec;
+	if (usec > lat->max)
+		lat->max = usec;
+	lat->count++;
+	lat->sum += usec;
+}
+
+void sharp_route_latency_reset(enum sharp_latency_type type)
+{
+	memset(&sg.r.lat[type], 0, sizeof(sg.r.lat[type]));
+}
+
+/* Upper bound of the bucket holding the given per mille of the samples */
+static uint64_t sharp_latency_pct(const struct sharp_latency *lat,
+				  unsigned int permille)
+{
+	uint64_t want = (lat->count * permille + 999) / 1000;
+	uint64_t seen = 0;
+	unsigned int i;
+
+	for (i = 0; i < SHARP_LAT_BUCKETS; i++) {
+		seen += lat->hist[i];
+		if (seen >= want)
+			return MIN((2ULL << i) - 1, lat->max);
+	}
+
+	return lat->max;
+}
+
+void sharp_route_latency_show(struct vty *vty, json_object *json)
+{
+	static const char *const names[SHARP_LAT_MAX] = {
+		[SHARP_LAT_INSTALL] = "install",
+		[SHARP_LAT_REMOVE] = "remove",
+	};
+	const struct sharp_latency *lat;
+	json_object *jlat;
+	unsigned int i;
+
+	for (i = 0; i < SHARP_LAT_MAX; i++) {
+		lat = &sg.r.lat[i];
+
+		if (json) {
+			jlat = json_object_new_object();
+			json_object_int_add(jlat, "count", lat->count);
+			json_object_int_add(jlat, "minUsec", lat->min);
+			json_object_int_add(jlat, "avgUsec",
+					    lat->count ? lat->sum / lat->count
+						       : 0);
+			json_object_int_add(jlat, "p50Usec",
+					    sharp_latency_pct(lat, 500));
+			json_object_int_add(jlat, "p90Usec",
+					    sharp_latency_pct(lat, 900));
+			json_object_int_add(jlat, "p99Usec",
+					    sharp_latency_pct(lat, 990));
+			json_object_int_add(jlat, "p999Usec",
+					    sharp_latency_pct(lat, 999));
+			json_object_int_add(jlat, "maxUsec", lat->max);
+			json_object_object_add(json, names[i], jlat);
+			continue;
+		}
+
+		if (!lat->count)
+			continue;
+
+		vty_out(vty,
+			"Latency %s (usec): count %" PRIu64 " min %" PRIu64
+			" avg %" PRIu64 " p50 %" PRIu64 " p90 %" PRIu64
+			" p99 %" PRIu64 " p99.9 %" PRIu64 " max %" PRIu64 "\n",
+			names[i], lat->count, lat->min, lat->sum / lat->count,
+			sharp_latency_pct(lat, 500), sharp_latency_pct(lat, 900),
+			sharp_latency_pct(lat, 990), sharp_latency_pct(lat, 999),
+			lat->max);
+	}
+}
+
 /*
  * route_add - Encodes a route to zebra
  *
@@ -293,6 +445,8 @@ static bool route_add(const struct prefix *p, vrf_id_t vrf_id, uint8_t instance,
 		memcpy(api.opaque.data, opaque, api.opaque.length);
 	}
 
+	sharp_route_sent(p, sharp_usec());
+
 	if (zclient_route_send(ZEBRA_ROUTE_ADD, zclient, &api) ==
 	    ZCLIENT_SEND_BUFFERED)
 		return true;
@@ -317,6 +471,8 @@ static bool route_delete(struct prefix *p, vrf_id_t vrf_id, uint8_t instance)
 	api.instance = instance;
 	memcpy(&api.prefix, p, sizeof(*p));
 
+	sharp_route_sent(p, sharp_usec());
+
 	if (zclient_route_send(ZEBRA_ROUTE_DELETE, zclient, &api) ==
 	    ZCLIENT_SEND_BUFFERED)
 		return true;
@@ -324,6 +480,57 @@ static bool route_delete(struct prefix *p, vrf_id_t vrf_id, uint8_t instance)
 		return false;
 }
 
+/* routes handed to zclient_route_send_batch() at once */
+#define SHARP_ROUTE_BATCH 1000
+
+/*
+ * route_add_batch - Encodes consecutive routes using an installed
+ * nexthop group into batch messages, advancing p past the last one.
+ *
+ * This function returns true when the routes were buffered
+ * by the underlying stream system
+ */
+static bool route_add_batch(struct prefix *p, uint32_t routes,
+			    vrf_id_t vrf_id, uint8_t instance, uint32_t nhgid,
+			    uint32_t flags, char *opaque)
+{
+	static struct prefix prefixes[SHARP_ROUTE_BATCH];
+	struct zapi_route api;
+	uint32_t temp, i;
+	bool v4 = (p->family == AF_INET);
+	uint64_t now = sharp_usec();
+
+	memset(&api, 0, sizeof(api));
+	api.vrf_id = vrf_id;
+	api.type = ZEBRA_ROUTE_SHARP;
+	api.instance = instance;
+	api.safi = SAFI_UNICAST;
+	api.flags = flags;
+	SET_FLAG(api.flags, ZEBRA_FLAG_ALLOW_RECURSION);
+	SET_FLAG(api.message, ZAPI_MESSAGE_NHG);
+	api.nhgid = nhgid;
+
+	if (strlen(opaque)) {
+		SET_FLAG(api.message, ZAPI_MESSAGE_OPAQUE);
+		api.opaque.length = strlen(opaque) + 1;
+		assert(api.opaque.length <= ZAPI_MESSAGE_OPAQUE_LENGTH);
+		memcpy(api.opaque.data, opaque, api.opaque.length);
+	}
+
+	temp = v4 ? ntohl(p->u.prefix4.s_addr) : ntohl(p->u.val32[3]);
+	for (i = 0; i < routes; i++) {
+		prefixes[i] = *p;
+		sharp_route_sent(p, now);
+		if (v4)
+			p->u.prefix4.s_addr = htonl(++temp);
+		else
+			p->u.val32[3] = htonl(++temp);
+	}
+
+	return zclient_route_send_batch(zclient, &api, prefixes, routes) ==
+	       ZCLIENT_SEND_BUFFERED;
+}
+
 static void sharp_install_routes_restart(struct prefix *p, uint32_t count,
 					 vrf_id_t vrf_id, uint8_t instance,
 					 uint32_t nhgid,
@@ -335,6 +542,31 @@ static void sharp_install_routes_restart(struct prefix *p, uint32_t count,
 	uint32_t temp, i;
 	bool v4 = false;
 
+	/* Routes only sharing an installed group can go in batches */
+	if (nhgid && sharp_nhgroup_id_is_installed(nhgid) && !backup_nhg) {
+		for (i = count; i < routes; i += SHARP_ROUTE_BATCH) {
+			uint32_t n = MIN(routes - i, SHARP_ROUTE_BATCH);
+
+			if (route_add_batch(p, n, vrf_id, instance, nhgid,
+					    flags, opaque)) {
+				wb.p = *p;
+				wb.count = i + n;
+				wb.routes = routes;
+				wb.vrf_id = vrf_id;
+				wb.instance = instance;
+				wb.nhgid = nhgid;
+				wb.nhg = nhg;
+				wb.flags = flags;
+				wb.backup_nhg = backup_nhg;
+				wb.opaque = opaque;
+				wb.restart = SHARP_INSTALL_ROUTES_RESTART;
+
+				return;
+			}
+		}
+		return;
+	}
+
 	if (p->family == AF_INET) {
 		v4 = true;
 		temp = ntohl(p->u.prefix4.s_addr);
@@ -380,6 +612,7 @@ void sharp_install_routes_helper(struct prefix *p, vrf_id_t vrf_id,
 		backup_nhg = NULL;
 
 	monotime(&sg.r.t_start);
+	sharp_route_latency_start(p, routes);
 	sharp_install_routes_restart(p, 0, vrf_id, instance, nhgid, nhg,
 				     backup_nhg, routes, flags, opaque);
 }
@@ -424,6 +657,7 @@ void sharp_remove_routes_helper(struct prefix *p, vrf_id_t vrf_id,
 	zlog_debug("Removing %u routes", routes);
 
 	monotime(&sg.r.t_start);
+	sharp_route_latency_start(p, routes);
 
 	sharp_remove_routes_restart(p, 0, vrf_id, instance, routes);
 }
@@ -479,6 +713,7 @@ static int route_notify_owner(ZAPI_CALLBACK_ARGS)
 
 	switch (note) {
 	case ZAPI_ROUTE_INSTALLED:
+		sharp_route_notified(SHARP_LAT_INSTALL, &p);
 		sg.r.installed_routes++;
 		if (sg.r.total_routes == sg.r.installed_routes) {
 			monotime(&sg.r.t_end);
@@ -495,6 +730,7 @@ static int route_notify_owner(ZAPI_CALLBACK_ARGS)
 		zlog_debug("Better Admin Distance won over us");
 		break;
 	case ZAPI_ROUTE_REMOVED:
+		sharp_route_notified(SHARP_LAT_REMOVE, &p);
 		sg.r.removed_routes++;
 		if (sg.r.total_routes == sg.r.removed_routes) {
 			monotime(&sg.r.t_end);
@@ -1042,7 +1278,8 @@ static zclient_handler *const sharp_handlers[] = {
 
 void sharp_zebra_init(void)
 {
-	struct zclient_options opt = {.receive_notify = true};
+	struct zclient_options opt = {.receive_notify = true,
+				      .receive_notify_batch = true};
 
 	if_zapi_callbacks(sharp_ifp_create, sharp_ifp_up, sharp_ifp_down,
 			  sharp_ifp_destroy);
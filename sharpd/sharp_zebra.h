@@ -29,6 +29,10 @@ extern void sharp_install_routes_helper(struct prefix *p, vrf_id_t vrf_id,
 extern void sharp_remove_routes_helper(struct prefix *p, vrf_id_t vrf_id,
 				       uint8_t instance, uint32_t routes);
 
+/* Route install/removal latency as seen through route notifications */
+extern void sharp_route_latency_reset(enum sharp_latency_type type);
+extern void sharp_route_latency_show(struct vty *vty, json_object *json);
+
 int sharp_install_lsps_helper(bool install_p, bool update_p,
 			      const struct prefix *p, uint8_t type,
 			      int instance, uint32_t in_label,
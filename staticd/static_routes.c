@@ -48,6 +48,7 @@ void zebra_stable_node_cleanup(struct route_table *table,
 				XFREE(MTYPE_STATIC_NEXTHOP, nh);
 			}
 			static_path_list_del(&si->path_list, pn);
+			static_zebra_route_forget(pn);
 			XFREE(MTYPE_STATIC_PATH, pn);
 		}
 
@@ -73,6 +74,7 @@ void zebra_stable_node_cleanup(struct route_table *table,
 					}
 					static_path_list_del(&src_si->path_list,
 							     src_pn);
+					static_zebra_route_forget(src_pn);
 					XFREE(MTYPE_STATIC_PATH, src_pn);
 				}
 
@@ -242,6 +244,7 @@ void static_del_path(struct static_path *pn)
 
 	route_unlock_node(rn);
 
+	static_zebra_route_forget(pn);
 	XFREE(MTYPE_STATIC_PATH, pn);
 }
 
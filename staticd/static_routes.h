@@ -68,6 +68,7 @@ enum static_install_states {
 
 PREDECL_DLIST(static_path_list);
 PREDECL_DLIST(static_nexthop_list);
+PREDECL_DLIST(static_path_pending);
 
 /* Static route information */
 struct static_route_info {
@@ -91,9 +92,12 @@ struct static_path {
 	uint32_t table_id;
 	/* Nexthop list */
 	struct static_nexthop_list_head nexthop_list;
+	/* Linkage for the paths waiting to be sent to zebra */
+	struct static_path_pending_item pending;
 };
 
 DECLARE_DLIST(static_path_list, struct static_path, list);
+DECLARE_DLIST(static_path_pending, struct static_path, pending);
 
 /* Static route information. */
 struct static_nexthop {
@@ -71,6 +71,21 @@ DECLARE_HASH(static_nht_hash, struct static_nht_data, itm, static_nht_data_cmp,
 
 static struct static_nht_hash_head static_nht_hash[1];
 
+/*
+ * Updates to zebra are not written one at a time.  Paths to (re)install are
+ * queued and encoded from an event, so a path that is touched several times
+ * in a row (once per nexthop when the config is loaded, once per nexthop
+ * tracking update) is only sent once.  Route deletes and nexthop
+ * (un)registrations are encoded right away, to keep their order.  All
+ * messages are packed back to back into static_zebra_obuf, which goes to
+ * zebra in a single write whenever it fills up.
+ */
+static struct static_path_pending_head static_path_pending[1];
+static struct stream *static_zebra_obuf;
+/* scratch stream for encoding one message */
+static struct stream *static_zebra_msg;
+static struct event *t_static_zebra_flush;
+
 /* Zebra structure to hold current status. */
 struct zclient *zclient;
 uint32_t zebra_ecmp_count = MULTIPATH_NUM;
@@ -306,6 +321,34 @@ static bool static_zebra_nht_get_prefix(const struct static_nexthop *nh,
 	return false;
 }
 
+static void static_zebra_obuf_flush(void)
+{
+	if (!stream_get_endp(static_zebra_obuf))
+		return;
+
+	stream_copy(zclient->obuf, static_zebra_obuf);
+	stream_reset(static_zebra_obuf);
+
+	if (zclient_send_message(zclient) == ZCLIENT_SEND_FAILURE)
+		zlog_warn("%s: Failure to send queued messages to zebra",
+			  __func__);
+}
+
+static void static_zebra_flush(struct event *thread);
+
+/* Appends the message in static_zebra_msg to the outgoing batch */
+static void static_zebra_msg_queue(void)
+{
+	size_t len = stream_get_endp(static_zebra_msg);
+
+	if (STREAM_WRITEABLE(static_zebra_obuf) < len)
+		static_zebra_obuf_flush();
+	stream_put(static_zebra_obuf, STREAM_DATA(static_zebra_msg), len);
+
+	event_add_event(master, static_zebra_flush, NULL, 0,
+			&t_static_zebra_flush);
+}
+
 void static_zebra_nht_register(struct static_nexthop *nh, bool reg)
 {
 	struct static_path *pn = nh->pn;
@@ -377,15 +420,20 @@ void static_zebra_nht_register(struct static_nexthop *nh, bool reg)
 		       "Unregistering nexthop(%pFX) for %pRN", &lookup.nh, rn);
 	}
 
-	if (zclient_send_rnh(zclient, cmd, &lookup.nh, si->safi, false, false,
-			     nh->nh_vrf_id) == ZCLIENT_SEND_FAILURE)
+	if (zclient->sock < 0) {
 		zlog_warn("%s: Failure to send nexthop %pFX for %pRN to zebra",
 			  __func__, &lookup.nh, rn);
-	else if (reg)
+		return;
+	}
+
+	zapi_rnh_encode(static_zebra_msg, cmd, &lookup.nh, si->safi, false,
+			false, nh->nh_vrf_id);
+	static_zebra_msg_queue();
+	if (reg)
 		nhtd->registered = true;
 }
 
-extern void static_zebra_route_add(struct static_path *pn, bool install)
+static void static_zebra_route_encode(struct static_path *pn, bool install)
 {
 	struct route_node *rn = pn->rn;
 	struct static_route_info *si = rn->info;
@@ -511,9 +559,51 @@ extern void static_zebra_route_add(struct static_path *pn, bool install)
 	if (!nh_num && install)
 		install = false;
 
-	zclient_route_send(install ?
-			   ZEBRA_ROUTE_ADD : ZEBRA_ROUTE_DELETE,
-			   zclient, &api);
+	if (zapi_route_encode(install ? ZEBRA_ROUTE_ADD : ZEBRA_ROUTE_DELETE,
+			      static_zebra_msg, &api) < 0)
+		return;
+	static_zebra_msg_queue();
+}
+
+static void static_zebra_flush(struct event *thread)
+{
+	struct static_path *pn;
+	unsigned int count = 0;
+
+	while ((pn = static_path_pending_pop(static_path_pending))) {
+		static_zebra_route_encode(pn, true);
+		count++;
+	}
+
+	/* encoding queued the event again */
+	EVENT_OFF(t_static_zebra_flush);
+	static_zebra_obuf_flush();
+
+	if (count)
+		DEBUGD(&static_dbg_route, "%s: sent %u route updates", __func__,
+		       count);
+}
+
+void static_zebra_route_add(struct static_path *pn, bool install)
+{
+	if (install) {
+		if (!static_path_pending_anywhere(pn))
+			static_path_pending_add_tail(static_path_pending, pn);
+		event_add_event(master, static_zebra_flush, NULL, 0,
+				&t_static_zebra_flush);
+		return;
+	}
+
+	/* a queued update would re-add the route after the delete */
+	static_zebra_route_forget(pn);
+	static_zebra_route_encode(pn, false);
+}
+
+/* Drops a queued update for a path that is about to be freed */
+void static_zebra_route_forget(struct static_path *pn)
+{
+	if (static_path_pending_anywhere(pn))
+		static_path_pending_del(static_path_pending, pn);
 }
 
 static zclient_handler *const static_handlers[] = {
@@ -538,6 +628,9 @@ void static_zebra_init(void)
 	zclient->zebra_connected = zebra_connected;
 
 	static_nht_hash_init(static_nht_hash);
+	static_path_pending_init(static_path_pending);
+	static_zebra_obuf = stream_new(ZEBRA_MAX_PACKET_SIZ);
+	static_zebra_msg = stream_new(ZEBRA_MAX_PACKET_SIZ);
 	static_bfd_initialize(zclient, master);
 }
 
@@ -547,8 +640,19 @@ void static_zebra_stop(void)
 	static_nht_hash_clear();
 	static_nht_hash_fini(static_nht_hash);
 
+	EVENT_OFF(t_static_zebra_flush);
+	while (static_path_pending_pop(static_path_pending))
+		;
+	static_path_pending_fini(static_path_pending);
+
 	if (!zclient)
 		return;
+
+	/* send the deletes queued when the VRFs went away */
+	static_zebra_obuf_flush();
+	stream_free(static_zebra_obuf);
+	stream_free(static_zebra_msg);
+
 	zclient_stop(zclient);
 	zclient_free(zclient);
 	zclient = NULL;
@@ -16,6 +16,7 @@ extern struct event_loop *master;
 extern void static_zebra_nht_register(struct static_nexthop *nh, bool reg);
 
 extern void static_zebra_route_add(struct static_path *pn, bool install);
+extern void static_zebra_route_forget(struct static_path *pn);
 extern void static_zebra_init(void);
 /* static_zebra_stop used by tests/lib/test_grpc.cpp */
 extern void static_zebra_stop(void);
@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Microbenchmark harness for lib: runs each benchmark a few times to warm
+ * up, then times a number of iterations and reports percentiles of the
+ * time per operation, as a table or as JSON.
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include <getopt.h>
+
+#include "command.h"
+#include "json.h"
+#include "memory.h"
+#include "plist.h"
+#include "routemap.h"
+
+#include "tests/bench/bench.h"
+
+static const struct bench_suite *const suites[] = {
+	&bench_table,  &bench_hash,	&bench_typesafe, &bench_stream,
+	&bench_prefix, &bench_printfrr, &bench_filter,	 &bench_zlog,
+};
+
+#define BENCH_WARMUP	 3
+#define BENCH_ITERATIONS 20
+
+static unsigned int warmup = BENCH_WARMUP;
+static unsigned int iterations = BENCH_ITERATIONS;
+
+struct bench_result {
+	double min, p50, p90, p99, max, mean;
+};
+
+static uint64_t now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+	const uint64_t *x = a, *y = b;
+
+	return numcmp(*x, *y);
+}
+
+/* nearest rank */
+static uint64_t percentile(const uint64_t *sorted, unsigned int n,
+			   unsigned int pct)
+{
+	unsigned int rank = (pct * n + 99) / 100;
+
+	return sorted[rank ? rank - 1 : 0];
+}
+
+static void bench_run(const struct bench *b, struct bench_result *res)
+{
+	uint64_t *samples = XCALLOC(MTYPE_TMP, iterations * sizeof(*samples));
+	uint64_t start, total = 0;
+	double ops = b->ops;
+	unsigned int i;
+
+	if (b->setup)
+		b->setup();
+
+	for (i = 0; i < warmup; i++)
+		b->run();
+
+	for (i = 0; i < iterations; i++) {
+		start = now_nsec();
+		b->run();
+		samples[i] = now_nsec() - start;
+		total += samples[i];
+	}
+
+	if (b->teardown)
+		b->teardown();
+
+	qsort(samples, iterations, sizeof(*samples), cmp_u64);
+	res->min = samples[0] / ops;
+	res->p50 = percentile(samples, iterations, 50) / ops;
+	res->p90 = percentile(samples, iterations, 90) / ops;
+	res->p99 = percentile(samples, iterations, 99) / ops;
+	res->max = samples[iterations - 1] / ops;
+	res->mean = total / ops / iterations;
+
+	XFREE(MTYPE_TMP, samples);
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [-j] [-l] [-w warmup] [-i iterations] [filter...]\n"
+		"\n"
+		"  -j  JSON output\n"
+		"  -l  list the benchmarks and exit\n"
+		"  -w  untimed runs before measuring, default %u\n"
+		"  -i  timed runs, default %u\n"
+		"\n"
+		"Only benchmarks whose \"suite/name\" contains one of the\n"
+		"filters are run.\n",
+		prog, BENCH_WARMUP, BENCH_ITERATIONS);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	struct json_object *json = NULL, *jbenches = NULL, *jb, *jns;
+	const struct bench_suite *suite;
+	const struct bench *b;
+	struct bench_result res;
+	bool uj = false, list = false, match;
+	char name[128];
+	size_t s, j;
+	int opt, k;
+
+	while ((opt = getopt(argc, argv, "jlw:i:h")) != -1) {
+		switch (opt) {
+		case 'j':
+			uj = true;
+			break;
+		case 'l':
+			list = true;
+			break;
+		case 'w':
+			warmup = strtoul(optarg, NULL, 10);
+			break;
+		case 'i':
+			iterations = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (!iterations)
+		usage(argv[0]);
+
+	cmd_init(1);
+	zlog_aux_init("NONE: ", LOG_WARNING);
+	prefix_list_init();
+	route_map_init();
+
+	if (uj) {
+		json = json_object_new_object();
+		json_object_int_add(json, "warmup", warmup);
+		json_object_int_add(json, "iterations", iterations);
+		jbenches = json_object_new_array();
+		json_object_object_add(json, "benchmarks", jbenches);
+	} else if (!list)
+		printf("%-28s %10s %10s %10s %10s %10s %12s\n", "ns/op", "min",
+		       "p50", "p90", "p99", "max", "ops/s");
+
+	for (s = 0; s < array_size(suites); s++) {
+		suite = suites[s];
+		for (j = 0; j < suite->count; j++) {
+			b = &suite->benches[j];
+			snprintf(name, sizeof(name), "%s/%s", suite->name,
+				 b->name);
+
+			match = optind >= argc;
+			for (k = optind; k < argc && !match; k++)
+				match = strstr(name, argv[k]) != NULL;
+			if (!match)
+				continue;
+
+			if (list) {
+				printf("%s\n", name);
+				continue;
+			}
+
+			bench_run(b, &res);
+
+			if (!uj) {
+				printf("%-28s %10.1f %10.1f %10.1f %10.1f %10.1f %12.0f\n",
+				       name, res.min, res.p50, res.p90,
+				       res.p99, res.max,
+				       res.p50 > 0 ? 1e9 / res.p50 : 0);
+				fflush(stdout);
+				continue;
+			}
+
+			jb = json_object_new_object();
+			json_object_string_add(jb, "name", name);
+			json_object_int_add(jb, "ops", b->ops);
+			jns = json_object_new_object();
+			json_object_double_add(jns, "min", res.min);
+			json_object_double_add(jns, "p50", res.p50);
+			json_object_double_add(jns, "p90", res.p90);
+			json_object_double_add(jns, "p99", res.p99);
+			json_object_double_add(jns, "max", res.max);
+			json_object_double_add(jns, "mean", res.mean);
+			json_object_object_add(jb, "nsPerOp", jns);
+			json_object_double_add(jb, "opsPerSecond",
+					       res.p50 > 0 ? 1e9 / res.p50 : 0);
+			json_object_array_add(jbenches, jb);
+		}
+	}
+
+	if (uj) {
+		printf("%s\n", json_object_to_json_string_ext(
+				       json, JSON_C_TO_STRING_PRETTY));
+		json_object_free(json);
+	}
+	return 0;
+}
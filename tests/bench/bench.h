@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Microbenchmark harness for lib
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#ifndef _FRR_BENCH_H
+#define _FRR_BENCH_H
+
+#include "compiler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A benchmark times calls of run(), each of which does ops operations of
+ * whatever is measured; results are reported per operation.  run() must
+ * leave things as it found them, setup() and teardown() are called before
+ * the first and after the last call and are not timed.
+ */
+struct bench {
+	const char *name;
+	unsigned int ops;
+
+	void (*setup)(void);
+	void (*run)(void);
+	void (*teardown)(void);
+};
+
+struct bench_suite {
+	const char *name;
+	const struct bench *benches;
+	size_t count;
+};
+
+#define BENCH_SUITE(sname, ...)                                                \
+	static const struct bench bench_##sname##_list[] = { __VA_ARGS__ };   \
+	const struct bench_suite bench_##sname = {                            \
+		.name = #sname,                                                \
+		.benches = bench_##sname##_list,                               \
+		.count = array_size(bench_##sname##_list),                     \
+	}
+
+/* suites, in the order they are run; add new ones to bench.c too */
+extern const struct bench_suite bench_table;
+extern const struct bench_suite bench_hash;
+extern const struct bench_suite bench_typesafe;
+extern const struct bench_suite bench_stream;
+extern const struct bench_suite bench_prefix;
+extern const struct bench_suite bench_printfrr;
+extern const struct bench_suite bench_filter;
+extern const struct bench_suite bench_zlog;
+
+/* keep the compiler from optimizing away a result nobody looks at */
+#define bench_use(val)                                                         \
+	do {                                                                   \
+		__asm__ volatile("" : : "g"(val) : "memory");                  \
+	} while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_BENCH_H */
@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Prefix-list and route-map application benchmarks
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "memory.h"
+#include "plist.h"
+#include "prefix.h"
+#include "prng.h"
+#include "routemap.h"
+
+#include "tests/bench/bench.h"
+
+#define PLIST_ENTRIES 10000
+#define FILTER_OPS    100000
+#define RMAP_ENTRIES  10
+
+static char plist_name[] = "bench";
+static struct prefix_list *plist;
+static struct prefix *lookups;
+static struct route_map *rmap;
+
+static void random_prefix(struct prng *prng, struct prefix *p,
+			  unsigned int minlen, unsigned int maxlen)
+{
+	memset(p, 0, sizeof(*p));
+	p->family = AF_INET;
+	p->prefixlen = minlen + prng_rand(prng) % (maxlen - minlen + 1);
+	p->u.prefix4.s_addr = prng_rand(prng);
+	apply_mask(p);
+}
+
+static enum route_map_cmd_result_t
+match_len(void *rule, const struct prefix *prefix, void *object)
+{
+	uint8_t *len = rule;
+
+	return prefix->prefixlen == *len ? RMAP_MATCH : RMAP_NOMATCH;
+}
+
+static void *match_len_compile(const char *arg)
+{
+	uint8_t *len = XMALLOC(MTYPE_ROUTE_MAP_COMPILED, sizeof(*len));
+
+	*len = strtoul(arg, NULL, 10);
+	return len;
+}
+
+static enum route_map_cmd_result_t
+match_plist(void *rule, const struct prefix *prefix, void *object)
+{
+	struct prefix_list *pl = prefix_list_lookup(AFI_IP, rule);
+
+	return prefix_list_apply(pl, prefix) == PREFIX_PERMIT ? RMAP_MATCH
+							       : RMAP_NOMATCH;
+}
+
+static void *match_plist_compile(const char *arg)
+{
+	return XSTRDUP(MTYPE_ROUTE_MAP_COMPILED, arg);
+}
+
+static void match_free(void *rule)
+{
+	XFREE(MTYPE_ROUTE_MAP_COMPILED, rule);
+}
+
+static const struct route_map_rule_cmd match_len_cmd = {
+	.str = "bench length",
+	.func_apply = match_len,
+	.func_compile = match_len_compile,
+	.func_free = match_free,
+};
+
+static const struct route_map_rule_cmd match_plist_cmd = {
+	.str = "bench prefix-list",
+	.func_apply = match_plist,
+	.func_compile = match_plist_compile,
+	.func_free = match_free,
+};
+
+/* a list like in test_plist_performance, with some le/ge ranges */
+static void filter_setup(void)
+{
+	struct prng *prng = prng_new(0);
+	struct orf_prefix orfp;
+	unsigned int i;
+
+	for (i = 0; i < PLIST_ENTRIES; i++) {
+		memset(&orfp, 0, sizeof(orfp));
+		orfp.seq = 5 * (i + 1);
+		random_prefix(prng, &orfp.p, 8, 24);
+		if (i % 4 == 1)
+			orfp.le = orfp.p.prefixlen
+				  + prng_rand(prng) % (33 - orfp.p.prefixlen);
+		prefix_bgp_orf_set(plist_name, AFI_IP, &orfp,
+				   prng_rand(prng) & 1, 1);
+	}
+	plist = prefix_bgp_orf_lookup(AFI_IP, plist_name);
+	assert(plist);
+
+	lookups = XCALLOC(MTYPE_TMP, FILTER_OPS * sizeof(*lookups));
+	for (i = 0; i < FILTER_OPS; i++)
+		random_prefix(prng, &lookups[i], 16, 32);
+	prng_free(prng);
+}
+
+static void filter_teardown(void)
+{
+	prefix_bgp_orf_remove_all(AFI_IP, plist_name);
+	plist = NULL;
+	XFREE(MTYPE_TMP, lookups);
+}
+
+/* entries not matching most prefixes, then one using the prefix-list */
+static void rmap_setup(void)
+{
+	struct route_map_index *index;
+	char arg[8];
+	int i;
+
+	filter_setup();
+
+	route_map_install_match(&match_len_cmd);
+	route_map_install_match(&match_plist_cmd);
+
+	rmap = route_map_get("bench");
+	for (i = 0; i < RMAP_ENTRIES; i++) {
+		index = route_map_index_get(rmap, RMAP_DENY, 10 * (i + 1));
+		snprintf(arg, sizeof(arg), "%d", i);
+		route_map_add_match(index, "bench length", arg,
+				    RMAP_EVENT_MATCH_ADDED);
+	}
+	index = route_map_index_get(rmap, RMAP_PERMIT, 10 * (i + 1));
+	route_map_add_match(index, "bench prefix-list", plist_name,
+			    RMAP_EVENT_MATCH_ADDED);
+}
+
+static void rmap_teardown(void)
+{
+	route_map_delete(rmap);
+	rmap = NULL;
+	filter_teardown();
+}
+
+static void plist_apply(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < FILTER_OPS; i++)
+		bench_use(prefix_list_apply(plist, &lookups[i]));
+}
+
+static void rmap_apply(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < FILTER_OPS; i++)
+		bench_use(route_map_apply(rmap, &lookups[i], NULL));
+}
+
+BENCH_SUITE(filter,
+	{
+		.name = "prefix-list",
+		.ops = FILTER_OPS,
+		.setup = filter_setup,
+		.run = plist_apply,
+		.teardown = filter_teardown,
+	},
+	{
+		.name = "route-map",
+		.ops = FILTER_OPS,
+		.setup = rmap_setup,
+		.run = rmap_apply,
+		.teardown = rmap_teardown,
+	},
+);
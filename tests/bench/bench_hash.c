@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * lib/hash.c benchmarks
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "hash.h"
+#include "jhash.h"
+#include "memory.h"
+
+#include "tests/bench/bench.h"
+
+#define HASH_ITEMS 100000
+
+struct hash_item {
+	uint32_t key;
+};
+
+static struct hash_item *items;
+static struct hash *hash;
+
+static unsigned int item_key(const void *arg)
+{
+	const struct hash_item *item = arg;
+
+	return jhash_1word(item->key, 0);
+}
+
+static bool item_cmp(const void *a, const void *b)
+{
+	const struct hash_item *x = a, *y = b;
+
+	return x->key == y->key;
+}
+
+static void hash_setup(void)
+{
+	unsigned int i;
+
+	items = XCALLOC(MTYPE_TMP, HASH_ITEMS * sizeof(*items));
+	/* multiplying by an odd number gives distinct, scattered keys */
+	for (i = 0; i < HASH_ITEMS; i++)
+		items[i].key = i * 2654435761U;
+
+	hash = hash_create(item_key, item_cmp, "bench");
+	for (i = 0; i < HASH_ITEMS; i++)
+		hash_get(hash, &items[i], hash_alloc_intern);
+}
+
+static void hash_teardown(void)
+{
+	hash_clean_and_free(&hash, NULL);
+	XFREE(MTYPE_TMP, items);
+}
+
+/* removing and adding back all items, also growing and shrinking */
+static void hash_insert(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < HASH_ITEMS; i++)
+		hash_release(hash, &items[i]);
+	for (i = 0; i < HASH_ITEMS; i++)
+		hash_get(hash, &items[i], hash_alloc_intern);
+}
+
+static void hash_hit(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < HASH_ITEMS; i++)
+		bench_use(hash_lookup(hash, &items[i]));
+}
+
+static void hash_miss(void)
+{
+	struct hash_item ref;
+	unsigned int i;
+
+	for (i = 0; i < HASH_ITEMS; i++) {
+		ref.key = items[i].key + 1;
+		bench_use(hash_lookup(hash, &ref));
+	}
+}
+
+BENCH_SUITE(hash,
+	{
+		.name = "release/insert",
+		.ops = 2 * HASH_ITEMS,
+		.setup = hash_setup,
+		.run = hash_insert,
+		.teardown = hash_teardown,
+	},
+	{
+		.name = "lookup",
+		.ops = HASH_ITEMS,
+		.setup = hash_setup,
+		.run = hash_hit,
+		.teardown = hash_teardown,
+	},
+	{
+		.name = "lookup-miss",
+		.ops = HASH_ITEMS,
+		.setup = hash_setup,
+		.run = hash_miss,
+		.teardown = hash_teardown,
+	},
+);
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * lib/prefix.c benchmarks
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "memory.h"
+#include "prefix.h"
+#include "prng.h"
+
+#include "tests/bench/bench.h"
+
+#define PREFIX_OPS 100000
+
+static struct prefix *prefixes;
+static char (*strs)[PREFIX_STRLEN];
+
+static void prefix_setup(void)
+{
+	struct prng *prng = prng_new(0);
+	struct prefix *p;
+	unsigned int i;
+
+	prefixes = XCALLOC(MTYPE_TMP, PREFIX_OPS * sizeof(*prefixes));
+	strs = XCALLOC(MTYPE_TMP, PREFIX_OPS * sizeof(*strs));
+
+	for (i = 0; i < PREFIX_OPS; i++) {
+		p = &prefixes[i];
+		/* half IPv4, half IPv6 */
+		if (i & 1) {
+			p->family = AF_INET6;
+			p->prefixlen = 16 + prng_rand(prng) % 113;
+			p->u.prefix6.s6_addr32[0] = htonl(0x20010db8);
+			p->u.prefix6.s6_addr32[1] = prng_rand(prng);
+			p->u.prefix6.s6_addr32[2] = prng_rand(prng);
+			p->u.prefix6.s6_addr32[3] = prng_rand(prng);
+		} else {
+			p->family = AF_INET;
+			p->prefixlen = 8 + prng_rand(prng) % 25;
+			p->u.prefix4.s_addr = prng_rand(prng);
+		}
+		apply_mask(p);
+		prefix2str(p, strs[i], sizeof(strs[i]));
+	}
+	prng_free(prng);
+}
+
+static void prefix_teardown(void)
+{
+	XFREE(MTYPE_TMP, prefixes);
+	XFREE(MTYPE_TMP, strs);
+}
+
+static void prefix_parse(void)
+{
+	struct prefix p;
+	unsigned int i;
+
+	for (i = 0; i < PREFIX_OPS; i++) {
+		str2prefix(strs[i], &p);
+		bench_use(p.prefixlen);
+	}
+}
+
+static void prefix_format(void)
+{
+	char buf[PREFIX_STRLEN];
+	unsigned int i;
+
+	for (i = 0; i < PREFIX_OPS; i++) {
+		prefix2str(&prefixes[i], buf, sizeof(buf));
+		bench_use(buf[0]);
+	}
+}
+
+/* i and i + 2 are of the same family, so the addresses get compared */
+static void prefix_bench_match(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < PREFIX_OPS - 2; i++)
+		bench_use(prefix_match(&prefixes[i], &prefixes[i + 2]));
+}
+
+static void prefix_bench_cmp(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < PREFIX_OPS - 2; i++)
+		bench_use(prefix_cmp(&prefixes[i], &prefixes[i + 2]));
+}
+
+static void prefix_bench_mask(void)
+{
+	struct prefix p;
+	unsigned int i;
+
+	for (i = 0; i < PREFIX_OPS; i++) {
+		p = prefixes[i];
+		apply_mask(&p);
+		bench_use(p.u.prefix6.s6_addr32[3]);
+	}
+}
+
+BENCH_SUITE(prefix,
+	{
+		.name = "str2prefix",
+		.ops = PREFIX_OPS,
+		.setup = prefix_setup,
+		.run = prefix_parse,
+		.teardown = prefix_teardown,
+	},
+	{
+		.name = "prefix2str",
+		.ops = PREFIX_OPS,
+		.setup = prefix_setup,
+		.run = prefix_format,
+		.teardown = prefix_teardown,
+	},
+	{
+		.name = "prefix_match",
+		.ops = PREFIX_OPS - 2,
+		.setup = prefix_setup,
+		.run = prefix_bench_match,
+		.teardown = prefix_teardown,
+	},
+	{
+		.name = "prefix_cmp",
+		.ops = PREFIX_OPS - 2,
+		.setup = prefix_setup,
+		.run = prefix_bench_cmp,
+		.teardown = prefix_teardown,
+	},
+	{
+		.name = "apply_mask",
+		.ops = PREFIX_OPS,
+		.setup = prefix_setup,
+		.run = prefix_bench_mask,
+		.teardown = prefix_teardown,
+	},
+);
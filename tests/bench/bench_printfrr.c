@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * printfrr benchmarks
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "prefix.h"
+#include "printfrr.h"
+
+#include "tests/bench/bench.h"
+
+#define PRINTFRR_OPS 100000
+
+static struct prefix p4, p6;
+static char buf[256];
+
+static void printfrr_setup(void)
+{
+	str2prefix("192.0.2.0/24", &p4);
+	str2prefix("2001:db8:1234:5678::/64", &p6);
+}
+
+/* libc for comparison */
+static void printfrr_libc(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < PRINTFRR_OPS; i++)
+		snprintf(buf, sizeof(buf), "%u: %s %d", i, "interface", -1);
+	bench_use(buf[0]);
+}
+
+static void printfrr_plain(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < PRINTFRR_OPS; i++)
+		snprintfrr(buf, sizeof(buf), "%u: %s %d", i, "interface", -1);
+	bench_use(buf[0]);
+}
+
+static void printfrr_pfx4(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < PRINTFRR_OPS; i++)
+		snprintfrr(buf, sizeof(buf), "%pFX", &p4);
+	bench_use(buf[0]);
+}
+
+static void printfrr_pfx6(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < PRINTFRR_OPS; i++)
+		snprintfrr(buf, sizeof(buf), "%pFX", &p6);
+	bench_use(buf[0]);
+}
+
+static void printfrr_ipv4(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < PRINTFRR_OPS; i++)
+		snprintfrr(buf, sizeof(buf), "%pI4", &p4.u.prefix4);
+	bench_use(buf[0]);
+}
+
+static void printfrr_asprintf(void)
+{
+	unsigned int i;
+	char *str;
+
+	for (i = 0; i < PRINTFRR_OPS; i++) {
+		str = asprintfrr(MTYPE_TMP, "%pFX via %pI4", &p6,
+				 &p4.u.prefix4);
+		bench_use(str);
+		XFREE(MTYPE_TMP, str);
+	}
+}
+
+BENCH_SUITE(printfrr,
+	{
+		.name = "libc snprintf",
+		.ops = PRINTFRR_OPS,
+		.run = printfrr_libc,
+	},
+	{
+		.name = "plain",
+		.ops = PRINTFRR_OPS,
+		.run = printfrr_plain,
+	},
+	{
+		.name = "%pFX ipv4",
+		.ops = PRINTFRR_OPS,
+		.setup = printfrr_setup,
+		.run = printfrr_pfx4,
+	},
+	{
+		.name = "%pFX ipv6",
+		.ops = PRINTFRR_OPS,
+		.setup = printfrr_setup,
+		.run = printfrr_pfx6,
+	},
+	{
+		.name = "%pI4",
+		.ops = PRINTFRR_OPS,
+		.setup = printfrr_setup,
+		.run = printfrr_ipv4,
+	},
+	{
+		.name = "asprintfrr",
+		.ops = PRINTFRR_OPS,
+		.setup = printfrr_setup,
+		.run = printfrr_asprintf,
+	},
+);
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * lib/stream.c benchmarks
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "memory.h"
+#include "prefix.h"
+#include "stream.h"
+
+#include "tests/bench/bench.h"
+
+#define STREAM_OPS 100000
+
+static struct stream *s;
+static struct stream_fifo *fifo;
+static struct prefix *prefixes;
+
+static void stream_setup(void)
+{
+	unsigned int i;
+
+	s = stream_new(STREAM_OPS * (2 + IPV6_MAX_BYTELEN));
+	fifo = stream_fifo_new();
+
+	prefixes = XCALLOC(MTYPE_TMP, STREAM_OPS * sizeof(*prefixes));
+	for (i = 0; i < STREAM_OPS; i++) {
+		prefixes[i].family = AF_INET6;
+		prefixes[i].prefixlen = i % (IPV6_MAX_BITLEN + 1);
+		prefixes[i].u.prefix6.s6_addr32[0] = htonl(0x20010db8);
+		prefixes[i].u.prefix6.s6_addr32[1] = htonl(i);
+		apply_mask(&prefixes[i]);
+	}
+}
+
+static void stream_teardown(void)
+{
+	stream_free(s);
+	stream_fifo_free(fifo);
+	XFREE(MTYPE_TMP, prefixes);
+}
+
+static void stream_putget(void)
+{
+	unsigned int i;
+
+	stream_reset(s);
+	for (i = 0; i < STREAM_OPS; i++)
+		stream_putl(s, i);
+	for (i = 0; i < STREAM_OPS; i++)
+		bench_use(stream_getl(s));
+}
+
+static void stream_prefix(void)
+{
+	unsigned int i;
+
+	stream_reset(s);
+	for (i = 0; i < STREAM_OPS; i++)
+		stream_put_prefix(s, &prefixes[i]);
+}
+
+static void stream_alloc(void)
+{
+	struct stream *tmp;
+	unsigned int i;
+
+	for (i = 0; i < STREAM_OPS; i++) {
+		tmp = stream_new(4096);
+		bench_use(tmp);
+		stream_free(tmp);
+	}
+}
+
+static void stream_fifo(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < STREAM_OPS; i++)
+		stream_fifo_push(fifo, s);
+	for (i = 0; i < STREAM_OPS; i++)
+		bench_use(stream_fifo_pop(fifo));
+}
+
+BENCH_SUITE(stream,
+	{
+		.name = "putl+getl",
+		.ops = 2 * STREAM_OPS,
+		.setup = stream_setup,
+		.run = stream_putget,
+		.teardown = stream_teardown,
+	},
+	{
+		.name = "put_prefix",
+		.ops = STREAM_OPS,
+		.setup = stream_setup,
+		.run = stream_prefix,
+		.teardown = stream_teardown,
+	},
+	{
+		.name = "new+free",
+		.ops = STREAM_OPS,
+		.setup = stream_setup,
+		.run = stream_alloc,
+		.teardown = stream_teardown,
+	},
+	{
+		.name = "fifo push+pop",
+		.ops = 2 * STREAM_OPS,
+		.setup = stream_setup,
+		.run = stream_fifo,
+		.teardown = stream_teardown,
+	},
+);
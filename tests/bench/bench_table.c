@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * lib/table.c benchmarks
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "memory.h"
+#include "prefix.h"
+#include "prng.h"
+#include "table.h"
+
+#include "tests/bench/bench.h"
+
+#define TABLE_PREFIXES 100000
+
+static struct prefix_ipv4 *prefixes;
+static struct prefix_ipv4 *addrs;
+static struct route_table *table;
+
+static void table_prefixes(void)
+{
+	struct prng *prng = prng_new(0);
+	unsigned int i;
+
+	prefixes = XCALLOC(MTYPE_TMP, TABLE_PREFIXES * sizeof(*prefixes));
+	addrs = XCALLOC(MTYPE_TMP, TABLE_PREFIXES * sizeof(*addrs));
+
+	for (i = 0; i < TABLE_PREFIXES; i++) {
+		prefixes[i].family = AF_INET;
+		prefixes[i].prefixlen = 8 + prng_rand(prng) % 25;
+		prefixes[i].prefix.s_addr = prng_rand(prng);
+		apply_mask_ipv4(&prefixes[i]);
+
+		addrs[i].family = AF_INET;
+		addrs[i].prefixlen = IPV4_MAX_BITLEN;
+		addrs[i].prefix.s_addr = prng_rand(prng);
+	}
+	prng_free(prng);
+}
+
+static void table_fill(void)
+{
+	struct route_node *rn;
+	unsigned int i;
+
+	table = route_table_init();
+	for (i = 0; i < TABLE_PREFIXES; i++) {
+		rn = route_node_get(table, (struct prefix *)&prefixes[i]);
+		rn->info = &prefixes[i];
+	}
+}
+
+static void table_setup(void)
+{
+	table_prefixes();
+	table_fill();
+}
+
+static void table_teardown(void)
+{
+	route_table_finish(table);
+	table = NULL;
+	XFREE(MTYPE_TMP, prefixes);
+	XFREE(MTYPE_TMP, addrs);
+}
+
+/* building (and freeing) the whole table */
+static void table_insert(void)
+{
+	route_table_finish(table);
+	table_fill();
+}
+
+static void table_lookup(void)
+{
+	struct route_node *rn;
+	unsigned int i;
+
+	for (i = 0; i < TABLE_PREFIXES; i++) {
+		rn = route_node_lookup(table, (struct prefix *)&prefixes[i]);
+		bench_use(rn->info);
+		route_unlock_node(rn);
+	}
+}
+
+static void table_match(void)
+{
+	struct route_node *rn;
+	unsigned int i;
+
+	for (i = 0; i < TABLE_PREFIXES; i++) {
+		rn = route_node_match(table, (struct prefix *)&addrs[i]);
+		if (rn)
+			route_unlock_node(rn);
+		bench_use(rn);
+	}
+}
+
+static void table_walk(void)
+{
+	struct route_node *rn;
+
+	for (rn = route_top(table); rn; rn = route_next(rn))
+		bench_use(rn->info);
+}
+
+BENCH_SUITE(table,
+	{
+		.name = "insert",
+		.ops = TABLE_PREFIXES,
+		.setup = table_setup,
+		.run = table_insert,
+		.teardown = table_teardown,
+	},
+	{
+		.name = "lookup",
+		.ops = TABLE_PREFIXES,
+		.setup = table_setup,
+		.run = table_lookup,
+		.teardown = table_teardown,
+	},
+	{
+		.name = "match",
+		.ops = TABLE_PREFIXES,
+		.setup = table_setup,
+		.run = table_match,
+		.teardown = table_teardown,
+	},
+	{
+		.name = "walk",
+		.ops = TABLE_PREFIXES,
+		.setup = table_setup,
+		.run = table_walk,
+		.teardown = table_teardown,
+	},
+);
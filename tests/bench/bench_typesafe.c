@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Typesafe container benchmarks
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "jhash.h"
+#include "memory.h"
+#include "typerb.h"
+#include "typesafe.h"
+
+#include "tests/bench/bench.h"
+
+#define TS_ITEMS 100000
+
+PREDECL_RBTREE_UNIQ(ts_rb);
+PREDECL_HASH(ts_hash);
+PREDECL_SKIPLIST_UNIQ(ts_skip);
+
+struct ts_item {
+	uint32_t key;
+
+	struct ts_rb_item rb;
+	struct ts_hash_item hash;
+	struct ts_skip_item skip;
+};
+
+static int ts_cmp(const struct ts_item *a, const struct ts_item *b)
+{
+	return numcmp(a->key, b->key);
+}
+
+static uint32_t ts_hashfn(const struct ts_item *item)
+{
+	return jhash_1word(item->key, 0);
+}
+
+DECLARE_RBTREE_UNIQ(ts_rb, struct ts_item, rb, ts_cmp);
+DECLARE_HASH(ts_hash, struct ts_item, hash, ts_cmp, ts_hashfn);
+DECLARE_SKIPLIST_UNIQ(ts_skip, struct ts_item, skip, ts_cmp);
+
+static struct ts_item *items;
+
+static void ts_items(void)
+{
+	unsigned int i;
+
+	items = XCALLOC(MTYPE_TMP, TS_ITEMS * sizeof(*items));
+	/* multiplying by an odd number gives distinct, scattered keys */
+	for (i = 0; i < TS_ITEMS; i++)
+		items[i].key = i * 2654435761U;
+}
+
+/*
+ * The same benchmarks for each container: deleting and adding back all
+ * items, finding present and absent ones and iterating.
+ */
+#define TS_BENCH(list)                                                         \
+	static struct list##_head list##_head;                                 \
+                                                                               \
+	static void list##_setup(void)                                         \
+	{                                                                      \
+		unsigned int i;                                                \
+                                                                               \
+		ts_items();                                                    \
+		list##_init(&list##_head);                                     \
+		for (i = 0; i < TS_ITEMS; i++)                                 \
+			list##_add(&list##_head, &items[i]);                   \
+	}                                                                      \
+                                                                               \
+	static void list##_teardown(void)                                      \
+	{                                                                      \
+		while (list##_pop(&list##_head))                               \
+			;                                                      \
+		list##_fini(&list##_head);                                     \
+		XFREE(MTYPE_TMP, items);                                       \
+	}                                                                      \
+                                                                               \
+	static void list##_bench_insert(void)                                  \
+	{                                                                      \
+		unsigned int i;                                                \
+                                                                               \
+		for (i = 0; i < TS_ITEMS; i++)                                 \
+			list##_del(&list##_head, &items[i]);                   \
+		for (i = 0; i < TS_ITEMS; i++)                                 \
+			list##_add(&list##_head, &items[i]);                   \
+	}                                                                      \
+                                                                               \
+	static void list##_bench_find(void)                                    \
+	{                                                                      \
+		unsigned int i;                                                \
+                                                                               \
+		for (i = 0; i < TS_ITEMS; i++)                                 \
+			bench_use(list##_find(&list##_head, &items[i]));       \
+	}                                                                      \
+                                                                               \
+	static void list##_bench_miss(void)                                    \
+	{                                                                      \
+		struct ts_item ref;                                            \
+		unsigned int i;                                                \
+                                                                               \
+		for (i = 0; i < TS_ITEMS; i++) {                               \
+			ref.key = items[i].key + 1;                            \
+			bench_use(list##_find(&list##_head, &ref));            \
+		}                                                              \
+	}                                                                      \
+                                                                               \
+	static void list##_bench_iter(void)                                    \
+	{                                                                      \
+		struct ts_item *item;                                          \
+                                                                               \
+		frr_each (list, &list##_head, item)                            \
+			bench_use(item->key);                                  \
+	}                                                                      \
+	MACRO_REQUIRE_SEMICOLON() /* end */
+
+TS_BENCH(ts_rb);
+TS_BENCH(ts_hash);
+TS_BENCH(ts_skip);
+
+#define TS_ENTRIES(list, label)                                                \
+	{                                                                      \
+		.name = label "/del+add",                                      \
+		.ops = 2 * TS_ITEMS,                                           \
+		.setup = list##_setup,                                         \
+		.run = list##_bench_insert,                                    \
+		.teardown = list##_teardown,                                   \
+	},                                                                     \
+	{                                                                      \
+		.name = label "/find",                                         \
+		.ops = TS_ITEMS,                                               \
+		.setup = list##_setup,                                         \
+		.run = list##_bench_find,                                      \
+		.teardown = list##_teardown,                                   \
+	},                                                                     \
+	{                                                                      \
+		.name = label "/find-miss",                                    \
+		.ops = TS_ITEMS,                                               \
+		.setup = list##_setup,                                         \
+		.run = list##_bench_miss,                                      \
+		.teardown = list##_teardown,                                   \
+	},                                                                     \
+	{                                                                      \
+		.name = label "/iterate",                                      \
+		.ops = TS_ITEMS,                                               \
+		.setup = list##_setup,                                         \
+		.run = list##_bench_iter,                                      \
+		.teardown = list##_teardown,                                   \
+	}
+
+BENCH_SUITE(typesafe,
+	TS_ENTRIES(ts_rb, "rbtree"),
+	TS_ENTRIES(ts_hash, "hash"),
+	TS_ENTRIES(ts_skip, "skiplist"),
+);
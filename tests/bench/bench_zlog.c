@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * zlog benchmarks
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "prefix.h"
+#include "zlog.h"
+#include "zlog_targets.h"
+
+#include "tests/bench/bench.h"
+
+#define ZLOG_OPS 100000
+
+static struct zlog_cfg_file zcf;
+static struct prefix p;
+
+static void zlog_setup_prio(int prio)
+{
+	int fd;
+
+	str2prefix("2001:db8::/32", &p);
+
+	fd = open("/dev/null", O_WRONLY);
+	assert(fd >= 0);
+
+	zlog_file_init(&zcf);
+	zcf.prio_min = prio;
+	zlog_file_set_fd(&zcf, fd);
+}
+
+/* messages go to /dev/null, formatting and writing them is measured */
+static void zlog_setup_debug(void)
+{
+	zlog_setup_prio(LOG_DEBUG);
+}
+
+/* debug messages are filtered out, only the check is measured */
+static void zlog_setup_info(void)
+{
+	zlog_setup_prio(LOG_INFO);
+}
+
+static void zlog_teardown(void)
+{
+	zlog_file_fini(&zcf);
+}
+
+static void zlog_bench_debug(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < ZLOG_OPS; i++)
+		zlog_debug("route %pFX update %u from %s", &p, i, "bench");
+}
+
+static void zlog_bench_constant(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < ZLOG_OPS; i++)
+		zlog_debug("constant log message");
+}
+
+BENCH_SUITE(zlog,
+	{
+		.name = "debug to file",
+		.ops = ZLOG_OPS,
+		.setup = zlog_setup_debug,
+		.run = zlog_bench_debug,
+		.teardown = zlog_teardown,
+	},
+	{
+		.name = "constant to file",
+		.ops = ZLOG_OPS,
+		.setup = zlog_setup_debug,
+		.run = zlog_bench_constant,
+		.teardown = zlog_teardown,
+	},
+	{
+		.name = "debug filtered",
+		.ops = ZLOG_OPS,
+		.setup = zlog_setup_info,
+		.run = zlog_bench_debug,
+		.teardown = zlog_teardown,
+	},
+);
@@ -124,9 +124,10 @@ static void do_test(struct bgp_table *table, const char *prefix, ...)
 /*
  * test_range_lookup
  */
-static void test_range_lookup(void)
+static void test_range_lookup(bool pool)
 {
-	struct bgp_table *table = bgp_table_init(NULL, AFI_IP, SAFI_UNICAST);
+	struct bgp_table *table =
+		bgp_table_init_ext(NULL, AFI_IP, SAFI_UNICAST, pool);
 
 	printf("Testing bgp_table_range_lookup\n");
 
@@ -161,7 +162,69 @@ static void test_range_lookup(void)
 		"1.16.32.0/20", "1.16.32.0/21", "16.0.0.0/16", NULL);
 }
 
+#define WALK_PREFIXES 64
+
+/* spread the /24s around so the tree gets some depth */
+static in_addr_t walk_addr(uint32_t i)
+{
+	return htonl((i * 0x9e3779b1U) & 0xffffff00U);
+}
+
+/*
+ * test_walk
+ *
+ * Fill a table with /24s, delete every other one to fragment it the way
+ * churn does, and check that a full walk still visits exactly the
+ * remaining prefixes, in order.
+ */
+static void test_walk(bool pool)
+{
+	struct bgp_table *table =
+		bgp_table_init_ext(NULL, AFI_IP, SAFI_UNICAST, pool);
+	struct bgp_dest *dest;
+	struct route_node *rn;
+	struct prefix p = { .family = AF_INET, .prefixlen = 24 };
+	uint32_t last = 0;
+	int count = 0;
+	int i;
+
+	printf("Testing bgp_table walk\n");
+
+	for (i = 0; i < WALK_PREFIXES; i++) {
+		p.u.prefix4.s_addr = walk_addr(i);
+		dest = bgp_node_get(table, &p);
+		if (i % 2)
+			bgp_dest_unlock_node(dest);
+	}
+
+	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
+		const struct prefix *dest_p = bgp_dest_get_prefix(dest);
+		uint32_t addr = ntohl(dest_p->u.prefix4.s_addr);
+
+		if (dest_p->prefixlen != 24)
+			continue;
+
+		assert(!count || addr > last);
+		last = addr;
+		count++;
+	}
+	assert(count == WALK_PREFIXES / 2);
+
+	for (i = 0; i < WALK_PREFIXES; i++) {
+		p.u.prefix4.s_addr = walk_addr(i);
+		rn = route_node_lookup_maynull(table->route_table, &p);
+		assert((rn == NULL) == (i % 2 == 1));
+		if (rn)
+			route_unlock_node(rn);
+	}
+
+	bgp_table_unlock(table);
+}
+
 int main(void)
 {
-	test_range_lookup();
+	test_range_lookup(false);
+	test_range_lookup(true);
+	test_walk(false);
+	test_walk(true);
 }
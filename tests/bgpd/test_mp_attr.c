@@ -995,6 +995,7 @@ static void parse_test(struct peer *peer, struct test_segment *t, int type)
 	struct bgp_nlri nlri = {};
 	struct bgp_attr_parser_args attr_args = {
 		.peer = peer,
+		.s = peer->curr,
 		.length = t->len,
 		.total = 1,
 		.attr = &attr,
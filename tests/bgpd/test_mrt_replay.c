@@ -0,0 +1,1083 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * BGP ingestion benchmark: replays MRT dumps (TABLE_DUMP_V2 and BGP4MP)
+ * into bgpd through synthetic peers connected over loopback, so updates go
+ * the whole way through the socket, bgp_update_receive(), best path
+ * selection and update generation towards the other peers.  Results are
+ * printed as JSON.
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include <getopt.h>
+#include <sys/resource.h>
+
+#include "command.h"
+#include "filter.h"
+#include "frr_pthread.h"
+#include "json.h"
+#include "memory.h"
+#include "monotime.h"
+#include "network.h"
+#include "northbound.h"
+#include "privs.h"
+#include "routemap.h"
+#include "sockunion.h"
+#include "stream.h"
+#include "vrf.h"
+#include "vty.h"
+#include "workqueue.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_dump.h"
+#include "bgpd/bgp_network.h"
+#include "bgpd/bgp_open.h"
+#include "bgpd/bgp_packet.h"
+#include "bgpd/bgp_routemap_nb.h"
+#include "bgpd/bgp_table.h"
+
+/* need these to link in libbgp */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master;
+
+#define MRT_TYPE_TABLE_DUMP_V2 13
+
+#define REPLAY_TICK_MSEC 10
+#define REPLAY_ESTABLISH_SEC 60
+#define REPLAY_QUIET_MSEC 1000
+#define REPLAY_LOCAL_AS 4200000000U
+
+/* room for the full MP_REACH_NLRI rebuilt from the abbreviated one */
+#define RIB_MP_OVERHEAD 9
+
+static const struct frr_yang_module_info *const replay_yang_modules[] = {
+	&frr_filter_info,
+	&frr_interface_info,
+	&frr_route_map_info,
+	&frr_vrf_info,
+	&frr_bgp_route_map_info,
+};
+
+/* A peer in the MRT files, whose updates are replayed by one or more of ours */
+struct replay_source {
+	int family;
+	uint8_t addr[IPV6_MAX_BYTELEN];
+	as_t as;
+	bool as4;
+
+	/* complete BGP messages, in the order they are sent */
+	uint8_t *msgs;
+	size_t len, size;
+	uint32_t count;
+	uint64_t prefixes;
+
+	/* UPDATE being packed from consecutive TABLE_DUMP_V2 entries */
+	afi_t rib_afi;
+	uint16_t rib_attr_len;
+	uint16_t rib_nlri_len;
+	uint32_t rib_prefixes;
+	uint8_t rib_attr[BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE];
+	uint8_t rib_nlri[BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE];
+};
+
+struct replay_peer {
+	unsigned int idx;
+	struct replay_source *src;
+	union sockunion su;
+	char host[INET_ADDRSTRLEN];
+
+	struct peer *peer;
+	int fd;
+	size_t sent;
+
+	struct event *t_read;
+	struct event *t_write;
+};
+
+enum replay_phase {
+	PHASE_ESTABLISH,
+	PHASE_RECEIVE,
+	PHASE_BESTPATH,
+	PHASE_UPDATES,
+	PHASE_DONE,
+};
+
+static struct {
+	/* options */
+	unsigned int npeers;
+	unsigned int ngroups;
+	unsigned int quiet_msec;
+	as_t asn;
+	const char *config;
+
+	struct replay_source **sources;
+	unsigned int nsources;
+	uint64_t records, skipped;
+
+	struct bgp *bgp;
+	uint16_t port;
+	struct replay_peer *peers;
+
+	enum replay_phase phase;
+	bool failed;
+	struct event *t_tick;
+	struct timeval t_init, t_start, t_rx, t_best, t_out, t_last_out;
+	uint64_t out_bytes;
+} rp = {
+	.ngroups = 1,
+	.quiet_msec = REPLAY_QUIET_MSEC,
+	.asn = REPLAY_LOCAL_AS,
+};
+
+static void replay_fail(const char *fmt, ...) PRINTFRR(1, 2);
+static void replay_fail(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fputc('\n', stderr);
+
+	rp.failed = true;
+	rp.phase = PHASE_DONE;
+}
+
+static struct replay_source *source_get(int family, const uint8_t *addr,
+					as_t as, bool as4)
+{
+	struct replay_source *src;
+	size_t alen = family == AF_INET ? IPV4_MAX_BYTELEN : IPV6_MAX_BYTELEN;
+	unsigned int i;
+
+	for (i = 0; i < rp.nsources; i++) {
+		src = rp.sources[i];
+		if (src->family == family && src->as == as && src->as4 == as4
+		    && !memcmp(src->addr, addr, alen))
+			return src;
+	}
+
+	src = XCALLOC(MTYPE_TMP, sizeof(*src));
+	src->family = family;
+	memcpy(src->addr, addr, alen);
+	src->as = as;
+	src->as4 = as4;
+
+	rp.sources = XREALLOC(MTYPE_TMP, rp.sources,
+			      (rp.nsources + 1) * sizeof(*rp.sources));
+	rp.sources[rp.nsources++] = src;
+	return src;
+}
+
+static void source_put(struct replay_source *src, const void *msg, size_t len)
+{
+	if (src->len + len > src->size) {
+		src->size = MAX(src->size * 2, src->len + len + 65536);
+		src->msgs = XREALLOC(MTYPE_TMP, src->msgs, src->size);
+	}
+	memcpy(src->msgs + src->len, msg, len);
+	src->len += len;
+	src->count++;
+}
+
+static uint32_t nlri_count(const uint8_t *p, size_t len)
+{
+	uint32_t n = 0;
+	size_t psize;
+
+	while (len) {
+		psize = 1 + PSIZE(p[0]);
+		if (psize > len)
+			break;
+		n++;
+		p += psize;
+		len -= psize;
+	}
+	return n;
+}
+
+/* prefixes announced or withdrawn by an UPDATE body */
+static uint32_t update_prefixes(const uint8_t *p, size_t len)
+{
+	const uint8_t *end = p + len, *aend, *val;
+	uint16_t wlen, alen, vlen;
+	uint32_t n = 0;
+	uint8_t flags, type, nhlen;
+
+	if (len < 4)
+		return 0;
+
+	wlen = (p[0] << 8) | p[1];
+	if (len < (size_t)wlen + 4)
+		return 0;
+	n += nlri_count(p + 2, wlen);
+	p += 2 + wlen;
+
+	alen = (p[0] << 8) | p[1];
+	p += 2;
+	if (p + alen > end)
+		return n;
+	aend = p + alen;
+
+	while (p + 3 <= aend) {
+		flags = p[0];
+		type = p[1];
+		if (CHECK_FLAG(flags, BGP_ATTR_FLAG_EXTLEN)) {
+			if (p + 4 > aend)
+				break;
+			vlen = (p[2] << 8) | p[3];
+			val = p + 4;
+		} else {
+			vlen = p[2];
+			val = p + 3;
+		}
+		if (val + vlen > aend)
+			break;
+
+		if (type == BGP_ATTR_MP_REACH_NLRI && vlen >= 5) {
+			nhlen = val[3];
+			if (5 + nhlen <= vlen)
+				n += nlri_count(val + 5 + nhlen,
+						vlen - 5 - nhlen);
+		} else if (type == BGP_ATTR_MP_UNREACH_NLRI && vlen >= 3)
+			n += nlri_count(val + 3, vlen - 3);
+
+		p = val + vlen;
+	}
+
+	return n + nlri_count(aend, end - aend);
+}
+
+/*
+ * Turn the packed TABLE_DUMP_V2 entries into an UPDATE.  For IPv6 the MRT
+ * attributes only carry the nexthop in MP_REACH_NLRI (RFC 6396 4.3.4), the
+ * full attribute is rebuilt around the packed prefixes.
+ */
+static void rib_flush(struct replay_source *src)
+{
+	struct stream *s;
+	const uint8_t *p, *end, *val, *nh = NULL;
+	uint16_t vlen;
+	uint8_t nhlen = 0;
+	size_t alen_pos;
+
+	if (!src->rib_nlri_len)
+		return;
+
+	s = stream_new(BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE);
+	bgp_packet_set_marker(s, BGP_MSG_UPDATE);
+	stream_putw(s, 0);
+
+	if (src->rib_afi == AFI_IP) {
+		stream_putw(s, src->rib_attr_len);
+		stream_put(s, src->rib_attr, src->rib_attr_len);
+		stream_put(s, src->rib_nlri, src->rib_nlri_len);
+	} else {
+		alen_pos = stream_get_endp(s);
+		stream_putw(s, 0);
+
+		p = src->rib_attr;
+		end = p + src->rib_attr_len;
+		while (p + 3 <= end) {
+			if (CHECK_FLAG(p[0], BGP_ATTR_FLAG_EXTLEN)) {
+				if (p + 4 > end)
+					break;
+				vlen = (p[2] << 8) | p[3];
+				val = p + 4;
+			} else {
+				vlen = p[2];
+				val = p + 3;
+			}
+			if (val + vlen > end)
+				break;
+
+			if (p[1] != BGP_ATTR_MP_REACH_NLRI)
+				stream_put(s, p, val + vlen - p);
+			else if (vlen >= 1 && val[0] == vlen - 1) {
+				nhlen = val[0];
+				nh = val + 1;
+			} else if (vlen >= 4) {
+				/* some writers put in the full attribute */
+				nhlen = val[3];
+				nh = val + 4;
+				if (4 + nhlen > vlen)
+					nh = NULL;
+			}
+			p = val + vlen;
+		}
+
+		if (!nh) {
+			rp.skipped += src->rib_prefixes;
+			goto out;
+		}
+
+		stream_putc(s, BGP_ATTR_FLAG_OPTIONAL | BGP_ATTR_FLAG_EXTLEN);
+		stream_putc(s, BGP_ATTR_MP_REACH_NLRI);
+		stream_putw(s, 5 + nhlen + src->rib_nlri_len);
+		stream_putw(s, IANA_AFI_IPV6);
+		stream_putc(s, IANA_SAFI_UNICAST);
+		stream_putc(s, nhlen);
+		stream_put(s, nh, nhlen);
+		stream_putc(s, 0);
+		stream_put(s, src->rib_nlri, src->rib_nlri_len);
+
+		stream_putw_at(s, alen_pos,
+			       stream_get_endp(s) - alen_pos - 2);
+	}
+
+	bgp_packet_set_size(s);
+	source_put(src, STREAM_DATA(s), stream_get_endp(s));
+	src->prefixes += src->rib_prefixes;
+
+out:
+	stream_free(s);
+	src->rib_nlri_len = 0;
+	src->rib_prefixes = 0;
+}
+
+static void rib_add(struct replay_source *src, afi_t afi, const uint8_t *attr,
+		    uint16_t attr_len, uint8_t plen, const uint8_t *pfx)
+{
+	size_t psize = PSIZE(plen);
+	size_t fixed = BGP_HEADER_SIZE + 4 + attr_len + RIB_MP_OVERHEAD;
+
+	if (fixed + 1 + psize > BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE) {
+		rp.skipped++;
+		return;
+	}
+
+	if (src->rib_nlri_len
+	    && (src->rib_afi != afi || src->rib_attr_len != attr_len
+		|| memcmp(src->rib_attr, attr, attr_len)
+		|| fixed + src->rib_nlri_len + 1 + psize
+			   > BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE))
+		rib_flush(src);
+
+	if (!src->rib_nlri_len) {
+		src->rib_afi = afi;
+		src->rib_attr_len = attr_len;
+		memcpy(src->rib_attr, attr, attr_len);
+	}
+
+	src->rib_nlri[src->rib_nlri_len++] = plen;
+	memcpy(src->rib_nlri + src->rib_nlri_len, pfx, psize);
+	src->rib_nlri_len += psize;
+	src->rib_prefixes++;
+}
+
+static int mrt_peer_index(struct stream *s, struct replay_source ***index,
+			  uint16_t *nindex)
+{
+	uint8_t addr[IPV6_MAX_BYTELEN];
+	uint16_t vlen, count, as2, i;
+	uint8_t type;
+	uint32_t as;
+
+	stream_forward_getp(s, 4);
+	STREAM_GETW(s, vlen);
+	if (STREAM_READABLE(s) < vlen)
+		goto stream_failure;
+	stream_forward_getp(s, vlen);
+	STREAM_GETW(s, count);
+
+	*index = XREALLOC(MTYPE_TMP, *index, count * sizeof(**index));
+	*nindex = 0;
+
+	for (i = 0; i < count; i++) {
+		STREAM_GETC(s, type);
+		if (STREAM_READABLE(s) < 4)
+			goto stream_failure;
+		stream_forward_getp(s, 4);
+		memset(addr, 0, sizeof(addr));
+		if (CHECK_FLAG(type, TABLE_DUMP_V2_PEER_INDEX_TABLE_IP6))
+			STREAM_GET(addr, s, IPV6_MAX_BYTELEN);
+		else
+			STREAM_GET(addr, s, IPV4_MAX_BYTELEN);
+		if (CHECK_FLAG(type, TABLE_DUMP_V2_PEER_INDEX_TABLE_AS4))
+			STREAM_GETL(s, as);
+		else {
+			STREAM_GETW(s, as2);
+			as = as2;
+		}
+
+		/* AS_PATHs in TABLE_DUMP_V2 always have 4 byte ASes */
+		(*index)[i] = source_get(
+			CHECK_FLAG(type, TABLE_DUMP_V2_PEER_INDEX_TABLE_IP6)
+				? AF_INET6
+				: AF_INET,
+			addr, as, true);
+		(*nindex)++;
+	}
+	return 0;
+
+stream_failure:
+	return -1;
+}
+
+static int mrt_rib(struct stream *s, afi_t afi, struct replay_source **index,
+		   uint16_t nindex)
+{
+	uint8_t pfx[IPV6_MAX_BYTELEN];
+	uint16_t count, idx, alen, i;
+	uint8_t plen;
+
+	stream_forward_getp(s, 4);
+	STREAM_GETC(s, plen);
+	if (plen > (afi == AFI_IP ? IPV4_MAX_BITLEN : IPV6_MAX_BITLEN))
+		goto stream_failure;
+	STREAM_GET(pfx, s, PSIZE(plen));
+	STREAM_GETW(s, count);
+
+	for (i = 0; i < count; i++) {
+		STREAM_GETW(s, idx);
+		if (STREAM_READABLE(s) < 4)
+			goto stream_failure;
+		stream_forward_getp(s, 4);
+		STREAM_GETW(s, alen);
+		if (STREAM_READABLE(s) < alen)
+			goto stream_failure;
+
+		if (idx < nindex)
+			rib_add(index[idx], afi, stream_pnt(s), alen, plen,
+				pfx);
+		else
+			rp.skipped++;
+		stream_forward_getp(s, alen);
+	}
+	return 0;
+
+stream_failure:
+	return -1;
+}
+
+static int mrt_bgp4mp(struct stream *s, uint16_t subtype)
+{
+	struct replay_source *src;
+	uint8_t addr[IPV6_MAX_BYTELEN] = {};
+	bool as4 = subtype == BGP4MP_MESSAGE_AS4;
+	uint16_t as2, afi, mlen;
+	uint32_t as;
+	const uint8_t *msg;
+	size_t alen;
+
+	if (as4) {
+		STREAM_GETL(s, as);
+		stream_forward_getp(s, 4);
+	} else {
+		STREAM_GETW(s, as2);
+		as = as2;
+		stream_forward_getp(s, 2);
+	}
+	stream_forward_getp(s, 2);
+	STREAM_GETW(s, afi);
+	if (afi == IANA_AFI_IPV4)
+		alen = IPV4_MAX_BYTELEN;
+	else if (afi == IANA_AFI_IPV6)
+		alen = IPV6_MAX_BYTELEN;
+	else
+		goto stream_failure;
+	STREAM_GET(addr, s, alen);
+	if (STREAM_READABLE(s) < alen + BGP_HEADER_SIZE)
+		goto stream_failure;
+	stream_forward_getp(s, alen);
+
+	msg = stream_pnt(s);
+	mlen = (msg[BGP_MARKER_SIZE] << 8) | msg[BGP_MARKER_SIZE + 1];
+	if (msg[BGP_MARKER_SIZE + 2] != BGP_MSG_UPDATE)
+		return 0;
+	/* our sessions don't negotiate extended messages */
+	if (mlen != STREAM_READABLE(s)
+	    || mlen > BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE) {
+		rp.skipped++;
+		return 0;
+	}
+
+	src = source_get(afi == IANA_AFI_IPV4 ? AF_INET : AF_INET6, addr, as,
+			 as4);
+	rib_flush(src);
+	source_put(src, msg, mlen);
+	src->prefixes += update_prefixes(msg + BGP_HEADER_SIZE,
+					 mlen - BGP_HEADER_SIZE);
+	return 0;
+
+stream_failure:
+	return -1;
+}
+
+static int mrt_load(const char *path)
+{
+	struct replay_source **index = NULL;
+	uint16_t nindex = 0, type, subtype;
+	uint8_t hdr[BGP_DUMP_HEADER_SIZE];
+	struct stream *s;
+	uint32_t len;
+	unsigned int i;
+	FILE *fp;
+	int ret = 0;
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		fprintf(stderr, "%s: %s\n", path, safe_strerror(errno));
+		return -1;
+	}
+
+	s = stream_new(BGP_MAX_PACKET_SIZE);
+
+	while (fread(hdr, sizeof(hdr), 1, fp) == 1) {
+		type = (hdr[4] << 8) | hdr[5];
+		subtype = (hdr[6] << 8) | hdr[7];
+		len = ((uint32_t)hdr[8] << 24) | (hdr[9] << 16) | (hdr[10] << 8)
+		      | hdr[11];
+
+		if (len > STREAM_SIZE(s))
+			stream_resize_inplace(&s, len);
+		stream_reset(s);
+		if (len && fread(STREAM_DATA(s), len, 1, fp) != 1) {
+			fprintf(stderr, "%s: truncated record\n", path);
+			ret = -1;
+			break;
+		}
+		stream_set_endp(s, len);
+		rp.records++;
+
+		if (type == MSG_PROTOCOL_BGP4MP_ET) {
+			/* microsecond timestamp */
+			if (len < 4)
+				continue;
+			stream_forward_getp(s, 4);
+			type = MSG_PROTOCOL_BGP4MP;
+		}
+
+		if (type == MRT_TYPE_TABLE_DUMP_V2
+		    && subtype == TABLE_DUMP_V2_PEER_INDEX_TABLE)
+			ret = mrt_peer_index(s, &index, &nindex);
+		else if (type == MRT_TYPE_TABLE_DUMP_V2
+			 && subtype == TABLE_DUMP_V2_RIB_IPV4_UNICAST)
+			ret = mrt_rib(s, AFI_IP, index, nindex);
+		else if (type == MRT_TYPE_TABLE_DUMP_V2
+			 && subtype == TABLE_DUMP_V2_RIB_IPV6_UNICAST)
+			ret = mrt_rib(s, AFI_IP6, index, nindex);
+		else if (type == MSG_PROTOCOL_BGP4MP
+			 && (subtype == BGP4MP_MESSAGE
+			     || subtype == BGP4MP_MESSAGE_AS4))
+			ret = mrt_bgp4mp(s, subtype);
+		else
+			rp.skipped++;
+
+		if (ret < 0) {
+			fprintf(stderr,
+				"%s: malformed record %" PRIu64
+				" (type %u subtype %u)\n",
+				path, rp.records, type, subtype);
+			break;
+		}
+	}
+
+	for (i = 0; i < rp.nsources; i++)
+		rib_flush(rp.sources[i]);
+
+	stream_free(s);
+	XFREE(MTYPE_TMP, index);
+	fclose(fp);
+	return ret;
+}
+
+static double tv_sec(const struct timeval *a, const struct timeval *b)
+{
+	return (b->tv_sec - a->tv_sec) + (b->tv_usec - a->tv_usec) / 1e6;
+}
+
+static void replay_report(void)
+{
+	struct json_object *json;
+	struct rusage ru;
+	uint64_t prefixes = 0, msgs = 0;
+	double best;
+	unsigned int i;
+
+	for (i = 0; i < rp.npeers; i++) {
+		prefixes += rp.peers[i].src->prefixes;
+		msgs += rp.peers[i].src->count;
+	}
+
+	getrusage(RUSAGE_SELF, &ru);
+	best = tv_sec(&rp.t_start, &rp.t_best);
+
+	json = json_object_new_object();
+	json_object_int_add(json, "peers", rp.npeers);
+	json_object_int_add(json, "peerGroups", rp.ngroups);
+	json_object_int_add(json, "sources", rp.nsources);
+	json_object_int_add(json, "records", rp.records);
+	json_object_int_add(json, "recordsSkipped", rp.skipped);
+	json_object_int_add(json, "updates", msgs);
+	json_object_int_add(json, "prefixes", prefixes);
+	json_object_int_add(json, "ipv4Destinations",
+			    bgp_table_count(rp.bgp->rib[AFI_IP][SAFI_UNICAST]));
+	json_object_int_add(json, "ipv6Destinations",
+			    bgp_table_count(
+				    rp.bgp->rib[AFI_IP6][SAFI_UNICAST]));
+	json_object_double_add(json, "establishSeconds",
+			       tv_sec(&rp.t_init, &rp.t_start));
+	/* the phases overlap, all times are from the first update sent */
+	json_object_double_add(json, "receiveSeconds",
+			       tv_sec(&rp.t_start, &rp.t_rx));
+	json_object_double_add(json, "bestpathSeconds", best);
+	json_object_double_add(json, "updateGenerationSeconds",
+			       tv_sec(&rp.t_start, &rp.t_out));
+	json_object_double_add(json, "prefixesPerSecond",
+			       best > 0 ? prefixes / best : 0);
+	json_object_int_add(json, "updateBytesOut", rp.out_bytes);
+	json_object_double_add(json, "cpuSeconds",
+			       ru.ru_utime.tv_sec + ru.ru_stime.tv_sec
+				       + (ru.ru_utime.tv_usec
+					  + ru.ru_stime.tv_usec) / 1e6);
+	json_object_int_add(json, "peakRssKb", ru.ru_maxrss);
+
+	printf("%s\n",
+	       json_object_to_json_string_ext(json, JSON_C_TO_STRING_PRETTY));
+	json_object_free(json);
+}
+
+static void peer_read(struct event *t)
+{
+	struct replay_peer *rpeer = EVENT_ARG(t);
+	static uint8_t buf[65536];
+	ssize_t n;
+
+	while ((n = read(rpeer->fd, buf, sizeof(buf))) > 0) {
+		rp.out_bytes += n;
+		monotime(&rp.t_last_out);
+	}
+
+	if (n == 0 || !ERRNO_IO_RETRY(errno)) {
+		replay_fail("%s: connection closed by bgpd", rpeer->host);
+		return;
+	}
+
+	event_add_read(master, peer_read, rpeer, rpeer->fd, &rpeer->t_read);
+}
+
+static void peer_write(struct event *t)
+{
+	struct replay_peer *rpeer = EVENT_ARG(t);
+	struct replay_source *src = rpeer->src;
+	ssize_t n;
+
+	while (rpeer->sent < src->len) {
+		n = write(rpeer->fd, src->msgs + rpeer->sent,
+			  src->len - rpeer->sent);
+		if (n < 0) {
+			if (!ERRNO_IO_RETRY(errno)) {
+				replay_fail("%s: write: %s", rpeer->host,
+					    safe_strerror(errno));
+				return;
+			}
+			event_add_write(master, peer_write, rpeer, rpeer->fd,
+					&rpeer->t_write);
+			return;
+		}
+		rpeer->sent += n;
+	}
+}
+
+/* OPEN without hold time, so nobody needs to send keepalives, + KEEPALIVE */
+static void peer_open(struct event *t)
+{
+	struct replay_peer *rpeer = EVENT_ARG(t);
+	struct stream *s;
+	as_t as = rpeer->src->as;
+	socklen_t len = sizeof(int);
+	size_t op, cp;
+	ssize_t ret;
+	int err = 0;
+
+	if (getsockopt(rpeer->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0)
+		err = errno;
+	if (err) {
+		replay_fail("%s: connect: %s", rpeer->host, safe_strerror(err));
+		return;
+	}
+
+	s = stream_new(BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE);
+	bgp_packet_set_marker(s, BGP_MSG_OPEN);
+	stream_putc(s, BGP_VERSION_4);
+	stream_putw(s, as > BGP_AS_MAX ? BGP_AS_TRANS : as);
+	stream_putw(s, 0);
+	stream_put_ipv4(s, htonl(0x0a010000 + rpeer->idx));
+
+	op = stream_get_endp(s);
+	stream_putc(s, 0);
+	stream_putc(s, BGP_OPEN_OPT_CAP);
+	cp = stream_get_endp(s);
+	stream_putc(s, 0);
+
+	stream_putc(s, CAPABILITY_CODE_MP);
+	stream_putc(s, CAPABILITY_CODE_MP_LEN);
+	stream_putw(s, IANA_AFI_IPV4);
+	stream_putc(s, 0);
+	stream_putc(s, IANA_SAFI_UNICAST);
+	stream_putc(s, CAPABILITY_CODE_MP);
+	stream_putc(s, CAPABILITY_CODE_MP_LEN);
+	stream_putw(s, IANA_AFI_IPV6);
+	stream_putc(s, 0);
+	stream_putc(s, IANA_SAFI_UNICAST);
+	if (rpeer->src->as4) {
+		stream_putc(s, CAPABILITY_CODE_AS4);
+		stream_putc(s, CAPABILITY_CODE_AS4_LEN);
+		stream_putl(s, as);
+	}
+
+	stream_putc_at(s, cp, stream_get_endp(s) - cp - 1);
+	stream_putc_at(s, op, stream_get_endp(s) - op - 1);
+	bgp_packet_set_size(s);
+
+	cp = stream_get_endp(s);
+	bgp_packet_set_marker(s, BGP_MSG_KEEPALIVE);
+	stream_putw_at(s, cp + BGP_MARKER_SIZE, BGP_HEADER_SIZE);
+
+	/* fits in any socket buffer */
+	ret = write(rpeer->fd, STREAM_DATA(s), stream_get_endp(s));
+	if (ret != (ssize_t)stream_get_endp(s)) {
+		replay_fail("%s: can't send OPEN", rpeer->host);
+		stream_free(s);
+		return;
+	}
+	stream_free(s);
+
+	event_add_read(master, peer_read, rpeer, rpeer->fd, &rpeer->t_read);
+}
+
+/* non-blocking, bgpd can only accept once the event loop runs */
+static int peer_connect(struct replay_peer *rpeer)
+{
+	struct sockaddr_in sin = {};
+
+	rpeer->fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (rpeer->fd < 0
+	    || bind(rpeer->fd, &rpeer->su.sa, sizeof(rpeer->su.sin)) < 0)
+		return -1;
+	set_nonblocking(rpeer->fd);
+
+	sin.sin_family = AF_INET;
+	sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	sin.sin_port = htons(rp.port);
+	if (connect(rpeer->fd, (struct sockaddr *)&sin, sizeof(sin)) < 0
+	    && errno != EINPROGRESS)
+		return -1;
+
+	event_add_write(master, peer_open, rpeer, rpeer->fd, &rpeer->t_write);
+	return 0;
+}
+
+static bool replay_peers_established(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < rp.npeers; i++)
+		if (!peer_established(rp.peers[i].peer))
+			return false;
+	return true;
+}
+
+/* nothing left for bgpd to write towards our peers */
+static bool replay_output_idle(void)
+{
+	struct peer *peer;
+	unsigned int i;
+
+	for (i = 0; i < rp.npeers; i++) {
+		peer = rp.peers[i].peer;
+		if (peer->t_generate_updgrp_packets
+		    || stream_fifo_count_safe(peer->obuf))
+			return false;
+	}
+	return true;
+}
+
+static void replay_tick(struct event *t)
+{
+	struct replay_peer *rpeer;
+	struct timeval now;
+	const struct timeval *since;
+	unsigned int i;
+
+	monotime(&now);
+
+	switch (rp.phase) {
+	case PHASE_ESTABLISH:
+		if (!replay_peers_established()) {
+			if (now.tv_sec - rp.t_init.tv_sec
+			    > REPLAY_ESTABLISH_SEC) {
+				replay_fail("peers did not establish");
+				return;
+			}
+			break;
+		}
+
+		rp.t_start = now;
+		rp.out_bytes = 0;
+		rp.phase = PHASE_RECEIVE;
+		for (i = 0; i < rp.npeers; i++)
+			event_add_write(master, peer_write, &rp.peers[i],
+					rp.peers[i].fd, &rp.peers[i].t_write);
+		break;
+
+	case PHASE_RECEIVE:
+		for (i = 0; i < rp.npeers; i++) {
+			rpeer = &rp.peers[i];
+			if (!peer_established(rpeer->peer)) {
+				replay_fail("%s: session went down",
+					    rpeer->host);
+				return;
+			}
+			if (rpeer->sent < rpeer->src->len
+			    || atomic_load_explicit(&rpeer->peer->update_in,
+						    memory_order_relaxed)
+				       < rpeer->src->count)
+				break;
+		}
+		if (i < rp.npeers)
+			break;
+
+		rp.t_rx = now;
+		rp.phase = PHASE_BESTPATH;
+		/* FALLTHROUGH */
+
+	case PHASE_BESTPATH:
+		if (!work_queue_empty(rp.bgp->process_queue))
+			break;
+
+		rp.t_best = now;
+		rp.phase = PHASE_UPDATES;
+		/* FALLTHROUGH */
+
+	case PHASE_UPDATES:
+		since = timercmp(&rp.t_last_out, &rp.t_best, >) ? &rp.t_last_out
+								: &rp.t_best;
+		if (!replay_output_idle()
+		    || tv_sec(since, &now) * 1000 < rp.quiet_msec)
+			break;
+
+		rp.t_out = *since;
+		rp.phase = PHASE_DONE;
+		replay_report();
+		return;
+
+	case PHASE_DONE:
+		return;
+	}
+
+	event_add_timer_msec(master, replay_tick, NULL, REPLAY_TICK_MSEC,
+			     &rp.t_tick);
+}
+
+static int replay_config(void)
+{
+	char path[] = "/tmp/test_mrt_replay.XXXXXX";
+	unsigned int i, g;
+	bool ok;
+	FILE *fp;
+	int fd;
+
+	fd = mkstemp(path);
+	if (fd < 0 || !(fp = fdopen(fd, "w")))
+		return -1;
+
+	fprintf(fp, "router bgp %u\n", rp.asn);
+	fprintf(fp, " bgp router-id 10.255.255.254\n");
+	fprintf(fp, " no bgp ebgp-requires-policy\n");
+	fprintf(fp, " no bgp default ipv4-unicast\n");
+	for (g = 0; g < rp.ngroups; g++) {
+		fprintf(fp, " neighbor PG%u peer-group\n", g);
+		fprintf(fp, " neighbor PG%u remote-as external\n", g);
+		fprintf(fp, " neighbor PG%u passive\n", g);
+		fprintf(fp, " no neighbor PG%u enforce-first-as\n", g);
+	}
+	for (i = 0; i < rp.npeers; i++)
+		fprintf(fp, " neighbor %s peer-group PG%u\n", rp.peers[i].host,
+			i % rp.ngroups);
+	fprintf(fp, " address-family ipv4 unicast\n");
+	for (g = 0; g < rp.ngroups; g++)
+		fprintf(fp, "  neighbor PG%u activate\n", g);
+	fprintf(fp, " exit-address-family\n");
+	fprintf(fp, " address-family ipv6 unicast\n");
+	for (g = 0; g < rp.ngroups; g++)
+		fprintf(fp, "  neighbor PG%u activate\n", g);
+	fprintf(fp, " exit-address-family\n");
+	fclose(fp);
+
+	ok = vty_read_config(NULL, path, NULL);
+	unlink(path);
+	if (!ok)
+		return -1;
+
+	if (rp.config && !vty_read_config(NULL, rp.config, NULL))
+		return -1;
+	return 0;
+}
+
+/* bgpd listens on 127.0.0.1, on a port that was free a moment ago */
+static int replay_port(void)
+{
+	struct sockaddr_in sin = {};
+	socklen_t len = sizeof(sin);
+	int fd;
+
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (fd < 0)
+		return -1;
+	sin.sin_family = AF_INET;
+	sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(fd, (struct sockaddr *)&sin, sizeof(sin)) < 0
+	    || getsockname(fd, (struct sockaddr *)&sin, &len) < 0) {
+		close(fd);
+		return -1;
+	}
+	close(fd);
+	return ntohs(sin.sin_port);
+}
+
+static void bgp_startup(void)
+{
+	struct list *addresses = list_new();
+
+	cmd_init(1);
+	zlog_aux_init("NONE: ", LOG_WARNING);
+	zprivs_preinit(&bgpd_privs);
+	zprivs_init(&bgpd_privs);
+
+	master = event_master_create(NULL);
+	nb_init(master, replay_yang_modules, array_size(replay_yang_modules),
+		false);
+	listnode_add(addresses, XSTRDUP(MTYPE_TMP, "127.0.0.1"));
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, addresses);
+	bm->port = rp.port;
+	vrf_init(NULL, NULL, NULL, NULL);
+	frr_pthread_init();
+	bgp_init(0);
+	bgp_pthreads_run();
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [-p peers] [-g peer-groups] [-c config] [-a asn]\n"
+		"       [-q quiet-msec] file.mrt...\n"
+		"\n"
+		"  -p  synthetic peers, each replays source (n %% sources)\n"
+		"      of the files, default one per source\n"
+		"  -g  spread the peers over this many peer-groups (and so\n"
+		"      update-groups), default 1\n"
+		"  -c  extra configuration read after the generated one\n"
+		"  -a  local AS, default %u\n"
+		"  -q  silence towards the peers that ends update generation,\n"
+		"      default %u ms\n",
+		prog, REPLAY_LOCAL_AS, REPLAY_QUIET_MSEC);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	struct replay_peer *rpeer;
+	struct event thread;
+	unsigned int i;
+	int opt, port;
+
+	while ((opt = getopt(argc, argv, "p:g:c:a:q:h")) != -1) {
+		switch (opt) {
+		case 'p':
+			rp.npeers = strtoul(optarg, NULL, 10);
+			break;
+		case 'g':
+			rp.ngroups = strtoul(optarg, NULL, 10);
+			break;
+		case 'c':
+			rp.config = optarg;
+			break;
+		case 'a':
+			rp.asn = strtoul(optarg, NULL, 10);
+			break;
+		case 'q':
+			rp.quiet_msec = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind >= argc || !rp.ngroups || rp.npeers > 65535)
+		usage(argv[0]);
+
+	for (; optind < argc; optind++)
+		if (mrt_load(argv[optind]) < 0)
+			return 1;
+
+	/* only sources with something to replay */
+	for (i = 0; i < rp.nsources;) {
+		if (rp.sources[i]->count) {
+			i++;
+			continue;
+		}
+		XFREE(MTYPE_TMP, rp.sources[i]);
+		rp.sources[i] = rp.sources[--rp.nsources];
+	}
+	if (!rp.nsources) {
+		fprintf(stderr, "no updates to replay\n");
+		return 1;
+	}
+	if (!rp.npeers)
+		rp.npeers = MIN(rp.nsources, 65535U);
+
+	port = replay_port();
+	if (port < 0) {
+		fprintf(stderr, "no port: %s\n", safe_strerror(errno));
+		return 1;
+	}
+	rp.port = port;
+
+	rp.peers = XCALLOC(MTYPE_TMP, rp.npeers * sizeof(*rp.peers));
+	for (i = 0; i < rp.npeers; i++) {
+		rpeer = &rp.peers[i];
+		rpeer->idx = i + 1;
+		rpeer->src = rp.sources[i % rp.nsources];
+		rpeer->su.sin.sin_family = AF_INET;
+		rpeer->su.sin.sin_addr.s_addr =
+			htonl(0x7f010000 + rpeer->idx);
+		inet_ntop(AF_INET, &rpeer->su.sin.sin_addr, rpeer->host,
+			  sizeof(rpeer->host));
+	}
+
+	bgp_startup();
+	if (replay_config() < 0) {
+		fprintf(stderr, "configuration failed\n");
+		return 1;
+	}
+
+	rp.bgp = bgp_get_default();
+	if (!rp.bgp) {
+		fprintf(stderr, "no BGP instance\n");
+		return 1;
+	}
+
+	for (i = 0; i < rp.npeers; i++) {
+		rpeer = &rp.peers[i];
+		rpeer->peer = peer_lookup(rp.bgp, &rpeer->su);
+		if (!rpeer->peer || peer_connect(rpeer) < 0) {
+			fprintf(stderr, "%s: can't set up peer: %s\n",
+				rpeer->host, safe_strerror(errno));
+			return 1;
+		}
+	}
+
+	monotime(&rp.t_init);
+	event_add_timer_msec(master, replay_tick, NULL, REPLAY_TICK_MSEC,
+			     &rp.t_tick);
+
+	while (rp.phase != PHASE_DONE && event_fetch(master, &thread))
+		event_call(&thread);
+
+	return rp.failed ? 1 : 0;
+}
@@ -12,6 +12,7 @@
 #include "frrevent.h"
 
 #include "isisd/isis_circuit.h"
+#include "isisd/isis_mt.h"
 #include "isisd/isis_tlvs.h"
 
 #include "test_common.h"
@@ -71,6 +72,71 @@ static char *sortlines(char *in)
 	return rv;
 }
 
+struct raw_reach_cursor {
+	struct isis_item *oldstyle;
+	struct isis_item *extended;
+};
+
+static int check_raw_reach_cb(const uint8_t *id, uint32_t metric,
+			      bool oldmetric, const uint8_t *subtlvs,
+			      uint8_t subtlvs_len, void *arg)
+{
+	struct raw_reach_cursor *c = arg;
+
+	if (oldmetric) {
+		struct isis_oldstyle_reach *r =
+			(struct isis_oldstyle_reach *)c->oldstyle;
+
+		assert(r);
+		assert(!memcmp(r->id, id, sizeof(r->id)));
+		assert(r->metric == metric);
+		c->oldstyle = c->oldstyle->next;
+	} else {
+		struct isis_extended_reach *r =
+			(struct isis_extended_reach *)c->extended;
+
+		assert(r);
+		assert(!memcmp(r->id, id, sizeof(r->id)));
+		assert(r->metric == metric);
+		c->extended = c->extended->next;
+	}
+
+	return 0;
+}
+
+/* The zero-copy IS reach iteration has to agree with the decoded TLVs */
+static void check_raw_reach(struct isis_tlvs *tlvs, const uint8_t *buf,
+			    size_t len)
+{
+	struct raw_reach_cursor c = {
+		.oldstyle = tlvs->oldstyle_reach.head,
+		.extended = tlvs->extended_reach.head,
+	};
+	struct isis_item_list *items;
+
+	isis_tlvs_iterate_is_reach_raw(buf, len, ISIS_MT_IPV4_UNICAST,
+				       check_raw_reach_cb, &c);
+	assert(!c.oldstyle && !c.extended);
+
+	for (size_t pos = 0; pos + 4 <= len; pos += 2 + buf[pos + 1]) {
+		uint16_t mtid;
+
+		if (buf[pos] != ISIS_TLV_MT_REACH || buf[pos + 1] < 2)
+			continue;
+
+		mtid = ((buf[pos + 2] << 8) | buf[pos + 3]) & ISIS_MT_MASK;
+		if (mtid == ISIS_MT_IPV4_UNICAST)
+			continue;
+
+		items = isis_lookup_mt_items(&tlvs->mt_reach, mtid);
+		c.oldstyle = NULL;
+		c.extended = items ? items->head : NULL;
+		isis_tlvs_iterate_is_reach_raw(buf, len, mtid,
+					       check_raw_reach_cb, &c);
+		assert(!c.extended);
+	}
+}
+
 static int test(FILE *input, FILE *output)
 {
 	struct stream *s = stream_new(TEST_STREAM_SIZE);
@@ -110,6 +176,7 @@ static int test(FILE *input, FILE *output)
 	fprintf(output, "Unpack log:\n%s", log);
 	const char *s_tlvs = isis_format_tlvs(tlvs, NULL);
 	fprintf(output, "Unpacked TLVs:\n%s", s_tlvs);
+	check_raw_reach(tlvs, STREAM_DATA(s), stream_get_endp(s));
 
 	struct isis_item *orig_auth = tlvs->isis_auth.head;
 	tlvs->isis_auth.head = NULL;
@@ -35,6 +35,18 @@ function fact(n)
   }
 end
 
+function prefix_view(p)
+  -- const prefixes are passed as views, reading fields must still work
+  local ok = 0
+  if p.network == "10.0.0.0/8" then
+    ok = 1
+  end
+  return {
+    length = p.length,
+    ok = ok,
+  }
+end
+
 -- Negative testing
 
 function bad_return1()
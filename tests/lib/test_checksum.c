@@ -8,6 +8,7 @@
 #include <time.h>
 
 #include "checksum.h"
+#include "monotime.h"
 #include "network.h"
 #include "prng.h"
 
@@ -446,6 +447,48 @@ static int /* return checksum in low-order 16 bits */
 }
 
 
+/* typical PDU sizes: small LSA, MTU sized LSP or packet, large LSA */
+static const size_t bench_lens[] = { 64, 1492, 8192 };
+#define BENCH_BYTES (256 * 1024 * 1024)
+
+static double bench_mbps(struct timeval *start, struct timeval *stop)
+{
+	double sec = (stop->tv_sec - start->tv_sec)
+		     + (stop->tv_usec - start->tv_usec) / 1e6;
+
+	return sec > 0 ? BENCH_BYTES / sec / 1e6 : 0.0;
+}
+
+static void bench(struct prng *prng, bool accel)
+{
+	const char *impl = checksum_impl_select(accel);
+	struct timeval t0, t1, t2;
+	unsigned long sink = 0;
+	uint8_t buffer[8192 + sizeof(uint16_t)];
+	size_t i, r, len, rounds;
+
+	for (i = 0; i < sizeof(buffer); i++)
+		buffer[i] = prng_rand(prng);
+
+	for (i = 0; i < array_size(bench_lens); i++) {
+		len = bench_lens[i];
+		rounds = BENCH_BYTES / len;
+
+		monotime(&t0);
+		for (r = 0; r < rounds; r++)
+			sink += in_cksum(buffer, len);
+		monotime(&t1);
+		for (r = 0; r < rounds; r++)
+			sink += fletcher_checksum(buffer,
+						  len + sizeof(uint16_t), len);
+		monotime(&t2);
+
+		printf("%-8s %5zu bytes  in_cksum %8.1f MB/s  fletcher %8.1f MB/s (%lu)\n",
+		       impl, len, bench_mbps(&t0, &t1), bench_mbps(&t1, &t2),
+		       sink & 1);
+	}
+}
+
 int main(int argc, char **argv)
 {
 /* 60017 65629 702179 */
@@ -455,6 +498,10 @@ int main(int argc, char **argv)
 	int exercise = 0;
 #define EXERCISESTEP 257
 	struct prng *prng = prng_new(0);
+	bool accel = false;
+
+	bench(prng, false);
+	bench(prng, true);
 
 	while (1) {
 		uint16_t ospfd, isisd, lib, in_csum, in_csum_res, in_csum_rfc;
@@ -463,6 +510,10 @@ int main(int argc, char **argv)
 		exercise += EXERCISESTEP;
 		exercise %= MAXDATALEN;
 
+		/* alternate between the portable and the accelerated code */
+		accel = !accel;
+		checksum_impl_select(accel);
+
 		printf("\rexercising length %d\033[K", exercise);
 
 		for (i = 0; i < exercise; i++)
@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test program which measures how long it takes to load a large generated
+ * configuration file through vty_read_config(), i.e. mostly the time spent
+ * in the command matcher.
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+
+#include "command.h"
+#include "frrevent.h"
+#include "memory.h"
+#include "northbound.h"
+#include "prng.h"
+#include "vty.h"
+
+/* number of commands installed, each under its own keyword */
+#define COMMANDS	200
+#define CONFIG_LINES	500000
+
+static unsigned long executed;
+
+static unsigned long elapsed_msec(struct timeval *a, struct timeval *b)
+{
+	return 1000 * (b->tv_sec - a->tv_sec)
+	       + (b->tv_usec - a->tv_usec) / 1000;
+}
+
+static int bench_cmd_func(const struct cmd_element *self, struct vty *vty,
+			  int argc, struct cmd_token *argv[])
+{
+	executed++;
+	return CMD_SUCCESS;
+}
+
+/*
+ * Install COMMANDS commands shaped like a typical daemon's configuration
+ * commands, so the matcher has a wide keyword fan-out to dispatch on at the
+ * top of CONFIG_NODE.
+ */
+static void install_commands(void)
+{
+	struct cmd_element *cmd;
+	char buf[256];
+	int i;
+
+	for (i = 0; i < COMMANDS; i++) {
+		cmd = XCALLOC(MTYPE_TMP, sizeof(*cmd));
+
+		snprintf(buf, sizeof(buf),
+			 "bench%d WORD$name [seq (1-4294967295)] <permit|deny> <A.B.C.D/M|X:X::X:X/M|any> [le (0-128)]",
+			 i);
+		cmd->string = XSTRDUP(MTYPE_TMP, buf);
+		cmd->doc = "Benchmark command\n"
+			   "Name\n"
+			   "Sequence number\n"
+			   "Sequence number\n"
+			   "Permit\n"
+			   "Deny\n"
+			   "IPv4 prefix\n"
+			   "IPv6 prefix\n"
+			   "Any prefix\n"
+			   "Maximum prefix length\n"
+			   "Maximum prefix length\n";
+		cmd->func = bench_cmd_func;
+		cmd->name = "bench";
+		/* built at runtime, so no xref for install_element() */
+		_install_element(CONFIG_NODE, cmd);
+	}
+}
+
+static void write_config(FILE *fp, struct prng *prng)
+{
+	unsigned int r;
+	int i;
+
+	for (i = 0; i < CONFIG_LINES; i++) {
+		r = prng_rand(prng);
+
+		fprintf(fp, "bench%u L%u seq %d %s ", r % COMMANDS,
+			(r >> 8) % 1000, i + 1, (r & 0x10000) ? "deny" : "permit");
+		if (r & 0x20000)
+			fprintf(fp, "2001:db8:%x::/48\n", (r >> 4) & 0xffff);
+		else
+			fprintf(fp, "10.%u.%u.0/24 le 32\n", (r >> 4) & 0xff,
+				(r >> 12) & 0xff);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	char path[] = "/tmp/test_cli_performance.XXXXXX";
+	struct event_loop *master;
+	struct timeval tv_start, tv_stop;
+	struct prng *prng;
+	FILE *fp;
+	int fd;
+
+	master = event_master_create(NULL);
+	cmd_init(1);
+	vty_init(master, false);
+	nb_init(master, NULL, 0, false);
+	install_commands();
+
+	fd = mkstemp(path);
+	assert(fd >= 0);
+	fp = fdopen(fd, "w");
+	assert(fp);
+
+	prng = prng_new(0);
+	write_config(fp, prng);
+	prng_free(prng);
+	fclose(fp);
+
+	monotime(&tv_start);
+	assert(vty_read_config(NULL, path, NULL));
+	monotime(&tv_stop);
+
+	unlink(path);
+
+	printf("%d lines, %d commands: %lu executed in %lums\n", CONFIG_LINES,
+	       COMMANDS, executed, elapsed_msec(&tv_start, &tv_stop));
+	assert(executed == CONFIG_LINES);
+
+	return 0;
+}
@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test cross-pthread event channels: several producers sending to one
+ * consumer event loop, with and without a limit on the channel.
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "memory.h"
+#include "frrevent.h"
+#include "event_channel.h"
+
+#define PRODUCERS    4
+#define MSGS_PER_PRODUCER 50000
+#define LIMIT	     64
+
+struct test_msg {
+	struct event_channel_msg cmsg;
+	unsigned int producer;
+	unsigned int seq;
+};
+
+struct producer {
+	pthread_t pt;
+	unsigned int index;
+	struct event_channel *chan;
+	struct test_msg *msgs;
+	unsigned int retries;
+};
+
+static struct event_loop *master;
+static struct producer producers[PRODUCERS];
+
+static unsigned int next_seq[PRODUCERS];
+static unsigned int received;
+static unsigned int resumed;
+static bool done;
+
+static void *producer_run(void *arg)
+{
+	struct producer *p = arg;
+	unsigned int i;
+
+	for (i = 0; i < MSGS_PER_PRODUCER; i++) {
+		p->msgs[i].producer = p->index;
+		p->msgs[i].seq = i;
+
+		while (!event_channel_send(p->chan, &p->msgs[i].cmsg)) {
+			p->retries++;
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void consumer_recv(struct event_channel *chan, void *arg)
+{
+	struct event_channel_msg *batch[16];
+	struct test_msg *msg;
+	size_t i, n;
+
+	while ((n = event_channel_recv_batch(chan, batch, array_size(batch)))) {
+		for (i = 0; i < n; i++) {
+			msg = container_of(batch[i], struct test_msg, cmsg);
+
+			assert(msg->producer < PRODUCERS);
+			/* messages from one producer arrive in order */
+			assert(msg->seq == next_seq[msg->producer]);
+			next_seq[msg->producer]++;
+			received++;
+		}
+	}
+
+	if (received == PRODUCERS * MSGS_PER_PRODUCER)
+		done = true;
+}
+
+static void consumer_resume(struct event_channel *chan, void *arg)
+{
+	resumed++;
+}
+
+static const struct event_channel_ops consumer_ops = {
+	.recv = consumer_recv,
+	.resume = consumer_resume,
+};
+
+static void run_test(const char *desc, size_t limit)
+{
+	struct event_channel *chan;
+	struct event event;
+	unsigned int i, retries = 0;
+
+	printf("%s: ", desc);
+	fflush(stdout);
+
+	memset(next_seq, 0, sizeof(next_seq));
+	received = 0;
+	resumed = 0;
+	done = false;
+
+	chan = event_channel_new(desc, master, limit, &consumer_ops, NULL);
+
+	for (i = 0; i < PRODUCERS; i++) {
+		producers[i].index = i;
+		producers[i].chan = chan;
+		producers[i].retries = 0;
+		producers[i].msgs = XCALLOC(MTYPE_TMP,
+					    MSGS_PER_PRODUCER *
+						    sizeof(struct test_msg));
+		pthread_create(&producers[i].pt, NULL, producer_run,
+			       &producers[i]);
+	}
+
+	while (!done && event_fetch(master, &event))
+		event_call(&event);
+
+	for (i = 0; i < PRODUCERS; i++) {
+		pthread_join(producers[i].pt, NULL);
+		retries += producers[i].retries;
+		XFREE(MTYPE_TMP, producers[i].msgs);
+	}
+
+	assert(event_channel_depth(chan) == 0);
+	assert(!event_channel_recv(chan));
+	for (i = 0; i < PRODUCERS; i++)
+		assert(next_seq[i] == MSGS_PER_PRODUCER);
+	/* a producer that got turned away always gets a resume eventually */
+	if (!limit)
+		assert(retries == 0 && resumed == 0);
+	else if (retries)
+		assert(resumed > 0);
+
+	event_channel_free(&chan, NULL);
+	assert(chan == NULL);
+
+	printf("OK\n");
+}
+
+int main(int argc, char **argv)
+{
+	master = event_master_create(NULL);
+
+	run_test("unbounded channel", 0);
+	run_test("bounded channel", LIMIT);
+
+	event_master_free(master);
+	return 0;
+}
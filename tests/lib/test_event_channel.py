@@ -0,0 +1,8 @@
+import frrtest
+
+
+class TestEventChannel(frrtest.TestMultiOut):
+    program = "./test_event_channel"
+
+
+TestEventChannel.exit_cleanly()
@@ -59,6 +59,31 @@ int main(int argc, char **argv)
 
 	XFREE(MTYPE_SCRIPT_RES, ansptr);
 
+	/* const prefix, passed as a view */
+	struct prefix p;
+	const struct prefix *cp = &p;
+
+	(void)str2prefix("10.0.0.0/8", &p);
+	result = frrscript_load(fs, "prefix_view", NULL);
+	assert(result == 0);
+	for (int i = 0; i < 3; i++) {
+		result = frrscript_call(fs, "prefix_view", ("p", cp));
+		assert(result == 0);
+	}
+	long long *lenptr = frrscript_get_result(fs, "prefix_view", "length",
+						 lua_tointegerp);
+	assert(*lenptr == 8);
+	XFREE(MTYPE_SCRIPT_RES, lenptr);
+	long long *okptr =
+		frrscript_get_result(fs, "prefix_view", "ok", lua_tointegerp);
+	assert(*okptr == 1);
+	XFREE(MTYPE_SCRIPT_RES, okptr);
+
+	struct lua_function_state lookup = {.name = "prefix_view"};
+	struct lua_function_state *lfs =
+		hash_lookup(fs->lua_function_hash, &lookup);
+	assert(lfs->calls == 3 && lfs->errors == 0);
+
 	/* Negative testing */
 
 	/* Function does not exist in script file*/
@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test program which compares the chained and the open addressing variants
+ * of lib/hash.c with each other and with the typesafe HASH container, and
+ * checks that both lib/hash.c variants behave the same.
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+
+#include "hash.h"
+#include "jhash.h"
+#include "memory.h"
+#include "monotime.h"
+#include "typesafe.h"
+
+#define ITEMS	1000000
+
+PREDECL_HASH(ithash);
+
+struct item {
+	struct ithash_item titem;
+	uint32_t val;
+	bool visited;
+};
+
+static struct item *items;
+/* lookups in random order, and values that aren't in the table */
+static struct item *probes;
+static struct item *misses;
+
+static uint32_t item_hash(const struct item *item)
+{
+	return jhash_1word(item->val, 0xcafe);
+}
+
+static int item_cmp(const struct item *a, const struct item *b)
+{
+	return numcmp(a->val, b->val);
+}
+
+DECLARE_HASH(ithash, struct item, titem, item_cmp, item_hash);
+
+static unsigned int item_hash_key(const void *arg)
+{
+	return item_hash(arg);
+}
+
+static bool item_hash_cmp(const void *a, const void *b)
+{
+	return !item_cmp(a, b);
+}
+
+static unsigned long elapsed_msec(struct timeval *a, struct timeval *b)
+{
+	return 1000 * (b->tv_sec - a->tv_sec)
+	       + (b->tv_usec - a->tv_usec) / 1000;
+}
+
+static void visit(struct hash_bucket *hb, void *arg)
+{
+	struct item *item = hb->data;
+	unsigned long *count = arg;
+
+	assert(!item->visited);
+	item->visited = true;
+	(*count)++;
+}
+
+/* delete every other item from within the walk, which has to be safe */
+static void visit_release(struct hash_bucket *hb, void *arg)
+{
+	struct item *item = hb->data;
+	struct hash *hash = arg;
+
+	if (item->val & 1)
+		assert(hash_release(hash, item) == item);
+}
+
+static void check_hash(struct hash *hash)
+{
+	unsigned long count = 0;
+	unsigned int i;
+
+	for (i = 0; i < ITEMS; i++)
+		items[i].visited = false;
+	hash_iterate(hash, visit, &count);
+	assert(count == ITEMS);
+	for (i = 0; i < ITEMS; i++)
+		assert(items[i].visited);
+
+	for (i = 0; i < ITEMS; i++)
+		assert(hash_lookup(hash, &misses[i]) == NULL);
+
+	hash_iterate(hash, visit_release, hash);
+	assert(hashcount(hash) == ITEMS / 2);
+	for (i = 0; i < ITEMS; i++)
+		assert(hash_lookup(hash, &items[i]) ==
+		       ((items[i].val & 1) ? NULL : &items[i]));
+
+	/* fill it up again, reusing the deleted slots */
+	for (i = 0; i < ITEMS; i++)
+		assert(hash_get(hash, &items[i], hash_alloc_intern) ==
+		       &items[i]);
+	assert(hashcount(hash) == ITEMS);
+}
+
+static void run_hash(const char *desc, unsigned int flags)
+{
+	struct timeval t0, t1, t2, t3, t4, t5;
+	struct hash *hash;
+	unsigned int i;
+	void *found;
+
+	hash = hash_create_flags(HASH_INITIAL_SIZE, item_hash_key,
+				 item_hash_cmp, NULL, flags);
+
+	monotime(&t0);
+	for (i = 0; i < ITEMS; i++)
+		hash_get(hash, &items[i], hash_alloc_intern);
+	monotime(&t1);
+	for (i = 0; i < ITEMS; i++) {
+		found = hash_lookup(hash, &probes[i]);
+		assert(found && ((struct item *)found)->val == probes[i].val);
+	}
+	monotime(&t2);
+	for (i = 0; i < ITEMS; i++)
+		assert(!hash_lookup(hash, &misses[i]));
+	monotime(&t3);
+
+	check_hash(hash);
+
+	monotime(&t4);
+	for (i = 0; i < ITEMS; i++)
+		hash_release(hash, &items[i]);
+	monotime(&t5);
+	assert(hashcount(hash) == 0);
+
+	printf("%-20s insert %5lums  hit %5lums  miss %5lums  delete %5lums\n",
+	       desc, elapsed_msec(&t0, &t1), elapsed_msec(&t1, &t2),
+	       elapsed_msec(&t2, &t3), elapsed_msec(&t4, &t5));
+
+	hash_free(hash);
+}
+
+static void run_typesafe(void)
+{
+	struct timeval t0, t1, t2, t3, t4;
+	struct ithash_head head;
+	struct item *found;
+	unsigned int i;
+
+	ithash_init(&head);
+
+	monotime(&t0);
+	for (i = 0; i < ITEMS; i++)
+		ithash_add(&head, &items[i]);
+	monotime(&t1);
+	for (i = 0; i < ITEMS; i++) {
+		found = ithash_find(&head, &probes[i]);
+		assert(found && found->val == probes[i].val);
+	}
+	monotime(&t2);
+	for (i = 0; i < ITEMS; i++)
+		assert(!ithash_find(&head, &misses[i]));
+	monotime(&t3);
+	for (i = 0; i < ITEMS; i++)
+		ithash_del(&head, &items[i]);
+	monotime(&t4);
+	assert(ithash_count(&head) == 0);
+
+	printf("%-20s insert %5lums  hit %5lums  miss %5lums  delete %5lums\n",
+	       "typesafe HASH", elapsed_msec(&t0, &t1), elapsed_msec(&t1, &t2),
+	       elapsed_msec(&t2, &t3), elapsed_msec(&t3, &t4));
+
+	ithash_fini(&head);
+}
+
+int main(int argc, char **argv)
+{
+	unsigned int i, j;
+	struct item tmp;
+
+	items = XCALLOC(MTYPE_TMP, ITEMS * sizeof(*items));
+	probes = XCALLOC(MTYPE_TMP, ITEMS * sizeof(*probes));
+	misses = XCALLOC(MTYPE_TMP, ITEMS * sizeof(*misses));
+
+	/* even and odd values alike, misses are out of range */
+	for (i = 0; i < ITEMS; i++) {
+		items[i].val = i * 7;
+		probes[i].val = i * 7;
+		misses[i].val = ITEMS * 7 + i;
+	}
+	srandom(1);
+	for (i = ITEMS - 1; i > 0; i--) {
+		j = random() % (i + 1);
+		tmp = probes[i];
+		probes[i] = probes[j];
+		probes[j] = tmp;
+	}
+
+	run_hash("chained hash", 0);
+	run_hash("open addressing hash", HASH_OPEN_ADDRESSING);
+	run_typesafe();
+
+	XFREE(MTYPE_TMP, items);
+	XFREE(MTYPE_TMP, probes);
+	XFREE(MTYPE_TMP, misses);
+	return 0;
+}
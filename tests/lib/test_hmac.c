@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test HMAC with precomputed key state against the RFC 2202 and RFC 4231
+ * vectors, and reuse/rebuild of cached states.
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "hmac.h"
+
+struct vector {
+	enum keychain_hash_algo algo;
+	const char *key;
+	size_t keylen;
+	const char *data;
+	const char *digest;
+};
+
+static const char key_0b[20] = {
+	0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+	0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+};
+
+static char key_aa[131];
+
+static const struct vector vectors[] = {
+	/* RFC 2202 2. */
+	{ KEYCHAIN_ALGO_MD5, key_0b, 16, "Hi There",
+	  "9294727a3638bb1c13f48ef8158bfc9d" },
+	{ KEYCHAIN_ALGO_MD5, "Jefe", 4, "what do ya want for nothing?",
+	  "750c783e6ab0b503eaa86e310a5db738" },
+	/* 80 byte key, hashed first */
+	{ KEYCHAIN_ALGO_MD5, key_aa, 80,
+	  "Test Using Larger Than Block-Size Key - Hash Key First",
+	  "6b1ab7fe4bd7bf8f0b62e6ce61b9d0cd" },
+	/* RFC 4231 4.2., 4.3., 4.7. */
+	{ KEYCHAIN_ALGO_HMAC_SHA256, key_0b, 20, "Hi There",
+	  "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7" },
+	{ KEYCHAIN_ALGO_HMAC_SHA256, "Jefe", 4, "what do ya want for nothing?",
+	  "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843" },
+	{ KEYCHAIN_ALGO_HMAC_SHA256, key_aa, 131,
+	  "Test Using Larger Than Block-Size Key - Hash Key First",
+	  "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54" },
+#ifdef CRYPTO_OPENSSL
+	/* RFC 2202 3., RFC 4231 4.3. */
+	{ KEYCHAIN_ALGO_HMAC_SHA1, "Jefe", 4, "what do ya want for nothing?",
+	  "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79" },
+	{ KEYCHAIN_ALGO_HMAC_SHA384, "Jefe", 4, "what do ya want for nothing?",
+	  "af45d2e376484031617f78d2b58a6b1b9c7ef464f5a01b47e42ec3736322445e"
+	  "8e2240ca5e69e2c78b3239ecfab21649" },
+	{ KEYCHAIN_ALGO_HMAC_SHA512, "Jefe", 4, "what do ya want for nothing?",
+	  "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+	  "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737" },
+#endif
+};
+
+static void hex(const uint8_t *buf, size_t len, char *out)
+{
+	for (size_t i = 0; i < len; i++)
+		snprintf(out + 2 * i, 3, "%02x", buf[i]);
+}
+
+static void digest_str(const struct vector *v, const struct hmac_key *hk,
+		       char *str)
+{
+	uint8_t digest[KEYCHAIN_MAX_HASH_SIZE];
+
+	hmac_digest(hk, v->data, strlen(v->data), digest);
+	hex(digest, hmac_digest_len(hk), str);
+}
+
+static int check(const struct vector *v, const struct hmac_key *hk)
+{
+	char str[2 * KEYCHAIN_MAX_HASH_SIZE + 1];
+
+	digest_str(v, hk, str);
+	if (strcmp(str, v->digest)) {
+		printf("%s key length %zu: got %s, expected %s\n",
+		       keychain_algo_str(v->algo), v->keylen, str, v->digest);
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct hmac_key *cache = NULL, *hk;
+	char str[2 * KEYCHAIN_MAX_HASH_SIZE + 1];
+	int failed = 0;
+	size_t i;
+
+	memset(key_aa, 0xaa, sizeof(key_aa));
+
+	for (i = 0; i < array_size(vectors); i++) {
+		const struct vector *v = &vectors[i];
+
+		hk = hmac_key_new(v->algo, v->key, v->keylen, 0);
+		assert(hk);
+		failed += check(v, hk);
+		/* the precomputed state must not change between messages */
+		failed += check(v, hk);
+		hmac_key_free(&hk);
+		assert(!hk);
+
+		failed += check(v, hmac_key_lookup(v->algo, v->key, v->keylen,
+						   0));
+	}
+
+	/* same parameters reuse the state, different ones rebuild it */
+	hk = hmac_key_get(&cache, KEYCHAIN_ALGO_MD5, "Jefe", 4, 0);
+	assert(hk && hk == cache);
+	assert(hmac_key_get(&cache, KEYCHAIN_ALGO_MD5, "Jefe", 4, 0) == hk);
+	failed += check(&vectors[1], cache);
+
+	hmac_key_get(&cache, KEYCHAIN_ALGO_HMAC_SHA256, "Jefe", 4, 0);
+	assert(hmac_digest_len(cache) == 32);
+	failed += check(&vectors[4], cache);
+
+	/* a pad length other than the block size gives a different digest */
+	hmac_key_get(&cache, KEYCHAIN_ALGO_HMAC_SHA256, "Jefe", 4, 32);
+	digest_str(&vectors[4], cache, str);
+	assert(strcmp(str, vectors[4].digest));
+	hmac_key_free(&cache);
+
+	assert(!hmac_key_new(KEYCHAIN_ALGO_NULL, "Jefe", 4, 0));
+
+	if (failed) {
+		printf("%d digests wrong\n", failed);
+		return 1;
+	}
+	printf("all %zu vectors ok\n", array_size(vectors));
+	return 0;
+}
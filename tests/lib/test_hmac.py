@@ -0,0 +1,8 @@
+import frrtest
+
+
+class TestHmac(frrtest.TestMultiOut):
+    program = "./test_hmac"
+
+
+TestHmac.exit_cleanly()
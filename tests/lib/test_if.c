@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Interface lookup index tests.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+#include <zebra.h>
+
+#include "if.h"
+#include "prefix.h"
+#include "vrf.h"
+
+static struct interface *new_if(const char *name, ifindex_t ifindex,
+				vrf_id_t vrf_id, const char *vrf_name)
+{
+	struct interface *ifp = if_get_by_name(name, vrf_id, vrf_name);
+
+	assert(ifp);
+	assert(if_set_index(ifp, ifindex) == 0);
+	return ifp;
+}
+
+static void test_lookups(void)
+{
+	struct interface *eth0, *eth1;
+
+	eth0 = new_if("eth0", 5, 10, "red");
+	eth1 = new_if("eth1", 6, 11, "blue");
+
+	/* VRF-lite: ifindexes and names are looked up across all VRFs */
+	assert(if_lookup_by_index(5, VRF_DEFAULT) == eth0);
+	assert(if_lookup_by_index(6, 10) == eth1);
+	assert(if_lookup_by_index(7, VRF_DEFAULT) == NULL);
+	assert(if_get_by_name("eth1", VRF_UNKNOWN, NULL) == eth1);
+	assert(eth1->vrf->vrf_id == 11);
+
+	/* the kernel says eth0 is in the default VRF now */
+	assert(if_get_by_name("eth0", VRF_DEFAULT, NULL) == eth0);
+	assert(eth0->vrf->vrf_id == VRF_DEFAULT);
+	assert(if_lookup_by_name("eth0", VRF_DEFAULT) == eth0);
+	assert(if_lookup_by_name("eth0", 10) == NULL);
+	assert(if_lookup_by_index(5, 11) == eth0);
+
+	assert(if_set_index(eth0, 8) == 0);
+	assert(if_lookup_by_index(5, VRF_DEFAULT) == NULL);
+	assert(if_lookup_by_index(8, VRF_DEFAULT) == eth0);
+
+	if_delete(&eth0);
+	assert(if_lookup_by_index(8, VRF_DEFAULT) == NULL);
+	assert(if_lookup_by_name("eth0", VRF_DEFAULT) == NULL);
+	assert(if_lookup_by_index(6, VRF_DEFAULT) == eth1);
+
+	if_delete(&eth1);
+	assert(if_lookup_by_index(6, VRF_DEFAULT) == NULL);
+}
+
+static void test_shadowed(void)
+{
+	struct interface *red, *blue;
+
+	/* with the netns backend, names and ifindexes repeat across VRFs */
+	vrf_configure_backend(VRF_BACKEND_NETNS);
+	red = new_if("eth9", 20, 10, "red");
+	blue = new_if("eth9", 20, 11, "blue");
+	assert(red != blue);
+	assert(if_lookup_by_index(20, 10) == red);
+	assert(if_lookup_by_index(20, 11) == blue);
+	vrf_configure_backend(VRF_BACKEND_VRF_LITE);
+
+	/* the first one is indexed, the other has to take over from it */
+	assert(if_lookup_by_index(20, VRF_DEFAULT) == red);
+	assert(if_get_by_name("eth9", VRF_UNKNOWN, NULL) == red);
+	if_delete(&red);
+	assert(if_lookup_by_index(20, VRF_DEFAULT) == blue);
+	assert(if_get_by_name("eth9", VRF_UNKNOWN, NULL) == blue);
+	if_delete(&blue);
+	assert(if_lookup_by_index(20, VRF_DEFAULT) == NULL);
+}
+
+static void test_addresses(void)
+{
+	struct interface *eth2, *eth3;
+	struct connected *ifc;
+	struct prefix p;
+	struct in_addr a;
+
+	eth2 = new_if("eth2", 30, 10, "red");
+	eth3 = new_if("eth3", 31, 11, "blue");
+
+	str2prefix("10.0.0.1/24", &p);
+	a = p.u.prefix4;
+	connected_add_by_prefix(eth2, &p, NULL);
+	str2prefix("10.0.0.1/32", &p);
+	connected_add_by_prefix(eth3, &p, NULL);
+
+	assert(if_lookup_address_local(&a, AF_INET, 10) == eth2);
+	assert(if_lookup_address_local(&a, AF_INET, 11) == eth3);
+	assert(!if_address_is_local(&a, AF_INET, VRF_DEFAULT));
+
+	/* addresses follow their interface into another VRF */
+	if_update_to_new_vrf(eth2, VRF_DEFAULT);
+	assert(if_lookup_address_local(&a, AF_INET, VRF_DEFAULT) == eth2);
+	assert(!if_address_is_local(&a, AF_INET, 10));
+
+	ifc = connected_delete_by_prefix(eth3, &p);
+	assert(ifc);
+	connected_free(&ifc);
+	assert(!if_address_is_local(&a, AF_INET, 11));
+
+	/* and go away with it */
+	if_delete(&eth2);
+	assert(!if_address_is_local(&a, AF_INET, VRF_DEFAULT));
+	if_delete(&eth3);
+}
+
+int main(int argc, char **argv)
+{
+	vrf_init(NULL, NULL, NULL, NULL);
+
+	printf("Validating interface lookups...\n");
+	test_lookups();
+	printf("Validating shadowed interfaces...\n");
+	test_shadowed();
+	printf("Validating address lookups...\n");
+	test_addresses();
+
+	vrf_terminate();
+	return 0;
+}
@@ -0,0 +1,8 @@
+import frrtest
+
+
+class TestIf(frrtest.TestMultiOut):
+    program = "./test_if"
+
+
+TestIf.exit_cleanly()
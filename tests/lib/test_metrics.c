@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * OpenMetrics rendering tests.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+#include <zebra.h>
+
+#include "frrevent.h"
+#include "memory.h"
+#include "metrics.h"
+
+static unsigned int snapshots;
+
+static void collect_plain(struct metrics_out *out, void *arg)
+{
+	metrics_family(out, "test_plain", METRICS_GAUGE, "Plain collector");
+	metrics_sample(out, "test_plain", 42, NULL);
+	metrics_sample(out, "test_plain", 7, "name", "a \"quoted\\ \nname",
+		       NULL);
+}
+
+static void collect_histogram(struct metrics_out *out, void *arg)
+{
+	size_t buckets[4] = { 1, 0, 2, 3 };
+
+	metrics_family(out, "test_hist_usec", METRICS_HISTOGRAM, NULL);
+	metrics_log2_histogram(out, "test_hist_usec", buckets, 4, "thread",
+			       "x");
+}
+
+static void collect_snapshot(struct metrics_out *out, void *arg)
+{
+	snapshots++;
+	metrics_family(out, "test_snapshot", METRICS_COUNTER, NULL);
+	metrics_sample(out, "test_snapshot_total", snapshots, NULL);
+}
+
+static char *render(void)
+{
+	size_t len;
+	char *text = metrics_render(&len);
+
+	assert(strlen(text) == len);
+	assert(len >= 6 && !strcmp(text + len - 6, "# EOF\n"));
+	return text;
+}
+
+static void run_events(struct event_loop *loop)
+{
+	struct event thread;
+
+	if (event_fetch(loop, &thread))
+		event_call(&thread);
+}
+
+int main(int argc, char **argv)
+{
+	struct event_loop *loop = event_master_create(NULL);
+	struct metrics_collector *plain, *hist, *snap;
+	char *text;
+
+	plain = metrics_collector_add("plain", collect_plain, NULL);
+	hist = metrics_collector_add("hist", collect_histogram, NULL);
+	snap = metrics_snapshot_add("snap", loop, 0, collect_snapshot, NULL);
+
+	printf("Validating plain collectors...\n");
+	text = render();
+	assert(strstr(text, "# TYPE test_plain gauge\n"
+			    "# HELP test_plain Plain collector\n"
+			    "test_plain 42\n"
+			    "test_plain{name=\"a \\\"quoted\\\\ \\nname\"} 7\n"));
+	assert(strstr(text, "test_hist_usec_bucket{thread=\"x\",le=\"2\"} 1\n"
+			    "test_hist_usec_bucket{thread=\"x\",le=\"4\"} 1\n"
+			    "test_hist_usec_bucket{thread=\"x\",le=\"8\"} 3\n"
+			    "test_hist_usec_bucket{thread=\"x\",le=\"+Inf\"} 6\n"
+			    "test_hist_usec_count{thread=\"x\"} 6\n"));
+	assert(strstr(text, "# TYPE frr_memory_allocations gauge\n"));
+
+	/* snapshots are only rendered once a scrape asks for them */
+	printf("Validating snapshots...\n");
+	assert(!strstr(text, "test_snapshot"));
+	assert(snapshots == 0);
+	metrics_text_free(text);
+
+	run_events(loop);
+	assert(snapshots == 1);
+
+	text = render();
+	assert(strstr(text, "test_snapshot_total 1\n"));
+	metrics_text_free(text);
+
+	printf("Validating removal...\n");
+	metrics_collector_del(plain);
+	metrics_collector_del(hist);
+	metrics_collector_del(snap);
+
+	text = render();
+	assert(!strstr(text, "test_plain"));
+	assert(!strstr(text, "test_hist_usec"));
+	assert(!strstr(text, "test_snapshot"));
+	metrics_text_free(text);
+
+	event_master_free(loop);
+	return 0;
+}
@@ -0,0 +1,8 @@
+import frrtest
+
+
+class TestMetrics(frrtest.TestMultiOut):
+    program = "./test_metrics"
+
+
+TestMetrics.exit_cleanly()
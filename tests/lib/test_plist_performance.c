@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test program which measures prefix-list lookup times with and without
+ * the compiled lookup trie, and checks that both give the same results.
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+
+#include "command.h"
+#include "plist.h"
+#include "prng.h"
+
+#define LIST_ENTRIES	100000
+#define LOOKUPS		1000000
+
+static unsigned long elapsed_msec(struct timeval *a, struct timeval *b)
+{
+	return 1000 * (b->tv_sec - a->tv_sec)
+	       + (b->tv_usec - a->tv_usec) / 1000;
+}
+
+static void random_prefix(struct prng *prng, struct prefix *p,
+			  unsigned int minlen, unsigned int maxlen)
+{
+	memset(p, 0, sizeof(*p));
+	p->family = AF_INET;
+	p->prefixlen = minlen + prng_rand(prng) % (maxlen - minlen + 1);
+	p->u.prefix4.s_addr = prng_rand(prng);
+	apply_mask(p);
+}
+
+static unsigned long run_lookups(struct prefix_list *plist,
+				 struct prefix *lookups,
+				 const struct prefix_list_entry **results)
+{
+	struct timeval tv_start, tv_stop;
+	int i;
+
+	monotime(&tv_start);
+	for (i = 0; i < LOOKUPS; i++)
+		prefix_list_apply_ext(plist, &results[i], &lookups[i], false);
+	monotime(&tv_stop);
+
+	return elapsed_msec(&tv_start, &tv_stop);
+}
+
+int main(int argc, char **argv)
+{
+	char name[] = "perf";
+	struct prng *prng;
+	struct orf_prefix orfp;
+	struct prefix_list *plist;
+	struct prefix *lookups;
+	const struct prefix_list_entry **plain, **compiled;
+	struct timeval tv_start, tv_stop;
+	unsigned long t_load, t_compile, t_plain, t_compiled;
+	int i, mismatches = 0;
+
+	cmd_init(1);
+	prefix_list_init();
+	prng = prng_new(0);
+
+	lookups = calloc(LOOKUPS, sizeof(*lookups));
+	plain = calloc(LOOKUPS, sizeof(*plain));
+	compiled = calloc(LOOKUPS, sizeof(*compiled));
+
+	monotime(&tv_start);
+	for (i = 0; i < LIST_ENTRIES; i++) {
+		memset(&orfp, 0, sizeof(orfp));
+		orfp.seq = 5 * (i + 1);
+		random_prefix(prng, &orfp.p, 8, 24);
+
+		switch (prng_rand(prng) % 4) {
+		case 0:
+			break;
+		case 1:
+			orfp.le = orfp.p.prefixlen
+				  + prng_rand(prng) % (33 - orfp.p.prefixlen);
+			break;
+		case 2:
+			orfp.ge = orfp.p.prefixlen
+				  + prng_rand(prng) % (33 - orfp.p.prefixlen);
+			break;
+		case 3:
+			orfp.ge = orfp.p.prefixlen;
+			orfp.le = orfp.ge + prng_rand(prng) % (33 - orfp.ge);
+			break;
+		}
+
+		prefix_bgp_orf_set(name, AFI_IP, &orfp, prng_rand(prng) & 1,
+				   1);
+	}
+	monotime(&tv_stop);
+	t_load = elapsed_msec(&tv_start, &tv_stop);
+
+	plist = prefix_bgp_orf_lookup(AFI_IP, name);
+	assert(plist);
+
+	for (i = 0; i < LOOKUPS; i++)
+		random_prefix(prng, &lookups[i], 16, 32);
+
+	prefix_list_compile_enable(false);
+	t_plain = run_lookups(plist, lookups, plain);
+
+	prefix_list_compile_enable(true);
+	monotime(&tv_start);
+	prefix_list_compile(plist);
+	monotime(&tv_stop);
+	t_compile = elapsed_msec(&tv_start, &tv_stop);
+
+	t_compiled = run_lookups(plist, lookups, compiled);
+
+	for (i = 0; i < LOOKUPS; i++)
+		if (plain[i] != compiled[i])
+			mismatches++;
+
+	printf("Loading %d random prefix-list entries took %lu.%03lu seconds.\n",
+	       LIST_ENTRIES, t_load / 1000, t_load % 1000);
+	printf("Compiling the lookup trie took %lu.%03lu seconds.\n",
+	       t_compile / 1000, t_compile % 1000);
+	printf("%d lookups took %lu.%03lu seconds (incremental trie).\n",
+	       LOOKUPS, t_plain / 1000, t_plain % 1000);
+	printf("%d lookups took %lu.%03lu seconds (compiled trie).\n",
+	       LOOKUPS, t_compiled / 1000, t_compiled % 1000);
+	printf("%d mismatching results.\n", mismatches);
+	fflush(stdout);
+
+	prefix_bgp_orf_remove_all(AFI_IP, name);
+	free(compiled);
+	free(plain);
+	free(lookups);
+	prng_free(prng);
+	return mismatches ? 1 : 0;
+}
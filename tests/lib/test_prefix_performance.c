@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test program which measures the throughput of the basic prefix primitives
+ * (prefix_match, prefix_cmp, prefix_same, apply_mask_ipv6, prefix_hash_key)
+ * and checks their IPv4/IPv6 fast paths against plain byte-by-byte versions.
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+
+#include "jhash.h"
+#include "monotime.h"
+#include "prefix.h"
+#include "prng.h"
+
+#define PREFIXES	4096
+#define ROUNDS		2000
+
+static const uint8_t maskbit[] = {0x00, 0x80, 0xc0, 0xe0, 0xf0,
+				  0xf8, 0xfc, 0xfe, 0xff};
+
+static struct prefix prefixes[PREFIXES];
+
+/* reference implementations, as the code looked before the fast paths */
+static int ref_match(const struct prefix *n, const struct prefix *p)
+{
+	int offset = n->prefixlen / 8;
+	int shift = n->prefixlen % 8;
+
+	if (n->prefixlen > p->prefixlen)
+		return 0;
+	if (shift && (maskbit[shift] & (n->u.val[offset] ^ p->u.val[offset])))
+		return 0;
+	while (offset--)
+		if (n->u.val[offset] != p->u.val[offset])
+			return 0;
+	return 1;
+}
+
+static int ref_cmp(const struct prefix *p1, const struct prefix *p2)
+{
+	int offset, shift, i;
+
+	if (p1->family != p2->family)
+		return numcmp(p1->family, p2->family);
+	if (p1->prefixlen != p2->prefixlen)
+		return numcmp(p1->prefixlen, p2->prefixlen);
+
+	offset = p1->prefixlen / 8;
+	shift = p1->prefixlen % 8;
+
+	i = memcmp(p1->u.val, p2->u.val, offset);
+	if (i)
+		return numcmp(i, 0);
+	if (shift)
+		return numcmp(p1->u.val[offset] & maskbit[shift],
+			      p2->u.val[offset] & maskbit[shift]);
+	return 0;
+}
+
+static void ref_mask_ipv6(struct prefix_ipv6 *p)
+{
+	uint8_t *pnt = (uint8_t *)&p->prefix;
+	int index = p->prefixlen / 8;
+
+	if (index < 16) {
+		pnt[index] &= maskbit[p->prefixlen % 8];
+		while (++index < 16)
+			pnt[index] = 0;
+	}
+}
+
+static unsigned int ref_hash(const struct prefix *p)
+{
+	struct prefix copy;
+
+	memset(&copy, 0, sizeof(copy));
+	prefix_copy(&copy, p);
+	return jhash(&copy, offsetof(struct prefix, u.prefix) +
+				    PSIZE(copy.prefixlen),
+		     0x55aa5a5a);
+}
+
+/*
+ * Prefixes come in clusters sharing their leading bits, so that matches and
+ * long common runs (the expensive cases for the byte loops) actually happen.
+ */
+static void make_prefixes(struct prng *prng)
+{
+	uint8_t base[16];
+	unsigned int i, j;
+	struct prefix *p;
+
+	for (i = 0; i < PREFIXES; i++) {
+		p = &prefixes[i];
+		memset(p, 0, sizeof(*p));
+
+		if (i % 16 == 0)
+			for (j = 0; j < sizeof(base); j++)
+				base[j] = prng_rand(prng);
+
+		memcpy(p->u.val, base, sizeof(base));
+		p->u.val[prng_rand(prng) % 16] ^= prng_rand(prng);
+
+		if (prng_rand(prng) & 1) {
+			p->family = AF_INET;
+			p->prefixlen = prng_rand(prng) % (IPV4_MAX_BITLEN + 1);
+			memset(p->u.val + 4, 0, sizeof(p->u.val) - 4);
+		} else {
+			p->family = AF_INET6;
+			p->prefixlen = prng_rand(prng) % (IPV6_MAX_BITLEN + 1);
+		}
+	}
+}
+
+static void check_results(void)
+{
+	struct prefix_ipv6 p6, ref6;
+	unsigned int i, j;
+	struct prefix *a, *b;
+
+	for (i = 0; i < PREFIXES; i++) {
+		a = &prefixes[i];
+
+		/* neighbours share most bits, plus a few random pairs */
+		for (j = i; j < i + 32 && j < PREFIXES; j++) {
+			b = &prefixes[j];
+
+			assert(!!prefix_match(a, b) == ref_match(a, b));
+			assert(!!prefix_match(b, a) == ref_match(b, a));
+			assert(numcmp(prefix_cmp(a, b), 0) == ref_cmp(a, b));
+			assert(numcmp(prefix_cmp(b, a), 0) == ref_cmp(b, a));
+			assert(!!prefix_same(a, b) ==
+			       (a->family == b->family &&
+				a->prefixlen == b->prefixlen &&
+				!memcmp(a->u.val, b->u.val,
+					a->family == AF_INET ? 4 : 16)));
+		}
+
+		assert(prefix_hash_key(a) == ref_hash(a));
+
+		if (a->family == AF_INET6) {
+			memcpy(&p6, a, sizeof(p6));
+			memcpy(&ref6, a, sizeof(ref6));
+			apply_mask_ipv6(&p6);
+			ref_mask_ipv6(&ref6);
+			assert(!memcmp(&p6, &ref6, sizeof(p6)));
+		}
+	}
+}
+
+static double elapsed_sec(struct timeval *a, struct timeval *b)
+{
+	return (b->tv_sec - a->tv_sec) + (b->tv_usec - a->tv_usec) / 1e6;
+}
+
+static void report(const char *name, struct timeval *start,
+		   struct timeval *stop, unsigned long ops, unsigned long sink)
+{
+	double sec = elapsed_sec(start, stop);
+
+	printf("%-16s %10lu ops %8.1f Mops/s (%lu)\n", name, ops,
+	       sec > 0 ? ops / sec / 1e6 : 0.0, sink);
+}
+
+#define BENCH(name, expr)                                                      \
+	do {                                                                   \
+		struct timeval tv_start, tv_stop;                              \
+		unsigned long sink = 0;                                        \
+		unsigned int r, i;                                             \
+                                                                               \
+		monotime(&tv_start);                                           \
+		for (r = 0; r < ROUNDS; r++)                                   \
+			for (i = 0; i < PREFIXES; i++)                         \
+				sink += (expr);                                \
+		monotime(&tv_stop);                                            \
+		report(name, &tv_start, &tv_stop,                              \
+		       (unsigned long)ROUNDS * PREFIXES, sink);                \
+	} while (0)
+
+#define NEXT(i) (&prefixes[((i) + 1) % PREFIXES])
+
+static unsigned int mask_one(unsigned int i)
+{
+	struct prefix_ipv6 p6;
+
+	memcpy(&p6, &prefixes[i], sizeof(p6));
+	p6.family = AF_INET6;
+	apply_mask_ipv6(&p6);
+	return p6.prefix.s6_addr[15];
+}
+
+int main(int argc, char **argv)
+{
+	struct prng *prng;
+
+	prng = prng_new(0);
+	make_prefixes(prng);
+	prng_free(prng);
+
+	check_results();
+	printf("fast paths match reference implementations\n");
+
+	BENCH("prefix_match", prefix_match(&prefixes[i], NEXT(i)));
+	BENCH("prefix_cmp", prefix_cmp(&prefixes[i], NEXT(i)) + 1);
+	BENCH("prefix_same", prefix_same(&prefixes[i], NEXT(i)));
+	BENCH("apply_mask_ipv6", mask_one(i));
+	BENCH("prefix_hash_key", prefix_hash_key(&prefixes[i]) & 1);
+
+	return 0;
+}
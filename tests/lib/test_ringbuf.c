@@ -152,6 +152,32 @@ int main(int argc, char **argv)
 	assert(!strcmp(chloroplast, "eetr"));
 	printf("Retrieved: '%s'\n", chloroplast);
 
+	ringbuf_wipe(soil);
+
+	/* validate direct writes across ring boundary */
+	struct iovec iov[2];
+
+	printf("Validating direct writes...\n");
+	soil->start = soil->size - 2;
+	soil->end = soil->start;
+	assert(ringbuf_space_iov(soil, iov) == 2);
+	assert(iov[0].iov_len == 2 && iov[1].iov_len == soil->size - 2);
+	memcpy(iov[0].iov_base, "le", 2);
+	memcpy(iov[1].iov_base, "af", 2);
+	ringbuf_commit(soil, 4);
+	validate_state(soil, BUFSIZ, 4);
+	char stem[5];
+	assert(ringbuf_get(soil, stem, 100) == 4);
+	stem[4] = '\0';
+	assert(!strcmp(stem, "leaf"));
+	printf("Retrieved: '%s'\n", stem);
+
+	/* fill up completely */
+	assert(ringbuf_space_iov(soil, iov) == 2);
+	ringbuf_commit(soil, iov[0].iov_len + iov[1].iov_len);
+	validate_state(soil, BUFSIZ, BUFSIZ);
+	assert(ringbuf_space_iov(soil, iov) == 0);
+
 	printf("Deleting...\n");
 	ringbuf_del(soil);
 
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 /*
- * Test srcdest table for correctness.
+ * Test srcdest table for correctness.  Run with "bench" as argument to
+ * measure insert, lookup, walk and delete throughput instead.
  *
  * Copyright (C) 2017 by David Lamparter & Christian Franke,
  *                       Open Source Routing / NetDEF Inc.
@@ -12,6 +13,7 @@
 
 #include "hash.h"
 #include "memory.h"
+#include "monotime.h"
 #include "prefix.h"
 #include "prng.h"
 #include "srcdest_table.h"
@@ -414,8 +416,125 @@ static void run_prng_test(void)
 	test_state_free(test);
 }
 
+/*
+ * Benchmark, not run by default: many destinations, a quarter of them with
+ * several source prefixes as in source-specific multihoming setups.
+ */
+#define BENCH_DSTS 100000
+#define BENCH_MAX_SRCS 4
+
+static struct prefix_ipv6 bench_dst[BENCH_DSTS];
+static struct prefix_ipv6 bench_src[BENCH_DSTS][BENCH_MAX_SRCS];
+static unsigned int bench_nsrc[BENCH_DSTS];
+
+static void bench_report(const char *name, struct timeval *start,
+			 unsigned long ops)
+{
+	int64_t usec = monotime_since(start, NULL);
+
+	printf("%-16s %9lu ops %8.1f kops/s\n", name, ops,
+	       usec > 0 ? ops * 1e3 / usec : 0.0);
+}
+
+static void bench_prefix(struct prng *prng, struct prefix_ipv6 *p,
+			 uint8_t minlen, uint8_t maxlen)
+{
+	get_rand_prefix(prng, p);
+	p->prefixlen = minlen + prng_rand(prng) % (maxlen - minlen + 1);
+	apply_mask(p);
+}
+
+static void run_bench(void)
+{
+	struct route_table *table = srcdest_table_init();
+	struct prng *prng = prng_new(0);
+	struct prefix_ipv6 miss;
+	struct timeval start;
+	struct route_node *rn;
+	unsigned long ops;
+	unsigned int i, j;
+
+	for (i = 0; i < BENCH_DSTS; i++) {
+		bench_prefix(prng, &bench_dst[i], 32, 64);
+		bench_nsrc[i] = (i % 4) ? 0 : 1 + prng_rand(prng) % BENCH_MAX_SRCS;
+		for (j = 0; j < bench_nsrc[i]; j++)
+			bench_prefix(prng, &bench_src[i][j], 32, 56);
+	}
+
+	monotime(&start);
+	for (ops = 0, i = 0; i < BENCH_DSTS; i++) {
+		rn = srcdest_rnode_get(table, &bench_dst[i], NULL);
+		rn->info = (void *)0xdeadbeef;
+		ops++;
+		for (j = 0; j < bench_nsrc[i]; j++, ops++) {
+			rn = srcdest_rnode_get(table, &bench_dst[i],
+					       &bench_src[i][j]);
+			rn->info = (void *)0xdeadbeef;
+		}
+	}
+	bench_report("get", &start, ops);
+
+	monotime(&start);
+	for (ops = 0, i = 0; i < BENCH_DSTS; i++) {
+		for (j = 0; j < bench_nsrc[i]; j++, ops++) {
+			rn = srcdest_rnode_lookup(table, &bench_dst[i],
+						  &bench_src[i][j]);
+			assert(rn && rn->info);
+			route_unlock_node(rn);
+		}
+		rn = srcdest_rnode_lookup(table, &bench_dst[i], NULL);
+		assert(rn && rn->info);
+		route_unlock_node(rn);
+		ops++;
+	}
+	bench_report("lookup", &start, ops);
+
+	monotime(&start);
+	for (ops = 0, i = 0; i < BENCH_DSTS; i++, ops++) {
+		bench_prefix(prng, &miss, 32, 56);
+		rn = srcdest_rnode_lookup(table, &bench_dst[i], &miss);
+		if (rn)
+			route_unlock_node(rn);
+	}
+	bench_report("lookup miss", &start, ops);
+
+	monotime(&start);
+	for (ops = 0, rn = route_top(table); rn; rn = srcdest_route_next(rn))
+		ops++;
+	bench_report("walk", &start, ops);
+
+	monotime(&start);
+	for (ops = 0, i = 0; i < BENCH_DSTS; i++) {
+		for (j = 0; j < bench_nsrc[i]; j++, ops++) {
+			rn = srcdest_rnode_lookup(table, &bench_dst[i],
+						  &bench_src[i][j]);
+			if (!rn)
+				continue;
+			rn->info = NULL;
+			route_unlock_node(rn);
+			route_unlock_node(rn);
+		}
+		rn = srcdest_rnode_lookup(table, &bench_dst[i], NULL);
+		if (rn) {
+			rn->info = NULL;
+			route_unlock_node(rn);
+			route_unlock_node(rn);
+		}
+		ops++;
+	}
+	bench_report("delete", &start, ops);
+
+	prng_free(prng);
+	route_table_finish(table);
+}
+
 int main(int argc, char *argv[])
 {
+	if (argc > 1 && !strcmp(argv[1], "bench")) {
+		run_bench();
+		return 0;
+	}
+
 	run_prng_test();
 	printf("PRNG Test successful.\n");
 	return 0;
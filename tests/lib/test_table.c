@@ -7,6 +7,9 @@
  */
 
 #include <zebra.h>
+#include "frratomic.h"
+#include "frrcu.h"
+#include "frrevent.h"
 #include "printfrr.h"
 #include "prefix.h"
 #include "table.h"
@@ -477,6 +480,320 @@ static void test_iter_pause(void)
 	route_table_finish(table);
 }
 
+struct diff_result {
+	char buf[256];
+	size_t len;
+	const char *changed;
+};
+
+static bool diff_same(const struct route_node *old_rn,
+		      const struct route_node *new_rn, void *arg)
+{
+	struct diff_result *res = arg;
+	const test_node_t *node = new_rn->info;
+
+	return strcmp(node->prefix_str, res->changed) != 0;
+}
+
+static void diff_cb(struct route_node *old_rn, struct route_node *new_rn,
+		    void *arg)
+{
+	struct diff_result *res = arg;
+	const char *op = !old_rn ? "+" : !new_rn ? "-" : "*";
+	test_node_t *node = (new_rn ? new_rn : old_rn)->info;
+
+	res->len += snprintf(res->buf + res->len, sizeof(res->buf) - res->len,
+			     "%s%s%s", res->len ? " " : "", op,
+			     node->prefix_str);
+}
+
+static void verify_diff(struct route_table *old_table,
+			struct route_table *new_table, const char *changed,
+			const char *expected)
+{
+	struct route_table_diff_stats stats;
+	struct diff_result res = { .changed = changed };
+	unsigned long count[3] = {};
+	const char *c;
+
+	route_table_diff(old_table, new_table, diff_same, diff_cb, &res,
+			 &stats);
+
+	printf("Verified table diff. Expected: %s, Result: %s\n", expected,
+	       res.buf);
+	assert(!strcmp(res.buf, expected));
+
+	for (c = expected; *c; c++)
+		if (c == expected || c[-1] == ' ')
+			count[*c == '+' ? 0 : *c == '-' ? 1 : 2]++;
+
+	assert(stats.added == count[0]);
+	assert(stats.removed == count[1]);
+	assert(stats.changed == count[2]);
+}
+
+/*
+ * test_diff
+ */
+static void test_diff(void)
+{
+	struct route_table *old_table, *new_table;
+
+	printf("\n\nTesting route_table_diff()\n");
+
+	old_table = route_table_init();
+	new_table = route_table_init();
+
+	add_nodes(old_table, "1.0.0.0/8", "1.0.1.0/24", "1.0.2.0/24",
+		  "2.0.0.0/8", NULL);
+	add_nodes(new_table, "1.0.0.0/8", "1.0.2.0/24", "1.0.3.0/24",
+		  "2.0.0.0/8", "3.0.0.0/8", NULL);
+
+	verify_diff(old_table, new_table, "2.0.0.0/8",
+		    "-1.0.1.0/24 +1.0.3.0/24 *2.0.0.0/8 +3.0.0.0/8");
+	verify_diff(new_table, old_table, "",
+		    "+1.0.1.0/24 -1.0.3.0/24 -3.0.0.0/8");
+	verify_diff(old_table, old_table, "", "");
+	verify_diff(NULL, old_table, "",
+		    "+1.0.0.0/8 +1.0.1.0/24 +1.0.2.0/24 +2.0.0.0/8");
+
+	clear_table(old_table);
+	clear_table(new_table);
+	route_table_finish(old_table);
+	route_table_finish(new_table);
+}
+
+/*
+ * test_rcu
+ *
+ * Lookups from another thread while this one keeps adding and deleting
+ * routes below the ones it looks up.
+ */
+#define RCU_COVERS 16
+#define RCU_ROUNDS 2000
+
+static struct prefix_ipv4 rcu_covers[RCU_COVERS];
+static struct prefix_ipv4 rcu_specifics[RCU_COVERS * 4];
+static _Atomic bool rcu_done;
+
+struct rcu_reader {
+	struct route_table *table;
+	struct rcu_thread *rcu_thread;
+	unsigned long lookups;
+};
+
+static void rcu_verify(struct route_table *table, const struct prefix_ipv4 *p,
+		       bool exact)
+{
+	struct route_node *rn;
+	const struct prefix *info;
+
+	if (exact)
+		rn = route_node_lookup_rcu(table, p);
+	else
+		rn = route_node_match_rcu(table, p);
+	assert(rn);
+
+	/* info is never freed, it's in the arrays above */
+	info = route_node_get_info_rcu(rn);
+	assert(info && prefix_same(info, &rn->p));
+	assert(prefix_match(&rn->p, (const struct prefix *)p));
+}
+
+static void *rcu_reader_run(void *arg)
+{
+	struct rcu_reader *reader = arg;
+	struct prefix_ipv4 p = { .family = AF_INET, .prefixlen = 32 };
+	unsigned int i;
+
+	rcu_thread_start(reader->rcu_thread);
+
+	while (!atomic_load_explicit(&rcu_done, memory_order_relaxed)) {
+		for (i = 0; i < RCU_COVERS; i++) {
+			rcu_verify(reader->table, &rcu_covers[i], true);
+
+			p.prefix = rcu_covers[i].prefix;
+			p.prefix.s_addr |= htonl(reader->lookups & 0xffff);
+			rcu_verify(reader->table, &p, false);
+		}
+		reader->lookups++;
+
+		/* let the RCU thread free what was deleted meanwhile */
+		rcu_read_unlock();
+		rcu_read_lock();
+	}
+
+	rcu_read_unlock();
+	return NULL;
+}
+
+static void test_rcu(void)
+{
+	struct route_table *table;
+	struct rcu_reader reader = {};
+	struct route_node *rn;
+	unsigned long count;
+	pthread_t pt;
+	unsigned int i, j, r;
+
+	printf("\n\nTesting RCU lookups\n");
+
+	table = route_table_init_rcu();
+
+	for (i = 0; i < RCU_COVERS; i++) {
+		str2prefix_ipv4("10.0.0.0/16", &rcu_covers[i]);
+		rcu_covers[i].prefix.s_addr |= htonl(i << 16);
+		rn = route_node_get(table, &rcu_covers[i]);
+		route_node_set_info_rcu(rn, &rcu_covers[i]);
+
+		for (j = 0; j < 4; j++) {
+			rcu_specifics[i * 4 + j] = rcu_covers[i];
+			rcu_specifics[i * 4 + j].prefixlen = 24 + j;
+			rcu_specifics[i * 4 + j].prefix.s_addr |=
+				htonl((j + 1) << 8);
+		}
+	}
+
+	count = route_table_count(table);
+
+	reader.table = table;
+	reader.rcu_thread = rcu_thread_prepare();
+	assert(!pthread_create(&pt, NULL, rcu_reader_run, &reader));
+
+	for (r = 0; r < RCU_ROUNDS; r++) {
+		for (i = 0; i < array_size(rcu_specifics); i++) {
+			rn = route_node_get(table, &rcu_specifics[i]);
+			route_node_set_info_rcu(rn, &rcu_specifics[i]);
+		}
+		for (i = 0; i < array_size(rcu_specifics); i++) {
+			rn = route_node_lookup(table, &rcu_specifics[i]);
+			route_node_set_info_rcu(rn, NULL);
+			route_unlock_node(rn);
+			route_unlock_node(rn);
+		}
+
+		rcu_read_unlock();
+		rcu_read_lock();
+	}
+
+	atomic_store_explicit(&rcu_done, true, memory_order_relaxed);
+	pthread_join(pt, NULL);
+
+	assert(route_table_count(table) == count);
+	for (i = 0; i < RCU_COVERS; i++) {
+		rn = route_node_lookup(table, &rcu_covers[i]);
+		assert(rn && route_node_lookup_rcu(table, &rcu_covers[i]) == rn);
+		rn->info = NULL;
+		route_unlock_node(rn);
+		route_unlock_node(rn);
+	}
+	route_table_finish(table);
+
+	printf("Verified RCU lookups\n");
+}
+
+struct walk_state {
+	struct route_table *table;
+	struct route_table_walk walk;
+	unsigned int seen;
+	bool done;
+};
+
+static void walk_del_node(struct route_node *rn)
+{
+	test_node_t *node = rn->info;
+
+	rn->info = NULL;
+	route_unlock_node(rn);
+	free(node->prefix_str);
+	free(node);
+}
+
+static bool walk_fn(struct route_node *rn, void *arg)
+{
+	struct walk_state *ws = arg;
+	struct prefix_ipv4 p;
+	struct route_node *other;
+
+	if (!rn->info)
+		return true;
+
+	ws->seen++;
+
+	/* drop ourselves, and the next prefix before it is visited */
+	prefix_copy(&p, &rn->p);
+	walk_del_node(rn);
+
+	if (p.prefix.s_addr == htonl(0x0a000800)) {
+		p.prefix.s_addr = htonl(0x0a000900);
+		other = route_node_lookup(ws->table, &p);
+		assert(other && other->info);
+		route_unlock_node(other);
+		walk_del_node(other);
+	}
+	return true;
+}
+
+static void walk_done(void *arg)
+{
+	struct walk_state *ws = arg;
+
+	ws->done = true;
+}
+
+/*
+ * test_walk
+ */
+static void test_walk(void)
+{
+	struct walk_state ws = {};
+	struct event ev;
+	char buf[PREFIX_STRLEN];
+	unsigned int i;
+
+	printf("\n\nTesting background table walks\n");
+
+	master = event_master_create(NULL);
+	ws.table = route_table_init();
+	for (i = 0; i < 64; i++) {
+		snprintfrr(buf, sizeof(buf), "10.0.%u.0/24", i);
+		add_node(ws.table, buf);
+	}
+
+	/* yield after every node */
+	ws.walk.yield_usec = 1;
+	route_table_walk_start(&ws.walk, master, ws.table, walk_fn, walk_done,
+			       &ws);
+	assert(route_table_walk_running(&ws.walk));
+	assert(ws.seen == 0);
+
+	while (!ws.done && event_fetch(master, &ev))
+		event_call(&ev);
+
+	assert(!route_table_walk_running(&ws.walk));
+	assert(ws.seen == 63);
+	assert(route_table_count(ws.table) == 0);
+
+	/* cancelling halfway leaves nothing locked behind */
+	add_node(ws.table, "10.0.0.0/24");
+	add_node(ws.table, "10.0.1.0/24");
+	ws.seen = 0;
+	ws.done = false;
+	route_table_walk_start(&ws.walk, master, ws.table, walk_fn, walk_done,
+			       &ws);
+	route_table_walk_cancel(&ws.walk);
+	assert(!route_table_walk_running(&ws.walk));
+	assert(ws.seen == 0 && !ws.done);
+	clear_table(ws.table);
+	assert(route_table_count(ws.table) == 0);
+
+	route_table_finish(ws.table);
+	event_master_free(master);
+	master = NULL;
+
+	printf("Verified background table walks\n");
+}
+
 /*
  * run_tests
  */
@@ -485,6 +802,9 @@ static void run_tests(void)
 	test_prefix_iter_cmp();
 	test_get_next();
 	test_iter_pause();
+	test_diff();
+	test_rcu();
+	test_walk();
 }
 
 /*
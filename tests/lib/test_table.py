@@ -10,3 +10,7 @@ for i in range(6):
 for i in range(11):
     TestTable.onesimple("Verifying successor")
 TestTable.onesimple("Verified pausing")
+for i in range(4):
+    TestTable.onesimple("Verified table diff")
+TestTable.onesimple("Verified RCU lookups")
+TestTable.onesimple("Verified background table walks")
@@ -26,15 +26,25 @@ static void dummy_func(struct event *thread)
 {
 }
 
-int main(int argc, char **argv)
+static unsigned long msec_between(struct timeval *a, struct timeval *b)
+{
+	return 1000 * (b->tv_sec - a->tv_sec) + (b->tv_usec - a->tv_usec) / 1000;
+}
+
+/*
+ * range_msec picks how far out the timers go; the timer wheel only covers a
+ * few minutes, so long timers are expected to perform the same either way.
+ */
+static void run_test(const char *desc, bool wheel, long range_msec)
 {
 	struct prng *prng;
 	int i;
 	struct event **timers;
-	struct timeval tv_start, tv_lap, tv_stop;
-	unsigned long t_schedule, t_remove;
+	struct timeval tv_start, tv_lap, tv_resched, tv_stop;
+	unsigned long t_schedule, t_reschedule, t_remove;
 
 	master = event_master_create(NULL);
+	event_master_set_timer_wheel(master, wheel);
 	prng = prng_new(0);
 	timers = calloc(SCHEDULE_TIMERS, sizeof(*timers));
 
@@ -51,36 +61,61 @@ int main(int argc, char **argv)
 	for (i = 0; i < SCHEDULE_TIMERS; i++) {
 		long interval_msec;
 
-		interval_msec = prng_rand(prng) % (100 * SCHEDULE_TIMERS);
+		interval_msec = prng_rand(prng) % range_msec;
 		event_add_timer_msec(master, dummy_func, NULL, interval_msec,
 				     &timers[i]);
 	}
 
 	monotime(&tv_lap);
 
+	/* restart timers, like keepalives being reset on every update */
 	for (i = 0; i < REMOVE_TIMERS; i++) {
 		int index;
 
 		index = prng_rand(prng) % SCHEDULE_TIMERS;
 		event_cancel(&timers[index]);
+		event_add_timer_msec(master, dummy_func, NULL,
+				     prng_rand(prng) % range_msec,
+				     &timers[index]);
 	}
 
-	monotime(&tv_stop);
+	monotime(&tv_resched);
+
+	for (i = 0; i < REMOVE_TIMERS; i++) {
+		int index;
 
-	t_schedule = 1000 * (tv_lap.tv_sec - tv_start.tv_sec);
-	t_schedule += (tv_lap.tv_usec - tv_start.tv_usec) / 1000;
+		index = prng_rand(prng) % SCHEDULE_TIMERS;
+		event_cancel(&timers[index]);
+	}
+
+	monotime(&tv_stop);
 
-	t_remove = 1000 * (tv_stop.tv_sec - tv_lap.tv_sec);
-	t_remove += (tv_stop.tv_usec - tv_lap.tv_usec) / 1000;
+	t_schedule = msec_between(&tv_start, &tv_lap);
+	t_reschedule = msec_between(&tv_lap, &tv_resched);
+	t_remove = msec_between(&tv_resched, &tv_stop);
 
-	printf("Scheduling %d random timers took %lu.%03lu seconds.\n",
+	printf("%s, %s:\n", desc, wheel ? "timer wheel" : "timer heap");
+	printf("  Scheduling %d random timers took %lu.%03lu seconds.\n",
 	       SCHEDULE_TIMERS, t_schedule / 1000, t_schedule % 1000);
-	printf("Removing %d random timers took %lu.%03lu seconds.\n",
+	printf("  Rescheduling %d random timers took %lu.%03lu seconds.\n",
+	       REMOVE_TIMERS, t_reschedule / 1000, t_reschedule % 1000);
+	printf("  Removing %d random timers took %lu.%03lu seconds.\n",
 	       REMOVE_TIMERS, t_remove / 1000, t_remove % 1000);
 	fflush(stdout);
 
 	free(timers);
 	event_master_free(master);
 	prng_free(prng);
+}
+
+int main(int argc, char **argv)
+{
+	/* 0..100000s, way past the end of the wheel */
+	run_test("Long timers", false, 100 * SCHEDULE_TIMERS);
+	run_test("Long timers", true, 100 * SCHEDULE_TIMERS);
+
+	/* 0..180s, the range of BGP keepalive/hold timers */
+	run_test("Short timers", false, 180 * 1000);
+	run_test("Short timers", true, 180 * 1000);
 	return 0;
 }
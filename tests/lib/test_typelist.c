@@ -62,6 +62,8 @@
 #define _T_RBTREE_NONUNIQ	(T_SORTED          | T_REVERSE)
 #define _T_ATOMSORT_UNIQ	(T_SORTED | T_UNIQ | T_ATOMIC)
 #define _T_ATOMSORT_NONUNIQ	(T_SORTED          | T_ATOMIC)
+#define _T_SORTARRAY_UNIQ	(T_SORTED | T_UNIQ | T_REVERSE)
+#define _T_SORTARRAY_NONUNIQ	(T_SORTED          | T_REVERSE)
 
 #define _T_TYPE(type)		_T_##type
 #define IS_SORTED(type)		(_T_TYPE(type) & T_SORTED)
@@ -137,6 +139,12 @@ static void ts_end(void)
 #define TYPE ATOMSORT_NONUNIQ
 #include "test_typelist.h"
 
+#define TYPE SORTARRAY_UNIQ
+#include "test_typelist.h"
+
+#define TYPE SORTARRAY_NONUNIQ
+#include "test_typelist.h"
+
 int main(int argc, char **argv)
 {
 	srandom(1);
@@ -155,6 +163,8 @@ int main(int argc, char **argv)
 	test_RBTREE_NONUNIQ();
 	test_ATOMSORT_UNIQ();
 	test_ATOMSORT_NONUNIQ();
+	test_SORTARRAY_UNIQ();
+	test_SORTARRAY_NONUNIQ();
 
 	log_memstats_stderr("test: ");
 	return 0;
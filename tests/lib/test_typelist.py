@@ -19,3 +19,5 @@ TestTypelist.onesimple("RBTREE_UNIQ end")
 TestTypelist.onesimple("RBTREE_NONUNIQ end")
 TestTypelist.onesimple("ATOMSORT_UNIQ end")
 TestTypelist.onesimple("ATOMSORT_NONUNIQ end")
+TestTypelist.onesimple("SORTARRAY_UNIQ end")
+TestTypelist.onesimple("SORTARRAY_NONUNIQ end")
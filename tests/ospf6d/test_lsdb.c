@@ -223,6 +223,71 @@ DEFPY(lsdb_delete, lsdb_delete_cmd,
 	return CMD_SUCCESS;
 }
 
+/*
+ * Synthetic area LSDB for benchmarking: every router originates a router LSA
+ * and an intra-area-prefix LSA, which is what the SPF and intra-area route
+ * calculations walk.  Not used by the regular test run, timings vary.
+ */
+DEFPY(lsdb_scale, lsdb_scale_cmd,
+      "lsdb scale (1-1000000)$count [(1-1000)$passes]",
+      "LSDB\n"
+      "benchmark a synthetic LSDB\n"
+      "number of routers\n"
+      "number of lookup/iteration passes (default 10)\n")
+{
+	struct ospf6_lsdb *scale_lsdb;
+	struct ospf6_lsa_header hdr;
+	struct ospf6_lsa *lsa;
+	uint16_t rtr = htons(OSPF6_LSTYPE_ROUTER);
+	uint16_t inp = htons(OSPF6_LSTYPE_INTRA_PREFIX);
+	unsigned int found = 0, walked = 0;
+	uint64_t add_usecs, lookup_usecs, walk_usecs, del_usecs;
+	struct timeval start;
+	long i, j;
+
+	if (!passes_str)
+		passes = 10;
+
+	scale_lsdb = ospf6_lsdb_create(NULL);
+
+	monotime(&start);
+	memset(&hdr, 0, sizeof(hdr));
+	for (i = 0; i < count; i++) {
+		hdr.adv_router = htonl(0x0a000001 + i);
+		hdr.type = rtr;
+		ospf6_lsdb_add(ospf6_lsa_create_headeronly(&hdr), scale_lsdb);
+		hdr.type = inp;
+		ospf6_lsdb_add(ospf6_lsa_create_headeronly(&hdr), scale_lsdb);
+	}
+	add_usecs = monotime_since(&start, NULL);
+
+	monotime(&start);
+	for (j = 0; j < passes; j++)
+		for (i = 0; i < count; i++)
+			if (ospf6_lsdb_lookup(rtr, 0, htonl(0x0a000001 + i),
+					      scale_lsdb))
+				found++;
+	lookup_usecs = monotime_since(&start, NULL);
+
+	monotime(&start);
+	for (j = 0; j < passes; j++)
+		for (ALL_LSDB_TYPED(scale_lsdb, inp, lsa))
+			walked++;
+	walk_usecs = monotime_since(&start, NULL);
+
+	monotime(&start);
+	ospf6_lsdb_remove_all(scale_lsdb);
+	del_usecs = monotime_since(&start, NULL);
+	ospf6_lsdb_delete(scale_lsdb);
+
+	vty_out(vty,
+		"%ld routers: add %" PRIu64 " usecs, %u lookups %" PRIu64
+		" usecs, %u iterated %" PRIu64 " usecs, delete %" PRIu64
+		" usecs\n",
+		count, add_usecs, found, lookup_usecs, walked, walk_usecs,
+		del_usecs);
+	return CMD_SUCCESS;
+}
 
 struct zebra_privs_t ospf6d_privs;
 
@@ -243,4 +308,5 @@ void test_init(int argc, char **argv)
 	install_element(ENABLE_NODE, &lsdb_walk_type_cmd);
 	install_element(ENABLE_NODE, &lsdb_walk_type_adv_cmd);
 	install_element(ENABLE_NODE, &lsdb_get_cmd);
+	install_element(ENABLE_NODE, &lsdb_scale_cmd);
 }
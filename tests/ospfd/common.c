@@ -247,3 +247,122 @@ int topology_load(struct vty *vty, struct ospf_topology *topology,
 
 	return 0;
 }
+
+/*
+ * Synthetic topology for benchmarking: a rows x cols grid of routers with
+ * P2P links between horizontal and vertical neighbors, all with metric 10.
+ * Router i gets ID 10.0.0.0 + i + 1, link k uses 172.16.0.0 + 4 * k / 30.
+ */
+static uint32_t grid_link_index(unsigned int rows, unsigned int cols,
+				unsigned int r, unsigned int c, bool down)
+{
+	/* horizontal links first, then vertical ones */
+	if (!down)
+		return r * (cols - 1) + c;
+	return rows * (cols - 1) + r * cols + c;
+}
+
+static void grid_add_link(struct stream **s, unsigned int neighbor,
+			  uint32_t link, bool low_end)
+{
+	struct in_addr id, data;
+
+	id.s_addr = htonl(0x0a000000 + neighbor + 1);
+	data.s_addr = htonl(0xac100000 + 4 * link + (low_end ? 1 : 2));
+	link_info_set(s, id, data, LSA_LINK_TYPE_POINTOPOINT, 0, 10);
+
+	id.s_addr = htonl(0xac100000 + 4 * link);
+	masklen2ip(30, &data);
+	link_info_set(s, id, data, LSA_LINK_TYPE_STUB, 0, 10);
+}
+
+int topology_load_grid(struct vty *vty, unsigned int rows, unsigned int cols,
+		       struct ospf *ospf)
+{
+	struct ospf_area *area = ospf->backbone;
+	unsigned int r, c, i;
+
+	for (r = 0; r < rows; r++) {
+		for (c = 0; c < cols; c++) {
+			struct in_addr router_id, data;
+			struct lsa_header *lsah;
+			struct ospf_lsa *new;
+			struct stream *s;
+			unsigned long putp;
+			uint16_t link_count = 0;
+			int length;
+
+			i = r * cols + c;
+			router_id.s_addr = htonl(0x0a000000 + i + 1);
+
+			s = stream_new(OSPF_MAX_LSA_SIZE);
+			lsa_header_set(s,
+				       LSA_OPTIONS_GET(area) |
+					       LSA_OPTIONS_NSSA_GET(area),
+				       OSPF_ROUTER_LSA, router_id, router_id);
+			stream_putc(s, router_lsa_flags(area));
+			stream_putc(s, 0);
+			putp = stream_get_endp(s);
+			stream_putw(s, 0);
+
+			if (c > 0) {
+				grid_add_link(&s, i - 1,
+					      grid_link_index(rows, cols, r,
+							      c - 1, false),
+					      false);
+				link_count++;
+			}
+			if (c < cols - 1) {
+				grid_add_link(&s, i + 1,
+					      grid_link_index(rows, cols, r, c,
+							      false),
+					      true);
+				link_count++;
+			}
+			if (r > 0) {
+				grid_add_link(&s, i - cols,
+					      grid_link_index(rows, cols,
+							      r - 1, c, true),
+					      false);
+				link_count++;
+			}
+			if (r < rows - 1) {
+				grid_add_link(&s, i + cols,
+					      grid_link_index(rows, cols, r, c,
+							      true),
+					      true);
+				link_count++;
+			}
+
+			/* Don't forget the node itself (just a stub) */
+			data.s_addr = 0xffffffff;
+			link_info_set(&s, router_id, data, LSA_LINK_TYPE_STUB,
+				      0, 0);
+			stream_putw_at(s, putp, (2 * link_count) + 1);
+
+			length = stream_get_endp(s);
+			lsah = (struct lsa_header *)STREAM_DATA(s);
+			lsah->length = htons(length);
+
+			new = ospf_lsa_new_and_data(length);
+			new->area = area;
+			new->vrf_id = area->ospf->vrf_id;
+			memcpy(new->data, lsah, length);
+			stream_free(s);
+
+			/* The first router is the one doing the SPF run. */
+			if (i == 0)
+				SET_FLAG(new->flags,
+					 OSPF_LSA_SELF | OSPF_LSA_SELF_CHECKED);
+
+			ospf_lsdb_add(area->lsdb, new);
+
+			if (i == 0) {
+				ospf_lsa_unlock(&area->router_lsa_self);
+				area->router_lsa_self = ospf_lsa_lock(new);
+			}
+		}
+	}
+
+	return 0;
+}
@@ -28,6 +28,8 @@ extern struct ospf_test_node *test_find_node(struct ospf_topology *topology,
 					     const char *hostname);
 extern int topology_load(struct vty *vty, struct ospf_topology *topology,
 			 struct ospf_test_node *root, struct ospf *ospf);
+extern int topology_load_grid(struct vty *vty, unsigned int rows,
+			      unsigned int cols, struct ospf *ospf);
 
 /* Global variables. */
 extern struct event_loop *master;
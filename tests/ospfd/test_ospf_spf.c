@@ -13,6 +13,7 @@
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_asbr.h"
 #include "ospfd/ospf_lsa.h"
+#include "ospfd/ospf_lsdb.h"
 #include "ospfd/ospf_route.h"
 #include "ospfd/ospf_spf.h"
 #include "ospfd/ospf_ti_lfa.h"
@@ -202,6 +203,129 @@ DEFUN(test_ospf, test_ospf_cmd,
 	return test_run(vty, topology, root, protection_type, verbose);
 }
 
+DEFUN(test_ospf_grid, test_ospf_grid_cmd,
+      "test ospf grid (2-100) (2-100) spf [(1-100000)]",
+      "Test mode\n"
+      "Choose OSPF for SPF testing\n"
+      "Synthetic grid topology, for benchmarking\n"
+      "Number of rows\n"
+      "Number of columns\n"
+      "Run SPF\n"
+      "Number of SPF runs (default 100)\n")
+{
+	unsigned int rows = strtoul(argv[3]->arg, NULL, 10);
+	unsigned int cols = strtoul(argv[4]->arg, NULL, 10);
+	unsigned int runs = 100, vertices = 0, i;
+	struct route_table *new_table;
+	struct ospf_area *area;
+	struct in_addr area_id;
+	struct timeval start;
+	struct ospf *ospf;
+	uint64_t usecs;
+
+	if (argc > 6)
+		runs = strtoul(argv[6]->arg, NULL, 10);
+
+	ospf = ospf_new_alloc(0, VRF_DEFAULT_NAME);
+	area_id.s_addr = OSPF_AREA_BACKBONE;
+	area = ospf_area_new(ospf, area_id);
+	listnode_add_sort(ospf->areas, area);
+	ospf->router_id.s_addr = htonl(0x0a000001);
+	ospf->router_id_static = ospf->router_id;
+
+	if (topology_load_grid(vty, rows, cols, ospf)) {
+		vty_out(vty, "%% Failed to load topology\n");
+		return CMD_WARNING;
+	}
+
+	monotime(&start);
+	for (i = 0; i < runs; i++) {
+		new_table = route_table_init();
+
+		/* dryrun true, root_node false */
+		ospf_spf_calculate(area, area->router_lsa_self, new_table,
+				   NULL, NULL, true, false);
+
+		vertices = listcount(area->spf_vertex_list);
+		ospf_spf_cleanup(area->spf, area->spf_vertex_list);
+		ospf_route_table_free(new_table);
+	}
+	usecs = monotime_since(&start, NULL);
+
+	vty_out(vty, "%ux%u grid: %u vertices, %u SPF runs, %" PRIu64
+		" usecs per run\n",
+		rows, cols, vertices, runs, usecs / runs);
+
+	return CMD_SUCCESS;
+}
+
+DEFUN(test_ospf_lsdb, test_ospf_lsdb_cmd,
+      "test ospf lsdb (1-1000000) [(1-1000)]",
+      "Test mode\n"
+      "Choose OSPF for SPF testing\n"
+      "Synthetic LSDB, for benchmarking lookups and iteration\n"
+      "Number of summary-LSAs\n"
+      "Number of lookup/iteration passes (default 10)\n")
+{
+	unsigned int count = strtoul(argv[3]->arg, NULL, 10);
+	unsigned int passes = 10, i, j, found = 0, walked = 0;
+	uint64_t add_usecs, lookup_usecs, walk_usecs, del_usecs;
+	struct ospf_lsdb *lsdb;
+	struct ospf_lsa *lsa;
+	struct route_node *rn;
+	struct in_addr id, adv_router;
+	struct timeval start;
+
+	if (argc > 4)
+		passes = strtoul(argv[4]->arg, NULL, 10);
+
+	lsdb = ospf_lsdb_new();
+
+	/* 100 ABRs, each originating an equal share of the summaries */
+	monotime(&start);
+	for (i = 0; i < count; i++) {
+		lsa = ospf_lsa_new_and_data(OSPF_LSA_HEADER_SIZE);
+		lsa->data->type = OSPF_SUMMARY_LSA;
+		lsa->data->id.s_addr = htonl(0x0a000000 + i);
+		lsa->data->adv_router.s_addr = htonl(0xc0a80001 + i % 100);
+		lsa->data->length = htons(OSPF_LSA_HEADER_SIZE);
+		ospf_lsdb_add(lsdb, lsa);
+		ospf_lsa_discard(lsa);
+	}
+	add_usecs = monotime_since(&start, NULL);
+
+	monotime(&start);
+	for (j = 0; j < passes; j++)
+		for (i = 0; i < count; i++) {
+			id.s_addr = htonl(0x0a000000 + i);
+			adv_router.s_addr = htonl(0xc0a80001 + i % 100);
+			if (ospf_lsdb_lookup_by_id(lsdb, OSPF_SUMMARY_LSA, id,
+						   adv_router))
+				found++;
+		}
+	lookup_usecs = monotime_since(&start, NULL);
+
+	monotime(&start);
+	for (j = 0; j < passes; j++)
+		LSDB_LOOP (lsdb->type[OSPF_SUMMARY_LSA].db, rn, lsa)
+			walked++;
+	walk_usecs = monotime_since(&start, NULL);
+
+	monotime(&start);
+	ospf_lsdb_delete_all(lsdb);
+	del_usecs = monotime_since(&start, NULL);
+	ospf_lsdb_free(lsdb);
+
+	vty_out(vty,
+		"%u LSAs: add %" PRIu64 " usecs, %u lookups %" PRIu64
+		" usecs, %u iterated %" PRIu64 " usecs, delete %" PRIu64
+		" usecs\n",
+		count, add_usecs, found, lookup_usecs, walked, walk_usecs,
+		del_usecs);
+
+	return CMD_SUCCESS;
+}
+
 static void vty_do_exit(int isexit)
 {
 	printf("\nend.\n");
@@ -286,6 +410,8 @@ int main(int argc, char **argv)
 
 	/* Install test command. */
 	install_element(VIEW_NODE, &test_ospf_cmd);
+	install_element(VIEW_NODE, &test_ospf_grid_cmd);
+	install_element(VIEW_NODE, &test_ospf_lsdb_cmd);
 
 	/* needed for SR DB init */
 	ospf_vty_init();
@@ -0,0 +1,121 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: ISC
+
+"""
+Test that paths restored from a RIB snapshot are removed after
+stalepath-time, even if the first connect to the peer fails.
+"""
+
+import os
+import sys
+import json
+import pytest
+import functools
+
+CWD = os.path.dirname(os.path.realpath(__file__))
+sys.path.append(os.path.join(CWD, "../"))
+
+# pylint: disable=C0413
+from lib import topotest
+from lib.topogen import Topogen, TopoRouter, get_topogen
+from lib.common_config import kill_router_daemons, start_router_daemons, step
+
+pytestmark = [pytest.mark.bgpd]
+
+
+def build_topo(tgen):
+    for routern in range(1, 3):
+        tgen.add_router("r{}".format(routern))
+
+    switch = tgen.add_switch("s1")
+    switch.add_link(tgen.gears["r1"])
+    switch.add_link(tgen.gears["r2"])
+
+
+def setup_module(mod):
+    tgen = Topogen(build_topo, mod.__name__)
+    tgen.start_topology()
+
+    router_list = tgen.routers()
+
+    for i, (rname, router) in enumerate(router_list.items(), 1):
+        router.load_config(
+            TopoRouter.RD_ZEBRA, os.path.join(CWD, "{}/zebra.conf".format(rname))
+        )
+        router.load_config(
+            TopoRouter.RD_BGP, os.path.join(CWD, "{}/bgpd.conf".format(rname))
+        )
+
+    tgen.start_router()
+
+
+def teardown_module(mod):
+    tgen = get_topogen()
+    tgen.stop_topology()
+
+
+def test_bgp_rib_snapshot_connect_failed():
+    tgen = get_topogen()
+
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+
+    def _bgp_converge():
+        output = json.loads(r1.vtysh_cmd("show bgp ipv4 unicast 172.16.255.2/32 json"))
+        expected = {"paths": [{"valid": True}]}
+        return topotest.json_cmp(output, expected)
+
+    def _bgp_check_restored():
+        output = json.loads(r1.vtysh_cmd("show bgp rib-snapshot json"))
+        expected = {"restoredPaths": 1}
+        return topotest.json_cmp(output, expected)
+
+    def _bgp_check_stale():
+        output = json.loads(r1.vtysh_cmd("show bgp ipv4 unicast 172.16.255.2/32 json"))
+        expected = {"paths": [{"stale": True}]}
+        return topotest.json_cmp(output, expected)
+
+    def _bgp_check_connect_failed():
+        output = json.loads(r1.vtysh_cmd("show bgp ipv4 neighbors 192.168.255.2 json"))
+        expected = {"192.168.255.2": {"bgpState": "Active"}}
+        return topotest.json_cmp(output, expected)
+
+    def _bgp_check_removed():
+        output = json.loads(r1.vtysh_cmd("show bgp ipv4 unicast 172.16.255.2/32 json"))
+        expected = {"paths": None}
+        return topotest.json_cmp(output, expected)
+
+    step("Initial BGP converge")
+    test_func = functools.partial(_bgp_converge)
+    _, result = topotest.run_and_expect(test_func, None, count=60, wait=0.5)
+    assert result is None, "Failed to see 172.16.255.2/32 on R1"
+
+    step("Stop bgpd on R1 to write the snapshot, then stop bgpd on R2")
+    kill_router_daemons(tgen, "r1", ["bgpd"])
+    kill_router_daemons(tgen, "r2", ["bgpd"])
+
+    step("Start bgpd on R1 again, with R2 still down")
+    start_router_daemons(tgen, "r1", ["bgpd"])
+
+    step("Check that the snapshot was restored as stale paths")
+    test_func = functools.partial(_bgp_check_restored)
+    _, result = topotest.run_and_expect(test_func, None, count=30, wait=0.5)
+    assert result is None, "Failed to restore the RIB snapshot on R1"
+    assert _bgp_check_stale() is None, "Restored path is not stale on R1"
+
+    step("Check that connecting to R2 fails")
+    test_func = functools.partial(_bgp_check_connect_failed)
+    _, result = topotest.run_and_expect(test_func, None, count=30, wait=0.5)
+    assert result is None, "R1 did not try and fail to connect to R2"
+
+    step("Check that the stale path goes away after stalepath-time")
+    test_func = functools.partial(_bgp_check_removed)
+    _, result = topotest.run_and_expect(test_func, None, count=40, wait=0.5)
+    assert result is None, "Restored stale path stayed on R1"
+
+
+if __name__ == "__main__":
+    args = ["-s"] + sys.argv[1:]
+    sys.exit(pytest.main(args))
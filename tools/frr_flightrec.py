@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0-or-later
+"""
+Usage: frr_flightrec.py [-n COUNT] DIR
+
+Decode the flight recorder rings a daemon leaves in its temporary directory
+(e.g. /var/tmp/frr/bgpd.1234) when it crashes.  Records from all pthreads
+are merged and printed in time order, the call sites are taken from the
+"flightrec.sites" file next to the rings.
+
+The file layout is defined in lib/flightrec.c.
+
+Copyright (C) 2026 The FRRouting Project
+"""
+
+import argparse
+import datetime
+import os
+import re
+import struct
+import sys
+
+MAGIC = b"FRRFLTR1"
+# magic, hdr_size, rec_size, nrecs, pad, tid, realtime_offset, head
+HDR = struct.Struct("=8sIIII qqQ")
+NARGS = 5
+# seq, ts, xref, args
+REC = struct.Struct("=QQQ%dQ" % NARGS)
+
+
+class Site:
+    def __init__(self, line):
+        fields = line.rstrip("\n").split("\t")
+        self.uid = fields[1]
+        self.file = fields[2]
+        self.line = int(fields[3])
+        self.func = fields[4]
+        self.name = fields[5]
+        self.args = split_args(fields[6]) if len(fields) > 6 else []
+
+
+def split_args(argstr):
+    """
+    split the stringified flightrec() arguments, returning (name, hex) pairs
+    """
+    args = []
+    depth = 0
+    cur = ""
+    for char in argstr + ",":
+        if char == "," and depth == 0:
+            cur = cur.strip()
+            hexfmt = cur.startswith("(uintptr_t)")
+            cur = re.sub(r"^\([^()]*\)\s*", "", cur)
+            args.append((cur, hexfmt))
+            cur = ""
+            continue
+        if char == "(":
+            depth += 1
+        elif char == ")":
+            depth -= 1
+        cur += char
+    return args
+
+
+def read_sites(path):
+    sites = {}
+    try:
+        with open(path, "r", errors="replace") as fd:
+            for line in fd:
+                sites[int(line.split("\t", 1)[0], 16)] = Site(line)
+    except FileNotFoundError:
+        pass
+    return sites
+
+
+def read_ring(path):
+    with open(path, "rb") as fd:
+        data = fd.read()
+
+    if len(data) < HDR.size:
+        return []
+    magic, hdr_size, rec_size, nrecs, _, tid, rt_offset, head = HDR.unpack_from(
+        data
+    )
+    if magic != MAGIC or rec_size < REC.size:
+        return []
+
+    records = []
+    for idx in range(nrecs):
+        off = hdr_size + idx * rec_size
+        if off + REC.size > len(data):
+            break
+        seq, ts, xref, *args = REC.unpack_from(data, off)
+        # never written, or the crash hit in the middle of writing
+        if seq == 0 or seq > head:
+            continue
+        records.append((ts + rt_offset, seq, tid, xref, args))
+    return records
+
+
+def format_record(rec, sites):
+    ts, _, tid, xref, args = rec
+    when = datetime.datetime.fromtimestamp(ts / 1e9).strftime(
+        "%Y-%m-%dT%H:%M:%S.%f"
+    )
+
+    site = sites.get(xref)
+    if site is None:
+        values = " ".join("%#x" % arg for arg in args)
+        return "%s %8d <unknown site %#x> %s" % (when, tid, xref, values)
+
+    values = []
+    for (name, hexfmt), arg in zip(site.args, args):
+        values.append("%s=%s" % (name, ("%#x" if hexfmt else "%d") % arg))
+    return "%s %8d %s %s (%s:%d)" % (
+        when,
+        tid,
+        site.name,
+        " ".join(values),
+        site.file,
+        site.line,
+    )
+
+
+def main():
+    argp = argparse.ArgumentParser(description="decode FRR flight recorder")
+    argp.add_argument("-n", "--count", type=int, default=0,
+                      help="only print the last COUNT records")
+    argp.add_argument("dir", help="daemon temporary directory")
+    args = argp.parse_args()
+
+    sites = read_sites(os.path.join(args.dir, "flightrec.sites"))
+
+    records = []
+    for name in os.listdir(args.dir):
+        if re.match(r"^flightrec\.\d+$", name):
+            records.extend(read_ring(os.path.join(args.dir, name)))
+
+    if not records:
+        sys.stderr.write("no flight recorder records in %s\n" % args.dir)
+        return 1
+
+    records.sort()
+    if args.count:
+        records = records[-args.count:]
+
+    for rec in records:
+        print(format_record(rec, sites))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Print a compiled YANG context for daemons to share.
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#define REALLY_NEED_PLAIN_GETOPT 1
+
+#include <zebra.h>
+
+#include <unistd.h>
+
+#include "yang.h"
+
+static void __attribute__((noreturn)) usage(int status)
+{
+	fprintf(stderr,
+		"usage: gen_yang_context [-h] [-p SEARCHDIR]... -o FILE MODULE...\n");
+	exit(status);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *searchdirs[16];
+	unsigned int nsearchdirs = 0;
+	const char *output = NULL;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "hp:o:")) != -1) {
+		switch (opt) {
+		case 'h':
+			usage(EXIT_SUCCESS);
+			/* NOTREACHED */
+		case 'p':
+			if (nsearchdirs == array_size(searchdirs))
+				usage(EXIT_FAILURE);
+			searchdirs[nsearchdirs++] = optarg;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		default:
+			usage(EXIT_FAILURE);
+			/* NOTREACHED */
+		}
+	}
+	argc -= optind;
+	argv += optind;
+	if (argc < 1 || !output)
+		usage(EXIT_FAILURE);
+
+	/* same setup as the daemons, except modules come from the files */
+	yang_init(false, false);
+
+	for (unsigned int i = 0; i < nsearchdirs; i++)
+		ly_ctx_set_searchdir(ly_native_ctx, searchdirs[i]);
+
+	for (int i = 0; i < argc; i++)
+		yang_module_load(argv[i]);
+
+	if (yang_ctx_shared_write(output)) {
+		fprintf(stderr, "cannot write %s: %s\n", output,
+			safe_strerror(errno));
+		return 1;
+	}
+
+	yang_terminate();
+	return 0;
+}
@@ -9,6 +9,7 @@
 #include "lib/hash.h"
 #include "lib/hook.h"
 #include "lib/if.h"
+#include "lib/jhash.h"
 #include "lib/linklist.h"
 #include "lib/memory.h"
 #include "lib/network.h"
@@ -29,12 +30,46 @@
 
 DEFINE_MTYPE_STATIC(VRRPD, VRRP_IP, "VRRP IP address");
 DEFINE_MTYPE_STATIC(VRRPD, VRRP_RTR, "VRRP Router");
+DEFINE_MTYPE_STATIC(VRRPD, VRRP_RX_SOCK, "VRRP Rx socket");
+DEFINE_MTYPE_STATIC(VRRPD, VRRP_ADVER_GROUP, "VRRP advertisement group");
+
+/*
+ * Rx socket shared by all VRRP routers of one address family on an
+ * interface. Received advertisements are dispatched by VRID.
+ */
+struct vrrp_rx_sock {
+	struct interface *ifp;
+	int family;
+	int fd;
+	unsigned int refcnt;
+	struct event *t_read;
+};
+
+/*
+ * Master VRRP routers with the same interface and advertisement interval
+ * share a single Adver_Timer; when it fires, all of them advertise.
+ */
+struct vrrp_adver_group {
+	struct interface *ifp;
+	uint16_t interval;
+	struct list *routers;
+	struct event *t_adver;
+};
 
 /* statics */
 struct hash *vrrp_vrouters_hash;
+static struct hash *vrrp_rx_socks;
+static struct hash *vrrp_adver_groups;
+
+static void vrrp_rx_sock_put(struct vrrp_rx_sock **rxp);
+static void vrrp_adver_timer_start(struct vrrp_router *r);
+static void vrrp_adver_timer_stop(struct vrrp_router *r);
 bool vrrp_autoconfig_is_on;
 int vrrp_autoconfig_version;
 
+/* Socket read buffer, shared by all Rx sockets */
+static uint8_t vrrp_ibuf[IP_MAXPACKET];
+
 struct vrrp_defaults vd;
 
 const char *const vrrp_state_names[3] = {
@@ -383,6 +418,12 @@ void vrrp_set_advertisement_interval(struct vrrp_vrouter *vr,
 	vr->advertisement_interval = advertisement_interval;
 	vrrp_recalculate_timers(vr->v4);
 	vrrp_recalculate_timers(vr->v6);
+
+	/* Move running Adver_Timers to the group for the new interval */
+	if (vr->v4->adver_group)
+		vrrp_adver_timer_start(vr->v4);
+	if (vr->v6->adver_group)
+		vrrp_adver_timer_start(vr->v6);
 }
 
 static bool vrrp_has_ip(struct vrrp_vrouter *vr, struct ipaddr *ip)
@@ -586,7 +627,6 @@ static struct vrrp_router *vrrp_router_create(struct vrrp_vrouter *vr,
 		XCALLOC(MTYPE_VRRP_RTR, sizeof(struct vrrp_router));
 
 	r->family = family;
-	r->sock_rx = -1;
 	r->sock_tx = -1;
 	r->vr = vr;
 	r->addrs = list_new();
@@ -605,8 +645,7 @@ static void vrrp_router_destroy(struct vrrp_router *r)
 	if (r->is_active)
 		vrrp_event(r, VRRP_EVENT_SHUTDOWN);
 
-	if (r->sock_rx >= 0)
-		close(r->sock_rx);
+	vrrp_rx_sock_put(&r->rx);
 	if (r->sock_tx >= 0)
 		close(r->sock_tx);
 
@@ -673,7 +712,6 @@ struct vrrp_vrouter *vrrp_lookup(const struct interface *ifp, uint8_t vrid)
 
 /* Forward decls */
 static void vrrp_change_state(struct vrrp_router *r, int to);
-static void vrrp_adver_timer_expire(struct event *thread);
 static void vrrp_master_down_timer_expire(struct event *thread);
 
 /*
@@ -899,12 +937,11 @@ static int vrrp_recv_advertisement(struct vrrp_router *r, struct ipaddr *src,
 		addrcmp = ipaddr_cmp(src, &r->src);
 
 		if (pkt->hdr.priority == 0) {
+			/*
+			 * The Adver_Timer is shared with the other routers
+			 * of our group, so it is left running
+			 */
 			vrrp_send_advertisement(r);
-			EVENT_OFF(r->t_adver_timer);
-			event_add_timer_msec(master, vrrp_adver_timer_expire, r,
-					     r->vr->advertisement_interval *
-						     CS2MS,
-					     &r->t_adver_timer);
 		} else if (pkt->hdr.priority > r->priority
 			   || ((pkt->hdr.priority == r->priority)
 			       && addrcmp > 0)) {
@@ -913,7 +950,7 @@ static int vrrp_recv_advertisement(struct vrrp_router *r, struct ipaddr *src,
 				"Received advertisement from %s w/ priority %hhu; switching to Backup",
 				r->vr->vrid, family2str(r->family), sipstr,
 				pkt->hdr.priority);
-			EVENT_OFF(r->t_adver_timer);
+			vrrp_adver_timer_stop(r);
 			if (r->vr->version == 3) {
 				r->master_adver_interval =
 					htons(pkt->hdr.v3.adver_int);
@@ -973,17 +1010,45 @@ static int vrrp_recv_advertisement(struct vrrp_router *r, struct ipaddr *src,
 	return 0;
 }
 
+/*
+ * Called when the shared Rx socket of an interface fails; every VRRP router
+ * using it goes down.
+ */
+static void vrrp_rx_sock_fail(struct vrrp_rx_sock *rx)
+{
+	struct list *vrs = hash_to_list(vrrp_vrouters_hash);
+	int family = rx->family;
+	struct listnode *ln;
+	struct vrrp_vrouter *vr;
+	struct vrrp_router *r;
+
+	/* the last shutdown frees rx */
+	for (ALL_LIST_ELEMENTS_RO(vrs, ln, vr)) {
+		r = family == AF_INET ? vr->v4 : vr->v6;
+		if (r->rx == rx)
+			vrrp_event(r, VRRP_EVENT_SHUTDOWN);
+	}
+
+	list_delete(&vrs);
+}
+
 /*
  * Read and process next IPvX datagram.
+ *
+ * The socket is shared by all VRRP routers of one address family on the
+ * interface, the datagram is handed to the router its VRID belongs to.
  */
 static void vrrp_read(struct event *thread)
 {
-	struct vrrp_router *r = EVENT_ARG(thread);
+	struct vrrp_rx_sock *rx = EVENT_ARG(thread);
+	struct vrrp_vrouter *vr;
+	struct vrrp_router *r;
 
 	struct vrrp_pkt *pkt;
 	ssize_t pktsize;
 	ssize_t nbytes;
-	bool resched;
+	size_t hdrlen = 0;
+	uint8_t vrid;
 	char errbuf[BUFSIZ];
 	struct sockaddr_storage sa;
 	uint8_t control[64];
@@ -992,8 +1057,8 @@ static void vrrp_read(struct event *thread)
 	struct msghdr m = {};
 	struct iovec iov;
 
-	iov.iov_base = r->ibuf;
-	iov.iov_len = sizeof(r->ibuf);
+	iov.iov_base = vrrp_ibuf;
+	iov.iov_len = sizeof(vrrp_ibuf);
 	m.msg_name = &sa;
 	m.msg_namelen = sizeof(sa);
 	m.msg_iov = &iov;
@@ -1001,14 +1066,34 @@ static void vrrp_read(struct event *thread)
 	m.msg_control = control;
 	m.msg_controllen = sizeof(control);
 
-	nbytes = recvmsg(r->sock_rx, &m, MSG_DONTWAIT);
+	nbytes = recvmsg(rx->fd, &m, MSG_DONTWAIT);
 
 	if ((nbytes < 0 && ERRNO_IO_RETRY(errno))) {
-		resched = true;
+		nbytes = 0;
 		goto done;
 	} else if (nbytes <= 0) {
-		vrrp_event(r, VRRP_EVENT_SHUTDOWN);
-		resched = false;
+		vrrp_rx_sock_fail(rx);
+		return;
+	}
+
+	/* Find the Virtual Router before parsing, parsing depends on it */
+	if (rx->family == AF_INET && (size_t)nbytes >= sizeof(struct ip))
+		hdrlen = ((struct ip *)vrrp_ibuf)->ip_hl << 2;
+	if ((size_t)nbytes < hdrlen + 2) {
+		DEBUGD(&vrrp_dbg_pkt,
+		       VRRP_LOGPFX "Datagram on %s too short to contain VRID",
+		       rx->ifp->name);
+		goto done;
+	}
+	vrid = vrrp_ibuf[hdrlen + 1];
+
+	vr = vrrp_lookup(rx->ifp, vrid);
+	r = vr ? (rx->family == AF_INET ? vr->v4 : vr->v6) : NULL;
+	if (!r || r->rx != rx) {
+		DEBUGD(&vrrp_dbg_pkt,
+		       VRRP_LOGPFX
+		       "Datagram on %s for VRID %hhu which has no active %s instance",
+		       rx->ifp->name, vrid, family2str(rx->family));
 		goto done;
 	}
 
@@ -1017,7 +1102,7 @@ static void vrrp_read(struct event *thread)
 		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 		       "Datagram rx: ",
 		       r->vr->vrid, family2str(r->family));
-		zlog_hexdump(r->ibuf, nbytes);
+		zlog_hexdump(vrrp_ibuf, nbytes);
 	}
 
 	pktsize = vrrp_pkt_parse_datagram(
@@ -1033,37 +1118,236 @@ static void vrrp_read(struct event *thread)
 	else
 		vrrp_recv_advertisement(r, &src, pkt, pktsize);
 
-	resched = true;
-
 done:
-	memset(r->ibuf, 0x00, sizeof(r->ibuf));
+	memset(vrrp_ibuf, 0x00, nbytes);
 
-	if (resched)
-		event_add_read(master, vrrp_read, r, r->sock_rx, &r->t_read);
+	event_add_read(master, vrrp_read, rx, rx->fd, &rx->t_read);
 }
 
 /*
- * Creates and configures VRRP router sockets.
+ * Creates and configures the Rx socket shared by all VRRP routers of one
+ * address family on the Virtual Router's interface.
  *
  * This function:
- * - Creates two sockets, one for Tx, one for Rx
- * - Binds the Tx socket to the macvlan device, if necessary (VRF case)
  * - Binds the Rx socket to the base interface
  * - Joins the Rx socket to the appropriate VRRP multicast group
- * - Sets the Tx socket to set the TTL (v4) or Hop Limit (v6) field to 255 for
- *   all transmitted IPvX packets
  * - Requests the kernel to deliver IPv6 header values needed to validate VRRP
  *   packets
  *
+ * The first connected address on the Virtual Router's interface is used as the
+ * interface address.
+ *
+ * r
+ *    VRRP Router for which to create the socket
+ *
+ * Returns:
+ *    the socket on success
+ *    -1 on failure
+ */
+static int vrrp_rx_socket(struct vrrp_router *r)
+{
+	int fd;
+	int ret;
+
+	frr_with_privs(&vrrp_privs) {
+		fd = vrf_socket(r->family, SOCK_RAW, IPPROTO_VRRP,
+				r->vr->ifp->vrf->vrf_id, NULL);
+	}
+
+	if (fd < 0) {
+		zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+			  "Can't create VRRP Rx socket",
+			  r->vr->vrid, family2str(r->family));
+		return -1;
+	}
+
+	if (r->family == AF_INET6) {
+		/* Request hop limit delivery */
+		ret = setsockopt_ipv6_hoplimit(fd, 1);
+		if (ret < 0) {
+			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+				  "Failed to request IPv6 Hop Limit delivery",
+				  r->vr->vrid, family2str(r->family));
+			goto fail;
+		}
+	}
+
+	/* Bind Rx socket to exact interface */
+	frr_with_privs(&vrrp_privs) {
+		ret = setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE,
+				 r->vr->ifp->name, strlen(r->vr->ifp->name));
+	}
+	if (ret) {
+		zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+			  "Failed to bind Rx socket to %s: %s",
+			  r->vr->vrid, family2str(r->family), r->vr->ifp->name,
+			  safe_strerror(errno));
+		goto fail;
+	}
+	DEBUGD(&vrrp_dbg_sock,
+	       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM "Bound Rx socket to %s",
+	       r->vr->vrid, family2str(r->family), r->vr->ifp->name);
+
+	if (r->family == AF_INET) {
+		/* Bind Rx socket to v4 multicast address */
+		struct sockaddr_in sa = {0};
+
+		sa.sin_family = AF_INET;
+		sa.sin_addr.s_addr = htonl(VRRP_MCASTV4_GROUP);
+		if (bind(fd, (struct sockaddr *)&sa, sizeof(sa))) {
+			zlog_err(
+				VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+				"Failed to bind Rx socket to VRRP multicast group: %s",
+				r->vr->vrid, family2str(r->family),
+				safe_strerror(errno));
+			goto fail;
+		}
+		DEBUGD(&vrrp_dbg_sock,
+		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+		       "Bound Rx socket to VRRP multicast group",
+		       r->vr->vrid, family2str(r->family));
+
+		/* Join Rx socket to VRRP IPv4 multicast group */
+		assert(listhead(r->vr->ifp->connected));
+		struct connected *c = listhead(r->vr->ifp->connected)->data;
+		struct in_addr v4 = c->address->u.prefix4;
+
+		ret = setsockopt_ipv4_multicast(fd, IP_ADD_MEMBERSHIP, v4,
+						htonl(VRRP_MCASTV4_GROUP),
+						r->vr->ifp->ifindex);
+		if (ret < 0) {
+			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID
+				  "Failed to join VRRP %s multicast group",
+				  r->vr->vrid, family2str(r->family));
+			goto fail;
+		}
+	} else {
+		/* Bind Rx socket to v6 multicast address */
+		struct sockaddr_in6 sa = {0};
+
+		sa.sin6_family = AF_INET6;
+		inet_pton(AF_INET6, VRRP_MCASTV6_GROUP_STR, &sa.sin6_addr);
+		if (bind(fd, (struct sockaddr *)&sa, sizeof(sa))) {
+			zlog_err(
+				VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+				"Failed to bind Rx socket to VRRP multicast group: %s",
+				r->vr->vrid, family2str(r->family),
+				safe_strerror(errno));
+			goto fail;
+		}
+		DEBUGD(&vrrp_dbg_sock,
+		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+		       "Bound Rx socket to VRRP multicast group",
+		       r->vr->vrid, family2str(r->family));
+
+		/* Join VRRP IPv6 multicast group */
+		struct ipv6_mreq mreq;
+
+		inet_pton(AF_INET6, VRRP_MCASTV6_GROUP_STR,
+			  &mreq.ipv6mr_multiaddr);
+		mreq.ipv6mr_interface = r->vr->ifp->ifindex;
+		ret = setsockopt(fd, IPPROTO_IPV6, IPV6_JOIN_GROUP, &mreq,
+				 sizeof(mreq));
+		if (ret < 0) {
+			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+				  "Failed to join VRRP multicast group",
+				  r->vr->vrid, family2str(r->family));
+			goto fail;
+		}
+	}
+	DEBUGD(&vrrp_dbg_sock,
+	       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+	       "Joined VRRP multicast group",
+	       r->vr->vrid, family2str(r->family));
+
+	return fd;
+
+fail:
+	close(fd);
+	return -1;
+}
+
+static unsigned int vrrp_rx_sock_hash_key(const void *arg)
+{
+	const struct vrrp_rx_sock *rx = arg;
+
+	return jhash_2words(rx->ifp->ifindex, rx->family, 0);
+}
+
+static bool vrrp_rx_sock_hash_cmp(const void *arg1, const void *arg2)
+{
+	const struct vrrp_rx_sock *rx1 = arg1;
+	const struct vrrp_rx_sock *rx2 = arg2;
+
+	return rx1->ifp == rx2->ifp && rx1->family == rx2->family;
+}
+
+/*
+ * Gets a reference to the shared Rx socket of a VRRP router's interface and
+ * address family, creating it if this is the first router using it.
+ */
+static struct vrrp_rx_sock *vrrp_rx_sock_get(struct vrrp_router *r)
+{
+	struct vrrp_rx_sock key = {.ifp = r->vr->ifp, .family = r->family};
+	struct vrrp_rx_sock *rx;
+	int fd;
+
+	rx = hash_lookup(vrrp_rx_socks, &key);
+	if (rx) {
+		rx->refcnt++;
+		return rx;
+	}
+
+	fd = vrrp_rx_socket(r);
+	if (fd < 0)
+		return NULL;
+
+	rx = XCALLOC(MTYPE_VRRP_RX_SOCK, sizeof(*rx));
+	rx->ifp = key.ifp;
+	rx->family = key.family;
+	rx->fd = fd;
+	rx->refcnt = 1;
+	(void)hash_get(vrrp_rx_socks, rx, hash_alloc_intern);
+
+	event_add_read(master, vrrp_read, rx, rx->fd, &rx->t_read);
+
+	return rx;
+}
+
+static void vrrp_rx_sock_put(struct vrrp_rx_sock **rxp)
+{
+	struct vrrp_rx_sock *rx = *rxp;
+
+	if (!rx)
+		return;
+	*rxp = NULL;
+
+	if (--rx->refcnt)
+		return;
+
+	EVENT_OFF(rx->t_read);
+	close(rx->fd);
+	hash_release(vrrp_rx_socks, rx);
+	XFREE(MTYPE_VRRP_RX_SOCK, rx);
+}
+
+/*
+ * Creates and configures VRRP router sockets.
+ *
+ * This function:
+ * - Creates the Tx socket
+ * - Binds the Tx socket to the macvlan device, if necessary (VRF case)
+ * - Sets the Tx socket to set the TTL (v4) or Hop Limit (v6) field to 255 for
+ *   all transmitted IPvX packets
+ * - Gets the Rx socket shared by all VRRP routers of this address family on
+ *   the base interface, creating it if necessary
+ *
  * If any of the above fail, the sockets are closed. The only exception is if
  * the TTL / Hop Limit settings fail; these are logged, but configuration
  * proceeds.
  *
- * The first connected address on the Virtual Router's interface is used as the
- * interface address.
- *
  * r
- *    VRRP Router for which to create listen socket
+ *    VRRP Router for which to create sockets
  *
  * Returns:
  *     0 on success
@@ -1075,18 +1359,14 @@ static int vrrp_socket(struct vrrp_router *r)
 	bool failed = false;
 
 	frr_with_privs(&vrrp_privs) {
-		r->sock_rx = vrf_socket(r->family, SOCK_RAW, IPPROTO_VRRP,
-					r->vr->ifp->vrf->vrf_id, NULL);
 		r->sock_tx = vrf_socket(r->family, SOCK_RAW, IPPROTO_VRRP,
 					r->vr->ifp->vrf->vrf_id, NULL);
 	}
 
-	if (r->sock_rx < 0 || r->sock_tx < 0) {
-		const char *rxtx = r->sock_rx < 0 ? "Rx" : "Tx";
-
+	if (r->sock_tx < 0) {
 		zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 			  "Can't create VRRP %s socket",
-			  r->vr->vrid, family2str(r->family), rxtx);
+			  r->vr->vrid, family2str(r->family), "Tx");
 		failed = true;
 		goto done;
 	}
@@ -1132,64 +1412,6 @@ static int vrrp_socket(struct vrrp_router *r)
 		/* Turn off multicast loop on Tx */
 		setsockopt_ipv4_multicast_loop(r->sock_tx, 0);
 
-		/* Bind Rx socket to exact interface */
-		frr_with_privs(&vrrp_privs) {
-			ret = setsockopt(r->sock_rx, SOL_SOCKET,
-					 SO_BINDTODEVICE, r->vr->ifp->name,
-					 strlen(r->vr->ifp->name));
-		}
-		if (ret) {
-			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-				  "Failed to bind Rx socket to %s: %s",
-				  r->vr->vrid, family2str(r->family),
-				  r->vr->ifp->name, safe_strerror(errno));
-			failed = true;
-			goto done;
-		}
-		DEBUGD(&vrrp_dbg_sock,
-		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-		       "Bound Rx socket to %s",
-		       r->vr->vrid, family2str(r->family), r->vr->ifp->name);
-
-		/* Bind Rx socket to v4 multicast address */
-		struct sockaddr_in sa = {0};
-
-		sa.sin_family = AF_INET;
-		sa.sin_addr.s_addr = htonl(VRRP_MCASTV4_GROUP);
-		if (bind(r->sock_rx, (struct sockaddr *)&sa, sizeof(sa))) {
-			zlog_err(
-				VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-				"Failed to bind Rx socket to VRRP multicast group: %s",
-				r->vr->vrid, family2str(r->family),
-				safe_strerror(errno));
-			failed = true;
-			goto done;
-		}
-		DEBUGD(&vrrp_dbg_sock,
-		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-		       "Bound Rx socket to VRRP multicast group",
-		       r->vr->vrid, family2str(r->family));
-
-		/* Join Rx socket to VRRP IPv4 multicast group */
-		assert(listhead(r->vr->ifp->connected));
-		struct connected *c = listhead(r->vr->ifp->connected)->data;
-		struct in_addr v4 = c->address->u.prefix4;
-
-		ret = setsockopt_ipv4_multicast(r->sock_rx, IP_ADD_MEMBERSHIP,
-						v4, htonl(VRRP_MCASTV4_GROUP),
-						r->vr->ifp->ifindex);
-		if (ret < 0) {
-			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID
-				  "Failed to join VRRP %s multicast group",
-				  r->vr->vrid, family2str(r->family));
-			failed = true;
-			goto done;
-		}
-		DEBUGD(&vrrp_dbg_sock,
-		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-		       "Joined VRRP multicast group",
-		       r->vr->vrid, family2str(r->family));
-
 		/* Set outgoing interface for advertisements */
 		struct ip_mreqn mreqn = {};
 
@@ -1229,77 +1451,9 @@ static int vrrp_socket(struct vrrp_router *r)
 		/* Set Tx socket DSCP byte */
 		setsockopt_ipv6_tclass(r->sock_tx, IPTOS_PREC_INTERNETCONTROL);
 
-		/* Request hop limit delivery */
-		setsockopt_ipv6_hoplimit(r->sock_rx, 1);
-		if (ret < 0) {
-			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-				  "Failed to request IPv6 Hop Limit delivery",
-				  r->vr->vrid, family2str(r->family));
-			failed = true;
-			goto done;
-		}
-
 		/* Turn off multicast loop on Tx */
 		setsockopt_ipv6_multicast_loop(r->sock_tx, 0);
 
-		/* Bind Rx socket to exact interface */
-		frr_with_privs(&vrrp_privs) {
-			ret = setsockopt(r->sock_rx, SOL_SOCKET,
-					 SO_BINDTODEVICE, r->vr->ifp->name,
-					 strlen(r->vr->ifp->name));
-		}
-		if (ret) {
-			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-				  "Failed to bind Rx socket to %s: %s",
-				  r->vr->vrid, family2str(r->family),
-				  r->vr->ifp->name, safe_strerror(errno));
-			failed = true;
-			goto done;
-		}
-		DEBUGD(&vrrp_dbg_sock,
-		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-		       "Bound Rx socket to %s",
-		       r->vr->vrid, family2str(r->family), r->vr->ifp->name);
-
-		/* Bind Rx socket to v6 multicast address */
-		struct sockaddr_in6 sa = {0};
-
-		sa.sin6_family = AF_INET6;
-		inet_pton(AF_INET6, VRRP_MCASTV6_GROUP_STR, &sa.sin6_addr);
-		if (bind(r->sock_rx, (struct sockaddr *)&sa, sizeof(sa))) {
-			zlog_err(
-				VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-				"Failed to bind Rx socket to VRRP multicast group: %s",
-				r->vr->vrid, family2str(r->family),
-				safe_strerror(errno));
-			failed = true;
-			goto done;
-		}
-		DEBUGD(&vrrp_dbg_sock,
-		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-		       "Bound Rx socket to VRRP multicast group",
-		       r->vr->vrid, family2str(r->family));
-
-		/* Join VRRP IPv6 multicast group */
-		struct ipv6_mreq mreq;
-
-		inet_pton(AF_INET6, VRRP_MCASTV6_GROUP_STR,
-			  &mreq.ipv6mr_multiaddr);
-		mreq.ipv6mr_interface = r->vr->ifp->ifindex;
-		ret = setsockopt(r->sock_rx, IPPROTO_IPV6, IPV6_JOIN_GROUP,
-				 &mreq, sizeof(mreq));
-		if (ret < 0) {
-			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-				  "Failed to join VRRP multicast group",
-				  r->vr->vrid, family2str(r->family));
-			failed = true;
-			goto done;
-		}
-		DEBUGD(&vrrp_dbg_sock,
-		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-		       "Joined VRRP multicast group",
-		       r->vr->vrid, family2str(r->family));
-
 		/* Set outgoing interface for advertisements */
 		ret = setsockopt(r->sock_tx, IPPROTO_IPV6, IPV6_MULTICAST_IF,
 				 &r->mvl_ifp->ifindex, sizeof(ifindex_t));
@@ -1318,16 +1472,17 @@ static int vrrp_socket(struct vrrp_router *r)
 		       r->vr->vrid, family2str(r->family), r->mvl_ifp->name);
 	}
 
+	r->rx = vrrp_rx_sock_get(r);
+	if (!r->rx)
+		failed = true;
+
 done:
 	ret = 0;
 	if (failed) {
 		zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 			  "Failed to initialize VRRP router",
 			  r->vr->vrid, family2str(r->family));
-		if (r->sock_rx >= 0) {
-			close(r->sock_rx);
-			r->sock_rx = -1;
-		}
+		vrrp_rx_sock_put(&r->rx);
 		if (r->sock_tx >= 0) {
 			close(r->sock_tx);
 			r->sock_tx = -1;
@@ -1405,7 +1560,7 @@ static void vrrp_change_state_backup(struct vrrp_router *r)
 		vrrp_zebra_radv_set(r, false);
 
 	/* Disable Adver_Timer */
-	EVENT_OFF(r->t_adver_timer);
+	vrrp_adver_timer_stop(r);
 
 	r->advert_pending = false;
 	r->garp_pending = false;
@@ -1471,31 +1626,108 @@ static void vrrp_change_state(struct vrrp_router *r, int to)
 }
 
 /*
- * Called when Adver_Timer expires.
+ * Called when the Adver_Timer of an advertisement group expires.
  */
 static void vrrp_adver_timer_expire(struct event *thread)
 {
-	struct vrrp_router *r = EVENT_ARG(thread);
+	struct vrrp_adver_group *ag = EVENT_ARG(thread);
+	struct listnode *ln;
+	struct vrrp_router *r;
 
-	DEBUGD(&vrrp_dbg_proto,
-	       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-	       "Adver_Timer expired",
-	       r->vr->vrid, family2str(r->family));
+	for (ALL_LIST_ELEMENTS_RO(ag->routers, ln, r)) {
+		DEBUGD(&vrrp_dbg_proto,
+		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+		       "Adver_Timer expired",
+		       r->vr->vrid, family2str(r->family));
 
-	if (r->fsm.state == VRRP_STATE_MASTER) {
-		/* Send an ADVERTISEMENT */
-		vrrp_send_advertisement(r);
+		if (r->fsm.state == VRRP_STATE_MASTER) {
+			/* Send an ADVERTISEMENT */
+			vrrp_send_advertisement(r);
+		} else {
+			zlog_err(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+				 "Adver_Timer expired in state '%s'; this is a bug",
+				 r->vr->vrid, family2str(r->family),
+				 vrrp_state_names[r->fsm.state]);
+		}
+	}
 
-		/* Reset the Adver_Timer to Advertisement_Interval */
-		event_add_timer_msec(master, vrrp_adver_timer_expire, r,
-				     r->vr->advertisement_interval * CS2MS,
-				     &r->t_adver_timer);
-	} else {
-		zlog_err(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-			 "Adver_Timer expired in state '%s'; this is a bug",
-			 r->vr->vrid, family2str(r->family),
-			 vrrp_state_names[r->fsm.state]);
+	/* Reset the Adver_Timer to Advertisement_Interval */
+	event_add_timer_msec(master, vrrp_adver_timer_expire, ag,
+			     ag->interval * CS2MS, &ag->t_adver);
+}
+
+static unsigned int vrrp_adver_group_hash_key(const void *arg)
+{
+	const struct vrrp_adver_group *ag = arg;
+
+	return jhash_2words(ag->ifp->ifindex, ag->interval, 0);
+}
+
+static bool vrrp_adver_group_hash_cmp(const void *arg1, const void *arg2)
+{
+	const struct vrrp_adver_group *ag1 = arg1;
+	const struct vrrp_adver_group *ag2 = arg2;
+
+	return ag1->ifp == ag2->ifp && ag1->interval == ag2->interval;
+}
+
+/*
+ * Stops a VRRP router's Adver_Timer by removing it from its advertisement
+ * group. The group goes away with its last member.
+ */
+static void vrrp_adver_timer_stop(struct vrrp_router *r)
+{
+	struct vrrp_adver_group *ag = r->adver_group;
+
+	if (!ag)
+		return;
+	r->adver_group = NULL;
+
+	listnode_delete(ag->routers, r);
+	if (listcount(ag->routers))
+		return;
+
+	EVENT_OFF(ag->t_adver);
+	list_delete(&ag->routers);
+	hash_release(vrrp_adver_groups, ag);
+	XFREE(MTYPE_VRRP_ADVER_GROUP, ag);
+}
+
+/*
+ * Starts a VRRP router's Adver_Timer by adding it to the advertisement group
+ * for its interface and advertisement interval. If the router is already in
+ * a group for another interval, it is moved.
+ *
+ * A router joining a running group advertises with the group, so its first
+ * advertisement after becoming Master may come early.
+ */
+static void vrrp_adver_timer_start(struct vrrp_router *r)
+{
+	struct vrrp_adver_group key = {
+		.ifp = r->vr->ifp,
+		.interval = r->vr->advertisement_interval,
+	};
+	struct vrrp_adver_group *ag;
+
+	if (r->adver_group) {
+		if (vrrp_adver_group_hash_cmp(r->adver_group, &key))
+			return;
+		vrrp_adver_timer_stop(r);
 	}
+
+	ag = hash_lookup(vrrp_adver_groups, &key);
+	if (!ag) {
+		ag = XCALLOC(MTYPE_VRRP_ADVER_GROUP, sizeof(*ag));
+		ag->ifp = key.ifp;
+		ag->interval = key.interval;
+		ag->routers = list_new();
+		(void)hash_get(vrrp_adver_groups, ag, hash_alloc_intern);
+		event_add_timer_msec(master, vrrp_adver_timer_expire, ag,
+				     ag->interval * CS2MS, &ag->t_adver);
+	}
+
+	listnode_add(ag->routers, r);
+	r->adver_group = ag;
 }
 
 /*
@@ -1509,9 +1741,7 @@ static void vrrp_master_down_timer_expire(struct event *thread)
 		  "Master_Down_Timer expired",
 		  r->vr->vrid, family2str(r->family));
 
-	event_add_timer_msec(master, vrrp_adver_timer_expire, r,
-			     r->vr->advertisement_interval * CS2MS,
-			     &r->t_adver_timer);
+	vrrp_adver_timer_start(r);
 	vrrp_change_state(r, VRRP_STATE_MASTER);
 }
 
@@ -1552,17 +1782,14 @@ static int vrrp_startup(struct vrrp_router *r)
 	if (r->family == AF_INET6 && !vrrp_ndisc_is_init())
 		vrrp_ndisc_init();
 
-	/* Create socket */
-	if (r->sock_rx < 0 || r->sock_tx < 0) {
+	/* Create sockets; this also schedules the shared listener */
+	if (!r->rx || r->sock_tx < 0) {
 		int ret = vrrp_socket(r);
 
-		if (ret < 0 || r->sock_tx < 0 || r->sock_rx < 0)
+		if (ret < 0 || r->sock_tx < 0 || !r->rx)
 			return ret;
 	}
 
-	/* Schedule listener */
-	event_add_read(master, vrrp_read, r, r->sock_rx, &r->t_read);
-
 	/* Configure effective priority */
 	assert(listhead(r->addrs));
 	struct ipaddr *primary = (struct ipaddr *)listhead(r->addrs)->data;
@@ -1583,9 +1810,7 @@ static int vrrp_startup(struct vrrp_router *r)
 	}
 
 	if (r->priority == VRRP_PRIO_MASTER) {
-		event_add_timer_msec(master, vrrp_adver_timer_expire, r,
-				     r->vr->advertisement_interval * CS2MS,
-				     &r->t_adver_timer);
+		vrrp_adver_timer_start(r);
 		vrrp_change_state(r, VRRP_STATE_MASTER);
 	} else {
 		r->master_adver_interval = r->vr->advertisement_interval;
@@ -1632,9 +1857,8 @@ static int vrrp_shutdown(struct vrrp_router *r)
 	}
 
 	/* Cancel all timers */
-	EVENT_OFF(r->t_adver_timer);
+	vrrp_adver_timer_stop(r);
 	EVENT_OFF(r->t_master_down_timer);
-	EVENT_OFF(r->t_read);
 	EVENT_OFF(r->t_write);
 
 	/* Protodown macvlan */
@@ -1644,10 +1868,7 @@ static int vrrp_shutdown(struct vrrp_router *r)
 	/* Throw away our source address */
 	memset(&r->src, 0x00, sizeof(r->src));
 
-	if (r->sock_rx > 0) {
-		close(r->sock_rx);
-		r->sock_rx = -1;
-	}
+	vrrp_rx_sock_put(&r->rx);
 	if (r->sock_tx > 0) {
 		close(r->sock_tx);
 		r->sock_tx = -1;
@@ -2395,6 +2616,11 @@ void vrrp_init(void)
 	vrrp_autoconfig_version = 3;
 	vrrp_vrouters_hash = hash_create(&vrrp_hash_key, vrrp_hash_cmp,
 					 "VRRP virtual router hash");
+	vrrp_rx_socks = hash_create(vrrp_rx_sock_hash_key,
+				    vrrp_rx_sock_hash_cmp, "VRRP Rx sockets");
+	vrrp_adver_groups = hash_create(vrrp_adver_group_hash_key,
+					vrrp_adver_group_hash_cmp,
+					"VRRP advertisement groups");
 	vrf_init(NULL, NULL, NULL, NULL);
 }
 
@@ -2412,4 +2638,6 @@ void vrrp_fini(void)
 	list_delete(&vrs);
 
 	hash_clean_and_free(&vrrp_vrouters_hash, NULL);
+	hash_clean_and_free(&vrrp_rx_socks, NULL);
+	hash_clean_and_free(&vrrp_adver_groups, NULL);
 }
@@ -88,8 +88,11 @@ struct vrrp_router {
 	/* Whether we are the address owner */
 	bool is_owner;
 
-	/* Rx socket: Rx from parent of mvl_ifp */
-	int sock_rx;
+	/*
+	 * Rx socket: Rx from parent of mvl_ifp, shared by all VRRP routers of
+	 * the same address family on that interface
+	 */
+	struct vrrp_rx_sock *rx;
 	/* Tx socket; Tx from mvl_ifp */
 	int sock_tx;
 
@@ -99,9 +102,6 @@ struct vrrp_router {
 	/* Source address for advertisements */
 	struct ipaddr src;
 
-	/* Socket read buffer */
-	uint8_t ibuf[IP_MAXPACKET];
-
 	/*
 	 * Address family of this Virtual Router.
 	 * Either AF_INET or AF_INET6.
@@ -194,8 +194,11 @@ struct vrrp_router {
 	} stats;
 
 	struct event *t_master_down_timer;
-	struct event *t_adver_timer;
-	struct event *t_read;
+	/*
+	 * Adver_Timer; shared by all Master VRRP routers with the same
+	 * interface and advertisement interval
+	 */
+	struct vrrp_adver_group *adver_group;
 	struct event *t_write;
 };
 
@@ -39,6 +39,7 @@
 #include "bgpd/bgp_vty.h"
 
 DEFINE_MTYPE_STATIC(MVTYSH, VTYSH_CMD, "Vtysh cmd copy");
+DEFINE_MTYPE_STATIC(MVTYSH, VTYSH_PIPELINE, "Vtysh command pipeline");
 
 /* Struct VTY. */
 struct vty *vty;
@@ -154,9 +155,15 @@ enum vtysh_write_integrated vtysh_write_integrated =
 	WRITE_INTEGRATED_UNSPECIFIED;
 
 static int vtysh_reconnect(struct vtysh_client *vclient);
+static void vtysh_pipeline_reset(struct vtysh_client *vclient);
+static int vtysh_pipeline_flush(struct vtysh_client *vclient);
+static int vtysh_client_execute(struct vtysh_client *head_client,
+				const char *line);
 
 static void vclient_close(struct vtysh_client *vclient)
 {
+	vtysh_pipeline_reset(vclient);
+
 	if (vclient->fd >= 0) {
 		if (vty->of)
 			vty_out(vty,
@@ -248,6 +255,9 @@ static int vtysh_client_run(struct vtysh_client *vclient, const char *line,
 	char *bufvalid, *end = NULL;
 	char terminator[3] = {0, 0, 0};
 
+	/* replies to anything sent before have to be out of the way */
+	vtysh_pipeline_flush(vclient);
+
 	/* vclinet was previously active, try to reconnect */
 	if (vclient->fd == VTYSH_WAS_ACTIVE) {
 		ret = vtysh_reconnect(vclient);
@@ -408,6 +418,194 @@ out:
 	return ret;
 }
 
+/*
+ * Loading a config file, commands that don't need the daemon's answer
+ * before going on are sent without waiting for the reply, up to
+ * VTYSH_PIPELINE_DEPTH per daemon.  The daemon runs them in order, so the
+ * replies arrive in order and are matched up with the lines they belong to
+ * for error reporting.
+ *
+ * Daemons with several instances aren't pipelined (one of them answering
+ * CMD_NOT_MY_INSTANCE is fine), and neither is mgmtd (which only reads the
+ * next command once the previous one has been answered).
+ */
+#define VTYSH_PIPELINE_DEPTH 64
+
+struct vtysh_pipeline {
+	/* oldest one at head */
+	struct {
+		int lineno;
+		char *line;
+	} pending[VTYSH_PIPELINE_DEPTH];
+	unsigned int head, count;
+
+	/* reply data not processed yet */
+	char buf[4096];
+	size_t len;
+};
+
+static void vtysh_config_report(int lineno, int cmd_stat, const char *name,
+				const char *line)
+{
+	fprintf(stderr,
+		"line %d: Failure to communicate[%d] to %s, line: %s\n",
+		lineno, cmd_stat, name, line);
+}
+
+static void vtysh_pipeline_reset(struct vtysh_client *vclient)
+{
+	struct vtysh_pipeline *pl = vclient->pipeline;
+
+	if (!pl)
+		return;
+
+	while (pl->count) {
+		XFREE(MTYPE_VTYSH_CMD, pl->pending[pl->head].line);
+		pl->head = (pl->head + 1) % VTYSH_PIPELINE_DEPTH;
+		pl->count--;
+	}
+	pl->len = 0;
+}
+
+/* Read the reply to the oldest command sent, return its status */
+static int vtysh_pipeline_recv(struct vtysh_client *vclient)
+{
+	struct vtysh_pipeline *pl = vclient->pipeline;
+	int lineno = pl->pending[pl->head].lineno;
+	char *line = pl->pending[pl->head].line;
+	size_t textlen;
+	ssize_t nread;
+	char *end;
+	int ret;
+
+	while (true) {
+		/* daemon output is text, so the first NUL starts the end */
+		end = memchr(pl->buf, '\0', pl->len);
+		textlen = end ? (size_t)(end - pl->buf) : pl->len;
+
+		if (textlen && vty->of)
+			vty_out(vty, "%.*s", (int)textlen, pl->buf);
+		memmove(pl->buf, pl->buf + textlen, pl->len - textlen);
+		pl->len -= textlen;
+
+		if (pl->len >= 4) {
+			ret = pl->buf[3];
+			memmove(pl->buf, pl->buf + 4, pl->len - 4);
+			pl->len -= 4;
+			break;
+		}
+
+		nread = vtysh_client_receive(vclient, pl->buf + pl->len,
+					     sizeof(pl->buf) - pl->len, NULL);
+		if (nread < 0 && (errno == EINTR || errno == EAGAIN))
+			continue;
+		if (nread <= 0) {
+			if (vty->of)
+				vty_out(vty,
+					"vtysh: error reading from %s: %s (%d)",
+					vclient->name, safe_strerror(errno),
+					errno);
+			/* the line is freed with the rest of the pipeline */
+			line = XSTRDUP(MTYPE_VTYSH_CMD, line);
+			vclient_close(vclient);
+			vtysh_config_report(lineno, CMD_ERR_NO_DAEMON,
+					    vclient->name, line);
+			XFREE(MTYPE_VTYSH_CMD, line);
+			return CMD_ERR_NO_DAEMON;
+		}
+		pl->len += nread;
+	}
+
+	/* same as vtysh_config_from_file(): warnings are fine */
+	if (ret != CMD_SUCCESS && ret != CMD_WARNING)
+		vtysh_config_report(lineno, ret, vclient->name, line);
+	else
+		ret = CMD_SUCCESS;
+
+	XFREE(MTYPE_VTYSH_CMD, pl->pending[pl->head].line);
+	pl->head = (pl->head + 1) % VTYSH_PIPELINE_DEPTH;
+	pl->count--;
+	return ret;
+}
+
+/* Read all outstanding replies, return the last failure (if any) */
+static int vtysh_pipeline_flush(struct vtysh_client *vclient)
+{
+	int ret, ret_all = CMD_SUCCESS;
+
+	while (vclient->pipeline && vclient->pipeline->count) {
+		ret = vtysh_pipeline_recv(vclient);
+		if (ret != CMD_SUCCESS)
+			ret_all = ret;
+	}
+	return ret_all;
+}
+
+static int vtysh_pipeline_flush_all(void)
+{
+	int ret, ret_all = CMD_SUCCESS;
+
+	for (unsigned int i = 0; i < array_size(vtysh_client); i++) {
+		ret = vtysh_pipeline_flush(&vtysh_client[i]);
+		if (ret != CMD_SUCCESS)
+			ret_all = ret;
+	}
+	return ret_all;
+}
+
+/*
+ * Send a config line to a daemon, possibly without waiting for the reply.
+ * Returns the status of the line itself if it was run synchronously, else
+ * that of an earlier line whose reply had to be read to make room.
+ */
+static int vtysh_pipeline_send(struct vtysh_client *vclient, const char *line,
+			       int lineno)
+{
+	struct vtysh_pipeline *pl;
+	size_t len = strlen(line) + 1;
+	unsigned int slot;
+	int ret = CMD_SUCCESS;
+
+	if (vclient->next || vclient->flag == VTYSH_MGMTD) {
+		ret = vtysh_client_execute(vclient, line);
+		if (ret == CMD_WARNING)
+			return CMD_SUCCESS;
+		if (ret != CMD_SUCCESS)
+			vtysh_config_report(lineno, ret, vclient->name, line);
+		return ret;
+	}
+
+	if (vclient->fd == VTYSH_WAS_ACTIVE && vtysh_reconnect(vclient) < 0)
+		return CMD_SUCCESS;
+	if (vclient->fd < 0)
+		return CMD_SUCCESS;
+
+	if (!vclient->pipeline)
+		vclient->pipeline = XCALLOC(MTYPE_VTYSH_PIPELINE,
+					    sizeof(*vclient->pipeline));
+	pl = vclient->pipeline;
+
+	if (pl->count == VTYSH_PIPELINE_DEPTH)
+		ret = vtysh_pipeline_recv(vclient);
+
+	if (write(vclient->fd, line, len) <= 0) {
+		/* same as vtysh_client_run(): reconnect and retry */
+		vclient_close(vclient);
+		if (vtysh_reconnect(vclient) < 0 ||
+		    write(vclient->fd, line, len) <= 0) {
+			vclient_close(vclient);
+			return ret;
+		}
+	}
+
+	slot = (pl->head + pl->count) % VTYSH_PIPELINE_DEPTH;
+	pl->pending[slot].lineno = lineno;
+	pl->pending[slot].line = XSTRDUP(MTYPE_VTYSH_CMD, line);
+	pl->count++;
+
+	return ret;
+}
+
 static int vtysh_client_run_all(struct vtysh_client *head_client,
 				const char *line, int continue_on_err,
 				void (*callback)(void *, const char *),
@@ -912,8 +1110,29 @@ int vtysh_config_from_file(struct vty *vty, FILE *fp)
 			unsigned int i;
 			int cmd_stat = CMD_SUCCESS;
 
+			/*
+			 * Nothing to do in vtysh after the daemons are done
+			 * (like entering a node), so don't wait for them.
+			 */
+			if (!cmd->func) {
+				for (i = 0; i < array_size(vtysh_client); i++) {
+					if (!(cmd->daemon & vtysh_client[i].flag))
+						continue;
+					cmd_stat = vtysh_pipeline_send(
+						&vtysh_client[i], vty->buf,
+						lineno);
+					if (cmd_stat != CMD_SUCCESS)
+						retcode = cmd_stat;
+				}
+				break;
+			}
+
 			for (i = 0; i < array_size(vtysh_client); i++) {
 				if (cmd->daemon & vtysh_client[i].flag) {
+					cmd_stat = vtysh_pipeline_flush(
+						&vtysh_client[i]);
+					if (cmd_stat != CMD_SUCCESS)
+						retcode = cmd_stat;
 					cmd_stat = vtysh_client_execute(
 						&vtysh_client[i], vty->buf);
 					/*
@@ -927,8 +1146,7 @@ int vtysh_config_from_file(struct vty *vty, FILE *fp)
 					 */
 					if (cmd_stat != CMD_SUCCESS
 					    && cmd_stat != CMD_WARNING) {
-						fprintf(stderr,
-							"line %d: Failure to communicate[%d] to %s, line: %s\n",
+						vtysh_config_report(
 							lineno, cmd_stat,
 							vtysh_client[i].name,
 							vty->buf);
@@ -946,6 +1164,10 @@ int vtysh_config_from_file(struct vty *vty, FILE *fp)
 		}
 	}
 
+	ret = vtysh_pipeline_flush_all();
+	if (ret != CMD_SUCCESS)
+		retcode = ret;
+
 	XFREE(MTYPE_VTYSH_CMD, vty_buf_copy);
 
 	return (retcode);
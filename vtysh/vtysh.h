@@ -119,6 +119,8 @@ extern int user_mode;
 
 extern bool vtysh_add_timestamp;
 
+struct vtysh_pipeline;
+
 struct vtysh_client {
 	int fd;
 	const char *name;
@@ -129,6 +131,9 @@ struct vtysh_client {
 	struct event *log_reader;
 	int log_fd;
 	uint32_t lost_msgs;
+
+	/* commands sent while loading a config file, replies not read yet */
+	struct vtysh_pipeline *pipeline;
 };
 
 extern struct vtysh_client vtysh_client[22];
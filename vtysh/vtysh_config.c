@@ -9,6 +9,7 @@
 #include "command.h"
 #include "linklist.h"
 #include "memory.h"
+#include "monotime.h"
 #include "typesafe.h"
 
 #include "vtysh/vtysh.h"
@@ -666,6 +667,8 @@ int vtysh_apply_config(const char *config_file_path, bool dry_run, bool do_fork)
 	int ret;
 	int my_client_type;
 	char my_client[64];
+	struct timeval start;
+	int64_t elapsed;
 
 	if (do_fork) {
 		for (unsigned int i = 0; i < array_size(vtysh_client); i++) {
@@ -731,19 +734,25 @@ int vtysh_apply_config(const char *config_file_path, bool dry_run, bool do_fork)
 			my_client);
 	}
 
+	monotime(&start);
 	ret = vtysh_read_config(config_file_path, dry_run);
+	elapsed = monotime_since(&start, NULL);
 
 	if (ret) {
 		if (do_fork)
 			fprintf(stderr,
-				"[%d|%s] Configuration file[%s] processing failure: %d\n",
-				getpid(), my_client, frr_config, ret);
+				"[%d|%s] Configuration file[%s] processing failure: %d (%" PRId64
+				".%03" PRId64 "s)\n",
+				getpid(), my_client, frr_config, ret,
+				elapsed / 1000000, elapsed / 1000 % 1000);
 		else
 			fprintf(stderr,
 				"Configuration file[%s] processing failure: %d\n",
 				frr_config, ret);
 	} else if (do_fork) {
-		fprintf(stderr, "[%d|%s] done\n", getpid(), my_client);
+		fprintf(stderr, "[%d|%s] done in %" PRId64 ".%03" PRId64 "s\n",
+			getpid(), my_client, elapsed / 1000000,
+			elapsed / 1000 % 1000);
 		exit(0);
 	}
 
@@ -17,6 +17,7 @@
 #include "zlog_targets.h"
 #include "network.h"
 #include "printfrr.h"
+#include "monotime.h"
 
 #include <getopt.h>
 #include <sys/un.h>
@@ -113,6 +114,16 @@ static struct global_state {
 	int numdaemons;
 	int numpids;
 	int numdown; /* # of daemons that are not UP or UNRESPONSIVE */
+
+	/* --depends arguments, resolved once the daemon list is known */
+	const char **depends;
+	int numdepends;
+
+	/* cold start: daemons are started as their dependencies get ready */
+	bool booting;
+	bool boot_reported;
+	struct timeval boot; /* when watchfrr started, for the startup times */
+	long boot_done;
 } gs = {
 	.phase = PHASE_INIT,
 	.vtydir = frr_vtydir,
@@ -163,6 +174,19 @@ struct daemon {
 	 * at
 	 */
 	bool ignore_timeout;
+
+	/* answered an echo since it came up, i.e. done with its startup and
+	 * running its event loop
+	 */
+	bool ready;
+	/* daemons that have to be ready before this one is started */
+	struct daemon **deps;
+	int numdeps;
+
+	/* startup timeline in msec after watchfrr started, -1 if not (yet) */
+	long boot_start;
+	long boot_up;
+	long boot_ready;
 };
 
 #define OPTION_MINRESTART 2000
@@ -170,6 +194,7 @@ struct daemon {
 #define OPTION_DRY        2002
 #define OPTION_NETNS      2003
 #define OPTION_MAXOPERATIONAL 2004
+#define OPTION_DEPENDS    2005
 
 static const struct option longopts[] = {
 	{"daemon", no_argument, NULL, 'd'},
@@ -185,6 +210,7 @@ static const struct option longopts[] = {
 	{"min-restart-interval", required_argument, NULL, OPTION_MINRESTART},
 	{"max-restart-interval", required_argument, NULL, OPTION_MAXRESTART},
 	{"operational-timeout", required_argument, NULL, OPTION_MAXOPERATIONAL},
+	{"depends", required_argument, NULL, OPTION_DEPENDS},
 	{"pid-file", required_argument, NULL, 'p'},
 	{"blank-string", required_argument, NULL, 'b'},
 #ifdef GNU_LINUX
@@ -199,6 +225,7 @@ static void wakeup_send_echo(struct event *t_wakeup);
 static void try_restart(struct daemon *dmn);
 static void phase_check(void);
 static void restart_done(struct daemon *dmn);
+static void boot_check(void);
 
 static const char *progname;
 
@@ -262,6 +289,10 @@ Otherwise, the interval is doubled (but capped at the -M value).\n\n",
     --operational-timeout\n\
                 Set the time before systemd is notified that we are considered\n\
                 operational again after a daemon restart (default is %d).\n\
+    --depends	DAEMON:DEP[,DEP...] - when starting from scratch, only start\n\
+		DAEMON once all of DEP are up and responding.  By default\n\
+		everything waits for zebra, and for mgmtd if that is watched.\n\
+		Daemons with no pending dependencies are started in parallel.\n\
 -i, --interval	Set the status polling interval in seconds (default is %d)\n\
 -t, --timeout	Set the unresponsiveness timeout in seconds (default is %d)\n\
 -T, --restart-timeout\n\
@@ -608,6 +639,7 @@ static void daemon_down(struct daemon *dmn, const char *why)
 	if (IS_UP(dmn))
 		gs.numdown++;
 	dmn->state = DAEMON_DOWN;
+	dmn->ready = false;
 	if (dmn->fd >= 0) {
 		close(dmn->fd);
 		dmn->fd = -1;
@@ -671,6 +703,12 @@ static void handle_read(struct event *t_read)
 
 	time_elapsed(&delay, &dmn->echo_sent);
 	dmn->echo_sent.tv_sec = 0;
+	if (!dmn->ready) {
+		dmn->ready = true;
+		if (dmn->boot_ready < 0)
+			dmn->boot_ready = monotime_since(&gs.boot, NULL) / 1000;
+		boot_check();
+	}
 	if (dmn->state == DAEMON_UNRESPONSIVE) {
 		if (delay.tv_sec < gs.timeout) {
 			dmn->state = DAEMON_UP;
@@ -737,6 +775,8 @@ static void daemon_up(struct daemon *dmn, const char *why)
 	gs.numdown--;
 	dmn->connect_tries = 0;
 	zlog_notice("%s state -> up : %s", dmn->name, why);
+	if (dmn->boot_up < 0)
+		dmn->boot_up = monotime_since(&gs.boot, NULL) / 1000;
 	if (gs.numdown == 0) {
 		daemon_send_ready(0);
 
@@ -746,7 +786,16 @@ static void daemon_up(struct daemon *dmn, const char *why)
 				gs.operational_timeout, &gs.t_operational);
 	}
 
-	SET_WAKEUP_ECHO(dmn);
+	if (dmn->ready) {
+		SET_WAKEUP_ECHO(dmn);
+	} else {
+		/* the first echo is answered once the daemon is through
+		 * its startup, don't wait a whole period for it
+		 */
+		EVENT_OFF(dmn->t_wakeup);
+		event_add_timer_msec(master, wakeup_send_echo, dmn, 0,
+				     &dmn->t_wakeup);
+	}
 	phase_check();
 }
 
@@ -880,6 +929,66 @@ static void set_phase(enum restart_phase new_phase)
 			&gs.t_phase_hanging);
 }
 
+static bool daemon_deps_ready(const struct daemon *dmn)
+{
+	int i;
+
+	for (i = 0; i < dmn->numdeps; i++)
+		if (!dmn->deps[i]->ready)
+			return false;
+	return true;
+}
+
+static const char *boot_time_str(long msec, char *buf, size_t size)
+{
+	if (msec < 0)
+		return "-";
+	snprintf(buf, size, "%ld.%03lds", msec / 1000, msec % 1000);
+	return buf;
+}
+
+/*
+ * When starting from scratch, start every daemon whose dependencies are all
+ * ready; independent ones go in parallel.  Once everything is ready, log
+ * where the time went.
+ */
+static void boot_check(void)
+{
+	struct daemon *dmn;
+	bool pending = false;
+	char b1[32], b2[32], b3[32];
+
+	if (gs.booting) {
+		for (dmn = gs.daemons; dmn; dmn = dmn->next) {
+			if (dmn->boot_start >= 0)
+				continue;
+			if (!daemon_deps_ready(dmn)) {
+				pending = true;
+				continue;
+			}
+			dmn->boot_start = monotime_since(&gs.boot, NULL) / 1000;
+			run_job(&dmn->restart, "start", gs.start_command, 1, 0);
+		}
+		gs.booting = pending;
+	}
+
+	if (gs.boot_reported)
+		return;
+	for (dmn = gs.daemons; dmn; dmn = dmn->next)
+		if (!dmn->ready)
+			return;
+
+	gs.boot_reported = true;
+	gs.boot_done = monotime_since(&gs.boot, NULL) / 1000;
+	zlog_notice("all daemons ready after %s",
+		    boot_time_str(gs.boot_done, b1, sizeof(b1)));
+	for (dmn = gs.daemons; dmn; dmn = dmn->next)
+		zlog_info("%s startup: started %s, up %s, ready %s", dmn->name,
+			  boot_time_str(dmn->boot_start, b1, sizeof(b1)),
+			  boot_time_str(dmn->boot_up, b2, sizeof(b2)),
+			  boot_time_str(dmn->boot_ready, b3, sizeof(b3)));
+}
+
 static void phase_check(void)
 {
 	struct daemon *dmn;
@@ -895,11 +1004,20 @@ static void phase_check(void)
 
 		/* startup complete, everything out of INIT */
 		gs.phase = PHASE_NONE;
+
+		/* nothing running at all: rather than one global restart that
+		 * brings the daemons up one after the other, start them along
+		 * their dependencies
+		 */
+		if (!watch_only && gs.numdown == gs.numdaemons)
+			gs.booting = true;
+
 		for (dmn = gs.daemons; dmn; dmn = dmn->next)
 			if (dmn->state == DAEMON_DOWN) {
 				SET_WAKEUP_DOWN(dmn);
 				try_restart(dmn);
 			}
+		boot_check();
 		break;
 	case PHASE_STOPS_PENDING:
 		if (gs.numpids)
@@ -949,6 +1067,10 @@ static void try_restart(struct daemon *dmn)
 	if (watch_only)
 		return;
 
+	/* still starting from scratch, boot_check() takes care of it */
+	if (gs.booting)
+		return;
+
 	if (dmn != gs.special) {
 		if ((gs.special->state == DAEMON_UP)
 		    && (gs.phase == PHASE_NONE))
@@ -1050,6 +1172,8 @@ void watchfrr_status(struct vty *vty)
 {
 	struct daemon *dmn;
 	struct timeval delay;
+	char b1[32], b2[32], b3[32];
+	int i;
 
 	vty_out(vty, "watchfrr global phase: %s\n", phase_str[gs.phase]);
 	vty_out(vty, " Restart Command: %pSQq\n", gs.restart_command);
@@ -1064,9 +1188,26 @@ void watchfrr_status(struct vty *vty)
 		vty_out(vty, "    global restart running, pid %ld\n",
 			(long)gs.restart.pid);
 
+	if (gs.boot_reported)
+		vty_out(vty, " Startup: all daemons ready after %s\n",
+			boot_time_str(gs.boot_done, b1, sizeof(b1)));
+	else
+		vty_out(vty, " Startup: %s\n",
+			gs.booting ? "starting daemons" : "in progress");
+
 	for (dmn = gs.daemons; dmn; dmn = dmn->next) {
 		vty_out(vty, "  %-20s %s%s", dmn->name, state_str[dmn->state],
 			dmn->ignore_timeout ? "/Ignoring Timeout\n" : "\n");
+		if (dmn->numdeps) {
+			vty_out(vty, "      depends on:");
+			for (i = 0; i < dmn->numdeps; i++)
+				vty_out(vty, " %s", dmn->deps[i]->name);
+			vty_out(vty, "\n");
+		}
+		vty_out(vty, "      startup: started %s, up %s, ready %s\n",
+			boot_time_str(dmn->boot_start, b1, sizeof(b1)),
+			boot_time_str(dmn->boot_up, b2, sizeof(b2)),
+			boot_time_str(dmn->boot_ready, b3, sizeof(b3)));
 		if (dmn->restart.pid)
 			vty_out(vty, "      restart running, pid %ld\n",
 				(long)dmn->restart.pid);
@@ -1120,6 +1261,8 @@ static char *translate_blanks(const char *cmd, const char *blankstr)
 
 static void startup_timeout(struct event *t_wakeup)
 {
+	/* whatever couldn't be started yet goes through the usual restart */
+	gs.booting = false;
 	daemon_send_ready(1);
 }
 
@@ -1275,6 +1418,104 @@ static void watchfrr_end_config(void)
 	gs.reading_configuration = false;
 }
 
+static struct daemon *daemon_find(const char *name)
+{
+	struct daemon *dmn;
+
+	for (dmn = gs.daemons; dmn; dmn = dmn->next)
+		if (!strcmp(dmn->name, name))
+			return dmn;
+	return NULL;
+}
+
+static void daemon_add_dep(struct daemon *dmn, struct daemon *dep)
+{
+	int i;
+
+	if (!dmn->deps)
+		dmn->deps = XCALLOC(MTYPE_WATCHFRR_DAEMON,
+				    gs.numdaemons * sizeof(dmn->deps[0]));
+	if (!dep || dep == dmn)
+		return;
+	for (i = 0; i < dmn->numdeps; i++)
+		if (dmn->deps[i] == dep)
+			return;
+	dmn->deps[dmn->numdeps++] = dep;
+}
+
+/* "DAEMON:DEP,DEP,..." replaces the default dependencies of DAEMON */
+static void watchfrr_depends_parse(const char *arg)
+{
+	char *str = XSTRDUP(MTYPE_TMP, arg);
+	char *deps, *name, *save = NULL;
+	struct daemon *dmn, *dep;
+
+	deps = strchr(str, ':');
+	if (deps)
+		*deps++ = '\0';
+	dmn = daemon_find(str);
+	if (!deps || !dmn) {
+		fprintf(stderr, "Invalid --depends argument: %s\n\n", arg);
+		frr_help_exit(1);
+	}
+
+	dmn->numdeps = 0;
+	daemon_add_dep(dmn, NULL);
+	for (name = strtok_r(deps, ",", &save); name;
+	     name = strtok_r(NULL, ",", &save)) {
+		dep = daemon_find(name);
+		if (!dep) {
+			fprintf(stderr,
+				"--depends %s: \"%s\" is not in the daemon list\n\n",
+				arg, name);
+			frr_help_exit(1);
+		}
+		daemon_add_dep(dmn, dep);
+	}
+	XFREE(MTYPE_TMP, str);
+}
+
+static void watchfrr_depends_init(void)
+{
+	struct daemon *dmn, *mgmtd = daemon_find("mgmtd");
+	bool progress;
+	int i;
+
+	for (i = 0; i < gs.numdepends; i++)
+		watchfrr_depends_parse(gs.depends[i]);
+
+	/* zebra first, then mgmtd which holds the config of its backends */
+	for (dmn = gs.daemons; dmn; dmn = dmn->next) {
+		if (dmn->deps || dmn == gs.special)
+			continue;
+		daemon_add_dep(dmn, gs.special);
+		if (dmn != mgmtd)
+			daemon_add_dep(dmn, mgmtd);
+	}
+
+	/* a loop would hold its daemons back until the startup timeout,
+	 * walk the graph once with ->ready standing in for "resolved"
+	 */
+	do {
+		progress = false;
+		for (dmn = gs.daemons; dmn; dmn = dmn->next)
+			if (!dmn->ready && daemon_deps_ready(dmn)) {
+				dmn->ready = true;
+				progress = true;
+			}
+	} while (progress);
+
+	for (dmn = gs.daemons; dmn; dmn = dmn->next)
+		if (!dmn->ready) {
+			fprintf(stderr,
+				"Daemon dependency loop involving %s\n\n",
+				dmn->name);
+			frr_help_exit(1);
+		}
+	for (dmn = gs.daemons; dmn; dmn = dmn->next)
+		dmn->ready = false;
+}
+
 static void watchfrr_init(int argc, char **argv)
 {
 	const char *special = "zebra";
@@ -1282,6 +1523,7 @@ static void watchfrr_init(int argc, char **argv)
 	struct daemon *dmn, **add = &gs.daemons;
 	char alldaemons[512] = "", *p = alldaemons;
 
+	monotime(&gs.boot);
 	event_add_timer_msec(master, startup_timeout, NULL, STARTUP_TIMEOUT,
 			     &gs.t_startup_timeout);
 
@@ -1293,6 +1535,7 @@ static void watchfrr_init(int argc, char **argv)
 		gs.numdaemons++;
 		gs.numdown++;
 		dmn->fd = -1;
+		dmn->boot_start = dmn->boot_up = dmn->boot_ready = -1;
 		event_add_timer_msec(master, wakeup_init, dmn, 0,
 				     &dmn->t_wakeup);
 		dmn->restart.interval = gs.min_restart_interval;
@@ -1313,6 +1556,7 @@ static void watchfrr_init(int argc, char **argv)
 			special);
 		frr_help_exit(1);
 	}
+	watchfrr_depends_init();
 
 	for (dmn = gs.daemons; dmn; dmn = dmn->next) {
 		snprintf(p, alldaemons + sizeof(alldaemons) - p, "%s%s",
@@ -1447,6 +1691,12 @@ int main(int argc, char **argv)
 				frr_help_exit(1);
 			}
 		} break;
+		case OPTION_DEPENDS:
+			if (!gs.depends)
+				gs.depends = XCALLOC(MTYPE_WATCHFRR_DAEMON,
+						     argc * sizeof(char *));
+			gs.depends[gs.numdepends++] = optarg;
+			break;
 		case OPTION_NETNS:
 			netns_en = true;
 			if (optarg && strchr(optarg, '/')) {
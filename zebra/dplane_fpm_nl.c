@@ -57,6 +57,26 @@
  */
 #define FPM_HEADER_SIZE 4
 
+/*
+ * The output buffer starts at FPM_OBUF_SIZE and doubles when a message does
+ * not fit, up to FPM_OBUF_MAX_SIZE, so that a burst of updates does not have
+ * to wait in the context queue while the server catches up. It goes back to
+ * its initial size once drained.
+ */
+#define FPM_OBUF_SIZE (NL_PKT_BUF_SIZE * 128)
+#define FPM_OBUF_MAX_SIZE (FPM_OBUF_SIZE * 32)
+
+/*
+ * With incremental resync every message written to the server also goes
+ * into a journal and is stamped with a generation number (in nlmsg_seq, with
+ * the journal id in nlmsg_pid). A reconnecting server sends a RTM_GETROUTE
+ * request carrying the last generation it applied and only the newer
+ * messages get replayed. When the journal no longer covers that generation
+ * (or the server doesn't ask in time) we fall back to the full table walk.
+ */
+#define FPM_JOURNAL_SIZE (FPM_OBUF_MAX_SIZE / 2)
+#define FPM_RESUME_TIMEOUT 3
+
 static const char *prov_name = "dplane_fpm_nl";
 
 struct fpm_nl_ctx {
@@ -65,6 +85,8 @@ struct fpm_nl_ctx {
 	bool disabled;
 	bool connecting;
 	bool use_nhg;
+	bool incremental;
+	bool resume_pending;
 	struct sockaddr_storage addr;
 
 	/* data plane buffers. */
@@ -72,6 +94,15 @@ struct fpm_nl_ctx {
 	struct stream *obuf;
 	pthread_mutex_t obuf_mutex;
 
+	/* incremental resync journal, protected by obuf_mutex. */
+	struct stream *journal;
+	uint32_t journal_id;
+	uint32_t journal_next_gen;
+	uint32_t journal_frames;
+
+	/* monotime of the last counters reset, for throughput */
+	struct timeval counters_start;
+
 	/*
 	 * data plane context queue:
 	 * When a FPM server connection becomes a bottleneck, we must keep the
@@ -88,6 +119,8 @@ struct fpm_nl_ctx {
 	struct event *t_write;
 	struct event *t_event;
 	struct event *t_nhg;
+	struct event *t_incremental;
+	struct event *t_resume;
 	struct event *t_dequeue;
 
 	/* zebra events. */
@@ -110,6 +143,10 @@ struct fpm_nl_ctx {
 		_Atomic uint32_t obuf_bytes;
 		/* Output buffer peak usage. */
 		_Atomic uint32_t obuf_peak;
+		/* Output buffer current allocation. */
+		_Atomic uint32_t obuf_size;
+		/* Amount of output buffer size changes. */
+		_Atomic uint32_t obuf_resizes;
 
 		/* Amount of connection closes. */
 		_Atomic uint32_t connection_closes;
@@ -130,6 +167,15 @@ struct fpm_nl_ctx {
 
 		/* Amount of buffer full events. */
 		_Atomic uint32_t buffer_full;
+
+		/* Amount of full table replays. */
+		_Atomic uint32_t full_resyncs;
+		/* Amount of resumes served from the journal. */
+		_Atomic uint32_t incremental_resyncs;
+		/* Amount of messages replayed from the journal. */
+		_Atomic uint32_t journal_replayed;
+		/* Amount of messages dropped from the journal. */
+		_Atomic uint32_t journal_drops;
 	} counters;
 } *gfnc;
 
@@ -142,6 +188,8 @@ enum fpm_nl_events {
 	FNE_RESET_COUNTERS,
 	/* Toggle next hop group feature. */
 	FNE_TOGGLE_NHG,
+	/* Toggle incremental resync feature. */
+	FNE_TOGGLE_INCREMENTAL,
 	/* Reconnect request by our own code to avoid races. */
 	FNE_INTERNAL_RECONNECT,
 
@@ -282,6 +330,37 @@ DEFUN(no_fpm_use_nhg, no_fpm_use_nhg_cmd,
 	return CMD_SUCCESS;
 }
 
+DEFUN(fpm_incremental_resync, fpm_incremental_resync_cmd,
+      "fpm incremental-resync",
+      FPM_STR
+      "Only replay the changes the server missed when it reconnects.\n")
+{
+	/* Already enabled. */
+	if (gfnc->incremental)
+		return CMD_SUCCESS;
+
+	event_add_event(gfnc->fthread->master, fpm_process_event, gfnc,
+			FNE_TOGGLE_INCREMENTAL, &gfnc->t_incremental);
+
+	return CMD_SUCCESS;
+}
+
+DEFUN(no_fpm_incremental_resync, no_fpm_incremental_resync_cmd,
+      "no fpm incremental-resync",
+      NO_STR
+      FPM_STR
+      "Only replay the changes the server missed when it reconnects.\n")
+{
+	/* Already disabled. */
+	if (!gfnc->incremental)
+		return CMD_SUCCESS;
+
+	event_add_event(gfnc->fthread->master, fpm_process_event, gfnc,
+			FNE_TOGGLE_INCREMENTAL, &gfnc->t_incremental);
+
+	return CMD_SUCCESS;
+}
+
 DEFUN(fpm_reset_counters, fpm_reset_counters_cmd,
       "clear fpm counters",
       CLEAR_STR
@@ -299,6 +378,8 @@ DEFUN(fpm_show_counters, fpm_show_counters_cmd,
       FPM_STR
       "FPM statistic counters\n")
 {
+	int64_t usec = monotime_since(&gfnc->counters_start, NULL);
+
 	vty_out(vty, "%30s\n%30s\n", "FPM counters", "============");
 
 #define SHOW_COUNTER(label, counter) \
@@ -308,6 +389,11 @@ DEFUN(fpm_show_counters, fpm_show_counters_cmd,
 	SHOW_COUNTER("Output bytes", gfnc->counters.bytes_sent);
 	SHOW_COUNTER("Output buffer current size", gfnc->counters.obuf_bytes);
 	SHOW_COUNTER("Output buffer peak size", gfnc->counters.obuf_peak);
+	SHOW_COUNTER("Output buffer allocated", gfnc->counters.obuf_size);
+	SHOW_COUNTER("Output buffer resizes", gfnc->counters.obuf_resizes);
+	vty_out(vty, "%28s: %" PRIu64 "\n", "Output bytes per second",
+		usec > 0 ? (uint64_t)gfnc->counters.bytes_sent * 1000000 / usec
+			 : 0);
 	SHOW_COUNTER("Connection closes", gfnc->counters.connection_closes);
 	SHOW_COUNTER("Connection errors", gfnc->counters.connection_errors);
 	SHOW_COUNTER("Data plane items processed",
@@ -319,6 +405,11 @@ DEFUN(fpm_show_counters, fpm_show_counters_cmd,
 	SHOW_COUNTER("Buffer full hits", gfnc->counters.buffer_full);
 	SHOW_COUNTER("User FPM configurations", gfnc->counters.user_configures);
 	SHOW_COUNTER("User FPM disable requests", gfnc->counters.user_disables);
+	SHOW_COUNTER("Full resyncs", gfnc->counters.full_resyncs);
+	SHOW_COUNTER("Incremental resyncs", gfnc->counters.incremental_resyncs);
+	SHOW_COUNTER("Journal replayed messages",
+		     gfnc->counters.journal_replayed);
+	SHOW_COUNTER("Journal dropped messages", gfnc->counters.journal_drops);
 
 #undef SHOW_COUNTER
 
@@ -333,12 +424,19 @@ DEFUN(fpm_show_counters_json, fpm_show_counters_json_cmd,
       JSON_STR)
 {
 	struct json_object *jo;
+	int64_t usec = monotime_since(&gfnc->counters_start, NULL);
 
 	jo = json_object_new_object();
 	json_object_int_add(jo, "bytes-read", gfnc->counters.bytes_read);
 	json_object_int_add(jo, "bytes-sent", gfnc->counters.bytes_sent);
 	json_object_int_add(jo, "obuf-bytes", gfnc->counters.obuf_bytes);
 	json_object_int_add(jo, "obuf-bytes-peak", gfnc->counters.obuf_peak);
+	json_object_int_add(jo, "obuf-size", gfnc->counters.obuf_size);
+	json_object_int_add(jo, "obuf-resizes", gfnc->counters.obuf_resizes);
+	json_object_int_add(jo, "bytes-sent-per-second",
+			    usec > 0 ? (uint64_t)gfnc->counters.bytes_sent *
+					       1000000 / usec
+				     : 0);
 	json_object_int_add(jo, "connection-closes",
 			    gfnc->counters.connection_closes);
 	json_object_int_add(jo, "connection-errors",
@@ -353,6 +451,12 @@ DEFUN(fpm_show_counters_json, fpm_show_counters_json_cmd,
 	json_object_int_add(jo, "user-configures",
 			    gfnc->counters.user_configures);
 	json_object_int_add(jo, "user-disables", gfnc->counters.user_disables);
+	json_object_int_add(jo, "full-resyncs", gfnc->counters.full_resyncs);
+	json_object_int_add(jo, "incremental-resyncs",
+			    gfnc->counters.incremental_resyncs);
+	json_object_int_add(jo, "journal-replayed",
+			    gfnc->counters.journal_replayed);
+	json_object_int_add(jo, "journal-drops", gfnc->counters.journal_drops);
 	vty_json(vty, jo);
 
 	return CMD_SUCCESS;
@@ -396,6 +500,11 @@ static int fpm_write_config(struct vty *vty)
 		written = 1;
 	}
 
+	if (gfnc->incremental) {
+		vty_out(vty, "fpm incremental-resync\n");
+		written = 1;
+	}
+
 	return written;
 }
 
@@ -410,6 +519,238 @@ static struct cmd_node fpm_node = {
  * FPM functions.
  */
 static void fpm_connect(struct event *t);
+static void fpm_write(struct event *t);
+
+/* Both with fnc->obuf_mutex held. */
+static bool fpm_obuf_grow(struct fpm_nl_ctx *fnc, size_t need)
+{
+	size_t size = STREAM_SIZE(fnc->obuf);
+
+	if (size >= FPM_OBUF_MAX_SIZE)
+		return false;
+
+	while (size < FPM_OBUF_MAX_SIZE &&
+	       size - stream_get_endp(fnc->obuf) < need)
+		size *= 2;
+	size = MIN(size, FPM_OBUF_MAX_SIZE);
+	if (size - stream_get_endp(fnc->obuf) < need)
+		return false;
+
+	stream_resize_inplace(&fnc->obuf, size);
+	atomic_store_explicit(&fnc->counters.obuf_size, size,
+			      memory_order_relaxed);
+	atomic_fetch_add_explicit(&fnc->counters.obuf_resizes, 1,
+				  memory_order_relaxed);
+
+	if (IS_ZEBRA_DEBUG_FPM)
+		zlog_debug("%s: output buffer grown to %zu bytes", __func__,
+			   size);
+
+	return true;
+}
+
+static void fpm_obuf_shrink(struct fpm_nl_ctx *fnc)
+{
+	if (STREAM_SIZE(fnc->obuf) <= FPM_OBUF_SIZE ||
+	    STREAM_READABLE(fnc->obuf))
+		return;
+
+	stream_reset(fnc->obuf);
+	stream_resize_inplace(&fnc->obuf, FPM_OBUF_SIZE);
+	atomic_store_explicit(&fnc->counters.obuf_size, FPM_OBUF_SIZE,
+			      memory_order_relaxed);
+	atomic_fetch_add_explicit(&fnc->counters.obuf_resizes, 1,
+				  memory_order_relaxed);
+}
+
+/* Whether at least a full netlink message can be queued right now. */
+static bool fpm_obuf_has_room(struct fpm_nl_ctx *fnc)
+{
+	frr_with_mutex (&fnc->obuf_mutex) {
+		if (STREAM_WRITEABLE(fnc->obuf) >= NL_PKT_BUF_SIZE ||
+		    STREAM_SIZE(fnc->obuf) < FPM_OBUF_MAX_SIZE)
+			return true;
+	}
+
+	return false;
+}
+
+/* All the journal functions run with fnc->obuf_mutex held. */
+static void fpm_journal_reset(struct fpm_nl_ctx *fnc)
+{
+	stream_reset(fnc->journal);
+	fnc->journal_id = frr_weak_random();
+	fnc->journal_next_gen = 1;
+	fnc->journal_frames = 0;
+}
+
+static void fpm_journal_drop(struct fpm_nl_ctx *fnc)
+{
+	struct stream *s = fnc->journal;
+	size_t flen;
+
+	/* Drop the oldest quarter at once so the copy down is amortized. */
+	while (STREAM_READABLE(s) &&
+	       stream_get_getp(s) < STREAM_SIZE(s) / 4) {
+		flen = (s->data[s->getp + 2] << 8) | s->data[s->getp + 3];
+		stream_forward_getp(s, flen);
+		fnc->journal_frames--;
+		atomic_fetch_add_explicit(&fnc->counters.journal_drops, 1,
+					  memory_order_relaxed);
+	}
+
+	stream_pulldown(s);
+}
+
+/*
+ * Stamp the netlink messages in `nl_buf` with the next generation and keep
+ * a copy of the resulting FPM frame.
+ */
+static void fpm_journal_add(struct fpm_nl_ctx *fnc, uint8_t *nl_buf,
+			    size_t nl_buf_len)
+{
+	struct nlmsghdr *nlh;
+	unsigned int len = nl_buf_len;
+
+	if (fnc->journal_next_gen == UINT32_MAX)
+		fpm_journal_reset(fnc);
+
+	for (nlh = (struct nlmsghdr *)nl_buf; NLMSG_OK(nlh, len);
+	     nlh = NLMSG_NEXT(nlh, len)) {
+		nlh->nlmsg_seq = fnc->journal_next_gen;
+		nlh->nlmsg_pid = fnc->journal_id;
+	}
+
+	if (STREAM_WRITEABLE(fnc->journal) < nl_buf_len + FPM_HEADER_SIZE)
+		fpm_journal_drop(fnc);
+
+	stream_putc(fnc->journal, 1);
+	stream_putc(fnc->journal, 1);
+	stream_putw(fnc->journal, nl_buf_len + FPM_HEADER_SIZE);
+	stream_write(fnc->journal, nl_buf, nl_buf_len);
+
+	fnc->journal_next_gen++;
+	fnc->journal_frames++;
+}
+
+/*
+ * Copy every journaled frame newer than `gen` into the output buffer.
+ * Returns false if the journal doesn't go back that far.
+ */
+static bool fpm_journal_replay(struct fpm_nl_ctx *fnc, uint32_t gen)
+{
+	struct stream *s = fnc->journal;
+	uint32_t first_gen = fnc->journal_next_gen - fnc->journal_frames;
+	uint32_t skip, replay;
+	size_t pos, flen;
+
+	if (gen == 0 || gen + 1 < first_gen || gen >= fnc->journal_next_gen)
+		return false;
+
+	pos = stream_get_getp(s);
+	for (skip = gen + 1 - first_gen; skip > 0; skip--) {
+		flen = (s->data[pos + 2] << 8) | s->data[pos + 3];
+		pos += flen;
+	}
+
+	flen = stream_get_endp(s) - pos;
+	if (STREAM_WRITEABLE(fnc->obuf) < flen && !fpm_obuf_grow(fnc, flen))
+		return false;
+
+	replay = fnc->journal_next_gen - 1 - gen;
+	stream_write(fnc->obuf, &s->data[pos], flen);
+	atomic_fetch_add_explicit(&fnc->counters.obuf_bytes, flen,
+				  memory_order_relaxed);
+	atomic_fetch_add_explicit(&fnc->counters.journal_replayed, replay,
+				  memory_order_relaxed);
+
+	if (IS_ZEBRA_DEBUG_FPM)
+		zlog_debug("%s: replaying %u messages (%zu bytes) after generation %u",
+			   __func__, replay, flen, gen);
+
+	return true;
+}
+
+/* Replay everything, starting with the LSPs walk. */
+static void fpm_resync_full(struct fpm_nl_ctx *fnc)
+{
+	frr_with_mutex (&fnc->obuf_mutex) {
+		fnc->resume_pending = false;
+	}
+
+	atomic_fetch_add_explicit(&fnc->counters.full_resyncs, 1,
+				  memory_order_relaxed);
+
+	/*
+	 * Starting with LSPs walk all FPM objects, marking them
+	 * as unsent and then replaying them.
+	 */
+	event_add_timer(zrouter.master, fpm_lsp_reset, fnc, 0,
+			&fnc->t_lspreset);
+}
+
+static void fpm_resume_timeout(struct event *t)
+{
+	struct fpm_nl_ctx *fnc = EVENT_ARG(t);
+
+	if (IS_ZEBRA_DEBUG_FPM)
+		zlog_debug("%s: no resume request, doing a full resync",
+			   __func__);
+
+	fpm_resync_full(fnc);
+}
+
+/* Connection established: resync the server. */
+static void fpm_connected(struct fpm_nl_ctx *fnc)
+{
+	if (!fnc->incremental) {
+		fpm_resync_full(fnc);
+		return;
+	}
+
+	/* Hold the output until the server tells us what it has. */
+	frr_with_mutex (&fnc->obuf_mutex) {
+		fnc->resume_pending = true;
+	}
+
+	event_add_timer(fnc->fthread->master, fpm_resume_timeout, fnc,
+			FPM_RESUME_TIMEOUT, &fnc->t_resume);
+}
+
+/* Server resume request: RTM_GETROUTE with the last applied generation. */
+static void fpm_resume(struct fpm_nl_ctx *fnc, const struct nlmsghdr *hdr)
+{
+	bool replayed = false;
+
+	if (!fnc->resume_pending) {
+		if (IS_ZEBRA_DEBUG_FPM)
+			zlog_debug("%s: [seq=%u] unexpected resume request, ignoring",
+				   __func__, hdr->nlmsg_seq);
+		return;
+	}
+
+	EVENT_OFF(fnc->t_resume);
+
+	frr_with_mutex (&fnc->obuf_mutex) {
+		if (fnc->journal && hdr->nlmsg_pid == fnc->journal_id)
+			replayed = fpm_journal_replay(fnc, hdr->nlmsg_seq);
+		if (replayed)
+			fnc->resume_pending = false;
+	}
+
+	if (!replayed) {
+		if (IS_ZEBRA_DEBUG_FPM)
+			zlog_debug("%s: [seq=%u] generation not in the journal, doing a full resync",
+				   __func__, hdr->nlmsg_seq);
+		fpm_resync_full(fnc);
+		return;
+	}
+
+	atomic_fetch_add_explicit(&fnc->counters.incremental_resyncs, 1,
+				  memory_order_relaxed);
+	event_add_write(fnc->fthread->master, fpm_write, fnc, fnc->socket,
+			&fnc->t_write);
+}
 
 static void fpm_reconnect(struct fpm_nl_ctx *fnc)
 {
@@ -437,8 +778,11 @@ static void fpm_reconnect(struct fpm_nl_ctx *fnc)
 
 	stream_reset(fnc->ibuf);
 	stream_reset(fnc->obuf);
+	fpm_obuf_shrink(fnc);
+	fnc->resume_pending = false;
 	EVENT_OFF(fnc->t_read);
 	EVENT_OFF(fnc->t_write);
+	EVENT_OFF(fnc->t_resume);
 
 	/* FPM is disabled, don't attempt to connect. */
 	if (fnc->disabled)
@@ -598,6 +942,9 @@ static void fpm_read(struct event *t)
 				 */
 			}
 			break;
+		case RTM_GETROUTE:
+			fpm_resume(fnc, hdr);
+			break;
 		default:
 			if (IS_ZEBRA_DEBUG_FPM)
 				zlog_debug(
@@ -641,13 +988,7 @@ static void fpm_write(struct event *t)
 		}
 
 		fnc->connecting = false;
-
-		/*
-		 * Starting with LSPs walk all FPM objects, marking them
-		 * as unsent and then replaying them.
-		 */
-		event_add_timer(zrouter.master, fpm_lsp_reset, fnc, 0,
-				&fnc->t_lspreset);
+		fpm_connected(fnc);
 
 		/* Permit receiving messages now. */
 		event_add_read(fnc->fthread->master, fpm_read, fnc, fnc->socket,
@@ -660,6 +1001,7 @@ static void fpm_write(struct event *t)
 		/* Stream is empty: reset pointers and return. */
 		if (STREAM_READABLE(fnc->obuf) == 0) {
 			stream_reset(fnc->obuf);
+			fpm_obuf_shrink(fnc);
 			break;
 		}
 
@@ -766,15 +1108,9 @@ static void fpm_connect(struct event *t)
 	event_add_write(fnc->fthread->master, fpm_write, fnc, sock,
 			&fnc->t_write);
 
-	/*
-	 * Starting with LSPs walk all FPM objects, marking them
-	 * as unsent and then replaying them.
-	 *
-	 * If we are not connected, then delay the objects reset/send.
-	 */
+	/* If we are not connected, then delay the objects reset/send. */
 	if (!fnc->connecting)
-		event_add_timer(zrouter.master, fpm_lsp_reset, fnc, 0,
-				&fnc->t_lspreset);
+		fpm_connected(fnc);
 }
 
 /**
@@ -804,8 +1140,11 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 
 	nl_buf_len = 0;
 
-	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
-
+	/*
+	 * Encode without holding the output buffer lock: the zebra pthread
+	 * replaying the RIB and this provider's pthread can then encode in
+	 * parallel and only serialize on the copy into the buffer.
+	 */
 	switch (op) {
 	case DPLANE_OP_ROUTE_UPDATE:
 	case DPLANE_OP_ROUTE_DELETE:
@@ -944,8 +1283,21 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	/* We must know if someday a message goes beyond 65KiB. */
 	assert((nl_buf_len + FPM_HEADER_SIZE) <= UINT16_MAX);
 
+	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
+
+	/*
+	 * While disconnected or waiting for the server resume request the
+	 * messages only go into the journal.
+	 */
+	if (fnc->journal &&
+	    (fnc->socket == -1 || fnc->connecting || fnc->resume_pending)) {
+		fpm_journal_add(fnc, nl_buf, nl_buf_len);
+		return 0;
+	}
+
 	/* Check if we have enough buffer space. */
-	if (STREAM_WRITEABLE(fnc->obuf) < (nl_buf_len + FPM_HEADER_SIZE)) {
+	if (STREAM_WRITEABLE(fnc->obuf) < (nl_buf_len + FPM_HEADER_SIZE) &&
+	    !fpm_obuf_grow(fnc, nl_buf_len + FPM_HEADER_SIZE)) {
 		atomic_fetch_add_explicit(&fnc->counters.buffer_full, 1,
 					  memory_order_relaxed);
 
@@ -958,6 +1310,9 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 		return -1;
 	}
 
+	if (fnc->journal)
+		fpm_journal_add(fnc, nl_buf, nl_buf_len);
+
 	/*
 	 * Fill in the FPM header information.
 	 *
@@ -1335,7 +1690,7 @@ static void fpm_process_queue(struct event *t)
 
 	while (true) {
 		/* No space available yet. */
-		if (STREAM_WRITEABLE(fnc->obuf) < NL_PKT_BUF_SIZE) {
+		if (!fpm_obuf_has_room(fnc)) {
 			no_bufs = true;
 			break;
 		}
@@ -1353,7 +1708,7 @@ static void fpm_process_queue(struct event *t)
 		 * the output data in the STREAM_WRITEABLE
 		 * check above, so we can ignore the return
 		 */
-		if (fnc->socket != -1)
+		if (fnc->socket != -1 || fnc->incremental)
 			(void)fpm_nl_enqueue(fnc, ctx);
 
 		/* Account the processed entries. */
@@ -1414,12 +1769,40 @@ static void fpm_process_event(struct event *t)
 	case FNE_RESET_COUNTERS:
 		zlog_info("%s: manual FPM counters reset event", __func__);
 		memset(&fnc->counters, 0, sizeof(fnc->counters));
+		frr_with_mutex (&fnc->obuf_mutex) {
+			fnc->counters.obuf_size = STREAM_SIZE(fnc->obuf);
+		}
+		monotime(&fnc->counters_start);
 		break;
 
 	case FNE_TOGGLE_NHG:
 		zlog_info("%s: toggle next hop groups support", __func__);
 		fnc->use_nhg = !fnc->use_nhg;
 		fpm_reconnect(fnc);
+		/* Journaled messages were encoded the other way. */
+		frr_with_mutex (&fnc->obuf_mutex) {
+			if (fnc->journal)
+				fpm_journal_reset(fnc);
+		}
+		break;
+
+	case FNE_TOGGLE_INCREMENTAL:
+		zlog_info("%s: toggle incremental resync support", __func__);
+		frr_with_mutex (&fnc->obuf_mutex) {
+			fnc->incremental = !fnc->incremental;
+			if (fnc->incremental) {
+				fnc->journal = stream_new(FPM_JOURNAL_SIZE);
+				fpm_journal_reset(fnc);
+			} else {
+				stream_free(fnc->journal);
+				fnc->journal = NULL;
+			}
+		}
+		/* Don't keep the server waiting for a journal we dropped. */
+		if (!fnc->incremental && fnc->resume_pending) {
+			EVENT_OFF(fnc->t_resume);
+			fpm_resync_full(fnc);
+		}
 		break;
 
 	case FNE_INTERNAL_RECONNECT:
@@ -1457,7 +1840,9 @@ static int fpm_nl_start(struct zebra_dplane_provider *prov)
 	fnc->fthread = frr_pthread_new(NULL, prov_name, prov_name);
 	assert(frr_pthread_run(fnc->fthread, NULL) == 0);
 	fnc->ibuf = stream_new(NL_PKT_BUF_SIZE);
-	fnc->obuf = stream_new(NL_PKT_BUF_SIZE * 128);
+	fnc->obuf = stream_new(FPM_OBUF_SIZE);
+	fnc->counters.obuf_size = FPM_OBUF_SIZE;
+	monotime(&fnc->counters_start);
 	pthread_mutex_init(&fnc->obuf_mutex, NULL);
 	fnc->socket = -1;
 	fnc->disabled = true;
@@ -1484,6 +1869,8 @@ static int fpm_nl_finish_early(struct fpm_nl_ctx *fnc)
 	EVENT_OFF(fnc->t_rmacwalk);
 	EVENT_OFF(fnc->t_event);
 	EVENT_OFF(fnc->t_nhg);
+	EVENT_OFF(fnc->t_incremental);
+	event_cancel_async(fnc->fthread->master, &fnc->t_resume, NULL);
 	event_cancel_async(fnc->fthread->master, &fnc->t_read, NULL);
 	event_cancel_async(fnc->fthread->master, &fnc->t_write, NULL);
 	event_cancel_async(fnc->fthread->master, &fnc->t_connect, NULL);
@@ -1506,6 +1893,8 @@ static int fpm_nl_finish_late(struct fpm_nl_ctx *fnc)
 	pthread_mutex_destroy(&fnc->ctxqueue_mutex);
 	stream_free(fnc->ibuf);
 	stream_free(fnc->obuf);
+	if (fnc->journal)
+		stream_free(fnc->journal);
 	free(gfnc);
 	gfnc = NULL;
 
@@ -1539,9 +1928,11 @@ static int fpm_nl_process(struct zebra_dplane_provider *prov)
 
 		/*
 		 * Skip all notifications if not connected, we'll walk the RIB
-		 * anyway.
+		 * anyway. With incremental resync they still must make it
+		 * into the journal.
 		 */
-		if (fnc->socket != -1 && fnc->connecting == false) {
+		if ((fnc->socket != -1 && fnc->connecting == false) ||
+		    fnc->incremental) {
 			/*
 			 * Update the number of queued contexts *before*
 			 * enqueueing, to ensure counter consistency.
@@ -1607,6 +1998,8 @@ static int fpm_nl_new(struct event_loop *tm)
 	install_element(CONFIG_NODE, &no_fpm_set_address_cmd);
 	install_element(CONFIG_NODE, &fpm_use_nhg_cmd);
 	install_element(CONFIG_NODE, &no_fpm_use_nhg_cmd);
+	install_element(CONFIG_NODE, &fpm_incremental_resync_cmd);
+	install_element(CONFIG_NODE, &no_fpm_incremental_resync_cmd);
 
 	return 0;
 }
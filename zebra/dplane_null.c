@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Null dataplane provider for zebra.
+ *
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+/*
+ * Completes every update without programming anything, optionally after a
+ * fixed delay per update, so that the cost of zebra itself - RIB processing,
+ * the meta queue and the dataplane pipeline - can be measured without the
+ * kernel.  "show zebra dplane pipeline" displays where the time goes.
+ *
+ * Run zebra with '-M dplane_null' or '-M dplane_null:USEC' for a delay of
+ * USEC microseconds per update.  Nothing gets installed in the kernel, this
+ * is for benchmarking only.
+ */
+
+#include <zebra.h>
+
+#include "lib/libfrr.h"
+#include "lib/version.h"
+#include "zebra/debug.h"
+#include "zebra/zebra_dplane.h"
+
+#define NULL_LATENCY_MAX 1000000
+
+static struct zebra_dplane_provider *null_prov;
+static uint32_t null_latency;
+
+static int null_process(struct zebra_dplane_provider *prov)
+{
+	struct zebra_dplane_ctx *ctx;
+	struct timespec ts;
+	uint64_t usec;
+	int counter, limit;
+
+	limit = dplane_provider_get_work_limit(prov);
+
+	for (counter = 0; counter < limit; counter++) {
+		ctx = dplane_provider_dequeue_in_ctx(prov);
+		if (!ctx)
+			break;
+
+		dplane_ctx_set_skip_kernel(ctx);
+		dplane_ctx_set_status(ctx, ZEBRA_DPLANE_REQUEST_SUCCESS);
+		dplane_provider_enqueue_out_ctx(prov, ctx);
+	}
+
+	/* Like the kernel provider's synchronous netlink, the delay holds up
+	 * the dplane pthread rather than just the updates.
+	 */
+	if (counter && null_latency) {
+		usec = (uint64_t)counter * null_latency;
+		ts.tv_sec = usec / 1000000;
+		ts.tv_nsec = (usec % 1000000) * 1000;
+		while (nanosleep(&ts, &ts) < 0 && errno == EINTR)
+			;
+	}
+
+	/* Ensure dataplane thread is rescheduled if we hit the work limit */
+	if (counter >= limit)
+		dplane_provider_work_ready();
+
+	return 0;
+}
+
+static int null_init(struct event_loop *tm)
+{
+	int ret;
+
+	ret = dplane_provider_register("Null", DPLANE_PRIO_PRE_KERNEL,
+				       DPLANE_PROV_FLAGS_DEFAULT, NULL,
+				       null_process, NULL, NULL, &null_prov);
+	if (ret != 0) {
+		zlog_err("%s: unable to register the null dplane provider",
+			 __func__);
+		return 0;
+	}
+
+	zlog_warn("null dplane provider loaded (%u usec per update), nothing will be installed in the kernel",
+		  null_latency);
+	return 0;
+}
+
+static int null_module_init(void)
+{
+	const char *args = THIS_MODULE->load_args;
+	unsigned long val;
+	char *end;
+
+	if (args && *args) {
+		val = strtoul(args, &end, 10);
+		if (*end || val > NULL_LATENCY_MAX)
+			zlog_err("dplane_null: invalid latency \"%s\", expecting 0-%u usec",
+				 args, NULL_LATENCY_MAX);
+		else
+			null_latency = val;
+	}
+
+	hook_register(frr_late_init, null_init);
+	return 0;
+}
+
+FRR_MODULE_SETUP(
+	.name = "dplane_null",
+	.version = FRR_VERSION,
+	.description = "Null dataplane provider for benchmarking",
+	.init = null_module_init,
+);
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Free ranges of numeric identifiers (labels, table IDs)
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#include <zebra.h>
+
+#include "zebra/id_ranges.h"
+
+struct id_range {
+	uint32_t start;
+	uint32_t end;
+
+	struct id_ranges_start_item start_item;
+	struct id_ranges_size_item size_item;
+};
+
+static int id_range_start_cmp(const struct id_range *a,
+			      const struct id_range *b)
+{
+	return numcmp(a->start, b->start);
+}
+
+/* end - start rather than the size, which doesn't fit for [0, UINT32_MAX] */
+static int id_range_size_cmp(const struct id_range *a,
+			     const struct id_range *b)
+{
+	if (a->end - a->start != b->end - b->start)
+		return numcmp(a->end - a->start, b->end - b->start);
+	return numcmp(a->start, b->start);
+}
+
+DECLARE_RBTREE_UNIQ(id_ranges_start, struct id_range, start_item,
+		    id_range_start_cmp);
+DECLARE_RBTREE_UNIQ(id_ranges_size, struct id_range, size_item,
+		    id_range_size_cmp);
+
+void id_ranges_init(struct id_ranges *ir, struct memtype *mt)
+{
+	id_ranges_start_init(&ir->by_start);
+	id_ranges_size_init(&ir->by_size);
+	ir->mt = mt;
+}
+
+void id_ranges_flush(struct id_ranges *ir)
+{
+	struct id_range *r;
+
+	while ((r = id_ranges_start_pop(&ir->by_start))) {
+		id_ranges_size_del(&ir->by_size, r);
+		XFREE(ir->mt, r);
+	}
+}
+
+void id_ranges_fini(struct id_ranges *ir)
+{
+	id_ranges_flush(ir);
+	id_ranges_start_fini(&ir->by_start);
+	id_ranges_size_fini(&ir->by_size);
+}
+
+size_t id_ranges_count(const struct id_ranges *ir)
+{
+	return id_ranges_start_count(&ir->by_start);
+}
+
+void id_ranges_release(struct id_ranges *ir, uint32_t start, uint32_t end)
+{
+	struct id_range ref = { .start = start };
+	struct id_range *prev, *next, *r;
+
+	prev = id_ranges_start_find_lt(&ir->by_start, &ref);
+	next = id_ranges_start_find_gteq(&ir->by_start, &ref);
+	if (prev && prev->end + 1 != start)
+		prev = NULL;
+	if (next && (end == UINT32_MAX || next->start != end + 1))
+		next = NULL;
+
+	if (prev && next) {
+		id_ranges_size_del(&ir->by_size, prev);
+		id_ranges_size_del(&ir->by_size, next);
+		id_ranges_start_del(&ir->by_start, next);
+		prev->end = next->end;
+		XFREE(ir->mt, next);
+		r = prev;
+	} else if (prev) {
+		id_ranges_size_del(&ir->by_size, prev);
+		prev->end = end;
+		r = prev;
+	} else if (next) {
+		/* ranges are disjoint, so moving the start down to the
+		 * previous free range's end doesn't change their order
+		 */
+		id_ranges_size_del(&ir->by_size, next);
+		next->start = start;
+		r = next;
+	} else {
+		r = XCALLOC(ir->mt, sizeof(*r));
+		r->start = start;
+		r->end = end;
+		id_ranges_start_add(&ir->by_start, r);
+	}
+	id_ranges_size_add(&ir->by_size, r);
+}
+
+/* cut [start, end] out of r, which covers it */
+static void id_range_take(struct id_ranges *ir, struct id_range *r,
+			  uint32_t start, uint32_t end)
+{
+	struct id_range *tail;
+
+	id_ranges_size_del(&ir->by_size, r);
+
+	if (start == r->start && end == r->end) {
+		id_ranges_start_del(&ir->by_start, r);
+		XFREE(ir->mt, r);
+		return;
+	}
+
+	if (start > r->start && end < r->end) {
+		tail = XCALLOC(ir->mt, sizeof(*tail));
+		tail->start = end + 1;
+		tail->end = r->end;
+		id_ranges_start_add(&ir->by_start, tail);
+		id_ranges_size_add(&ir->by_size, tail);
+		r->end = start - 1;
+	} else if (start > r->start) {
+		r->end = start - 1;
+	} else {
+		/* same as above, the order by start is kept */
+		r->start = end + 1;
+	}
+	id_ranges_size_add(&ir->by_size, r);
+}
+
+bool id_ranges_alloc(struct id_ranges *ir, uint32_t size, uint32_t *start)
+{
+	struct id_range ref = { .start = 0, .end = size - 1 };
+	struct id_range *r;
+
+	if (!size)
+		return false;
+
+	r = id_ranges_size_find_gteq(&ir->by_size, &ref);
+	if (!r)
+		return false;
+
+	*start = r->start;
+	id_range_take(ir, r, r->start, r->start + size - 1);
+	return true;
+}
+
+bool id_ranges_alloc_at(struct id_ranges *ir, uint32_t start, uint32_t end)
+{
+	struct id_range ref = { .start = start };
+	struct id_range *r;
+
+	if (end < start)
+		return false;
+
+	r = id_ranges_start_find_gteq(&ir->by_start, &ref);
+	if (!r || r->start != start)
+		r = id_ranges_start_find_lt(&ir->by_start, &ref);
+	if (!r || r->end < end)
+		return false;
+
+	id_range_take(ir, r, start, end);
+	return true;
+}
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Free ranges of numeric identifiers (labels, table IDs)
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * The free space is kept as a set of disjoint ranges, indexed both by first
+ * identifier (to merge released ranges with their neighbours and to take a
+ * specific range) and by size (to find the smallest range that fits a
+ * request).  All operations are O(log n) in the number of free ranges.
+ */
+
+#ifndef _ZEBRA_ID_RANGES_H
+#define _ZEBRA_ID_RANGES_H
+
+#include <stdint.h>
+
+#include "lib/memory.h"
+#include "lib/typesafe.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+PREDECL_RBTREE_UNIQ(id_ranges_start);
+PREDECL_RBTREE_UNIQ(id_ranges_size);
+
+struct id_ranges {
+	struct id_ranges_start_head by_start;
+	struct id_ranges_size_head by_size;
+	struct memtype *mt;
+};
+
+/* ranges are allocated as mt, so they show up under their owner */
+extern void id_ranges_init(struct id_ranges *ir, struct memtype *mt);
+extern void id_ranges_fini(struct id_ranges *ir);
+/* drop all free ranges */
+extern void id_ranges_flush(struct id_ranges *ir);
+
+/*
+ * Return [start, end] to the free space.  It must not overlap any free
+ * range, i.e. it has to be something previously taken.
+ */
+extern void id_ranges_release(struct id_ranges *ir, uint32_t start,
+			      uint32_t end);
+
+/*
+ * Take size identifiers from the smallest free range that fits, from its
+ * low end.  Returns false if there is no such range.
+ */
+extern bool id_ranges_alloc(struct id_ranges *ir, uint32_t size,
+			    uint32_t *start);
+
+/* Take exactly [start, end], if it is entirely free */
+extern bool id_ranges_alloc_at(struct id_ranges *ir, uint32_t start,
+			       uint32_t end);
+
+extern size_t id_ranges_count(const struct id_ranges *ir);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ZEBRA_ID_RANGES_H */
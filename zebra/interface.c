@@ -708,8 +708,7 @@ static void if_delete_connected(struct interface *ifp)
 					 * (unconditionally). */
 					if (!CHECK_FLAG(ifc->conf,
 							ZEBRA_IFC_CONFIGURED)) {
-						listnode_delete(ifp->connected,
-								ifc);
+						connected_del(ifp, ifc);
 						connected_free(&ifc);
 					} else
 						last = node;
@@ -730,7 +729,7 @@ static void if_delete_connected(struct interface *ifp)
 			if (CHECK_FLAG(ifc->conf, ZEBRA_IFC_CONFIGURED))
 				last = node;
 			else {
-				listnode_delete(ifp->connected, ifc);
+				connected_del(ifp, ifc);
 				connected_free(&ifc);
 			}
 		} else {
@@ -1509,12 +1508,14 @@ void zebra_if_dplane_result(struct zebra_dplane_ctx *ctx)
 	switch (op) {
 	case DPLANE_OP_INTF_ADDR_ADD:
 	case DPLANE_OP_INTF_ADDR_DEL:
+		zrouter.if_stats.addr_events++;
 		zebra_if_addr_update_ctx(ctx, ifp);
 		break;
 
 	case DPLANE_OP_INTF_INSTALL:
 	case DPLANE_OP_INTF_UPDATE:
 	case DPLANE_OP_INTF_DELETE:
+		zrouter.if_stats.link_events++;
 		zebra_if_update_ctx(ctx, ifp);
 		break;
 
@@ -2948,6 +2949,61 @@ DEFUN (show_interface_desc_vrf_all,
 	return CMD_SUCCESS;
 }
 
+DEFPY (show_interface_events,
+       show_interface_events_cmd,
+       "show interface events [json$uj]",
+       SHOW_STR
+       "Interface status and configuration\n"
+       "Interface event and client update counters\n"
+       JSON_STR)
+{
+	struct vrf *vrf;
+	struct interface *ifp;
+	uint32_t total = 0, up = 0;
+	double per_msg = 0;
+
+	RB_FOREACH (vrf, vrf_id_head, &vrfs_by_id)
+		FOR_ALL_INTERFACES (vrf, ifp) {
+			total++;
+			if (if_is_operative(ifp))
+				up++;
+		}
+
+	if (zrouter.if_stats.bulk_msgs)
+		per_msg = (double)zrouter.if_stats.state_updates /
+			  zrouter.if_stats.bulk_msgs;
+
+	if (uj) {
+		json_object *json = json_object_new_object();
+
+		json_object_int_add(json, "interfaces", total);
+		json_object_int_add(json, "interfacesUp", up);
+		json_object_int_add(json, "linkEvents",
+				    zrouter.if_stats.link_events);
+		json_object_int_add(json, "addressEvents",
+				    zrouter.if_stats.addr_events);
+		json_object_int_add(json, "clientStateUpdates",
+				    zrouter.if_stats.state_updates);
+		json_object_int_add(json, "clientBulkMessages",
+				    zrouter.if_stats.bulk_msgs);
+		json_object_int_add(json, "clientBulkMax",
+				    zrouter.if_stats.bulk_max);
+		vty_json(vty, json);
+		return CMD_SUCCESS;
+	}
+
+	vty_out(vty, "Interfaces: %u, %u up\n", total, up);
+	vty_out(vty, "Kernel events: %" PRIu64 " link, %" PRIu64 " address\n",
+		zrouter.if_stats.link_events, zrouter.if_stats.addr_events);
+	vty_out(vty,
+		"Client state updates: %" PRIu64 " in %" PRIu64
+		" bulk messages (%.1f per message, largest %u)\n",
+		zrouter.if_stats.state_updates, zrouter.if_stats.bulk_msgs,
+		per_msg, zrouter.if_stats.bulk_max);
+
+	return CMD_SUCCESS;
+}
+
 int if_multicast_set(struct interface *ifp)
 {
 	struct zebra_if *if_data;
@@ -4152,7 +4208,7 @@ int if_ip_address_install(struct interface *ifp, struct prefix *prefix,
 			ifc->label = XSTRDUP(MTYPE_CONNECTED_LABEL, label);
 
 		/* Add to linked list. */
-		listnode_add(ifp->connected, ifc);
+		connected_add(ifp, ifc);
 	}
 
 	/* This address is configured from zebra. */
@@ -4247,7 +4303,7 @@ static int ip_address_install(struct vty *vty, struct interface *ifp,
 			ifc->label = XSTRDUP(MTYPE_CONNECTED_LABEL, label);
 
 		/* Add to linked list. */
-		listnode_add(ifp->connected, ifc);
+		connected_add(ifp, ifc);
 	}
 
 	/* This address is configured from zebra. */
@@ -4309,7 +4365,7 @@ int if_ip_address_uinstall(struct interface *ifp, struct prefix *prefix)
 	/* This is not real address or interface is not active. */
 	if (!CHECK_FLAG(ifc->conf, ZEBRA_IFC_QUEUED)
 	    || !CHECK_FLAG(ifp->status, ZEBRA_INTERFACE_ACTIVE)) {
-		listnode_delete(ifp->connected, ifc);
+		connected_del(ifp, ifc);
 		connected_free(&ifc);
 		return CMD_WARNING_CONFIG_FAILED;
 	}
@@ -4372,7 +4428,7 @@ static int ip_address_uninstall(struct vty *vty, struct interface *ifp,
 	/* This is not real address or interface is not active. */
 	if (!CHECK_FLAG(ifc->conf, ZEBRA_IFC_QUEUED)
 	    || !CHECK_FLAG(ifp->status, ZEBRA_INTERFACE_ACTIVE)) {
-		listnode_delete(ifp->connected, ifc);
+		connected_del(ifp, ifc);
 		connected_free(&ifc);
 		return CMD_WARNING_CONFIG_FAILED;
 	}
@@ -4510,7 +4566,7 @@ int if_ipv6_address_install(struct interface *ifp, struct prefix *prefix,
 			ifc->label = XSTRDUP(MTYPE_CONNECTED_LABEL, label);
 
 		/* Add to linked list. */
-		listnode_add(ifp->connected, ifc);
+		connected_add(ifp, ifc);
 	}
 
 	/* This address is configured from zebra. */
@@ -4583,7 +4639,7 @@ static int ipv6_address_install(struct vty *vty, struct interface *ifp,
 			ifc->label = XSTRDUP(MTYPE_CONNECTED_LABEL, label);
 
 		/* Add to linked list. */
-		listnode_add(ifp->connected, ifc);
+		connected_add(ifp, ifc);
 	}
 
 	/* This address is configured from zebra. */
@@ -4662,7 +4718,7 @@ static int ipv6_address_uninstall(struct vty *vty, struct interface *ifp,
 	/* This is not real address or interface is not active. */
 	if (!CHECK_FLAG(ifc->conf, ZEBRA_IFC_QUEUED)
 	    || !CHECK_FLAG(ifp->status, ZEBRA_INTERFACE_ACTIVE)) {
-		listnode_delete(ifp->connected, ifc);
+		connected_del(ifp, ifc);
 		connected_free(&ifc);
 		return CMD_WARNING_CONFIG_FAILED;
 	}
@@ -4880,6 +4936,7 @@ void zebra_if_init(void)
 
 	install_element(ENABLE_NODE, &show_interface_desc_cmd);
 	install_element(ENABLE_NODE, &show_interface_desc_vrf_all_cmd);
+	install_element(VIEW_NODE, &show_interface_events_cmd);
 	install_element(INTERFACE_NODE, &multicast_cmd);
 	install_element(INTERFACE_NODE, &no_multicast_cmd);
 	install_element(INTERFACE_NODE, &mpls_cmd);
@@ -76,6 +76,15 @@
  */
 #define NL_DEFAULT_BATCH_SEND_THRESHOLD (15 * NL_PKT_BUF_SIZE)
 
+/*
+ * With adaptive batching the send threshold follows the time the kernel takes
+ * to process and acknowledge a batch, aiming at the configured target
+ * latency. The buffer is grown so that the threshold has room to go up when
+ * the kernel keeps up.
+ */
+#define NL_ADAPTIVE_BATCH_BUFSIZE (128 * NL_PKT_BUF_SIZE)
+#define NL_DEFAULT_BATCH_TARGET_USEC 2000
+
 static const struct message nlmsg_str[] = {{RTM_NEWROUTE, "RTM_NEWROUTE"},
 					   {RTM_DELROUTE, "RTM_DELROUTE"},
 					   {RTM_GETROUTE, "RTM_GETROUTE"},
@@ -179,10 +188,14 @@ char *nl_batch_tx_buf;
 _Atomic uint32_t nl_batch_bufsize = NL_DEFAULT_BATCH_BUFSIZE;
 _Atomic uint32_t nl_batch_send_threshold = NL_DEFAULT_BATCH_SEND_THRESHOLD;
 
+/* target batch latency in microseconds, 0 if adaptive batching is off */
+_Atomic uint32_t nl_batch_target_usec;
+
 struct nl_batch {
 	void *buf;
 	size_t bufsiz;
 	size_t limit;
+	uint32_t target_usec;
 
 	void *buf_head;
 	size_t curlen;
@@ -205,12 +218,20 @@ int netlink_config_write_helper(struct vty *vty)
 		atomic_load_explicit(&nl_batch_bufsize, memory_order_relaxed);
 	uint32_t threshold = atomic_load_explicit(&nl_batch_send_threshold,
 						  memory_order_relaxed);
+	uint32_t target = atomic_load_explicit(&nl_batch_target_usec,
+					       memory_order_relaxed);
 
 	if (size != NL_DEFAULT_BATCH_BUFSIZE
 	    || threshold != NL_DEFAULT_BATCH_SEND_THRESHOLD)
 		vty_out(vty, "zebra kernel netlink batch-tx-buf %u %u\n", size,
 			threshold);
 
+	if (target == NL_DEFAULT_BATCH_TARGET_USEC)
+		vty_out(vty, "zebra kernel netlink batch-adaptive\n");
+	else if (target)
+		vty_out(vty, "zebra kernel netlink batch-adaptive latency %u\n",
+			target);
+
 	if (if_netlink_frr_protodown_r_bit_is_set())
 		vty_out(vty, "zebra protodown reason-bit %u\n",
 			if_netlink_get_frr_protodown_r_bit());
@@ -230,6 +251,55 @@ void netlink_set_batch_buffer_size(uint32_t size, uint32_t threshold, bool set)
 			      memory_order_relaxed);
 }
 
+void netlink_set_batch_adaptive(uint32_t usec, bool set)
+{
+	if (set && !usec)
+		usec = NL_DEFAULT_BATCH_TARGET_USEC;
+	else if (!set)
+		usec = 0;
+
+	atomic_store_explicit(&nl_batch_target_usec, usec,
+			      memory_order_relaxed);
+}
+
+static void netlink_batch_show_one(struct hash_bucket *bucket, void *arg)
+{
+	struct nlsock *nl = bucket->data;
+	struct vty *vty = arg;
+	uint64_t batches, msgs, bytes, usec;
+	uint32_t usec_max, limit;
+
+	batches = atomic_load_explicit(&nl->batches, memory_order_relaxed);
+	if (!batches)
+		return;
+
+	msgs = atomic_load_explicit(&nl->batch_msgs, memory_order_relaxed);
+	bytes = atomic_load_explicit(&nl->batch_bytes, memory_order_relaxed);
+	usec = atomic_load_explicit(&nl->batch_usec, memory_order_relaxed);
+	usec_max = atomic_load_explicit(&nl->batch_usec_max,
+					memory_order_relaxed);
+	limit = atomic_load_explicit(&nl->batch_limit, memory_order_relaxed);
+
+	vty_out(vty, "Netlink socket %s:\n", nl->name);
+	vty_out(vty, "  Batches sent:           %" PRIu64 "\n", batches);
+	vty_out(vty, "  Messages sent:          %" PRIu64 "\n", msgs);
+	vty_out(vty, "  Bytes sent:             %" PRIu64 "\n", bytes);
+	vty_out(vty, "  Avg batch latency:      %" PRIu64 " usec\n",
+		usec / batches);
+	vty_out(vty, "  Max batch latency:      %u usec\n", usec_max);
+	vty_out(vty, "  Throughput:             %" PRIu64 " msgs/sec\n",
+		usec ? msgs * 1000000 / usec : 0);
+	if (limit)
+		vty_out(vty, "  Adaptive threshold:     %u\n", limit);
+}
+
+void netlink_batch_show(struct vty *vty)
+{
+	NLSOCK_LOCK();
+	hash_iterate(nlsock_hash, netlink_batch_show_one, vty);
+	NLSOCK_UNLOCK();
+}
+
 int netlink_talk_filter(struct nlmsghdr *h, ns_id_t ns_id, int startup)
 {
 	/*
@@ -1103,9 +1173,11 @@ static int netlink_parse_error(const struct nlsock *nl, struct nlmsghdr *h,
  * startup -> Are we reading in under startup conditions? passed to
  *            the filter.
  */
-int netlink_parse_info(int (*filter)(struct nlmsghdr *, ns_id_t, int),
-		       struct nlsock *nl, const struct zebra_dplane_info *zns,
-		       int count, bool startup)
+static int netlink_parse_info_internal(int (*filter)(struct nlmsghdr *,
+						     ns_id_t, int),
+				       struct nlsock *nl,
+				       const struct zebra_dplane_info *zns,
+				       int count, bool startup, bool *done)
 {
 	int status;
 	int ret = 0;
@@ -1132,8 +1204,11 @@ int netlink_parse_info(int (*filter)(struct nlmsghdr *, ns_id_t, int),
 		     (status >= 0 && NLMSG_OK(h, (unsigned int)status));
 		     h = NLMSG_NEXT(h, status)) {
 			/* Finish of reading. */
-			if (h->nlmsg_type == NLMSG_DONE)
+			if (h->nlmsg_type == NLMSG_DONE) {
+				if (done)
+					*done = true;
 				return ret;
+			}
 
 			/* Error handling. */
 			if (h->nlmsg_type == NLMSG_ERROR) {
@@ -1141,8 +1216,11 @@ int netlink_parse_info(int (*filter)(struct nlmsghdr *, ns_id_t, int),
 					nl, h, zns->is_cmd, startup);
 
 				if (err == 1) {
-					if (!(h->nlmsg_flags & NLM_F_MULTI))
+					if (!(h->nlmsg_flags & NLM_F_MULTI)) {
+						if (done)
+							*done = true;
 						return 0;
+					}
 					continue;
 				} else
 					return err;
@@ -1204,6 +1282,25 @@ int netlink_parse_info(int (*filter)(struct nlmsghdr *, ns_id_t, int),
 	return ret;
 }
 
+int netlink_parse_info(int (*filter)(struct nlmsghdr *, ns_id_t, int),
+		       struct nlsock *nl, const struct zebra_dplane_info *zns,
+		       int count, bool startup)
+{
+	return netlink_parse_info_internal(filter, nl, zns, count, startup,
+					   NULL);
+}
+
+int netlink_parse_dump_chunk(int (*filter)(struct nlmsghdr *, ns_id_t, int),
+			     struct nlsock *nl,
+			     const struct zebra_dplane_info *zns, int count,
+			     bool *done)
+{
+	*done = false;
+
+	return netlink_parse_info_internal(filter, nl, zns, count, true,
+					   done);
+}
+
 /*
  * netlink_talk_info
  *
@@ -1457,6 +1554,12 @@ static void nl_batch_init(struct nl_batch *bth,
 	 */
 	size_t bufsize =
 		atomic_load_explicit(&nl_batch_bufsize, memory_order_relaxed);
+	uint32_t target = atomic_load_explicit(&nl_batch_target_usec,
+					       memory_order_relaxed);
+
+	if (target)
+		bufsize = MAX(bufsize, NL_ADAPTIVE_BATCH_BUFSIZE);
+
 	if (bufsize != nl_batch_tx_bufsize) {
 		if (nl_batch_tx_buf)
 			XFREE(MTYPE_NL_BUF, nl_batch_tx_buf);
@@ -1469,12 +1572,42 @@ static void nl_batch_init(struct nl_batch *bth,
 	bth->bufsiz = bufsize;
 	bth->limit = atomic_load_explicit(&nl_batch_send_threshold,
 					  memory_order_relaxed);
+	bth->target_usec = target;
 
 	bth->ctx_out_q = ctx_out_q;
 
 	nl_batch_reset(bth);
 }
 
+/*
+ * Pick the send threshold for the next batches on this socket from the time
+ * the kernel took to acknowledge the one just sent.  The kernel handles the
+ * messages synchronously, so this is mostly its processing time; sizing the
+ * batch so that it takes about the target latency keeps the number of
+ * syscalls low without holding results back for too long.
+ */
+static void nl_batch_adapt(struct nlsock *nl, const struct nl_batch *bth,
+			   uint64_t usec)
+{
+	uint64_t limit, want;
+
+	limit = atomic_load_explicit(&nl->batch_limit, memory_order_relaxed);
+	if (!limit)
+		limit = bth->limit;
+
+	want = bth->curlen * bth->target_usec / MAX(usec, 1U);
+
+	/* a batch cut short by an empty queue can only tell us to shrink */
+	if (want > limit && bth->curlen <= limit)
+		return;
+
+	limit = (limit * 7 + want) / 8;
+	limit = MAX(limit, NL_PKT_BUF_SIZE);
+	limit = MIN(limit, bth->bufsiz - NL_PKT_BUF_SIZE);
+
+	atomic_store_explicit(&nl->batch_limit, limit, memory_order_relaxed);
+}
+
 static void nl_batch_send(struct nl_batch *bth)
 {
 	struct zebra_dplane_ctx *ctx;
@@ -1483,12 +1616,16 @@ static void nl_batch_send(struct nl_batch *bth)
 	if (bth->curlen != 0 && bth->zns != NULL) {
 		struct nlsock *nl =
 			kernel_netlink_nlsock_lookup(bth->zns->sock);
+		struct timeval start;
+		uint64_t usec;
 
 		if (IS_ZEBRA_DEBUG_KERNEL)
 			zlog_debug("%s: %s, batch size=%zu, msg cnt=%zu",
 				   __func__, nl->name, bth->curlen,
 				   bth->msgcnt);
 
+		monotime(&start);
+
 		if (netlink_send_msg(nl, bth->buf, bth->curlen) == -1)
 			err = true;
 
@@ -1496,6 +1633,24 @@ static void nl_batch_send(struct nl_batch *bth)
 			if (nl_batch_read_resp(bth) == -1)
 				err = true;
 		}
+
+		usec = monotime_since(&start, NULL);
+
+		atomic_fetch_add_explicit(&nl->batches, 1,
+					  memory_order_relaxed);
+		atomic_fetch_add_explicit(&nl->batch_msgs, bth->msgcnt,
+					  memory_order_relaxed);
+		atomic_fetch_add_explicit(&nl->batch_bytes, bth->curlen,
+					  memory_order_relaxed);
+		atomic_fetch_add_explicit(&nl->batch_usec, usec,
+					  memory_order_relaxed);
+		if (usec > atomic_load_explicit(&nl->batch_usec_max,
+						memory_order_relaxed))
+			atomic_store_explicit(&nl->batch_usec_max, usec,
+					      memory_order_relaxed);
+
+		if (bth->target_usec && !err)
+			nl_batch_adapt(nl, bth, usec);
 	}
 
 	/* Move remaining contexts to the outbound queue. */
@@ -1560,6 +1715,13 @@ enum netlink_msg_status netlink_batch_add_msg(
 	msgh->nlmsg_pid = nl->snl.nl_pid;
 
 	bth->zns = dplane_ctx_get_ns(ctx);
+	if (bth->target_usec) {
+		uint32_t limit = atomic_load_explicit(&nl->batch_limit,
+						      memory_order_relaxed);
+
+		if (limit)
+			bth->limit = limit;
+	}
 	bth->buf_head = ((char *)bth->buf_head) + size;
 	bth->curlen += size;
 	bth->msgcnt++;
@@ -1849,6 +2011,9 @@ void kernel_init(struct zebra_ns *zns)
 
 	kernel_netlink_nlsock_insert(&zns->netlink_dplane_in);
 
+	/* Opened on demand by kernel_netlink_read_open() */
+	zns->netlink_read.sock = -1;
+
 	/*
 	 * SOL_NETLINK is not available on all platforms yet
 	 * apparently.  It's in bits/socket.h which I am not
@@ -1957,10 +2122,42 @@ static void kernel_nlsock_fini(struct nlsock *nls)
 	}
 }
 
+int kernel_netlink_read_open(struct zebra_ns *zns)
+{
+	struct nlsock *nl = &zns->netlink_read;
+
+	snprintf(nl->name, sizeof(nl->name), "netlink-read (NS %u)",
+		 zns->ns_id);
+	nl->sock = -1;
+	if (netlink_socket(nl, 0, 0, 0, zns->ns_id) < 0) {
+		zlog_err("Failure to create %s socket", nl->name);
+		return -1;
+	}
+
+	if (fcntl(nl->sock, F_SETFL, O_NONBLOCK) < 0)
+		zlog_err("Can't set %s socket error: %s(%d)", nl->name,
+			 safe_strerror(errno), errno);
+
+	if (rcvbufsize)
+		netlink_recvbuf(nl, rcvbufsize);
+
+	kernel_netlink_nlsock_insert(nl);
+
+	return 0;
+}
+
+void kernel_netlink_read_close(struct zebra_ns *zns)
+{
+	EVENT_OFF(zns->t_netlink_read);
+	kernel_nlsock_fini(&zns->netlink_read);
+}
+
 void kernel_terminate(struct zebra_ns *zns, bool complete)
 {
 	EVENT_OFF(zns->t_netlink);
 
+	netlink_route_read_stop(zns);
+
 	kernel_nlsock_fini(&zns->netlink);
 
 	kernel_nlsock_fini(&zns->netlink_cmd);
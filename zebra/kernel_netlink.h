@@ -123,6 +123,16 @@ extern int netlink_parse_info(int (*filter)(struct nlmsghdr *, ns_id_t, int),
 			      struct nlsock *nl,
 			      const struct zebra_dplane_info *dp_info,
 			      int count, bool startup);
+
+/*
+ * Parse at most 'count' reads of a dump in progress on a non-blocking
+ * socket; 'done' is set once the end of the dump was reached.
+ */
+extern int netlink_parse_dump_chunk(int (*filter)(struct nlmsghdr *, ns_id_t,
+						  int),
+				    struct nlsock *nl,
+				    const struct zebra_dplane_info *dp_info,
+				    int count, bool *done);
 extern int netlink_talk_filter(struct nlmsghdr *h, ns_id_t ns, int startup);
 extern int netlink_talk(int (*filter)(struct nlmsghdr *, ns_id_t, int startup),
 			struct nlmsghdr *n, struct nlsock *nl,
@@ -170,7 +180,20 @@ extern int netlink_config_write_helper(struct vty *vty);
 extern void netlink_set_batch_buffer_size(uint32_t size, uint32_t threshold,
 					  bool set);
 
+/*
+ * Size batches from the observed kernel acknowledgement latency, aiming at
+ * 'usec' microseconds per batch (0 for the default).
+ */
+extern void netlink_set_batch_adaptive(uint32_t usec, bool set);
+
+/* Per-socket batch statistics for 'show zebra dplane' */
+extern void netlink_batch_show(struct vty *vty);
+
 extern struct nlsock *kernel_netlink_nlsock_lookup(int sock);
+
+/* Open/close the per-namespace socket used for chunked startup reads */
+extern int kernel_netlink_read_open(struct zebra_ns *zns);
+extern void kernel_netlink_read_close(struct zebra_ns *zns);
 #endif /* HAVE_NETLINK */
 
 #ifdef __cplusplus
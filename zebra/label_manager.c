@@ -34,6 +34,30 @@ struct label_manager lbl_mgr;
 
 DEFINE_MGROUP(LBL_MGR, "Label Manager");
 DEFINE_MTYPE_STATIC(LBL_MGR, LM_CHUNK, "Label Manager Chunk");
+DEFINE_MTYPE_STATIC(LBL_MGR, LM_RANGE, "Label Manager Free Range");
+
+static int lm_chunk_owner_cmp(const struct label_manager_chunk *a,
+			      const struct label_manager_chunk *b)
+{
+	if (a->proto != b->proto)
+		return numcmp(a->proto, b->proto);
+	if (a->instance != b->instance)
+		return numcmp(a->instance, b->instance);
+	if (a->session_id != b->session_id)
+		return numcmp(a->session_id, b->session_id);
+	return numcmp(a->start, b->start);
+}
+
+static int lm_chunk_start_cmp(const struct label_manager_chunk *a,
+			      const struct label_manager_chunk *b)
+{
+	return numcmp(a->start, b->start);
+}
+
+DECLARE_RBTREE_UNIQ(lm_chunks_owner, struct label_manager_chunk, owner_item,
+		    lm_chunk_owner_cmp);
+DECLARE_RBTREE_UNIQ(lm_chunks_start, struct label_manager_chunk, start_item,
+		    lm_chunk_start_cmp);
 
 /* define hooks for the basic API, so that it can be specialized or served
  * externally
@@ -79,9 +103,25 @@ static int label_manager_get_chunk(struct label_manager_chunk **lmc,
 static int label_manager_release_label_chunk(struct zserv *client,
 					     uint32_t start, uint32_t end);
 
+/* chunks assigned here give their labels back to the free space */
 void delete_label_chunk(void *val)
 {
-	XFREE(MTYPE_LM_CHUNK, val);
+	struct label_manager_chunk *lmc = val;
+
+	if (lmc->managed) {
+		lm_chunks_owner_del(&lbl_mgr.chunks_owner, lmc);
+		lm_chunks_start_del(&lbl_mgr.chunks_start, lmc);
+		id_ranges_release(&lbl_mgr.free, lmc->start, lmc->end);
+	}
+	XFREE(MTYPE_LM_CHUNK, lmc);
+}
+
+static bool lm_chunk_owned_by(const struct label_manager_chunk *lmc,
+			      uint8_t proto, unsigned short instance,
+			      uint32_t session_id)
+{
+	return lmc->proto == proto && lmc->instance == instance &&
+	       lmc->session_id == session_id;
 }
 
 /**
@@ -96,26 +136,29 @@ void delete_label_chunk(void *val)
  */
 int release_daemon_label_chunks(struct zserv *client)
 {
-	struct listnode *node;
-	struct label_manager_chunk *lmc;
+	struct label_manager_chunk ref = {
+		.proto = client->proto,
+		.instance = client->instance,
+		.session_id = client->session_id,
+	};
+	struct label_manager_chunk *lmc, *next;
 	int count = 0;
-	int ret;
 
 	if (IS_ZEBRA_DEBUG_PACKET)
 		zlog_debug("%s: Releasing chunks for client proto %s, instance %d, session %u",
 			   __func__, zebra_route_string(client->proto),
 			   client->instance, client->session_id);
 
-	for (ALL_LIST_ELEMENTS_RO(lbl_mgr.lc_list, node, lmc)) {
-		if (lmc->proto == client->proto &&
-		    lmc->instance == client->instance &&
-		    lmc->session_id == client->session_id && lmc->keep == 0) {
-			ret = release_label_chunk(lmc->proto, lmc->instance,
-						  lmc->session_id,
-						  lmc->start, lmc->end);
-			if (ret == 0)
-				count++;
+	/* the client's chunks are contiguous in the owner index */
+	lmc = lm_chunks_owner_find_gteq(&lbl_mgr.chunks_owner, &ref);
+	while (lmc && lm_chunk_owned_by(lmc, client->proto, client->instance,
+					client->session_id)) {
+		next = lm_chunks_owner_next(&lbl_mgr.chunks_owner, lmc);
+		if (lmc->keep == 0) {
+			delete_label_chunk(lmc);
+			count++;
 		}
+		lmc = next;
 	}
 
 	if (IS_ZEBRA_DEBUG_PACKET)
@@ -150,8 +193,12 @@ void lm_hooks_unregister(void)
  */
 void label_manager_init(void)
 {
-	lbl_mgr.lc_list = list_new();
-	lbl_mgr.lc_list->del = delete_label_chunk;
+	lm_chunks_owner_init(&lbl_mgr.chunks_owner);
+	lm_chunks_start_init(&lbl_mgr.chunks_start);
+	id_ranges_init(&lbl_mgr.free, MTYPE_LM_RANGE);
+	id_ranges_release(&lbl_mgr.free, MPLS_LABEL_UNRESERVED_MIN,
+			  MPLS_LABEL_UNRESERVED_MAX);
+
 	hook_register(zserv_client_close, lm_client_disconnect_cb);
 
 	/* register default hooks for the label manager actions */
@@ -180,105 +227,52 @@ create_label_chunk(uint8_t proto, unsigned short instance, uint32_t session_id,
 	return lmc;
 }
 
+/* link a chunk whose labels were just taken from the free space */
+static struct label_manager_chunk *
+lm_chunk_add(uint8_t proto, unsigned short instance, uint32_t session_id,
+	     uint8_t keep, uint32_t start, uint32_t end)
+{
+	struct label_manager_chunk *lmc;
+
+	lmc = create_label_chunk(proto, instance, session_id, keep, start, end);
+	lmc->managed = true;
+	lm_chunks_owner_add(&lbl_mgr.chunks_owner, lmc);
+	lm_chunks_start_add(&lbl_mgr.chunks_start, lmc);
+	return lmc;
+}
+
 /* attempt to get a specific label chunk */
 static struct label_manager_chunk *
 assign_specific_label_chunk(uint8_t proto, unsigned short instance,
 			    uint32_t session_id, uint8_t keep, uint32_t size,
 			    uint32_t base)
 {
-	struct label_manager_chunk *lmc;
-	struct listnode *node, *next = NULL;
-	struct listnode *first_node = NULL;
-	struct listnode *last_node = NULL;
-	struct listnode *insert_node = NULL;
-
-	/* precompute last label from base and size */
-	uint32_t end = base + size - 1;
+	uint32_t end;
 
 	/* sanities */
-	if ((base < MPLS_LABEL_UNRESERVED_MIN)
-	    || (end > MPLS_LABEL_UNRESERVED_MAX)) {
+	if (!size || (base < MPLS_LABEL_UNRESERVED_MIN)
+	    || (base > MPLS_LABEL_UNRESERVED_MAX)
+	    || (size > MPLS_LABEL_UNRESERVED_MAX - base + 1)) {
 		zlog_err("Invalid LM request arguments: base: %u, size: %u",
 			 base, size);
 		return NULL;
 	}
 
-	/* Scan the existing chunks to see if the requested range of labels
-	 * falls inside any of such chunks */
-	for (ALL_LIST_ELEMENTS_RO(lbl_mgr.lc_list, node, lmc)) {
-
-		/* skip chunks for labels < base */
-		if (base > lmc->end)
-			continue;
-
-		/* requested range is not covered by any existing, free chunk.
-		 * Therefore, need to insert a chunk */
-		if ((end < lmc->start) && !first_node) {
-			insert_node = node;
-			break;
-		}
-
-		if (!first_node)
-			first_node = node;
-
-		/* if chunk is used, cannot honor request */
-		if (lmc->proto != NO_PROTO)
-			return NULL;
-
-		if (end <= lmc->end) {
-			last_node = node;
-			break;
-		}
-	}
-
-	/* insert chunk between existing chunks */
-	if (insert_node) {
-		lmc = create_label_chunk(proto, instance, session_id, keep,
-					 base, end);
-		listnode_add_before(lbl_mgr.lc_list, insert_node, lmc);
-		return lmc;
-	}
-
-	if (first_node) {
-		/* get node past the last one, if there */
-		if (last_node)
-			last_node = listnextnode(last_node);
-
-		/* delete node coming after the above chunk whose labels are
-		 * included in the previous one */
-		for (node = first_node; node && (node != last_node);
-		     node = next) {
-			struct label_manager_chunk *death;
-
-			next = listnextnode(node);
-			death = listgetdata(node);
-			list_delete_node(lbl_mgr.lc_list, node);
-			delete_label_chunk(death);
-		}
+	/* precompute last label from base and size */
+	end = base + size - 1;
 
-		lmc = create_label_chunk(proto, instance, session_id, keep,
-					 base, end);
-		if (last_node)
-			listnode_add_before(lbl_mgr.lc_list, last_node, lmc);
-		else
-			listnode_add(lbl_mgr.lc_list, lmc);
+	/* if any label in the range is used, cannot honor request */
+	if (!id_ranges_alloc_at(&lbl_mgr.free, base, end))
+		return NULL;
 
-		return lmc;
-	} else {
-		/* create a new chunk past all the existing ones and link at
-		 * tail */
-		lmc = create_label_chunk(proto, instance, session_id, keep,
-					 base, end);
-		listnode_add(lbl_mgr.lc_list, lmc);
-		return lmc;
-	}
+	return lm_chunk_add(proto, instance, session_id, keep, base, end);
 }
 
 /**
  * Core function, assigns label chunks
  *
- * It first searches through the list to check if there's one available
- * (previously released). Otherwise it creates and assigns a new one
+ * The chunk is taken from the smallest free range that fits it, so that
+ * released chunks get reused before larger free ranges are split.
  *
  * @param proto Daemon protocol of client, to identify the owner
  * @param instance Instance, to identify the owner
@@ -291,62 +285,21 @@ struct label_manager_chunk *
 assign_label_chunk(uint8_t proto, unsigned short instance, uint32_t session_id,
 		   uint8_t keep, uint32_t size, uint32_t base)
 {
-	struct label_manager_chunk *lmc;
-	struct listnode *node;
-	uint32_t prev_end = MPLS_LABEL_UNRESERVED_MIN;
+	uint32_t start;
 
 	/* handle chunks request with a specific base label */
 	if (base != MPLS_LABEL_BASE_ANY)
 		return assign_specific_label_chunk(proto, instance, session_id,
 						   keep, size, base);
 
-	/* appease scan-build, who gets confused by the use of macros */
-	assert(lbl_mgr.lc_list);
-
-	/* first check if there's one available */
-	for (ALL_LIST_ELEMENTS_RO(lbl_mgr.lc_list, node, lmc)) {
-		if (lmc->proto == NO_PROTO
-		    && lmc->end - lmc->start + 1 == size) {
-			lmc->proto = proto;
-			lmc->instance = instance;
-			lmc->session_id = session_id;
-			lmc->keep = keep;
-			return lmc;
-		}
-		/* check if we hadve a "hole" behind us that we can squeeze into
-		 */
-		if ((lmc->start > prev_end) && (lmc->start - prev_end > size)) {
-			lmc = create_label_chunk(proto, instance, session_id,
-						 keep, prev_end + 1,
-						 prev_end + size);
-			listnode_add_before(lbl_mgr.lc_list, node, lmc);
-			return lmc;
-		}
-		prev_end = lmc->end;
-	}
-	/* otherwise create a new one */
-	uint32_t start_free;
-
-	if (list_isempty(lbl_mgr.lc_list))
-		start_free = MPLS_LABEL_UNRESERVED_MIN;
-	else
-		start_free = ((struct label_manager_chunk *)listgetdata(
-				      listtail(lbl_mgr.lc_list)))
-				     ->end
-			     + 1;
-
-	if (start_free > MPLS_LABEL_UNRESERVED_MAX - size + 1) {
+	if (!id_ranges_alloc(&lbl_mgr.free, size, &start)) {
 		flog_err(EC_ZEBRA_LM_EXHAUSTED_LABELS,
-			 "Reached max labels. Start: %u, size: %u", start_free,
-			 size);
+			 "Reached max labels. No free range of size %u", size);
 		return NULL;
 	}
 
-	/* create chunk and link at tail */
-	lmc = create_label_chunk(proto, instance, session_id, keep, start_free,
-				 start_free + size - 1);
-	listnode_add(lbl_mgr.lc_list, lmc);
-	return lmc;
+	return lm_chunk_add(proto, instance, session_id, keep, start,
+			    start + size - 1);
 }
 
 /**
@@ -380,31 +333,28 @@ static int label_manager_release_label_chunk(struct zserv *client,
 int release_label_chunk(uint8_t proto, unsigned short instance,
 			uint32_t session_id, uint32_t start, uint32_t end)
 {
-	struct listnode *node;
+	struct label_manager_chunk ref = {
+		.proto = proto,
+		.instance = instance,
+		.session_id = session_id,
+		.start = start,
+	};
 	struct label_manager_chunk *lmc;
 	int ret = -1;
 
 	/* check that size matches */
 	if (IS_ZEBRA_DEBUG_PACKET)
 		zlog_debug("Releasing label chunk: %u - %u", start, end);
-	/* find chunk and disown */
-	for (ALL_LIST_ELEMENTS_RO(lbl_mgr.lc_list, node, lmc)) {
-		if (lmc->start != start)
-			continue;
-		if (lmc->end != end)
-			continue;
-		if (lmc->proto != proto || lmc->instance != instance ||
-		    lmc->session_id != session_id) {
+	/* find chunk and give its labels back */
+	lmc = lm_chunks_owner_find(&lbl_mgr.chunks_owner, &ref);
+	if (lmc && lmc->end == end) {
+		delete_label_chunk(lmc);
+		ret = 0;
+	} else {
+		lmc = lm_chunks_start_find(&lbl_mgr.chunks_start, &ref);
+		if (lmc && lmc->end == end)
 			flog_err(EC_ZEBRA_LM_DAEMON_MISMATCH,
 				 "%s: Daemon mismatch!!", __func__);
-			continue;
-		}
-		lmc->proto = NO_PROTO;
-		lmc->instance = 0;
-		lmc->session_id = 0;
-		lmc->keep = 0;
-		ret = 0;
-		break;
 	}
 	if (ret != 0)
 		flog_err(EC_ZEBRA_LM_UNRELEASED_CHUNK,
@@ -472,5 +422,13 @@ int lm_get_chunk_response(struct label_manager_chunk *lmc, struct zserv *client,
 
 void label_manager_close(void)
 {
-	list_delete(&lbl_mgr.lc_list);
+	struct label_manager_chunk *lmc;
+
+	while ((lmc = lm_chunks_owner_pop(&lbl_mgr.chunks_owner))) {
+		lm_chunks_start_del(&lbl_mgr.chunks_start, lmc);
+		XFREE(MTYPE_LM_CHUNK, lmc);
+	}
+	lm_chunks_owner_fini(&lbl_mgr.chunks_owner);
+	lm_chunks_start_fini(&lbl_mgr.chunks_start);
+	id_ranges_fini(&lbl_mgr.free);
 }
@@ -16,8 +16,10 @@
 #include "lib/linklist.h"
 #include "frrevent.h"
 #include "lib/hook.h"
+#include "lib/typesafe.h"
 
 #include "zebra/zserv.h"
+#include "zebra/id_ranges.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,6 +27,9 @@ extern "C" {
 
 #define NO_PROTO 0
 
+PREDECL_RBTREE_UNIQ(lm_chunks_owner);
+PREDECL_RBTREE_UNIQ(lm_chunks_start);
+
 /*
  * Label chunk struct
  * Client daemon which the chunk belongs to can be identified by a tuple of:
@@ -44,6 +49,13 @@ struct label_manager_chunk {
 	uint8_t keep;
 	uint32_t start; /* First label of the chunk */
 	uint32_t end;   /* Last label of the chunk */
+
+	/* set while the chunk is assigned by the label manager itself, as
+	 * opposed to chunks built by an external one
+	 */
+	bool managed;
+	struct lm_chunks_owner_item owner_item;
+	struct lm_chunks_start_item start_item;
 };
 
 /* declare hooks for the basic API, so that it can be specialized or served
@@ -93,10 +105,13 @@ void lm_hooks_unregister(void);
 
 /*
  * Main label manager struct
- * Holds a linked list of label chunks.
+ * Holds the assigned label chunks, by owner and by first label, and the
+ * labels that are still free.
  */
 struct label_manager {
-	struct list *lc_list;
+	struct lm_chunks_owner_head chunks_owner;
+	struct lm_chunks_start_head chunks_start;
+	struct id_ranges free;
 };
 
 void label_manager_init(void);
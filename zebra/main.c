@@ -45,6 +45,7 @@
 #include "zebra/zebra_srte.h"
 #include "zebra/zebra_srv6.h"
 #include "zebra/zebra_srv6_vty.h"
+#include "zebra/zebra_restart.h"
 
 #define ZEBRA_PTM_SUPPORT
 
@@ -71,6 +72,9 @@ uint32_t rcvbufsize = 128 * 1024;
 
 #define OPTION_V6_RR_SEMANTICS 2000
 #define OPTION_ASIC_OFFLOAD    2001
+#define OPTION_STREAM_READ     2002
+#define OPTION_NL_READERS      2003
+#define OPTION_FAST_RESTART    2004
 
 /* Command line options. */
 const struct option longopts[] = {
@@ -81,10 +85,13 @@ const struct option longopts[] = {
 	{"retain", no_argument, NULL, 'r'},
 	{"graceful_restart", required_argument, NULL, 'K'},
 	{"asic-offload", optional_argument, NULL, OPTION_ASIC_OFFLOAD},
+	{"fast-restart", required_argument, NULL, OPTION_FAST_RESTART},
 #ifdef HAVE_NETLINK
 	{"vrfwnetns", no_argument, NULL, 'n'},
 	{"nl-bufsize", required_argument, NULL, 's'},
 	{"v6-rr-semantics", no_argument, NULL, OPTION_V6_RR_SEMANTICS},
+	{"stream-kernel-read", no_argument, NULL, OPTION_STREAM_READ},
+	{"netlink-readers", required_argument, NULL, OPTION_NL_READERS},
 #endif /* HAVE_NETLINK */
 	{0}};
 
@@ -137,6 +144,10 @@ static void sigint(void)
 	atomic_store_explicit(&zrouter.in_shutdown, true,
 			      memory_order_relaxed);
 
+	/* The RIB is still complete, before clients are closed */
+	if (retain_mode)
+		zebra_restart_write();
+
 	/* send RA lifetime of 0 before stopping. rfc4861/6.2.5 */
 	rtadv_stop_ra_all();
 
@@ -281,6 +292,9 @@ int main(int argc, char **argv)
 	socklen_t dummylen;
 	bool asic_offload = false;
 	bool notify_on_ack = true;
+	bool stream_read = false;
+	uint32_t nl_readers = 0;
+	const char *fast_restart = NULL;
 
 	graceful_restart = 0;
 	vrf_configure_backend(VRF_BACKEND_VRF_LITE);
@@ -301,10 +315,13 @@ int main(int argc, char **argv)
 		"  -r, --retain             When program terminates, retain added route by zebra.\n"
 		"  -K, --graceful_restart   Graceful restart at the kernel level, timer in seconds for expiration\n"
 		"  -A, --asic-offload       FRR is interacting with an asic underneath the linux kernel\n"
+		"      --fast-restart       State file to restart from without reprogramming the kernel, with -r and -K\n"
 #ifdef HAVE_NETLINK
 		"  -s, --nl-bufsize         Set netlink receive buffer size\n"
 		"  -n, --vrfwnetns          Use NetNS as VRF backend\n"
 		"      --v6-rr-semantics    Use v6 RR semantics\n"
+		"      --stream-kernel-read Read kernel routes in chunks while serving clients\n"
+		"      --netlink-readers    Read namespaces' interface address events on this many pthreads\n"
 #else
 		"  -s,                      Set kernel socket receive buffer size\n"
 #endif /* HAVE_NETLINK */
@@ -355,6 +372,9 @@ int main(int argc, char **argv)
 		case 'K':
 			graceful_restart = atoi(optarg);
 			break;
+		case OPTION_FAST_RESTART:
+			fast_restart = optarg;
+			break;
 		case 's':
 			rcvbufsize = atoi(optarg);
 			if (rcvbufsize < RCVBUFSIZE_MIN)
@@ -376,6 +396,17 @@ int main(int argc, char **argv)
 				notify_on_ack = true;
 			asic_offload = true;
 			break;
+		case OPTION_STREAM_READ:
+			stream_read = true;
+			break;
+		case OPTION_NL_READERS:
+			nl_readers = strtoul(optarg, NULL, 10);
+			if (nl_readers > 16) {
+				fprintf(stderr,
+					"At most 16 netlink readers are supported\n");
+				exit(1);
+			}
+			break;
 #endif /* HAVE_NETLINK */
 		default:
 			frr_help_exit(1);
@@ -386,11 +417,17 @@ int main(int argc, char **argv)
 
 	/* Zebra related initialize. */
 	zebra_router_init(asic_offload, notify_on_ack);
+	zrouter.kernel_read_stream = stream_read;
 	zserv_init();
 	rib_init();
+	zebra_dplane_set_netlink_readers(nl_readers);
 	zebra_if_init();
 	zebra_debug_init();
 
+	/* Has to be loaded before the kernel tables are read */
+	if (fast_restart)
+		zebra_restart_init(fast_restart);
+
 	/*
 	 * Initialize NS( and implicitly the VRF module), and make kernel
 	 * routing socket. */
@@ -31,6 +31,8 @@
 
 #define ZEBRA_PTM_SUPPORT
 
+DEFINE_MTYPE_STATIC(ZEBRA, REDIST_WALK, "Redistribution table walk");
+
 /* array holding redistribute info about table redistribution */
 /* bit AFI is set if that AFI is redistributing routes from this table */
 static int zebra_import_table_used[AFI_MAX][ZEBRA_KERNEL_TABLE_MAX];
@@ -86,47 +88,184 @@ static void zebra_redistribute_default(struct zserv *client, vrf_id_t vrf_id)
 	}
 }
 
+/*
+ * A new redistribute request sends the client all matching routes of the
+ * table.  Rather than queueing a whole table at once, it is walked a chunk
+ * of REDIST_WALK_CHUNK destinations at a time, from an event, and only
+ * while fewer than REDIST_WALK_CHUNK updates are still waiting to go out
+ * to the client (see zsend_redistribute_route()), so the walk goes as fast
+ * as the client reads.  Between chunks only the last destination is kept,
+ * the walk carries on after it in whatever the table holds by then;
+ * changes to routes it has passed are sent to the client as usual.
+ */
+#define REDIST_WALK_CHUNK 1000
+#define REDIST_WALK_RETRY_MSEC 10
+
+struct redist_walk {
+	struct zserv_redist_walks_item item;
+
+	int type;
+	unsigned short instance;
+	vrf_id_t vrf_id;
+	afi_t afi;
+
+	bool started;
+	struct prefix last;
+};
+
+DECLARE_DLIST(zserv_redist_walks, struct redist_walk, item);
+
+static void zebra_redistribute_walk(struct event *thread);
+
+void zebra_redistribute_walks_init(struct zserv *client)
+{
+	zserv_redist_walks_init(&client->redist_walks);
+}
+
+void zebra_redistribute_walks_fini(struct zserv *client)
+{
+	struct redist_walk *walk;
+
+	EVENT_OFF(client->t_redist_walk);
+
+	while ((walk = zserv_redist_walks_pop(&client->redist_walks)))
+		XFREE(MTYPE_REDIST_WALK, walk);
+	zserv_redist_walks_fini(&client->redist_walks);
+}
+
+static void zebra_redistribute_node(struct zserv *client,
+				    struct redist_walk *walk,
+				    struct route_node *rn)
+{
+	struct route_entry *newre;
+
+	RNODE_FOREACH_RE (rn, newre) {
+		if (IS_ZEBRA_DEBUG_RIB)
+			zlog_debug(
+				"%s: client %s %pRN(%u:%u) checking: selected=%d, type=%s, instance=%u, distance=%d, metric=%d zebra_check_addr=%d",
+				__func__, zebra_route_string(client->proto), rn,
+				walk->vrf_id, newre->instance,
+				!!CHECK_FLAG(newre->flags, ZEBRA_FLAG_SELECTED),
+				zebra_route_string(newre->type),
+				newre->instance, newre->distance,
+				newre->metric, zebra_check_addr(&rn->p));
+
+		if (!CHECK_FLAG(newre->flags, ZEBRA_FLAG_SELECTED))
+			continue;
+		if ((walk->type != ZEBRA_ROUTE_ALL &&
+		     (newre->type != walk->type ||
+		      newre->instance != walk->instance)))
+			continue;
+		if (!zebra_check_addr(&rn->p))
+			continue;
+
+		zsend_redistribute_route(ZEBRA_REDISTRIBUTE_ROUTE_ADD, client,
+					 rn, newre);
+	}
+}
+
+/* Send the next chunk of the client's first walk, false once it is done */
+static bool zebra_redistribute_walk_chunk(struct zserv *client,
+					  struct redist_walk *walk)
+{
+	struct route_table *table, *src_table;
+	struct route_node *rn, *srn;
+	unsigned int n;
+
+	table = zebra_vrf_table(walk->afi, SAFI_UNICAST, walk->vrf_id);
+	if (!table)
+		return false;
+
+	if (walk->started)
+		rn = route_table_get_next(table, &walk->last);
+	else
+		rn = route_top(table);
+	walk->started = true;
+
+	for (n = 0; rn; rn = route_next(rn)) {
+		zebra_redistribute_node(client, walk, rn);
+
+		/* the source prefixes of a destination go with it */
+		src_table = srcdest_srcnode_table(rn);
+		if (src_table)
+			for (srn = route_top(src_table); srn;
+			     srn = route_next(srn))
+				zebra_redistribute_node(client, walk, srn);
+
+		if (++n == REDIST_WALK_CHUNK) {
+			prefix_copy(&walk->last, &rn->p);
+			route_unlock_node(rn);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void zebra_redistribute_walk(struct event *thread)
+{
+	struct zserv *client = EVENT_ARG(thread);
+	struct redist_walk *walk;
+
+	walk = zserv_redist_walks_first(&client->redist_walks);
+	if (!walk)
+		return;
+
+	/* wait for the client to take what was sent so far */
+	if (zsend_redistribute_backlog(client) >= REDIST_WALK_CHUNK) {
+		event_add_timer_msec(zrouter.master, zebra_redistribute_walk,
+				     client, REDIST_WALK_RETRY_MSEC,
+				     &client->t_redist_walk);
+		return;
+	}
+
+	if (!zebra_redistribute_walk_chunk(client, walk)) {
+		zserv_redist_walks_del(&client->redist_walks, walk);
+		XFREE(MTYPE_REDIST_WALK, walk);
+	}
+
+	if (zserv_redist_walks_count(&client->redist_walks))
+		event_add_event(zrouter.master, zebra_redistribute_walk, client,
+				0, &client->t_redist_walk);
+}
+
 /* Redistribute routes. */
 static void zebra_redistribute(struct zserv *client, int type,
 			       unsigned short instance, vrf_id_t vrf_id,
 			       int afi)
 {
-	struct route_entry *newre;
-	struct route_table *table;
-	struct route_node *rn;
+	struct redist_walk *walk;
 
-	table = zebra_vrf_table(afi, SAFI_UNICAST, vrf_id);
-	if (!table)
+	if (!zebra_vrf_table(afi, SAFI_UNICAST, vrf_id))
 		return;
 
-	for (rn = route_top(table); rn; rn = srcdest_route_next(rn))
-		RNODE_FOREACH_RE (rn, newre) {
-			if (IS_ZEBRA_DEBUG_RIB)
-				zlog_debug(
-					"%s: client %s %pRN(%u:%u) checking: selected=%d, type=%s, instance=%u, distance=%d, metric=%d zebra_check_addr=%d",
-					__func__,
-					zebra_route_string(client->proto), rn,
-					vrf_id, newre->instance,
-					!!CHECK_FLAG(newre->flags,
-						     ZEBRA_FLAG_SELECTED),
-					zebra_route_string(newre->type),
-					newre->instance,
-					newre->distance,
-					newre->metric,
-					zebra_check_addr(&rn->p));
-
-			if (!CHECK_FLAG(newre->flags, ZEBRA_FLAG_SELECTED))
-				continue;
-			if ((type != ZEBRA_ROUTE_ALL
-			     && (newre->type != type
-				 || newre->instance != instance)))
-				continue;
-			if (!zebra_check_addr(&rn->p))
-				continue;
+	walk = XCALLOC(MTYPE_REDIST_WALK, sizeof(*walk));
+	walk->type = type;
+	walk->instance = instance;
+	walk->vrf_id = vrf_id;
+	walk->afi = afi;
+	zserv_redist_walks_add_tail(&client->redist_walks, walk);
 
-			zsend_redistribute_route(ZEBRA_REDISTRIBUTE_ROUTE_ADD,
-						 client, rn, newre);
-		}
+	if (!client->t_redist_walk)
+		event_add_event(zrouter.master, zebra_redistribute_walk, client,
+				0, &client->t_redist_walk);
+}
+
+/* The client no longer wants what a pending walk would send it */
+static void zebra_redistribute_walk_cancel(struct zserv *client, int type,
+					   unsigned short instance,
+					   vrf_id_t vrf_id, afi_t afi)
+{
+	struct redist_walk *walk;
+
+	frr_each_safe (zserv_redist_walks, &client->redist_walks, walk) {
+		if (walk->type != type || walk->instance != instance ||
+		    walk->vrf_id != vrf_id || walk->afi != afi)
+			continue;
+
+		zserv_redist_walks_del(&client->redist_walks, walk);
+		XFREE(MTYPE_REDIST_WALK, walk);
+	}
 }
 
 /*
@@ -389,6 +528,9 @@ void zebra_redistribute_delete(ZAPI_HANDLER_ARGS)
 	else
 		vrf_bitmap_unset(client->redist[afi][type], zvrf_id(zvrf));
 
+	zebra_redistribute_walk_cancel(client, type, instance, zvrf_id(zvrf),
+				       afi);
+
 stream_failure:
 	return;
 }
@@ -25,6 +25,10 @@ extern void zebra_redistribute_default_add(ZAPI_HANDLER_ARGS);
 extern void zebra_redistribute_default_delete(ZAPI_HANDLER_ARGS);
 /* ----------------- */
 
+/* pending table walks of a client for initial redistribution */
+extern void zebra_redistribute_walks_init(struct zserv *client);
+extern void zebra_redistribute_walks_fini(struct zserv *client);
+
 extern void redistribute_update(const struct route_node *rn,
 				const struct route_entry *re,
 				const struct route_entry *prev_re);
@@ -32,6 +32,8 @@ DECLARE_MGROUP(ZEBRA);
 DECLARE_MTYPE(RE);
 
 PREDECL_LIST(rnh_list);
+PREDECL_DLIST(rnh_rcache_list);
+PREDECL_DLIST(rnh_pending_list);
 
 /* Nexthop structure. */
 struct rnh {
@@ -40,6 +42,7 @@ struct rnh {
 #define ZEBRA_NHT_CONNECTED 0x1
 #define ZEBRA_NHT_DELETED 0x2
 #define ZEBRA_NHT_RESOLVE_VIA_DEFAULT 0x4
+#define ZEBRA_NHT_NOTIFY_PENDING 0x8
 
 	/* VRF identifier. */
 	vrf_id_t vrf_id;
@@ -63,6 +66,14 @@ struct rnh {
 	 */
 	int filtered[ZEBRA_ROUTE_MAX];
 
+	/*
+	 * While a delayed notification is pending, the state clients
+	 * were last told about.
+	 */
+	struct route_entry *notified_state;
+	struct prefix notified_route;
+	struct rnh_pending_list_item pending_item;
+
 	struct rnh_list_item rnh_list_item;
 };
 
@@ -70,6 +81,7 @@ struct rnh {
 #define ZEBRA_KERNEL_TABLE_MAX 252 /* support for no more than this rt tables */
 
 PREDECL_LIST(re_list);
+PREDECL_DLIST(re_type_list);
 
 struct re_opaque {
 	uint16_t length;
@@ -85,12 +97,23 @@ struct route_entry {
 	 */
 	struct nhg_hash_entry *nhe;
 
-	/* Nexthop group from FIB (optional), reflecting what is actually
-	 * installed in the FIB if that differs. The 'backup' group is used
-	 * when backup nexthops are present in the route's nhg.
+	/* Nexthop groups from FIB (optional), see struct re_fib_nhgs.
+	 * Only allocated once the dataplane reports an installed set that
+	 * differs from the rib one, or installed backups.
 	 */
-	struct nexthop_group fib_ng;
-	struct nexthop_group fib_backup_ng;
+	struct re_fib_nhgs *fib;
+
+	/* Per-table list of routes of the same type, and the node the
+	 * route hangs off, so that rib_update_table() only has to visit
+	 * the nodes holding routes of the type it was asked to update.
+	 */
+	struct re_type_list_item type_item;
+	struct route_node *rn;
+
+	/* Uptime. */
+	time_t uptime;
+
+	struct re_opaque *opaque;
 
 	/* Nexthop group hash entry IDs. The "installed" id is the id
 	 * used in linux/netlink, if available.
@@ -101,9 +124,6 @@ struct route_entry {
 	/* Tag */
 	route_tag_t tag;
 
-	/* Uptime. */
-	time_t uptime;
-
 	/* Type of this route. */
 	int type;
 
@@ -159,8 +179,16 @@ struct route_entry {
 
 	/* Distance. */
 	uint8_t distance;
+};
 
-	struct re_opaque *opaque;
+/* Nexthop group from FIB, reflecting what is actually installed in the FIB
+ * if that differs. The 'backup' group is used when backup nexthops are
+ * present in the route's nhg. Kept out of line since most routes never
+ * need it.
+ */
+struct re_fib_nhgs {
+	struct nexthop_group fib_ng;
+	struct nexthop_group fib_backup_ng;
 };
 
 #define RIB_SYSTEM_ROUTE(R) RSYSTEM_ROUTE((R)->type)
@@ -183,6 +211,14 @@ struct route_entry {
 #define MQ_SIZE 10
 struct meta_queue {
 	struct list *subq[MQ_SIZE];
+
+	/*
+	 * With "zebra rib-queue per-vrf", route nodes are queued on
+	 * zvrf->mq_subq[] instead and the VRFs with nodes pending are
+	 * served round robin from these lists.
+	 */
+	struct list *vrfs[MQ_SIZE];
+
 	uint32_t size; /* sum of lengths of all subqueues */
 };
 
@@ -209,6 +245,11 @@ typedef struct rib_dest_t_ {
 	 */
 	uint32_t flags;
 
+	/*
+	 * When the node got on the meta queue, for the time it waited.
+	 */
+	struct timeval mq_time;
+
 	/*
 	 * The list of nht prefixes that have ended up
 	 * depending on this route node.
@@ -218,6 +259,12 @@ typedef struct rib_dest_t_ {
 	 */
 	struct rnh_list_head nht;
 
+	/*
+	 * Recursive resolution cache entries whose nexthop address
+	 * currently has this node as its longest prefix match.
+	 */
+	struct rnh_rcache_list_head rcache;
+
 	/*
 	 * Linkage to put dest on the FPM processing queue.
 	 */
@@ -227,6 +274,7 @@ typedef struct rib_dest_t_ {
 
 DECLARE_LIST(rnh_list, struct rnh, rnh_list_item);
 DECLARE_LIST(re_list, struct route_entry, next);
+DECLARE_DLIST(re_type_list, struct route_entry, type_item);
 
 #define RIB_ROUTE_QUEUED(x)	(1 << (x))
 // If MQ_SIZE is modified this value needs to be updated.
@@ -297,6 +345,9 @@ struct rib_table_info {
 	afi_t afi;
 	safi_t safi;
 	uint32_t table_id;
+
+	/* Routes in the table, by route type */
+	struct re_type_list_head re_types[ZEBRA_ROUTE_MAX];
 };
 
 enum rib_tables_iter_state {
@@ -585,12 +636,15 @@ static inline struct nexthop_group *rib_get_fib_nhg(struct route_entry *re)
 	/* If the fib set is a subset of the active rib set,
 	 * use the dedicated fib list.
 	 */
-	if (CHECK_FLAG(re->status, ROUTE_ENTRY_USE_FIB_NHG))
-		return &(re->fib_ng);
+	if (CHECK_FLAG(re->status, ROUTE_ENTRY_USE_FIB_NHG) && re->fib)
+		return &(re->fib->fib_ng);
 	else
 		return &(re->nhe->nhg);
 }
 
+/* Empty group handed out for routes without a fib extension. */
+extern struct nexthop_group rib_empty_fib_nhg;
+
 /*
  * Access backup nexthop-group that represents the installed backup nexthops;
  * any installed backup will be on the fib list.
@@ -598,9 +652,19 @@ static inline struct nexthop_group *rib_get_fib_nhg(struct route_entry *re)
 static inline struct nexthop_group *rib_get_fib_backup_nhg(
 	struct route_entry *re)
 {
-	return &(re->fib_backup_ng);
+	if (re->fib)
+		return &(re->fib->fib_backup_ng);
+
+	return &rib_empty_fib_nhg;
 }
 
+/* Allocate (if needed) and free the out-of-line fib nexthop groups */
+extern struct re_fib_nhgs *route_entry_fib_get(struct route_entry *re);
+extern void route_entry_fib_free(struct route_entry *re);
+
+/* RIB memory accounting, per VRF and per route type */
+extern void zebra_rib_memory_show(struct vty *vty, json_object *json);
+
 extern void zebra_vty_init(void);
 
 extern pid_t pid;
@@ -78,6 +78,14 @@ void kernel_router_terminate(void);
 
 extern uint32_t kernel_get_speed(struct interface *ifp, int *error);
 extern int kernel_get_ipmr_sg_stats(struct zebra_vrf *zvrf, void *mroute);
+/*
+ * Dump all multicast routes of the zvrf's table for the given family,
+ * calling cb for each of them.  Returns < 0 if the dump isn't supported or
+ * failed.
+ */
+extern int kernel_get_ipmr_sg_stats_bulk(struct zebra_vrf *zvrf, int family,
+					 void (*cb)(void *mroute, void *arg),
+					 void *arg);
 
 /*
  * Southbound Initialization routines to get initial starting
@@ -66,6 +66,7 @@
 #include "zebra/zebra_evpn_mh.h"
 #include "zebra/zebra_trace.h"
 #include "zebra/zebra_neigh.h"
+#include "zebra/zebra_restart.h"
 
 #ifndef AF_MPLS
 #define AF_MPLS 28
@@ -947,6 +948,9 @@ int netlink_route_change_read_unicast_internal(struct nlmsghdr *h,
 		re = zebra_rib_route_entry_new(vrf_id, proto, 0, flags, nhe_id,
 					       table, metric, mtu, distance,
 					       tag);
+		if (startup && selfroute)
+			zebra_restart_kernel_route(re, afi, &p, &src_p,
+						   prefsrc);
 		if (!nhe_id)
 			ng = nexthop_group_new();
 
@@ -1223,7 +1227,7 @@ int netlink_route_change(struct nlmsghdr *h, ns_id_t ns_id, int startup)
 }
 
 /* Request for specific route information from the kernel */
-static int netlink_request_route(struct zebra_ns *zns, int family, int type)
+static int netlink_request_route(struct nlsock *nl, int family, int type)
 {
 	struct {
 		struct nlmsghdr n;
@@ -1237,7 +1241,116 @@ static int netlink_request_route(struct zebra_ns *zns, int family, int type)
 	req.n.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
 	req.rtm.rtm_family = family;
 
-	return netlink_request(&zns->netlink_cmd, &req);
+	return netlink_request(nl, &req);
+}
+
+/*
+ * Number of reads from the kernel handled per event when the routing tables
+ * are read in chunks at startup.
+ */
+#define NL_ROUTE_READ_CHUNK 16
+
+static int netlink_route_read_stream_filter(struct nlmsghdr *h, ns_id_t ns_id,
+					    int startup)
+{
+	if (h->nlmsg_type == RTM_NEWROUTE)
+		zrouter.kernel_read_routes++;
+
+	return netlink_route_change_read_unicast(h, ns_id, startup);
+}
+
+static void netlink_route_read_stream_done(struct zebra_ns *zns, bool ok)
+{
+	int64_t usec = monotime_since(&zns->netlink_read_start, NULL);
+
+	kernel_netlink_read_close(zns);
+
+	zrouter.kernel_read_usec += usec;
+	zrouter.kernel_reads_pending--;
+
+	if (ok)
+		zlog_info("Kernel routing tables of NS %u read in %" PRId64
+			  " ms",
+			  zns->ns_id, usec / 1000);
+	else
+		zlog_warn("Reading the kernel routing tables of NS %u failed",
+			  zns->ns_id);
+
+	if (!zrouter.kernel_reads_pending && zrouter.sweep_deferred)
+		event_add_event(zrouter.master, rib_sweep_route, NULL, 0,
+				&zrouter.sweeper);
+}
+
+static void netlink_route_read_stream(struct event *t)
+{
+	struct zebra_ns *zns = EVENT_ARG(t);
+	struct zebra_dplane_info dp_info;
+	bool done;
+	int ret;
+
+	zebra_dplane_info_from_zns(&dp_info, zns, true /*is_cmd*/);
+
+	ret = netlink_parse_dump_chunk(netlink_route_read_stream_filter,
+				       &zns->netlink_read, &dp_info,
+				       NL_ROUTE_READ_CHUNK, &done);
+	if (ret < 0) {
+		netlink_route_read_stream_done(zns, false);
+		return;
+	}
+
+	if (done) {
+		if (zns->netlink_read_family != AF_INET) {
+			netlink_route_read_stream_done(zns, true);
+			return;
+		}
+
+		/* IPv4 is complete, continue with the IPv6 table */
+		zns->netlink_read_family = AF_INET6;
+		if (netlink_request_route(&zns->netlink_read, AF_INET6,
+					  RTM_GETROUTE) < 0) {
+			netlink_route_read_stream_done(zns, false);
+			return;
+		}
+	}
+
+	event_add_read(zrouter.master, netlink_route_read_stream, zns,
+		       zns->netlink_read.sock, &zns->t_netlink_read);
+}
+
+/*
+ * Start reading the routing tables over a dedicated socket, a chunk per
+ * event, so that clients are served while a large table is loaded.
+ */
+static int netlink_route_read_stream_start(struct zebra_ns *zns)
+{
+	if (kernel_netlink_read_open(zns) < 0)
+		return -1;
+
+	zns->netlink_read_family = AF_INET;
+	if (netlink_request_route(&zns->netlink_read, AF_INET,
+				  RTM_GETROUTE) < 0) {
+		kernel_netlink_read_close(zns);
+		return -1;
+	}
+
+	monotime(&zns->netlink_read_start);
+	zrouter.kernel_reads_pending++;
+
+	event_add_read(zrouter.master, netlink_route_read_stream, zns,
+		       zns->netlink_read.sock, &zns->t_netlink_read);
+
+	return 0;
+}
+
+void netlink_route_read_stop(struct zebra_ns *zns)
+{
+	if (zns->netlink_read.sock < 0)
+		return;
+
+	/* Shutting down, the deferred sweep has no point anymore */
+	kernel_netlink_read_close(zns);
+	zrouter.kernel_reads_pending--;
+	zrouter.sweep_deferred = false;
 }
 
 /* Routing table read function using netlink interface.  Only called
@@ -1247,10 +1360,14 @@ int netlink_route_read(struct zebra_ns *zns)
 	int ret;
 	struct zebra_dplane_info dp_info;
 
+	if (zrouter.kernel_read_stream &&
+	    netlink_route_read_stream_start(zns) == 0)
+		return 0;
+
 	zebra_dplane_info_from_zns(&dp_info, zns, true /*is_cmd*/);
 
 	/* Get IPv4 routing table. */
-	ret = netlink_request_route(zns, AF_INET, RTM_GETROUTE);
+	ret = netlink_request_route(&zns->netlink_cmd, AF_INET, RTM_GETROUTE);
 	if (ret < 0)
 		return ret;
 	ret = netlink_parse_info(netlink_route_change_read_unicast,
@@ -1259,7 +1376,7 @@ int netlink_route_read(struct zebra_ns *zns)
 		return ret;
 
 	/* Get IPv6 routing table. */
-	ret = netlink_request_route(zns, AF_INET6, RTM_GETROUTE);
+	ret = netlink_request_route(&zns->netlink_cmd, AF_INET6, RTM_GETROUTE);
 	if (ret < 0)
 		return ret;
 	ret = netlink_parse_info(netlink_route_change_read_unicast,
@@ -2441,6 +2558,29 @@ ssize_t netlink_route_multipath_msg_encode(int cmd,
 	return NLMSG_ALIGN(req->n.nlmsg_len);
 }
 
+/*
+ * What?
+ *
+ * So during the namespace cleanup we started storing
+ * the zvrf table_id for the default table as RT_TABLE_MAIN
+ * which is what the normal routing table for ip routing is.
+ * This change caused this to break our lookups of sg data
+ * because prior to this change the zvrf->table_id was 0
+ * and when the pim multicast kernel code saw a 0,
+ * it was auto-translated to RT_TABLE_DEFAULT.  But since
+ * we are now passing in RT_TABLE_MAIN there is no auto-translation
+ * and the kernel goes screw you and the delicious cookies you
+ * are trying to give me.  So now we have this little hack.
+ */
+static uint32_t ipmr_table_id(struct zebra_vrf *zvrf, int family)
+{
+	if (family == AF_INET)
+		return (zvrf->table_id == RT_TABLE_MAIN) ? RT_TABLE_DEFAULT
+							 : zvrf->table_id;
+
+	return zvrf->table_id;
+}
+
 int kernel_get_ipmr_sg_stats(struct zebra_vrf *zvrf, void *in)
 {
 	uint32_t actual_table;
@@ -2488,26 +2628,7 @@ int kernel_get_ipmr_sg_stats(struct zebra_vrf *zvrf, void *in)
 			    sizeof(mroute->grp.ipaddr_v6));
 	}
 
-	/*
-	 * What?
-	 *
-	 * So during the namespace cleanup we started storing
-	 * the zvrf table_id for the default table as RT_TABLE_MAIN
-	 * which is what the normal routing table for ip routing is.
-	 * This change caused this to break our lookups of sg data
-	 * because prior to this change the zvrf->table_id was 0
-	 * and when the pim multicast kernel code saw a 0,
-	 * it was auto-translated to RT_TABLE_DEFAULT.  But since
-	 * we are now passing in RT_TABLE_MAIN there is no auto-translation
-	 * and the kernel goes screw you and the delicious cookies you
-	 * are trying to give me.  So now we have this little hack.
-	 */
-	if (mroute->family == AF_INET)
-		actual_table = (zvrf->table_id == RT_TABLE_MAIN)
-				       ? RT_TABLE_DEFAULT
-				       : zvrf->table_id;
-	else
-		actual_table = zvrf->table_id;
+	actual_table = ipmr_table_id(zvrf, mroute->family);
 
 	nl_attr_put32(&req.n, sizeof(req), RTA_TABLE, actual_table);
 
@@ -2518,6 +2639,117 @@ int kernel_get_ipmr_sg_stats(struct zebra_vrf *zvrf, void *in)
 	return suc;
 }
 
+/* state of the kernel_get_ipmr_sg_stats_bulk() dump in progress */
+static struct ipmr_stats_dump {
+	int family;
+	uint32_t table;
+	void (*cb)(void *mroute, void *arg);
+	void *arg;
+} *ipmr_dump;
+
+static int netlink_ipmr_stats_dump_read(struct nlmsghdr *h, ns_id_t ns_id,
+					int startup)
+{
+	struct ipmr_stats_dump *dump = ipmr_dump;
+	struct mcast_route_data mr = {};
+	struct rtmsg *rtm;
+	struct rtattr *tb[RTA_MAX + 1];
+	struct rta_mfc_stats *mfcs;
+	uint32_t table;
+	int len;
+
+	assert(dump);
+
+	if (h->nlmsg_type != RTM_NEWROUTE)
+		return 0;
+
+	rtm = NLMSG_DATA(h);
+	len = h->nlmsg_len - NLMSG_LENGTH(sizeof(struct rtmsg));
+	if (len < 0)
+		return -1;
+
+	if (rtm->rtm_family != (dump->family == AF_INET ? RTNL_FAMILY_IPMR
+							: RTNL_FAMILY_IP6MR))
+		return 0;
+
+	netlink_parse_rtattr(tb, RTA_MAX, RTM_RTA(rtm), len);
+
+	/* the kernel dumps the entries of all multicast tables */
+	if (tb[RTA_TABLE])
+		table = *(uint32_t *)RTA_DATA(tb[RTA_TABLE]);
+	else
+		table = rtm->rtm_table;
+	if (table != dump->table)
+		return 0;
+
+	/* (*,*) and (*,G) proxy entries have no source */
+	if (!tb[RTA_SRC] || !tb[RTA_DST])
+		return 0;
+
+	mr.family = dump->family;
+	if (dump->family == AF_INET) {
+		SET_IPADDR_V4(&mr.src);
+		SET_IPADDR_V4(&mr.grp);
+		mr.src.ipaddr_v4 = *(struct in_addr *)RTA_DATA(tb[RTA_SRC]);
+		mr.grp.ipaddr_v4 = *(struct in_addr *)RTA_DATA(tb[RTA_DST]);
+	} else {
+		SET_IPADDR_V6(&mr.src);
+		SET_IPADDR_V6(&mr.grp);
+		mr.src.ipaddr_v6 = *(struct in6_addr *)RTA_DATA(tb[RTA_SRC]);
+		mr.grp.ipaddr_v6 = *(struct in6_addr *)RTA_DATA(tb[RTA_DST]);
+	}
+
+	if (tb[RTA_IIF])
+		mr.ifindex = *(int *)RTA_DATA(tb[RTA_IIF]);
+
+	if (tb[RTA_EXPIRES])
+		mr.lastused = *(unsigned long long *)RTA_DATA(tb[RTA_EXPIRES]);
+
+	if (tb[RTA_MFC_STATS]) {
+		mfcs = RTA_DATA(tb[RTA_MFC_STATS]);
+		mr.pktcnt = mfcs->mfcs_packets;
+		mr.bytecnt = mfcs->mfcs_bytes;
+		mr.wrong_if = mfcs->mfcs_wrong_if;
+	}
+
+	dump->cb(&mr, dump->arg);
+	return 0;
+}
+
+/*
+ * Dump the whole multicast table of a vrf in one go, instead of asking for
+ * every (S,G) on its own.
+ */
+int kernel_get_ipmr_sg_stats_bulk(struct zebra_vrf *zvrf, int family,
+				  void (*cb)(void *mroute, void *arg), void *arg)
+{
+	struct ipmr_stats_dump dump = {
+		.family = family,
+		.table = ipmr_table_id(zvrf, family),
+		.cb = cb,
+		.arg = arg,
+	};
+	struct zebra_dplane_info dp_info;
+	struct zebra_ns *zns = zvrf->zns;
+	int ret;
+
+	zebra_dplane_info_from_zns(&dp_info, zns, true /*is_cmd*/);
+
+	ret = netlink_request_route(&zns->netlink_cmd,
+				    family == AF_INET ? RTNL_FAMILY_IPMR
+						      : RTNL_FAMILY_IP6MR,
+				    RTM_GETROUTE);
+	if (ret < 0)
+		return ret;
+
+	ipmr_dump = &dump;
+	ret = netlink_parse_info(netlink_ipmr_stats_dump_read,
+				 &zns->netlink_cmd, &dp_info, 0, false);
+	ipmr_dump = NULL;
+
+	return ret;
+}
+
 /* Char length to debug ID with */
 #define ID_LENGTH 10
 
@@ -20,6 +20,7 @@
 #include "vrf.h"
 #include "ns.h"
 #include "lib_errors.h"
+#include "network.h"
 
 #include "zebra/interface.h"
 #include "zebra/rtadv.h"
@@ -80,6 +81,7 @@ DECLARE_RBTREE_UNIQ(rtadv_prefixes, struct rtadv_prefix, item,
 
 DEFINE_MTYPE_STATIC(ZEBRA, RTADV_RDNSS, "Router Advertisement RDNSS");
 DEFINE_MTYPE_STATIC(ZEBRA, RTADV_DNSSL, "Router Advertisement DNSSL");
+DEFINE_MTYPE_STATIC(ZEBRA, RTADV_PACKET, "Router Advertisement packet");
 
 /* Order is intentional.  Matches RFC4191.  This array is also used for
    command matching, so only modify with care. */
@@ -178,59 +180,17 @@ static int rtadv_recv_packet(struct zebra_vrf *zvrf, int sock, uint8_t *buf,
 
 #define RTADV_MSG_SIZE 4096
 
-/* Send router advertisement packet. */
-static void rtadv_send_packet(int sock, struct interface *ifp,
-			      enum ipv6_nd_suppress_ra_status stop)
+/* Build the router advertisement for ifp into buf, return its length */
+static size_t rtadv_build_packet(struct interface *ifp,
+				 enum ipv6_nd_suppress_ra_status stop,
+				 uint8_t *buf)
 {
-	struct msghdr msg;
-	struct iovec iov;
-	struct cmsghdr *cmsgptr;
-	struct in6_pktinfo *pkt;
-	struct sockaddr_in6 addr;
-	static void *adata = NULL;
-	unsigned char buf[RTADV_MSG_SIZE];
+	struct zebra_if *zif = ifp->info;
 	struct nd_router_advert *rtadv;
-	int ret;
-	int len = 0;
-	struct zebra_if *zif;
 	struct rtadv_prefix *rprefix;
-	uint8_t all_nodes_addr[] = {0xff, 0x02, 0, 0, 0, 0, 0, 0,
-				    0,    0,    0, 0, 0, 0, 0, 1};
 	struct listnode *node;
 	uint16_t pkt_RouterLifetime;
-
-	/*
-	 * Allocate control message bufffer.  This is dynamic because
-	 * CMSG_SPACE is not guaranteed not to call a function.  Note that
-	 * the size will be different on different architectures due to
-	 * differing alignment rules.
-	 */
-	if (adata == NULL) {
-		/* XXX Free on shutdown. */
-		adata = calloc(1, CMSG_SPACE(sizeof(struct in6_pktinfo)));
-
-		if (adata == NULL) {
-			zlog_debug("%s: can't malloc control data", __func__);
-			exit(-1);
-		}
-	}
-
-	/* Logging of packet. */
-	if (IS_ZEBRA_DEBUG_PACKET)
-		zlog_debug("%s(%s:%u): Tx RA, socket %u", ifp->name,
-			   ifp->vrf->name, ifp->ifindex, sock);
-
-	/* Fill in sockaddr_in6. */
-	memset(&addr, 0, sizeof(struct sockaddr_in6));
-	addr.sin6_family = AF_INET6;
-#ifdef SIN6_LEN
-	addr.sin6_len = sizeof(struct sockaddr_in6);
-#endif /* SIN6_LEN */
-	addr.sin6_port = htons(IPPROTO_ICMPV6);
-	IPV6_ADDR_COPY(&addr.sin6_addr, all_nodes_addr);
-
-	/* Fetch interface information. */
-	zif = ifp->info;
+	size_t len = 0;
 
 	/* Make router advertisement message. */
 	rtadv = (struct nd_router_advert *)buf;
@@ -380,7 +340,7 @@ static void rtadv_send_packet(int sock, struct interface *ifp,
 	 * to exceed the link's MTU (risking fragmentation) or even
 	 * blow the stack buffer allocated for it.
 	 */
-	size_t max_len = MIN(ifp->mtu6 - 40, sizeof(buf));
+	size_t max_len = MIN(ifp->mtu6 - 40, RTADV_MSG_SIZE);
 
 	/* Recursive DNS servers */
 	struct rtadv_rdnss *rdnss;
@@ -446,41 +406,237 @@ static void rtadv_send_packet(int sock, struct interface *ifp,
 
 no_more_opts:
 
-	msg.msg_name = (void *)&addr;
-	msg.msg_namelen = sizeof(struct sockaddr_in6);
-	msg.msg_iov = &iov;
-	msg.msg_iovlen = 1;
-	msg.msg_control = (void *)adata;
-	msg.msg_controllen = CMSG_SPACE(sizeof(struct in6_pktinfo));
-	msg.msg_flags = 0;
-	iov.iov_base = buf;
-	iov.iov_len = len;
+	return len;
+}
+
+static void rtadv_packet_invalidate(struct zebra_if *zif)
+{
+	XFREE(MTYPE_RTADV_PACKET, zif->rtadv.packet);
+	zif->rtadv.packet_len = 0;
+}
+
+/*
+ * The periodic advertisement of an interface only changes with its
+ * configuration, which invalidates the stored copy, or with the link
+ * layer address and MTU, which are checked here.  Advertisements with a
+ * zero lifetime are sent rarely enough to always be built from scratch.
+ */
+static const uint8_t *rtadv_packet_get(struct zebra_vrf *zvrf,
+				       struct interface *ifp,
+				       enum ipv6_nd_suppress_ra_status stop,
+				       uint8_t *buf, size_t *len)
+{
+	struct rtadvconf *rtadv = &((struct zebra_if *)ifp->info)->rtadv;
+
+	if (stop == RA_SUPPRESS) {
+		*len = rtadv_build_packet(ifp, stop, buf);
+		return buf;
+	}
+
+	if (rtadv->packet && rtadv->packet_mtu6 == ifp->mtu6
+	    && rtadv->packet_hw_addr_len == ifp->hw_addr_len
+	    && !memcmp(rtadv->packet_hw_addr, ifp->hw_addr,
+		       ifp->hw_addr_len)) {
+		zvrf->rtadv.stats.reused++;
+		*len = rtadv->packet_len;
+		return rtadv->packet;
+	}
+
+	XFREE(MTYPE_RTADV_PACKET, rtadv->packet);
+	rtadv->packet_len = rtadv_build_packet(ifp, stop, buf);
+	rtadv->packet = XMALLOC(MTYPE_RTADV_PACKET, rtadv->packet_len);
+	memcpy(rtadv->packet, buf, rtadv->packet_len);
+	rtadv->packet_mtu6 = ifp->mtu6;
+	rtadv->packet_hw_addr_len = ifp->hw_addr_len;
+	memcpy(rtadv->packet_hw_addr, ifp->hw_addr, ifp->hw_addr_len);
+	zvrf->rtadv.stats.built++;
+
+	*len = rtadv->packet_len;
+	return rtadv->packet;
+}
+
+/* ff02::1, the port of raw sockets defaults to their protocol */
+static const struct sockaddr_in6 rtadv_all_nodes = {
+	.sin6_family = AF_INET6,
+#ifdef SIN6_LEN
+	.sin6_len = sizeof(struct sockaddr_in6),
+#endif /* SIN6_LEN */
+	.sin6_addr = { .s6_addr = { 0xff, 0x02, 0, 0, 0, 0, 0, 0,
+				    0, 0, 0, 0, 0, 0, 0, 1 } },
+};
 
-	cmsgptr = CMSG_FIRSTHDR(&msg);
+union rtadv_cmsg {
+	struct cmsghdr hdr;
+	uint8_t buf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+};
+
+static void rtadv_msg_init(struct msghdr *msg, struct iovec *iov,
+			   union rtadv_cmsg *cmsg, struct interface *ifp,
+			   const uint8_t *packet, size_t len)
+{
+	struct cmsghdr *cmsgptr;
+	struct in6_pktinfo *pkt;
+
+	memset(msg, 0, sizeof(*msg));
+	memset(cmsg, 0, sizeof(*cmsg));
+
+	msg->msg_name = (void *)&rtadv_all_nodes;
+	msg->msg_namelen = sizeof(struct sockaddr_in6);
+	msg->msg_iov = iov;
+	msg->msg_iovlen = 1;
+	msg->msg_control = cmsg->buf;
+	msg->msg_controllen = CMSG_SPACE(sizeof(struct in6_pktinfo));
+	iov->iov_base = (void *)packet;
+	iov->iov_len = len;
+
+	cmsgptr = CMSG_FIRSTHDR(msg);
 	cmsgptr->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
 	cmsgptr->cmsg_level = IPPROTO_IPV6;
 	cmsgptr->cmsg_type = IPV6_PKTINFO;
 
 	pkt = (struct in6_pktinfo *)CMSG_DATA(cmsgptr);
-	memset(&pkt->ipi6_addr, 0, sizeof(struct in6_addr));
 	pkt->ipi6_ifindex = ifp->ifindex;
+}
 
-	ret = sendmsg(sock, &msg, 0);
-	if (ret < 0) {
-		flog_err_sys(EC_LIB_SOCKET,
-			     "%s(%u): Tx RA failed, socket %u error %d (%s)",
-			     ifp->name, ifp->ifindex, sock, errno,
-			     safe_strerror(errno));
-	} else
-		zif->ra_sent++;
+static void rtadv_send_error(struct zebra_vrf *zvrf, struct interface *ifp,
+			     int sock)
+{
+	zvrf->rtadv.stats.errors++;
+	flog_err_sys(EC_LIB_SOCKET,
+		     "%s(%u): Tx RA failed, socket %u error %d (%s)",
+		     ifp->name, ifp->ifindex, sock, errno,
+		     safe_strerror(errno));
+}
+
+/* Send router advertisement packet. */
+static void rtadv_send_packet(int sock, struct interface *ifp,
+			      enum ipv6_nd_suppress_ra_status stop)
+{
+	struct zebra_vrf *zvrf = rtadv_interface_get_zvrf(ifp);
+	struct zebra_if *zif = ifp->info;
+	uint8_t buf[RTADV_MSG_SIZE];
+	union rtadv_cmsg cmsg;
+	const uint8_t *packet;
+	struct msghdr msg;
+	struct iovec iov;
+	size_t len;
+
+	/* Logging of packet. */
+	if (IS_ZEBRA_DEBUG_PACKET)
+		zlog_debug("%s(%s:%u): Tx RA, socket %u", ifp->name,
+			   ifp->vrf->name, ifp->ifindex, sock);
+
+	packet = rtadv_packet_get(zvrf, ifp, stop, buf, &len);
+	rtadv_msg_init(&msg, &iov, &cmsg, ifp, packet, len);
+
+	if (sendmsg(sock, &msg, 0) < 0) {
+		rtadv_send_error(zvrf, ifp, sock);
+		return;
+	}
+
+	zif->ra_sent++;
+	zvrf->rtadv.stats.sent++;
+	zvrf->rtadv.stats.batches++;
+}
+
+/*
+ * Periodic advertisements due in the same timer run are handed to the
+ * kernel together.  They all come from the stored copies, so only the
+ * headers are set up per interface.
+ */
+#define RTADV_TX_BATCH 64
+
+struct rtadv_tx_batch {
+	struct zebra_vrf *zvrf;
+	unsigned int count;
+
+	struct interface *ifp[RTADV_TX_BATCH];
+	struct mmsghdr mmsg[RTADV_TX_BATCH];
+	struct iovec iov[RTADV_TX_BATCH];
+	union rtadv_cmsg cmsg[RTADV_TX_BATCH];
+};
+
+/* a few dozen KB, too much for the stack */
+static struct rtadv_tx_batch rtadv_tx_batch;
+
+static void rtadv_tx_batch_flush(struct rtadv_tx_batch *batch)
+{
+	struct zebra_vrf *zvrf = batch->zvrf;
+	int sock = zvrf->rtadv.sock;
+	unsigned int pos = 0;
+	int ret;
+
+	while (pos < batch->count) {
+		ret = sendmmsg(sock, batch->mmsg + pos, batch->count - pos, 0);
+		zvrf->rtadv.stats.batches++;
+
+		if (ret <= 0) {
+			/* skip the message that failed, try the rest */
+			rtadv_send_error(zvrf, batch->ifp[pos], sock);
+			pos++;
+			continue;
+		}
+
+		for (; ret > 0; ret--, pos++) {
+			((struct zebra_if *)batch->ifp[pos]->info)->ra_sent++;
+			zvrf->rtadv.stats.sent++;
+		}
+	}
+
+	batch->count = 0;
+}
+
+static void rtadv_tx_batch_add(struct rtadv_tx_batch *batch,
+			       struct interface *ifp)
+{
+	uint8_t buf[RTADV_MSG_SIZE];
+	unsigned int i = batch->count;
+	const uint8_t *packet;
+	size_t len;
+
+	if (IS_ZEBRA_DEBUG_PACKET)
+		zlog_debug("%s(%s:%u): Tx RA, socket %u", ifp->name,
+			   ifp->vrf->name, ifp->ifindex,
+			   batch->zvrf->rtadv.sock);
+
+	/* RA_ENABLE always returns the stored copy, buf isn't kept */
+	packet = rtadv_packet_get(batch->zvrf, ifp, RA_ENABLE, buf, &len);
+
+	batch->ifp[i] = ifp;
+	rtadv_msg_init(&batch->mmsg[i].msg_hdr, &batch->iov[i],
+		       &batch->cmsg[i], ifp, packet, len);
+	batch->mmsg[i].msg_len = 0;
+
+	if (++batch->count == RTADV_TX_BATCH)
+		rtadv_tx_batch_flush(batch);
+}
+
+/*
+ * RFC 4861 6.2.4: the time between unsolicited advertisements is a random
+ * value between MinRtrAdvInterval and MaxRtrAdvInterval.  This also keeps
+ * interfaces that were set up together from all coming due in the same
+ * timer run forever.
+ */
+static int rtadv_interval_jitter(const struct zebra_if *zif)
+{
+	int max = zif->rtadv.MaxRtrAdvInterval;
+	int min = zif->rtadv.MinRtrAdvInterval;
+
+	if (min <= 0 || min >= max)
+		return max;
+
+	return min + frr_weak_random() % (max - min + 1);
 }
 
 static void rtadv_timer(struct event *thread)
 {
 	struct zebra_vrf *zvrf = EVENT_ARG(thread);
+	struct rtadv_tx_batch *batch;
 	struct vrf *vrf;
 	struct interface *ifp;
 	struct zebra_if *zif;
+	struct timeval start;
+	int64_t usec;
 	int period;
 
 	zvrf->rtadv.ra_timer = NULL;
@@ -492,6 +648,14 @@ static void rtadv_timer(struct event *thread)
 		rtadv_event(zvrf, RTADV_TIMER_MSEC, 10 /* 10 ms */);
 	}
 
+	monotime(&start);
+	if (!zvrf->rtadv.stats.start.tv_sec)
+		zvrf->rtadv.stats.start = start;
+
+	batch = &rtadv_tx_batch;
+	batch->zvrf = zvrf;
+	batch->count = 0;
+
 	RB_FOREACH (vrf, vrf_id_head, &vrfs_by_id)
 		FOR_ALL_INTERFACES (vrf, ifp) {
 			if (if_is_loopback(ifp) || !if_is_operative(ifp) ||
@@ -520,26 +684,26 @@ static void rtadv_timer(struct event *thread)
 							ifp->vrf->name,
 							ifp->ifindex);
 
-					rtadv_send_packet(zvrf->rtadv.sock, ifp,
-							  RA_ENABLE);
+					rtadv_tx_batch_add(batch, ifp);
 				} else {
 					zif->rtadv.AdvIntervalTimer -= period;
 					if (zif->rtadv.AdvIntervalTimer <= 0) {
-						/* FIXME: using
-						   MaxRtrAdvInterval each
-						   time isn't what section
-						   6.2.4 of RFC4861 tells to do.
-						   */
 						zif->rtadv.AdvIntervalTimer =
-							zif->rtadv
-								.MaxRtrAdvInterval;
-						rtadv_send_packet(
-							zvrf->rtadv.sock, ifp,
-							RA_ENABLE);
+							rtadv_interval_jitter(
+								zif);
+						rtadv_tx_batch_add(batch, ifp);
 					}
 				}
 			}
 		}
+
+	rtadv_tx_batch_flush(batch);
+
+	usec = monotime_since(&start, NULL);
+	zvrf->rtadv.stats.runs++;
+	zvrf->rtadv.stats.run_usec += usec;
+	if (usec > (int64_t)zvrf->rtadv.stats.run_usec_max)
+		zvrf->rtadv.stats.run_usec_max = usec;
 }
 
 static void rtadv_process_solicit(struct interface *ifp)
@@ -1151,6 +1315,7 @@ static void rtadv_prefix_set(struct zebra_if *zif, struct rtadv_prefix *rp)
 {
 	struct rtadv_prefix *rprefix;
 
+	rtadv_packet_invalidate(zif);
 	rprefix = rtadv_prefix_get(zif->rtadv.prefixes, &rp->prefix);
 
 	/*
@@ -1188,6 +1353,7 @@ static int rtadv_prefix_reset(struct zebra_if *zif, struct rtadv_prefix *rp)
 
 	rprefix = rtadv_prefixes_find(zif->rtadv.prefixes, rp);
 	if (rprefix != NULL) {
+		rtadv_packet_invalidate(zif);
 
 		/*
 		 * When deleting an address from the list, need to take care
@@ -1362,6 +1528,7 @@ static void zebra_interface_radv_set(ZAPI_HANDLER_ARGS, int enable)
 	}
 
 	zif = ifp->info;
+	rtadv_packet_invalidate(zif);
 	if (enable) {
 		if (!CHECK_FLAG(zif->rtadv.ra_configured, BGP_RA_CONFIGURED))
 			interfaces_configured_for_ra_from_bgp++;
@@ -1456,6 +1623,29 @@ static void show_zvrf_rtadv_adv_if_helper(struct vty *vty,
 	vty_out(vty, "\n");
 }
 
+static void show_zvrf_rtadv_stats_helper(struct vty *vty,
+					 struct zebra_vrf *zvrf)
+{
+	struct rtadv_stats *stats = &zvrf->rtadv.stats;
+	int64_t usec;
+
+	usec = stats->start.tv_sec ? monotime_since(&stats->start, NULL) : 0;
+
+	vty_out(vty, "    Sent: %" PRIu64 " (%.1f/s), errors: %" PRIu64 "\n",
+		stats->sent, usec ? stats->sent * 1e6 / usec : 0.0,
+		stats->errors);
+	vty_out(vty, "    System calls: %" PRIu64 ", %.1f packets per call\n",
+		stats->batches,
+		stats->batches ? (double)stats->sent / stats->batches : 0.0);
+	vty_out(vty, "    Encoded: %" PRIu64 ", reused: %" PRIu64 "\n",
+		stats->built, stats->reused);
+	vty_out(vty,
+		"    Timer runs: %" PRIu64 ", average %" PRIu64
+		" usec, max %" PRIu64 " usec\n",
+		stats->runs, stats->runs ? stats->run_usec / stats->runs : 0,
+		stats->run_usec_max);
+}
+
 static void show_zvrf_rtadv_helper(struct vty *vty, struct zebra_vrf *zvrf)
 {
 	vty_out(vty, "VRF: %s\n", zvrf_name(zvrf));
@@ -1464,6 +1654,9 @@ static void show_zvrf_rtadv_helper(struct vty *vty, struct zebra_vrf *zvrf)
 
 	vty_out(vty, "  Interfaces(msec):\n");
 	show_zvrf_rtadv_adv_if_helper(vty, &zvrf->rtadv.adv_msec_if);
+
+	vty_out(vty, "  Transmit:\n");
+	show_zvrf_rtadv_stats_helper(vty, zvrf);
 }
 
 DEFPY(show_ipv6_nd_ra_if, show_ipv6_nd_ra_if_cmd,
@@ -1573,6 +1766,7 @@ DEFPY (ipv6_nd_ra_hop_limit,
 	}
 
 	zif->rtadv.AdvCurHopLimit = hopcount;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -1596,6 +1790,7 @@ DEFPY (no_ipv6_nd_ra_hop_limit,
 	}
 
 	zif->rtadv.AdvCurHopLimit = RTADV_DEFAULT_HOPLIMIT;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -1618,6 +1813,7 @@ DEFPY (ipv6_nd_ra_retrans_interval,
 	}
 
 	zif->rtadv.AdvRetransTimer = interval;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -1641,6 +1837,7 @@ DEFPY (no_ipv6_nd_ra_retrans_interval,
 	}
 
 	zif->rtadv.AdvRetransTimer = 0;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -1728,6 +1925,7 @@ DEFUN (ipv6_nd_ra_interval_msec,
 	SET_FLAG(zif->rtadv.ra_configured, VTY_RA_INTERVAL_CONFIGURED);
 	zif->rtadv.MaxRtrAdvInterval = interval;
 	zif->rtadv.MinRtrAdvInterval = 0.33 * interval;
+	rtadv_packet_invalidate(zif);
 	zif->rtadv.AdvIntervalTimer = 0;
 
 	return CMD_SUCCESS;
@@ -1770,6 +1968,7 @@ DEFUN (ipv6_nd_ra_interval,
 	SET_FLAG(zif->rtadv.ra_configured, VTY_RA_INTERVAL_CONFIGURED);
 	zif->rtadv.MaxRtrAdvInterval = interval;
 	zif->rtadv.MinRtrAdvInterval = 0.33 * interval;
+	rtadv_packet_invalidate(zif);
 	zif->rtadv.AdvIntervalTimer = 0;
 
 	return CMD_SUCCESS;
@@ -1808,6 +2007,7 @@ DEFUN (no_ipv6_nd_ra_interval,
 
 	zif->rtadv.AdvIntervalTimer = zif->rtadv.MaxRtrAdvInterval;
 	zif->rtadv.MinRtrAdvInterval = RTADV_MIN_RTR_ADV_INTERVAL;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -1838,6 +2038,7 @@ DEFUN (ipv6_nd_ra_lifetime,
 	}
 
 	zif->rtadv.AdvDefaultLifetime = lifetime;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -1855,6 +2056,7 @@ DEFUN (no_ipv6_nd_ra_lifetime,
 	struct zebra_if *zif = ifp->info;
 
 	zif->rtadv.AdvDefaultLifetime = -1;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -1871,6 +2073,7 @@ DEFUN (ipv6_nd_reachable_time,
 	VTY_DECLVAR_CONTEXT(interface, ifp);
 	struct zebra_if *zif = ifp->info;
 	zif->rtadv.AdvReachableTime = strtoul(argv[idx_number]->arg, NULL, 10);
+	rtadv_packet_invalidate(zif);
 	return CMD_SUCCESS;
 }
 
@@ -1887,6 +2090,7 @@ DEFUN (no_ipv6_nd_reachable_time,
 	struct zebra_if *zif = ifp->info;
 
 	zif->rtadv.AdvReachableTime = 0;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -1904,6 +2108,7 @@ DEFUN (ipv6_nd_homeagent_preference,
 	struct zebra_if *zif = ifp->info;
 	zif->rtadv.HomeAgentPreference =
 		strtoul(argv[idx_number]->arg, NULL, 10);
+	rtadv_packet_invalidate(zif);
 	return CMD_SUCCESS;
 }
 
@@ -1920,6 +2125,7 @@ DEFUN (no_ipv6_nd_homeagent_preference,
 	struct zebra_if *zif = ifp->info;
 
 	zif->rtadv.HomeAgentPreference = 0;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -1936,6 +2142,7 @@ DEFUN (ipv6_nd_homeagent_lifetime,
 	VTY_DECLVAR_CONTEXT(interface, ifp);
 	struct zebra_if *zif = ifp->info;
 	zif->rtadv.HomeAgentLifetime = strtoul(argv[idx_number]->arg, NULL, 10);
+	rtadv_packet_invalidate(zif);
 	return CMD_SUCCESS;
 }
 
@@ -1952,6 +2159,7 @@ DEFUN (no_ipv6_nd_homeagent_lifetime,
 	struct zebra_if *zif = ifp->info;
 
 	zif->rtadv.HomeAgentLifetime = -1;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -1967,6 +2175,7 @@ DEFUN (ipv6_nd_managed_config_flag,
 	struct zebra_if *zif = ifp->info;
 
 	zif->rtadv.AdvManagedFlag = 1;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -1983,6 +2192,7 @@ DEFUN (no_ipv6_nd_managed_config_flag,
 	struct zebra_if *zif = ifp->info;
 
 	zif->rtadv.AdvManagedFlag = 0;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -1998,6 +2208,7 @@ DEFUN (ipv6_nd_homeagent_config_flag,
 	struct zebra_if *zif = ifp->info;
 
 	zif->rtadv.AdvHomeAgentFlag = 1;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -2014,6 +2225,7 @@ DEFUN (no_ipv6_nd_homeagent_config_flag,
 	struct zebra_if *zif = ifp->info;
 
 	zif->rtadv.AdvHomeAgentFlag = 0;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -2029,6 +2241,7 @@ DEFUN (ipv6_nd_adv_interval_config_option,
 	struct zebra_if *zif = ifp->info;
 
 	zif->rtadv.AdvIntervalOption = 1;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -2045,6 +2258,7 @@ DEFUN (no_ipv6_nd_adv_interval_config_option,
 	struct zebra_if *zif = ifp->info;
 
 	zif->rtadv.AdvIntervalOption = 0;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -2060,6 +2274,7 @@ DEFUN (ipv6_nd_other_config_flag,
 	struct zebra_if *zif = ifp->info;
 
 	zif->rtadv.AdvOtherConfigFlag = 1;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -2076,6 +2291,7 @@ DEFUN (no_ipv6_nd_other_config_flag,
 	struct zebra_if *zif = ifp->info;
 
 	zif->rtadv.AdvOtherConfigFlag = 0;
+	rtadv_packet_invalidate(zif);
 
 	return CMD_SUCCESS;
 }
@@ -2225,6 +2441,7 @@ DEFUN (ipv6_nd_router_preference,
 			    1)
 		    == 0) {
 			zif->rtadv.DefaultPreference = i;
+			rtadv_packet_invalidate(zif);
 			return CMD_SUCCESS;
 		}
 		i++;
@@ -2251,6 +2468,7 @@ DEFUN (no_ipv6_nd_router_preference,
 		RTADV_PREF_MEDIUM; /* Default per RFC4191. */
 
 	return CMD_SUCCESS;
+	rtadv_packet_invalidate(zif);
 }
 
 DEFUN (ipv6_nd_mtu,
@@ -2265,6 +2483,7 @@ DEFUN (ipv6_nd_mtu,
 	VTY_DECLVAR_CONTEXT(interface, ifp);
 	struct zebra_if *zif = ifp->info;
 	zif->rtadv.AdvLinkMTU = strtoul(argv[idx_number]->arg, NULL, 10);
+	rtadv_packet_invalidate(zif);
 	return CMD_SUCCESS;
 }
 
@@ -2280,6 +2499,7 @@ DEFUN (no_ipv6_nd_mtu,
 	VTY_DECLVAR_CONTEXT(interface, ifp);
 	struct zebra_if *zif = ifp->info;
 	zif->rtadv.AdvLinkMTU = 0;
+	rtadv_packet_invalidate(zif);
 	return CMD_SUCCESS;
 }
 
@@ -2328,6 +2548,7 @@ static void rtadv_rdnss_set(struct zebra_if *zif, struct rtadv_rdnss *rdnss)
 	p = rtadv_rdnss_get(zif->rtadv.AdvRDNSSList, rdnss);
 	p->lifetime = rdnss->lifetime;
 	p->lifetime_set = rdnss->lifetime_set;
+	rtadv_packet_invalidate(zif);
 }
 
 static int rtadv_rdnss_reset(struct zebra_if *zif, struct rtadv_rdnss *rdnss)
@@ -2336,6 +2557,7 @@ static int rtadv_rdnss_reset(struct zebra_if *zif, struct rtadv_rdnss *rdnss)
 
 	p = rtadv_rdnss_lookup(zif->rtadv.AdvRDNSSList, rdnss);
 	if (p) {
+		rtadv_packet_invalidate(zif);
 		listnode_delete(zif->rtadv.AdvRDNSSList, p);
 		rtadv_rdnss_free(p);
 		return 1;
@@ -2388,6 +2610,7 @@ static void rtadv_dnssl_set(struct zebra_if *zif, struct rtadv_dnssl *dnssl)
 
 	p = rtadv_dnssl_get(zif->rtadv.AdvDNSSLList, dnssl);
 	memcpy(p, dnssl, sizeof(struct rtadv_dnssl));
+	rtadv_packet_invalidate(zif);
 }
 
 static int rtadv_dnssl_reset(struct zebra_if *zif, struct rtadv_dnssl *dnssl)
@@ -2396,6 +2619,7 @@ static int rtadv_dnssl_reset(struct zebra_if *zif, struct rtadv_dnssl *dnssl)
 
 	p = rtadv_dnssl_lookup(zif->rtadv.AdvDNSSLList, dnssl);
 	if (p) {
+		rtadv_packet_invalidate(zif);
 		listnode_delete(zif->rtadv.AdvDNSSLList, p);
 		rtadv_dnssl_free(p);
 		return 1;
@@ -2900,6 +3124,7 @@ void rtadv_if_fini(struct zebra_if *zif)
 
 	list_delete(&rtadv->AdvRDNSSList);
 	list_delete(&rtadv->AdvDNSSLList);
+	rtadv_packet_invalidate(zif);
 }
 
 void rtadv_vrf_init(struct zebra_vrf *zvrf)
@@ -32,6 +32,22 @@ struct rtadv {
 
 	struct event *ra_read;
 	struct event *ra_timer;
+
+	/* transmit counters, shown in "show ipv6 nd ra-interfaces" */
+	struct rtadv_stats {
+		struct timeval start;
+		uint64_t sent;
+		uint64_t errors;
+		/* sendmsg/sendmmsg calls */
+		uint64_t batches;
+		/* advertisements encoded vs. sent from the stored copy */
+		uint64_t built;
+		uint64_t reused;
+		/* timer runs and the time spent in them */
+		uint64_t runs;
+		uint64_t run_usec;
+		uint64_t run_usec_max;
+	} stats;
 };
 
 PREDECL_RBTREE_UNIQ(rtadv_prefixes);
@@ -58,7 +74,7 @@ struct rtadvconf {
 	   MUST be no greater than .75 * MaxRtrAdvInterval.
 
 	   Default: 0.33 * MaxRtrAdvInterval */
-	int MinRtrAdvInterval; /* This field is currently unused. */
+	int MinRtrAdvInterval;
 #define RTADV_MIN_RTR_ADV_INTERVAL (0.33 * RTADV_MAX_RTR_ADV_INTERVAL)
 
 	/* Unsolicited Router Advertisements' interval timer. */
@@ -210,6 +226,16 @@ struct rtadvconf {
 #define RTADV_FAST_REXMIT_PERIOD 1 /* 1 sec */
 #define RTADV_NUM_FAST_REXMITS 4   /* Fast Rexmit RA 4 times on certain events \
 				    */
+
+	/* The encoded periodic advertisement, dropped on any configuration
+	 * change.  Link layer address and MTU are also part of it and are
+	 * compared before reuse.
+	 */
+	uint8_t *packet;
+	size_t packet_len;
+	unsigned int packet_mtu6;
+	int packet_hw_addr_len;
+	uint8_t packet_hw_addr[INTERFACE_HWADDR_MAX];
 };
 
 struct rtadv_rdnss {
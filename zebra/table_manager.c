@@ -45,10 +45,69 @@
 DEFINE_MGROUP(TABLE_MGR, "Table Manager");
 DEFINE_MTYPE_STATIC(TABLE_MGR, TM_CHUNK, "Table Manager Chunk");
 DEFINE_MTYPE_STATIC(TABLE_MGR, TM_TABLE, "Table Manager Context");
+DEFINE_MTYPE_STATIC(TABLE_MGR, TM_RANGE, "Table Manager Free Range");
 
-static void delete_table_chunk(void *val)
+static int tm_chunk_owner_cmp(const struct table_manager_chunk *a,
+			      const struct table_manager_chunk *b)
 {
-	XFREE(MTYPE_TM_CHUNK, val);
+	if (a->proto != b->proto)
+		return numcmp(a->proto, b->proto);
+	if (a->instance != b->instance)
+		return numcmp(a->instance, b->instance);
+	return numcmp(a->start, b->start);
+}
+
+static int tm_chunk_start_cmp(const struct table_manager_chunk *a,
+			      const struct table_manager_chunk *b)
+{
+	return numcmp(a->start, b->start);
+}
+
+DECLARE_RBTREE_UNIQ(tm_chunks_owner, struct table_manager_chunk, owner_item,
+		    tm_chunk_owner_cmp);
+DECLARE_RBTREE_UNIQ(tm_chunks_start, struct table_manager_chunk, start_item,
+		    tm_chunk_start_cmp);
+
+static void delete_table_chunk(struct table_manager *tbl_mgr,
+			       struct table_manager_chunk *tmc)
+{
+	tm_chunks_owner_del(&tbl_mgr->chunks_owner, tmc);
+	tm_chunks_start_del(&tbl_mgr->chunks_start, tmc);
+	id_ranges_release(&tbl_mgr->free, tmc->start, tmc->end);
+	XFREE(MTYPE_TM_CHUNK, tmc);
+}
+
+/*
+ * (Re)build the free table RT IDs from the configured range.  Only done
+ * while no chunk is assigned, since a range change is otherwise taken into
+ * account at restart.
+ */
+static void table_manager_reset_free(struct table_manager *tbl_mgr)
+{
+	id_ranges_flush(&tbl_mgr->free);
+
+	if (tbl_mgr->start || tbl_mgr->end) {
+		id_ranges_release(&tbl_mgr->free, tbl_mgr->start, tbl_mgr->end);
+		return;
+	}
+
+#if !defined(GNU_LINUX)
+/* BSD systems
+ */
+	id_ranges_release(&tbl_mgr->free, RT_TABLE_ID_UNRESERVED_MIN,
+			  RT_TABLE_ID_UNRESERVED_MAX);
+#else
+/* Linux Systems
+ */
+	/* table RT IDs range are [1;251] and [256;0xffffffff]
+	 * - TODO : vrf-lites have their own table identifier.
+	 * In that case, table_id should be removed from the table range.
+	 */
+	id_ranges_release(&tbl_mgr->free, RT_TABLE_ID_UNRESERVED_MIN,
+			  RT_TABLE_ID_COMPAT - 1);
+	id_ranges_release(&tbl_mgr->free, RT_TABLE_ID_LOCAL + 1,
+			  RT_TABLE_ID_UNRESERVED_MAX);
+#endif /* !def(GNU_LINUX) */
 }
 
 /**
@@ -68,15 +127,16 @@ void table_manager_enable(struct zebra_vrf *zvrf)
 		return;
 	}
 	zvrf->tbl_mgr = XCALLOC(MTYPE_TM_TABLE, sizeof(struct table_manager));
-	zvrf->tbl_mgr->lc_list = list_new();
-	zvrf->tbl_mgr->lc_list->del = delete_table_chunk;
+	tm_chunks_owner_init(&zvrf->tbl_mgr->chunks_owner);
+	tm_chunks_start_init(&zvrf->tbl_mgr->chunks_start);
+	id_ranges_init(&zvrf->tbl_mgr->free, MTYPE_TM_RANGE);
 }
 
 /**
  * Core function, assigns table chunks
  *
- * It first searches through the list to check if there's one available
- * (previously released). Otherwise it creates and assigns a new one
+ * The chunk is taken from the smallest free range of table RT IDs that
+ * fits it, so that released chunks get reused first.
  *
  * @param proto Daemon protocol of client, to identify the owner
  * @param instance Instance, to identify the owner
@@ -88,81 +148,30 @@ struct table_manager_chunk *assign_table_chunk(uint8_t proto, uint16_t instance,
 					       struct zebra_vrf *zvrf)
 {
 	struct table_manager_chunk *tmc;
-	struct listnode *node;
+	struct table_manager *tbl_mgr;
 	uint32_t start;
-	bool manual_conf = false;
 
 	if (!zvrf)
 		return NULL;
 
-	/* first check if there's one available */
-	for (ALL_LIST_ELEMENTS_RO(zvrf->tbl_mgr->lc_list, node, tmc)) {
-		if (tmc->proto == NO_PROTO
-		    && tmc->end - tmc->start + 1 == size) {
-			tmc->proto = proto;
-			tmc->instance = instance;
-			return tmc;
-		}
-	}
-	/* otherwise create a new one */
-	tmc = XCALLOC(MTYPE_TM_CHUNK, sizeof(struct table_manager_chunk));
-
-	if (zvrf->tbl_mgr->start || zvrf->tbl_mgr->end)
-		manual_conf = true;
-	/* table RT IDs range are [1;252] and [256;0xffffffff]
-	 * - check if the requested range can be within the first range,
-	 * otherwise elect second one
-	 * - TODO : vrf-lites have their own table identifier.
-	 * In that case, table_id should be removed from the table range.
-	 */
-	if (list_isempty(zvrf->tbl_mgr->lc_list)) {
-		if (!manual_conf)
-			start = RT_TABLE_ID_UNRESERVED_MIN;
-		else
-			start = zvrf->tbl_mgr->start;
-	} else
-		start = ((struct table_manager_chunk *)listgetdata(
-				 listtail(zvrf->tbl_mgr->lc_list)))
-				->end
-			+ 1;
-
-	if (!manual_conf) {
+	tbl_mgr = zvrf->tbl_mgr;
+	if (!tm_chunks_owner_count(&tbl_mgr->chunks_owner))
+		table_manager_reset_free(tbl_mgr);
 
-#if !defined(GNU_LINUX)
-/* BSD systems
- */
-#else
-/* Linux Systems
- */
-		/* if not enough room space between MIN and COMPAT,
-		 * then begin after LOCAL
-		 */
-		if (start < RT_TABLE_ID_COMPAT
-		    && (size > RT_TABLE_ID_COMPAT - RT_TABLE_ID_UNRESERVED_MIN))
-			start = RT_TABLE_ID_LOCAL + 1;
-#endif /* !def(GNU_LINUX) */
-		tmc->start = start;
-		if (RT_TABLE_ID_UNRESERVED_MAX - size + 1 < start) {
-			flog_err(EC_ZEBRA_TM_EXHAUSTED_IDS,
-				 "Reached max table id. Start/Size %u/%u",
-				 start, size);
-			XFREE(MTYPE_TM_CHUNK, tmc);
-			return NULL;
-		}
-	} else {
-		tmc->start = start;
-		if (zvrf->tbl_mgr->end - size + 1 < start) {
-			flog_err(EC_ZEBRA_TM_EXHAUSTED_IDS,
-				 "Reached max table id. Start/Size %u/%u",
-				 start, size);
-			XFREE(MTYPE_TM_CHUNK, tmc);
-			return NULL;
-		}
+	if (!id_ranges_alloc(&tbl_mgr->free, size, &start)) {
+		flog_err(EC_ZEBRA_TM_EXHAUSTED_IDS,
+			 "Reached max table id. No free range of size %u",
+			 size);
+		return NULL;
 	}
-	tmc->end = tmc->start + size - 1;
+
+	tmc = XCALLOC(MTYPE_TM_CHUNK, sizeof(struct table_manager_chunk));
+	tmc->start = start;
+	tmc->end = start + size - 1;
 	tmc->proto = proto;
 	tmc->instance = instance;
-	listnode_add(zvrf->tbl_mgr->lc_list, tmc);
+	tm_chunks_owner_add(&tbl_mgr->chunks_owner, tmc);
+	tm_chunks_start_add(&tbl_mgr->chunks_start, tmc);
 
 	return tmc;
 }
@@ -179,7 +188,11 @@ struct table_manager_chunk *assign_table_chunk(uint8_t proto, uint16_t instance,
 int release_table_chunk(uint8_t proto, uint16_t instance, uint32_t start,
 			uint32_t end, struct zebra_vrf *zvrf)
 {
-	struct listnode *node;
+	struct table_manager_chunk ref = {
+		.proto = proto,
+		.instance = instance,
+		.start = start,
+	};
 	struct table_manager_chunk *tmc;
 	int ret = -1;
 	struct table_manager *tbl_mgr;
@@ -192,21 +205,16 @@ int release_table_chunk(uint8_t proto, uint16_t instance, uint32_t start,
 		return ret;
 	/* check that size matches */
 	zlog_debug("Releasing table chunk: %u - %u", start, end);
-	/* find chunk and disown */
-	for (ALL_LIST_ELEMENTS_RO(tbl_mgr->lc_list, node, tmc)) {
-		if (tmc->start != start)
-			continue;
-		if (tmc->end != end)
-			continue;
-		if (tmc->proto != proto || tmc->instance != instance) {
+	/* find chunk and give its IDs back */
+	tmc = tm_chunks_owner_find(&tbl_mgr->chunks_owner, &ref);
+	if (tmc && tmc->end == end) {
+		delete_table_chunk(tbl_mgr, tmc);
+		ret = 0;
+	} else {
+		tmc = tm_chunks_start_find(&tbl_mgr->chunks_start, &ref);
+		if (tmc && tmc->end == end)
 			flog_err(EC_ZEBRA_TM_DAEMON_MISMATCH,
 				 "%s: Daemon mismatch!!", __func__);
-			continue;
-		}
-		tmc->proto = NO_PROTO;
-		tmc->instance = 0;
-		ret = 0;
-		break;
 	}
 	if (ret != 0)
 		flog_err(EC_ZEBRA_TM_UNRELEASED_CHUNK,
@@ -226,14 +234,15 @@ int release_table_chunk(uint8_t proto, uint16_t instance, uint32_t start,
  */
 int release_daemon_table_chunks(struct zserv *client)
 {
-	uint8_t proto = client->proto;
-	uint16_t instance = client->instance;
-	struct listnode *node;
-	struct table_manager_chunk *tmc;
+	struct table_manager_chunk ref = {
+		.proto = client->proto,
+		.instance = client->instance,
+	};
+	struct table_manager_chunk *tmc, *next;
 	int count = 0;
-	int ret;
 	struct vrf *vrf;
 	struct zebra_vrf *zvrf;
+	struct table_manager *tbl_mgr;
 
 	RB_FOREACH (vrf, vrf_name_head, &vrfs_by_name) {
 		zvrf = vrf->info;
@@ -242,14 +251,15 @@ int release_daemon_table_chunks(struct zserv *client)
 			continue;
 		if (!vrf_is_backend_netns() && vrf->vrf_id != VRF_DEFAULT)
 			continue;
-		for (ALL_LIST_ELEMENTS_RO(zvrf->tbl_mgr->lc_list, node, tmc)) {
-			if (tmc->proto == proto && tmc->instance == instance) {
-				ret = release_table_chunk(
-					tmc->proto, tmc->instance, tmc->start,
-					tmc->end, zvrf);
-				if (ret == 0)
-					count++;
-			}
+		tbl_mgr = zvrf->tbl_mgr;
+		/* the client's chunks are contiguous in the owner index */
+		tmc = tm_chunks_owner_find_gteq(&tbl_mgr->chunks_owner, &ref);
+		while (tmc && tmc->proto == ref.proto
+		       && tmc->instance == ref.instance) {
+			next = tm_chunks_owner_next(&tbl_mgr->chunks_owner, tmc);
+			delete_table_chunk(tbl_mgr, tmc);
+			count++;
+			tmc = next;
 		}
 	}
 	zlog_debug("%s: Released %d table chunks", __func__, count);
@@ -268,6 +278,8 @@ static void table_range_add(struct zebra_vrf *zvrf, uint32_t start,
 
 void table_manager_disable(struct zebra_vrf *zvrf)
 {
+	struct table_manager_chunk *tmc;
+
 	if (!zvrf->tbl_mgr)
 		return;
 	if (!vrf_is_backend_netns()
@@ -275,7 +287,13 @@ void table_manager_disable(struct zebra_vrf *zvrf)
 		zvrf->tbl_mgr = NULL;
 		return;
 	}
-	list_delete(&zvrf->tbl_mgr->lc_list);
+	while ((tmc = tm_chunks_owner_pop(&zvrf->tbl_mgr->chunks_owner))) {
+		tm_chunks_start_del(&zvrf->tbl_mgr->chunks_start, tmc);
+		XFREE(MTYPE_TM_CHUNK, tmc);
+	}
+	tm_chunks_owner_fini(&zvrf->tbl_mgr->chunks_owner);
+	tm_chunks_start_fini(&zvrf->tbl_mgr->chunks_start);
+	id_ranges_fini(&zvrf->tbl_mgr->free);
 	XFREE(MTYPE_TM_TABLE, zvrf->tbl_mgr);
 	zvrf->tbl_mgr = NULL;
 }
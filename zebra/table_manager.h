@@ -11,13 +11,18 @@
 #include "lib/linklist.h"
 #include "frrevent.h"
 #include "lib/ns.h"
+#include "lib/typesafe.h"
 
 #include "zebra/zserv.h"
+#include "zebra/id_ranges.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+PREDECL_RBTREE_UNIQ(tm_chunks_owner);
+PREDECL_RBTREE_UNIQ(tm_chunks_start);
+
 /*
  * Table chunk struct
  * Client daemon which the chunk belongs to can be identified by either
@@ -36,14 +41,20 @@ struct table_manager_chunk {
 	uint16_t instance;
 	uint32_t start; /* First table RT ID of the chunk */
 	uint32_t end;   /* Last table RT ID of the chunk */
+
+	struct tm_chunks_owner_item owner_item;
+	struct tm_chunks_start_item start_item;
 };
 
 /*
  * Main table manager struct
- * Holds a linked list of table chunks.
+ * Holds the assigned table chunks, by owner and by first table RT ID, and
+ * the IDs that are still free.
  */
 struct table_manager {
-	struct list *lc_list;
+	struct tm_chunks_owner_head chunks_owner;
+	struct tm_chunks_start_head chunks_start;
+	struct id_ranges free;
 	uint32_t start;
 	uint32_t end;
 };
@@ -22,6 +22,7 @@
 #include "lib/vrf.h"
 #include "lib/libfrr.h"
 #include "lib/lib_errors.h"
+#include "lib/frr_pthread.h"
 
 #include "zebra/zebra_router.h"
 #include "zebra/rib.h"
@@ -51,6 +52,7 @@
 #include "zebra/zebra_srv6.h"
 
 DEFINE_MTYPE_STATIC(ZEBRA, RE_OPAQUE, "Route Opaque Data");
+DEFINE_MTYPE_STATIC(ZEBRA, REDIST_UPDATE, "Pending redistributed route");
 
 static int zapi_nhg_decode(struct stream *s, int cmd, struct zapi_nhg *api_nhg);
 
@@ -156,6 +158,69 @@ static void zserv_encode_error(struct stream *s, enum zebra_error_types error)
 
 /* Send handlers ----------------------------------------------------------- */
 
+/*
+ * ZEBRA_INTERFACE_UP/DOWN updates to a client are collected into one
+ * ZEBRA_INTERFACE_STATE_BULK message, so a flap of thousands of interfaces
+ * isn't as many messages (and reads, and hook runs) for every daemon.  The
+ * message is sent at the end of the event loop pass, or before any other
+ * interface, vrf or redistributed route message to the client, so what the
+ * client sees stays in the order it happened.
+ *
+ * Each entry is the command, the entry length and the interface in the
+ * layout of ZEBRA_INTERFACE_UP.  An entry is at most ZAPI_IFSTATE_ENTRY_MAX:
+ * the fixed fields, the hardware address and the link parameters with the
+ * largest extended admin group.
+ */
+#define ZAPI_IFSTATE_ENTRY_MAX                                                 \
+	(2 + 2 + INTERFACE_NAMSIZ + 48 + INTERFACE_HWADDR_MAX + 1 +           \
+	 (64 + MAX_CLASS_TYPE * 4) + UINT8_MAX * 4)
+
+static void zsend_redistribute_flush(struct zserv *client, bool force);
+
+static void interface_state_batch_send(struct zserv *client)
+{
+	struct stream *s = client->ifstate_batch.s;
+
+	EVENT_OFF(client->ifstate_batch.t_flush);
+	if (!s)
+		return;
+
+	client->ifstate_batch.s = NULL;
+	stream_putw_at(s, client->ifstate_batch.countp,
+		       client->ifstate_batch.count);
+	stream_putw_at(s, 0, stream_get_endp(s));
+
+	client->ifstate_bulk_cnt++;
+	zrouter.if_stats.bulk_msgs++;
+	zrouter.if_stats.bulk_max = MAX(zrouter.if_stats.bulk_max,
+					client->ifstate_batch.count);
+
+	zserv_send_message(client, s);
+}
+
+/*
+ * Send everything the client has pending before another interface or vrf
+ * message: the interface state updates, then the redistributed routes
+ * queued after them.
+ */
+void zsend_interface_state_flush(struct zserv *client)
+{
+	interface_state_batch_send(client);
+	zsend_redistribute_flush(client, true);
+}
+
+static void interface_state_batch_timer(struct event *thread)
+{
+	zsend_interface_state_flush(EVENT_ARG(thread));
+}
+
+void zsend_interface_state_discard(struct zserv *client)
+{
+	EVENT_OFF(client->ifstate_batch.t_flush);
+	stream_free(client->ifstate_batch.s);
+	client->ifstate_batch.s = NULL;
+}
+
 /* Interface is added. Send ZEBRA_INTERFACE_ADD to client. */
 /*
  * This function is called in the following situations:
@@ -171,6 +236,7 @@ int zsend_interface_add(struct zserv *client, struct interface *ifp)
 {
 	struct stream *s = stream_new(ZEBRA_MAX_PACKET_SIZ);
 
+	zsend_interface_state_flush(client);
 	zclient_create_header(s, ZEBRA_INTERFACE_ADD, ifp->vrf->vrf_id);
 	zserv_encode_interface(s, ifp);
 
@@ -183,6 +249,7 @@ int zsend_interface_delete(struct zserv *client, struct interface *ifp)
 {
 	struct stream *s = stream_new(ZEBRA_MAX_PACKET_SIZ);
 
+	zsend_interface_state_flush(client);
 	zclient_create_header(s, ZEBRA_INTERFACE_DELETE, ifp->vrf->vrf_id);
 	zserv_encode_interface(s, ifp);
 
@@ -194,6 +261,7 @@ int zsend_vrf_add(struct zserv *client, struct zebra_vrf *zvrf)
 {
 	struct stream *s = stream_new(ZEBRA_MAX_PACKET_SIZ);
 
+	zsend_interface_state_flush(client);
 	zclient_create_header(s, ZEBRA_VRF_ADD, zvrf_id(zvrf));
 	zserv_encode_vrf(s, zvrf);
 
@@ -207,6 +275,7 @@ int zsend_vrf_delete(struct zserv *client, struct zebra_vrf *zvrf)
 {
 	struct stream *s = stream_new(ZEBRA_MAX_PACKET_SIZ);
 
+	zsend_interface_state_flush(client);
 	zclient_create_header(s, ZEBRA_VRF_DELETE, zvrf_id(zvrf));
 	zserv_encode_vrf(s, zvrf);
 
@@ -232,6 +301,7 @@ int zsend_interface_link_params(struct zserv *client, struct interface *ifp)
 	/* Write packet size. */
 	stream_putw_at(s, 0, stream_get_endp(s));
 
+	zsend_interface_state_flush(client);
 	return zserv_send_message(client, s);
 }
 
@@ -280,6 +350,7 @@ int zsend_interface_address(int cmd, struct zserv *client,
 	struct prefix *p;
 	struct stream *s = stream_new(ZEBRA_MAX_PACKET_SIZ);
 
+	zsend_interface_state_flush(client);
 	zclient_create_header(s, cmd, ifp->vrf->vrf_id);
 	stream_putl(s, ifp->ifindex);
 
@@ -322,6 +393,7 @@ static int zsend_interface_nbr_address(int cmd, struct zserv *client,
 	struct stream *s = stream_new(ZEBRA_MAX_PACKET_SIZ);
 	struct prefix *p;
 
+	zsend_interface_state_flush(client);
 	zclient_create_header(s, cmd, ifp->vrf->vrf_id);
 	stream_putl(s, ifp->ifindex);
 
@@ -440,6 +512,7 @@ int zsend_interface_vrf_update(struct zserv *client, struct interface *ifp,
 {
 	struct stream *s = stream_new(ZEBRA_MAX_PACKET_SIZ);
 
+	zsend_interface_state_flush(client);
 	zclient_create_header(s, ZEBRA_INTERFACE_VRF_UPDATE, ifp->vrf->vrf_id);
 
 	/* Fill in the name of the interface and its new VRF (id) */
@@ -510,26 +583,264 @@ void nbr_connected_delete_ipv6(struct interface *ifp, struct in6_addr *address)
  *   - an if_up is detected e.g., as a result of an RTM_IFINFO message
  *   - a vty command modifying the bandwidth of an interface is received.
  * The ZEBRA_INTERFACE_DOWN message is sent when an if_down is detected.
+ *
+ * Both are added to the client's ZEBRA_INTERFACE_STATE_BULK message.
  */
 int zsend_interface_update(int cmd, struct zserv *client, struct interface *ifp)
 {
-	struct stream *s = stream_new(ZEBRA_MAX_PACKET_SIZ);
+	struct stream *s = client->ifstate_batch.s;
+	vrf_id_t vrf_id = ifp->vrf->vrf_id;
+	size_t lenp;
+
+	if (s && (client->ifstate_batch.vrf_id != vrf_id ||
+		  client->ifstate_batch.count == UINT16_MAX ||
+		  STREAM_WRITEABLE(s) < ZAPI_IFSTATE_ENTRY_MAX)) {
+		interface_state_batch_send(client);
+		s = NULL;
+	}
 
-	zclient_create_header(s, cmd, ifp->vrf->vrf_id);
+	if (!s) {
+		s = stream_new(ZEBRA_MAX_PACKET_SIZ);
+		zclient_create_header(s, ZEBRA_INTERFACE_STATE_BULK, vrf_id);
+		client->ifstate_batch.countp = stream_get_endp(s);
+		stream_putw(s, 0);
+
+		client->ifstate_batch.s = s;
+		client->ifstate_batch.count = 0;
+		client->ifstate_batch.vrf_id = vrf_id;
+
+		event_add_event(zrouter.master, interface_state_batch_timer,
+				client, 0, &client->ifstate_batch.t_flush);
+	}
+
+	stream_putw(s, cmd);
+	lenp = stream_get_endp(s);
+	stream_putw(s, 0);
 	zserv_encode_interface(s, ifp);
+	stream_putw_at(s, lenp, stream_get_endp(s) - lenp - 2);
+	client->ifstate_batch.count++;
 
 	if (cmd == ZEBRA_INTERFACE_UP)
 		client->ifup_cnt++;
 	else
 		client->ifdown_cnt++;
+	zrouter.if_stats.state_updates++;
 
-	return zserv_send_message(client, s);
+	return 0;
+}
+
+/*
+ * Redistributed routes are not sent in a message each.  An update is
+ * encoded as it would be on its own and kept for the client, replacing an
+ * update for the same route (vrf, type, instance, prefix and source
+ * prefix) that hasn't gone out yet, so a route changing a number of times
+ * in a burst is sent once, as it ended up.  At the end of the event loop
+ * pass, or before any interface or vrf message to the client, the pending
+ * updates are sent oldest first, in ZEBRA_REDISTRIBUTE_ROUTE_BULK
+ * messages: a count, then each update as a complete message.
+ *
+ * While the client isn't keeping up, i.e. ZSERV_REDIST_FIFO_MAX messages
+ * or more are waiting on its output fifo, the updates stay here (and are
+ * coalesced further) instead of going on the fifo.
+ */
+#define ZSERV_REDIST_FIFO_MAX 32
+#define ZSERV_REDIST_RETRY_MSEC 10
+
+struct zserv_redist_update {
+	struct zserv_redist_pending_item hitem;
+	struct zserv_redist_order_item oitem;
+
+	vrf_id_t vrf_id;
+	uint8_t type;
+	uint16_t instance;
+	struct prefix p;
+	struct prefix src_p;
+
+	/* the encoded message */
+	uint16_t len;
+	uint8_t msg[];
+};
+
+static int zserv_redist_update_cmp(const struct zserv_redist_update *a,
+				   const struct zserv_redist_update *b)
+{
+	int ret;
+
+	if (a->vrf_id != b->vrf_id)
+		return numcmp(a->vrf_id, b->vrf_id);
+	if (a->type != b->type)
+		return numcmp(a->type, b->type);
+	if (a->instance != b->instance)
+		return numcmp(a->instance, b->instance);
+
+	ret = prefix_cmp(&a->p, &b->p);
+	if (ret)
+		return ret;
+	return prefix_cmp(&a->src_p, &b->src_p);
+}
+
+static uint32_t zserv_redist_update_hash(const struct zserv_redist_update *a)
+{
+	uint32_t key = prefix_hash_key(&a->p);
+
+	if (a->src_p.prefixlen)
+		key = jhash_1word(prefix_hash_key(&a->src_p), key);
+	return jhash_3words(a->vrf_id, a->type, a->instance, key);
+}
+
+DECLARE_HASH(zserv_redist_pending, struct zserv_redist_update, hitem,
+	     zserv_redist_update_cmp, zserv_redist_update_hash);
+DECLARE_DLIST(zserv_redist_order, struct zserv_redist_update, oitem);
+
+static void zsend_redistribute_timer(struct event *thread);
+
+void zsend_redistribute_init(struct zserv *client)
+{
+	zserv_redist_pending_init(&client->redist_pending);
+	zserv_redist_order_init(&client->redist_order);
+}
+
+void zsend_redistribute_discard(struct zserv *client)
+{
+	struct zserv_redist_update *upd;
+
+	EVENT_OFF(client->t_redist_flush);
+
+	while ((upd = zserv_redist_order_pop(&client->redist_order))) {
+		zserv_redist_pending_del(&client->redist_pending, upd);
+		XFREE(MTYPE_REDIST_UPDATE, upd);
+	}
+	zserv_redist_pending_fini(&client->redist_pending);
+	zserv_redist_order_fini(&client->redist_order);
+}
+
+size_t zsend_redistribute_backlog(struct zserv *client)
+{
+	return zserv_redist_order_count(&client->redist_order);
+}
+
+static bool zsend_redistribute_congested(struct zserv *client)
+{
+	size_t queued;
+
+	frr_with_mutex (&client->obuf_mtx) {
+		queued = client->obuf_fifo->count;
+	}
+
+	return queued >= ZSERV_REDIST_FIFO_MAX;
+}
+
+/*
+ * Send the pending updates, all of them if forced, else until the client's
+ * output fifo is full.
+ */
+static void zsend_redistribute_flush(struct zserv *client, bool force)
+{
+	struct zserv_redist_update *upd;
+	struct stream *s = NULL;
+	size_t countp = 0;
+	uint16_t count = 0;
+
+	EVENT_OFF(client->t_redist_flush);
+	if (!zserv_redist_order_count(&client->redist_order))
+		return;
+
+	/* what the client was told about interfaces comes first */
+	interface_state_batch_send(client);
+
+	while ((upd = zserv_redist_order_first(&client->redist_order))) {
+		if (s && (count == UINT16_MAX ||
+			  STREAM_WRITEABLE(s) < upd->len)) {
+			stream_putw_at(s, countp, count);
+			stream_putw_at(s, 0, stream_get_endp(s));
+			zserv_send_message(client, s);
+			client->redist_bulk_cnt++;
+			s = NULL;
+		}
+
+		if (!s) {
+			if (!force && zsend_redistribute_congested(client))
+				break;
+
+			s = stream_new(ZEBRA_MAX_PACKET_SIZ);
+			zclient_create_header(s, ZEBRA_REDISTRIBUTE_ROUTE_BULK,
+					      VRF_DEFAULT);
+			countp = stream_get_endp(s);
+			stream_putw(s, 0);
+			count = 0;
+		}
+
+		stream_put(s, upd->msg, upd->len);
+		count++;
+
+		zserv_redist_order_del(&client->redist_order, upd);
+		zserv_redist_pending_del(&client->redist_pending, upd);
+		XFREE(MTYPE_REDIST_UPDATE, upd);
+	}
+
+	if (s) {
+		stream_putw_at(s, countp, count);
+		stream_putw_at(s, 0, stream_get_endp(s));
+		zserv_send_message(client, s);
+		client->redist_bulk_cnt++;
+	}
+
+	if (zserv_redist_order_count(&client->redist_order))
+		event_add_timer_msec(zrouter.master, zsend_redistribute_timer,
+				     client, ZSERV_REDIST_RETRY_MSEC,
+				     &client->t_redist_flush);
+}
+
+static void zsend_redistribute_timer(struct event *thread)
+{
+	zsend_redistribute_flush(EVENT_ARG(thread), false);
+}
+
+static void zsend_redistribute_queue(struct zserv *client,
+				     const struct zapi_route *api,
+				     struct stream *s)
+{
+	struct zserv_redist_update *upd, *old;
+	size_t len = stream_get_endp(s);
+
+	/* can't be part of a bulk message, send it after what is pending */
+	if (len > ZEBRA_MAX_PACKET_SIZ - ZEBRA_HEADER_SIZE - 2) {
+		zsend_redistribute_flush(client, true);
+		zserv_send_message(client, stream_dup(s));
+		return;
+	}
+
+	upd = XCALLOC(MTYPE_REDIST_UPDATE, sizeof(*upd) + len);
+	upd->vrf_id = api->vrf_id;
+	upd->type = api->type;
+	upd->instance = api->instance;
+	prefix_copy(&upd->p, &api->prefix);
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX))
+		prefix_copy(&upd->src_p, &api->src_prefix);
+	upd->len = len;
+	memcpy(upd->msg, STREAM_DATA(s), len);
+
+	old = zserv_redist_pending_find(&client->redist_pending, upd);
+	if (old) {
+		zserv_redist_pending_del(&client->redist_pending, old);
+		zserv_redist_order_del(&client->redist_order, old);
+		XFREE(MTYPE_REDIST_UPDATE, old);
+		client->redist_coalesced_cnt++;
+	}
+
+	zserv_redist_pending_add(&client->redist_pending, upd);
+	zserv_redist_order_add_tail(&client->redist_order, upd);
+
+	if (!client->t_redist_flush)
+		event_add_event(zrouter.master, zsend_redistribute_timer,
+				client, 0, &client->t_redist_flush);
 }
 
 int zsend_redistribute_route(int cmd, struct zserv *client,
 			     const struct route_node *rn,
 			     const struct route_entry *re)
 {
+	struct stream *s;
 	struct zapi_route api;
 	struct zapi_nexthop *api_nh;
 	struct nexthop *nexthop;
@@ -621,9 +932,9 @@ int zsend_redistribute_route(int cmd, struct zserv *client,
 	SET_FLAG(api.message, ZAPI_MESSAGE_MTU);
 	api.mtu = re->mtu;
 
-	struct stream *s = stream_new(stream_size);
+	s = stream_new(stream_size);
 
-	/* Encode route and send. */
+	/* Encode route and queue it. */
 	if (zapi_route_encode(cmd, s, &api) < 0) {
 		stream_free(s);
 		return -1;
@@ -635,7 +946,10 @@ int zsend_redistribute_route(int cmd, struct zserv *client,
 			   zebra_route_string(client->proto),
 			   zebra_route_string(api.type), api.vrf_id,
 			   &api.prefix);
-	return zserv_send_message(client, s);
+
+	zsend_redistribute_queue(client, &api, s);
+	stream_free(s);
+	return 0;
 }
 
 /*
@@ -729,6 +1043,94 @@ int zsend_nhg_notify(uint16_t type, uint16_t instance, uint32_t session_id,
 	return zserv_send_message(client, s);
 }
 
+/* Send the route notifications collected for the client so far */
+static void route_notify_batch_flush(struct zserv *client)
+{
+	struct stream *s = client->notify_batch.s;
+
+	EVENT_OFF(client->notify_batch.t_flush);
+	if (!s)
+		return;
+
+	client->notify_batch.s = NULL;
+	stream_putw_at(s, client->notify_batch.countp,
+		       client->notify_batch.count);
+	stream_putw_at(s, 0, stream_get_endp(s));
+
+	zserv_send_message(client, s);
+}
+
+static void route_notify_batch_timer(struct event *thread)
+{
+	route_notify_batch_flush(EVENT_ARG(thread));
+}
+
+void zsend_route_notify_batch_discard(struct zserv *client)
+{
+	EVENT_OFF(client->notify_batch.t_flush);
+	stream_free(client->notify_batch.s);
+	client->notify_batch.s = NULL;
+}
+
+/*
+ * Add a notification to the client's batch.  The batch is sent when a
+ * notification with different parameters comes along, so the client
+ * sees all of them in the order they were generated.
+ */
+static int route_notify_batch_add(struct zserv *client,
+				  const struct route_node *rn, vrf_id_t vrf_id,
+				  uint32_t table_id,
+				  enum zapi_route_notify_owner note, afi_t afi,
+				  safi_t safi)
+{
+	struct stream *s = client->notify_batch.s;
+	int psize = PSIZE(rn->p.prefixlen);
+
+	if (s &&
+	    (client->notify_batch.vrf_id != vrf_id ||
+	     client->notify_batch.note != note ||
+	     client->notify_batch.table_id != table_id ||
+	     client->notify_batch.afi != afi ||
+	     client->notify_batch.safi != safi ||
+	     client->notify_batch.family != rn->p.family ||
+	     client->notify_batch.count == UINT16_MAX ||
+	     STREAM_WRITEABLE(s) < (size_t)psize + 1)) {
+		route_notify_batch_flush(client);
+		s = NULL;
+	}
+
+	if (!s) {
+		s = stream_new(ZEBRA_MAX_PACKET_SIZ);
+		zclient_create_header(s, ZEBRA_ROUTE_NOTIFY_OWNER_BATCH,
+				      vrf_id);
+		stream_put(s, &note, sizeof(note));
+		stream_putc(s, rn->p.family);
+		stream_putl(s, table_id);
+		stream_putc(s, afi);
+		stream_putc(s, safi);
+		client->notify_batch.countp = stream_get_endp(s);
+		stream_putw(s, 0);
+
+		client->notify_batch.s = s;
+		client->notify_batch.count = 0;
+		client->notify_batch.vrf_id = vrf_id;
+		client->notify_batch.note = note;
+		client->notify_batch.table_id = table_id;
+		client->notify_batch.afi = afi;
+		client->notify_batch.safi = safi;
+		client->notify_batch.family = rn->p.family;
+
+		event_add_event(zrouter.master, route_notify_batch_timer,
+				client, 0, &client->notify_batch.t_flush);
+	}
+
+	stream_putc(s, rn->p.prefixlen);
+	stream_put(s, &rn->p.u.prefix, psize);
+	client->notify_batch.count++;
+
+	return 0;
+}
+
 /*
  * Common utility send route notification, called from a path using a
  * route_entry and from a path using a dataplane context.
@@ -758,6 +1160,10 @@ static int route_notify_internal(const struct route_node *rn, int type,
 			"Notifying Owner: %s about prefix %pRN(%u) %d vrf: %u",
 			zebra_route_string(type), rn, table_id, note, vrf_id);
 
+	if (client->notify_owner_batch)
+		return route_notify_batch_add(client, rn, vrf_id, table_id,
+					      note, afi, safi);
+
 	/* We're just allocating a small-ish buffer here, since we only
 	 * encode a small amount of data.
 	 */
@@ -814,6 +1220,14 @@ static void zread_route_notify_request(ZAPI_HANDLER_ARGS)
 
 	STREAM_GETC(msg, notify);
 	client->notify_owner = notify;
+
+	/* older clients do not send this */
+	if (STREAM_READABLE(msg)) {
+		uint8_t batch;
+
+		STREAM_GETC(msg, batch);
+		client->notify_owner_batch = !!batch;
+	}
 stream_failure:
 	return;
 }
@@ -2177,6 +2591,117 @@ static void zread_route_add(ZAPI_HANDLER_ARGS)
 	}
 }
 
+/* Install one route of a ZEBRA_ROUTE_ADD_BATCH message */
+static void zread_route_batch_add_one(struct zserv *client,
+				      struct zebra_vrf *zvrf,
+				      const struct zapi_route *api,
+				      struct prefix *p)
+{
+	struct route_entry *re;
+	int ret;
+
+	re = zebra_rib_route_entry_new(
+		zvrf_id(zvrf), api->type, api->instance, api->flags,
+		api->nhgid, api->tableid ? api->tableid : zvrf->table_id,
+		api->metric, api->mtu, api->distance, api->tag);
+
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_OPAQUE)) {
+		re->opaque =
+			XMALLOC(MTYPE_RE_OPAQUE,
+				sizeof(struct re_opaque) + api->opaque.length);
+		re->opaque->length = api->opaque.length;
+		memcpy(re->opaque->data, api->opaque.data, re->opaque->length);
+	}
+
+	ret = rib_add_multipath_nhe(family2afi(p->family), api->safi, p,
+				    NULL, re, NULL, false);
+	if (ret == -1) {
+		client->error_cnt++;
+		XFREE(MTYPE_RE_OPAQUE, re->opaque);
+		XFREE(MTYPE_RE, re);
+	}
+
+	/* Stats */
+	switch (p->family) {
+	case AF_INET:
+		if (ret == 0)
+			client->v4_route_add_cnt++;
+		else if (ret == 1)
+			client->v4_route_upd8_cnt++;
+		break;
+	case AF_INET6:
+		if (ret == 0)
+			client->v6_route_add_cnt++;
+		else if (ret == 1)
+			client->v6_route_upd8_cnt++;
+		break;
+	}
+}
+
+/*
+ * Routes sharing a nexthop group and all other attributes, see
+ * zclient_route_send_batch().  The message starts out like a regular
+ * route add, the attributes are decoded only once for the whole batch.
+ */
+static void zread_route_add_batch(ZAPI_HANDLER_ARGS)
+{
+	struct stream *s;
+	struct zapi_route api;
+	struct prefix p;
+	uint16_t count = 0, i = 0;
+
+	s = msg;
+	if (zapi_route_decode(s, &api) < 0) {
+		if (IS_ZEBRA_DEBUG_RECV)
+			zlog_debug("%s: Unable to decode zapi_route sent",
+				   __func__);
+		return;
+	}
+
+	if (!CHECK_FLAG(api.message, ZAPI_MESSAGE_NHG) ||
+	    CHECK_FLAG(api.message, ZAPI_MESSAGE_SRCPFX)) {
+		flog_warn(EC_LIB_ZAPI_MISSMATCH,
+			  "%s: client %s: route batch without nexthop group ID or with source prefix",
+			  __func__, zebra_route_string(client->proto));
+		return;
+	}
+
+	if (api.safi != SAFI_UNICAST && api.safi != SAFI_MULTICAST) {
+		flog_warn(EC_LIB_ZAPI_MISSMATCH,
+			  "%s: Received safi: %d but we can only accept UNICAST or MULTICAST",
+			  __func__, api.safi);
+		return;
+	}
+
+	STREAM_GETW(s, count);
+
+	if (IS_ZEBRA_DEBUG_RECV)
+		zlog_debug(
+			"%s: p=(%u:%u)%pFX and %u more, nhg %u, msg flags=0x%x, flags=0x%x",
+			__func__, zvrf_id(zvrf), api.tableid, &api.prefix,
+			count, api.nhgid, (int)api.message, api.flags);
+
+	zread_route_batch_add_one(client, zvrf, &api, &api.prefix);
+
+	for (i = 0; i < count; i++) {
+		memset(&p, 0, sizeof(p));
+		p.family = api.prefix.family;
+		STREAM_GETC(s, p.prefixlen);
+		if (p.prefixlen > prefix_blen(&p) * 8)
+			goto stream_failure;
+		STREAM_GET(&p.u.prefix, s, PSIZE(p.prefixlen));
+
+		zread_route_batch_add_one(client, zvrf, &api, &p);
+	}
+
+	return;
+
+stream_failure:
+	flog_warn(EC_LIB_ZAPI_MISSMATCH,
+		  "%s: client %s: truncated route batch, %u of %u routes read",
+		  __func__, zebra_route_string(client->proto), i, count);
+}
+
 void zapi_re_opaque_free(struct re_opaque *opaque)
 {
 	XFREE(MTYPE_RE_OPAQUE, opaque);
@@ -2365,6 +2890,15 @@ static void zread_hello(ZAPI_HANDLER_ARGS)
 	if (notify)
 		client->notify_owner = true;
 
+	/* older clients do not send this */
+	if (STREAM_READABLE(msg)) {
+		uint8_t notify_batch;
+
+		STREAM_GETC(msg, notify_batch);
+		if (notify_batch)
+			client->notify_owner_batch = true;
+	}
+
 	if (synchronous)
 		client->synchronous = true;
 
@@ -3510,19 +4044,22 @@ static inline void zread_ipset_entry(ZAPI_HANDLER_ARGS)
 		if (zpi.proto != 0)
 			zpi.filter_bm |= PBR_FILTER_PROTO;
 
+		/* a message can carry many entries (bgpd batches flowspec
+		 * derived ones), a bad one must not take the rest with it
+		 */
 		if (!(zpi.dst.family == AF_INET
 		      || zpi.dst.family == AF_INET6)) {
 			zlog_warn(
 				"Unsupported PBR destination IP family: %s (%hhu)",
 				family2str(zpi.dst.family), zpi.dst.family);
-			goto stream_failure;
+			continue;
 		}
 		if (!(zpi.src.family == AF_INET
 		      || zpi.src.family == AF_INET6)) {
 			zlog_warn(
 				"Unsupported PBR source IP family: %s (%hhu)",
 				family2str(zpi.src.family), zpi.src.family);
-			goto stream_failure;
+			continue;
 		}
 
 		/* calculate backpointer */
@@ -3532,7 +4069,7 @@ static inline void zread_ipset_entry(ZAPI_HANDLER_ARGS)
 		if (!zpi.backpointer) {
 			zlog_warn("ipset name specified: %s does not exist",
 				  ipset.ipset_name);
-			goto stream_failure;
+			continue;
 		}
 
 		if (hdr->command == ZEBRA_IPSET_ENTRY_ADD)
@@ -3881,6 +4418,7 @@ void (*const zserv_handlers[])(ZAPI_HANDLER_ARGS) = {
 	[ZEBRA_MPLS_LABELS_DELETE] = zread_mpls_labels_delete,
 	[ZEBRA_MPLS_LABELS_REPLACE] = zread_mpls_labels_replace,
 	[ZEBRA_IPMR_ROUTE_STATS] = zebra_ipmr_route_stats,
+	[ZEBRA_IPMR_ROUTE_STATS_BULK] = zebra_ipmr_route_stats_bulk,
 	[ZEBRA_LABEL_MANAGER_CONNECT] = zread_label_manager_request,
 	[ZEBRA_LABEL_MANAGER_CONNECT_ASYNC] = zread_label_manager_request,
 	[ZEBRA_GET_LABEL_CHUNK] = zread_label_manager_request,
@@ -3941,6 +4479,7 @@ void (*const zserv_handlers[])(ZAPI_HANDLER_ARGS) = {
 	[ZEBRA_TC_CLASS_DELETE] = zread_tc_class,
 	[ZEBRA_TC_FILTER_ADD] = zread_tc_filter,
 	[ZEBRA_TC_FILTER_DELETE] = zread_tc_filter,
+	[ZEBRA_ROUTE_ADD_BATCH] = zread_route_add_batch,
 };
 
 /*
@@ -3952,6 +4491,7 @@ void zserv_handle_commands(struct zserv *client, struct stream_fifo *fifo)
 	struct zebra_vrf *zvrf;
 	struct stream *msg;
 	struct stream_fifo temp_fifo;
+	struct timeval start;
 
 	stream_fifo_init(&temp_fifo);
 
@@ -4003,7 +4543,10 @@ void zserv_handle_commands(struct zserv *client, struct stream_fifo *fifo)
 			goto continue_loop;
 		}
 
+		monotime(&start);
 		zserv_handlers[hdr.command](client, &hdr, msg, zvrf);
+		zserv_cmd_stats_handled(client, hdr.command,
+					monotime_since(&start, NULL));
 
 continue_loop:
 		stream_free(msg);
@@ -54,6 +54,10 @@ extern int zsend_interface_update(int cmd, struct zserv *client,
 extern int zsend_redistribute_route(int cmd, struct zserv *zclient,
 				    const struct route_node *rn,
 				    const struct route_entry *re);
+extern void zsend_redistribute_init(struct zserv *client);
+extern void zsend_redistribute_discard(struct zserv *client);
+/* redistributed route updates not sent to the client yet */
+extern size_t zsend_redistribute_backlog(struct zserv *client);
 
 extern int zsend_router_id_update(struct zserv *zclient, afi_t afi,
 				  struct prefix *p, vrf_id_t vrf_id);
@@ -68,6 +72,9 @@ extern int zsend_route_notify_owner(const struct route_node *rn,
 				    afi_t afi, safi_t safi);
 extern int zsend_route_notify_owner_ctx(const struct zebra_dplane_ctx *ctx,
 					enum zapi_route_notify_owner note);
+extern void zsend_route_notify_batch_discard(struct zserv *client);
+extern void zsend_interface_state_flush(struct zserv *client);
+extern void zsend_interface_state_discard(struct zserv *client);
 
 extern void zsend_rule_notify_owner(const struct zebra_dplane_ctx *ctx,
 				    enum zapi_rule_notify_owner note);
@@ -11,6 +11,7 @@
 #include "lib/libfrr.h"
 #include "lib/debug.h"
 #include "lib/frratomic.h"
+#include "lib/flightrec.h"
 #include "lib/frr_pthread.h"
 #include "lib/memory.h"
 #include "lib/zebra.h"
@@ -24,7 +25,10 @@
 #include "zebra/zebra_pbr.h"
 #include "zebra/zebra_neigh.h"
 #include "zebra/zebra_tc.h"
+#include "zebra/kernel_netlink.h"
+#include "zebra/zebra_restart.h"
 #include "printfrr.h"
+#include "json.h"
 
 /* Memory types */
 DEFINE_MTYPE_STATIC(ZEBRA, DP_CTX, "Zebra DPlane Ctx");
@@ -402,6 +406,17 @@ struct zebra_dplane_ctx {
 	/* Namespace info, used especially for netlink kernel communication */
 	struct zebra_dplane_info zd_ns_info;
 
+	/* Time the ctx was handed to its current provider, or back to zebra
+	 * main once the last provider is done with it
+	 */
+	struct timeval zd_prov_time;
+
+	/* Time the ctx was queued for the dplane pthread */
+	struct timeval zd_queue_time;
+
+	/* Time the dplane pthread picked the ctx up */
+	struct timeval zd_dplane_time;
+
 	/* Embedded list linkage */
 	struct dplane_ctx_list_item zd_entries;
 };
@@ -418,6 +433,12 @@ DECLARE_DLIST(dplane_intf_extra_list, struct dplane_intf_extra, dlink);
 /* List for dplane plugins/providers */
 PREDECL_DLIST(dplane_prov_list);
 
+/*
+ * Provider latency histogram: bucket i counts contexts that took less than
+ * 16 << (2 * i) microseconds, the last one everything above.
+ */
+#define DPLANE_LAT_BUCKETS 8
+
 /*
  * Registration block for one dataplane provider.
  */
@@ -454,6 +475,21 @@ struct zebra_dplane_provider {
 	_Atomic uint32_t dp_out_max;
 	_Atomic uint32_t dp_error_counter;
 
+	/* Configured work limit per cycle, 0 for the global default */
+	_Atomic uint32_t dp_work_limit;
+
+	/*
+	 * Configured limit on the provider's inbound queue; while it is
+	 * exceeded no new work is taken from zebra, 0 for no limit.
+	 */
+	_Atomic uint32_t dp_queue_limit;
+	_Atomic uint32_t dp_backpressure;
+
+	/* Time from handing a ctx to the provider until it comes back */
+	_Atomic uint64_t dp_lat_hist[DPLANE_LAT_BUCKETS];
+	_Atomic uint64_t dp_lat_usec;
+	_Atomic uint64_t dp_lat_max;
+
 	/* Queue of contexts inbound to the provider */
 	struct dplane_ctx_list_head dp_ctx_in_list;
 
@@ -481,10 +517,35 @@ struct dplane_zns_info {
 	/* Read event */
 	struct event *t_read;
 
+	/* Netlink reader pthread handling the socket, -1 for the dplane one */
+	int reader;
+
 	/* List linkage */
 	struct zns_info_list_item link;
 };
 
+/*
+ * Optional pthreads reading the namespaces' incoming dplane sockets, so
+ * an event storm in one namespace doesn't hold up the others, nor the
+ * dataplane's own work.  Each namespace is read by one of them, which
+ * keeps its events in order.  What they parse only becomes contexts for
+ * zebra main, like on the dplane pthread.
+ */
+#define DPLANE_READERS_MAX 16
+
+struct dplane_reader {
+	struct frr_pthread *pthread;
+
+	_Atomic uint32_t zns_count;
+	_Atomic uint64_t reads;
+};
+
+struct dplane_stage_stats {
+	uint64_t count;
+	uint64_t usec;
+	uint64_t usec_max;
+};
+
 /*
  * Globals
  */
@@ -577,6 +638,15 @@ static struct zebra_dplane_globals {
 
 	_Atomic uint32_t dg_tcs_in;
 	_Atomic uint32_t dg_tcs_errors;
+	/* TC updates back from the kernel and the time they took */
+	_Atomic uint64_t dg_tcs_done;
+	_Atomic uint64_t dg_tcs_usec;
+	_Atomic uint64_t dg_tcs_usec_max;
+
+	/* Route update pipeline, only touched by the main pthread */
+	struct dplane_stage_stats dg_stages[DPLANE_STAGE_MAX];
+	struct timeval dg_pipe_start;
+	struct timeval dg_pipe_last;
 
 	/* Dataplane pthread */
 	struct frr_pthread *dg_pthread;
@@ -590,6 +660,10 @@ static struct zebra_dplane_globals {
 	/* Event pointer for pending shutdown check loop */
 	struct event *dg_t_shutdown_check;
 
+	/* Netlink reader pthreads, none by default */
+	uint32_t dg_reader_count;
+	struct dplane_reader dg_readers[DPLANE_READERS_MAX];
+
 } zdplane_info;
 
 /* Instantiate zns list type */
@@ -638,16 +712,140 @@ struct event_loop *dplane_get_thread_master(void)
 	return zdplane_info.dg_master;
 }
 
+/*
+ * Free context objects are cached per pthread rather than handed back to
+ * the allocator: every route, LSP, MAC, neighbor and nexthop-group update
+ * goes through one, and most of them are allocated and released on the
+ * zebra main pthread. Each pthread that touches a context gets its own
+ * pool on first use, so the fast path takes no lock.
+ */
+#define DPLANE_CTX_POOL_MAX 1024
+
+#ifndef thread_local
+#define thread_local __thread
+#endif
+
+struct dplane_ctx_pool {
+	struct dplane_ctx_pool *next;
+
+	/* Only accessed by the owning pthread */
+	struct dplane_ctx_list_head free_list;
+
+	/* Counters, read by the show command */
+	_Atomic uint32_t cached;
+	_Atomic uint64_t hits;
+	_Atomic uint64_t misses;
+	_Atomic uint64_t drops;
+};
+
+static thread_local struct dplane_ctx_pool *dplane_ctx_pool;
+
+/* All pools, for statistics and for cleanup at shutdown */
+static struct dplane_ctx_pool *dplane_ctx_pools;
+static pthread_mutex_t dplane_ctx_pools_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+/* Set once the pools were released during shutdown */
+static _Atomic bool dplane_ctx_pools_done;
+
+static struct dplane_ctx_pool *dplane_ctx_pool_get(void)
+{
+	struct dplane_ctx_pool *pool = dplane_ctx_pool;
+
+	if (pool)
+		return pool;
+
+	if (atomic_load_explicit(&dplane_ctx_pools_done, memory_order_relaxed))
+		return NULL;
+
+	pool = XCALLOC(MTYPE_DP_CTX, sizeof(*pool));
+	dplane_ctx_list_init(&pool->free_list);
+
+	pthread_mutex_lock(&dplane_ctx_pools_mtx);
+	pool->next = dplane_ctx_pools;
+	dplane_ctx_pools = pool;
+	pthread_mutex_unlock(&dplane_ctx_pools_mtx);
+
+	dplane_ctx_pool = pool;
+	return pool;
+}
+
+/*
+ * Release all cached contexts. Only called from the main pthread once the
+ * dataplane pthread is gone; later allocations go straight to the
+ * allocator.
+ */
+static void dplane_ctx_pools_fini(void)
+{
+	struct dplane_ctx_pool *pool;
+	struct zebra_dplane_ctx *ctx;
+
+	atomic_store_explicit(&dplane_ctx_pools_done, true,
+			      memory_order_relaxed);
+
+	pthread_mutex_lock(&dplane_ctx_pools_mtx);
+	while ((pool = dplane_ctx_pools) != NULL) {
+		dplane_ctx_pools = pool->next;
+
+		while ((ctx = dplane_ctx_list_pop(&pool->free_list)))
+			XFREE(MTYPE_DP_CTX, ctx);
+
+		dplane_ctx_list_fini(&pool->free_list);
+		XFREE(MTYPE_DP_CTX, pool);
+	}
+	pthread_mutex_unlock(&dplane_ctx_pools_mtx);
+
+	dplane_ctx_pool = NULL;
+}
+
+static void dplane_ctx_pools_show(struct vty *vty)
+{
+	struct dplane_ctx_pool *pool;
+	uint64_t hits = 0, misses = 0, drops = 0, cached = 0;
+
+	pthread_mutex_lock(&dplane_ctx_pools_mtx);
+	for (pool = dplane_ctx_pools; pool; pool = pool->next) {
+		hits += atomic_load_explicit(&pool->hits,
+					     memory_order_relaxed);
+		misses += atomic_load_explicit(&pool->misses,
+					       memory_order_relaxed);
+		drops += atomic_load_explicit(&pool->drops,
+					      memory_order_relaxed);
+		cached += atomic_load_explicit(&pool->cached,
+					       memory_order_relaxed);
+	}
+	pthread_mutex_unlock(&dplane_ctx_pools_mtx);
+
+	vty_out(vty, "Context pool hits:        %" PRIu64 "\n", hits);
+	vty_out(vty, "Context pool misses:      %" PRIu64 "\n", misses);
+	vty_out(vty, "Context pool hit rate:    %" PRIu64 "%%\n",
+		(hits + misses) ? hits * 100 / (hits + misses) : 0);
+	vty_out(vty, "Context pool overflows:   %" PRIu64 "\n", drops);
+	vty_out(vty, "Context pool cached:      %" PRIu64 "\n", cached);
+}
+
 /*
  * Allocate a dataplane update context
  */
 struct zebra_dplane_ctx *dplane_ctx_alloc(void)
 {
+	struct dplane_ctx_pool *pool = dplane_ctx_pool_get();
 	struct zebra_dplane_ctx *p;
 
-	/* TODO -- just alloc'ing memory, but would like to maintain
-	 * a pool
-	 */
+	p = pool ? dplane_ctx_list_pop(&pool->free_list) : NULL;
+	if (p) {
+		memset(p, 0, sizeof(*p));
+
+		atomic_fetch_sub_explicit(&pool->cached, 1,
+					  memory_order_relaxed);
+		atomic_fetch_add_explicit(&pool->hits, 1,
+					  memory_order_relaxed);
+		return p;
+	}
+
+	if (pool)
+		atomic_fetch_add_explicit(&pool->misses, 1,
+					  memory_order_relaxed);
+
 	p = XCALLOC(MTYPE_DP_CTX, sizeof(struct zebra_dplane_ctx));
 
 	return p;
@@ -842,20 +1040,33 @@ static void dplane_ctx_free_internal(struct zebra_dplane_ctx *ctx)
  */
 static void dplane_ctx_free(struct zebra_dplane_ctx **pctx)
 {
+	struct dplane_ctx_pool *pool;
+
 	if (pctx == NULL)
 		return;
 
 	DPLANE_CTX_VALID(*pctx);
 
-	/* TODO -- just freeing memory, but would like to maintain
-	 * a pool
-	 */
-
 	/* Some internal allocations may need to be freed, depending on
 	 * the type of info captured in the ctx.
 	 */
 	dplane_ctx_free_internal(*pctx);
 
+	/* Keep the object itself for re-use, up to the per-pthread cap */
+	pool = dplane_ctx_pool_get();
+	if (pool && dplane_ctx_list_count(&pool->free_list) <
+			    DPLANE_CTX_POOL_MAX) {
+		dplane_ctx_list_add_head(&pool->free_list, *pctx);
+		atomic_fetch_add_explicit(&pool->cached, 1,
+					  memory_order_relaxed);
+		*pctx = NULL;
+		return;
+	}
+
+	if (pool)
+		atomic_fetch_add_explicit(&pool->drops, 1,
+					  memory_order_relaxed);
+
 	XFREE(MTYPE_DP_CTX, *pctx);
 }
 
@@ -874,7 +1085,6 @@ void dplane_ctx_reset(struct zebra_dplane_ctx *ctx)
  */
 void dplane_ctx_fini(struct zebra_dplane_ctx **pctx)
 {
-	/* TODO -- maintain pool; for now, just free */
 	dplane_ctx_free(pctx);
 }
 
@@ -3628,6 +3838,8 @@ static int dplane_update_enqueue(struct zebra_dplane_ctx *ctx)
 	int ret = EINVAL;
 	uint32_t high, curr;
 
+	monotime(&ctx->zd_queue_time);
+
 	/* Enqueue for processing by the dataplane pthread */
 	DPLANE_LOCK();
 	{
@@ -3641,6 +3853,9 @@ static int dplane_update_enqueue(struct zebra_dplane_ctx *ctx)
 
 	curr++;	/* We got the pre-incremented value */
 
+	flightrec("dplane_enqueue", (uintptr_t)ctx, dplane_ctx_get_op(ctx),
+		  curr);
+
 	/* Maybe update high-water counter also */
 	high = atomic_load_explicit(&zdplane_info.dg_routes_queued_max,
 				    memory_order_seq_cst);
@@ -3749,6 +3964,10 @@ dplane_route_update_internal(struct route_node *rn,
 			return ZEBRA_DPLANE_REQUEST_SUCCESS;
 		}
 
+		/* Left in the kernel by the zebra before a fast restart */
+		if (zebra_restart_route_unchanged(ctx))
+			dplane_ctx_set_skip_kernel(ctx);
+
 		/* Enqueue context for processing */
 		ret = dplane_update_enqueue(ctx);
 	}
@@ -3944,6 +4163,8 @@ dplane_nexthop_update_internal(struct nhg_hash_entry *nhe, enum dplane_op_e op)
 	}
 
 	ret = dplane_ctx_nexthop_init(ctx, op, nhe);
+	if (ret == AOK && zebra_restart_nhg_unchanged(ctx))
+		dplane_ctx_set_skip_kernel(ctx);
 	if (ret == AOK)
 		ret = dplane_update_enqueue(ctx);
 
@@ -5505,9 +5726,115 @@ int dplane_show_helper(struct vty *vty, bool detailed)
 				    memory_order_relaxed);
 	vty_out(vty, "GRE set updates:       %"PRIu64"\n", incoming);
 	vty_out(vty, "GRE set errors:        %"PRIu64"\n", errs);
+
+	incoming = atomic_load_explicit(&zdplane_info.dg_tcs_in,
+					memory_order_relaxed);
+	errs = atomic_load_explicit(&zdplane_info.dg_tcs_errors,
+				    memory_order_relaxed);
+	vty_out(vty, "TC updates:               %" PRIu64 "\n", incoming);
+	vty_out(vty, "TC errors:                %" PRIu64 "\n", errs);
+	incoming = atomic_load_explicit(&zdplane_info.dg_tcs_done,
+					memory_order_relaxed);
+	if (incoming)
+		vty_out(vty,
+			"TC latency:               avg %" PRIu64
+			" usec, max %" PRIu64 " usec\n",
+			atomic_load_explicit(&zdplane_info.dg_tcs_usec,
+					     memory_order_relaxed) /
+				incoming,
+			atomic_load_explicit(&zdplane_info.dg_tcs_usec_max,
+					     memory_order_relaxed));
+
+	dplane_ctx_pools_show(vty);
+
+#ifdef HAVE_NETLINK
+	netlink_batch_show(vty);
+#endif
+
+	for (uint32_t i = 0; i < zdplane_info.dg_reader_count; i++) {
+		struct dplane_reader *rd = &zdplane_info.dg_readers[i];
+
+		vty_out(vty,
+			"Netlink reader %u: %u namespaces, %" PRIu64 " reads\n",
+			i,
+			atomic_load_explicit(&rd->zns_count,
+					     memory_order_relaxed),
+			atomic_load_explicit(&rd->reads,
+					     memory_order_relaxed));
+	}
 	return CMD_SUCCESS;
 }
 
+/*
+ * Account for the time a ctx spent with a provider; dplane pthread only.
+ */
+static void dplane_provider_latency(struct zebra_dplane_provider *prov,
+				    const struct timeval *now,
+				    const struct zebra_dplane_ctx *ctx)
+{
+	struct timeval delta;
+	int64_t usec;
+	uint64_t high;
+	int i;
+
+	timersub(now, &ctx->zd_prov_time, &delta);
+	usec = (int64_t)delta.tv_sec * 1000000LL + delta.tv_usec;
+	if (usec < 0)
+		usec = 0;
+
+	for (i = 0; i < DPLANE_LAT_BUCKETS - 1; i++)
+		if (usec < (16LL << (2 * i)))
+			break;
+
+	atomic_fetch_add_explicit(&prov->dp_lat_hist[i], 1,
+				  memory_order_relaxed);
+	atomic_fetch_add_explicit(&prov->dp_lat_usec, usec,
+				  memory_order_relaxed);
+	high = atomic_load_explicit(&prov->dp_lat_max, memory_order_relaxed);
+	if ((uint64_t)usec > high)
+		atomic_store_explicit(&prov->dp_lat_max, usec,
+				      memory_order_relaxed);
+}
+
+static void dplane_show_prov_detail(struct vty *vty,
+				    struct zebra_dplane_provider *prov)
+{
+	uint64_t usec, lat_max, cnt[DPLANE_LAT_BUCKETS], total = 0;
+	uint32_t qlimit;
+	int i;
+
+	for (i = 0; i < DPLANE_LAT_BUCKETS; i++) {
+		cnt[i] = atomic_load_explicit(&prov->dp_lat_hist[i],
+					      memory_order_relaxed);
+		total += cnt[i];
+	}
+
+	qlimit = atomic_load_explicit(&prov->dp_queue_limit,
+				      memory_order_relaxed);
+	usec = atomic_load_explicit(&prov->dp_lat_usec, memory_order_relaxed);
+	lat_max = atomic_load_explicit(&prov->dp_lat_max,
+				       memory_order_relaxed);
+
+	vty_out(vty, "  Work limit: %d, queue limit: %u%s, threaded: %s\n",
+		dplane_provider_get_work_limit(prov), qlimit,
+		qlimit ? "" : " (none)",
+		dplane_provider_is_threaded(prov) ? "yes" : "no");
+	vty_out(vty, "  Backpressure events: %u\n",
+		atomic_load_explicit(&prov->dp_backpressure,
+				     memory_order_relaxed));
+	vty_out(vty, "  Latency: avg %" PRIu64 " usec, max %" PRIu64 " usec\n",
+		total ? usec / total : 0, lat_max);
+
+	for (i = 0; i < DPLANE_LAT_BUCKETS; i++) {
+		if (i < DPLANE_LAT_BUCKETS - 1)
+			vty_out(vty, "    < %8lld usec: %" PRIu64 "\n",
+				16LL << (2 * i), cnt[i]);
+		else
+			vty_out(vty, "    >= %7lld usec: %" PRIu64 "\n",
+				16LL << (2 * (i - 1)), cnt[i]);
+	}
+}
+
 /*
  * Handler for 'show dplane providers'
  */
@@ -5542,24 +5869,171 @@ int dplane_show_provs_helper(struct vty *vty, bool detailed)
 			prov->dp_name, prov->dp_id, in, in_q, in_max,
 			out, out_q, out_max);
 
+		if (detailed)
+			dplane_show_prov_detail(vty, prov);
+
 		prov = dplane_prov_list_next(&zdplane_info.dg_providers, prov);
 	}
 
 	return CMD_SUCCESS;
 }
 
+void dplane_stage_account(enum dplane_stage stage, const struct timeval *start,
+			  const struct timeval *now)
+{
+	struct dplane_stage_stats *st = &zdplane_info.dg_stages[stage];
+	struct timeval delta;
+	int64_t usec;
+
+	timersub(now, start, &delta);
+	usec = (int64_t)delta.tv_sec * 1000000LL + delta.tv_usec;
+	if (usec < 0)
+		usec = 0;
+
+	st->count++;
+	st->usec += usec;
+	if ((uint64_t)usec > st->usec_max)
+		st->usec_max = usec;
+}
+
+void dplane_ctx_route_result_account(const struct zebra_dplane_ctx *ctx,
+				     const struct timeval *now)
+{
+	/* throughput is over the time since the first update was queued */
+	if (!zdplane_info.dg_stages[DPLANE_STAGE_TOTAL].count)
+		zdplane_info.dg_pipe_start = ctx->zd_queue_time;
+	zdplane_info.dg_pipe_last = *now;
+
+	dplane_stage_account(DPLANE_STAGE_DPLANE_QUEUE, &ctx->zd_queue_time,
+			     &ctx->zd_dplane_time);
+	dplane_stage_account(DPLANE_STAGE_PROVIDERS, &ctx->zd_dplane_time,
+			     &ctx->zd_prov_time);
+	dplane_stage_account(DPLANE_STAGE_RESULTS, &ctx->zd_prov_time, now);
+	dplane_stage_account(DPLANE_STAGE_TOTAL, &ctx->zd_queue_time, now);
+}
+
+void dplane_pipeline_clear(void)
+{
+	memset(zdplane_info.dg_stages, 0, sizeof(zdplane_info.dg_stages));
+}
+
+int dplane_show_pipeline_helper(struct vty *vty, bool uj)
+{
+	static const char *const names[DPLANE_STAGE_MAX][2] = {
+		[DPLANE_STAGE_META_QUEUE] = { "Meta queue", "metaQueue" },
+		[DPLANE_STAGE_DPLANE_QUEUE] = { "Dplane queue", "dplaneQueue" },
+		[DPLANE_STAGE_PROVIDERS] = { "Providers", "providers" },
+		[DPLANE_STAGE_RESULTS] = { "Result queue", "resultQueue" },
+		[DPLANE_STAGE_TOTAL] = { "Total", "total" },
+	};
+	const struct dplane_stage_stats *st;
+	struct json_object *json = NULL, *jstages = NULL, *jst;
+	struct timeval delta;
+	uint64_t updates, avg;
+	double secs, rate;
+	int i;
+
+	updates = zdplane_info.dg_stages[DPLANE_STAGE_TOTAL].count;
+	timersub(&zdplane_info.dg_pipe_last, &zdplane_info.dg_pipe_start,
+		 &delta);
+	secs = updates ? delta.tv_sec + delta.tv_usec / 1000000.0 : 0;
+	rate = secs > 0 ? updates / secs : 0;
+
+	if (uj) {
+		json = json_object_new_object();
+		json_object_int_add(json, "routeUpdates", updates);
+		json_object_double_add(json, "seconds", secs);
+		json_object_double_add(json, "updatesPerSecond", rate);
+		jstages = json_object_new_object();
+		json_object_object_add(json, "stages", jstages);
+	} else {
+		vty_out(vty,
+			"Route updates: %" PRIu64 " in %.3f seconds, %.0f/s\n",
+			updates, secs, rate);
+		vty_out(vty, "%-14s %12s %12s %12s\n", "Stage", "Count",
+			"Avg (usec)", "Max (usec)");
+	}
+
+	for (i = 0; i < DPLANE_STAGE_MAX; i++) {
+		st = &zdplane_info.dg_stages[i];
+		avg = st->count ? st->usec / st->count : 0;
+
+		if (uj) {
+			jst = json_object_new_object();
+			json_object_int_add(jst, "count", st->count);
+			json_object_int_add(jst, "avgUsec", avg);
+			json_object_int_add(jst, "maxUsec", st->usec_max);
+			json_object_object_add(jstages, names[i][1], jst);
+		} else
+			vty_out(vty,
+				"%-14s %12" PRIu64 " %12" PRIu64 " %12" PRIu64
+				"\n",
+				names[i][0], st->count, avg, st->usec_max);
+	}
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
 /*
  * Helper for 'show run' etc.
  */
 int dplane_config_write_helper(struct vty *vty)
 {
+	struct zebra_dplane_provider *prov;
+	uint32_t limit;
+
 	if (zdplane_info.dg_max_queued_updates != DPLANE_DEFAULT_MAX_QUEUED)
 		vty_out(vty, "zebra dplane limit %u\n",
 			zdplane_info.dg_max_queued_updates);
 
+	frr_each (dplane_prov_list, &zdplane_info.dg_providers, prov) {
+		limit = atomic_load_explicit(&prov->dp_work_limit,
+					     memory_order_relaxed);
+		if (limit)
+			vty_out(vty, "zebra dplane provider %s work-limit %u\n",
+				prov->dp_name, limit);
+
+		limit = atomic_load_explicit(&prov->dp_queue_limit,
+					     memory_order_relaxed);
+		if (limit)
+			vty_out(vty,
+				"zebra dplane provider %s queue-limit %u\n",
+				prov->dp_name, limit);
+	}
+
 	return 0;
 }
 
+/*
+ * Configure per-provider limits; 0 resets a limit to its default.
+ */
+int dplane_provider_set_limits(const char *name, bool work, uint32_t limit)
+{
+	struct zebra_dplane_provider *prov;
+	int ret = -1;
+
+	DPLANE_LOCK();
+	frr_each (dplane_prov_list, &zdplane_info.dg_providers, prov) {
+		if (strcmp(prov->dp_name, name) != 0)
+			continue;
+
+		if (work)
+			atomic_store_explicit(&prov->dp_work_limit, limit,
+					      memory_order_relaxed);
+		else
+			atomic_store_explicit(&prov->dp_queue_limit, limit,
+					      memory_order_relaxed);
+		ret = 0;
+		break;
+	}
+	DPLANE_UNLOCK();
+
+	return ret;
+}
+
 /*
  * Provider registration
  */
@@ -5656,7 +6130,10 @@ void *dplane_provider_get_data(const struct zebra_dplane_provider *prov)
 
 int dplane_provider_get_work_limit(const struct zebra_dplane_provider *prov)
 {
-	return zdplane_info.dg_updates_per_cycle;
+	uint32_t limit = atomic_load_explicit(&prov->dp_work_limit,
+					      memory_order_relaxed);
+
+	return limit ? (int)limit : (int)zdplane_info.dg_updates_per_cycle;
 }
 
 /* Lock/unlock a provider's mutex - iff the provider was registered with
@@ -5704,7 +6181,7 @@ int dplane_provider_dequeue_in_list(struct zebra_dplane_provider *prov,
 	int limit, ret;
 	struct zebra_dplane_ctx *ctx;
 
-	limit = zdplane_info.dg_updates_per_cycle;
+	limit = dplane_provider_get_work_limit(prov);
 
 	dplane_provider_lock(prov);
 
@@ -5768,10 +6245,85 @@ bool dplane_provider_is_threaded(const struct zebra_dplane_provider *prov)
 	return (prov->dp_flags & DPLANE_PROV_FLAG_THREADED);
 }
 
+/*
+ * Set the number of netlink reader pthreads; called once at startup,
+ * before any namespace is enabled.
+ */
+void zebra_dplane_set_netlink_readers(uint32_t count)
+{
+	zdplane_info.dg_reader_count = MIN(count, DPLANE_READERS_MAX);
+}
+
+/* The least loaded reader for a new namespace, or -1 if there are none */
+static int dplane_reader_assign(void)
+{
+	uint32_t i, count, min = UINT32_MAX;
+	int reader = -1;
+
+	for (i = 0; i < zdplane_info.dg_reader_count; i++) {
+		count = atomic_load_explicit(
+			&zdplane_info.dg_readers[i].zns_count,
+			memory_order_relaxed);
+		if (count < min) {
+			min = count;
+			reader = i;
+		}
+	}
+
+	if (reader >= 0)
+		atomic_fetch_add_explicit(
+			&zdplane_info.dg_readers[reader].zns_count, 1,
+			memory_order_relaxed);
+	return reader;
+}
+
+static void dplane_reader_release(const struct dplane_zns_info *zi)
+{
+	if (zi->reader >= 0)
+		atomic_fetch_sub_explicit(
+			&zdplane_info.dg_readers[zi->reader].zns_count, 1,
+			memory_order_relaxed);
+}
+
+/*
+ * Event loop reading zi's socket: its reader pthread's, or the dplane
+ * pthread's.  NULL until the pthreads are started.
+ */
+static struct event_loop *dplane_zns_master(const struct dplane_zns_info *zi)
+{
+	struct frr_pthread *fpt;
+
+	if (zi->reader < 0)
+		return zdplane_info.dg_master;
+
+	fpt = zdplane_info.dg_readers[zi->reader].pthread;
+	return fpt ? fpt->master : NULL;
+}
+
+/*
+ * Stop zi's tasks.  From zi's own pthread they're simply cancelled,
+ * otherwise this waits for its pthread to do it.
+ */
+static void dplane_zns_cancel(struct dplane_zns_info *zi)
+{
+	struct event_loop *master = dplane_zns_master(zi);
+
+	if (!master)
+		return;
+
+	if (pthread_equal(master->owner, pthread_self())) {
+		EVENT_OFF(zi->t_read);
+		EVENT_OFF(zi->t_request);
+	} else {
+		event_cancel_async(master, &zi->t_request, NULL);
+		event_cancel_async(master, &zi->t_read, NULL);
+	}
+}
+
 #ifdef HAVE_NETLINK
 /*
  * Callback when an OS (netlink) incoming event read is ready. This runs
- * in the dplane pthread.
+ * in the dplane pthread, or in zi's netlink reader pthread.
  */
 static void dplane_incoming_read(struct event *event)
 {
@@ -5779,13 +6331,18 @@ static void dplane_incoming_read(struct event *event)
 
 	kernel_dplane_read(&zi->info);
 
+	if (zi->reader >= 0)
+		atomic_fetch_add_explicit(
+			&zdplane_info.dg_readers[zi->reader].reads, 1,
+			memory_order_relaxed);
+
 	/* Re-start read task */
-	event_add_read(zdplane_info.dg_master, dplane_incoming_read, zi,
+	event_add_read(dplane_zns_master(zi), dplane_incoming_read, zi,
 		       zi->info.sock, &zi->t_read);
 }
 
 /*
- * Callback in the dataplane pthread that requests info from the OS and
+ * Callback in the pthread reading zi that requests info from the OS and
  * initiates netlink reads.
  */
 static void dplane_incoming_request(struct event *event)
@@ -5793,7 +6350,7 @@ static void dplane_incoming_request(struct event *event)
 	struct dplane_zns_info *zi = EVENT_ARG(event);
 
 	/* Start read task */
-	event_add_read(zdplane_info.dg_master, dplane_incoming_read, zi,
+	event_add_read(dplane_zns_master(zi), dplane_incoming_read, zi,
 		       zi->info.sock, &zi->t_read);
 
 	/* Send requests */
@@ -5803,17 +6360,19 @@ static void dplane_incoming_request(struct event *event)
 /*
  * Initiate requests for existing info from the OS. This is called by the
  * main pthread, but we want all activity on the dplane netlink socket to
- * take place on the dplane pthread, so we schedule an event to accomplish
- * that.
+ * take place on the pthread reading it, so we schedule an event to
+ * accomplish that.
  */
 static void dplane_kernel_info_request(struct dplane_zns_info *zi)
 {
+	struct event_loop *master = dplane_zns_master(zi);
+
 	/* If we happen to encounter an enabled zns before the dplane
-	 * pthread is running, we'll initiate this later on.
+	 * pthreads are running, we'll initiate this later on.
 	 */
-	if (zdplane_info.dg_master)
-		event_add_event(zdplane_info.dg_master, dplane_incoming_request,
-				zi, 0, &zi->t_request);
+	if (master)
+		event_add_event(master, dplane_incoming_request, zi, 0,
+				&zi->t_request);
 }
 
 #endif /* HAVE_NETLINK */
@@ -5846,12 +6405,14 @@ void zebra_dplane_ns_enable(struct zebra_ns *zns, bool enabled)
 			zi = XCALLOC(MTYPE_DP_NS, sizeof(*zi));
 
 			zi->info.ns_id = zns->ns_id;
+			zi->reader = dplane_reader_assign();
 
 			zns_info_list_add_tail(&zdplane_info.dg_zns_list, zi);
 
 			if (IS_ZEBRA_DEBUG_DPLANE)
-				zlog_debug("%s: nsid %u, new zi %p", __func__,
-					   zns->ns_id, zi);
+				zlog_debug("%s: nsid %u, new zi %p reader %d",
+					   __func__, zns->ns_id, zi,
+					   zi->reader);
 		}
 
 		/* Make sure we're up-to-date with the zns object */
@@ -5873,13 +6434,8 @@ void zebra_dplane_ns_enable(struct zebra_ns *zns, bool enabled)
 		zns_info_list_del(&zdplane_info.dg_zns_list, zi);
 
 		/* Stop any outstanding tasks */
-		if (zdplane_info.dg_master) {
-			event_cancel_async(zdplane_info.dg_master,
-					   &zi->t_request, NULL);
-
-			event_cancel_async(zdplane_info.dg_master, &zi->t_read,
-					   NULL);
-		}
+		dplane_zns_cancel(zi);
+		dplane_reader_release(zi);
 
 		XFREE(MTYPE_DP_NS, zi);
 	}
@@ -6093,6 +6649,27 @@ static void kernel_dplane_log_detail(struct zebra_dplane_ctx *ctx)
 	}
 }
 
+/* Account for the time from queueing a TC update to its kernel result */
+static void dplane_tc_latency(const struct zebra_dplane_ctx *ctx)
+{
+	struct timeval now, delta;
+	uint64_t usec, high;
+
+	monotime(&now);
+	timersub(&now, &ctx->zd_queue_time, &delta);
+	usec = (uint64_t)delta.tv_sec * 1000000ULL + delta.tv_usec;
+
+	atomic_fetch_add_explicit(&zdplane_info.dg_tcs_done, 1,
+				  memory_order_relaxed);
+	atomic_fetch_add_explicit(&zdplane_info.dg_tcs_usec, usec,
+				  memory_order_relaxed);
+	high = atomic_load_explicit(&zdplane_info.dg_tcs_usec_max,
+				    memory_order_relaxed);
+	if (usec > high)
+		atomic_store_explicit(&zdplane_info.dg_tcs_usec_max, usec,
+				      memory_order_relaxed);
+}
+
 static void kernel_dplane_handle_result(struct zebra_dplane_ctx *ctx)
 {
 	enum zebra_dplane_result res = dplane_ctx_get_status(ctx);
@@ -6244,6 +6821,7 @@ static void kernel_dplane_handle_result(struct zebra_dplane_ctx *ctx)
 		if (res != ZEBRA_DPLANE_REQUEST_SUCCESS)
 			atomic_fetch_add_explicit(&zdplane_info.dg_tcs_errors,
 						  1, memory_order_relaxed);
+		dplane_tc_latency(ctx);
 		break;
 
 	/* Ignore 'notifications' - no-op */
@@ -6606,10 +7184,8 @@ static void dplane_check_shutdown_status(struct event *event)
 	frr_each_safe (zns_info_list, &zdplane_info.dg_zns_list, zi) {
 		zns_info_list_del(&zdplane_info.dg_zns_list, zi);
 
-		if (zdplane_info.dg_master) {
-			EVENT_OFF(zi->t_read);
-			EVENT_OFF(zi->t_request);
-		}
+		dplane_zns_cancel(zi);
+		dplane_reader_release(zi);
 
 		XFREE(MTYPE_DP_NS, zi);
 	}
@@ -6666,9 +7242,10 @@ static void dplane_thread_loop(struct event *event)
 	struct dplane_ctx_list_head error_list;
 	struct zebra_dplane_provider *prov;
 	struct zebra_dplane_ctx *ctx;
-	int limit, counter, error_counter;
+	int limit, prov_limit, counter, error_counter;
 	uint64_t curr, high;
 	bool reschedule = false;
+	struct timeval now;
 
 	/* Capture work limit per cycle */
 	limit = zdplane_info.dg_updates_per_cycle;
@@ -6688,14 +7265,32 @@ static void dplane_thread_loop(struct event *event)
 	 */
 	DPLANE_LOCK();
 
+	/* Hold new work back while a provider is over its queue limit */
+	frr_each (dplane_prov_list, &zdplane_info.dg_providers, prov) {
+		uint32_t qlimit = atomic_load_explicit(&prov->dp_queue_limit,
+						       memory_order_relaxed);
+
+		if (qlimit &&
+		    atomic_load_explicit(&prov->dp_in_queued,
+					 memory_order_relaxed) >= qlimit) {
+			atomic_fetch_add_explicit(&prov->dp_backpressure, 1,
+						  memory_order_relaxed);
+			limit = 0;
+			break;
+		}
+	}
+
 	/* Locate initial registered provider */
 	prov = dplane_prov_list_first(&zdplane_info.dg_providers);
 
+	monotime(&now);
+
 	/* Move new work from incoming list to temp list */
 	for (counter = 0; counter < limit; counter++) {
 		ctx = dplane_ctx_list_pop(&zdplane_info.dg_update_list);
 		if (ctx) {
 			ctx->zd_provider = prov->dp_id;
+			ctx->zd_dplane_time = now;
 
 			dplane_ctx_list_add_tail(&work_list, ctx);
 		} else {
@@ -6727,10 +7322,13 @@ static void dplane_thread_loop(struct event *event)
 		/* Capture current provider id in each context; check for
 		 * error status.
 		 */
+		monotime(&now);
+
 		frr_each_safe (dplane_ctx_list, &work_list, ctx) {
 			if (dplane_ctx_get_status(ctx) ==
 			    ZEBRA_DPLANE_REQUEST_SUCCESS) {
 				ctx->zd_provider = prov->dp_id;
+				ctx->zd_prov_time = now;
 			} else {
 				/*
 				 * TODO -- improve error-handling: recirc
@@ -6767,6 +7365,8 @@ static void dplane_thread_loop(struct event *event)
 
 		dplane_provider_unlock(prov);
 
+		flightrec("dplane_provider", prov->dp_id, counter);
+
 		/* Reset the temp list (though the 'concat' may have done this
 		 * already), and the counter
 		 */
@@ -6784,11 +7384,17 @@ static void dplane_thread_loop(struct event *event)
 			break;
 
 		/* Dequeue completed work from the provider */
+		prov_limit = dplane_provider_get_work_limit(prov);
+		monotime(&now);
+
 		dplane_provider_lock(prov);
 
-		while (counter < limit) {
+		while (counter < prov_limit) {
 			ctx = dplane_ctx_list_pop(&(prov->dp_ctx_out_list));
 			if (ctx) {
+				dplane_provider_latency(prov, &now, ctx);
+				/* overwritten by the next provider, if any */
+				ctx->zd_prov_time = now;
 				dplane_ctx_list_add_tail(&work_list, ctx);
 				counter++;
 			} else
@@ -6797,7 +7403,7 @@ static void dplane_thread_loop(struct event *event)
 
 		dplane_provider_unlock(prov);
 
-		if (counter >= limit)
+		if (counter >= prov_limit)
 			reschedule = true;
 
 		if (IS_ZEBRA_DEBUG_DPLANE_DETAIL)
@@ -6845,6 +7451,7 @@ static void dplane_thread_loop(struct event *event)
 void zebra_dplane_shutdown(void)
 {
 	struct zebra_dplane_provider *dp;
+	uint32_t i;
 
 	if (IS_ZEBRA_DEBUG_DPLANE)
 		zlog_debug("Zebra dataplane shutdown called");
@@ -6864,6 +7471,16 @@ void zebra_dplane_shutdown(void)
 	zdplane_info.dg_pthread = NULL;
 	zdplane_info.dg_master = NULL;
 
+	/* The namespaces' reads were stopped with the dplane pthread */
+	for (i = 0; i < zdplane_info.dg_reader_count; i++) {
+		if (!zdplane_info.dg_readers[i].pthread)
+			continue;
+
+		frr_pthread_stop(zdplane_info.dg_readers[i].pthread, NULL);
+		frr_pthread_destroy(zdplane_info.dg_readers[i].pthread);
+		zdplane_info.dg_readers[i].pthread = NULL;
+	}
+
 	/* Notify provider(s) of final shutdown.
 	 * Note that this call is in the main pthread, so providers must
 	 * be prepared for that.
@@ -6878,6 +7495,8 @@ void zebra_dplane_shutdown(void)
 	/* TODO -- Clean-up provider objects */
 
 	/* TODO -- Clean queue(s), free memory */
+
+	dplane_ctx_pools_fini();
 }
 
 /*
@@ -6914,6 +7533,7 @@ void zebra_dplane_start(void)
 		.start = frr_pthread_attr_default.start,
 		.stop = frr_pthread_attr_default.stop
 	};
+	uint32_t i;
 
 	/* Start dataplane pthread */
 
@@ -6928,10 +7548,22 @@ void zebra_dplane_start(void)
 	event_add_event(zdplane_info.dg_master, dplane_thread_loop, NULL, 0,
 			&zdplane_info.dg_t_update);
 
+	/* Start netlink reader pthreads */
+	for (i = 0; i < zdplane_info.dg_reader_count; i++) {
+		char name[32], os_name[OS_THREAD_NAMELEN];
+
+		snprintf(name, sizeof(name), "Zebra dplane netlink reader %u",
+			 i);
+		snprintf(os_name, sizeof(os_name), "zebra_nlrd%u", i);
+		zdplane_info.dg_readers[i].pthread =
+			frr_pthread_new(&pattr, name, os_name);
+		frr_pthread_run(zdplane_info.dg_readers[i].pthread, NULL);
+	}
+
 	/* Enqueue requests and reads if necessary */
 	frr_each (zns_info_list, &zdplane_info.dg_zns_list, zi) {
 #if defined(HAVE_NETLINK)
-		event_add_read(zdplane_info.dg_master, dplane_incoming_read, zi,
+		event_add_read(dplane_zns_master(zi), dplane_incoming_read, zi,
 			       zi->info.sock, &zi->t_read);
 		dplane_kernel_info_request(zi);
 #endif
@@ -924,13 +924,42 @@ void dplane_set_in_queue_limit(uint32_t limit, bool set);
 /* Retrieve the current queue depth of incoming, unprocessed updates */
 uint32_t dplane_get_in_queue_len(void);
 
+/*
+ * Stages of a route update on its way from the RIB to the dataplane
+ * providers and back, accounted from the zebra main pthread only.
+ */
+enum dplane_stage {
+	DPLANE_STAGE_META_QUEUE,   /* route node waiting in the meta queue */
+	DPLANE_STAGE_DPLANE_QUEUE, /* waiting for the dplane pthread */
+	DPLANE_STAGE_PROVIDERS,    /* through all providers */
+	DPLANE_STAGE_RESULTS,      /* result waiting for zebra main */
+	DPLANE_STAGE_TOTAL,        /* from dplane enqueue to result */
+	DPLANE_STAGE_MAX,
+};
+
+void dplane_stage_account(enum dplane_stage stage, const struct timeval *start,
+			  const struct timeval *now);
+
+/* Account a route update result being processed by zebra main */
+void dplane_ctx_route_result_account(const struct zebra_dplane_ctx *ctx,
+				     const struct timeval *now);
+
 /*
  * Vty/cli apis
  */
 int dplane_show_helper(struct vty *vty, bool detailed);
 int dplane_show_provs_helper(struct vty *vty, bool detailed);
+int dplane_show_pipeline_helper(struct vty *vty, bool uj);
+void dplane_pipeline_clear(void);
 int dplane_config_write_helper(struct vty *vty);
 
+/*
+ * Configure a provider's work limit per cycle ('work' true) or the limit on
+ * its inbound queue, beyond which no new work is taken from zebra. A limit
+ * of 0 restores the default. Returns -1 if there is no such provider.
+ */
+int dplane_provider_set_limits(const char *name, bool work, uint32_t limit);
+
 /*
  * Dataplane providers: modules that process or consume dataplane events.
  */
@@ -1055,6 +1084,13 @@ void zebra_dplane_init(int (*)(struct dplane_ctx_list_head *));
  */
 void zebra_dplane_start(void);
 
+/*
+ * Read the namespaces' incoming dplane netlink sockets on count pthreads of
+ * their own rather than on the dplane pthread.  Must be set before
+ * zebra_ns_init().
+ */
+void zebra_dplane_set_netlink_readers(uint32_t count);
+
 /* Finalize/cleanup apis, one called early as shutdown is starting,
  * one called late at the end of zebra shutdown, and then one called
  * from the zebra main pthread to stop the dplane pthread and
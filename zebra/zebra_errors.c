@@ -787,6 +787,14 @@ static struct log_ref ferr_zebra_err[] = {
 		.suggestion =
 			"Wait for Zebra to reattempt update.",
 	},
+	{
+		.code = EC_ZEBRA_FAST_RESTART,
+		.title = "Zebra fast restart state could not be used",
+		.description =
+			"Zebra could not read or write the state file given with --fast-restart. Zebra still restarts, but reprograms all nexthop groups and routes in the kernel.",
+		.suggestion =
+			"Check that the directory of the file exists and is writable by zebra, and that the file was written by the same version of zebra.",
+	},
 	{
 		.code = END_FERR,
 	}
@@ -1128,6 +1128,10 @@ struct zebra_evpn *zebra_evpn_add(vni_t vni)
 	/* Create hash table for MAC */
 	zevpn->mac_table = zebra_mac_db_create(buffer);
 
+	snprintf(buffer, sizeof(buffer), "Zebra EVPN MAC VTEP Table vni: %u",
+		 vni);
+	zevpn->mac_vtep_table = zebra_mac_vtep_db_create(buffer);
+
 	snprintf(buffer, sizeof(buffer), "Zebra EVPN Neighbor Table vni: %u",
 		 vni);
 	/* Create hash table for neighbors */
@@ -1155,6 +1159,7 @@ int zebra_evpn_del(struct zebra_evpn *zevpn)
 	/* Free the MAC hash table. */
 	hash_free(zevpn->mac_table);
 	zevpn->mac_table = NULL;
+	zebra_mac_vtep_db_free(&zevpn->mac_vtep_table);
 
 	/* Remove references to the zevpn in the MH databases */
 	if (zevpn->vxlan_if)
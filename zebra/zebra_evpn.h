@@ -102,6 +102,9 @@ struct zebra_evpn {
 	/* List of local or remote MAC */
 	struct hash *mac_table;
 
+	/* Remote MACs by VTEP, see struct zebra_mac_vtep */
+	struct hash *mac_vtep_table;
+
 	/* List of local or remote neighbors (MAC+IP) */
 	struct hash *neigh_table;
 
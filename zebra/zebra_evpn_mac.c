@@ -28,6 +28,18 @@
 #include "zebra/zebra_evpn_neigh.h"
 
 DEFINE_MTYPE_STATIC(ZEBRA, MAC, "EVPN MAC");
+DEFINE_MTYPE_STATIC(ZEBRA, MAC_VTEP, "EVPN MAC VTEP index");
+
+static void num_valid_macs_iter(struct hash_bucket *hb, void *arg)
+{
+	struct zebra_mac *mac = hb->data;
+	uint32_t *num_macs = arg;
+
+	if (CHECK_FLAG(mac->flags, ZEBRA_MAC_REMOTE)
+	    || CHECK_FLAG(mac->flags, ZEBRA_MAC_LOCAL)
+	    || !CHECK_FLAG(mac->flags, ZEBRA_MAC_AUTO))
+		(*num_macs)++;
+}
 
 /*
  * Return number of valid MACs in an EVPN's MAC hash table - all
@@ -35,46 +47,30 @@ DEFINE_MTYPE_STATIC(ZEBRA, MAC, "EVPN MAC");
  */
 uint32_t num_valid_macs(struct zebra_evpn *zevpn)
 {
-	unsigned int i;
 	uint32_t num_macs = 0;
-	struct hash *hash;
-	struct hash_bucket *hb;
-	struct zebra_mac *mac;
 
-	hash = zevpn->mac_table;
-	if (!hash)
-		return num_macs;
-	for (i = 0; i < hash->size; i++) {
-		for (hb = hash->index[i]; hb; hb = hb->next) {
-			mac = (struct zebra_mac *)hb->data;
-			if (CHECK_FLAG(mac->flags, ZEBRA_MAC_REMOTE)
-			    || CHECK_FLAG(mac->flags, ZEBRA_MAC_LOCAL)
-			    || !CHECK_FLAG(mac->flags, ZEBRA_MAC_AUTO))
-				num_macs++;
-		}
-	}
+	if (zevpn->mac_table)
+		hash_iterate(zevpn->mac_table, num_valid_macs_iter, &num_macs);
 
 	return num_macs;
 }
 
+static void num_dup_detected_macs_iter(struct hash_bucket *hb, void *arg)
+{
+	struct zebra_mac *mac = hb->data;
+	uint32_t *num_macs = arg;
+
+	if (CHECK_FLAG(mac->flags, ZEBRA_MAC_DUPLICATE))
+		(*num_macs)++;
+}
+
 uint32_t num_dup_detected_macs(struct zebra_evpn *zevpn)
 {
-	unsigned int i;
 	uint32_t num_macs = 0;
-	struct hash *hash;
-	struct hash_bucket *hb;
-	struct zebra_mac *mac;
 
-	hash = zevpn->mac_table;
-	if (!hash)
-		return num_macs;
-	for (i = 0; i < hash->size; i++) {
-		for (hb = hash->index[i]; hb; hb = hb->next) {
-			mac = (struct zebra_mac *)hb->data;
-			if (CHECK_FLAG(mac->flags, ZEBRA_MAC_DUPLICATE))
-				num_macs++;
-		}
-	}
+	if (zevpn->mac_table)
+		hash_iterate(zevpn->mac_table, num_dup_detected_macs_iter,
+			     &num_macs);
 
 	return num_macs;
 }
@@ -170,10 +166,196 @@ static void zebra_evpn_mac_ifp_link(struct zebra_mac *zmac,
 	listnode_add(zif->mac_list, &zmac->ifp_listnode);
 }
 
-/* If the mac is a local mac clear links to destination access port */
+static unsigned int mac_vtep_hash_keymake(const void *p)
+{
+	const struct zebra_mac_vtep *mvtep = p;
+
+	return jhash_1word(mvtep->vtep_ip.s_addr, 0);
+}
+
+static bool mac_vtep_cmp(const void *p1, const void *p2)
+{
+	const struct zebra_mac_vtep *mvtep1 = p1;
+	const struct zebra_mac_vtep *mvtep2 = p2;
+
+	return IPV4_ADDR_SAME(&mvtep1->vtep_ip, &mvtep2->vtep_ip);
+}
+
+static void *mac_vtep_alloc(void *p)
+{
+	const struct zebra_mac_vtep *tmp = p;
+	struct zebra_mac_vtep *mvtep;
+
+	mvtep = XCALLOC(MTYPE_MAC_VTEP, sizeof(*mvtep));
+	mvtep->vtep_ip = tmp->vtep_ip;
+	mvtep->mac_list = list_new();
+
+	return mvtep;
+}
+
+static void mac_vtep_free(void *p)
+{
+	struct zebra_mac_vtep *mvtep = p;
+	struct listnode *node;
+	struct zebra_mac *zmac;
+
+	for (ALL_LIST_ELEMENTS_RO(mvtep->mac_list, node, zmac))
+		zmac->vtep = NULL;
+	list_delete(&mvtep->mac_list);
+	XFREE(MTYPE_MAC_VTEP, mvtep);
+}
+
+struct hash *zebra_mac_vtep_db_create(const char *desc)
+{
+	return hash_create_size(8, mac_vtep_hash_keymake, mac_vtep_cmp, desc);
+}
+
+void zebra_mac_vtep_db_free(struct hash **table)
+{
+	hash_clean_and_free(table, mac_vtep_free);
+}
+
+/* Unlink remote mac from the VTEP index */
+static void zebra_evpn_mac_vtep_unlink(struct zebra_mac *zmac)
+{
+	struct zebra_mac_vtep *mvtep = zmac->vtep;
+
+	if (!mvtep)
+		return;
+
+	list_delete_node(mvtep->mac_list, &zmac->vtep_listnode);
+	zmac->vtep = NULL;
+
+	if (list_isempty(mvtep->mac_list)) {
+		hash_release(zmac->zevpn->mac_vtep_table, mvtep);
+		mac_vtep_free(mvtep);
+	}
+}
+
+/* Link remote mac to the VTEP index, fwd_info.r_vtep_ip must be set */
+static void zebra_evpn_mac_vtep_link(struct zebra_mac *zmac)
+{
+	struct zebra_mac_vtep tmp;
+
+	if (!zmac->zevpn || !zmac->zevpn->mac_vtep_table)
+		return;
+
+	zebra_evpn_mac_vtep_unlink(zmac);
+
+	tmp.vtep_ip = zmac->fwd_info.r_vtep_ip;
+	zmac->vtep = hash_get(zmac->zevpn->mac_vtep_table, &tmp,
+			      mac_vtep_alloc);
+	listnode_init(&zmac->vtep_listnode, zmac);
+	listnode_add(zmac->vtep->mac_list, &zmac->vtep_listnode);
+}
+
+/*
+ * Call func on the remote macs pointing to vtep_ip, the same way
+ * hash_iterate() would on the whole mac table.
+ */
+void zebra_evpn_mac_vtep_iterate(struct zebra_evpn *zevpn,
+				 struct in_addr vtep_ip,
+				 void (*func)(struct hash_bucket *, void *),
+				 void *arg)
+{
+	struct zebra_mac_vtep *mvtep, tmp;
+	struct hash_bucket bucket = {};
+	struct listnode *node, *nnode;
+
+	if (!zevpn->mac_vtep_table)
+		return;
+
+	tmp.vtep_ip = vtep_ip;
+	mvtep = hash_lookup(zevpn->mac_vtep_table, &tmp);
+	if (!mvtep)
+		return;
+
+	for (ALL_LIST_ELEMENTS(mvtep->mac_list, node, nnode, bucket.data))
+		func(&bucket, arg);
+}
+
+struct mac_index_stats {
+	uint32_t vteps;
+	uint32_t vtep_macs;
+};
+
+static void zebra_evpn_mac_vtep_stats(struct hash_bucket *bucket, void *arg)
+{
+	struct zebra_mac_vtep *mvtep = bucket->data;
+	struct mac_index_stats *stats = arg;
+
+	stats->vteps++;
+	stats->vtep_macs += listcount(mvtep->mac_list);
+}
+
+static void zebra_evpn_mac_index_stats(struct hash_bucket *bucket, void *arg)
+{
+	struct zebra_evpn *zevpn = bucket->data;
+
+	if (zevpn->mac_vtep_table)
+		hash_iterate(zevpn->mac_vtep_table, zebra_evpn_mac_vtep_stats,
+			     arg);
+}
+
+/* Sizes of the secondary mac indexes (by VTEP, ES and access port) */
+void zebra_evpn_mac_index_show(struct vty *vty, json_object *json)
+{
+	struct mac_index_stats stats = {};
+	struct zebra_evpn_es *es;
+	struct vrf *vrf;
+	struct interface *ifp;
+	struct zebra_if *zif;
+	uint32_t es_cnt = 0, es_macs = 0;
+	uint32_t ifp_cnt = 0, ifp_macs = 0;
+	struct zebra_vrf *zvrf = zebra_vrf_get_evpn();
+
+	if (zvrf && zvrf->evpn_table)
+		hash_iterate(zvrf->evpn_table, zebra_evpn_mac_index_stats,
+			     &stats);
+
+	RB_FOREACH (es, zebra_es_rb_head, &zmh_info->es_rb_tree) {
+		if (!listcount(es->mac_list))
+			continue;
+		es_cnt++;
+		es_macs += listcount(es->mac_list);
+	}
+
+	RB_FOREACH (vrf, vrf_id_head, &vrfs_by_id) {
+		FOR_ALL_INTERFACES (vrf, ifp) {
+			zif = ifp->info;
+			if (!zif || !zif->mac_list || !listcount(zif->mac_list))
+				continue;
+			ifp_cnt++;
+			ifp_macs += listcount(zif->mac_list);
+		}
+	}
+
+	if (json) {
+		json_object *json_idx = json_object_new_object();
+
+		json_object_int_add(json_idx, "vteps", stats.vteps);
+		json_object_int_add(json_idx, "vtepMacs", stats.vtep_macs);
+		json_object_int_add(json_idx, "ess", es_cnt);
+		json_object_int_add(json_idx, "esMacs", es_macs);
+		json_object_int_add(json_idx, "interfaces", ifp_cnt);
+		json_object_int_add(json_idx, "interfaceMacs", ifp_macs);
+		json_object_object_add(json, "macIndexes", json_idx);
+		return;
+	}
+
+	vty_out(vty, "MAC indexes:\n");
+	vty_out(vty, "  by remote VTEP: %u VTEPs, %u MACs\n", stats.vteps,
+		stats.vtep_macs);
+	vty_out(vty, "  by ES: %u ESs, %u MACs\n", es_cnt, es_macs);
+	vty_out(vty, "  by access port: %u ports, %u MACs\n", ifp_cnt,
+		ifp_macs);
+}
+
+/* Clear the links to the destination access port or remote VTEP */
 void zebra_evpn_mac_clear_fwd_info(struct zebra_mac *zmac)
 {
 	zebra_evpn_mac_ifp_unlink(zmac);
+	zebra_evpn_mac_vtep_unlink(zmac);
 	memset(&zmac->fwd_info, 0, sizeof(zmac->fwd_info));
 }
 
@@ -1358,7 +1540,8 @@ int zebra_evpn_mac_send_del_to_client(vni_t vni, const struct ethaddr *macaddr,
  */
 struct hash *zebra_mac_db_create(const char *desc)
 {
-	return hash_create_size(8, mac_hash_keymake, mac_cmp, desc);
+	return hash_create_flags(8, mac_hash_keymake, mac_cmp, desc,
+				 HASH_OPEN_ADDRESSING);
 }
 
 /* program sync mac flags in the dataplane  */
@@ -2111,6 +2294,7 @@ int zebra_evpn_mac_remote_macip_add(struct zebra_evpn *zevpn,
 		UNSET_FLAG(mac->flags, ZEBRA_MAC_ALL_LOCAL_FLAGS);
 		SET_FLAG(mac->flags, ZEBRA_MAC_REMOTE);
 		mac->fwd_info.r_vtep_ip = vtep_ip;
+		zebra_evpn_mac_vtep_link(mac);
 
 		if (sticky)
 			SET_FLAG(mac->flags, ZEBRA_MAC_STICKY);
@@ -101,6 +101,13 @@ struct zebra_mac {
 	/* memory used to link the mac to the ifp */
 	struct listnode ifp_listnode;
 
+	/* remote VTEP the mac is reachable through. only relevant for
+	 * remote macs
+	 */
+	struct zebra_mac_vtep *vtep;
+	/* memory used to link the mac to the vtep */
+	struct listnode vtep_listnode;
+
 	/* Mobility sequence numbers associated with this entry. */
 	uint32_t rem_seq;
 	uint32_t loc_seq;
@@ -131,6 +138,17 @@ struct zebra_mac {
 	time_t uptime;
 };
 
+/*
+ * Remote MACs of an EVPN indexed by VTEP (zevpn->mac_vtep_table), so that
+ * per-VTEP operations don't have to walk the whole MAC table.
+ */
+struct zebra_mac_vtep {
+	struct in_addr vtep_ip;
+
+	/* remote macs pointing to vtep_ip */
+	struct list *mac_list;
+};
+
 /*
  * Context for MAC hash walk - used by callbacks.
  */
@@ -194,6 +212,13 @@ static inline bool zebra_evpn_mac_in_use(struct zebra_mac *mac)
 }
 
 struct hash *zebra_mac_db_create(const char *desc);
+struct hash *zebra_mac_vtep_db_create(const char *desc);
+void zebra_mac_vtep_db_free(struct hash **table);
+void zebra_evpn_mac_vtep_iterate(struct zebra_evpn *zevpn,
+				 struct in_addr vtep_ip,
+				 void (*func)(struct hash_bucket *, void *),
+				 void *arg);
+void zebra_evpn_mac_index_show(struct vty *vty, json_object *json);
 uint32_t num_valid_macs(struct zebra_evpn *zevi);
 uint32_t num_dup_detected_macs(struct zebra_evpn *zevi);
 int zebra_evpn_rem_mac_uninstall(struct zebra_evpn *zevi, struct zebra_mac *mac,
@@ -71,27 +71,26 @@ int neigh_list_cmp(void *p1, void *p2)
 
 struct hash *zebra_neigh_db_create(const char *desc)
 {
-	return hash_create_size(8, neigh_hash_keymake, neigh_cmp, desc);
+	return hash_create_flags(8, neigh_hash_keymake, neigh_cmp, desc,
+				 HASH_OPEN_ADDRESSING);
+}
+
+static void num_dup_detected_neighs_iter(struct hash_bucket *hb, void *arg)
+{
+	struct zebra_neigh *nbr = hb->data;
+	uint32_t *num_neighs = arg;
+
+	if (CHECK_FLAG(nbr->flags, ZEBRA_NEIGH_DUPLICATE))
+		(*num_neighs)++;
 }
 
 uint32_t num_dup_detected_neighs(struct zebra_evpn *zevpn)
 {
-	unsigned int i;
 	uint32_t num_neighs = 0;
-	struct hash *hash;
-	struct hash_bucket *hb;
-	struct zebra_neigh *nbr;
 
-	hash = zevpn->neigh_table;
-	if (!hash)
-		return num_neighs;
-	for (i = 0; i < hash->size; i++) {
-		for (hb = hash->index[i]; hb; hb = hb->next) {
-			nbr = (struct zebra_neigh *)hb->data;
-			if (CHECK_FLAG(nbr->flags, ZEBRA_NEIGH_DUPLICATE))
-				num_neighs++;
-		}
-	}
+	if (zevpn->neigh_table)
+		hash_iterate(zevpn->neigh_table, num_dup_detected_neighs_iter,
+			     &num_neighs);
 
 	return num_neighs;
 }
@@ -1859,6 +1858,50 @@ static char *zebra_evpn_print_neigh_flags(struct zebra_neigh *n,
 	return flags_buf;
 }
 
+struct neigh_vtep_iter_ctx {
+	struct in_addr vtep_ip;
+	void (*func)(struct hash_bucket *bucket, void *arg);
+	void *arg;
+};
+
+static void zebra_evpn_neigh_vtep_mac_cb(struct hash_bucket *bucket,
+					 void *arg)
+{
+	struct zebra_mac *zmac = bucket->data;
+	struct neigh_vtep_iter_ctx *ictx = arg;
+	struct hash_bucket nbucket = {};
+	struct listnode *node, *nnode;
+	struct zebra_neigh *n;
+
+	for (ALL_LIST_ELEMENTS(zmac->neigh_list, node, nnode, n)) {
+		if (!CHECK_FLAG(n->flags, ZEBRA_NEIGH_REMOTE) ||
+		    !IPV4_ADDR_SAME(&n->r_vtep_ip, &ictx->vtep_ip))
+			continue;
+
+		nbucket.data = n;
+		ictx->func(&nbucket, ictx->arg);
+	}
+}
+
+/*
+ * Call func on the remote neighbors pointing to vtep_ip. Remote neighbors
+ * share the VTEP of their MAC, so this goes through the MAC VTEP index.
+ */
+void zebra_evpn_neigh_vtep_iterate(struct zebra_evpn *zevpn,
+				   struct in_addr vtep_ip,
+				   void (*func)(struct hash_bucket *, void *),
+				   void *arg)
+{
+	struct neigh_vtep_iter_ctx ictx = {
+		.vtep_ip = vtep_ip,
+		.func = func,
+		.arg = arg,
+	};
+
+	zebra_evpn_mac_vtep_iterate(zevpn, vtep_ip,
+				    zebra_evpn_neigh_vtep_mac_cb, &ictx);
+}
+
 /*
  * Print neighbor hash entry - called for display of all neighbors.
  */
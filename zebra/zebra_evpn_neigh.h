@@ -251,6 +251,10 @@ void zebra_evpn_clear_dup_neigh_hash(struct hash_bucket *bucket, void *ctxt);
 void zebra_evpn_print_neigh(struct zebra_neigh *n, void *ctxt,
 			    json_object *json);
 void zebra_evpn_print_neigh_hash(struct hash_bucket *bucket, void *ctxt);
+void zebra_evpn_neigh_vtep_iterate(struct zebra_evpn *zevpn,
+				   struct in_addr vtep_ip,
+				   void (*func)(struct hash_bucket *, void *),
+				   void *arg);
 void zebra_evpn_print_neigh_hdr(struct vty *vty, struct neigh_walk_ctx *wctx);
 void zebra_evpn_print_neigh_hash_detail(struct hash_bucket *bucket, void *ctxt);
 void zebra_evpn_print_dad_neigh_hash(struct hash_bucket *bucket, void *ctxt);
@@ -32,6 +32,7 @@
 #include "zebra/zebra_router.h"
 #include "zebra/debug.h"
 #include "zebra/zapi_msg.h"
+#include "zebra/zebra_restart.h"
 
 DEFINE_MTYPE_STATIC(ZEBRA, ZEBRA_GR, "GR");
 
@@ -421,6 +422,10 @@ static void zebra_client_capabilities_handler(struct zserv *client,
 		 */
 		zebra_client_update_info(client, api);
 		zebra_gr_process_client_stale_routes(client, api->vrf_id);
+		if (api->safi == SAFI_UNICAST)
+			zebra_restart_client_complete(client->proto,
+						      client->instance,
+						      api->vrf_id, api->afi);
 		break;
 	}
 }
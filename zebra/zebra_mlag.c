@@ -128,6 +128,140 @@ void zebra_mlag_process_mlag_data(uint8_t *data, uint32_t len)
  */
 #define ZEBRA_MLAG_POST_LIMIT 100
 
+/*
+ * Mroute adds or deletes queued back to back are merged into one bulk
+ * message.  pimd already bulks what it sends, but each bulk is limited to
+ * one zapi message, and on MLAG peer recovery thousands of them arrive.
+ * Each mroute is at most about 90 bytes encoded, so this keeps a merged
+ * bulk within ZEBRA_MLAG_BUF_LIMIT.
+ */
+#define ZEBRA_MLAG_BULK_MAX 256
+#define ZEBRA_MLAG_HDR_LEN 8
+
+/*
+ * Encoded messages are framed by their length on the socket, so several
+ * go out with one write.
+ */
+#define ZEBRA_MLAG_WR_BATCH (4 * ZEBRA_MLAG_BUF_LIMIT)
+
+static uint8_t mlag_wr_batch[ZEBRA_MLAG_WR_BATCH];
+static uint32_t mlag_wr_batch_len;
+
+#define zmlag_stat_add(field, val)                                             \
+	atomic_fetch_add_explicit(&zrouter.mlag_info.field, (val),             \
+				  memory_order_relaxed)
+
+/* bulk type and count of an mroute add/del, false for anything else */
+static bool zebra_mlag_msg_bulk_info(struct stream *s, uint32_t *type,
+				     uint16_t *cnt)
+{
+	if (stream_get_endp(s) < ZEBRA_MLAG_HDR_LEN)
+		return false;
+
+	*type = stream_getl_from(s, 0);
+	*cnt = stream_getw_from(s, 6);
+
+	switch (*type) {
+	case MLAG_MROUTE_ADD:
+		*type = MLAG_MROUTE_ADD_BULK;
+		break;
+	case MLAG_MROUTE_DEL:
+		*type = MLAG_MROUTE_DEL_BULK;
+		break;
+	case MLAG_MROUTE_ADD_BULK:
+	case MLAG_MROUTE_DEL_BULK:
+		break;
+	default:
+		return false;
+	}
+	return *cnt > 0;
+}
+
+/*
+ * Merge s with the mroute messages of the same kind following it in the
+ * fifo.  Returns the stream to encode, s itself if there's nothing to
+ * merge.  *consumed is the number of queued messages it covers.
+ */
+static struct stream *zebra_mlag_coalesce(struct stream *s,
+					  uint32_t *consumed)
+{
+	struct stream_fifo *fifo = zrouter.mlag_info.mlag_fifo;
+	struct stream *bulk, *next;
+	uint32_t type, next_type;
+	uint16_t cnt, next_cnt, data_len;
+	size_t rec_len;
+
+	*consumed = 1;
+
+	if (!zebra_mlag_msg_bulk_info(s, &type, &cnt))
+		return s;
+
+	zmlag_stat_add(stat_mroutes, cnt);
+
+	next = stream_fifo_head_safe(fifo);
+	if (!next || !zebra_mlag_msg_bulk_info(next, &next_type, &next_cnt)
+	    || next_type != type || cnt + next_cnt > ZEBRA_MLAG_BULK_MAX)
+		return s;
+
+	/* all records of one kind have the same size */
+	rec_len = (stream_get_endp(s) - ZEBRA_MLAG_HDR_LEN) / cnt;
+	bulk = stream_new(ZEBRA_MLAG_HDR_LEN + rec_len * ZEBRA_MLAG_BULK_MAX);
+
+	stream_putl(bulk, type);
+	stream_putw(bulk, 0);
+	stream_putw(bulk, 0);
+	data_len = stream_getw_from(s, 4);
+	stream_put(bulk, STREAM_DATA(s) + ZEBRA_MLAG_HDR_LEN,
+		   stream_get_endp(s) - ZEBRA_MLAG_HDR_LEN);
+	stream_free(s);
+
+	/* only this pthread pops from the fifo, the head stays the same */
+	while ((next = stream_fifo_head_safe(fifo))
+	       && zebra_mlag_msg_bulk_info(next, &next_type, &next_cnt)
+	       && next_type == type && cnt + next_cnt <= ZEBRA_MLAG_BULK_MAX
+	       && STREAM_WRITEABLE(bulk)
+			  >= stream_get_endp(next) - ZEBRA_MLAG_HDR_LEN) {
+		next = stream_fifo_pop_safe(fifo);
+
+		stream_put(bulk, STREAM_DATA(next) + ZEBRA_MLAG_HDR_LEN,
+			   stream_get_endp(next) - ZEBRA_MLAG_HDR_LEN);
+		cnt += next_cnt;
+		data_len += stream_getw_from(next, 4);
+		stream_free(next);
+
+		(*consumed)++;
+		zmlag_stat_add(stat_mroutes, next_cnt);
+		zmlag_stat_add(stat_coalesced, 1);
+	}
+
+	stream_putw_at(bulk, 4, data_len);
+	stream_putw_at(bulk, 6, cnt);
+	return bulk;
+}
+
+static void zebra_mlag_wr_batch_flush(void)
+{
+	if (!mlag_wr_batch_len)
+		return;
+
+	hook_call(zebra_mlag_private_write_data, mlag_wr_batch,
+		  mlag_wr_batch_len);
+
+	zmlag_stat_add(stat_writes, 1);
+	zmlag_stat_add(stat_tx_bytes, mlag_wr_batch_len);
+	mlag_wr_batch_len = 0;
+}
+
+static void zebra_mlag_wr_batch_add(const uint8_t *data, uint32_t len)
+{
+	if (mlag_wr_batch_len + len > sizeof(mlag_wr_batch))
+		zebra_mlag_wr_batch_flush();
+
+	memcpy(mlag_wr_batch + mlag_wr_batch_len, data, len);
+	mlag_wr_batch_len += len;
+	zmlag_stat_add(stat_tx_msgs, 1);
+}
+
 /*
  * This thread reads the clients data from the Global queue and encodes with
  * protobuf and pass on to the MLAG socket.
@@ -138,6 +272,7 @@ static void zebra_mlag_client_msg_handler(struct event *event)
 	uint32_t wr_count = 0;
 	uint32_t msg_type = 0;
 	uint32_t max_count = 0;
+	uint32_t consumed;
 	int len = 0;
 
 	wr_count = stream_fifo_count_safe(zrouter.mlag_info.mlag_fifo);
@@ -147,7 +282,7 @@ static void zebra_mlag_client_msg_handler(struct event *event)
 
 	max_count = MIN(wr_count, ZEBRA_MLAG_POST_LIMIT);
 
-	for (wr_count = 0; wr_count < max_count; wr_count++) {
+	for (wr_count = 0; wr_count < max_count; wr_count += consumed) {
 		s = stream_fifo_pop_safe(zrouter.mlag_info.mlag_fifo);
 		if (!s) {
 			zlog_debug(":%s: Got a NULL Messages, some thing wrong",
@@ -155,6 +290,9 @@ static void zebra_mlag_client_msg_handler(struct event *event)
 			break;
 		}
 
+		s = zebra_mlag_coalesce(s, &consumed);
+		zmlag_stat_add(stat_rx_msgs, consumed);
+
 		/*
 		 * Encode the data now
 		 */
@@ -164,8 +302,7 @@ static void zebra_mlag_client_msg_handler(struct event *event)
 		 * write to MCLAGD
 		 */
 		if (len > 0) {
-			hook_call(zebra_mlag_private_write_data,
-				  mlag_wr_buffer, len);
+			zebra_mlag_wr_batch_add(mlag_wr_buffer, len);
 
 			/*
 			 * If message type is De-register, send a signal to main
@@ -173,15 +310,19 @@ static void zebra_mlag_client_msg_handler(struct event *event)
 			 * main thread.
 			 */
 			if (msg_type == MLAG_DEREGISTER) {
+				zebra_mlag_wr_batch_flush();
 				event_add_event(zrouter.master,
 						zebra_mlag_terminate_pthread,
 						NULL, 0, NULL);
 			}
-		}
+		} else
+			zmlag_stat_add(stat_errors, 1);
 
 		stream_free(s);
 	}
 
+	zebra_mlag_wr_batch_flush();
+
 	if (IS_ZEBRA_DEBUG_MLAG)
 		zlog_debug(":%s: Posted  %d messages to MLAGD", __func__,
 			   wr_count);
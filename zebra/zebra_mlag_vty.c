@@ -27,6 +27,21 @@ DEFUN_HIDDEN (show_mlag,
 	vty_out(vty, "MLag is configured to: %s\n",
 		mlag_role2str(zrouter.mlag_info.role, buf, sizeof(buf)));
 
+#define zmlag_stat(field)                                                      \
+	atomic_load_explicit(&zrouter.mlag_info.field, memory_order_relaxed)
+
+	vty_out(vty,
+		"Client messages: %" PRIu64 ", mroutes: %" PRIu64
+		", merged into bulks: %" PRIu64 "\n",
+		zmlag_stat(stat_rx_msgs), zmlag_stat(stat_mroutes),
+		zmlag_stat(stat_coalesced));
+	vty_out(vty,
+		"Sent to MLAGD: %" PRIu64 " messages, %" PRIu64
+		" bytes in %" PRIu64 " writes, %" PRIu64 " encode errors\n",
+		zmlag_stat(stat_tx_msgs), zmlag_stat(stat_tx_bytes),
+		zmlag_stat(stat_writes), zmlag_stat(stat_errors));
+#undef zmlag_stat
+
 	return CMD_SUCCESS;
 }
 
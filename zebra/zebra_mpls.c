@@ -37,6 +37,27 @@
 DEFINE_MTYPE_STATIC(ZEBRA, LSP, "MPLS LSP object");
 DEFINE_MTYPE_STATIC(ZEBRA, FEC, "MPLS FEC object");
 DEFINE_MTYPE_STATIC(ZEBRA, NHLFE, "MPLS nexthop object");
+DEFINE_MTYPE_STATIC(ZEBRA, LSP_INDEX, "MPLS LSP label index");
+
+/*
+ * Lookups by in-label go through a direct index of the LSP table rather
+ * than hashing. The label space is split in pages that are only allocated
+ * while they hold an LSP, so a few dense label blocks (e.g. the SRGB and
+ * the dynamic range) only cost a couple of pages. The hash is kept for the
+ * table walks.
+ */
+#define LSP_INDEX_PAGE_BITS 10
+#define LSP_INDEX_PAGE_SIZE (1U << LSP_INDEX_PAGE_BITS)
+#define LSP_INDEX_PAGES ((MPLS_LABEL_MAX >> LSP_INDEX_PAGE_BITS) + 1)
+
+struct zebra_lsp_index_page {
+	uint32_t count;
+	struct zebra_lsp *lsp[LSP_INDEX_PAGE_SIZE];
+};
+
+struct zebra_lsp_index {
+	struct zebra_lsp_index_page *pages[LSP_INDEX_PAGES];
+};
 
 bool mpls_enabled;
 bool mpls_pw_reach_strict; /* Strict reachability checking */
@@ -78,10 +99,10 @@ static int lsp_processq_add(struct zebra_lsp *lsp);
 static void *lsp_alloc(void *p);
 
 /* Check whether lsp can be freed - no nhlfes, e.g., and call free api */
-static void lsp_check_free(struct hash *lsp_table, struct zebra_lsp **plsp);
+static void lsp_check_free(struct zebra_vrf *zvrf, struct zebra_lsp **plsp);
 
 /* Free lsp; sets caller's pointer to NULL */
-static void lsp_free(struct hash *lsp_table, struct zebra_lsp **plsp);
+static void lsp_free(struct zebra_vrf *zvrf, struct zebra_lsp **plsp);
 
 static char *nhlfe2str(const struct zebra_nhlfe *nhlfe, char *buf, int size);
 static char *nhlfe_config_str(const struct zebra_nhlfe *nhlfe, char *buf,
@@ -103,7 +124,7 @@ static int nhlfe_del(struct zebra_nhlfe *nhlfe);
 static void nhlfe_free(struct zebra_nhlfe *nhlfe);
 static void nhlfe_out_label_update(struct zebra_nhlfe *nhlfe,
 				   struct mpls_label_stack *nh_label);
-static int mpls_lsp_uninstall_all(struct hash *lsp_table, struct zebra_lsp *lsp,
+static int mpls_lsp_uninstall_all(struct zebra_vrf *zvrf, struct zebra_lsp *lsp,
 				  enum lsp_types_t type);
 static int mpls_static_lsp_uninstall_all(struct zebra_vrf *zvrf,
 					 mpls_label_t in_label);
@@ -120,6 +141,79 @@ static int lsp_backup_znh_install(struct zebra_lsp *lsp, enum lsp_types_t type,
 
 /* Static functions */
 
+/*
+ * Look up the LSP for an in-label.
+ */
+static struct zebra_lsp *lsp_lookup(struct zebra_vrf *zvrf, mpls_label_t label)
+{
+	struct zebra_lsp_index_page *page;
+
+	if (!zvrf->lsp_index || label > MPLS_LABEL_MAX)
+		return NULL;
+
+	page = zvrf->lsp_index->pages[label >> LSP_INDEX_PAGE_BITS];
+	if (!page)
+		return NULL;
+
+	return page->lsp[label & (LSP_INDEX_PAGE_SIZE - 1)];
+}
+
+/*
+ * Look up or allocate the LSP for an in-label.
+ */
+static struct zebra_lsp *lsp_get(struct zebra_vrf *zvrf, mpls_label_t label)
+{
+	struct zebra_lsp_index_page **page;
+	struct zebra_lsp *lsp;
+	struct zebra_ile tmp_ile;
+
+	lsp = lsp_lookup(zvrf, label);
+	if (lsp)
+		return lsp;
+
+	tmp_ile.in_label = label;
+	lsp = hash_get(zvrf->lsp_table, &tmp_ile, lsp_alloc);
+
+	if (!zvrf->lsp_index || label > MPLS_LABEL_MAX)
+		return lsp;
+
+	page = &zvrf->lsp_index->pages[label >> LSP_INDEX_PAGE_BITS];
+	if (!*page)
+		*page = XCALLOC(MTYPE_LSP_INDEX, sizeof(**page));
+	(*page)->lsp[label & (LSP_INDEX_PAGE_SIZE - 1)] = lsp;
+	(*page)->count++;
+
+	return lsp;
+}
+
+static void lsp_index_del(struct zebra_vrf *zvrf, mpls_label_t label)
+{
+	struct zebra_lsp_index_page **page;
+
+	if (!zvrf->lsp_index || label > MPLS_LABEL_MAX)
+		return;
+
+	page = &zvrf->lsp_index->pages[label >> LSP_INDEX_PAGE_BITS];
+	if (!*page || !(*page)->lsp[label & (LSP_INDEX_PAGE_SIZE - 1)])
+		return;
+
+	(*page)->lsp[label & (LSP_INDEX_PAGE_SIZE - 1)] = NULL;
+	if (--(*page)->count == 0)
+		XFREE(MTYPE_LSP_INDEX, *page);
+}
+
+static void lsp_index_free(struct zebra_vrf *zvrf)
+{
+	uint32_t i;
+
+	if (!zvrf->lsp_index)
+		return;
+
+	for (i = 0; i < LSP_INDEX_PAGES; i++)
+		XFREE(MTYPE_LSP_INDEX, zvrf->lsp_index->pages[i]);
+	XFREE(MTYPE_LSP_INDEX, zvrf->lsp_index);
+}
+
 /*
  * Handle failure in LSP install, clear flags for NHLFE.
  */
@@ -172,7 +266,7 @@ static int lsp_install(struct zebra_vrf *zvrf, mpls_label_t label,
 
 	/* Locate or allocate LSP entry. */
 	tmp_ile.in_label = label;
-	lsp = hash_get(lsp_table, &tmp_ile, lsp_alloc);
+	lsp = lsp_get(zvrf, tmp_ile.in_label);
 
 	/* For each active nexthop, create NHLFE. Note that we deliberately skip
 	 * recursive nexthops right now, because intermediate hops won't
@@ -244,7 +338,7 @@ static int lsp_install(struct zebra_vrf *zvrf, mpls_label_t label,
 		if (lsp_processq_add(lsp))
 			return -1;
 	} else {
-		lsp_check_free(lsp_table, &lsp);
+		lsp_check_free(zvrf, &lsp);
 	}
 
 	return 0;
@@ -269,7 +363,7 @@ static int lsp_uninstall(struct zebra_vrf *zvrf, mpls_label_t label)
 
 	/* If entry is not present, exit. */
 	tmp_ile.in_label = label;
-	lsp = hash_lookup(lsp_table, &tmp_ile);
+	lsp = lsp_lookup(zvrf, tmp_ile.in_label);
 	if (!lsp || (nhlfe_list_first(&lsp->nhlfe_list) == NULL))
 		return 0;
 
@@ -300,7 +394,7 @@ static int lsp_uninstall(struct zebra_vrf *zvrf, mpls_label_t label)
 		if (lsp_processq_add(lsp))
 			return -1;
 	} else {
-		lsp_check_free(lsp_table, &lsp);
+		lsp_check_free(zvrf, &lsp);
 	}
 
 	return 0;
@@ -1055,7 +1149,7 @@ static void lsp_processq_del(struct work_queue *wq, void *data)
 			nhlfe_del(nhlfe);
 	}
 
-	lsp_check_free(lsp_table, &lsp);
+	lsp_check_free(zvrf, &lsp);
 }
 
 /*
@@ -1109,7 +1203,7 @@ static void *lsp_alloc(void *p)
 /*
  * Check whether lsp can be freed - no nhlfes, e.g., and call free api
  */
-static void lsp_check_free(struct hash *lsp_table, struct zebra_lsp **plsp)
+static void lsp_check_free(struct zebra_vrf *zvrf, struct zebra_lsp **plsp)
 {
 	struct zebra_lsp *lsp;
 
@@ -1121,7 +1215,7 @@ static void lsp_check_free(struct hash *lsp_table, struct zebra_lsp **plsp)
 	if ((nhlfe_list_first(&lsp->nhlfe_list) == NULL) &&
 	    (nhlfe_list_first(&lsp->backup_nhlfe_list) == NULL) &&
 	    !CHECK_FLAG(lsp->flags, LSP_FLAG_SCHEDULED))
-		lsp_free(lsp_table, plsp);
+		lsp_free(zvrf, plsp);
 }
 
 static void lsp_free_nhlfe(struct zebra_lsp *lsp)
@@ -1143,7 +1237,7 @@ static void lsp_free_nhlfe(struct zebra_lsp *lsp)
  * Dtor for an LSP: remove from ile hash, release any internal allocations,
  * free LSP object.
  */
-static void lsp_free(struct hash *lsp_table, struct zebra_lsp **plsp)
+static void lsp_free(struct zebra_vrf *zvrf, struct zebra_lsp **plsp)
 {
 	struct zebra_lsp *lsp;
 
@@ -1158,7 +1252,8 @@ static void lsp_free(struct hash *lsp_table, struct zebra_lsp **plsp)
 
 	lsp_free_nhlfe(lsp);
 
-	hash_release(lsp_table, &lsp->ile);
+	lsp_index_del(zvrf, lsp->ile.in_label);
+	hash_release(zvrf->lsp_table, &lsp->ile);
 	XFREE(MTYPE_LSP, lsp);
 
 	*plsp = NULL;
@@ -1407,7 +1502,7 @@ static void nhlfe_out_label_update(struct zebra_nhlfe *nhlfe,
 	nhlfe->nexthop->nh_label->label[0] = nh_label->label[0];
 }
 
-static int mpls_lsp_uninstall_all(struct hash *lsp_table, struct zebra_lsp *lsp,
+static int mpls_lsp_uninstall_all(struct zebra_vrf *zvrf, struct zebra_lsp *lsp,
 				  enum lsp_types_t type)
 {
 	struct zebra_nhlfe *nhlfe;
@@ -1469,7 +1564,7 @@ static int mpls_lsp_uninstall_all(struct hash *lsp_table, struct zebra_lsp *lsp,
 		if (lsp_processq_add(lsp))
 			return -1;
 	} else {
-		lsp_check_free(lsp_table, &lsp);
+		lsp_check_free(zvrf, &lsp);
 	}
 
 	return 0;
@@ -1493,11 +1588,11 @@ static int mpls_static_lsp_uninstall_all(struct zebra_vrf *zvrf,
 
 	/* If entry is not present, exit. */
 	tmp_ile.in_label = in_label;
-	lsp = hash_lookup(lsp_table, &tmp_ile);
+	lsp = lsp_lookup(zvrf, tmp_ile.in_label);
 	if (!lsp || (nhlfe_list_first(&lsp->nhlfe_list) == NULL))
 		return 0;
 
-	return mpls_lsp_uninstall_all(lsp_table, lsp, ZEBRA_LSP_STATIC);
+	return mpls_lsp_uninstall_all(zvrf, lsp, ZEBRA_LSP_STATIC);
 }
 
 static json_object *nhlfe_json(struct zebra_nhlfe *nhlfe)
@@ -1752,8 +1847,6 @@ void zebra_mpls_lsp_dplane_result(struct zebra_dplane_ctx *ctx)
 {
 	struct zebra_vrf *zvrf;
 	mpls_label_t label;
-	struct zebra_ile tmp_ile;
-	struct hash *lsp_table;
 	struct zebra_lsp *lsp;
 	struct zebra_nhlfe *nhlfe;
 	struct nexthop *nexthop;
@@ -1780,10 +1873,7 @@ void zebra_mpls_lsp_dplane_result(struct zebra_dplane_ctx *ctx)
 		if (zvrf == NULL)
 			break;
 
-		lsp_table = zvrf->lsp_table;
-
-		tmp_ile.in_label = label;
-		lsp = hash_lookup(lsp_table, &tmp_ile);
+		lsp = lsp_lookup(zvrf, label);
 		if (lsp == NULL) {
 			if (IS_ZEBRA_DEBUG_DPLANE)
 				zlog_debug("LSP ctx %p: in-label %u not found",
@@ -2078,8 +2168,6 @@ static int update_nhlfes_from_ctx(struct nhlfe_list_head *nhlfe_head,
 void zebra_mpls_process_dplane_notify(struct zebra_dplane_ctx *ctx)
 {
 	struct zebra_vrf *zvrf;
-	struct zebra_ile tmp_ile;
-	struct hash *lsp_table;
 	struct zebra_lsp *lsp;
 	const struct nhlfe_list_head *ctx_list;
 	int start_count = 0, end_count = 0; /* Installed counts */
@@ -2096,10 +2184,7 @@ void zebra_mpls_process_dplane_notify(struct zebra_dplane_ctx *ctx)
 	if (zvrf == NULL)
 		return;
 
-	lsp_table = zvrf->lsp_table;
-
-	tmp_ile.in_label = dplane_ctx_get_in_label(ctx);
-	lsp = hash_lookup(lsp_table, &tmp_ile);
+	lsp = lsp_lookup(zvrf, dplane_ctx_get_in_label(ctx));
 	if (lsp == NULL) {
 		if (is_debug)
 			zlog_debug("dplane LSP notif: in-label %u not found",
@@ -2502,7 +2587,7 @@ static int zebra_mpls_cleanup_fecs_for_client(struct zserv *client)
 }
 
 struct lsp_uninstall_args {
-	struct hash *lsp_table;
+	struct zebra_vrf *zvrf;
 	enum lsp_types_t type;
 };
 
@@ -2522,7 +2607,7 @@ static int zebra_mpls_cleanup_zclient_labels(struct zserv *client)
 			continue;
 
 		/* Cleanup LSPs. */
-		args.lsp_table = zvrf->lsp_table;
+		args.zvrf = zvrf;
 		args.type = lsp_type_from_re_type(client->proto);
 		hash_iterate(zvrf->lsp_table, mpls_lsp_uninstall_all_type,
 			     &args);
@@ -2942,7 +3027,7 @@ void zebra_mpls_zapi_labels_process(bool add_p, struct zebra_vrf *zvrf,
 
 		/* Find or create LSP object */
 		tmp_ile.in_label = zl->local_label;
-		lsp = hash_get(lsp_table, &tmp_ile, lsp_alloc);
+		lsp = lsp_get(zvrf, tmp_ile.in_label);
 	}
 
 	/* Prep for route/FEC update if requested */
@@ -3217,7 +3302,7 @@ int mpls_lsp_install(struct zebra_vrf *zvrf, enum lsp_types_t type,
 
 	/* Find or create LSP object */
 	tmp_ile.in_label = in_label;
-	lsp = hash_get(lsp_table, &tmp_ile, lsp_alloc);
+	lsp = lsp_get(zvrf, tmp_ile.in_label);
 
 	nhlfe = lsp_add_nhlfe(lsp, type, num_out_labels, out_labels, gtype,
 			      gate, ifindex, false /*backup*/);
@@ -3306,7 +3391,7 @@ struct zebra_lsp *mpls_lsp_find(struct zebra_vrf *zvrf, mpls_label_t in_label)
 
 	/* If entry is not present, exit. */
 	tmp_ile.in_label = in_label;
-	return hash_lookup(lsp_table, &tmp_ile);
+	return lsp_lookup(zvrf, tmp_ile.in_label);
 }
 
 /*
@@ -3332,7 +3417,7 @@ int mpls_lsp_uninstall(struct zebra_vrf *zvrf, enum lsp_types_t type,
 
 	/* If entry is not present, exit. */
 	tmp_ile.in_label = in_label;
-	lsp = hash_lookup(lsp_table, &tmp_ile);
+	lsp = lsp_lookup(zvrf, tmp_ile.in_label);
 	if (!lsp)
 		return 0;
 
@@ -3369,7 +3454,7 @@ int mpls_lsp_uninstall(struct zebra_vrf *zvrf, enum lsp_types_t type,
 		nhlfe_del(nhlfe);
 
 		/* Free LSP entry if no other NHLFEs and not scheduled. */
-		lsp_check_free(lsp_table, &lsp);
+		lsp_check_free(zvrf, &lsp);
 	}
 	return 0;
 }
@@ -3388,11 +3473,11 @@ int mpls_lsp_uninstall_all_vrf(struct zebra_vrf *zvrf, enum lsp_types_t type,
 
 	/* If entry is not present, exit. */
 	tmp_ile.in_label = in_label;
-	lsp = hash_lookup(lsp_table, &tmp_ile);
+	lsp = lsp_lookup(zvrf, tmp_ile.in_label);
 	if (!lsp)
 		return 0;
 
-	return mpls_lsp_uninstall_all(lsp_table, lsp, type);
+	return mpls_lsp_uninstall_all(zvrf, lsp, type);
 }
 
 /*
@@ -3403,17 +3488,15 @@ static void mpls_lsp_uninstall_all_type(struct hash_bucket *bucket, void *ctxt)
 {
 	struct lsp_uninstall_args *args = ctxt;
 	struct zebra_lsp *lsp;
-	struct hash *lsp_table;
 
 	lsp = (struct zebra_lsp *)bucket->data;
 	if (nhlfe_list_first(&lsp->nhlfe_list) == NULL)
 		return;
 
-	lsp_table = args->lsp_table;
-	if (!lsp_table)
+	if (!args->zvrf->lsp_table)
 		return;
 
-	mpls_lsp_uninstall_all(lsp_table, lsp, args->type);
+	mpls_lsp_uninstall_all(args->zvrf, lsp, args->type);
 }
 
 /*
@@ -3738,7 +3821,7 @@ void zebra_mpls_print_lsp(struct vty *vty, struct zebra_vrf *zvrf,
 
 	/* If entry is not present, exit. */
 	tmp_ile.in_label = label;
-	lsp = hash_lookup(lsp_table, &tmp_ile);
+	lsp = lsp_lookup(zvrf, tmp_ile.in_label);
 	if (!lsp) {
 		if (use_json)
 			vty_out(vty, "{}\n");
@@ -4060,6 +4143,7 @@ void zebra_mpls_close_tables(struct zebra_vrf *zvrf)
 	hash_iterate(zvrf->lsp_table, lsp_uninstall_from_kernel, NULL);
 	hash_clean_and_free(&zvrf->lsp_table, lsp_table_free);
 	hash_clean_and_free(&zvrf->slsp_table, lsp_table_free);
+	lsp_index_free(zvrf);
 	route_table_finish(zvrf->fec_table[AFI_IP]);
 	route_table_finish(zvrf->fec_table[AFI_IP6]);
 }
@@ -4082,6 +4166,7 @@ void zebra_mpls_init_tables(struct zebra_vrf *zvrf)
 	snprintf(buffer, sizeof(buffer), "ZEBRA LSP table: %s",
 		 zvrf->vrf->name);
 	zvrf->lsp_table = hash_create_size(8, label_hash, label_cmp, buffer);
+	zvrf->lsp_index = XCALLOC(MTYPE_LSP_INDEX, sizeof(*zvrf->lsp_index));
 	zvrf->fec_table[AFI_IP] = route_table_init();
 	zvrf->fec_table[AFI_IP6] = route_table_init();
 	zvrf->mpls_flags = 0;
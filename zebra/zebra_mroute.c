@@ -85,3 +85,106 @@ stream_failure:
 	stream_putw_at(s, 0, stream_get_endp(s));
 	zserv_send_message(client, s);
 }
+
+/* reply to a ZEBRA_IPMR_ROUTE_STATS_BULK request being built */
+struct ipmr_stats_bulk {
+	struct zserv *client;
+	struct zebra_vrf *zvrf;
+	int family;
+
+	struct stream *s;
+	size_t count_pos;
+	uint32_t count;
+	uint32_t total;
+};
+
+static void ipmr_stats_bulk_start(struct ipmr_stats_bulk *bulk)
+{
+	bulk->s = stream_new(ZEBRA_MAX_PACKET_SIZ);
+	zclient_create_header(bulk->s, ZEBRA_IPMR_ROUTE_STATS_BULK,
+			      zvrf_id(bulk->zvrf));
+	stream_putc(bulk->s, 0);
+	stream_putl(bulk->s, 0);
+	bulk->count_pos = stream_get_endp(bulk->s);
+	stream_putl(bulk->s, 0);
+	bulk->count = 0;
+}
+
+static void ipmr_stats_bulk_send(struct ipmr_stats_bulk *bulk, bool last,
+				 int suc)
+{
+	struct stream *s = bulk->s;
+
+	stream_putc_at(s, ZEBRA_HEADER_SIZE, last ? ZAPI_IPMR_STATS_BULK_LAST
+						  : 0);
+	stream_putl_at(s, ZEBRA_HEADER_SIZE + 1, (uint32_t)suc);
+	stream_putl_at(s, bulk->count_pos, bulk->count);
+	stream_putw_at(s, 0, stream_get_endp(s));
+	zserv_send_message(bulk->client, s);
+	bulk->s = NULL;
+}
+
+static void ipmr_stats_bulk_add(void *in, void *arg)
+{
+	struct mcast_route_data *mr = in;
+	struct ipmr_stats_bulk *bulk = arg;
+	size_t addrlen = bulk->family == AF_INET ? sizeof(struct in_addr)
+						 : sizeof(struct in6_addr);
+
+	if (STREAM_WRITEABLE(bulk->s) < 2 * addrlen + 4 * sizeof(uint64_t)) {
+		ipmr_stats_bulk_send(bulk, false, 0);
+		ipmr_stats_bulk_start(bulk);
+	}
+
+	if (bulk->family == AF_INET) {
+		stream_write(bulk->s, &mr->src.ipaddr_v4, addrlen);
+		stream_write(bulk->s, &mr->grp.ipaddr_v4, addrlen);
+	} else {
+		stream_write(bulk->s, &mr->src.ipaddr_v6, addrlen);
+		stream_write(bulk->s, &mr->grp.ipaddr_v6, addrlen);
+	}
+	stream_putq(bulk->s, mr->lastused);
+	stream_putq(bulk->s, mr->pktcnt);
+	stream_putq(bulk->s, mr->bytecnt);
+	stream_putq(bulk->s, mr->wrong_if);
+
+	bulk->count++;
+	bulk->total++;
+}
+
+/*
+ * Return the statistics of all multicast routes in the vrf, spread over as
+ * many messages as needed.  The last one has ZAPI_IPMR_STATS_BULK_LAST set
+ * and carries the result of the kernel dump.
+ */
+void zebra_ipmr_route_stats_bulk(ZAPI_HANDLER_ARGS)
+{
+	struct ipmr_stats_bulk bulk = {
+		.client = client,
+		.zvrf = zvrf,
+	};
+	int suc = -1;
+
+	STREAM_GETL(msg, bulk.family);
+
+	if (bulk.family != AF_INET && bulk.family != AF_INET6) {
+		zlog_warn("%s: Invalid address family received while parsing",
+			  __func__);
+		return;
+	}
+
+	ipmr_stats_bulk_start(&bulk);
+	suc = kernel_get_ipmr_sg_stats_bulk(zvrf, bulk.family,
+					    ipmr_stats_bulk_add, &bulk);
+
+	if (IS_ZEBRA_DEBUG_KERNEL)
+		zlog_debug("Dumped %u %s mroutes for %s(%u): %d", bulk.total,
+			   bulk.family == AF_INET ? "IPv4" : "IPv6",
+			   zvrf->vrf->name, zvrf->vrf->vrf_id, suc);
+
+	ipmr_stats_bulk_send(&bulk, true, suc);
+	return;
+
+stream_failure:
+	return;
+}
@@ -19,9 +19,15 @@ struct mcast_route_data {
 	struct ipaddr grp;
 	unsigned int ifindex;
 	unsigned long long lastused;
+
+	/* only filled in by kernel_get_ipmr_sg_stats_bulk() */
+	uint64_t pktcnt;
+	uint64_t bytecnt;
+	uint64_t wrong_if;
 };
 
 void zebra_ipmr_route_stats(ZAPI_HANDLER_ARGS);
+void zebra_ipmr_route_stats_bulk(ZAPI_HANDLER_ARGS);
 
 #ifdef __cplusplus
 }
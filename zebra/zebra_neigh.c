@@ -62,6 +62,8 @@ static int zebra_neigh_rb_cmp(const struct zebra_neigh_ent *n1,
 }
 RB_GENERATE(zebra_neigh_rb_head, zebra_neigh_ent, rb_node, zebra_neigh_rb_cmp);
 
+DECLARE_DLIST(zebra_neigh_pending, struct zebra_neigh_ent, pending_item);
+
 static struct zebra_neigh_ent *zebra_neigh_find(ifindex_t ifindex,
 						struct ipaddr *ip)
 {
@@ -108,8 +110,50 @@ static void zebra_neigh_pbr_rules_update(struct zebra_neigh_ent *n)
 	struct zebra_pbr_rule *rule;
 	struct listnode *node;
 
-	for (ALL_LIST_ELEMENTS_RO(n->pbr_rule_list, node, rule))
+	for (ALL_LIST_ELEMENTS_RO(n->pbr_rule_list, node, rule)) {
 		dplane_pbr_rule_update(rule, rule);
+		zneigh_info->rule_updates++;
+	}
+}
+
+static void zebra_neigh_changes_run(struct event *t)
+{
+	struct zebra_neigh_ent *n;
+
+	zneigh_info->runs++;
+
+	while ((n = zebra_neigh_pending_pop(&zneigh_info->pending))) {
+		n->flags &= ~ZEBRA_NEIGH_ENT_PENDING;
+		zebra_neigh_pbr_rules_update(n);
+	}
+}
+
+/* the rules using n need to pick up its new state */
+static void zebra_neigh_change(struct zebra_neigh_ent *n)
+{
+	zneigh_info->changes++;
+
+	if (n->flags & ZEBRA_NEIGH_ENT_PENDING) {
+		zneigh_info->coalesced++;
+		return;
+	}
+
+	n->flags |= ZEBRA_NEIGH_ENT_PENDING;
+	zebra_neigh_pending_add_tail(&zneigh_info->pending, n);
+
+	if (!zneigh_info->t_pending)
+		event_add_timer_msec(zrouter.master, zebra_neigh_changes_run,
+				     NULL, ZEBRA_NEIGH_COALESCE_MSEC,
+				     &zneigh_info->t_pending);
+}
+
+static void zebra_neigh_change_cancel(struct zebra_neigh_ent *n)
+{
+	if (!(n->flags & ZEBRA_NEIGH_ENT_PENDING))
+		return;
+
+	n->flags &= ~ZEBRA_NEIGH_ENT_PENDING;
+	zebra_neigh_pending_del(&zneigh_info->pending, n);
 }
 
 static void zebra_neigh_free(struct zebra_neigh_ent *n)
@@ -122,7 +166,7 @@ static void zebra_neigh_free(struct zebra_neigh_ent *n)
 			n->flags &= ~ZEBRA_NEIGH_ENT_ACTIVE;
 			memset(&n->mac, 0, sizeof(n->mac));
 		}
-		zebra_neigh_pbr_rules_update(n);
+		zebra_neigh_change(n);
 		return;
 	}
 	if (IS_ZEBRA_DEBUG_NEIGH)
@@ -130,6 +174,7 @@ static void zebra_neigh_free(struct zebra_neigh_ent *n)
 			   &n->ip, &n->mac);
 
 	/* cleanup resources maintained against the neigh */
+	zebra_neigh_change_cancel(n);
 	list_delete(&n->pbr_rule_list);
 
 	RB_REMOVE(zebra_neigh_rb_head, &zneigh_info->neigh_rb_tree, n);
@@ -171,7 +216,7 @@ void zebra_neigh_add(struct interface *ifp, struct ipaddr *ip,
 		n->flags |= ZEBRA_NEIGH_ENT_ACTIVE;
 
 		/* update rules linked to the neigh */
-		zebra_neigh_pbr_rules_update(n);
+		zebra_neigh_change(n);
 	} else {
 		zebra_neigh_new(ifp->ifindex, ip, mac);
 	}
@@ -251,12 +296,20 @@ void zebra_neigh_show(struct vty *vty)
 		"#Rules");
 	RB_FOREACH (n, zebra_neigh_rb_head, &zneigh_info->neigh_rb_tree)
 		zebra_neigh_show_one(vty, n);
+
+	vty_out(vty,
+		"\nChanges: %" PRIu64 " (%" PRIu64 " coalesced), pending: %zu\n",
+		zneigh_info->changes, zneigh_info->coalesced,
+		zebra_neigh_pending_count(&zneigh_info->pending));
+	vty_out(vty, "Rule updates: %" PRIu64 " in %" PRIu64 " runs\n",
+		zneigh_info->rule_updates, zneigh_info->runs);
 }
 
 void zebra_neigh_init(void)
 {
 	zneigh_info = XCALLOC(MTYPE_ZNEIGH_INFO, sizeof(*zrouter.neigh_info));
 	RB_INIT(zebra_neigh_rb_head, &zneigh_info->neigh_rb_tree);
+	zebra_neigh_pending_init(&zneigh_info->pending);
 }
 
 void zebra_neigh_terminate(void)
@@ -269,5 +322,10 @@ void zebra_neigh_terminate(void)
 	RB_FOREACH_SAFE (n, zebra_neigh_rb_head, &zneigh_info->neigh_rb_tree,
 			 next)
 		zebra_neigh_free(n);
+	/* entries still used by rules survive zebra_neigh_free() */
+	EVENT_OFF(zneigh_info->t_pending);
+	while ((n = zebra_neigh_pending_pop(&zneigh_info->pending)))
+		n->flags &= ~ZEBRA_NEIGH_ENT_PENDING;
+	zebra_neigh_pending_fini(&zneigh_info->pending);
 	XFREE(MTYPE_ZNEIGH_INFO, zneigh_info);
 }
@@ -12,9 +12,18 @@
 #include <zebra.h>
 
 #include "if.h"
+#include "typesafe.h"
 
 #define zneigh_info zrouter.neigh_info
 
+/* Changes to a neighbor used by PBR rules are collected for this long and
+ * then pushed to the rules once, so a flapping neighbor doesn't reprogram
+ * them on every flap.
+ */
+#define ZEBRA_NEIGH_COALESCE_MSEC 20
+
+PREDECL_DLIST(zebra_neigh_pending);
+
 struct zebra_neigh_ent {
 	ifindex_t ifindex;
 	struct ipaddr ip;
@@ -23,12 +32,16 @@ struct zebra_neigh_ent {
 
 	uint32_t flags;
 #define ZEBRA_NEIGH_ENT_ACTIVE (1 << 0) /* can be used for traffic */
+#define ZEBRA_NEIGH_ENT_PENDING (1 << 1) /* rules need to be updated */
 
 	/* memory used for adding the neigt entry to zneigh_info->es_rb_tree */
 	RB_ENTRY(zebra_neigh_ent) rb_node;
 
 	/* list of pbr rules associated with this neigh */
 	struct list *pbr_rule_list;
+
+	/* zneigh_info->pending, if ZEBRA_NEIGH_ENT_PENDING */
+	struct zebra_neigh_pending_item pending_item;
 };
 RB_HEAD(zebra_neigh_rb_head, zebra_neigh_ent);
 RB_PROTOTYPE(zebra_neigh_rb_head, zebra_neigh_ent, rb_node, zebra_es_rb_cmp);
@@ -36,6 +49,18 @@ RB_PROTOTYPE(zebra_neigh_rb_head, zebra_neigh_ent, rb_node, zebra_es_rb_cmp);
 struct zebra_neigh_info {
 	/* RB tree of neighbor entries  */
 	struct zebra_neigh_rb_head neigh_rb_tree;
+
+	/* neighbors with changes not yet pushed to their rules */
+	struct zebra_neigh_pending_head pending;
+	struct event *t_pending;
+
+	/* neighbor changes, the ones folded into an already pending change
+	 * and rule updates resulting from them
+	 */
+	uint64_t changes;
+	uint64_t coalesced;
+	uint64_t rule_updates;
+	uint64_t runs;
 };
 
 
@@ -29,6 +29,7 @@
 #include "zebra/zapi_msg.h"
 #include "zebra/rib.h"
 #include "zebra/zebra_vxlan.h"
+#include "zebra/zebra_restart.h"
 
 DEFINE_MTYPE_STATIC(ZEBRA, NHG, "Nexthop Group Entry");
 DEFINE_MTYPE_STATIC(ZEBRA, NHG_CONNECTED, "Nexthop Group Connected");
@@ -62,6 +63,7 @@ depends_find_add(struct nhg_connected_tree_head *head, struct nexthop *nh,
 static struct nhg_hash_entry *
 depends_find_id_add(struct nhg_connected_tree_head *head, uint32_t id);
 static void depends_decrement_free(struct nhg_connected_tree_head *head);
+static void zebra_nhg_handle_uninstall(struct nhg_hash_entry *nhe);
 
 static struct nhg_backup_info *
 nhg_backup_copy(const struct nhg_backup_info *orig);
@@ -435,6 +437,9 @@ static void *zebra_nhg_hash_alloc(void *arg)
 
 	nhe = zebra_nhe_copy(copy, copy->id);
 
+	/* Keep the key the entry was hashed with */
+	nhe->fingerprint = copy->fingerprint;
+
 	/* Mark duplicate nexthops in a group at creation time. */
 	nexthop_group_mark_duplicates(&(nhe->nhg));
 
@@ -463,22 +468,55 @@ static void *zebra_nhg_hash_alloc(void *arg)
 	return nhe;
 }
 
-uint32_t zebra_nhg_hash_key(const void *arg)
+/* Statistics of lookups in the zebra-owned nhe hash, main pthread only */
+static struct nhg_hash_stats {
+	uint64_t lookups;
+	uint64_t hits;
+	uint64_t compares;
+	uint64_t rejects;
+	uint64_t collisions;
+} nhg_hash_stats;
+
+uint64_t zebra_nhg_fingerprint(const struct nhg_hash_entry *nhe)
 {
-	const struct nhg_hash_entry *nhe = arg;
 	uint32_t key = 0x5a351234;
-	uint32_t primary = 0;
-	uint32_t backup = 0;
+	uint32_t top = 0x1b873593;
+	uint64_t primary, backup = 0;
+	uint64_t fp;
 
-	primary = nexthop_group_hash(&(nhe->nhg));
-	if (nhe->backup_info)
-		backup = nexthop_group_hash(&(nhe->backup_info->nhe->nhg));
+	if (nhe->fingerprint)
+		return nhe->fingerprint;
 
-	key = jhash_3words(primary, backup, nhe->type, key);
+	primary = nexthop_group_fingerprint(&(nhe->nhg));
+	if (nhe->backup_info)
+		backup = nexthop_group_fingerprint(
+			&(nhe->backup_info->nhe->nhg));
 
+	key = jhash_3words(primary >> 32, backup >> 32, nhe->type, key);
 	key = jhash_2words(nhe->vrf_id, nhe->afi, key);
 
-	return key;
+	top = jhash_3words(primary, backup, nhe->nhg.nhgr.buckets, top);
+	top = jhash_2words(nhe->nhg.nhgr.idle_timer,
+			   nhe->nhg.nhgr.unbalanced_timer, top);
+
+	fp = ((uint64_t)key << 32) | top;
+	if (!fp)
+		fp = 1;
+
+	/*
+	 * The nexthops of an nhe are not changed once it is used for a
+	 * lookup or is in the hash, so the value can be kept.
+	 */
+	((struct nhg_hash_entry *)nhe)->fingerprint = fp;
+
+	return fp;
+}
+
+uint32_t zebra_nhg_hash_key(const void *arg)
+{
+	const struct nhg_hash_entry *nhe = arg;
+
+	return zebra_nhg_fingerprint(nhe) >> 32;
 }
 
 uint32_t zebra_nhg_id_key(const void *arg)
@@ -528,17 +566,12 @@ static bool nhg_compare_nexthops(const struct nexthop *nh1,
 	return true;
 }
 
-bool zebra_nhg_hash_equal(const void *arg1, const void *arg2)
+static bool zebra_nhg_hash_equal_full(const struct nhg_hash_entry *nhe1,
+				      const struct nhg_hash_entry *nhe2)
 {
-	const struct nhg_hash_entry *nhe1 = arg1;
-	const struct nhg_hash_entry *nhe2 = arg2;
 	struct nexthop *nexthop1;
 	struct nexthop *nexthop2;
 
-	/* No matter what if they equal IDs, assume equal */
-	if (nhe1->id && nhe2->id && (nhe1->id == nhe2->id))
-		return true;
-
 	if (nhe1->type != nhe2->type)
 		return false;
 
@@ -605,6 +638,58 @@ bool zebra_nhg_hash_equal(const void *arg1, const void *arg2)
 	return true;
 }
 
+bool zebra_nhg_hash_equal(const void *arg1, const void *arg2)
+{
+	const struct nhg_hash_entry *nhe1 = arg1;
+	const struct nhg_hash_entry *nhe2 = arg2;
+
+	/* No matter what if they equal IDs, assume equal */
+	if (nhe1->id && nhe2->id && (nhe1->id == nhe2->id))
+		return true;
+
+	if (zebra_nhg_fingerprint(nhe1) != zebra_nhg_fingerprint(nhe2)) {
+		nhg_hash_stats.rejects++;
+		return false;
+	}
+
+	nhg_hash_stats.compares++;
+	if (!zebra_nhg_hash_equal_full(nhe1, nhe2)) {
+		nhg_hash_stats.collisions++;
+		return false;
+	}
+
+	return true;
+}
+
+void zebra_nhg_hash_stats_show(struct vty *vty, json_object *json)
+{
+	if (json) {
+		json_object_int_add(json, "entries", zrouter.nhgs->count);
+		json_object_int_add(json, "lookups", nhg_hash_stats.lookups);
+		json_object_int_add(json, "hits", nhg_hash_stats.hits);
+		json_object_int_add(json, "fullCompares",
+				    nhg_hash_stats.compares);
+		json_object_int_add(json, "fingerprintRejects",
+				    nhg_hash_stats.rejects);
+		json_object_int_add(json, "fingerprintCollisions",
+				    nhg_hash_stats.collisions);
+		return;
+	}
+
+	vty_out(vty, "Nexthop group hash statistics:\n");
+	vty_out(vty, "  Entries:                %lu\n", zrouter.nhgs->count);
+	vty_out(vty, "  Lookups:                %" PRIu64 "\n",
+		nhg_hash_stats.lookups);
+	vty_out(vty, "  Hits:                   %" PRIu64 "\n",
+		nhg_hash_stats.hits);
+	vty_out(vty, "  Full compares:          %" PRIu64 "\n",
+		nhg_hash_stats.compares);
+	vty_out(vty, "  Fingerprint rejects:    %" PRIu64 "\n",
+		nhg_hash_stats.rejects);
+	vty_out(vty, "  Fingerprint collisions: %" PRIu64 "\n",
+		nhg_hash_stats.collisions);
+}
+
 bool zebra_nhg_hash_id_equal(const void *arg1, const void *arg2)
 {
 	const struct nhg_hash_entry *nhe1 = arg1;
@@ -676,6 +761,37 @@ static void handle_recursive_depend(struct nhg_connected_tree_head *nhg_depends,
 		depends_add(nhg_depends, depend);
 }
 
+/*
+ * ID for a new zebra owned nhe that the kernel still has from before a
+ * fast restart, 0 if there is none.  The nhe read from the kernel for it
+ * leaves the ID table, it stays around only as long as kernel routes
+ * use it.
+ */
+static uint32_t zebra_nhg_restart_id(struct nhg_hash_entry *lookup)
+{
+	struct nhg_hash_entry *old;
+	uint32_t id;
+
+	id = zebra_restart_nhg_claim(zebra_nhg_fingerprint(lookup),
+				     lookup->afi, lookup->vrf_id, lookup->type);
+	if (!id)
+		return 0;
+
+	old = zebra_nhg_lookup_id(id);
+	if (old) {
+		if (hash_lookup(zrouter.nhgs, old) == old)
+			return 0;
+
+		hash_release(zrouter.nhgs_id, old);
+		UNSET_FLAG(old->flags, NEXTHOP_GROUP_INSTALLED);
+		SET_FLAG(old->flags, NEXTHOP_GROUP_REPLACED);
+		if (old->refcnt == 0)
+			zebra_nhg_handle_uninstall(old);
+	}
+
+	return id;
+}
+
 /*
  * Lookup an nhe in the global hash, using data from another nhe. If 'lookup'
  * has an id value, that's used. Create a new global/shared nhe if not found.
@@ -699,9 +815,14 @@ static bool zebra_nhe_find(struct nhg_hash_entry **nhe, /* return value */
 
 	if (lookup->id)
 		(*nhe) = zebra_nhg_lookup_id(lookup->id);
-	else
+	else {
 		(*nhe) = hash_lookup(zrouter.nhgs, lookup);
 
+		nhg_hash_stats.lookups++;
+		if (*nhe)
+			nhg_hash_stats.hits++;
+	}
+
 	if (IS_ZEBRA_DEBUG_NHG_DETAIL)
 		zlog_debug("%s: lookup => %p (%pNG)", __func__, *nhe, *nhe);
 
@@ -712,6 +833,8 @@ static bool zebra_nhe_find(struct nhg_hash_entry **nhe, /* return value */
 	/* We're going to create/insert a new nhe:
 	 * assign the next global id value if necessary.
 	 */
+	if (lookup->id == 0 && !from_dplane)
+		lookup->id = zebra_nhg_restart_id(lookup);
 	if (lookup->id == 0)
 		lookup->id = nhg_get_next_id();
 
@@ -1113,6 +1236,9 @@ static void zebra_nhg_release(struct nhg_hash_entry *nhe)
 	 * If its not zebra owned, we didn't store it here and have to be
 	 * sure we don't clear one thats actually being used.
 	 */
+	if (CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_REPLACED))
+		return;
+
 	if (nhe->id < ZEBRA_NHG_PROTO_LOWER)
 		hash_release(zrouter.nhgs, nhe);
 
@@ -1328,6 +1454,9 @@ int zebra_nhg_kernel_find(uint32_t id, struct nexthop *nh, struct nh_grp *grp,
 		 */
 		id_counter = id;
 
+	if (startup)
+		zebra_restart_kernel_nhg(id, nh, grp, count, nhgr);
+
 	ctx = nhg_ctx_init(id, nh, grp, vrf_id, afi, type, count, nhgr);
 	nhg_ctx_set_op(ctx, NHG_CTX_OP_NEW);
 
@@ -2332,7 +2461,7 @@ static int nexthop_active(struct nexthop *nexthop, struct nhg_hash_entry *nhe,
 		return 0;
 	}
 
-	rn = route_node_match(table, (struct prefix *)&p);
+	rn = zebra_rnh_rcache_match(table, nexthop->vrf_id, &p);
 	while (rn) {
 		route_unlock_node(rn);
 
@@ -63,6 +63,13 @@ struct nhg_hash_entry {
 
 	uint32_t flags;
 
+	/*
+	 * Cached hash fingerprint, 0 until first computed: the upper half is
+	 * the hash key, the lower half lets zebra_nhg_hash_equal() reject
+	 * most key collisions without walking the nexthops.
+	 */
+	uint64_t fingerprint;
+
 	/* Dependency trees for other entries.
 	 * For instance a group with two
 	 * nexthops will have two dependencies
@@ -144,6 +151,13 @@ struct nhg_hash_entry {
  * Track FPM installation status..
  */
 #define NEXTHOP_GROUP_FPM (1 << 6)
+
+/*
+ * Read from the kernel at startup, and its ID has been taken over by
+ * the zebra owned NHG the kernel's group was created for before a fast
+ * restart.  It is in neither hash, and only kept until no route uses it.
+ */
+#define NEXTHOP_GROUP_REPLACED (1 << 7)
 };
 
 /* Upper 4 bits of the NHG are reserved for indicating the NHG type */
@@ -229,6 +243,9 @@ bool zebra_nhg_kernel_nexthops_enabled(void);
 void zebra_nhg_set_proto_nexthops_only(bool set);
 bool zebra_nhg_proto_nexthops_only(void);
 
+/* Hash fingerprint of the nexthops, cached in the nhe */
+uint64_t zebra_nhg_fingerprint(const struct nhg_hash_entry *nhe);
+
 /* Global control for use of activated backups for recursive resolution. */
 void zebra_nhg_set_recursive_use_backups(bool set);
 bool zebra_nhg_recursive_use_backups(void);
@@ -281,6 +298,9 @@ extern uint32_t zebra_nhg_id_key(const void *arg);
 extern bool zebra_nhg_hash_equal(const void *arg1, const void *arg2);
 extern bool zebra_nhg_hash_id_equal(const void *arg1, const void *arg2);
 
+/* Counters of the zebra nhe hash, for 'show nexthop-group rib statistics' */
+extern void zebra_nhg_hash_stats_show(struct vty *vty, json_object *json);
+
 /*
  * Process a context off of a queue.
  * Specifically this should be from
@@ -27,6 +27,19 @@ struct nlsock {
 
 	uint8_t *buf;
 	size_t buflen;
+
+	/*
+	 * Batch statistics, only updated by the dplane pthread for the
+	 * sockets it sends batches on.
+	 */
+	_Atomic uint64_t batches;
+	_Atomic uint64_t batch_msgs;
+	_Atomic uint64_t batch_bytes;
+	_Atomic uint64_t batch_usec;
+	_Atomic uint32_t batch_usec_max;
+
+	/* adaptive send threshold, 0 until the first batch was measured */
+	_Atomic uint32_t batch_limit;
 };
 #endif
 
@@ -47,6 +60,15 @@ struct zebra_ns {
 	struct nlsock netlink_dplane_out;
 	struct nlsock netlink_dplane_in;
 	struct event *t_netlink;
+
+	/*
+	 * Dedicated channel for reading the routing tables in chunks at
+	 * startup, only open while that read is in progress.
+	 */
+	struct nlsock netlink_read;
+	struct event *t_netlink_read;
+	struct timeval netlink_read_start;
+	int netlink_read_family;
 #endif
 
 	struct route_table *if_table;
@@ -0,0 +1,853 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Zebra fast restart state
+ * Copyright (C) 2026 The FRRouting Project
+ *
+ * A zebra started with -K keeps the routes the previous one left in the
+ * kernel until its clients have sent them again.  Without more information
+ * it still reprograms everything: the groups the clients' routes resolve
+ * to get new IDs, since the kernel's groups can't be matched to what zebra
+ * hashes on, and every re-sent route is installed again using one of them.
+ *
+ * With --fast-restart FILE, a retaining zebra writes FILE at shutdown:
+ *  - the hash fingerprint of each group it had installed, with its ID;
+ *  - the owner (type, instance, distance, metric, tag) of each installed
+ *    route, which the kernel only partly knows about;
+ *  - the clients owning these routes.
+ *
+ * The next zebra loads it before reading the kernel and remembers what the
+ * kernel still has for the IDs and prefixes in it.  A group created while
+ * restarting takes over the kernel's ID if its fingerprint matches, and
+ * once it or a route using it is to be installed, the dataplane is told to
+ * skip the kernel when the kernel already has exactly that.  Kernel routes
+ * get their owner back, so a client's route replaces them as it would
+ * have replaced its own.  Once every client in the file reports its
+ * routes complete, the stale routes are swept without waiting for -K.
+ *
+ * Nothing in the file is trusted on its own: data is only ever kept as it
+ * is when both the file and the kernel agree with what zebra would program
+ * now, a stale or foreign file just means everything is programmed again.
+ */
+
+#include <zebra.h>
+
+#include "hash.h"
+#include "jhash.h"
+#include "memory.h"
+#include "nexthop.h"
+#include "srcdest_table.h"
+#include "termtable.h"
+#include "typesafe.h"
+
+#include "zebra/debug.h"
+#include "zebra/rib.h"
+#include "zebra/rt.h"
+#include "zebra/zebra_errors.h"
+#include "zebra/zebra_restart.h"
+#include "zebra/zebra_router.h"
+#include "zebra/zserv.h"
+
+DEFINE_MTYPE_STATIC(ZEBRA, RESTART, "Fast restart state");
+
+#define RESTART_MAGIC "FRRZEBRS"
+#define RESTART_VERSION 1
+#define RESTART_BYTEORDER 0x01020304U
+
+struct restart_hdr {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteorder;
+
+	/* wall clock */
+	int64_t created;
+
+	uint32_t nnhgs;
+	uint32_t nclients;
+	uint64_t nroutes;
+};
+
+struct restart_nhg_rec {
+	uint64_t fingerprint;
+	uint32_t id;
+	uint32_t vrf_id;
+	uint8_t afi;
+	uint8_t type;
+	uint8_t pad[6];
+};
+
+struct restart_route_key {
+	uint32_t vrf_id;
+	uint32_t table;
+	uint8_t family;
+	uint8_t dst_len;
+	uint8_t src_len;
+	uint8_t pad;
+	uint8_t dst[16];
+	uint8_t src[16];
+};
+
+struct restart_route_rec {
+	struct restart_route_key key;
+	uint32_t metric;
+	uint32_t tag;
+	uint16_t instance;
+	uint8_t type;
+	uint8_t distance;
+};
+
+struct restart_client_rec {
+	uint32_t vrf_id;
+	uint16_t instance;
+	uint8_t proto;
+	/* 1 << afi for each address family the client had routes in */
+	uint8_t afis;
+};
+
+PREDECL_HASH(restart_nhg_ids);
+PREDECL_HASH(restart_nhg_fps);
+PREDECL_HASH(restart_routes);
+PREDECL_HASH(restart_clients);
+
+struct restart_nhg {
+	struct restart_nhg_ids_item id_item;
+	struct restart_nhg_fps_item fp_item;
+	struct restart_nhg_rec rec;
+
+	/* the kernel had the ID at startup */
+	bool in_kernel;
+	/* a group of this run has taken over the ID */
+	bool claimed;
+	/* its first install has been compared */
+	bool checked;
+
+	/* what the kernel had, a group or a single nexthop */
+	uint8_t count;
+	struct nh_grp *grp;
+	struct nexthop *nh;
+	struct nhg_resilience nhgr;
+};
+
+struct restart_route {
+	struct restart_routes_item item;
+	struct restart_route_rec rec;
+
+	bool in_kernel;
+	bool checked;
+
+	/* the kernel route at startup */
+	uint32_t nhe_id;
+	uint32_t mtu;
+	route_tag_t tag;
+	union g_addr prefsrc;
+};
+
+struct restart_client {
+	struct restart_clients_item item;
+	struct restart_client_rec rec;
+
+	/* address families the client has sent all its routes for again */
+	uint8_t complete;
+	/* false if no client was connected for it while writing */
+	bool owned;
+};
+
+static int restart_nhg_id_cmp(const struct restart_nhg *a,
+			      const struct restart_nhg *b)
+{
+	return numcmp(a->rec.id, b->rec.id);
+}
+
+static uint32_t restart_nhg_id_hash(const struct restart_nhg *a)
+{
+	return jhash_1word(a->rec.id, 0x7e57a27);
+}
+
+DECLARE_HASH(restart_nhg_ids, struct restart_nhg, id_item, restart_nhg_id_cmp,
+	     restart_nhg_id_hash);
+
+static int restart_nhg_fp_cmp(const struct restart_nhg *a,
+			      const struct restart_nhg *b)
+{
+	if (a->rec.fingerprint != b->rec.fingerprint)
+		return numcmp(a->rec.fingerprint, b->rec.fingerprint);
+	if (a->rec.vrf_id != b->rec.vrf_id)
+		return numcmp(a->rec.vrf_id, b->rec.vrf_id);
+	if (a->rec.afi != b->rec.afi)
+		return numcmp(a->rec.afi, b->rec.afi);
+	return numcmp(a->rec.type, b->rec.type);
+}
+
+static uint32_t restart_nhg_fp_hash(const struct restart_nhg *a)
+{
+	return a->rec.fingerprint >> 32;
+}
+
+DECLARE_HASH(restart_nhg_fps, struct restart_nhg, fp_item, restart_nhg_fp_cmp,
+	     restart_nhg_fp_hash);
+
+static int restart_route_cmp(const struct restart_route *a,
+			     const struct restart_route *b)
+{
+	return memcmp(&a->rec.key, &b->rec.key, sizeof(a->rec.key));
+}
+
+static uint32_t restart_route_hash(const struct restart_route *a)
+{
+	return jhash(&a->rec.key, sizeof(a->rec.key), 0x7e57a27);
+}
+
+DECLARE_HASH(restart_routes, struct restart_route, item, restart_route_cmp,
+	     restart_route_hash);
+
+static int restart_client_cmp(const struct restart_client *a,
+			      const struct restart_client *b)
+{
+	if (a->rec.proto != b->rec.proto)
+		return numcmp(a->rec.proto, b->rec.proto);
+	if (a->rec.instance != b->rec.instance)
+		return numcmp(a->rec.instance, b->rec.instance);
+	return numcmp(a->rec.vrf_id, b->rec.vrf_id);
+}
+
+static uint32_t restart_client_hash(const struct restart_client *a)
+{
+	return jhash_3words(a->rec.proto, a->rec.instance, a->rec.vrf_id,
+			    0x7e57a27);
+}
+
+DECLARE_HASH(restart_clients, struct restart_client, item,
+	     restart_client_cmp, restart_client_hash);
+
+static struct {
+	char *path;
+	/* between loading the file and the sweep of stale routes */
+	bool active;
+	bool loaded;
+	bool early_sweep;
+
+	struct restart_nhg_ids_head nhg_ids;
+	struct restart_nhg_fps_head nhg_fps;
+	struct restart_routes_head routes;
+	struct restart_clients_head clients;
+
+	int64_t created;
+	uint32_t nhgs;
+	uint32_t nhgs_kernel;
+	uint32_t nhgs_claimed;
+	uint32_t nhgs_kept;
+	uint32_t nhgs_changed;
+	uint64_t routes_loaded;
+	uint64_t routes_kernel;
+	uint64_t routes_kept;
+	uint64_t routes_changed;
+	uint32_t clients_complete;
+} restart;
+
+const char *zebra_restart_path(void)
+{
+	return restart.path;
+}
+
+static void restart_route_key(struct restart_route_key *key, vrf_id_t vrf_id,
+			      uint32_t table, const struct prefix *p,
+			      const struct prefix *src_p)
+{
+	memset(key, 0, sizeof(*key));
+	key->vrf_id = vrf_id;
+	key->table = table;
+	key->family = p->family;
+	key->dst_len = p->prefixlen;
+	memcpy(key->dst, &p->u.prefix, prefix_blen(p));
+	if (src_p && src_p->prefixlen) {
+		key->src_len = src_p->prefixlen;
+		memcpy(key->src, &src_p->u.prefix6, sizeof(key->src));
+	}
+}
+
+/*
+ * Writing
+ */
+
+struct restart_write {
+	FILE *fp;
+	bool ok;
+	struct restart_hdr hdr;
+	struct restart_clients_head clients;
+};
+
+static void restart_fwrite(struct restart_write *w, const void *data,
+			   size_t len)
+{
+	if (w->ok && fwrite(data, len, 1, w->fp) != 1)
+		w->ok = false;
+}
+
+static void restart_write_nhg(struct hash_bucket *bucket, void *arg)
+{
+	struct nhg_hash_entry *nhe = bucket->data;
+	struct restart_write *w = arg;
+	struct restart_nhg_rec rec = {};
+
+	if (nhe->id >= ZEBRA_NHG_PROTO_LOWER ||
+	    !CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_INSTALLED))
+		return;
+
+	/* groups read from the kernel and still around are not zebra's */
+	if (hash_lookup(zrouter.nhgs, nhe) != nhe)
+		return;
+
+	rec.fingerprint = zebra_nhg_fingerprint(nhe);
+	rec.id = nhe->id;
+	rec.vrf_id = nhe->vrf_id;
+	rec.afi = nhe->afi;
+	rec.type = nhe->type;
+	restart_fwrite(w, &rec, sizeof(rec));
+	w->hdr.nnhgs++;
+}
+
+static void restart_write_client(struct restart_write *w,
+				 const struct route_entry *re, afi_t afi)
+{
+	struct restart_client ref = {}, *rc;
+
+	ref.rec.proto = re->type;
+	ref.rec.instance = re->instance;
+	ref.rec.vrf_id = re->vrf_id;
+
+	rc = restart_clients_find(&w->clients, &ref);
+	if (!rc) {
+		rc = XCALLOC(MTYPE_RESTART, sizeof(*rc));
+		rc->rec = ref.rec;
+		rc->owned = !!zserv_find_client(re->type, re->instance);
+		restart_clients_add(&w->clients, rc);
+	}
+	rc->rec.afis |= 1 << afi;
+}
+
+static void restart_write_routes(struct restart_write *w)
+{
+	struct zebra_router_table *zrt;
+	const struct prefix *p, *src_p;
+	struct restart_route_rec rec;
+	struct route_node *rn;
+	struct route_entry *re;
+	rib_dest_t *dest;
+
+	RB_FOREACH (zrt, zebra_router_table_head, &zrouter.tables) {
+		if (zrt->safi != SAFI_UNICAST)
+			continue;
+
+		for (rn = route_top(zrt->table); rn;
+		     rn = srcdest_route_next(rn)) {
+			dest = rib_dest_from_rnode(rn);
+			re = dest ? dest->selected_fib : NULL;
+			if (!re || RIB_SYSTEM_ROUTE(re) ||
+			    !CHECK_FLAG(re->status, ROUTE_ENTRY_INSTALLED))
+				continue;
+
+			srcdest_rnode_prefixes(rn, &p, &src_p);
+
+			memset(&rec, 0, sizeof(rec));
+			restart_route_key(&rec.key, re->vrf_id, re->table, p,
+					  src_p);
+			rec.metric = re->metric;
+			rec.tag = re->tag;
+			rec.instance = re->instance;
+			rec.type = re->type;
+			rec.distance = re->distance;
+			restart_fwrite(w, &rec, sizeof(rec));
+			w->hdr.nroutes++;
+
+			restart_write_client(w, re, family2afi(p->family));
+		}
+	}
+}
+
+void zebra_restart_write(void)
+{
+	struct restart_write w = { .ok = true };
+	struct restart_client *rc;
+	char tmpname[MAXPATHLEN];
+	int fd;
+
+	if (!restart.path)
+		return;
+
+	snprintf(tmpname, sizeof(tmpname), "%s.tmp", restart.path);
+	fd = open(tmpname, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	w.fp = fd >= 0 ? fdopen(fd, "w") : NULL;
+	if (!w.fp) {
+		flog_warn(EC_ZEBRA_FAST_RESTART, "%s: %s: %s", __func__,
+			  tmpname, safe_strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return;
+	}
+
+	memcpy(w.hdr.magic, RESTART_MAGIC, sizeof(w.hdr.magic));
+	w.hdr.version = RESTART_VERSION;
+	w.hdr.byteorder = RESTART_BYTEORDER;
+	w.hdr.created = time(NULL);
+	restart_clients_init(&w.clients);
+
+	/* header is written last, once the counts are known */
+	w.ok = fseek(w.fp, sizeof(w.hdr), SEEK_SET) == 0;
+	hash_iterate(zrouter.nhgs_id, restart_write_nhg, &w);
+	restart_write_routes(&w);
+
+	while ((rc = restart_clients_pop(&w.clients))) {
+		if (rc->owned) {
+			restart_fwrite(&w, &rc->rec, sizeof(rc->rec));
+			w.hdr.nclients++;
+		}
+		XFREE(MTYPE_RESTART, rc);
+	}
+	restart_clients_fini(&w.clients);
+
+	w.ok = w.ok && fseek(w.fp, 0, SEEK_SET) == 0 &&
+	       fwrite(&w.hdr, sizeof(w.hdr), 1, w.fp) == 1;
+	w.ok = w.ok && fflush(w.fp) == 0 && fsync(fileno(w.fp)) == 0;
+	w.ok = fclose(w.fp) == 0 && w.ok;
+
+	if (!w.ok || rename(tmpname, restart.path) < 0) {
+		flog_warn(EC_ZEBRA_FAST_RESTART, "%s: writing %s failed: %s",
+			  __func__, restart.path, safe_strerror(errno));
+		unlink(tmpname);
+		return;
+	}
+
+	zlog_info("Fast restart state %s: %u NHGs, %" PRIu64
+		  " routes, %u clients",
+		  restart.path, w.hdr.nnhgs, w.hdr.nroutes, w.hdr.nclients);
+}
+
+/*
+ * Loading
+ */
+
+static bool restart_hdr_ok(const struct restart_hdr *hdr, off_t size)
+{
+	uint64_t expect = sizeof(*hdr);
+
+	if (memcmp(hdr->magic, RESTART_MAGIC, sizeof(hdr->magic)) ||
+	    hdr->version != RESTART_VERSION ||
+	    hdr->byteorder != RESTART_BYTEORDER)
+		return false;
+
+	expect += (uint64_t)hdr->nnhgs * sizeof(struct restart_nhg_rec);
+	expect += (uint64_t)hdr->nclients * sizeof(struct restart_client_rec);
+	if (hdr->nroutes > (uint64_t)size / sizeof(struct restart_route_rec))
+		return false;
+	expect += hdr->nroutes * sizeof(struct restart_route_rec);
+
+	return expect == (uint64_t)size;
+}
+
+static bool restart_load(FILE *fp, const struct restart_hdr *hdr)
+{
+	struct restart_nhg *rnhg;
+	struct restart_route *rr;
+	struct restart_client *rc;
+
+	for (uint32_t i = 0; i < hdr->nnhgs; i++) {
+		rnhg = XCALLOC(MTYPE_RESTART, sizeof(*rnhg));
+		if (fread(&rnhg->rec, sizeof(rnhg->rec), 1, fp) != 1) {
+			XFREE(MTYPE_RESTART, rnhg);
+			return false;
+		}
+
+		/* the same key twice can only be a fingerprint collision */
+		if (restart_nhg_ids_add(&restart.nhg_ids, rnhg)) {
+			XFREE(MTYPE_RESTART, rnhg);
+			continue;
+		}
+		if (restart_nhg_fps_add(&restart.nhg_fps, rnhg)) {
+			restart_nhg_ids_del(&restart.nhg_ids, rnhg);
+			XFREE(MTYPE_RESTART, rnhg);
+			continue;
+		}
+		restart.nhgs++;
+	}
+
+	for (uint64_t i = 0; i < hdr->nroutes; i++) {
+		rr = XCALLOC(MTYPE_RESTART, sizeof(*rr));
+		if (fread(&rr->rec, sizeof(rr->rec), 1, fp) != 1) {
+			XFREE(MTYPE_RESTART, rr);
+			return false;
+		}
+		if (restart_routes_add(&restart.routes, rr)) {
+			XFREE(MTYPE_RESTART, rr);
+			continue;
+		}
+		restart.routes_loaded++;
+	}
+
+	for (uint32_t i = 0; i < hdr->nclients; i++) {
+		rc = XCALLOC(MTYPE_RESTART, sizeof(*rc));
+		if (fread(&rc->rec, sizeof(rc->rec), 1, fp) != 1) {
+			XFREE(MTYPE_RESTART, rc);
+			return false;
+		}
+		if (restart_clients_add(&restart.clients, rc))
+			XFREE(MTYPE_RESTART, rc);
+	}
+
+	return true;
+}
+
+static void restart_free(void)
+{
+	struct restart_nhg *rnhg;
+	struct restart_route *rr;
+	struct restart_client *rc;
+
+	while ((rnhg = restart_nhg_ids_pop(&restart.nhg_ids))) {
+		restart_nhg_fps_del(&restart.nhg_fps, rnhg);
+		XFREE(MTYPE_RESTART, rnhg->grp);
+		if (rnhg->nh)
+			nexthop_free(rnhg->nh);
+		XFREE(MTYPE_RESTART, rnhg);
+	}
+	while ((rr = restart_routes_pop(&restart.routes)))
+		XFREE(MTYPE_RESTART, rr);
+	while ((rc = restart_clients_pop(&restart.clients)))
+		XFREE(MTYPE_RESTART, rc);
+}
+
+void zebra_restart_init(const char *path)
+{
+	struct restart_hdr hdr;
+	struct stat st;
+	FILE *fp;
+
+	restart.path = XSTRDUP(MTYPE_RESTART, path);
+	restart_nhg_ids_init(&restart.nhg_ids);
+	restart_nhg_fps_init(&restart.nhg_fps);
+	restart_routes_init(&restart.routes);
+	restart_clients_init(&restart.clients);
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		if (errno != ENOENT)
+			flog_warn(EC_ZEBRA_FAST_RESTART, "%s: %s: %s",
+				  __func__, path, safe_strerror(errno));
+		return;
+	}
+
+	if (fstat(fileno(fp), &st) < 0 || fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    !restart_hdr_ok(&hdr, st.st_size) || !restart_load(fp, &hdr)) {
+		flog_warn(EC_ZEBRA_FAST_RESTART,
+			  "%s: %s is not a usable fast restart state, ignoring it",
+			  __func__, path);
+		restart_free();
+		restart.nhgs = 0;
+		restart.routes_loaded = 0;
+		fclose(fp);
+		return;
+	}
+	fclose(fp);
+
+	restart.active = true;
+	restart.loaded = true;
+	restart.created = hdr.created;
+
+	zlog_info("Fast restart state %s: %u NHGs, %" PRIu64
+		  " routes, %zu clients",
+		  path, restart.nhgs, restart.routes_loaded,
+		  restart_clients_count(&restart.clients));
+}
+
+/*
+ * Kernel state at startup
+ */
+
+void zebra_restart_kernel_nhg(uint32_t id, const struct nexthop *nh,
+			      const struct nh_grp *grp, uint8_t count,
+			      const struct nhg_resilience *nhgr)
+{
+	struct restart_nhg ref = {}, *rnhg;
+
+	if (!restart.active)
+		return;
+
+	ref.rec.id = id;
+	rnhg = restart_nhg_ids_find(&restart.nhg_ids, &ref);
+	if (!rnhg || rnhg->in_kernel)
+		return;
+
+	rnhg->in_kernel = true;
+	rnhg->count = count;
+	if (count) {
+		rnhg->grp = XMALLOC(MTYPE_RESTART, count * sizeof(*grp));
+		memcpy(rnhg->grp, grp, count * sizeof(*grp));
+	} else if (nh)
+		rnhg->nh = nexthop_dup(nh, NULL);
+	if (nhgr)
+		rnhg->nhgr = *nhgr;
+
+	restart.nhgs_kernel++;
+}
+
+void zebra_restart_kernel_route(struct route_entry *re, afi_t afi,
+				const struct prefix *p,
+				const struct prefix_ipv6 *src_p,
+				const void *prefsrc)
+{
+	struct restart_route ref, *rr;
+
+	if (!restart.active)
+		return;
+
+	restart_route_key(&ref.rec.key, re->vrf_id, re->table, p,
+			  (const struct prefix *)src_p);
+	rr = restart_routes_find(&restart.routes, &ref);
+	if (!rr || rr->in_kernel || rr->rec.type != re->type)
+		return;
+
+	rr->in_kernel = true;
+	rr->nhe_id = re->nhe_id;
+	rr->mtu = re->mtu;
+	rr->tag = re->tag;
+	if (prefsrc)
+		memcpy(&rr->prefsrc, prefsrc, prefix_blen(p));
+
+	/* the kernel knows the protocol, but not which part of it */
+	re->instance = rr->rec.instance;
+	re->distance = rr->rec.distance;
+	re->metric = rr->rec.metric;
+	re->tag = rr->rec.tag;
+
+	restart.routes_kernel++;
+}
+
+/*
+ * Restarting
+ */
+
+uint32_t zebra_restart_nhg_claim(uint64_t fingerprint, afi_t afi,
+				 vrf_id_t vrf_id, int type)
+{
+	struct restart_nhg ref = {}, *rnhg;
+
+	if (!restart.active)
+		return 0;
+
+	ref.rec.fingerprint = fingerprint;
+	ref.rec.vrf_id = vrf_id;
+	ref.rec.afi = afi;
+	ref.rec.type = type;
+	rnhg = restart_nhg_fps_find(&restart.nhg_fps, &ref);
+	if (!rnhg || !rnhg->in_kernel || rnhg->claimed)
+		return 0;
+
+	rnhg->claimed = true;
+	restart.nhgs_claimed++;
+
+	if (IS_ZEBRA_DEBUG_NHG)
+		zlog_debug("%s: taking over NHG ID %u from the kernel",
+			   __func__, rnhg->rec.id);
+
+	return rnhg->rec.id;
+}
+
+bool zebra_restart_nhg_unchanged(const struct zebra_dplane_ctx *ctx)
+{
+	struct restart_nhg ref = {}, *rnhg;
+	const struct nexthop_group *ng;
+	const struct nh_grp *grp;
+	uint8_t count;
+	bool same;
+
+	if (!restart.active || dplane_ctx_get_op(ctx) != DPLANE_OP_NH_INSTALL)
+		return false;
+
+	ref.rec.id = dplane_ctx_get_nhe_id(ctx);
+	rnhg = restart_nhg_ids_find(&restart.nhg_ids, &ref);
+	if (!rnhg || !rnhg->claimed || rnhg->checked)
+		return false;
+	rnhg->checked = true;
+
+	ng = dplane_ctx_get_nhe_ng(ctx);
+	grp = dplane_ctx_get_nhe_nh_grp(ctx);
+	count = dplane_ctx_get_nhe_nh_grp_count(ctx);
+
+	same = count == rnhg->count;
+	for (uint8_t i = 0; same && i < count; i++)
+		same = grp[i].id == rnhg->grp[i].id &&
+		       grp[i].weight == rnhg->grp[i].weight;
+	if (same && !count)
+		same = rnhg->nh && ng->nexthop && !ng->nexthop->next &&
+		       nexthop_same(rnhg->nh, ng->nexthop);
+
+	same = same && ng->nhgr.buckets == rnhg->nhgr.buckets &&
+	       ng->nhgr.idle_timer == rnhg->nhgr.idle_timer &&
+	       ng->nhgr.unbalanced_timer == rnhg->nhgr.unbalanced_timer;
+
+	if (same)
+		restart.nhgs_kept++;
+	else
+		restart.nhgs_changed++;
+
+	if (IS_ZEBRA_DEBUG_NHG)
+		zlog_debug("%s: NHG ID %u %s", __func__, rnhg->rec.id,
+			   same ? "is unchanged in the kernel"
+				: "changed, reprogramming it");
+
+	return same;
+}
+
+/* the preferred source, picked as the netlink route encoding does */
+static bool restart_nexthop_src(const struct nexthop *nexthop, int family,
+				union g_addr *src)
+{
+	if (family == AF_INET) {
+		if (nexthop->rmap_src.ipv4.s_addr != INADDR_ANY)
+			src->ipv4 = nexthop->rmap_src.ipv4;
+		else if (nexthop->src.ipv4.s_addr != INADDR_ANY)
+			src->ipv4 = nexthop->src.ipv4;
+		else
+			return false;
+	} else {
+		if (!IN6_IS_ADDR_UNSPECIFIED(&nexthop->rmap_src.ipv6))
+			src->ipv6 = nexthop->rmap_src.ipv6;
+		else if (!IN6_IS_ADDR_UNSPECIFIED(&nexthop->src.ipv6))
+			src->ipv6 = nexthop->src.ipv6;
+		else
+			return false;
+	}
+
+	return true;
+}
+
+bool zebra_restart_route_unchanged(const struct zebra_dplane_ctx *ctx)
+{
+	const struct prefix *p = dplane_ctx_get_dest(ctx);
+	const struct nexthop *nexthop;
+	struct restart_route ref, *rr;
+	union g_addr src = {};
+	uint32_t mtu, nh_mtu;
+	bool same;
+
+	if (!restart.active)
+		return false;
+	if (dplane_ctx_get_op(ctx) != DPLANE_OP_ROUTE_INSTALL &&
+	    dplane_ctx_get_op(ctx) != DPLANE_OP_ROUTE_UPDATE)
+		return false;
+
+	restart_route_key(&ref.rec.key, dplane_ctx_get_vrf(ctx),
+			  dplane_ctx_get_table(ctx), p,
+			  dplane_ctx_get_src(ctx));
+	rr = restart_routes_find(&restart.routes, &ref);
+	if (!rr || !rr->in_kernel || rr->checked)
+		return false;
+	rr->checked = true;
+
+	mtu = dplane_ctx_get_mtu(ctx);
+	nh_mtu = dplane_ctx_get_nh_mtu(ctx);
+	if (!mtu || (nh_mtu && nh_mtu < mtu))
+		mtu = nh_mtu;
+
+	for (ALL_NEXTHOPS_PTR(dplane_ctx_get_ng(ctx), nexthop))
+		if (restart_nexthop_src(nexthop, p->family, &src))
+			break;
+
+	/* only routes using a kernel group, with the group's ID unchanged */
+	same = zebra_nhg_kernel_nexthops_enabled() &&
+	       !zebra_nhg_proto_nexthops_only() && rr->nhe_id &&
+	       rr->nhe_id == dplane_ctx_get_nhe_id(ctx) &&
+	       rr->rec.type == dplane_ctx_get_type(ctx) && rr->mtu == mtu &&
+	       !memcmp(&rr->prefsrc, &src, sizeof(src));
+#if defined(SUPPORT_REALMS)
+	same = same && rr->tag == dplane_ctx_get_tag(ctx);
+#endif
+
+	if (same)
+		restart.routes_kept++;
+	else
+		restart.routes_changed++;
+
+	if (IS_ZEBRA_DEBUG_RIB_DETAILED)
+		zlog_debug("%s: %pFX table %u %s", __func__, p,
+			   rr->rec.key.table,
+			   same ? "is unchanged in the kernel"
+				: "changed, reprogramming it");
+
+	return same;
+}
+
+void zebra_restart_client_complete(uint8_t proto, uint16_t instance,
+				   vrf_id_t vrf_id, afi_t afi)
+{
+	struct restart_client ref = {}, *rc;
+
+	if (!restart.active || afi >= AFI_MAX)
+		return;
+
+	ref.rec.proto = proto;
+	ref.rec.instance = instance;
+	ref.rec.vrf_id = vrf_id;
+	rc = restart_clients_find(&restart.clients, &ref);
+	if (!rc || rc->complete == rc->rec.afis)
+		return;
+
+	rc->complete |= (1 << afi) & rc->rec.afis;
+	if (rc->complete != rc->rec.afis)
+		return;
+
+	if (++restart.clients_complete <
+		    restart_clients_count(&restart.clients) ||
+	    !zrouter.sweeper)
+		return;
+
+	/* everyone is back, there is no point in waiting for -K */
+	zlog_info("Fast restart: all %u clients have sent their routes again, removing stale routes",
+		  restart.clients_complete);
+	restart.early_sweep = true;
+	event_cancel(&zrouter.sweeper);
+	event_add_event(zrouter.master, rib_sweep_route, NULL, 0,
+			&zrouter.sweeper);
+}
+
+void zebra_restart_done(void)
+{
+	if (!restart.active)
+		return;
+
+	restart.active = false;
+	restart_free();
+
+	zlog_info("Fast restart: %u of %u NHG IDs taken over, %u NHGs and %" PRIu64
+		  " routes left in the kernel as they were, %u NHGs and %" PRIu64
+		  " routes reprogrammed",
+		  restart.nhgs_claimed, restart.nhgs_kernel, restart.nhgs_kept,
+		  restart.routes_kept, restart.nhgs_changed,
+		  restart.routes_changed);
+}
+
+void zebra_restart_show(struct ttable *tt)
+{
+	if (!restart.path)
+		return;
+
+	if (!restart.loaded) {
+		ttable_add_row(tt, "Fast restart|%s, no state loaded",
+			       restart.path);
+		return;
+	}
+
+	ttable_add_row(tt, "Fast restart|%s, %s", restart.path,
+		       restart.active ? "in progress" : "done");
+	ttable_add_row(tt,
+		       "Fast restart NHGs|%u IDs taken over of %u in the kernel, %u kept, %u reprogrammed",
+		       restart.nhgs_claimed, restart.nhgs_kernel,
+		       restart.nhgs_kept, restart.nhgs_changed);
+	ttable_add_row(tt,
+		       "Fast restart routes|%" PRIu64
+		       " in the kernel, %" PRIu64 " kept, %" PRIu64
+		       " reprogrammed",
+		       restart.routes_kernel, restart.routes_kept,
+		       restart.routes_changed);
+	ttable_add_row(tt, "Fast restart clients|%u done%s",
+		       restart.clients_complete,
+		       restart.early_sweep ? ", stale routes swept early" : "");
+}
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Zebra fast restart state
+ * Copyright (C) 2026 The FRRouting Project
+ */
+
+#ifndef _ZEBRA_RESTART_H
+#define _ZEBRA_RESTART_H
+
+#include "prefix.h"
+#include "termtable.h"
+
+#include "zebra/rib.h"
+#include "zebra/zebra_dplane.h"
+#include "zebra/zebra_nhg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Load the state left by the previous zebra from path, before the kernel
+ * tables are read.  Without a call to this, everything below does nothing.
+ */
+extern void zebra_restart_init(const char *path);
+
+/* configured state file, NULL if fast restart is not used */
+extern const char *zebra_restart_path(void);
+
+/* write the state of the RIB at shutdown, it has to be retained */
+extern void zebra_restart_write(void);
+
+/* kernel tables read at startup */
+extern void zebra_restart_kernel_nhg(uint32_t id, const struct nexthop *nh,
+				     const struct nh_grp *grp, uint8_t count,
+				     const struct nhg_resilience *nhgr);
+extern void zebra_restart_kernel_route(struct route_entry *re, afi_t afi,
+				       const struct prefix *p,
+				       const struct prefix_ipv6 *src_p,
+				       const void *prefsrc);
+
+/*
+ * ID the kernel has for a group zebra is about to create, 0 if there
+ * is none to take over.
+ */
+extern uint32_t zebra_restart_nhg_claim(uint64_t fingerprint, afi_t afi,
+					vrf_id_t vrf_id, int type);
+
+/* is what ctx would program already in the kernel? */
+extern bool zebra_restart_nhg_unchanged(const struct zebra_dplane_ctx *ctx);
+extern bool zebra_restart_route_unchanged(const struct zebra_dplane_ctx *ctx);
+
+/* a client has sent all its routes for afi in vrf_id again */
+extern void zebra_restart_client_complete(uint8_t proto, uint16_t instance,
+					  vrf_id_t vrf_id, afi_t afi);
+
+/* the stale routes have been swept, the state is not needed any more */
+extern void zebra_restart_done(void);
+
+extern void zebra_restart_show(struct ttable *tt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ZEBRA_RESTART_H */
@@ -25,6 +25,8 @@
 #include "frr_pthread.h"
 #include "printfrr.h"
 #include "frrscript.h"
+#include "json.h"
+#include "flightrec.h"
 
 #include "zebra/zebra_router.h"
 #include "zebra/connected.h"
@@ -44,10 +46,12 @@
 #include "zebra/zebra_dplane.h"
 #include "zebra/zebra_evpn_mh.h"
 #include "zebra/zebra_script.h"
+#include "zebra/zebra_restart.h"
 
 DEFINE_MGROUP(ZEBRA, "zebra");
 
 DEFINE_MTYPE(ZEBRA, RE,       "Route Entry");
+DEFINE_MTYPE_STATIC(ZEBRA, RE_FIB,   "Route Entry FIB nexthops");
 DEFINE_MTYPE_STATIC(ZEBRA, RIB_DEST,       "RIB destination");
 DEFINE_MTYPE_STATIC(ZEBRA, RIB_UPDATE_CTX, "Rib update context object");
 DEFINE_MTYPE_STATIC(ZEBRA, WQ_WRAPPER, "WQ wrapper");
@@ -685,9 +689,9 @@ void rib_install_kernel(struct route_node *rn, struct route_entry *re,
 
 			/* Free old FIB nexthop group */
 			UNSET_FLAG(old->status, ROUTE_ENTRY_USE_FIB_NHG);
-			if (old->fib_ng.nexthop) {
-				nexthops_free(old->fib_ng.nexthop);
-				old->fib_ng.nexthop = NULL;
+			if (old->fib && old->fib->fib_ng.nexthop) {
+				nexthops_free(old->fib->fib_ng.nexthop);
+				old->fib->fib_ng.nexthop = NULL;
 			}
 		}
 
@@ -785,6 +789,7 @@ void zebra_rib_evaluate_rn_nexthops(struct route_node *rn, uint32_t seq,
 				    bool rt_delete)
 {
 	rib_dest_t *dest = rib_dest_from_rnode(rn);
+	const struct prefix *changed = &rn->p;
 	struct rnh *rnh;
 
 	/*
@@ -851,6 +856,15 @@ void zebra_rib_evaluate_rn_nexthops(struct route_node *rn, uint32_t seq,
 				continue;
 			}
 
+			/*
+			 * A change to this prefix can only affect the
+			 * resolution of nexthops that fall into it, the
+			 * others resolving over a less specific route up
+			 * the tree are left alone.
+			 */
+			if (!prefix_match(changed, p))
+				continue;
+
 			rnh->seqno = seq;
 			zebra_evaluate_rnh(zvrf, family2afi(p->family), 0, p,
 					   rnh->safi);
@@ -891,6 +905,7 @@ int rib_gc_dest(struct route_node *rn)
 	zebra_rib_evaluate_rn_nexthops(rn, zebra_router_get_next_sequence(),
 				       true);
 
+	zebra_rnh_rcache_dest_del(rn);
 	dest->rnode = NULL;
 	rnh_list_fini(&dest->nht);
 	XFREE(MTYPE_RIB_DEST, dest);
@@ -918,6 +933,7 @@ void zebra_rtable_node_cleanup(struct route_table *table,
 		/* Remove from update queue of FPM module */
 		hook_call(rib_shutdown, node);
 
+		zebra_rnh_rcache_dest_del(node);
 		rnh_list_fini(&dest->nht);
 		XFREE(MTYPE_RIB_DEST, node->info);
 	}
@@ -1192,6 +1208,9 @@ static void rib_process(struct route_node *rn)
 
 	vrf = vrf_lookup_by_id(vrf_id);
 
+	flightrec("rib_process", (uintptr_t)rn, vrf_id, rn->p.family,
+		  rn->p.prefixlen);
+
 	/*
 	 * we can have rn's that have a NULL info pointer
 	 * (dest).  As such let's not let the deref happen
@@ -1676,8 +1695,8 @@ static bool rib_update_re_from_ctx(struct route_entry *re,
 	/* TODO -- this isn't testing or comparing the FIB flags; we should
 	 * do a more explicit loop, checking the incoming notification's flags.
 	 */
-	if (re->fib_ng.nexthop && ctxnhg->nexthop &&
-	    nexthop_group_equal(&re->fib_ng, ctxnhg))
+	if (re->fib && re->fib->fib_ng.nexthop && ctxnhg->nexthop &&
+	    nexthop_group_equal(&re->fib->fib_ng, ctxnhg))
 		matched = true;
 
 	/* If the new FIB set matches the existing FIB set, we're done. */
@@ -1696,8 +1715,10 @@ static bool rib_update_re_from_ctx(struct route_entry *re,
 			zlog_debug(
 				"%s(%u:%u):%pRN update_from_ctx(): replacing fib nhg",
 				VRF_LOGNAME(vrf), re->vrf_id, re->table, rn);
-		nexthops_free(re->fib_ng.nexthop);
-		re->fib_ng.nexthop = NULL;
+		if (re->fib) {
+			nexthops_free(re->fib->fib_ng.nexthop);
+			re->fib->fib_ng.nexthop = NULL;
+		}
 
 		UNSET_FLAG(re->status, ROUTE_ENTRY_USE_FIB_NHG);
 
@@ -1756,8 +1777,8 @@ no_nexthops:
 	if (zrouter.asic_notification_nexthop_control) {
 		SET_FLAG(re->status, ROUTE_ENTRY_USE_FIB_NHG);
 		if (ctxnhg->nexthop)
-			copy_nexthops(&(re->fib_ng.nexthop), ctxnhg->nexthop,
-				      NULL);
+			copy_nexthops(&(route_entry_fib_get(re)->fib_ng.nexthop),
+				      ctxnhg->nexthop, NULL);
 	}
 
 check_backups:
@@ -1774,7 +1795,7 @@ check_backups:
 	/* First check the route's 'fib' list of backups, if it's present
 	 * from some previous event.
 	 */
-	re_nhg = &re->fib_backup_ng;
+	re_nhg = rib_get_fib_backup_nhg(re);
 	ctxnhg = dplane_ctx_get_backup_ng(ctx);
 
 	matched = false;
@@ -1789,7 +1810,7 @@ check_backups:
 				VRF_LOGNAME(vrf), re->vrf_id, rn);
 		goto done;
 
-	} else if (re->fib_backup_ng.nexthop) {
+	} else if (re_nhg->nexthop) {
 		/*
 		 * Free stale fib backup list and move on to check
 		 * the route's backups.
@@ -1798,8 +1819,8 @@ check_backups:
 			zlog_debug(
 				"%s(%u):%pRN update_from_ctx(): replacing fib backup nhg",
 				VRF_LOGNAME(vrf), re->vrf_id, rn);
-		nexthops_free(re->fib_backup_ng.nexthop);
-		re->fib_backup_ng.nexthop = NULL;
+		nexthops_free(re_nhg->nexthop);
+		re_nhg->nexthop = NULL;
 
 		/* Note that the installed nexthops have changed */
 		changed_p = true;
@@ -1831,8 +1852,8 @@ check_backups:
 				VRF_LOGNAME(vrf), re->vrf_id, rn,
 				(changed_p ? "true" : "false"));
 
-		copy_nexthops(&(re->fib_backup_ng.nexthop), ctxnhg->nexthop,
-			      NULL);
+		copy_nexthops(&(route_entry_fib_get(re)->fib_backup_ng.nexthop),
+			      ctxnhg->nexthop, NULL);
 	}
 
 done:
@@ -2201,7 +2222,7 @@ static int rib_count_installed_nh(struct route_entry *re)
 		/* The meaningful flag depends on where the installed
 		 * nexthops reside.
 		 */
-		if (nhg == &(re->fib_ng)) {
+		if (re->fib && nhg == &(re->fib->fib_ng)) {
 			if (CHECK_FLAG(nexthop->flags, NEXTHOP_FLAG_FIB))
 				count++;
 		} else {
@@ -2590,6 +2611,7 @@ static void process_subq_route(struct listnode *lnode, uint8_t qindex)
 	struct route_node *rnode = NULL;
 	rib_dest_t *dest = NULL;
 	struct zebra_vrf *zvrf = NULL;
+	struct timeval now;
 
 	rnode = listgetdata(lnode);
 	dest = rib_dest_from_rnode(rnode);
@@ -2597,6 +2619,9 @@ static void process_subq_route(struct listnode *lnode, uint8_t qindex)
 
 	zvrf = rib_dest_vrf(dest);
 
+	monotime(&now);
+	dplane_stage_account(DPLANE_STAGE_META_QUEUE, &dest->mq_time, &now);
+
 	rib_process(rnode);
 
 	if (IS_ZEBRA_DEBUG_RIB_DETAILED) {
@@ -2620,9 +2645,34 @@ static void process_subq_route(struct listnode *lnode, uint8_t qindex)
 		UNSET_FLAG(rib_dest_from_rnode(rnode)->flags,
 			   RIB_ROUTE_QUEUED(qindex));
 
+	if (zvrf) {
+		zvrf->mq_queued--;
+		zvrf->mq_processed++;
+	}
+
 	route_unlock_node(rnode);
 }
 
+struct nexthop_group rib_empty_fib_nhg;
+
+struct re_fib_nhgs *route_entry_fib_get(struct route_entry *re)
+{
+	if (!re->fib)
+		re->fib = XCALLOC(MTYPE_RE_FIB, sizeof(*re->fib));
+
+	return re->fib;
+}
+
+void route_entry_fib_free(struct route_entry *re)
+{
+	if (!re->fib)
+		return;
+
+	nexthops_free(re->fib->fib_ng.nexthop);
+	nexthops_free(re->fib->fib_backup_ng.nexthop);
+	XFREE(MTYPE_RE_FIB, re->fib);
+}
+
 static void rib_re_nhg_free(struct route_entry *re)
 {
 	if (re->nhe && re->nhe_id) {
@@ -2631,7 +2681,7 @@ static void rib_re_nhg_free(struct route_entry *re)
 	} else if (re->nhe && re->nhe->nhg.nexthop)
 		nexthops_free(re->nhe->nhg.nexthop);
 
-	nexthops_free(re->fib_ng.nexthop);
+	route_entry_fib_free(re);
 }
 
 struct zebra_early_route {
@@ -3129,6 +3179,33 @@ static unsigned int process_subq(struct list *subq,
 	return 1;
 }
 
+/*
+ * Process one route node of the VRF at the head of the sub-queue's round
+ * robin and move that VRF to the back, so a VRF with a lot of churn does
+ * not hold up the others.  Return 0 if no VRF has anything queued.
+ */
+static unsigned int process_subq_vrf(struct meta_queue *mq,
+				     enum meta_queue_indexes qindex)
+{
+	struct listnode *vnode = listhead(mq->vrfs[qindex]);
+	struct zebra_vrf *zvrf;
+
+	if (!vnode)
+		return 0;
+
+	zvrf = listgetdata(vnode);
+	list_delete_node(mq->vrfs[qindex], vnode);
+
+	process_subq(zvrf->mq_subq[qindex], qindex);
+
+	if (list_isempty(zvrf->mq_subq[qindex]))
+		list_delete(&zvrf->mq_subq[qindex]);
+	else
+		listnode_add(mq->vrfs[qindex], zvrf);
+
+	return 1;
+}
+
 /* Dispatch the meta queue by picking and processing the next node from
  * a non-empty sub-queue with lowest priority. wq is equal to zebra->ribq and
  * data is pointed to the meta queue structure.
@@ -3156,7 +3233,8 @@ static wq_item_status meta_queue_process(struct work_queue *dummy, void *data)
 	}
 
 	for (i = 0; i < MQ_SIZE; i++)
-		if (process_subq(mq->subq[i], i)) {
+		if (process_subq(mq->subq[i], i) ||
+		    process_subq_vrf(mq, i)) {
 			mq->size--;
 			break;
 		}
@@ -3188,6 +3266,7 @@ static int rib_meta_queue_add(struct meta_queue *mq, void *data)
 	struct route_node *rn = NULL;
 	struct route_entry *re = NULL, *curr_re = NULL;
 	uint8_t qindex = MQ_SIZE, curr_qindex = MQ_SIZE;
+	struct zebra_vrf *zvrf;
 
 	rn = (struct route_node *)data;
 
@@ -3213,8 +3292,25 @@ static int rib_meta_queue_add(struct meta_queue *mq, void *data)
 		return -1;
 	}
 
+	/* The wait is counted from when the node first got queued */
+	if (!CHECK_FLAG(rib_dest_from_rnode(rn)->flags,
+			RIB_ROUTE_QUEUED(MQ_SIZE) - 1))
+		monotime(&rib_dest_from_rnode(rn)->mq_time);
 	SET_FLAG(rib_dest_from_rnode(rn)->flags, RIB_ROUTE_QUEUED(qindex));
-	listnode_add(mq->subq[qindex], rn);
+
+	zvrf = rib_dest_vrf(rib_dest_from_rnode(rn));
+	if (zrouter.mq_per_vrf && zvrf) {
+		if (!zvrf->mq_subq[qindex]) {
+			zvrf->mq_subq[qindex] = list_new();
+			listnode_add(mq->vrfs[qindex], zvrf);
+		}
+		listnode_add(zvrf->mq_subq[qindex], rn);
+	} else
+		listnode_add(mq->subq[qindex], rn);
+
+	if (zvrf)
+		zvrf->mq_queued++;
+
 	route_lock_node(rn);
 	mq->size++;
 
@@ -3606,6 +3702,7 @@ static struct meta_queue *meta_queue_new(void)
 	for (i = 0; i < MQ_SIZE; i++) {
 		new->subq[i] = list_new();
 		assert(new->subq[i]);
+		new->vrfs[i] = list_new();
 	}
 
 	return new;
@@ -3703,6 +3800,9 @@ static void rib_meta_queue_free(struct meta_queue *mq, struct list *l,
 		if (dest && rib_dest_vrf(dest) != zvrf)
 			continue;
 
+		if (zvrf)
+			zvrf->mq_queued--;
+
 		route_unlock_node(rnode);
 		node->data = NULL;
 		list_delete_node(l, node);
@@ -3710,6 +3810,24 @@ static void rib_meta_queue_free(struct meta_queue *mq, struct list *l,
 	}
 }
 
+/* Drop the VRF's own route sub-queues, NULL zvrf drops them for all VRFs */
+static void rib_meta_queue_vrf_free(struct meta_queue *mq,
+				    enum meta_queue_indexes qindex,
+				    struct zebra_vrf *zvrf)
+{
+	struct listnode *node, *nnode;
+	struct zebra_vrf *z;
+
+	for (ALL_LIST_ELEMENTS(mq->vrfs[qindex], node, nnode, z)) {
+		if (zvrf && z != zvrf)
+			continue;
+
+		rib_meta_queue_free(mq, z->mq_subq[qindex], z);
+		list_delete(&z->mq_subq[qindex]);
+		list_delete_node(mq->vrfs[qindex], node);
+	}
+}
+
 static void early_route_meta_queue_free(struct meta_queue *mq, struct list *l,
 					struct zebra_vrf *zvrf)
 {
@@ -3753,10 +3871,13 @@ void meta_queue_free(struct meta_queue *mq, struct zebra_vrf *zvrf)
 		case META_QUEUE_BGP:
 		case META_QUEUE_OTHER:
 			rib_meta_queue_free(mq, mq->subq[i], zvrf);
+			rib_meta_queue_vrf_free(mq, i, zvrf);
 			break;
 		}
-		if (!zvrf)
+		if (!zvrf) {
 			list_delete(&mq->subq[i]);
+			list_delete(&mq->vrfs[i]);
+		}
 	}
 
 	if (!zvrf)
@@ -3799,6 +3920,7 @@ rib_dest_t *zebra_rib_create_dest(struct route_node *rn)
 	route_lock_node(rn); /* rn route table reference */
 	rn->info = dest;
 	dest->rnode = rn;
+	zebra_rnh_rcache_dest_add(rn);
 
 	return dest;
 }
@@ -3840,12 +3962,26 @@ rib_dest_t *zebra_rib_create_dest(struct route_node *rn)
  *
  */
 
+/* Per-table list of the routes of re's type */
+static struct re_type_list_head *rib_re_type_list(struct route_node *rn,
+						  struct route_entry *re)
+{
+	struct rib_table_info *info;
+
+	info = rib_table_info(srcdest_rnode_table(rn));
+	if (!info || re->type >= ZEBRA_ROUTE_MAX)
+		return NULL;
+
+	return &info->re_types[re->type];
+}
+
 /* Add RE to head of the route node. */
 static void rib_link(struct route_node *rn, struct route_entry *re, int process)
 {
 	rib_dest_t *dest;
 	afi_t afi;
 	const char *rmap_name;
+	struct re_type_list_head *types;
 
 	assert(re && rn);
 
@@ -3859,6 +3995,12 @@ static void rib_link(struct route_node *rn, struct route_entry *re, int process)
 
 	re_list_add_head(&dest->routes, re);
 
+	types = rib_re_type_list(rn, re);
+	if (types) {
+		re->rn = rn;
+		re_type_list_add_tail(types, re);
+	}
+
 	afi = (rn->p.family == AF_INET)
 		      ? AFI_IP
 		      : (rn->p.family == AF_INET6) ? AFI_IP6 : AFI_MAX;
@@ -3913,6 +4055,11 @@ void rib_unlink(struct route_node *rn, struct route_entry *re)
 
 	re_list_del(&dest->routes, re);
 
+	if (re->rn) {
+		re_type_list_del(rib_re_type_list(re->rn, re), re);
+		re->rn = NULL;
+	}
+
 	if (dest->selected_fib == re)
 		dest->selected_fib = NULL;
 
@@ -4311,6 +4458,12 @@ void rib_update_table(struct route_table *table, enum rib_update_event event,
 		      int rtype)
 {
 	struct route_node *rn;
+	struct rib_table_info *info = table->info;
+	struct route_entry *re;
+	unsigned long visited = 0;
+
+	if (event == RIB_UPDATE_KERNEL)
+		rtype = ZEBRA_ROUTE_KERNEL;
 
 	if (IS_ZEBRA_DEBUG_EVENT) {
 		struct zebra_vrf *zvrf;
@@ -4329,9 +4482,37 @@ void rib_update_table(struct route_table *table, enum rib_update_event event,
 			   rib_update_event2str(event), zebra_route_string(rtype));
 	}
 
+	if (event == RIB_UPDATE_MAX)
+		return;
+
+	/* A single route type only needs the nodes holding routes of that
+	 * type, which the table keeps on a list.
+	 */
+	if (info && rtype < ZEBRA_ROUTE_ALL) {
+		frr_each (re_type_list, &info->re_types[rtype], re) {
+			visited++;
+			if (CHECK_FLAG(rib_dest_from_rnode(re->rn)->flags,
+				       RIB_ROUTE_ANY_QUEUED))
+				continue;
+
+			rib_update_route_node(re->rn, rtype);
+		}
+
+		if (IS_ZEBRA_DEBUG_EVENT)
+			zlog_debug("%s: visited %lu routes, skipped %lu nodes",
+				   __func__, visited,
+				   table->count > visited ? table->count - visited
+							  : 0);
+		return;
+	}
+
 	/* Walk all routes and queue for processing, if appropriate for
-	 * the trigger event.
+	 * the trigger event. "any" protocol route-maps come in as
+	 * ZEBRA_ROUTE_MAX, which means every route as well.
 	 */
+	if (rtype > ZEBRA_ROUTE_ALL)
+		rtype = ZEBRA_ROUTE_ALL;
+
 	for (rn = route_top(table); rn; rn = srcdest_route_next(rn)) {
 		/*
 		 * If we are looking at a route node and the node
@@ -4343,17 +4524,7 @@ void rib_update_table(struct route_table *table, enum rib_update_event event,
 				  RIB_ROUTE_ANY_QUEUED))
 			continue;
 
-		switch (event) {
-		case RIB_UPDATE_KERNEL:
-			rib_update_route_node(rn, ZEBRA_ROUTE_KERNEL);
-			break;
-		case RIB_UPDATE_RMAP_CHANGE:
-		case RIB_UPDATE_OTHER:
-			rib_update_route_node(rn, rtype);
-			break;
-		case RIB_UPDATE_MAX:
-			break;
-		}
+		rib_update_route_node(rn, rtype);
 	}
 }
 
@@ -4499,6 +4670,14 @@ void rib_sweep_route(struct event *t)
 	struct vrf *vrf;
 	struct zebra_vrf *zvrf;
 
+	/* Kernel routes are still being read, sweep once that is done */
+	if (zrouter.kernel_reads_pending) {
+		zrouter.sweep_deferred = true;
+		return;
+	}
+
+	zrouter.sweep_deferred = false;
+
 	RB_FOREACH (vrf, vrf_id_head, &vrfs_by_id) {
 		if ((zvrf = vrf->info) == NULL)
 			continue;
@@ -4509,6 +4688,8 @@ void rib_sweep_route(struct event *t)
 
 	zebra_router_sweep_route();
 	zebra_router_sweep_nhgs();
+
+	zebra_restart_done();
 }
 
 /* Remove specific by protocol routes from 'table'. */
@@ -4579,6 +4760,144 @@ void rib_close_table(struct route_table *table)
 	}
 }
 
+struct rib_mem_stats {
+	unsigned long routes[ZEBRA_ROUTE_MAX];
+	size_t bytes[ZEBRA_ROUTE_MAX];
+	unsigned long fib_exts;
+	unsigned long dests;
+	size_t total;
+};
+
+static size_t rib_mem_nexthops(const struct nexthop_group *nhg)
+{
+	const struct nexthop *nh;
+	size_t bytes = 0;
+
+	for (nh = nhg->nexthop; nh; nh = nh->next)
+		bytes += sizeof(struct nexthop);
+
+	return bytes;
+}
+
+static void rib_mem_table(struct route_table *table,
+			  struct rib_mem_stats *stats)
+{
+	struct route_node *rn;
+	struct route_entry *re;
+	size_t bytes;
+
+	for (rn = route_top(table); rn; rn = srcdest_route_next(rn)) {
+		if (!rib_dest_from_rnode(rn))
+			continue;
+
+		stats->dests++;
+		stats->total += sizeof(rib_dest_t);
+
+		RNODE_FOREACH_RE (rn, re) {
+			if (re->type >= ZEBRA_ROUTE_MAX)
+				continue;
+
+			bytes = sizeof(*re);
+			if (re->fib) {
+				stats->fib_exts++;
+				bytes += sizeof(*re->fib);
+				bytes += rib_mem_nexthops(&re->fib->fib_ng);
+				bytes += rib_mem_nexthops(
+					&re->fib->fib_backup_ng);
+			}
+			if (re->opaque)
+				bytes += sizeof(*re->opaque) +
+					 re->opaque->length;
+
+			stats->routes[re->type]++;
+			stats->bytes[re->type] += bytes;
+			stats->total += bytes;
+		}
+	}
+}
+
+/*
+ * Approximate memory held by the RIB, broken down by VRF and route type.
+ * Nexthop groups are shared between routes (and VRFs) and are accounted
+ * for in "show nexthop-group rib" instead.
+ */
+void zebra_rib_memory_show(struct vty *vty, json_object *json)
+{
+	struct zebra_router_table *zrt;
+	struct zebra_vrf *zvrf;
+	struct vrf *vrf;
+	struct rib_mem_stats stats;
+	json_object *json_vrfs = NULL, *json_vrf, *json_types, *json_type;
+	int i;
+
+	if (json) {
+		json_object_int_add(json, "routeEntrySize",
+				    sizeof(struct route_entry));
+		json_object_int_add(json, "routeEntryFibSize",
+				    sizeof(struct re_fib_nhgs));
+		json_object_int_add(json, "destSize", sizeof(rib_dest_t));
+		json_vrfs = json_object_new_object();
+		json_object_object_add(json, "vrfs", json_vrfs);
+	} else
+		vty_out(vty,
+			"Route entry %zu bytes, fib nexthops %zu bytes, destination %zu bytes\n",
+			sizeof(struct route_entry), sizeof(struct re_fib_nhgs),
+			sizeof(rib_dest_t));
+
+	RB_FOREACH (vrf, vrf_name_head, &vrfs_by_name) {
+		zvrf = vrf->info;
+		if (!zvrf)
+			continue;
+
+		memset(&stats, 0, sizeof(stats));
+		RB_FOREACH (zrt, zebra_router_table_head, &zrouter.tables) {
+			if (rib_table_info(zrt->table)->zvrf != zvrf)
+				continue;
+			rib_mem_table(zrt->table, &stats);
+		}
+
+		if (json) {
+			json_vrf = json_object_new_object();
+			json_types = json_object_new_object();
+			json_object_object_add(json_vrf, "routes", json_types);
+			for (i = 0; i < ZEBRA_ROUTE_MAX; i++) {
+				if (!stats.routes[i])
+					continue;
+				json_type = json_object_new_object();
+				json_object_int_add(json_type, "count",
+						    stats.routes[i]);
+				json_object_int_add(json_type, "bytes",
+						    stats.bytes[i]);
+				json_object_object_add(json_types,
+						       zebra_route_string(i),
+						       json_type);
+			}
+			json_object_int_add(json_vrf, "fibNexthopGroups",
+					    stats.fib_exts);
+			json_object_int_add(json_vrf, "destinations",
+					    stats.dests);
+			json_object_int_add(json_vrf, "totalBytes",
+					    stats.total);
+			json_object_object_add(json_vrfs, vrf->name, json_vrf);
+			continue;
+		}
+
+		vty_out(vty, "\nVRF %s:\n", vrf->name);
+		vty_out(vty, "  %-16s %10s %12s\n", "Type", "Routes", "Bytes");
+		for (i = 0; i < ZEBRA_ROUTE_MAX; i++) {
+			if (!stats.routes[i])
+				continue;
+			vty_out(vty, "  %-16s %10lu %12zu\n",
+				zebra_route_string(i), stats.routes[i],
+				stats.bytes[i]);
+		}
+		vty_out(vty, "  %-16s %10lu %12zu\n", "destinations",
+			stats.dests, stats.dests * sizeof(rib_dest_t));
+		vty_out(vty, "  fib nexthop groups: %lu\n", stats.fib_exts);
+		vty_out(vty, "  total: %zu bytes\n", stats.total);
+	}
+}
+
 /*
  * Handler for async dataplane results after a pseudowire installation
  */
@@ -4610,6 +4929,7 @@ static void rib_process_dplane_results(struct event *thread)
 {
 	struct zebra_dplane_ctx *ctx;
 	struct dplane_ctx_list_head ctxlist;
+	struct timeval now;
 	bool shut_p = false;
 
 	/* Dequeue a list of completed updates with one lock/unlock cycle */
@@ -4645,6 +4965,8 @@ static void rib_process_dplane_results(struct event *thread)
 			continue;
 		}
 
+		monotime(&now);
+
 #ifdef HAVE_SCRIPTING
 		char *script_name = frrscript_names_get_script_name(
 			ZEBRA_ON_RIB_PROCESS_HOOK_CALL);
@@ -4670,6 +4992,10 @@ static void rib_process_dplane_results(struct event *thread)
 					       ("ctx", ctx));
 #endif /* HAVE_SCRIPTING */
 
+			flightrec("dplane_result", (uintptr_t)ctx,
+				  dplane_ctx_get_op(ctx),
+				  dplane_ctx_get_status(ctx));
+
 			switch (dplane_ctx_get_op(ctx)) {
 			case DPLANE_OP_ROUTE_INSTALL:
 			case DPLANE_OP_ROUTE_UPDATE:
@@ -4679,8 +5005,11 @@ static void rib_process_dplane_results(struct event *thread)
 				 * we don't want to continue processing these
 				 * in the rib.
 				 */
-				if (dplane_ctx_get_notif_provider(ctx) == 0)
+				if (dplane_ctx_get_notif_provider(ctx) == 0) {
+					dplane_ctx_route_result_account(ctx,
+									&now);
 					rib_process_result(ctx);
+				}
 				break;
 
 			case DPLANE_OP_ROUTE_NOTIFY:
@@ -20,6 +20,7 @@
 #include "stream.h"
 #include "nexthop.h"
 #include "vrf.h"
+#include "jhash.h"
 
 #include "zebra/zebra_router.h"
 #include "zebra/rib.h"
@@ -36,12 +37,32 @@
 #include "zebra/zebra_errors.h"
 
 DEFINE_MTYPE_STATIC(ZEBRA, RNH, "Nexthop tracking object");
+DEFINE_MTYPE_STATIC(ZEBRA, RNH_RCACHE, "Nexthop resolution cache entry");
 
 /* UI controls whether to notify about changes that only involve backup
  * nexthops. Default is to notify all changes.
  */
 static bool rnh_hide_backups;
 
+/*
+ * Optional window, in milliseconds, over which changes to a tracked nexthop
+ * are folded into a single notification to the clients. 0 notifies
+ * immediately.
+ */
+static uint32_t rnh_notify_delay;
+
+DECLARE_DLIST(rnh_pending_list, struct rnh, pending_item);
+
+static struct rnh_pending_list_head rnh_pending = INIT_DLIST(rnh_pending);
+static struct event *t_rnh_notify;
+
+static struct {
+	uint64_t sent;
+	uint64_t deferred;
+	uint64_t coalesced;
+	uint64_t suppressed;
+} rnh_notify_stats;
+
 static void free_state(vrf_id_t vrf_id, struct route_entry *re,
 		       struct route_node *rn);
 static void copy_state(struct rnh *rnh, const struct route_entry *re,
@@ -50,6 +71,7 @@ static bool compare_state(struct route_entry *r1, struct route_entry *r2);
 static void print_rnh(struct route_node *rn, struct vty *vty,
 		      json_object *json);
 static int zebra_client_cleanup_rnh(struct zserv *client);
+static void zebra_rnh_notify_cancel(struct rnh *rnh);
 
 void zebra_rnh_init(void)
 {
@@ -206,6 +228,7 @@ void zebra_free_rnh(struct rnh *rnh)
 	struct route_table *table;
 
 	zebra_rnh_remove_from_routing_table(rnh);
+	zebra_rnh_notify_cancel(rnh);
 	rnh->flags |= ZEBRA_NHT_DELETED;
 	list_delete(&rnh->client_list);
 	list_delete(&rnh->zebra_pseudowire_list);
@@ -457,6 +480,7 @@ static void zebra_rnh_notify_protocol_clients(struct zebra_vrf *zvrf, afi_t afi,
 		}
 
 		zebra_send_rnh_update(rnh, client, zvrf->vrf->vrf_id, 0);
+		rnh_notify_stats.sent++;
 	}
 
 	if (re)
@@ -643,6 +667,84 @@ static void zebra_rnh_process_pseudowires(vrf_id_t vrfid, struct rnh *rnh)
 		zebra_pw_update(pw);
 }
 
+static void zebra_rnh_notify_cancel(struct rnh *rnh)
+{
+	if (!CHECK_FLAG(rnh->flags, ZEBRA_NHT_NOTIFY_PENDING))
+		return;
+
+	UNSET_FLAG(rnh->flags, ZEBRA_NHT_NOTIFY_PENDING);
+	rnh_pending_list_del(&rnh_pending, rnh);
+	free_state(rnh->vrf_id, rnh->notified_state, rnh->node);
+	rnh->notified_state = NULL;
+}
+
+static void zebra_rnh_notify_timer(struct event *event)
+{
+	struct rnh *rnh;
+	struct zebra_vrf *zvrf;
+	struct route_table *table;
+	struct route_node *prn;
+	bool changed;
+	afi_t afi;
+
+	while ((rnh = rnh_pending_list_pop(&rnh_pending))) {
+		UNSET_FLAG(rnh->flags, ZEBRA_NHT_NOTIFY_PENDING);
+
+		/*
+		 * Clients only need to hear about it if the state differs
+		 * from the one they were told about before the window opened,
+		 * a flap within the window goes unnoticed.
+		 */
+		changed = !prefix_same(&rnh->notified_route,
+				       &rnh->resolved_route) ||
+			  compare_state(rnh->state, rnh->notified_state);
+		free_state(rnh->vrf_id, rnh->notified_state, rnh->node);
+		rnh->notified_state = NULL;
+
+		zvrf = zebra_vrf_lookup_by_id(rnh->vrf_id);
+		if (!changed || !zvrf) {
+			rnh_notify_stats.suppressed++;
+			continue;
+		}
+
+		afi = family2afi(rnh->node->p.family);
+		prn = NULL;
+		table = zvrf->table[afi][rnh->safi];
+		if (rnh->state && table) {
+			prn = route_node_lookup(table, &rnh->resolved_route);
+			if (prn)
+				route_unlock_node(prn);
+		}
+
+		zebra_rnh_notify_protocol_clients(zvrf, afi, rnh->node, rnh,
+						  prn, rnh->state);
+		zebra_rnh_process_pseudowires(zvrf->vrf->vrf_id, rnh);
+	}
+}
+
+/*
+ * Called before the state of the rnh gets changed: keep what the clients
+ * currently know and open the notification window if it is not already.
+ */
+static void zebra_rnh_notify_defer(struct rnh *rnh)
+{
+	if (CHECK_FLAG(rnh->flags, ZEBRA_NHT_NOTIFY_PENDING)) {
+		rnh_notify_stats.coalesced++;
+		return;
+	}
+
+	SET_FLAG(rnh->flags, ZEBRA_NHT_NOTIFY_PENDING);
+	rnh->notified_state = rnh->state;
+	rnh->state = NULL;
+	prefix_copy(&rnh->notified_route, &rnh->resolved_route);
+	rnh_pending_list_add_tail(&rnh_pending, rnh);
+	rnh_notify_stats.deferred++;
+
+	if (!t_rnh_notify)
+		event_add_timer_msec(zrouter.master, zebra_rnh_notify_timer,
+				     NULL, rnh_notify_delay, &t_rnh_notify);
+}
+
 /*
  * See if a tracked nexthop entry has undergone any change, and if so,
  * take appropriate action; this involves notifying any clients and/or
@@ -655,6 +757,7 @@ static void zebra_rnh_eval_nexthop_entry(struct zebra_vrf *zvrf, afi_t afi,
 					 struct route_entry *re)
 {
 	int state_changed = 0;
+	bool defer = rnh_notify_delay && !force;
 
 	/* If we're resolving over a different route, resolution has changed or
 	 * the resolving route has some change (e.g., metric), there is a state
@@ -662,6 +765,9 @@ static void zebra_rnh_eval_nexthop_entry(struct zebra_vrf *zvrf, afi_t afi,
 	 */
 	zebra_rnh_remove_from_routing_table(rnh);
 	if (!prefix_same(&rnh->resolved_route, prn ? &prn->p : NULL)) {
+		if (defer)
+			zebra_rnh_notify_defer(rnh);
+
 		if (prn)
 			prefix_copy(&rnh->resolved_route, &prn->p);
 		else {
@@ -678,12 +784,21 @@ static void zebra_rnh_eval_nexthop_entry(struct zebra_vrf *zvrf, afi_t afi,
 		copy_state(rnh, re, nrn);
 		state_changed = 1;
 	} else if (compare_state(re, rnh->state)) {
+		if (defer)
+			zebra_rnh_notify_defer(rnh);
+
 		copy_state(rnh, re, nrn);
 		state_changed = 1;
 	}
 	zebra_rnh_store_in_routing_table(rnh);
 
+	if (defer)
+		return;
+
 	if (state_changed || force) {
+		/* Anything pending is covered by this notification */
+		zebra_rnh_notify_cancel(rnh);
+
 		/* NOTE: Use the "copy" of resolving route stored in 'rnh' i.e.,
 		 * rnh->state.
 		 */
@@ -822,6 +937,7 @@ static void free_state(vrf_id_t vrf_id, struct route_entry *re,
 
 	/* free RE and nexthops */
 	zebra_nhg_free(re->nhe);
+	route_entry_fib_free(re);
 	XFREE(MTYPE_RE, re);
 }
 
@@ -850,10 +966,12 @@ static void copy_state(struct rnh *rnh, const struct route_entry *re,
 	/* Copy the 'fib' nexthops also, if present - we want to capture
 	 * the true installed nexthops.
 	 */
-	if (re->fib_ng.nexthop)
-		nexthop_group_copy(&state->fib_ng, &re->fib_ng);
-	if (re->fib_backup_ng.nexthop)
-		nexthop_group_copy(&state->fib_backup_ng, &re->fib_backup_ng);
+	if (re->fib && re->fib->fib_ng.nexthop)
+		nexthop_group_copy(&route_entry_fib_get(state)->fib_ng,
+				   &re->fib->fib_ng);
+	if (re->fib && re->fib->fib_backup_ng.nexthop)
+		nexthop_group_copy(&route_entry_fib_get(state)->fib_backup_ng,
+				   &re->fib->fib_backup_ng);
 
 	rnh->state = state;
 }
@@ -873,7 +991,8 @@ static struct nexthop *next_valid_primary_nh(struct route_entry *re,
 	/* Fib backup ng present: some backups are installed,
 	 * and we're configured for special handling if there are backups.
 	 */
-	if (rnh_hide_backups && (re->fib_backup_ng.nexthop != NULL))
+	if (rnh_hide_backups && re->fib &&
+	    (re->fib->fib_backup_ng.nexthop != NULL))
 		default_path = false;
 
 	/* Default path: no special handling, just using the 'installed'
@@ -1723,6 +1842,173 @@ int rnh_resolve_via_default(struct zebra_vrf *zvrf, int family)
 		return 0;
 }
 
+/*
+ * Cache of the longest prefix match node for recursive nexthop addresses.
+ * nexthop_active() starts its walk up the table from the cached node rather
+ * than doing a route_node_match() for every route sharing the nexthop. Each
+ * entry hangs off the dest of the node it points to. The match can only
+ * change when that dest goes away or when a more specific dest covering the
+ * address shows up, and both cases drop the entry from the rib_dest_t
+ * lifecycle hooks below. Main pthread only.
+ */
+#define RNH_RCACHE_MAX 65536
+
+PREDECL_HASH(rnh_rcache_hash);
+
+struct rnh_rcache {
+	struct rnh_rcache_hash_item hitem;
+	struct rnh_rcache_list_item litem;
+
+	vrf_id_t vrf_id;
+	struct prefix p;
+
+	struct route_node *rn;
+};
+
+static int rnh_rcache_cmp(const struct rnh_rcache *a,
+			  const struct rnh_rcache *b)
+{
+	if (a->vrf_id != b->vrf_id)
+		return numcmp(a->vrf_id, b->vrf_id);
+
+	return prefix_cmp(&a->p, &b->p);
+}
+
+static uint32_t rnh_rcache_key(const struct rnh_rcache *c)
+{
+	return jhash_1word(c->vrf_id, prefix_hash_key(&c->p));
+}
+
+DECLARE_HASH(rnh_rcache_hash, struct rnh_rcache, hitem, rnh_rcache_cmp,
+	     rnh_rcache_key);
+DECLARE_DLIST(rnh_rcache_list, struct rnh_rcache, litem);
+
+static struct rnh_rcache_hash_head rnh_rcache = INIT_HASH(rnh_rcache);
+
+static struct {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t invalidations;
+	uint64_t full;
+} rnh_rcache_stats;
+
+static void rnh_rcache_free(rib_dest_t *dest, struct rnh_rcache *c)
+{
+	rnh_rcache_list_del(&dest->rcache, c);
+	rnh_rcache_hash_del(&rnh_rcache, c);
+	XFREE(MTYPE_RNH_RCACHE, c);
+	rnh_rcache_stats.invalidations++;
+}
+
+struct route_node *zebra_rnh_rcache_match(struct route_table *table,
+					  vrf_id_t vrf_id,
+					  const struct prefix *p)
+{
+	struct rnh_rcache lookup, *c;
+	struct route_node *rn;
+	rib_dest_t *dest;
+
+	lookup.vrf_id = vrf_id;
+	prefix_copy(&lookup.p, p);
+
+	c = rnh_rcache_hash_find(&rnh_rcache, &lookup);
+	if (c) {
+		rnh_rcache_stats.hits++;
+		return route_lock_node(c->rn);
+	}
+
+	rnh_rcache_stats.misses++;
+
+	rn = route_node_match(table, p);
+	if (!rn)
+		return NULL;
+
+	dest = rib_dest_from_rnode(rn);
+	if (!dest)
+		return rn;
+
+	if (rnh_rcache_hash_count(&rnh_rcache) >= RNH_RCACHE_MAX) {
+		rnh_rcache_stats.full++;
+		return rn;
+	}
+
+	c = XCALLOC(MTYPE_RNH_RCACHE, sizeof(*c));
+	c->vrf_id = vrf_id;
+	prefix_copy(&c->p, p);
+	c->rn = rn;
+	rnh_rcache_hash_add(&rnh_rcache, c);
+	rnh_rcache_list_add_tail(&dest->rcache, c);
+
+	return rn;
+}
+
+void zebra_rnh_rcache_dest_add(struct route_node *rn)
+{
+	rib_dest_t *dest = rib_dest_from_rnode(rn);
+	struct route_node *parent;
+	rib_dest_t *pdest;
+	struct rnh_rcache *c;
+
+	rnh_rcache_list_init(&dest->rcache);
+
+	if (!rnh_rcache_hash_count(&rnh_rcache))
+		return;
+
+	/*
+	 * Addresses covered by the new prefix matched the closest ancestor
+	 * that has a dest until now, they have to be looked up again.
+	 */
+	for (parent = rn->parent; parent; parent = parent->parent)
+		if (parent->info)
+			break;
+	if (!parent)
+		return;
+
+	pdest = rib_dest_from_rnode(parent);
+	frr_each_safe (rnh_rcache_list, &pdest->rcache, c)
+		if (prefix_match(&rn->p, &c->p))
+			rnh_rcache_free(pdest, c);
+}
+
+void zebra_rnh_rcache_dest_del(struct route_node *rn)
+{
+	rib_dest_t *dest = rib_dest_from_rnode(rn);
+	struct rnh_rcache *c;
+
+	frr_each_safe (rnh_rcache_list, &dest->rcache, c)
+		rnh_rcache_free(dest, c);
+
+	rnh_rcache_list_fini(&dest->rcache);
+}
+
+void zebra_rnh_rcache_show(struct vty *vty, json_object *json)
+{
+	uint64_t lookups = rnh_rcache_stats.hits + rnh_rcache_stats.misses;
+
+	if (json) {
+		json_object_int_add(json, "entries",
+				    rnh_rcache_hash_count(&rnh_rcache));
+		json_object_int_add(json, "maxEntries", RNH_RCACHE_MAX);
+		json_object_int_add(json, "hits", rnh_rcache_stats.hits);
+		json_object_int_add(json, "misses", rnh_rcache_stats.misses);
+		json_object_int_add(json, "invalidations",
+				    rnh_rcache_stats.invalidations);
+		json_object_int_add(json, "full", rnh_rcache_stats.full);
+		return;
+	}
+
+	vty_out(vty, "Nexthop resolution cache:\n");
+	vty_out(vty, "  Entries:       %zu (max %u)\n",
+		rnh_rcache_hash_count(&rnh_rcache), RNH_RCACHE_MAX);
+	vty_out(vty, "  Hits:          %" PRIu64 " (%" PRIu64 "%%)\n",
+		rnh_rcache_stats.hits,
+		lookups ? rnh_rcache_stats.hits * 100 / lookups : 0);
+	vty_out(vty, "  Misses:        %" PRIu64 "\n", rnh_rcache_stats.misses);
+	vty_out(vty, "  Invalidations: %" PRIu64 "\n",
+		rnh_rcache_stats.invalidations);
+	vty_out(vty, "  Cache full:    %" PRIu64 "\n", rnh_rcache_stats.full);
+}
+
 /*
  * UI control to avoid notifications if backup nexthop status changes
  */
@@ -1731,6 +2017,51 @@ void rnh_set_hide_backups(bool hide_p)
 	rnh_hide_backups = hide_p;
 }
 
+void rnh_set_notify_delay(uint32_t msec)
+{
+	rnh_notify_delay = msec;
+
+	/* Flush anything pending when the window is turned off */
+	if (!msec && t_rnh_notify) {
+		EVENT_OFF(t_rnh_notify);
+		zebra_rnh_notify_timer(NULL);
+	}
+}
+
+uint32_t rnh_get_notify_delay(void)
+{
+	return rnh_notify_delay;
+}
+
+void zebra_rnh_notify_show(struct vty *vty, json_object *json)
+{
+	if (json) {
+		json_object_int_add(json, "notifyDelayMsec", rnh_notify_delay);
+		json_object_int_add(json, "pending",
+				    rnh_pending_list_count(&rnh_pending));
+		json_object_int_add(json, "sent", rnh_notify_stats.sent);
+		json_object_int_add(json, "deferred",
+				    rnh_notify_stats.deferred);
+		json_object_int_add(json, "coalesced",
+				    rnh_notify_stats.coalesced);
+		json_object_int_add(json, "suppressed",
+				    rnh_notify_stats.suppressed);
+		return;
+	}
+
+	vty_out(vty, "Nexthop tracking notifications:\n");
+	vty_out(vty, "  Notify delay: %u msec\n", rnh_notify_delay);
+	vty_out(vty, "  Pending:      %zu\n",
+		rnh_pending_list_count(&rnh_pending));
+	vty_out(vty, "  Sent:         %" PRIu64 "\n", rnh_notify_stats.sent);
+	vty_out(vty, "  Deferred:     %" PRIu64 "\n",
+		rnh_notify_stats.deferred);
+	vty_out(vty, "  Coalesced:    %" PRIu64 "\n",
+		rnh_notify_stats.coalesced);
+	vty_out(vty, "  Suppressed:   %" PRIu64 "\n",
+		rnh_notify_stats.suppressed);
+}
+
 bool rnh_get_hide_backups(void)
 {
 	return rnh_hide_backups;
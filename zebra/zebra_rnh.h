@@ -36,6 +36,18 @@ extern void zebra_print_rnh_table(vrf_id_t vrfid, afi_t afi, safi_t safi,
 
 extern int rnh_resolve_via_default(struct zebra_vrf *zvrf, int family);
 
+/*
+ * Longest prefix match for a recursive nexthop, served from the resolution
+ * cache when possible. Returns a locked node, like route_node_match().
+ */
+extern struct route_node *zebra_rnh_rcache_match(struct route_table *table,
+						 vrf_id_t vrf_id,
+						 const struct prefix *p);
+/* called when a rib dest is attached to/removed from a route node */
+extern void zebra_rnh_rcache_dest_add(struct route_node *rn);
+extern void zebra_rnh_rcache_dest_del(struct route_node *rn);
+extern void zebra_rnh_rcache_show(struct vty *vty, json_object *json);
+
 extern bool rnh_nexthop_valid(const struct route_entry *re,
 			      const struct nexthop *nh);
 
@@ -43,6 +55,11 @@ extern bool rnh_nexthop_valid(const struct route_entry *re,
 void rnh_set_hide_backups(bool hide_p);
 bool rnh_get_hide_backups(void);
 
+/* Coalesce nexthop change notifications over msec milliseconds, 0 disables */
+void rnh_set_notify_delay(uint32_t msec);
+uint32_t rnh_get_notify_delay(void);
+extern void zebra_rnh_notify_show(struct vty *vty, json_object *json);
+
 void show_nexthop_json_helper(json_object *json_nexthop,
 			      const struct nexthop *nexthop,
 			      const struct route_entry *re);
@@ -7,6 +7,7 @@
 
 #include <pthread.h>
 #include "lib/frratomic.h"
+#include "lib/metrics.h"
 
 #include "zebra_router.h"
 #include "zebra_pbr.h"
@@ -17,6 +18,8 @@
 #include "zebra/zebra_tc.h"
 #include "debug.h"
 #include "zebra_script.h"
+#include "zebra/zebra_dplane.h"
+#include "zebra/zserv.h"
 
 DEFINE_MTYPE_STATIC(ZEBRA, RIB_TABLE_INFO, "RIB table info");
 DEFINE_MTYPE_STATIC(ZEBRA, ZEBRA_RT_TABLE, "Zebra VRF table");
@@ -121,6 +124,8 @@ struct route_table *zebra_router_get_table(struct zebra_vrf *zvrf,
 	info->afi = afi;
 	info->safi = safi;
 	info->table_id = tableid;
+	for (int i = 0; i < ZEBRA_ROUTE_MAX; i++)
+		re_type_list_init(&info->re_types[i]);
 	route_table_set_info(zrt->table, info);
 	zrt->table->cleanup = zebra_rtable_node_cleanup;
 
@@ -165,12 +170,15 @@ void zebra_router_sweep_nhgs(void)
 
 static void zebra_router_free_table(struct zebra_router_table *zrt)
 {
-	void *table_info;
+	struct rib_table_info *table_info;
 
 	table_info = route_table_get_info(zrt->table);
 	route_table_finish(zrt->table);
 	RB_REMOVE(zebra_router_table_head, &zrouter.tables, zrt);
 
+	for (int i = 0; i < ZEBRA_ROUTE_MAX; i++)
+		re_type_list_fini(&table_info->re_types[i]);
+
 	XFREE(MTYPE_RIB_TABLE_INFO, table_info);
 	XFREE(MTYPE_ZEBRA_RT_TABLE, zrt);
 }
@@ -214,10 +222,45 @@ enum multicast_mode multicast_mode_ipv4_get(void)
 	return zrouter.ipv4_multicast_mode;
 }
 
+/* how often the queue depths are rendered for the metrics exporter */
+#define ZEBRA_METRICS_INTERVAL_MS 1000
+
+static struct metrics_collector *zebra_metrics;
+
+static void zebra_metrics_collect(struct metrics_out *out, void *arg)
+{
+	struct listnode *node;
+	struct zserv *client;
+	char instance[16];
+
+	metrics_family(out, "frr_zebra_rib_queue_depth", METRICS_GAUGE,
+		       "Route nodes waiting on the RIB meta queue");
+	metrics_sample(out, "frr_zebra_rib_queue_depth",
+		       zrouter.mq ? zrouter.mq->size : 0, NULL);
+
+	metrics_family(out, "frr_zebra_dplane_queue_depth", METRICS_GAUGE,
+		       "Contexts waiting for the dataplane pthread");
+	metrics_sample(out, "frr_zebra_dplane_queue_depth",
+		       dplane_get_in_queue_len(), NULL);
+
+	metrics_family(out, "frr_zebra_client_inq_depth", METRICS_GAUGE,
+		       "Messages read from a client, not processed yet");
+	for (ALL_LIST_ELEMENTS_RO(zrouter.client_list, node, client)) {
+		snprintf(instance, sizeof(instance), "%u", client->instance);
+		metrics_sample(out, "frr_zebra_client_inq_depth",
+			       stream_fifo_count_safe(client->ibuf_fifo),
+			       "client", zebra_route_string(client->proto),
+			       "instance", instance, NULL);
+	}
+}
+
 void zebra_router_terminate(void)
 {
 	struct zebra_router_table *zrt, *tmp;
 
+	metrics_collector_del(zebra_metrics);
+	zebra_metrics = NULL;
+
 	EVENT_OFF(zrouter.sweeper);
 
 	RB_FOREACH_SAFE (zrt, zebra_router_table_head, &zrouter.tables, tmp)
@@ -286,8 +329,9 @@ void zebra_router_init(bool asic_offload, bool notify_on_ack)
 						"IPtable Hash Entry");
 
 	zrouter.nhgs =
-		hash_create_size(8, zebra_nhg_hash_key, zebra_nhg_hash_equal,
-				 "Zebra Router Nexthop Groups");
+		hash_create_flags(8, zebra_nhg_hash_key, zebra_nhg_hash_equal,
+				  "Zebra Router Nexthop Groups",
+				  HASH_OPEN_ADDRESSING);
 	zrouter.nhgs_id =
 		hash_create_size(8, zebra_nhg_id_key, zebra_nhg_hash_id_equal,
 				 "Zebra Router Nexthop Groups ID index");
@@ -324,6 +368,10 @@ void zebra_router_init(bool asic_offload, bool notify_on_ack)
 	zebra_script_init();
 #endif
 
+	zebra_metrics = metrics_snapshot_add("zebra", zrouter.master,
+					     ZEBRA_METRICS_INTERVAL_MS,
+					     zebra_metrics_collect, NULL);
+
 	/* OS-specific init */
 	kernel_router_init();
 }
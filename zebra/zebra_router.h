@@ -121,6 +121,20 @@ struct zebra_mlag_info {
 	struct event *t_read;
 	/* Event for MLAG write */
 	struct event *t_write;
+
+	/*
+	 * Transmit statistics, updated by the MLAG pthread: client messages
+	 * and mroutes taken from mlag_fifo, client messages merged into the
+	 * bulk before them, encoded messages, system calls and bytes written,
+	 * and messages that failed to encode.
+	 */
+	_Atomic uint64_t stat_rx_msgs;
+	_Atomic uint64_t stat_mroutes;
+	_Atomic uint64_t stat_coalesced;
+	_Atomic uint64_t stat_tx_msgs;
+	_Atomic uint64_t stat_writes;
+	_Atomic uint64_t stat_tx_bytes;
+	_Atomic uint64_t stat_errors;
 };
 
 struct zebra_router {
@@ -171,6 +185,9 @@ struct zebra_router {
 	/* Meta Queue Information */
 	struct meta_queue *mq;
 
+	/* serve route nodes of each VRF round robin */
+	bool mq_per_vrf;
+
 	/* LSP work queue */
 	struct work_queue *lsp_process_q;
 
@@ -196,6 +213,29 @@ struct zebra_router {
 	time_t startup_time;
 	struct event *sweeper;
 
+	/*
+	 * Read the kernel routing tables in chunks from the event loop at
+	 * startup instead of before serving any client. The sweep waits
+	 * for all pending reads.
+	 */
+	bool kernel_read_stream;
+	uint32_t kernel_reads_pending;
+	uint64_t kernel_read_routes;
+	int64_t kernel_read_usec;
+	bool sweep_deferred;
+
+	/*
+	 * Interface events from the kernel, and the state updates they
+	 * caused to clients, for "show interface events".
+	 */
+	struct {
+		uint64_t link_events;
+		uint64_t addr_events;
+		uint64_t state_updates;
+		uint64_t bulk_msgs;
+		uint16_t bulk_max;
+	} if_stats;
+
 	/*
 	 * The hash of nexthop groups associated with this router
 	 */
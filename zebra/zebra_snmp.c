@@ -280,6 +280,103 @@ static void check_replace(struct route_node *np2, struct route_entry *re2,
 	return;
 }
 
+/*
+ * ipForwardTable index: ipForwardDest, ipForwardProto, ipForwardPolicy and
+ * ipForwardNextHop.  Rows are ordered by address only, which the route
+ * table can't find the next one by, so GETNEXT is answered from a snapshot
+ * of the index instead of walking the whole table for every request.
+ */
+#define IPFW_INDEX_LEN 10
+
+static struct smux_index_cache *ipfw_cache;
+
+static void ipfw_cache_fill(struct smux_index_cache *cache, void *arg)
+{
+	struct route_table *table = arg;
+	struct route_node *np;
+	struct route_entry *re;
+	struct prefix_ipv4 p = { .family = AF_INET };
+	uint8_t index[IPFW_INDEX_LEN];
+
+	for (np = route_top(table); np; np = route_next(np)) {
+		RNODE_FOREACH_RE (np, re) {
+			struct nexthop *nexthop = re->nhe->nhg.nexthop;
+
+			if (!nexthop)
+				continue;
+
+			memcpy(index, &np->p.u.prefix4, 4);
+			index[4] = proto_trans(re->type);
+			index[5] = 0;
+			memcpy(index + 6, &nexthop->gate.ipv4, 4);
+
+			p.prefix = np->p.u.prefix4;
+			p.prefixlen = np->p.prefixlen;
+			smux_index_cache_add(cache, index, &p);
+		}
+	}
+}
+
+static void get_fwtable_route_node_cached(struct variable *v, oid objid[],
+					  size_t *objid_len, int exact,
+					  struct route_table *table,
+					  struct route_node **np,
+					  struct route_entry **re)
+{
+	oid key[IPFW_INDEX_LEN], index[IPFW_INDEX_LEN];
+	const oid *kp = objid + v->namelen;
+	size_t len = *objid_len - v->namelen;
+	const struct prefix_ipv4 *p;
+	uint8_t nexthop[4];
+	int i;
+
+	if (!ipfw_cache)
+		ipfw_cache = smux_index_cache_new(IPFW_INDEX_LEN,
+						  sizeof(struct prefix_ipv4),
+						  ipfw_cache_fill);
+
+	while ((p = smux_index_cache_lookup(ipfw_cache, kp, len, exact, index,
+					    table))) {
+		struct route_node *rn;
+		struct route_entry *re2;
+
+		for (i = 0; i < 4; i++)
+			nexthop[i] = index[6 + i];
+
+		/* the snapshot may be older than the table */
+		rn = route_node_lookup(table, (const struct prefix *)p);
+		if (rn) {
+			route_unlock_node(rn);
+			RNODE_FOREACH_RE (rn, re2) {
+				struct nexthop *nh = re2->nhe->nhg.nexthop;
+
+				if (nh
+				    && proto_trans(re2->type) == (int)index[4]
+				    && !memcmp(&nh->gate.ipv4, nexthop, 4)) {
+					*np = rn;
+					*re = re2;
+					break;
+				}
+			}
+		}
+		if (*re || exact)
+			break;
+
+		memcpy(key, index, sizeof(key));
+		kp = key;
+		len = IPFW_INDEX_LEN;
+	}
+
+	if (!*re) {
+		*np = NULL;
+		return;
+	}
+
+	*objid_len = v->namelen + IPFW_INDEX_LEN;
+	for (i = 0; i < IPFW_INDEX_LEN; i++)
+		objid[v->namelen + i] = index[i];
+}
+
 static void get_fwtable_route_node(struct variable *v, oid objid[],
 				   size_t *objid_len, int exact,
 				   struct route_node **np,
@@ -322,6 +419,12 @@ static void get_fwtable_route_node(struct variable *v, oid objid[],
 	if (!table)
 		return;
 
+	if (smux_index_cache_enabled()) {
+		get_fwtable_route_node_cached(v, objid, objid_len, exact, table,
+					      np, re);
+		return;
+	}
+
 	/* Get INDEX information out of OID.
 	 * ipForwardDest, ipForwardProto, ipForwardPolicy, ipForwardNextHop
 	 */
@@ -543,9 +646,16 @@ static int zebra_snmp_init(struct event_loop *tm)
 	return 0;
 }
 
+static int zebra_snmp_fini(void)
+{
+	smux_index_cache_free(&ipfw_cache);
+	return 0;
+}
+
 static int zebra_snmp_module_init(void)
 {
 	hook_register(frr_late_init, zebra_snmp_init);
+	hook_register(frr_fini, zebra_snmp_fini);
 	return 0;
 }
 
@@ -87,35 +87,14 @@ bool zebra_tc_qdisc_hash_equal(const void *arg1, const void *arg2)
 	return true;
 }
 
-struct tc_qdisc_ifindex_lookup {
-	struct zebra_tc_qdisc *qdisc;
-	ifindex_t ifindex;
-};
-
-
-static int tc_qdisc_lookup_ifindex_walker(struct hash_bucket *b, void *data)
-{
-	struct tc_qdisc_ifindex_lookup *lookup = data;
-	struct zebra_tc_qdisc *qdisc = b->data;
-
-	if (lookup->ifindex == qdisc->qdisc.ifindex) {
-		lookup->qdisc = qdisc;
-		return HASHWALK_ABORT;
-	}
-
-	return HASHWALK_CONTINUE;
-}
-
-static struct zebra_tc_qdisc *
-tc_qdisc_lookup_ifindex(struct zebra_tc_qdisc *qdisc)
+/*
+ * Whether an update changes anything that is programmed.  zapi_msg.c zeroes
+ * the structs before decoding into them, so comparing them whole is fine.
+ */
+static bool tc_qdisc_same(const struct zebra_tc_qdisc *a,
+			  const struct zebra_tc_qdisc *b)
 {
-	struct tc_qdisc_ifindex_lookup lookup;
-
-	lookup.ifindex = qdisc->qdisc.ifindex;
-	lookup.qdisc = NULL;
-	hash_walk(zrouter.rules_hash, &tc_qdisc_lookup_ifindex_walker, &lookup);
-
-	return lookup.qdisc;
+	return !memcmp(&a->qdisc, &b->qdisc, sizeof(a->qdisc));
 }
 
 static void *tc_qdisc_alloc_intern(void *arg)
@@ -169,10 +148,14 @@ void zebra_tc_qdisc_install(struct zebra_tc_qdisc *qdisc)
 	struct zebra_tc_qdisc *old;
 	struct zebra_tc_qdisc *new;
 
-	found = tc_qdisc_lookup_ifindex(qdisc);
+	found = hash_lookup(zrouter.qdisc_hash, qdisc);
 
 	if (found) {
-		if (!zebra_tc_qdisc_hash_equal(qdisc, found)) {
+		if (tc_qdisc_same(qdisc, found)) {
+			if (IS_ZEBRA_DEBUG_TC)
+				zlog_debug("%s: tc qdisc ifindex %d unchanged",
+					   __func__, qdisc->qdisc.ifindex);
+		} else {
 			old = tc_qdisc_release(found, false);
 			(void)dplane_tc_qdisc_uninstall(old);
 			new = hash_get(zrouter.qdisc_hash, qdisc,
@@ -229,6 +212,12 @@ bool zebra_tc_class_hash_equal(const void *arg1, const void *arg2)
 	return true;
 }
 
+static bool tc_class_same(const struct zebra_tc_class *a,
+			  const struct zebra_tc_class *b)
+{
+	return !memcmp(&a->class, &b->class, sizeof(a->class));
+}
+
 static void *tc_class_alloc_intern(void *arg)
 {
 	struct zebra_tc_class *class;
@@ -285,17 +274,24 @@ void zebra_tc_class_add(struct zebra_tc_class *class)
 	/*
 	 * We find the class in the hash by (ifindex, handle) directly, and by
 	 * testing their deep equality to seek out whether it's an update.
-	 *
-	 * Currently deep equality is not checked since it will be okay to
-	 * update the totally same class again.
+	 * Resending the same class would be harmless, but clients replay
+	 * their whole configuration and that adds up.
 	 */
 	found = hash_lookup(zrouter.class_hash, class);
-	new = hash_get(zrouter.class_hash, class, tc_class_alloc_intern);
 
-	if (found)
-		(void)dplane_tc_class_update(new);
-	else
+	if (found) {
+		if (tc_class_same(class, found)) {
+			if (IS_ZEBRA_DEBUG_TC)
+				zlog_debug("%s: tc class unchanged", __func__);
+			return;
+		}
+		*found = *class;
+		(void)dplane_tc_class_update(found);
+	} else {
+		new = hash_get(zrouter.class_hash, class,
+			       tc_class_alloc_intern);
 		(void)dplane_tc_class_add(new);
+	}
 }
 
 void zebra_tc_class_delete(struct zebra_tc_class *class)
@@ -379,6 +375,12 @@ static struct zebra_tc_filter *tc_filter_release(struct zebra_tc_filter *filter,
 	return tc_filter_free(lookup, free_data);
 }
 
+static bool tc_filter_same(const struct zebra_tc_filter *a,
+			   const struct zebra_tc_filter *b)
+{
+	return !memcmp(&a->filter, &b->filter, sizeof(a->filter));
+}
+
 static void *tc_filter_alloc_intern(void *arg)
 {
 	struct zebra_tc_filter *ztf;
@@ -405,13 +407,22 @@ void zebra_tc_filter_add(struct zebra_tc_filter *filter)
 	struct zebra_tc_filter *found;
 	struct zebra_tc_filter *new;
 
+	/* an update is a delete and add in the kernel, skip it if we can */
 	found = hash_lookup(zrouter.filter_hash, filter);
-	new = hash_get(zrouter.filter_hash, filter, tc_filter_alloc_intern);
 
-	if (found)
-		(void)dplane_tc_filter_update(new);
-	else
+	if (found) {
+		if (tc_filter_same(filter, found)) {
+			if (IS_ZEBRA_DEBUG_TC)
+				zlog_debug("%s: tc filter unchanged", __func__);
+			return;
+		}
+		*found = *filter;
+		(void)dplane_tc_filter_update(found);
+	} else {
+		new = hash_get(zrouter.filter_hash, filter,
+			       tc_filter_alloc_intern);
 		(void)dplane_tc_filter_add(new);
+	}
 }
 
 void zebra_tc_filter_delete(struct zebra_tc_filter *filter)
@@ -97,6 +97,9 @@ struct zebra_vrf {
 	/* MPLS label forwarding table */
 	struct hash *lsp_table;
 
+	/* Direct in-label index of lsp_table */
+	struct zebra_lsp_index *lsp_index;
+
 	/* MPLS FEC binding table */
 	struct route_table *fec_table[AFI_MAX];
 
@@ -161,6 +164,11 @@ struct zebra_vrf {
 	uint64_t lsp_installs;
 	uint64_t lsp_removals;
 
+	/* Route nodes of this VRF queued for processing */
+	struct list *mq_subq[MQ_SIZE];
+	uint32_t mq_queued;
+	uint64_t mq_processed;
+
 	struct table_manager *tbl_mgr;
 
 	struct rtadv rtadv;
@@ -50,6 +50,7 @@
 #include "zebra/zebra_script.h"
 #include "zebra/rtadv.h"
 #include "zebra/zebra_neigh.h"
+#include "zebra/zebra_restart.h"
 
 /* context to manage dumps in multiple tables or vrfs */
 struct route_show_ctx {
@@ -1615,6 +1616,94 @@ DEFPY(show_nexthop_group,
 	return CMD_SUCCESS;
 }
 
+DEFPY (show_nexthop_group_statistics,
+       show_nexthop_group_statistics_cmd,
+       "show nexthop-group rib statistics [json$uj]",
+       SHOW_STR
+       "Show Nexthop Groups\n"
+       "RIB information\n"
+       "Nexthop group hash statistics\n"
+       JSON_STR)
+{
+	json_object *json = NULL;
+
+	if (uj)
+		json = json_object_new_object();
+
+	zebra_nhg_hash_stats_show(vty, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_nht_resolution_cache,
+       show_nht_resolution_cache_cmd,
+       "show zebra nht resolution-cache [json$uj]",
+       SHOW_STR
+       ZEBRA_STR
+       "Nexthop tracking\n"
+       "Recursive nexthop resolution cache\n"
+       JSON_STR)
+{
+	json_object *json = NULL;
+
+	if (uj)
+		json = json_object_new_object();
+
+	zebra_rnh_rcache_show(vty, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_nht_notifications,
+       show_nht_notifications_cmd,
+       "show zebra nht notifications [json$uj]",
+       SHOW_STR
+       ZEBRA_STR
+       "Nexthop tracking\n"
+       "Notifications sent to clients\n"
+       JSON_STR)
+{
+	json_object *json = NULL;
+
+	if (uj)
+		json = json_object_new_object();
+
+	zebra_rnh_notify_show(vty, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_zebra_memory_vrf,
+       show_zebra_memory_vrf_cmd,
+       "show zebra memory vrf [json$uj]",
+       SHOW_STR
+       ZEBRA_STR
+       "Memory statistics\n"
+       "RIB memory per VRF and route type\n"
+       JSON_STR)
+{
+	json_object *json = NULL;
+
+	if (uj)
+		json = json_object_new_object();
+
+	zebra_rib_memory_show(vty, json);
+
+	if (uj)
+		vty_json(vty, json);
+
+	return CMD_SUCCESS;
+}
+
 DEFPY_HIDDEN(nexthop_group_use_enable,
 	     nexthop_group_use_enable_cmd,
 	     "[no] zebra nexthop kernel enable",
@@ -1724,6 +1813,19 @@ DEFPY_HIDDEN(rnh_hide_backups, rnh_hide_backups_cmd,
 	return CMD_SUCCESS;
 }
 
+DEFPY (rnh_notify_delay,
+       rnh_notify_delay_cmd,
+       "[no] ip nht notify-delay ![(1-10000)$delay]",
+       NO_STR
+       IP_STR
+       "Nexthop-tracking configuration\n"
+       "Coalesce nexthop change notifications to clients\n"
+       "Window in milliseconds\n")
+{
+	rnh_set_notify_delay(no ? 0 : delay);
+	return CMD_SUCCESS;
+}
+
 DEFPY (show_route,
        show_route_cmd,
        "show\
@@ -3893,6 +3995,20 @@ DEFUN_HIDDEN (no_zebra_workqueue_timer,
 	return CMD_SUCCESS;
 }
 
+DEFPY (zebra_rib_queue_per_vrf,
+       zebra_rib_queue_per_vrf_cmd,
+       "[no] zebra rib-queue per-vrf",
+       NO_STR
+       ZEBRA_STR
+       "Route node processing queue\n"
+       "Serve the queued route nodes of each VRF in turn\n")
+{
+	/* nodes already queued are processed in the mode they were queued in */
+	zrouter.mq_per_vrf = !no;
+
+	return CMD_SUCCESS;
+}
+
 DEFUN (no_ip_zebra_import_table,
        no_ip_zebra_import_table_cmd,
        "no ip import-table (1-252) [distance (1-255)] [route-map NAME]",
@@ -3955,6 +4071,9 @@ static int config_write_protocol(struct vty *vty)
 	if (zrouter.ribq->spec.hold != ZEBRA_RIB_PROCESS_HOLD_TIME)
 		vty_out(vty, "zebra work-queue %u\n", zrouter.ribq->spec.hold);
 
+	if (zrouter.mq_per_vrf)
+		vty_out(vty, "zebra rib-queue per-vrf\n");
+
 	if (zrouter.packets_to_process != ZEBRA_ZAPI_PACKETS_TO_PROCESS)
 		vty_out(vty, "zebra zapi-packets %u\n",
 			zrouter.packets_to_process);
@@ -3998,6 +4117,9 @@ static int config_write_protocol(struct vty *vty)
 	if (rnh_get_hide_backups())
 		vty_out(vty, "ip nht hide-backup-events\n");
 
+	if (rnh_get_notify_delay())
+		vty_out(vty, "ip nht notify-delay %u\n", rnh_get_notify_delay());
+
 #ifdef HAVE_NETLINK
 	/* Include netlink info */
 	netlink_config_write_helper(vty);
@@ -4078,6 +4200,25 @@ DEFUN (show_zebra,
 	ttable_add_row(table, "v6 Default MC Forwarding|%s",
 		       zrouter.default_mc_forwardingv6 ? "On" : "Off");
 
+	ttable_add_row(table, "RIB queue|%s, %u queued",
+		       zrouter.mq_per_vrf ? "Per VRF" : "Shared",
+		       zrouter.mq->size);
+
+	if (zrouter.kernel_reads_pending)
+		ttable_add_row(table,
+			       "Kernel route read|In progress, %" PRIu64
+			       " routes",
+			       zrouter.kernel_read_routes);
+	else if (zrouter.kernel_read_stream)
+		ttable_add_row(table,
+			       "Kernel route read|Done, %" PRIu64
+			       " routes in %" PRId64 " ms%s",
+			       zrouter.kernel_read_routes,
+			       zrouter.kernel_read_usec / 1000,
+			       zrouter.sweep_deferred ? ", sweep pending" : "");
+
+	zebra_restart_show(table);
+
 	out = ttable_dump(table, "\n");
 	vty_out(vty, "%s\n", out);
 	XFREE(MTYPE_TMP, out);
@@ -4097,6 +4238,19 @@ DEFUN (show_zebra,
 			zvrf->lsp_removals);
 	}
 
+	vty_out(vty, "\n");
+	vty_out(vty,
+		"                            RIB queue  RIB nodes\n");
+	vty_out(vty,
+		"VRF                         Depth      Processed\n");
+
+	RB_FOREACH (vrf, vrf_name_head, &vrfs_by_name) {
+		struct zebra_vrf *zvrf = vrf->info;
+
+		vty_out(vty, "%-25s %10u %10" PRIu64 "\n", vrf->name,
+			zvrf->mq_queued, zvrf->mq_processed);
+	}
+
 	return CMD_SUCCESS;
 }
 
@@ -4267,6 +4421,31 @@ DEFUN (show_dataplane_providers,
 	return dplane_show_provs_helper(vty, detailed);
 }
 
+/* Display route update pipeline latencies */
+DEFPY (show_dataplane_pipeline,
+       show_dataplane_pipeline_cmd,
+       "show zebra dplane pipeline [json$uj]",
+       SHOW_STR
+       ZEBRA_STR
+       "Zebra dataplane information\n"
+       "Route update pipeline statistics\n"
+       JSON_STR)
+{
+	return dplane_show_pipeline_helper(vty, !!uj);
+}
+
+DEFPY (clear_dataplane_pipeline,
+       clear_dataplane_pipeline_cmd,
+       "clear zebra dplane pipeline",
+       CLEAR_STR
+       ZEBRA_STR
+       "Zebra dataplane information\n"
+       "Route update pipeline statistics\n")
+{
+	dplane_pipeline_clear();
+	return CMD_SUCCESS;
+}
+
 /* Configure dataplane incoming queue limit */
 DEFUN (zebra_dplane_queue_limit,
        zebra_dplane_queue_limit_cmd,
@@ -4300,6 +4479,32 @@ DEFUN (no_zebra_dplane_queue_limit,
 	return CMD_SUCCESS;
 }
 
+DEFPY (zebra_dplane_provider_limit,
+       zebra_dplane_provider_limit_cmd,
+       "[no] zebra dplane provider WORD$name <work-limit$work (1-10000)$wlimit|queue-limit (1-1000000)$qlimit>",
+       NO_STR
+       ZEBRA_STR
+       "Zebra dataplane\n"
+       "Dataplane provider\n"
+       "Provider name\n"
+       "Limit updates handled per cycle\n"
+       "Number of updates\n"
+       "Stop taking new work while the provider has this many updates queued\n"
+       "Number of queued updates\n")
+{
+	uint32_t limit = 0;
+
+	if (!no)
+		limit = work ? wlimit : qlimit;
+
+	if (dplane_provider_set_limits(name, !!work, limit) < 0) {
+		vty_out(vty, "%% Unknown dataplane provider %s\n", name);
+		return CMD_WARNING_CONFIG_FAILED;
+	}
+
+	return CMD_SUCCESS;
+}
+
 DEFUN (zebra_show_routing_tables_summary,
        zebra_show_routing_tables_summary_cmd,
        "show zebra router table summary",
@@ -4430,6 +4635,22 @@ DEFUN_HIDDEN(no_zebra_kernel_netlink_batch_tx_buf,
 	return CMD_SUCCESS;
 }
 
+DEFPY (zebra_kernel_netlink_batch_adaptive,
+       zebra_kernel_netlink_batch_adaptive_cmd,
+       "[no] zebra kernel netlink batch-adaptive [latency (100-1000000)$usec]",
+       NO_STR
+       ZEBRA_STR
+       "Zebra kernel interface\n"
+       "Set Netlink parameters\n"
+       "Size batches from the kernel acknowledgement latency\n"
+       "Target latency per batch\n"
+       "Microseconds\n")
+{
+	netlink_set_batch_adaptive(usec, !no);
+
+	return CMD_SUCCESS;
+}
+
 DEFPY (zebra_protodown_bit,
        zebra_protodown_bit_cmd,
        "zebra protodown reason-bit (0-31)$bit",
@@ -4572,6 +4793,7 @@ void zebra_vty_init(void)
 	install_element(CONFIG_NODE, &no_ip_zebra_import_table_cmd);
 	install_element(CONFIG_NODE, &zebra_workqueue_timer_cmd);
 	install_element(CONFIG_NODE, &no_zebra_workqueue_timer_cmd);
+	install_element(CONFIG_NODE, &zebra_rib_queue_per_vrf_cmd);
 	install_element(CONFIG_NODE, &zebra_packet_process_cmd);
 	install_element(CONFIG_NODE, &no_zebra_packet_process_cmd);
 	install_element(CONFIG_NODE, &nexthop_group_use_enable_cmd);
@@ -4579,6 +4801,10 @@ void zebra_vty_init(void)
 	install_element(CONFIG_NODE, &backup_nexthop_recursive_use_enable_cmd);
 
 	install_element(VIEW_NODE, &show_nexthop_group_cmd);
+	install_element(VIEW_NODE, &show_nexthop_group_statistics_cmd);
+	install_element(VIEW_NODE, &show_nht_resolution_cache_cmd);
+	install_element(VIEW_NODE, &show_nht_notifications_cmd);
+	install_element(VIEW_NODE, &show_zebra_memory_vrf_cmd);
 	install_element(VIEW_NODE, &show_interface_nexthop_group_cmd);
 
 	install_element(VIEW_NODE, &show_vrf_cmd);
@@ -4602,6 +4828,7 @@ void zebra_vty_init(void)
 	install_element(VRF_NODE, &ipv6_nht_default_route_cmd);
 	install_element(VRF_NODE, &no_ipv6_nht_default_route_cmd);
 	install_element(CONFIG_NODE, &rnh_hide_backups_cmd);
+	install_element(CONFIG_NODE, &rnh_notify_delay_cmd);
 
 	install_element(VIEW_NODE, &show_frr_cmd);
 	install_element(VIEW_NODE, &show_evpn_global_cmd);
@@ -4659,8 +4886,11 @@ void zebra_vty_init(void)
 
 	install_element(VIEW_NODE, &show_dataplane_cmd);
 	install_element(VIEW_NODE, &show_dataplane_providers_cmd);
+	install_element(VIEW_NODE, &show_dataplane_pipeline_cmd);
+	install_element(ENABLE_NODE, &clear_dataplane_pipeline_cmd);
 	install_element(CONFIG_NODE, &zebra_dplane_queue_limit_cmd);
 	install_element(CONFIG_NODE, &no_zebra_dplane_queue_limit_cmd);
+	install_element(CONFIG_NODE, &zebra_dplane_provider_limit_cmd);
 
 	install_element(CONFIG_NODE, &ip_table_range_cmd);
 	install_element(VRF_NODE, &ip_table_range_cmd);
@@ -4668,6 +4898,7 @@ void zebra_vty_init(void)
 #ifdef HAVE_NETLINK
 	install_element(CONFIG_NODE, &zebra_kernel_netlink_batch_tx_buf_cmd);
 	install_element(CONFIG_NODE, &no_zebra_kernel_netlink_batch_tx_buf_cmd);
+	install_element(CONFIG_NODE, &zebra_kernel_netlink_batch_adaptive_cmd);
 	install_element(CONFIG_NODE, &zebra_protodown_bit_cmd);
 	install_element(CONFIG_NODE, &no_zebra_protodown_bit_cmd);
 #endif /* HAVE_NETLINK */
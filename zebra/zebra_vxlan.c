@@ -485,6 +485,9 @@ static void zevpn_print_mac_hash_all_evpn(struct hash_bucket *bucket, void *ctxt
 	if (wctx->print_dup)
 		hash_iterate(zevpn->mac_table, zebra_evpn_print_dad_mac_hash,
 			     wctx);
+	else if (CHECK_FLAG(wctx->flags, SHOW_REMOTE_MAC_FROM_VTEP))
+		zebra_evpn_mac_vtep_iterate(zevpn, wctx->r_vtep_ip,
+					    zebra_evpn_print_mac_hash, wctx);
 	else
 		hash_iterate(zevpn->mac_table, zebra_evpn_print_mac_hash, wctx);
 	wctx->json = json;
@@ -3072,9 +3075,10 @@ void zebra_vxlan_print_neigh_vni_vtep(struct vty *vty, struct zebra_vrf *zvrf,
 	wctx.flags = SHOW_REMOTE_NEIGH_FROM_VTEP;
 	wctx.r_vtep_ip = vtep_ip;
 	wctx.json = json;
-	hash_iterate(zevpn->neigh_table, zebra_evpn_find_neigh_addr_width,
-		     &wctx);
-	hash_iterate(zevpn->neigh_table, zebra_evpn_print_neigh_hash, &wctx);
+	zebra_evpn_neigh_vtep_iterate(zevpn, vtep_ip,
+				      zebra_evpn_find_neigh_addr_width, &wctx);
+	zebra_evpn_neigh_vtep_iterate(zevpn, vtep_ip,
+				      zebra_evpn_print_neigh_hash, &wctx);
 
 	if (use_json)
 		vty_json(vty, json);
@@ -3718,7 +3722,8 @@ void zebra_vxlan_print_macs_vni_vtep(struct vty *vty, struct zebra_vrf *zvrf,
 	wctx.flags = SHOW_REMOTE_MAC_FROM_VTEP;
 	wctx.r_vtep_ip = vtep_ip;
 	wctx.json = json_mac;
-	hash_iterate(zevpn->mac_table, zebra_evpn_print_mac_hash, &wctx);
+	zebra_evpn_mac_vtep_iterate(zevpn, vtep_ip, zebra_evpn_print_mac_hash,
+				    &wctx);
 
 	if (use_json) {
 		json_object_int_add(json, "numMacs", wctx.count);
@@ -3822,6 +3827,7 @@ void zebra_vxlan_print_evpn(struct vty *vty, bool uj)
 		json_object_boolean_add(json, "isDetectionFreeze",
 					zvrf->dad_freeze);
 		zebra_evpn_mh_json(json);
+		zebra_evpn_mac_index_show(vty, json);
 	} else {
 		vty_out(vty, "L2 VNIs: %u\n", num_l2vnis);
 		vty_out(vty, "L3 VNIs: %u\n", num_l3vnis);
@@ -3845,6 +3851,7 @@ void zebra_vxlan_print_evpn(struct vty *vty, bool uj)
 					"permanent");
 		}
 		zebra_evpn_mh_print(vty);
+		zebra_evpn_mac_index_show(vty, NULL);
 	}
 
 	if (uj)
@@ -42,6 +42,7 @@
 #include "lib/frratomic.h"        /* for atomic_load_explicit, atomic_stor... */
 #include "lib/lib_errors.h"       /* for generic ferr ids */
 #include "lib/printfrr.h"         /* for string functions */
+#include "lib/json.h"             /* for json_object_new_object, json_obj... */
 
 #include "zebra/debug.h"          /* for various debugging macros */
 #include "zebra/rib.h"            /* for rib_score_proto */
@@ -50,6 +51,7 @@
 #include "zebra/zserv.h"          /* for zserv */
 #include "zebra/zebra_router.h"
 #include "zebra/zebra_errors.h"   /* for error messages */
+#include "zebra/redistribute.h"   /* for zebra_redistribute_walks_fini */
 /* clang-format on */
 
 /* privileges */
@@ -67,6 +69,23 @@ static struct zserv *find_client_internal(uint8_t proto,
 
 /* Mem type for zclients. */
 DEFINE_MTYPE_STATIC(ZEBRA, ZSERV_CLIENT, "ZClients");
+DEFINE_MTYPE_STATIC(ZEBRA, ZSERV_IBATCH, "ZClient input batch");
+DEFINE_MTYPE_STATIC(ZEBRA, ZSERV_CMD_STATS, "ZClient message stats");
+
+/* A run of messages zserv_read() published on a client's ibuf_fifo */
+struct zserv_ibatch {
+	uint32_t count;
+	struct timeval read_time;
+
+	struct zserv_ibatch_item item;
+};
+
+DECLARE_LIST(zserv_ibatch, struct zserv_ibatch, item);
+
+/* Largest message accepted from a client */
+#define ZSERV_MAX_MSG_SIZE MAX(ZEBRA_MAX_PACKET_SIZ, sizeof(struct zapi_route))
+/* Client input buffer, big enough to pull in several messages per read */
+#define ZSERV_IBUF_SIZE (4 * ZSERV_MAX_MSG_SIZE)
 
 /*
  * Client thread events.
@@ -309,12 +328,13 @@ zwrite_fail:
 static void zserv_read(struct event *thread)
 {
 	struct zserv *client = EVENT_ARG(thread);
+	struct stream *ibuf = client->ibuf_work;
 	int sock;
-	size_t already;
 	struct stream_fifo *cache;
 	uint32_t p2p_orig;
-
 	uint32_t p2p;
+	uint32_t count = 0, reads = 0;
+	uint16_t last_cmd = 0;
 	struct zmsghdr hdr;
 
 	p2p_orig = atomic_load_explicit(&zrouter.packets_to_process,
@@ -323,110 +343,121 @@ static void zserv_read(struct event *thread)
 	p2p = p2p_orig;
 	sock = EVENT_FD(thread);
 
-	while (p2p) {
+	/*
+	 * Read as much as the socket has in one go and carve the messages out
+	 * of the buffer afterwards, rather than doing a read for the header
+	 * and another one for the body of every message. A message that is not
+	 * complete yet stays at the front of the buffer for the next round.
+	 */
+	for (;;) {
 		ssize_t nb;
 		bool hdrvalid;
 		char errmsg[256];
+		size_t start;
+
+		while (STREAM_READABLE(ibuf) >= ZEBRA_HEADER_SIZE) {
+			start = stream_get_getp(ibuf);
 
-		already = stream_get_endp(client->ibuf_work);
+			/* Fetch header values */
+			hdrvalid = zapi_parse_header(ibuf, &hdr);
+			stream_set_getp(ibuf, start);
 
-		/* Read length and command (if we don't have it already). */
-		if (already < ZEBRA_HEADER_SIZE) {
-			nb = stream_read_try(client->ibuf_work, sock,
-					     ZEBRA_HEADER_SIZE - already);
-			if ((nb == 0 || nb == -1)) {
-				if (IS_ZEBRA_DEBUG_EVENT)
-					zlog_debug("connection closed socket [%d]",
-						   sock);
+			if (!hdrvalid) {
+				snprintf(errmsg, sizeof(errmsg),
+					 "%s: Message has corrupt header",
+					 __func__);
+				zserv_log_message(errmsg, ibuf, NULL);
 				goto zread_fail;
 			}
-			if (nb != (ssize_t)(ZEBRA_HEADER_SIZE - already)) {
-				/* Try again later. */
-				break;
-			}
-			already = ZEBRA_HEADER_SIZE;
-		}
 
-		/* Reset to read from the beginning of the incoming packet. */
-		stream_set_getp(client->ibuf_work, 0);
+			/* Validate header */
+			if (hdr.marker != ZEBRA_HEADER_MARKER
+			    || hdr.version != ZSERV_VERSION) {
+				snprintf(
+					errmsg, sizeof(errmsg),
+					"Message has corrupt header\n%s: socket %d version mismatch, marker %d, version %d",
+					__func__, sock, hdr.marker, hdr.version);
+				zserv_log_message(errmsg, ibuf, &hdr);
+				goto zread_fail;
+			}
+			if (hdr.length < ZEBRA_HEADER_SIZE) {
+				snprintf(
+					errmsg, sizeof(errmsg),
+					"Message has corrupt header\n%s: socket %d message length %u is less than header size %d",
+					__func__, sock, hdr.length,
+					ZEBRA_HEADER_SIZE);
+				zserv_log_message(errmsg, ibuf, &hdr);
+				goto zread_fail;
+			}
+			if (hdr.length > ZSERV_MAX_MSG_SIZE) {
+				snprintf(
+					errmsg, sizeof(errmsg),
+					"Message has corrupt header\n%s: socket %d message length %u exceeds buffer size %lu",
+					__func__, sock, hdr.length,
+					(unsigned long)ZSERV_MAX_MSG_SIZE);
+				zserv_log_message(errmsg, ibuf, &hdr);
+				goto zread_fail;
+			}
 
-		/* Fetch header values */
-		hdrvalid = zapi_parse_header(client->ibuf_work, &hdr);
+			/* Rest of the message not there yet. */
+			if (STREAM_READABLE(ibuf) < hdr.length)
+				break;
 
-		if (!hdrvalid) {
-			snprintf(errmsg, sizeof(errmsg),
-				 "%s: Message has corrupt header", __func__);
-			zserv_log_message(errmsg, client->ibuf_work, NULL);
-			goto zread_fail;
-		}
+			/* Debug packet information. */
+			if (IS_ZEBRA_DEBUG_PACKET)
+				zlog_debug("zebra message[%s:%u:%u] comes from socket [%d]",
+					   zserv_command_string(hdr.command),
+					   hdr.vrf_id, hdr.length, sock);
 
-		/* Validate header */
-		if (hdr.marker != ZEBRA_HEADER_MARKER
-		    || hdr.version != ZSERV_VERSION) {
-			snprintf(
-				errmsg, sizeof(errmsg),
-				"Message has corrupt header\n%s: socket %d version mismatch, marker %d, version %d",
-				__func__, sock, hdr.marker, hdr.version);
-			zserv_log_message(errmsg, client->ibuf_work, &hdr);
-			goto zread_fail;
-		}
-		if (hdr.length < ZEBRA_HEADER_SIZE) {
-			snprintf(
-				errmsg, sizeof(errmsg),
-				"Message has corrupt header\n%s: socket %d message length %u is less than header size %d",
-				__func__, sock, hdr.length, ZEBRA_HEADER_SIZE);
-			zserv_log_message(errmsg, client->ibuf_work, &hdr);
-			goto zread_fail;
-		}
-		if (hdr.length > STREAM_SIZE(client->ibuf_work)) {
-			snprintf(
-				errmsg, sizeof(errmsg),
-				"Message has corrupt header\n%s: socket %d message length %u exceeds buffer size %lu",
-				__func__, sock, hdr.length,
-				(unsigned long)STREAM_SIZE(client->ibuf_work));
-			zserv_log_message(errmsg, client->ibuf_work, &hdr);
-			goto zread_fail;
-		}
+			struct stream *msg = stream_new(hdr.length);
 
-		/* Read rest of data. */
-		if (already < hdr.length) {
-			nb = stream_read_try(client->ibuf_work, sock,
-					     hdr.length - already);
-			if ((nb == 0 || nb == -1)) {
-				if (IS_ZEBRA_DEBUG_EVENT)
-					zlog_debug(
-						   "connection closed [%d] when reading zebra data",
-						   sock);
-				goto zread_fail;
-			}
-			if (nb != (ssize_t)(hdr.length - already)) {
-				/* Try again later. */
-				break;
-			}
+			stream_put(msg, stream_pnt(ibuf), hdr.length);
+			stream_forward_getp(ibuf, hdr.length);
+			stream_fifo_push(cache, msg);
+			last_cmd = hdr.command;
+			count++;
+			if (p2p)
+				p2p--;
 		}
 
-		/* Debug packet information. */
-		if (IS_ZEBRA_DEBUG_PACKET)
-			zlog_debug("zebra message[%s:%u:%u] comes from socket [%d]",
-				   zserv_command_string(hdr.command),
-				   hdr.vrf_id, hdr.length,
-				   sock);
+		if (!p2p)
+			break;
 
-		stream_set_getp(client->ibuf_work, 0);
-		struct stream *msg = stream_dup(client->ibuf_work);
+		/* Move what is left of a partial message to the front. */
+		if (STREAM_READABLE(ibuf))
+			stream_pulldown(ibuf);
+		else
+			stream_reset(ibuf);
 
-		stream_fifo_push(cache, msg);
-		stream_reset(client->ibuf_work);
-		p2p--;
+		nb = stream_read_try(ibuf, sock, STREAM_WRITEABLE(ibuf));
+		if (nb == 0 || nb == -1) {
+			if (IS_ZEBRA_DEBUG_EVENT)
+				zlog_debug("connection closed socket [%d]",
+					   sock);
+			goto zread_fail;
+		}
+		if (nb < 0) {
+			/* Try again later. */
+			break;
+		}
+		reads++;
 	}
 
-	if (p2p < p2p_orig) {
+	if (count) {
 		uint64_t time_now = monotime(NULL);
+		struct zserv_ibatch *batch;
+
+		batch = XMALLOC(MTYPE_ZSERV_IBATCH, sizeof(*batch));
+		batch->count = count;
+		monotime(&batch->read_time);
 
 		/* update session statistics */
 		frr_with_mutex (&client->stats_mtx) {
 			client->last_read_time = time_now;
-			client->last_read_cmd = hdr.command;
+			client->last_read_cmd = last_cmd;
+			client->read_calls += reads;
+			client->read_msgs += count;
+			client->ibuf_pending = STREAM_READABLE(ibuf);
 		}
 
 		/* publish read packets on client's input queue */
@@ -434,6 +465,7 @@ static void zserv_read(struct event *thread)
 			while (cache->head)
 				stream_fifo_push(client->ibuf_fifo,
 						 stream_fifo_pop(cache));
+			zserv_ibatch_add_tail(&client->ibuf_batches, batch);
 		}
 
 		/* Schedule job to process those packets */
@@ -442,7 +474,7 @@ static void zserv_read(struct event *thread)
 	}
 
 	if (IS_ZEBRA_DEBUG_PACKET)
-		zlog_debug("Read %d packets from client: %s", p2p_orig - p2p,
+		zlog_debug("Read %u packets from client: %s", count,
 			   zebra_route_string(client->proto));
 
 	/* Reschedule ourselves */
@@ -474,6 +506,62 @@ static void zserv_client_event(struct zserv *client,
 
 /* Main thread lifecycle ---------------------------------------------------- */
 
+static inline unsigned int zserv_hist_bucket(uint64_t usec)
+{
+	if (usec < 2)
+		return 0;
+	return MIN(63 - __builtin_clzll(usec), ZSERV_HIST_BUCKETS - 1);
+}
+
+static struct zserv_cmd_stats *zserv_cmd_stats_get(struct zserv *client,
+						   uint16_t command)
+{
+	if (command >= ZSERV_CMD_STATS_MAX)
+		return NULL;
+	if (!client->cmd_stats[command])
+		client->cmd_stats[command] =
+			XCALLOC(MTYPE_ZSERV_CMD_STATS,
+				sizeof(struct zserv_cmd_stats));
+	return client->cmd_stats[command];
+}
+
+/* time msg spent on the client's input queue */
+static void zserv_cmd_stats_queued(struct zserv *client, struct stream *msg,
+				   int64_t usec)
+{
+	struct zserv_cmd_stats *stats;
+	struct zmsghdr hdr;
+
+	zapi_parse_header(msg, &hdr);
+	stream_set_getp(msg, 0);
+
+	stats = zserv_cmd_stats_get(client, hdr.command);
+	if (!stats)
+		return;
+
+	usec = MAX(usec, 0);
+	stats->queued++;
+	stats->wait_total += usec;
+	stats->wait_max = MAX(stats->wait_max, (uint64_t)usec);
+	stats->wait_hist[zserv_hist_bucket(usec)]++;
+}
+
+void zserv_cmd_stats_handled(struct zserv *client, uint16_t command,
+			     int64_t usec)
+{
+	struct zserv_cmd_stats *stats;
+
+	stats = zserv_cmd_stats_get(client, command);
+	if (!stats)
+		return;
+
+	usec = MAX(usec, 0);
+	stats->handled++;
+	stats->handler_total += usec;
+	stats->handler_max = MAX(stats->handler_max, (uint64_t)usec);
+	stats->handler_hist[zserv_hist_bucket(usec)]++;
+}
+
 /*
  * Read and process messages from a client.
  *
@@ -498,6 +586,10 @@ static void zserv_process_messages(struct event *thread)
 	struct stream_fifo *cache = stream_fifo_new();
 	uint32_t p2p = zrouter.packets_to_process;
 	bool need_resched = false;
+	struct zserv_ibatch *batch;
+	struct timeval now;
+
+	monotime(&now);
 
 	frr_with_mutex (&client->ibuf_mtx) {
 		uint32_t i;
@@ -505,6 +597,17 @@ static void zserv_process_messages(struct event *thread)
 		     ++i) {
 			msg = stream_fifo_pop(client->ibuf_fifo);
 			stream_fifo_push(cache, msg);
+
+			batch = zserv_ibatch_first(&client->ibuf_batches);
+			if (!batch)
+				continue;
+			zserv_cmd_stats_queued(client, msg,
+					       monotime_since(&batch->read_time,
+							      &now));
+			if (--batch->count == 0) {
+				zserv_ibatch_pop(&client->ibuf_batches);
+				XFREE(MTYPE_ZSERV_IBATCH, batch);
+			}
 		}
 
 		msg = NULL;
@@ -576,11 +679,19 @@ DEFINE_KOOH(zserv_client_close, (struct zserv *client), (client));
  */
 static void zserv_client_free(struct zserv *client)
 {
+	struct zserv_ibatch *batch;
+	unsigned int i;
+
 	if (client == NULL)
 		return;
 
 	hook_call(zserv_client_close, client);
 
+	zsend_route_notify_batch_discard(client);
+	zsend_interface_state_discard(client);
+	zebra_redistribute_walks_fini(client);
+	zsend_redistribute_discard(client);
+
 	/* Close file descriptor. */
 	if (client->sock) {
 		unsigned long nroutes;
@@ -615,6 +726,11 @@ static void zserv_client_free(struct zserv *client)
 		stream_free(client->obuf_work);
 	if (client->ibuf_fifo)
 		stream_fifo_free(client->ibuf_fifo);
+	while ((batch = zserv_ibatch_pop(&client->ibuf_batches)))
+		XFREE(MTYPE_ZSERV_IBATCH, batch);
+	zserv_ibatch_fini(&client->ibuf_batches);
+	for (i = 0; i < ZSERV_CMD_STATS_MAX; i++)
+		XFREE(MTYPE_ZSERV_CMD_STATS, client->cmd_stats[i]);
 	if (client->obuf_fifo)
 		stream_fifo_free(client->obuf_fifo);
 	if (client->wb)
@@ -729,8 +845,7 @@ static void zserv_handle_client_fail(struct event *thread)
 static struct zserv *zserv_client_create(int sock)
 {
 	struct zserv *client;
-	size_t stream_size =
-		MAX(ZEBRA_MAX_PACKET_SIZ, sizeof(struct zapi_route));
+	size_t stream_size = ZSERV_MAX_MSG_SIZE;
 	int i;
 	afi_t afi;
 
@@ -739,8 +854,9 @@ static struct zserv *zserv_client_create(int sock)
 	/* Make client input/output buffer. */
 	client->sock = sock;
 	client->ibuf_fifo = stream_fifo_new();
+	zserv_ibatch_init(&client->ibuf_batches);
 	client->obuf_fifo = stream_fifo_new();
-	client->ibuf_work = stream_new(stream_size);
+	client->ibuf_work = stream_new(ZSERV_IBUF_SIZE);
 	client->obuf_work = stream_new(stream_size);
 	client->connect_time = monotime(NULL);
 	pthread_mutex_init(&client->ibuf_mtx, NULL);
@@ -748,6 +864,8 @@ static struct zserv *zserv_client_create(int sock)
 	pthread_mutex_init(&client->stats_mtx, NULL);
 	client->wb = buffer_new(0);
 	TAILQ_INIT(&(client->gr_info_queue));
+	zsend_redistribute_init(client);
+	zebra_redistribute_walks_init(client);
 
 	/* Initialize flags */
 	for (afi = AFI_IP; afi < AFI_MAX; afi++) {
@@ -990,6 +1108,126 @@ static char *zserv_time_buf(time_t *time1, char *buf, int buflen)
 	return buf;
 }
 
+/* upper bound of the bucket that holds the given percentile */
+static uint64_t zserv_hist_percentile(const uint32_t *hist, uint64_t total,
+				      unsigned int pct, uint64_t max)
+{
+	uint64_t seen = 0, want = (total * pct + 99) / 100;
+
+	for (unsigned int i = 0; i < ZSERV_HIST_BUCKETS - 1; i++) {
+		seen += hist[i];
+		if (seen >= want)
+			return MIN(2ULL << i, max);
+	}
+	return max;
+}
+
+static json_object *zserv_hist_json(const uint32_t *hist)
+{
+	json_object *json = json_object_new_object();
+	char key[16];
+
+	for (unsigned int i = 0; i < ZSERV_HIST_BUCKETS; i++) {
+		if (!hist[i])
+			continue;
+
+		if (i == ZSERV_HIST_BUCKETS - 1)
+			snprintf(key, sizeof(key), "+Inf");
+		else
+			snprintf(key, sizeof(key), "%llu", 2ULL << i);
+		json_object_int_add(json, key, hist[i]);
+	}
+	return json;
+}
+
+static void zebra_show_client_cmd_stats(struct vty *vty, struct zserv *client)
+{
+	const struct zserv_cmd_stats *stats;
+	bool header = false;
+
+	for (unsigned int cmd = 0; cmd < ZSERV_CMD_STATS_MAX; cmd++) {
+		stats = client->cmd_stats[cmd];
+		if (!stats)
+			continue;
+
+		if (!header) {
+			vty_out(vty,
+				"%-34s %10s %7s %7s %7s %7s %7s %7s\n",
+				"Message (usec)", "Handled", "Avg", "p99",
+				"Max", "WaitAvg", "Waitp99", "WaitMax");
+			header = true;
+		}
+		vty_out(vty,
+			"%-34s %10" PRIu64 " %7" PRIu64 " %7" PRIu64
+			" %7" PRIu64 " %7" PRIu64 " %7" PRIu64 " %7" PRIu64
+			"\n",
+			zserv_command_string(cmd), stats->handled,
+			stats->handled ? stats->handler_total / stats->handled
+				       : 0,
+			zserv_hist_percentile(stats->handler_hist,
+					      stats->handled, 99,
+					      stats->handler_max),
+			stats->handler_max,
+			stats->queued ? stats->wait_total / stats->queued : 0,
+			zserv_hist_percentile(stats->wait_hist, stats->queued,
+					      99, stats->wait_max),
+			stats->wait_max);
+	}
+	if (header)
+		vty_out(vty, "\n");
+}
+
+static json_object *zebra_client_json(struct zserv *client)
+{
+	const struct zserv_cmd_stats *stats;
+	json_object *json, *json_msgs, *json_msg;
+	uint64_t read_calls, read_msgs;
+
+	frr_with_mutex (&client->stats_mtx) {
+		read_calls = client->read_calls;
+		read_msgs = client->read_msgs;
+	}
+
+	json = json_object_new_object();
+	json_object_string_add(json, "client",
+			       zebra_route_string(client->proto));
+	json_object_int_add(json, "instance", client->instance);
+	json_object_int_add(json, "sessionId", client->session_id);
+	json_object_int_add(json, "fd", client->sock);
+	json_object_int_add(json, "socketReads", read_calls);
+	json_object_int_add(json, "socketReadMsgs", read_msgs);
+	json_object_int_add(json, "errors", client->error_cnt);
+
+	json_msgs = json_object_new_object();
+	json_object_object_add(json, "messages", json_msgs);
+
+	for (unsigned int cmd = 0; cmd < ZSERV_CMD_STATS_MAX; cmd++) {
+		stats = client->cmd_stats[cmd];
+		if (!stats)
+			continue;
+
+		json_msg = json_object_new_object();
+		json_object_int_add(json_msg, "handled", stats->handled);
+		json_object_int_add(json_msg, "handlerUsecTotal",
+				    stats->handler_total);
+		json_object_int_add(json_msg, "handlerUsecMax",
+				    stats->handler_max);
+		json_object_object_add(json_msg, "handlerUsecHistogram",
+				       zserv_hist_json(stats->handler_hist));
+		json_object_int_add(json_msg, "queued", stats->queued);
+		json_object_int_add(json_msg, "queueWaitUsecTotal",
+				    stats->wait_total);
+		json_object_int_add(json_msg, "queueWaitUsecMax",
+				    stats->wait_max);
+		json_object_object_add(json_msg, "queueWaitUsecHistogram",
+				       zserv_hist_json(stats->wait_hist));
+		json_object_object_add(json_msgs, zserv_command_string(cmd),
+				       json_msg);
+	}
+
+	return json;
+}
+
 /* Display client info details */
 static void zebra_show_client_detail(struct vty *vty, struct zserv *client)
 {
@@ -997,6 +1235,8 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client)
 	char wbuf[ZEBRA_TIME_BUF], nhbuf[ZEBRA_TIME_BUF], mbuf[ZEBRA_TIME_BUF];
 	time_t connect_time, last_read_time, last_write_time;
 	uint32_t last_read_cmd, last_write_cmd;
+	uint64_t read_calls, read_msgs;
+	size_t ibuf_pending;
 
 	vty_out(vty, "Client: %s", zebra_route_string(client->proto));
 	if (client->instance)
@@ -1015,6 +1255,10 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client)
 
 		last_read_cmd = client->last_read_cmd;
 		last_write_cmd = client->last_write_cmd;
+
+		read_calls = client->read_calls;
+		read_msgs = client->read_msgs;
+		ibuf_pending = client->ibuf_pending;
 	}
 
 	vty_out(vty, "Connect Time: %s \n",
@@ -1046,6 +1290,11 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client)
 	if (last_write_cmd)
 		vty_out(vty, "Last Sent Cmd: %s \n",
 			zserv_command_string(last_write_cmd));
+	vty_out(vty, "Socket Reads: %" PRIu64 " Msgs: %" PRIu64
+		" (%" PRIu64 " per read) \n",
+		read_calls, read_msgs, read_calls ? read_msgs / read_calls : 0);
+	vty_out(vty, "Input Buffer: %zu of %zu bytes pending \n", ibuf_pending,
+		(size_t)ZSERV_IBUF_SIZE);
 	vty_out(vty, "\n");
 
 	vty_out(vty, "Type        Add         Update      Del \n");
@@ -1084,6 +1333,12 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client)
 		0, client->local_es_del_cnt);
 	vty_out(vty, "ES-EVI      %-12u%-12u%-12u\n",
 		client->local_es_evi_add_cnt, 0, client->local_es_evi_del_cnt);
+	vty_out(vty, "Interface state bulk messages: %u\n",
+		client->ifstate_bulk_cnt);
+	vty_out(vty,
+		"Redistribute bulk messages: %u, updates coalesced: %u, pending: %zu\n",
+		client->redist_bulk_cnt, client->redist_coalesced_cnt,
+		zsend_redistribute_backlog(client));
 	vty_out(vty, "Errors: %u\n", client->error_cnt);
 
 #if defined DEV_BUILD
@@ -1092,6 +1347,8 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client)
 		client->obuf_fifo->count, client->obuf_fifo->max_count);
 #endif
 	vty_out(vty, "\n");
+
+	zebra_show_client_cmd_stats(vty, client);
 }
 
 /* Display stale client information */
@@ -1248,13 +1505,28 @@ struct zserv *zserv_find_client_session(uint8_t proto, unsigned short instance,
 /* This command is for debugging purpose. */
 DEFUN (show_zebra_client,
        show_zebra_client_cmd,
-       "show zebra client",
+       "show zebra client [json]",
        SHOW_STR
        ZEBRA_STR
-       "Client information\n")
+       "Client information\n"
+       JSON_STR)
 {
 	struct listnode *node;
 	struct zserv *client;
+	json_object *json, *json_clients;
+
+	if (use_json(argc, argv)) {
+		json = json_object_new_object();
+		json_clients = json_object_new_array();
+		json_object_object_add(json, "clients", json_clients);
+
+		for (ALL_LIST_ELEMENTS_RO(zrouter.client_list, node, client))
+			json_object_array_add(json_clients,
+					      zebra_client_json(client));
+
+		vty_json(vty, json);
+		return CMD_SUCCESS;
+	}
 
 	for (ALL_LIST_ELEMENTS_RO(zrouter.client_list, node, client)) {
 		zebra_show_client_detail(vty, client);
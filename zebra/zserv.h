@@ -23,6 +23,7 @@
 #include "lib/linklist.h"     /* for list */
 #include "lib/workqueue.h"    /* for work_queue */
 #include "lib/hook.h"         /* for DECLARE_HOOK, DECLARE_KOOH */
+#include "lib/typesafe.h"     /* for PREDECL_LIST */
 /* clang-format on */
 
 #ifdef __cplusplus
@@ -75,6 +76,32 @@ struct client_gr_info {
 	TAILQ_ENTRY(client_gr_info) gr_info;
 };
 
+PREDECL_LIST(zserv_ibatch);
+PREDECL_HASH(zserv_redist_pending);
+PREDECL_DLIST(zserv_redist_order);
+PREDECL_DLIST(zserv_redist_walks);
+
+/*
+ * Latency histograms use log2 buckets of microseconds: [0, 2), [2, 4), ...
+ * and everything from 2^23 (~8.4s) on in the last one.
+ */
+#define ZSERV_HIST_BUCKETS 24
+
+/* commands above this aren't accounted, they are all well below */
+#define ZSERV_CMD_STATS_MAX 256
+
+/* Time spent on one message type of a client, in usec */
+struct zserv_cmd_stats {
+	uint64_t handled;
+	uint64_t handler_total;
+	uint64_t handler_max;
+	uint64_t queued;
+	uint64_t wait_total;
+	uint64_t wait_max;
+	uint32_t handler_hist[ZSERV_HIST_BUCKETS];
+	uint32_t wait_hist[ZSERV_HIST_BUCKETS];
+};
+
 /* Client structure. */
 struct zserv {
 	/* Client pthread */
@@ -94,6 +121,8 @@ struct zserv {
 	/* Input/output buffer to the client. */
 	pthread_mutex_t ibuf_mtx;
 	struct stream_fifo *ibuf_fifo;
+	/* when the messages on ibuf_fifo were read, oldest first */
+	struct zserv_ibatch_head ibuf_batches;
 	pthread_mutex_t obuf_mtx;
 	struct stream_fifo *obuf_fifo;
 
@@ -129,6 +158,50 @@ struct zserv {
 
 	bool notify_owner;
 
+	/*
+	 * Client accepts ZEBRA_ROUTE_NOTIFY_OWNER_BATCH: consecutive route
+	 * notifications with the same vrf, note, table, afi and safi are
+	 * collected here and sent at the end of the event loop pass.
+	 */
+	bool notify_owner_batch;
+	struct {
+		struct stream *s;
+		size_t countp;
+		uint16_t count;
+		vrf_id_t vrf_id;
+		enum zapi_route_notify_owner note;
+		uint32_t table_id;
+		afi_t afi;
+		safi_t safi;
+		uint8_t family;
+		struct event *t_flush;
+	} notify_batch;
+
+	/*
+	 * ZEBRA_INTERFACE_UP/DOWN updates waiting to go out in one
+	 * ZEBRA_INTERFACE_STATE_BULK message, see zsend_interface_update().
+	 */
+	struct {
+		struct stream *s;
+		size_t countp;
+		uint16_t count;
+		vrf_id_t vrf_id;
+		struct event *t_flush;
+	} ifstate_batch;
+
+	/*
+	 * Redistributed routes waiting to go out in
+	 * ZEBRA_REDISTRIBUTE_ROUTE_BULK messages, only the latest update for
+	 * each route, oldest first; see zsend_redistribute_route().
+	 */
+	struct zserv_redist_pending_head redist_pending;
+	struct zserv_redist_order_head redist_order;
+	struct event *t_redist_flush;
+
+	/* Table walks for new redistribute requests, see zebra_redistribute() */
+	struct zserv_redist_walks_head redist_walks;
+	struct event *t_redist_walk;
+
 	/* Indicates if client is synchronous. */
 	bool synchronous;
 
@@ -159,6 +232,9 @@ struct zserv {
 	uint32_t connected_rt_del_cnt;
 	uint32_t ifup_cnt;
 	uint32_t ifdown_cnt;
+	uint32_t ifstate_bulk_cnt;
+	uint32_t redist_bulk_cnt;
+	uint32_t redist_coalesced_cnt;
 	uint32_t ifadd_cnt;
 	uint32_t ifdel_cnt;
 	uint32_t if_bfd_cnt;
@@ -215,9 +291,21 @@ struct zserv {
 	uint64_t last_read_cmd;
 	/* command code of last message written */
 	uint64_t last_write_cmd;
+	/* reads done on the socket and messages they carried */
+	uint64_t read_calls;
+	uint64_t read_msgs;
+	/* bytes of a partial message left in ibuf_work after the last read */
+	size_t ibuf_pending;
 
 	/* END covered by stats_mtx */
 
+	/*
+	 * Per message type handler time and time spent queued between
+	 * zserv_read() and zserv_process_messages(), allocated on first use.
+	 * Only touched from the main pthread.
+	 */
+	struct zserv_cmd_stats *cmd_stats[ZSERV_CMD_STATS_MAX];
+
 	/*
 	 * Number of instances configured with
 	 * graceful restart
@@ -291,6 +379,22 @@ extern int zserv_send_message(struct zserv *client, struct stream *msg);
  */
 extern int zserv_send_batch(struct zserv *client, struct stream_fifo *fifo);
 
+/*
+ * Account the time a handler took for a message of a client. Main pthread
+ * only.
+ *
+ * client
+ *    the client the message came from
+ *
+ * command
+ *    the message's command code
+ *
+ * usec
+ *    how long the handler ran
+ */
+extern void zserv_cmd_stats_handled(struct zserv *client, uint16_t command,
+				    int64_t usec);
+
 /*
  * Retrieve a client by its protocol and instance number.
  *